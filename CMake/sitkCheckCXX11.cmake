@@ -8,6 +8,8 @@
 # SITK_HAS_CXX11_NULLPTR          - True if "nullptr" keyword is supported
 # SITK_HAS_CXX11_UNIQUE_PTR
 # SITK_HAS_CXX11_ALIAS_TEMPLATE   - Able to use alias templates
+# SITK_HAS_CXX11_RVREF           - True if rvalue references and move semantics are supported
+# SITK_HAS_CXX11_VARIADIC_TEMPLATES - True if variadic templates, constexpr and decltype are supported
 #
 # SITK_HAS_TR1_SUB_INCLUDE
 #
@@ -74,6 +76,8 @@ sitkCXX11Test(SITK_HAS_CXX11_UNORDERED_MAP)
 sitkCXX11Test(SITK_HAS_CXX11_NULLPTR)
 sitkCXX11Test(SITK_HAS_CXX11_UNIQUE_PTR)
 sitkCXX11Test(SITK_HAS_CXX11_ALIAS_TEMPLATE)
+sitkCXX11Test(SITK_HAS_CXX11_RVREF)
+sitkCXX11Test(SITK_HAS_CXX11_VARIADIC_TEMPLATES)
 
 
 
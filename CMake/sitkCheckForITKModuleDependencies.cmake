@@ -20,6 +20,7 @@ list(APPEND _SITK_REQUIRED_ITK_MODULES
   ITKIOGDCM
   ITKIOImageBase
   ITKIOTransformBase
+  ITKIOTransformHDF5
   ITKImageCompose
   ITKImageIntensity
   ITKLabelMap
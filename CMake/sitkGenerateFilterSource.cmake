@@ -170,20 +170,30 @@ function( expand_template FILENAME input_dir output_dir library_name )
     set ( JSON_VALIDATE_COMMAND COMMAND "${PYTHON_EXECUTABLE}" "${SimpleITK_SOURCE_DIR}/Utilities/JSON/JSONValidate.py" "${input_json_file}" )
   endif ()
 
+  # The optional file restricting the instantiated pixel types and
+  # dimensions of the filters
+  set ( instantiation_file "" )
+  if ( SimpleITK_FILTER_INSTANTIATION_FILE )
+    get_filename_component( instantiation_file "${SimpleITK_FILTER_INSTANTIATION_FILE}" ABSOLUTE )
+    if ( NOT EXISTS "${instantiation_file}" )
+      message( FATAL_ERROR "SimpleITK_FILTER_INSTANTIATION_FILE \"${SimpleITK_FILTER_INSTANTIATION_FILE}\" does not exist." )
+    endif()
+  endif()
+
   # header
   add_custom_command (
     OUTPUT "${output_h}"
     ${JSON_VALIDATE_COMMAND}
     COMMAND ${CMAKE_COMMAND} -E remove -f ${output_h}
-    COMMAND ${SimpleITK_LUA_EXECUTABLE} ${expand_template_script} code ${input_json_file} ${input_dir}/templates/sitk ${template_include_dir} Template.h.in ${output_h}
-    DEPENDS ${input_json_file} ${template_deps} ${template_file_h}
+    COMMAND ${SimpleITK_LUA_EXECUTABLE} ${expand_template_script} code ${input_json_file} ${input_dir}/templates/sitk ${template_include_dir} Template.h.in ${output_h} ${instantiation_file}
+    DEPENDS ${input_json_file} ${template_deps} ${template_file_h} ${instantiation_file}
     )
   # impl
   add_custom_command (
     OUTPUT "${output_cxx}"
     COMMAND ${CMAKE_COMMAND} -E remove -f ${output_cxx}
-    COMMAND ${SimpleITK_LUA_EXECUTABLE} ${expand_template_script} code ${input_json_file} ${input_dir}/templates/sitk ${template_include_dir} Template.cxx.in ${output_cxx}
-    DEPENDS ${input_json_file} ${template_deps} ${template_file_cxx}
+    COMMAND ${SimpleITK_LUA_EXECUTABLE} ${expand_template_script} code ${input_json_file} ${input_dir}/templates/sitk ${template_include_dir} Template.cxx.in ${output_cxx} ${instantiation_file}
+    DEPENDS ${input_json_file} ${template_deps} ${template_file_cxx} ${instantiation_file}
     )
 
   set ( ${library_name}GeneratedHeader ${${library_name}GeneratedHeader}
@@ -0,0 +1,56 @@
+# sitk_target_build_acceleration
+#
+# This function has the following form:
+#   sitk_target_build_acceleration(<target>
+#                                  [header [header [...]]])
+#
+#   It configures the target with the unity build and precompiled
+# header options. When SimpleITK_UNITY_BUILD is enabled, the sources
+# of the target are compiled in batches of
+# SimpleITK_UNITY_BUILD_BATCH_SIZE files. When
+# SimpleITK_USE_PRECOMPILED_HEADERS is enabled, the headers listed
+# are precompiled for the target. The first header should be
+# sitkCommon.h, so the extern template declarations of the explicit
+# ITK instantiations precede any ITK header.
+#
+# Both options require CMake 3.16, and are ignored with a warning
+# with older versions. A source file which can not be compiled in a
+# batch may set the SKIP_UNITY_BUILD_INCLUSION source file property.
+
+option( SimpleITK_UNITY_BUILD "Compile the sources of the filter libraries in batches. Requires CMake 3.16." OFF )
+mark_as_advanced( SimpleITK_UNITY_BUILD )
+
+set( SimpleITK_UNITY_BUILD_BATCH_SIZE 8 CACHE STRING
+  "The number of sources compiled together in a batch with SimpleITK_UNITY_BUILD." )
+mark_as_advanced( SimpleITK_UNITY_BUILD_BATCH_SIZE )
+
+option( SimpleITK_USE_PRECOMPILED_HEADERS "Precompile the common SimpleITK and ITK headers of the filter libraries. Requires CMake 3.16." OFF )
+mark_as_advanced( SimpleITK_USE_PRECOMPILED_HEADERS )
+
+if ( (SimpleITK_UNITY_BUILD OR SimpleITK_USE_PRECOMPILED_HEADERS)
+    AND CMAKE_VERSION VERSION_LESS 3.16 )
+  message( WARNING "SimpleITK_UNITY_BUILD and SimpleITK_USE_PRECOMPILED_HEADERS require CMake 3.16, they are ignored." )
+endif()
+
+function(sitk_target_build_acceleration target_name)
+
+  if ( CMAKE_VERSION VERSION_LESS 3.16 )
+    return()
+  endif()
+
+  set(headers ${ARGV})
+  list(REMOVE_AT headers 0)
+
+  if ( SimpleITK_UNITY_BUILD )
+    set_target_properties( ${target_name}
+      PROPERTIES
+        UNITY_BUILD ON
+        UNITY_BUILD_MODE BATCH
+        UNITY_BUILD_BATCH_SIZE ${SimpleITK_UNITY_BUILD_BATCH_SIZE} )
+  endif()
+
+  if ( SimpleITK_USE_PRECOMPILED_HEADERS AND headers )
+    target_precompile_headers( ${target_name} PRIVATE ${headers} )
+  endif()
+
+endfunction()
@@ -67,6 +67,27 @@ return 0;
 
 //-------------------------------------
 
+#ifdef SITK_HAS_CXX11_RVREF
+
+#include <utility>
+
+struct M {
+  M( void ) {}
+  M( M && ) noexcept {}
+  M & operator=( M && ) noexcept { return *this; }
+};
+
+int main(void) {
+  M a;
+  M b( std::move(a) );
+  a = std::move(b);
+  return 0;
+}
+
+#endif
+
+//-------------------------------------
+
 #ifdef SITK_HAS_CXX11_UNIQUE_PTR
 
 #include <memory>
@@ -78,6 +99,29 @@ int main(void) {
 
 #endif
 
+//-------------------------------------
+
+#ifdef SITK_HAS_CXX11_VARIADIC_TEMPLATES
+
+template <typename... T> struct Pack {};
+
+constexpr int First( int ) { return -1; }
+
+template <typename... B>
+constexpr int First( int i, bool b, B... bs ) { return b ? i : First( i + 1, bs... ); }
+
+template <typename... T>
+int Count( Pack<T...> ) { int a[] = { 0, ( (void)sizeof(T), 1 )... }; return sizeof(a)/sizeof(int) - 1; }
+
+int main(void)
+{
+  static_assert( First( 0, false, true ) == 1, "constexpr" );
+  decltype( Count( Pack<int, char>() ) ) n = Count( Pack<int, char>() );
+  return n - 2;
+}
+
+#endif
+
 
 
 //-------------------------------------
@@ -0,0 +1,121 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkBandedSignedMaurerDistanceMapImageFilter_h
+#define itkBandedSignedMaurerDistanceMapImageFilter_h
+
+#include "itkSignedMaurerDistanceMapImageFilter.h"
+
+namespace itk {
+
+/** \class BandedSignedMaurerDistanceMapImageFilter
+ * \brief A SignedMaurerDistanceMapImageFilter which may only compute
+ * the distances in a band around the object.
+ *
+ * The exact distance transform of Maurer is computed one axis after
+ * the other, and each pass is threaded over the lines of the image.
+ * Its cost is proportional to the number of pixels of the whole
+ * image, even when the distances far from the object are not used.
+ *
+ * When MaximumDistance is greater than zero, the distances are only
+ * computed in the bounding box of the pixels which are not background,
+ * grown by MaximumDistance and one pixel along each axis. The nearest
+ * object pixel of a pixel of the box, and the nearest background pixel
+ * of an object pixel, are inside of the box, so the distances computed
+ * in the box are exact. The distances are then clamped to
+ * MaximumDistance, and the pixels outside of the box are set to the
+ * clamped distance of the background.
+ *
+ * MaximumDistance is in the units of the distances, physical units
+ * when UseImageSpacing is true and pixels otherwise. It is a distance
+ * also when SquaredDistance is true, the squared distances are then
+ * clamped to the square of MaximumDistance.
+ *
+ * \sa SignedMaurerDistanceMapImageFilter
+ */
+template< typename TInputImage, typename TOutputImage >
+class BandedSignedMaurerDistanceMapImageFilter:
+    public SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef BandedSignedMaurerDistanceMapImageFilter Self;
+  typedef SignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(BandedSignedMaurerDistanceMapImageFilter, SignedMaurerDistanceMapImageFilter);
+
+  typedef TInputImage                          InputImageType;
+  typedef TOutputImage                         OutputImageType;
+  typedef typename InputImageType::PixelType   InputPixelType;
+  typedef typename OutputImageType::PixelType  OutputPixelType;
+  typedef typename OutputImageType::RegionType OutputImageRegionType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** The width of the band around the object where the distances are
+   * computed. The default of 0 computes the distances in the whole
+   * image. */
+  itkSetMacro( MaximumDistance, double );
+  itkGetConstMacro( MaximumDistance, double );
+
+  /** Get if the last execution only computed the distances in a
+   * band. */
+  itkGetConstMacro( BandUsed, bool );
+
+  /** Get the region where the distances were computed by the last
+   * execution. */
+  itkGetConstReferenceMacro( BandRegion, OutputImageRegionType );
+
+protected:
+
+  BandedSignedMaurerDistanceMapImageFilter();
+
+  // virtual ~BandedSignedMaurerDistanceMapImageFilter(); // implementation not needed
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void GenerateData() ITK_OVERRIDE;
+
+private:
+  BandedSignedMaurerDistanceMapImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  // Compute the bounding box of the object grown by the band, cropped
+  // to the region. Returns false if there is no object.
+  bool ComputeBandRegion( const InputImageType *input,
+                          const OutputImageRegionType &region,
+                          OutputImageRegionType &bandRegion ) const;
+
+  double                m_MaximumDistance;
+  bool                  m_BandUsed;
+  OutputImageRegionType m_BandRegion;
+};
+
+
+} // end namespace itk
+
+
+#include "itkBandedSignedMaurerDistanceMapImageFilter.hxx"
+
+#endif // itkBandedSignedMaurerDistanceMapImageFilter_h
@@ -0,0 +1,222 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkBandedSignedMaurerDistanceMapImageFilter_hxx
+#define itkBandedSignedMaurerDistanceMapImageFilter_hxx
+
+#include "itkBandedSignedMaurerDistanceMapImageFilter.h"
+
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkImageScanlineConstIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressAccumulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TInputImage, typename TOutputImage >
+BandedSignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
+::BandedSignedMaurerDistanceMapImageFilter()
+  : m_MaximumDistance( 0.0 ),
+    m_BandUsed( false )
+{
+}
+
+//
+// ComputeBandRegion
+//
+template< typename TInputImage, typename TOutputImage >
+bool
+BandedSignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
+::ComputeBandRegion( const InputImageType *input,
+                     const OutputImageRegionType &region,
+                     OutputImageRegionType &bandRegion ) const
+{
+  typedef typename OutputImageRegionType::IndexType IndexType;
+
+  const InputPixelType backgroundValue = this->GetBackgroundValue();
+
+  IndexType lower;
+  IndexType upper;
+  bool found = false;
+
+  ImageScanlineConstIterator< InputImageType > it( input, region );
+  while ( !it.IsAtEnd() )
+    {
+    while ( !it.IsAtEndOfLine() )
+      {
+      if ( it.Get() != backgroundValue )
+        {
+        const IndexType index = it.GetIndex();
+        if ( !found )
+          {
+          lower = index;
+          upper = index;
+          found = true;
+          }
+        for ( unsigned int d = 0; d < ImageDimension; ++d )
+          {
+          lower[d] = std::min( lower[d], index[d] );
+          upper[d] = std::max( upper[d], index[d] );
+          }
+        }
+      ++it;
+      }
+    it.NextLine();
+    }
+
+  if ( !found )
+    {
+    return false;
+    }
+
+  const typename InputImageType::SpacingType spacing = input->GetSpacing();
+  const IndexType regionLower = region.GetIndex();
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    double padding = this->m_MaximumDistance;
+    if ( this->GetUseImageSpacing() )
+      {
+      padding /= spacing[d];
+      }
+    // the one pixel border of background is needed for the distances
+    // inside of the object
+    const IndexValueType pad = static_cast< IndexValueType >( std::ceil( padding ) ) + 1;
+    const IndexValueType regionUpper = regionLower[d] + static_cast< IndexValueType >( region.GetSize()[d] ) - 1;
+
+    lower[d] = std::max( lower[d] - pad, regionLower[d] );
+    upper[d] = std::min( upper[d] + pad, regionUpper );
+    }
+
+  typename OutputImageRegionType::SizeType size;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    size[d] = static_cast< SizeValueType >( upper[d] - lower[d] + 1 );
+    }
+  bandRegion.SetIndex( lower );
+  bandRegion.SetSize( size );
+  return true;
+}
+
+//
+// GenerateData
+//
+template< typename TInputImage, typename TOutputImage >
+void
+BandedSignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
+::GenerateData()
+{
+  this->m_BandUsed = this->m_MaximumDistance > 0.0;
+  if ( !this->m_BandUsed )
+    {
+    this->m_BandRegion = this->GetOutput()->GetRequestedRegion();
+    Superclass::GenerateData();
+    return;
+    }
+
+  this->AllocateOutputs();
+
+  const InputImageType *input = this->GetInput();
+  OutputImageType *output = this->GetOutput();
+  const OutputImageRegionType region = output->GetRequestedRegion();
+
+  // the clamped distances of the object and of the background
+  double limit = this->m_MaximumDistance;
+  if ( this->GetSquaredDistance() )
+    {
+    limit *= this->m_MaximumDistance;
+    }
+  OutputPixelType outsideValue = static_cast< OutputPixelType >( limit );
+  OutputPixelType insideValue = static_cast< OutputPixelType >( -limit );
+  if ( this->GetInsideIsPositive() )
+    {
+    std::swap( outsideValue, insideValue );
+    }
+
+  output->FillBuffer( outsideValue );
+
+  if ( !this->ComputeBandRegion( input, region, this->m_BandRegion ) )
+    {
+    this->m_BandRegion = OutputImageRegionType();
+    return;
+    }
+
+  typedef RegionOfInterestImageFilter< InputImageType, InputImageType > CropFilterType;
+  typedef SignedMaurerDistanceMapImageFilter< InputImageType, OutputImageType > DistanceFilterType;
+
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter( this );
+
+  // Create an internal image to protect the input image's metadata
+  typename InputImageType::Pointer localInput = InputImageType::New();
+  localInput->Graft( input );
+
+  typename CropFilterType::Pointer cropFilter = CropFilterType::New();
+  cropFilter->SetInput( localInput );
+  cropFilter->SetRegionOfInterest( this->m_BandRegion );
+  cropFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+  cropFilter->ReleaseDataFlagOn();
+  progress->RegisterInternalFilter( cropFilter, 0.1f );
+
+  typename DistanceFilterType::Pointer distanceFilter = DistanceFilterType::New();
+  distanceFilter->SetInput( cropFilter->GetOutput() );
+  distanceFilter->SetBackgroundValue( this->GetBackgroundValue() );
+  distanceFilter->SetInsideIsPositive( this->GetInsideIsPositive() );
+  distanceFilter->SetSquaredDistance( this->GetSquaredDistance() );
+  distanceFilter->SetUseImageSpacing( this->GetUseImageSpacing() );
+  distanceFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+  progress->RegisterInternalFilter( distanceFilter, 0.9f );
+  distanceFilter->Update();
+
+  // the output of the crop starts at the index 0
+  const OutputImageType *band = distanceFilter->GetOutput();
+  ImageRegionConstIterator< OutputImageType > bandIt( band, band->GetLargestPossibleRegion() );
+  ImageRegionIterator< OutputImageType > outIt( output, this->m_BandRegion );
+  const OutputPixelType upperValue = std::max( outsideValue, insideValue );
+  const OutputPixelType lowerValue = std::min( outsideValue, insideValue );
+  while ( !outIt.IsAtEnd() )
+    {
+    outIt.Set( std::min( std::max( bandIt.Get(), lowerValue ), upperValue ) );
+    ++bandIt;
+    ++outIt;
+    }
+}
+
+//
+// PrintSelf
+//
+template< typename TInputImage, typename TOutputImage >
+void
+BandedSignedMaurerDistanceMapImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "MaximumDistance: " << this->m_MaximumDistance << std::endl;
+  os << indent << "BandUsed: " << this->m_BandUsed << std::endl;
+  os << indent << "BandRegion: " << this->m_BandRegion << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkBandedSignedMaurerDistanceMapImageFilter_hxx
@@ -0,0 +1,136 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkBlendPasteImageFilter_h
+#define itkBlendPasteImageFilter_h
+
+#include "itkPasteImageFilter.h"
+
+#include <complex>
+
+namespace itk {
+
+/** \class BlendPasteImageFilter
+ * \brief A PasteImageFilter which may blend the source with the
+ * destination instead of replacing it.
+ *
+ * With the Replace blend mode, the default, this filter is the
+ * PasteImageFilter. The Maximum mode keeps the maximum of the source
+ * and destination components, and the Add mode adds the source
+ * components multiplied by the SourceWeight to the destination.
+ *
+ * A weighted average of overlapping patches, as for a sliding window,
+ * is the division of two images each built with the Add mode: one
+ * with the patches and their weights, and one with the weights
+ * pasted from constant images.
+ *
+ * When run in-place, only the pasted region of the destination
+ * buffer is visited, so a small patch is pasted in a time
+ * proportional to its size. The Maximum mode is not for complex
+ * pixels.
+ */
+template< typename TInputImage, typename TSourceImage = TInputImage, typename TOutputImage = TInputImage >
+class BlendPasteImageFilter:
+    public PasteImageFilter< TInputImage, TSourceImage, TOutputImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef BlendPasteImageFilter                                      Self;
+  typedef PasteImageFilter< TInputImage, TSourceImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                                       Pointer;
+  typedef SmartPointer< const Self >                                 ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(BlendPasteImageFilter, PasteImageFilter);
+
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::SourceImageType       SourceImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename OutputImageType::InternalPixelType ComponentType;
+
+  typedef enum { Replace, Maximum, Add } BlendModeType;
+
+  /** Set/Get how the source is combined with the destination */
+  itkSetMacro(BlendMode, BlendModeType);
+  itkGetConstMacro(BlendMode, BlendModeType);
+
+  /** Set/Get the factor of the source components of the Add mode */
+  itkSetMacro(SourceWeight, double);
+  itkGetConstMacro(SourceWeight, double);
+
+protected:
+
+  BlendPasteImageFilter();
+
+  // virtual ~BlendPasteImageFilter(); // implementation not needed
+
+  virtual void PrintSelf( std::ostream & os, Indent indent ) const ITK_OVERRIDE;
+
+  virtual void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                                     ThreadIdType threadId ) ITK_OVERRIDE;
+
+private:
+  BlendPasteImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  // Blend n contiguous components of the source into the output
+  void BlendComponents( const ComponentType *source,
+                        ComponentType *output,
+                        SizeValueType n ) const;
+
+  template< typename T >
+  static void BlendMaximum( T & output, const T & source )
+    {
+    if ( output < source )
+      {
+      output = source;
+      }
+    }
+  template< typename T >
+  static void BlendMaximum( std::complex< T > &, const std::complex< T > & )
+    {
+    // not ordered, rejected by BeforeThreadedGenerateData
+    }
+
+  template< typename T >
+  static void BlendAdd( T & output, const T & source, double weight )
+    {
+    output = static_cast< T >( output + weight * source );
+    }
+  template< typename T >
+  static void BlendAdd( std::complex< T > & output, const std::complex< T > & source, double weight )
+    {
+    output += static_cast< T >( weight ) * source;
+    }
+
+  BlendModeType m_BlendMode;
+  double        m_SourceWeight;
+};
+
+
+} // end namespace itk
+
+
+#include "itkBlendPasteImageFilter.hxx"
+
+#endif // itkBlendPasteImageFilter_h
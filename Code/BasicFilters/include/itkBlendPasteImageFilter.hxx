@@ -0,0 +1,165 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkBlendPasteImageFilter_hxx
+#define itkBlendPasteImageFilter_hxx
+
+#include "itkBlendPasteImageFilter.h"
+
+#include "itkImageAlgorithm.h"
+#include "itkImageScanlineIterator.h"
+
+#include <limits>
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TInputImage, typename TSourceImage, typename TOutputImage >
+BlendPasteImageFilter< TInputImage, TSourceImage, TOutputImage >
+::BlendPasteImageFilter()
+  : m_BlendMode( Replace ),
+    m_SourceWeight( 1.0 )
+{
+}
+
+//
+// PrintSelf
+//
+template< typename TInputImage, typename TSourceImage, typename TOutputImage >
+void
+BlendPasteImageFilter< TInputImage, TSourceImage, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "BlendMode: " << static_cast< int >( m_BlendMode ) << std::endl;
+  os << indent << "SourceWeight: " << m_SourceWeight << std::endl;
+}
+
+//
+// BeforeThreadedGenerateData
+//
+template< typename TInputImage, typename TSourceImage, typename TOutputImage >
+void
+BlendPasteImageFilter< TInputImage, TSourceImage, TOutputImage >
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  // std::numeric_limits is not specialized for the complex numbers
+  if ( m_BlendMode == Maximum && !std::numeric_limits< ComponentType >::is_specialized )
+    {
+    itkExceptionMacro( "The Maximum blend mode is not for complex pixels!" );
+    }
+}
+
+//
+// BlendComponents
+//
+template< typename TInputImage, typename TSourceImage, typename TOutputImage >
+void
+BlendPasteImageFilter< TInputImage, TSourceImage, TOutputImage >
+::BlendComponents( const ComponentType *source,
+                   ComponentType *output,
+                   SizeValueType n ) const
+{
+  if ( m_BlendMode == Maximum )
+    {
+    for ( SizeValueType i = 0; i < n; ++i )
+      {
+      BlendMaximum( output[i], source[i] );
+      }
+    }
+  else
+    {
+    const double weight = m_SourceWeight;
+    for ( SizeValueType i = 0; i < n; ++i )
+      {
+      BlendAdd( output[i], source[i], weight );
+      }
+    }
+}
+
+//
+// ThreadedGenerateData
+//
+template< typename TInputImage, typename TSourceImage, typename TOutputImage >
+void
+BlendPasteImageFilter< TInputImage, TSourceImage, TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        ThreadIdType threadId )
+{
+  if ( m_BlendMode == Replace )
+    {
+    Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+    return;
+    }
+
+  const TInputImage *destinationPtr = this->GetDestinationImage();
+  const SourceImageType *sourcePtr = this->GetSourceImage();
+  OutputImageType *outputPtr = this->GetOutput();
+
+  // the output is the destination unless running in-place
+  if ( !( this->GetInPlace() && this->CanRunInPlace() ) )
+    {
+    ImageAlgorithm::Copy( destinationPtr, outputPtr, outputRegionForThread, outputRegionForThread );
+    }
+
+  // the part of the pasted region generated by this thread
+  const typename SourceImageType::RegionType sourceRegion = this->GetSourceRegion();
+  const typename OutputImageType::IndexType destinationIndex = this->GetDestinationIndex();
+  OutputImageRegionType pasteRegion( destinationIndex, sourceRegion.GetSize() );
+  if ( !pasteRegion.Crop( outputRegionForThread ) )
+    {
+    return;
+    }
+
+  typename SourceImageType::RegionType sourceRegionForThread( pasteRegion.GetSize() );
+  typename SourceImageType::IndexType sourceIndex;
+  for ( unsigned int d = 0; d < OutputImageType::ImageDimension; ++d )
+    {
+    sourceIndex[d] = sourceRegion.GetIndex()[d] + pasteRegion.GetIndex()[d] - destinationIndex[d];
+    }
+  sourceRegionForThread.SetIndex( sourceIndex );
+
+  // blend one scanline of components at a time, the components of
+  // the pixels of a line being contiguous in both buffers
+  const SizeValueType numberOfComponents = outputPtr->GetNumberOfComponentsPerPixel();
+  const SizeValueType lineComponents = pasteRegion.GetSize( 0 ) * numberOfComponents;
+  const ComponentType *sourceBuffer = sourcePtr->GetBufferPointer();
+  ComponentType *outputBuffer = outputPtr->GetBufferPointer();
+
+  ImageScanlineConstIterator< SourceImageType > it( sourcePtr, sourceRegionForThread );
+  while ( !it.IsAtEnd() )
+    {
+    const typename SourceImageType::IndexType index = it.GetIndex();
+    typename OutputImageType::IndexType outputIndex;
+    for ( unsigned int d = 0; d < OutputImageType::ImageDimension; ++d )
+      {
+      outputIndex[d] = index[d] - sourceIndex[d] + pasteRegion.GetIndex()[d];
+      }
+    this->BlendComponents( sourceBuffer + sourcePtr->ComputeOffset( index ) * numberOfComponents,
+                           outputBuffer + outputPtr->ComputeOffset( outputIndex ) * numberOfComponents,
+                           lineComponents );
+    it.NextLine();
+    }
+}
+
+} // end namespace itk
+
+#endif // itkBlendPasteImageFilter_hxx
@@ -0,0 +1,95 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkBlockedPermuteAxesImageFilter_h
+#define itkBlockedPermuteAxesImageFilter_h
+
+#include "itkPermuteAxesImageFilter.h"
+
+namespace itk {
+
+/** \class BlockedPermuteAxesImageFilter
+ * \brief A PermuteAxesImageFilter copying the pixel buffers in
+ * cache sized blocks.
+ *
+ * The PermuteAxesImageFilter visits the output pixels in order and
+ * reads the input with the stride of the permuted axis, so each
+ * output pixel of a large volume loads a new cache line of the
+ * input.
+ *
+ * When the first output axis is the first input axis, each output
+ * scanline is a contiguous input scanline, and is copied as one
+ * block. Otherwise the plane of the first output axis and the output
+ * axis of the first input axis is transposed in square blocks, small
+ * enough that the input lines of a block stay in the cache while the
+ * output lines are written.
+ *
+ * The components of the pixels are copied, so the output is the one
+ * of the PermuteAxesImageFilter for any pixel type.
+ */
+template< typename TImage >
+class BlockedPermuteAxesImageFilter:
+    public PermuteAxesImageFilter< TImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef BlockedPermuteAxesImageFilter    Self;
+  typedef PermuteAxesImageFilter< TImage > Superclass;
+  typedef SmartPointer< Self >             Pointer;
+  typedef SmartPointer< const Self >       ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(BlockedPermuteAxesImageFilter, PermuteAxesImageFilter);
+
+  typedef typename Superclass::InputImageType        InputImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename TImage::InternalPixelType         ComponentType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TImage::ImageDimension);
+
+  /** The number of pixels along each side of a transposed block */
+  itkStaticConstMacro(BlockSize, SizeValueType, 32);
+
+protected:
+
+  BlockedPermuteAxesImageFilter() {}
+
+  // virtual ~BlockedPermuteAxesImageFilter(); // implementation not needed
+
+  // See superclass for doxygen documentation
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                                     ThreadIdType threadId ) ITK_OVERRIDE;
+
+private:
+  BlockedPermuteAxesImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  // The input index of an output index
+  typename InputImageType::IndexType InputIndex( const typename OutputImageType::IndexType & outputIndex ) const;
+};
+
+
+} // end namespace itk
+
+
+#include "itkBlockedPermuteAxesImageFilter.hxx"
+
+#endif // itkBlockedPermuteAxesImageFilter_h
@@ -0,0 +1,124 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkBlockedPermuteAxesImageFilter_hxx
+#define itkBlockedPermuteAxesImageFilter_hxx
+
+#include "itkBlockedPermuteAxesImageFilter.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+
+namespace itk {
+
+//
+// InputIndex
+//
+template< typename TImage >
+typename BlockedPermuteAxesImageFilter< TImage >::InputImageType::IndexType
+BlockedPermuteAxesImageFilter< TImage >
+::InputIndex( const typename OutputImageType::IndexType & outputIndex ) const
+{
+  typename InputImageType::IndexType inputIndex;
+  for ( unsigned int j = 0; j < ImageDimension; ++j )
+    {
+    inputIndex[j] = outputIndex[this->GetInverseOrder()[j]];
+    }
+  return inputIndex;
+}
+
+//
+// ThreadedGenerateData
+//
+template< typename TImage >
+void
+BlockedPermuteAxesImageFilter< TImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        ThreadIdType threadId )
+{
+  const InputImageType *inputPtr = this->GetInput();
+  OutputImageType *outputPtr = this->GetOutput();
+
+  if ( outputRegionForThread.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  const SizeValueType numberOfComponents = inputPtr->GetNumberOfComponentsPerPixel();
+  const ComponentType *inputBuffer = inputPtr->GetBufferPointer();
+  ComponentType *outputBuffer = outputPtr->GetBufferPointer();
+
+  // the output axis along the input scanlines, and the input stride
+  // along the output scanlines
+  const unsigned int transposedAxis = this->GetInverseOrder()[0];
+  const OffsetValueType inputStride = inputPtr->GetOffsetTable()[this->GetOrder()[0]];
+  const OffsetValueType outputStride = outputPtr->GetOffsetTable()[transposedAxis];
+
+  // the region of the first pixel of each transposed plane, or of
+  // each scanline when the first axis is not permuted
+  OutputImageRegionType planeRegion = outputRegionForThread;
+  planeRegion.SetSize( 0, 1 );
+  planeRegion.SetSize( transposedAxis, 1 );
+
+  const SizeValueType lineSize = outputRegionForThread.GetSize( 0 );
+  const SizeValueType planeLines = outputRegionForThread.GetSize( transposedAxis );
+
+  ProgressReporter progress( this, threadId, planeRegion.GetNumberOfPixels() );
+
+  ImageRegionConstIteratorWithIndex< OutputImageType > it( outputPtr, planeRegion );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const typename OutputImageType::IndexType outputIndex = it.GetIndex();
+    const ComponentType *in = inputBuffer + inputPtr->ComputeOffset( this->InputIndex( outputIndex ) ) * numberOfComponents;
+    ComponentType *out = outputBuffer + outputPtr->ComputeOffset( outputIndex ) * numberOfComponents;
+
+    if ( transposedAxis == 0 )
+      {
+      std::copy( in, in + lineSize * numberOfComponents, out );
+      progress.CompletedPixel();
+      continue;
+      }
+
+    // transpose the plane one block at a time, the output pixels of
+    // a block line read one pixel of each input line of the block
+    for ( SizeValueType lineStart = 0; lineStart < planeLines; lineStart += BlockSize )
+      {
+      const SizeValueType lineEnd = std::min( lineStart + BlockSize, planeLines );
+      for ( SizeValueType pixelStart = 0; pixelStart < lineSize; pixelStart += BlockSize )
+        {
+        const SizeValueType pixelEnd = std::min( pixelStart + BlockSize, lineSize );
+        for ( SizeValueType l = lineStart; l < lineEnd; ++l )
+          {
+          ComponentType *outLine = out + l * outputStride * numberOfComponents;
+          const ComponentType *inLine = in + l * numberOfComponents;
+          for ( SizeValueType p = pixelStart; p < pixelEnd; ++p )
+            {
+            const ComponentType *inPixel = inLine + p * inputStride * numberOfComponents;
+            std::copy( inPixel, inPixel + numberOfComponents, outLine + p * numberOfComponents );
+            }
+          }
+        }
+      }
+    progress.CompletedPixel();
+    }
+}
+
+} // end namespace itk
+
+#endif // itkBlockedPermuteAxesImageFilter_hxx
@@ -0,0 +1,97 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkContiguousCastImageFilter_h
+#define itkContiguousCastImageFilter_h
+
+#include "itkCastImageFilter.h"
+
+namespace itk {
+
+/** \class ContiguousCastImageFilter
+ * \brief A CastImageFilter with a fast path for the pixel buffers of
+ * scalar components.
+ *
+ * When the components of the input and output pixels are both
+ * integer or real numbers, as for the scalar images and the
+ * VectorImages, the components of each scanline are contiguous in
+ * both buffers. They are converted with a plain loop over the
+ * buffers, which the compiler vectorizes, instead of calling the
+ * functor for each pixel. The VectorImages avoid the construction
+ * of a VariableLengthVector for each pixel.
+ *
+ * The components are converted with a static_cast, as the
+ * CastImageFilter does, so the results are the same. Any other pixel
+ * type, such as complex numbers or fixed length vectors, uses the
+ * CastImageFilter.
+ */
+template< typename TInputImage, typename TOutputImage >
+class ContiguousCastImageFilter:
+    public CastImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef ContiguousCastImageFilter                    Self;
+  typedef CastImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                         Pointer;
+  typedef SmartPointer< const Self >                   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ContiguousCastImageFilter, CastImageFilter);
+
+  typedef typename Superclass::InputImageType        InputImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename InputImageType::InternalPixelType  InputComponentType;
+  typedef typename OutputImageType::InternalPixelType OutputComponentType;
+
+  /** True when the components of the input and output pixels are
+   * integer or real numbers, which are converted by the fast
+   * path. */
+  static bool IsContiguousCastSupported();
+
+protected:
+
+  ContiguousCastImageFilter() {}
+
+  // virtual ~ContiguousCastImageFilter(); // implementation not needed
+
+  // See superclass for doxygen documentation
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                                     ThreadIdType threadId ) ITK_OVERRIDE;
+
+private:
+  ContiguousCastImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  // Convert n contiguous components, kept out of line of the
+  // iteration so the loop is vectorized.
+  static void CastComponents( const InputComponentType *input,
+                              OutputComponentType *output,
+                              SizeValueType n );
+};
+
+
+} // end namespace itk
+
+
+#include "itkContiguousCastImageFilter.hxx"
+
+#endif // itkContiguousCastImageFilter_h
@@ -0,0 +1,106 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkContiguousCastImageFilter_hxx
+#define itkContiguousCastImageFilter_hxx
+
+#include "itkContiguousCastImageFilter.h"
+
+#include "itkImageScanlineIterator.h"
+#include "itkProgressReporter.h"
+
+#include <limits>
+
+namespace itk {
+
+//
+// IsContiguousCastSupported
+//
+template< typename TInputImage, typename TOutputImage >
+bool
+ContiguousCastImageFilter< TInputImage, TOutputImage >
+::IsContiguousCastSupported()
+{
+  // std::numeric_limits is not specialized for the complex numbers
+  // nor the vectors
+  return std::numeric_limits< InputComponentType >::is_specialized
+    && std::numeric_limits< OutputComponentType >::is_specialized;
+}
+
+//
+// CastComponents
+//
+template< typename TInputImage, typename TOutputImage >
+void
+ContiguousCastImageFilter< TInputImage, TOutputImage >
+::CastComponents( const InputComponentType *input,
+                  OutputComponentType *output,
+                  SizeValueType n )
+{
+  for ( SizeValueType i = 0; i < n; ++i )
+    {
+    output[i] = static_cast< OutputComponentType >( input[i] );
+    }
+}
+
+//
+// ThreadedGenerateData
+//
+template< typename TInputImage, typename TOutputImage >
+void
+ContiguousCastImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        ThreadIdType threadId )
+{
+  const InputImageType *inputPtr = this->GetInput();
+  OutputImageType *outputPtr = this->GetOutput( 0 );
+
+  const unsigned int numberOfComponents = inputPtr->GetNumberOfComponentsPerPixel();
+  if ( !IsContiguousCastSupported()
+       || outputPtr->GetNumberOfComponentsPerPixel() != numberOfComponents
+       || outputRegionForThread.GetNumberOfPixels() == 0 )
+    {
+    Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+    return;
+    }
+
+  // the output region is the input region, both are in the buffers
+  const SizeValueType lineComponents = outputRegionForThread.GetSize( 0 ) * numberOfComponents;
+  const InputComponentType *inputBuffer =
+    reinterpret_cast< const InputComponentType * >( inputPtr->GetBufferPointer() );
+  OutputComponentType *outputBuffer =
+    reinterpret_cast< OutputComponentType * >( outputPtr->GetBufferPointer() );
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize( 0 ) );
+
+  ImageScanlineIterator< OutputImageType > outIt( outputPtr, outputRegionForThread );
+  while ( !outIt.IsAtEnd() )
+    {
+    const typename OutputImageType::IndexType index = outIt.GetIndex();
+
+    CastComponents( inputBuffer + inputPtr->ComputeOffset( index ) * numberOfComponents,
+                    outputBuffer + outputPtr->ComputeOffset( index ) * numberOfComponents,
+                    lineComponents );
+
+    outIt.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+} // end namespace itk
+
+#endif // itkContiguousCastImageFilter_hxx
@@ -0,0 +1,151 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkCroppedHausdorffDistanceImageFilter_h
+#define itkCroppedHausdorffDistanceImageFilter_h
+
+#include "itkHausdorffDistanceImageFilter.h"
+#include "itkProgressAccumulator.h"
+
+namespace itk {
+
+/** \class CroppedHausdorffDistanceImageFilter
+ * \brief A HausdorffDistanceImageFilter which computes the distance
+ * maps in the bounding box of the objects, with overlap measures.
+ *
+ * The HausdorffDistanceImageFilter computes a distance map of the
+ * whole extent of each input, while only the distances at the
+ * non-zero pixels of the other input are used. When UseBoundingBox is
+ * on, both inputs are scanned once for the bounding box of the union
+ * of their non-zero pixels, and the distance maps are only computed in
+ * this box, grown by one pixel. The nearest non-zero pixel of each
+ * non-zero pixel is inside of the box, so the distances are the same.
+ *
+ * The same scan counts the non-zero pixels of each input and of their
+ * intersection, which give the Dice and Jaccard coefficients, and the
+ * distance maps give the average distance between the surfaces, the
+ * non-zero pixels with a zero neighbor. The AverageSurfaceDistance is
+ * the mean of the distances of the surface pixels of both inputs to
+ * the surface of the other input.
+ *
+ * When MaximumDistance is greater than zero, the distance maps are
+ * computed by the BandedSignedMaurerDistanceMapImageFilter, only in a
+ * band around each object. The distances are then clamped to
+ * MaximumDistance, which is a lower bound of the Hausdorff distance
+ * when it is reached.
+ *
+ * When one of the inputs has no non-zero pixel, or UseBoundingBox is
+ * off, the distances are computed by the superclass, and the
+ * AverageSurfaceDistance is the HausdorffDistance. The Dice and
+ * Jaccard coefficients are 1 when both inputs have no non-zero
+ * pixel.
+ *
+ * \sa BandedSignedMaurerDistanceMapImageFilter
+ */
+template< typename TInputImage1, typename TInputImage2 >
+class CroppedHausdorffDistanceImageFilter:
+    public HausdorffDistanceImageFilter< TInputImage1, TInputImage2 >
+{
+public:
+  /** Standard Self typedef */
+  typedef CroppedHausdorffDistanceImageFilter Self;
+  typedef HausdorffDistanceImageFilter< TInputImage1, TInputImage2 > Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(CroppedHausdorffDistanceImageFilter, HausdorffDistanceImageFilter);
+
+  typedef TInputImage1                       InputImage1Type;
+  typedef TInputImage2                       InputImage2Type;
+  typedef typename Superclass::RealType      RealType;
+  typedef typename TInputImage1::RegionType  RegionType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage1::ImageDimension);
+
+  /** Enable or disable the bounding box, on by default. */
+  itkSetMacro( UseBoundingBox, bool );
+  itkGetConstMacro( UseBoundingBox, bool );
+  itkBooleanMacro( UseBoundingBox );
+
+  /** Get if the last execution computed the distances in the
+   * bounding box. */
+  itkGetConstMacro( BoundingBoxUsed, bool );
+
+  /** The width of the band around each object where the distances
+   * are computed. The default of 0 computes the exact distances. */
+  itkSetMacro( MaximumDistance, double );
+  itkGetConstMacro( MaximumDistance, double );
+
+  /** The measurements of the last execution. */
+  itkGetConstMacro( HausdorffDistance, RealType );
+  itkGetConstMacro( AverageHausdorffDistance, RealType );
+  itkGetConstMacro( AverageSurfaceDistance, RealType );
+  itkGetConstMacro( DiceCoefficient, RealType );
+  itkGetConstMacro( JaccardCoefficient, RealType );
+
+protected:
+
+  CroppedHausdorffDistanceImageFilter();
+
+  // virtual ~CroppedHausdorffDistanceImageFilter(); // implementation not needed
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void GenerateData() ITK_OVERRIDE;
+
+private:
+  CroppedHausdorffDistanceImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  // Count the non-zero pixels of both inputs and of their
+  // intersection, and compute the bounding box of their union. Returns
+  // false if one of the inputs has no non-zero pixel.
+  bool ScanInputs( const RegionType &region,
+                   SizeValueType &count1,
+                   SizeValueType &count2,
+                   SizeValueType &intersection,
+                   RegionType &boundingBox ) const;
+
+  // Compute the distance map of the non-zero pixels of an input in a
+  // region.
+  template< typename TImage, typename TDistanceMap >
+  typename TDistanceMap::Pointer ComputeDistanceMap( const TImage *input,
+                                                     const RegionType &region,
+                                                     ProgressAccumulator *progress ) const;
+
+  bool     m_UseBoundingBox;
+  bool     m_BoundingBoxUsed;
+  double   m_MaximumDistance;
+  RealType m_HausdorffDistance;
+  RealType m_AverageHausdorffDistance;
+  RealType m_AverageSurfaceDistance;
+  RealType m_DiceCoefficient;
+  RealType m_JaccardCoefficient;
+};
+
+
+} // end namespace itk
+
+
+#include "itkCroppedHausdorffDistanceImageFilter.hxx"
+
+#endif // itkCroppedHausdorffDistanceImageFilter_h
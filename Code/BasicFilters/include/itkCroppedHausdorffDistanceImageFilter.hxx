@@ -0,0 +1,283 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkCroppedHausdorffDistanceImageFilter_hxx
+#define itkCroppedHausdorffDistanceImageFilter_hxx
+
+#include "itkCroppedHausdorffDistanceImageFilter.h"
+
+#include "itkBandedSignedMaurerDistanceMapImageFilter.h"
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkImageScanlineConstIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TInputImage1, typename TInputImage2 >
+CroppedHausdorffDistanceImageFilter< TInputImage1, TInputImage2 >
+::CroppedHausdorffDistanceImageFilter()
+  : m_UseBoundingBox( true ),
+    m_BoundingBoxUsed( false ),
+    m_MaximumDistance( 0.0 ),
+    m_HausdorffDistance( NumericTraits< RealType >::ZeroValue() ),
+    m_AverageHausdorffDistance( NumericTraits< RealType >::ZeroValue() ),
+    m_AverageSurfaceDistance( NumericTraits< RealType >::ZeroValue() ),
+    m_DiceCoefficient( NumericTraits< RealType >::ZeroValue() ),
+    m_JaccardCoefficient( NumericTraits< RealType >::ZeroValue() )
+{
+}
+
+//
+// ScanInputs
+//
+template< typename TInputImage1, typename TInputImage2 >
+bool
+CroppedHausdorffDistanceImageFilter< TInputImage1, TInputImage2 >
+::ScanInputs( const RegionType &region,
+              SizeValueType &count1,
+              SizeValueType &count2,
+              SizeValueType &intersection,
+              RegionType &boundingBox ) const
+{
+  typedef typename RegionType::IndexType IndexType;
+
+  count1 = 0;
+  count2 = 0;
+  intersection = 0;
+
+  IndexType lower;
+  IndexType upper;
+  bool found = false;
+
+  ImageScanlineConstIterator< InputImage1Type > it1( this->GetInput1(), region );
+  ImageScanlineConstIterator< InputImage2Type > it2( this->GetInput2(), region );
+  while ( !it1.IsAtEnd() )
+    {
+    while ( !it1.IsAtEndOfLine() )
+      {
+      const bool inside1 = it1.Get() != NumericTraits< typename InputImage1Type::PixelType >::ZeroValue();
+      const bool inside2 = it2.Get() != NumericTraits< typename InputImage2Type::PixelType >::ZeroValue();
+      if ( inside1 || inside2 )
+        {
+        count1 += inside1;
+        count2 += inside2;
+        intersection += inside1 && inside2;
+
+        const IndexType index = it1.GetIndex();
+        if ( !found )
+          {
+          lower = index;
+          upper = index;
+          found = true;
+          }
+        for ( unsigned int d = 0; d < ImageDimension; ++d )
+          {
+          lower[d] = std::min( lower[d], index[d] );
+          upper[d] = std::max( upper[d], index[d] );
+          }
+        }
+      ++it1;
+      ++it2;
+      }
+    it1.NextLine();
+    it2.NextLine();
+    }
+
+  if ( count1 == 0 || count2 == 0 )
+    {
+    return false;
+    }
+
+  // grow the box by one pixel for the surfaces of the objects
+  const IndexType regionLower = region.GetIndex();
+  typename RegionType::SizeType size;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    const IndexValueType regionUpper = regionLower[d] + static_cast< IndexValueType >( region.GetSize()[d] ) - 1;
+    lower[d] = std::max( lower[d] - 1, regionLower[d] );
+    upper[d] = std::min( upper[d] + 1, regionUpper );
+    size[d] = static_cast< SizeValueType >( upper[d] - lower[d] + 1 );
+    }
+  boundingBox.SetIndex( lower );
+  boundingBox.SetSize( size );
+  return true;
+}
+
+//
+// ComputeDistanceMap
+//
+template< typename TInputImage1, typename TInputImage2 >
+template< typename TImage, typename TDistanceMap >
+typename TDistanceMap::Pointer
+CroppedHausdorffDistanceImageFilter< TInputImage1, TInputImage2 >
+::ComputeDistanceMap( const TImage *input,
+                      const RegionType &region,
+                      ProgressAccumulator *progress ) const
+{
+  typedef RegionOfInterestImageFilter< TImage, TImage >                     CropFilterType;
+  typedef BandedSignedMaurerDistanceMapImageFilter< TImage, TDistanceMap > DistanceFilterType;
+
+  // Create an internal image to protect the input image's metadata
+  typename TImage::Pointer localInput = TImage::New();
+  localInput->Graft( input );
+
+  typename CropFilterType::Pointer cropFilter = CropFilterType::New();
+  cropFilter->SetInput( localInput );
+  cropFilter->SetRegionOfInterest( region );
+  cropFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+  cropFilter->ReleaseDataFlagOn();
+  progress->RegisterInternalFilter( cropFilter, 0.05f );
+
+  typename DistanceFilterType::Pointer distanceFilter = DistanceFilterType::New();
+  distanceFilter->SetInput( cropFilter->GetOutput() );
+  distanceFilter->SetInsideIsPositive( false );
+  distanceFilter->SetSquaredDistance( false );
+  distanceFilter->SetUseImageSpacing( this->GetUseImageSpacing() );
+  distanceFilter->SetMaximumDistance( this->m_MaximumDistance );
+  distanceFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+  progress->RegisterInternalFilter( distanceFilter, 0.4f );
+  distanceFilter->Update();
+
+  return distanceFilter->GetOutput();
+}
+
+//
+// GenerateData
+//
+template< typename TInputImage1, typename TInputImage2 >
+void
+CroppedHausdorffDistanceImageFilter< TInputImage1, TInputImage2 >
+::GenerateData()
+{
+  const RegionType region = this->GetInput1()->GetRequestedRegion();
+
+  SizeValueType count1;
+  SizeValueType count2;
+  SizeValueType intersection;
+  RegionType    boundingBox;
+  const bool found = this->ScanInputs( region, count1, count2, intersection, boundingBox );
+
+  const SizeValueType unionCount = count1 + count2 - intersection;
+  this->m_DiceCoefficient = NumericTraits< RealType >::OneValue();
+  this->m_JaccardCoefficient = NumericTraits< RealType >::OneValue();
+  if ( unionCount > 0 )
+    {
+    this->m_DiceCoefficient = static_cast< RealType >( 2.0 * intersection / ( count1 + count2 ) );
+    this->m_JaccardCoefficient = static_cast< RealType >( static_cast< double >( intersection ) / unionCount );
+    }
+
+  this->m_BoundingBoxUsed = this->m_UseBoundingBox && found;
+  if ( !this->m_BoundingBoxUsed )
+    {
+    Superclass::GenerateData();
+    this->m_HausdorffDistance = Superclass::GetHausdorffDistance();
+    this->m_AverageHausdorffDistance = Superclass::GetAverageHausdorffDistance();
+    this->m_AverageSurfaceDistance = this->m_HausdorffDistance;
+    return;
+    }
+
+  // Pass the first input through as the output
+  this->GraftOutput( const_cast< InputImage1Type * >( this->GetInput1() ) );
+
+  typedef Image< RealType, ImageDimension > DistanceMapType;
+
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter( this );
+
+  typename DistanceMapType::Pointer distance1 =
+    this->template ComputeDistanceMap< InputImage1Type, DistanceMapType >( this->GetInput1(), boundingBox, progress );
+  typename DistanceMapType::Pointer distance2 =
+    this->template ComputeDistanceMap< InputImage2Type, DistanceMapType >( this->GetInput2(), boundingBox, progress );
+
+  // The distance maps are negative inside of the objects, and zero on
+  // their surfaces.
+  const RealType zero = NumericTraits< RealType >::ZeroValue();
+  RealType maximum12 = zero;
+  RealType maximum21 = zero;
+  RealType sum12 = zero;
+  RealType sum21 = zero;
+  RealType surfaceSum = zero;
+  SizeValueType surfaceCount = 0;
+
+  ImageRegionConstIterator< InputImage1Type > it1( this->GetInput1(), boundingBox );
+  ImageRegionConstIterator< InputImage2Type > it2( this->GetInput2(), boundingBox );
+  ImageRegionConstIterator< DistanceMapType > dIt1( distance1, distance1->GetLargestPossibleRegion() );
+  ImageRegionConstIterator< DistanceMapType > dIt2( distance2, distance2->GetLargestPossibleRegion() );
+  while ( !it1.IsAtEnd() )
+    {
+    const RealType d1 = dIt1.Get();
+    const RealType d2 = dIt2.Get();
+    if ( it1.Get() != NumericTraits< typename InputImage1Type::PixelType >::ZeroValue() )
+      {
+      const RealType d = std::max( d2, zero );
+      maximum12 = std::max( maximum12, d );
+      sum12 += d;
+      if ( d1 == zero )
+        {
+        surfaceSum += std::abs( d2 );
+        ++surfaceCount;
+        }
+      }
+    if ( it2.Get() != NumericTraits< typename InputImage2Type::PixelType >::ZeroValue() )
+      {
+      const RealType d = std::max( d1, zero );
+      maximum21 = std::max( maximum21, d );
+      sum21 += d;
+      if ( d2 == zero )
+        {
+        surfaceSum += std::abs( d1 );
+        ++surfaceCount;
+        }
+      }
+    ++it1;
+    ++it2;
+    ++dIt1;
+    ++dIt2;
+    }
+
+  this->m_HausdorffDistance = std::max( maximum12, maximum21 );
+  this->m_AverageHausdorffDistance = ( sum12 / count1 + sum21 / count2 ) / 2.0;
+  this->m_AverageSurfaceDistance = surfaceCount > 0 ? surfaceSum / surfaceCount : zero;
+}
+
+//
+// PrintSelf
+//
+template< typename TInputImage1, typename TInputImage2 >
+void
+CroppedHausdorffDistanceImageFilter< TInputImage1, TInputImage2 >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "UseBoundingBox: " << this->m_UseBoundingBox << std::endl;
+  os << indent << "BoundingBoxUsed: " << this->m_BoundingBoxUsed << std::endl;
+  os << indent << "MaximumDistance: " << this->m_MaximumDistance << std::endl;
+  os << indent << "AverageSurfaceDistance: " << this->m_AverageSurfaceDistance << std::endl;
+  os << indent << "DiceCoefficient: " << this->m_DiceCoefficient << std::endl;
+  os << indent << "JaccardCoefficient: " << this->m_JaccardCoefficient << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkCroppedHausdorffDistanceImageFilter_hxx
@@ -0,0 +1,95 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkGPUHostImageFilter_h
+#define itkGPUHostImageFilter_h
+
+#include "itkGPUImage.h"
+
+namespace itk {
+
+/** \class GPUHostImageFilter
+ * \brief Run an OpenCL filter of GPUImages on the Images of SimpleITK.
+ *
+ * The GPU filters of ITK take and produce GPUImages, which keep a
+ * copy of their pixels on the device. This filter derives from the
+ * GPU filter TGPUFilter instantiated over the GPUImages of the same
+ * pixels as TInputImage and TOutputImage, and takes and produces
+ * Images:
+ *
+ * - An input which is a GPUImage, such as the output of another GPU
+ * filter, is used as it is, so the pixels of a chain of GPU filters
+ * stay on the device.
+ * - Any other input is copied into a GPUImage, which is uploaded to
+ * the device when the filter runs.
+ * - The output is the GPUImage of the GPU filter. GPUImage overrides
+ * the virtual GetBufferPointer to copy the pixels back to the host,
+ * only when the pixels are accessed there.
+ *
+ * \sa GPUImage
+ */
+template< template< typename, typename > class TGPUFilter, typename TInputImage, typename TOutputImage >
+class GPUHostImageFilter:
+    public TGPUFilter< GPUImage< typename TInputImage::PixelType, TInputImage::ImageDimension >,
+                       GPUImage< typename TOutputImage::PixelType, TOutputImage::ImageDimension > >
+{
+public:
+  /** Standard Self typedef */
+  typedef GPUHostImageFilter Self;
+  typedef GPUImage< typename TInputImage::PixelType, TInputImage::ImageDimension >   GPUInputImageType;
+  typedef GPUImage< typename TOutputImage::PixelType, TOutputImage::ImageDimension > GPUOutputImageType;
+  typedef TGPUFilter< GPUInputImageType, GPUOutputImageType > Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(GPUHostImageFilter, ImageToImageFilter);
+
+  typedef TInputImage  InputImageType;
+  typedef TOutputImage OutputImageType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** Set the input, used as it is when it is a GPUImage and copied
+   * into a GPUImage otherwise. These hide the SetInput methods of the
+   * GPU filter. */
+  void SetInput( const InputImageType *image );
+  void SetInput( unsigned int index, const InputImageType *image );
+
+  /** Get the output of the GPU filter, a GPUImage. */
+  OutputImageType * GetOutput( void )
+    { return this->Superclass::GetOutput(); }
+
+protected:
+
+  GPUHostImageFilter() {}
+
+private:
+  GPUHostImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+};
+
+
+} // end namespace itk
+
+
+#include "itkGPUHostImageFilter.hxx"
+
+#endif // itkGPUHostImageFilter_h
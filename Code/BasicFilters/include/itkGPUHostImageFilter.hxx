@@ -0,0 +1,64 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkGPUHostImageFilter_hxx
+#define itkGPUHostImageFilter_hxx
+
+#include "itkGPUHostImageFilter.h"
+
+#include <algorithm>
+
+namespace itk {
+
+template< template< typename, typename > class TGPUFilter, typename TInputImage, typename TOutputImage >
+void
+GPUHostImageFilter< TGPUFilter, TInputImage, TOutputImage >
+::SetInput( const InputImageType *image )
+{
+  this->SetInput( 0, image );
+}
+
+template< template< typename, typename > class TGPUFilter, typename TInputImage, typename TOutputImage >
+void
+GPUHostImageFilter< TGPUFilter, TInputImage, TOutputImage >
+::SetInput( unsigned int index, const InputImageType *image )
+{
+  const GPUInputImageType *gpuImage = dynamic_cast< const GPUInputImageType * >( image );
+  if ( gpuImage != ITK_NULLPTR || image == ITK_NULLPTR )
+    {
+    this->Superclass::SetInput( index, gpuImage );
+    return;
+    }
+
+  // A GPUImage manages its buffer with the device, so the pixels are
+  // copied rather than grafted.
+  typename GPUInputImageType::Pointer copy = GPUInputImageType::New();
+  copy->CopyInformation( image );
+  copy->SetRegions( image->GetLargestPossibleRegion() );
+  copy->Allocate();
+
+  const typename InputImageType::PixelContainer *container = image->GetPixelContainer();
+  std::copy( container->GetBufferPointer(),
+             container->GetBufferPointer() + container->Size(),
+             copy->GetBufferPointer() );
+
+  this->Superclass::SetInput( index, copy );
+}
+
+} // end namespace itk
+
+#endif // itkGPUHostImageFilter_hxx
@@ -23,10 +23,7 @@
 #include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkCastImageFilter.h"
 #include "itkByteSwapper.h"
-
-
-#include "Ancillary/hl_md5.h"
-#include "Ancillary/hl_sha1.h"
+#include "Ancillary/itkIncrementalHash.h"
 
 namespace itk {
 
@@ -37,6 +34,17 @@ namespace itk {
  * with itk::Image and itk::VectorImage. It is modeled after the access
  * an ImageFileWriter provides to an ImageIO.
  *
+ * The hashes are computed with the IncrementalHash. The SHA1 and MD5
+ * hashes are computed by one thread, and the output is a copy of the
+ * input. The FAST hash is a non-cryptographic 64 bits hash, the XXH64
+ * of the XXH64 of each block of FastHashBlockSize bytes of the input,
+ * computed in parallel on the buffer of the input without a copy. The
+ * output then shares the buffer of the input. The hashes do not
+ * depend on the number of threads or the byte order.
+ *
+ * When IncludeGeometry is on, the size, origin, spacing and direction
+ * of the image are also hashed.
+ *
  * \todo Update in-place on to default after fixing bug in InPlaceImageFilter
  */
 template < class TImageType >
@@ -72,12 +80,21 @@ public:
   const HashObjectType* GetHashOutput() const
   { return static_cast<const HashObjectType *>( this->ProcessObject::GetOutput(1) ); }
 
-  enum  HashFunction { SHA1, MD5 };
+  enum  HashFunction { SHA1, MD5, FAST };
 
   /** Set/Get hashing function as enumerated type */
   itkSetMacro( HashFunction, HashFunction );
   itkGetMacro( HashFunction, HashFunction );
 
+  /** Set/Get whether the geometry of the image is hashed with its
+   * pixels. Off by default. */
+  itkSetMacro( IncludeGeometry, bool );
+  itkGetMacro( IncludeGeometry, bool );
+  itkBooleanMacro( IncludeGeometry );
+
+  /** The number of bytes of the blocks of the FAST hash. */
+  itkStaticConstMacro(FastHashBlockSize, SizeValueType, IncrementalHash::BlockSize);
+
 /** Make a DataObject of the correct type to be used as the specified
    * output. */
   typedef ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
@@ -92,6 +109,11 @@ protected:
 
   virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
 
+  // See superclass for doxygen documentation
+  //
+  // The FAST hash is computed without the copy of the superclass.
+  void GenerateData() ITK_OVERRIDE;
+
   // See superclass for doxygen documentation
   //
   // This method is to do work after the superclass potential threaded
@@ -107,8 +129,21 @@ private:
   HashImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);  //purposely not implemented
 
+  // The number of values, components of the pixels, in the buffer of
+  // the input.
+  size_t GetNumberOfValues() const;
+
+  // The size, origin, spacing and direction of the input, as little
+  // endian bytes.
+  std::vector< unsigned char > GetGeometryBytes() const;
+
+  // The hash of the buffer of the input, and of its geometry when
+  // IncludeGeometry is on.
+  std::string ComputeHash() const;
+
 
   HashFunction m_HashFunction;
+  bool         m_IncludeGeometry;
 };
 
 
@@ -20,6 +20,9 @@
 
 #include "itkHashImageFilter.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace itk {
 
 //
@@ -29,6 +32,7 @@ template<class TImageType>
 HashImageFilter<TImageType>::HashImageFilter()
 {
   this->m_HashFunction = MD5;
+  this->m_IncludeGeometry = false;
 
   // create data object
   this->ProcessObject::SetNthOutput( 1, this->MakeOutput(1).GetPointer() );
@@ -67,20 +71,43 @@ HashImageFilter<TImageType>::AfterThreadedGenerateData()
 
   Superclass::AfterThreadedGenerateData();
 
+  this->GetHashOutput()->Set( this->ComputeHash() );
+}
+
+
+//
+// GenerateData
+//
+template<class TImageType>
+void
+HashImageFilter<TImageType>::GenerateData()
+{
+  if ( this->m_HashFunction != FAST )
+    {
+    Superclass::GenerateData();
+    return;
+    }
+
+  // The fast hash only reads the buffer of the input, so the output
+  // shares it instead of copying it.
+  this->GraftOutput( const_cast<TImageType *>( this->GetInput() ) );
+
+  this->GetHashOutput()->Set( this->ComputeHash() );
+}
+
+
+//
+// GetNumberOfValues
+//
+template<class TImageType>
+size_t
+HashImageFilter<TImageType>::GetNumberOfValues() const
+{
   typedef TImageType                                   ImageType;
   typedef typename ImageType::PixelType                PixelType;
   typedef typename NumericTraits<PixelType>::ValueType ValueType;
-  typedef itk::ByteSwapper<ValueType>                  Swapper;
-
-  ::MD5 md5;
-  ::HL_MD5_CTX md5Context;
-  md5.MD5Init ( &md5Context );
-  ::SHA1 sha1;
-  ::HL_SHA1_CTX sha1Context;
-  sha1.SHA1Reset ( &sha1Context );
-
-  typename ImageType::ConstPointer input = this->GetInput();
 
+  const ImageType *input = this->GetInput();
 
   // make a good guess about the number of components in each pixel
   size_t numberOfComponent =   sizeof(PixelType) / sizeof(ValueType );
@@ -95,60 +122,80 @@ HashImageFilter<TImageType>::AfterThreadedGenerateData()
     itkExceptionMacro("Unsupported data type for hashing!");
     }
 
-  // we feel bad about accessing the data this way
-  ValueType *buffer = static_cast<ValueType*>( (void *)input->GetBufferPointer() );
+  return input->GetBufferedRegion().GetNumberOfPixels()*numberOfComponent;
+}
 
-  typename ImageType::RegionType largestRegion = input->GetBufferedRegion();
-  const size_t numberOfValues = largestRegion.GetNumberOfPixels()*numberOfComponent;
 
+//
+// GetGeometryBytes
+//
+template<class TImageType>
+std::vector<unsigned char>
+HashImageFilter<TImageType>::GetGeometryBytes() const
+{
+  const TImageType *input = this->GetInput();
+  const unsigned int dimension = TImageType::ImageDimension;
 
-  // Possibly byte swap so we always calculate on little endian data
-  Swapper::SwapRangeFromSystemToLittleEndian ( buffer, numberOfValues );
+  std::vector<uint64_t> size( dimension );
+  std::vector<double> values;
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    size[i] = input->GetLargestPossibleRegion().GetSize()[i];
+    ByteSwapper<uint64_t>::SwapFromSystemToLittleEndian( &size[i] );
+    values.push_back( input->GetOrigin()[i] );
+    }
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    values.push_back( input->GetSpacing()[i] );
+    }
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    for ( unsigned int j = 0; j < dimension; ++j )
+      {
+      values.push_back( input->GetDirection()[i][j] );
+      }
+    }
+  ByteSwapper<double>::SwapRangeFromSystemToLittleEndian( &values[0], values.size() );
 
-  // Update the hash
+  std::vector<unsigned char> bytes( size.size()*sizeof(uint64_t) + values.size()*sizeof(double) );
+  std::memcpy( &bytes[0], &size[0], size.size()*sizeof(uint64_t) );
+  std::memcpy( &bytes[size.size()*sizeof(uint64_t)], &values[0], values.size()*sizeof(double) );
+  return bytes;
+}
+
+
+//
+// ComputeHash
+//
+template<class TImageType>
+std::string
+HashImageFilter<TImageType>::ComputeHash() const
+{
+  typedef typename NumericTraits<typename TImageType::PixelType>::ValueType ValueType;
+
+  IncrementalHash::HashFunction hashFunction = IncrementalHash::MD5;
   switch ( this->m_HashFunction )
     {
     case SHA1:
-      sha1.SHA1Input ( &sha1Context, (unsigned char*)buffer, numberOfValues*sizeof(ValueType) );
+      hashFunction = IncrementalHash::SHA1;
+      break;
+    case FAST:
+      hashFunction = IncrementalHash::FAST;
       break;
-    case MD5:
-      md5.MD5Update ( &md5Context, (unsigned char*)buffer, numberOfValues*sizeof(ValueType) );
+    default:
       break;
     }
 
-  // Calculate and return the hash value
-  std::string hash;
-  int HashSize = SHA1HashSize;
-  unsigned char Digest[1024];
-  switch ( this->m_HashFunction )
-    {
-    case SHA1:
-    {
-    HashSize = SHA1HashSize;
-    sha1.SHA1Result ( &sha1Context, Digest );
-    break;
-    }
-    case MD5:
-    {
-    HashSize = 16;
-    md5.MD5Final ( Digest, &md5Context );
-    break;
-    }
-    }
+  IncrementalHash hash( hashFunction, sizeof(ValueType) );
+  hash.SetNumberOfThreads( this->GetNumberOfThreads() );
+  hash.Update( this->GetInput()->GetBufferPointer(), this->GetNumberOfValues()*sizeof(ValueType) );
 
-  // Should we really covert the binary representation to a hex ASCII here
-  //
-  // Print to a string
-  std::ostringstream os;
-  for(int i=0; i<HashSize; ++i)
+  if ( this->m_IncludeGeometry )
     {
-    // set the width to 2, fill with 0, and convert to hex
-    os.width(2);
-    os.fill('0');
-    os << std::hex << static_cast<unsigned int>(Digest[i]);
+    const std::vector<unsigned char> geometry = this->GetGeometryBytes();
+    return hash.Final( &geometry[0], geometry.size() );
     }
-
-  this->GetHashOutput()->Set( os.str() );
+  return hash.Final();
 }
 
 
@@ -177,6 +224,7 @@ HashImageFilter<TImageType>::PrintSelf(std::ostream & os, Indent indent) const
   Superclass::PrintSelf(os, indent);
 
   os << indent << "HashFunction: " << m_HashFunction << std::endl;
+  os << indent << "IncludeGeometry: " << m_IncludeGeometry << std::endl;
 }
 
 
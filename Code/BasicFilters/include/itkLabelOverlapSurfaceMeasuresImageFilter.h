@@ -0,0 +1,193 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkLabelOverlapSurfaceMeasuresImageFilter_h
+#define itkLabelOverlapSurfaceMeasuresImageFilter_h
+
+#include "itkLabelOverlapMeasuresImageFilter.h"
+#include "itkMultiThreader.h"
+
+#include <map>
+#include <vector>
+
+namespace itk {
+
+/** \class LabelOverlapSurfaceMeasuresImageFilter
+ * \brief A LabelOverlapMeasuresImageFilter which also computes the
+ * distances between the surfaces of each label.
+ *
+ * When ComputeSurfaceDistances is on, each thread collects the surface
+ * pixels of all the labels of its part of the source and target
+ * images, in the same pass as the overlap measures. A surface pixel
+ * has a face neighbor inside of the image with another label, as for
+ * the LabelContourImageFilter.
+ *
+ * The labels are then shared between the threads. For each label, the
+ * exact Euclidean distance transform of the surface of each image is
+ * computed, one axis after the other, in the bounding box of the
+ * surfaces of the label in both images, and sampled at the surface of
+ * the other image. The cost depends on the size of the labels, not on
+ * the number of labels times the size of the image.
+ *
+ * The HausdorffDistance of a label is the largest distance of a
+ * surface pixel to the surface of the other image, and the
+ * MeanSurfaceDistance is the mean of these distances over the surface
+ * pixels of both images. They are the largest value of RealType when
+ * the label is only in one image. The distances are in physical units
+ * when UseImageSpacing is on, the default, and in pixels otherwise.
+ *
+ * \sa LabelContourImageFilter
+ */
+template< typename TLabelImage >
+class LabelOverlapSurfaceMeasuresImageFilter:
+    public LabelOverlapMeasuresImageFilter< TLabelImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef LabelOverlapSurfaceMeasuresImageFilter Self;
+  typedef LabelOverlapMeasuresImageFilter< TLabelImage > Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(LabelOverlapSurfaceMeasuresImageFilter, LabelOverlapMeasuresImageFilter);
+
+  typedef TLabelImage                         LabelImageType;
+  typedef typename LabelImageType::PixelType  LabelType;
+  typedef typename LabelImageType::RegionType RegionType;
+  typedef typename LabelImageType::IndexType  IndexType;
+  typedef typename Superclass::RealType       RealType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TLabelImage::ImageDimension);
+
+  /** Enable or disable the surface distances, off by default. */
+  itkSetMacro( ComputeSurfaceDistances, bool );
+  itkGetConstMacro( ComputeSurfaceDistances, bool );
+  itkBooleanMacro( ComputeSurfaceDistances );
+
+  /** Compute the distances in physical units, on by default. */
+  itkSetMacro( UseImageSpacing, bool );
+  itkGetConstMacro( UseImageSpacing, bool );
+  itkBooleanMacro( UseImageSpacing );
+
+  /** The labels other than 0 of the source and target images, in
+   * increasing order. */
+  std::vector< LabelType > GetLabels() const;
+
+  /** The largest distance between the surfaces of a label. An
+   * exception is thrown if the label does not exist or the surface
+   * distances were not computed. */
+  RealType GetHausdorffDistance( LabelType label ) const;
+
+  /** The mean distance between the surfaces of a label. */
+  RealType GetMeanSurfaceDistance( LabelType label ) const;
+
+protected:
+
+  LabelOverlapSurfaceMeasuresImageFilter();
+
+  // virtual ~LabelOverlapSurfaceMeasuresImageFilter(); // implementation not needed
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void ThreadedGenerateData( const RegionType &, ThreadIdType ) ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void AfterThreadedGenerateData() ITK_OVERRIDE;
+
+private:
+  LabelOverlapSurfaceMeasuresImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  // The surface pixels of a label in the source and target images.
+  struct LabelSurface
+  {
+    std::vector< IndexType > m_Source;
+    std::vector< IndexType > m_Target;
+  };
+  typedef std::map< LabelType, LabelSurface > LabelSurfaceMapType;
+
+  struct SurfaceMeasures
+  {
+    RealType m_HausdorffDistance;
+    RealType m_MeanSurfaceDistance;
+  };
+  typedef std::map< LabelType, SurfaceMeasures > SurfaceMeasuresMapType;
+
+  struct DistanceThreadStruct
+  {
+    const Self                          *m_Filter;
+    std::vector< const LabelSurface * > m_Surfaces;
+    std::vector< SurfaceMeasures >      m_Measures;
+  };
+
+  static ITK_THREAD_RETURN_TYPE DistanceThreaderCallback( void *arg );
+
+  // Add the surface pixels of the labels of an image in a region.
+  void AddSurface( const LabelImageType *image,
+                   const RegionType &region,
+                   bool source,
+                   LabelSurfaceMapType &surfaces ) const;
+
+  // Compute the distances between the surfaces of a label.
+  void ComputeSurfaceMeasures( const LabelSurface &surface, SurfaceMeasures &measures ) const;
+
+  // Compute the squared distances to the points in a box, one axis
+  // after the other, and sample them at other points. Returns the
+  // largest distance and the sum of the distances.
+  void ComputeDirectedDistances( const std::vector< IndexType > &to,
+                                 const std::vector< IndexType > &from,
+                                 const IndexType &lower,
+                                 const SizeValueType *size,
+                                 const double *weights,
+                                 std::vector< double > &distances,
+                                 RealType &maximum,
+                                 RealType &sum ) const;
+
+  // The squared distance transform of a line with the lower envelope
+  // of parabolas of Felzenszwalb and Huttenlocher.
+  static void DistanceTransformLine( const double *f,
+                                     SizeValueType n,
+                                     double weight,
+                                     double *d,
+                                     SizeValueType *v,
+                                     double *z );
+
+  const SurfaceMeasures & GetSurfaceMeasures( LabelType label ) const;
+
+  bool m_ComputeSurfaceDistances;
+  bool m_UseImageSpacing;
+
+  std::vector< LabelSurfaceMapType > m_ThreadSurfaces;
+  SurfaceMeasuresMapType             m_SurfaceMeasures;
+  bool                               m_SurfaceDistancesComputed;
+};
+
+
+} // end namespace itk
+
+
+#include "itkLabelOverlapSurfaceMeasuresImageFilter.hxx"
+
+#endif // itkLabelOverlapSurfaceMeasuresImageFilter_h
@@ -0,0 +1,501 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkLabelOverlapSurfaceMeasuresImageFilter_hxx
+#define itkLabelOverlapSurfaceMeasuresImageFilter_hxx
+
+#include "itkLabelOverlapSurfaceMeasuresImageFilter.h"
+
+#include "itkImageScanlineConstIterator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TLabelImage >
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::LabelOverlapSurfaceMeasuresImageFilter()
+  : m_ComputeSurfaceDistances( false ),
+    m_UseImageSpacing( true ),
+    m_SurfaceDistancesComputed( false )
+{
+}
+
+//
+// GetLabels
+//
+template< typename TLabelImage >
+std::vector< typename LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >::LabelType >
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::GetLabels() const
+{
+  std::vector< LabelType > labels;
+  const typename Superclass::MapType labelSetMeasures = this->GetLabelSetMeasures();
+  for ( typename Superclass::MapType::const_iterator it = labelSetMeasures.begin(); it != labelSetMeasures.end(); ++it )
+    {
+    if ( it->first != NumericTraits< LabelType >::ZeroValue() )
+      {
+      labels.push_back( it->first );
+      }
+    }
+  return labels;
+}
+
+//
+// GetSurfaceMeasures
+//
+template< typename TLabelImage >
+const typename LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >::SurfaceMeasures &
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::GetSurfaceMeasures( LabelType label ) const
+{
+  if ( !this->m_SurfaceDistancesComputed )
+    {
+    itkExceptionMacro( "The surface distances were not computed by the last execution." );
+    }
+  typename SurfaceMeasuresMapType::const_iterator it = this->m_SurfaceMeasures.find( label );
+  if ( it == this->m_SurfaceMeasures.end() )
+    {
+    itkExceptionMacro( "The label " << static_cast< typename NumericTraits< LabelType >::PrintType >( label )
+                       << " does not exist." );
+    }
+  return it->second;
+}
+
+template< typename TLabelImage >
+typename LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >::RealType
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::GetHausdorffDistance( LabelType label ) const
+{
+  return this->GetSurfaceMeasures( label ).m_HausdorffDistance;
+}
+
+template< typename TLabelImage >
+typename LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >::RealType
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::GetMeanSurfaceDistance( LabelType label ) const
+{
+  return this->GetSurfaceMeasures( label ).m_MeanSurfaceDistance;
+}
+
+//
+// BeforeThreadedGenerateData
+//
+template< typename TLabelImage >
+void
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  this->m_SurfaceMeasures.clear();
+  this->m_SurfaceDistancesComputed = false;
+  this->m_ThreadSurfaces.clear();
+  if ( this->m_ComputeSurfaceDistances )
+    {
+    this->m_ThreadSurfaces.resize( this->GetNumberOfThreads() );
+    }
+}
+
+//
+// ThreadedGenerateData
+//
+template< typename TLabelImage >
+void
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::ThreadedGenerateData( const RegionType &outputRegionForThread, ThreadIdType threadId )
+{
+  Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+
+  if ( this->m_ComputeSurfaceDistances )
+    {
+    this->AddSurface( this->GetSourceImage(), outputRegionForThread, true, this->m_ThreadSurfaces[threadId] );
+    this->AddSurface( this->GetTargetImage(), outputRegionForThread, false, this->m_ThreadSurfaces[threadId] );
+    }
+}
+
+//
+// AddSurface
+//
+template< typename TLabelImage >
+void
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::AddSurface( const LabelImageType *image,
+              const RegionType &region,
+              bool source,
+              LabelSurfaceMapType &surfaces ) const
+{
+  const RegionType bufferedRegion = image->GetBufferedRegion();
+  const IndexType bufferLower = bufferedRegion.GetIndex();
+  const typename RegionType::SizeType bufferSize = bufferedRegion.GetSize();
+  const OffsetValueType *offsetTable = image->GetOffsetTable();
+  const LabelType *buffer = image->GetBufferPointer();
+
+  // the last label seen, to skip the search in the map
+  LabelSurface *surface = ITK_NULLPTR;
+  LabelType surfaceLabel = NumericTraits< LabelType >::ZeroValue();
+
+  ImageScanlineConstIterator< LabelImageType > it( image, region );
+  while ( !it.IsAtEnd() )
+    {
+    IndexType index = it.GetIndex();
+    const LabelType *pixel = buffer + image->ComputeOffset( index );
+    while ( !it.IsAtEndOfLine() )
+      {
+      const LabelType label = *pixel;
+      if ( label != NumericTraits< LabelType >::ZeroValue() )
+        {
+        bool onSurface = false;
+        for ( unsigned int d = 0; d < ImageDimension && !onSurface; ++d )
+          {
+          const IndexValueType position = index[d] - bufferLower[d];
+          if ( position > 0 && pixel[-offsetTable[d]] != label )
+            {
+            onSurface = true;
+            }
+          if ( position + 1 < static_cast< IndexValueType >( bufferSize[d] ) && pixel[offsetTable[d]] != label )
+            {
+            onSurface = true;
+            }
+          }
+
+        if ( onSurface )
+          {
+          if ( !surface || label != surfaceLabel )
+            {
+            surface = &surfaces[label];
+            surfaceLabel = label;
+            }
+          if ( source )
+            {
+            surface->m_Source.push_back( index );
+            }
+          else
+            {
+            surface->m_Target.push_back( index );
+            }
+          }
+        }
+      ++index[0];
+      ++pixel;
+      ++it;
+      }
+    it.NextLine();
+    }
+}
+
+//
+// AfterThreadedGenerateData
+//
+template< typename TLabelImage >
+void
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::AfterThreadedGenerateData()
+{
+  Superclass::AfterThreadedGenerateData();
+
+  if ( !this->m_ComputeSurfaceDistances )
+    {
+    return;
+    }
+
+  // gather the surfaces of the threads
+  LabelSurfaceMapType surfaces;
+  for ( size_t t = 0; t < this->m_ThreadSurfaces.size(); ++t )
+    {
+    for ( typename LabelSurfaceMapType::iterator it = this->m_ThreadSurfaces[t].begin();
+          it != this->m_ThreadSurfaces[t].end(); ++it )
+      {
+      LabelSurface &surface = surfaces[it->first];
+      surface.m_Source.insert( surface.m_Source.end(), it->second.m_Source.begin(), it->second.m_Source.end() );
+      surface.m_Target.insert( surface.m_Target.end(), it->second.m_Target.begin(), it->second.m_Target.end() );
+      }
+    LabelSurfaceMapType().swap( this->m_ThreadSurfaces[t] );
+    }
+  this->m_ThreadSurfaces.clear();
+
+  // the labels are shared between the threads
+  DistanceThreadStruct str;
+  str.m_Filter = this;
+  for ( typename LabelSurfaceMapType::const_iterator it = surfaces.begin(); it != surfaces.end(); ++it )
+    {
+    str.m_Surfaces.push_back( &it->second );
+    }
+  str.m_Measures.resize( str.m_Surfaces.size() );
+
+  if ( !str.m_Surfaces.empty() )
+    {
+    const ThreadIdType numberOfThreads =
+      std::min< ThreadIdType >( this->GetNumberOfThreads(), static_cast< ThreadIdType >( str.m_Surfaces.size() ) );
+    this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+    this->GetMultiThreader()->SetSingleMethod( &Self::DistanceThreaderCallback, &str );
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+
+  size_t i = 0;
+  for ( typename LabelSurfaceMapType::const_iterator it = surfaces.begin(); it != surfaces.end(); ++it, ++i )
+    {
+    this->m_SurfaceMeasures[it->first] = str.m_Measures[i];
+    }
+  this->m_SurfaceDistancesComputed = true;
+}
+
+//
+// DistanceThreaderCallback
+//
+template< typename TLabelImage >
+ITK_THREAD_RETURN_TYPE
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::DistanceThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  DistanceThreadStruct *str = static_cast< DistanceThreadStruct * >( info->UserData );
+
+  for ( size_t i = info->ThreadID; i < str->m_Surfaces.size(); i += info->NumberOfThreads )
+    {
+    str->m_Filter->ComputeSurfaceMeasures( *str->m_Surfaces[i], str->m_Measures[i] );
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+//
+// ComputeSurfaceMeasures
+//
+template< typename TLabelImage >
+void
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::ComputeSurfaceMeasures( const LabelSurface &surface, SurfaceMeasures &measures ) const
+{
+  if ( surface.m_Source.empty() || surface.m_Target.empty() )
+    {
+    measures.m_HausdorffDistance = NumericTraits< RealType >::max();
+    measures.m_MeanSurfaceDistance = NumericTraits< RealType >::max();
+    return;
+    }
+
+  // the bounding box of both surfaces, which contains the nearest
+  // surface pixel of each surface pixel
+  IndexType lower = surface.m_Source[0];
+  IndexType upper = lower;
+  for ( unsigned int s = 0; s < 2; ++s )
+    {
+    const std::vector< IndexType > &points = s == 0 ? surface.m_Source : surface.m_Target;
+    for ( size_t i = 0; i < points.size(); ++i )
+      {
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        lower[d] = std::min( lower[d], points[i][d] );
+        upper[d] = std::max( upper[d], points[i][d] );
+        }
+      }
+    }
+
+  SizeValueType size[ImageDimension];
+  double weights[ImageDimension];
+  const typename LabelImageType::SpacingType spacing = this->GetSourceImage()->GetSpacing();
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    size[d] = static_cast< SizeValueType >( upper[d] - lower[d] + 1 );
+    weights[d] = this->m_UseImageSpacing ? spacing[d] * spacing[d] : 1.0;
+    }
+
+  std::vector< double > distances;
+  RealType maximum1;
+  RealType sum1;
+  RealType maximum2;
+  RealType sum2;
+  this->ComputeDirectedDistances( surface.m_Target, surface.m_Source, lower, size, weights, distances, maximum1, sum1 );
+  this->ComputeDirectedDistances( surface.m_Source, surface.m_Target, lower, size, weights, distances, maximum2, sum2 );
+
+  measures.m_HausdorffDistance = std::max( maximum1, maximum2 );
+  measures.m_MeanSurfaceDistance = ( sum1 + sum2 ) / ( surface.m_Source.size() + surface.m_Target.size() );
+}
+
+//
+// ComputeDirectedDistances
+//
+template< typename TLabelImage >
+void
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::ComputeDirectedDistances( const std::vector< IndexType > &to,
+                            const std::vector< IndexType > &from,
+                            const IndexType &lower,
+                            const SizeValueType *size,
+                            const double *weights,
+                            std::vector< double > &distances,
+                            RealType &maximum,
+                            RealType &sum ) const
+{
+  SizeValueType strides[ImageDimension];
+  SizeValueType numberOfPixels = 1;
+  SizeValueType maximumSize = 1;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    strides[d] = numberOfPixels;
+    numberOfPixels *= size[d];
+    maximumSize = std::max( maximumSize, size[d] );
+    }
+
+  distances.assign( numberOfPixels, std::numeric_limits< double >::infinity() );
+  for ( size_t i = 0; i < to.size(); ++i )
+    {
+    SizeValueType offset = 0;
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      offset += static_cast< SizeValueType >( to[i][d] - lower[d] ) * strides[d];
+      }
+    distances[offset] = 0.0;
+    }
+
+  std::vector< double > f( maximumSize );
+  std::vector< double > line( maximumSize );
+  std::vector< SizeValueType > v( maximumSize );
+  std::vector< double > z( maximumSize + 1 );
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    const SizeValueType n = size[d];
+    if ( n == 1 )
+      {
+      continue;
+      }
+    // the first pixel of each line along the axis
+    for ( SizeValueType start = 0; start < numberOfPixels; ++start )
+      {
+      if ( ( start / strides[d] ) % n != 0 )
+        {
+        continue;
+        }
+      for ( SizeValueType i = 0; i < n; ++i )
+        {
+        f[i] = distances[start + i * strides[d]];
+        }
+      DistanceTransformLine( &f[0], n, weights[d], &line[0], &v[0], &z[0] );
+      for ( SizeValueType i = 0; i < n; ++i )
+        {
+        distances[start + i * strides[d]] = line[i];
+        }
+      }
+    }
+
+  maximum = NumericTraits< RealType >::ZeroValue();
+  sum = NumericTraits< RealType >::ZeroValue();
+  for ( size_t i = 0; i < from.size(); ++i )
+    {
+    SizeValueType offset = 0;
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      offset += static_cast< SizeValueType >( from[i][d] - lower[d] ) * strides[d];
+      }
+    const RealType distance = static_cast< RealType >( std::sqrt( distances[offset] ) );
+    maximum = std::max( maximum, distance );
+    sum += distance;
+    }
+}
+
+//
+// DistanceTransformLine
+//
+template< typename TLabelImage >
+void
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::DistanceTransformLine( const double *f,
+                         SizeValueType n,
+                         double weight,
+                         double *d,
+                         SizeValueType *v,
+                         double *z )
+{
+  const double infinity = std::numeric_limits< double >::infinity();
+
+  // the lower envelope of the parabolas of the finite values, the
+  // parabola v[k] is the lowest between z[k] and z[k+1]
+  SizeValueType k = 0;
+  bool empty = true;
+  for ( SizeValueType q = 0; q < n; ++q )
+    {
+    if ( f[q] == infinity )
+      {
+      continue;
+      }
+    if ( empty )
+      {
+      v[0] = q;
+      z[0] = -infinity;
+      z[1] = infinity;
+      empty = false;
+      continue;
+      }
+    double s;
+    while ( true )
+      {
+      const double p = static_cast< double >( v[k] );
+      const double r = static_cast< double >( q );
+      s = ( ( f[q] + weight * r * r ) - ( f[v[k]] + weight * p * p ) ) / ( 2.0 * weight * ( r - p ) );
+      // z[0] is -infinity, so k stops at 0
+      if ( s > z[k] )
+        {
+        break;
+        }
+      --k;
+      }
+    ++k;
+    v[k] = q;
+    z[k] = s;
+    z[k+1] = infinity;
+    }
+
+  if ( empty )
+    {
+    std::fill( d, d + n, infinity );
+    return;
+    }
+
+  k = 0;
+  for ( SizeValueType q = 0; q < n; ++q )
+    {
+    while ( z[k+1] < static_cast< double >( q ) )
+      {
+      ++k;
+      }
+    const double r = static_cast< double >( q ) - static_cast< double >( v[k] );
+    d[q] = weight * r * r + f[v[k]];
+    }
+}
+
+//
+// PrintSelf
+//
+template< typename TLabelImage >
+void
+LabelOverlapSurfaceMeasuresImageFilter< TLabelImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "ComputeSurfaceDistances: " << this->m_ComputeSurfaceDistances << std::endl;
+  os << indent << "UseImageSpacing: " << this->m_UseImageSpacing << std::endl;
+  os << indent << "SurfaceDistancesComputed: " << this->m_SurfaceDistancesComputed << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkLabelOverlapSurfaceMeasuresImageFilter_hxx
@@ -0,0 +1,145 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkPhiloxRandomStream_h
+#define itkPhiloxRandomStream_h
+
+#include "itkIntTypes.h"
+
+#include <cmath>
+
+namespace itk {
+
+/** \class PhiloxRandomStream
+ * \brief A stream of random numbers computed from a key and a
+ * counter with the Philox4x32-10 generator.
+ *
+ * A counter based generator computes each block of random numbers as
+ * a function of a key and of the position of the block, rather than
+ * from the state left by the previous numbers. A stream keyed on a
+ * seed and identified by an index, such as the index of a pixel, has
+ * the same numbers whichever thread computes it and in whichever
+ * order, so a filter drawing the numbers of each pixel from its own
+ * stream gives the same output for any number of threads.
+ *
+ * Philox4x32-10 is the generator of Salmon et al., "Parallel random
+ * numbers: as easy as 1, 2, 3", SC 2011. Each block of four 32-bit
+ * numbers costs ten rounds of two 32-bit multiplications, and the
+ * numbers pass the BigCrush tests.
+ */
+class PhiloxRandomStream
+{
+public:
+
+  /** The stream of the index for the seed. Several independent
+   * families of indexed streams have the same seed with a different
+   * stream number. */
+  PhiloxRandomStream( uint32_t seed, uint64_t index, uint32_t stream = 0 )
+    {
+      this->Reset( seed, index, stream );
+    }
+
+  /** Restart at the beginning of the stream of the index for the
+   * seed. */
+  void Reset( uint32_t seed, uint64_t index, uint32_t stream = 0 )
+    {
+      m_Key[0] = seed;
+      m_Key[1] = 0x5349544Bu;
+      m_Counter[0] = static_cast<uint32_t>( index );
+      m_Counter[1] = static_cast<uint32_t>( index >> 32 );
+      m_Counter[2] = 0;
+      m_Counter[3] = stream;
+      m_Position = 4;
+      m_HasNormal = false;
+    }
+
+  /** The next 32-bit number of the stream. */
+  uint32_t GetIntegerVariate( void )
+    {
+      if ( m_Position == 4 )
+        {
+        Philox( m_Counter, m_Key, m_Block );
+        ++m_Counter[2];
+        m_Position = 0;
+        }
+      return m_Block[m_Position++];
+    }
+
+  /** A uniform variate in the open interval (0, 1), with 53 random
+   * bits. */
+  double GetVariate( void )
+    {
+      const uint32_t a = this->GetIntegerVariate() >> 5;
+      const uint32_t b = this->GetIntegerVariate() >> 6;
+      return ( a * 67108864.0 + b + 0.5 ) / 9007199254740992.0;
+    }
+
+  /** A normal variate of mean 0 and variance 1, by the Box-Muller
+   * transform. */
+  double GetNormalVariate( void )
+    {
+      if ( m_HasNormal )
+        {
+        m_HasNormal = false;
+        return m_Normal;
+        }
+      const double radius = std::sqrt( -2.0 * std::log( this->GetVariate() ) );
+      const double angle = 6.283185307179586477 * this->GetVariate();
+      m_Normal = radius * std::sin( angle );
+      m_HasNormal = true;
+      return radius * std::cos( angle );
+    }
+
+  /** Compute the block of the counter for the key. */
+  static void Philox( const uint32_t counter[4], const uint32_t key[2], uint32_t block[4] )
+    {
+      uint32_t c[4] = { counter[0], counter[1], counter[2], counter[3] };
+      uint32_t k[2] = { key[0], key[1] };
+      for ( unsigned int round = 0; round < 10; ++round )
+        {
+        if ( round > 0 )
+          {
+          k[0] += 0x9E3779B9u;
+          k[1] += 0xBB67AE85u;
+          }
+        const uint64_t product0 = static_cast<uint64_t>( 0xD2511F53u ) * c[0];
+        const uint64_t product1 = static_cast<uint64_t>( 0xCD9E8D57u ) * c[2];
+        const uint32_t c1 = c[1];
+        const uint32_t c3 = c[3];
+        c[0] = static_cast<uint32_t>( product1 >> 32 ) ^ c1 ^ k[0];
+        c[1] = static_cast<uint32_t>( product1 );
+        c[2] = static_cast<uint32_t>( product0 >> 32 ) ^ c3 ^ k[1];
+        c[3] = static_cast<uint32_t>( product0 );
+        }
+      block[0] = c[0];
+      block[1] = c[1];
+      block[2] = c[2];
+      block[3] = c[3];
+    }
+
+private:
+  uint32_t     m_Key[2];
+  uint32_t     m_Counter[4];
+  uint32_t     m_Block[4];
+  unsigned int m_Position;
+  bool         m_HasNormal;
+  double       m_Normal;
+};
+
+} // end namespace itk
+
+#endif // itkPhiloxRandomStream_h
@@ -0,0 +1,118 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkRecursiveDiscreteGaussianImageFilter_h
+#define itkRecursiveDiscreteGaussianImageFilter_h
+
+#include "itkDiscreteGaussianImageFilter.h"
+
+#include <vector>
+
+namespace itk {
+
+/** \class RecursiveDiscreteGaussianImageFilter
+ * \brief A DiscreteGaussianImageFilter with a recursive path for large
+ * variances.
+ *
+ * The cost of the discrete Gaussian kernel grows with the standard
+ * deviation. When the standard deviation in pixels of each smoothed
+ * axis is at least RecursiveGaussianMinimumSigma, the image is
+ * smoothed with a RecursiveGaussianImageFilter along each axis, in a
+ * time per pixel which does not depend on the variance.
+ *
+ * The recursive filter approximates the sampled Gaussian, while the
+ * DiscreteGaussianImageFilter uses the discrete Gaussian kernel of
+ * Lindeberg, truncated to MaximumError and MaximumKernelWidth. The two
+ * get closer as the standard deviation grows, so a smaller
+ * RecursiveGaussianMinimumSigma trades accuracy for speed. The
+ * recursive path requests the whole input.
+ *
+ * \sa RecursiveGaussianImageFilter
+ */
+template< typename TInputImage, typename TOutputImage = TInputImage >
+class RecursiveDiscreteGaussianImageFilter:
+    public DiscreteGaussianImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef RecursiveDiscreteGaussianImageFilter Self;
+  typedef DiscreteGaussianImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(RecursiveDiscreteGaussianImageFilter, DiscreteGaussianImageFilter);
+
+  typedef typename Superclass::InputImageType  InputImageType;
+  typedef typename Superclass::OutputImageType OutputImageType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** Enable or disable the recursive Gaussian, on by default. */
+  itkSetMacro( UseRecursiveGaussian, bool );
+  itkGetConstMacro( UseRecursiveGaussian, bool );
+  itkBooleanMacro( UseRecursiveGaussian );
+
+  /** The smallest standard deviation, in pixels, of the smoothed axes
+   * for the recursive Gaussian. The default is 4 pixels. */
+  itkSetMacro( RecursiveGaussianMinimumSigma, double );
+  itkGetConstMacro( RecursiveGaussianMinimumSigma, double );
+
+  /** Get if the last execution used the recursive Gaussian. */
+  itkGetConstMacro( RecursiveGaussianUsed, bool );
+
+  // See superclass for doxygen documentation
+  //
+  // The recursive Gaussian requests the largest possible region.
+  virtual void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+protected:
+
+  RecursiveDiscreteGaussianImageFilter();
+
+  // virtual ~RecursiveDiscreteGaussianImageFilter(); // implementation not needed
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void GenerateData() ITK_OVERRIDE;
+
+private:
+  RecursiveDiscreteGaussianImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  // Compute the axes to smooth and their standard deviations in
+  // physical units. Returns false if the recursive Gaussian is not
+  // used.
+  bool ComputeRecursiveSigmas( std::vector< unsigned int > &axes,
+                               std::vector< double > &sigmas ) const;
+
+  bool   m_UseRecursiveGaussian;
+  double m_RecursiveGaussianMinimumSigma;
+  bool   m_RecursiveGaussianUsed;
+};
+
+
+} // end namespace itk
+
+
+#include "itkRecursiveDiscreteGaussianImageFilter.hxx"
+
+#endif // itkRecursiveDiscreteGaussianImageFilter_h
@@ -0,0 +1,215 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkRecursiveDiscreteGaussianImageFilter_hxx
+#define itkRecursiveDiscreteGaussianImageFilter_hxx
+
+#include "itkRecursiveDiscreteGaussianImageFilter.h"
+
+#include "itkRecursiveGaussianImageFilter.h"
+#include "itkCastImageFilter.h"
+#include "itkProgressAccumulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TInputImage, typename TOutputImage >
+RecursiveDiscreteGaussianImageFilter< TInputImage, TOutputImage >
+::RecursiveDiscreteGaussianImageFilter()
+  : m_UseRecursiveGaussian( true ),
+    m_RecursiveGaussianMinimumSigma( 4.0 ),
+    m_RecursiveGaussianUsed( false )
+{
+}
+
+//
+// ComputeRecursiveSigmas
+//
+template< typename TInputImage, typename TOutputImage >
+bool
+RecursiveDiscreteGaussianImageFilter< TInputImage, TOutputImage >
+::ComputeRecursiveSigmas( std::vector< unsigned int > &axes,
+                          std::vector< double > &sigmas ) const
+{
+  axes.clear();
+  sigmas.clear();
+
+  const InputImageType *input = this->GetInput();
+  if ( !this->m_UseRecursiveGaussian || !input )
+    {
+    return false;
+    }
+
+  const unsigned int filterDimensionality = std::min( this->GetFilterDimensionality(),
+                                                      static_cast< unsigned int >( ImageDimension ) );
+  const typename InputImageType::SpacingType spacing = input->GetSpacing();
+  const typename InputImageType::SizeType size = input->GetLargestPossibleRegion().GetSize();
+
+  for ( unsigned int d = 0; d < filterDimensionality; ++d )
+    {
+    const double variance = this->GetVariance()[d];
+    if ( variance <= 0.0 )
+      {
+      // a zero variance does not smooth the axis
+      continue;
+      }
+    if ( spacing[d] == 0.0 )
+      {
+      return false;
+      }
+
+    double sigmaInPixels = std::sqrt( variance );
+    double sigma = sigmaInPixels * spacing[d];
+    if ( this->GetUseImageSpacing() )
+      {
+      sigma = std::sqrt( variance );
+      sigmaInPixels = sigma / spacing[d];
+      }
+
+    // the recursive filter needs 4 pixels along its direction
+    if ( sigmaInPixels < this->m_RecursiveGaussianMinimumSigma || size[d] < 4 )
+      {
+      return false;
+      }
+
+    axes.push_back( d );
+    sigmas.push_back( sigma );
+    }
+
+  return !axes.empty();
+}
+
+//
+// GenerateInputRequestedRegion
+//
+template< typename TInputImage, typename TOutputImage >
+void
+RecursiveDiscreteGaussianImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+{
+  std::vector< unsigned int > axes;
+  std::vector< double > sigmas;
+  if ( !this->ComputeRecursiveSigmas( axes, sigmas ) )
+    {
+    Superclass::GenerateInputRequestedRegion();
+    return;
+    }
+
+  // skip the padding of the DiscreteGaussianImageFilter, the
+  // recursive filters use whole lines
+  ImageToImageFilter< TInputImage, TOutputImage >::GenerateInputRequestedRegion();
+
+  InputImageType *input = const_cast< InputImageType * >( this->GetInput() );
+  if ( input )
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+//
+// GenerateData
+//
+template< typename TInputImage, typename TOutputImage >
+void
+RecursiveDiscreteGaussianImageFilter< TInputImage, TOutputImage >
+::GenerateData()
+{
+  std::vector< unsigned int > axes;
+  std::vector< double > sigmas;
+  this->m_RecursiveGaussianUsed = this->ComputeRecursiveSigmas( axes, sigmas );
+  if ( !this->m_RecursiveGaussianUsed )
+    {
+    Superclass::GenerateData();
+    return;
+    }
+
+  typedef typename NumericTraits< typename OutputImageType::PixelType >::RealType RealPixelType;
+  typedef Image< RealPixelType, ImageDimension >                                  RealImageType;
+
+  typedef RecursiveGaussianImageFilter< InputImageType, RealImageType > FirstFilterType;
+  typedef RecursiveGaussianImageFilter< RealImageType, RealImageType >  InternalFilterType;
+  typedef CastImageFilter< RealImageType, OutputImageType >             CastFilterType;
+
+  // Create an internal image to protect the input image's metadata
+  typename InputImageType::Pointer localInput = InputImageType::New();
+  localInput->Graft( this->GetInput() );
+
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter( this );
+  const float weight = 1.0f / ( axes.size() + 1 );
+
+  typename FirstFilterType::Pointer firstFilter = FirstFilterType::New();
+  firstFilter->SetInput( localInput );
+  firstFilter->SetDirection( axes[0] );
+  firstFilter->SetSigma( sigmas[0] );
+  firstFilter->SetOrder( FirstFilterType::ZeroOrder );
+  firstFilter->SetNormalizeAcrossScale( false );
+  firstFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+  firstFilter->ReleaseDataFlagOn();
+  progress->RegisterInternalFilter( firstFilter, weight );
+
+  typename RealImageType::Pointer smoothed = firstFilter->GetOutput();
+
+  std::vector< typename InternalFilterType::Pointer > internalFilters;
+  for ( unsigned int i = 1; i < axes.size(); ++i )
+    {
+    typename InternalFilterType::Pointer filter = InternalFilterType::New();
+    filter->SetInput( smoothed );
+    filter->SetDirection( axes[i] );
+    filter->SetSigma( sigmas[i] );
+    filter->SetOrder( InternalFilterType::ZeroOrder );
+    filter->SetNormalizeAcrossScale( false );
+    filter->SetNumberOfThreads( this->GetNumberOfThreads() );
+    filter->ReleaseDataFlagOn();
+    progress->RegisterInternalFilter( filter, weight );
+    internalFilters.push_back( filter );
+    smoothed = filter->GetOutput();
+    }
+
+  typename CastFilterType::Pointer castFilter = CastFilterType::New();
+  castFilter->SetInput( smoothed );
+  castFilter->SetNumberOfThreads( this->GetNumberOfThreads() );
+  progress->RegisterInternalFilter( castFilter, weight );
+
+  castFilter->GraftOutput( this->GetOutput() );
+  castFilter->Update();
+  this->GraftOutput( castFilter->GetOutput() );
+}
+
+//
+// PrintSelf
+//
+template< typename TInputImage, typename TOutputImage >
+void
+RecursiveDiscreteGaussianImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "UseRecursiveGaussian: " << this->m_UseRecursiveGaussian << std::endl;
+  os << indent << "RecursiveGaussianMinimumSigma: " << this->m_RecursiveGaussianMinimumSigma << std::endl;
+  os << indent << "RecursiveGaussianUsed: " << this->m_RecursiveGaussianUsed << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkRecursiveDiscreteGaussianImageFilter_hxx
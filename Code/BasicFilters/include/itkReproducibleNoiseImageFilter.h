@@ -0,0 +1,92 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkReproducibleNoiseImageFilter_h
+#define itkReproducibleNoiseImageFilter_h
+
+#include "itkAdditiveGaussianNoiseImageFilter.h"
+#include "itkSaltAndPepperNoiseImageFilter.h"
+#include "itkShotNoiseImageFilter.h"
+#include "itkSpeckleNoiseImageFilter.h"
+
+namespace itk {
+
+/** \class ReproducibleNoiseImageFilter
+ * \brief A noise filter whose output does not depend on the number
+ * of threads.
+ *
+ * The noise filters of ITK draw the noise of each thread from a
+ * generator seeded with the Seed and the region of the thread, so the
+ * output changes with the number of threads. This filter derives from
+ * one of the AdditiveGaussianNoiseImageFilter,
+ * SaltAndPepperNoiseImageFilter, ShotNoiseImageFilter or
+ * SpeckleNoiseImageFilter, with the same parameters and
+ * distributions, and draws the noise of each pixel from a
+ * PhiloxRandomStream keyed on the Seed and identified by the index of
+ * the pixel in the largest possible region. The output is the same
+ * for any number of threads and for streamed execution, and the
+ * filter is fully multi-threaded.
+ *
+ * The salt and pepper values are the largest and the smallest value
+ * of the output pixel type.
+ *
+ * \sa PhiloxRandomStream
+ */
+template< typename TNoiseFilter >
+class ReproducibleNoiseImageFilter:
+    public TNoiseFilter
+{
+public:
+  /** Standard Self typedef */
+  typedef ReproducibleNoiseImageFilter Self;
+  typedef TNoiseFilter                 Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ReproducibleNoiseImageFilter, NoiseBaseImageFilter);
+
+  typedef typename Superclass::InputImageType        InputImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::InputImageRegionType  InputImageRegionType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+protected:
+
+  ReproducibleNoiseImageFilter() {}
+
+  // virtual ~ReproducibleNoiseImageFilter(); // implementation not needed
+
+  // See superclass for doxygen documentation
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                                     ThreadIdType threadId ) ITK_OVERRIDE;
+
+private:
+  ReproducibleNoiseImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+};
+
+
+} // end namespace itk
+
+
+#include "itkReproducibleNoiseImageFilter.hxx"
+
+#endif // itkReproducibleNoiseImageFilter_h
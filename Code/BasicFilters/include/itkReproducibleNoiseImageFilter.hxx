@@ -0,0 +1,177 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkReproducibleNoiseImageFilter_hxx
+#define itkReproducibleNoiseImageFilter_hxx
+
+#include "itkReproducibleNoiseImageFilter.h"
+#include "itkPhiloxRandomStream.h"
+
+#include "itkImageScanlineIterator.h"
+#include "itkProgressReporter.h"
+
+#include <cmath>
+
+namespace itk {
+
+namespace ReproducibleNoise {
+
+// The noise of a pixel of each filter, chosen by the deduction of the
+// filter from its base class
+
+template< typename TInputImage, typename TOutputImage >
+double AddNoise( const AdditiveGaussianNoiseImageFilter< TInputImage, TOutputImage > *filter,
+                 double value, PhiloxRandomStream &stream )
+{
+  return value + filter->GetMean() + filter->GetStandardDeviation() * stream.GetNormalVariate();
+}
+
+template< typename TInputImage, typename TOutputImage >
+double AddNoise( const SaltAndPepperNoiseImageFilter< TInputImage, TOutputImage > *filter,
+                 double value, PhiloxRandomStream &stream )
+{
+  typedef typename TOutputImage::PixelType OutputPixelType;
+  if ( stream.GetVariate() < filter->GetProbability() )
+    {
+    if ( stream.GetVariate() < 0.5 )
+      {
+      return static_cast<double>( NumericTraits< OutputPixelType >::max() );
+      }
+    return static_cast<double>( NumericTraits< OutputPixelType >::NonpositiveMin() );
+    }
+  return value;
+}
+
+template< typename TInputImage, typename TOutputImage >
+double AddNoise( const ShotNoiseImageFilter< TInputImage, TOutputImage > *filter,
+                 double value, PhiloxRandomStream &stream )
+{
+  const double scale = filter->GetScale();
+  const double in = scale * value;
+
+  // the Poisson distribution of Knuth for few events, and its normal
+  // approximation otherwise
+  if ( in < 50 )
+    {
+    const double limit = std::exp( -in );
+    long k = 0;
+    double p = 1.0;
+    do
+      {
+      ++k;
+      p *= stream.GetVariate();
+      }
+    while ( p > limit );
+    return ( k - 1 ) / scale;
+    }
+  return ( in + std::sqrt( in ) * stream.GetNormalVariate() ) / scale;
+}
+
+/** A gamma variate of the shape and a scale of 1, by the method of
+ * Marsaglia and Tsang. */
+inline double GammaVariate( double shape, PhiloxRandomStream &stream )
+{
+  if ( shape < 1.0 )
+    {
+    return GammaVariate( shape + 1.0, stream ) * std::pow( stream.GetVariate(), 1.0 / shape );
+    }
+  const double d = shape - 1.0 / 3.0;
+  const double c = 1.0 / std::sqrt( 9.0 * d );
+  while ( true )
+    {
+    double x;
+    double v;
+    do
+      {
+      x = stream.GetNormalVariate();
+      v = 1.0 + c * x;
+      }
+    while ( v <= 0.0 );
+    v = v * v * v;
+    const double u = stream.GetVariate();
+    if ( u < 1.0 - 0.0331 * x * x * x * x
+         || std::log( u ) < 0.5 * x * x + d * ( 1.0 - v + std::log( v ) ) )
+      {
+      return d * v;
+      }
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+double AddNoise( const SpeckleNoiseImageFilter< TInputImage, TOutputImage > *filter,
+                 double value, PhiloxRandomStream &stream )
+{
+  // multiplied by a gamma variate of mean 1 and of the variance
+  const double theta = filter->GetStandardDeviation() * filter->GetStandardDeviation();
+  if ( theta <= 0.0 )
+    {
+    return value;
+    }
+  return value * theta * GammaVariate( 1.0 / theta, stream );
+}
+
+} // end namespace ReproducibleNoise
+
+
+template< typename TNoiseFilter >
+void
+ReproducibleNoiseImageFilter< TNoiseFilter >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        ThreadIdType threadId )
+{
+  const InputImageType *inputPtr = this->GetInput();
+  OutputImageType *outputPtr = this->GetOutput( 0 );
+
+  InputImageRegionType inputRegionForThread;
+  this->CallCopyOutputRegionToInputRegion( inputRegionForThread, outputRegionForThread );
+
+  ImageScanlineConstIterator< InputImageType > inputIt( inputPtr, inputRegionForThread );
+  ImageScanlineIterator< OutputImageType >     outputIt( outputPtr, outputRegionForThread );
+
+  // each pixel has the stream of its index in the largest region
+  const OutputImageRegionType largestRegion = outputPtr->GetLargestPossibleRegion();
+  const uint32_t seed = this->GetSeed();
+  PhiloxRandomStream stream( seed, 0 );
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  while ( !inputIt.IsAtEnd() )
+    {
+    const typename OutputImageType::IndexType index = outputIt.GetIndex();
+    uint64_t pixel = 0;
+    for ( unsigned int d = OutputImageType::ImageDimension; d > 0; --d )
+      {
+      pixel = pixel * largestRegion.GetSize( d - 1 ) + ( index[d - 1] - largestRegion.GetIndex( d - 1 ) );
+      }
+
+    while ( !inputIt.IsAtEndOfLine() )
+      {
+      stream.Reset( seed, pixel++ );
+      const double out = ReproducibleNoise::AddNoise( this, static_cast<double>( inputIt.Get() ), stream );
+      outputIt.Set( Self::ClampCast( out ) );
+      ++inputIt;
+      ++outputIt;
+      progress.CompletedPixel();
+      }
+    inputIt.NextLine();
+    outputIt.NextLine();
+    }
+}
+
+} // end namespace itk
+
+#endif // itkReproducibleNoiseImageFilter_hxx
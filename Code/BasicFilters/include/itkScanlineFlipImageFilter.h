@@ -0,0 +1,83 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkScanlineFlipImageFilter_h
+#define itkScanlineFlipImageFilter_h
+
+#include "itkFlipImageFilter.h"
+
+namespace itk {
+
+/** \class ScanlineFlipImageFilter
+ * \brief A FlipImageFilter copying whole scanlines of the pixel
+ * buffers.
+ *
+ * The FlipImageFilter computes the input index of each output pixel.
+ * Flipping an axis only reverses the order of the scanlines along
+ * it, so each output scanline is copied from one input scanline: as
+ * a block when the first axis is not flipped, and in reverse order
+ * of the pixels when it is.
+ *
+ * The components of the pixels are copied, so the output is the one
+ * of the FlipImageFilter for any pixel type.
+ */
+template< typename TImage >
+class ScanlineFlipImageFilter:
+    public FlipImageFilter< TImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef ScanlineFlipImageFilter    Self;
+  typedef FlipImageFilter< TImage >  Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ScanlineFlipImageFilter, FlipImageFilter);
+
+  typedef typename Superclass::InputImageType        InputImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename TImage::InternalPixelType         ComponentType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TImage::ImageDimension);
+
+protected:
+
+  ScanlineFlipImageFilter() {}
+
+  // virtual ~ScanlineFlipImageFilter(); // implementation not needed
+
+  // See superclass for doxygen documentation
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                                     ThreadIdType threadId ) ITK_OVERRIDE;
+
+private:
+  ScanlineFlipImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+};
+
+
+} // end namespace itk
+
+
+#include "itkScanlineFlipImageFilter.hxx"
+
+#endif // itkScanlineFlipImageFilter_h
@@ -0,0 +1,103 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkScanlineFlipImageFilter_hxx
+#define itkScanlineFlipImageFilter_hxx
+
+#include "itkScanlineFlipImageFilter.h"
+
+#include "itkImageScanlineIterator.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+
+namespace itk {
+
+//
+// ThreadedGenerateData
+//
+template< typename TImage >
+void
+ScanlineFlipImageFilter< TImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        ThreadIdType threadId )
+{
+  const InputImageType *inputPtr = this->GetInput();
+  OutputImageType *outputPtr = this->GetOutput();
+
+  if ( outputRegionForThread.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  // a flipped axis maps the largest possible output region onto the
+  // input one in reverse order, the input index being the sum of
+  // the ends of both regions less the output index
+  const typename InputImageType::RegionType & inputLargestRegion = inputPtr->GetLargestPossibleRegion();
+  const typename OutputImageType::RegionType & outputLargestRegion = outputPtr->GetLargestPossibleRegion();
+  const typename Superclass::FlipAxesArrayType flipAxes = this->GetFlipAxes();
+  OffsetValueType flipOffset[ImageDimension];
+  for ( unsigned int j = 0; j < ImageDimension; ++j )
+    {
+    flipOffset[j] = inputLargestRegion.GetIndex( j ) + outputLargestRegion.GetIndex( j )
+      + static_cast< OffsetValueType >( outputLargestRegion.GetSize( j ) ) - 1;
+    }
+
+  const SizeValueType numberOfComponents = inputPtr->GetNumberOfComponentsPerPixel();
+  const SizeValueType lineSize = outputRegionForThread.GetSize( 0 );
+  const ComponentType *inputBuffer = inputPtr->GetBufferPointer();
+  ComponentType *outputBuffer = outputPtr->GetBufferPointer();
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / lineSize );
+
+  ImageScanlineIterator< OutputImageType > outIt( outputPtr, outputRegionForThread );
+  while ( !outIt.IsAtEnd() )
+    {
+    const typename OutputImageType::IndexType outputIndex = outIt.GetIndex();
+
+    // the input index of the first output pixel of the line
+    typename InputImageType::IndexType inputIndex;
+    for ( unsigned int j = 0; j < ImageDimension; ++j )
+      {
+      inputIndex[j] = flipAxes[j] ? flipOffset[j] - outputIndex[j] : outputIndex[j];
+      }
+
+    const ComponentType *in = inputBuffer + inputPtr->ComputeOffset( inputIndex ) * numberOfComponents;
+    ComponentType *out = outputBuffer + outputPtr->ComputeOffset( outputIndex ) * numberOfComponents;
+
+    if ( !flipAxes[0] )
+      {
+      std::copy( in, in + lineSize * numberOfComponents, out );
+      }
+    else
+      {
+      // the input line goes backward from the input index
+      for ( SizeValueType p = 0; p < lineSize; ++p )
+        {
+        const ComponentType *inPixel = in - p * numberOfComponents;
+        std::copy( inPixel, inPixel + numberOfComponents, out + p * numberOfComponents );
+        }
+      }
+
+    outIt.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+} // end namespace itk
+
+#endif // itkScanlineFlipImageFilter_hxx
@@ -0,0 +1,169 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkSeparableResampleImageFilter_h
+#define itkSeparableResampleImageFilter_h
+
+#include "itkResampleImageFilter.h"
+
+#include <vector>
+
+namespace itk {
+
+/** \class SeparableResampleImageFilter
+ * \brief A ResampleImageFilter with a fast path for axis aligned
+ * mappings.
+ *
+ * When the transform is linear and maps each axis of the output
+ * index onto the same axis of the input index, such as a scale and
+ * translation transform between images with the same direction, the
+ * continuous input index along each axis only depends on the output
+ * index along that axis. The nearest neighbor and linear
+ * interpolation are then separable, and their indices and weights
+ * are computed once per axis in tables. The output is computed one
+ * scanline at a time from the tables, without evaluating the
+ * transform or calling the interpolator for each pixel.
+ *
+ * When the linear mapping is not separable, such as a rotation or
+ * any other affine transform, the nearest neighbor and linear
+ * interpolations still have a fast path. The continuous input index
+ * is linear in the output index, so it is computed once per scanline
+ * and then stepped by a constant vector along the scanline. The
+ * neighbor pixels are read from the input buffer directly, without a
+ * physical point or a call to the interpolator for each pixel.
+ *
+ * The results are the same as the ResampleImageFilter, including the
+ * pixels outside the input buffer and the clamping of the linear
+ * interpolation at the border, up to floating point rounding. Any
+ * other transform or interpolator, or an extrapolator, uses the
+ * ResampleImageFilter.
+ *
+ * \note This class is only for images of scalar pixels.
+ */
+template< typename TInputImage,
+          typename TOutputImage,
+          typename TInterpolatorPrecisionType = double,
+          typename TTransformPrecisionType = TInterpolatorPrecisionType >
+class SeparableResampleImageFilter:
+    public ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+{
+public:
+  /** Standard Self typedef */
+  typedef SeparableResampleImageFilter Self;
+  typedef ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType > Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(SeparableResampleImageFilter, ResampleImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  typedef typename Superclass::InputImageType        InputImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename Superclass::TransformType         TransformType;
+  typedef typename Superclass::InterpolatorType      InterpolatorType;
+  typedef typename Superclass::PixelType             PixelType;
+  typedef typename InputImageType::PixelType         InputPixelType;
+
+  /** Enable or disable the separable and the linear mapping fast
+   * paths, on by default. */
+  itkSetMacro( UseSeparableMapping, bool );
+  itkGetConstMacro( UseSeparableMapping, bool );
+  itkBooleanMacro( UseSeparableMapping );
+
+  /** Get if the last execution used the separable fast path. */
+  itkGetConstMacro( SeparableMappingUsed, bool );
+
+  /** Get if the last execution used the fast path for a linear
+   * mapping which is not separable. */
+  itkGetConstMacro( LinearMappingUsed, bool );
+
+protected:
+
+  SeparableResampleImageFilter();
+
+  // virtual ~SeparableResampleImageFilter(); // implementation not needed
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  //
+  // Compute the per axis tables when the mapping is separable.
+  virtual void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                                     ThreadIdType threadId ) ITK_OVERRIDE;
+
+private:
+  SeparableResampleImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  enum InterpolationType
+  {
+    NearestNeighborInterpolation,
+    LinearInterpolation
+  };
+
+  // For each output index along an axis, the buffer offsets of the
+  // lower and upper input neighbors along the axis, the weight of
+  // the upper neighbor, and if the mapped index is inside the input
+  // buffer.
+  struct AxisTable
+  {
+    std::vector<OffsetValueType> m_LowerOffset;
+    std::vector<OffsetValueType> m_UpperOffset;
+    std::vector<double>          m_UpperWeight;
+    std::vector<unsigned char>   m_Inside;
+  };
+
+  bool ComputeAxisTables();
+
+  // Compute the continuous input index of the first output pixel and
+  // its steps along the output axes, for the nearest neighbor or
+  // linear interpolation with a linear transform.
+  bool ComputeLinearMapping();
+
+  void LinearMappingThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                                          ThreadIdType threadId );
+
+  PixelType CastPixelWithBounds( double value ) const;
+
+  bool              m_UseSeparableMapping;
+  bool              m_SeparableMappingUsed;
+  bool              m_LinearMappingUsed;
+  InterpolationType m_Interpolation;
+  AxisTable         m_AxisTables[ImageDimension];
+
+  // the continuous input index of the first output pixel, and the
+  // step of the continuous input index along each output axis
+  double            m_MappingOrigin[ImageDimension];
+  double            m_MappingSteps[ImageDimension][ImageDimension];
+};
+
+
+} // end namespace itk
+
+
+#include "itkSeparableResampleImageFilter.hxx"
+
+#endif // itkSeparableResampleImageFilter_h
@@ -0,0 +1,543 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkSeparableResampleImageFilter_hxx
+#define itkSeparableResampleImageFilter_hxx
+
+#include "itkSeparableResampleImageFilter.h"
+
+#include "itkContinuousIndex.h"
+#include "itkImageScanlineIterator.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType, typename TTransformPrecisionType >
+SeparableResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+::SeparableResampleImageFilter()
+  : m_UseSeparableMapping( true ),
+    m_SeparableMappingUsed( false ),
+    m_LinearMappingUsed( false ),
+    m_Interpolation( LinearInterpolation )
+{
+}
+
+//
+// BeforeThreadedGenerateData
+//
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType, typename TTransformPrecisionType >
+void
+SeparableResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  this->m_SeparableMappingUsed = this->m_UseSeparableMapping && this->ComputeAxisTables();
+  this->m_LinearMappingUsed = this->m_UseSeparableMapping && !this->m_SeparableMappingUsed && this->ComputeLinearMapping();
+}
+
+//
+// ComputeAxisTables
+//
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType, typename TTransformPrecisionType >
+bool
+SeparableResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+::ComputeAxisTables()
+{
+  typedef LinearInterpolateImageFunction< InputImageType, TInterpolatorPrecisionType >          LinearInterpolatorType;
+  typedef NearestNeighborInterpolateImageFunction< InputImageType, TInterpolatorPrecisionType > NearestNeighborInterpolatorType;
+
+  const TransformType *transform = this->GetTransform();
+  const InterpolatorType *interpolator = this->GetInterpolator();
+  if ( transform == ITK_NULLPTR || !transform->IsLinear() || this->GetExtrapolator() != ITK_NULLPTR )
+    {
+    return false;
+    }
+
+  if ( dynamic_cast< const LinearInterpolatorType * >( interpolator ) != ITK_NULLPTR )
+    {
+    this->m_Interpolation = LinearInterpolation;
+    }
+  else if ( dynamic_cast< const NearestNeighborInterpolatorType * >( interpolator ) != ITK_NULLPTR )
+    {
+    this->m_Interpolation = NearestNeighborInterpolation;
+    }
+  else
+    {
+    return false;
+    }
+
+  const InputImageType *inputPtr = this->GetInput();
+  const OutputImageType *outputPtr = this->GetOutput();
+
+  const typename InputImageType::RegionType inputRegion = inputPtr->GetBufferedRegion();
+  const typename OutputImageType::RegionType outputRegion = outputPtr->GetLargestPossibleRegion();
+  const OffsetValueType *offsetTable = inputPtr->GetOffsetTable();
+
+  typedef ContinuousIndex< double, ImageDimension > ContinuousIndexType;
+  typename OutputImageType::IndexType index = outputRegion.GetIndex();
+  typename OutputImageType::PointType point;
+  ContinuousIndexType origin;
+  outputPtr->TransformIndexToPhysicalPoint( index, point );
+  inputPtr->TransformPhysicalPointToContinuousIndex( transform->TransformPoint( point ), origin );
+
+  // The mapping is separable if moving along one output axis does not
+  // move the input index along the other axes, within a tolerance
+  // accumulated over the output.
+  const double tolerance = 1e-6;
+
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    const SizeValueType size = outputRegion.GetSize( d );
+    AxisTable &table = this->m_AxisTables[d];
+    table.m_LowerOffset.resize( size );
+    table.m_UpperOffset.resize( size );
+    table.m_UpperWeight.resize( size );
+    table.m_Inside.resize( size );
+
+    const IndexValueType start = inputRegion.GetIndex( d );
+    const IndexValueType end = start + static_cast< IndexValueType >( inputRegion.GetSize( d ) ) - 1;
+
+    index = outputRegion.GetIndex();
+    for ( SizeValueType i = 0; i < size; ++i )
+      {
+      index[d] = outputRegion.GetIndex( d ) + static_cast< IndexValueType >( i );
+
+      ContinuousIndexType cindex;
+      outputPtr->TransformIndexToPhysicalPoint( index, point );
+      inputPtr->TransformPhysicalPointToContinuousIndex( transform->TransformPoint( point ), cindex );
+
+      for ( unsigned int e = 0; e < ImageDimension; ++e )
+        {
+        if ( e != d && std::abs( cindex[e] - origin[e] ) > tolerance )
+          {
+          return false;
+          }
+        }
+
+      // the same bounds as the interpolator's IsInsideBuffer
+      const double c = cindex[d];
+      table.m_Inside[i] = ( c >= start - 0.5 && c < end + 0.5 );
+      if ( !table.m_Inside[i] )
+        {
+        table.m_LowerOffset[i] = table.m_UpperOffset[i] = 0;
+        table.m_UpperWeight[i] = 0.0;
+        continue;
+        }
+
+      IndexValueType lower;
+      IndexValueType upper;
+      double weight = 0.0;
+      if ( this->m_Interpolation == NearestNeighborInterpolation )
+        {
+        lower = upper = Math::RoundHalfIntegerUp< IndexValueType >( c );
+        }
+      else
+        {
+        // as the linear interpolator, the neighbors are clamped to the
+        // buffer
+        lower = std::max( Math::Floor< IndexValueType >( c ), start );
+        weight = c - static_cast< double >( lower );
+        upper = lower + 1;
+        if ( weight <= 0.0 || upper > end )
+          {
+          weight = 0.0;
+          upper = lower;
+          }
+        }
+
+      table.m_LowerOffset[i] = ( lower - start ) * offsetTable[d];
+      table.m_UpperOffset[i] = ( upper - start ) * offsetTable[d];
+      table.m_UpperWeight[i] = weight;
+      }
+    }
+
+  return true;
+}
+
+//
+// ComputeLinearMapping
+//
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType, typename TTransformPrecisionType >
+bool
+SeparableResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+::ComputeLinearMapping()
+{
+  typedef LinearInterpolateImageFunction< InputImageType, TInterpolatorPrecisionType >          LinearInterpolatorType;
+  typedef NearestNeighborInterpolateImageFunction< InputImageType, TInterpolatorPrecisionType > NearestNeighborInterpolatorType;
+
+  const TransformType *transform = this->GetTransform();
+  const InterpolatorType *interpolator = this->GetInterpolator();
+  if ( transform == ITK_NULLPTR || !transform->IsLinear() || this->GetExtrapolator() != ITK_NULLPTR )
+    {
+    return false;
+    }
+
+  if ( dynamic_cast< const LinearInterpolatorType * >( interpolator ) != ITK_NULLPTR )
+    {
+    this->m_Interpolation = LinearInterpolation;
+    }
+  else if ( dynamic_cast< const NearestNeighborInterpolatorType * >( interpolator ) != ITK_NULLPTR )
+    {
+    this->m_Interpolation = NearestNeighborInterpolation;
+    }
+  else
+    {
+    return false;
+    }
+
+  const InputImageType *inputPtr = this->GetInput();
+  const OutputImageType *outputPtr = this->GetOutput();
+  const typename OutputImageType::RegionType outputRegion = outputPtr->GetLargestPossibleRegion();
+
+  typedef ContinuousIndex< double, ImageDimension > ContinuousIndexType;
+  typename OutputImageType::IndexType index = outputRegion.GetIndex();
+  typename OutputImageType::PointType point;
+  ContinuousIndexType cindex;
+  outputPtr->TransformIndexToPhysicalPoint( index, point );
+  inputPtr->TransformPhysicalPointToContinuousIndex( transform->TransformPoint( point ), cindex );
+  for ( unsigned int e = 0; e < ImageDimension; ++e )
+    {
+    this->m_MappingOrigin[e] = cindex[e];
+    }
+
+  // The steps are measured across the whole output along each axis,
+  // to reduce the rounding error.
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    const IndexValueType steps = std::max< IndexValueType >( static_cast< IndexValueType >( outputRegion.GetSize( d ) ) - 1, 1 );
+    index = outputRegion.GetIndex();
+    index[d] += steps;
+    outputPtr->TransformIndexToPhysicalPoint( index, point );
+    inputPtr->TransformPhysicalPointToContinuousIndex( transform->TransformPoint( point ), cindex );
+    for ( unsigned int e = 0; e < ImageDimension; ++e )
+      {
+      this->m_MappingSteps[d][e] = ( cindex[e] - this->m_MappingOrigin[e] ) / steps;
+      }
+    }
+
+  return true;
+}
+
+//
+// CastPixelWithBounds
+//
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType, typename TTransformPrecisionType >
+typename SeparableResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >::PixelType
+SeparableResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+::CastPixelWithBounds( double value ) const
+{
+  // as the ResampleImageFilter, the value is clamped to the range of
+  // the output pixel
+  const double minValue = static_cast< double >( NumericTraits< PixelType >::NonpositiveMin() );
+  const double maxValue = static_cast< double >( NumericTraits< PixelType >::max() );
+  if ( value < minValue )
+    {
+    return NumericTraits< PixelType >::NonpositiveMin();
+    }
+  if ( value > maxValue )
+    {
+    return NumericTraits< PixelType >::max();
+    }
+  return static_cast< PixelType >( value );
+}
+
+//
+// ThreadedGenerateData
+//
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType, typename TTransformPrecisionType >
+void
+SeparableResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        ThreadIdType threadId )
+{
+  if ( this->m_LinearMappingUsed )
+    {
+    this->LinearMappingThreadedGenerateData( outputRegionForThread, threadId );
+    return;
+    }
+
+  if ( !this->m_SeparableMappingUsed )
+    {
+    Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+    return;
+    }
+
+  if ( outputRegionForThread.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  // the neighbors along the axes other than the first, for each
+  // scanline
+  const unsigned int MaximumNumberOfCorners = 1u << ( ImageDimension - 1 );
+
+  OutputImageType *outputPtr = this->GetOutput();
+  const InputPixelType *inBuffer = this->GetInput()->GetBufferPointer();
+  const typename OutputImageType::IndexType outputStart = outputPtr->GetLargestPossibleRegion().GetIndex();
+  const PixelType defaultValue = this->GetDefaultPixelValue();
+  const AxisTable &table0 = this->m_AxisTables[0];
+  const bool linear = ( this->m_Interpolation == LinearInterpolation );
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize( 0 ) );
+
+  ImageScanlineIterator< OutputImageType > outIt( outputPtr, outputRegionForThread );
+  while ( !outIt.IsAtEnd() )
+    {
+    const typename OutputImageType::IndexType index = outIt.GetIndex();
+
+    OffsetValueType cornerOffsets[MaximumNumberOfCorners];
+    double cornerWeights[MaximumNumberOfCorners];
+    unsigned int numberOfCorners = 1;
+    cornerOffsets[0] = 0;
+    cornerWeights[0] = 1.0;
+
+    bool inside = true;
+    for ( unsigned int d = 1; d < ImageDimension && inside; ++d )
+      {
+      const AxisTable &table = this->m_AxisTables[d];
+      const SizeValueType k = static_cast< SizeValueType >( index[d] - outputStart[d] );
+      inside = table.m_Inside[k];
+
+      const double weight = table.m_UpperWeight[k];
+      if ( weight == 0.0 )
+        {
+        for ( unsigned int c = 0; c < numberOfCorners; ++c )
+          {
+          cornerOffsets[c] += table.m_LowerOffset[k];
+          }
+        continue;
+        }
+      for ( unsigned int c = 0; c < numberOfCorners; ++c )
+        {
+        cornerOffsets[c + numberOfCorners] = cornerOffsets[c] + table.m_UpperOffset[k];
+        cornerWeights[c + numberOfCorners] = cornerWeights[c] * weight;
+        cornerOffsets[c] += table.m_LowerOffset[k];
+        cornerWeights[c] *= 1.0 - weight;
+        }
+      numberOfCorners *= 2;
+      }
+
+    SizeValueType k = static_cast< SizeValueType >( index[0] - outputStart[0] );
+    while ( !outIt.IsAtEndOfLine() )
+      {
+      if ( !inside || !table0.m_Inside[k] )
+        {
+        outIt.Set( defaultValue );
+        }
+      else if ( !linear )
+        {
+        outIt.Set( CastPixelWithBounds( static_cast< double >( inBuffer[cornerOffsets[0] + table0.m_LowerOffset[k]] ) ) );
+        }
+      else
+        {
+        const OffsetValueType lower = table0.m_LowerOffset[k];
+        const OffsetValueType upper = table0.m_UpperOffset[k];
+        const double weight = table0.m_UpperWeight[k];
+
+        double value = 0.0;
+        for ( unsigned int c = 0; c < numberOfCorners; ++c )
+          {
+          const InputPixelType *p = inBuffer + cornerOffsets[c];
+          const double v0 = static_cast< double >( p[lower] );
+          value += cornerWeights[c] * ( v0 + ( static_cast< double >( p[upper] ) - v0 ) * weight );
+          }
+        outIt.Set( CastPixelWithBounds( value ) );
+        }
+      ++outIt;
+      ++k;
+      }
+    outIt.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+//
+// LinearMappingThreadedGenerateData
+//
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType, typename TTransformPrecisionType >
+void
+SeparableResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+::LinearMappingThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                                     ThreadIdType threadId )
+{
+  if ( outputRegionForThread.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  OutputImageType *outputPtr = this->GetOutput();
+  const InputImageType *inputPtr = this->GetInput();
+  const InputPixelType *inBuffer = inputPtr->GetBufferPointer();
+  const typename InputImageType::RegionType inputRegion = inputPtr->GetBufferedRegion();
+  const OffsetValueType *offsetTable = inputPtr->GetOffsetTable();
+  const typename OutputImageType::IndexType outputStart = outputPtr->GetLargestPossibleRegion().GetIndex();
+  const PixelType defaultValue = this->GetDefaultPixelValue();
+
+  const bool linear = ( this->m_Interpolation == LinearInterpolation );
+  const unsigned int NumberOfCorners = 1u << ImageDimension;
+
+  // the same bounds as the interpolator's IsInsideBuffer
+  IndexValueType inputStart[ImageDimension];
+  IndexValueType inputEnd[ImageDimension];
+  double lowerBound[ImageDimension];
+  double upperBound[ImageDimension];
+  for ( unsigned int e = 0; e < ImageDimension; ++e )
+    {
+    inputStart[e] = inputRegion.GetIndex( e );
+    inputEnd[e] = inputStart[e] + static_cast< IndexValueType >( inputRegion.GetSize( e ) ) - 1;
+    lowerBound[e] = inputStart[e] - 0.5;
+    upperBound[e] = inputEnd[e] + 0.5;
+    }
+
+  const double *step = this->m_MappingSteps[0];
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize( 0 ) );
+
+  ImageScanlineIterator< OutputImageType > outIt( outputPtr, outputRegionForThread );
+  while ( !outIt.IsAtEnd() )
+    {
+    const typename OutputImageType::IndexType index = outIt.GetIndex();
+
+    // the continuous input index of the first pixel of the scanline
+    double lineStart[ImageDimension];
+    for ( unsigned int e = 0; e < ImageDimension; ++e )
+      {
+      lineStart[e] = this->m_MappingOrigin[e];
+      }
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      const double k = static_cast< double >( index[d] - outputStart[d] );
+      for ( unsigned int e = 0; e < ImageDimension; ++e )
+        {
+        lineStart[e] += this->m_MappingSteps[d][e] * k;
+        }
+      }
+
+    double k = 0.0;
+    while ( !outIt.IsAtEndOfLine() )
+      {
+      // the offsets of the lower and upper neighbors along each axis,
+      // and the weight of the upper neighbor
+      OffsetValueType lowerOffsets[ImageDimension];
+      OffsetValueType upperOffsets[ImageDimension];
+      double upperWeights[ImageDimension];
+      bool inside = true;
+      for ( unsigned int e = 0; e < ImageDimension; ++e )
+        {
+        const double c = lineStart[e] + step[e] * k;
+        if ( !( c >= lowerBound[e] && c < upperBound[e] ) )
+          {
+          inside = false;
+          break;
+          }
+
+        if ( !linear )
+          {
+          lowerOffsets[e] = ( Math::RoundHalfIntegerUp< IndexValueType >( c ) - inputStart[e] ) * offsetTable[e];
+          continue;
+          }
+
+        // as the linear interpolator, the neighbors are clamped to
+        // the buffer
+        const IndexValueType lower = std::max( Math::Floor< IndexValueType >( c ), inputStart[e] );
+        double weight = c - static_cast< double >( lower );
+        IndexValueType upper = lower + 1;
+        if ( weight <= 0.0 || upper > inputEnd[e] )
+          {
+          weight = 0.0;
+          upper = lower;
+          }
+        lowerOffsets[e] = ( lower - inputStart[e] ) * offsetTable[e];
+        upperOffsets[e] = ( upper - inputStart[e] ) * offsetTable[e];
+        upperWeights[e] = weight;
+        }
+
+      if ( !inside )
+        {
+        outIt.Set( defaultValue );
+        }
+      else if ( !linear )
+        {
+        OffsetValueType offset = 0;
+        for ( unsigned int e = 0; e < ImageDimension; ++e )
+          {
+          offset += lowerOffsets[e];
+          }
+        outIt.Set( CastPixelWithBounds( static_cast< double >( inBuffer[offset] ) ) );
+        }
+      else
+        {
+        double value = 0.0;
+        for ( unsigned int corner = 0; corner < NumberOfCorners; ++corner )
+          {
+          OffsetValueType offset = 0;
+          double weight = 1.0;
+          for ( unsigned int e = 0; e < ImageDimension; ++e )
+            {
+            if ( corner & ( 1u << e ) )
+              {
+              offset += upperOffsets[e];
+              weight *= upperWeights[e];
+              }
+            else
+              {
+              offset += lowerOffsets[e];
+              weight *= 1.0 - upperWeights[e];
+              }
+            }
+          if ( weight != 0.0 )
+            {
+            value += weight * static_cast< double >( inBuffer[offset] );
+            }
+          }
+        outIt.Set( CastPixelWithBounds( value ) );
+        }
+      ++outIt;
+      k += 1.0;
+      }
+    outIt.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+//
+// PrintSelf
+//
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType, typename TTransformPrecisionType >
+void
+SeparableResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTransformPrecisionType >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "UseSeparableMapping: " << this->m_UseSeparableMapping << std::endl;
+  os << indent << "SeparableMappingUsed: " << this->m_SeparableMappingUsed << std::endl;
+  os << indent << "LinearMappingUsed: " << this->m_LinearMappingUsed << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkSeparableResampleImageFilter_hxx
@@ -0,0 +1,97 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkSlidingHistogramMedianImageFilter_hxx
+#define itkSlidingHistogramMedianImageFilter_hxx
+
+#include "itkSlidingHistogramMedianImageFilter.h"
+
+#include "itkProgressReporter.h"
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TInputImage, typename TOutputImage >
+SlidingHistogramMedianImageFilter< TInputImage, TOutputImage >
+::SlidingHistogramMedianImageFilter()
+  : m_UseSlidingHistogram( true ),
+    m_SlidingHistogramUsed( false )
+{
+}
+
+//
+// BeforeThreadedGenerateData
+//
+template< typename TInputImage, typename TOutputImage >
+void
+SlidingHistogramMedianImageFilter< TInputImage, TOutputImage >
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  // The requested region of the input contains the radius around the
+  // output, except at the border of the buffer, so its pixels are the
+  // pixels of the median.
+  const InputImageType *input = this->GetInput();
+  this->m_SlidingHistogramUsed = this->m_UseSlidingHistogram
+    && SlidingHistogramType::IsPixelTypeSupported()
+    && this->m_SlidingHistogram.Initialize( input,
+                                            input->GetRequestedRegion(),
+                                            this->GetOutput()->GetRequestedRegion(),
+                                            this->GetRadius(),
+                                            0.5,
+                                            false );
+}
+
+//
+// ThreadedGenerateData
+//
+template< typename TInputImage, typename TOutputImage >
+void
+SlidingHistogramMedianImageFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        ThreadIdType threadId )
+{
+  if ( !this->m_SlidingHistogramUsed )
+    {
+    Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+    return;
+    }
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize( 0 ) );
+  this->m_SlidingHistogram.Compute( this->GetOutput(), outputRegionForThread, progress );
+}
+
+//
+// PrintSelf
+//
+template< typename TInputImage, typename TOutputImage >
+void
+SlidingHistogramMedianImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "UseSlidingHistogram: " << this->m_UseSlidingHistogram << std::endl;
+  os << indent << "SlidingHistogramUsed: " << this->m_SlidingHistogramUsed << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkSlidingHistogramMedianImageFilter_hxx
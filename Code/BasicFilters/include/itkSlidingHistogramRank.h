@@ -0,0 +1,144 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkSlidingHistogramRank_h
+#define itkSlidingHistogramRank_h
+
+#include "itkImage.h"
+#include "itkProgressReporter.h"
+
+#include <vector>
+
+namespace itk {
+
+/** \class SlidingHistogramRank
+ * \brief Compute the value of a rank in a box around each pixel with
+ * sliding histograms.
+ *
+ * This is the constant time median filter of Perreault and Hebert,
+ * "Median Filtering in Constant Time", IEEE Transactions on Image
+ * Processing, 16(9), 2007, extended to more dimensions.
+ *
+ * A column histogram is kept for each index along the first axis,
+ * with the pixels of the box along the other axes. Moving to the
+ * next line along the second axis adds one slab of the box and
+ * removes another in each column histogram, and moving along a line
+ * adds one column histogram to the kernel histogram and removes
+ * another. The histograms have a coarse and a fine level, and the
+ * fine level of the kernel histogram is only updated for the coarse
+ * bin of the rank.
+ *
+ * The cost per pixel does not depend on the radius for 2D images,
+ * and is linear in the radius along the third axis for 3D images. It
+ * grows with the square root of the range of the pixel values.
+ *
+ * The pixels are integers of at most 16 bits. The histograms have a
+ * bin for each value between the minimum and the maximum of the
+ * input, so the memory of the column histograms of each thread is
+ * bounded by MaximumHistogramMemory.
+ *
+ * The rank selects the value of index floor( rank * (n-1) ) of the n
+ * sorted values in the box. The pixels outside of the input region
+ * are either excluded from the box, as in the RankImageFilter, or
+ * replaced with the nearest pixel of the region, as with the
+ * ZeroFluxNeumannBoundaryCondition of the MedianImageFilter.
+ */
+template< typename TInputImage, typename TOutputImage >
+class SlidingHistogramRank
+{
+public:
+  typedef TInputImage                          InputImageType;
+  typedef TOutputImage                         OutputImageType;
+  typedef typename InputImageType::PixelType   InputPixelType;
+  typedef typename OutputImageType::PixelType  OutputPixelType;
+  typedef typename InputImageType::RegionType  InputImageRegionType;
+  typedef typename OutputImageType::RegionType OutputImageRegionType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  typedef Size< ImageDimension > RadiusType;
+
+  /** The maximum memory in bytes of the column histograms of a
+   * thread. */
+  itkStaticConstMacro(MaximumHistogramMemory, SizeValueType, 32u << 20);
+
+  SlidingHistogramRank();
+
+  /** Return true if the pixel type of the input is an integer of at
+   * most 16 bits. */
+  static bool IsPixelTypeSupported();
+
+  /** Compute the range of the pixels of the input and the size of
+   * the histograms.
+   *
+   * The pixels in inputRegion are used, it must be inside the buffer
+   * of the input. Returns false if the pixel type is not supported,
+   * or if the column histograms for a region with the width of
+   * outputRegion exceed MaximumHistogramMemory.
+   */
+  bool Initialize( const InputImageType *input,
+                   const InputImageRegionType &inputRegion,
+                   const OutputImageRegionType &outputRegion,
+                   const RadiusType &radius,
+                   double rank,
+                   bool excludeOutsidePixels );
+
+  /** Compute the output in a region inside the input region. The
+   * progress is reported for each line. Different regions may be
+   * computed concurrently. */
+  void Compute( OutputImageType *output,
+                const OutputImageRegionType &region,
+                ProgressReporter &progress ) const;
+
+private:
+  typedef uint32_t CountType;
+
+  // Map an index along an axis into the input region. Returns false
+  // if the pixel is excluded.
+  bool MapIndex( IndexValueType index, unsigned int axis, IndexValueType &mapped ) const;
+
+  // Add or remove the pixels of the slab at a row, an index along
+  // the second axis, to the column histograms.
+  void UpdateColumns( IndexValueType row,
+                      bool add,
+                      const std::vector< OffsetValueType > &slabOffsets,
+                      IndexValueType columnStart,
+                      SizeValueType numberOfColumns,
+                      CountType *columnFine,
+                      CountType *columnCoarse,
+                      CountType *columnTotal ) const;
+
+  const InputImageType *m_Input;
+  InputImageRegionType  m_InputRegion;
+  RadiusType            m_Radius;
+  double                m_Rank;
+  bool                  m_ExcludeOutsidePixels;
+
+  // the bin of a pixel is its value minus the minimum
+  IndexValueType m_MinimumValue;
+  // the fine bins of a coarse bin, as a power of 2
+  unsigned int   m_FineShift;
+  SizeValueType  m_NumberOfCoarseBins;
+  SizeValueType  m_NumberOfBins;
+};
+
+} // end namespace itk
+
+
+#include "itkSlidingHistogramRank.hxx"
+
+#endif // itkSlidingHistogramRank_h
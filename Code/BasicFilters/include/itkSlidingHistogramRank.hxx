@@ -0,0 +1,430 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkSlidingHistogramRank_hxx
+#define itkSlidingHistogramRank_hxx
+
+#include "itkSlidingHistogramRank.h"
+
+#include "itkImageScanlineConstIterator.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TInputImage, typename TOutputImage >
+SlidingHistogramRank< TInputImage, TOutputImage >
+::SlidingHistogramRank()
+  : m_Input( ITK_NULLPTR ),
+    m_Rank( 0.5 ),
+    m_ExcludeOutsidePixels( false ),
+    m_MinimumValue( 0 ),
+    m_FineShift( 0 ),
+    m_NumberOfCoarseBins( 0 ),
+    m_NumberOfBins( 0 )
+{
+  m_Radius.Fill( 0 );
+}
+
+//
+// IsPixelTypeSupported
+//
+template< typename TInputImage, typename TOutputImage >
+bool
+SlidingHistogramRank< TInputImage, TOutputImage >
+::IsPixelTypeSupported()
+{
+  return NumericTraits< InputPixelType >::is_integer
+    && NumericTraits< InputPixelType >::GetLength() == 1
+    && sizeof( InputPixelType ) <= 2;
+}
+
+//
+// Initialize
+//
+template< typename TInputImage, typename TOutputImage >
+bool
+SlidingHistogramRank< TInputImage, TOutputImage >
+::Initialize( const InputImageType *input,
+              const InputImageRegionType &inputRegion,
+              const OutputImageRegionType &outputRegion,
+              const RadiusType &radius,
+              double rank,
+              bool excludeOutsidePixels )
+{
+  if ( !IsPixelTypeSupported() || ImageDimension < 2 || inputRegion.GetNumberOfPixels() == 0 )
+    {
+    return false;
+    }
+
+  this->m_Input = input;
+  this->m_InputRegion = inputRegion;
+  this->m_Radius = radius;
+  this->m_Rank = std::min( std::max( rank, 0.0 ), 1.0 );
+  this->m_ExcludeOutsidePixels = excludeOutsidePixels;
+
+  // the range of the pixels
+  IndexValueType minimum = NumericTraits< IndexValueType >::max();
+  IndexValueType maximum = NumericTraits< IndexValueType >::NonpositiveMin();
+  ImageScanlineConstIterator< InputImageType > it( input, inputRegion );
+  while ( !it.IsAtEnd() )
+    {
+    while ( !it.IsAtEndOfLine() )
+      {
+      const IndexValueType value = static_cast< IndexValueType >( it.Get() );
+      minimum = std::min( minimum, value );
+      maximum = std::max( maximum, value );
+      ++it;
+      }
+    it.NextLine();
+    }
+  const SizeValueType range = static_cast< SizeValueType >( maximum - minimum ) + 1;
+
+  // about as many coarse bins as fine bins in each coarse bin
+  unsigned int fineShift = 0;
+  while ( ( SizeValueType( 1 ) << ( 2 * fineShift ) ) < range )
+    {
+    ++fineShift;
+    }
+  this->m_MinimumValue = minimum;
+  this->m_FineShift = fineShift;
+  this->m_NumberOfCoarseBins = ( range + ( SizeValueType( 1 ) << fineShift ) - 1 ) >> fineShift;
+  this->m_NumberOfBins = this->m_NumberOfCoarseBins << fineShift;
+
+  const SizeValueType numberOfColumns = std::min( outputRegion.GetSize( 0 ) + 2 * radius[0], inputRegion.GetSize( 0 ) );
+  const SizeValueType memory = numberOfColumns * ( this->m_NumberOfBins + this->m_NumberOfCoarseBins + 1 ) * sizeof( CountType );
+  return memory <= MaximumHistogramMemory;
+}
+
+//
+// MapIndex
+//
+template< typename TInputImage, typename TOutputImage >
+bool
+SlidingHistogramRank< TInputImage, TOutputImage >
+::MapIndex( IndexValueType index, unsigned int axis, IndexValueType &mapped ) const
+{
+  const IndexValueType start = this->m_InputRegion.GetIndex( axis );
+  const IndexValueType end = start + static_cast< IndexValueType >( this->m_InputRegion.GetSize( axis ) ) - 1;
+  if ( index >= start && index <= end )
+    {
+    mapped = index;
+    return true;
+    }
+  if ( this->m_ExcludeOutsidePixels )
+    {
+    return false;
+    }
+  mapped = ( index < start ) ? start : end;
+  return true;
+}
+
+//
+// UpdateColumns
+//
+template< typename TInputImage, typename TOutputImage >
+void
+SlidingHistogramRank< TInputImage, TOutputImage >
+::UpdateColumns( IndexValueType row,
+                 bool add,
+                 const std::vector< OffsetValueType > &slabOffsets,
+                 IndexValueType columnStart,
+                 SizeValueType numberOfColumns,
+                 CountType *columnFine,
+                 CountType *columnCoarse,
+                 CountType *columnTotal ) const
+{
+  IndexValueType mapped;
+  if ( !this->MapIndex( row, 1, mapped ) )
+    {
+    return;
+    }
+
+  const InputPixelType *inBuffer = this->m_Input->GetBufferPointer();
+  const OffsetValueType *offsetTable = this->m_Input->GetOffsetTable();
+  const typename InputImageType::IndexType bufferStart = this->m_Input->GetBufferedRegion().GetIndex();
+  const SizeValueType numberOfBins = this->m_NumberOfBins;
+  const SizeValueType numberOfCoarseBins = this->m_NumberOfCoarseBins;
+  const unsigned int fineShift = this->m_FineShift;
+
+  const OffsetValueType rowOffset = ( columnStart - bufferStart[0] ) * offsetTable[0]
+    + ( mapped - bufferStart[1] ) * offsetTable[1];
+  for ( size_t s = 0; s < slabOffsets.size(); ++s )
+    {
+    const InputPixelType *p = inBuffer + rowOffset + slabOffsets[s];
+    for ( SizeValueType c = 0; c < numberOfColumns; ++c )
+      {
+      const SizeValueType bin = static_cast< SizeValueType >( static_cast< IndexValueType >( p[c] ) - this->m_MinimumValue );
+      if ( add )
+        {
+        ++columnFine[c * numberOfBins + bin];
+        ++columnCoarse[c * numberOfCoarseBins + ( bin >> fineShift )];
+        ++columnTotal[c];
+        }
+      else
+        {
+        --columnFine[c * numberOfBins + bin];
+        --columnCoarse[c * numberOfCoarseBins + ( bin >> fineShift )];
+        --columnTotal[c];
+        }
+      }
+    }
+}
+
+//
+// Compute
+//
+template< typename TInputImage, typename TOutputImage >
+void
+SlidingHistogramRank< TInputImage, TOutputImage >
+::Compute( OutputImageType *output,
+           const OutputImageRegionType &region,
+           ProgressReporter &progress ) const
+{
+  if ( region.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  const OffsetValueType *offsetTable = this->m_Input->GetOffsetTable();
+  const typename InputImageType::IndexType bufferStart = this->m_Input->GetBufferedRegion().GetIndex();
+
+  const SizeValueType numberOfBins = this->m_NumberOfBins;
+  const SizeValueType numberOfCoarseBins = this->m_NumberOfCoarseBins;
+  const unsigned int fineShift = this->m_FineShift;
+  const SizeValueType numberOfFineBins = SizeValueType( 1 ) << fineShift;
+
+  // The columns are the indices along the first axis in the input
+  // region and within the radius of the output region. The pixels
+  // out of the input region along the first axis use the column of
+  // their mapped index, or no column when excluded.
+  const IndexValueType r0 = static_cast< IndexValueType >( this->m_Radius[0] );
+  const IndexValueType x0 = region.GetIndex( 0 );
+  const IndexValueType x1 = x0 + static_cast< IndexValueType >( region.GetSize( 0 ) ) - 1;
+  const IndexValueType columnStart = std::max( x0 - r0, this->m_InputRegion.GetIndex( 0 ) );
+  const IndexValueType columnEnd = std::min( x1 + r0,
+                                             this->m_InputRegion.GetIndex( 0 )
+                                             + static_cast< IndexValueType >( this->m_InputRegion.GetSize( 0 ) ) - 1 );
+  const SizeValueType numberOfColumns = static_cast< SizeValueType >( columnEnd - columnStart + 1 );
+
+  std::vector< OffsetValueType > columnOfIndex( region.GetSize( 0 ) + 2 * r0 );
+  for ( IndexValueType x = x0 - r0; x <= x1 + r0; ++x )
+    {
+    IndexValueType mapped;
+    columnOfIndex[x - x0 + r0] = this->MapIndex( x, 0, mapped ) ? mapped - columnStart : -1;
+    }
+
+  std::vector< CountType > columnFine( numberOfColumns * numberOfBins );
+  std::vector< CountType > columnCoarse( numberOfColumns * numberOfCoarseBins );
+  std::vector< CountType > columnTotal( numberOfColumns );
+
+  std::vector< CountType > kernelFine( numberOfBins );
+  std::vector< CountType > kernelCoarse( numberOfCoarseBins );
+  std::vector< IndexValueType > kernelFineIndex( numberOfCoarseBins );
+
+  // the buffer offsets of the pixels of a slab, along the axes after
+  // the second one
+  std::vector< OffsetValueType > slabOffsets;
+
+  // the lines of the region, with the second axis varying fastest
+  typename OutputImageType::IndexType lineIndex = region.GetIndex();
+  const IndexValueType y0 = region.GetIndex( 1 );
+  const IndexValueType y1 = y0 + static_cast< IndexValueType >( region.GetSize( 1 ) ) - 1;
+  const IndexValueType r1 = static_cast< IndexValueType >( this->m_Radius[1] );
+
+  bool done = false;
+  while ( !done )
+    {
+    // the slab of the box around the line
+    slabOffsets.assign( 1, 0 );
+    for ( unsigned int d = 2; d < ImageDimension; ++d )
+      {
+      std::vector< OffsetValueType > offsets;
+      const IndexValueType rd = static_cast< IndexValueType >( this->m_Radius[d] );
+      for ( IndexValueType i = lineIndex[d] - rd; i <= lineIndex[d] + rd; ++i )
+        {
+        IndexValueType mapped;
+        if ( this->MapIndex( i, d, mapped ) )
+          {
+          for ( size_t j = 0; j < slabOffsets.size(); ++j )
+            {
+            offsets.push_back( slabOffsets[j] + ( mapped - bufferStart[d] ) * offsetTable[d] );
+            }
+          }
+        }
+      slabOffsets.swap( offsets );
+      }
+
+    for ( IndexValueType y = y0; y <= y1; ++y )
+      {
+      // the column histograms of the first line are computed, the
+      // next lines add and remove one slab
+      if ( y == y0 )
+        {
+        std::fill( columnFine.begin(), columnFine.end(), 0 );
+        std::fill( columnCoarse.begin(), columnCoarse.end(), 0 );
+        std::fill( columnTotal.begin(), columnTotal.end(), 0 );
+        for ( IndexValueType row = y - r1; row <= y + r1; ++row )
+          {
+          this->UpdateColumns( row, true, slabOffsets, columnStart, numberOfColumns,
+                               &columnFine[0], &columnCoarse[0], &columnTotal[0] );
+          }
+        }
+      else
+        {
+        this->UpdateColumns( y + r1, true, slabOffsets, columnStart, numberOfColumns,
+                             &columnFine[0], &columnCoarse[0], &columnTotal[0] );
+        this->UpdateColumns( y - r1 - 1, false, slabOffsets, columnStart, numberOfColumns,
+                             &columnFine[0], &columnCoarse[0], &columnTotal[0] );
+        }
+
+      // the kernel histogram along the line
+      std::fill( kernelCoarse.begin(), kernelCoarse.end(), 0 );
+      std::fill( kernelFineIndex.begin(), kernelFineIndex.end(), NumericTraits< IndexValueType >::NonpositiveMin() );
+      SizeValueType kernelTotal = 0;
+      for ( IndexValueType x = x0 - r0; x <= x0 + r0; ++x )
+        {
+        const OffsetValueType c = columnOfIndex[x - x0 + r0];
+        if ( c >= 0 )
+          {
+          for ( SizeValueType b = 0; b < numberOfCoarseBins; ++b )
+            {
+            kernelCoarse[b] += columnCoarse[c * numberOfCoarseBins + b];
+            }
+          kernelTotal += columnTotal[c];
+          }
+        }
+
+      lineIndex[1] = y;
+      OutputPixelType *out = output->GetBufferPointer() + output->ComputeOffset( lineIndex );
+
+      for ( IndexValueType x = x0; x <= x1; ++x )
+        {
+        if ( x > x0 )
+          {
+          const OffsetValueType added = columnOfIndex[x + r0 - x0 + r0];
+          const OffsetValueType removed = columnOfIndex[x - r0 - 1 - x0 + r0];
+          if ( added >= 0 )
+            {
+            for ( SizeValueType b = 0; b < numberOfCoarseBins; ++b )
+              {
+              kernelCoarse[b] += columnCoarse[added * numberOfCoarseBins + b];
+              }
+            kernelTotal += columnTotal[added];
+            }
+          if ( removed >= 0 )
+            {
+            for ( SizeValueType b = 0; b < numberOfCoarseBins; ++b )
+              {
+              kernelCoarse[b] -= columnCoarse[removed * numberOfCoarseBins + b];
+              }
+            kernelTotal -= columnTotal[removed];
+            }
+          }
+
+        // the coarse bin of the rank
+        const SizeValueType rankIndex = static_cast< SizeValueType >( this->m_Rank * ( kernelTotal - 1 ) );
+        SizeValueType count = 0;
+        SizeValueType coarse = 0;
+        while ( count + kernelCoarse[coarse] <= rankIndex )
+          {
+          count += kernelCoarse[coarse];
+          ++coarse;
+          }
+
+        // Update the fine bins of the coarse bin to this index, from
+        // the columns in the kernel when they were last updated
+        // before the kernel moved by its width.
+        CountType *fine = &kernelFine[coarse << fineShift];
+        const IndexValueType lastIndex = kernelFineIndex[coarse];
+        if ( lastIndex == NumericTraits< IndexValueType >::NonpositiveMin() || x - lastIndex > r0 )
+          {
+          std::fill( fine, fine + numberOfFineBins, 0 );
+          for ( IndexValueType k = x - r0; k <= x + r0; ++k )
+            {
+            const OffsetValueType c = columnOfIndex[k - x0 + r0];
+            if ( c >= 0 )
+              {
+              const CountType *columnBins = &columnFine[c * numberOfBins + ( coarse << fineShift )];
+              for ( SizeValueType b = 0; b < numberOfFineBins; ++b )
+                {
+                fine[b] += columnBins[b];
+                }
+              }
+            }
+          }
+        else
+          {
+          for ( IndexValueType k = lastIndex + 1; k <= x; ++k )
+            {
+            const OffsetValueType added = columnOfIndex[k + r0 - x0 + r0];
+            const OffsetValueType removed = columnOfIndex[k - r0 - 1 - x0 + r0];
+            if ( added >= 0 )
+              {
+              const CountType *columnBins = &columnFine[added * numberOfBins + ( coarse << fineShift )];
+              for ( SizeValueType b = 0; b < numberOfFineBins; ++b )
+                {
+                fine[b] += columnBins[b];
+                }
+              }
+            if ( removed >= 0 )
+              {
+              const CountType *columnBins = &columnFine[removed * numberOfBins + ( coarse << fineShift )];
+              for ( SizeValueType b = 0; b < numberOfFineBins; ++b )
+                {
+                fine[b] -= columnBins[b];
+                }
+              }
+            }
+          }
+        kernelFineIndex[coarse] = x;
+
+        SizeValueType bin = 0;
+        while ( count + fine[bin] <= rankIndex )
+          {
+          count += fine[bin];
+          ++bin;
+          }
+
+        *out++ = static_cast< OutputPixelType >( this->m_MinimumValue
+                                                 + static_cast< IndexValueType >( ( coarse << fineShift ) + bin ) );
+        }
+      progress.CompletedPixel();
+      }
+
+    // the next line along the axes after the second one
+    done = true;
+    for ( unsigned int d = 2; d < ImageDimension; ++d )
+      {
+      if ( lineIndex[d] < region.GetIndex( d ) + static_cast< IndexValueType >( region.GetSize( d ) ) - 1 )
+        {
+        ++lineIndex[d];
+        done = false;
+        break;
+        }
+      lineIndex[d] = region.GetIndex( d );
+      }
+    }
+}
+
+} // end namespace itk
+
+#endif // itkSlidingHistogramRank_hxx
@@ -0,0 +1,109 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkSlidingHistogramRankImageFilter_h
+#define itkSlidingHistogramRankImageFilter_h
+
+#include "itkRankImageFilter.h"
+#include "itkSlidingHistogramRank.h"
+
+namespace itk {
+
+/** \class SlidingHistogramRankImageFilter
+ * \brief A RankImageFilter with a constant time path for integer pixels.
+ *
+ * When the pixels are integers of at most 16 bits and the kernel is
+ * a box, such as the kernel set by SetRadius, the rank is computed
+ * with the sliding histograms of the SlidingHistogramRank, in a time
+ * per pixel which does not depend on the radius along the first two
+ * axes. As in the RankImageFilter, the pixels outside of the input
+ * requested region are excluded from the kernel.
+ *
+ * The results are the same as the RankImageFilter. The other pixel
+ * types and kernels, and pixel ranges needing column histograms
+ * larger than SlidingHistogramRank::MaximumHistogramMemory, use the
+ * RankImageFilter.
+ *
+ * \sa SlidingHistogramRank
+ */
+template< typename TInputImage, typename TOutputImage = TInputImage >
+class SlidingHistogramRankImageFilter:
+    public RankImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef SlidingHistogramRankImageFilter Self;
+  typedef RankImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(SlidingHistogramRankImageFilter, RankImageFilter);
+
+  typedef typename Superclass::InputImageType        InputImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  /** Enable or disable the sliding histogram, on by default. */
+  itkSetMacro( UseSlidingHistogram, bool );
+  itkGetConstMacro( UseSlidingHistogram, bool );
+  itkBooleanMacro( UseSlidingHistogram );
+
+  /** Get if the last execution used the sliding histogram. */
+  itkGetConstMacro( SlidingHistogramUsed, bool );
+
+protected:
+
+  SlidingHistogramRankImageFilter();
+
+  // virtual ~SlidingHistogramRankImageFilter(); // implementation not needed
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  //
+  // Compute the range of the pixels for the sliding histogram.
+  virtual void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                                     ThreadIdType threadId ) ITK_OVERRIDE;
+
+private:
+  SlidingHistogramRankImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  // Return true if all the pixels of the kernel are on.
+  bool IsBoxKernel() const;
+
+  typedef SlidingHistogramRank< InputImageType, OutputImageType > SlidingHistogramType;
+
+  bool                 m_UseSlidingHistogram;
+  bool                 m_SlidingHistogramUsed;
+  SlidingHistogramType m_SlidingHistogram;
+};
+
+
+} // end namespace itk
+
+
+#include "itkSlidingHistogramRankImageFilter.hxx"
+
+#endif // itkSlidingHistogramRankImageFilter_h
@@ -0,0 +1,117 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkTabulatedWindowedSincInterpolateImageFunction_h
+#define itkTabulatedWindowedSincInterpolateImageFunction_h
+
+#include "itkInterpolateImageFunction.h"
+#include "itkWindowedSincInterpolateImageFunction.h"
+
+#include <vector>
+
+namespace itk {
+
+/** \class TabulatedWindowedSincInterpolateImageFunction
+ * \brief A WindowedSincInterpolateImageFunction with the kernel
+ * sampled in a table.
+ *
+ * The kernel, the product of the window function and the sinc, is
+ * even, so it is sampled once over [0, VRadius] with
+ * NumberOfSamplesPerPixel samples per pixel when the interpolator is
+ * constructed or the number of samples is set. The weights of each
+ * axis are then linearly interpolated in the table instead of
+ * evaluating the trigonometric functions of the window and the sinc.
+ *
+ * The pixels are read from the buffer with the indices clamped to
+ * the buffered region, as the ZeroFluxNeumannBoundaryCondition, and
+ * the sum over the window is computed one line along the first axis
+ * at a time, skipping the lines with a zero weight.
+ *
+ * The error of the weights decreases with the square of the number
+ * of samples, it is about 1e-6 with the default of 1000 samples per
+ * pixel. The weights are exactly a delta when the continuous index
+ * is on a pixel, as in the WindowedSincInterpolateImageFunction.
+ *
+ * \note This class is only for images of scalar pixels.
+ */
+template< typename TInputImage,
+          unsigned int VRadius,
+          typename TWindowFunction = Function::HammingWindowFunction< VRadius >,
+          typename TCoordRep = double >
+class TabulatedWindowedSincInterpolateImageFunction:
+    public InterpolateImageFunction< TInputImage, TCoordRep >
+{
+public:
+  /** Standard Self typedef */
+  typedef TabulatedWindowedSincInterpolateImageFunction      Self;
+  typedef InterpolateImageFunction< TInputImage, TCoordRep > Superclass;
+  typedef SmartPointer< Self >                               Pointer;
+  typedef SmartPointer< const Self >                         ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(TabulatedWindowedSincInterpolateImageFunction, InterpolateImageFunction);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, Superclass::ImageDimension);
+
+  typedef typename Superclass::InputImageType      InputImageType;
+  typedef typename Superclass::InputPixelType      InputPixelType;
+  typedef typename Superclass::OutputType          OutputType;
+  typedef typename Superclass::RealType            RealType;
+  typedef typename Superclass::IndexType           IndexType;
+  typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
+
+  /** Set the number of samples of the kernel table per pixel, the
+   * table is computed again when it changes. The default is 1000. */
+  void SetNumberOfSamplesPerPixel( unsigned int samples );
+  itkGetConstMacro( NumberOfSamplesPerPixel, unsigned int );
+
+  virtual OutputType EvaluateAtContinuousIndex( const ContinuousIndexType & index ) const ITK_OVERRIDE;
+
+protected:
+
+  TabulatedWindowedSincInterpolateImageFunction();
+
+  // virtual ~TabulatedWindowedSincInterpolateImageFunction(); // implementation not needed
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+private:
+  TabulatedWindowedSincInterpolateImageFunction(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  itkStaticConstMacro(WindowSize, unsigned int, 2 * VRadius);
+
+  void ComputeTable();
+
+  // The kernel at x, with |x| < VRadius, interpolated in the table.
+  double LookupKernel( double x ) const;
+
+  unsigned int        m_NumberOfSamplesPerPixel;
+  // the kernel at i / m_NumberOfSamplesPerPixel
+  std::vector<double> m_Table;
+};
+
+
+} // end namespace itk
+
+
+#include "itkTabulatedWindowedSincInterpolateImageFunction.hxx"
+
+#endif // itkTabulatedWindowedSincInterpolateImageFunction_h
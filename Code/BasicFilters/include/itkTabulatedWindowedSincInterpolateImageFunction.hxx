@@ -0,0 +1,195 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkTabulatedWindowedSincInterpolateImageFunction_hxx
+#define itkTabulatedWindowedSincInterpolateImageFunction_hxx
+
+#include "itkTabulatedWindowedSincInterpolateImageFunction.h"
+
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TInputImage, unsigned int VRadius, typename TWindowFunction, typename TCoordRep >
+TabulatedWindowedSincInterpolateImageFunction< TInputImage, VRadius, TWindowFunction, TCoordRep >
+::TabulatedWindowedSincInterpolateImageFunction()
+  : m_NumberOfSamplesPerPixel( 1000 )
+{
+  this->ComputeTable();
+}
+
+//
+// SetNumberOfSamplesPerPixel
+//
+template< typename TInputImage, unsigned int VRadius, typename TWindowFunction, typename TCoordRep >
+void
+TabulatedWindowedSincInterpolateImageFunction< TInputImage, VRadius, TWindowFunction, TCoordRep >
+::SetNumberOfSamplesPerPixel( unsigned int samples )
+{
+  samples = std::max( samples, 1u );
+  if ( samples != this->m_NumberOfSamplesPerPixel )
+    {
+    this->m_NumberOfSamplesPerPixel = samples;
+    this->ComputeTable();
+    this->Modified();
+    }
+}
+
+//
+// ComputeTable
+//
+template< typename TInputImage, unsigned int VRadius, typename TWindowFunction, typename TCoordRep >
+void
+TabulatedWindowedSincInterpolateImageFunction< TInputImage, VRadius, TWindowFunction, TCoordRep >
+::ComputeTable()
+{
+  const TWindowFunction windowFunction = TWindowFunction();
+
+  const unsigned int size = VRadius * this->m_NumberOfSamplesPerPixel + 1;
+  this->m_Table.resize( size );
+
+  this->m_Table[0] = 1.0;
+  for ( unsigned int i = 1; i < size; ++i )
+    {
+    const double x = static_cast<double>( i ) / this->m_NumberOfSamplesPerPixel;
+    const double px = Math::pi * x;
+    this->m_Table[i] = windowFunction( x ) * std::sin( px ) / px;
+    }
+}
+
+//
+// LookupKernel
+//
+template< typename TInputImage, unsigned int VRadius, typename TWindowFunction, typename TCoordRep >
+inline double
+TabulatedWindowedSincInterpolateImageFunction< TInputImage, VRadius, TWindowFunction, TCoordRep >
+::LookupKernel( double x ) const
+{
+  const double t = std::abs( x ) * this->m_NumberOfSamplesPerPixel;
+  const size_t j = std::min( static_cast<size_t>( t ), this->m_Table.size() - 2 );
+  const double f = t - j;
+  return this->m_Table[j] + f * ( this->m_Table[j + 1] - this->m_Table[j] );
+}
+
+//
+// EvaluateAtContinuousIndex
+//
+template< typename TInputImage, unsigned int VRadius, typename TWindowFunction, typename TCoordRep >
+typename TabulatedWindowedSincInterpolateImageFunction< TInputImage, VRadius, TWindowFunction, TCoordRep >::OutputType
+TabulatedWindowedSincInterpolateImageFunction< TInputImage, VRadius, TWindowFunction, TCoordRep >
+::EvaluateAtContinuousIndex( const ContinuousIndexType & index ) const
+{
+  const InputImageType *image = this->GetInputImage();
+  const typename InputImageType::RegionType &bufferedRegion = image->GetBufferedRegion();
+  const OffsetValueType *offsetTable = image->GetOffsetTable();
+
+  // The weight and the buffer offset of each pixel of the window
+  // along each axis.
+  double          weights[ImageDimension][WindowSize];
+  OffsetValueType offsets[ImageDimension][WindowSize];
+
+  for ( unsigned int dim = 0; dim < ImageDimension; ++dim )
+    {
+    const IndexValueType baseIndex = Math::Floor< IndexValueType >( index[dim] );
+    const double distance = index[dim] - baseIndex;
+
+    const IndexValueType start = bufferedRegion.GetIndex( dim );
+    const IndexValueType last = start + static_cast<IndexValueType>( bufferedRegion.GetSize( dim ) ) - 1;
+
+    for ( unsigned int i = 0; i < WindowSize; ++i )
+      {
+      const IndexValueType relative = static_cast<IndexValueType>( i ) - static_cast<IndexValueType>( VRadius - 1 );
+      const IndexValueType neighbor = std::min( std::max( baseIndex + relative, start ), last );
+      offsets[dim][i] = ( neighbor - start ) * offsetTable[dim];
+
+      if ( distance == 0.0 )
+        {
+        weights[dim][i] = ( relative == 0 ) ? 1.0 : 0.0;
+        }
+      else
+        {
+        weights[dim][i] = this->LookupKernel( distance - relative );
+        }
+      }
+    }
+
+  const InputPixelType *buffer = image->GetBufferPointer();
+
+  RealType value = NumericTraits<RealType>::ZeroValue();
+
+  // Sum one line of the window along the first axis for each
+  // position of the window along the other axes.
+  unsigned int counter[ImageDimension];
+  std::fill( counter, counter + ImageDimension, 0u );
+  while ( true )
+    {
+    OffsetValueType lineOffset = 0;
+    double lineWeight = 1.0;
+    for ( unsigned int dim = 1; dim < ImageDimension; ++dim )
+      {
+      lineOffset += offsets[dim][counter[dim]];
+      lineWeight *= weights[dim][counter[dim]];
+      }
+
+    if ( lineWeight != 0.0 )
+      {
+      const InputPixelType *line = buffer + lineOffset;
+      RealType lineValue = NumericTraits<RealType>::ZeroValue();
+      for ( unsigned int i = 0; i < WindowSize; ++i )
+        {
+        lineValue += static_cast<RealType>( line[offsets[0][i]] ) * weights[0][i];
+        }
+      value += lineValue * lineWeight;
+      }
+
+    unsigned int dim = 1;
+    while ( dim < ImageDimension && ++counter[dim] == WindowSize )
+      {
+      counter[dim] = 0;
+      ++dim;
+      }
+    if ( dim >= ImageDimension )
+      {
+      break;
+      }
+    }
+
+  return static_cast<OutputType>( value );
+}
+
+//
+// PrintSelf
+//
+template< typename TInputImage, unsigned int VRadius, typename TWindowFunction, typename TCoordRep >
+void
+TabulatedWindowedSincInterpolateImageFunction< TInputImage, VRadius, TWindowFunction, TCoordRep >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "NumberOfSamplesPerPixel: " << this->m_NumberOfSamplesPerPixel << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkTabulatedWindowedSincInterpolateImageFunction_hxx
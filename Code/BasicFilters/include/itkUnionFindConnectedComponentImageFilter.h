@@ -0,0 +1,136 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkUnionFindConnectedComponentImageFilter_h
+#define itkUnionFindConnectedComponentImageFilter_h
+
+#include "itkConnectedComponentImageFilter.h"
+#include "itkUnionFindConnectedComponents.h"
+
+#include <vector>
+
+namespace itk {
+
+/** \class UnionFindConnectedComponentImageFilter
+ * \brief A ConnectedComponentImageFilter with a parallel union-find
+ * path.
+ *
+ * When UseUnionFind is on, the components are labeled by
+ * UnionFindConnectedComponents: each thread labels a block of lines,
+ * the blocks are united at their boundaries, and the output is
+ * painted by all the threads. The labels are the same as those of the
+ * ConnectedComponentImageFilter.
+ *
+ * The components may be relabeled as by the
+ * RelabelComponentImageFilter in the same pass: the components smaller
+ * than MinimumObjectSize are removed, only the largest
+ * MaximumNumberOfObjects are kept when it is not zero, and the labels
+ * are sorted by decreasing size with SortByObjectSize. The sizes are
+ * counted from the runs of the union-find.
+ *
+ * The ConnectedComponentImageFilter is used when a mask image is set
+ * or the BackgroundValue is not zero, and its output is relabeled.
+ *
+ * \sa UnionFindConnectedComponents
+ */
+template< typename TInputImage, typename TOutputImage, typename TMaskImage = TInputImage >
+class UnionFindConnectedComponentImageFilter:
+    public ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef UnionFindConnectedComponentImageFilter Self;
+  typedef ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage > Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(UnionFindConnectedComponentImageFilter, ConnectedComponentImageFilter);
+
+  typedef typename Superclass::InputImageType  InputImageType;
+  typedef typename Superclass::OutputImageType OutputImageType;
+  typedef typename InputImageType::PixelType   InputPixelType;
+  typedef typename OutputImageType::PixelType  OutputPixelType;
+
+  /** Enable or disable the union-find, on by default. */
+  itkSetMacro( UseUnionFind, bool );
+  itkGetConstMacro( UseUnionFind, bool );
+  itkBooleanMacro( UseUnionFind );
+
+  /** Get if the last execution used the union-find. */
+  itkGetConstMacro( UnionFindUsed, bool );
+
+  /** Sort the labels by decreasing size, off by default. */
+  itkSetMacro( SortByObjectSize, bool );
+  itkGetConstMacro( SortByObjectSize, bool );
+  itkBooleanMacro( SortByObjectSize );
+
+  /** The components with fewer pixels are removed. The default is
+   * 0. */
+  itkSetMacro( MinimumObjectSize, SizeValueType );
+  itkGetConstMacro( MinimumObjectSize, SizeValueType );
+
+  /** Only keep the largest components, all of them when 0, the
+   * default. */
+  itkSetMacro( MaximumNumberOfObjects, SizeValueType );
+  itkGetConstMacro( MaximumNumberOfObjects, SizeValueType );
+
+  /** The number of labels of the output of the last execution. */
+  SizeValueType GetObjectCount() const;
+
+  /** The number of pixels of each label of the output, from the
+   * label 1. */
+  const std::vector< SizeValueType > & GetSizeOfObjectsInPixels() const { return this->m_SizeOfObjectsInPixels; }
+
+protected:
+
+  UnionFindConnectedComponentImageFilter();
+
+  // virtual ~UnionFindConnectedComponentImageFilter(); // implementation not needed
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void GenerateData() ITK_OVERRIDE;
+
+private:
+  UnionFindConnectedComponentImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  // Count the pixels of each label of the output, and relabel it.
+  void RelabelOutput();
+
+  bool          m_UseUnionFind;
+  bool          m_UnionFindUsed;
+  bool          m_SortByObjectSize;
+  SizeValueType m_MinimumObjectSize;
+  SizeValueType m_MaximumNumberOfObjects;
+
+  SizeValueType                m_OutputObjectCount;
+  std::vector< SizeValueType > m_SizeOfObjectsInPixels;
+};
+
+
+} // end namespace itk
+
+
+#include "itkUnionFindConnectedComponentImageFilter.hxx"
+
+#endif // itkUnionFindConnectedComponentImageFilter_h
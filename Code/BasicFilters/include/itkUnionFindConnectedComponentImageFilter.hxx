@@ -0,0 +1,176 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkUnionFindConnectedComponentImageFilter_hxx
+#define itkUnionFindConnectedComponentImageFilter_hxx
+
+#include "itkUnionFindConnectedComponentImageFilter.h"
+
+#include "itkImageRegionIterator.h"
+#include "itkNumericTraits.h"
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TInputImage, typename TOutputImage, typename TMaskImage >
+UnionFindConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+::UnionFindConnectedComponentImageFilter()
+  : m_UseUnionFind( true ),
+    m_UnionFindUsed( false ),
+    m_SortByObjectSize( false ),
+    m_MinimumObjectSize( 0 ),
+    m_MaximumNumberOfObjects( 0 ),
+    m_OutputObjectCount( 0 )
+{
+}
+
+//
+// GetObjectCount
+//
+template< typename TInputImage, typename TOutputImage, typename TMaskImage >
+SizeValueType
+UnionFindConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+::GetObjectCount() const
+{
+  return this->m_OutputObjectCount;
+}
+
+//
+// GenerateData
+//
+template< typename TInputImage, typename TOutputImage, typename TMaskImage >
+void
+UnionFindConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+::GenerateData()
+{
+  this->m_UnionFindUsed = this->m_UseUnionFind
+    && this->GetMaskImage() == ITK_NULLPTR
+    && this->GetBackgroundValue() == NumericTraits< OutputPixelType >::ZeroValue();
+  if ( !this->m_UnionFindUsed )
+    {
+    Superclass::GenerateData();
+    this->RelabelOutput();
+    return;
+    }
+
+  this->AllocateOutputs();
+  OutputImageType *output = this->GetOutput();
+
+  UnionFindConnectedComponents< InputImageType > components;
+  components.Compute( this->GetInput(),
+                      output->GetRequestedRegion(),
+                      true,
+                      NumericTraits< InputPixelType >::ZeroValue(),
+                      this->GetFullyConnected(),
+                      typename UnionFindConnectedComponents< InputImageType >::AlwaysConnected(),
+                      this->GetMultiThreader(),
+                      this->GetNumberOfThreads() );
+  this->UpdateProgress( 0.5f );
+
+  if ( this->m_SortByObjectSize || this->m_MinimumObjectSize > 1 || this->m_MaximumNumberOfObjects > 0 )
+    {
+    components.Relabel( this->m_SortByObjectSize, this->m_MinimumObjectSize, this->m_MaximumNumberOfObjects );
+    }
+  this->m_SizeOfObjectsInPixels = components.GetSizeOfObjectsInPixels();
+  this->m_OutputObjectCount = components.GetNumberOfObjects();
+  if ( this->m_OutputObjectCount > static_cast< SizeValueType >( NumericTraits< OutputPixelType >::max() ) )
+    {
+    itkExceptionMacro( << "Number of objects (" << this->m_OutputObjectCount
+                       << ") greater than maximum of output pixel type ("
+                       << static_cast< typename NumericTraits< OutputPixelType >::PrintType >( NumericTraits< OutputPixelType >::max() )
+                       << ")." );
+    }
+
+  components.Paint( output, this->GetMultiThreader() );
+  this->UpdateProgress( 1.0f );
+}
+
+//
+// RelabelOutput
+//
+template< typename TInputImage, typename TOutputImage, typename TMaskImage >
+void
+UnionFindConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+::RelabelOutput()
+{
+  OutputImageType *output = this->GetOutput();
+  const OutputPixelType backgroundValue = this->GetBackgroundValue();
+
+  std::vector< SizeValueType > sizes( Superclass::GetObjectCount(), 0 );
+  ImageRegionIterator< OutputImageType > it( output, output->GetRequestedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const OutputPixelType label = it.Get();
+    if ( label != backgroundValue && label > 0 )
+      {
+      if ( static_cast< SizeValueType >( label ) > sizes.size() )
+        {
+        sizes.resize( label, 0 );
+        }
+      ++sizes[label - 1];
+      }
+    }
+
+  if ( !this->m_SortByObjectSize && this->m_MinimumObjectSize <= 1 && this->m_MaximumNumberOfObjects == 0 )
+    {
+    this->m_SizeOfObjectsInPixels = sizes;
+    this->m_OutputObjectCount = Superclass::GetObjectCount();
+    return;
+    }
+
+  std::vector< SizeValueType > newLabels;
+  UnionFindConnectedComponents< InputImageType >::ComputeRelabeling( sizes,
+                                                                    this->m_SortByObjectSize,
+                                                                    this->m_MinimumObjectSize,
+                                                                    this->m_MaximumNumberOfObjects,
+                                                                    newLabels,
+                                                                    this->m_SizeOfObjectsInPixels );
+  this->m_OutputObjectCount = this->m_SizeOfObjectsInPixels.size();
+
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const OutputPixelType label = it.Get();
+    if ( label != backgroundValue && label > 0 )
+      {
+      const SizeValueType newLabel = newLabels[label - 1];
+      it.Set( newLabel > 0 ? static_cast< OutputPixelType >( newLabel ) : backgroundValue );
+      }
+    }
+}
+
+//
+// PrintSelf
+//
+template< typename TInputImage, typename TOutputImage, typename TMaskImage >
+void
+UnionFindConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "UseUnionFind: " << this->m_UseUnionFind << std::endl;
+  os << indent << "UnionFindUsed: " << this->m_UnionFindUsed << std::endl;
+  os << indent << "SortByObjectSize: " << this->m_SortByObjectSize << std::endl;
+  os << indent << "MinimumObjectSize: " << this->m_MinimumObjectSize << std::endl;
+  os << indent << "MaximumNumberOfObjects: " << this->m_MaximumNumberOfObjects << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkUnionFindConnectedComponentImageFilter_hxx
@@ -0,0 +1,206 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkUnionFindConnectedComponents_h
+#define itkUnionFindConnectedComponents_h
+
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
+
+namespace itk {
+
+/** \class UnionFindConnectedComponents
+ * \brief Label the connected components of an image with runs and a
+ * union-find forest, in parallel.
+ *
+ * The region is split into blocks of consecutive lines along the
+ * first axis, one block per thread. Each thread encodes the pixels of
+ * its block which are not background as runs of connected pixels
+ * along the lines, and unites the connected runs of the neighbor
+ * lines inside its block. The runs of neighbor lines in different
+ * blocks are then united, which only visits the first lines of each
+ * block.
+ *
+ * The root of a component is its first run in raster order, so the
+ * roots numbered in order are consecutive labels, from 1, ordered by
+ * the first pixel of each component as in the
+ * ConnectedComponentImageFilter. The labels are painted by all the
+ * threads.
+ *
+ * Two neighbor pixels are connected when the functor is true for
+ * their values. The memory is proportional to the number of runs, not
+ * to the number of pixels.
+ */
+template< typename TInputImage >
+class UnionFindConnectedComponents
+{
+public:
+  typedef UnionFindConnectedComponents        Self;
+  typedef TInputImage                         InputImageType;
+  typedef typename InputImageType::PixelType  InputPixelType;
+  typedef typename InputImageType::RegionType RegionType;
+  typedef typename InputImageType::IndexType  IndexType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  /** The functor connecting all the neighbor pixels which are not
+   * background. */
+  struct AlwaysConnected
+  {
+    bool operator()( const InputPixelType &, const InputPixelType & ) const { return true; }
+  };
+
+  UnionFindConnectedComponents();
+
+  /** Label the components of the pixels of the region, except the
+   * pixels with the backgroundValue when hasBackgroundValue is
+   * true. The region must be inside the buffer of the input. */
+  template< typename TFunctor >
+  void Compute( const InputImageType *input,
+                const RegionType &region,
+                bool hasBackgroundValue,
+                const InputPixelType &backgroundValue,
+                bool fullyConnected,
+                const TFunctor &connected,
+                MultiThreader *threader,
+                ThreadIdType numberOfThreads );
+
+  /** The number of components found by Compute. */
+  SizeValueType GetNumberOfObjects() const { return this->m_NumberOfObjects; }
+
+  /** The number of pixels of each component, from the label 1. */
+  const std::vector< SizeValueType > & GetSizeOfObjectsInPixels() const { return this->m_SizeOfObjectsInPixels; }
+
+  /** Relabel the components as the RelabelComponentImageFilter. The
+   * components smaller than minimumObjectSize are removed, and only
+   * the largest maximumNumberOfObjects components are kept when it is
+   * not zero. The labels are sorted by decreasing size, the first
+   * label first for equal sizes, when sortByObjectSize is true, and
+   * kept in order otherwise. */
+  void Relabel( bool sortByObjectSize,
+                SizeValueType minimumObjectSize,
+                SizeValueType maximumNumberOfObjects );
+
+  /** Compute the relabeling of Relabel from the sizes of the labels,
+   * from the label 1. The new label of each label, or 0 if it is
+   * removed, and the sizes of the new labels are returned. */
+  static void ComputeRelabeling( const std::vector< SizeValueType > &sizes,
+                                 bool sortByObjectSize,
+                                 SizeValueType minimumObjectSize,
+                                 SizeValueType maximumNumberOfObjects,
+                                 std::vector< SizeValueType > &newLabels,
+                                 std::vector< SizeValueType > &newSizes );
+
+  /** Set the pixels of the region in the output to the label of their
+   * component, or 0 for the background. The region must be inside
+   * the buffer of the output, and the labels must fit in its pixel
+   * type. */
+  template< typename TLabelImage >
+  void Paint( TLabelImage *output, MultiThreader *threader ) const;
+
+  /** Release the runs. */
+  void Clear();
+
+private:
+  typedef Offset< ImageDimension > OffsetType;
+
+  // Connected pixels along a line, from m_Start to m_End excluded,
+  // relative to the start of the region.
+  struct Run
+  {
+    IndexValueType m_Start;
+    IndexValueType m_End;
+  };
+
+  // Order the labels by decreasing size.
+  struct LargerObject
+  {
+    const std::vector< SizeValueType > *m_Sizes;
+    bool operator()( SizeValueType a, SizeValueType b ) const { return ( *m_Sizes )[a] > ( *m_Sizes )[b]; }
+  };
+
+  template< typename TFunctor > struct ComputeThreadStruct;
+  template< typename TLabelImage > struct PaintThreadStruct;
+
+  template< typename TFunctor >
+  static ITK_THREAD_RETURN_TYPE ComputeThreaderCallback( void *arg );
+  template< typename TLabelImage >
+  static ITK_THREAD_RETURN_TYPE PaintThreaderCallback( void *arg );
+
+  // Encode the runs of the lines of a block, and unite the runs of
+  // the neighbor lines of the block.
+  template< typename TFunctor >
+  void ComputeBlock( unsigned int block, ComputeThreadStruct< TFunctor > &str ) const;
+
+  template< typename TLabelImage >
+  void PaintBlock( unsigned int block, TLabelImage *output ) const;
+
+  // The position in the region of the first pixel of a line.
+  OffsetType GetLinePosition( SizeValueType line ) const;
+
+  // Get the line of a neighbor, returns false if it is outside of
+  // the region.
+  bool GetNeighborLine( SizeValueType line,
+                        const OffsetType &position,
+                        const OffsetType &neighborOffset,
+                        SizeValueType &neighbor ) const;
+
+  const InputPixelType *GetLineBuffer( const InputImageType *input, const OffsetType &position ) const;
+
+  // Unite the connected runs of two neighbor lines, the runs are in
+  // the ranges of runs and parents.
+  template< typename TFunctor >
+  void UniteLines( const std::vector< Run > &runs,
+                   SizeValueType neighborBegin,
+                   SizeValueType neighborEnd,
+                   const InputPixelType *neighborBuffer,
+                   SizeValueType begin,
+                   SizeValueType end,
+                   const InputPixelType *buffer,
+                   const TFunctor &connected,
+                   std::vector< SizeValueType > &parents ) const;
+
+  // The root of a run, with path halving. A parent is never after
+  // its child, so the root is the first run of its tree.
+  static SizeValueType FindRoot( std::vector< SizeValueType > &parents, SizeValueType run );
+
+  RegionType                   m_Region;
+  IndexValueType               m_Tolerance;
+  // the offsets to the neighbor lines before a line
+  std::vector< OffsetType >    m_NeighborOffsets;
+  std::vector< SizeValueType > m_LineStrides;
+  SizeValueType                m_MaximumLineOffset;
+  // the first line of each block, followed by the number of lines
+  std::vector< SizeValueType > m_BlockStarts;
+
+  // the runs of all the lines, in raster order
+  std::vector< Run >           m_Runs;
+  std::vector< SizeValueType > m_LineRunStarts;
+  // the parent of each run in the forest, then its label
+  std::vector< SizeValueType > m_Parents;
+  SizeValueType                m_NumberOfObjects;
+  std::vector< SizeValueType > m_SizeOfObjectsInPixels;
+};
+
+} // end namespace itk
+
+
+#include "itkUnionFindConnectedComponents.hxx"
+
+#endif // itkUnionFindConnectedComponents_h
@@ -0,0 +1,628 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkUnionFindConnectedComponents_hxx
+#define itkUnionFindConnectedComponents_hxx
+
+#include "itkUnionFindConnectedComponents.h"
+
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+
+namespace itk {
+
+template< typename TInputImage >
+template< typename TFunctor >
+struct UnionFindConnectedComponents< TInputImage >::ComputeThreadStruct
+{
+  const Self           *m_Components;
+  const InputImageType *m_Input;
+  bool                  m_HasBackgroundValue;
+  InputPixelType        m_BackgroundValue;
+  const TFunctor       *m_Connected;
+
+  // the runs of each block, with the runs of its lines and their
+  // parents in the block
+  std::vector< std::vector< Run > >           m_Runs;
+  std::vector< std::vector< SizeValueType > > m_LineRunStarts;
+  std::vector< std::vector< SizeValueType > > m_Parents;
+};
+
+template< typename TInputImage >
+template< typename TLabelImage >
+struct UnionFindConnectedComponents< TInputImage >::PaintThreadStruct
+{
+  const Self  *m_Components;
+  TLabelImage *m_Output;
+};
+
+//
+// Constructor
+//
+template< typename TInputImage >
+UnionFindConnectedComponents< TInputImage >
+::UnionFindConnectedComponents()
+  : m_Tolerance( 0 ),
+    m_MaximumLineOffset( 0 ),
+    m_NumberOfObjects( 0 )
+{
+}
+
+//
+// Compute
+//
+template< typename TInputImage >
+template< typename TFunctor >
+void
+UnionFindConnectedComponents< TInputImage >
+::Compute( const InputImageType *input,
+           const RegionType &region,
+           bool hasBackgroundValue,
+           const InputPixelType &backgroundValue,
+           bool fullyConnected,
+           const TFunctor &connected,
+           MultiThreader *threader,
+           ThreadIdType numberOfThreads )
+{
+  this->Clear();
+  this->m_Region = region;
+  this->m_Tolerance = fullyConnected ? 1 : 0;
+
+  // the lines along the first axis
+  this->m_LineStrides.assign( ImageDimension, 0 );
+  SizeValueType numberOfLines = 1;
+  for ( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+    this->m_LineStrides[d] = numberOfLines;
+    numberOfLines *= region.GetSize( d );
+    }
+  if ( region.GetNumberOfPixels() == 0 )
+    {
+    numberOfLines = 0;
+    }
+
+  // the neighbor lines before a line, with the offsets along the
+  // other axes in { -1, 0, 1 }, and only one non zero offset for face
+  // connectivity
+  SizeValueType numberOfOffsets = 1;
+  for ( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+    numberOfOffsets *= 3;
+    }
+  for ( SizeValueType i = 0; i < numberOfOffsets; ++i )
+    {
+    OffsetType offset;
+    offset.Fill( 0 );
+    SizeValueType code = i;
+    unsigned int numberOfNonZero = 0;
+    OffsetValueType lineOffset = 0;
+    for ( unsigned int d = 1; d < ImageDimension; ++d )
+      {
+      offset[d] = static_cast< OffsetValueType >( code % 3 ) - 1;
+      code /= 3;
+      numberOfNonZero += ( offset[d] != 0 );
+      lineOffset += offset[d] * static_cast< OffsetValueType >( this->m_LineStrides[d] );
+      }
+    if ( lineOffset < 0 && ( fullyConnected || numberOfNonZero == 1 ) )
+      {
+      this->m_NeighborOffsets.push_back( offset );
+      this->m_MaximumLineOffset = std::max( this->m_MaximumLineOffset, static_cast< SizeValueType >( -lineOffset ) );
+      }
+    }
+
+  // the blocks of lines of the threads
+  const SizeValueType numberOfBlocks = std::max< SizeValueType >( 1, std::min< SizeValueType >( numberOfThreads, numberOfLines ) );
+  this->m_BlockStarts.resize( numberOfBlocks + 1 );
+  for ( SizeValueType b = 0; b <= numberOfBlocks; ++b )
+    {
+    this->m_BlockStarts[b] = b * ( numberOfLines / numberOfBlocks ) + std::min( b, numberOfLines % numberOfBlocks );
+    }
+
+  ComputeThreadStruct< TFunctor > str;
+  str.m_Components = this;
+  str.m_Input = input;
+  str.m_HasBackgroundValue = hasBackgroundValue;
+  str.m_BackgroundValue = backgroundValue;
+  str.m_Connected = &connected;
+  str.m_Runs.resize( numberOfBlocks );
+  str.m_LineRunStarts.resize( numberOfBlocks );
+  str.m_Parents.resize( numberOfBlocks );
+
+  threader->SetNumberOfThreads( static_cast< ThreadIdType >( numberOfBlocks ) );
+  threader->SetSingleMethod( &Self::template ComputeThreaderCallback< TFunctor >, &str );
+  threader->SingleMethodExecute();
+
+  // gather the runs of the blocks, the runs of a block follow the
+  // runs of the previous blocks
+  SizeValueType numberOfRuns = 0;
+  for ( SizeValueType b = 0; b < numberOfBlocks; ++b )
+    {
+    numberOfRuns += str.m_Runs[b].size();
+    }
+  this->m_Runs.reserve( numberOfRuns );
+  this->m_Parents.reserve( numberOfRuns );
+  this->m_LineRunStarts.resize( numberOfLines + 1 );
+  for ( SizeValueType b = 0; b < numberOfBlocks; ++b )
+    {
+    const SizeValueType firstRun = this->m_Runs.size();
+    for ( SizeValueType line = this->m_BlockStarts[b]; line < this->m_BlockStarts[b+1]; ++line )
+      {
+      this->m_LineRunStarts[line] = firstRun + str.m_LineRunStarts[b][line - this->m_BlockStarts[b]];
+      }
+    for ( SizeValueType i = 0; i < str.m_Parents[b].size(); ++i )
+      {
+      this->m_Parents.push_back( firstRun + str.m_Parents[b][i] );
+      }
+    this->m_Runs.insert( this->m_Runs.end(), str.m_Runs[b].begin(), str.m_Runs[b].end() );
+
+    std::vector< Run >().swap( str.m_Runs[b] );
+    std::vector< SizeValueType >().swap( str.m_LineRunStarts[b] );
+    std::vector< SizeValueType >().swap( str.m_Parents[b] );
+    }
+  this->m_LineRunStarts[numberOfLines] = this->m_Runs.size();
+
+  // unite the runs of the first lines of each block with their
+  // neighbors in the previous blocks
+  for ( SizeValueType b = 1; b < numberOfBlocks; ++b )
+    {
+    const SizeValueType blockStart = this->m_BlockStarts[b];
+    const SizeValueType end = std::min( this->m_BlockStarts[b+1], blockStart + this->m_MaximumLineOffset );
+    for ( SizeValueType line = blockStart; line < end; ++line )
+      {
+      const OffsetType position = this->GetLinePosition( line );
+      const InputPixelType *buffer = this->GetLineBuffer( input, position );
+      for ( unsigned int i = 0; i < this->m_NeighborOffsets.size(); ++i )
+        {
+        SizeValueType neighbor;
+        if ( this->GetNeighborLine( line, position, this->m_NeighborOffsets[i], neighbor ) && neighbor < blockStart )
+          {
+          this->UniteLines( this->m_Runs,
+                            this->m_LineRunStarts[neighbor],
+                            this->m_LineRunStarts[neighbor+1],
+                            this->GetLineBuffer( input, position + this->m_NeighborOffsets[i] ),
+                            this->m_LineRunStarts[line],
+                            this->m_LineRunStarts[line+1],
+                            buffer,
+                            connected,
+                            this->m_Parents );
+          }
+        }
+      }
+    }
+
+  // Number the roots in order. The parent of a run is before it, so
+  // it is already replaced by the label of its root.
+  for ( SizeValueType run = 0; run < this->m_Parents.size(); ++run )
+    {
+    if ( this->m_Parents[run] == run )
+      {
+      this->m_Parents[run] = ++this->m_NumberOfObjects;
+      }
+    else
+      {
+      this->m_Parents[run] = this->m_Parents[this->m_Parents[run]];
+      }
+    }
+
+  this->m_SizeOfObjectsInPixels.assign( this->m_NumberOfObjects, 0 );
+  for ( SizeValueType run = 0; run < this->m_Runs.size(); ++run )
+    {
+    this->m_SizeOfObjectsInPixels[this->m_Parents[run] - 1] += this->m_Runs[run].m_End - this->m_Runs[run].m_Start;
+    }
+}
+
+//
+// Relabel
+//
+template< typename TInputImage >
+void
+UnionFindConnectedComponents< TInputImage >
+::Relabel( bool sortByObjectSize,
+           SizeValueType minimumObjectSize,
+           SizeValueType maximumNumberOfObjects )
+{
+  std::vector< SizeValueType > newLabels;
+  std::vector< SizeValueType > newSizes;
+  ComputeRelabeling( this->m_SizeOfObjectsInPixels,
+                     sortByObjectSize,
+                     minimumObjectSize,
+                     maximumNumberOfObjects,
+                     newLabels,
+                     newSizes );
+
+  // the runs of the removed components are painted as background
+  for ( SizeValueType run = 0; run < this->m_Parents.size(); ++run )
+    {
+    this->m_Parents[run] = newLabels[this->m_Parents[run] - 1];
+    }
+  this->m_SizeOfObjectsInPixels.swap( newSizes );
+  this->m_NumberOfObjects = this->m_SizeOfObjectsInPixels.size();
+}
+
+//
+// ComputeRelabeling
+//
+template< typename TInputImage >
+void
+UnionFindConnectedComponents< TInputImage >
+::ComputeRelabeling( const std::vector< SizeValueType > &sizes,
+                     bool sortByObjectSize,
+                     SizeValueType minimumObjectSize,
+                     SizeValueType maximumNumberOfObjects,
+                     std::vector< SizeValueType > &newLabels,
+                     std::vector< SizeValueType > &newSizes )
+{
+  std::vector< SizeValueType > kept;
+  for ( SizeValueType i = 0; i < sizes.size(); ++i )
+    {
+    if ( sizes[i] >= minimumObjectSize )
+      {
+      kept.push_back( i );
+      }
+    }
+
+  // the stable sort keeps the first label first for equal sizes
+  if ( sortByObjectSize || ( maximumNumberOfObjects > 0 && kept.size() > maximumNumberOfObjects ) )
+    {
+    LargerObject larger;
+    larger.m_Sizes = &sizes;
+    std::stable_sort( kept.begin(), kept.end(), larger );
+    if ( maximumNumberOfObjects > 0 && kept.size() > maximumNumberOfObjects )
+      {
+      kept.resize( maximumNumberOfObjects );
+      }
+    if ( !sortByObjectSize )
+      {
+      std::sort( kept.begin(), kept.end() );
+      }
+    }
+
+  newLabels.assign( sizes.size(), 0 );
+  newSizes.resize( kept.size() );
+  for ( SizeValueType k = 0; k < kept.size(); ++k )
+    {
+    newLabels[kept[k]] = k + 1;
+    newSizes[k] = sizes[kept[k]];
+    }
+}
+
+//
+// ComputeThreaderCallback
+//
+template< typename TInputImage >
+template< typename TFunctor >
+ITK_THREAD_RETURN_TYPE
+UnionFindConnectedComponents< TInputImage >
+::ComputeThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ComputeThreadStruct< TFunctor > *str = static_cast< ComputeThreadStruct< TFunctor > * >( info->UserData );
+
+  const unsigned int numberOfBlocks = str->m_Runs.size();
+  for ( unsigned int block = info->ThreadID; block < numberOfBlocks; block += info->NumberOfThreads )
+    {
+    str->m_Components->ComputeBlock( block, *str );
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+//
+// ComputeBlock
+//
+template< typename TInputImage >
+template< typename TFunctor >
+void
+UnionFindConnectedComponents< TInputImage >
+::ComputeBlock( unsigned int block, ComputeThreadStruct< TFunctor > &str ) const
+{
+  const SizeValueType blockStart = this->m_BlockStarts[block];
+  const SizeValueType blockEnd = this->m_BlockStarts[block+1];
+  const IndexValueType width = this->m_Region.GetSize( 0 );
+  const bool hasBackgroundValue = str.m_HasBackgroundValue;
+  const InputPixelType backgroundValue = str.m_BackgroundValue;
+  const TFunctor &connected = *str.m_Connected;
+
+  std::vector< Run > &runs = str.m_Runs[block];
+  std::vector< SizeValueType > &lineRunStarts = str.m_LineRunStarts[block];
+  std::vector< SizeValueType > &parents = str.m_Parents[block];
+  lineRunStarts.resize( blockEnd - blockStart + 1 );
+
+  for ( SizeValueType line = blockStart; line < blockEnd; ++line )
+    {
+    lineRunStarts[line - blockStart] = runs.size();
+    const InputPixelType *buffer = this->GetLineBuffer( str.m_Input, this->GetLinePosition( line ) );
+
+    IndexValueType x = 0;
+    while ( x < width )
+      {
+      if ( hasBackgroundValue && buffer[x] == backgroundValue )
+        {
+        ++x;
+        continue;
+        }
+      Run run;
+      run.m_Start = x++;
+      while ( x < width
+              && !( hasBackgroundValue && buffer[x] == backgroundValue )
+              && connected( buffer[x-1], buffer[x] ) )
+        {
+        ++x;
+        }
+      run.m_End = x;
+      parents.push_back( runs.size() );
+      runs.push_back( run );
+      }
+    }
+  lineRunStarts[blockEnd - blockStart] = runs.size();
+
+  for ( SizeValueType line = blockStart; line < blockEnd; ++line )
+    {
+    const OffsetType position = this->GetLinePosition( line );
+    const InputPixelType *buffer = this->GetLineBuffer( str.m_Input, position );
+    for ( unsigned int i = 0; i < this->m_NeighborOffsets.size(); ++i )
+      {
+      SizeValueType neighbor;
+      if ( this->GetNeighborLine( line, position, this->m_NeighborOffsets[i], neighbor ) && neighbor >= blockStart )
+        {
+        this->UniteLines( runs,
+                          lineRunStarts[neighbor - blockStart],
+                          lineRunStarts[neighbor - blockStart + 1],
+                          this->GetLineBuffer( str.m_Input, position + this->m_NeighborOffsets[i] ),
+                          lineRunStarts[line - blockStart],
+                          lineRunStarts[line - blockStart + 1],
+                          buffer,
+                          connected,
+                          parents );
+        }
+      }
+    }
+}
+
+//
+// UniteLines
+//
+template< typename TInputImage >
+template< typename TFunctor >
+void
+UnionFindConnectedComponents< TInputImage >
+::UniteLines( const std::vector< Run > &runs,
+              SizeValueType neighborBegin,
+              SizeValueType neighborEnd,
+              const InputPixelType *neighborBuffer,
+              SizeValueType begin,
+              SizeValueType end,
+              const InputPixelType *buffer,
+              const TFunctor &connected,
+              std::vector< SizeValueType > &parents ) const
+{
+  const IndexValueType tolerance = this->m_Tolerance;
+
+  // the neighbor runs are extended by the tolerance, and the runs
+  // which overlap are visited in order
+  SizeValueType n = neighborBegin;
+  SizeValueType r = begin;
+  while ( n < neighborEnd && r < end )
+    {
+    const Run &neighborRun = runs[n];
+    const Run &run = runs[r];
+    if ( neighborRun.m_Start - tolerance < run.m_End && run.m_Start < neighborRun.m_End + tolerance )
+      {
+      SizeValueType neighborRoot = FindRoot( parents, n );
+      SizeValueType root = FindRoot( parents, r );
+      if ( neighborRoot != root )
+        {
+        // the runs are connected if a pixel of the run is connected
+        // to a neighbor pixel of the neighbor run
+        bool isConnected = false;
+        const IndexValueType xEnd = std::min( run.m_End, neighborRun.m_End + tolerance );
+        for ( IndexValueType x = std::max( run.m_Start, neighborRun.m_Start - tolerance ); x < xEnd && !isConnected; ++x )
+          {
+          const IndexValueType nxEnd = std::min( x + tolerance + 1, neighborRun.m_End );
+          for ( IndexValueType nx = std::max( x - tolerance, neighborRun.m_Start ); nx < nxEnd; ++nx )
+            {
+            if ( connected( neighborBuffer[nx], buffer[x] ) )
+              {
+              isConnected = true;
+              break;
+              }
+            }
+          }
+        if ( isConnected )
+          {
+          if ( neighborRoot < root )
+            {
+            parents[root] = neighborRoot;
+            }
+          else
+            {
+            parents[neighborRoot] = root;
+            }
+          }
+        }
+      }
+
+    if ( neighborRun.m_End + tolerance < run.m_End )
+      {
+      ++n;
+      }
+    else
+      {
+      ++r;
+      }
+    }
+}
+
+//
+// FindRoot
+//
+template< typename TInputImage >
+SizeValueType
+UnionFindConnectedComponents< TInputImage >
+::FindRoot( std::vector< SizeValueType > &parents, SizeValueType run )
+{
+  while ( parents[run] != run )
+    {
+    parents[run] = parents[parents[run]];
+    run = parents[run];
+    }
+  return run;
+}
+
+//
+// Paint
+//
+template< typename TInputImage >
+template< typename TLabelImage >
+void
+UnionFindConnectedComponents< TInputImage >
+::Paint( TLabelImage *output, MultiThreader *threader ) const
+{
+  if ( this->m_BlockStarts.size() < 2 )
+    {
+    return;
+    }
+
+  PaintThreadStruct< TLabelImage > str;
+  str.m_Components = this;
+  str.m_Output = output;
+
+  threader->SetNumberOfThreads( static_cast< ThreadIdType >( this->m_BlockStarts.size() - 1 ) );
+  threader->SetSingleMethod( &Self::template PaintThreaderCallback< TLabelImage >, &str );
+  threader->SingleMethodExecute();
+}
+
+//
+// PaintThreaderCallback
+//
+template< typename TInputImage >
+template< typename TLabelImage >
+ITK_THREAD_RETURN_TYPE
+UnionFindConnectedComponents< TInputImage >
+::PaintThreaderCallback( void *arg )
+{
+  MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  PaintThreadStruct< TLabelImage > *str = static_cast< PaintThreadStruct< TLabelImage > * >( info->UserData );
+
+  const unsigned int numberOfBlocks = str->m_Components->m_BlockStarts.size() - 1;
+  for ( unsigned int block = info->ThreadID; block < numberOfBlocks; block += info->NumberOfThreads )
+    {
+    str->m_Components->PaintBlock( block, str->m_Output );
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+//
+// PaintBlock
+//
+template< typename TInputImage >
+template< typename TLabelImage >
+void
+UnionFindConnectedComponents< TInputImage >
+::PaintBlock( unsigned int block, TLabelImage *output ) const
+{
+  typedef typename TLabelImage::PixelType LabelType;
+
+  const SizeValueType width = this->m_Region.GetSize( 0 );
+  for ( SizeValueType line = this->m_BlockStarts[block]; line < this->m_BlockStarts[block+1]; ++line )
+    {
+    LabelType *buffer = output->GetBufferPointer() + output->ComputeOffset( this->m_Region.GetIndex() + this->GetLinePosition( line ) );
+    std::fill( buffer, buffer + width, NumericTraits< LabelType >::ZeroValue() );
+    for ( SizeValueType run = this->m_LineRunStarts[line]; run < this->m_LineRunStarts[line+1]; ++run )
+      {
+      std::fill( buffer + this->m_Runs[run].m_Start,
+                 buffer + this->m_Runs[run].m_End,
+                 static_cast< LabelType >( this->m_Parents[run] ) );
+      }
+    }
+}
+
+//
+// Clear
+//
+template< typename TInputImage >
+void
+UnionFindConnectedComponents< TInputImage >
+::Clear()
+{
+  std::vector< OffsetType >().swap( this->m_NeighborOffsets );
+  std::vector< SizeValueType >().swap( this->m_BlockStarts );
+  std::vector< Run >().swap( this->m_Runs );
+  std::vector< SizeValueType >().swap( this->m_LineRunStarts );
+  std::vector< SizeValueType >().swap( this->m_Parents );
+  std::vector< SizeValueType >().swap( this->m_SizeOfObjectsInPixels );
+  this->m_MaximumLineOffset = 0;
+  this->m_NumberOfObjects = 0;
+}
+
+//
+// GetLinePosition
+//
+template< typename TInputImage >
+typename UnionFindConnectedComponents< TInputImage >::OffsetType
+UnionFindConnectedComponents< TInputImage >
+::GetLinePosition( SizeValueType line ) const
+{
+  OffsetType position;
+  position[0] = 0;
+  for ( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+    position[d] = static_cast< OffsetValueType >( line % this->m_Region.GetSize( d ) );
+    line /= this->m_Region.GetSize( d );
+    }
+  return position;
+}
+
+//
+// GetNeighborLine
+//
+template< typename TInputImage >
+bool
+UnionFindConnectedComponents< TInputImage >
+::GetNeighborLine( SizeValueType line,
+                   const OffsetType &position,
+                   const OffsetType &neighborOffset,
+                   SizeValueType &neighbor ) const
+{
+  OffsetValueType lineOffset = 0;
+  for ( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+    const OffsetValueType p = position[d] + neighborOffset[d];
+    if ( p < 0 || p >= static_cast< OffsetValueType >( this->m_Region.GetSize( d ) ) )
+      {
+      return false;
+      }
+    lineOffset += neighborOffset[d] * static_cast< OffsetValueType >( this->m_LineStrides[d] );
+    }
+  neighbor = line + lineOffset;
+  return true;
+}
+
+//
+// GetLineBuffer
+//
+template< typename TInputImage >
+const typename UnionFindConnectedComponents< TInputImage >::InputPixelType *
+UnionFindConnectedComponents< TInputImage >
+::GetLineBuffer( const InputImageType *input, const OffsetType &position ) const
+{
+  return input->GetBufferPointer() + input->ComputeOffset( this->m_Region.GetIndex() + position );
+}
+
+} // end namespace itk
+
+#endif // itkUnionFindConnectedComponents_hxx
@@ -0,0 +1,104 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkUnionFindScalarConnectedComponentImageFilter_h
+#define itkUnionFindScalarConnectedComponentImageFilter_h
+
+#include "itkScalarConnectedComponentImageFilter.h"
+#include "itkUnionFindConnectedComponents.h"
+
+namespace itk {
+
+/** \class UnionFindScalarConnectedComponentImageFilter
+ * \brief A ScalarConnectedComponentImageFilter with a parallel
+ * union-find path.
+ *
+ * When UseUnionFind is on, the components are labeled by
+ * UnionFindConnectedComponents: each thread labels a block of lines,
+ * the blocks are united at their boundaries, and the output is
+ * painted by all the threads. All the pixels are labeled, and the
+ * neighbor pixels within the DistanceThreshold are connected. The
+ * components are the same as those of the
+ * ScalarConnectedComponentImageFilter, but the labels are consecutive
+ * and ordered by the first pixel of each component, so the union-find
+ * is off by default.
+ *
+ * The ScalarConnectedComponentImageFilter is used when a mask image is
+ * set or the BackgroundValue is not zero.
+ *
+ * \sa UnionFindConnectedComponents
+ */
+template< typename TInputImage, typename TOutputImage, typename TMaskImage = TInputImage >
+class UnionFindScalarConnectedComponentImageFilter:
+    public ScalarConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+{
+public:
+  /** Standard Self typedef */
+  typedef UnionFindScalarConnectedComponentImageFilter Self;
+  typedef ScalarConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage > Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(UnionFindScalarConnectedComponentImageFilter, ScalarConnectedComponentImageFilter);
+
+  typedef typename Superclass::InputImageType  InputImageType;
+  typedef typename Superclass::OutputImageType OutputImageType;
+  typedef typename InputImageType::PixelType   InputPixelType;
+  typedef typename OutputImageType::PixelType  OutputPixelType;
+
+  /** Enable or disable the union-find, off by default. */
+  itkSetMacro( UseUnionFind, bool );
+  itkGetConstMacro( UseUnionFind, bool );
+  itkBooleanMacro( UseUnionFind );
+
+  /** Get if the last execution used the union-find. */
+  itkGetConstMacro( UnionFindUsed, bool );
+
+  /** The number of components of the last execution. */
+  SizeValueType GetObjectCount() const;
+
+protected:
+
+  UnionFindScalarConnectedComponentImageFilter();
+
+  // virtual ~UnionFindScalarConnectedComponentImageFilter(); // implementation not needed
+
+  virtual void PrintSelf(std::ostream & os, Indent indent) const ITK_OVERRIDE;
+
+  // See superclass for doxygen documentation
+  virtual void GenerateData() ITK_OVERRIDE;
+
+private:
+  UnionFindScalarConnectedComponentImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  bool          m_UseUnionFind;
+  bool          m_UnionFindUsed;
+  SizeValueType m_UnionFindObjectCount;
+};
+
+
+} // end namespace itk
+
+
+#include "itkUnionFindScalarConnectedComponentImageFilter.hxx"
+
+#endif // itkUnionFindScalarConnectedComponentImageFilter_h
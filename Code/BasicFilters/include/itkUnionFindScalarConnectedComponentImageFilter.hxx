@@ -0,0 +1,114 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkUnionFindScalarConnectedComponentImageFilter_hxx
+#define itkUnionFindScalarConnectedComponentImageFilter_hxx
+
+#include "itkUnionFindScalarConnectedComponentImageFilter.h"
+
+#include "itkNumericTraits.h"
+
+namespace itk {
+
+//
+// Constructor
+//
+template< typename TInputImage, typename TOutputImage, typename TMaskImage >
+UnionFindScalarConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+::UnionFindScalarConnectedComponentImageFilter()
+  : m_UseUnionFind( false ),
+    m_UnionFindUsed( false ),
+    m_UnionFindObjectCount( 0 )
+{
+}
+
+//
+// GetObjectCount
+//
+template< typename TInputImage, typename TOutputImage, typename TMaskImage >
+SizeValueType
+UnionFindScalarConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+::GetObjectCount() const
+{
+  if ( this->m_UnionFindUsed )
+    {
+    return this->m_UnionFindObjectCount;
+    }
+  return Superclass::GetObjectCount();
+}
+
+//
+// GenerateData
+//
+template< typename TInputImage, typename TOutputImage, typename TMaskImage >
+void
+UnionFindScalarConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+::GenerateData()
+{
+  this->m_UnionFindUsed = this->m_UseUnionFind
+    && this->GetMaskImage() == ITK_NULLPTR
+    && this->GetBackgroundValue() == NumericTraits< OutputPixelType >::ZeroValue();
+  if ( !this->m_UnionFindUsed )
+    {
+    Superclass::GenerateData();
+    return;
+    }
+
+  this->AllocateOutputs();
+  OutputImageType *output = this->GetOutput();
+
+  UnionFindConnectedComponents< InputImageType > components;
+  components.Compute( this->GetInput(),
+                      output->GetRequestedRegion(),
+                      false,
+                      NumericTraits< InputPixelType >::ZeroValue(),
+                      this->GetFullyConnected(),
+                      this->GetFunctor(),
+                      this->GetMultiThreader(),
+                      this->GetNumberOfThreads() );
+  this->UpdateProgress( 0.5f );
+
+  this->m_UnionFindObjectCount = components.GetNumberOfObjects();
+  if ( this->m_UnionFindObjectCount > static_cast< SizeValueType >( NumericTraits< OutputPixelType >::max() ) )
+    {
+    itkExceptionMacro( << "Number of objects (" << this->m_UnionFindObjectCount
+                       << ") greater than maximum of output pixel type ("
+                       << static_cast< typename NumericTraits< OutputPixelType >::PrintType >( NumericTraits< OutputPixelType >::max() )
+                       << ")." );
+    }
+
+  components.Paint( output, this->GetMultiThreader() );
+  this->UpdateProgress( 1.0f );
+}
+
+//
+// PrintSelf
+//
+template< typename TInputImage, typename TOutputImage, typename TMaskImage >
+void
+UnionFindScalarConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "UseUnionFind: " << this->m_UseUnionFind << std::endl;
+  os << indent << "UnionFindUsed: " << this->m_UnionFindUsed << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkUnionFindScalarConnectedComponentImageFilter_hxx
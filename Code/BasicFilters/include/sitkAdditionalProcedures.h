@@ -69,6 +69,67 @@ SITKBasicFilters_EXPORT Image Resample ( const Image& image1,
     /**@}*/
 
 
+/**
+ * \brief Resample many images onto the grid of a reference image
+ * with the same transform.
+ *
+ * The result is the same as calling Resample for each image with the
+ * referenceImage. When the transform is not linear, such as a
+ * BSpline, displacement field or composite transform, the mapping of
+ * the reference grid is computed once into a displacement field,
+ * then each image is interpolated on the mapped points without
+ * evaluating the transform again. A linear transform has no such
+ * shared work, so each image is resampled directly.
+ *
+ * The mapped points are only shared for an image when the output
+ * pixel type is sitkUnknown or the pixel type of the image, and the
+ * interpolator is sitkNearestNeighbor or sitkLinear or the image has
+ * real pixels, so no interpolated value needs to be clamped to the
+ * output pixel type. Other images are resampled directly.
+ *
+ * Either one interpolator is given for all images, or one per image,
+ * such as sitkLinear for intensities and sitkNearestNeighbor for
+ * label maps.
+ *
+ * \sa itk::simple::Resample
+ * @{
+ */
+SITKBasicFilters_EXPORT std::vector<Image> ResampleImages ( const std::vector<Image> &images,
+                                                            const Image& referenceImage,
+                                                            Transform transform = itk::simple::Transform(),
+                                                            InterpolatorEnum interpolator = itk::simple::sitkLinear,
+                                                            double defaultPixelValue = 0.0,
+                                                            PixelIDValueEnum outputPixelType = sitkUnknown );
+
+#if !defined(SWIG)
+SITKBasicFilters_EXPORT std::vector<Image> ResampleImages ( const std::vector<Image> &images,
+                                                            const Image& referenceImage,
+                                                            Transform transform,
+                                                            const std::vector<InterpolatorEnum> &interpolators,
+                                                            double defaultPixelValue = 0.0,
+                                                            PixelIDValueEnum outputPixelType = sitkUnknown );
+#endif
+    /**@}*/
+
+
+/**
+ * \brief Evaluate an image at a list of physical points.
+ *
+ * The points are given as a flat array of N points, each with the
+ * image's dimension of coordinates: x0, y0, z0, x1, y1, z1, ... The
+ * image is interpolated at each point with the requested interpolator
+ * and the result is returned as a contiguous array of N values per
+ * component. Points outside the image buffer are assigned
+ * defaultValue. The evaluation is multi-threaded over the points.
+ *
+ * \sa itk::simple::Resample
+ */
+SITKBasicFilters_EXPORT std::vector<double> EvaluateAtPhysicalPoints( const Image &image,
+                                                                      const std::vector<double> &points,
+                                                                      InterpolatorEnum interpolator = itk::simple::sitkLinear,
+                                                                      double defaultValue = 0.0 );
+
+
 /**
  * \brief itk::simple::PatchBasedDenoisingImageFilter Procedural Interface
  *
@@ -130,6 +191,37 @@ SITKBasicFilters_EXPORT Image PatchBasedDenoising (const Image& image1,
                                                                 double sigma,
                                                                 bool normalizeAcrossScale = false );
 
+
+    /**
+     * \brief Clip an image between two percentiles of its intensities
+     * and rescale them linearly to an output range.
+     *
+     * The percentiles, between 0 and 100, are computed from a
+     * histogram of numberOfBins bins by the HistogramImageFilter, so
+     * their error is at most the width of a bin. They become the
+     * window of the IntensityWindowingImageFilter, which gives an
+     * image of the pixel type of the input. With a mask of sitkUInt8
+     * pixels, only the pixels where the mask is not zero are counted
+     * in the percentiles, but all of them are rescaled.
+     *
+     * \sa itk::simple::HistogramImageFilter
+     * \sa itk::simple::IntensityWindowingImageFilter
+     */
+     SITKBasicFilters_EXPORT Image PercentileWindowing ( const Image& image1,
+                                                         double lowerPercentile = 0.5,
+                                                         double upperPercentile = 99.5,
+                                                         double outputMinimum = 0.0,
+                                                         double outputMaximum = 255.0,
+                                                         unsigned int numberOfBins = 4096u );
+
+     SITKBasicFilters_EXPORT Image PercentileWindowing ( const Image& image1,
+                                                         const Image& maskImage,
+                                                         double lowerPercentile = 0.5,
+                                                         double upperPercentile = 99.5,
+                                                         double outputMinimum = 0.0,
+                                                         double outputMaximum = 255.0,
+                                                         unsigned int numberOfBins = 4096u );
+
 }
 }
 #endif
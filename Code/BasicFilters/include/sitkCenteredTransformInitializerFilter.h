@@ -86,6 +86,20 @@ assumption will probably not hold in multi-modality registration.
       /**
        */
         OperationModeType GetOperationMode() const { return this->m_OperationMode; }
+
+      /**
+       * Compute the moments on every ShrinkFactor pixel in each
+       * dimension of the images, 1 by default for all the pixels. The
+       * centers of mass are computed in parallel, and a coarse center
+       * is enough as a starting point of a registration.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetShrinkFactor ( unsigned int ShrinkFactor ) { this->m_ShrinkFactor = ShrinkFactor; return *this; }
+
+      /**
+       * Compute the moments on every ShrinkFactor pixel in each
+       * dimension of the images, 1 by default for all the pixels.
+       */
+        unsigned int GetShrinkFactor() const { return this->m_ShrinkFactor; }
       /** Name of this class */
       std::string GetName() const { return std::string ("CenteredTransformInitializerFilter"); }
 
@@ -122,6 +136,7 @@ assumption will probably not hold in multi-modality registration.
 
 
       OperationModeType  m_OperationMode;
+      unsigned int  m_ShrinkFactor;
     };
 
     /**
@@ -73,6 +73,20 @@ Versorrepresenting rotation.
        * Enable the use of the principal axes of each image to compute an initial rotation that will align them.
        */
         bool GetComputeRotation() const { return this->m_ComputeRotation; }
+
+      /**
+       * Compute the moments on every ShrinkFactor pixel in each
+       * dimension of the images, 1 by default for all the pixels. The
+       * centers of mass are computed in parallel. With ComputeRotation
+       * the images are shrunk for the moments of the principal axes.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetShrinkFactor ( unsigned int ShrinkFactor ) { this->m_ShrinkFactor = ShrinkFactor; return *this; }
+
+      /**
+       * Compute the moments on every ShrinkFactor pixel in each
+       * dimension of the images, 1 by default for all the pixels.
+       */
+        unsigned int GetShrinkFactor() const { return this->m_ShrinkFactor; }
       /** Name of this class */
       std::string GetName() const { return std::string ("CenteredVersorTransformInitializerFilter"); }
 
@@ -102,6 +116,7 @@ Versorrepresenting rotation.
 
 
       bool  m_ComputeRotation;
+      unsigned int  m_ShrinkFactor;
     };
 
 
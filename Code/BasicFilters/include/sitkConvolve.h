@@ -0,0 +1,107 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkConvolve_h
+#define sitkConvolve_h
+
+#include "sitkBasicFilters.h"
+#include "sitkImage.h"
+#include "sitkConvolutionImageFilter.h"
+
+#include <string>
+
+namespace itk {
+namespace simple {
+
+/** \brief The method used to compute a convolution.
+ */
+enum ConvolutionModeEnum {
+  /// Select the fastest method from the image and kernel sizes
+  sitkConvolutionAuto,
+  /// ConvolutionImageFilter with the kernel image
+  sitkConvolutionSpatial,
+  /// ConvolutionImageFilter with a 1-D kernel along each axis
+  sitkConvolutionSeparable,
+  /// FFTConvolutionImageFilter
+  sitkConvolutionFFT
+};
+
+
+/**
+ * \brief Convolve an image with a kernel image, with the spatial,
+ * separable or FFT convolution.
+ *
+ * The arguments are those of the ConvolutionImageFilter and the
+ * FFTConvolutionImageFilter, which compute the same convolution.
+ *
+ * A kernel is separable when it is the outer product of a 1-D kernel
+ * along each axis, such as a Gaussian or a box kernel. The separable
+ * convolution is computed as one 1-D convolution per axis, in
+ * floating point.
+ *
+ * With sitkConvolutionAuto, the method with the lowest estimated
+ * cost is used, see SelectConvolutionMode. The results of the
+ * methods are the same up to floating point rounding, and the
+ * truncation to the pixel type of the image for integer pixels.
+ *
+ * The spatial and separable convolutions pad the image once with the
+ * boundary condition when most of its pixels are within the kernel
+ * radius of the border, see ConvolutionImageFilter::SetPadInput.
+ *
+ * \sa itk::simple::ConvolutionImageFilter
+ * \sa itk::simple::FFTConvolutionImageFilter
+ */
+SITKBasicFilters_EXPORT Image Convolve ( const Image& image,
+                                         const Image& kernelImage,
+                                         bool normalize = false,
+                                         ConvolutionImageFilter::BoundaryConditionType boundaryCondition = itk::simple::ConvolutionImageFilter::ZERO_FLUX_NEUMANN_PAD,
+                                         ConvolutionImageFilter::OutputRegionModeType outputRegionMode = itk::simple::ConvolutionImageFilter::SAME,
+                                         ConvolutionModeEnum mode = itk::simple::sitkConvolutionAuto );
+
+
+/**
+ * \brief The convolution method used by Convolve with
+ * sitkConvolutionAuto.
+ *
+ * The cost of the spatial convolution grows with the number of
+ * kernel pixels, the cost of the separable convolution with the sum
+ * of the kernel sizes, and the cost of the FFT convolution with the
+ * size of the padded image. The costs are estimated with the
+ * constants of the host computed by CalibrateConvolutionMode, or
+ * with default constants.
+ */
+SITKBasicFilters_EXPORT ConvolutionModeEnum SelectConvolutionMode ( const Image& image,
+                                                                    const Image& kernelImage );
+
+
+/**
+ * \brief Measure the cost constants of the convolution methods on
+ * this host.
+ *
+ * A few small convolutions are timed, and the constants are used by
+ * the following calls to SelectConvolutionMode in the process.
+ *
+ * When a fileName is given and the file exists, the constants are
+ * read from it instead of being measured. Otherwise the measured
+ * constants are written to it, so that the calibration is computed
+ * once for the host.
+ */
+SITKBasicFilters_EXPORT void CalibrateConvolutionMode ( const std::string &fileName = "" );
+
+}
+}
+#endif
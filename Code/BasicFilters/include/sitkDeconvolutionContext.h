@@ -0,0 +1,156 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkDeconvolutionContext_h
+#define sitkDeconvolutionContext_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkBasicFilters.h"
+#include "sitkProcessObject.h"
+
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class DeconvolutionContext
+     * \brief Deconvolve many images of the same size with the same kernel
+     *
+     * The deconvolution filters pad the kernel image and compute its
+     * FFT on each execution. This object computes the FFT of the
+     * padded kernel once for a size of image, and keeps it for the
+     * following images of the same size, such as the tiles of a
+     * microscopy acquisition deconvolved with the same point spread
+     * function. The FFT filters of a batch of images are reused, so
+     * the FFTW plan of the padded size is created once.
+     *
+     * \code
+     * DeconvolutionContext deconvolution;
+     * deconvolution.SetAlgorithm( DeconvolutionContext::RichardsonLucy );
+     * deconvolution.SetNumberOfIterations( 10 );
+     * deconvolution.SetKernelImage( psf );
+     * std::vector<Image> deconvolved = deconvolution.Execute( tiles );
+     * \endcode
+     *
+     * The algorithms and their parameters are those of the
+     * WienerDeconvolutionImageFilter,
+     * TikhonovDeconvolutionImageFilter,
+     * RichardsonLucyDeconvolutionImageFilter,
+     * LandweberDeconvolutionImageFilter and
+     * ProjectedLandweberDeconvolutionImageFilter, with the SAME output
+     * region mode. The deconvolution is computed in single precision,
+     * the default internal precision of these filters, and the output
+     * has the pixel type of the input.
+     *
+     * \sa itk::simple::WienerDeconvolutionImageFilter
+     * \sa itk::simple::RichardsonLucyDeconvolutionImageFilter
+     * \sa itk::simple::FFTConfiguration
+     */
+    class SITKBasicFilters_EXPORT DeconvolutionContext
+      : public ProcessObject {
+    public:
+      typedef DeconvolutionContext Self;
+
+      typedef BasicPixelIDTypeList PixelIDTypeList;
+
+      enum AlgorithmType {
+        Wiener,
+        Tikhonov,
+        RichardsonLucy,
+        Landweber,
+        ProjectedLandweber
+      };
+
+      enum BoundaryConditionType { ZERO_PAD, ZERO_FLUX_NEUMANN_PAD, PERIODIC_PAD };
+
+      DeconvolutionContext();
+      ~DeconvolutionContext();
+
+      /** Set the deconvolution algorithm, Wiener by default */
+      SITK_RETURN_SELF_TYPE_HEADER SetAlgorithm ( AlgorithmType algorithm ) { this->m_Algorithm = algorithm; return *this; }
+      AlgorithmType GetAlgorithm ( ) const { return this->m_Algorithm; }
+
+      /** Set the kernel image, the point spread function. The cached
+       * FFT of the kernel is released. */
+      SITK_RETURN_SELF_TYPE_HEADER SetKernelImage ( const Image &kernelImage );
+      Image GetKernelImage ( ) const { return this->m_KernelImage; }
+
+      /** Normalize the kernel to a sum of 1 */
+      SITK_RETURN_SELF_TYPE_HEADER SetNormalize ( bool normalize );
+      bool GetNormalize ( ) const { return this->m_Normalize; }
+
+      /** Set the boundary condition extending the images to the
+       * padded size, ZERO_FLUX_NEUMANN_PAD by default */
+      SITK_RETURN_SELF_TYPE_HEADER SetBoundaryCondition ( BoundaryConditionType boundaryCondition ) { this->m_BoundaryCondition = boundaryCondition; return *this; }
+      BoundaryConditionType GetBoundaryCondition ( ) const { return this->m_BoundaryCondition; }
+
+      /** Set the noise variance of the Wiener algorithm */
+      SITK_RETURN_SELF_TYPE_HEADER SetNoiseVariance ( double noiseVariance ) { this->m_NoiseVariance = noiseVariance; return *this; }
+      double GetNoiseVariance ( ) const { return this->m_NoiseVariance; }
+
+      /** Set the regularization constant of the Tikhonov algorithm */
+      SITK_RETURN_SELF_TYPE_HEADER SetRegularizationConstant ( double regularizationConstant ) { this->m_RegularizationConstant = regularizationConstant; return *this; }
+      double GetRegularizationConstant ( ) const { return this->m_RegularizationConstant; }
+
+      /** Set the number of iterations of the iterative algorithms */
+      SITK_RETURN_SELF_TYPE_HEADER SetNumberOfIterations ( unsigned int numberOfIterations ) { this->m_NumberOfIterations = numberOfIterations; return *this; }
+      unsigned int GetNumberOfIterations ( ) const { return this->m_NumberOfIterations; }
+
+      /** Set the relaxation factor of the Landweber algorithms */
+      SITK_RETURN_SELF_TYPE_HEADER SetAlpha ( double alpha ) { this->m_Alpha = alpha; return *this; }
+      double GetAlpha ( ) const { return this->m_Alpha; }
+
+      /** Deconvolve an image with the kernel image */
+      Image Execute ( const Image &image );
+
+      /** Deconvolve a batch of images with the kernel image */
+      std::vector<Image> Execute ( const std::vector<Image> &images );
+
+      /** Get the padded size the FFT of the kernel is cached for,
+       * empty when no image has been deconvolved with the kernel. */
+      std::vector<unsigned int> GetPaddedSize ( ) const { return this->m_PaddedSize; }
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ( "DeconvolutionContext" ); }
+
+      // Print ourselves out
+      std::string ToString() const;
+
+    private:
+
+      template <unsigned int VImageDimension>
+      std::vector<Image> ExecuteInternal ( const std::vector<Image> &images );
+
+      AlgorithmType         m_Algorithm;
+      Image                 m_KernelImage;
+      bool                  m_Normalize;
+      BoundaryConditionType m_BoundaryCondition;
+      double                m_NoiseVariance;
+      double                m_RegularizationConstant;
+      unsigned int          m_NumberOfIterations;
+      double                m_Alpha;
+
+      // the FFT of the padded kernel, for images of the image size
+      Image                     m_KernelTransform;
+      std::vector<unsigned int> m_ImageSize;
+      std::vector<unsigned int> m_PaddedSize;
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,118 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkFFTConfiguration_h
+#define sitkFFTConfiguration_h
+
+#include "sitkBasicFilters.h"
+
+#include <string>
+
+namespace itk {
+namespace simple {
+
+/** \class FFTConfiguration
+ * \brief Global settings of the FFT implementation used by filters
+ *
+ * The ForwardFFTImageFilter, InverseFFTImageFilter, the half
+ * Hermitian FFT filters, and the filters computing FFTs internally,
+ * such as the FFTConvolutionImageFilter, the
+ * FFTNormalizedCorrelationImageFilter and the deconvolution filters,
+ * use the FFTW library when ITK is built with it, and the VNL
+ * implementation otherwise. The VNL implementation only supports
+ * sizes whose prime factors are 2, 3 and 5, see the
+ * FFTPadImageFilter.
+ *
+ * Before computing a FFT, FFTW creates a plan for the size of the
+ * image. The plan rigor selects how much time is spent searching
+ * for a fast plan. The result of the planning, the wisdom, is kept
+ * for the process so that a FFT of the same size is planned quickly
+ * the next time. With the wisdom cache, the wisdom is also read from
+ * and written to files, so that it is kept between processes.
+ *
+ * The FFTW methods throw an exception when ITK is not built with
+ * FFTW, see HasFFTW.
+ */
+class SITKBasicFilters_EXPORT FFTConfiguration
+{
+public:
+
+  enum FFTBackendType {
+    /// FFTW library, used when available
+    FFTW,
+    /// VNL implementation
+    VNL
+  };
+
+  /** \brief Select the implementation used for new FFT filters.
+   *
+   * The default is FFTW when ITK is built with FFTW.
+   * @{
+   */
+  static void SetBackend( FFTBackendType backend );
+  static FFTBackendType GetBackend();
+  /**@}*/
+
+  /** \brief Query if ITK is built with FFTW. */
+  static bool HasFFTW();
+
+  /** \brief The FFTW planning rigor
+   *
+   * One of "FFTW_ESTIMATE", "FFTW_MEASURE", "FFTW_PATIENT" or
+   * "FFTW_EXHAUSTIVE", from the fastest planning to the most
+   * thorough planning and fastest FFTs.
+   * @{
+   */
+  static void SetPlanRigor( const std::string &planRigor );
+  static std::string GetPlanRigor();
+  /**@}*/
+
+  /** \brief Read and write the FFTW wisdom cache files
+   *
+   * When reading is enabled, the wisdom is imported from the cache
+   * files before the first plan is created in the process. When
+   * writing is enabled, the new wisdom is saved to the cache files
+   * when the process exits. The single and double precision wisdom
+   * is kept in separate files whose path starts with the
+   * WisdomCacheBase.
+   * @{
+   */
+  static void SetReadWisdomCache( bool readWisdomCache );
+  static bool GetReadWisdomCache();
+  static void SetWriteWisdomCache( bool writeWisdomCache );
+  static bool GetWriteWisdomCache();
+
+  static void SetWisdomCacheBase( const std::string &wisdomCacheBase );
+  static std::string GetWisdomCacheBase();
+  /**@}*/
+
+  /** \brief Import or export the FFTW wisdom of double precision
+   * FFTs, or single precision FFTs, with a file.
+   *
+   * Returns false if the file could not be read or written.
+   * @{
+   */
+  static bool ImportWisdomFile( const std::string &fileName, bool singlePrecision = false );
+  static bool ExportWisdomFile( const std::string &fileName, bool singlePrecision = false );
+  /**@}*/
+
+};
+
+}
+}
+
+#endif
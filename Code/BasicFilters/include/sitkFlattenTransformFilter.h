@@ -0,0 +1,186 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkFlattenTransformFilter_h
+#define sitkFlattenTransformFilter_h
+
+#include <memory>
+
+#include "sitkBasicFilters.h"
+#include "sitkImageFilter.h"
+#include "sitkTransform.h"
+
+namespace itk {
+  namespace simple {
+
+    /**\class FlattenTransformFilter
+\brief Replace a transform, such as a composite of many transforms,
+by a single transform which is evaluated with one lookup.
+
+A linear transform, including a composite of only linear transforms,
+is composed analytically into one AffineTransform. Any other
+transform, such as a composite including BSpline or displacement
+field components, is sampled on the output grid into one
+DisplacementFieldTransform, so resampling with the flattened
+transform interpolates a single displacement field instead of
+evaluating each component in sequence.
+
+The output grid is set by the size, origin, spacing and direction,
+or from a reference image. The accuracy of the flattened transform
+is measured at the centers of the grid cells, between the sampled
+points, as the distance between the points mapped by the input and
+the flattened transforms.
+
+\sa itk::simple::FlattenTransform for the procedural interface
+\sa itk::simple::TransformToDisplacementFieldFilter
+     */
+    class SITKBasicFilters_EXPORT FlattenTransformFilter : public ProcessObject {
+    public:
+      typedef FlattenTransformFilter Self;
+
+      /** Default Constructor that takes no arguments and initializes
+       * default parameters */
+      FlattenTransformFilter();
+
+      /** Destructor */
+      ~FlattenTransformFilter();
+
+      /** Define the pixels types supported by this filter */
+      typedef typelist::MakeTypeList<BasicPixelID<float> >::Type PixelIDTypeList;
+
+
+      /**
+       * Set/Get the size of the output grid.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetSize ( const std::vector<unsigned int> & Size ) { this->m_Size = Size; return *this; }
+
+      /**
+       * Set/Get the size of the output grid.
+       */
+        std::vector<unsigned int> GetSize() const { return this->m_Size; }
+
+      /**
+       * Set/Get the origin of the output grid.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetOutputOrigin ( const std::vector<double> & OutputOrigin ) { this->m_OutputOrigin = OutputOrigin; return *this; }
+
+      /**
+       * Set/Get the origin of the output grid.
+       */
+        std::vector<double> GetOutputOrigin() const { return this->m_OutputOrigin; }
+
+      /**
+       * Set/Get the spacing of the output grid.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetOutputSpacing ( const std::vector<double> & OutputSpacing ) { this->m_OutputSpacing = OutputSpacing; return *this; }
+
+      /**
+       * Set/Get the spacing of the output grid.
+       */
+        std::vector<double> GetOutputSpacing() const { return this->m_OutputSpacing; }
+
+      /**
+       * Set/Get the direction cosine matrix of the output grid.
+       * Passing a zero sized array, defaults to identiy matrix. The
+       * size of the array must exactly match the direction matrix for
+       * the dimension of the transform.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetOutputDirection ( const std::vector<double> & OutputDirection ) { this->m_OutputDirection = OutputDirection; return *this; }
+
+      /**
+       * Set/Get the direction cosine matrix of the output grid.
+       */
+        std::vector<double> GetOutputDirection() const { return this->m_OutputDirection; }
+
+      /** This methods sets the size, origin, spacing and direction to that of the provided image */
+      SITK_RETURN_SELF_TYPE_HEADER SetReferenceImage( const Image & refImage );
+
+      /** The largest distance between the points mapped by the input
+       * and the flattened transforms, at the centers of the grid
+       * cells.
+       *
+       * This is a measurement. Its value is updated in the Execute
+       * methods, so the value will only be valid after an execution.
+       */
+      double GetMaximumError() const { return this->m_MaximumError; }
+
+      /** The mean distance between the points mapped by the input
+       * and the flattened transforms, at the centers of the grid
+       * cells.
+       *
+       * This is a measurement. Its value is updated in the Execute
+       * methods, so the value will only be valid after an execution.
+       */
+      double GetMeanError() const { return this->m_MeanError; }
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ("FlattenTransformFilter"); }
+
+      /** Print ourselves out */
+      std::string ToString() const;
+
+
+      /** Execute the filter on the input transform */
+      Transform Execute ( const Transform & transform );
+
+
+      /** Execute the filter on the input transform with the given parameters */
+      Transform Execute ( const Transform & transform,
+                          const std::vector<unsigned int> & size,
+                          const std::vector<double> & outputOrigin,
+                          const std::vector<double> & outputSpacing,
+                          const std::vector<double> & outputDirection );
+
+
+    private:
+
+      /** Setup for member function dispatching */
+
+      typedef Transform (Self::*MemberFunctionType)( const Transform & transform );
+      template <class TImageType> Transform ExecuteInternal ( const Transform & transform );
+
+
+      friend struct detail::MemberFunctionAddressor<MemberFunctionType>;
+
+      nsstd::auto_ptr<detail::MemberFunctionFactory<MemberFunctionType> > m_MemberFactory;
+
+
+      std::vector<unsigned int>  m_Size;
+      std::vector<double>  m_OutputOrigin;
+      std::vector<double>  m_OutputSpacing;
+      std::vector<double>  m_OutputDirection;
+
+      double m_MaximumError;
+      double m_MeanError;
+    };
+
+
+    /**
+     * \brief Replace a transform by a single transform, which is
+     * sampled on the grid of the reference image if it is not
+     * linear.
+     *
+     * This function directly calls the execute method of FlattenTransformFilter
+     * in order to support a procedural API
+     *
+     * \sa itk::simple::FlattenTransformFilter for the object oriented interface
+     */
+     SITKBasicFilters_EXPORT Transform FlattenTransform ( const Transform & transform, const Image & referenceImage );
+
+  }
+}
+#endif
@@ -0,0 +1,154 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkGaussianScaleSpaceFilter_h
+#define sitkGaussianScaleSpaceFilter_h
+
+#include <memory>
+
+#include "sitkBasicFilters.h"
+#include "sitkImageFilter.h"
+
+namespace itk {
+  namespace simple {
+
+    /**\class GaussianScaleSpaceFilter
+
+\brief Compute the Gaussian scale space of an image at several sigmas,
+each level from the previous one.
+
+Smoothing the image at each sigma from the original image repeats the
+smoothing of the smaller sigmas. As the convolution of Gaussians of
+sigmas s1 and s2 is a Gaussian of sigma sqrt( s1^2 + s2^2 ), the
+level of sigma s_i is computed by smoothing the level of s_(i-1) with
+sqrt( s_i^2 - s_(i-1)^2 ). The increments are small, so the levels are
+smoothed with the short kernels of the DiscreteGaussianImageFilter,
+and with the SmoothingRecursiveGaussianImageFilter, whose cost does
+not depend on sigma, once the increment is two pixels or more.
+
+With ShrinkPerOctave, the scale space is also shrunk by a factor of 2
+along each axis each time sigma doubles, as in the octaves of a
+pyramid: when the sigma of a level is twice that of the first level
+of its octave, and at least the largest spacing of the level, the
+next levels are computed from the level shrunk by the
+ShrinkImageFilter. The pixels of each octave cost an eighth of those
+of the previous octave in 3D. GetShrinkFactors returns the factor of
+each level.
+
+The sigmas, in physical units, must be increasing and not less than
+InputSigma, the blur already in the image, by default 0. A level of
+sigma equal to the previous one is not smoothed. The levels are of
+the sitkFloat32 pixel type, or sitkFloat64 for an image of
+sitkFloat64.
+
+\sa itk::simple::SmoothingRecursiveGaussianImageFilter
+\sa itk::simple::DiscreteGaussianImageFilter
+     */
+    class SITKBasicFilters_EXPORT GaussianScaleSpaceFilter : public ImageFilter<0> {
+    public:
+      typedef GaussianScaleSpaceFilter Self;
+
+      /** Default Constructor that takes no arguments and initializes
+       * default parameters */
+      GaussianScaleSpaceFilter();
+
+      /** Destructor */
+      ~GaussianScaleSpaceFilter();
+
+      /** Define the pixels types supported by this filter */
+      typedef BasicPixelIDTypeList  PixelIDTypeList;
+
+      /**
+       * Set/Get the increasing sigmas of the levels, in physical
+       * units. The default is 1, 2 and 4.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetSigmas ( const std::vector<double> & Sigmas ) { this->m_Sigmas = Sigmas; return *this; }
+
+      /**
+       * Set/Get the increasing sigmas of the levels, in physical
+       * units.
+       */
+        std::vector<double> GetSigmas() const { return this->m_Sigmas; }
+
+      /**
+       * Set/Get the sigma of the blur already in the input image, in
+       * physical units. The default is 0.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetInputSigma ( double InputSigma ) { this->m_InputSigma = InputSigma; return *this; }
+
+      /**
+       * Set/Get the sigma of the blur already in the input image.
+       */
+        double GetInputSigma() const { return this->m_InputSigma; }
+
+      /**
+       * Set/Get whether the levels are shrunk by a factor of 2 each
+       * time sigma doubles. The default is false.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetShrinkPerOctave ( bool ShrinkPerOctave ) { this->m_ShrinkPerOctave = ShrinkPerOctave; return *this; }
+
+      /** Set the value of ShrinkPerOctave to true or false respectfully. */
+      SITK_RETURN_SELF_TYPE_HEADER ShrinkPerOctaveOn() { return this->SetShrinkPerOctave(true); }
+      SITK_RETURN_SELF_TYPE_HEADER ShrinkPerOctaveOff() { return this->SetShrinkPerOctave(false); }
+
+      /**
+       * Set/Get whether the levels are shrunk by a factor of 2 each
+       * time sigma doubles.
+       */
+        bool GetShrinkPerOctave() const { return this->m_ShrinkPerOctave; }
+
+      /** The factor by which each level of the last execution is
+       * shrunk from the input image.
+       *
+       * This is a measurement. Its value is updated in the Execute
+       * methods, so the value will only be valid after an execution.
+       */
+      std::vector<unsigned int> GetShrinkFactors() const { return this->m_ShrinkFactors; }
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ("GaussianScaleSpaceFilter"); }
+
+      /** Print ourselves out */
+      std::string ToString() const;
+
+
+      /** Compute the levels of the image, one for each sigma */
+      std::vector<Image> Execute ( const Image & image );
+
+    private:
+
+      /** Setup for member function dispatching */
+
+      typedef std::vector<Image> (Self::*MemberFunctionType)( const Image & image );
+      template <class TImageType> std::vector<Image> ExecuteInternal ( const Image & image );
+
+
+      friend struct detail::MemberFunctionAddressor<MemberFunctionType>;
+
+      nsstd::auto_ptr<detail::MemberFunctionFactory<MemberFunctionType> > m_MemberFactory;
+
+
+      std::vector<double>  m_Sigmas;
+      double  m_InputSigma;
+      bool  m_ShrinkPerOctave;
+
+      std::vector<unsigned int>  m_ShrinkFactors;
+    };
+
+  }
+}
+#endif
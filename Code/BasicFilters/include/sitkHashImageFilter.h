@@ -31,6 +31,10 @@ namespace itk {
     /** \class HashImageFilter
      * \brief Compute the sha1 or md5 hash of an image
      *
+     * The FAST hash function is a non-cryptographic 64 bits hash,
+     * computed in parallel on the buffer of the image without copying
+     * it, for caching and the detection of duplicated images.
+     *
      * \sa itk::simple::Hash for the procedural interface
      */
     class SITKBasicFilters_EXPORT HashImageFilter
@@ -48,10 +52,17 @@ namespace itk {
 
       HashImageFilter();
 
-      enum HashFunction { SHA1, MD5 };
+      enum HashFunction { SHA1, MD5, FAST };
       SITK_RETURN_SELF_TYPE_HEADER SetHashFunction ( HashFunction hashFunction );
       HashFunction GetHashFunction () const;
 
+      /** \brief Hash the size, origin, spacing and direction of the
+       * image with its pixels. Off by default. */
+      SITK_RETURN_SELF_TYPE_HEADER SetIncludeGeometry ( bool includeGeometry );
+      bool GetIncludeGeometry () const;
+      SITK_RETURN_SELF_TYPE_HEADER IncludeGeometryOn() { return this->SetIncludeGeometry(true); }
+      SITK_RETURN_SELF_TYPE_HEADER IncludeGeometryOff() { return this->SetIncludeGeometry(false); }
+
       /** Name of this class */
       std::string GetName() const { return std::string ( "Hash"); }
 
@@ -63,6 +74,7 @@ namespace itk {
 
     private:
       HashFunction m_HashFunction;
+      bool m_IncludeGeometry;
 
       template <class TImageType> std::string ExecuteInternal ( const Image& image );
       template <class TImageType> std::string ExecuteInternalLabelImage ( const Image& image );
@@ -0,0 +1,237 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkHistogramImageFilter_h
+#define sitkHistogramImageFilter_h
+
+#include "sitkBasicFilters.h"
+#include "sitkImageFilter.h"
+#include "sitkDualMemberFunctionFactory.h"
+
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /**\class HistogramImageFilter
+\brief Compute the histogram of an image, or the joint histogram of
+two images, in a single multi-threaded pass.
+
+Each thread counts the pixels of a part of the image into its own
+bins, which are added together at the end. The counts are returned
+as one contiguous array.
+
+The bins are NumberOfBins intervals of equal width between the
+minimum and the maximum of each image. By default the minimum and
+maximum are those of the pixels which are counted, computed by a
+first pass over the image. When AutoMinimumMaximum is off, the
+HistogramMinimum and HistogramMaximum are used, with one value per
+image, and the pixels outside of the range are not counted. The
+maximum is in the last bin.
+
+With a mask, of the sitkUInt8 pixel type and the size of the images,
+only the pixels whose mask is not zero are counted.
+
+The histogram threshold methods, such as those of the
+OtsuThresholdImageFilter or the LiThresholdImageFilter, are computed
+from a histogram by ComputeThreshold, so that several thresholds of
+an image are computed from one histogram. The thresholds may differ
+slightly from those of the threshold filters, which compute their
+own histograms. The percentiles are computed by ComputePercentile,
+without sorting or copying the pixels.
+
+\sa itk::simple::LabelStatisticsImageFilter
+     */
+    class SITKBasicFilters_EXPORT HistogramImageFilter : public ProcessObject {
+    public:
+      typedef HistogramImageFilter Self;
+
+      /** Default Constructor that takes no arguments and initializes
+       * default parameters */
+      HistogramImageFilter();
+
+      /** Destructor */
+      ~HistogramImageFilter();
+
+      /** Define the pixels types supported by this filter */
+      typedef BasicPixelIDTypeList PixelIDTypeList;
+
+      /** The histogram threshold methods of the threshold filters. */
+      enum ThresholdMethodType {
+        HUANG,
+        INTERMODES,
+        ISO_DATA,
+        KITTLER_ILLINGWORTH,
+        LI,
+        MAXIMUM_ENTROPY,
+        MOMENTS,
+        OTSU,
+        RENYI_ENTROPY,
+        SHANBHAG,
+        TRIANGLE,
+        YEN
+      };
+
+      /**
+       * Set/Get the number of bins for each image. The default is
+       * 256.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetNumberOfBins ( unsigned int NumberOfBins ) { this->m_NumberOfBins = NumberOfBins; return *this; }
+
+      /**
+       * Set/Get the number of bins for each image.
+       */
+        unsigned int GetNumberOfBins() const { return this->m_NumberOfBins; }
+
+      /**
+       * Set/Get whether the range of the bins is the range of the
+       * counted pixels. The default is true.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetAutoMinimumMaximum ( bool AutoMinimumMaximum ) { this->m_AutoMinimumMaximum = AutoMinimumMaximum; return *this; }
+
+      /** Set the value of AutoMinimumMaximum to true or false respectfully. */
+      SITK_RETURN_SELF_TYPE_HEADER AutoMinimumMaximumOn() { return this->SetAutoMinimumMaximum(true); }
+      SITK_RETURN_SELF_TYPE_HEADER AutoMinimumMaximumOff() { return this->SetAutoMinimumMaximum(false); }
+
+      /**
+       * Set/Get whether the range of the bins is the range of the
+       * counted pixels.
+       */
+        bool GetAutoMinimumMaximum() const { return this->m_AutoMinimumMaximum; }
+
+      /**
+       * Set/Get the minimum of the first bin of each image, used
+       * when AutoMinimumMaximum is off.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetHistogramMinimum ( const std::vector<double> & HistogramMinimum ) { this->m_HistogramMinimum = HistogramMinimum; return *this; }
+
+      /**
+       * Set/Get the minimum of the first bin of each image.
+       */
+        std::vector<double> GetHistogramMinimum() const { return this->m_HistogramMinimum; }
+
+      /**
+       * Set/Get the maximum of the last bin of each image, used when
+       * AutoMinimumMaximum is off.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetHistogramMaximum ( const std::vector<double> & HistogramMaximum ) { this->m_HistogramMaximum = HistogramMaximum; return *this; }
+
+      /**
+       * Set/Get the maximum of the last bin of each image.
+       */
+        std::vector<double> GetHistogramMaximum() const { return this->m_HistogramMaximum; }
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ("HistogramImageFilter"); }
+
+      /** Print ourselves out */
+      std::string ToString() const;
+
+
+      /** Compute the histogram of the image */
+      void Execute ( const Image & image );
+
+      /** Compute the histogram of the pixels of the image inside of
+       * the mask */
+      void Execute ( const Image & image, const Image & maskImage );
+
+      /** Compute the joint histogram of two images of the same size */
+      void ExecuteJoint ( const Image & image1, const Image & image2 );
+
+      /** Compute the joint histogram of the pixels of two images
+       * inside of the mask */
+      void ExecuteJoint ( const Image & image1, const Image & image2, const Image & maskImage );
+
+
+      /** The counts of the bins of the last execution. For a joint
+       * histogram, the count of the bin i of the first image and the
+       * bin j of the second image is at i * NumberOfBins + j.
+       *
+       * This is a measurement. Its value is updated in the Execute
+       * methods, so the value will only be valid after an execution.
+       */
+      std::vector<uint64_t> GetCounts() const { return this->m_Counts; }
+
+      /** The NumberOfBins + 1 edges of the bins of an image of the
+       * last execution, 0 for the first image and 1 for the second
+       * image of a joint histogram. */
+      std::vector<double> GetBinEdges( unsigned int image = 0 ) const;
+
+      /** The number of images of the last execution, 2 for a joint
+       * histogram. */
+      unsigned int GetNumberOfHistogramDimensions() const { return this->m_BinEdges.size(); }
+
+      /** The number of pixels counted in the last execution. */
+      uint64_t GetNumberOfPixels() const { return this->m_NumberOfPixels; }
+
+      /** Compute the threshold of a method from the histogram of the
+       * last execution, which must not be a joint histogram. */
+      double ComputeThreshold( ThresholdMethodType method ) const;
+
+      /** Compute the threshold of a method from the counts of a
+       * histogram and the edges of its bins, one more than the
+       * counts, in increasing order. */
+      static double ComputeThreshold( const std::vector<uint64_t> & counts,
+                                      const std::vector<double> & binEdges,
+                                      ThresholdMethodType method );
+
+      /** Compute a percentile, between 0 and 100, of the pixels
+       * counted in the last execution, which must not be a joint
+       * histogram. The value is interpolated linearly inside of its
+       * bin, so its error is at most the width of a bin, set by the
+       * NumberOfBins. */
+      double ComputePercentile( double percentile ) const;
+
+      /** Compute a percentile from the counts of a histogram and the
+       * edges of its bins, one more than the counts, in increasing
+       * order. */
+      static double ComputePercentile( const std::vector<uint64_t> & counts,
+                                       const std::vector<double> & binEdges,
+                                       double percentile );
+
+    private:
+
+      /** Setup for member function dispatching */
+
+      typedef void (Self::*MemberFunctionType)( const Image & image1, const Image & image2 );
+      template <class TImageType, class TImageType2> void DualExecuteInternal ( const Image & image1, const Image & image2 );
+
+      friend struct detail::DualExecuteInternalAddressor<MemberFunctionType>;
+
+      nsstd::auto_ptr<detail::DualMemberFunctionFactory<MemberFunctionType> > m_DualMemberFactory;
+
+      // Check the images and dispatch, the second image is the first
+      // one when it is not used.
+      void Dispatch ( const Image & image1, const Image & image2, const Image * maskImage, bool joint );
+
+      unsigned int        m_NumberOfBins;
+      bool                m_AutoMinimumMaximum;
+      std::vector<double> m_HistogramMinimum;
+      std::vector<double> m_HistogramMaximum;
+
+      // set by Dispatch for DualExecuteInternal
+      const Image *m_MaskImage;
+      bool         m_Joint;
+
+      std::vector<uint64_t>              m_Counts;
+      std::vector< std::vector<double> > m_BinEdges;
+      uint64_t                           m_NumberOfPixels;
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,125 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkImageAccumulator_h
+#define sitkImageAccumulator_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkBasicFilters.h"
+#include "sitkProcessObject.h"
+
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class ImageAccumulator
+     * \brief Fold images one at a time into the result of an N-ary filter
+     *
+     * The NaryAddImageFilter, NaryMaximumImageFilter and
+     * LabelVotingImageFilter need all their inputs in memory at
+     * once. This object instead receives the images one at a time
+     * with AddImage, and folds each into a running state, so the
+     * images may be read, added and released one after another:
+     *
+     * \code
+     * ImageAccumulator voting( ImageAccumulator::LabelVoting );
+     * for ( size_t i = 0; i < fileNames.size(); ++i )
+     *   {
+     *   voting.AddImage( ReadImage( fileNames[i] ) );
+     *   }
+     * Image labels = voting.GetResult();
+     * \endcode
+     *
+     * The memory does not depend on the number of images. The Sum
+     * and Maximum keep one image of the pixel type of the inputs, and
+     * the sum wraps or rounds in that type as the NaryAddImageFilter.
+     * The LabelVoting keeps a 16 bit count per pixel of each label
+     * found in the inputs, so at most 65535 images are voted, and
+     * gives the label with the most votes as the
+     * LabelVotingImageFilter. The pixels with more than one such label
+     * get the LabelForUndecidedPixels, by default the maximum label
+     * plus one.
+     *
+     * All the images must have the size and pixel type of the first
+     * one, which also sets the origin, spacing and direction of the
+     * result. The LabelVoting is for unsigned integer pixels.
+     *
+     * \sa itk::simple::NaryAddImageFilter
+     * \sa itk::simple::NaryMaximumImageFilter
+     * \sa itk::simple::LabelVotingImageFilter
+     */
+    class SITKBasicFilters_EXPORT ImageAccumulator
+      : public ProcessObject {
+    public:
+      typedef ImageAccumulator Self;
+
+      typedef BasicPixelIDTypeList PixelIDTypeList;
+
+      typedef enum { Sum, Maximum, LabelVoting } OperationType;
+
+      explicit ImageAccumulator( OperationType operation = Sum );
+      ~ImageAccumulator();
+
+      /** Set the operation, which also resets the accumulated state */
+      SITK_RETURN_SELF_TYPE_HEADER SetOperation ( OperationType operation );
+      OperationType GetOperation ( ) const { return this->m_Operation; }
+
+      /** Set the label of the LabelVoting for the pixels with a tie */
+      SITK_RETURN_SELF_TYPE_HEADER SetLabelForUndecidedPixels ( uint64_t label );
+      /** Get the label for the pixels with a tie, the maximum label
+       * plus one when it has not been set and after GetResult. */
+      uint64_t GetLabelForUndecidedPixels ( ) const { return this->m_LabelForUndecidedPixels; }
+
+      /** Fold an image into the accumulated state */
+      SITK_RETURN_SELF_TYPE_HEADER AddImage ( const Image &image );
+
+      /** Get the number of images added since the last reset */
+      unsigned int GetNumberOfImages ( ) const { return this->m_NumberOfImages; }
+
+      /** Compute the result of the images added so far. More images
+       * may be added after. */
+      Image GetResult ( );
+
+      /** Discard the accumulated state */
+      SITK_RETURN_SELF_TYPE_HEADER Reset ( );
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ( "ImageAccumulator" ); }
+
+      // Print ourselves out
+      std::string ToString() const;
+
+    private:
+
+      OperationType m_Operation;
+      uint64_t      m_LabelForUndecidedPixels;
+      bool          m_HasLabelForUndecidedPixels;
+      unsigned int  m_NumberOfImages;
+
+      // the running sum or maximum, or the first image of the voting
+      Image m_State;
+
+      // the labels found, and the votes of each label for each pixel
+      std::vector<uint64_t>                m_Labels;
+      std::vector< std::vector<uint16_t> > m_Votes;
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,143 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkImageExpression_h
+#define sitkImageExpression_h
+
+#include "sitkBasicFilters.h"
+#include "sitkImage.h"
+
+#include "itkSmartPointer.h"
+
+#include <string>
+
+namespace itk {
+namespace simple {
+
+class ImageExpression;
+
+/** \brief Operators which build an ImageExpression
+ *
+ * \sa ImageExpression
+ * @{
+ */
+SITKBasicFilters_EXPORT ImageExpression operator+( const ImageExpression &e1, const ImageExpression &e2 );
+SITKBasicFilters_EXPORT ImageExpression operator-( const ImageExpression &e1, const ImageExpression &e2 );
+SITKBasicFilters_EXPORT ImageExpression operator*( const ImageExpression &e1, const ImageExpression &e2 );
+SITKBasicFilters_EXPORT ImageExpression operator/( const ImageExpression &e1, const ImageExpression &e2 );
+SITKBasicFilters_EXPORT ImageExpression operator-( const ImageExpression &e );
+/**@}*/
+
+/** \class ImageExpression
+ * \brief A lazily evaluated pixel-wise arithmetic expression of images
+ *
+ * The arithmetic operators on an ImageExpression do not execute a
+ * filter, they record an expression tree. When the expression is
+ * converted to an Image, or Evaluate is called, all operations are
+ * computed in a single multi-threaded pass over the pixels. An
+ * expression such as "(a - b) * c + d / 2.0" is computed without
+ * intermediate images, and reads each input only once.
+ *
+ * \code
+ * Image result = ( ImageExpression( a ) - b ) * c + ImageExpression( d ) / 2.0;
+ * \endcode
+ *
+ * All images in an expression must have the same pixel type, size
+ * and number of components. Scalar and vector pixel types are
+ * supported, vector images are computed component-wise like the
+ * corresponding SimpleITK filters. Intermediate values are computed
+ * in double precision, then the result is converted to the pixel
+ * type of the images, with integer results clamped to the range of
+ * the pixel type. Division by zero results in the maximum value of
+ * the pixel type as with DivideImageFilter. The origin, spacing and
+ * direction of the output are those of the first image in the
+ * expression.
+ *
+ * The expression holds shallow copies of its images, so it is not
+ * affected by later modification of the original images.
+ *
+ * \sa sitkImageOperators.h for eagerly evaluated operators
+ */
+class SITKBasicFilters_EXPORT ImageExpression
+{
+public:
+  typedef ImageExpression Self;
+
+  /** Construct an expression of a single image */
+  explicit ImageExpression( const Image &image );
+
+  /** Construct an expression of a constant value */
+  explicit ImageExpression( double constant );
+
+  ImageExpression( const ImageExpression &expression );
+  ImageExpression &operator=( const ImageExpression &expression );
+  ~ImageExpression();
+
+  /** \brief Compute the expression into a new image */
+  Image Evaluate( void ) const;
+
+  /** Implicitly evaluate the expression on assignment to an Image */
+  operator Image( void ) const { return this->Evaluate(); }
+
+  /** \brief Get the number of images referenced by the expression */
+  unsigned int GetNumberOfImages( void ) const;
+
+  /** Print the expression with infix notation, the images are
+   * represented as "image0", "image1", ... in the order they are
+   * referenced. */
+  std::string ToString( void ) const;
+
+  class ExpressionNode;
+
+private:
+
+  explicit ImageExpression( ExpressionNode *node );
+
+  friend ImageExpression operator+( const ImageExpression &e1, const ImageExpression &e2 );
+  friend ImageExpression operator-( const ImageExpression &e1, const ImageExpression &e2 );
+  friend ImageExpression operator*( const ImageExpression &e1, const ImageExpression &e2 );
+  friend ImageExpression operator/( const ImageExpression &e1, const ImageExpression &e2 );
+  friend ImageExpression operator-( const ImageExpression &e );
+
+  itk::SmartPointer<ExpressionNode> m_Node;
+};
+
+/** \brief Overloads for combining expressions with images and constants
+ * @{
+ */
+inline ImageExpression operator+( const ImageExpression &e, const Image &img ) { return e + ImageExpression( img ); }
+inline ImageExpression operator+( const Image &img, const ImageExpression &e ) { return ImageExpression( img ) + e; }
+inline ImageExpression operator+( const ImageExpression &e, double s ) { return e + ImageExpression( s ); }
+inline ImageExpression operator+( double s, const ImageExpression &e ) { return ImageExpression( s ) + e; }
+inline ImageExpression operator-( const ImageExpression &e, const Image &img ) { return e - ImageExpression( img ); }
+inline ImageExpression operator-( const Image &img, const ImageExpression &e ) { return ImageExpression( img ) - e; }
+inline ImageExpression operator-( const ImageExpression &e, double s ) { return e - ImageExpression( s ); }
+inline ImageExpression operator-( double s, const ImageExpression &e ) { return ImageExpression( s ) - e; }
+inline ImageExpression operator*( const ImageExpression &e, const Image &img ) { return e * ImageExpression( img ); }
+inline ImageExpression operator*( const Image &img, const ImageExpression &e ) { return ImageExpression( img ) * e; }
+inline ImageExpression operator*( const ImageExpression &e, double s ) { return e * ImageExpression( s ); }
+inline ImageExpression operator*( double s, const ImageExpression &e ) { return ImageExpression( s ) * e; }
+inline ImageExpression operator/( const ImageExpression &e, const Image &img ) { return e / ImageExpression( img ); }
+inline ImageExpression operator/( const Image &img, const ImageExpression &e ) { return ImageExpression( img ) / e; }
+inline ImageExpression operator/( const ImageExpression &e, double s ) { return e / ImageExpression( s ); }
+inline ImageExpression operator/( double s, const ImageExpression &e ) { return ImageExpression( s ) / e; }
+/**@}*/
+
+}
+}
+
+#endif // sitkImageExpression_h
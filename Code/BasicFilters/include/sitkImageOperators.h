@@ -29,6 +29,8 @@
 #include "sitkOrImageFilter.h"
 #include "sitkXorImageFilter.h"
 
+#include <utility>
+
 namespace itk {
 namespace simple {
 
@@ -75,23 +77,39 @@ inline Image operator^( const Image &img1, const Image &img2 ) { return Xor(img1
 inline Image operator^( const Image &img, int s ) { return Xor(img, s ); }
 inline Image operator^( int s, const Image &img ) { return Xor(s, img ); }
 
-/** \todo these operators should some how be done "in-place" */
-inline Image operator+=( Image &img1, const Image &img2 ) { return img1 = Add(img1, img2 ); }
-inline Image operator+=( Image &img1, double s ) { return img1 = Add(img1, s ); }
-inline Image operator-=( Image &img1, const Image &img2 ) { return img1 = Subtract(img1, img2 ); }
-inline Image operator-=( Image &img1, double s ) { return img1 = Subtract(img1, s ); }
-inline Image operator*=( Image &img1, const Image &img2 ) { return img1 = Multiply(img1, img2 ); }
-inline Image operator*=( Image &img1, double s ) { return img1 = Multiply(img1, s ); }
-inline Image operator/=( Image &img1, const Image &img2 ) { return img1 = Divide(img1, img2 ); }
-inline Image operator/=( Image &img1, double s ) { return img1 = Divide(img1, s ); }
-inline Image operator%=( Image &img1, const Image &img2 ) { return img1 = Modulus(img1, img2 ); }
-inline Image operator%=( Image &img1, uint32_t s ) { return img1 = Modulus(img1, s ); }
-inline Image operator&=( Image &img1, const Image &img2 ) { return img1 = And(img1, img2 ); }
-inline Image operator&=( Image &img1, int s ) { return img1 = And(img1, s ); }
-inline Image operator|=( Image &img1, const Image &img2 ) { return img1 = Or(img1, img2 ); }
-inline Image operator|=( Image &img1, int s ) { return img1 = Or(img1, s ); }
-inline Image operator^=( Image &img1, const Image &img2 ) { return img1 = Xor(img1, img2 ); }
-inline Image operator^=( Image &img1, int s ) { return img1 = Xor(img1, s ); }
+#if defined(SITK_HAS_CXX11_RVREF)
+/** The operators with a temporary image as the first operand reuse
+ * its buffer for the result, so that chained expressions such as
+ * "a + b + c" only allocate one new image. */
+inline Image operator+( Image &&img1, const Image &img2 ) { return AddImageFilter().Execute( std::move(img1), img2 ); }
+inline Image operator+( Image &&img, double s ) { return AddImageFilter().Execute( std::move(img), s ); }
+inline Image operator-( Image &&img1, const Image &img2 ) { return SubtractImageFilter().Execute( std::move(img1), img2 ); }
+inline Image operator-( Image &&img, double s ) { return SubtractImageFilter().Execute( std::move(img), s ); }
+inline Image operator*( Image &&img1, const Image &img2 ) { return MultiplyImageFilter().Execute( std::move(img1), img2 ); }
+inline Image operator*( Image &&img, double s ) { return MultiplyImageFilter().Execute( std::move(img), s ); }
+inline Image operator/( Image &&img1, const Image &img2 ) { return DivideImageFilter().Execute( std::move(img1), img2 ); }
+inline Image operator/( Image &&img, double s ) { return DivideImageFilter().Execute( std::move(img), s ); }
+#endif
+
+/** The compound assignment operators run the filter in-place, the
+ * result is computed in the buffer of img1 when it is not shared with
+ * another image and the pixel type is unchanged. */
+inline Image &operator+=( Image &img1, const Image &img2 ) { AddImageFilter().ExecuteInPlace( img1, img2 ); return img1; }
+inline Image &operator+=( Image &img1, double s ) { AddImageFilter().ExecuteInPlace( img1, s ); return img1; }
+inline Image &operator-=( Image &img1, const Image &img2 ) { SubtractImageFilter().ExecuteInPlace( img1, img2 ); return img1; }
+inline Image &operator-=( Image &img1, double s ) { SubtractImageFilter().ExecuteInPlace( img1, s ); return img1; }
+inline Image &operator*=( Image &img1, const Image &img2 ) { MultiplyImageFilter().ExecuteInPlace( img1, img2 ); return img1; }
+inline Image &operator*=( Image &img1, double s ) { MultiplyImageFilter().ExecuteInPlace( img1, s ); return img1; }
+inline Image &operator/=( Image &img1, const Image &img2 ) { DivideImageFilter().ExecuteInPlace( img1, img2 ); return img1; }
+inline Image &operator/=( Image &img1, double s ) { DivideImageFilter().ExecuteInPlace( img1, s ); return img1; }
+inline Image &operator%=( Image &img1, const Image &img2 ) { ModulusImageFilter().ExecuteInPlace( img1, img2 ); return img1; }
+inline Image &operator%=( Image &img1, uint32_t s ) { ModulusImageFilter().ExecuteInPlace( img1, s ); return img1; }
+inline Image &operator&=( Image &img1, const Image &img2 ) { AndImageFilter().ExecuteInPlace( img1, img2 ); return img1; }
+inline Image &operator&=( Image &img1, int s ) { AndImageFilter().ExecuteInPlace( img1, s ); return img1; }
+inline Image &operator|=( Image &img1, const Image &img2 ) { OrImageFilter().ExecuteInPlace( img1, img2 ); return img1; }
+inline Image &operator|=( Image &img1, int s ) { OrImageFilter().ExecuteInPlace( img1, s ); return img1; }
+inline Image &operator^=( Image &img1, const Image &img2 ) { XorImageFilter().ExecuteInPlace( img1, img2 ); return img1; }
+inline Image &operator^=( Image &img1, int s ) { XorImageFilter().ExecuteInPlace( img1, s ); return img1; }
 /**@} */
 }
 }
@@ -0,0 +1,344 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkLabelFeaturesImageFilter_h
+#define sitkLabelFeaturesImageFilter_h
+
+#include "sitkBasicFilters.h"
+#include "sitkImageFilter.h"
+#include "sitkDualMemberFunctionFactory.h"
+
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    namespace detail {
+      template <unsigned int VDimension> class LabelAccumulators;
+    }
+
+    /**\class LabelFeaturesImageFilter
+\brief Compute selected shape and intensity features of each label of
+a label image in a single multi-threaded pass.
+
+The LabelShapeStatisticsImageFilter and the
+LabelIntensityStatisticsImageFilter each build a label map before
+computing their features. This filter accumulates the selected
+features of each label directly from the pixels: each thread scans a
+part of the image into its own accumulators, which are merged at the
+end. No label map is built.
+
+The features are selected with SetFeatures as a combination of the
+FeatureType flags. The shape features are computed from the label
+image, the intensity features from the optional intensity image,
+which must have the size of the label image. The pixels with the
+BackgroundValue are skipped.
+
+The positions are in physical units, computed from the pixel indices
+with the origin, spacing and direction of the label image.
+
+An image which does not fit in memory is processed in chunks, such as
+the regions read with the ExtractIndex and ExtractSize of the
+ImageFileReader. Each chunk is added with its index in the whole image
+by AddChunk, which accumulates its pixels into the features of the
+previous chunks, so a label may span several chunks. ExecuteChunks
+computes the measurements of the whole image. The chunks must not
+overlap.
+
+The label image may also be a label map, of the sitkLabelUInt8 to
+sitkLabelUInt64 pixel types. The features are then accumulated from
+the runs of the label objects, without a dense pass over the label
+image: the shape features of a run are computed from its first index
+and length, and only the intensity pixels inside of the runs are
+read. The pixels of the background of the label map are not in its
+runs, so they are never measured.
+
+\sa itk::simple::LabelShapeStatisticsImageFilter
+\sa itk::simple::LabelIntensityStatisticsImageFilter
+     */
+    class SITKBasicFilters_EXPORT LabelFeaturesImageFilter : public ProcessObject {
+    public:
+      typedef LabelFeaturesImageFilter Self;
+
+      /** Default Constructor that takes no arguments and initializes
+       * default parameters */
+      LabelFeaturesImageFilter();
+
+      /** Destructor */
+      ~LabelFeaturesImageFilter();
+
+      /** Define the pixels types supported by this filter */
+      typedef IntegerPixelIDTypeList PixelIDTypeList;
+      typedef BasicPixelIDTypeList   PixelIDTypeList2;
+      typedef LabelPixelIDTypeList   LabelMapPixelIDTypeList;
+
+      /** The features, to be combined with a bitwise or. */
+      enum FeatureType {
+        /// The number of pixels of the label
+        NUMBER_OF_PIXELS = 1,
+        /// The index and size of the bounding box of the label
+        BOUNDING_BOX = 2,
+        /// The mean position of the pixels of the label
+        CENTROID = 4,
+        /// The central second order moments of the positions
+        SECOND_ORDER_MOMENTS = 8,
+        /// The sum and mean of the intensities
+        MEAN = 16,
+        /// The minimum and maximum of the intensities
+        MINIMUM_MAXIMUM = 32,
+        /// The variance and standard deviation of the intensities
+        VARIANCE = 64,
+        /// The intensity weighted mean position
+        CENTER_OF_GRAVITY = 128,
+        ALL_SHAPE_FEATURES = 15,
+        ALL_INTENSITY_FEATURES = 240,
+        ALL_FEATURES = 255
+      };
+
+      /**
+       * Set/Get the features to compute, as a combination of the
+       * FeatureType flags. All the features are computed by default.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetFeatures ( unsigned int Features ) { this->m_Features = Features; return *this; }
+
+      /**
+       * Set/Get the features to compute.
+       */
+        unsigned int GetFeatures() const { return this->m_Features; }
+
+      /**
+       * Set/Get the label of the pixels which are skipped. The
+       * default is 0.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetBackgroundValue ( int64_t BackgroundValue ) { this->m_BackgroundValue = BackgroundValue; return *this; }
+
+      /**
+       * Set/Get the label of the pixels which are skipped.
+       */
+        int64_t GetBackgroundValue() const { return this->m_BackgroundValue; }
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ("LabelFeaturesImageFilter"); }
+
+      /** Print ourselves out */
+      std::string ToString() const;
+
+
+      /** Compute the shape features of the labels */
+      void Execute ( const Image & labelImage );
+
+      /** Compute the shape features of the labels, and the intensity
+       * features of the intensity image in each label */
+      void Execute ( const Image & labelImage, const Image & intensityImage );
+
+
+      /** Remove the features accumulated by AddChunk. */
+      void ClearChunks ();
+
+      /** Accumulate the shape features of the labels of a chunk of
+       * the label image, whose first pixel is at chunkIndex in the
+       * whole image. */
+      void AddChunk ( const Image & labelChunk, const std::vector<int> & chunkIndex );
+
+      /** Accumulate the shape features of the labels of a chunk of
+       * the label image, and the intensity features of the matching
+       * chunk of the intensity image. */
+      void AddChunk ( const Image & labelChunk, const Image & intensityChunk, const std::vector<int> & chunkIndex );
+
+      /** The number of chunks added since the last ClearChunks. */
+      uint64_t GetNumberOfChunks () const;
+
+      /** Compute the measurements from the features of the chunks
+       * added since the last ClearChunks. The features selected when
+       * the first chunk was added are computed. */
+      void ExecuteChunks ();
+
+
+      /** The labels found in the last execution, in increasing order.
+       *
+       * This is a measurement. Its value is updated in the Execute
+       * methods, so the value will only be valid after an execution.
+       */
+      std::vector<int64_t> GetLabels() const { return this->m_Labels; }
+
+      /** Return the number of labels after execution. */
+      uint64_t GetNumberOfLabels() const { return this->m_Labels.size(); }
+
+      /** Does the specified label exist? Can only be called after an
+       * execution. */
+      bool HasLabel( int64_t label ) const;
+
+      /** The features computed in the last execution. The intensity
+       * features are only computed with an intensity image. */
+      unsigned int GetComputedFeatures() const { return this->m_ComputedFeatures; }
+
+      /** \name Per label measurements
+       *
+       * These are measurements, valid after an execution which
+       * computed the feature. An exception is thrown if the label
+       * does not exist or the feature was not computed.
+       * @{
+       */
+      uint64_t GetNumberOfPixels( int64_t label ) const;
+
+      /** The index of the first pixel followed by the size, as for
+       * the LabelShapeStatisticsImageFilter */
+      std::vector<unsigned int> GetBoundingBox( int64_t label ) const;
+
+      std::vector<double> GetCentroid( int64_t label ) const;
+
+      /** The covariance of the physical positions of the pixels, as
+       * a row major matrix. */
+      std::vector<double> GetSecondOrderMoments( int64_t label ) const;
+
+      /** The eigenvalues of the second order moments, in increasing
+       * order. */
+      std::vector<double> GetPrincipalMoments( int64_t label ) const;
+
+      double GetSum( int64_t label ) const;
+      double GetMean( int64_t label ) const;
+      double GetMinimum( int64_t label ) const;
+      double GetMaximum( int64_t label ) const;
+      double GetVariance( int64_t label ) const;
+      double GetStandardDeviation( int64_t label ) const;
+      std::vector<double> GetCenterOfGravity( int64_t label ) const;
+      /**@}*/
+
+      /** \name Measurements of all the labels
+       *
+       * The features of all the labels, in the order of GetLabels, as
+       * contiguous arrays. The values of a label follow each other:
+       * the dimension of the image values for the positions, twice
+       * the dimension for the bounding boxes, and the square of the
+       * dimension for the second order moments. An array is empty if
+       * its feature was not computed in the last execution.
+       * @{
+       */
+      std::vector<uint64_t> GetNumberOfPixelsArray() const { return this->m_NumberOfPixels; }
+      std::vector<unsigned int> GetBoundingBoxArray() const { return this->m_BoundingBox; }
+      std::vector<double> GetCentroidArray() const { return this->m_Centroid; }
+      std::vector<double> GetSecondOrderMomentsArray() const { return this->m_SecondOrderMoments; }
+      std::vector<double> GetSumArray() const { return this->m_Sum; }
+      std::vector<double> GetMeanArray() const;
+      std::vector<double> GetMinimumArray() const { return this->m_Minimum; }
+      std::vector<double> GetMaximumArray() const { return this->m_Maximum; }
+      std::vector<double> GetVarianceArray() const { return this->m_Variance; }
+      std::vector<double> GetCenterOfGravityArray() const { return this->m_CenterOfGravity; }
+      /**@}*/
+
+      /** The dimension of the label image of the last execution. */
+      unsigned int GetDimension() const { return this->m_Dimension; }
+
+    private:
+
+      /** Setup for member function dispatching */
+
+      typedef void (Self::*MemberFunctionType)( const Image & labelImage, const Image & intensityImage );
+      template <class TImageType, class TImageType2> void DualExecuteInternal ( const Image & labelImage, const Image & intensityImage );
+
+      template <class TLabelMapType, class TImageType2> void LabelMapExecuteInternal ( const Image & labelImage, const Image & intensityImage );
+
+      friend struct detail::DualExecuteInternalAddressor<MemberFunctionType>;
+
+// SWIG does not appear to process private classes correctly
+#ifndef SWIG
+      /** An addressor of LabelMapExecuteInternal to be utilized with
+       * registering member functions with the factory.
+       */
+      template < class TMemberFunctionPointer >
+      struct LabelMapAddressor
+      {
+        typedef typename ::detail::FunctionTraits<TMemberFunctionPointer>::ClassType ObjectType;
+
+        template< typename TImageType1, typename TImageType2 >
+        TMemberFunctionPointer operator() ( void ) const
+        {
+          return &ObjectType::template LabelMapExecuteInternal< TImageType1, TImageType2 >;
+        }
+      };
+#endif
+
+      // Dispatch to the execution of the pixel types of the images,
+      // the intensity image is the label image when it is not used.
+      void Dispatch ( const Image & labelImage, const Image & intensityImage );
+
+      nsstd::auto_ptr<detail::DualMemberFunctionFactory<MemberFunctionType> > m_DualMemberFactory;
+
+      // The position of a label in the measurements, after checking
+      // that the feature was computed.
+      size_t GetLabelPosition( int64_t label, unsigned int feature ) const;
+
+      unsigned int m_Features;
+      int64_t      m_BackgroundValue;
+
+      // The features of the chunks, with the geometry of the whole
+      // image, for a dimension.
+      struct ChunkState;
+      template <unsigned int VDimension> struct DimensionChunkState;
+
+      // The accumulators of the features of an execution, those of
+      // the previous chunks when a chunk is added. The index of the
+      // chunk, the origin at its index 0 and the features are set.
+      template <unsigned int VDimension>
+      detail::LabelAccumulators<VDimension> * BeginAccumulation ( const Image &labelImage,
+                                                                  detail::LabelAccumulators<VDimension> &imageAccumulators,
+                                                                  std::vector<int> &indexOffset,
+                                                                  std::vector<double> &origin,
+                                                                  unsigned int &features );
+
+      // Compute the measurements, unless a chunk was added.
+      template <unsigned int VDimension>
+      void EndAccumulation ( const Image &labelImage,
+                             const detail::LabelAccumulators<VDimension> &imageAccumulators,
+                             const std::vector<double> &origin,
+                             unsigned int features );
+
+      // Set the measurements from the features of the labels.
+      template <unsigned int VDimension>
+      void ComputeMeasurements ( const detail::LabelAccumulators<VDimension> &accumulators,
+                                 const std::vector<double> &origin,
+                                 const std::vector<double> &spacing,
+                                 const std::vector<double> &direction,
+                                 unsigned int features,
+                                 bool useIntensityImage );
+
+      // set by Execute and AddChunk for DualExecuteInternal
+      bool              m_UseIntensityImage;
+      bool              m_AddChunk;
+      std::vector<int>  m_ChunkIndex;
+
+      nsstd::auto_ptr<ChunkState> m_ChunkState;
+
+      // The measurements are stored per feature, with the values of
+      // each label contiguous, in the order of m_Labels.
+      unsigned int              m_Dimension;
+      unsigned int              m_ComputedFeatures;
+      std::vector<int64_t>      m_Labels;
+      std::vector<uint64_t>     m_NumberOfPixels;
+      std::vector<unsigned int> m_BoundingBox;
+      std::vector<double>       m_Centroid;
+      std::vector<double>       m_SecondOrderMoments;
+      std::vector<double>       m_Sum;
+      std::vector<double>       m_Minimum;
+      std::vector<double>       m_Maximum;
+      std::vector<double>       m_Variance;
+      std::vector<double>       m_CenterOfGravity;
+    };
+
+  }
+}
+#endif
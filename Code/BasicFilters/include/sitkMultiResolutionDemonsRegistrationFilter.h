@@ -0,0 +1,302 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkMultiResolutionDemonsRegistrationFilter_h
+#define sitkMultiResolutionDemonsRegistrationFilter_h
+
+#include <memory>
+
+#include "sitkBasicFilters.h"
+#include "sitkImageFilter.h"
+
+namespace itk {
+  namespace simple {
+
+    /**\class MultiResolutionDemonsRegistrationFilter
+
+\brief Deformably register two images with a demons algorithm over a
+multi-resolution pyramid.
+
+The fixed and moving images are downsampled into a pyramid, and the
+displacement field is computed by a demons registration filter from
+the coarsest level to the finest, where the field of each level is
+upsampled to initialize the next. The pyramid and the displacement
+field are kept by the ITK filter between the levels, so the
+registration does not copy the images or the field through SimpleITK
+at each level.
+
+The demons algorithm at each level is selected by SetDemonsType from
+the algorithms of the DemonsRegistrationFilter,
+SymmetricForcesDemonsRegistrationFilter,
+FastSymmetricForcesDemonsRegistrationFilter and
+DiffeomorphicDemonsRegistrationFilter, and is executed for the number
+of iterations of the level, or until the root mean square change of
+the field is less than MaximumRMSError.
+
+The levels of the pyramid are shrunk by a factor of 2 from the finer
+level, the finest level being the fixed image. An initial displacement
+field may be given, which is smoothed and downsampled to the coarsest
+level. The output is the displacement field on the fixed image's
+domain.
+
+\sa itk::MultiResolutionPDEDeformableRegistration for the Doxygen on the original ITK class.
+\sa itk::simple::DemonsRegistrationFilter for a single resolution registration
+     */
+    class SITKBasicFilters_EXPORT MultiResolutionDemonsRegistrationFilter : public ImageFilter<0> {
+    public:
+      typedef MultiResolutionDemonsRegistrationFilter Self;
+
+      /** Default Constructor that takes no arguments and initializes
+       * default parameters */
+      MultiResolutionDemonsRegistrationFilter();
+
+      /** Destructor */
+      ~MultiResolutionDemonsRegistrationFilter();
+
+      /** Define the pixels types supported by this filter */
+      typedef BasicPixelIDTypeList  PixelIDTypeList;
+
+      typedef enum {Demons,SymmetricForces,FastSymmetricForces,Diffeomorphic} DemonsTypeType;
+
+      /**
+       * Set/Get the demons algorithm of the registration at each level.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetDemonsType ( DemonsTypeType DemonsType ) { this->m_DemonsType = DemonsType; return *this; }
+
+      /**
+       * Set/Get the demons algorithm of the registration at each level.
+       */
+        DemonsTypeType GetDemonsType() const { return this->m_DemonsType; }
+
+      /**
+       * Set/Get the number of levels of the pyramid.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetNumberOfLevels ( unsigned int NumberOfLevels ) { this->m_NumberOfLevels = NumberOfLevels; return *this; }
+
+      /**
+       * Set/Get the number of levels of the pyramid.
+       */
+        unsigned int GetNumberOfLevels() const { return this->m_NumberOfLevels; }
+
+      /**
+       * Set/Get the number of iterations at each level, from the
+       * coarsest level. A single value is used for all the levels.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetNumberOfIterations ( const std::vector<uint32_t> & NumberOfIterations ) { this->m_NumberOfIterations = NumberOfIterations; return *this; }
+
+      /** Set the values of the NumberOfIterations vector all to value */
+      SITK_RETURN_SELF_TYPE_HEADER SetNumberOfIterations( uint32_t value ) { this->m_NumberOfIterations = std::vector<uint32_t>(1,value); return *this; }
+
+      /**
+       * Set/Get the number of iterations at each level, from the
+       * coarsest level. A single value is used for all the levels.
+       */
+        std::vector<uint32_t> GetNumberOfIterations() const { return this->m_NumberOfIterations; }
+
+      /**
+       * Set/Get the Gaussian smoothing standard deviations for the displacement field. The values are set with respect to pixel coordinates.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetStandardDeviations ( const std::vector<double> & StandardDeviations ) { this->m_StandardDeviations = StandardDeviations; return *this; }
+
+      /** Set the values of the StandardDeviations vector all to value */
+      SITK_RETURN_SELF_TYPE_HEADER SetStandardDeviations( double value ) { this->m_StandardDeviations = std::vector<double>(3,value); return *this; }
+
+      /**
+       * Set/Get the Gaussian smoothing standard deviations for the displacement field. The values are set with respect to pixel coordinates.
+       */
+        std::vector<double> GetStandardDeviations() const { return this->m_StandardDeviations; }
+
+      /**
+       * Value of RMS change below which the registration of a level should stop. This is a convergence criterion.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetMaximumRMSError ( double MaximumRMSError ) { this->m_MaximumRMSError = MaximumRMSError; return *this; }
+
+      /**
+       * Value of RMS change below which the registration of a level should stop. This is a convergence criterion.
+       */
+        double GetMaximumRMSError() const { return this->m_MaximumRMSError; }
+
+      /**
+       * Set/Get whether the displacement field is smoothed (regularized). Smoothing the displacement yields a solution elastic in nature. If SmoothDisplacementField is on, then the displacement field is smoothed with a Gaussian whose standard deviations are specified with SetStandardDeviations()
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetSmoothDisplacementField ( bool SmoothDisplacementField ) { this->m_SmoothDisplacementField = SmoothDisplacementField; return *this; }
+
+      /** Set the value of SmoothDisplacementField to true or false respectfully. */
+      SITK_RETURN_SELF_TYPE_HEADER SmoothDisplacementFieldOn() { return this->SetSmoothDisplacementField(true); }
+      SITK_RETURN_SELF_TYPE_HEADER SmoothDisplacementFieldOff() { return this->SetSmoothDisplacementField(false); }
+
+      /**
+       * Set/Get whether the displacement field is smoothed (regularized). Smoothing the displacement yields a solution elastic in nature. If SmoothDisplacementField is on, then the displacement field is smoothed with a Gaussian whose standard deviations are specified with SetStandardDeviations()
+       */
+        bool GetSmoothDisplacementField() const { return this->m_SmoothDisplacementField; }
+
+      /**
+       * Set/Get whether the update field is smoothed (regularized). Smoothing the update field yields a solution viscous in nature. If SmoothUpdateField is on, then the update field is smoothed with a Gaussian whose standard deviations are specified with SetUpdateFieldStandardDeviations()
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetSmoothUpdateField ( bool SmoothUpdateField ) { this->m_SmoothUpdateField = SmoothUpdateField; return *this; }
+
+      /** Set the value of SmoothUpdateField to true or false respectfully. */
+      SITK_RETURN_SELF_TYPE_HEADER SmoothUpdateFieldOn() { return this->SetSmoothUpdateField(true); }
+      SITK_RETURN_SELF_TYPE_HEADER SmoothUpdateFieldOff() { return this->SetSmoothUpdateField(false); }
+
+      /**
+       * Set/Get whether the update field is smoothed (regularized). Smoothing the update field yields a solution viscous in nature. If SmoothUpdateField is on, then the update field is smoothed with a Gaussian whose standard deviations are specified with SetUpdateFieldStandardDeviations()
+       */
+        bool GetSmoothUpdateField() const { return this->m_SmoothUpdateField; }
+
+      /**
+       * Set the Gaussian smoothing standard deviations for the update field. The values are set with respect to pixel coordinates.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetUpdateFieldStandardDeviations ( const std::vector<double> & UpdateFieldStandardDeviations ) { this->m_UpdateFieldStandardDeviations = UpdateFieldStandardDeviations; return *this; }
+
+      /** Set the values of the UpdateFieldStandardDeviations vector all to value */
+      SITK_RETURN_SELF_TYPE_HEADER SetUpdateFieldStandardDeviations( double value ) { this->m_UpdateFieldStandardDeviations = std::vector<double>(3,value); return *this; }
+
+      /**
+       * Set the Gaussian smoothing standard deviations for the update field. The values are set with respect to pixel coordinates.
+       */
+        std::vector<double> GetUpdateFieldStandardDeviations() const { return this->m_UpdateFieldStandardDeviations; }
+
+      /**
+       * Set/Get the desired limits of the Gaussian kernel width.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetMaximumKernelWidth ( unsigned int MaximumKernelWidth ) { this->m_MaximumKernelWidth = MaximumKernelWidth; return *this; }
+
+      /**
+       * Set/Get the desired limits of the Gaussian kernel width.
+       */
+        unsigned int GetMaximumKernelWidth() const { return this->m_MaximumKernelWidth; }
+
+      /**
+       * Set/Get the desired maximum error of the Guassian kernel approximate.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetMaximumError ( double MaximumError ) { this->m_MaximumError = MaximumError; return *this; }
+
+      /**
+       * Set/Get the desired maximum error of the Guassian kernel approximate.
+       */
+        double GetMaximumError() const { return this->m_MaximumError; }
+
+      /**
+       * Set/Get the threshold below which the absolute difference of intensity yields a match. When the intensities match between a moving and fixed image pixel, the update vector (for that iteration) will be the zero vector. Default is 0.001.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetIntensityDifferenceThreshold ( double IntensityDifferenceThreshold ) { this->m_IntensityDifferenceThreshold = IntensityDifferenceThreshold; return *this; }
+
+      /**
+       * Set/Get the threshold below which the absolute difference of intensity yields a match. When the intensities match between a moving and fixed image pixel, the update vector (for that iteration) will be the zero vector. Default is 0.001.
+       */
+        double GetIntensityDifferenceThreshold() const { return this->m_IntensityDifferenceThreshold; }
+
+      /**
+       * Set/Get whether the spacing of the images is used to compute the update.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetUseImageSpacing ( bool UseImageSpacing ) { this->m_UseImageSpacing = UseImageSpacing; return *this; }
+
+      /** Set the value of UseImageSpacing to true or false respectfully. */
+      SITK_RETURN_SELF_TYPE_HEADER UseImageSpacingOn() { return this->SetUseImageSpacing(true); }
+      SITK_RETURN_SELF_TYPE_HEADER UseImageSpacingOff() { return this->SetUseImageSpacing(false); }
+
+      /**
+       * Set/Get whether the spacing of the images is used to compute the update.
+       */
+        bool GetUseImageSpacing() const { return this->m_UseImageSpacing; }
+
+      /** The level of the pyramid being registered, from the coarsest level.
+       *
+       * This is an active measurement. It may be accessed while the
+       * filter is being executing in command call-backs and can be
+       * accessed after execution.
+       */
+      uint32_t GetCurrentLevel() const { return this->m_pfGetCurrentLevel(); };
+
+      /** Number of iterations run at the current level.
+       *
+       * This is an active measurement. It may be accessed while the
+       * filter is being executing in command call-backs and can be
+       * accessed after execution.
+       */
+      uint32_t GetElapsedIterations() const { return this->m_pfGetElapsedIterations(); };
+
+      /** The root mean squared change of the previous iteration.
+       *
+       * This is an active measurement. It may be accessed while the
+       * filter is being executing in command call-backs and can be
+       * accessed after execution.
+       */
+      double GetRMSChange() const { return this->m_pfGetRMSChange(); };
+
+      /** The mean square difference in intensity between the fixed
+       * image and transforming moving image of the current level.
+       *
+       * This is an active measurement. It may be accessed while the
+       * filter is being executing in command call-backs and can be
+       * accessed after execution.
+       */
+      double GetMetric() const { return this->m_pfGetMetric(); };
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ("MultiResolutionDemonsRegistrationFilter"); }
+
+      /** Print ourselves out */
+      std::string ToString() const;
+
+
+      /** Execute the filter on the input images */
+      Image Execute ( const Image & fixedImage, const Image & movingImage, const Image & initialDisplacementField );
+
+      /** Execute the filter on the input images */
+      Image Execute ( const Image & fixedImage, const Image & movingImage );
+
+    private:
+
+      /** Setup for member function dispatching */
+
+      typedef Image (Self::*MemberFunctionType)( const Image * fixedImage, const Image * movingImage, const Image * initialDisplacementField );
+      template <class TImageType> Image ExecuteInternal ( const Image * fixedImage, const Image * movingImage, const Image * initialDisplacementField );
+
+
+      friend struct detail::MemberFunctionAddressor<MemberFunctionType>;
+
+      nsstd::auto_ptr<detail::MemberFunctionFactory<MemberFunctionType> > m_MemberFactory;
+
+
+      DemonsTypeType  m_DemonsType;
+      unsigned int  m_NumberOfLevels;
+      std::vector<uint32_t>  m_NumberOfIterations;
+      std::vector<double>  m_StandardDeviations;
+      double  m_MaximumRMSError;
+      bool  m_SmoothDisplacementField;
+      bool  m_SmoothUpdateField;
+      std::vector<double>  m_UpdateFieldStandardDeviations;
+      unsigned int  m_MaximumKernelWidth;
+      double  m_MaximumError;
+      double  m_IntensityDifferenceThreshold;
+      bool  m_UseImageSpacing;
+
+      nsstd::function<uint32_t()> m_pfGetCurrentLevel;
+      nsstd::function<uint32_t()> m_pfGetElapsedIterations;
+      nsstd::function<double()> m_pfGetRMSChange;
+      nsstd::function<double()> m_pfGetMetric;
+
+      // Holder of process object for active measurements
+      itk::ProcessObject *m_Filter;
+    };
+
+
+  }
+}
+#endif
@@ -0,0 +1,161 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkNormalizedCorrelationMatcher_h
+#define sitkNormalizedCorrelationMatcher_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkBasicFilters.h"
+#include "sitkProcessObject.h"
+
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class NormalizedCorrelationMatcher
+     * \brief Match many templates against one fixed image with the
+     * masked normalized cross correlation
+     *
+     * The FFTNormalizedCorrelationImageFilter and the
+     * MaskedFFTNormalizedCorrelationImageFilter compute the FFTs of
+     * the fixed image, of its square and of its mask for each moving
+     * image. This object computes them once for the fixed image, and
+     * only the FFTs of each template, the moving image, are computed
+     * when it is matched. The moving images matched against a cached
+     * fixed image share its padded size, so FFTW plans are created
+     * for one size.
+     *
+     * \code
+     * NormalizedCorrelationMatcher matcher;
+     * matcher.SetFixedImage( frame );
+     * for ( unsigned int i = 0; i < templates.size(); ++i )
+     *   {
+     *   std::vector< std::vector<unsigned int> > peaks = matcher.FindPeaks( templates[i], 3 );
+     *   std::vector<double> values = matcher.GetPeakValues();
+     *   }
+     * \endcode
+     *
+     * The correlation is that of the masked filter, with the masks
+     * of the fixed and moving images all ones when they are not
+     * set. The correlation image has the size of the fixed image plus
+     * the size of the moving image minus one, in double precision.
+     * The pixel at index i of the correlation is the correlation of
+     * the moving image placed with its first pixel on the pixel at
+     * index i minus the size of the moving image plus one of the
+     * fixed image. The origin of the correlation is the physical
+     * point of that pixel, so a peak at a point places the first
+     * pixel of the moving image at the point.
+     *
+     * The FFTs of the fixed image are computed for the padded size of
+     * the largest moving image matched, and are computed again for a
+     * moving image larger than the previous ones.
+     *
+     * \sa itk::simple::MaskedFFTNormalizedCorrelationImageFilter
+     * \sa itk::simple::FFTConfiguration
+     */
+    class SITKBasicFilters_EXPORT NormalizedCorrelationMatcher
+      : public ProcessObject {
+    public:
+      typedef NormalizedCorrelationMatcher Self;
+
+      typedef BasicPixelIDTypeList PixelIDTypeList;
+
+      NormalizedCorrelationMatcher();
+      ~NormalizedCorrelationMatcher();
+
+      /** Set the fixed image the moving images are matched against.
+       * The cached FFTs of the fixed image are released. */
+      SITK_RETURN_SELF_TYPE_HEADER SetFixedImage ( const Image &fixedImage );
+      Image GetFixedImage ( ) const { return this->m_FixedImage; }
+
+      /** Set the mask of the fixed image, the pixels which are not 0,
+       * or an empty image for no mask. The cached FFTs of the fixed
+       * image are released. */
+      SITK_RETURN_SELF_TYPE_HEADER SetFixedImageMask ( const Image &fixedImageMask );
+      Image GetFixedImageMask ( ) const { return this->m_FixedImageMask; }
+
+      /** Set the number of overlapping pixels of the masks below
+       * which the correlation is 0 */
+      SITK_RETURN_SELF_TYPE_HEADER SetRequiredNumberOfOverlappingPixels ( uint64_t requiredNumberOfOverlappingPixels ) { this->m_RequiredNumberOfOverlappingPixels = requiredNumberOfOverlappingPixels; return *this; }
+      uint64_t GetRequiredNumberOfOverlappingPixels ( ) const { return this->m_RequiredNumberOfOverlappingPixels; }
+
+      /** Set the fraction of the largest number of overlapping pixels
+       * below which the correlation is 0 */
+      SITK_RETURN_SELF_TYPE_HEADER SetRequiredFractionOfOverlappingPixels ( float requiredFractionOfOverlappingPixels ) { this->m_RequiredFractionOfOverlappingPixels = requiredFractionOfOverlappingPixels; return *this; }
+      float GetRequiredFractionOfOverlappingPixels ( ) const { return this->m_RequiredFractionOfOverlappingPixels; }
+
+      /** Compute the correlation of a moving image, with an optional
+       * mask of the moving image. */
+      Image Execute ( const Image &movingImage );
+      Image Execute ( const Image &movingImage, const Image &movingImageMask );
+
+      /** Compute the correlations of several moving images. The FFTs
+       * of the fixed image are computed once for the largest one. */
+      std::vector<Image> Execute ( const std::vector<Image> &movingImages );
+
+      /** \brief Find the indexes of the highest local maxima of the
+       * correlation of a moving image.
+       *
+       * The local maxima are not less than their neighbors, including
+       * the diagonal ones, and are returned from the highest. Their
+       * values are returned by GetPeakValues. The correlation image is
+       * not kept.
+       */
+      std::vector< std::vector<unsigned int> > FindPeaks ( const Image &movingImage, unsigned int numberOfPeaks );
+
+      /** The values of the peaks found by the last call to FindPeaks */
+      std::vector<double> GetPeakValues ( ) const { return this->m_PeakValues; }
+
+      /** Get the padded size the FFTs of the fixed image are cached
+       * for, empty when no moving image has been matched. */
+      std::vector<unsigned int> GetPaddedSize ( ) const { return this->m_PaddedSize; }
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ( "NormalizedCorrelationMatcher" ); }
+
+      // Print ourselves out
+      std::string ToString() const;
+
+    private:
+
+      Image ExecuteInternal ( const Image &movingImage, const Image *movingImageMask, const std::vector<unsigned int> &largestMovingSize );
+
+      template <unsigned int VImageDimension>
+      Image ExecuteInternal ( const Image &movingImage, const Image *movingImageMask, const std::vector<unsigned int> &largestMovingSize );
+
+      void ReleaseFixedTransforms ( );
+
+      Image    m_FixedImage;
+      Image    m_FixedImageMask;
+      uint64_t m_RequiredNumberOfOverlappingPixels;
+      float    m_RequiredFractionOfOverlappingPixels;
+
+      // the FFTs of the fixed image, its square and its mask padded
+      // to the padded size
+      Image                     m_FixedTransform;
+      Image                     m_FixedSquaredTransform;
+      Image                     m_FixedMaskTransform;
+      std::vector<unsigned int> m_PaddedSize;
+
+      std::vector<double>       m_PeakValues;
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,159 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkPackedBinaryImage_h
+#define sitkPackedBinaryImage_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkBasicFilters.h"
+
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class PackedBinaryImage
+     * \brief A binary image with one bit per pixel
+     *
+     * A mask of sitkUInt8 pixels takes a byte per pixel, and the
+     * binary morphology filters read and write a byte at a time. This
+     * image keeps each line of pixels along the first axis as bits of
+     * 64 bit words, so it takes an eighth of the memory, and its
+     * operations process 64 pixels at once:
+     *
+     * \code
+     * PackedBinaryImage mask( std::vector<unsigned int>( 3, 4096 ) );
+     * for ( unsigned int z = 0; z < 4096; ++z )
+     *   {
+     *   std::vector<unsigned int> index( 3, 0 );
+     *   index[2] = z;
+     *   mask.SetRegion( BinaryThreshold( ReadImage( sliceNames[z] ), 100, 255 ), index );
+     *   }
+     * mask.Opening( std::vector<unsigned int>( 3, 2 ) );
+     * \endcode
+     *
+     * Any pixel of an image converted which is not zero is
+     * foreground. ToImage and GetRegion convert back to an image of
+     * sitkUInt8 pixels, and Mask replaces the pixels of an image which
+     * are background.
+     *
+     * The morphology uses a box structuring element, and gives the
+     * results of the BinaryDilateImageFilter and the
+     * BinaryErodeImageFilter with the sitkBox kernel and their default
+     * boundary conditions: the pixels outside of the image are
+     * background for the dilation and foreground for the erosion. The
+     * box is separated in passes along each axis, each split between
+     * several threads.
+     *
+     * \sa itk::simple::BinaryDilateImageFilter
+     * \sa itk::simple::BinaryErodeImageFilter
+     * \sa itk::simple::MaskImageFilter
+     */
+    class SITKBasicFilters_EXPORT PackedBinaryImage
+    {
+    public:
+      typedef PackedBinaryImage Self;
+
+      /** An image of no pixels */
+      PackedBinaryImage();
+
+      /** An image of the size given, all background, with the default
+       * origin, spacing and direction */
+      explicit PackedBinaryImage( const std::vector<unsigned int> &size );
+
+      /** Convert an image of scalar pixels, with its geometry. The
+       * pixels which are not zero are foreground. */
+      explicit PackedBinaryImage( const Image &image );
+
+      unsigned int GetDimension( ) const { return static_cast<unsigned int>( this->m_Size.size() ); }
+      std::vector<unsigned int> GetSize( ) const { return this->m_Size; }
+      uint64_t GetNumberOfPixels( ) const;
+
+      std::vector<double> GetOrigin( ) const { return this->m_Origin; }
+      void SetOrigin( const std::vector<double> &origin );
+      std::vector<double> GetSpacing( ) const { return this->m_Spacing; }
+      void SetSpacing( const std::vector<double> &spacing );
+      std::vector<double> GetDirection( ) const { return this->m_Direction; }
+      void SetDirection( const std::vector<double> &direction );
+
+      /** Copy the origin, spacing and direction of an image */
+      void CopyInformation( const Image &image );
+
+      /** Get the number of bytes of the words of the pixels */
+      uint64_t GetSizeInBytes( ) const { return sizeof( uint64_t ) * this->m_Words.size(); }
+
+      bool GetPixel( const std::vector<uint32_t> &index ) const;
+      void SetPixel( const std::vector<uint32_t> &index, bool value );
+
+      /** Get the number of foreground pixels */
+      uint64_t GetNumberOfForegroundPixels( ) const;
+
+      /** Convert an image of scalar pixels into the region starting
+       * at the index. The pixels which are not zero are foreground.
+       * Slabs of a large image may be converted one at a time. */
+      void SetRegion( const Image &image, const std::vector<unsigned int> &index );
+
+      /** Convert a region to an image of sitkUInt8 pixels, with the
+       * foregroundValue where the pixels are foreground and 0
+       * elsewhere. */
+      Image GetRegion( const std::vector<unsigned int> &index,
+                       const std::vector<unsigned int> &size,
+                       uint8_t foregroundValue = 1 ) const;
+
+      /** Convert the whole image to an image of sitkUInt8 pixels */
+      Image ToImage( uint8_t foregroundValue = 1 ) const;
+
+      /** Copy an image of scalar pixels of the size of this one, with
+       * the outsideValue where the pixels of this one are background */
+      Image Mask( const Image &image, double outsideValue = 0.0 ) const;
+
+      /** The logical operations with an image of the same size, in place */
+      Self &And( const PackedBinaryImage &other );
+      Self &Or( const PackedBinaryImage &other );
+      Self &Xor( const PackedBinaryImage &other );
+      Self &Not( );
+
+      /** The morphology with a box of the radius along each axis, in place */
+      Self &Dilate( const std::vector<unsigned int> &radius );
+      Self &Erode( const std::vector<unsigned int> &radius );
+      Self &Opening( const std::vector<unsigned int> &radius );
+      Self &Closing( const std::vector<unsigned int> &radius );
+
+      // Print ourselves out
+      std::string ToString( ) const;
+
+    private:
+
+      void Allocate( const std::vector<unsigned int> &size );
+      void CheckSameSize( const PackedBinaryImage &other ) const;
+      void DilateAlong( unsigned int axis, unsigned int radius );
+
+      std::vector<unsigned int> m_Size;
+      std::vector<double>       m_Origin;
+      std::vector<double>       m_Spacing;
+      std::vector<double>       m_Direction;
+
+      // the lines along the first axis, each of m_WordsPerLine words,
+      // the bits after the last pixel of a line are zero
+      size_t                    m_WordsPerLine;
+      std::vector<uint64_t>     m_Words;
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,123 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkPixelwisePipeline_h
+#define sitkPixelwisePipeline_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkBasicFilters.h"
+#include "sitkProcessObject.h"
+
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class PixelwisePipeline
+     * \brief Execute a sequence of point operations in a single fused pass
+     *
+     * A chain of per-pixel operations such as Cast, ShiftScale, Clamp,
+     * BinaryThreshold and Mask normally executes one filter after
+     * another, allocating an intermediate image at each step. This
+     * object records the sequence of operations, then computes the
+     * complete chain for each pixel in one multi-threaded pass over
+     * the input, producing only the output image.
+     *
+     * \code
+     * PixelwisePipeline pipeline;
+     * pipeline.AddCast( sitkFloat32 ).AddShiftScale( -100.0, 0.5 ).AddClamp( 0.0, 255.0 )
+     *         .AddBinaryThreshold( 10.0, 200.0 ).AddMask( mask );
+     * Image output = pipeline.Execute( input );
+     * \endcode
+     *
+     * Each step is computed in double precision, then converted to
+     * the pixel type the corresponding filter would produce, so
+     * intermediate truncation matches executing the filters
+     * separately. Unlike CastImageFilter, values converted to an
+     * integer type are clamped to the range of the type. The pixel
+     * type changes with AddCast, and to sitkUInt8 with
+     * AddBinaryThreshold, otherwise the pixel type of the input is
+     * kept.
+     *
+     * Only scalar images are supported. Mask images must have the
+     * same size as the input, and may be of any scalar pixel type.
+     *
+     * As no ITK filter is executed, commands observing this object
+     * only receive the events of the ProcessObject itself.
+     */
+    class SITKBasicFilters_EXPORT PixelwisePipeline
+      : public ProcessObject {
+    public:
+      typedef PixelwisePipeline Self;
+
+      typedef BasicPixelIDTypeList PixelIDTypeList;
+
+      PixelwisePipeline();
+      ~PixelwisePipeline();
+
+      /** Convert the values to another pixel type */
+      SITK_RETURN_SELF_TYPE_HEADER AddCast ( PixelIDValueEnum pixelID );
+
+      /** Compute ( value + shift ) * scale, as ShiftScaleImageFilter */
+      SITK_RETURN_SELF_TYPE_HEADER AddShiftScale ( double shift = 0.0, double scale = 1.0 );
+
+      /** Clamp the values to [lowerBound, upperBound], as ClampImageFilter */
+      SITK_RETURN_SELF_TYPE_HEADER AddClamp ( double lowerBound, double upperBound );
+
+      /** Threshold to a sitkUInt8 binary image, as BinaryThresholdImageFilter */
+      SITK_RETURN_SELF_TYPE_HEADER AddBinaryThreshold ( double lowerThreshold = 0.0,
+                                                        double upperThreshold = 255.0,
+                                                        uint8_t insideValue = 1u,
+                                                        uint8_t outsideValue = 0u );
+
+      /** Replace values where the mask is zero, as MaskImageFilter */
+      SITK_RETURN_SELF_TYPE_HEADER AddMask ( const Image &mask, double outsideValue = 0.0 );
+
+      /** Remove all steps */
+      SITK_RETURN_SELF_TYPE_HEADER Clear ( );
+
+      /** Get the number of operations added */
+      unsigned int GetNumberOfSteps ( ) const;
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ( "PixelwisePipeline" ); }
+
+      // Print ourselves out
+      std::string ToString() const;
+
+      /** Compute all steps on the image */
+      Image Execute ( const Image &image );
+
+    private:
+
+      enum StepType { CastStep, ShiftScaleStep, ClampStep, BinaryThresholdStep, MaskStep };
+
+      struct Step
+      {
+        StepType         m_Type;
+        double           m_Parameters[4];
+        PixelIDValueEnum m_PixelID;
+        Image            m_Mask;
+      };
+
+      std::vector<Step> m_Steps;
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,145 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkProjectionAccumulator_h
+#define sitkProjectionAccumulator_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkBasicFilters.h"
+#include "sitkProcessObject.h"
+
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class ProjectionAccumulator
+     * \brief Project an image given in slabs along the projection axis
+     *
+     * The MaximumProjectionImageFilter and the other projection
+     * filters need the whole input in memory. This object receives
+     * the input in slabs, consecutive blocks of slices along the
+     * ProjectionDimension, and folds each into a running projection,
+     * so a volume or time series larger than the memory may be read
+     * and projected one slab at a time:
+     *
+     * \code
+     * ImageFileReader reader;
+     * reader.SetFileName( fileName );
+     * reader.ReadImageInformation();
+     * std::vector<unsigned int> size = reader.GetSize();
+     * std::vector<int> index( size.size(), 0 );
+     * ProjectionAccumulator mip( ProjectionAccumulator::Maximum );
+     * mip.SetProjectionDimension( size.size() - 1 );
+     * for ( unsigned int z = 0; z < size.back(); z += 16 )
+     *   {
+     *   std::vector<unsigned int> slab = size;
+     *   slab.back() = std::min( 16u, size.back() - z );
+     *   index.back() = z;
+     *   reader.SetExtractIndex( index );
+     *   reader.SetExtractSize( slab );
+     *   mip.AddSlab( reader.Execute() );
+     *   }
+     * Image projection = mip.GetResult();
+     * \endcode
+     *
+     * The Maximum and Minimum give an image of the pixel type of the
+     * input, and the Sum, Mean and StandardDeviation an image of
+     * 64 bit floats as the corresponding filters. The
+     * StandardDeviation is the unbiased one, as the
+     * StandardDeviationProjectionImageFilter. The running projection
+     * is kept in doubles, so 64 bit integers beyond 2^53 are rounded.
+     *
+     * Each slab is folded by several threads. When the output has
+     * many pixels, the threads split the output pixels, otherwise
+     * they split the slices of the slab into partial projections
+     * which are then combined.
+     *
+     * All the slabs must have the pixel type and the size of the
+     * first one, except along the ProjectionDimension. The first slab
+     * sets the origin, spacing and direction of the output, which is
+     * one pixel thick along the ProjectionDimension and centered on
+     * all the slices added.
+     *
+     * \sa itk::simple::MaximumProjectionImageFilter
+     * \sa itk::simple::MinimumProjectionImageFilter
+     * \sa itk::simple::SumProjectionImageFilter
+     * \sa itk::simple::MeanProjectionImageFilter
+     * \sa itk::simple::StandardDeviationProjectionImageFilter
+     */
+    class SITKBasicFilters_EXPORT ProjectionAccumulator
+      : public ProcessObject {
+    public:
+      typedef ProjectionAccumulator Self;
+
+      typedef BasicPixelIDTypeList PixelIDTypeList;
+
+      typedef enum { Maximum, Minimum, Sum, Mean, StandardDeviation } ProjectionType;
+
+      explicit ProjectionAccumulator( ProjectionType projection = Maximum );
+      ~ProjectionAccumulator();
+
+      /** Set the projection, which also resets the accumulated state */
+      SITK_RETURN_SELF_TYPE_HEADER SetProjection ( ProjectionType projection );
+      ProjectionType GetProjection ( ) const { return this->m_Projection; }
+
+      /** Set the axis projected, which also resets the accumulated
+       * state */
+      SITK_RETURN_SELF_TYPE_HEADER SetProjectionDimension ( unsigned int dimension );
+      unsigned int GetProjectionDimension ( ) const { return this->m_ProjectionDimension; }
+
+      /** Fold the slices of a slab into the running projection */
+      SITK_RETURN_SELF_TYPE_HEADER AddSlab ( const Image &slab );
+
+      /** Get the number of slices added since the last reset */
+      unsigned int GetNumberOfSlices ( ) const { return this->m_NumberOfSlices; }
+
+      /** Compute the projection of the slices added so far. More
+       * slabs may be added after. */
+      Image GetResult ( ) const;
+
+      /** Discard the accumulated state */
+      SITK_RETURN_SELF_TYPE_HEADER Reset ( );
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ( "ProjectionAccumulator" ); }
+
+      // Print ourselves out
+      std::string ToString() const;
+
+    private:
+
+      ProjectionType m_Projection;
+      unsigned int   m_ProjectionDimension;
+      unsigned int   m_NumberOfSlices;
+
+      // the pixel type and geometry of the first slab
+      PixelIDValueEnum          m_PixelID;
+      std::vector<unsigned int> m_Size;
+      std::vector<double>       m_Origin;
+      std::vector<double>       m_Spacing;
+      std::vector<double>       m_Direction;
+
+      // the running maximum, minimum or sum, and sum of squares
+      std::vector<double> m_Values;
+      std::vector<double> m_SquaredValues;
+    };
+
+  }
+}
+#endif
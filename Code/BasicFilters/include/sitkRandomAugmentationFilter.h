@@ -0,0 +1,190 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkRandomAugmentationFilter_h
+#define sitkRandomAugmentationFilter_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkBasicFilters.h"
+#include "sitkProcessObject.h"
+#include "sitkInterpolator.h"
+#include "sitkRandomSeed.h"
+
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class RandomAugmentationFilter
+     * \brief Draw randomly transformed patches of an image in a single
+     * resampling pass, to augment the training data of a network.
+     *
+     * Each patch is a crop of OutputSize pixels centred at a random
+     * point of the image, sampled through a random rotation and
+     * scaling about its centre and a random elastic deformation, and
+     * its values are transformed by a random scale and shift with
+     * additive Gaussian noise. Rather than executing a
+     * ResampleImageFilter per transform and a filter per intensity
+     * operation, each output pixel maps its point through the
+     * composed transforms, interpolates the input once and computes
+     * the intensity operations, so only the patch is allocated and
+     * the input is read only around the patch.
+     *
+     \code
+     RandomAugmentationFilter augment;
+     augment.SetOutputSize( std::vector<unsigned int>( 3, 64 ) );
+     augment.SetRotationRange( 0.2 ).SetScaleRange( 0.1 );
+     augment.SetElasticStandardDeviation( 2.0 ).SetNoiseStandardDeviation( 5.0 );
+     augment.SetSeed( 42 );
+     std::vector<Image> batch = augment.Execute( volume, 32 );
+     \endcode
+     *
+     * The random numbers are drawn from counter based Philox streams
+     * keyed on the Seed: the transforms of a patch from the stream of
+     * its sample number, and the noise of each pixel from a stream of
+     * the pixel in the patch. The patches are therefore the same for
+     * any number of threads, and the patch of a sample number can be
+     * drawn again with SetSampleNumber. The transforms depend only on
+     * the Seed, the sample number and the dimension, so a label image
+     * sampled with the same Seed and sample numbers, the
+     * sitkNearestNeighbor interpolator and no intensity changes, gets
+     * the same geometry as the image.
+     *
+     * The elastic deformation is a cubic B-spline of
+     * ElasticGridSize control points along each axis spanning the
+     * patch, with displacements of ElasticStandardDeviation in
+     * physical units. A point of the patch p is sampled at
+     * c + A ( p + u( p ) - c ), with c the centre of the patch, A the
+     * rotation and scaling and u the displacement.
+     *
+     * The output is a sitkFloat32 image with the spacing OutputSpacing,
+     * by default that of the input, and the direction of the input.
+     * Points outside the input have the DefaultPixelValue, without
+     * intensity changes. Only scalar images are supported.
+     *
+     * As no ITK filter is executed, commands observing this object
+     * only receive the events of the ProcessObject itself.
+     */
+    class SITKBasicFilters_EXPORT RandomAugmentationFilter
+      : public ProcessObject {
+    public:
+      typedef RandomAugmentationFilter Self;
+
+      typedef BasicPixelIDTypeList PixelIDTypeList;
+
+      RandomAugmentationFilter();
+      ~RandomAugmentationFilter();
+
+      /** The size of the patches, with an element for each dimension
+       * of the input. It must be set. */
+      SITK_RETURN_SELF_TYPE_HEADER SetOutputSize ( const std::vector<unsigned int> &size );
+      const std::vector<unsigned int> &GetOutputSize ( ) const;
+
+      /** The spacing of the patches, by default empty for the spacing
+       * of the input. */
+      SITK_RETURN_SELF_TYPE_HEADER SetOutputSpacing ( const std::vector<double> &spacing );
+      const std::vector<double> &GetOutputSpacing ( ) const;
+
+      /** The largest angle, in radians, of the rotation about each
+       * axis, by default 0. A 2D patch is rotated in its plane. */
+      SITK_RETURN_SELF_TYPE_HEADER SetRotationRange ( double range );
+      double GetRotationRange ( ) const;
+
+      /** The isotropic scale of the region sampled is drawn in
+       * [1 - ScaleRange, 1 + ScaleRange], by default 1. */
+      SITK_RETURN_SELF_TYPE_HEADER SetScaleRange ( double range );
+      double GetScaleRange ( ) const;
+
+      /** The number of control points of the elastic deformation
+       * along each axis of the patch, at least 2, by default 4. */
+      SITK_RETURN_SELF_TYPE_HEADER SetElasticGridSize ( unsigned int size );
+      unsigned int GetElasticGridSize ( ) const;
+
+      /** The standard deviation of the displacements of the control
+       * points, in physical units, by default 0 for no deformation. */
+      SITK_RETURN_SELF_TYPE_HEADER SetElasticStandardDeviation ( double sigma );
+      double GetElasticStandardDeviation ( ) const;
+
+      /** The values are scaled by a factor drawn in
+       * [1 - IntensityScaleRange, 1 + IntensityScaleRange], by default
+       * 1. */
+      SITK_RETURN_SELF_TYPE_HEADER SetIntensityScaleRange ( double range );
+      double GetIntensityScaleRange ( ) const;
+
+      /** The values are shifted by an offset drawn in
+       * [-IntensityShiftRange, IntensityShiftRange], by default 0. */
+      SITK_RETURN_SELF_TYPE_HEADER SetIntensityShiftRange ( double range );
+      double GetIntensityShiftRange ( ) const;
+
+      /** The standard deviation of the Gaussian noise added to each
+       * pixel, by default 0. */
+      SITK_RETURN_SELF_TYPE_HEADER SetNoiseStandardDeviation ( double sigma );
+      double GetNoiseStandardDeviation ( ) const;
+
+      /** sitkLinear, the default, or sitkNearestNeighbor. */
+      SITK_RETURN_SELF_TYPE_HEADER SetInterpolator ( InterpolatorEnum interpolator );
+      InterpolatorEnum GetInterpolator ( ) const;
+
+      /** The value of the points outside the input, by default 0. */
+      SITK_RETURN_SELF_TYPE_HEADER SetDefaultPixelValue ( double value );
+      double GetDefaultPixelValue ( ) const;
+
+      /** The seed of the random numbers. The default, sitkWallClock,
+       * draws a new seed from the time at each Execute. */
+      SITK_RETURN_SELF_TYPE_HEADER SetSeed ( uint32_t seed );
+      uint32_t GetSeed ( ) const;
+
+      /** The sample number of the next patch, by default 0. Each
+       * Execute increments it by the number of patches drawn. */
+      SITK_RETURN_SELF_TYPE_HEADER SetSampleNumber ( uint32_t sampleNumber );
+      uint32_t GetSampleNumber ( ) const;
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ( "RandomAugmentationFilter" ); }
+
+      // Print ourselves out
+      std::string ToString() const;
+
+      /** Draw a patch of the image */
+      Image Execute ( const Image &image );
+
+      /** Draw numberOfSamples patches of the image. The pixels of all
+       * the patches are computed by the threads together, so many
+       * small patches keep the threads busy. */
+      std::vector<Image> Execute ( const Image &image, unsigned int numberOfSamples );
+
+    private:
+
+      std::vector<unsigned int> m_OutputSize;
+      std::vector<double>       m_OutputSpacing;
+      double                    m_RotationRange;
+      double                    m_ScaleRange;
+      unsigned int              m_ElasticGridSize;
+      double                    m_ElasticStandardDeviation;
+      double                    m_IntensityScaleRange;
+      double                    m_IntensityShiftRange;
+      double                    m_NoiseStandardDeviation;
+      InterpolatorEnum          m_Interpolator;
+      double                    m_DefaultPixelValue;
+      uint32_t                  m_Seed;
+      uint32_t                  m_SampleNumber;
+    };
+
+  }
+}
+#endif
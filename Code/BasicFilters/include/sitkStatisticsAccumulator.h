@@ -0,0 +1,123 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkStatisticsAccumulator_h
+#define sitkStatisticsAccumulator_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkBasicFilters.h"
+#include "sitkProcessObject.h"
+
+namespace itk {
+  namespace simple {
+
+    /** \class StatisticsAccumulator
+     * \brief Accumulate the statistics of the pixels of images in one
+     * pass, optionally under a mask
+     *
+     * The StatisticsImageFilter computes its statistics for a whole
+     * image, and a mask needs the LabelStatisticsImageFilter. This
+     * object reads the pixels of each image added once, with several
+     * threads, and accumulates the minimum, maximum, sum, mean,
+     * variance, and the number of pixels and of non-zero pixels.
+     * Images, or chunks of a large image, may be added one after
+     * another, as from a reader with an extract region, and the
+     * statistics are those of all the pixels added:
+     *
+     * \code
+     * StatisticsAccumulator statistics;
+     * for ( size_t i = 0; i < fileNames.size(); ++i )
+     *   {
+     *   statistics.AddImage( ReadImage( fileNames[i] ), ReadImage( maskNames[i] ) );
+     *   }
+     * double mean = statistics.GetMean();
+     * double sigma = statistics.GetSigma();
+     * \endcode
+     *
+     * When a mask is given, only the pixels where the mask is not zero
+     * are accumulated. The mask must have the size of the image and
+     * integer pixels.
+     *
+     * The pixels are accumulated in blocks: the mean and the sum of
+     * squared deviations of each block are computed in two passes
+     * over the block, and combined with the running values by the
+     * parallel algorithm of Chan et al., so the variance does not
+     * lose precision for large counts or means. The sum is
+     * accumulated with a Kahan compensation.
+     *
+     * The variance and sigma are the unbiased ones, as the
+     * StatisticsImageFilter. Without any pixel, the minimum is
+     * positive infinity, the maximum negative infinity, and the mean,
+     * variance and sigma are NaN.
+     *
+     * \sa itk::simple::StatisticsImageFilter
+     * \sa itk::simple::LabelStatisticsImageFilter
+     */
+    class SITKBasicFilters_EXPORT StatisticsAccumulator
+      : public ProcessObject {
+    public:
+      typedef StatisticsAccumulator Self;
+
+      typedef BasicPixelIDTypeList PixelIDTypeList;
+
+      StatisticsAccumulator();
+      ~StatisticsAccumulator();
+
+      /** Accumulate all the pixels of an image */
+      SITK_RETURN_SELF_TYPE_HEADER AddImage ( const Image &image );
+
+      /** Accumulate the pixels of an image where the mask is not zero */
+      SITK_RETURN_SELF_TYPE_HEADER AddImage ( const Image &image, const Image &mask );
+
+      /** Discard the accumulated statistics */
+      SITK_RETURN_SELF_TYPE_HEADER Reset ( );
+
+      /** Get the number of pixels accumulated */
+      uint64_t GetCount ( ) const { return this->m_Count; }
+
+      /** Get the number of pixels accumulated which are not zero */
+      uint64_t GetNonZeroCount ( ) const { return this->m_NonZeroCount; }
+
+      double GetMinimum ( ) const { return this->m_Minimum; }
+      double GetMaximum ( ) const { return this->m_Maximum; }
+      double GetSum ( ) const { return this->m_Sum; }
+      double GetMean ( ) const;
+      double GetVariance ( ) const;
+      double GetSigma ( ) const;
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ( "StatisticsAccumulator" ); }
+
+      // Print ourselves out
+      std::string ToString() const;
+
+    private:
+
+      uint64_t m_Count;
+      uint64_t m_NonZeroCount;
+      double   m_Minimum;
+      double   m_Maximum;
+      double   m_Sum;
+      double   m_SumCompensation;
+      double   m_Mean;
+      double   m_SquaredDeviations;
+    };
+
+  }
+}
+#endif
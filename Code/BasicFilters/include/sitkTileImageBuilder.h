@@ -0,0 +1,131 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkTileImageBuilder_h
+#define sitkTileImageBuilder_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkBasicFilters.h"
+#include "sitkProcessObject.h"
+
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class TileImageBuilder
+     * \brief Paste tiles or slices one at a time into a preallocated image
+     *
+     * The JoinSeriesImageFilter and TileImageFilter take all their
+     * inputs at once and copy them into a new output, so the inputs
+     * and the output are in memory together. This object allocates
+     * the output first, then copies each tile into it as it is
+     * produced, such as by a reader or a per slice filter, so a tile
+     * may be released as soon as it is set.
+     *
+     * \code
+     * TileImageBuilder builder;
+     * builder.Allocate( ReadImage( fileNames[0] ), fileNames.size() );
+     * for ( unsigned int i = 0; i < fileNames.size(); ++i )
+     *   {
+     *   builder.SetTile( i, ReadImage( fileNames[i] ) );
+     *   }
+     * Image volume = builder.GetOutput();
+     * \endcode
+     *
+     * The tiles are placed on a grid as the TileImageFilter, the first
+     * axis varying fastest. When the Layout is empty, the default, the
+     * tiles are joined along a new axis as the JoinSeriesImageFilter,
+     * and the Spacing and Origin set the spacing and origin of the new
+     * axis. A 0 as the last element of the Layout is replaced to fit
+     * the number of tiles.
+     *
+     * All the tiles must have the size and pixel type of the image
+     * given to Allocate, which also sets the origin, spacing and
+     * direction of the output. The tiles not set are zero.
+     *
+     * SetTile may be called concurrently from several threads for
+     * different tiles.
+     *
+     * \sa itk::simple::JoinSeriesImageFilter
+     * \sa itk::simple::TileImageFilter
+     */
+    class SITKBasicFilters_EXPORT TileImageBuilder
+      : public ProcessObject {
+    public:
+      typedef TileImageBuilder Self;
+
+      typedef NonLabelPixelIDTypeList PixelIDTypeList;
+
+      TileImageBuilder();
+      ~TileImageBuilder();
+
+      /** Set the number of tiles along each axis of the output, empty
+       * to join the tiles along a new axis. */
+      SITK_RETURN_SELF_TYPE_HEADER SetLayout ( const std::vector<unsigned int> &layout ) { this->m_Layout = layout; return *this; }
+      std::vector<unsigned int> GetLayout ( ) const { return this->m_Layout; }
+
+      /** Set the spacing of the new axis when joining a series */
+      SITK_RETURN_SELF_TYPE_HEADER SetSpacing ( double spacing ) { this->m_Spacing = spacing; return *this; }
+      double GetSpacing ( ) const { return this->m_Spacing; }
+
+      /** Set the origin of the new axis when joining a series */
+      SITK_RETURN_SELF_TYPE_HEADER SetOrigin ( double origin ) { this->m_Origin = origin; return *this; }
+      double GetOrigin ( ) const { return this->m_Origin; }
+
+      /** Allocate the output for numberOfTiles tiles like tile. The
+       * pixels of tile are not copied. */
+      SITK_RETURN_SELF_TYPE_HEADER Allocate ( const Image &tile, unsigned int numberOfTiles );
+
+      /** Copy a tile into the output at its place in the layout */
+      SITK_RETURN_SELF_TYPE_HEADER SetTile ( unsigned int index, const Image &tile );
+
+      /** Get the number of tiles of the allocated output */
+      unsigned int GetNumberOfTiles ( ) const { return static_cast<unsigned int>( this->m_TileIsSet.size() ); }
+
+      /** Get if a tile has been set since the output was allocated */
+      bool IsTileSet ( unsigned int index ) const;
+
+      /** Get the output and release it from this object, which must be
+       * allocated again before setting more tiles. */
+      Image GetOutput ( );
+
+      /** Name of this class */
+      std::string GetName() const { return std::string ( "TileImageBuilder" ); }
+
+      // Print ourselves out
+      std::string ToString() const;
+
+    private:
+
+      std::vector<unsigned int> m_Layout;
+      double                    m_Spacing;
+      double                    m_Origin;
+
+      Image                      m_Output;
+      void                      *m_Buffer;
+      size_t                     m_PixelSize;
+      std::vector<unsigned int>  m_TileSize;
+      PixelIDValueEnum           m_TilePixelID;
+      std::vector<unsigned int>  m_AllocatedLayout;
+      std::vector<unsigned char> m_TileIsSet;
+    };
+
+  }
+}
+#endif
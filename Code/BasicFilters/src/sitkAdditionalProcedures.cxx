@@ -18,13 +18,28 @@
 
 #include "sitkAdditionalProcedures.h"
 #include "sitkResampleImageFilter.h"
+#include "sitkTransformToDisplacementFieldFilter.h"
+#include "sitkWarpImageFilter.h"
 #include "sitkPatchBasedDenoisingImageFilter.h"
 #include "sitkDiscreteGaussianImageFilter.h"
 #include "sitkSmoothingRecursiveGaussianImageFilter.h"
+#include "sitkHistogramImageFilter.h"
+#include "sitkIntensityWindowingImageFilter.h"
 
 namespace itk {
 namespace simple {
 
+namespace
+{
+
+bool IsRealPixelID( PixelIDValueEnum type )
+{
+  return type == sitkFloat32 || type == sitkFloat64
+    || type == sitkVectorFloat32 || type == sitkVectorFloat64;
+}
+
+}
+
 //
 // Function to run the Execute method of this filter after custom
 // setting the parameters.
@@ -76,6 +91,79 @@ SITKBasicFilters_EXPORT Image Resample ( const Image& image1,
   return filter.Execute ( image1, size, transform, interpolator, outputOrigin, outputSpacing, outputDirection, defaultPixelValue, outputPixelType );
 }
 
+std::vector<Image> ResampleImages ( const std::vector<Image> &images,
+                                    const Image& referenceImage,
+                                    Transform transform,
+                                    InterpolatorEnum interpolator,
+                                    double defaultPixelValue,
+                                    PixelIDValueEnum outputPixelType )
+{
+  return ResampleImages( images, referenceImage, transform,
+                         std::vector<InterpolatorEnum>( 1, interpolator ),
+                         defaultPixelValue, outputPixelType );
+}
+
+std::vector<Image> ResampleImages ( const std::vector<Image> &images,
+                                    const Image& referenceImage,
+                                    Transform transform,
+                                    const std::vector<InterpolatorEnum> &interpolators,
+                                    double defaultPixelValue,
+                                    PixelIDValueEnum outputPixelType )
+{
+  if ( interpolators.size() != 1 && interpolators.size() != images.size() )
+    {
+    sitkExceptionMacro( "Expected 1 or " << images.size() << " interpolators, but got "
+                        << interpolators.size() << "!" );
+    }
+
+  ResampleImageFilter resampler;
+  resampler.SetReferenceImage( referenceImage );
+  resampler.SetTransform( transform );
+  resampler.SetDefaultPixelValue( defaultPixelValue );
+  resampler.SetOutputPixelType( outputPixelType );
+
+  const bool isLinear = transform.IsLinear();
+
+  // The mapped points of the reference grid as displacements, which
+  // the WarpImageFilter reads directly since the grids are the same.
+  Image displacementField;
+  WarpImageFilter warper;
+  warper.SetOutputParameteresFromImage( referenceImage );
+  warper.SetEdgePaddingValue( defaultPixelValue );
+
+  std::vector<Image> results;
+  results.reserve( images.size() );
+  for ( size_t i = 0; i < images.size(); ++i )
+    {
+    const InterpolatorEnum interpolator = interpolators[ interpolators.size() == 1 ? 0 : i ];
+    const PixelIDValueEnum type = images[i].GetPixelID();
+
+    const bool shareMapping = !isLinear
+      && ( outputPixelType == sitkUnknown || outputPixelType == type )
+      && ( interpolator == sitkNearestNeighbor || interpolator == sitkLinear || IsRealPixelID( type ) );
+
+    if ( !shareMapping )
+      {
+      resampler.SetInterpolator( interpolator );
+      results.push_back( resampler.Execute( images[i] ) );
+      continue;
+      }
+
+    if ( displacementField.GetNumberOfPixels() == 0 )
+      {
+      TransformToDisplacementFieldFilter toDisplacementField;
+      toDisplacementField.SetReferenceImage( referenceImage );
+      toDisplacementField.SetOutputPixelType( sitkVectorFloat64 );
+      displacementField = toDisplacementField.Execute( transform );
+      }
+
+    warper.SetInterpolator( interpolator );
+    results.push_back( warper.Execute( images[i], displacementField ) );
+    }
+
+  return results;
+}
+
 SITKBasicFilters_EXPORT Image PatchBasedDenoising (const Image& image1,
                                                    double kernelBandwidthSigma,
                                                    uint32_t patchRadius,
@@ -162,6 +250,58 @@ Image SmoothingRecursiveGaussian ( const Image& image1,
   return filter.Execute(image1);
 }
 
+namespace
+{
+
+Image WindowBetweenPercentiles ( const Image& image1,
+                                 const HistogramImageFilter &histogram,
+                                 double lowerPercentile,
+                                 double upperPercentile,
+                                 double outputMinimum,
+                                 double outputMaximum )
+{
+  if ( lowerPercentile > upperPercentile )
+    {
+    sitkExceptionMacro ( "The lower percentile " << lowerPercentile
+                         << " is greater than the upper percentile " << upperPercentile << "!" );
+    }
+
+  IntensityWindowingImageFilter filter;
+  filter.SetWindowMinimum( histogram.ComputePercentile( lowerPercentile ) );
+  filter.SetWindowMaximum( histogram.ComputePercentile( upperPercentile ) );
+  filter.SetOutputMinimum( outputMinimum );
+  filter.SetOutputMaximum( outputMaximum );
+  return filter.Execute( image1 );
+}
+
+}
+
+Image PercentileWindowing ( const Image& image1,
+                            double lowerPercentile,
+                            double upperPercentile,
+                            double outputMinimum,
+                            double outputMaximum,
+                            unsigned int numberOfBins )
+{
+  HistogramImageFilter histogram;
+  histogram.SetNumberOfBins( numberOfBins );
+  histogram.Execute( image1 );
+  return WindowBetweenPercentiles( image1, histogram, lowerPercentile, upperPercentile, outputMinimum, outputMaximum );
+}
+
+Image PercentileWindowing ( const Image& image1,
+                            const Image& maskImage,
+                            double lowerPercentile,
+                            double upperPercentile,
+                            double outputMinimum,
+                            double outputMaximum,
+                            unsigned int numberOfBins )
+{
+  HistogramImageFilter histogram;
+  histogram.SetNumberOfBins( numberOfBins );
+  histogram.Execute( image1, maskImage );
+  return WindowBetweenPercentiles( image1, histogram, lowerPercentile, upperPercentile, outputMinimum, outputMaximum );
+}
 
 }
 }
@@ -0,0 +1,490 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkBilateralGrid_hxx
+#define sitkBilateralGrid_hxx
+
+#include <itkBilateralImageFilter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+#include <itkImageRegionSplitterSlowDimension.h>
+#include <itkMultiThreader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace itk {
+namespace simple {
+
+namespace
+{
+
+// A grid of one more dimension than the image, the last one the
+// intensity, with the sums of the intensities and of the weights
+// splatted into each cell.
+class BilateralGrid
+{
+public:
+  BilateralGrid( const std::vector<size_t> &size )
+    : m_Size( size ),
+      m_Stride( size.size(), 1 )
+  {
+    for ( unsigned int a = 1; a < size.size(); ++a )
+      {
+      m_Stride[a] = m_Stride[a-1] * size[a-1];
+      }
+    const size_t numberOfCells = m_Stride.back() * size.back();
+    m_Values.resize( numberOfCells, 0.0f );
+    m_Weights.resize( numberOfCells, 0.0f );
+  }
+
+  size_t GetNumberOfLines( unsigned int axis ) const
+  {
+    return m_Values.size() / m_Size[axis];
+  }
+
+  // Blur the lines [beginLine, endLine) of the grid along the axis
+  // with the kernel, the cells beyond the grid are zero.
+  void Blur( unsigned int axis, const std::vector<float> &kernel, size_t beginLine, size_t endLine )
+  {
+    const int radius = static_cast<int>( kernel.size() / 2 );
+    const int length = static_cast<int>( m_Size[axis] );
+    const size_t stride = m_Stride[axis];
+    std::vector<float> values( length );
+    std::vector<float> weights( length );
+
+    for ( size_t line = beginLine; line < endLine; ++line )
+      {
+      const size_t first = line % stride + ( line / stride ) * stride * m_Size[axis];
+      for ( int i = 0; i < length; ++i )
+        {
+        values[i] = m_Values[first + i * stride];
+        weights[i] = m_Weights[first + i * stride];
+        }
+      for ( int i = 0; i < length; ++i )
+        {
+        float value = 0.0f;
+        float weight = 0.0f;
+        for ( int k = std::max( -radius, -i ); k <= std::min( radius, length - 1 - i ); ++k )
+          {
+          value += kernel[k + radius] * values[i + k];
+          weight += kernel[k + radius] * weights[i + k];
+          }
+        m_Values[first + i * stride] = value;
+        m_Weights[first + i * stride] = weight;
+        }
+      }
+  }
+
+  std::vector<size_t> m_Size;
+  std::vector<size_t> m_Stride;
+  std::vector<float>  m_Values;
+  std::vector<float>  m_Weights;
+};
+
+
+inline std::vector<float> BilateralGridKernel( double sigma, int radius )
+{
+  std::vector<float> kernel( 2 * radius + 1 );
+  double sum = 0.0;
+  for ( int k = -radius; k <= radius; ++k )
+    {
+    sum += kernel[k + radius] = static_cast<float>( std::exp( -0.5 * k * k / ( sigma * sigma ) ) );
+    }
+  for ( size_t k = 0; k < kernel.size(); ++k )
+    {
+    kernel[k] /= static_cast<float>( sum );
+    }
+  return kernel;
+}
+
+}
+
+
+/** \brief A BilateralImageFilter with an approximation on a
+ * bilateral grid.
+ *
+ * By default the filter is the exact filter of its superclass. With
+ * UseBilateralGrid, the pixels are splatted into a grid of cells of
+ * DomainSigma / GridSamplingRate along each axis, but not smaller
+ * than a pixel, and of RangeSigma / GridSamplingRate along the
+ * intensity. The grid is blurred by the domain and range Gaussians,
+ * truncated as the ones of the superclass, and each pixel is the
+ * multilinear interpolation of the grid at its position and
+ * intensity.
+ *
+ * The cost is linear in the number of pixels and of cells, rather
+ * than in the volume of the domain kernel, so it is cheapest for the
+ * large domain sigmas the exact filter is slowest for. The splatting
+ * is split between the threads by slabs of cells of the slowest
+ * axis, the blur by lines of the grid and the interpolation by
+ * regions of the output, so the output does not depend on the number
+ * of threads. A grid of more than MaximumNumberOfCells cells is an
+ * exception. The approximation needs the whole input and computes
+ * the whole output.
+ */
+template< class TInputImage, class TOutputImage >
+class BilateralGridImageFilter
+  : public BilateralImageFilter< TInputImage, TOutputImage >
+{
+public:
+  typedef BilateralGridImageFilter                            Self;
+  typedef BilateralImageFilter< TInputImage, TOutputImage >   Superclass;
+  typedef SmartPointer< Self >                                Pointer;
+  typedef SmartPointer< const Self >                          ConstPointer;
+
+  typedef TInputImage                              InputImageType;
+  typedef TOutputImage                             OutputImageType;
+  typedef typename OutputImageType::PixelType      OutputPixelType;
+  typedef typename InputImageType::RegionType      RegionType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** The limit of the number of cells of the grid, of two floats
+   * each, 1 GiB. */
+  static const SizeValueType MaximumNumberOfCells = 134217728;
+
+  itkNewMacro( Self );
+  itkTypeMacro( BilateralGridImageFilter, BilateralImageFilter );
+
+  itkSetMacro( UseBilateralGrid, bool );
+  itkGetConstMacro( UseBilateralGrid, bool );
+
+  itkSetMacro( GridSamplingRate, double );
+  itkGetConstMacro( GridSamplingRate, double );
+
+protected:
+  BilateralGridImageFilter()
+    : m_UseBilateralGrid( false ),
+      m_GridSamplingRate( 1.0 )
+  {}
+
+  virtual void GenerateInputRequestedRegion() ITK_OVERRIDE
+  {
+    if ( !m_UseBilateralGrid )
+      {
+      Superclass::GenerateInputRequestedRegion();
+      return;
+      }
+    InputImageType *input = const_cast< InputImageType * >( this->GetInput() );
+    if ( input )
+      {
+      input->SetRequestedRegionToLargestPossibleRegion();
+      }
+  }
+
+  virtual void EnlargeOutputRequestedRegion( DataObject *output ) ITK_OVERRIDE
+  {
+    Superclass::EnlargeOutputRequestedRegion( output );
+    if ( m_UseBilateralGrid )
+      {
+      output->SetRequestedRegionToLargestPossibleRegion();
+      }
+  }
+
+  virtual void GenerateData() ITK_OVERRIDE
+  {
+    if ( !m_UseBilateralGrid )
+      {
+      Superclass::GenerateData();
+      return;
+      }
+
+    const typename Superclass::ArrayType domainSigma = this->GetDomainSigma();
+    const double rangeSigma = this->GetRangeSigma();
+    bool positive = rangeSigma > 0.0 && m_GridSamplingRate > 0.0;
+    for ( unsigned int a = 0; a < ImageDimension; ++a )
+      {
+      positive = positive && domainSigma[a] > 0.0;
+      }
+    if ( !positive )
+      {
+      itkExceptionMacro( "The sigmas and the grid sampling rate must be positive." );
+      }
+
+    this->AllocateOutputs();
+
+    ThreadStruct str;
+    str.m_Input = this->GetInput();
+    str.m_Output = this->GetOutput();
+    str.m_Region = str.m_Output->GetRequestedRegion();
+
+    const unsigned int numberOfThreads = std::max( 1u, unsigned( this->GetNumberOfThreads() ) );
+    std::vector<RegionType> splits;
+    ImageRegionSplitterSlowDimension::Pointer splitter = ImageRegionSplitterSlowDimension::New();
+    const unsigned int numberOfSplits = splitter->GetNumberOfSplits( str.m_Region, numberOfThreads );
+    splits.resize( numberOfSplits, str.m_Region );
+    for ( unsigned int i = 0; i < numberOfSplits; ++i )
+      {
+      splitter->GetSplit( i, numberOfSplits, splits[i] );
+      }
+
+    str.m_Pass = MinimumMaximumPass;
+    str.m_Regions = splits;
+    str.m_Minimums.resize( numberOfSplits );
+    str.m_Maximums.resize( numberOfSplits );
+    this->Execute( str, numberOfSplits );
+    str.m_Minimum = *std::min_element( str.m_Minimums.begin(), str.m_Minimums.end() );
+    const double maximum = *std::max_element( str.m_Maximums.begin(), str.m_Maximums.end() );
+    this->UpdateProgress( 0.1f );
+    this->CheckAbortGenerateData();
+
+    // the cell sizes in pixels and in intensity, the blur in cells and
+    // the padding for the blur and the interpolation
+    std::vector<double> kernelSigma( ImageDimension + 1 );
+    std::vector<int> radius( ImageDimension + 1 );
+    std::vector<size_t> gridSize( ImageDimension + 1 );
+    str.m_CellSize.resize( ImageDimension + 1 );
+    str.m_Padding.resize( ImageDimension + 1 );
+    double numberOfCells = 1.0;
+    for ( unsigned int a = 0; a <= ImageDimension; ++a )
+      {
+      double extent = 0.0;
+      double kernelExtent = 0.0;
+      if ( a < ImageDimension )
+        {
+        const double sigma = domainSigma[a] / str.m_Input->GetSpacing()[a];
+        str.m_CellSize[a] = std::max( 1.0, sigma / m_GridSamplingRate );
+        kernelSigma[a] = sigma / str.m_CellSize[a];
+        kernelExtent = 2.5;
+        extent = double( str.m_Region.GetSize( a ) - 1 );
+        }
+      else
+        {
+        str.m_CellSize[a] = rangeSigma / m_GridSamplingRate;
+        kernelSigma[a] = m_GridSamplingRate;
+        kernelExtent = 4.0;
+        extent = maximum - str.m_Minimum;
+        }
+      const double kernelRadius = std::max( 1.0, std::ceil( kernelExtent * kernelSigma[a] ) );
+      const double cells = std::floor( extent / str.m_CellSize[a] ) + 2.0 * kernelRadius + 4.0;
+      numberOfCells *= cells;
+      if ( !( numberOfCells <= double( MaximumNumberOfCells ) ) )
+        {
+        break;
+        }
+      radius[a] = static_cast<int>( kernelRadius );
+      str.m_Padding[a] = radius[a] + 1;
+      gridSize[a] = static_cast<size_t>( cells );
+      }
+    if ( !( numberOfCells <= double( MaximumNumberOfCells ) ) )
+      {
+      itkExceptionMacro( "The bilateral grid of at least " << numberOfCells << " cells exceeds the maximum of "
+                         << MaximumNumberOfCells << " cells, increase the DomainSigma or the RangeSigma, "
+                         << "or decrease the GridSamplingRate." );
+      }
+
+    BilateralGrid grid( gridSize );
+    str.m_Grid = &grid;
+
+    // A slab of cells of the slowest axis is splatted by one thread,
+    // from the contiguous slices of the image nearest to it.
+    const unsigned int slowAxis = ImageDimension - 1;
+    const SizeValueType numberOfSlices = str.m_Region.GetSize( slowAxis );
+    const SizeValueType numberOfSlabCells = CellIndex( double( numberOfSlices - 1 ), str.m_CellSize[slowAxis] ) + 1;
+    str.m_Regions.clear();
+    SizeValueType currentSlab = 0;
+    for ( SizeValueType i = 0; i < numberOfSlices; ++i )
+      {
+      const SizeValueType slab = CellIndex( double( i ), str.m_CellSize[slowAxis] ) * numberOfThreads / numberOfSlabCells;
+      if ( str.m_Regions.empty() || slab != currentSlab )
+        {
+        RegionType slabRegion = str.m_Region;
+        slabRegion.SetIndex( slowAxis, str.m_Region.GetIndex( slowAxis ) + static_cast<IndexValueType>( i ) );
+        slabRegion.SetSize( slowAxis, 0 );
+        str.m_Regions.push_back( slabRegion );
+        currentSlab = slab;
+        }
+      str.m_Regions.back().SetSize( slowAxis, str.m_Regions.back().GetSize( slowAxis ) + 1 );
+      }
+    str.m_Pass = SplatPass;
+    this->Execute( str, static_cast<unsigned int>( str.m_Regions.size() ) );
+    this->UpdateProgress( 0.3f );
+    this->CheckAbortGenerateData();
+
+    str.m_Pass = BlurPass;
+    for ( unsigned int a = 0; a <= ImageDimension; ++a )
+      {
+      const std::vector<float> kernel = BilateralGridKernel( kernelSigma[a], radius[a] );
+      str.m_Axis = a;
+      str.m_Kernel = &kernel;
+      this->Execute( str, numberOfThreads );
+      this->UpdateProgress( 0.3f + 0.5f * float( a + 1 ) / float( ImageDimension + 1 ) );
+      this->CheckAbortGenerateData();
+      }
+
+    str.m_Pass = SlicePass;
+    str.m_Regions = splits;
+    this->Execute( str, numberOfSplits );
+    this->UpdateProgress( 1.0f );
+  }
+
+private:
+  BilateralGridImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );           // purposely not implemented
+
+  enum PassType { MinimumMaximumPass, SplatPass, BlurPass, SlicePass };
+
+  struct ThreadStruct
+  {
+    const InputImageType      *m_Input;
+    OutputImageType           *m_Output;
+    RegionType                 m_Region;
+    std::vector<RegionType>    m_Regions;
+    PassType                   m_Pass;
+    // one of each per thread
+    std::vector<double>        m_Minimums;
+    std::vector<double>        m_Maximums;
+    double                     m_Minimum;
+    std::vector<double>        m_CellSize;
+    std::vector<size_t>        m_Padding;
+    BilateralGrid             *m_Grid;
+    unsigned int               m_Axis;
+    const std::vector<float>  *m_Kernel;
+  };
+
+  // the index of the nearest cell of the position, without the
+  // padding, as it is splatted
+  static SizeValueType CellIndex( double position, double cellSize )
+  {
+    return static_cast<SizeValueType>( position / cellSize + 0.5 );
+  }
+
+  void Execute( ThreadStruct &str, unsigned int numberOfThreads )
+  {
+    MultiThreader *threader = this->GetMultiThreader();
+    threader->SetNumberOfThreads( static_cast< ThreadIdType >( numberOfThreads ) );
+    threader->SetSingleMethod( Self::ThreaderCallback, &str );
+    threader->SingleMethodExecute();
+  }
+
+  void CheckAbortGenerateData()
+  {
+    if ( this->GetAbortGenerateData() )
+      {
+      ProcessAborted e( __FILE__, __LINE__ );
+      e.SetLocation( ITK_LOCATION );
+      e.SetDescription( "Process aborted." );
+      throw e;
+      }
+  }
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void *arg )
+  {
+    typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType *info = static_cast< ThreadInfoType * >( arg );
+    ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+    const ThreadIdType threadId = info->ThreadID;
+
+    if ( str->m_Pass == BlurPass )
+      {
+      const size_t numberOfLines = str->m_Grid->GetNumberOfLines( str->m_Axis );
+      const size_t numberOfThreads = info->NumberOfThreads;
+      str->m_Grid->Blur( str->m_Axis, *str->m_Kernel,
+                         numberOfLines * threadId / numberOfThreads,
+                         numberOfLines * ( threadId + 1 ) / numberOfThreads );
+      return ITK_THREAD_RETURN_VALUE;
+      }
+
+    if ( threadId >= str->m_Regions.size() )
+      {
+      return ITK_THREAD_RETURN_VALUE;
+      }
+    const RegionType &region = str->m_Regions[threadId];
+
+    if ( str->m_Pass == MinimumMaximumPass )
+      {
+      ImageRegionConstIterator< InputImageType > it( str->m_Input, region );
+      double minimum = static_cast<double>( it.Get() );
+      double maximum = minimum;
+      for ( ; !it.IsAtEnd(); ++it )
+        {
+        minimum = std::min( minimum, static_cast<double>( it.Get() ) );
+        maximum = std::max( maximum, static_cast<double>( it.Get() ) );
+        }
+      str->m_Minimums[threadId] = minimum;
+      str->m_Maximums[threadId] = maximum;
+      return ITK_THREAD_RETURN_VALUE;
+      }
+
+    const std::vector<double> &cellSize = str->m_CellSize;
+    const std::vector<size_t> &padding = str->m_Padding;
+    BilateralGrid &grid = *str->m_Grid;
+    ImageRegionConstIteratorWithIndex< InputImageType > pt( str->m_Input, region );
+
+    if ( str->m_Pass == SplatPass )
+      {
+      for ( ; !pt.IsAtEnd(); ++pt )
+        {
+        const double value = static_cast<double>( pt.Get() );
+        size_t cell = 0;
+        for ( unsigned int a = 0; a <= ImageDimension; ++a )
+          {
+          const double position = ( a < ImageDimension ) ? double( pt.GetIndex()[a] - str->m_Region.GetIndex( a ) ) : value - str->m_Minimum;
+          cell += ( CellIndex( position, cellSize[a] ) + padding[a] ) * grid.m_Stride[a];
+          }
+        grid.m_Values[cell] += static_cast<float>( value );
+        grid.m_Weights[cell] += 1.0f;
+        }
+      return ITK_THREAD_RETURN_VALUE;
+      }
+
+    std::vector<size_t> lower( ImageDimension + 1 );
+    std::vector<double> fraction( ImageDimension + 1 );
+    ImageRegionIterator< OutputImageType > ot( str->m_Output, region );
+    for ( ; !pt.IsAtEnd(); ++pt, ++ot )
+      {
+      const double value = static_cast<double>( pt.Get() );
+      for ( unsigned int a = 0; a <= ImageDimension; ++a )
+        {
+        const double position = ( a < ImageDimension ) ? double( pt.GetIndex()[a] - str->m_Region.GetIndex( a ) ) : value - str->m_Minimum;
+        const double coordinate = position / cellSize[a] + double( padding[a] );
+        lower[a] = static_cast<size_t>( coordinate );
+        fraction[a] = coordinate - double( lower[a] );
+        }
+
+      double sumOfValues = 0.0;
+      double sumOfWeights = 0.0;
+      for ( unsigned int corner = 0; corner < ( 1u << ( ImageDimension + 1 ) ); ++corner )
+        {
+        size_t cell = 0;
+        double weight = 1.0;
+        for ( unsigned int a = 0; a <= ImageDimension; ++a )
+          {
+          const bool upper = ( corner >> a ) & 1u;
+          cell += ( lower[a] + upper ) * grid.m_Stride[a];
+          weight *= upper ? fraction[a] : 1.0 - fraction[a];
+          }
+        sumOfValues += weight * grid.m_Values[cell];
+        sumOfWeights += weight * grid.m_Weights[cell];
+        }
+      ot.Set( static_cast<OutputPixelType>( sumOfWeights > 0.0 ? sumOfValues / sumOfWeights : value ) );
+      }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  bool    m_UseBilateralGrid;
+  double  m_GridSamplingRate;
+};
+
+} // end namespace simple
+} // end namespace itk
+
+#endif
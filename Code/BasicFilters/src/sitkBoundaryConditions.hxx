@@ -20,6 +20,8 @@
 
 #include <memory>
 #include <itkConstantBoundaryCondition.h>
+#include <itkImageAlgorithm.h>
+#include <itkImageRegionIteratorWithIndex.h>
 #include <itkPeriodicBoundaryCondition.h>
 #include <itkZeroFluxNeumannBoundaryCondition.h>
 
@@ -53,6 +55,70 @@ namespace itk {
         break;
       }
     }
+
+
+  /** \brief Pad the input of a convolution filter once by the radius
+   * of its kernel with the boundary condition.
+   *
+   * The neighbourhoods of the pixels near the border of the image,
+   * the face regions, look up each neighbour through the boundary
+   * condition, which is the most of the pixels for a kernel large for
+   * the image. The input of the filter is replaced by a copy extended
+   * by the kernel radius with the values of the boundary condition,
+   * so the VALID output region of the filter for the padded input is
+   * the region of the input, and its pixels are all computed without
+   * boundary checks. The kernel of an even size extends by one pixel
+   * less after the centre.
+   *
+   * The input must be buffered. Returns false, and leaves the input
+   * unchanged, when the output region is already VALID, as no
+   * neighbourhood is then outside the input.
+   */
+  template< class TFilter >
+  bool PadInputForKernel( TFilter *filter,
+                          const typename TFilter::KernelImageType *kernel,
+                          const ImageBoundaryCondition< typename TFilter::InputImageType > *boundaryCondition,
+                          int outputRegionMode )
+  {
+    typedef typename TFilter::InputImageType InputImageType;
+    const unsigned int Dimension = InputImageType::ImageDimension;
+
+    if ( outputRegionMode == int( TFilter::VALID ) )
+      {
+      return false;
+      }
+
+    const InputImageType *input = filter->GetInput();
+    const typename InputImageType::RegionType region = input->GetLargestPossibleRegion();
+    const typename TFilter::KernelImageType::SizeType kernelSize = kernel->GetLargestPossibleRegion().GetSize();
+
+    typename InputImageType::RegionType paddedRegion = region;
+    for ( unsigned int d = 0; d < Dimension; ++d )
+      {
+      const typename InputImageType::SizeValueType radius = kernelSize[d] / 2;
+      paddedRegion.SetIndex( d, region.GetIndex( d ) - static_cast< typename InputImageType::IndexValueType >( radius ) );
+      paddedRegion.SetSize( d, region.GetSize( d ) + 2 * radius - ( kernelSize[d] % 2 == 0 ? 1 : 0 ) );
+      }
+
+    typename InputImageType::Pointer padded = InputImageType::New();
+    padded->CopyInformation( input );
+    padded->SetRegions( paddedRegion );
+    padded->Allocate();
+
+    ImageAlgorithm::Copy( input, padded.GetPointer(), region, region );
+    ImageRegionIteratorWithIndex< InputImageType > it( padded, paddedRegion );
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      if ( !region.IsInside( it.GetIndex() ) )
+        {
+        it.Set( boundaryCondition->GetPixel( it.GetIndex(), input ) );
+        }
+      }
+
+    filter->SetInput( padded );
+    return true;
+  }
+
   }
 }
 
@@ -0,0 +1,354 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkBoundedRegionGrowing_hxx
+#define sitkBoundedRegionGrowing_hxx
+
+#include "sitkImage.h"
+#include "sitkTemplateFunctions.h"
+
+#include <itkImage.h>
+#include <itkIndex.h>
+#include <itkLabelMap.h>
+#include <itkLabelObject.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace itk {
+namespace simple {
+
+/** \brief Whether a pixel is within the thresholds, as for the
+ * ConnectedThresholdImageFilter. */
+template< class TImage >
+class ThresholdRegionGrowingPredicate
+{
+public:
+  typedef typename TImage::PixelType PixelType;
+
+  ThresholdRegionGrowingPredicate( double lower, double upper )
+    : m_Lower( static_cast<PixelType>( lower ) ),
+      m_Upper( static_cast<PixelType>( upper ) ) {}
+
+  bool operator()( const TImage *image, const typename TImage::IndexType &index ) const
+    {
+      const PixelType value = image->GetPixel( index );
+      return m_Lower <= value && value <= m_Upper;
+    }
+
+private:
+  PixelType m_Lower;
+  PixelType m_Upper;
+};
+
+
+/** \class RegionGrowingRuns
+ * \brief The runs of pixels of a region along the first axis, by
+ * line.
+ *
+ * The region is stored as the runs a scanline flood fill grows, so
+ * its memory scales with the region rather than with the image, and
+ * each pixel is tested once per neighbouring run instead of once per
+ * neighbour.
+ */
+template< unsigned int VImageDimension >
+class RegionGrowingRuns
+{
+public:
+  typedef itk::Index< VImageDimension >              IndexType;
+  typedef typename IndexType::IndexValueType         IndexValueType;
+  typedef std::map< IndexValueType, IndexValueType > LineRunsType;
+  typedef std::map< IndexType, LineRunsType, Functor::IndexLexicographicCompare< VImageDimension > > RunsType;
+
+  RegionGrowingRuns() : m_NumberOfPixels( 0 ) {}
+
+  /** The end of the run of the line containing x, or x - 1 */
+  static IndexValueType RunEnd( const LineRunsType &runs, IndexValueType x )
+    {
+      typename LineRunsType::const_iterator it = runs.upper_bound( x );
+      if ( it == runs.begin() )
+        {
+        return x - 1;
+        }
+      --it;
+      return ( x <= it->second ) ? it->second : x - 1;
+    }
+
+  /** The start of the line of the index */
+  static IndexType LineStart( IndexType index )
+    {
+      index[0] = 0;
+      return index;
+    }
+
+  RunsType m_Runs;
+  uint64_t m_NumberOfPixels;
+};
+
+
+/** \brief Grow the region connected to the seeds of the pixels of
+ * the predicate with a scanline flood fill, up to
+ * maximumNumberOfPixels pixels if not 0.
+ *
+ * The runs are grown breadth first from the seeds, so a bounded
+ * region is the part of the region nearest to the seeds in runs.
+ */
+template< class TImage, class TPredicate >
+void GrowRegionRuns( const TImage *image,
+                     const std::vector< std::vector<unsigned int> > &seeds,
+                     const TPredicate &predicate,
+                     bool fullyConnected,
+                     uint64_t maximumNumberOfPixels,
+                     RegionGrowingRuns< TImage::ImageDimension > &region )
+{
+  const unsigned int Dimension = TImage::ImageDimension;
+  typedef RegionGrowingRuns< TImage::ImageDimension > RegionType;
+  typedef typename RegionType::IndexType              IndexType;
+  typedef typename RegionType::IndexValueType         IndexValueType;
+  typedef typename RegionType::LineRunsType           LineRunsType;
+
+  const typename TImage::RegionType imageRegion = image->GetLargestPossibleRegion();
+  const IndexValueType firstX = imageRegion.GetIndex( 0 );
+  const IndexValueType lastX = firstX + static_cast<IndexValueType>( imageRegion.GetSize( 0 ) ) - 1;
+
+  // the offsets of the neighbouring lines
+  std::vector< IndexType > lineOffsets;
+  unsigned int numberOfLineOffsets = 1;
+  for ( unsigned int d = 1; d < Dimension; ++d )
+    {
+    numberOfLineOffsets *= 3;
+    }
+  for ( unsigned int n = 0; n < numberOfLineOffsets; ++n )
+    {
+    IndexType offset;
+    offset[0] = 0;
+    unsigned int numberOfNonZero = 0;
+    unsigned int code = n;
+    for ( unsigned int d = 1; d < Dimension; ++d )
+      {
+      offset[d] = static_cast<IndexValueType>( code % 3 ) - 1;
+      code /= 3;
+      numberOfNonZero += ( offset[d] != 0 );
+      }
+    if ( numberOfNonZero == 1 || ( fullyConnected && numberOfNonZero > 1 ) )
+      {
+      lineOffsets.push_back( offset );
+      }
+    }
+
+  std::deque< IndexType > queue;
+  for ( unsigned int i = 0; i < seeds.size(); ++i )
+    {
+    const IndexType seed = sitkSTLVectorToITK< IndexType >( seeds[i] );
+    if ( imageRegion.IsInside( seed ) && predicate( image, seed ) )
+      {
+      queue.push_back( seed );
+      }
+    }
+
+  while ( !queue.empty()
+          && ( maximumNumberOfPixels == 0 || region.m_NumberOfPixels < maximumNumberOfPixels ) )
+    {
+    const IndexType seed = queue.front();
+    queue.pop_front();
+
+    const IndexType line = RegionType::LineStart( seed );
+    LineRunsType &runs = region.m_Runs[line];
+    if ( RegionType::RunEnd( runs, seed[0] ) >= seed[0] )
+      {
+      continue;
+      }
+
+    // the run of the seed, not merged with the runs of the line as
+    // the runs end where the predicate is false
+    IndexType index = seed;
+    IndexValueType x0 = seed[0];
+    for ( index[0] = x0 - 1; index[0] >= firstX && predicate( image, index ); --index[0] )
+      {
+      x0 = index[0];
+      }
+    IndexValueType x1 = seed[0];
+    for ( index[0] = x1 + 1; index[0] <= lastX && predicate( image, index ); ++index[0] )
+      {
+      x1 = index[0];
+      }
+    if ( maximumNumberOfPixels != 0 )
+      {
+      const IndexValueType remaining = static_cast<IndexValueType>( maximumNumberOfPixels - region.m_NumberOfPixels );
+      x1 = std::min( x1, seed[0] + remaining - 1 );
+      x0 = std::max( x0, x1 - remaining + 1 );
+      }
+    runs[x0] = x1;
+    region.m_NumberOfPixels += static_cast<uint64_t>( x1 - x0 + 1 );
+
+    // a seed for each segment of the pixels of the predicate along the
+    // run in the neighbouring lines, not already in a run
+    for ( unsigned int o = 0; o < lineOffsets.size(); ++o )
+      {
+      IndexType neighbor = line;
+      bool inside = true;
+      for ( unsigned int d = 1; d < Dimension; ++d )
+        {
+        neighbor[d] += lineOffsets[o][d];
+        inside = inside && neighbor[d] >= imageRegion.GetIndex( d )
+          && neighbor[d] < imageRegion.GetIndex( d ) + static_cast<IndexValueType>( imageRegion.GetSize( d ) );
+        }
+      if ( !inside )
+        {
+        continue;
+        }
+
+      const typename RegionType::RunsType::const_iterator neighborRuns = region.m_Runs.find( neighbor );
+      const IndexValueType start = fullyConnected ? std::max( firstX, x0 - 1 ) : x0;
+      const IndexValueType end = fullyConnected ? std::min( lastX, x1 + 1 ) : x1;
+      for ( neighbor[0] = start; neighbor[0] <= end; ++neighbor[0] )
+        {
+        if ( neighborRuns != region.m_Runs.end() )
+          {
+          const IndexValueType runEnd = RegionType::RunEnd( neighborRuns->second, neighbor[0] );
+          if ( runEnd >= neighbor[0] )
+            {
+            neighbor[0] = runEnd;
+            continue;
+            }
+          }
+        if ( predicate( image, neighbor ) )
+          {
+          queue.push_back( neighbor );
+          // skip the rest of the segment
+          while ( neighbor[0] + 1 <= end )
+            {
+            ++neighbor[0];
+            if ( !predicate( image, neighbor ) )
+              {
+              break;
+              }
+            }
+          }
+        }
+      }
+    }
+}
+
+
+/** \brief The region grown as an image of the size of the input, an
+ * image cropped to the bounding box of the region, or a label map.
+ *
+ * The cropped image has the physical space of the bounding box; for
+ * an empty region it has a single pixel of 0 at the start of the
+ * input. The label map has a single label object of the value,
+ * stored by runs, and its pixels type is sitkLabelUInt8.
+ */
+template< class TOutputImage, class TInputImage >
+Image RegionGrowingRunsToImage( const TInputImage *image,
+                                const RegionGrowingRuns< TInputImage::ImageDimension > &region,
+                                typename TOutputImage::PixelType value,
+                                int outputMode )
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  typedef RegionGrowingRuns< TInputImage::ImageDimension > RegionType;
+  typedef typename RegionType::IndexType                   IndexType;
+  typedef typename RegionType::IndexValueType              IndexValueType;
+
+  if ( outputMode == 2 )
+    {
+    typedef itk::LabelObject< typename TOutputImage::PixelType, TInputImage::ImageDimension > LabelObjectType;
+    typedef itk::LabelMap< LabelObjectType >                                                 LabelMapType;
+
+    typename LabelMapType::Pointer labelMap = LabelMapType::New();
+    labelMap->CopyInformation( image );
+    labelMap->SetRegions( image->GetLargestPossibleRegion() );
+    labelMap->Allocate();
+    if ( region.m_NumberOfPixels != 0 )
+      {
+      typename LabelObjectType::Pointer labelObject = LabelObjectType::New();
+      labelObject->SetLabel( value );
+      for ( typename RegionType::RunsType::const_iterator line = region.m_Runs.begin(); line != region.m_Runs.end(); ++line )
+        {
+        for ( typename RegionType::LineRunsType::const_iterator run = line->second.begin(); run != line->second.end(); ++run )
+          {
+          IndexType index = line->first;
+          index[0] = run->first;
+          labelObject->AddLine( index, static_cast< typename LabelObjectType::LengthType >( run->second - run->first + 1 ) );
+          }
+        }
+      labelMap->AddLabelObject( labelObject );
+      }
+    return Image( labelMap );
+    }
+
+  typename TOutputImage::RegionType outputRegion = image->GetLargestPossibleRegion();
+  if ( outputMode == 1 )
+    {
+    IndexType lower = outputRegion.GetIndex();
+    IndexType upper = outputRegion.GetIndex();
+    bool found = false;
+    for ( typename RegionType::RunsType::const_iterator line = region.m_Runs.begin(); line != region.m_Runs.end(); ++line )
+      {
+      for ( typename RegionType::LineRunsType::const_iterator run = line->second.begin(); run != line->second.end(); ++run )
+        {
+        IndexType first = line->first;
+        first[0] = run->first;
+        IndexType last = line->first;
+        last[0] = run->second;
+        for ( unsigned int d = 0; d < Dimension; ++d )
+          {
+          lower[d] = found ? std::min( lower[d], first[d] ) : first[d];
+          upper[d] = found ? std::max( upper[d], last[d] ) : last[d];
+          }
+        found = true;
+        }
+      }
+    for ( unsigned int d = 0; d < Dimension; ++d )
+      {
+      outputRegion.SetIndex( d, lower[d] );
+      outputRegion.SetSize( d, static_cast< typename TOutputImage::SizeValueType >( upper[d] - lower[d] + 1 ) );
+      }
+    }
+
+  typename TOutputImage::Pointer output = TOutputImage::New();
+  output->CopyInformation( image );
+  output->SetRegions( outputRegion );
+  output->Allocate();
+  output->FillBuffer( 0 );
+  for ( typename RegionType::RunsType::const_iterator line = region.m_Runs.begin(); line != region.m_Runs.end(); ++line )
+    {
+    for ( typename RegionType::LineRunsType::const_iterator run = line->second.begin(); run != line->second.end(); ++run )
+      {
+      IndexType index = line->first;
+      index[0] = run->first;
+      std::fill_n( &output->GetPixel( index ), run->second - run->first + 1, value );
+      }
+    }
+
+  // the origin of the cropped image is the start of the bounding box
+  typename TOutputImage::PointType origin;
+  output->TransformIndexToPhysicalPoint( outputRegion.GetIndex(), origin );
+  output->SetOrigin( origin );
+  IndexType zeroIndex;
+  zeroIndex.Fill( 0 );
+  outputRegion.SetIndex( zeroIndex );
+  output->SetRegions( outputRegion );
+  return Image( output );
+}
+
+} // end namespace simple
+} // end namespace itk
+
+#endif
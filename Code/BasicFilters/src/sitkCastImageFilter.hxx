@@ -20,6 +20,7 @@
 
 // include itk first to suppress std::copy conversion warning
 #include <itkCastImageFilter.h>
+#include "itkContiguousCastImageFilter.h"
 
 #include "sitkCastImageFilter.h"
 
@@ -45,7 +46,9 @@ CastImageFilter::ExecuteInternalCast( const Image& inImage )
 
   typename InputImageType::ConstPointer image = this->CastImageToITK<InputImageType>( inImage );
 
-  typedef itk::CastImageFilter<InputImageType, OutputImageType> FilterType;
+  // the scalar components are converted by a vectorized loop over
+  // the buffers
+  typedef itk::ContiguousCastImageFilter<InputImageType, OutputImageType> FilterType;
   typename FilterType::Pointer filter = FilterType::New();
 
   filter->SetInput ( image );
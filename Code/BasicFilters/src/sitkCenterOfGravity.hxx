@@ -0,0 +1,178 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkCenterOfGravity_hxx
+#define sitkCenterOfGravity_hxx
+
+#include "sitkMacro.h"
+
+#include <itkContinuousIndex.h>
+#include <itkImageRegionConstIteratorWithOnlyIndex.h>
+#include <itkImageRegionSplitterSlowDimension.h>
+#include <itkMultiThreader.h>
+#include <itkShrinkImageFilter.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace itk {
+namespace simple {
+namespace {
+
+template <class TImageType>
+struct CenterOfGravityThreadStruct
+{
+  typedef typename TImageType::RegionType RegionType;
+
+  const TImageType        *m_Image;
+  unsigned int             m_ShrinkFactor;
+  std::vector<RegionType>  m_Regions;
+  // one of each per thread
+  std::vector<double>                m_Masses;
+  std::vector< std::vector<double> > m_Moments;
+};
+
+template <class TImageType>
+ITK_THREAD_RETURN_TYPE CenterOfGravityThreaderCallback( void *arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType *info = static_cast< ThreadInfoType * >( arg );
+  CenterOfGravityThreadStruct<TImageType> *str = static_cast< CenterOfGravityThreadStruct<TImageType> * >( info->UserData );
+  const unsigned int Dimension = TImageType::ImageDimension;
+
+  const TImageType *image = str->m_Image;
+  const typename TImageType::IndexType start = image->GetBufferedRegion().GetIndex();
+  double mass = 0.0;
+  double *moment = &str->m_Moments[info->ThreadID][0];
+
+  // the region is of the sampled grid, each of its indexes is of the
+  // pixel at the shrink factor times its offset from the start
+  ImageRegionConstIteratorWithOnlyIndex<TImageType> it( image, str->m_Regions[info->ThreadID] );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    typename TImageType::IndexType index = it.GetIndex();
+    for ( unsigned int d = 0; d < Dimension; ++d )
+      {
+      index[d] = start[d] + ( index[d] - start[d] ) * str->m_ShrinkFactor;
+      }
+    const double value = static_cast<double>( image->GetPixel( index ) );
+    mass += value;
+    for ( unsigned int d = 0; d < Dimension; ++d )
+      {
+      moment[d] += value * index[d];
+      }
+    }
+  str->m_Masses[info->ThreadID] = mass;
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/** Compute the center of gravity of the intensities of an image, as
+ * the itk::ImageMomentsCalculator, in parallel on the pixels of every
+ * shrinkFactor pixel in each dimension. The moments are accumulated
+ * in index space, and the center is mapped to a physical point. */
+template <class TImageType>
+typename TImageType::PointType ComputeCenterOfGravity( const TImageType *image,
+                                                       unsigned int shrinkFactor,
+                                                       unsigned int numberOfThreads )
+{
+  typedef typename TImageType::RegionType RegionType;
+  const unsigned int Dimension = TImageType::ImageDimension;
+
+  shrinkFactor = std::max( shrinkFactor, 1u );
+  RegionType region = image->GetBufferedRegion();
+  for ( unsigned int d = 0; d < Dimension; ++d )
+    {
+    region.SetSize( d, ( region.GetSize( d ) + shrinkFactor - 1 ) / shrinkFactor );
+    }
+
+  CenterOfGravityThreadStruct<TImageType> str;
+  str.m_Image = image;
+  str.m_ShrinkFactor = shrinkFactor;
+
+  ImageRegionSplitterSlowDimension::Pointer splitter = ImageRegionSplitterSlowDimension::New();
+  const unsigned int numberOfSplits = splitter->GetNumberOfSplits( region, std::max( 1u, numberOfThreads ) );
+  str.m_Regions.resize( numberOfSplits, region );
+  for ( unsigned int i = 0; i < numberOfSplits; ++i )
+    {
+    splitter->GetSplit( i, numberOfSplits, str.m_Regions[i] );
+    }
+  str.m_Masses.assign( numberOfSplits, 0.0 );
+  str.m_Moments.assign( numberOfSplits, std::vector<double>( Dimension, 0.0 ) );
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( static_cast< ThreadIdType >( numberOfSplits ) );
+  threader->SetSingleMethod( CenterOfGravityThreaderCallback<TImageType>, &str );
+  threader->SingleMethodExecute();
+
+  double mass = 0.0;
+  ContinuousIndex<double, Dimension> center;
+  center.Fill( 0.0 );
+  for ( unsigned int t = 0; t < numberOfSplits; ++t )
+    {
+    mass += str.m_Masses[t];
+    for ( unsigned int d = 0; d < Dimension; ++d )
+      {
+      center[d] += str.m_Moments[t][d];
+      }
+    }
+  if ( mass == 0.0 )
+    {
+    sitkExceptionMacro( "The total mass of the image is zero!" );
+    }
+  for ( unsigned int d = 0; d < Dimension; ++d )
+    {
+    center[d] /= mass;
+    }
+
+  typename TImageType::PointType point;
+  image->TransformContinuousIndexToPhysicalPoint( center, point );
+  return point;
+}
+
+/** Shrink an image by a factor in each dimension, not larger than the
+ * size of the dimension. The image is returned for a factor of 1. */
+template <class TImageType>
+typename TImageType::ConstPointer ShrinkImageForMoments( const TImageType *image,
+                                                         unsigned int shrinkFactor,
+                                                         unsigned int numberOfThreads )
+{
+  if ( shrinkFactor <= 1 )
+    {
+    return image;
+    }
+
+  typedef ShrinkImageFilter<TImageType, TImageType> ShrinkFilterType;
+  typename ShrinkFilterType::Pointer shrinker = ShrinkFilterType::New();
+  for ( unsigned int d = 0; d < TImageType::ImageDimension; ++d )
+    {
+    const unsigned int size = static_cast<unsigned int>( image->GetLargestPossibleRegion().GetSize( d ) );
+    shrinker->SetShrinkFactor( d, std::max( 1u, std::min( shrinkFactor, size ) ) );
+    }
+  shrinker->SetNumberOfThreads( std::max( 1u, numberOfThreads ) );
+  shrinker->SetInput( image );
+  shrinker->Update();
+  typename TImageType::Pointer shrunken = shrinker->GetOutput();
+  shrunken->DisconnectPipeline();
+  return shrunken.GetPointer();
+}
+
+}
+}
+}
+
+#endif
@@ -30,6 +30,7 @@
 
 // Additional include files
 #include "sitkTransform.h"
+#include "sitkCenterOfGravity.hxx"
 // Done with additional include files
 
 namespace itk {
@@ -45,6 +46,8 @@ CenteredTransformInitializerFilter::CenteredTransformInitializerFilter ()
 
     this->m_OperationMode = itk::simple::CenteredTransformInitializerFilter::MOMENTS;
 
+    this->m_ShrinkFactor = 1u;
+
   this->m_MemberFactory.reset( new detail::MemberFunctionFactory<MemberFunctionType>( this ) );
 
   this->m_MemberFactory->RegisterMemberFunctions< PixelIDTypeList, 3 > ();
@@ -70,6 +73,9 @@ std::string CenteredTransformInitializerFilter::ToString() const
   out << "  OperationMode: ";
   this->ToStringHelper(out, this->m_OperationMode);
   out << std::endl;
+  out << "  ShrinkFactor: ";
+  this->ToStringHelper(out, this->m_ShrinkFactor);
+  out << std::endl;
 
   out << ProcessObject::ToString();
   return out.str();
@@ -130,7 +136,8 @@ Transform CenteredTransformInitializerFilter::ExecuteInternal ( const Image * in
 
 
   assert( inFixedImage != NULL );
-  filter->SetFixedImage( this->CastImageToITK<typename FilterType::FixedImageType>(*inFixedImage) );
+  typename FilterType::FixedImageType::ConstPointer image1 = this->CastImageToITK<typename FilterType::FixedImageType>( *inFixedImage );
+  filter->SetFixedImage( image1 );
   assert( inMovingImage != NULL );
   typename FilterType::MovingImageType::ConstPointer image2 = this->CastImageToITK<typename FilterType::MovingImageType>( *inMovingImage );
   filter->SetMovingImage( image2 );
@@ -152,15 +159,30 @@ Transform CenteredTransformInitializerFilter::ExecuteInternal ( const Image * in
 
   if (m_OperationMode == MOMENTS)
     {
-    filter->MomentsOn();
+    // The centers of mass are computed in parallel on the sampled
+    // pixels, and set as the itk::CenteredTransformInitializer does.
+    const typename TImageType::PointType fixedCenter =
+      ComputeCenterOfGravity( image1.GetPointer(), this->m_ShrinkFactor, this->GetNumberOfThreads() );
+    const typename TImageType::PointType movingCenter =
+      ComputeCenterOfGravity( image2.GetPointer(), this->m_ShrinkFactor, this->GetNumberOfThreads() );
+
+    typename TransformType::InputPointType rotationCenter;
+    typename TransformType::OutputVectorType translationVector;
+    for ( unsigned int i = 0; i < TImageType::ImageDimension; ++i )
+      {
+      rotationCenter[i] = fixedCenter[i];
+      translationVector[i] = movingCenter[i] - fixedCenter[i];
+      }
+    TransformType *transform = const_cast<TransformType*>(itkTx);
+    transform->SetCenter( rotationCenter );
+    transform->SetTranslation( translationVector );
     }
   else
     {
     filter->GeometryOn();
+    filter->InitializeTransform();
     }
 
-  filter->InitializeTransform();
-
   return copyTransform;
 }
 
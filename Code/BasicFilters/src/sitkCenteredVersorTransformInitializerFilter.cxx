@@ -31,6 +31,7 @@
 
 // Additional include files
 #include "sitkTransform.h"
+#include "sitkCenterOfGravity.hxx"
 // Done with additional include files
 
 namespace itk {
@@ -46,6 +47,8 @@ CenteredVersorTransformInitializerFilter::CenteredVersorTransformInitializerFilt
 
   this->m_ComputeRotation = false;
 
+  this->m_ShrinkFactor = 1u;
+
   this->m_MemberFactory.reset( new detail::MemberFunctionFactory<MemberFunctionType>( this ) );
 
   this->m_MemberFactory->RegisterMemberFunctions< PixelIDTypeList, 3 > ();
@@ -71,6 +74,9 @@ std::string CenteredVersorTransformInitializerFilter::ToString() const
   out << "  ComputeRotation: ";
   this->ToStringHelper(out, this->m_ComputeRotation);
   out << std::endl;
+  out << "  ShrinkFactor: ";
+  this->ToStringHelper(out, this->m_ShrinkFactor);
+  out << std::endl;
 
   out << ProcessObject::ToString();
   return out.str();
@@ -126,10 +132,9 @@ Transform CenteredVersorTransformInitializerFilter::ExecuteInternal ( const Imag
 
 
   assert( inFixedImage != NULL );
-  filter->SetFixedImage( this->CastImageToITK<typename FilterType::FixedImageType>(*inFixedImage) );
+  typename FilterType::FixedImageType::ConstPointer image1 = this->CastImageToITK<typename FilterType::FixedImageType>( *inFixedImage );
   assert( inMovingImage != NULL );
   typename FilterType::MovingImageType::ConstPointer image2 = this->CastImageToITK<typename FilterType::MovingImageType>( *inMovingImage );
-  filter->SetMovingImage( image2 );
   assert( inTransform != NULL );
 
   // This initializers modifies the input, we copy the transform to
@@ -145,9 +150,36 @@ Transform CenteredVersorTransformInitializerFilter::ExecuteInternal ( const Imag
   else { filter->SetTransform( const_cast<typename FilterType::TransformType*>(itkTx) ); }
 
 
-  filter->SetComputeRotation ( this->m_ComputeRotation );
-
-  filter->InitializeTransform();
+  if ( this->m_ComputeRotation )
+    {
+    // the principal axes are computed by the ITK filter, on the
+    // shrunken images
+    filter->SetFixedImage( ShrinkImageForMoments( image1.GetPointer(), this->m_ShrinkFactor, this->GetNumberOfThreads() ) );
+    filter->SetMovingImage( ShrinkImageForMoments( image2.GetPointer(), this->m_ShrinkFactor, this->GetNumberOfThreads() ) );
+    filter->SetComputeRotation ( true );
+    filter->InitializeTransform();
+    }
+  else
+    {
+    // The centers of mass are computed in parallel on the sampled
+    // pixels, and set as the itk::CenteredVersorTransformInitializer
+    // does without rotation.
+    const typename TImageType::PointType fixedCenter =
+      ComputeCenterOfGravity( image1.GetPointer(), this->m_ShrinkFactor, this->GetNumberOfThreads() );
+    const typename TImageType::PointType movingCenter =
+      ComputeCenterOfGravity( image2.GetPointer(), this->m_ShrinkFactor, this->GetNumberOfThreads() );
+
+    typename FilterType::TransformType::InputPointType rotationCenter;
+    typename FilterType::TransformType::OutputVectorType translationVector;
+    for ( unsigned int i = 0; i < TImageType::ImageDimension; ++i )
+      {
+      rotationCenter[i] = fixedCenter[i];
+      translationVector[i] = movingCenter[i] - fixedCenter[i];
+      }
+    typename FilterType::TransformType *transform = const_cast<typename FilterType::TransformType*>(itkTx);
+    transform->SetCenter( rotationCenter );
+    transform->SetTranslation( translationVector );
+    }
 
   return copyTransform;
 }
@@ -0,0 +1,92 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkCompactLabelImage_hxx
+#define sitkCompactLabelImage_hxx
+
+#include "sitkImage.h"
+
+#include <itkCastImageFilter.h>
+#include <itkImage.h>
+#include <itkNumericTraits.h>
+
+#include <algorithm>
+
+namespace itk {
+namespace simple {
+
+namespace
+{
+
+template< class TCompactImage, class TLabelImage >
+Image CastLabelImage( TLabelImage *labels, unsigned int numberOfThreads )
+{
+  typedef itk::CastImageFilter< TLabelImage, TCompactImage > CastFilterType;
+  typename CastFilterType::Pointer caster = CastFilterType::New();
+  caster->SetInput( labels );
+  caster->SetNumberOfThreads( numberOfThreads );
+  caster->Update();
+
+  typename TCompactImage::Pointer compactImage = caster->GetOutput();
+  compactImage->DisconnectPipeline();
+  return Image( compactImage );
+}
+
+}
+
+/** \brief Return a label image in the smallest unsigned integer pixel
+ * type holding its largest label: uint8, uint16 or the pixel type of
+ * the labels.
+ *
+ * The labels are cast from a copy of the image which shares its
+ * buffer, so the pipeline of the label image is not updated.
+ */
+template< class TLabelImage >
+Image CompactLabelImage( TLabelImage *labelImage, unsigned int numberOfThreads )
+{
+  typedef typename TLabelImage::PixelType LabelType;
+  typedef itk::Image< uint8_t, TLabelImage::ImageDimension >  UInt8ImageType;
+  typedef itk::Image< uint16_t, TLabelImage::ImageDimension > UInt16ImageType;
+
+  typename TLabelImage::Pointer labels = TLabelImage::New();
+  labels->Graft( labelImage );
+
+  const LabelType *buffer = labels->GetBufferPointer();
+  const size_t numberOfPixels = labels->GetPixelContainer()->Size();
+  LabelType minimum = itk::NumericTraits< LabelType >::ZeroValue();
+  LabelType maximum = itk::NumericTraits< LabelType >::ZeroValue();
+  for ( size_t i = 0; i < numberOfPixels; ++i )
+    {
+    minimum = std::min( minimum, buffer[i] );
+    maximum = std::max( maximum, buffer[i] );
+    }
+
+  if ( double( minimum ) >= 0.0 && double( maximum ) <= double( itk::NumericTraits< uint8_t >::max() ) )
+    {
+    return CastLabelImage< UInt8ImageType >( labels.GetPointer(), numberOfThreads );
+    }
+  if ( double( minimum ) >= 0.0 && double( maximum ) <= double( itk::NumericTraits< uint16_t >::max() ) )
+    {
+    return CastLabelImage< UInt16ImageType >( labels.GetPointer(), numberOfThreads );
+    }
+  return Image( labelImage );
+}
+
+} // end namespace simple
+} // end namespace itk
+
+#endif
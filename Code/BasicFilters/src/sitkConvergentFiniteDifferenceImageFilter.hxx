@@ -0,0 +1,107 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkConvergentFiniteDifferenceImageFilter_hxx
+#define sitkConvergentFiniteDifferenceImageFilter_hxx
+
+#include <itkImageRegionConstIterator.h>
+#include <itkNumericTraits.h>
+
+#include <cmath>
+
+namespace itk {
+namespace simple {
+
+/** \brief A dense finite difference filter which stops iterating
+ * when the image converges.
+ *
+ * The dense finite difference filters do not measure the change of
+ * the solution, so their MaximumRMSError has no effect. This filter
+ * measures the root mean square of the update applied by each
+ * iteration, the time step times the update buffer, and halts before
+ * NumberOfIterations when it is less than the ConvergenceTolerance. A
+ * tolerance of 0, the default, runs all the iterations.
+ */
+template< class TFilter >
+class ConvergentFiniteDifferenceImageFilter
+  : public TFilter
+{
+public:
+  typedef ConvergentFiniteDifferenceImageFilter Self;
+  typedef TFilter                               Superclass;
+  typedef SmartPointer< Self >                  Pointer;
+  typedef SmartPointer< const Self >            ConstPointer;
+
+  typedef typename Superclass::TimeStepType     TimeStepType;
+  typedef typename Superclass::UpdateBufferType UpdateBufferType;
+
+  itkNewMacro( Self );
+  itkTypeMacro( ConvergentFiniteDifferenceImageFilter, TFilter );
+
+  itkSetMacro( ConvergenceTolerance, double );
+  itkGetConstMacro( ConvergenceTolerance, double );
+
+  /** The root mean square of the update of the last iteration. */
+  itkGetConstMacro( UpdateRMS, double );
+
+protected:
+  ConvergentFiniteDifferenceImageFilter()
+    : m_ConvergenceTolerance( 0.0 ),
+      m_UpdateRMS( NumericTraits< double >::max() )
+  {}
+
+  virtual void ApplyUpdate( const TimeStepType & dt ) ITK_OVERRIDE
+  {
+    if ( m_ConvergenceTolerance > 0.0 )
+      {
+      const UpdateBufferType *update = this->GetUpdateBuffer();
+      double sumOfSquares = 0.0;
+      ImageRegionConstIterator< UpdateBufferType > it( update, update->GetBufferedRegion() );
+      for ( ; !it.IsAtEnd(); ++it )
+        {
+        const double value = static_cast< double >( it.Get() );
+        sumOfSquares += value * value;
+        }
+      const double numberOfPixels = static_cast< double >( update->GetBufferedRegion().GetNumberOfPixels() );
+      m_UpdateRMS = ( numberOfPixels > 0.0 ) ? std::fabs( double( dt ) ) * std::sqrt( sumOfSquares / numberOfPixels ) : 0.0;
+      }
+    Superclass::ApplyUpdate( dt );
+  }
+
+  virtual bool Halt() ITK_OVERRIDE
+  {
+    if ( Superclass::Halt() )
+      {
+      return true;
+      }
+    return m_ConvergenceTolerance > 0.0
+      && this->GetElapsedIterations() > 0
+      && m_UpdateRMS < m_ConvergenceTolerance;
+  }
+
+private:
+  ConvergentFiniteDifferenceImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                        // purposely not implemented
+
+  double m_ConvergenceTolerance;
+  double m_UpdateRMS;
+};
+
+} // end namespace simple
+} // end namespace itk
+
+#endif
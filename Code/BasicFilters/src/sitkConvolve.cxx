@@ -0,0 +1,326 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "sitkConvolve.h"
+#include "sitkFFTConvolutionImageFilter.h"
+#include "sitkCastImageFilter.h"
+#include "sitkSeparableKernel.hxx"
+
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+namespace itk {
+namespace simple {
+
+namespace
+{
+
+// The cost constants of the convolution methods, in seconds.
+struct ConvolutionCosts
+{
+  // per output pixel and kernel pixel of a spatial convolution
+  double m_KernelPixel;
+  // per output pixel of each pass of a convolution
+  double m_Pass;
+  // per padded pixel and log2 of the padded size of a FFT convolution
+  double m_FFTPixel;
+};
+
+// default constants, in the range of a recent multi-core computer
+ConvolutionCosts convolutionCosts = { 1e-10, 1e-9, 2e-9 };
+
+
+bool IsRealPixelID( PixelIDValueEnum type )
+{
+  return type == sitkFloat32 || type == sitkFloat64;
+}
+
+
+// Decompose the kernel into the 1-D kernels along each axis whose
+// outer product is the kernel.
+bool ComputeSeparableKernels( const Image &kernelImage, std::vector<Image> &kernels )
+{
+  kernels.clear();
+
+  const Image kernel = Cast( kernelImage, sitkFloat64 );
+  const std::vector<unsigned int> size = kernel.GetSize();
+  const unsigned int dimension = kernel.GetDimension();
+
+  std::vector< std::vector<double> > lines;
+  if ( !DecomposeSeparableKernel( kernel.GetBufferAsDouble(), size, lines ) )
+    {
+    return false;
+    }
+
+  for ( unsigned int d = 0; d < dimension; ++d )
+    {
+    std::vector<unsigned int> lineSize( dimension, 1u );
+    lineSize[d] = size[d];
+    Image line( lineSize, sitkFloat64 );
+    std::copy( lines[d].begin(), lines[d].end(), line.GetBufferAsDouble() );
+    kernels.push_back( line );
+    }
+  return true;
+}
+
+
+// The estimated cost of each convolution method. The separable cost
+// is infinite when the kernel is not separable.
+void EstimateConvolutionCosts( const Image &image,
+                               const Image &kernelImage,
+                               bool separable,
+                               double &spatialCost,
+                               double &separableCost,
+                               double &fftCost )
+{
+  const std::vector<unsigned int> size = image.GetSize();
+  const std::vector<unsigned int> kernelSize = kernelImage.GetSize();
+
+  double numberOfPixels = 1.0;
+  double numberOfKernelPixels = 1.0;
+  double sumOfKernelSizes = 0.0;
+  double numberOfPaddedPixels = 1.0;
+  for ( unsigned int d = 0; d < size.size(); ++d )
+    {
+    numberOfPixels *= size[d];
+    numberOfKernelPixels *= kernelSize[d];
+    sumOfKernelSizes += kernelSize[d];
+    numberOfPaddedPixels *= size[d] + kernelSize[d];
+    }
+
+  spatialCost = numberOfPixels * ( convolutionCosts.m_KernelPixel * numberOfKernelPixels + convolutionCosts.m_Pass );
+
+  separableCost = std::numeric_limits<double>::infinity();
+  if ( separable )
+    {
+    separableCost = numberOfPixels * ( convolutionCosts.m_KernelPixel * sumOfKernelSizes
+                                       + convolutionCosts.m_Pass * size.size() );
+    }
+
+  // the forward FFT of the image and kernel, and the inverse FFT
+  fftCost = 3.0 * convolutionCosts.m_FFTPixel * numberOfPaddedPixels * std::log( numberOfPaddedPixels ) / std::log( 2.0 );
+}
+
+
+ConvolutionModeEnum SelectConvolutionMode( const Image &image,
+                                           const Image &kernelImage,
+                                           std::vector<Image> &separableKernels )
+{
+  const bool separable = ComputeSeparableKernels( kernelImage, separableKernels );
+
+  double spatialCost, separableCost, fftCost;
+  EstimateConvolutionCosts( image, kernelImage, separable, spatialCost, separableCost, fftCost );
+
+  if ( separableCost <= spatialCost && separableCost <= fftCost )
+    {
+    return sitkConvolutionSeparable;
+    }
+  return ( fftCost < spatialCost ) ? sitkConvolutionFFT : sitkConvolutionSpatial;
+}
+
+
+// Whether most of the pixels are within the kernel radius of the
+// border, in the face regions whose neighbours are each checked
+// against the boundary, so padding the image once costs less.
+bool IsMostlyFaceRegions( const Image &image, const Image &kernelImage )
+{
+  const std::vector<unsigned int> size = image.GetSize();
+  const std::vector<unsigned int> kernelSize = kernelImage.GetSize();
+
+  double numberOfPixels = 1.0;
+  double numberOfInteriorPixels = 1.0;
+  for ( unsigned int d = 0; d < size.size(); ++d )
+    {
+    numberOfPixels *= size[d];
+    numberOfInteriorPixels *= ( size[d] > 2 * ( kernelSize[d] / 2 ) ) ? size[d] - 2 * ( kernelSize[d] / 2 ) : 0;
+    }
+  return 2.0 * numberOfInteriorPixels < numberOfPixels;
+}
+
+
+Image SeparableConvolve( const Image &image,
+                         const std::vector<Image> &kernels,
+                         bool normalize,
+                         ConvolutionImageFilter::BoundaryConditionType boundaryCondition,
+                         ConvolutionImageFilter::OutputRegionModeType outputRegionMode )
+{
+  const PixelIDValueEnum workPixelID = IsRealPixelID( image.GetPixelID() ) ? image.GetPixelID() : sitkFloat64;
+
+  ConvolutionImageFilter filter;
+  filter.SetNormalize( normalize );
+  filter.SetBoundaryCondition( boundaryCondition );
+  filter.SetOutputRegionMode( outputRegionMode );
+
+  // The boundary conditions extend the image separably along each
+  // axis, so the passes compute the same convolution as the kernel.
+  Image output = Cast( image, workPixelID );
+  for ( unsigned int d = 0; d < kernels.size(); ++d )
+    {
+    if ( kernels[d].GetNumberOfPixels() == 1 && kernels[d].GetBufferAsDouble()[0] == 1.0 )
+      {
+      continue;
+      }
+    filter.SetPadInput( IsMostlyFaceRegions( output, kernels[d] ) );
+    output = filter.Execute( output, Cast( kernels[d], workPixelID ) );
+    }
+
+  if ( output.GetPixelID() != image.GetPixelID() )
+    {
+    output = Cast( output, image.GetPixelID() );
+    }
+  return output;
+}
+
+
+// The smallest time of a few executions of a convolution.
+double TimeConvolution( const Image &image, const Image &kernel, ConvolutionModeEnum mode )
+{
+  double minimumTime = std::numeric_limits<double>::max();
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    itk::TimeProbe probe;
+    probe.Start();
+    Convolve( image, kernel, false, ConvolutionImageFilter::ZERO_FLUX_NEUMANN_PAD, ConvolutionImageFilter::SAME, mode );
+    probe.Stop();
+    minimumTime = std::min( minimumTime, probe.GetTotal() );
+    }
+  return minimumTime;
+}
+
+}
+
+
+Image Convolve ( const Image& image,
+                 const Image& kernelImage,
+                 bool normalize,
+                 ConvolutionImageFilter::BoundaryConditionType boundaryCondition,
+                 ConvolutionImageFilter::OutputRegionModeType outputRegionMode,
+                 ConvolutionModeEnum mode )
+{
+  if ( image.GetDimension() != kernelImage.GetDimension() )
+    {
+    sitkExceptionMacro( "The kernel image does not match the dimension of the image!" );
+    }
+  if ( image.GetPixelID() != kernelImage.GetPixelID() )
+    {
+    sitkExceptionMacro( "The kernel image does not match the pixel type of the image!" );
+    }
+
+  std::vector<Image> separableKernels;
+  if ( mode == sitkConvolutionAuto )
+    {
+    mode = SelectConvolutionMode( image, kernelImage, separableKernels );
+    }
+  else if ( mode == sitkConvolutionSeparable &&
+            !ComputeSeparableKernels( kernelImage, separableKernels ) )
+    {
+    sitkExceptionMacro( "The kernel image is not separable!" );
+    }
+
+  switch ( mode )
+    {
+    case sitkConvolutionSeparable:
+      return SeparableConvolve( image, separableKernels, normalize, boundaryCondition, outputRegionMode );
+    case sitkConvolutionFFT:
+      {
+      FFTConvolutionImageFilter filter;
+      filter.SetNormalize( normalize );
+      filter.SetBoundaryCondition( FFTConvolutionImageFilter::BoundaryConditionType( int( boundaryCondition ) ) );
+      filter.SetOutputRegionMode( FFTConvolutionImageFilter::OutputRegionModeType( int( outputRegionMode ) ) );
+      return filter.Execute( image, kernelImage );
+      }
+    case sitkConvolutionSpatial:
+      {
+      ConvolutionImageFilter filter;
+      filter.SetNormalize( normalize );
+      filter.SetBoundaryCondition( boundaryCondition );
+      filter.SetOutputRegionMode( outputRegionMode );
+      filter.SetPadInput( IsMostlyFaceRegions( image, kernelImage ) );
+      return filter.Execute( image, kernelImage );
+      }
+    default:
+      sitkExceptionMacro( "Unknown convolution mode: " << mode );
+    }
+}
+
+
+ConvolutionModeEnum SelectConvolutionMode ( const Image& image,
+                                            const Image& kernelImage )
+{
+  std::vector<Image> separableKernels;
+  return SelectConvolutionMode( image, kernelImage, separableKernels );
+}
+
+
+void CalibrateConvolutionMode ( const std::string &fileName )
+{
+  if ( !fileName.empty() )
+    {
+    std::ifstream input( fileName.c_str() );
+    ConvolutionCosts costs;
+    if ( input >> costs.m_KernelPixel >> costs.m_Pass >> costs.m_FFTPixel )
+      {
+      convolutionCosts = costs;
+      return;
+      }
+    }
+
+  const unsigned int imageSize = 64;
+  const unsigned int kernelSize = 7;
+  Image image( imageSize, imageSize, imageSize, sitkFloat32 );
+  Image kernel( kernelSize, kernelSize, kernelSize, sitkFloat32 );
+  std::fill( kernel.GetBufferAsFloat(), kernel.GetBufferAsFloat() + kernel.GetNumberOfPixels(), 1.0f );
+  // the ConvolutionImageFilter computes a separable kernel one axis
+  // at a time, so the kernel used to time it is not separable
+  kernel.GetBufferAsFloat()[kernel.GetNumberOfPixels() / 2] = 2.0f;
+  Image impulse( 1, 1, 1, sitkFloat32 );
+  impulse.GetBufferAsFloat()[0] = 1.0f;
+
+  const double numberOfPixels = image.GetNumberOfPixels();
+  const double numberOfKernelPixels = kernel.GetNumberOfPixels();
+  const double numberOfPaddedPixels = std::pow( double( imageSize + kernelSize ), 3.0 );
+
+  // a pass with a single pixel kernel, a spatial convolution and a
+  // FFT convolution with the 3-D kernel
+  ConvolutionCosts costs;
+  costs.m_Pass = TimeConvolution( image, impulse, sitkConvolutionSpatial ) / numberOfPixels;
+  const double spatialTime = TimeConvolution( image, kernel, sitkConvolutionSpatial );
+  costs.m_KernelPixel = std::max( spatialTime / numberOfPixels - costs.m_Pass, costs.m_Pass ) / numberOfKernelPixels;
+  const double fftTime = TimeConvolution( image, kernel, sitkConvolutionFFT );
+  costs.m_FFTPixel = fftTime / ( 3.0 * numberOfPaddedPixels * std::log( numberOfPaddedPixels ) / std::log( 2.0 ) );
+
+  convolutionCosts = costs;
+
+  if ( !fileName.empty() )
+    {
+    std::ofstream output( fileName.c_str() );
+    output.precision( 17 );
+    output << costs.m_KernelPixel << " " << costs.m_Pass << " " << costs.m_FFTPixel << std::endl;
+    if ( !output )
+      {
+      sitkExceptionMacro( "Unable to write the convolution calibration file \"" << fileName << "\"" );
+      }
+    }
+}
+
+}
+}
@@ -23,9 +23,11 @@
 #include <itkNearestNeighborInterpolateImageFunction.h>
 #include <itkLinearInterpolateImageFunction.h>
 #include <itkBSplineInterpolateImageFunction.h>
+#include <itkBSplineResampleImageFunction.h>
 #include <itkGaussianInterpolateImageFunction.h>
 #include <itkLabelImageGaussianInterpolateImageFunction.h>
 #include <itkWindowedSincInterpolateImageFunction.h>
+#include "itkTabulatedWindowedSincInterpolateImageFunction.h"
 
 namespace itk
 {
@@ -47,14 +49,45 @@ ConditionalCreateInterpolator( const FalseType & )
   return NULL;
 }
 
-template< typename TImageType >
+/** Create a windowed sinc interpolator, with the kernel sampled in a
+ * table of tableResolution samples per pixel if it is not zero.
+ */
+template< typename TImageType, typename TWindowFunction, unsigned int VRadius >
 typename itk::InterpolateImageFunction< TImageType, double >::Pointer
-CreateInterpolator( const TImageType *image, InterpolatorEnum itype )
+CreateWindowedSincInterpolator( unsigned int tableResolution, const TrueType & )
 {
   typedef typename itk::InterpolateImageFunction< TImageType, double >::Pointer RType;
+
+  if ( tableResolution > 0 )
+    {
+    typedef itk::TabulatedWindowedSincInterpolateImageFunction<TImageType, VRadius, TWindowFunction, double> InterpolatorType;
+    typename InterpolatorType::Pointer p = InterpolatorType::New();
+    p->SetNumberOfSamplesPerPixel( tableResolution );
+    return RType(p);
+    }
+
   typedef typename itk::ZeroFluxNeumannBoundaryCondition<TImageType,TImageType> BoundaryCondition;
-  //typedef typename itk::ConstantBoundaryCondition<TImageType> BoundaryCondition;
+  typedef itk::WindowedSincInterpolateImageFunction<TImageType, VRadius, TWindowFunction, BoundaryCondition> InterpolatorType;
+  return RType( InterpolatorType::New() );
+}
+
+template< typename TImageType, typename TWindowFunction, unsigned int VRadius >
+typename itk::InterpolateImageFunction< TImageType, double >::Pointer
+CreateWindowedSincInterpolator( unsigned int, const FalseType & )
+{
+  return NULL;
+}
 
+/** Create the interpolator of a type for an image. The windowed sinc
+ * interpolators use a table of windowedSincTableResolution samples
+ * per pixel of their kernel when it is not zero, and evaluate the
+ * kernel exactly otherwise.
+ */
+template< typename TImageType >
+typename itk::InterpolateImageFunction< TImageType, double >::Pointer
+CreateInterpolator( const TImageType *image, InterpolatorEnum itype, unsigned int windowedSincTableResolution = 0 )
+{
+  typedef typename itk::InterpolateImageFunction< TImageType, double >::Pointer RType;
   typedef typename TImageType::SpacingType SpacingType;
 
   static const unsigned int WindowingRadius = 5;
@@ -110,33 +143,32 @@ CreateInterpolator( const TImageType *image, InterpolatorEnum itype )
     }
     case sitkHammingWindowedSinc:
     {
-
       typedef typename itk::Function::HammingWindowFunction<WindowingRadius, double, double > WindowFunction;
-      typedef itk::WindowedSincInterpolateImageFunction<TImageType, WindowingRadius, WindowFunction, BoundaryCondition> InterpolatorType;
-      return RType( ConditionalCreateInterpolator<InterpolatorType>( typename IsBasic<TImageType>::Type() ) );
+      return CreateWindowedSincInterpolator<TImageType, WindowFunction, WindowingRadius>( windowedSincTableResolution, typename IsBasic<TImageType>::Type() );
     }
     case sitkCosineWindowedSinc:
     {
       typedef typename itk::Function::CosineWindowFunction<WindowingRadius, double, double > WindowFunction;
-      typedef itk::WindowedSincInterpolateImageFunction<TImageType, WindowingRadius, WindowFunction, BoundaryCondition> InterpolatorType;
-      return RType( ConditionalCreateInterpolator<InterpolatorType>( typename IsBasic<TImageType>::Type() ) );
+      return CreateWindowedSincInterpolator<TImageType, WindowFunction, WindowingRadius>( windowedSincTableResolution, typename IsBasic<TImageType>::Type() );
     }
     case sitkWelchWindowedSinc:
     {
       typedef typename itk::Function::WelchWindowFunction<WindowingRadius, double, double > WindowFunction;
-      typedef itk::WindowedSincInterpolateImageFunction<TImageType, WindowingRadius, WindowFunction, BoundaryCondition> InterpolatorType;
-      return RType( ConditionalCreateInterpolator<InterpolatorType>( typename IsBasic<TImageType>::Type() ) );
+      return CreateWindowedSincInterpolator<TImageType, WindowFunction, WindowingRadius>( windowedSincTableResolution, typename IsBasic<TImageType>::Type() );
     }
     case sitkLanczosWindowedSinc:
     {
       typedef typename itk::Function::LanczosWindowFunction<WindowingRadius, double, double > WindowFunction;
-      typedef itk::WindowedSincInterpolateImageFunction<TImageType, WindowingRadius, WindowFunction, BoundaryCondition> InterpolatorType;
-      return RType( ConditionalCreateInterpolator<InterpolatorType>( typename IsBasic<TImageType>::Type() ) );
+      return CreateWindowedSincInterpolator<TImageType, WindowFunction, WindowingRadius>( windowedSincTableResolution, typename IsBasic<TImageType>::Type() );
     }
     case sitkBlackmanWindowedSinc:
     {
       typedef typename itk::Function::BlackmanWindowFunction<WindowingRadius, double, double > WindowFunction;
-      typedef itk::WindowedSincInterpolateImageFunction<TImageType, WindowingRadius, WindowFunction, BoundaryCondition> InterpolatorType;
+      return CreateWindowedSincInterpolator<TImageType, WindowFunction, WindowingRadius>( windowedSincTableResolution, typename IsBasic<TImageType>::Type() );
+    }
+    case sitkBSplineResampler:
+    {
+      typedef itk::BSplineResampleImageFunction<TImageType, double> InterpolatorType;
       return RType( ConditionalCreateInterpolator<InterpolatorType>( typename IsBasic<TImageType>::Type() ) );
     }
     default:
@@ -0,0 +1,98 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkCreateKernel.h"
+
+#include "itkSimpleFastMutexLock.h"
+
+#include <map>
+#include <utility>
+
+
+namespace itk {
+namespace simple {
+
+namespace
+{
+
+typedef std::pair< KernelEnum, std::vector<uint32_t> > KernelKeyType;
+
+const size_t MaximumNumberOfCachedKernels = 64;
+const size_t MaximumNumberOfCachedPixels = size_t(1) << 24;
+
+class KernelCache
+{
+public:
+  typedef std::map< KernelKeyType, CachedKernelBase * > MapType;
+
+  KernelCache() : m_NumberOfPixels( 0 ) {}
+
+  ~KernelCache()
+  {
+    for ( MapType::iterator it = m_Kernels.begin(); it != m_Kernels.end(); ++it )
+      {
+      delete it->second;
+      }
+  }
+
+  itk::SimpleFastMutexLock m_Mutex;
+  MapType                  m_Kernels;
+  size_t                   m_NumberOfPixels;
+};
+
+typedef itk::MutexLockHolder<itk::SimpleFastMutexLock> MutexHolderType;
+
+KernelCache Cache;
+
+}
+
+
+const CachedKernelBase *FindCachedKernel( KernelEnum kernelType,
+                                          const std::vector<uint32_t> &radius )
+{
+  MutexHolderType holder( Cache.m_Mutex );
+  KernelCache::MapType::const_iterator it = Cache.m_Kernels.find( KernelKeyType( kernelType, radius ) );
+  if ( it == Cache.m_Kernels.end() )
+    {
+    return SITK_NULLPTR;
+    }
+  return it->second;
+}
+
+
+void AddCachedKernel( KernelEnum kernelType,
+                      const std::vector<uint32_t> &radius,
+                      CachedKernelBase *kernel,
+                      size_t numberOfPixels )
+{
+  {
+  MutexHolderType holder( Cache.m_Mutex );
+  // another thread may have added the same kernel since it was
+  // looked up
+  if ( Cache.m_Kernels.size() < MaximumNumberOfCachedKernels
+       && Cache.m_NumberOfPixels + numberOfPixels <= MaximumNumberOfCachedPixels
+       && Cache.m_Kernels.insert( std::make_pair( KernelKeyType( kernelType, radius ), kernel ) ).second )
+    {
+    Cache.m_NumberOfPixels += numberOfPixels;
+    return;
+    }
+  }
+  delete kernel;
+}
+
+} // end namespace simple
+} // end namespace itk
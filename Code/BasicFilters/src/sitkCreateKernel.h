@@ -20,7 +20,11 @@
 
 
 #include "sitkKernel.h"
+#include "sitkBasicFilters.h"
+#include "sitkExceptionObject.h"
 #include <itkFlatStructuringElement.h>
+#include <algorithm>
+#include <vector>
 
 namespace itk
 {
@@ -28,17 +32,54 @@ namespace itk
 namespace simple
 {
 
+/** \class CachedKernelBase
+ * \brief A kernel kept by the kernel cache, of any dimension
+ */
+class SITKBasicFilters0_EXPORT CachedKernelBase
+{
+public:
+  virtual ~CachedKernelBase() {}
+};
+
+template< unsigned int VImageDimension >
+class CachedKernel
+  : public CachedKernelBase
+{
+public:
+  CachedKernel( const itk::FlatStructuringElement< VImageDimension > &kernel ) : m_Kernel( kernel ) {}
+  const itk::FlatStructuringElement< VImageDimension > m_Kernel;
+};
+
+/** \brief Find a kernel of the type and radius in the cache of the
+ * process, or return null.
+ *
+ * The cached kernels are never removed, so the kernel returned may
+ * be used without holding a lock. The dimension of the kernel is the
+ * number of elements of the radius.
+ */
+SITKBasicFilters0_EXPORT const CachedKernelBase *FindCachedKernel( KernelEnum kernelType,
+                                                                   const std::vector<uint32_t> &radius );
+
+/** \brief Add a kernel to the cache, which takes ownership of it.
+ *
+ * The kernel is deleted instead when the cache is full, or already
+ * has a kernel of the type and radius. The cache holds at most 64
+ * kernels of 2^24 pixels altogether.
+ */
+SITKBasicFilters0_EXPORT void AddCachedKernel( KernelEnum kernelType,
+                                               const std::vector<uint32_t> &radius,
+                                               CachedKernelBase *kernel,
+                                               size_t numberOfPixels );
+
 #define sitkKernelPolygonCreateMacro(n) \
   case sitkPolygon##n: return ITKKernelType::Polygon( radius, n )
 
 template< unsigned int VImageDimension >
 itk::FlatStructuringElement< VImageDimension >
-CreateKernel( KernelEnum kernelType, const std::vector<uint32_t> &size )
+BuildKernel( KernelEnum kernelType, const typename itk::FlatStructuringElement< VImageDimension >::SizeType &radius )
 {
   typedef typename itk::FlatStructuringElement< VImageDimension > ITKKernelType;
 
-  typename ITKKernelType::SizeType radius = sitkSTLVectorToITK<typename ITKKernelType::SizeType>( size );
-
   switch (kernelType)
     {
     case sitkAnnulus:
@@ -66,6 +107,83 @@ CreateKernel( KernelEnum kernelType, const std::vector<uint32_t> &size )
 }
 
 
+/** \brief Create a kernel of a type and radius.
+ *
+ * The kernels, such as large balls and polygons, are costly to
+ * build, so the kernels built are kept in a cache of the process and
+ * copied by the next calls, from any filter.
+ */
+template< unsigned int VImageDimension >
+itk::FlatStructuringElement< VImageDimension >
+CreateKernel( KernelEnum kernelType, const std::vector<uint32_t> &size )
+{
+  typedef typename itk::FlatStructuringElement< VImageDimension > ITKKernelType;
+
+  typename ITKKernelType::SizeType radius = sitkSTLVectorToITK<typename ITKKernelType::SizeType>( size );
+
+  std::vector<uint32_t> key( VImageDimension );
+  for ( unsigned int d = 0; d < VImageDimension; ++d )
+    {
+    key[d] = static_cast<uint32_t>( radius[d] );
+    }
+
+  const CachedKernelBase *cached = FindCachedKernel( kernelType, key );
+  if ( cached != SITK_NULLPTR )
+    {
+    // the dimension is that of the radius of the key
+    return static_cast< const CachedKernel< VImageDimension > * >( cached )->m_Kernel;
+    }
+
+  ITKKernelType kernel = BuildKernel< VImageDimension >( kernelType, radius );
+  AddCachedKernel( kernelType, key, new CachedKernel< VImageDimension >( kernel ), kernel.Size() );
+  return kernel;
+}
+
+
+/** \brief Whether two kernels have the same radius, pixels and
+ * decomposition into lines. */
+template< unsigned int VImageDimension >
+bool IsSameKernel( const itk::FlatStructuringElement< VImageDimension > &kernel1,
+                   const itk::FlatStructuringElement< VImageDimension > &kernel2 )
+{
+  return kernel1.GetRadius() == kernel2.GetRadius()
+    && kernel1.GetDecomposable() == kernel2.GetDecomposable()
+    && kernel1.GetLines().size() == kernel2.GetLines().size()
+    && std::equal( kernel1.Begin(), kernel1.End(), kernel2.Begin() );
+}
+
+
+
+/** \brief Create a flat line kernel along each axis with a non-zero
+ * radius.
+ *
+ * The sitkBox kernel is the dilation of these lines by each other,
+ * and the sitkCross kernel is their union, so a dilation or an
+ * erosion with these kernels may be computed with the lines.
+ */
+template< unsigned int VImageDimension >
+std::vector< itk::FlatStructuringElement< VImageDimension > >
+CreateLineKernels( const std::vector<uint32_t> &size )
+{
+  typedef typename itk::FlatStructuringElement< VImageDimension > ITKKernelType;
+
+  typename ITKKernelType::SizeType radius = sitkSTLVectorToITK<typename ITKKernelType::SizeType>( size );
+
+  std::vector< ITKKernelType > lines;
+  for ( unsigned int d = 0; d < VImageDimension; ++d )
+    {
+    if ( radius[d] != 0 )
+      {
+      typename ITKKernelType::SizeType lineRadius;
+      lineRadius.Fill( 0 );
+      lineRadius[d] = radius[d];
+      lines.push_back( ITKKernelType::Box( lineRadius ) );
+      }
+    }
+  return lines;
+}
+
+
 } // end namespace simple
 } // end namespace itk
 
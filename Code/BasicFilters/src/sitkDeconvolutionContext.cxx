@@ -0,0 +1,445 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkDeconvolutionContext.h"
+#include "sitkCastImageFilter.h"
+#include "sitkExceptionObject.h"
+#include "sitkFFTTransforms.hxx"
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <complex>
+#include <sstream>
+
+namespace itk {
+  namespace simple {
+
+    namespace
+    {
+
+    // the threshold of the magnitude of the kernel transform below
+    // which the deconvolution is zero, as the deconvolution filters
+    const float KernelZeroMagnitudeThreshold = 1.0e-4f;
+
+
+    // Extend an image to the padded size with the boundary
+    // condition, the image starting at the index lower.
+    template< class TImage >
+    typename TImage::Pointer PadImage( const TImage *image,
+                                       const std::vector<unsigned int> &paddedSize,
+                                       const std::vector<unsigned int> &lower,
+                                       DeconvolutionContext::BoundaryConditionType boundaryCondition )
+    {
+      typedef typename TImage::IndexType IndexType;
+      const unsigned int Dimension = TImage::ImageDimension;
+
+      typename TImage::RegionType region;
+      for ( unsigned int d = 0; d < Dimension; ++d )
+        {
+        region.SetIndex( d, 0 );
+        region.SetSize( d, paddedSize[d] );
+        }
+      typename TImage::Pointer padded = TImage::New();
+      padded->SetRegions( region );
+      padded->Allocate();
+
+      const typename TImage::RegionType imageRegion = image->GetLargestPossibleRegion();
+      ImageRegionIteratorWithIndex< TImage > it( padded, region );
+      for ( ; !it.IsAtEnd(); ++it )
+        {
+        const IndexType index = it.GetIndex();
+        IndexType source;
+        bool inside = true;
+        for ( unsigned int d = 0; d < Dimension; ++d )
+          {
+          const IndexValueType size = static_cast<IndexValueType>( imageRegion.GetSize( d ) );
+          IndexValueType s = index[d] - static_cast<IndexValueType>( lower[d] );
+          if ( s < 0 || s >= size )
+            {
+            switch ( boundaryCondition )
+              {
+              case DeconvolutionContext::ZERO_PAD:
+                inside = false;
+                break;
+              case DeconvolutionContext::PERIODIC_PAD:
+                s = ( ( s % size ) + size ) % size;
+                break;
+              case DeconvolutionContext::ZERO_FLUX_NEUMANN_PAD:
+              default:
+                s = std::min( std::max( s, IndexValueType( 0 ) ), size - 1 );
+              }
+            }
+          source[d] = s + imageRegion.GetIndex( d );
+          }
+        it.Set( inside ? image->GetPixel( source ) : typename TImage::PixelType( 0 ) );
+        }
+      return padded;
+    }
+
+
+    // transform = transform * kernel, or its conjugate
+    template< class TComplexImage >
+    void MultiplyTransform( TComplexImage *transform, const TComplexImage *kernelTransform, bool conjugate )
+    {
+      typename TComplexImage::PixelType *t = transform->GetBufferPointer();
+      const typename TComplexImage::PixelType *h = kernelTransform->GetBufferPointer();
+      const size_t n = transform->GetPixelContainer()->Size();
+      for ( size_t i = 0; i < n; ++i )
+        {
+        t[i] *= conjugate ? std::conj( h[i] ) : h[i];
+        }
+    }
+
+    }
+
+
+    DeconvolutionContext::DeconvolutionContext()
+      : m_Algorithm( Wiener ),
+        m_Normalize( false ),
+        m_BoundaryCondition( ZERO_FLUX_NEUMANN_PAD ),
+        m_NoiseVariance( 0.0 ),
+        m_RegularizationConstant( 0.0 ),
+        m_NumberOfIterations( 1 ),
+        m_Alpha( 0.1 )
+    {
+    }
+
+
+    DeconvolutionContext::~DeconvolutionContext()
+    {
+    }
+
+
+    DeconvolutionContext::Self& DeconvolutionContext::SetKernelImage( const Image &kernelImage )
+    {
+      this->m_KernelImage = kernelImage;
+      this->m_KernelTransform = Image();
+      this->m_ImageSize.clear();
+      this->m_PaddedSize.clear();
+      return *this;
+    }
+
+
+    DeconvolutionContext::Self& DeconvolutionContext::SetNormalize( bool normalize )
+    {
+      if ( normalize != this->m_Normalize )
+        {
+        this->m_Normalize = normalize;
+        this->m_KernelTransform = Image();
+        this->m_ImageSize.clear();
+        this->m_PaddedSize.clear();
+        }
+      return *this;
+    }
+
+
+    Image DeconvolutionContext::Execute( const Image &image )
+    {
+      return this->Execute( std::vector<Image>( 1, image ) ).front();
+    }
+
+
+    std::vector<Image> DeconvolutionContext::Execute( const std::vector<Image> &images )
+    {
+      if ( images.empty() )
+        {
+        return std::vector<Image>();
+        }
+      if ( this->m_KernelImage.GetNumberOfPixels() == 0 || this->m_KernelImage.GetPixelID() == sitkUnknown )
+        {
+        sitkExceptionMacro( "The kernel image is not set!" );
+        }
+
+      const unsigned int dimension = images[0].GetDimension();
+      const std::vector<unsigned int> size = images[0].GetSize();
+      for ( size_t i = 0; i < images.size(); ++i )
+        {
+        if ( images[i].GetSize() != size )
+          {
+          sitkExceptionMacro( "The images of a batch must have the same size!" );
+          }
+        if ( images[i].GetNumberOfComponentsPerPixel() != 1 )
+          {
+          sitkExceptionMacro( "The images must be scalar images!" );
+          }
+        }
+      if ( this->m_KernelImage.GetDimension() != dimension )
+        {
+        sitkExceptionMacro( "The kernel image does not match the dimension of the images!" );
+        }
+
+      switch ( dimension )
+        {
+        case 2:
+          return this->ExecuteInternal<2>( images );
+        case 3:
+          return this->ExecuteInternal<3>( images );
+        default:
+          sitkExceptionMacro( "Unsupported dimension: " << dimension );
+        }
+    }
+
+
+    template <unsigned int VImageDimension>
+    std::vector<Image> DeconvolutionContext::ExecuteInternal( const std::vector<Image> &images )
+    {
+      typedef itk::Image< float, VImageDimension >                 RealImageType;
+      typedef itk::Image< std::complex<float>, VImageDimension >   ComplexImageType;
+      typedef itk::RealToHalfHermitianForwardFFTImageFilter< RealImageType, ComplexImageType > ForwardFFTType;
+      typedef itk::HalfHermitianToRealInverseFFTImageFilter< ComplexImageType, RealImageType > InverseFFTType;
+
+      // the FFT filters and their plans are shared by the images
+      typename ForwardFFTType::Pointer forwardFFT = ForwardFFTType::New();
+      forwardFFT->SetNumberOfThreads( this->GetNumberOfThreads() );
+      typename InverseFFTType::Pointer inverseFFT = InverseFFTType::New();
+      inverseFFT->SetNumberOfThreads( this->GetNumberOfThreads() );
+
+      const std::vector<unsigned int> kernelSize = this->m_KernelImage.GetSize();
+      const std::vector<unsigned int> imageSize = images[0].GetSize();
+      std::vector<unsigned int> radius( VImageDimension );
+      for ( unsigned int d = 0; d < VImageDimension; ++d )
+        {
+        radius[d] = kernelSize[d] / 2;
+        }
+
+      if ( this->m_PaddedSize.empty() || this->m_ImageSize != imageSize )
+        {
+        std::vector<unsigned int> paddedSize( VImageDimension );
+        for ( unsigned int d = 0; d < VImageDimension; ++d )
+          {
+          paddedSize[d] = FFTSize( std::max( imageSize[d] + 2 * radius[d], kernelSize[d] ),
+                                   static_cast<unsigned int>( forwardFFT->GetSizeGreatestPrimeFactor() ) );
+          }
+
+        // the kernel is padded with its center at the origin
+        const Image kernelImage = Cast( this->m_KernelImage, sitkFloat32 );
+        const RealImageType *kernel = dynamic_cast< const RealImageType * >( kernelImage.GetITKBase() );
+        assert( kernel != SITK_NULLPTR );
+
+        double sum = 0.0;
+        ImageRegionConstIteratorWithIndex< RealImageType > kt( kernel, kernel->GetLargestPossibleRegion() );
+        for ( ; !kt.IsAtEnd(); ++kt )
+          {
+          sum += kt.Get();
+          }
+        const float scale = ( this->m_Normalize && sum != 0.0 ) ? static_cast<float>( 1.0 / sum ) : 1.0f;
+
+        typename RealImageType::RegionType paddedRegion;
+        for ( unsigned int d = 0; d < VImageDimension; ++d )
+          {
+          paddedRegion.SetIndex( d, 0 );
+          paddedRegion.SetSize( d, paddedSize[d] );
+          }
+        typename RealImageType::Pointer paddedKernel = RealImageType::New();
+        paddedKernel->SetRegions( paddedRegion );
+        paddedKernel->Allocate();
+        paddedKernel->FillBuffer( 0.0f );
+        for ( kt.GoToBegin(); !kt.IsAtEnd(); ++kt )
+          {
+          typename RealImageType::IndexType index;
+          for ( unsigned int d = 0; d < VImageDimension; ++d )
+            {
+            const IndexValueType k = kt.GetIndex()[d] - kernel->GetLargestPossibleRegion().GetIndex( d );
+            const IndexValueType n = static_cast<IndexValueType>( paddedSize[d] );
+            index[d] = ( k - static_cast<IndexValueType>( radius[d] ) + n ) % n;
+            }
+          paddedKernel->SetPixel( index, scale * kt.Get() );
+          }
+
+        this->m_KernelTransform = Image( ForwardTransform( forwardFFT.GetPointer(), paddedKernel.GetPointer() ) );
+        this->m_ImageSize = imageSize;
+        this->m_PaddedSize = paddedSize;
+        }
+
+      const ComplexImageType *kernelTransform = dynamic_cast< const ComplexImageType * >( this->m_KernelTransform.GetITKBase() );
+      assert( kernelTransform != SITK_NULLPTR );
+      const std::complex<float> *h = kernelTransform->GetBufferPointer();
+      const size_t numberOfFrequencies = kernelTransform->GetPixelContainer()->Size();
+
+      double numberOfPaddedPixels = 1.0;
+      for ( unsigned int d = 0; d < VImageDimension; ++d )
+        {
+        numberOfPaddedPixels *= this->m_PaddedSize[d];
+        }
+      inverseFFT->SetActualXDimensionIsOdd( this->m_PaddedSize[0] % 2 == 1 );
+
+      std::vector<Image> outputs;
+      outputs.reserve( images.size() );
+      for ( size_t i = 0; i < images.size(); ++i )
+        {
+        const Image floatImage = Cast( images[i], sitkFloat32 );
+        const RealImageType *input = dynamic_cast< const RealImageType * >( floatImage.GetITKBase() );
+        assert( input != SITK_NULLPTR );
+
+        typename RealImageType::Pointer padded = PadImage( input, this->m_PaddedSize, radius, this->m_BoundaryCondition );
+        typename RealImageType::Pointer estimate;
+
+        switch ( this->m_Algorithm )
+          {
+          case Wiener:
+          case Tikhonov:
+            {
+            typename ComplexImageType::Pointer transform = ForwardTransform( forwardFFT.GetPointer(), padded.GetPointer() );
+            std::complex<float> *g = transform->GetBufferPointer();
+            const float noise = static_cast<float>( this->m_NoiseVariance * numberOfPaddedPixels );
+            for ( size_t f = 0; f < numberOfFrequencies; ++f )
+              {
+              float denominator = std::norm( h[f] );
+              if ( this->m_Algorithm == Wiener )
+                {
+                // the power spectral density of the image is estimated
+                // as the one of the input minus the one of the noise
+                denominator += noise / ( std::norm( g[f] ) - noise );
+                }
+              else
+                {
+                denominator += static_cast<float>( this->m_RegularizationConstant );
+                }
+              g[f] = ( std::abs( denominator ) >= KernelZeroMagnitudeThreshold ) ? g[f] * ( std::conj( h[f] ) / denominator ) : std::complex<float>( 0.0f );
+              }
+            estimate = InverseTransform( inverseFFT.GetPointer(), transform.GetPointer() );
+            break;
+            }
+          case Landweber:
+          case ProjectedLandweber:
+            {
+            const float alpha = static_cast<float>( this->m_Alpha );
+            typename ComplexImageType::Pointer inputTransform = ForwardTransform( forwardFFT.GetPointer(), padded.GetPointer() );
+            const std::complex<float> *g = inputTransform->GetBufferPointer();
+            // the first estimate is the input
+            typename ComplexImageType::Pointer transform = ComplexImageType::New();
+            transform->CopyInformation( inputTransform );
+            transform->SetRegions( inputTransform->GetLargestPossibleRegion() );
+            transform->Allocate();
+            std::copy( g, g + numberOfFrequencies, transform->GetBufferPointer() );
+            estimate = padded;
+            for ( unsigned int iteration = 0; iteration < this->m_NumberOfIterations; ++iteration )
+              {
+              if ( iteration > 0 && this->m_Algorithm == ProjectedLandweber )
+                {
+                transform = ForwardTransform( forwardFFT.GetPointer(), estimate.GetPointer() );
+                }
+              std::complex<float> *e = transform->GetBufferPointer();
+              for ( size_t f = 0; f < numberOfFrequencies; ++f )
+                {
+                e[f] = alpha * std::conj( h[f] ) * g[f] + ( 1.0f - alpha * std::norm( h[f] ) ) * e[f];
+                }
+              if ( this->m_Algorithm == ProjectedLandweber )
+                {
+                // project the estimate onto the nonnegative images
+                estimate = InverseTransform( inverseFFT.GetPointer(), transform.GetPointer() );
+                float *p = estimate->GetBufferPointer();
+                const size_t n = estimate->GetPixelContainer()->Size();
+                for ( size_t j = 0; j < n; ++j )
+                  {
+                  p[j] = std::max( p[j], 0.0f );
+                  }
+                }
+              }
+            if ( this->m_Algorithm == Landweber && this->m_NumberOfIterations > 0 )
+              {
+              estimate = InverseTransform( inverseFFT.GetPointer(), transform.GetPointer() );
+              }
+            break;
+            }
+          case RichardsonLucy:
+            {
+            estimate = padded;
+            const float *g = padded->GetBufferPointer();
+            const size_t n = padded->GetPixelContainer()->Size();
+            for ( unsigned int iteration = 0; iteration < this->m_NumberOfIterations; ++iteration )
+              {
+              typename ComplexImageType::Pointer transform = ForwardTransform( forwardFFT.GetPointer(), estimate.GetPointer() );
+              MultiplyTransform( transform.GetPointer(), kernelTransform, false );
+              typename RealImageType::Pointer ratio = InverseTransform( inverseFFT.GetPointer(), transform.GetPointer() );
+              float *r = ratio->GetBufferPointer();
+              for ( size_t j = 0; j < n; ++j )
+                {
+                r[j] = ( r[j] != 0.0f ) ? g[j] / r[j] : 0.0f;
+                }
+              transform = ForwardTransform( forwardFFT.GetPointer(), ratio.GetPointer() );
+              MultiplyTransform( transform.GetPointer(), kernelTransform, true );
+              typename RealImageType::Pointer correction = InverseTransform( inverseFFT.GetPointer(), transform.GetPointer() );
+              typename RealImageType::Pointer next = RealImageType::New();
+              next->SetRegions( estimate->GetLargestPossibleRegion() );
+              next->Allocate();
+              const float *e = estimate->GetBufferPointer();
+              const float *c = correction->GetBufferPointer();
+              float *x = next->GetBufferPointer();
+              for ( size_t j = 0; j < n; ++j )
+                {
+                x[j] = e[j] * c[j];
+                }
+              estimate = next;
+              }
+            break;
+            }
+          default:
+            sitkExceptionMacro( "Unknown deconvolution algorithm: " << this->m_Algorithm );
+          }
+
+        // crop the estimate to the region of the image
+        typename RealImageType::Pointer output = RealImageType::New();
+        output->CopyInformation( input );
+        output->SetRegions( input->GetLargestPossibleRegion() );
+        output->Allocate();
+        ImageRegionIteratorWithIndex< RealImageType > ot( output, output->GetLargestPossibleRegion() );
+        for ( ; !ot.IsAtEnd(); ++ot )
+          {
+          typename RealImageType::IndexType index;
+          for ( unsigned int d = 0; d < VImageDimension; ++d )
+            {
+            index[d] = ot.GetIndex()[d] - output->GetLargestPossibleRegion().GetIndex( d ) + static_cast<IndexValueType>( radius[d] );
+            }
+          ot.Set( estimate->GetPixel( index ) );
+          }
+
+        Image outputImage( output );
+        if ( images[i].GetPixelID() != sitkFloat32 )
+          {
+          outputImage = Cast( outputImage, images[i].GetPixelID() );
+          }
+        outputs.push_back( outputImage );
+        }
+      return outputs;
+    }
+
+
+    std::string DeconvolutionContext::ToString() const
+    {
+      std::ostringstream out;
+      out << "itk::simple::DeconvolutionContext" << std::endl;
+      out << "  Algorithm: " << this->m_Algorithm << std::endl;
+      out << "  Normalize: " << this->m_Normalize << std::endl;
+      out << "  BoundaryCondition: " << this->m_BoundaryCondition << std::endl;
+      out << "  NoiseVariance: " << this->m_NoiseVariance << std::endl;
+      out << "  RegularizationConstant: " << this->m_RegularizationConstant << std::endl;
+      out << "  NumberOfIterations: " << this->m_NumberOfIterations << std::endl;
+      out << "  Alpha: " << this->m_Alpha << std::endl;
+      out << "  PaddedSize: ";
+      this->ToStringHelper( out, this->m_PaddedSize );
+      out << std::endl;
+      out << ProcessObject::ToString();
+      return out.str();
+    }
+
+  }
+}
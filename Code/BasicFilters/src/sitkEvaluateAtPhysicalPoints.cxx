@@ -0,0 +1,230 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkAdditionalProcedures.h"
+#include "sitkMemberFunctionFactory.h"
+#include "sitkExceptionObject.h"
+#include "sitkEnableIf.h"
+#include "sitkVectorIndexSelectionCastImageFilter.h"
+#include "sitkCreateInterpolator.hxx"
+
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace itk {
+namespace simple {
+
+namespace
+{
+
+template <class TImageType>
+struct EvaluateAtPointsThreadStruct
+{
+  typedef itk::InterpolateImageFunction<TImageType, double>    InterpolatorType;
+  typedef itk::BSplineInterpolateImageFunction<TImageType, double> BSplineInterpolatorType;
+
+  const InterpolatorType        *m_Interpolator;
+  // set when the interpolator needs a thread id to evaluate concurrently
+  const BSplineInterpolatorType *m_BSplineInterpolator;
+  const double                  *m_Points;
+  double                        *m_Output;
+  size_t                         m_NumberOfPoints;
+  size_t                         m_Stride;
+  double                         m_DefaultValue;
+};
+
+template <class TImageType>
+ITK_THREAD_RETURN_TYPE EvaluateAtPointsThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  typedef EvaluateAtPointsThreadStruct<TImageType> StructType;
+  typedef typename StructType::InterpolatorType InterpolatorType;
+  typedef typename InterpolatorType::PointType PointType;
+  typedef typename InterpolatorType::ContinuousIndexType ContinuousIndexType;
+
+  const unsigned int Dimension = TImageType::ImageDimension;
+
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  const StructType *str = static_cast<StructType *>( info->UserData );
+
+  const size_t begin = str->m_NumberOfPoints * info->ThreadID / info->NumberOfThreads;
+  const size_t end = str->m_NumberOfPoints * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+  PointType point;
+  ContinuousIndexType cindex;
+  for ( size_t i = begin; i < end; ++i )
+    {
+    const double *p = str->m_Points + i * Dimension;
+    for ( unsigned int d = 0; d < Dimension; ++d )
+      {
+      point[d] = p[d];
+      }
+
+    double &out = str->m_Output[i * str->m_Stride];
+
+    str->m_Interpolator->ConvertPointToContinuousIndex( point, cindex );
+    if ( !str->m_Interpolator->IsInsideBuffer( cindex ) )
+      {
+      out = str->m_DefaultValue;
+      }
+    else if ( str->m_BSplineInterpolator )
+      {
+      out = str->m_BSplineInterpolator->EvaluateAtContinuousIndex( cindex, info->ThreadID );
+      }
+    else
+      {
+      out = str->m_Interpolator->EvaluateAtContinuousIndex( cindex );
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+// Dispatches the evaluation of an interpolator at a list of points on
+// the pixel type of the image. Vector images are evaluated one
+// component at a time.
+class PointsEvaluator
+{
+public:
+  typedef PointsEvaluator Self;
+  typedef void (Self::*MemberFunctionType)( const Image & );
+
+  typedef typelist::Append< BasicPixelIDTypeList, VectorPixelIDTypeList >::Type PixelIDTypeList;
+
+  PointsEvaluator( const std::vector<double> &points,
+                   InterpolatorEnum interpolator,
+                   double defaultValue,
+                   double *output,
+                   size_t stride )
+    : m_Points( points ),
+      m_Interpolator( interpolator ),
+      m_DefaultValue( defaultValue ),
+      m_Output( output ),
+      m_Stride( stride ) {}
+
+  void Execute( const Image &image )
+    {
+      detail::MemberFunctionFactory<MemberFunctionType> memberFactory( this );
+      memberFactory.RegisterMemberFunctions< PixelIDTypeList, 3 > ();
+      memberFactory.RegisterMemberFunctions< PixelIDTypeList, 2 > ();
+
+      memberFactory.GetMemberFunction( image.GetPixelID(), image.GetDimension() )( image );
+    }
+
+  template <class TImageType>
+  typename EnableIf<IsVector<TImageType>::Value>::Type
+  ExecuteInternal( const Image &image )
+    {
+      const unsigned int numberOfComponents = image.GetNumberOfComponentsPerPixel();
+      for ( unsigned int c = 0; c < numberOfComponents; ++c )
+        {
+        PointsEvaluator evaluator( m_Points, m_Interpolator, m_DefaultValue, m_Output + c, m_Stride );
+        evaluator.Execute( VectorIndexSelectionCast( image, c ) );
+        }
+    }
+
+  template <class TImageType>
+  typename EnableIf<IsBasic<TImageType>::Value>::Type
+  ExecuteInternal( const Image &image )
+    {
+      typedef EvaluateAtPointsThreadStruct<TImageType> StructType;
+      typedef typename StructType::InterpolatorType InterpolatorType;
+      typedef typename StructType::BSplineInterpolatorType BSplineInterpolatorType;
+
+      const TImageType *itkImage = dynamic_cast<const TImageType *>( image.GetITKBase() );
+      assert( itkImage != SITK_NULLPTR );
+
+      typename InterpolatorType::Pointer interpolator = CreateInterpolator( itkImage, m_Interpolator );
+      if ( interpolator.IsNull() )
+        {
+        sitkExceptionMacro( "Interpolator " << m_Interpolator << " is not supported for " << image.GetPixelIDTypeAsString() << "!" );
+        }
+      interpolator->SetInputImage( itkImage );
+
+      StructType str;
+      str.m_Interpolator = interpolator.GetPointer();
+      str.m_BSplineInterpolator = SITK_NULLPTR;
+      str.m_Points = &m_Points[0];
+      str.m_Output = m_Output;
+      str.m_NumberOfPoints = m_Points.size() / TImageType::ImageDimension;
+      str.m_Stride = m_Stride;
+      str.m_DefaultValue = m_DefaultValue;
+
+      // points fewer than this are evaluated by the calling thread
+      const size_t minimumPointsPerThread = 1024;
+      const size_t numberOfThreads =
+        std::max<size_t>( 1, std::min<size_t>( itk::MultiThreader::GetGlobalDefaultNumberOfThreads(),
+                                               str.m_NumberOfPoints / minimumPointsPerThread ) );
+
+      // the BSpline interpolator keeps a scratch buffer for each thread
+      BSplineInterpolatorType *bspline = dynamic_cast<BSplineInterpolatorType *>( interpolator.GetPointer() );
+      if ( bspline )
+        {
+        bspline->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+        str.m_BSplineInterpolator = bspline;
+        }
+
+      itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+      threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+      threader->SetSingleMethod( EvaluateAtPointsThreaderCallback<TImageType>, &str );
+      threader->SingleMethodExecute();
+    }
+
+private:
+  const std::vector<double> &m_Points;
+  InterpolatorEnum           m_Interpolator;
+  double                     m_DefaultValue;
+  double                    *m_Output;
+  size_t                     m_Stride;
+};
+
+}
+
+
+std::vector<double> EvaluateAtPhysicalPoints( const Image &image,
+                                              const std::vector<double> &points,
+                                              InterpolatorEnum interpolator,
+                                              double defaultValue )
+{
+  const unsigned int dimension = image.GetDimension();
+  if ( points.size() % dimension != 0 )
+    {
+    sitkExceptionMacro( "The number of point coordinates " << points.size()
+                        << " is not a multiple of the image dimension " << dimension << "!" );
+    }
+
+  const size_t numberOfPoints = points.size() / dimension;
+  const unsigned int numberOfComponents = image.GetNumberOfComponentsPerPixel();
+
+  std::vector<double> values( numberOfPoints * numberOfComponents );
+  if ( numberOfPoints == 0 )
+    {
+    return values;
+    }
+
+  PointsEvaluator evaluator( points, interpolator, defaultValue, &values[0], numberOfComponents );
+  evaluator.Execute( image );
+
+  return values;
+}
+
+}
+}
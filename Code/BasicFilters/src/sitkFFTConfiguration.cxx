@@ -0,0 +1,297 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "sitkFFTConfiguration.h"
+#include "sitkMacro.h"
+#include "sitkTemplateFunctions.h"
+
+#include "itkConfigure.h"
+#include "itkVersion.h"
+#include "itkImage.h"
+#include "itkObjectFactoryBase.h"
+#include "itkCreateObjectFunction.h"
+#include "itkVnlForwardFFTImageFilter.h"
+#include "itkVnlInverseFFTImageFilter.h"
+#include "itkVnlRealToHalfHermitianForwardFFTImageFilter.h"
+#include "itkVnlHalfHermitianToRealInverseFFTImageFilter.h"
+
+#if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
+#define SITK_HAS_FFTW
+#include "itkFFTWGlobalConfiguration.h"
+#endif
+
+#include <complex>
+#include <typeinfo>
+
+namespace itk {
+namespace simple {
+
+namespace
+{
+
+// An object factory overriding the creation of the FFT filters with
+// the VNL implementations, for the pixel types and dimensions of the
+// FFTs computed by the SimpleITK filters.
+class VnlFFTImageFilterFactory
+  : public ObjectFactoryBase
+{
+public:
+  typedef VnlFFTImageFilterFactory Self;
+  typedef ObjectFactoryBase        Superclass;
+  typedef SmartPointer<Self>       Pointer;
+  typedef SmartPointer<const Self> ConstPointer;
+
+  virtual const char *GetITKSourceVersion() const ITK_OVERRIDE { return ITK_SOURCE_VERSION; }
+  virtual const char *GetDescription() const ITK_OVERRIDE { return "SimpleITK VNL FFT image filters"; }
+
+  itkFactorylessNewMacro(Self);
+  itkTypeMacro(VnlFFTImageFilterFactory, ObjectFactoryBase);
+
+protected:
+  VnlFFTImageFilterFactory()
+    {
+      this->RegisterFFTOverrides<float, 2>();
+      this->RegisterFFTOverrides<float, 3>();
+      this->RegisterFFTOverrides<double, 2>();
+      this->RegisterFFTOverrides<double, 3>();
+#ifdef SITK_4D_IMAGES
+      this->RegisterFFTOverrides<float, 4>();
+      this->RegisterFFTOverrides<double, 4>();
+#endif
+    }
+
+private:
+  VnlFFTImageFilterFactory(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  template <class TFilterType, class TOverrideType>
+  void RegisterFFTOverride()
+    {
+      this->RegisterOverride( typeid(TFilterType).name(),
+                              typeid(TOverrideType).name(),
+                              "VNL FFT image filter",
+                              true,
+                              CreateObjectFunction<TOverrideType>::New() );
+    }
+
+  template <class TPixelType, unsigned int VImageDimension>
+  void RegisterFFTOverrides()
+    {
+      typedef Image<TPixelType, VImageDimension>               RealImageType;
+      typedef Image<std::complex<TPixelType>, VImageDimension> ComplexImageType;
+
+      this->RegisterFFTOverride< ForwardFFTImageFilter<RealImageType, ComplexImageType>,
+                                 VnlForwardFFTImageFilter<RealImageType, ComplexImageType> >();
+      this->RegisterFFTOverride< InverseFFTImageFilter<ComplexImageType, RealImageType>,
+                                 VnlInverseFFTImageFilter<ComplexImageType, RealImageType> >();
+      this->RegisterFFTOverride< RealToHalfHermitianForwardFFTImageFilter<RealImageType, ComplexImageType>,
+                                 VnlRealToHalfHermitianForwardFFTImageFilter<RealImageType, ComplexImageType> >();
+      this->RegisterFFTOverride< HalfHermitianToRealInverseFFTImageFilter<ComplexImageType, RealImageType>,
+                                 VnlHalfHermitianToRealInverseFFTImageFilter<ComplexImageType, RealImageType> >();
+    }
+};
+
+
+// the registered factory when the VNL backend is selected
+VnlFFTImageFilterFactory::Pointer vnlFactory;
+
+
+void CheckFFTW()
+{
+#ifndef SITK_HAS_FFTW
+  sitkExceptionMacro( "SimpleITK was built with an ITK without FFTW!" );
+#endif
+}
+
+}
+
+
+void FFTConfiguration::SetBackend( FFTBackendType backend )
+{
+  if ( backend == FFTW )
+    {
+    CheckFFTW();
+    if ( vnlFactory.IsNotNull() )
+      {
+      ObjectFactoryBase::UnRegisterFactory( vnlFactory );
+      vnlFactory = SITK_NULLPTR;
+      }
+    }
+  else if ( backend == VNL )
+    {
+    if ( HasFFTW() && vnlFactory.IsNull() )
+      {
+      vnlFactory = VnlFFTImageFilterFactory::New();
+      ObjectFactoryBase::RegisterFactory( vnlFactory, ObjectFactoryBase::INSERT_AT_FRONT );
+      }
+    }
+  else
+    {
+    sitkExceptionMacro( "Unknown FFT backend: " << backend );
+    }
+}
+
+
+FFTConfiguration::FFTBackendType FFTConfiguration::GetBackend()
+{
+  return ( HasFFTW() && vnlFactory.IsNull() ) ? FFTW : VNL;
+}
+
+
+bool FFTConfiguration::HasFFTW()
+{
+#ifdef SITK_HAS_FFTW
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+void FFTConfiguration::SetPlanRigor( const std::string &planRigor )
+{
+  CheckFFTW();
+#ifdef SITK_HAS_FFTW
+  if ( planRigor != "FFTW_ESTIMATE" && planRigor != "FFTW_MEASURE" &&
+       planRigor != "FFTW_PATIENT" && planRigor != "FFTW_EXHAUSTIVE" )
+    {
+    sitkExceptionMacro( "Unknown FFTW plan rigor: \"" << planRigor << "\"" );
+    }
+  FFTWGlobalConfiguration::SetPlanRigor( FFTWGlobalConfiguration::GetPlanRigorValue( planRigor ) );
+#endif
+}
+
+
+std::string FFTConfiguration::GetPlanRigor()
+{
+  CheckFFTW();
+#ifdef SITK_HAS_FFTW
+  return FFTWGlobalConfiguration::GetPlanRigorName( FFTWGlobalConfiguration::GetPlanRigor() );
+#else
+  return std::string();
+#endif
+}
+
+
+void FFTConfiguration::SetReadWisdomCache( bool readWisdomCache )
+{
+  CheckFFTW();
+#ifdef SITK_HAS_FFTW
+  FFTWGlobalConfiguration::SetReadWisdomCache( readWisdomCache );
+#else
+  Unused( readWisdomCache );
+#endif
+}
+
+
+bool FFTConfiguration::GetReadWisdomCache()
+{
+  CheckFFTW();
+#ifdef SITK_HAS_FFTW
+  return FFTWGlobalConfiguration::GetReadWisdomCache();
+#else
+  return false;
+#endif
+}
+
+
+void FFTConfiguration::SetWriteWisdomCache( bool writeWisdomCache )
+{
+  CheckFFTW();
+#ifdef SITK_HAS_FFTW
+  FFTWGlobalConfiguration::SetWriteWisdomCache( writeWisdomCache );
+#else
+  Unused( writeWisdomCache );
+#endif
+}
+
+
+bool FFTConfiguration::GetWriteWisdomCache()
+{
+  CheckFFTW();
+#ifdef SITK_HAS_FFTW
+  return FFTWGlobalConfiguration::GetWriteWisdomCache();
+#else
+  return false;
+#endif
+}
+
+
+void FFTConfiguration::SetWisdomCacheBase( const std::string &wisdomCacheBase )
+{
+  CheckFFTW();
+#ifdef SITK_HAS_FFTW
+  FFTWGlobalConfiguration::SetWisdomCacheBase( wisdomCacheBase );
+#else
+  Unused( wisdomCacheBase );
+#endif
+}
+
+
+std::string FFTConfiguration::GetWisdomCacheBase()
+{
+  CheckFFTW();
+#ifdef SITK_HAS_FFTW
+  return FFTWGlobalConfiguration::GetWisdomCacheBase();
+#else
+  return std::string();
+#endif
+}
+
+
+bool FFTConfiguration::ImportWisdomFile( const std::string &fileName, bool singlePrecision )
+{
+  CheckFFTW();
+  if ( singlePrecision )
+    {
+#if defined(ITK_USE_FFTWF)
+    return FFTWGlobalConfiguration::ImportWisdomFileFloat( fileName );
+#endif
+    }
+  else
+    {
+#if defined(ITK_USE_FFTWD)
+    return FFTWGlobalConfiguration::ImportWisdomFileDouble( fileName );
+#endif
+    }
+  sitkExceptionMacro( "SimpleITK was built with an ITK without FFTW for "
+                      << ( singlePrecision ? "single" : "double" ) << " precision!" );
+}
+
+
+bool FFTConfiguration::ExportWisdomFile( const std::string &fileName, bool singlePrecision )
+{
+  CheckFFTW();
+  if ( singlePrecision )
+    {
+#if defined(ITK_USE_FFTWF)
+    return FFTWGlobalConfiguration::ExportWisdomFileFloat( fileName );
+#endif
+    }
+  else
+    {
+#if defined(ITK_USE_FFTWD)
+    return FFTWGlobalConfiguration::ExportWisdomFileDouble( fileName );
+#endif
+    }
+  sitkExceptionMacro( "SimpleITK was built with an ITK without FFTW for "
+                      << ( singlePrecision ? "single" : "double" ) << " precision!" );
+}
+
+}
+}
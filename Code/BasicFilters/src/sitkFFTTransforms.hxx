@@ -0,0 +1,83 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkFFTTransforms_hxx
+#define sitkFFTTransforms_hxx
+
+#include <itkRealToHalfHermitianForwardFFTImageFilter.h>
+#include <itkHalfHermitianToRealInverseFFTImageFilter.h>
+
+namespace itk {
+namespace simple {
+
+/** \brief The smallest size not less than size whose prime factors
+ * are not greater than greatestPrimeFactor, the sizes supported by
+ * the FFT filters.
+ */
+inline unsigned int FFTSize( unsigned int size, unsigned int greatestPrimeFactor )
+{
+  for ( ;; ++size )
+    {
+    unsigned int remainder = size;
+    for ( unsigned int p = 2; p <= greatestPrimeFactor && remainder > 1; ++p )
+      {
+      while ( remainder % p == 0 )
+        {
+        remainder /= p;
+        }
+      }
+    if ( remainder == 1 )
+      {
+      return size;
+      }
+    }
+}
+
+
+/** \brief Compute the FFT of an image with a FFT filter reused for
+ * several images, so the plan of a size is created once.
+ */
+template< class TForwardFFT >
+typename TForwardFFT::OutputImageType::Pointer
+ForwardTransform( TForwardFFT *fft, const typename TForwardFFT::InputImageType *image )
+{
+  fft->SetInput( image );
+  fft->Update();
+  typename TForwardFFT::OutputImageType::Pointer transform = fft->GetOutput();
+  transform->DisconnectPipeline();
+  return transform;
+}
+
+
+/** \brief Compute the inverse FFT of a transform with a FFT filter
+ * reused for several transforms.
+ */
+template< class TInverseFFT >
+typename TInverseFFT::OutputImageType::Pointer
+InverseTransform( TInverseFFT *fft, const typename TInverseFFT::InputImageType *transform )
+{
+  fft->SetInput( transform );
+  fft->Update();
+  typename TInverseFFT::OutputImageType::Pointer image = fft->GetOutput();
+  image->DisconnectPipeline();
+  return image;
+}
+
+} // end namespace simple
+} // end namespace itk
+
+#endif
@@ -0,0 +1,147 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkFastMarchingRegion_hxx
+#define sitkFastMarchingRegion_hxx
+
+#include <itkImage.h>
+#include <itkImageAlgorithm.h>
+#include <itkImageRegionConstIterator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace itk {
+namespace simple {
+
+/** \brief Bound the output region of a fast marching filter to the
+ * points the front reaches before the stopping value.
+ *
+ * The arrival time of a point is at least the value of a trial
+ * point plus the physical distance to it divided by the largest
+ * speed, so the points of a time not greater than the stopping value
+ * are within ( StoppingValue - value ) * maximum speed of a trial
+ * point. The output region is set to the bounding box of these
+ * balls, expanded by 2 pixels for the trial points of the last
+ * front, and the filter allocates and initializes this region only.
+ * The values in the region are those of the whole image.
+ *
+ * The trial points must be set. Returns false, and leaves the filter
+ * unchanged, when the region is the whole image.
+ */
+template< class TFilter >
+bool BoundFastMarchingOutputRegion( TFilter *filter,
+                                    const typename TFilter::SpeedImageType *speedImage,
+                                    double stoppingValue,
+                                    double normalizationFactor )
+{
+  typedef typename TFilter::SpeedImageType SpeedImageType;
+  typedef typename TFilter::NodeContainer  NodeContainerType;
+  const unsigned int Dimension = SpeedImageType::ImageDimension;
+
+  // a persistent filter may have the region of a previous execution
+  filter->SetOverrideOutputInformation( false );
+
+  const NodeContainerType *trialPoints = filter->GetTrialPoints();
+  if ( trialPoints == SITK_NULLPTR || trialPoints->Size() == 0 || normalizationFactor <= 0.0 )
+    {
+    return false;
+    }
+
+  const typename SpeedImageType::RegionType largestRegion = speedImage->GetLargestPossibleRegion();
+
+  double maximumSpeed = 0.0;
+  ImageRegionConstIterator< SpeedImageType > it( speedImage, largestRegion );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    maximumSpeed = std::max( maximumSpeed, double( it.Get() ) );
+    }
+  maximumSpeed /= normalizationFactor;
+
+  const typename SpeedImageType::SpacingType spacing = speedImage->GetSpacing();
+
+  std::vector<double> lower( Dimension, std::numeric_limits<double>::max() );
+  std::vector<double> upper( Dimension, -std::numeric_limits<double>::max() );
+  for ( typename NodeContainerType::ConstIterator node = trialPoints->Begin(); node != trialPoints->End(); ++node )
+    {
+    const double radius = std::max( 0.0, ( stoppingValue - double( node.Value().GetValue() ) ) * maximumSpeed );
+    for ( unsigned int d = 0; d < Dimension; ++d )
+      {
+      const double index = double( node.Value().GetIndex()[d] );
+      const double extent = radius / spacing[d] + 2.0;
+      lower[d] = std::min( lower[d], index - extent );
+      upper[d] = std::max( upper[d], index + extent );
+      }
+    }
+
+  typename SpeedImageType::RegionType region;
+  for ( unsigned int d = 0; d < Dimension; ++d )
+    {
+    const double first = double( largestRegion.GetIndex( d ) );
+    const double last = first + double( largestRegion.GetSize( d ) ) - 1.0;
+    const double start = std::max( first, std::floor( lower[d] ) );
+    const double end = std::min( last, std::ceil( upper[d] ) );
+    if ( end < start )
+      {
+      // no trial point is in the image, the filter has nothing to do
+      return false;
+      }
+    region.SetIndex( d, static_cast< typename SpeedImageType::IndexValueType >( start ) );
+    region.SetSize( d, static_cast< typename SpeedImageType::SizeValueType >( end - start + 1.0 ) );
+    }
+  if ( region == largestRegion )
+    {
+    return false;
+    }
+
+  filter->SetOverrideOutputInformation( true );
+  filter->SetOutputRegion( region );
+  filter->SetOutputOrigin( speedImage->GetOrigin() );
+  filter->SetOutputSpacing( spacing );
+  filter->SetOutputDirection( speedImage->GetDirection() );
+  return true;
+}
+
+
+/** \brief Extend the output of a fast marching filter bounded by
+ * BoundFastMarchingOutputRegion to the whole region, with the large
+ * value of the points not reached.
+ */
+template< class TFilter >
+typename TFilter::LevelSetImageType::Pointer
+UncropFastMarching( TFilter *filter, const typename TFilter::LevelSetImageType::RegionType &largestRegion )
+{
+  typedef typename TFilter::LevelSetImageType LevelSetImageType;
+
+  const LevelSetImageType *output = filter->GetOutput();
+  const typename LevelSetImageType::RegionType region = output->GetBufferedRegion();
+
+  typename LevelSetImageType::Pointer uncropped = LevelSetImageType::New();
+  uncropped->CopyInformation( output );
+  uncropped->SetRegions( largestRegion );
+  uncropped->Allocate();
+  uncropped->FillBuffer( filter->GetLargeValue() );
+  ImageAlgorithm::Copy( output, uncropped.GetPointer(), region, region );
+  return uncropped;
+}
+
+} // end namespace simple
+} // end namespace itk
+
+#endif
@@ -0,0 +1,268 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "itkImage.h"
+#include "itkVector.h"
+
+#include <algorithm>
+
+#include "sitkFlattenTransformFilter.h"
+#include "itkAffineTransform.h"
+#include "itkDisplacementFieldTransform.h"
+#include "itkTransformToDisplacementFieldFilter.h"
+
+namespace itk {
+namespace simple {
+
+//-----------------------------------------------------------------------------
+
+//
+// Default constructor that initializes parameters
+//
+FlattenTransformFilter::FlattenTransformFilter ()
+{
+
+  this->m_Size = std::vector<unsigned int>(3, 64);
+  this->m_OutputOrigin = std::vector<double>(3, 0.0);
+  this->m_OutputSpacing = std::vector<double>(3, 1.0);
+  this->m_OutputDirection = std::vector<double>();
+
+  this->m_MaximumError = 0.0;
+  this->m_MeanError = 0.0;
+
+  this->m_MemberFactory.reset( new detail::MemberFunctionFactory<MemberFunctionType>( this ) );
+
+  this->m_MemberFactory->RegisterMemberFunctions< PixelIDTypeList, 3 > ();
+  this->m_MemberFactory->RegisterMemberFunctions< PixelIDTypeList, 2 > ();
+}
+
+//
+// Destructor
+//
+FlattenTransformFilter::~FlattenTransformFilter ()
+{
+
+}
+
+
+FlattenTransformFilter::Self&
+FlattenTransformFilter::SetReferenceImage( const Image & refImage )
+{
+  this->SetSize( refImage.GetSize() );
+  this->SetOutputOrigin( refImage.GetOrigin() );
+  this->SetOutputSpacing( refImage.GetSpacing() );
+  this->SetOutputDirection( refImage.GetDirection() );
+  return *this;
+}
+
+
+//
+// ToString
+//
+std::string FlattenTransformFilter::ToString() const
+{
+  std::ostringstream out;
+  out << "itk::simple::FlattenTransformFilter\n";
+  out << "  Size: ";
+  this->ToStringHelper(out, this->m_Size);
+  out << std::endl;
+  out << "  OutputOrigin: ";
+  this->ToStringHelper(out, this->m_OutputOrigin);
+  out << std::endl;
+  out << "  OutputSpacing: ";
+  this->ToStringHelper(out, this->m_OutputSpacing);
+  out << std::endl;
+  out << "  OutputDirection: ";
+  this->ToStringHelper(out, this->m_OutputDirection);
+  out << std::endl;
+  out << "  MaximumError: ";
+  this->ToStringHelper(out, this->m_MaximumError);
+  out << std::endl;
+  out << "  MeanError: ";
+  this->ToStringHelper(out, this->m_MeanError);
+  out << std::endl;
+
+  out << ProcessObject::ToString();
+  return out.str();
+}
+
+//
+// Execute
+//
+Transform FlattenTransformFilter::Execute ( const Transform & transform,
+                                            const std::vector<unsigned int> & size,
+                                            const std::vector<double> & outputOrigin,
+                                            const std::vector<double> & outputSpacing,
+                                            const std::vector<double> & outputDirection )
+{
+  this->SetSize ( size );
+  this->SetOutputOrigin ( outputOrigin );
+  this->SetOutputSpacing ( outputSpacing );
+  this->SetOutputDirection ( outputDirection );
+
+  return this->Execute ( transform );
+}
+
+
+Transform FlattenTransformFilter::Execute ( const Transform & transform )
+{
+  unsigned int dimension = transform.GetDimension();
+
+  if ( this->m_Size.size() < dimension || this->m_OutputOrigin.size() < dimension || this->m_OutputSpacing.size() < dimension )
+    {
+    sitkExceptionMacro ( "The output grid for FlattenTransformFilter does not match dimension of the transform!" );
+    }
+
+  return this->m_MemberFactory->GetMemberFunction( sitkFloat32, dimension )( transform );
+}
+
+
+//-----------------------------------------------------------------------------
+
+//
+// ExecuteInternal
+//
+template <class TImageType>
+Transform FlattenTransformFilter::ExecuteInternal ( const Transform & inTransform )
+{
+  const unsigned int Dimension = TImageType::ImageDimension;
+
+  typedef itk::Transform<double, Dimension, Dimension>                     TransformType;
+  typedef itk::Image< itk::Vector<double, Dimension>, Dimension >          DisplacementFieldType;
+
+  const TransformType *itkTx = dynamic_cast<const TransformType *>( inTransform.GetITKBase() );
+  if ( !itkTx )
+    {
+    sitkExceptionMacro( "Unexpected error converting transform! Possible miss matching dimensions!" );
+    }
+
+  // the output grid
+  typename DisplacementFieldType::Pointer grid = DisplacementFieldType::New();
+  typename DisplacementFieldType::SizeType size = sitkSTLVectorToITK<typename DisplacementFieldType::SizeType>( this->m_Size );
+  grid->SetOrigin( sitkSTLVectorToITK<typename DisplacementFieldType::PointType>( this->m_OutputOrigin ) );
+  grid->SetSpacing( sitkSTLVectorToITK<typename DisplacementFieldType::SpacingType>( this->m_OutputSpacing ) );
+  grid->SetDirection( sitkSTLToITKDirection<typename DisplacementFieldType::DirectionType>( this->m_OutputDirection ) );
+
+  Transform flattened;
+  const TransformType *itkFlattenedTx = SITK_NULLPTR;
+  if ( itkTx->IsLinear() )
+    {
+    // A composition of linear transforms is an affine transform,
+    // whose matrix and offset are recovered from the mapping of the
+    // origin and the unit vectors.
+    typedef itk::AffineTransform<double, Dimension> AffineTransformType;
+    typename AffineTransformType::Pointer affine = AffineTransformType::New();
+
+    typename TransformType::InputPointType point;
+    point.Fill( 0.0 );
+    const typename TransformType::OutputPointType mappedOrigin = itkTx->TransformPoint( point );
+
+    typename AffineTransformType::MatrixType matrix;
+    for ( unsigned int j = 0; j < Dimension; ++j )
+      {
+      point.Fill( 0.0 );
+      point[j] = 1.0;
+      const typename TransformType::OutputPointType mappedPoint = itkTx->TransformPoint( point );
+      for ( unsigned int i = 0; i < Dimension; ++i )
+        {
+        matrix[i][j] = mappedPoint[i] - mappedOrigin[i];
+        }
+      }
+    typename AffineTransformType::OutputVectorType offset;
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      offset[i] = mappedOrigin[i];
+      }
+    affine->SetMatrix( matrix );
+    affine->SetOffset( offset );
+
+    flattened = Transform( affine.GetPointer() );
+    }
+  else
+    {
+    typedef itk::TransformToDisplacementFieldFilter<DisplacementFieldType, double> FilterType;
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetTransform( itkTx );
+    filter->SetSize( size );
+    filter->SetOutputOrigin( grid->GetOrigin() );
+    filter->SetOutputSpacing( grid->GetSpacing() );
+    filter->SetOutputDirection( grid->GetDirection() );
+
+    this->PreUpdate( filter.GetPointer() );
+
+    filter->Update();
+
+    typedef itk::DisplacementFieldTransform<double, Dimension> DisplacementFieldTransformType;
+    typename DisplacementFieldTransformType::Pointer displacementTx = DisplacementFieldTransformType::New();
+    displacementTx->SetDisplacementField( filter->GetOutput() );
+
+    flattened = Transform( displacementTx.GetPointer() );
+    }
+  itkFlattenedTx = dynamic_cast<const TransformType *>( flattened.GetITKBase() );
+  assert( itkFlattenedTx );
+
+  // Measure the error at the centers of the grid cells, where the
+  // interpolation of a displacement field is the least accurate.
+  typename DisplacementFieldType::SizeType cellsSize;
+  itk::SizeValueType numberOfCells = 1;
+  for ( unsigned int i = 0; i < Dimension; ++i )
+    {
+    cellsSize[i] = ( size[i] > 1 ) ? size[i] - 1 : 1;
+    numberOfCells *= cellsSize[i];
+    }
+
+  double maximumError = 0.0;
+  double sumError = 0.0;
+  for ( itk::SizeValueType n = 0; n < numberOfCells; ++n )
+    {
+    itk::ContinuousIndex<double, Dimension> cellCenter;
+    itk::SizeValueType remainder = n;
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      cellCenter[i] = static_cast<double>( remainder % cellsSize[i] ) + ( ( size[i] > 1 ) ? 0.5 : 0.0 );
+      remainder /= cellsSize[i];
+      }
+    typename DisplacementFieldType::PointType point;
+    grid->TransformContinuousIndexToPhysicalPoint( cellCenter, point );
+
+    const double error = itkTx->TransformPoint( point ).EuclideanDistanceTo( itkFlattenedTx->TransformPoint( point ) );
+    maximumError = std::max( maximumError, error );
+    sumError += error;
+    }
+  this->m_MaximumError = maximumError;
+  this->m_MeanError = sumError / numberOfCells;
+
+  return flattened;
+}
+
+//-----------------------------------------------------------------------------
+
+
+//
+// Function to run the Execute method of this filter
+//
+Transform FlattenTransform ( const Transform & transform, const Image & referenceImage )
+{
+  FlattenTransformFilter filter;
+  filter.SetReferenceImage( referenceImage );
+  return filter.Execute ( transform );
+}
+
+
+} // end namespace simple
+} // end namespace itk
@@ -0,0 +1,225 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "itkImage.h"
+#include "itkNumericTraits.h"
+
+#include "sitkGaussianScaleSpaceFilter.h"
+#include "itkCastImageFilter.h"
+#include "itkDiscreteGaussianImageFilter.h"
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include "itkShrinkImageFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk {
+namespace simple {
+
+//-----------------------------------------------------------------------------
+
+//
+// Default constructor that initializes parameters
+//
+GaussianScaleSpaceFilter::GaussianScaleSpaceFilter ()
+{
+  const double sigmas[] = { 1.0, 2.0, 4.0 };
+  this->m_Sigmas = std::vector<double>( sigmas, sigmas + 3 );
+  this->m_InputSigma = 0.0;
+  this->m_ShrinkPerOctave = false;
+
+  this->m_MemberFactory.reset( new detail::MemberFunctionFactory<MemberFunctionType>( this ) );
+
+  this->m_MemberFactory->RegisterMemberFunctions< PixelIDTypeList, 3 > ();
+  this->m_MemberFactory->RegisterMemberFunctions< PixelIDTypeList, 2 > ();
+}
+
+//
+// Destructor
+//
+GaussianScaleSpaceFilter::~GaussianScaleSpaceFilter ()
+{
+}
+
+
+//
+// ToString
+//
+std::string GaussianScaleSpaceFilter::ToString() const
+{
+  std::ostringstream out;
+  out << "itk::simple::GaussianScaleSpaceFilter\n";
+  out << "  Sigmas: ";
+  this->ToStringHelper(out, this->m_Sigmas);
+  out << std::endl;
+  out << "  InputSigma: ";
+  this->ToStringHelper(out, this->m_InputSigma);
+  out << std::endl;
+  out << "  ShrinkPerOctave: ";
+  this->ToStringHelper(out, this->m_ShrinkPerOctave);
+  out << std::endl;
+  out << "  ShrinkFactors: ";
+  this->ToStringHelper(out, this->m_ShrinkFactors);
+  out << std::endl;
+
+  out << ProcessObject::ToString();
+  return out.str();
+}
+
+
+//
+// Execute
+//
+std::vector<Image> GaussianScaleSpaceFilter::Execute ( const Image & image )
+{
+  PixelIDValueEnum type = image.GetPixelID();
+  unsigned int dimension = image.GetDimension();
+
+  if ( this->m_Sigmas.empty() )
+    {
+    sitkExceptionMacro( "At least one sigma is required!" );
+    }
+  double previousSigma = this->m_InputSigma;
+  for ( size_t i = 0; i < this->m_Sigmas.size(); ++i )
+    {
+    if ( !( this->m_Sigmas[i] >= previousSigma ) )
+      {
+      sitkExceptionMacro( "The sigmas must be increasing and not less than the InputSigma!" );
+      }
+    previousSigma = this->m_Sigmas[i];
+    }
+
+  return this->m_MemberFactory->GetMemberFunction( type, dimension )( image );
+}
+
+
+//-----------------------------------------------------------------------------
+
+//
+// ExecuteInternal
+//
+template <class TImageType>
+std::vector<Image> GaussianScaleSpaceFilter::ExecuteInternal ( const Image & inImage )
+{
+  // Define the input and output image types
+  typedef TImageType     InputImageType;
+  const unsigned int Dimension = InputImageType::ImageDimension;
+
+  typedef typename itk::NumericTraits<typename InputImageType::PixelType>::FloatType RealPixelType;
+  typedef itk::Image< RealPixelType, Dimension > RealImageType;
+
+  typedef itk::CastImageFilter<InputImageType, RealImageType>                   CastFilterType;
+  typedef itk::DiscreteGaussianImageFilter<RealImageType, RealImageType>        DiscreteFilterType;
+  typedef itk::SmoothingRecursiveGaussianImageFilter<RealImageType, RealImageType> RecursiveFilterType;
+  typedef itk::ShrinkImageFilter<RealImageType, RealImageType>                  ShrinkFilterType;
+
+  typename CastFilterType::Pointer cast = CastFilterType::New();
+  cast->SetInput( this->CastImageToITK<InputImageType>(inImage) );
+  this->PreUpdate( cast.GetPointer() );
+  cast->Update();
+
+  typename RealImageType::Pointer level = cast->GetOutput();
+  level->DisconnectPipeline();
+
+  std::vector<Image> levels;
+  this->m_ShrinkFactors.clear();
+
+  double previousSigma = this->m_InputSigma;
+  double octaveSigma = 0.0;
+  unsigned int shrinkFactor = 1;
+  for ( size_t i = 0; i < this->m_Sigmas.size(); ++i )
+    {
+    const double sigma = this->m_Sigmas[i];
+    const double increment = std::sqrt( sigma * sigma - previousSigma * previousSigma );
+
+    const typename RealImageType::SpacingType spacing = level->GetSpacing();
+    double smallestSpacing = spacing[0];
+    double largestSpacing = spacing[0];
+    for ( unsigned int d = 1; d < Dimension; ++d )
+      {
+      smallestSpacing = std::min( smallestSpacing, spacing[d] );
+      largestSpacing = std::max( largestSpacing, spacing[d] );
+      }
+
+    if ( increment > 0.0 )
+      {
+      // The kernel of the discrete Gaussian grows with sigma, the
+      // recursive Gaussian costs the same for any sigma but is not
+      // accurate for a sigma of a pixel or less.
+      if ( increment < 2.0 * smallestSpacing )
+        {
+        typename DiscreteFilterType::Pointer smoothing = DiscreteFilterType::New();
+        smoothing->SetInput( level );
+        smoothing->SetVariance( increment * increment );
+        smoothing->SetMaximumError( 0.01 );
+        smoothing->SetMaximumKernelWidth( 64 );
+        smoothing->SetUseImageSpacing( true );
+        this->PreUpdate( smoothing.GetPointer() );
+        smoothing->Update();
+        level = smoothing->GetOutput();
+        }
+      else
+        {
+        typename RecursiveFilterType::Pointer smoothing = RecursiveFilterType::New();
+        smoothing->SetInput( level );
+        smoothing->SetSigma( increment );
+        smoothing->SetNormalizeAcrossScale( false );
+        this->PreUpdate( smoothing.GetPointer() );
+        smoothing->Update();
+        level = smoothing->GetOutput();
+        }
+      level->DisconnectPipeline();
+      }
+
+    levels.push_back( Image( this->CastITKToImage( level.GetPointer() ) ) );
+    this->m_ShrinkFactors.push_back( shrinkFactor );
+    previousSigma = sigma;
+
+    if ( octaveSigma == 0.0 )
+      {
+      octaveSigma = sigma;
+      }
+
+    // The next levels are computed from this level shrunk by 2, when
+    // its blur is still at least half a pixel of the shrunk level.
+    if ( this->m_ShrinkPerOctave && i + 1 < this->m_Sigmas.size()
+         && octaveSigma > 0.0 && sigma >= 2.0 * octaveSigma && sigma >= largestSpacing )
+      {
+      typename ShrinkFilterType::Pointer shrink = ShrinkFilterType::New();
+      shrink->SetInput( level );
+      const typename RealImageType::SizeType size = level->GetLargestPossibleRegion().GetSize();
+      for ( unsigned int d = 0; d < Dimension; ++d )
+        {
+        shrink->SetShrinkFactor( d, ( size[d] > 1 ) ? 2 : 1 );
+        }
+      this->PreUpdate( shrink.GetPointer() );
+      shrink->Update();
+      level = shrink->GetOutput();
+      level->DisconnectPipeline();
+      this->FixNonZeroIndex( level.GetPointer() );
+
+      shrinkFactor *= 2;
+      octaveSigma = sigma;
+      }
+    }
+
+  return levels;
+}
+
+} // end namespace simple
+} // end namespace itk
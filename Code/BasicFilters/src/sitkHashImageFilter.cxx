@@ -30,6 +30,7 @@ namespace itk {
   namespace simple {
     HashImageFilter::HashImageFilter () {
       this->m_HashFunction = SHA1;
+      this->m_IncludeGeometry = false;
 
       this->m_MemberFactory.reset( new detail::MemberFunctionFactory<MemberFunctionType>( this ) );
 
@@ -54,8 +55,12 @@ namespace itk {
         case MD5:
           out << "MD5";
           break;
+        case FAST:
+          out << "FAST";
+          break;
         }
       out << std::endl;
+      out << "IncludeGeometry: " << this->m_IncludeGeometry << std::endl;
       out << ProcessObject::ToString();
       return out.str();
     }
@@ -71,6 +76,17 @@ namespace itk {
       return *this;
       }
 
+    bool HashImageFilter::GetIncludeGeometry() const
+    {
+      return this->m_IncludeGeometry;
+    }
+
+    HashImageFilter& HashImageFilter::SetIncludeGeometry ( bool includeGeometry )
+      {
+      this->m_IncludeGeometry = includeGeometry;
+      return *this;
+      }
+
     std::string HashImageFilter::Execute ( const Image& image ) {
 
       PixelIDValueEnum type = image.GetPixelID();
@@ -116,7 +132,11 @@ namespace itk {
         case MD5:
           hasher->SetHashFunction( HashFilterType::MD5 );
           break;
+        case FAST:
+          hasher->SetHashFunction( HashFilterType::FAST );
+          break;
         }
+      hasher->SetIncludeGeometry( this->m_IncludeGeometry );
 
       this->PreUpdate( hasher.GetPointer() );
 
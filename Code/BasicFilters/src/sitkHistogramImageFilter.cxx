@@ -0,0 +1,582 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "sitkHistogramImageFilter.h"
+#include "sitkExceptionObject.h"
+
+#include "itkImage.h"
+#include "itkImageScanlineConstIterator.h"
+#include "itkImageRegionSplitterSlowDimension.h"
+#include "itkMultiThreader.h"
+#include "itkHistogram.h"
+#include "itkHuangThresholdCalculator.h"
+#include "itkIntermodesThresholdCalculator.h"
+#include "itkIsoDataThresholdCalculator.h"
+#include "itkKittlerIllingworthThresholdCalculator.h"
+#include "itkLiThresholdCalculator.h"
+#include "itkMaximumEntropyThresholdCalculator.h"
+#include "itkMomentsThresholdCalculator.h"
+#include "itkOtsuThresholdCalculator.h"
+#include "itkRenyiEntropyThresholdCalculator.h"
+#include "itkShanbhagThresholdCalculator.h"
+#include "itkTriangleThresholdCalculator.h"
+#include "itkYenThresholdCalculator.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace itk {
+namespace simple {
+
+namespace
+{
+
+template <class TImageType, class TImageType2>
+struct HistogramThreadStruct
+{
+  typedef typename TImageType::RegionType                  RegionType;
+  typedef itk::Image<uint8_t, TImageType::ImageDimension> MaskImageType;
+
+  const TImageType        *m_Image1;
+  // null for the histogram of one image
+  const TImageType2       *m_Image2;
+  // null without a mask
+  const MaskImageType     *m_MaskImage;
+  std::vector<RegionType>  m_Regions;
+
+  // the first pass computes the range of the pixels of each thread,
+  // two values per thread
+  bool                     m_ComputeRange;
+  std::vector<double>      m_Minimum;
+  std::vector<double>      m_Maximum;
+
+  // the range of the bins of each image, and the bins per unit
+  unsigned int             m_NumberOfBins;
+  double                   m_Lower[2];
+  double                   m_Upper[2];
+  double                   m_Scale[2];
+  std::vector< std::vector<uint64_t> > m_Counts;
+};
+
+
+// The bin of a value, returns false for the values outside of the
+// range and NaN. The maximum is in the last bin.
+inline bool ComputeBin( double value, double lower, double upper, double scale,
+                        unsigned int numberOfBins, SizeValueType &bin )
+{
+  if ( !( value >= lower && value <= upper ) )
+    {
+    return false;
+    }
+  bin = std::min( static_cast<SizeValueType>( ( value - lower ) * scale ),
+                  static_cast<SizeValueType>( numberOfBins - 1 ) );
+  return true;
+}
+
+
+template <class TImageType, class TImageType2>
+ITK_THREAD_RETURN_TYPE HistogramThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  typedef HistogramThreadStruct<TImageType, TImageType2> StructType;
+  typedef typename StructType::MaskImageType            MaskImageType;
+
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  StructType *str = static_cast<StructType *>( info->UserData );
+
+  const typename StructType::RegionType &region = str->m_Regions[info->ThreadID];
+  const bool joint = str->m_Image2 != SITK_NULLPTR;
+  const bool mask = str->m_MaskImage != SITK_NULLPTR;
+  const bool computeRange = str->m_ComputeRange;
+
+  typedef itk::ImageScanlineConstIterator<TImageType>    IteratorType;
+  typedef itk::ImageScanlineConstIterator<TImageType2>   IteratorType2;
+  typedef itk::ImageScanlineConstIterator<MaskImageType> MaskIteratorType;
+
+  IteratorType it( str->m_Image1, region );
+  IteratorType2 it2;
+  if ( joint )
+    {
+    it2 = IteratorType2( str->m_Image2, region );
+    }
+  MaskIteratorType maskIt;
+  if ( mask )
+    {
+    maskIt = MaskIteratorType( str->m_MaskImage, region );
+    }
+
+  double *minimum = &str->m_Minimum[2*info->ThreadID];
+  double *maximum = &str->m_Maximum[2*info->ThreadID];
+  uint64_t *counts = computeRange ? SITK_NULLPTR : &str->m_Counts[info->ThreadID][0];
+  const unsigned int numberOfBins = str->m_NumberOfBins;
+
+  while ( !it.IsAtEnd() )
+    {
+    while ( !it.IsAtEndOfLine() )
+      {
+      if ( !mask || maskIt.Get() != 0 )
+        {
+        const double value = static_cast<double>( it.Get() );
+        const double value2 = joint ? static_cast<double>( it2.Get() ) : 0.0;
+        if ( computeRange )
+          {
+          // NaN is ignored by the comparisons
+          minimum[0] = std::min( minimum[0], value );
+          maximum[0] = std::max( maximum[0], value );
+          minimum[1] = std::min( minimum[1], value2 );
+          maximum[1] = std::max( maximum[1], value2 );
+          }
+        else
+          {
+          SizeValueType bin;
+          SizeValueType bin2 = 0;
+          if ( ComputeBin( value, str->m_Lower[0], str->m_Upper[0], str->m_Scale[0], numberOfBins, bin ) &&
+               ( !joint || ComputeBin( value2, str->m_Lower[1], str->m_Upper[1], str->m_Scale[1], numberOfBins, bin2 ) ) )
+            {
+            ++counts[bin*( joint ? numberOfBins : 1 ) + bin2];
+            }
+          }
+        }
+
+      ++it;
+      if ( joint )
+        {
+        ++it2;
+        }
+      if ( mask )
+        {
+        ++maskIt;
+        }
+      }
+
+    it.NextLine();
+    if ( joint )
+      {
+      it2.NextLine();
+      }
+    if ( mask )
+      {
+      maskIt.NextLine();
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+typedef itk::Statistics::Histogram<double> ThresholdHistogramType;
+
+template <class TCalculatorType>
+double RunThresholdCalculator( const ThresholdHistogramType *histogram )
+{
+  typename TCalculatorType::Pointer calculator = TCalculatorType::New();
+  calculator->SetInput( histogram );
+  calculator->Update();
+  return static_cast<double>( calculator->GetThreshold() );
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+//
+// Default constructor that initializes parameters
+//
+HistogramImageFilter::HistogramImageFilter ()
+{
+  this->m_NumberOfBins = 256;
+  this->m_AutoMinimumMaximum = true;
+  this->m_MaskImage = SITK_NULLPTR;
+  this->m_Joint = false;
+  this->m_NumberOfPixels = 0;
+
+  this->m_DualMemberFactory.reset( new detail::DualMemberFunctionFactory<MemberFunctionType>( this ) );
+
+  this->m_DualMemberFactory->RegisterMemberFunctions< PixelIDTypeList, PixelIDTypeList, 3 > ();
+  this->m_DualMemberFactory->RegisterMemberFunctions< PixelIDTypeList, PixelIDTypeList, 2 > ();
+}
+
+//
+// Destructor
+//
+HistogramImageFilter::~HistogramImageFilter ()
+{
+
+}
+
+
+//
+// ToString
+//
+std::string HistogramImageFilter::ToString() const
+{
+  std::ostringstream out;
+  out << "itk::simple::HistogramImageFilter\n";
+  out << "  NumberOfBins: ";
+  this->ToStringHelper(out, this->m_NumberOfBins);
+  out << std::endl;
+  out << "  AutoMinimumMaximum: ";
+  this->ToStringHelper(out, this->m_AutoMinimumMaximum);
+  out << std::endl;
+  out << "  HistogramMinimum: ";
+  this->ToStringHelper(out, this->m_HistogramMinimum);
+  out << std::endl;
+  out << "  HistogramMaximum: ";
+  this->ToStringHelper(out, this->m_HistogramMaximum);
+  out << std::endl;
+  out << "  NumberOfPixels: " << this->m_NumberOfPixels;
+  out << std::endl;
+
+  out << ProcessObject::ToString();
+  return out.str();
+}
+
+
+//
+// Execute
+//
+void HistogramImageFilter::Execute ( const Image & image )
+{
+  this->Dispatch( image, image, SITK_NULLPTR, false );
+}
+
+
+void HistogramImageFilter::Execute ( const Image & image, const Image & maskImage )
+{
+  this->Dispatch( image, image, &maskImage, false );
+}
+
+
+void HistogramImageFilter::ExecuteJoint ( const Image & image1, const Image & image2 )
+{
+  this->Dispatch( image1, image2, SITK_NULLPTR, true );
+}
+
+
+void HistogramImageFilter::ExecuteJoint ( const Image & image1, const Image & image2, const Image & maskImage )
+{
+  this->Dispatch( image1, image2, &maskImage, true );
+}
+
+
+void HistogramImageFilter::Dispatch ( const Image & image1, const Image & image2, const Image * maskImage, bool joint )
+{
+  if ( this->m_NumberOfBins == 0 )
+    {
+    sitkExceptionMacro ( "The number of bins must be positive!" );
+    }
+  if ( image1.GetDimension() != image2.GetDimension() ||
+       image1.GetSize() != image2.GetSize() )
+    {
+    sitkExceptionMacro ( "The images of a joint histogram must have the same size!" );
+    }
+  if ( maskImage )
+    {
+    if ( maskImage->GetPixelID() != sitkUInt8 )
+      {
+      sitkExceptionMacro ( "The mask image must be of the sitkUInt8 pixel type!" );
+      }
+    if ( maskImage->GetDimension() != image1.GetDimension() ||
+         maskImage->GetSize() != image1.GetSize() )
+      {
+      sitkExceptionMacro ( "The mask image must have the size of the image!" );
+      }
+    }
+
+  const size_t numberOfImages = joint ? 2 : 1;
+  if ( !this->m_AutoMinimumMaximum )
+    {
+    if ( this->m_HistogramMinimum.size() != numberOfImages ||
+         this->m_HistogramMaximum.size() != numberOfImages )
+      {
+      sitkExceptionMacro ( "The HistogramMinimum and HistogramMaximum must have one value per image!" );
+      }
+    for ( size_t i = 0; i < numberOfImages; ++i )
+      {
+      if ( !( this->m_HistogramMinimum[i] <= this->m_HistogramMaximum[i] ) )
+        {
+        sitkExceptionMacro ( "The HistogramMinimum must not be greater than the HistogramMaximum!" );
+        }
+      }
+    }
+
+  this->m_MaskImage = maskImage;
+  this->m_Joint = joint;
+  this->m_DualMemberFactory->GetMemberFunction( image1.GetPixelID(),
+                                                image2.GetPixelID(),
+                                                image1.GetDimension() )( image1, image2 );
+  this->m_MaskImage = SITK_NULLPTR;
+}
+
+
+//
+// DualExecuteInternal
+//
+template <class TImageType, class TImageType2>
+void HistogramImageFilter::DualExecuteInternal ( const Image & inImage1, const Image & inImage2 )
+{
+  typedef TImageType  ImageType;
+  typedef TImageType2 ImageType2;
+
+  typedef HistogramThreadStruct<ImageType, ImageType2> StructType;
+  typedef typename StructType::MaskImageType          MaskImageType;
+
+  const unsigned int numberOfImages = this->m_Joint ? 2 : 1;
+
+  StructType str;
+  str.m_Image1 = dynamic_cast<const ImageType *>( inImage1.GetITKBase() );
+  str.m_Image2 = SITK_NULLPTR;
+  if ( this->m_Joint )
+    {
+    str.m_Image2 = dynamic_cast<const ImageType2 *>( inImage2.GetITKBase() );
+    }
+  str.m_MaskImage = SITK_NULLPTR;
+  if ( this->m_MaskImage )
+    {
+    str.m_MaskImage = dynamic_cast<const MaskImageType *>( this->m_MaskImage->GetITKBase() );
+    }
+
+  // split the image along the slowest axis, each part is counted
+  // by a thread
+  const typename ImageType::RegionType region = str.m_Image1->GetBufferedRegion();
+  itk::ImageRegionSplitterSlowDimension::Pointer splitter = itk::ImageRegionSplitterSlowDimension::New();
+  const unsigned int numberOfSplits = splitter->GetNumberOfSplits( region, std::max( 1u, this->GetNumberOfThreads() ) );
+
+  str.m_Regions.resize( numberOfSplits, region );
+  for ( unsigned int i = 0; i < numberOfSplits; ++i )
+    {
+    splitter->GetSplit( i, numberOfSplits, str.m_Regions[i] );
+    }
+  str.m_NumberOfBins = this->m_NumberOfBins;
+  str.m_Minimum.assign( 2*numberOfSplits, std::numeric_limits<double>::infinity() );
+  str.m_Maximum.assign( 2*numberOfSplits, -std::numeric_limits<double>::infinity() );
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfSplits ) );
+  threader->SetSingleMethod( HistogramThreaderCallback<ImageType, ImageType2>, &str );
+
+  if ( this->m_AutoMinimumMaximum )
+    {
+    str.m_ComputeRange = true;
+    threader->SingleMethodExecute();
+
+    for ( unsigned int i = 0; i < numberOfImages; ++i )
+      {
+      str.m_Lower[i] = std::numeric_limits<double>::infinity();
+      str.m_Upper[i] = -std::numeric_limits<double>::infinity();
+      for ( unsigned int t = 0; t < numberOfSplits; ++t )
+        {
+        str.m_Lower[i] = std::min( str.m_Lower[i], str.m_Minimum[2*t+i] );
+        str.m_Upper[i] = std::max( str.m_Upper[i], str.m_Maximum[2*t+i] );
+        }
+      // no pixel is counted
+      if ( str.m_Lower[i] > str.m_Upper[i] )
+        {
+        str.m_Lower[i] = str.m_Upper[i] = 0.0;
+        }
+      }
+    }
+  else
+    {
+    for ( unsigned int i = 0; i < numberOfImages; ++i )
+      {
+      str.m_Lower[i] = this->m_HistogramMinimum[i];
+      str.m_Upper[i] = this->m_HistogramMaximum[i];
+      }
+    }
+
+  for ( unsigned int i = 0; i < numberOfImages; ++i )
+    {
+    str.m_Scale[i] = 0.0;
+    if ( str.m_Upper[i] > str.m_Lower[i] )
+      {
+      str.m_Scale[i] = this->m_NumberOfBins / ( str.m_Upper[i] - str.m_Lower[i] );
+      }
+    }
+
+  const size_t numberOfCounts = this->m_Joint ? size_t( this->m_NumberOfBins ) * this->m_NumberOfBins : this->m_NumberOfBins;
+  str.m_ComputeRange = false;
+  str.m_Counts.assign( numberOfSplits, std::vector<uint64_t>( numberOfCounts, 0 ) );
+  threader->SingleMethodExecute();
+
+  this->m_Counts.assign( numberOfCounts, 0 );
+  for ( unsigned int t = 0; t < numberOfSplits; ++t )
+    {
+    for ( size_t i = 0; i < numberOfCounts; ++i )
+      {
+      this->m_Counts[i] += str.m_Counts[t][i];
+      }
+    std::vector<uint64_t>().swap( str.m_Counts[t] );
+    }
+
+  this->m_NumberOfPixels = 0;
+  for ( size_t i = 0; i < numberOfCounts; ++i )
+    {
+    this->m_NumberOfPixels += this->m_Counts[i];
+    }
+
+  this->m_BinEdges.assign( numberOfImages, std::vector<double>( this->m_NumberOfBins + 1 ) );
+  for ( unsigned int i = 0; i < numberOfImages; ++i )
+    {
+    const double width = ( str.m_Upper[i] - str.m_Lower[i] ) / this->m_NumberOfBins;
+    for ( unsigned int b = 0; b < this->m_NumberOfBins; ++b )
+      {
+      this->m_BinEdges[i][b] = str.m_Lower[i] + b * width;
+      }
+    this->m_BinEdges[i][this->m_NumberOfBins] = str.m_Upper[i];
+    }
+}
+
+
+std::vector<double> HistogramImageFilter::GetBinEdges( unsigned int image ) const
+{
+  if ( image >= this->m_BinEdges.size() )
+    {
+    sitkExceptionMacro ( "The histogram of the last execution has no image " << image << "!" );
+    }
+  return this->m_BinEdges[image];
+}
+
+
+double HistogramImageFilter::ComputeThreshold( ThresholdMethodType method ) const
+{
+  if ( this->m_BinEdges.size() != 1 )
+    {
+    sitkExceptionMacro ( "A threshold is computed from the histogram of one image!" );
+    }
+  return ComputeThreshold( this->m_Counts, this->m_BinEdges[0], method );
+}
+
+
+double HistogramImageFilter::ComputePercentile( double percentile ) const
+{
+  if ( this->m_BinEdges.size() != 1 )
+    {
+    sitkExceptionMacro ( "A percentile is computed from the histogram of one image!" );
+    }
+  return ComputePercentile( this->m_Counts, this->m_BinEdges[0], percentile );
+}
+
+
+double HistogramImageFilter::ComputePercentile( const std::vector<uint64_t> & counts,
+                                                const std::vector<double> & binEdges,
+                                                double percentile )
+{
+  if ( counts.empty() || binEdges.size() != counts.size() + 1 )
+    {
+    sitkExceptionMacro ( "The histogram must have one more bin edge than counts!" );
+    }
+  if ( !( percentile >= 0.0 && percentile <= 100.0 ) )
+    {
+    sitkExceptionMacro ( "The percentile " << percentile << " is not between 0 and 100!" );
+    }
+
+  uint64_t total = 0;
+  for ( size_t i = 0; i < counts.size(); ++i )
+    {
+    total += counts[i];
+    }
+  if ( total == 0 )
+    {
+    sitkExceptionMacro ( "The histogram is empty!" );
+    }
+
+  // the rank of the percentile among the counted pixels, which are
+  // spread evenly inside of their bin
+  const double rank = percentile / 100.0 * static_cast<double>( total );
+  double cumulative = 0.0;
+  size_t last = 0;
+  for ( size_t i = 0; i < counts.size(); ++i )
+    {
+    if ( counts[i] == 0 )
+      {
+      continue;
+      }
+    const double count = static_cast<double>( counts[i] );
+    if ( cumulative + count >= rank )
+      {
+      return binEdges[i] + ( rank - cumulative ) / count * ( binEdges[i+1] - binEdges[i] );
+      }
+    cumulative += count;
+    last = i;
+    }
+  return binEdges[last+1];
+}
+
+
+double HistogramImageFilter::ComputeThreshold( const std::vector<uint64_t> & counts,
+                                               const std::vector<double> & binEdges,
+                                               ThresholdMethodType method )
+{
+  if ( counts.empty() || binEdges.size() != counts.size() + 1 )
+    {
+    sitkExceptionMacro ( "The histogram must have one more bin edge than counts!" );
+    }
+
+  typedef ThresholdHistogramType HistogramType;
+  HistogramType::Pointer histogram = HistogramType::New();
+  histogram->SetMeasurementVectorSize( 1 );
+  HistogramType::SizeType size( 1 );
+  size[0] = counts.size();
+  histogram->Initialize( size );
+
+  uint64_t total = 0;
+  for ( size_t i = 0; i < counts.size(); ++i )
+    {
+    histogram->SetBinMin( 0, i, binEdges[i] );
+    histogram->SetBinMax( 0, i, binEdges[i+1] );
+    histogram->SetFrequency( i, static_cast<HistogramType::AbsoluteFrequencyType>( counts[i] ) );
+    total += counts[i];
+    }
+  if ( total == 0 )
+    {
+    sitkExceptionMacro ( "The histogram is empty!" );
+    }
+
+  switch ( method )
+    {
+    case HUANG:
+      return RunThresholdCalculator< itk::HuangThresholdCalculator<HistogramType, double> >( histogram );
+    case INTERMODES:
+      return RunThresholdCalculator< itk::IntermodesThresholdCalculator<HistogramType, double> >( histogram );
+    case ISO_DATA:
+      return RunThresholdCalculator< itk::IsoDataThresholdCalculator<HistogramType, double> >( histogram );
+    case KITTLER_ILLINGWORTH:
+      return RunThresholdCalculator< itk::KittlerIllingworthThresholdCalculator<HistogramType, double> >( histogram );
+    case LI:
+      return RunThresholdCalculator< itk::LiThresholdCalculator<HistogramType, double> >( histogram );
+    case MAXIMUM_ENTROPY:
+      return RunThresholdCalculator< itk::MaximumEntropyThresholdCalculator<HistogramType, double> >( histogram );
+    case MOMENTS:
+      return RunThresholdCalculator< itk::MomentsThresholdCalculator<HistogramType, double> >( histogram );
+    case OTSU:
+      return RunThresholdCalculator< itk::OtsuThresholdCalculator<HistogramType, double> >( histogram );
+    case RENYI_ENTROPY:
+      return RunThresholdCalculator< itk::RenyiEntropyThresholdCalculator<HistogramType, double> >( histogram );
+    case SHANBHAG:
+      return RunThresholdCalculator< itk::ShanbhagThresholdCalculator<HistogramType, double> >( histogram );
+    case TRIANGLE:
+      return RunThresholdCalculator< itk::TriangleThresholdCalculator<HistogramType, double> >( histogram );
+    case YEN:
+      return RunThresholdCalculator< itk::YenThresholdCalculator<HistogramType, double> >( histogram );
+    }
+  sitkExceptionMacro ( "Unknown threshold method " << method << "!" );
+}
+
+}
+}
@@ -0,0 +1,329 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkImageAccumulator.h"
+#include "sitkMemberFunctionFactory.h"
+#include "sitkExceptionObject.h"
+
+#include "itkImage.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <sstream>
+
+namespace itk {
+  namespace simple {
+
+    namespace
+    {
+
+    typedef std::vector<uint64_t>                LabelsType;
+    typedef std::vector< std::vector<uint16_t> > VotesType;
+
+    typedef void (*FoldFunctionType)( const void *input, void *state, size_t n );
+    typedef void (*VoteFunctionType)( const void *input, size_t n, LabelsType &labels, VotesType &votes );
+    typedef void (*WriteVotingFunctionType)( const LabelsType &labels, const VotesType &votes,
+                                             uint64_t undecided, void *output, size_t n );
+
+    template <typename TElement>
+    void FoldSum( const void *input, void *state, size_t n )
+    {
+      const TElement *in = static_cast<const TElement *>( input );
+      TElement *out = static_cast<TElement *>( state );
+      for ( size_t i = 0; i < n; ++i )
+        {
+        out[i] = static_cast<TElement>( out[i] + in[i] );
+        }
+    }
+
+    template <typename TElement>
+    void FoldMaximum( const void *input, void *state, size_t n )
+    {
+      const TElement *in = static_cast<const TElement *>( input );
+      TElement *out = static_cast<TElement *>( state );
+      for ( size_t i = 0; i < n; ++i )
+        {
+        out[i] = std::max( out[i], in[i] );
+        }
+    }
+
+    template <typename TElement>
+    void Vote( const void *input, size_t n, LabelsType &labels, VotesType &votes )
+    {
+      const TElement *in = static_cast<const TElement *>( input );
+
+      // the labels are mostly the same for neighbor pixels, so the
+      // slot of the previous label is looked up first
+      TElement lastLabel = 0;
+      size_t lastSlot = labels.size();
+      for ( size_t i = 0; i < n; ++i )
+        {
+        if ( lastSlot == labels.size() || in[i] != lastLabel )
+          {
+          lastLabel = in[i];
+          lastSlot = static_cast<size_t>( std::find( labels.begin(), labels.end(), static_cast<uint64_t>( lastLabel ) ) - labels.begin() );
+          if ( lastSlot == labels.size() )
+            {
+            labels.push_back( lastLabel );
+            votes.push_back( std::vector<uint16_t>( n, 0 ) );
+            }
+          }
+        ++votes[lastSlot][i];
+        }
+    }
+
+    template <typename TElement>
+    void WriteVoting( const LabelsType &labels, const VotesType &votes,
+                      uint64_t undecided, void *output, size_t n )
+    {
+      TElement *out = static_cast<TElement *>( output );
+
+      // the maximum number of votes of each pixel, and if it is a tie
+      std::vector<uint16_t> best( n, 0 );
+      std::vector<unsigned char> tie( n, 0 );
+      for ( size_t s = 0; s < labels.size(); ++s )
+        {
+        const TElement label = static_cast<TElement>( labels[s] );
+        const uint16_t *v = &votes[s][0];
+        for ( size_t i = 0; i < n; ++i )
+          {
+          if ( v[i] > best[i] )
+            {
+            best[i] = v[i];
+            tie[i] = 0;
+            out[i] = label;
+            }
+          else if ( v[i] == best[i] && v[i] != 0 )
+            {
+            tie[i] = 1;
+            }
+          }
+        }
+
+      // as the LabelVotingImageFilter, the label wraps in the pixel type
+      const TElement undecidedLabel = static_cast<TElement>( undecided );
+      for ( size_t i = 0; i < n; ++i )
+        {
+        if ( tie[i] )
+          {
+          out[i] = undecidedLabel;
+          }
+        }
+    }
+
+    struct AccumulatorFunctions
+    {
+      FoldFunctionType        m_Sum;
+      FoldFunctionType        m_Maximum;
+      VoteFunctionType        m_Vote;
+      WriteVotingFunctionType m_WriteVoting;
+    };
+
+    // Selects the functions for a pixel type
+    class AccumulatorFunctionsSelector
+    {
+    public:
+      typedef AccumulatorFunctionsSelector Self;
+      typedef AccumulatorFunctions (Self::*MemberFunctionType)( void );
+
+      AccumulatorFunctionsSelector( unsigned int dimension )
+        : m_Dimension( dimension ),
+          m_MemberFactory( this )
+        {
+          m_MemberFactory.RegisterMemberFunctions< ImageAccumulator::PixelIDTypeList, 4 > ();
+          m_MemberFactory.RegisterMemberFunctions< ImageAccumulator::PixelIDTypeList, 3 > ();
+          m_MemberFactory.RegisterMemberFunctions< ImageAccumulator::PixelIDTypeList, 2 > ();
+        }
+
+      AccumulatorFunctions Select( PixelIDValueEnum pixelID )
+        {
+          return m_MemberFactory.GetMemberFunction( pixelID, m_Dimension )();
+        }
+
+      template <class TImageType>
+      AccumulatorFunctions ExecuteInternal( void )
+        {
+          typedef typename TImageType::PixelType ElementType;
+          AccumulatorFunctions f;
+          f.m_Sum = &FoldSum<ElementType>;
+          f.m_Maximum = &FoldMaximum<ElementType>;
+          // the labels are unsigned integers
+          const bool isLabel = std::numeric_limits<ElementType>::is_integer && !std::numeric_limits<ElementType>::is_signed;
+          f.m_Vote = isLabel ? &Vote<ElementType> : SITK_NULLPTR;
+          f.m_WriteVoting = isLabel ? &WriteVoting<ElementType> : SITK_NULLPTR;
+          return f;
+        }
+
+    private:
+      unsigned int                                      m_Dimension;
+      detail::MemberFunctionFactory<MemberFunctionType> m_MemberFactory;
+    };
+
+    }
+
+
+    ImageAccumulator::ImageAccumulator( OperationType operation )
+      : m_Operation( operation ),
+        m_LabelForUndecidedPixels( 0 ),
+        m_HasLabelForUndecidedPixels( false ),
+        m_NumberOfImages( 0 )
+    {
+    }
+
+    ImageAccumulator::~ImageAccumulator()
+    {
+    }
+
+    ImageAccumulator &ImageAccumulator::SetOperation ( OperationType operation )
+    {
+      this->m_Operation = operation;
+      return this->Reset();
+    }
+
+    ImageAccumulator &ImageAccumulator::SetLabelForUndecidedPixels ( uint64_t label )
+    {
+      this->m_LabelForUndecidedPixels = label;
+      this->m_HasLabelForUndecidedPixels = true;
+      return *this;
+    }
+
+    ImageAccumulator &ImageAccumulator::Reset ( )
+    {
+      this->m_NumberOfImages = 0;
+      this->m_State = Image();
+      this->m_Labels.clear();
+      VotesType().swap( this->m_Votes );
+      return *this;
+    }
+
+    ImageAccumulator &ImageAccumulator::AddImage ( const Image &image )
+    {
+      if ( this->m_NumberOfImages > 0 )
+        {
+        if ( image.GetSize() != this->m_State.GetSize() )
+          {
+          sitkExceptionMacro( "The size of the image " << this->m_NumberOfImages << " does not match the size of the first image!" );
+          }
+        if ( image.GetPixelID() != this->m_State.GetPixelID() )
+          {
+          sitkExceptionMacro( "The pixel type of the image " << this->m_NumberOfImages
+                              << " is " << image.GetPixelIDTypeAsString()
+                              << ", not " << this->m_State.GetPixelIDTypeAsString() << " as the first image!" );
+          }
+        }
+
+      AccumulatorFunctionsSelector selector( image.GetDimension() );
+      const AccumulatorFunctions functions = selector.Select( image.GetPixelID() );
+      const size_t n = static_cast<size_t>( image.GetNumberOfPixels() );
+
+      switch ( this->m_Operation )
+        {
+        case Sum:
+        case Maximum:
+          if ( this->m_NumberOfImages == 0 )
+            {
+            // the first image is shared until the second is folded
+            this->m_State = image;
+            }
+          else
+            {
+            FoldFunctionType fold = ( this->m_Operation == Sum ) ? functions.m_Sum : functions.m_Maximum;
+            fold( image.GetBufferAsVoid(), this->m_State.GetBufferAsVoid(), n );
+            }
+          break;
+        case LabelVoting:
+          if ( functions.m_Vote == SITK_NULLPTR )
+            {
+            sitkExceptionMacro( "The LabelVoting is for images of unsigned integer pixels, not "
+                                << image.GetPixelIDTypeAsString() << "!" );
+            }
+          if ( this->m_NumberOfImages == std::numeric_limits<uint16_t>::max() )
+            {
+            sitkExceptionMacro( "At most " << std::numeric_limits<uint16_t>::max() << " images are voted!" );
+            }
+          if ( this->m_NumberOfImages == 0 )
+            {
+            this->m_State = image;
+            }
+          functions.m_Vote( image.GetBufferAsVoid(), n, this->m_Labels, this->m_Votes );
+          break;
+        }
+
+      ++this->m_NumberOfImages;
+      return *this;
+    }
+
+    Image ImageAccumulator::GetResult ( )
+    {
+      if ( this->m_NumberOfImages == 0 )
+        {
+        sitkExceptionMacro( "No image has been added!" );
+        }
+
+      if ( this->m_Operation != LabelVoting )
+        {
+        return this->m_State;
+        }
+
+      if ( !this->m_HasLabelForUndecidedPixels )
+        {
+        this->m_LabelForUndecidedPixels = *std::max_element( this->m_Labels.begin(), this->m_Labels.end() ) + 1;
+        }
+
+      const Image &reference = this->m_State;
+      Image output( reference.GetSize(), reference.GetPixelID(), 0u, Image::NoBufferInitialization );
+      output.SetOrigin( reference.GetOrigin() );
+      output.SetSpacing( reference.GetSpacing() );
+      output.SetDirection( reference.GetDirection() );
+
+      AccumulatorFunctionsSelector selector( reference.GetDimension() );
+      selector.Select( reference.GetPixelID() ).m_WriteVoting( this->m_Labels,
+                                                               this->m_Votes,
+                                                               this->m_LabelForUndecidedPixels,
+                                                               output.GetBufferAsVoid(),
+                                                               static_cast<size_t>( output.GetNumberOfPixels() ) );
+      return output;
+    }
+
+    std::string ImageAccumulator::ToString() const
+    {
+      std::ostringstream out;
+      out << "itk::simple::ImageAccumulator" << std::endl;
+      out << "  Operation: ";
+      switch ( this->m_Operation )
+        {
+        case Sum:
+          out << "Sum";
+          break;
+        case Maximum:
+          out << "Maximum";
+          break;
+        case LabelVoting:
+          out << "LabelVoting";
+          break;
+        }
+      out << std::endl;
+      out << "  LabelForUndecidedPixels: " << this->m_LabelForUndecidedPixels << std::endl;
+      out << "  NumberOfImages: " << this->m_NumberOfImages << std::endl;
+      out << "  NumberOfLabels: " << this->m_Labels.size() << std::endl;
+      out << ProcessObject::ToString();
+      return out.str();
+    }
+
+  }
+}
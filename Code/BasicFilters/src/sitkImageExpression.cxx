@@ -0,0 +1,477 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkImageExpression.h"
+#include "sitkMemberFunctionFactory.h"
+#include "sitkExceptionObject.h"
+
+#include "itkImage.h"
+#include "itkVectorImage.h"
+#include "itkLightObject.h"
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace itk {
+namespace simple {
+
+class ImageExpression::ExpressionNode
+  : public itk::LightObject
+{
+public:
+  typedef ExpressionNode            Self;
+  typedef itk::LightObject          Superclass;
+  typedef itk::SmartPointer<Self>   Pointer;
+
+  itkSimpleNewMacro(Self);
+
+  enum OperatorType { ImageLeaf, ConstantLeaf, Add, Subtract, Multiply, Divide, Negate };
+
+  OperatorType m_Operator;
+  Image        m_Image;
+  double       m_Constant;
+  Pointer      m_Left;
+  Pointer      m_Right;
+
+protected:
+  ExpressionNode()
+    : m_Operator( ConstantLeaf ),
+      m_Constant( 0.0 ) {}
+
+private:
+  ExpressionNode( const Self & ); //purposely not implemented
+  void operator=( const Self & ); //purposely not implemented
+};
+
+namespace
+{
+
+typedef ImageExpression::ExpressionNode NodeType;
+
+// A single operation of the expression in postfix order, operating
+// on a stack of blocks of values.
+struct Instruction
+{
+  NodeType::OperatorType m_Operator;
+  unsigned int           m_ImageIndex;
+  double                 m_Constant;
+};
+
+struct Program
+{
+  std::vector<Instruction> m_Instructions;
+  std::vector<Image>       m_Images;
+  unsigned int             m_StackDepth;
+};
+
+void Compile( const NodeType *node, Program &program, unsigned int depth )
+{
+  depth += 1;
+  program.m_StackDepth = std::max( program.m_StackDepth, depth );
+
+  if ( node->m_Left )
+    {
+    Compile( node->m_Left, program, depth - 1 );
+    }
+  if ( node->m_Right )
+    {
+    Compile( node->m_Right, program, depth );
+    }
+
+  Instruction instruction;
+  instruction.m_Operator = node->m_Operator;
+  instruction.m_ImageIndex = 0;
+  instruction.m_Constant = node->m_Constant;
+
+  if ( node->m_Operator == NodeType::ImageLeaf )
+    {
+    instruction.m_ImageIndex = static_cast<unsigned int>( program.m_Images.size() );
+    program.m_Images.push_back( node->m_Image );
+    }
+  program.m_Instructions.push_back( instruction );
+}
+
+void Print( const NodeType *node, std::ostream &out, unsigned int &imageCount )
+{
+  switch ( node->m_Operator )
+    {
+    case NodeType::ImageLeaf:
+      out << "image" << imageCount++;
+      return;
+    case NodeType::ConstantLeaf:
+      out << node->m_Constant;
+      return;
+    case NodeType::Negate:
+      out << "-";
+      Print( node->m_Left, out, imageCount );
+      return;
+    default:
+      break;
+    }
+
+  out << "(";
+  Print( node->m_Left, out, imageCount );
+  switch ( node->m_Operator )
+    {
+    case NodeType::Add:
+      out << " + ";
+      break;
+    case NodeType::Subtract:
+      out << " - ";
+      break;
+    case NodeType::Multiply:
+      out << " * ";
+      break;
+    default:
+      out << " / ";
+      break;
+    }
+  Print( node->m_Right, out, imageCount );
+  out << ")";
+}
+
+
+// The number of values computed at once by each operation
+const size_t BlockSize = 256;
+
+template <typename TElement>
+struct EvaluateThreadStruct
+{
+  const Program                 *m_Program;
+  std::vector<const TElement *>  m_Inputs;
+  TElement                      *m_Output;
+  size_t                         m_NumberOfElements;
+};
+
+template <typename TElement>
+inline TElement ConvertToElement( double v )
+{
+  if ( std::numeric_limits<TElement>::is_integer )
+    {
+    // also maps NaN to the minimum
+    if ( !( v >= static_cast<double>( itk::NumericTraits<TElement>::NonpositiveMin() ) ) )
+      {
+      return itk::NumericTraits<TElement>::NonpositiveMin();
+      }
+    if ( v >= static_cast<double>( itk::NumericTraits<TElement>::max() ) )
+      {
+      return itk::NumericTraits<TElement>::max();
+      }
+    }
+  return static_cast<TElement>( v );
+}
+
+template <typename TElement>
+void EvaluateBlock( const EvaluateThreadStruct<TElement> &str,
+                    size_t start,
+                    size_t n,
+                    std::vector<double> &stack )
+{
+  const double divideByZero = static_cast<double>( itk::NumericTraits<TElement>::max() );
+  const std::vector<Instruction> &instructions = str.m_Program->m_Instructions;
+
+  double *top = &stack[0] - BlockSize;
+
+  for ( size_t i = 0; i < instructions.size(); ++i )
+    {
+    const Instruction &instruction = instructions[i];
+    switch ( instruction.m_Operator )
+      {
+      case NodeType::ImageLeaf:
+        {
+        top += BlockSize;
+        const TElement *input = str.m_Inputs[instruction.m_ImageIndex] + start;
+        for ( size_t j = 0; j < n; ++j )
+          {
+          top[j] = static_cast<double>( input[j] );
+          }
+        break;
+        }
+      case NodeType::ConstantLeaf:
+        top += BlockSize;
+        std::fill( top, top + n, instruction.m_Constant );
+        break;
+      case NodeType::Negate:
+        for ( size_t j = 0; j < n; ++j )
+          {
+          top[j] = -top[j];
+          }
+        break;
+      case NodeType::Add:
+        {
+        const double *b = top;
+        top -= BlockSize;
+        for ( size_t j = 0; j < n; ++j )
+          {
+          top[j] += b[j];
+          }
+        break;
+        }
+      case NodeType::Subtract:
+        {
+        const double *b = top;
+        top -= BlockSize;
+        for ( size_t j = 0; j < n; ++j )
+          {
+          top[j] -= b[j];
+          }
+        break;
+        }
+      case NodeType::Multiply:
+        {
+        const double *b = top;
+        top -= BlockSize;
+        for ( size_t j = 0; j < n; ++j )
+          {
+          top[j] *= b[j];
+          }
+        break;
+        }
+      case NodeType::Divide:
+        {
+        const double *b = top;
+        top -= BlockSize;
+        for ( size_t j = 0; j < n; ++j )
+          {
+          top[j] = ( b[j] != 0.0 ) ? top[j] / b[j] : divideByZero;
+          }
+        break;
+        }
+      }
+    }
+
+  TElement *output = str.m_Output + start;
+  for ( size_t j = 0; j < n; ++j )
+    {
+    output[j] = ConvertToElement<TElement>( top[j] );
+    }
+}
+
+template <typename TElement>
+ITK_THREAD_RETURN_TYPE EvaluateThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  const EvaluateThreadStruct<TElement> *str = static_cast<EvaluateThreadStruct<TElement> *>( info->UserData );
+
+  const size_t chunk = str->m_NumberOfElements / info->NumberOfThreads;
+  const size_t begin = chunk * info->ThreadID;
+  const size_t end = ( info->ThreadID + 1 == info->NumberOfThreads ) ? str->m_NumberOfElements : begin + chunk;
+
+  std::vector<double> stack( str->m_Program->m_StackDepth * BlockSize );
+
+  for ( size_t start = begin; start < end; start += BlockSize )
+    {
+    EvaluateBlock( *str, start, std::min( BlockSize, end - start ), stack );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+// Dispatches the evaluation of a compiled program on the pixel type
+// of the images
+class ExpressionEvaluator
+{
+public:
+  typedef ExpressionEvaluator Self;
+  typedef Image (Self::*MemberFunctionType)( void );
+
+  typedef typelist::Append< BasicPixelIDTypeList, VectorPixelIDTypeList >::Type PixelIDTypeList;
+
+  explicit ExpressionEvaluator( const Program &program )
+    : m_Program( program ) {}
+
+  Image Execute( void )
+    {
+      const Image &image0 = m_Program.m_Images[0];
+
+      for ( unsigned int i = 1; i < m_Program.m_Images.size(); ++i )
+        {
+        const Image &image = m_Program.m_Images[i];
+        if ( image.GetPixelID() != image0.GetPixelID()
+             || image.GetSize() != image0.GetSize()
+             || image.GetNumberOfComponentsPerPixel() != image0.GetNumberOfComponentsPerPixel() )
+          {
+          sitkExceptionMacro( "Image" << i << " of the expression does not match the pixel type or size of the first image!" );
+          }
+        }
+
+      detail::MemberFunctionFactory<MemberFunctionType> memberFactory( this );
+      memberFactory.RegisterMemberFunctions< PixelIDTypeList, 4 > ();
+      memberFactory.RegisterMemberFunctions< PixelIDTypeList, 3 > ();
+      memberFactory.RegisterMemberFunctions< PixelIDTypeList, 2 > ();
+
+      return memberFactory.GetMemberFunction( image0.GetPixelID(), image0.GetDimension() )();
+    }
+
+  template <class TImageType>
+  Image ExecuteInternal( void )
+    {
+      typedef typename TImageType::PixelContainer::Element ElementType;
+
+      const Image &image0 = m_Program.m_Images[0];
+
+      Image output( image0.GetSize(), image0.GetPixelID(), image0.GetNumberOfComponentsPerPixel(), Image::NoBufferInitialization );
+      output.SetOrigin( image0.GetOrigin() );
+      output.SetSpacing( image0.GetSpacing() );
+      output.SetDirection( image0.GetDirection() );
+
+      EvaluateThreadStruct<ElementType> str;
+      str.m_Program = &m_Program;
+      for ( unsigned int i = 0; i < m_Program.m_Images.size(); ++i )
+        {
+        const TImageType *itkImage = dynamic_cast<const TImageType *>( m_Program.m_Images[i].GetITKBase() );
+        assert( itkImage != SITK_NULLPTR );
+        str.m_Inputs.push_back( itkImage->GetBufferPointer() );
+        }
+      str.m_Output = dynamic_cast<TImageType *>( output.GetITKBase() )->GetBufferPointer();
+      str.m_NumberOfElements = static_cast<size_t>( output.GetNumberOfPixels() ) * output.GetNumberOfComponentsPerPixel();
+
+      // elements smaller than this are computed by the calling thread
+      const size_t minimumElementsPerThread = 16 * BlockSize;
+      const size_t numberOfThreads =
+        std::max<size_t>( 1, std::min<size_t>( itk::MultiThreader::GetGlobalDefaultNumberOfThreads(),
+                                               str.m_NumberOfElements / minimumElementsPerThread ) );
+
+      itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+      threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+      threader->SetSingleMethod( EvaluateThreaderCallback<ElementType>, &str );
+      threader->SingleMethodExecute();
+
+      return output;
+    }
+
+private:
+  const Program &m_Program;
+};
+
+ImageExpression::ExpressionNode *NewOperatorNode( NodeType::OperatorType op,
+                                                  const NodeType *left,
+                                                  const NodeType *right )
+{
+  NodeType::Pointer node = NodeType::New();
+  node->m_Operator = op;
+  node->m_Left = const_cast<NodeType *>( left );
+  node->m_Right = const_cast<NodeType *>( right );
+
+  // the reference is released by the ImageExpression constructor
+  node->Register();
+  return node.GetPointer();
+}
+
+}
+
+
+ImageExpression::ImageExpression( const Image &image )
+  : m_Node( NodeType::New() )
+{
+  m_Node->m_Operator = NodeType::ImageLeaf;
+  m_Node->m_Image = image;
+}
+
+ImageExpression::ImageExpression( double constant )
+  : m_Node( NodeType::New() )
+{
+  m_Node->m_Operator = NodeType::ConstantLeaf;
+  m_Node->m_Constant = constant;
+}
+
+ImageExpression::ImageExpression( ExpressionNode *node )
+  : m_Node( node )
+{
+  node->UnRegister();
+}
+
+ImageExpression::ImageExpression( const ImageExpression &expression )
+  : m_Node( expression.m_Node )
+{
+}
+
+ImageExpression &ImageExpression::operator=( const ImageExpression &expression )
+{
+  this->m_Node = expression.m_Node;
+  return *this;
+}
+
+ImageExpression::~ImageExpression()
+{
+}
+
+Image ImageExpression::Evaluate( void ) const
+{
+  Program program;
+  program.m_StackDepth = 0;
+  Compile( m_Node, program, 0 );
+
+  if ( program.m_Images.empty() )
+    {
+    sitkExceptionMacro( "An ImageExpression must contain at least one image to be evaluated!" );
+    }
+
+  return ExpressionEvaluator( program ).Execute();
+}
+
+unsigned int ImageExpression::GetNumberOfImages( void ) const
+{
+  Program program;
+  program.m_StackDepth = 0;
+  Compile( m_Node, program, 0 );
+  return static_cast<unsigned int>( program.m_Images.size() );
+}
+
+std::string ImageExpression::ToString( void ) const
+{
+  std::ostringstream out;
+  unsigned int imageCount = 0;
+  Print( m_Node, out, imageCount );
+  return out.str();
+}
+
+
+ImageExpression operator+( const ImageExpression &e1, const ImageExpression &e2 )
+{
+  return ImageExpression( NewOperatorNode( NodeType::Add, e1.m_Node, e2.m_Node ) );
+}
+
+ImageExpression operator-( const ImageExpression &e1, const ImageExpression &e2 )
+{
+  return ImageExpression( NewOperatorNode( NodeType::Subtract, e1.m_Node, e2.m_Node ) );
+}
+
+ImageExpression operator*( const ImageExpression &e1, const ImageExpression &e2 )
+{
+  return ImageExpression( NewOperatorNode( NodeType::Multiply, e1.m_Node, e2.m_Node ) );
+}
+
+ImageExpression operator/( const ImageExpression &e1, const ImageExpression &e2 )
+{
+  return ImageExpression( NewOperatorNode( NodeType::Divide, e1.m_Node, e2.m_Node ) );
+}
+
+ImageExpression operator-( const ImageExpression &e )
+{
+  return ImageExpression( NewOperatorNode( NodeType::Negate, e.m_Node, SITK_NULLPTR ) );
+}
+
+}
+}
@@ -0,0 +1,1132 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "sitkLabelFeaturesImageFilter.h"
+#include "sitkExceptionObject.h"
+#include "nsstd/unordered_map.h"
+
+#include "itkImage.h"
+#include "itkImageScanlineConstIterator.h"
+#include "itkImageRegionSplitterSlowDimension.h"
+#include "itkLabelMap.h"
+#include "itkLabelObject.h"
+#include "itkMultiThreader.h"
+#include "vnl/algo/vnl_symmetric_eigensystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace itk {
+namespace simple {
+
+namespace detail
+{
+
+// The features accumulated for a label from its pixels
+template <unsigned int VDimension>
+struct LabelAccumulator
+{
+  uint64_t       m_Count;
+  IndexValueType m_IndexMinimum[VDimension];
+  IndexValueType m_IndexMaximum[VDimension];
+  double         m_IndexSum[VDimension];
+  double         m_IndexProductSum[VDimension*VDimension];
+  double         m_Sum;
+  double         m_SumOfSquares;
+  double         m_Minimum;
+  double         m_Maximum;
+  double         m_WeightedIndexSum[VDimension];
+
+  LabelAccumulator()
+    : m_Count( 0 ),
+      m_Sum( 0.0 ),
+      m_SumOfSquares( 0.0 ),
+      m_Minimum( std::numeric_limits<double>::max() ),
+      m_Maximum( -std::numeric_limits<double>::max() )
+    {
+      for ( unsigned int d = 0; d < VDimension; ++d )
+        {
+        m_IndexMinimum[d] = NumericTraits<IndexValueType>::max();
+        m_IndexMaximum[d] = NumericTraits<IndexValueType>::NonpositiveMin();
+        m_IndexSum[d] = 0.0;
+        m_WeightedIndexSum[d] = 0.0;
+        }
+      std::fill( m_IndexProductSum, m_IndexProductSum + VDimension*VDimension, 0.0 );
+    }
+
+  void Merge( const LabelAccumulator &other )
+    {
+      m_Count += other.m_Count;
+      for ( unsigned int d = 0; d < VDimension; ++d )
+        {
+        m_IndexMinimum[d] = std::min( m_IndexMinimum[d], other.m_IndexMinimum[d] );
+        m_IndexMaximum[d] = std::max( m_IndexMaximum[d], other.m_IndexMaximum[d] );
+        m_IndexSum[d] += other.m_IndexSum[d];
+        m_WeightedIndexSum[d] += other.m_WeightedIndexSum[d];
+        }
+      for ( unsigned int i = 0; i < VDimension*VDimension; ++i )
+        {
+        m_IndexProductSum[i] += other.m_IndexProductSum[i];
+        }
+      m_Sum += other.m_Sum;
+      m_SumOfSquares += other.m_SumOfSquares;
+      m_Minimum = std::min( m_Minimum, other.m_Minimum );
+      m_Maximum = std::max( m_Maximum, other.m_Maximum );
+    }
+};
+
+
+// The accumulators of the labels found by a thread
+template <unsigned int VDimension>
+class LabelAccumulators
+{
+public:
+  typedef LabelAccumulator<VDimension> AccumulatorType;
+
+  LabelAccumulators()
+    : m_LastLabel( 0 ),
+      m_LastPosition( -1 ) {}
+
+  AccumulatorType &Get( int64_t label )
+    {
+      // the labels come in runs along the lines
+      if ( m_LastPosition < 0 || label != m_LastLabel )
+        {
+        typename MapType::iterator it = m_Positions.find( label );
+        if ( it == m_Positions.end() )
+          {
+          it = m_Positions.insert( std::make_pair( label, m_Values.size() ) ).first;
+          m_Values.push_back( AccumulatorType() );
+          }
+        m_LastLabel = label;
+        m_LastPosition = static_cast<ptrdiff_t>( it->second );
+        }
+      return m_Values[m_LastPosition];
+    }
+
+  void Merge( const LabelAccumulators &other )
+    {
+      for ( typename MapType::const_iterator it = other.m_Positions.begin(); it != other.m_Positions.end(); ++it )
+        {
+        this->Get( it->first ).Merge( other.m_Values[it->second] );
+        }
+    }
+
+  // the labels in increasing order, with the positions of their
+  // accumulators
+  std::vector< std::pair<int64_t, size_t> > GetSortedLabels() const
+    {
+      std::vector< std::pair<int64_t, size_t> > labels( m_Positions.begin(), m_Positions.end() );
+      std::sort( labels.begin(), labels.end() );
+      return labels;
+    }
+
+  const AccumulatorType &GetValue( size_t position ) const { return m_Values[position]; }
+
+private:
+  typedef nsstd::unordered_map<int64_t, size_t> MapType;
+
+  MapType                      m_Positions;
+  std::vector<AccumulatorType> m_Values;
+  int64_t                      m_LastLabel;
+  ptrdiff_t                    m_LastPosition;
+};
+
+}
+
+namespace
+{
+
+
+template <class TLabelImageType, class TIntensityImageType>
+struct LabelFeaturesThreadStruct
+{
+  typedef typename TLabelImageType::RegionType           RegionType;
+  typedef typename TLabelImageType::OffsetType           OffsetType;
+  typedef detail::LabelAccumulators<TLabelImageType::ImageDimension> AccumulatorsType;
+
+  const TLabelImageType         *m_LabelImage;
+  // null for the shape features only
+  const TIntensityImageType     *m_IntensityImage;
+  std::vector<RegionType>        m_Regions;
+  std::vector<AccumulatorsType>  m_Accumulators;
+  // added to the indices of the pixels, the index of a chunk
+  OffsetType                     m_IndexOffset;
+  unsigned int                   m_Features;
+  int64_t                        m_BackgroundValue;
+};
+
+
+template <class TLabelImageType, class TIntensityImageType>
+ITK_THREAD_RETURN_TYPE LabelFeaturesThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  typedef LabelFeaturesThreadStruct<TLabelImageType, TIntensityImageType> StructType;
+  typedef typename StructType::AccumulatorsType::AccumulatorType AccumulatorType;
+
+  const unsigned int Dimension = TLabelImageType::ImageDimension;
+
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  StructType *str = static_cast<StructType *>( info->UserData );
+
+  const typename StructType::RegionType &region = str->m_Regions[info->ThreadID];
+  typename StructType::AccumulatorsType &accumulators = str->m_Accumulators[info->ThreadID];
+
+  const unsigned int features = str->m_Features;
+  const bool boundingBox = ( features & LabelFeaturesImageFilter::BOUNDING_BOX ) != 0;
+  const bool centroid = ( features & ( LabelFeaturesImageFilter::CENTROID | LabelFeaturesImageFilter::SECOND_ORDER_MOMENTS ) ) != 0;
+  const bool moments = ( features & LabelFeaturesImageFilter::SECOND_ORDER_MOMENTS ) != 0;
+  const bool intensity = str->m_IntensityImage != SITK_NULLPTR;
+  const bool minimumMaximum = intensity && ( features & LabelFeaturesImageFilter::MINIMUM_MAXIMUM );
+  const bool squares = intensity && ( features & LabelFeaturesImageFilter::VARIANCE );
+  const bool weighted = intensity && ( features & LabelFeaturesImageFilter::CENTER_OF_GRAVITY );
+
+  typedef itk::ImageScanlineConstIterator<TLabelImageType>     LabelIteratorType;
+  typedef itk::ImageScanlineConstIterator<TIntensityImageType> IntensityIteratorType;
+
+  LabelIteratorType labelIt( str->m_LabelImage, region );
+  IntensityIteratorType intensityIt;
+  if ( intensity )
+    {
+    intensityIt = IntensityIteratorType( str->m_IntensityImage, region );
+    }
+
+  double position[Dimension];
+  while ( !labelIt.IsAtEnd() )
+    {
+    const typename TLabelImageType::IndexType lineIndex = labelIt.GetIndex() + str->m_IndexOffset;
+    for ( unsigned int d = 1; d < Dimension; ++d )
+      {
+      position[d] = lineIndex[d];
+      }
+    IndexValueType x = lineIndex[0];
+
+    while ( !labelIt.IsAtEndOfLine() )
+      {
+      const int64_t label = static_cast<int64_t>( labelIt.Get() );
+      if ( label != str->m_BackgroundValue )
+        {
+        AccumulatorType &a = accumulators.Get( label );
+        ++a.m_Count;
+        position[0] = x;
+
+        if ( boundingBox )
+          {
+          a.m_IndexMinimum[0] = std::min( a.m_IndexMinimum[0], x );
+          a.m_IndexMaximum[0] = std::max( a.m_IndexMaximum[0], x );
+          for ( unsigned int d = 1; d < Dimension; ++d )
+            {
+            a.m_IndexMinimum[d] = std::min( a.m_IndexMinimum[d], lineIndex[d] );
+            a.m_IndexMaximum[d] = std::max( a.m_IndexMaximum[d], lineIndex[d] );
+            }
+          }
+        if ( centroid )
+          {
+          for ( unsigned int d = 0; d < Dimension; ++d )
+            {
+            a.m_IndexSum[d] += position[d];
+            }
+          }
+        if ( moments )
+          {
+          // the upper triangle, the lower is filled at the end
+          for ( unsigned int i = 0; i < Dimension; ++i )
+            {
+            for ( unsigned int j = i; j < Dimension; ++j )
+              {
+              a.m_IndexProductSum[i*Dimension+j] += position[i] * position[j];
+              }
+            }
+          }
+        if ( intensity )
+          {
+          const double value = static_cast<double>( intensityIt.Get() );
+          a.m_Sum += value;
+          if ( squares )
+            {
+            a.m_SumOfSquares += value * value;
+            }
+          if ( minimumMaximum )
+            {
+            a.m_Minimum = std::min( a.m_Minimum, value );
+            a.m_Maximum = std::max( a.m_Maximum, value );
+            }
+          if ( weighted )
+            {
+            for ( unsigned int d = 0; d < Dimension; ++d )
+              {
+              a.m_WeightedIndexSum[d] += value * position[d];
+              }
+            }
+          }
+        }
+
+      ++x;
+      ++labelIt;
+      if ( intensity )
+        {
+        ++intensityIt;
+        }
+      }
+
+    labelIt.NextLine();
+    if ( intensity )
+      {
+      intensityIt.NextLine();
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TLabelMapType, class TIntensityImageType>
+struct LabelMapFeaturesThreadStruct
+{
+  typedef typename TLabelMapType::LabelObjectType                   LabelObjectType;
+  typedef itk::Offset<TLabelMapType::ImageDimension>                OffsetType;
+  typedef detail::LabelAccumulators<TLabelMapType::ImageDimension> AccumulatorsType;
+
+  // null for the shape features only
+  const TIntensityImageType           *m_IntensityImage;
+  std::vector<const LabelObjectType *> m_LabelObjects;
+  std::vector<AccumulatorsType>        m_Accumulators;
+  // added to the indices of the pixels, the index of a chunk
+  OffsetType                           m_IndexOffset;
+  unsigned int                         m_Features;
+  int64_t                              m_BackgroundValue;
+};
+
+
+// Accumulate the features of the runs of the label objects. The
+// sums of the indices along a run are computed from its first index
+// and its length.
+template <class TLabelMapType, class TIntensityImageType>
+ITK_THREAD_RETURN_TYPE LabelMapFeaturesThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  typedef LabelMapFeaturesThreadStruct<TLabelMapType, TIntensityImageType> StructType;
+  typedef typename StructType::AccumulatorsType::AccumulatorType          AccumulatorType;
+  typedef typename StructType::LabelObjectType                            LabelObjectType;
+  typedef typename TIntensityImageType::PixelType                         IntensityPixelType;
+
+  const unsigned int Dimension = TLabelMapType::ImageDimension;
+
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  StructType *str = static_cast<StructType *>( info->UserData );
+
+  typename StructType::AccumulatorsType &accumulators = str->m_Accumulators[info->ThreadID];
+
+  const unsigned int features = str->m_Features;
+  const bool boundingBox = ( features & LabelFeaturesImageFilter::BOUNDING_BOX ) != 0;
+  const bool centroid = ( features & ( LabelFeaturesImageFilter::CENTROID | LabelFeaturesImageFilter::SECOND_ORDER_MOMENTS ) ) != 0;
+  const bool moments = ( features & LabelFeaturesImageFilter::SECOND_ORDER_MOMENTS ) != 0;
+  const bool intensity = str->m_IntensityImage != SITK_NULLPTR;
+  const bool minimumMaximum = intensity && ( features & LabelFeaturesImageFilter::MINIMUM_MAXIMUM );
+  const bool squares = intensity && ( features & LabelFeaturesImageFilter::VARIANCE );
+  const bool weighted = intensity && ( features & LabelFeaturesImageFilter::CENTER_OF_GRAVITY );
+
+  double position[Dimension];
+  for ( size_t o = info->ThreadID; o < str->m_LabelObjects.size(); o += info->NumberOfThreads )
+    {
+    const LabelObjectType *labelObject = str->m_LabelObjects[o];
+    const int64_t label = static_cast<int64_t>( labelObject->GetLabel() );
+    if ( label == str->m_BackgroundValue )
+      {
+      continue;
+      }
+    AccumulatorType &a = accumulators.Get( label );
+
+    for ( typename LabelObjectType::ConstLineIterator lineIt( labelObject ); !lineIt.IsAtEnd(); ++lineIt )
+      {
+      const typename LabelObjectType::IndexType runIndex = lineIt.GetLine().GetIndex();
+      const IndexValueType length = static_cast<IndexValueType>( lineIt.GetLine().GetLength() );
+      const typename LabelObjectType::IndexType lineIndex = runIndex + str->m_IndexOffset;
+      for ( unsigned int d = 1; d < Dimension; ++d )
+        {
+        position[d] = lineIndex[d];
+        }
+      const IndexValueType x = lineIndex[0];
+      const double n = static_cast<double>( length );
+      const double x0 = static_cast<double>( x );
+      // the sums of x and of x*x over the run
+      const double sumX = n * x0 + n * ( n - 1.0 ) / 2.0;
+      const double sumXX = n * x0 * x0 + x0 * n * ( n - 1.0 ) + ( n - 1.0 ) * n * ( 2.0 * n - 1.0 ) / 6.0;
+
+      a.m_Count += static_cast<uint64_t>( length );
+
+      if ( boundingBox )
+        {
+        a.m_IndexMinimum[0] = std::min( a.m_IndexMinimum[0], x );
+        a.m_IndexMaximum[0] = std::max( a.m_IndexMaximum[0], x + length - 1 );
+        for ( unsigned int d = 1; d < Dimension; ++d )
+          {
+          a.m_IndexMinimum[d] = std::min( a.m_IndexMinimum[d], lineIndex[d] );
+          a.m_IndexMaximum[d] = std::max( a.m_IndexMaximum[d], lineIndex[d] );
+          }
+        }
+      if ( centroid )
+        {
+        a.m_IndexSum[0] += sumX;
+        for ( unsigned int d = 1; d < Dimension; ++d )
+          {
+          a.m_IndexSum[d] += n * position[d];
+          }
+        }
+      if ( moments )
+        {
+        // the upper triangle, the lower is filled at the end
+        a.m_IndexProductSum[0] += sumXX;
+        for ( unsigned int j = 1; j < Dimension; ++j )
+          {
+          a.m_IndexProductSum[j] += sumX * position[j];
+          }
+        for ( unsigned int i = 1; i < Dimension; ++i )
+          {
+          for ( unsigned int j = i; j < Dimension; ++j )
+            {
+            a.m_IndexProductSum[i*Dimension+j] += n * position[i] * position[j];
+            }
+          }
+        }
+      if ( intensity )
+        {
+        // only the intensities inside of the run are read
+        const IntensityPixelType *values = str->m_IntensityImage->GetBufferPointer()
+          + str->m_IntensityImage->ComputeOffset( runIndex );
+        for ( IndexValueType k = 0; k < length; ++k )
+          {
+          const double value = static_cast<double>( values[k] );
+          a.m_Sum += value;
+          if ( squares )
+            {
+            a.m_SumOfSquares += value * value;
+            }
+          if ( minimumMaximum )
+            {
+            a.m_Minimum = std::min( a.m_Minimum, value );
+            a.m_Maximum = std::max( a.m_Maximum, value );
+            }
+          if ( weighted )
+            {
+            a.m_WeightedIndexSum[0] += value * static_cast<double>( x + k );
+            for ( unsigned int d = 1; d < Dimension; ++d )
+              {
+              a.m_WeightedIndexSum[d] += value * position[d];
+              }
+            }
+          }
+        }
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+//
+// ChunkState
+//
+// The geometry of the whole image and the features of the chunks.
+struct LabelFeaturesImageFilter::ChunkState
+{
+  virtual ~ChunkState() {}
+
+  unsigned int        m_Dimension;
+  unsigned int        m_Features;
+  bool                m_UseIntensityImage;
+  uint64_t            m_NumberOfChunks;
+  std::vector<double> m_Origin;
+  std::vector<double> m_Spacing;
+  std::vector<double> m_Direction;
+};
+
+template <unsigned int VDimension>
+struct LabelFeaturesImageFilter::DimensionChunkState
+  : public LabelFeaturesImageFilter::ChunkState
+{
+  detail::LabelAccumulators<VDimension> m_Accumulators;
+};
+
+
+//
+// Default constructor that initializes parameters
+//
+LabelFeaturesImageFilter::LabelFeaturesImageFilter ()
+{
+  this->m_Features = ALL_FEATURES;
+  this->m_BackgroundValue = 0;
+  this->m_UseIntensityImage = false;
+  this->m_AddChunk = false;
+
+  this->m_Dimension = 0;
+  this->m_ComputedFeatures = 0;
+
+  this->m_DualMemberFactory.reset( new detail::DualMemberFunctionFactory<MemberFunctionType>( this ) );
+
+  this->m_DualMemberFactory->RegisterMemberFunctions< PixelIDTypeList, PixelIDTypeList2, 3 > ();
+  this->m_DualMemberFactory->RegisterMemberFunctions< PixelIDTypeList, PixelIDTypeList2, 2 > ();
+
+  this->m_DualMemberFactory->RegisterMemberFunctions< LabelMapPixelIDTypeList, PixelIDTypeList2, 3, LabelMapAddressor<MemberFunctionType> > ();
+  this->m_DualMemberFactory->RegisterMemberFunctions< LabelMapPixelIDTypeList, PixelIDTypeList2, 2, LabelMapAddressor<MemberFunctionType> > ();
+}
+
+//
+// Destructor
+//
+LabelFeaturesImageFilter::~LabelFeaturesImageFilter ()
+{
+
+}
+
+
+//
+// ToString
+//
+std::string LabelFeaturesImageFilter::ToString() const
+{
+  std::ostringstream out;
+  out << "itk::simple::LabelFeaturesImageFilter\n";
+  out << "  Features: ";
+  this->ToStringHelper(out, this->m_Features);
+  out << std::endl;
+  out << "  BackgroundValue: ";
+  this->ToStringHelper(out, this->m_BackgroundValue);
+  out << std::endl;
+  out << "  ComputedFeatures: ";
+  this->ToStringHelper(out, this->m_ComputedFeatures);
+  out << std::endl;
+  out << "  NumberOfLabels: " << this->m_Labels.size();
+  out << std::endl;
+  out << "  NumberOfChunks: " << this->GetNumberOfChunks();
+  out << std::endl;
+
+  out << ProcessObject::ToString();
+  return out.str();
+}
+
+
+//
+// Execute
+//
+void LabelFeaturesImageFilter::Execute ( const Image & labelImage )
+{
+  // The label image is passed as the intensity image to dispatch on
+  // its type, it is not read.
+  this->m_UseIntensityImage = false;
+  this->m_AddChunk = false;
+  this->Dispatch( labelImage, labelImage );
+}
+
+
+void LabelFeaturesImageFilter::Execute ( const Image & labelImage, const Image & intensityImage )
+{
+  if ( labelImage.GetDimension() != intensityImage.GetDimension() ||
+       labelImage.GetSize() != intensityImage.GetSize() )
+    {
+    sitkExceptionMacro ( "The intensity image must have the size of the label image!" );
+    }
+
+  this->m_UseIntensityImage = true;
+  this->m_AddChunk = false;
+  this->Dispatch( labelImage, intensityImage );
+}
+
+
+void LabelFeaturesImageFilter::Dispatch ( const Image & labelImage, const Image & intensityImage )
+{
+  PixelIDValueEnum intensityPixelID = intensityImage.GetPixelID();
+  if ( !this->m_UseIntensityImage )
+    {
+    // a label map is not an intensity type, any registered type
+    // dispatches to the shape features
+    switch ( labelImage.GetPixelID() )
+      {
+      case sitkLabelUInt8:
+      case sitkLabelUInt16:
+      case sitkLabelUInt32:
+      case sitkLabelUInt64:
+        intensityPixelID = sitkUInt8;
+        break;
+      default:
+        break;
+      }
+    }
+
+  this->m_DualMemberFactory->GetMemberFunction( labelImage.GetPixelID(),
+                                                intensityPixelID,
+                                                labelImage.GetDimension() )( labelImage, intensityImage );
+}
+
+
+//-----------------------------------------------------------------------------
+
+//
+// Chunks
+//
+void LabelFeaturesImageFilter::ClearChunks ()
+{
+  this->m_ChunkState.reset();
+}
+
+
+uint64_t LabelFeaturesImageFilter::GetNumberOfChunks () const
+{
+  return this->m_ChunkState.get() ? this->m_ChunkState->m_NumberOfChunks : 0;
+}
+
+
+void LabelFeaturesImageFilter::AddChunk ( const Image & labelChunk, const std::vector<int> & chunkIndex )
+{
+  if ( chunkIndex.size() < labelChunk.GetDimension() )
+    {
+    sitkExceptionMacro ( "The index of the chunk does not have the dimension of the chunk!" );
+    }
+
+  this->m_UseIntensityImage = false;
+  this->m_AddChunk = true;
+  this->m_ChunkIndex = chunkIndex;
+  this->Dispatch( labelChunk, labelChunk );
+}
+
+
+void LabelFeaturesImageFilter::AddChunk ( const Image & labelChunk, const Image & intensityChunk, const std::vector<int> & chunkIndex )
+{
+  if ( labelChunk.GetDimension() != intensityChunk.GetDimension() ||
+       labelChunk.GetSize() != intensityChunk.GetSize() )
+    {
+    sitkExceptionMacro ( "The intensity chunk must have the size of the label chunk!" );
+    }
+  if ( chunkIndex.size() < labelChunk.GetDimension() )
+    {
+    sitkExceptionMacro ( "The index of the chunk does not have the dimension of the chunk!" );
+    }
+
+  this->m_UseIntensityImage = true;
+  this->m_AddChunk = true;
+  this->m_ChunkIndex = chunkIndex;
+  this->Dispatch( labelChunk, intensityChunk );
+}
+
+
+void LabelFeaturesImageFilter::ExecuteChunks ()
+{
+  const ChunkState *state = this->m_ChunkState.get();
+  if ( !state )
+    {
+    sitkExceptionMacro ( "No chunk was added!" );
+    }
+
+  switch ( state->m_Dimension )
+    {
+    case 2:
+      this->ComputeMeasurements<2>( static_cast<const DimensionChunkState<2> *>( state )->m_Accumulators,
+                                    state->m_Origin, state->m_Spacing, state->m_Direction,
+                                    state->m_Features, state->m_UseIntensityImage );
+      break;
+    case 3:
+      this->ComputeMeasurements<3>( static_cast<const DimensionChunkState<3> *>( state )->m_Accumulators,
+                                    state->m_Origin, state->m_Spacing, state->m_Direction,
+                                    state->m_Features, state->m_UseIntensityImage );
+      break;
+    default:
+      sitkExceptionMacro ( "Unsupported dimension " << state->m_Dimension << "!" );
+    }
+}
+
+
+//
+// BeginAccumulation
+//
+template <unsigned int VDimension>
+detail::LabelAccumulators<VDimension> *
+LabelFeaturesImageFilter::BeginAccumulation ( const Image &labelImage,
+                                              detail::LabelAccumulators<VDimension> &imageAccumulators,
+                                              std::vector<int> &indexOffset,
+                                              std::vector<double> &origin,
+                                              unsigned int &features )
+{
+  const unsigned int Dimension = VDimension;
+
+  origin = labelImage.GetOrigin();
+  const std::vector<double> spacing = labelImage.GetSpacing();
+  const std::vector<double> direction = labelImage.GetDirection();
+
+  indexOffset.assign( Dimension, 0 );
+  features = this->m_Features;
+  if ( !this->m_AddChunk )
+    {
+    return &imageAccumulators;
+    }
+
+  for ( unsigned int d = 0; d < Dimension; ++d )
+    {
+    indexOffset[d] = this->m_ChunkIndex[d];
+    }
+
+  DimensionChunkState<Dimension> *state = dynamic_cast<DimensionChunkState<Dimension> *>( this->m_ChunkState.get() );
+  if ( !state )
+    {
+    if ( this->m_ChunkState.get() )
+      {
+      sitkExceptionMacro ( "The chunk does not have the dimension of the previous chunks!" );
+      }
+
+    // the origin of the whole image, at the index 0
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      for ( unsigned int j = 0; j < Dimension; ++j )
+        {
+        origin[i] -= direction[i*Dimension+j] * spacing[j] * indexOffset[j];
+        }
+      }
+
+    state = new DimensionChunkState<Dimension>();
+    state->m_Dimension = Dimension;
+    state->m_Features = this->m_Features;
+    state->m_UseIntensityImage = this->m_UseIntensityImage;
+    state->m_NumberOfChunks = 0;
+    state->m_Origin = origin;
+    state->m_Spacing = spacing;
+    state->m_Direction = direction;
+    this->m_ChunkState.reset( state );
+    }
+  else
+    {
+    if ( state->m_UseIntensityImage != this->m_UseIntensityImage )
+      {
+      sitkExceptionMacro ( "The chunks must all have an intensity image, or none!" );
+      }
+    for ( unsigned int i = 0; i < Dimension*Dimension; ++i )
+      {
+      if ( std::abs( state->m_Direction[i] - direction[i] ) > 1e-6 ||
+           ( i < Dimension && std::abs( state->m_Spacing[i] - spacing[i] ) > 1e-6 * std::abs( spacing[i] ) ) )
+        {
+        sitkExceptionMacro ( "The chunk does not have the spacing and direction of the previous chunks!" );
+        }
+      }
+    }
+
+  features = state->m_Features;
+  ++state->m_NumberOfChunks;
+  return &state->m_Accumulators;
+}
+
+
+//
+// EndAccumulation
+//
+template <unsigned int VDimension>
+void LabelFeaturesImageFilter::EndAccumulation ( const Image &labelImage,
+                                                 const detail::LabelAccumulators<VDimension> &imageAccumulators,
+                                                 const std::vector<double> &origin,
+                                                 unsigned int features )
+{
+  if ( !this->m_AddChunk )
+    {
+    this->ComputeMeasurements<VDimension>( imageAccumulators, origin, labelImage.GetSpacing(), labelImage.GetDirection(),
+                                           features, this->m_UseIntensityImage );
+    }
+}
+
+
+//
+// DualExecuteInternal
+//
+template <class TImageType, class TImageType2>
+void LabelFeaturesImageFilter::DualExecuteInternal ( const Image & inLabelImage, const Image & inIntensityImage )
+{
+  typedef TImageType  LabelImageType;
+  typedef TImageType2 IntensityImageType;
+  const unsigned int Dimension = LabelImageType::ImageDimension;
+
+  typedef LabelFeaturesThreadStruct<LabelImageType, IntensityImageType> StructType;
+  typedef typename StructType::AccumulatorsType                         AccumulatorsType;
+
+  const LabelImageType *labelImage = dynamic_cast<const LabelImageType *>( inLabelImage.GetITKBase() );
+  const IntensityImageType *intensityImage = SITK_NULLPTR;
+  if ( this->m_UseIntensityImage )
+    {
+    intensityImage = dynamic_cast<const IntensityImageType *>( inIntensityImage.GetITKBase() );
+    }
+
+  // the features of a chunk are added to the accumulators of the
+  // previous chunks
+  AccumulatorsType imageAccumulators;
+  std::vector<int> chunkIndex;
+  std::vector<double> origin;
+  unsigned int features;
+  AccumulatorsType *accumulators = this->BeginAccumulation<Dimension>( inLabelImage, imageAccumulators, chunkIndex, origin, features );
+
+  typename StructType::OffsetType indexOffset;
+  for ( unsigned int d = 0; d < Dimension; ++d )
+    {
+    indexOffset[d] = chunkIndex[d];
+    }
+
+  // split the image along the slowest axis, each part is accumulated
+  // by a thread
+  const typename LabelImageType::RegionType region = labelImage->GetBufferedRegion();
+  itk::ImageRegionSplitterSlowDimension::Pointer splitter = itk::ImageRegionSplitterSlowDimension::New();
+  const unsigned int numberOfSplits = splitter->GetNumberOfSplits( region, std::max( 1u, this->GetNumberOfThreads() ) );
+
+  StructType str;
+  str.m_LabelImage = labelImage;
+  str.m_IntensityImage = intensityImage;
+  str.m_Regions.resize( numberOfSplits, region );
+  for ( unsigned int i = 0; i < numberOfSplits; ++i )
+    {
+    splitter->GetSplit( i, numberOfSplits, str.m_Regions[i] );
+    }
+  str.m_Accumulators.resize( numberOfSplits );
+  str.m_IndexOffset = indexOffset;
+  str.m_Features = features;
+  str.m_BackgroundValue = this->m_BackgroundValue;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfSplits ) );
+  threader->SetSingleMethod( LabelFeaturesThreaderCallback<LabelImageType, IntensityImageType>, &str );
+  threader->SingleMethodExecute();
+
+  for ( unsigned int i = 0; i < numberOfSplits; ++i )
+    {
+    accumulators->Merge( str.m_Accumulators[i] );
+    str.m_Accumulators[i] = AccumulatorsType();
+    }
+
+  this->EndAccumulation<Dimension>( inLabelImage, imageAccumulators, origin, features );
+}
+
+
+//
+// LabelMapExecuteInternal
+//
+template <class TLabelMapType, class TImageType2>
+void LabelFeaturesImageFilter::LabelMapExecuteInternal ( const Image & inLabelImage, const Image & inIntensityImage )
+{
+  typedef TLabelMapType LabelMapType;
+  typedef TImageType2   IntensityImageType;
+  const unsigned int Dimension = LabelMapType::ImageDimension;
+
+  typedef LabelMapFeaturesThreadStruct<LabelMapType, IntensityImageType> StructType;
+  typedef typename StructType::AccumulatorsType                          AccumulatorsType;
+
+  const LabelMapType *labelMap = dynamic_cast<const LabelMapType *>( inLabelImage.GetITKBase() );
+  const IntensityImageType *intensityImage = SITK_NULLPTR;
+  if ( this->m_UseIntensityImage )
+    {
+    intensityImage = dynamic_cast<const IntensityImageType *>( inIntensityImage.GetITKBase() );
+    }
+
+  AccumulatorsType imageAccumulators;
+  std::vector<int> chunkIndex;
+  std::vector<double> origin;
+  unsigned int features;
+  AccumulatorsType *accumulators = this->BeginAccumulation<Dimension>( inLabelImage, imageAccumulators, chunkIndex, origin, features );
+
+  // the label objects are shared between the threads
+  StructType str;
+  str.m_IntensityImage = intensityImage;
+  for ( typename LabelMapType::ConstIterator it( labelMap ); !it.IsAtEnd(); ++it )
+    {
+    str.m_LabelObjects.push_back( it.GetLabelObject() );
+    }
+  for ( unsigned int d = 0; d < Dimension; ++d )
+    {
+    str.m_IndexOffset[d] = chunkIndex[d];
+    }
+  str.m_Features = features;
+  str.m_BackgroundValue = this->m_BackgroundValue;
+
+  const unsigned int numberOfThreads =
+    std::max<size_t>( 1, std::min<size_t>( std::max( 1u, this->GetNumberOfThreads() ), str.m_LabelObjects.size() ) );
+  str.m_Accumulators.resize( numberOfThreads );
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+  threader->SetSingleMethod( LabelMapFeaturesThreaderCallback<LabelMapType, IntensityImageType>, &str );
+  threader->SingleMethodExecute();
+
+  for ( unsigned int i = 0; i < numberOfThreads; ++i )
+    {
+    accumulators->Merge( str.m_Accumulators[i] );
+    str.m_Accumulators[i] = AccumulatorsType();
+    }
+
+  this->EndAccumulation<Dimension>( inLabelImage, imageAccumulators, origin, features );
+}
+
+
+//
+// ComputeMeasurements
+//
+template <unsigned int VDimension>
+void LabelFeaturesImageFilter::ComputeMeasurements ( const detail::LabelAccumulators<VDimension> &accumulators,
+                                                     const std::vector<double> &origin,
+                                                     const std::vector<double> &spacing,
+                                                     const std::vector<double> &direction,
+                                                     unsigned int features,
+                                                     bool useIntensityImage )
+{
+  const unsigned int Dimension = VDimension;
+  typedef typename detail::LabelAccumulators<VDimension>::AccumulatorType AccumulatorType;
+
+  // the mapping of the indices to physical positions
+  vnl_matrix<double> indexToPhysical( Dimension, Dimension );
+  for ( unsigned int i = 0; i < Dimension; ++i )
+    {
+    for ( unsigned int j = 0; j < Dimension; ++j )
+      {
+      indexToPhysical( i, j ) = direction[i*Dimension+j] * spacing[j];
+      }
+    }
+
+  unsigned int computed = features & ALL_SHAPE_FEATURES;
+  if ( useIntensityImage )
+    {
+    computed |= features & ALL_INTENSITY_FEATURES;
+    }
+
+  const std::vector< std::pair<int64_t, size_t> > labels = accumulators.GetSortedLabels();
+  const size_t numberOfLabels = labels.size();
+
+  this->m_Dimension = Dimension;
+  this->m_ComputedFeatures = computed;
+  this->m_Labels.resize( numberOfLabels );
+  this->m_NumberOfPixels.resize( numberOfLabels );
+  this->m_BoundingBox.assign( computed & BOUNDING_BOX ? 2 * Dimension * numberOfLabels : 0, 0u );
+  this->m_Centroid.assign( computed & CENTROID ? Dimension * numberOfLabels : 0, 0.0 );
+  this->m_SecondOrderMoments.assign( computed & SECOND_ORDER_MOMENTS ? Dimension * Dimension * numberOfLabels : 0, 0.0 );
+  this->m_Sum.assign( computed & MEAN ? numberOfLabels : 0, 0.0 );
+  this->m_Minimum.assign( computed & MINIMUM_MAXIMUM ? numberOfLabels : 0, 0.0 );
+  this->m_Maximum.assign( computed & MINIMUM_MAXIMUM ? numberOfLabels : 0, 0.0 );
+  this->m_Variance.assign( computed & VARIANCE ? numberOfLabels : 0, 0.0 );
+  this->m_CenterOfGravity.assign( computed & CENTER_OF_GRAVITY ? Dimension * numberOfLabels : 0, 0.0 );
+
+  vnl_vector<double> meanIndex( Dimension );
+  vnl_matrix<double> covariance( Dimension, Dimension );
+  for ( size_t l = 0; l < numberOfLabels; ++l )
+    {
+    const AccumulatorType &a = accumulators.GetValue( labels[l].second );
+    const double count = static_cast<double>( a.m_Count );
+
+    this->m_Labels[l] = labels[l].first;
+    this->m_NumberOfPixels[l] = a.m_Count;
+
+    if ( computed & BOUNDING_BOX )
+      {
+      for ( unsigned int d = 0; d < Dimension; ++d )
+        {
+        this->m_BoundingBox[2*Dimension*l + d] = static_cast<unsigned int>( a.m_IndexMinimum[d] );
+        this->m_BoundingBox[2*Dimension*l + Dimension + d] = static_cast<unsigned int>( a.m_IndexMaximum[d] - a.m_IndexMinimum[d] + 1 );
+        }
+      }
+
+    for ( unsigned int d = 0; d < Dimension; ++d )
+      {
+      meanIndex[d] = a.m_IndexSum[d] / count;
+      }
+    if ( computed & CENTROID )
+      {
+      const vnl_vector<double> physical = indexToPhysical * meanIndex;
+      for ( unsigned int d = 0; d < Dimension; ++d )
+        {
+        this->m_Centroid[Dimension*l + d] = origin[d] + physical[d];
+        }
+      }
+    if ( computed & SECOND_ORDER_MOMENTS )
+      {
+      for ( unsigned int i = 0; i < Dimension; ++i )
+        {
+        for ( unsigned int j = i; j < Dimension; ++j )
+          {
+          covariance( i, j ) = a.m_IndexProductSum[i*Dimension+j] / count - meanIndex[i] * meanIndex[j];
+          covariance( j, i ) = covariance( i, j );
+          }
+        }
+      const vnl_matrix<double> physical = indexToPhysical * covariance * indexToPhysical.transpose();
+      std::copy( physical.begin(), physical.end(), this->m_SecondOrderMoments.begin() + Dimension*Dimension*l );
+      }
+
+    if ( computed & MEAN )
+      {
+      this->m_Sum[l] = a.m_Sum;
+      }
+    if ( computed & MINIMUM_MAXIMUM )
+      {
+      this->m_Minimum[l] = a.m_Minimum;
+      this->m_Maximum[l] = a.m_Maximum;
+      }
+    if ( ( computed & VARIANCE ) && a.m_Count > 1 )
+      {
+      // the unbiased estimate, as the LabelStatisticsImageFilter
+      this->m_Variance[l] = std::max( 0.0, ( a.m_SumOfSquares - a.m_Sum * a.m_Sum / count ) / ( count - 1.0 ) );
+      }
+    if ( computed & CENTER_OF_GRAVITY )
+      {
+      vnl_vector<double> weightedIndex( Dimension, 0.0 );
+      if ( a.m_Sum != 0.0 )
+        {
+        for ( unsigned int d = 0; d < Dimension; ++d )
+          {
+          weightedIndex[d] = a.m_WeightedIndexSum[d] / a.m_Sum;
+          }
+        }
+      const vnl_vector<double> physical = indexToPhysical * weightedIndex;
+      for ( unsigned int d = 0; d < Dimension; ++d )
+        {
+        this->m_CenterOfGravity[Dimension*l + d] = origin[d] + physical[d];
+        }
+      }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+bool LabelFeaturesImageFilter::HasLabel( int64_t label ) const
+{
+  return std::binary_search( this->m_Labels.begin(), this->m_Labels.end(), label );
+}
+
+
+size_t LabelFeaturesImageFilter::GetLabelPosition( int64_t label, unsigned int feature ) const
+{
+  if ( ( this->m_ComputedFeatures & feature ) != feature )
+    {
+    sitkExceptionMacro ( "The feature " << feature << " was not computed in the last execution!" );
+    }
+
+  std::vector<int64_t>::const_iterator it = std::lower_bound( this->m_Labels.begin(), this->m_Labels.end(), label );
+  if ( it == this->m_Labels.end() || *it != label )
+    {
+    sitkExceptionMacro ( "The label " << label << " does not exist!" );
+    }
+  return it - this->m_Labels.begin();
+}
+
+
+uint64_t LabelFeaturesImageFilter::GetNumberOfPixels( int64_t label ) const
+{
+  return this->m_NumberOfPixels[this->GetLabelPosition( label, 0 )];
+}
+
+
+std::vector<unsigned int> LabelFeaturesImageFilter::GetBoundingBox( int64_t label ) const
+{
+  const size_t l = this->GetLabelPosition( label, BOUNDING_BOX );
+  std::vector<unsigned int>::const_iterator begin = this->m_BoundingBox.begin() + 2*this->m_Dimension*l;
+  return std::vector<unsigned int>( begin, begin + 2*this->m_Dimension );
+}
+
+
+std::vector<double> LabelFeaturesImageFilter::GetCentroid( int64_t label ) const
+{
+  const size_t l = this->GetLabelPosition( label, CENTROID );
+  std::vector<double>::const_iterator begin = this->m_Centroid.begin() + this->m_Dimension*l;
+  return std::vector<double>( begin, begin + this->m_Dimension );
+}
+
+
+std::vector<double> LabelFeaturesImageFilter::GetSecondOrderMoments( int64_t label ) const
+{
+  const size_t l = this->GetLabelPosition( label, SECOND_ORDER_MOMENTS );
+  const unsigned int n = this->m_Dimension * this->m_Dimension;
+  std::vector<double>::const_iterator begin = this->m_SecondOrderMoments.begin() + n*l;
+  return std::vector<double>( begin, begin + n );
+}
+
+
+std::vector<double> LabelFeaturesImageFilter::GetPrincipalMoments( int64_t label ) const
+{
+  const std::vector<double> moments = this->GetSecondOrderMoments( label );
+
+  vnl_matrix<double> matrix( &moments[0], this->m_Dimension, this->m_Dimension );
+  vnl_symmetric_eigensystem<double> eigensystem( matrix );
+
+  std::vector<double> principalMoments( this->m_Dimension );
+  for ( unsigned int d = 0; d < this->m_Dimension; ++d )
+    {
+    principalMoments[d] = eigensystem.get_eigenvalue( d );
+    }
+  return principalMoments;
+}
+
+
+double LabelFeaturesImageFilter::GetSum( int64_t label ) const
+{
+  return this->m_Sum[this->GetLabelPosition( label, MEAN )];
+}
+
+
+double LabelFeaturesImageFilter::GetMean( int64_t label ) const
+{
+  const size_t l = this->GetLabelPosition( label, MEAN );
+  return this->m_Sum[l] / this->m_NumberOfPixels[l];
+}
+
+
+std::vector<double> LabelFeaturesImageFilter::GetMeanArray() const
+{
+  std::vector<double> mean( this->m_Sum.size() );
+  for ( size_t l = 0; l < mean.size(); ++l )
+    {
+    mean[l] = this->m_Sum[l] / this->m_NumberOfPixels[l];
+    }
+  return mean;
+}
+
+
+double LabelFeaturesImageFilter::GetMinimum( int64_t label ) const
+{
+  return this->m_Minimum[this->GetLabelPosition( label, MINIMUM_MAXIMUM )];
+}
+
+
+double LabelFeaturesImageFilter::GetMaximum( int64_t label ) const
+{
+  return this->m_Maximum[this->GetLabelPosition( label, MINIMUM_MAXIMUM )];
+}
+
+
+double LabelFeaturesImageFilter::GetVariance( int64_t label ) const
+{
+  return this->m_Variance[this->GetLabelPosition( label, VARIANCE )];
+}
+
+
+double LabelFeaturesImageFilter::GetStandardDeviation( int64_t label ) const
+{
+  return std::sqrt( this->GetVariance( label ) );
+}
+
+
+std::vector<double> LabelFeaturesImageFilter::GetCenterOfGravity( int64_t label ) const
+{
+  const size_t l = this->GetLabelPosition( label, CENTER_OF_GRAVITY );
+  std::vector<double>::const_iterator begin = this->m_CenterOfGravity.begin() + this->m_Dimension*l;
+  return std::vector<double>( begin, begin + this->m_Dimension );
+}
+
+}
+}
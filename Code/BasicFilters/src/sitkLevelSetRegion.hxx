@@ -0,0 +1,154 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkLevelSetRegion_hxx
+#define sitkLevelSetRegion_hxx
+
+#include <itkImage.h>
+#include <itkImageAlgorithm.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkNumericTraits.h>
+
+#include <algorithm>
+
+namespace itk {
+namespace simple {
+
+namespace
+{
+
+template< class TImage >
+typename TImage::Pointer CropImage( const TImage *image, const typename TImage::RegionType &region )
+{
+  typename TImage::Pointer cropped = TImage::New();
+  cropped->CopyInformation( image );
+  cropped->SetRegions( region );
+  cropped->Allocate();
+  ImageAlgorithm::Copy( image, cropped.GetPointer(), region, region );
+  return cropped;
+}
+
+}
+
+
+/** \brief Crop the initial level set and the feature image of a
+ * segmentation level set filter to the bounding box of the initial
+ * object, the pixels not greater than 0, expanded by margin pixels.
+ *
+ * The level set evolves within the cropped region only, so its cost
+ * scales with the object rather than the image, and the front can
+ * not grow more than margin pixels beyond the initial object. The
+ * cropped images keep the index of the region, so the output is in
+ * the physical space of the input.
+ *
+ * Returns false, and leaves the inputs unchanged, when the initial
+ * level set has no object or the region is the whole image.
+ */
+template< class TFilter >
+bool CropLevelSetInputs( TFilter *filter, unsigned int margin )
+{
+  typedef typename TFilter::InputImageType   InputImageType;
+  typedef typename TFilter::FeatureImageType FeatureImageType;
+  const unsigned int Dimension = InputImageType::ImageDimension;
+
+  const InputImageType *input = filter->GetInput();
+  const typename InputImageType::RegionType largestRegion = input->GetLargestPossibleRegion();
+
+  typename InputImageType::IndexType lower;
+  typename InputImageType::IndexType upper;
+  bool found = false;
+
+  ImageRegionConstIteratorWithIndex< InputImageType > it( input, largestRegion );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() <= NumericTraits< typename InputImageType::PixelType >::ZeroValue() )
+      {
+      const typename InputImageType::IndexType index = it.GetIndex();
+      if ( !found )
+        {
+        lower = upper = index;
+        found = true;
+        continue;
+        }
+      for ( unsigned int d = 0; d < Dimension; ++d )
+        {
+        lower[d] = std::min( lower[d], index[d] );
+        upper[d] = std::max( upper[d], index[d] );
+        }
+      }
+    }
+  if ( !found )
+    {
+    return false;
+    }
+
+  typename InputImageType::RegionType region;
+  for ( unsigned int d = 0; d < Dimension; ++d )
+    {
+    const typename InputImageType::IndexValueType first = largestRegion.GetIndex( d );
+    const typename InputImageType::IndexValueType last = first + static_cast< typename InputImageType::IndexValueType >( largestRegion.GetSize( d ) ) - 1;
+    const typename InputImageType::IndexValueType start = std::max( first, lower[d] - static_cast< typename InputImageType::IndexValueType >( margin ) );
+    const typename InputImageType::IndexValueType end = std::min( last, upper[d] + static_cast< typename InputImageType::IndexValueType >( margin ) );
+    region.SetIndex( d, start );
+    region.SetSize( d, end - start + 1 );
+    }
+  if ( region == largestRegion )
+    {
+    return false;
+    }
+
+  typename InputImageType::Pointer croppedInput = CropImage( input, region );
+  typename FeatureImageType::Pointer croppedFeature = CropImage( filter->GetFeatureImage(), region );
+  filter->SetInput( croppedInput );
+  filter->SetFeatureImage( croppedFeature );
+  return true;
+}
+
+
+/** \brief Extend the output of a level set filter computed on a
+ * cropped region to the whole region.
+ *
+ * The pixels outside the cropped region are outside the object, and
+ * are given the largest value of the output, the value of the sparse
+ * field level set beyond its layers.
+ */
+template< class TImage >
+typename TImage::Pointer UncropLevelSet( const TImage *output, const typename TImage::RegionType &largestRegion )
+{
+  const typename TImage::RegionType region = output->GetBufferedRegion();
+
+  typename TImage::PixelType outsideValue = NumericTraits< typename TImage::PixelType >::NonpositiveMin();
+  ImageRegionConstIterator< TImage > it( output, region );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    outsideValue = std::max( outsideValue, it.Get() );
+    }
+
+  typename TImage::Pointer uncropped = TImage::New();
+  uncropped->CopyInformation( output );
+  uncropped->SetRegions( largestRegion );
+  uncropped->Allocate();
+  uncropped->FillBuffer( outsideValue );
+  ImageAlgorithm::Copy( output, uncropped.GetPointer(), region, region );
+  return uncropped;
+}
+
+} // end namespace simple
+} // end namespace itk
+
+#endif
@@ -0,0 +1,150 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkLookupTableScalarToRGBColormapImageFilter_hxx
+#define sitkLookupTableScalarToRGBColormapImageFilter_hxx
+
+#include <itkScalarToRGBColormapImageFilter.h>
+#include <itkImageScanlineConstIterator.h>
+#include <itkImageScanlineIterator.h>
+#include <itkNumericTraits.h>
+
+#include <cmath>
+#include <vector>
+
+namespace itk {
+namespace simple {
+
+/** \brief A ScalarToRGBColormapImageFilter with a lookup table for
+ * the integer pixel types of at most 16 bits.
+ *
+ * The superclass evaluates the colormap functor for each pixel. For
+ * the integer pixel types of at most 16 bits, the colormap is
+ * evaluated once for each of the 256 or 65536 values of the pixel
+ * type, after the extrema of the input are set on it, and the threads
+ * copy the colors from the table. The colors are the same as those
+ * of the superclass. The other pixel types evaluate the colormap for
+ * each pixel.
+ */
+template< class TInputImage, class TOutputImage >
+class LookupTableScalarToRGBColormapImageFilter
+  : public ScalarToRGBColormapImageFilter< TInputImage, TOutputImage >
+{
+public:
+  typedef LookupTableScalarToRGBColormapImageFilter                   Self;
+  typedef ScalarToRGBColormapImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                                        Pointer;
+  typedef SmartPointer< const Self >                                  ConstPointer;
+
+  typedef TInputImage                              InputImageType;
+  typedef TOutputImage                             OutputImageType;
+  typedef typename InputImageType::PixelType       InputPixelType;
+  typedef typename OutputImageType::PixelType      OutputPixelType;
+  typedef typename OutputImageType::RegionType     OutputImageRegionType;
+
+  itkNewMacro( Self );
+  itkTypeMacro( LookupTableScalarToRGBColormapImageFilter, ScalarToRGBColormapImageFilter );
+
+  /** Set the input values mapped to the first and the last colors of
+   * the colormap. The values are clamped to the range of the input
+   * pixel type, and rounded to the nearest integer for the integer
+   * pixel types. */
+  void SetWindowMinimum( double minimum )
+  {
+    this->GetModifiableColormap()->SetMinimumInputValue( ClampToInputPixelType( minimum ) );
+  }
+  void SetWindowMaximum( double maximum )
+  {
+    this->GetModifiableColormap()->SetMaximumInputValue( ClampToInputPixelType( maximum ) );
+  }
+
+protected:
+  LookupTableScalarToRGBColormapImageFilter() {}
+
+  static bool UseLookupTable()
+  {
+    return NumericTraits< InputPixelType >::IsInteger && sizeof( InputPixelType ) <= 2;
+  }
+
+  static InputPixelType ClampToInputPixelType( double value )
+  {
+    if ( NumericTraits< InputPixelType >::IsInteger )
+      {
+      value = std::floor( value + 0.5 );
+      }
+    if ( value <= static_cast< double >( NumericTraits< InputPixelType >::NonpositiveMin() ) )
+      {
+      return NumericTraits< InputPixelType >::NonpositiveMin();
+      }
+    if ( value >= static_cast< double >( NumericTraits< InputPixelType >::max() ) )
+      {
+      return NumericTraits< InputPixelType >::max();
+      }
+    return static_cast< InputPixelType >( value );
+  }
+
+  virtual void BeforeThreadedGenerateData() ITK_OVERRIDE
+  {
+    // sets the extrema of the input on the colormap
+    Superclass::BeforeThreadedGenerateData();
+
+    m_Table.clear();
+    if ( UseLookupTable() )
+      {
+      const typename Superclass::ColormapType *colormap = this->GetModifiableColormap();
+      const size_t numberOfValues = size_t( 1 ) << ( 8 * sizeof( InputPixelType ) );
+      m_Table.reserve( numberOfValues );
+      InputPixelType value = NumericTraits< InputPixelType >::NonpositiveMin();
+      for ( size_t i = 0; i < numberOfValues; ++i, ++value )
+        {
+        m_Table.push_back( ( *colormap )( value ) );
+        }
+      }
+  }
+
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE
+  {
+    if ( m_Table.empty() )
+      {
+      Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+      return;
+      }
+
+    const double minimum = static_cast< double >( NumericTraits< InputPixelType >::NonpositiveMin() );
+    ImageScanlineConstIterator< InputImageType > it( this->GetInput(), outputRegionForThread );
+    ImageScanlineIterator< OutputImageType > ot( this->GetOutput(), outputRegionForThread );
+    for ( ; !it.IsAtEnd(); it.NextLine(), ot.NextLine() )
+      {
+      for ( ; !it.IsAtEndOfLine(); ++it, ++ot )
+        {
+        ot.Set( m_Table[static_cast< size_t >( static_cast< double >( it.Get() ) - minimum )] );
+        }
+      }
+  }
+
+private:
+  LookupTableScalarToRGBColormapImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                            // purposely not implemented
+
+  // the color of each value of the pixel type, from the smallest
+  std::vector< OutputPixelType > m_Table;
+};
+
+}
+}
+
+#endif
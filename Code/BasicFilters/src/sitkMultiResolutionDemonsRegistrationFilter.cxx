@@ -0,0 +1,316 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include "itkImage.h"
+#include "itkVectorImage.h"
+#include "itkNumericTraits.h"
+
+#include "sitkMultiResolutionDemonsRegistrationFilter.h"
+#include "itkMultiResolutionPDEDeformableRegistration.h"
+#include "itkDemonsRegistrationFilter.h"
+#include "itkSymmetricForcesDemonsRegistrationFilter.h"
+#include "itkFastSymmetricForcesDemonsRegistrationFilter.h"
+#include "itkDiffeomorphicDemonsRegistrationFilter.h"
+
+// Additional include files
+#include "sitkImageConvert.h"
+// Done with additional include files
+
+namespace itk {
+namespace simple {
+
+//-----------------------------------------------------------------------------
+
+//
+// Default constructor that initializes parameters
+//
+MultiResolutionDemonsRegistrationFilter::MultiResolutionDemonsRegistrationFilter ()
+{
+
+  this->m_DemonsType = itk::simple::MultiResolutionDemonsRegistrationFilter::Demons;
+  this->m_NumberOfLevels = 3u;
+  this->m_NumberOfIterations = std::vector<uint32_t>(1, 10u);
+  this->m_StandardDeviations = std::vector<double>(3, 1.0);
+  this->m_MaximumRMSError = 0.02;
+  this->m_SmoothDisplacementField = true;
+  this->m_SmoothUpdateField = false;
+  this->m_UpdateFieldStandardDeviations = std::vector<double>(3, 1.0);
+  this->m_MaximumKernelWidth = 30u;
+  this->m_MaximumError = 0.1;
+  this->m_IntensityDifferenceThreshold = 0.001;
+  this->m_UseImageSpacing = true;
+
+  this->m_Filter = NULL;
+
+  this->m_MemberFactory.reset( new detail::MemberFunctionFactory<MemberFunctionType>( this ) );
+
+  this->m_MemberFactory->RegisterMemberFunctions< PixelIDTypeList, 3 > ();
+  this->m_MemberFactory->RegisterMemberFunctions< PixelIDTypeList, 2 > ();
+}
+
+//
+// Destructor
+//
+MultiResolutionDemonsRegistrationFilter::~MultiResolutionDemonsRegistrationFilter ()
+{
+  if (this->m_Filter != NULL)
+    {
+      m_Filter->UnRegister();
+    }
+}
+
+
+//
+// ToString
+//
+std::string MultiResolutionDemonsRegistrationFilter::ToString() const
+{
+  std::ostringstream out;
+  out << "itk::simple::MultiResolutionDemonsRegistrationFilter\n";
+  out << "  DemonsType: ";
+  this->ToStringHelper(out, this->m_DemonsType);
+  out << std::endl;
+  out << "  NumberOfLevels: ";
+  this->ToStringHelper(out, this->m_NumberOfLevels);
+  out << std::endl;
+  out << "  NumberOfIterations: ";
+  this->ToStringHelper(out, this->m_NumberOfIterations);
+  out << std::endl;
+  out << "  StandardDeviations: ";
+  this->ToStringHelper(out, this->m_StandardDeviations);
+  out << std::endl;
+  out << "  MaximumRMSError: ";
+  this->ToStringHelper(out, this->m_MaximumRMSError);
+  out << std::endl;
+  out << "  SmoothDisplacementField: ";
+  this->ToStringHelper(out, this->m_SmoothDisplacementField);
+  out << std::endl;
+  out << "  SmoothUpdateField: ";
+  this->ToStringHelper(out, this->m_SmoothUpdateField);
+  out << std::endl;
+  out << "  UpdateFieldStandardDeviations: ";
+  this->ToStringHelper(out, this->m_UpdateFieldStandardDeviations);
+  out << std::endl;
+  out << "  MaximumKernelWidth: ";
+  this->ToStringHelper(out, this->m_MaximumKernelWidth);
+  out << std::endl;
+  out << "  MaximumError: ";
+  this->ToStringHelper(out, this->m_MaximumError);
+  out << std::endl;
+  out << "  IntensityDifferenceThreshold: ";
+  this->ToStringHelper(out, this->m_IntensityDifferenceThreshold);
+  out << std::endl;
+  out << "  UseImageSpacing: ";
+  this->ToStringHelper(out, this->m_UseImageSpacing);
+  out << std::endl;
+
+  out << "  CurrentLevel: ";
+  if (bool(this->m_pfGetCurrentLevel))
+    {
+    this->ToStringHelper(out, this->m_pfGetCurrentLevel());
+    }
+  else
+    {
+    out << "(null)";
+    }
+  out << std::endl;
+  out << "  Metric: ";
+  if (bool(this->m_pfGetMetric))
+    {
+    this->ToStringHelper(out, this->m_pfGetMetric());
+    }
+  else
+    {
+    out << "(null)";
+    }
+  out << std::endl;
+
+  out << ProcessObject::ToString();
+  return out.str();
+}
+
+//
+// Execute
+//
+Image MultiResolutionDemonsRegistrationFilter::Execute ( const Image & fixedImage, const Image & movingImage, const Image & initialDisplacementField )
+{
+  PixelIDValueEnum type = fixedImage.GetPixelID();
+  unsigned int dimension = fixedImage.GetDimension();
+
+  if ( fixedImage.GetDimension() != movingImage.GetDimension() )
+    {
+      sitkExceptionMacro ( "Input image movingImage does not match dimension of first image!" );
+    }
+
+  if ( fixedImage.GetDimension() != initialDisplacementField.GetDimension() ||
+       fixedImage.GetSize() != initialDisplacementField.GetSize() )
+    {
+      sitkExceptionMacro ( "Input image initialDisplacementField does not match dimension or size of first image!" );
+    }
+
+  return this->m_MemberFactory->GetMemberFunction( type, dimension )( &fixedImage, &movingImage, &initialDisplacementField );
+}
+
+
+Image MultiResolutionDemonsRegistrationFilter::Execute ( const Image & fixedImage, const Image & movingImage )
+{
+  PixelIDValueEnum type = fixedImage.GetPixelID();
+  unsigned int dimension = fixedImage.GetDimension();
+
+  if ( fixedImage.GetDimension() != movingImage.GetDimension() )
+    {
+      sitkExceptionMacro ( "Input image movingImage does not match dimension of first image!" );
+    }
+
+  return this->m_MemberFactory->GetMemberFunction( type, dimension )( &fixedImage, &movingImage, NULL );
+}
+
+
+//-----------------------------------------------------------------------------
+
+//
+// Custom Casts
+//
+namespace {
+
+// Create the demons filter of a level, and bind its metric, which is
+// not a method of the PDE registration filters.
+template<typename TDemonsFilter, typename TRegistrationFilter>
+typename TRegistrationFilter::Pointer CreateDemonsFilter( double intensityDifferenceThreshold,
+                                                          nsstd::function<double()> &getMetric )
+{
+  typename TDemonsFilter::Pointer demons = TDemonsFilter::New();
+  demons->SetIntensityDifferenceThreshold( intensityDifferenceThreshold );
+  getMetric = nsstd::bind( &TDemonsFilter::GetMetric, demons.GetPointer() );
+
+  typename TRegistrationFilter::Pointer registration = demons.GetPointer();
+  return registration;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+//
+// ExecuteInternal
+//
+template <class TImageType>
+Image MultiResolutionDemonsRegistrationFilter::ExecuteInternal ( const Image * inFixedImage, const Image * inMovingImage, const Image * inInitialDisplacementField )
+{
+  // Define the input and output image types
+  typedef TImageType     InputImageType;
+  const unsigned int Dimension = InputImageType::ImageDimension;
+
+  typedef itk::Image< itk::Vector<double, Dimension>, Dimension > OutputImageType;
+  typedef itk::Image< float, Dimension >                          FloatImageType;
+
+  typedef itk::PDEDeformableRegistrationFilter<FloatImageType, FloatImageType, OutputImageType> RegistrationFilterType;
+  typedef itk::MultiResolutionPDEDeformableRegistration<InputImageType, InputImageType, OutputImageType, float, FloatImageType, RegistrationFilterType> FilterType;
+
+  // Set up the ITK filter
+  typename FilterType::Pointer filter = FilterType::New();
+
+  assert( inFixedImage != NULL );
+  filter->SetFixedImage( this->CastImageToITK<InputImageType>(*inFixedImage) );
+  assert( inMovingImage != NULL );
+  filter->SetMovingImage( this->CastImageToITK<InputImageType>(*inMovingImage) );
+  if ( inInitialDisplacementField != NULL )
+    {
+    typedef itk::VectorImage<double, Dimension> VectorImageType;
+    filter->SetArbitraryInitialDisplacementField( GetImageFromVectorImage(const_cast<VectorImageType*>(this->CastImageToITK<VectorImageType>(*inInitialDisplacementField).GetPointer()) ) );
+    }
+
+  if ( this->m_NumberOfLevels == 0 )
+    {
+    sitkExceptionMacro( "The number of levels must be at least one!" );
+    }
+  if ( this->m_NumberOfIterations.size() != 1 && this->m_NumberOfIterations.size() != this->m_NumberOfLevels )
+    {
+    sitkExceptionMacro( "The number of iterations per level and the number of levels don't match!" );
+    }
+  filter->SetNumberOfLevels( this->m_NumberOfLevels );
+  typename FilterType::NumberOfIterationsType numberOfIterations( this->m_NumberOfLevels, this->m_NumberOfIterations[0] );
+  if ( this->m_NumberOfIterations.size() == this->m_NumberOfLevels )
+    {
+    std::copy( this->m_NumberOfIterations.begin(), this->m_NumberOfIterations.end(), numberOfIterations.begin() );
+    }
+  filter->SetNumberOfIterations( numberOfIterations );
+
+  // release the old filter ( and output data )
+  if ( this->m_Filter != NULL)
+    {
+      this->m_pfGetCurrentLevel = SITK_NULLPTR;
+      this->m_pfGetElapsedIterations = SITK_NULLPTR;
+      this->m_pfGetRMSChange = SITK_NULLPTR;
+      this->m_pfGetMetric = SITK_NULLPTR;
+      this->m_Filter->UnRegister();
+      this->m_Filter = NULL;
+    }
+
+  // The same demons filter registers each level, so its buffers are
+  // reused by the levels of the pyramid.
+  typename RegistrationFilterType::Pointer registration;
+  switch ( this->m_DemonsType )
+    {
+    case SymmetricForces:
+      registration = CreateDemonsFilter< itk::SymmetricForcesDemonsRegistrationFilter<FloatImageType, FloatImageType, OutputImageType>, RegistrationFilterType >( this->m_IntensityDifferenceThreshold, this->m_pfGetMetric );
+      break;
+    case FastSymmetricForces:
+      registration = CreateDemonsFilter< itk::FastSymmetricForcesDemonsRegistrationFilter<FloatImageType, FloatImageType, OutputImageType>, RegistrationFilterType >( this->m_IntensityDifferenceThreshold, this->m_pfGetMetric );
+      break;
+    case Diffeomorphic:
+      registration = CreateDemonsFilter< itk::DiffeomorphicDemonsRegistrationFilter<FloatImageType, FloatImageType, OutputImageType>, RegistrationFilterType >( this->m_IntensityDifferenceThreshold, this->m_pfGetMetric );
+      break;
+    case Demons:
+    default:
+      registration = CreateDemonsFilter< itk::DemonsRegistrationFilter<FloatImageType, FloatImageType, OutputImageType>, RegistrationFilterType >( this->m_IntensityDifferenceThreshold, this->m_pfGetMetric );
+      break;
+    }
+
+  typename RegistrationFilterType::StandardDeviationsType itkVecStandardDeviations = sitkSTLVectorToITK<typename RegistrationFilterType::StandardDeviationsType>( this->GetStandardDeviations() );
+  registration->SetStandardDeviations( itkVecStandardDeviations );
+  registration->SetMaximumRMSError ( this->m_MaximumRMSError );
+  registration->SetSmoothDisplacementField ( this->m_SmoothDisplacementField );
+  registration->SetSmoothUpdateField ( this->m_SmoothUpdateField );
+  typename RegistrationFilterType::StandardDeviationsType itkVecUpdateFieldStandardDeviations = sitkSTLVectorToITK<typename RegistrationFilterType::StandardDeviationsType>( this->GetUpdateFieldStandardDeviations() );
+  registration->SetUpdateFieldStandardDeviations( itkVecUpdateFieldStandardDeviations );
+  registration->SetMaximumKernelWidth ( this->m_MaximumKernelWidth );
+  registration->SetMaximumError ( this->m_MaximumError );
+  registration->SetUseImageSpacing ( this->m_UseImageSpacing );
+  registration->SetNumberOfThreads( this->GetNumberOfThreads() );
+  filter->SetRegistrationFilter( registration );
+
+  this->m_Filter = filter;
+  this->m_Filter->Register();
+
+  this->PreUpdate( filter.GetPointer() );
+
+  this->m_pfGetCurrentLevel = nsstd::bind( &FilterType::GetCurrentLevel, filter.GetPointer() );
+  this->m_pfGetElapsedIterations = nsstd::bind( &RegistrationFilterType::GetElapsedIterations, registration.GetPointer() );
+  this->m_pfGetRMSChange = nsstd::bind( &RegistrationFilterType::GetRMSChange, registration.GetPointer() );
+
+  // Run the ITK filter and return the output as a SimpleITK image
+  filter->Update();
+
+  typename FilterType::OutputImageType *itkOutImage = filter->GetOutput();
+  this->FixNonZeroIndex( itkOutImage );
+  return Image( this->CastITKToImage(itkOutImage) );
+}
+
+} // end namespace simple
+} // end namespace itk
@@ -0,0 +1,226 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkN4BiasField_hxx
+#define sitkN4BiasField_hxx
+
+#include "sitkImage.h"
+#include "sitkExceptionObject.h"
+#include "sitkTemplateFunctions.h"
+
+#include <itkBSplineControlPointImageFilter.h>
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkShrinkImageFilter.h>
+#include <itkVector.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk {
+namespace simple {
+
+namespace
+{
+
+template< class TImage >
+typename TImage::Pointer ShrinkN4Image( const TImage *image, unsigned int shrinkFactor, int numberOfThreads )
+{
+  typedef itk::ShrinkImageFilter< TImage, TImage > ShrinkFilterType;
+  typename ShrinkFilterType::Pointer shrinker = ShrinkFilterType::New();
+  shrinker->SetInput( image );
+  const typename TImage::SizeType size = image->GetLargestPossibleRegion().GetSize();
+  for ( unsigned int d = 0; d < TImage::ImageDimension; ++d )
+    {
+    shrinker->SetShrinkFactor( d, std::max< unsigned int >( 1u, std::min< unsigned int >( shrinkFactor, size[d] ) ) );
+    }
+  shrinker->SetNumberOfThreads( numberOfThreads );
+  shrinker->Update();
+  typename TImage::Pointer output = shrinker->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+
+// The log bias field of the lattice on the grid of a reference image
+template< unsigned int VImageDimension >
+typename itk::Image< itk::Vector< float, 1 >, VImageDimension >::Pointer
+ReconstructN4LogBiasField( const itk::Image< itk::Vector< float, 1 >, VImageDimension > *lattice,
+                           const ImageBase< VImageDimension > *reference,
+                           unsigned int splineOrder )
+{
+  typedef itk::Image< itk::Vector< float, 1 >, VImageDimension > LatticeType;
+  typedef itk::BSplineControlPointImageFilter< LatticeType, LatticeType > BSplinerType;
+
+  typename BSplinerType::Pointer bspliner = BSplinerType::New();
+  bspliner->SetInput( lattice );
+  bspliner->SetSplineOrder( splineOrder );
+  bspliner->SetSize( reference->GetLargestPossibleRegion().GetSize() );
+  bspliner->SetOrigin( reference->GetOrigin() );
+  bspliner->SetSpacing( reference->GetSpacing() );
+  bspliner->SetDirection( reference->GetDirection() );
+  bspliner->Update();
+  typename LatticeType::Pointer field = bspliner->GetOutput();
+  field->DisconnectPipeline();
+  return field;
+}
+
+
+template< unsigned int VImageDimension >
+Image N4LogBiasFieldAsImage( const Image &latticeImage, const Image &referenceImage, unsigned int splineOrder )
+{
+  typedef itk::Image< float, VImageDimension >                   ScalarLatticeType;
+  typedef itk::Image< itk::Vector< float, 1 >, VImageDimension > LatticeType;
+  typedef itk::Image< float, VImageDimension >                   FieldType;
+
+  const ScalarLatticeType *scalarLattice = dynamic_cast< const ScalarLatticeType * >( latticeImage.GetITKBase() );
+  const ImageBase< VImageDimension > *reference = dynamic_cast< const ImageBase< VImageDimension > * >( referenceImage.GetITKBase() );
+  if ( scalarLattice == SITK_NULLPTR || reference == SITK_NULLPTR )
+    {
+    sitkExceptionMacro( "Unexpected lattice or reference image!" );
+    }
+
+  typename LatticeType::Pointer lattice = LatticeType::New();
+  lattice->CopyInformation( scalarLattice );
+  lattice->SetRegions( scalarLattice->GetLargestPossibleRegion() );
+  lattice->Allocate();
+  std::copy( scalarLattice->GetBufferPointer(),
+             scalarLattice->GetBufferPointer() + scalarLattice->GetPixelContainer()->Size(),
+             reinterpret_cast< float * >( lattice->GetBufferPointer() ) );
+
+  typename LatticeType::Pointer field = ReconstructN4LogBiasField( lattice.GetPointer(), reference, splineOrder );
+
+  typename FieldType::Pointer scalarField = FieldType::New();
+  scalarField->CopyInformation( field );
+  scalarField->SetRegions( field->GetLargestPossibleRegion() );
+  scalarField->Allocate();
+  std::copy( reinterpret_cast< const float * >( field->GetBufferPointer() ),
+             reinterpret_cast< const float * >( field->GetBufferPointer() ) + field->GetPixelContainer()->Size(),
+             scalarField->GetBufferPointer() );
+  return Image( scalarField );
+}
+
+}
+
+
+/** \brief Shrink the input and the mask of the N4 filter by the
+ * factor along each axis, at most the size of the axis, so the bias
+ * field is fitted to a low resolution image.
+ */
+template< class TFilter >
+void ShrinkN4Inputs( TFilter *filter, unsigned int shrinkFactor, int numberOfThreads )
+{
+  typedef typename TFilter::InputImageType InputImageType;
+  typedef typename TFilter::MaskImageType  MaskImageType;
+
+  typename InputImageType::Pointer input = ShrinkN4Image( filter->GetInput(), shrinkFactor, numberOfThreads );
+  const MaskImageType *mask = filter->GetMaskImage();
+  typename MaskImageType::Pointer shrunkMask;
+  if ( mask != SITK_NULLPTR )
+    {
+    shrunkMask = ShrinkN4Image( mask, shrinkFactor, numberOfThreads );
+    }
+
+  filter->SetInput( input );
+  if ( shrunkMask.IsNotNull() )
+    {
+    filter->SetMaskImage( shrunkMask );
+    }
+}
+
+
+/** \brief The control point lattice of the log bias field of the N4
+ * filter as an image of float, with the physical space of the
+ * lattice. */
+template< class TLattice >
+Image N4LatticeToImage( const TLattice *lattice )
+{
+  typedef itk::Image< float, TLattice::ImageDimension > ScalarLatticeType;
+
+  typename ScalarLatticeType::Pointer scalarLattice = ScalarLatticeType::New();
+  scalarLattice->CopyInformation( lattice );
+  scalarLattice->SetRegions( lattice->GetLargestPossibleRegion() );
+  scalarLattice->Allocate();
+
+  ImageRegionConstIterator< TLattice > it( lattice, lattice->GetLargestPossibleRegion() );
+  ImageRegionIterator< ScalarLatticeType > ot( scalarLattice, scalarLattice->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it, ++ot )
+    {
+    ot.Set( it.Get()[0] );
+    }
+  return Image( scalarLattice );
+}
+
+
+/** \brief Correct an image by the log bias field of the lattice
+ * evaluated on its grid, the image divided by the exponential of the
+ * field. */
+template< class TImage >
+typename TImage::Pointer CorrectN4AtResolution( const TImage *image,
+                                                const itk::Image< itk::Vector< float, 1 >, TImage::ImageDimension > *lattice,
+                                                unsigned int splineOrder )
+{
+  typedef itk::Image< itk::Vector< float, 1 >, TImage::ImageDimension > LatticeType;
+
+  typename LatticeType::Pointer field = ReconstructN4LogBiasField< TImage::ImageDimension >( lattice, image, splineOrder );
+
+  typename TImage::Pointer corrected = TImage::New();
+  corrected->CopyInformation( image );
+  corrected->SetRegions( image->GetLargestPossibleRegion() );
+  corrected->Allocate();
+
+  ImageRegionConstIterator< TImage > it( image, image->GetLargestPossibleRegion() );
+  ImageRegionConstIterator< LatticeType > ft( field, field->GetLargestPossibleRegion() );
+  ImageRegionIterator< TImage > ot( corrected, corrected->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it, ++ft, ++ot )
+    {
+    ot.Set( static_cast< typename TImage::PixelType >( it.Get() / std::exp( ft.Get()[0] ) ) );
+    }
+  return corrected;
+}
+
+
+/** \brief The log bias field of a lattice returned by N4LatticeToImage
+ * on the grid of a reference image, as an image of float.
+ */
+inline Image N4LogBiasFieldAsImage( const Image &latticeImage, const Image &referenceImage, unsigned int splineOrder )
+{
+  if ( latticeImage.GetNumberOfPixels() <= 1 )
+    {
+    sitkExceptionMacro( "The bias field is computed by an execution of the filter!" );
+    }
+  if ( referenceImage.GetDimension() != latticeImage.GetDimension() )
+    {
+    sitkExceptionMacro( "The reference image does not match the dimension of the bias field!" );
+    }
+
+  switch ( latticeImage.GetDimension() )
+    {
+    case 2:
+      return N4LogBiasFieldAsImage< 2 >( latticeImage, referenceImage, splineOrder );
+    case 3:
+      return N4LogBiasFieldAsImage< 3 >( latticeImage, referenceImage, splineOrder );
+    default:
+      sitkExceptionMacro( "Unsupported dimension: " << latticeImage.GetDimension() );
+    }
+}
+
+} // end namespace simple
+} // end namespace itk
+
+#endif
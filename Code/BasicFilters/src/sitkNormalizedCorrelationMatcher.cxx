@@ -0,0 +1,479 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkNormalizedCorrelationMatcher.h"
+#include "sitkCastImageFilter.h"
+#include "sitkExceptionObject.h"
+#include "sitkFFTTransforms.hxx"
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+namespace itk {
+  namespace simple {
+
+    namespace
+    {
+
+    // The image times the mask, to the power 0, 1 or 2, padded with
+    // zeros to the padded size, and rotated by 180 degrees for the
+    // moving image.
+    template< class TRealImage >
+    typename TRealImage::Pointer PadCorrelationTerm( const TRealImage *image,
+                                                     const TRealImage *mask,
+                                                     unsigned int power,
+                                                     bool rotate,
+                                                     const std::vector<unsigned int> &paddedSize )
+    {
+      const unsigned int Dimension = TRealImage::ImageDimension;
+
+      typename TRealImage::RegionType region;
+      for ( unsigned int d = 0; d < Dimension; ++d )
+        {
+        region.SetIndex( d, 0 );
+        region.SetSize( d, paddedSize[d] );
+        }
+      typename TRealImage::Pointer padded = TRealImage::New();
+      padded->SetRegions( region );
+      padded->Allocate();
+      padded->FillBuffer( 0.0 );
+
+      const typename TRealImage::RegionType imageRegion = image->GetLargestPossibleRegion();
+      ImageRegionConstIteratorWithIndex< TRealImage > it( image, imageRegion );
+      for ( ; !it.IsAtEnd(); ++it )
+        {
+        typename TRealImage::IndexType index;
+        for ( unsigned int d = 0; d < Dimension; ++d )
+          {
+          const IndexValueType r = it.GetIndex()[d] - imageRegion.GetIndex( d );
+          index[d] = rotate ? static_cast<IndexValueType>( imageRegion.GetSize( d ) ) - 1 - r : r;
+          }
+        if ( mask != SITK_NULLPTR && mask->GetPixel( it.GetIndex() ) == 0.0 )
+          {
+          continue;
+          }
+        const double value = it.Get();
+        padded->SetPixel( index, power == 0 ? 1.0 : ( power == 1 ? value : value * value ) );
+        }
+      return padded;
+    }
+
+
+    template< class TComplexImage >
+    typename TComplexImage::Pointer MultiplyTransforms( const TComplexImage *a, const TComplexImage *b )
+    {
+      typename TComplexImage::Pointer product = TComplexImage::New();
+      product->CopyInformation( a );
+      product->SetRegions( a->GetLargestPossibleRegion() );
+      product->Allocate();
+      const typename TComplexImage::PixelType *p = a->GetBufferPointer();
+      const typename TComplexImage::PixelType *q = b->GetBufferPointer();
+      typename TComplexImage::PixelType *r = product->GetBufferPointer();
+      const size_t n = product->GetPixelContainer()->Size();
+      for ( size_t i = 0; i < n; ++i )
+        {
+        r[i] = p[i] * q[i];
+        }
+      return product;
+    }
+
+
+    bool HasGreaterValue( const std::pair<double, size_t> &a, const std::pair<double, size_t> &b )
+    {
+      return a.first > b.first || ( a.first == b.first && a.second < b.second );
+    }
+
+    }
+
+
+    NormalizedCorrelationMatcher::NormalizedCorrelationMatcher()
+      : m_RequiredNumberOfOverlappingPixels( 0u ),
+        m_RequiredFractionOfOverlappingPixels( 0.0f )
+    {
+    }
+
+
+    NormalizedCorrelationMatcher::~NormalizedCorrelationMatcher()
+    {
+    }
+
+
+    NormalizedCorrelationMatcher::Self& NormalizedCorrelationMatcher::SetFixedImage( const Image &fixedImage )
+    {
+      this->m_FixedImage = fixedImage;
+      this->ReleaseFixedTransforms();
+      return *this;
+    }
+
+
+    NormalizedCorrelationMatcher::Self& NormalizedCorrelationMatcher::SetFixedImageMask( const Image &fixedImageMask )
+    {
+      this->m_FixedImageMask = fixedImageMask;
+      this->ReleaseFixedTransforms();
+      return *this;
+    }
+
+
+    void NormalizedCorrelationMatcher::ReleaseFixedTransforms()
+    {
+      this->m_FixedTransform = Image();
+      this->m_FixedSquaredTransform = Image();
+      this->m_FixedMaskTransform = Image();
+      this->m_PaddedSize.clear();
+    }
+
+
+    Image NormalizedCorrelationMatcher::Execute( const Image &movingImage )
+    {
+      return this->ExecuteInternal( movingImage, SITK_NULLPTR, movingImage.GetSize() );
+    }
+
+
+    Image NormalizedCorrelationMatcher::Execute( const Image &movingImage, const Image &movingImageMask )
+    {
+      return this->ExecuteInternal( movingImage, &movingImageMask, movingImage.GetSize() );
+    }
+
+
+    std::vector<Image> NormalizedCorrelationMatcher::Execute( const std::vector<Image> &movingImages )
+    {
+      std::vector<Image> correlations;
+      if ( movingImages.empty() )
+        {
+        return correlations;
+        }
+
+      std::vector<unsigned int> largestMovingSize = movingImages[0].GetSize();
+      for ( size_t i = 1; i < movingImages.size(); ++i )
+        {
+        const std::vector<unsigned int> size = movingImages[i].GetSize();
+        for ( unsigned int d = 0; d < std::min( size.size(), largestMovingSize.size() ); ++d )
+          {
+          largestMovingSize[d] = std::max( largestMovingSize[d], size[d] );
+          }
+        }
+
+      correlations.reserve( movingImages.size() );
+      for ( size_t i = 0; i < movingImages.size(); ++i )
+        {
+        correlations.push_back( this->ExecuteInternal( movingImages[i], SITK_NULLPTR, largestMovingSize ) );
+        }
+      return correlations;
+    }
+
+
+    std::vector< std::vector<unsigned int> > NormalizedCorrelationMatcher::FindPeaks( const Image &movingImage, unsigned int numberOfPeaks )
+    {
+      const Image correlation = this->ExecuteInternal( movingImage, SITK_NULLPTR, movingImage.GetSize() );
+      const std::vector<unsigned int> size = correlation.GetSize();
+      const unsigned int dimension = correlation.GetDimension();
+      const double *values = correlation.GetBufferAsDouble();
+      const size_t numberOfPixels = correlation.GetNumberOfPixels();
+
+      // the offsets of the 3^dimension - 1 neighbors
+      std::vector< std::vector<int> > offsets;
+      unsigned int numberOfNeighbors = 1;
+      for ( unsigned int d = 0; d < dimension; ++d )
+        {
+        numberOfNeighbors *= 3;
+        }
+      for ( unsigned int n = 0; n < numberOfNeighbors; ++n )
+        {
+        std::vector<int> offset( dimension );
+        bool center = true;
+        for ( unsigned int d = 0, m = n; d < dimension; ++d, m /= 3 )
+          {
+          offset[d] = static_cast<int>( m % 3 ) - 1;
+          center = center && offset[d] == 0;
+          }
+        if ( !center )
+          {
+          offsets.push_back( offset );
+          }
+        }
+
+      // a pixel of a plateau is a peak only when it is the first of
+      // the plateau in the order of the buffer
+      std::vector< std::pair<double, size_t> > peaks;
+      std::vector<int> index( dimension );
+      for ( size_t i = 0; i < numberOfPixels; ++i )
+        {
+        size_t remainder = i;
+        for ( unsigned int d = 0; d < dimension; ++d )
+          {
+          index[d] = static_cast<int>( remainder % size[d] );
+          remainder /= size[d];
+          }
+
+        bool isPeak = true;
+        for ( size_t o = 0; o < offsets.size() && isPeak; ++o )
+          {
+          size_t neighbor = 0;
+          size_t stride = 1;
+          bool inside = true;
+          for ( unsigned int d = 0; d < dimension; ++d )
+            {
+            const int n = index[d] + offsets[o][d];
+            if ( n < 0 || n >= static_cast<int>( size[d] ) )
+              {
+              inside = false;
+              break;
+              }
+            neighbor += n * stride;
+            stride *= size[d];
+            }
+          if ( inside )
+            {
+            isPeak = ( neighbor < i ) ? values[i] > values[neighbor] : values[i] >= values[neighbor];
+            }
+          }
+        if ( isPeak )
+          {
+          peaks.push_back( std::make_pair( values[i], i ) );
+          }
+        }
+
+      const size_t numberOfFoundPeaks = std::min( peaks.size(), size_t( numberOfPeaks ) );
+      std::partial_sort( peaks.begin(), peaks.begin() + numberOfFoundPeaks, peaks.end(), HasGreaterValue );
+
+      std::vector< std::vector<unsigned int> > peakIndexes;
+      this->m_PeakValues.clear();
+      for ( size_t p = 0; p < numberOfFoundPeaks; ++p )
+        {
+        std::vector<unsigned int> peakIndex( dimension );
+        size_t remainder = peaks[p].second;
+        for ( unsigned int d = 0; d < dimension; ++d )
+          {
+          peakIndex[d] = static_cast<unsigned int>( remainder % size[d] );
+          remainder /= size[d];
+          }
+        peakIndexes.push_back( peakIndex );
+        this->m_PeakValues.push_back( peaks[p].first );
+        }
+      return peakIndexes;
+    }
+
+
+    Image NormalizedCorrelationMatcher::ExecuteInternal( const Image &movingImage,
+                                                         const Image *movingImageMask,
+                                                         const std::vector<unsigned int> &largestMovingSize )
+    {
+      if ( this->m_FixedImage.GetNumberOfPixels() == 0 )
+        {
+        sitkExceptionMacro( "The fixed image is not set!" );
+        }
+      const unsigned int dimension = this->m_FixedImage.GetDimension();
+      if ( movingImage.GetDimension() != dimension )
+        {
+        sitkExceptionMacro( "The moving image does not match the dimension of the fixed image!" );
+        }
+      if ( this->m_FixedImageMask.GetNumberOfPixels() != 0 && this->m_FixedImageMask.GetSize() != this->m_FixedImage.GetSize() )
+        {
+        sitkExceptionMacro( "The fixed image mask does not match the size of the fixed image!" );
+        }
+      if ( movingImageMask != SITK_NULLPTR && movingImageMask->GetSize() != movingImage.GetSize() )
+        {
+        sitkExceptionMacro( "The moving image mask does not match the size of the moving image!" );
+        }
+
+      switch ( dimension )
+        {
+        case 2:
+          return this->ExecuteInternal<2>( movingImage, movingImageMask, largestMovingSize );
+        case 3:
+          return this->ExecuteInternal<3>( movingImage, movingImageMask, largestMovingSize );
+        default:
+          sitkExceptionMacro( "Unsupported dimension: " << dimension );
+        }
+    }
+
+
+    template <unsigned int VImageDimension>
+    Image NormalizedCorrelationMatcher::ExecuteInternal( const Image &movingImage,
+                                                         const Image *movingImageMask,
+                                                         const std::vector<unsigned int> &largestMovingSize )
+    {
+      typedef itk::Image< double, VImageDimension >                RealImageType;
+      typedef itk::Image< std::complex<double>, VImageDimension >  ComplexImageType;
+      typedef itk::RealToHalfHermitianForwardFFTImageFilter< RealImageType, ComplexImageType > ForwardFFTType;
+      typedef itk::HalfHermitianToRealInverseFFTImageFilter< ComplexImageType, RealImageType > InverseFFTType;
+
+      typename ForwardFFTType::Pointer forwardFFT = ForwardFFTType::New();
+      forwardFFT->SetNumberOfThreads( this->GetNumberOfThreads() );
+      typename InverseFFTType::Pointer inverseFFT = InverseFFTType::New();
+      inverseFFT->SetNumberOfThreads( this->GetNumberOfThreads() );
+
+      const Image fixedImage = Cast( this->m_FixedImage, sitkFloat64 );
+      const RealImageType *fixed = dynamic_cast< const RealImageType * >( fixedImage.GetITKBase() );
+      assert( fixed != SITK_NULLPTR );
+
+      const Image movingRealImage = Cast( movingImage, sitkFloat64 );
+      const RealImageType *moving = dynamic_cast< const RealImageType * >( movingRealImage.GetITKBase() );
+      assert( moving != SITK_NULLPTR );
+      Image movingMaskImage;
+      const RealImageType *movingMask = SITK_NULLPTR;
+      if ( movingImageMask != SITK_NULLPTR )
+        {
+        movingMaskImage = Cast( *movingImageMask, sitkFloat64 );
+        movingMask = dynamic_cast< const RealImageType * >( movingMaskImage.GetITKBase() );
+        }
+
+      const std::vector<unsigned int> fixedSize = this->m_FixedImage.GetSize();
+      const std::vector<unsigned int> movingSize = movingImage.GetSize();
+
+      // the correlation is not wrapped around in a size of at least
+      // the fixed size plus the moving size minus one
+      bool computeFixedTransforms = this->m_PaddedSize.empty();
+      std::vector<unsigned int> paddedSize( VImageDimension );
+      for ( unsigned int d = 0; d < VImageDimension; ++d )
+        {
+        const unsigned int largestSize = std::max( movingSize[d], d < largestMovingSize.size() ? largestMovingSize[d] : 0u );
+        paddedSize[d] = FFTSize( fixedSize[d] + largestSize - 1,
+                                 static_cast<unsigned int>( forwardFFT->GetSizeGreatestPrimeFactor() ) );
+        computeFixedTransforms = computeFixedTransforms || this->m_PaddedSize[d] < fixedSize[d] + movingSize[d] - 1;
+        }
+
+      if ( computeFixedTransforms )
+        {
+        Image fixedMaskImage;
+        const RealImageType *fixedMask = SITK_NULLPTR;
+        if ( this->m_FixedImageMask.GetNumberOfPixels() != 0 )
+          {
+          fixedMaskImage = Cast( this->m_FixedImageMask, sitkFloat64 );
+          fixedMask = dynamic_cast< const RealImageType * >( fixedMaskImage.GetITKBase() );
+          }
+        this->m_FixedTransform = Image( ForwardTransform( forwardFFT.GetPointer(), PadCorrelationTerm( fixed, fixedMask, 1, false, paddedSize ).GetPointer() ) );
+        this->m_FixedSquaredTransform = Image( ForwardTransform( forwardFFT.GetPointer(), PadCorrelationTerm( fixed, fixedMask, 2, false, paddedSize ).GetPointer() ) );
+        this->m_FixedMaskTransform = Image( ForwardTransform( forwardFFT.GetPointer(), PadCorrelationTerm( fixed, fixedMask, 0, false, paddedSize ).GetPointer() ) );
+        this->m_PaddedSize = paddedSize;
+        }
+      paddedSize = this->m_PaddedSize;
+
+      const ComplexImageType *fixedTransform = dynamic_cast< const ComplexImageType * >( this->m_FixedTransform.GetITKBase() );
+      const ComplexImageType *fixedSquaredTransform = dynamic_cast< const ComplexImageType * >( this->m_FixedSquaredTransform.GetITKBase() );
+      const ComplexImageType *fixedMaskTransform = dynamic_cast< const ComplexImageType * >( this->m_FixedMaskTransform.GetITKBase() );
+      assert( fixedTransform != SITK_NULLPTR && fixedSquaredTransform != SITK_NULLPTR && fixedMaskTransform != SITK_NULLPTR );
+
+      typename ComplexImageType::Pointer movingTransform =
+        ForwardTransform( forwardFFT.GetPointer(), PadCorrelationTerm( moving, movingMask, 1, true, paddedSize ).GetPointer() );
+      typename ComplexImageType::Pointer movingSquaredTransform =
+        ForwardTransform( forwardFFT.GetPointer(), PadCorrelationTerm( moving, movingMask, 2, true, paddedSize ).GetPointer() );
+      typename ComplexImageType::Pointer movingMaskTransform =
+        ForwardTransform( forwardFFT.GetPointer(), PadCorrelationTerm( moving, movingMask, 0, true, paddedSize ).GetPointer() );
+
+      inverseFFT->SetActualXDimensionIsOdd( paddedSize[0] % 2 == 1 );
+      typename RealImageType::Pointer fixedMoving =
+        InverseTransform( inverseFFT.GetPointer(), MultiplyTransforms( fixedTransform, movingTransform.GetPointer() ).GetPointer() );
+      typename RealImageType::Pointer fixedMovingMask =
+        InverseTransform( inverseFFT.GetPointer(), MultiplyTransforms( fixedTransform, movingMaskTransform.GetPointer() ).GetPointer() );
+      typename RealImageType::Pointer fixedMaskMoving =
+        InverseTransform( inverseFFT.GetPointer(), MultiplyTransforms( fixedMaskTransform, movingTransform.GetPointer() ).GetPointer() );
+      typename RealImageType::Pointer overlap =
+        InverseTransform( inverseFFT.GetPointer(), MultiplyTransforms( fixedMaskTransform, movingMaskTransform.GetPointer() ).GetPointer() );
+      typename RealImageType::Pointer fixedSquaredMovingMask =
+        InverseTransform( inverseFFT.GetPointer(), MultiplyTransforms( fixedSquaredTransform, movingMaskTransform.GetPointer() ).GetPointer() );
+      typename RealImageType::Pointer fixedMaskMovingSquared =
+        InverseTransform( inverseFFT.GetPointer(), MultiplyTransforms( fixedMaskTransform, movingSquaredTransform.GetPointer() ).GetPointer() );
+
+      // the correlation of the placements of the moving image
+      // overlapping the fixed image
+      typename RealImageType::RegionType outputRegion;
+      typename RealImageType::IndexType originIndex;
+      for ( unsigned int d = 0; d < VImageDimension; ++d )
+        {
+        outputRegion.SetIndex( d, 0 );
+        outputRegion.SetSize( d, fixedSize[d] + movingSize[d] - 1 );
+        originIndex[d] = fixed->GetLargestPossibleRegion().GetIndex( d ) - static_cast<IndexValueType>( movingSize[d] ) + 1;
+        }
+
+      double largestOverlap = 0.0;
+      double largestFixedSquared = 0.0;
+      double largestMovingSquared = 0.0;
+      ImageRegionConstIteratorWithIndex< RealImageType > it( overlap, outputRegion );
+      for ( ; !it.IsAtEnd(); ++it )
+        {
+        largestOverlap = std::max( largestOverlap, it.Get() );
+        largestFixedSquared = std::max( largestFixedSquared, std::abs( fixedSquaredMovingMask->GetPixel( it.GetIndex() ) ) );
+        largestMovingSquared = std::max( largestMovingSquared, std::abs( fixedMaskMovingSquared->GetPixel( it.GetIndex() ) ) );
+        }
+      const double requiredOverlap = std::max( 1.0, std::max( double( this->m_RequiredNumberOfOverlappingPixels ),
+                                                              std::ceil( this->m_RequiredFractionOfOverlappingPixels * Math::Round<double>( largestOverlap ) ) ) );
+      const double fixedTolerance = 1000.0 * std::numeric_limits<double>::epsilon() * largestFixedSquared;
+      const double movingTolerance = 1000.0 * std::numeric_limits<double>::epsilon() * largestMovingSquared;
+
+      typename RealImageType::Pointer output = RealImageType::New();
+      output->SetRegions( outputRegion );
+      output->SetSpacing( fixed->GetSpacing() );
+      output->SetDirection( fixed->GetDirection() );
+      typename RealImageType::PointType origin;
+      fixed->TransformIndexToPhysicalPoint( originIndex, origin );
+      output->SetOrigin( origin );
+      output->Allocate();
+
+      ImageRegionIteratorWithIndex< RealImageType > ot( output, outputRegion );
+      for ( ; !ot.IsAtEnd(); ++ot )
+        {
+        const typename RealImageType::IndexType index = ot.GetIndex();
+        const double n = Math::Round<double>( overlap->GetPixel( index ) );
+        if ( n < requiredOverlap )
+          {
+          ot.Set( 0.0 );
+          continue;
+          }
+        const double fm = fixedMovingMask->GetPixel( index );
+        const double mm = fixedMaskMoving->GetPixel( index );
+        const double numerator = fixedMoving->GetPixel( index ) - fm * mm / n;
+        const double fixedDenominator = fixedSquaredMovingMask->GetPixel( index ) - fm * fm / n;
+        const double movingDenominator = fixedMaskMovingSquared->GetPixel( index ) - mm * mm / n;
+        if ( fixedDenominator <= fixedTolerance || movingDenominator <= movingTolerance )
+          {
+          ot.Set( 0.0 );
+          continue;
+          }
+        const double correlation = numerator / std::sqrt( fixedDenominator * movingDenominator );
+        ot.Set( std::max( -1.0, std::min( 1.0, correlation ) ) );
+        }
+
+      return Image( output );
+    }
+
+
+    std::string NormalizedCorrelationMatcher::ToString() const
+    {
+      std::ostringstream out;
+      out << "itk::simple::NormalizedCorrelationMatcher" << std::endl;
+      out << "  RequiredNumberOfOverlappingPixels: " << this->m_RequiredNumberOfOverlappingPixels << std::endl;
+      out << "  RequiredFractionOfOverlappingPixels: " << this->m_RequiredFractionOfOverlappingPixels << std::endl;
+      out << "  PaddedSize: ";
+      this->ToStringHelper( out, this->m_PaddedSize );
+      out << std::endl;
+      out << ProcessObject::ToString();
+      return out.str();
+    }
+
+  }
+}
@@ -0,0 +1,804 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkPackedBinaryImage.h"
+#include "sitkMemberFunctionFactory.h"
+#include "sitkExceptionObject.h"
+
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace itk {
+  namespace simple {
+
+    namespace
+    {
+
+    const uint64_t One = 1;
+
+    inline bool GetBit( const uint64_t *words, size_t bit )
+    {
+      return ( ( words[bit >> 6] >> ( bit & 63 ) ) & One ) != 0;
+    }
+
+    inline unsigned int CountBits( uint64_t w )
+    {
+      w = w - ( ( w >> 1 ) & 0x5555555555555555ULL );
+      w = ( w & 0x3333333333333333ULL ) + ( ( w >> 2 ) & 0x3333333333333333ULL );
+      w = ( w + ( w >> 4 ) ) & 0x0f0f0f0f0f0f0f0fULL;
+      return static_cast<unsigned int>( ( w * 0x0101010101010101ULL ) >> 56 );
+    }
+
+    // out[x] = in[x + s], zero after the end of the line
+    void ShiftDown( const uint64_t *in, uint64_t *out, size_t n, size_t s )
+    {
+      const size_t ws = s >> 6;
+      const unsigned int bs = static_cast<unsigned int>( s & 63 );
+      for ( size_t i = 0; i < n; ++i )
+        {
+        uint64_t w = 0;
+        if ( i + ws < n )
+          {
+          w = in[i + ws] >> bs;
+          if ( bs != 0 && i + ws + 1 < n )
+            {
+            w |= in[i + ws + 1] << ( 64 - bs );
+            }
+          }
+        out[i] = w;
+        }
+    }
+
+    // out[x] = in[x - s], zero before the start of the line
+    void ShiftUp( const uint64_t *in, uint64_t *out, size_t n, size_t s )
+    {
+      const size_t ws = s >> 6;
+      const unsigned int bs = static_cast<unsigned int>( s & 63 );
+      for ( size_t i = 0; i < n; ++i )
+        {
+        uint64_t w = 0;
+        if ( i >= ws )
+          {
+          w = in[i - ws] << bs;
+          if ( bs != 0 && i > ws )
+            {
+            w |= in[i - ws - 1] >> ( 64 - bs );
+            }
+          }
+        out[i] = w;
+        }
+    }
+
+    typedef void (*PackLineFunctionType)( const void *buffer, size_t start, size_t n, uint64_t *words, size_t firstBit );
+    typedef void (*MaskLineFunctionType)( void *buffer, size_t start, size_t n, const uint64_t *words, double outsideValue );
+
+    template <typename TElement>
+    void PackLine( const void *buffer, size_t start, size_t n, uint64_t *words, size_t firstBit )
+    {
+      const TElement *in = static_cast<const TElement *>( buffer ) + start;
+      size_t i = 0;
+
+      // whole words when the line starts on a word
+      if ( ( firstBit & 63 ) == 0 )
+        {
+        for ( ; i + 64 <= n; i += 64 )
+          {
+          uint64_t w = 0;
+          for ( unsigned int b = 0; b < 64; ++b )
+            {
+            w |= static_cast<uint64_t>( in[i + b] != TElement( 0 ) ) << b;
+            }
+          words[( firstBit + i ) >> 6] = w;
+          }
+        }
+
+      for ( ; i < n; ++i )
+        {
+        const size_t bit = firstBit + i;
+        const uint64_t mask = One << ( bit & 63 );
+        if ( in[i] != TElement( 0 ) )
+          {
+          words[bit >> 6] |= mask;
+          }
+        else
+          {
+          words[bit >> 6] &= ~mask;
+          }
+        }
+    }
+
+    template <typename TElement>
+    void MaskLine( void *buffer, size_t start, size_t n, const uint64_t *words, double outsideValue )
+    {
+      TElement *out = static_cast<TElement *>( buffer ) + start;
+      const TElement outside = static_cast<TElement>( outsideValue );
+      for ( size_t i = 0; i < n; i += 64 )
+        {
+        const uint64_t w = words[i >> 6];
+        if ( w == ~uint64_t( 0 ) )
+          {
+          continue;
+          }
+        const size_t end = std::min( n, i + 64 );
+        for ( size_t j = i; j < end; ++j )
+          {
+          if ( !( ( w >> ( j & 63 ) ) & One ) )
+            {
+            out[j] = outside;
+            }
+          }
+        }
+    }
+
+    struct LineFunctions
+    {
+      PackLineFunctionType m_Pack;
+      MaskLineFunctionType m_Mask;
+    };
+
+    // Selects the functions for a pixel type
+    class LineFunctionsSelector
+    {
+    public:
+      typedef LineFunctionsSelector Self;
+      typedef LineFunctions (Self::*MemberFunctionType)( void );
+
+      LineFunctionsSelector( unsigned int dimension )
+        : m_Dimension( dimension ),
+          m_MemberFactory( this )
+        {
+          m_MemberFactory.RegisterMemberFunctions< BasicPixelIDTypeList, 4 > ();
+          m_MemberFactory.RegisterMemberFunctions< BasicPixelIDTypeList, 3 > ();
+          m_MemberFactory.RegisterMemberFunctions< BasicPixelIDTypeList, 2 > ();
+        }
+
+      LineFunctions Select( PixelIDValueEnum pixelID )
+        {
+          return m_MemberFactory.GetMemberFunction( pixelID, m_Dimension )();
+        }
+
+      template <class TImageType>
+      LineFunctions ExecuteInternal( void )
+        {
+          typedef typename TImageType::PixelType ElementType;
+          LineFunctions f;
+          f.m_Pack = &PackLine<ElementType>;
+          f.m_Mask = &MaskLine<ElementType>;
+          return f;
+        }
+
+    private:
+      unsigned int                                      m_Dimension;
+      detail::MemberFunctionFactory<MemberFunctionType> m_MemberFactory;
+    };
+
+    // The lines of a region of an image and of the packed image
+    struct RegionLines
+    {
+      RegionLines( const std::vector<unsigned int> &imageSize,
+                   const std::vector<unsigned int> &index,
+                   const std::vector<unsigned int> &size )
+        : m_ImageSize( imageSize ),
+          m_Index( index ),
+          m_Size( size )
+        {
+        }
+
+      size_t GetNumberOfLines( ) const
+        {
+          size_t n = 1;
+          for ( size_t d = 1; d < m_Size.size(); ++d )
+            {
+            n *= m_Size[d];
+            }
+          return n;
+        }
+
+      // the line of the packed image of a line of the region
+      size_t GetImageLine( size_t line ) const
+        {
+          size_t imageLine = 0;
+          size_t stride = 1;
+          for ( size_t d = 1; d < m_Size.size(); ++d )
+            {
+            imageLine += ( m_Index[d] + line % m_Size[d] ) * stride;
+            line /= m_Size[d];
+            stride *= m_ImageSize[d];
+            }
+          return imageLine;
+        }
+
+      std::vector<unsigned int> m_ImageSize;
+      std::vector<unsigned int> m_Index;
+      std::vector<unsigned int> m_Size;
+    };
+
+    typedef void (*LinesFunctionType)( void *data, size_t begin, size_t end );
+
+    struct LinesThreadStruct
+    {
+      LinesFunctionType m_Function;
+      void             *m_Data;
+      size_t            m_NumberOfLines;
+    };
+
+    ITK_THREAD_RETURN_TYPE LinesThreaderCallback( void *arg )
+    {
+      typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+      ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+      LinesThreadStruct *str = static_cast<LinesThreadStruct *>( info->UserData );
+
+      const size_t begin = str->m_NumberOfLines * info->ThreadID / info->NumberOfThreads;
+      const size_t end = str->m_NumberOfLines * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+      if ( begin < end )
+        {
+        str->m_Function( str->m_Data, begin, end );
+        }
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+    // Call the function for ranges of the lines in several threads
+    void ForEachLines( LinesFunctionType function, void *data, size_t numberOfLines )
+    {
+      // lines fewer than this are processed by the calling thread
+      const size_t minimumLinesPerThread = 64;
+      const size_t numberOfThreads =
+        std::max<size_t>( 1, std::min<size_t>( itk::MultiThreader::GetGlobalDefaultNumberOfThreads(),
+                                               numberOfLines / minimumLinesPerThread ) );
+
+      LinesThreadStruct str;
+      str.m_Function = function;
+      str.m_Data = data;
+      str.m_NumberOfLines = numberOfLines;
+
+      itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+      threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+      threader->SetSingleMethod( LinesThreaderCallback, &str );
+      threader->SingleMethodExecute();
+    }
+
+    struct PackData
+    {
+      const RegionLines   *m_Lines;
+      PackLineFunctionType m_Pack;
+      const void          *m_Buffer;
+      uint64_t            *m_Words;
+      size_t               m_WordsPerLine;
+    };
+
+    void PackLines( void *data, size_t begin, size_t end )
+    {
+      const PackData *str = static_cast<const PackData *>( data );
+      const size_t n = str->m_Lines->m_Size[0];
+      for ( size_t line = begin; line < end; ++line )
+        {
+        uint64_t *words = str->m_Words + str->m_Lines->GetImageLine( line ) * str->m_WordsPerLine;
+        str->m_Pack( str->m_Buffer, line * n, n, words, str->m_Lines->m_Index[0] );
+        }
+    }
+
+    struct UnpackData
+    {
+      const RegionLines *m_Lines;
+      const uint64_t    *m_Words;
+      size_t             m_WordsPerLine;
+      uint8_t           *m_Buffer;
+      uint8_t            m_ForegroundValue;
+    };
+
+    void UnpackLines( void *data, size_t begin, size_t end )
+    {
+      const UnpackData *str = static_cast<const UnpackData *>( data );
+      const size_t n = str->m_Lines->m_Size[0];
+      const size_t firstBit = str->m_Lines->m_Index[0];
+      for ( size_t line = begin; line < end; ++line )
+        {
+        const uint64_t *words = str->m_Words + str->m_Lines->GetImageLine( line ) * str->m_WordsPerLine;
+        uint8_t *out = str->m_Buffer + line * n;
+        for ( size_t i = 0; i < n; ++i )
+          {
+          out[i] = GetBit( words, firstBit + i ) ? str->m_ForegroundValue : 0;
+          }
+        }
+    }
+
+    struct MaskData
+    {
+      MaskLineFunctionType m_Mask;
+      void                *m_Buffer;
+      const uint64_t      *m_Words;
+      size_t               m_WordsPerLine;
+      size_t               m_LineLength;
+      double               m_OutsideValue;
+    };
+
+    void MaskLines( void *data, size_t begin, size_t end )
+    {
+      const MaskData *str = static_cast<const MaskData *>( data );
+      for ( size_t line = begin; line < end; ++line )
+        {
+        str->m_Mask( str->m_Buffer, line * str->m_LineLength, str->m_LineLength,
+                     str->m_Words + line * str->m_WordsPerLine, str->m_OutsideValue );
+        }
+    }
+
+    struct DilateData
+    {
+      const uint64_t *m_Input;
+      uint64_t       *m_Output;
+      size_t          m_WordsPerLine;
+      uint64_t        m_LastWordMask;
+      unsigned int    m_Radius;
+      // along the first axis, the number of pixels of a line
+      size_t          m_LineLength;
+      // along another axis, the lines between neighbors and the size
+      size_t          m_LineStride;
+      size_t          m_AxisSize;
+    };
+
+    // Dilate the lines along the first axis: the windows of r+1
+    // pixels after and before each pixel are doubled in turn, with
+    // the pixels outside of the line background
+    void DilateLinesAlongFirstAxis( void *data, size_t begin, size_t end )
+    {
+      const DilateData *str = static_cast<const DilateData *>( data );
+      const size_t n = str->m_WordsPerLine;
+      const size_t width = static_cast<size_t>( str->m_Radius ) + 1;
+      std::vector<uint64_t> after( n );
+      std::vector<uint64_t> before( n );
+      std::vector<uint64_t> shifted( n );
+      for ( size_t line = begin; line < end; ++line )
+        {
+        const uint64_t *in = str->m_Input + line * n;
+        uint64_t *out = str->m_Output + line * n;
+        std::copy( in, in + n, after.begin() );
+        std::copy( in, in + n, before.begin() );
+        for ( size_t covered = 1; covered < width; )
+          {
+          const size_t step = std::min( covered, width - covered );
+          ShiftDown( &after[0], &shifted[0], n, step );
+          for ( size_t i = 0; i < n; ++i )
+            {
+            after[i] |= shifted[i];
+            }
+          ShiftUp( &before[0], &shifted[0], n, step );
+          for ( size_t i = 0; i < n; ++i )
+            {
+            before[i] |= shifted[i];
+            }
+          covered += step;
+          }
+        for ( size_t i = 0; i < n; ++i )
+          {
+          out[i] = after[i] | before[i];
+          }
+        out[n - 1] &= str->m_LastWordMask;
+        }
+    }
+
+    // Dilate along another axis, the lines of the box are combined
+    void DilateLinesAlongAxis( void *data, size_t begin, size_t end )
+    {
+      const DilateData *str = static_cast<const DilateData *>( data );
+      const size_t n = str->m_WordsPerLine;
+      const size_t radius = str->m_Radius;
+      for ( size_t line = begin; line < end; ++line )
+        {
+        const size_t position = ( line / str->m_LineStride ) % str->m_AxisSize;
+        const size_t first = line - std::min( radius, position ) * str->m_LineStride;
+        const size_t last = line + std::min( radius, str->m_AxisSize - 1 - position ) * str->m_LineStride;
+        uint64_t *out = str->m_Output + line * n;
+        std::fill( out, out + n, uint64_t( 0 ) );
+        for ( size_t neighbor = first; neighbor <= last; neighbor += str->m_LineStride )
+          {
+          const uint64_t *in = str->m_Input + neighbor * n;
+          for ( size_t i = 0; i < n; ++i )
+            {
+            out[i] |= in[i];
+            }
+          }
+        }
+    }
+
+    }
+
+
+    PackedBinaryImage::PackedBinaryImage()
+      : m_WordsPerLine( 0 )
+    {
+    }
+
+    PackedBinaryImage::PackedBinaryImage( const std::vector<unsigned int> &size )
+      : m_WordsPerLine( 0 )
+    {
+      this->Allocate( size );
+    }
+
+    PackedBinaryImage::PackedBinaryImage( const Image &image )
+      : m_WordsPerLine( 0 )
+    {
+      this->Allocate( image.GetSize() );
+      this->CopyInformation( image );
+      this->SetRegion( image, std::vector<unsigned int>( image.GetDimension(), 0 ) );
+    }
+
+    void PackedBinaryImage::Allocate( const std::vector<unsigned int> &size )
+    {
+      if ( size.size() < 2 )
+        {
+        sitkExceptionMacro( "A PackedBinaryImage has at least 2 dimensions!" );
+        }
+
+      const unsigned int dimension = static_cast<unsigned int>( size.size() );
+      this->m_Size = size;
+      this->m_Origin.assign( dimension, 0.0 );
+      this->m_Spacing.assign( dimension, 1.0 );
+      this->m_Direction.assign( dimension * dimension, 0.0 );
+      for ( unsigned int d = 0; d < dimension; ++d )
+        {
+        this->m_Direction[d * dimension + d] = 1.0;
+        }
+
+      this->m_WordsPerLine = ( size[0] + 63 ) / 64;
+      size_t numberOfWords = this->m_WordsPerLine;
+      for ( unsigned int d = 1; d < dimension; ++d )
+        {
+        numberOfWords *= size[d];
+        }
+      this->m_Words.assign( numberOfWords, uint64_t( 0 ) );
+    }
+
+    uint64_t PackedBinaryImage::GetNumberOfPixels( ) const
+    {
+      if ( this->m_Size.empty() )
+        {
+        return 0;
+        }
+      uint64_t n = 1;
+      for ( size_t d = 0; d < this->m_Size.size(); ++d )
+        {
+        n *= this->m_Size[d];
+        }
+      return n;
+    }
+
+    void PackedBinaryImage::SetOrigin( const std::vector<double> &origin )
+    {
+      if ( origin.size() != this->m_Size.size() )
+        {
+        sitkExceptionMacro( "The origin has " << origin.size() << " components, not " << this->m_Size.size() << "!" );
+        }
+      this->m_Origin = origin;
+    }
+
+    void PackedBinaryImage::SetSpacing( const std::vector<double> &spacing )
+    {
+      if ( spacing.size() != this->m_Size.size() )
+        {
+        sitkExceptionMacro( "The spacing has " << spacing.size() << " components, not " << this->m_Size.size() << "!" );
+        }
+      this->m_Spacing = spacing;
+    }
+
+    void PackedBinaryImage::SetDirection( const std::vector<double> &direction )
+    {
+      if ( direction.size() != this->m_Size.size() * this->m_Size.size() )
+        {
+        sitkExceptionMacro( "The direction has " << direction.size() << " components, not "
+                            << this->m_Size.size() * this->m_Size.size() << "!" );
+        }
+      this->m_Direction = direction;
+    }
+
+    void PackedBinaryImage::CopyInformation( const Image &image )
+    {
+      if ( image.GetSize() != this->m_Size )
+        {
+        sitkExceptionMacro( "The size of the image does not match the size of the PackedBinaryImage!" );
+        }
+      this->m_Origin = image.GetOrigin();
+      this->m_Spacing = image.GetSpacing();
+      this->m_Direction = image.GetDirection();
+    }
+
+    bool PackedBinaryImage::GetPixel( const std::vector<uint32_t> &index ) const
+    {
+      if ( index.size() != this->m_Size.size() )
+        {
+        sitkExceptionMacro( "The index has " << index.size() << " components, not " << this->m_Size.size() << "!" );
+        }
+      for ( size_t d = 0; d < index.size(); ++d )
+        {
+        if ( index[d] >= this->m_Size[d] )
+          {
+          sitkExceptionMacro( "The index is outside of the image!" );
+          }
+        }
+      const RegionLines lines( this->m_Size, index, std::vector<unsigned int>( index.size(), 1 ) );
+      return GetBit( &this->m_Words[lines.GetImageLine( 0 ) * this->m_WordsPerLine], index[0] );
+    }
+
+    void PackedBinaryImage::SetPixel( const std::vector<uint32_t> &index, bool value )
+    {
+      // checks the index
+      this->GetPixel( index );
+      const RegionLines lines( this->m_Size, index, std::vector<unsigned int>( index.size(), 1 ) );
+      uint64_t &word = this->m_Words[lines.GetImageLine( 0 ) * this->m_WordsPerLine + ( index[0] >> 6 )];
+      const uint64_t mask = One << ( index[0] & 63 );
+      word = value ? ( word | mask ) : ( word & ~mask );
+    }
+
+    uint64_t PackedBinaryImage::GetNumberOfForegroundPixels( ) const
+    {
+      uint64_t n = 0;
+      for ( size_t i = 0; i < this->m_Words.size(); ++i )
+        {
+        n += CountBits( this->m_Words[i] );
+        }
+      return n;
+    }
+
+    void PackedBinaryImage::SetRegion( const Image &image, const std::vector<unsigned int> &index )
+    {
+      const std::vector<unsigned int> size = image.GetSize();
+      if ( size.size() != this->m_Size.size() || index.size() != this->m_Size.size() )
+        {
+        sitkExceptionMacro( "The image and the index must have " << this->m_Size.size() << " dimensions!" );
+        }
+      for ( size_t d = 0; d < size.size(); ++d )
+        {
+        if ( index[d] + size[d] > this->m_Size[d] )
+          {
+          sitkExceptionMacro( "The region of the image is outside of the PackedBinaryImage!" );
+          }
+        }
+
+      LineFunctionsSelector selector( image.GetDimension() );
+      const RegionLines lines( this->m_Size, index, size );
+
+      PackData str;
+      str.m_Lines = &lines;
+      str.m_Pack = selector.Select( image.GetPixelID() ).m_Pack;
+      str.m_Buffer = image.GetBufferAsVoid();
+      str.m_Words = this->m_Words.empty() ? SITK_NULLPTR : &this->m_Words[0];
+      str.m_WordsPerLine = this->m_WordsPerLine;
+
+      // each line of the region is in its own line of words, so the
+      // threads do not write the same words
+      ForEachLines( PackLines, &str, lines.GetNumberOfLines() );
+    }
+
+    Image PackedBinaryImage::GetRegion( const std::vector<unsigned int> &index,
+                                        const std::vector<unsigned int> &size,
+                                        uint8_t foregroundValue ) const
+    {
+      if ( size.size() != this->m_Size.size() || index.size() != this->m_Size.size() )
+        {
+        sitkExceptionMacro( "The index and the size must have " << this->m_Size.size() << " dimensions!" );
+        }
+      for ( size_t d = 0; d < size.size(); ++d )
+        {
+        if ( index[d] + size[d] > this->m_Size[d] )
+          {
+          sitkExceptionMacro( "The region is outside of the PackedBinaryImage!" );
+          }
+        }
+
+      Image image( size, sitkUInt8 );
+
+      // the origin is the physical point of the index
+      const size_t dimension = size.size();
+      std::vector<double> origin = this->m_Origin;
+      for ( size_t i = 0; i < dimension; ++i )
+        {
+        for ( size_t j = 0; j < dimension; ++j )
+          {
+          origin[i] += this->m_Direction[i * dimension + j] * this->m_Spacing[j] * index[j];
+          }
+        }
+      image.SetOrigin( origin );
+      image.SetSpacing( this->m_Spacing );
+      image.SetDirection( this->m_Direction );
+
+      const RegionLines lines( this->m_Size, index, size );
+
+      UnpackData str;
+      str.m_Lines = &lines;
+      str.m_Words = this->m_Words.empty() ? SITK_NULLPTR : &this->m_Words[0];
+      str.m_WordsPerLine = this->m_WordsPerLine;
+      str.m_Buffer = image.GetBufferAsUInt8();
+      str.m_ForegroundValue = foregroundValue;
+      ForEachLines( UnpackLines, &str, lines.GetNumberOfLines() );
+
+      return image;
+    }
+
+    Image PackedBinaryImage::ToImage( uint8_t foregroundValue ) const
+    {
+      return this->GetRegion( std::vector<unsigned int>( this->m_Size.size(), 0 ), this->m_Size, foregroundValue );
+    }
+
+    Image PackedBinaryImage::Mask( const Image &image, double outsideValue ) const
+    {
+      if ( image.GetSize() != this->m_Size )
+        {
+        sitkExceptionMacro( "The size of the image does not match the size of the PackedBinaryImage!" );
+        }
+
+      LineFunctionsSelector selector( image.GetDimension() );
+      const MaskLineFunctionType mask = selector.Select( image.GetPixelID() ).m_Mask;
+
+      // a deep copy of the pixels, which are replaced in place
+      Image output = image;
+
+      MaskData str;
+      str.m_Mask = mask;
+      str.m_Buffer = output.GetBufferAsVoid();
+      str.m_Words = this->m_Words.empty() ? SITK_NULLPTR : &this->m_Words[0];
+      str.m_WordsPerLine = this->m_WordsPerLine;
+      str.m_LineLength = this->m_Size[0];
+      str.m_OutsideValue = outsideValue;
+      ForEachLines( MaskLines, &str, this->m_Words.size() / std::max<size_t>( 1, this->m_WordsPerLine ) );
+
+      return output;
+    }
+
+    void PackedBinaryImage::CheckSameSize( const PackedBinaryImage &other ) const
+    {
+      if ( other.m_Size != this->m_Size )
+        {
+        sitkExceptionMacro( "The PackedBinaryImages do not have the same size!" );
+        }
+    }
+
+    PackedBinaryImage &PackedBinaryImage::And( const PackedBinaryImage &other )
+    {
+      this->CheckSameSize( other );
+      for ( size_t i = 0; i < this->m_Words.size(); ++i )
+        {
+        this->m_Words[i] &= other.m_Words[i];
+        }
+      return *this;
+    }
+
+    PackedBinaryImage &PackedBinaryImage::Or( const PackedBinaryImage &other )
+    {
+      this->CheckSameSize( other );
+      for ( size_t i = 0; i < this->m_Words.size(); ++i )
+        {
+        this->m_Words[i] |= other.m_Words[i];
+        }
+      return *this;
+    }
+
+    PackedBinaryImage &PackedBinaryImage::Xor( const PackedBinaryImage &other )
+    {
+      this->CheckSameSize( other );
+      for ( size_t i = 0; i < this->m_Words.size(); ++i )
+        {
+        this->m_Words[i] ^= other.m_Words[i];
+        }
+      return *this;
+    }
+
+    PackedBinaryImage &PackedBinaryImage::Not( )
+    {
+      if ( this->m_Words.empty() )
+        {
+        return *this;
+        }
+
+      // the bits after the last pixel of each line stay zero
+      const unsigned int tail = this->m_Size[0] & 63;
+      const uint64_t lastWordMask = tail ? ( One << tail ) - 1 : ~uint64_t( 0 );
+      for ( size_t i = 0; i < this->m_Words.size(); ++i )
+        {
+        this->m_Words[i] = ~this->m_Words[i];
+        if ( i % this->m_WordsPerLine == this->m_WordsPerLine - 1 )
+          {
+          this->m_Words[i] &= lastWordMask;
+          }
+        }
+      return *this;
+    }
+
+    void PackedBinaryImage::DilateAlong( unsigned int axis, unsigned int radius )
+    {
+      if ( radius == 0 || this->m_Words.empty() )
+        {
+        return;
+        }
+
+      std::vector<uint64_t> output( this->m_Words.size() );
+
+      const unsigned int tail = this->m_Size[0] & 63;
+
+      DilateData str;
+      str.m_Input = &this->m_Words[0];
+      str.m_Output = &output[0];
+      str.m_WordsPerLine = this->m_WordsPerLine;
+      str.m_LastWordMask = tail ? ( One << tail ) - 1 : ~uint64_t( 0 );
+      str.m_Radius = radius;
+      str.m_LineLength = this->m_Size[0];
+      str.m_LineStride = 1;
+      for ( unsigned int d = 1; d < axis; ++d )
+        {
+        str.m_LineStride *= this->m_Size[d];
+        }
+      str.m_AxisSize = this->m_Size[axis];
+
+      ForEachLines( axis == 0 ? DilateLinesAlongFirstAxis : DilateLinesAlongAxis,
+                    &str, this->m_Words.size() / this->m_WordsPerLine );
+
+      this->m_Words.swap( output );
+    }
+
+    PackedBinaryImage &PackedBinaryImage::Dilate( const std::vector<unsigned int> &radius )
+    {
+      if ( radius.size() != this->m_Size.size() )
+        {
+        sitkExceptionMacro( "The radius has " << radius.size() << " components, not " << this->m_Size.size() << "!" );
+        }
+      for ( unsigned int d = 0; d < radius.size(); ++d )
+        {
+        this->DilateAlong( d, radius[d] );
+        }
+      return *this;
+    }
+
+    PackedBinaryImage &PackedBinaryImage::Erode( const std::vector<unsigned int> &radius )
+    {
+      // the background is dilated, with the pixels outside of the
+      // image foreground
+      this->Not();
+      this->Dilate( radius );
+      return this->Not();
+    }
+
+    PackedBinaryImage &PackedBinaryImage::Opening( const std::vector<unsigned int> &radius )
+    {
+      this->Erode( radius );
+      return this->Dilate( radius );
+    }
+
+    PackedBinaryImage &PackedBinaryImage::Closing( const std::vector<unsigned int> &radius )
+    {
+      this->Dilate( radius );
+      return this->Erode( radius );
+    }
+
+    std::string PackedBinaryImage::ToString( ) const
+    {
+      std::ostringstream out;
+      out << "itk::simple::PackedBinaryImage" << std::endl;
+      out << "  Size: [";
+      for ( size_t d = 0; d < this->m_Size.size(); ++d )
+        {
+        out << ( d ? ", " : "" ) << this->m_Size[d];
+        }
+      out << "]" << std::endl;
+      out << "  WordsPerLine: " << this->m_WordsPerLine << std::endl;
+      out << "  SizeInBytes: " << this->GetSizeInBytes() << std::endl;
+      out << "  NumberOfForegroundPixels: " << this->GetNumberOfForegroundPixels() << std::endl;
+      return out.str();
+    }
+
+  }
+}
@@ -0,0 +1,366 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkParallelScalarImageKmeansImageFilter_hxx
+#define sitkParallelScalarImageKmeansImageFilter_hxx
+
+#include <itkScalarImageKmeansImageFilter.h>
+#include <itkImageRegionSplitterSlowDimension.h>
+#include <itkImageScanlineConstIterator.h>
+#include <itkImageScanlineIterator.h>
+#include <itkMersenneTwisterRandomVariateGenerator.h>
+#include <itkMultiThreader.h>
+#include <itkNumericTraits.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace itk {
+namespace simple {
+
+/** \brief A ScalarImageKmeansImageFilter with a multithreaded Lloyd
+ * algorithm.
+ *
+ * By default the filter classifies the pixels with the KdTree based
+ * estimator of its superclass, in one thread. With UseLloyd, the
+ * means are computed by Lloyd iterations, where each thread assigns
+ * a part of the image to the nearest means, until the means do not
+ * change, and the pixels are labeled in parallel.
+ *
+ * For the integer pixel types of at most 16 bits, the iterations run
+ * on the histogram of the image weighted by the counts, which gives
+ * the same means at the cost of one pass over the image. For the
+ * other pixel types, a NumberOfSamples other than 0 runs the
+ * iterations on that many pixels drawn at random, with a fixed seed,
+ * and only the labeling visits all the pixels.
+ */
+template< class TInputImage, class TOutputImage >
+class ParallelScalarImageKmeansImageFilter
+  : public ScalarImageKmeansImageFilter< TInputImage, TOutputImage >
+{
+public:
+  typedef ParallelScalarImageKmeansImageFilter                        Self;
+  typedef ScalarImageKmeansImageFilter< TInputImage, TOutputImage >   Superclass;
+  typedef SmartPointer< Self >                                        Pointer;
+  typedef SmartPointer< const Self >                                  ConstPointer;
+
+  typedef TInputImage                              InputImageType;
+  typedef TOutputImage                             OutputImageType;
+  typedef typename InputImageType::PixelType       InputPixelType;
+  typedef typename OutputImageType::PixelType      OutputPixelType;
+  typedef typename InputImageType::RegionType      RegionType;
+  typedef typename Superclass::RealPixelType       RealPixelType;
+  typedef typename Superclass::ParametersType      ParametersType;
+
+  itkNewMacro( Self );
+  itkTypeMacro( ParallelScalarImageKmeansImageFilter, ScalarImageKmeansImageFilter );
+
+  itkSetMacro( UseLloyd, bool );
+  itkGetConstMacro( UseLloyd, bool );
+
+  itkSetMacro( NumberOfSamples, SizeValueType );
+  itkGetConstMacro( NumberOfSamples, SizeValueType );
+
+  /** The superclass does not give its initial means back. */
+  void AddClassWithInitialMean( RealPixelType mean )
+  {
+    m_InitialMeans.push_back( static_cast< double >( mean ) );
+    Superclass::AddClassWithInitialMean( mean );
+  }
+
+  virtual const ParametersType & GetFinalMeans() const ITK_OVERRIDE
+  {
+    return m_UseLloyd ? m_LloydMeans : Superclass::GetFinalMeans();
+  }
+
+protected:
+  ParallelScalarImageKmeansImageFilter()
+    : m_UseLloyd( false ),
+      m_NumberOfSamples( 0 )
+  {}
+
+  virtual void GenerateData() ITK_OVERRIDE
+  {
+    if ( !m_UseLloyd )
+      {
+      Superclass::GenerateData();
+      return;
+      }
+    if ( m_InitialMeans.empty() )
+      {
+      itkExceptionMacro( "No class with an initial mean is set." );
+      }
+
+    this->AllocateOutputs();
+
+    ThreadStruct str;
+    str.m_Input = this->GetInput();
+    str.m_Output = this->GetOutput();
+    str.m_Means = m_InitialMeans;
+
+    const RegionType region = str.m_Output->GetRequestedRegion();
+    ImageRegionSplitterSlowDimension::Pointer splitter = ImageRegionSplitterSlowDimension::New();
+    const unsigned int numberOfSplits = splitter->GetNumberOfSplits( region, std::max( 1u, unsigned( this->GetNumberOfThreads() ) ) );
+    str.m_Regions.resize( numberOfSplits, region );
+    for ( unsigned int i = 0; i < numberOfSplits; ++i )
+      {
+      splitter->GetSplit( i, numberOfSplits, str.m_Regions[i] );
+      }
+
+    MultiThreader *threader = this->GetMultiThreader();
+    threader->SetNumberOfThreads( static_cast< ThreadIdType >( numberOfSplits ) );
+    threader->SetSingleMethod( Self::ThreaderCallback, &str );
+
+    const SizeValueType numberOfPixels = region.GetNumberOfPixels();
+    if ( UseHistogram() )
+      {
+      str.m_Pass = HistogramPass;
+      str.m_Histograms.assign( numberOfSplits, std::vector< SizeValueType >( NumberOfHistogramBins(), 0 ) );
+      threader->SingleMethodExecute();
+
+      std::vector< double > values;
+      std::vector< double > weights;
+      for ( size_t b = 0; b < NumberOfHistogramBins(); ++b )
+        {
+        SizeValueType count = 0;
+        for ( unsigned int t = 0; t < numberOfSplits; ++t )
+          {
+          count += str.m_Histograms[t][b];
+          }
+        if ( count > 0 )
+          {
+          values.push_back( static_cast< double >( NumericTraits< InputPixelType >::NonpositiveMin() ) + b );
+          weights.push_back( static_cast< double >( count ) );
+          }
+        }
+      str.m_Histograms.clear();
+      WeightedLloyd( values, weights, str.m_Means );
+      }
+    else if ( m_NumberOfSamples > 0 && m_NumberOfSamples < numberOfPixels )
+      {
+      const SizeValueType numberOfBufferedPixels = str.m_Input->GetBufferedRegion().GetNumberOfPixels();
+      typedef Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+      GeneratorType::Pointer generator = GeneratorType::New();
+      generator->Initialize( 121212 );
+
+      std::vector< double > values( m_NumberOfSamples );
+      for ( SizeValueType s = 0; s < m_NumberOfSamples; ++s )
+        {
+        const SizeValueType offset = generator->GetIntegerVariate( static_cast< GeneratorType::IntegerType >( numberOfBufferedPixels - 1 ) );
+        values[s] = static_cast< double >( str.m_Input->GetPixel( str.m_Input->ComputeIndex( offset ) ) );
+        }
+      WeightedLloyd( values, std::vector< double >( values.size(), 1.0 ), str.m_Means );
+      }
+    else
+      {
+      str.m_Pass = AccumulatePass;
+      for ( unsigned int iteration = 0; iteration < MaximumNumberOfIterations; ++iteration )
+        {
+        str.m_Sums.assign( numberOfSplits, std::vector< double >( str.m_Means.size(), 0.0 ) );
+        str.m_Counts.assign( numberOfSplits, std::vector< double >( str.m_Means.size(), 0.0 ) );
+        threader->SingleMethodExecute();
+
+        std::vector< double > sums( str.m_Means.size(), 0.0 );
+        std::vector< double > counts( str.m_Means.size(), 0.0 );
+        for ( unsigned int t = 0; t < numberOfSplits; ++t )
+          {
+          for ( size_t k = 0; k < str.m_Means.size(); ++k )
+            {
+            sums[k] += str.m_Sums[t][k];
+            counts[k] += str.m_Counts[t][k];
+            }
+          }
+        if ( !UpdateMeans( sums, counts, str.m_Means ) )
+          {
+          break;
+          }
+        }
+      }
+
+    // the labels of the superclass
+    const size_t numberOfClasses = str.m_Means.size();
+    unsigned int labelInterval = 1;
+    if ( this->GetUseNonContiguousLabels() )
+      {
+      labelInterval = ( NumericTraits< OutputPixelType >::max() / numberOfClasses ) - 1;
+      }
+    str.m_Labels.resize( numberOfClasses );
+    for ( size_t k = 0; k < numberOfClasses; ++k )
+      {
+      str.m_Labels[k] = static_cast< OutputPixelType >( k * labelInterval );
+      }
+    str.m_Pass = LabelPass;
+    threader->SingleMethodExecute();
+
+    m_LloydMeans.SetSize( static_cast< unsigned int >( numberOfClasses ) );
+    for ( size_t k = 0; k < numberOfClasses; ++k )
+      {
+      m_LloydMeans[k] = str.m_Means[k];
+      }
+  }
+
+private:
+  ParallelScalarImageKmeansImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                       // purposely not implemented
+
+  // the limit of the iterations of the KdTree based estimator
+  static const unsigned int MaximumNumberOfIterations = 200;
+
+  enum PassType { HistogramPass, AccumulatePass, LabelPass };
+
+  struct ThreadStruct
+  {
+    const InputImageType    *m_Input;
+    OutputImageType         *m_Output;
+    std::vector<RegionType>  m_Regions;
+    PassType                 m_Pass;
+    std::vector< double >    m_Means;
+    // one of each per thread
+    std::vector< std::vector< SizeValueType > > m_Histograms;
+    std::vector< std::vector< double > >        m_Sums;
+    std::vector< std::vector< double > >        m_Counts;
+    std::vector< OutputPixelType >              m_Labels;
+  };
+
+  static bool UseHistogram()
+  {
+    return NumericTraits< InputPixelType >::IsInteger && sizeof( InputPixelType ) <= 2;
+  }
+
+  static size_t NumberOfHistogramBins()
+  {
+    return UseHistogram() ? size_t( 1 ) << ( 8 * sizeof( InputPixelType ) ) : 0;
+  }
+
+  // The nearest mean, the first one on ties as the minimum decision
+  // rule of the superclass.
+  static size_t NearestClass( double value, const std::vector< double > &means )
+  {
+    size_t nearest = 0;
+    double nearestDistance = std::abs( value - means[0] );
+    for ( size_t k = 1; k < means.size(); ++k )
+      {
+      const double distance = std::abs( value - means[k] );
+      if ( distance < nearestDistance )
+        {
+        nearest = k;
+        nearestDistance = distance;
+        }
+      }
+    return nearest;
+  }
+
+  // The means of the classes, the means of the empty ones are kept.
+  // Returns whether a mean changed.
+  static bool UpdateMeans( const std::vector< double > &sums, const std::vector< double > &counts, std::vector< double > &means )
+  {
+    bool changed = false;
+    for ( size_t k = 0; k < means.size(); ++k )
+      {
+      if ( counts[k] > 0.0 )
+        {
+        const double mean = sums[k] / counts[k];
+        changed = changed || mean != means[k];
+        means[k] = mean;
+        }
+      }
+    return changed;
+  }
+
+  static void WeightedLloyd( const std::vector< double > &values, const std::vector< double > &weights, std::vector< double > &means )
+  {
+    for ( unsigned int iteration = 0; iteration < MaximumNumberOfIterations; ++iteration )
+      {
+      std::vector< double > sums( means.size(), 0.0 );
+      std::vector< double > counts( means.size(), 0.0 );
+      for ( size_t i = 0; i < values.size(); ++i )
+        {
+        const size_t k = NearestClass( values[i], means );
+        sums[k] += weights[i] * values[i];
+        counts[k] += weights[i];
+        }
+      if ( !UpdateMeans( sums, counts, means ) )
+        {
+        break;
+        }
+      }
+  }
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void *arg )
+  {
+    typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType *info = static_cast< ThreadInfoType * >( arg );
+    ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+
+    const RegionType &region = str->m_Regions[info->ThreadID];
+    const std::vector< double > &means = str->m_Means;
+    ImageScanlineConstIterator< InputImageType > it( str->m_Input, region );
+
+    if ( str->m_Pass == HistogramPass )
+      {
+      SizeValueType *histogram = &str->m_Histograms[info->ThreadID][0];
+      const double minimum = static_cast< double >( NumericTraits< InputPixelType >::NonpositiveMin() );
+      for ( ; !it.IsAtEnd(); it.NextLine() )
+        {
+        for ( ; !it.IsAtEndOfLine(); ++it )
+          {
+          ++histogram[static_cast< size_t >( static_cast< double >( it.Get() ) - minimum )];
+          }
+        }
+      }
+    else if ( str->m_Pass == AccumulatePass )
+      {
+      double *sums = &str->m_Sums[info->ThreadID][0];
+      double *counts = &str->m_Counts[info->ThreadID][0];
+      for ( ; !it.IsAtEnd(); it.NextLine() )
+        {
+        for ( ; !it.IsAtEndOfLine(); ++it )
+          {
+          const double value = static_cast< double >( it.Get() );
+          const size_t k = NearestClass( value, means );
+          sums[k] += value;
+          counts[k] += 1.0;
+          }
+        }
+      }
+    else
+      {
+      ImageScanlineIterator< OutputImageType > ot( str->m_Output, region );
+      for ( ; !it.IsAtEnd(); it.NextLine(), ot.NextLine() )
+        {
+        for ( ; !it.IsAtEndOfLine(); ++it, ++ot )
+          {
+          ot.Set( str->m_Labels[NearestClass( static_cast< double >( it.Get() ), means )] );
+          }
+        }
+      }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  bool                  m_UseLloyd;
+  SizeValueType         m_NumberOfSamples;
+  std::vector< double > m_InitialMeans;
+  ParametersType        m_LloydMeans;
+};
+
+} // end namespace simple
+} // end namespace itk
+
+#endif
@@ -0,0 +1,446 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkPixelwisePipeline.h"
+#include "sitkMemberFunctionFactory.h"
+#include "sitkExceptionObject.h"
+
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <sstream>
+#include <typeinfo>
+
+namespace itk {
+  namespace simple {
+
+    namespace
+    {
+
+    // The number of values computed at once by each step
+    const size_t BlockSize = 256;
+
+    typedef void (*ReadBlockFunctionType)( const void *buffer, size_t start, size_t n, double *values );
+    typedef void (*WriteBlockFunctionType)( const double *values, size_t start, size_t n, void *buffer );
+    typedef void (*ConvertBlockFunctionType)( double *values, size_t n );
+    typedef const void *(*GetBufferFunctionType)( const itk::DataObject *image );
+
+    template <typename TElement>
+    inline TElement ConvertToElement( double v )
+    {
+      if ( std::numeric_limits<TElement>::is_integer )
+        {
+        // also maps NaN to the minimum
+        if ( !( v >= static_cast<double>( itk::NumericTraits<TElement>::NonpositiveMin() ) ) )
+          {
+          return itk::NumericTraits<TElement>::NonpositiveMin();
+          }
+        if ( v >= static_cast<double>( itk::NumericTraits<TElement>::max() ) )
+          {
+          return itk::NumericTraits<TElement>::max();
+          }
+        }
+      return static_cast<TElement>( v );
+    }
+
+    template <typename TElement>
+    void ReadBlock( const void *buffer, size_t start, size_t n, double *values )
+    {
+      const TElement *p = static_cast<const TElement *>( buffer ) + start;
+      for ( size_t i = 0; i < n; ++i )
+        {
+        values[i] = static_cast<double>( p[i] );
+        }
+    }
+
+    template <typename TElement>
+    void WriteBlock( const double *values, size_t start, size_t n, void *buffer )
+    {
+      TElement *p = static_cast<TElement *>( buffer ) + start;
+      for ( size_t i = 0; i < n; ++i )
+        {
+        p[i] = ConvertToElement<TElement>( values[i] );
+        }
+    }
+
+    template <typename TElement>
+    void ConvertBlock( double *values, size_t n )
+    {
+      for ( size_t i = 0; i < n; ++i )
+        {
+        values[i] = static_cast<double>( ConvertToElement<TElement>( values[i] ) );
+        }
+    }
+
+    template <class TImageType>
+    const void *GetBuffer( const itk::DataObject *image )
+    {
+      const TImageType *itkImage = dynamic_cast<const TImageType *>( image );
+      assert( itkImage != SITK_NULLPTR );
+      return itkImage->GetBufferPointer();
+    }
+
+    struct BlockFunctions
+    {
+      GetBufferFunctionType    m_GetBuffer;
+      ReadBlockFunctionType    m_Read;
+      WriteBlockFunctionType   m_Write;
+      ConvertBlockFunctionType m_Convert;
+    };
+
+    // Selects the block functions for a pixel type
+    class BlockFunctionsSelector
+    {
+    public:
+      typedef BlockFunctionsSelector Self;
+      typedef BlockFunctions (Self::*MemberFunctionType)( void );
+
+      BlockFunctionsSelector( unsigned int dimension )
+        : m_Dimension( dimension ),
+          m_MemberFactory( this )
+        {
+          m_MemberFactory.RegisterMemberFunctions< PixelwisePipeline::PixelIDTypeList, 4 > ();
+          m_MemberFactory.RegisterMemberFunctions< PixelwisePipeline::PixelIDTypeList, 3 > ();
+          m_MemberFactory.RegisterMemberFunctions< PixelwisePipeline::PixelIDTypeList, 2 > ();
+        }
+
+      BlockFunctions Select( PixelIDValueEnum pixelID )
+        {
+          return m_MemberFactory.GetMemberFunction( pixelID, m_Dimension )();
+        }
+
+      template <class TImageType>
+      BlockFunctions ExecuteInternal( void )
+        {
+          typedef typename TImageType::PixelContainer::Element ElementType;
+          BlockFunctions f;
+          f.m_GetBuffer = &GetBuffer<TImageType>;
+          f.m_Read = &ReadBlock<ElementType>;
+          f.m_Write = &WriteBlock<ElementType>;
+          // double precision values need no conversion
+          f.m_Convert = ( typeid( ElementType ) == typeid( double ) ) ? SITK_NULLPTR : &ConvertBlock<ElementType>;
+          return f;
+        }
+
+    private:
+      unsigned int                                    m_Dimension;
+      detail::MemberFunctionFactory<MemberFunctionType> m_MemberFactory;
+    };
+
+
+    enum KernelOperatorType { ShiftScaleOperator, ClampOperator, BinaryThresholdOperator, MaskOperator, ConvertOperator };
+
+    struct KernelStep
+    {
+      KernelOperatorType       m_Operator;
+      double                   m_Parameters[4];
+      ConvertBlockFunctionType m_Convert;
+      ReadBlockFunctionType    m_ReadMask;
+      const void              *m_MaskBuffer;
+    };
+
+    struct KernelThreadStruct
+    {
+      std::vector<KernelStep> m_Steps;
+      ReadBlockFunctionType   m_Read;
+      const void             *m_Input;
+      WriteBlockFunctionType  m_Write;
+      void                   *m_Output;
+      size_t                  m_NumberOfElements;
+    };
+
+    void ExecuteBlock( const KernelThreadStruct &str, size_t start, size_t n, double *values, double *mask )
+    {
+      str.m_Read( str.m_Input, start, n, values );
+
+      for ( size_t s = 0; s < str.m_Steps.size(); ++s )
+        {
+        const KernelStep &step = str.m_Steps[s];
+        const double *p = step.m_Parameters;
+        switch ( step.m_Operator )
+          {
+          case ShiftScaleOperator:
+            for ( size_t i = 0; i < n; ++i )
+              {
+              values[i] = ( values[i] + p[0] ) * p[1];
+              }
+            break;
+          case ClampOperator:
+            for ( size_t i = 0; i < n; ++i )
+              {
+              values[i] = std::min( std::max( values[i], p[0] ), p[1] );
+              }
+            break;
+          case BinaryThresholdOperator:
+            for ( size_t i = 0; i < n; ++i )
+              {
+              values[i] = ( p[0] <= values[i] && values[i] <= p[1] ) ? p[2] : p[3];
+              }
+            break;
+          case MaskOperator:
+            step.m_ReadMask( step.m_MaskBuffer, start, n, mask );
+            for ( size_t i = 0; i < n; ++i )
+              {
+              if ( mask[i] == 0.0 )
+                {
+                values[i] = p[0];
+                }
+              }
+            break;
+          case ConvertOperator:
+            break;
+          }
+
+        if ( step.m_Convert )
+          {
+          step.m_Convert( values, n );
+          }
+        }
+
+      str.m_Write( values, start, n, str.m_Output );
+    }
+
+    ITK_THREAD_RETURN_TYPE KernelThreaderCallback( void *arg )
+    {
+      typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+      ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+      const KernelThreadStruct *str = static_cast<KernelThreadStruct *>( info->UserData );
+
+      const size_t chunk = str->m_NumberOfElements / info->NumberOfThreads;
+      const size_t begin = chunk * info->ThreadID;
+      const size_t end = ( info->ThreadID + 1 == info->NumberOfThreads ) ? str->m_NumberOfElements : begin + chunk;
+
+      double values[BlockSize];
+      double mask[BlockSize];
+
+      for ( size_t start = begin; start < end; start += BlockSize )
+        {
+        ExecuteBlock( *str, start, std::min( BlockSize, end - start ), values, mask );
+        }
+
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+    }
+
+
+    PixelwisePipeline::PixelwisePipeline()
+    {
+    }
+
+    PixelwisePipeline::~PixelwisePipeline()
+    {
+    }
+
+    PixelwisePipeline &PixelwisePipeline::AddCast ( PixelIDValueEnum pixelID )
+    {
+      Step step;
+      step.m_Type = CastStep;
+      std::fill( step.m_Parameters, step.m_Parameters + 4, 0.0 );
+      step.m_PixelID = pixelID;
+      m_Steps.push_back( step );
+      return *this;
+    }
+
+    PixelwisePipeline &PixelwisePipeline::AddShiftScale ( double shift, double scale )
+    {
+      Step step;
+      step.m_Type = ShiftScaleStep;
+      std::fill( step.m_Parameters, step.m_Parameters + 4, 0.0 );
+      step.m_Parameters[0] = shift;
+      step.m_Parameters[1] = scale;
+      step.m_PixelID = sitkUnknown;
+      m_Steps.push_back( step );
+      return *this;
+    }
+
+    PixelwisePipeline &PixelwisePipeline::AddClamp ( double lowerBound, double upperBound )
+    {
+      if ( lowerBound > upperBound )
+        {
+        sitkExceptionMacro( "The lower bound (" << lowerBound << ") must be less than or equal to the upper bound (" << upperBound << ")!" );
+        }
+      Step step;
+      step.m_Type = ClampStep;
+      std::fill( step.m_Parameters, step.m_Parameters + 4, 0.0 );
+      step.m_Parameters[0] = lowerBound;
+      step.m_Parameters[1] = upperBound;
+      step.m_PixelID = sitkUnknown;
+      m_Steps.push_back( step );
+      return *this;
+    }
+
+    PixelwisePipeline &PixelwisePipeline::AddBinaryThreshold ( double lowerThreshold,
+                                                               double upperThreshold,
+                                                               uint8_t insideValue,
+                                                               uint8_t outsideValue )
+    {
+      Step step;
+      step.m_Type = BinaryThresholdStep;
+      step.m_Parameters[0] = lowerThreshold;
+      step.m_Parameters[1] = upperThreshold;
+      step.m_Parameters[2] = insideValue;
+      step.m_Parameters[3] = outsideValue;
+      step.m_PixelID = sitkUInt8;
+      m_Steps.push_back( step );
+      return *this;
+    }
+
+    PixelwisePipeline &PixelwisePipeline::AddMask ( const Image &mask, double outsideValue )
+    {
+      Step step;
+      step.m_Type = MaskStep;
+      std::fill( step.m_Parameters, step.m_Parameters + 4, 0.0 );
+      step.m_Parameters[0] = outsideValue;
+      step.m_PixelID = sitkUnknown;
+      step.m_Mask = mask;
+      m_Steps.push_back( step );
+      return *this;
+    }
+
+    PixelwisePipeline &PixelwisePipeline::Clear ( )
+    {
+      m_Steps.clear();
+      return *this;
+    }
+
+    unsigned int PixelwisePipeline::GetNumberOfSteps ( ) const
+    {
+      return static_cast<unsigned int>( m_Steps.size() );
+    }
+
+    std::string PixelwisePipeline::ToString() const
+    {
+      std::ostringstream out;
+      out << "itk::simple::PixelwisePipeline" << std::endl;
+      out << "Steps:" << std::endl;
+      for ( size_t i = 0; i < m_Steps.size(); ++i )
+        {
+        const Step &step = m_Steps[i];
+        const double *p = step.m_Parameters;
+        out << "  " << i << ": ";
+        switch ( step.m_Type )
+          {
+          case CastStep:
+            out << "Cast( " << GetPixelIDValueAsString( step.m_PixelID ) << " )";
+            break;
+          case ShiftScaleStep:
+            out << "ShiftScale( " << p[0] << ", " << p[1] << " )";
+            break;
+          case ClampStep:
+            out << "Clamp( " << p[0] << ", " << p[1] << " )";
+            break;
+          case BinaryThresholdStep:
+            out << "BinaryThreshold( " << p[0] << ", " << p[1] << ", " << p[2] << ", " << p[3] << " )";
+            break;
+          case MaskStep:
+            out << "Mask( " << p[0] << " )";
+            break;
+          }
+        out << std::endl;
+        }
+      out << ProcessObject::ToString();
+      return out.str();
+    }
+
+    Image PixelwisePipeline::Execute ( const Image &image )
+    {
+      const unsigned int dimension = image.GetDimension();
+
+      BlockFunctionsSelector selector( dimension );
+
+      KernelThreadStruct str;
+      const BlockFunctions inputFunctions = selector.Select( image.GetPixelID() );
+      str.m_Read = inputFunctions.m_Read;
+      str.m_Input = inputFunctions.m_GetBuffer( image.GetITKBase() );
+
+      PixelIDValueEnum pixelID = image.GetPixelID();
+
+      for ( size_t i = 0; i < m_Steps.size(); ++i )
+        {
+        const Step &step = m_Steps[i];
+
+        KernelStep kernelStep;
+        std::copy( step.m_Parameters, step.m_Parameters + 4, kernelStep.m_Parameters );
+        kernelStep.m_ReadMask = SITK_NULLPTR;
+        kernelStep.m_MaskBuffer = SITK_NULLPTR;
+
+        switch ( step.m_Type )
+          {
+          case CastStep:
+            kernelStep.m_Operator = ConvertOperator;
+            pixelID = step.m_PixelID;
+            break;
+          case ShiftScaleStep:
+            kernelStep.m_Operator = ShiftScaleOperator;
+            break;
+          case ClampStep:
+            kernelStep.m_Operator = ClampOperator;
+            break;
+          case BinaryThresholdStep:
+            kernelStep.m_Operator = BinaryThresholdOperator;
+            pixelID = step.m_PixelID;
+            break;
+          case MaskStep:
+            if ( step.m_Mask.GetSize() != image.GetSize() )
+              {
+              sitkExceptionMacro( "The mask of step " << i << " does not match the size of the input image!" );
+              }
+            kernelStep.m_Operator = MaskOperator;
+            {
+            const BlockFunctions maskFunctions = selector.Select( step.m_Mask.GetPixelID() );
+            kernelStep.m_ReadMask = maskFunctions.m_Read;
+            kernelStep.m_MaskBuffer = maskFunctions.m_GetBuffer( step.m_Mask.GetITKBase() );
+            }
+            break;
+          }
+
+        kernelStep.m_Convert = selector.Select( pixelID ).m_Convert;
+        str.m_Steps.push_back( kernelStep );
+        }
+
+      Image output( image.GetSize(), pixelID, 0u, Image::NoBufferInitialization );
+      output.SetOrigin( image.GetOrigin() );
+      output.SetSpacing( image.GetSpacing() );
+      output.SetDirection( image.GetDirection() );
+
+      const BlockFunctions outputFunctions = selector.Select( pixelID );
+      str.m_Write = outputFunctions.m_Write;
+      // the buffer of the new output is not shared
+      str.m_Output = const_cast<void *>( outputFunctions.m_GetBuffer( output.GetITKBase() ) );
+      str.m_NumberOfElements = static_cast<size_t>( output.GetNumberOfPixels() );
+
+      // elements smaller than this are computed by the calling thread
+      const size_t minimumElementsPerThread = 16 * BlockSize;
+      const size_t numberOfThreads =
+        std::max<size_t>( 1, std::min<size_t>( this->GetNumberOfThreads(),
+                                               str.m_NumberOfElements / minimumElementsPerThread ) );
+
+      itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+      threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+      threader->SetSingleMethod( KernelThreaderCallback, &str );
+      threader->SingleMethodExecute();
+
+      return output;
+    }
+
+  }
+}
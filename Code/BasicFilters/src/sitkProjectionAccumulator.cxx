@@ -0,0 +1,455 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkProjectionAccumulator.h"
+#include "sitkMemberFunctionFactory.h"
+#include "sitkExceptionObject.h"
+
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace itk {
+  namespace simple {
+
+    namespace
+    {
+
+    typedef ProjectionAccumulator::ProjectionType ProjectionType;
+
+    typedef void (*FoldFunctionType)( const void *input, size_t inner, size_t slices,
+                                      size_t begin, size_t end,
+                                      size_t sliceBegin, size_t sliceEnd,
+                                      ProjectionType projection,
+                                      double *values, double *squaredValues );
+    typedef void (*WriteFunctionType)( const double *values, void *output, size_t n );
+
+    // Fold the slices [sliceBegin, sliceEnd) of the output pixels
+    // [begin, end) of a slab seen as outer blocks of slices of inner
+    // pixels.
+    template <typename TElement>
+    void FoldSlices( const void *input, size_t inner, size_t slices,
+                     size_t begin, size_t end,
+                     size_t sliceBegin, size_t sliceEnd,
+                     ProjectionType projection,
+                     double *values, double *squaredValues )
+    {
+      const TElement *in = static_cast<const TElement *>( input );
+
+      size_t o = begin;
+      while ( o < end )
+        {
+        const size_t outer = o / inner;
+        const size_t first = o % inner;
+        const size_t last = std::min( inner, first + end - o );
+        double *v = values + outer * inner;
+        double *s = squaredValues + outer * inner;
+
+        for ( size_t slice = sliceBegin; slice < sliceEnd; ++slice )
+          {
+          const TElement *line = in + ( outer * slices + slice ) * inner;
+          switch ( projection )
+            {
+            case ProjectionAccumulator::Maximum:
+              for ( size_t i = first; i < last; ++i )
+                {
+                v[i] = std::max( v[i], static_cast<double>( line[i] ) );
+                }
+              break;
+            case ProjectionAccumulator::Minimum:
+              for ( size_t i = first; i < last; ++i )
+                {
+                v[i] = std::min( v[i], static_cast<double>( line[i] ) );
+                }
+              break;
+            case ProjectionAccumulator::Sum:
+            case ProjectionAccumulator::Mean:
+              for ( size_t i = first; i < last; ++i )
+                {
+                v[i] += static_cast<double>( line[i] );
+                }
+              break;
+            case ProjectionAccumulator::StandardDeviation:
+              for ( size_t i = first; i < last; ++i )
+                {
+                const double x = static_cast<double>( line[i] );
+                v[i] += x;
+                s[i] += x * x;
+                }
+              break;
+            }
+          }
+
+        o += last - first;
+        }
+    }
+
+    template <typename TElement>
+    void WriteValues( const double *values, void *output, size_t n )
+    {
+      TElement *out = static_cast<TElement *>( output );
+      for ( size_t i = 0; i < n; ++i )
+        {
+        out[i] = static_cast<TElement>( values[i] );
+        }
+    }
+
+    struct ProjectionFunctions
+    {
+      FoldFunctionType  m_Fold;
+      WriteFunctionType m_Write;
+    };
+
+    // Selects the functions for a pixel type
+    class ProjectionFunctionsSelector
+    {
+    public:
+      typedef ProjectionFunctionsSelector Self;
+      typedef ProjectionFunctions (Self::*MemberFunctionType)( void );
+
+      ProjectionFunctionsSelector( unsigned int dimension )
+        : m_Dimension( dimension ),
+          m_MemberFactory( this )
+        {
+          m_MemberFactory.RegisterMemberFunctions< ProjectionAccumulator::PixelIDTypeList, 4 > ();
+          m_MemberFactory.RegisterMemberFunctions< ProjectionAccumulator::PixelIDTypeList, 3 > ();
+          m_MemberFactory.RegisterMemberFunctions< ProjectionAccumulator::PixelIDTypeList, 2 > ();
+        }
+
+      ProjectionFunctions Select( PixelIDValueEnum pixelID )
+        {
+          return m_MemberFactory.GetMemberFunction( pixelID, m_Dimension )();
+        }
+
+      template <class TImageType>
+      ProjectionFunctions ExecuteInternal( void )
+        {
+          typedef typename TImageType::PixelType ElementType;
+          ProjectionFunctions f;
+          f.m_Fold = &FoldSlices<ElementType>;
+          f.m_Write = &WriteValues<ElementType>;
+          return f;
+        }
+
+    private:
+      unsigned int                                      m_Dimension;
+      detail::MemberFunctionFactory<MemberFunctionType> m_MemberFactory;
+    };
+
+    // The value of a projection before any slice
+    double InitialValue( ProjectionType projection )
+    {
+      switch ( projection )
+        {
+        case ProjectionAccumulator::Maximum:
+          return -std::numeric_limits<double>::infinity();
+        case ProjectionAccumulator::Minimum:
+          return std::numeric_limits<double>::infinity();
+        default:
+          return 0.0;
+        }
+    }
+
+    struct FoldThreadStruct
+    {
+      FoldFunctionType m_Fold;
+      const void      *m_Input;
+      size_t           m_Inner;
+      size_t           m_Slices;
+      size_t           m_NumberOfOutputs;
+      ProjectionType   m_Projection;
+      double          *m_Values;
+      double          *m_SquaredValues;
+
+      // when set, each thread folds a part of the slices into its
+      // own partial projection
+      bool                               m_SplitSlices;
+      std::vector< std::vector<double> > m_PartialValues;
+      std::vector< std::vector<double> > m_PartialSquaredValues;
+    };
+
+    ITK_THREAD_RETURN_TYPE FoldThreaderCallback( void *arg )
+    {
+      typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+      ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+      FoldThreadStruct *str = static_cast<FoldThreadStruct *>( info->UserData );
+
+      const size_t threadId = info->ThreadID;
+      const size_t numberOfThreads = info->NumberOfThreads;
+
+      if ( str->m_SplitSlices )
+        {
+        const size_t sliceBegin = str->m_Slices * threadId / numberOfThreads;
+        const size_t sliceEnd = str->m_Slices * ( threadId + 1 ) / numberOfThreads;
+        str->m_Fold( str->m_Input, str->m_Inner, str->m_Slices,
+                     0, str->m_NumberOfOutputs, sliceBegin, sliceEnd,
+                     str->m_Projection,
+                     &str->m_PartialValues[threadId][0],
+                     &str->m_PartialSquaredValues[threadId][0] );
+        }
+      else
+        {
+        const size_t begin = str->m_NumberOfOutputs * threadId / numberOfThreads;
+        const size_t end = str->m_NumberOfOutputs * ( threadId + 1 ) / numberOfThreads;
+        str->m_Fold( str->m_Input, str->m_Inner, str->m_Slices,
+                     begin, end, 0, str->m_Slices,
+                     str->m_Projection,
+                     str->m_Values, str->m_SquaredValues );
+        }
+
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+    }
+
+
+    ProjectionAccumulator::ProjectionAccumulator( ProjectionType projection )
+      : m_Projection( projection ),
+        m_ProjectionDimension( 0 ),
+        m_NumberOfSlices( 0 ),
+        m_PixelID( sitkUnknown )
+    {
+    }
+
+    ProjectionAccumulator::~ProjectionAccumulator()
+    {
+    }
+
+    ProjectionAccumulator &ProjectionAccumulator::SetProjection ( ProjectionType projection )
+    {
+      this->m_Projection = projection;
+      return this->Reset();
+    }
+
+    ProjectionAccumulator &ProjectionAccumulator::SetProjectionDimension ( unsigned int dimension )
+    {
+      this->m_ProjectionDimension = dimension;
+      return this->Reset();
+    }
+
+    ProjectionAccumulator &ProjectionAccumulator::Reset ( )
+    {
+      this->m_NumberOfSlices = 0;
+      this->m_PixelID = sitkUnknown;
+      this->m_Size.clear();
+      std::vector<double>().swap( this->m_Values );
+      std::vector<double>().swap( this->m_SquaredValues );
+      return *this;
+    }
+
+    ProjectionAccumulator &ProjectionAccumulator::AddSlab ( const Image &slab )
+    {
+      const unsigned int dimension = slab.GetDimension();
+      const unsigned int p = this->m_ProjectionDimension;
+      if ( p >= dimension )
+        {
+        sitkExceptionMacro( "The ProjectionDimension " << p << " is not an axis of an image of dimension " << dimension << "!" );
+        }
+
+      std::vector<unsigned int> size = slab.GetSize();
+      const size_t slices = size[p];
+      size[p] = 1;
+
+      if ( this->m_NumberOfSlices == 0 )
+        {
+        this->m_PixelID = slab.GetPixelID();
+        this->m_Size = size;
+        this->m_Origin = slab.GetOrigin();
+        this->m_Spacing = slab.GetSpacing();
+        this->m_Direction = slab.GetDirection();
+        }
+      else
+        {
+        if ( size != this->m_Size )
+          {
+          sitkExceptionMacro( "The size of the slab does not match the size of the first slab across the projection!" );
+          }
+        if ( slab.GetPixelID() != this->m_PixelID )
+          {
+          sitkExceptionMacro( "The pixel type of the slab is " << slab.GetPixelIDTypeAsString()
+                              << ", not " << GetPixelIDValueAsString( this->m_PixelID ) << " as the first slab!" );
+          }
+        }
+
+      ProjectionFunctionsSelector selector( dimension );
+      const ProjectionFunctions functions = selector.Select( slab.GetPixelID() );
+
+      FoldThreadStruct str;
+      str.m_Fold = functions.m_Fold;
+      str.m_Input = slab.GetBufferAsVoid();
+      str.m_Inner = 1;
+      for ( unsigned int d = 0; d < p; ++d )
+        {
+        str.m_Inner *= size[d];
+        }
+      str.m_Slices = slices;
+      str.m_NumberOfOutputs = 1;
+      for ( unsigned int d = 0; d < dimension; ++d )
+        {
+        str.m_NumberOfOutputs *= size[d];
+        }
+      str.m_Projection = this->m_Projection;
+
+      if ( this->m_NumberOfSlices == 0 )
+        {
+        this->m_Values.assign( str.m_NumberOfOutputs, InitialValue( this->m_Projection ) );
+        this->m_SquaredValues.assign( this->m_Projection == StandardDeviation ? str.m_NumberOfOutputs : 1, 0.0 );
+        }
+      str.m_Values = &this->m_Values[0];
+      str.m_SquaredValues = &this->m_SquaredValues[0];
+
+      // outputs fewer than this per thread are too few to split, so
+      // the slices are split instead
+      const size_t minimumOutputsPerThread = 4096;
+      size_t numberOfThreads = std::max<unsigned int>( 1, this->GetNumberOfThreads() );
+      str.m_SplitSlices = str.m_NumberOfOutputs < minimumOutputsPerThread * numberOfThreads;
+      if ( str.m_SplitSlices )
+        {
+        numberOfThreads = std::max<size_t>( 1, std::min( numberOfThreads, slices ) );
+        str.m_PartialValues.assign( numberOfThreads,
+                                    std::vector<double>( str.m_NumberOfOutputs, InitialValue( this->m_Projection ) ) );
+        str.m_PartialSquaredValues.assign( numberOfThreads,
+                                           std::vector<double>( this->m_SquaredValues.size(), 0.0 ) );
+        }
+
+      itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+      threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+      threader->SetSingleMethod( FoldThreaderCallback, &str );
+      threader->SingleMethodExecute();
+
+      // combine the partial projections in the order of the slices
+      for ( size_t t = 0; t < str.m_PartialValues.size(); ++t )
+        {
+        const double *v = &str.m_PartialValues[t][0];
+        const double *s = &str.m_PartialSquaredValues[t][0];
+        for ( size_t i = 0; i < str.m_NumberOfOutputs; ++i )
+          {
+          switch ( this->m_Projection )
+            {
+            case Maximum:
+              this->m_Values[i] = std::max( this->m_Values[i], v[i] );
+              break;
+            case Minimum:
+              this->m_Values[i] = std::min( this->m_Values[i], v[i] );
+              break;
+            case Sum:
+            case Mean:
+              this->m_Values[i] += v[i];
+              break;
+            case StandardDeviation:
+              this->m_Values[i] += v[i];
+              this->m_SquaredValues[i] += s[i];
+              break;
+            }
+          }
+        }
+
+      this->m_NumberOfSlices += static_cast<unsigned int>( slices );
+      return *this;
+    }
+
+    Image ProjectionAccumulator::GetResult ( ) const
+    {
+      if ( this->m_NumberOfSlices == 0 )
+        {
+        sitkExceptionMacro( "No slab has been added!" );
+        }
+
+      const unsigned int dimension = static_cast<unsigned int>( this->m_Size.size() );
+      const unsigned int p = this->m_ProjectionDimension;
+      const size_t n = this->m_Values.size();
+      const double slices = static_cast<double>( this->m_NumberOfSlices );
+
+      const bool isReal = ( this->m_Projection != Maximum && this->m_Projection != Minimum );
+      const PixelIDValueEnum pixelID = isReal ? sitkFloat64 : this->m_PixelID;
+
+      // one pixel spanning all the slices, at the center of the slices
+      std::vector<double> spacing = this->m_Spacing;
+      std::vector<double> origin = this->m_Origin;
+      for ( unsigned int d = 0; d < dimension; ++d )
+        {
+        origin[d] += this->m_Direction[d * dimension + p] * this->m_Spacing[p] * ( slices - 1.0 ) / 2.0;
+        }
+      spacing[p] *= slices;
+
+      Image output( this->m_Size, pixelID, 0u, Image::NoBufferInitialization );
+      output.SetOrigin( origin );
+      output.SetSpacing( spacing );
+      output.SetDirection( this->m_Direction );
+
+      std::vector<double> values;
+      const double *result = &this->m_Values[0];
+      if ( this->m_Projection == Mean || this->m_Projection == StandardDeviation )
+        {
+        values.resize( n );
+        for ( size_t i = 0; i < n; ++i )
+          {
+          const double mean = this->m_Values[i] / slices;
+          if ( this->m_Projection == Mean )
+            {
+            values[i] = mean;
+            }
+          else
+            {
+            const double squares = std::max( 0.0, this->m_SquaredValues[i] - mean * this->m_Values[i] );
+            values[i] = std::sqrt( squares / ( slices - 1.0 ) );
+            }
+          }
+        result = &values[0];
+        }
+
+      ProjectionFunctionsSelector selector( dimension );
+      selector.Select( pixelID ).m_Write( result, output.GetBufferAsVoid(), n );
+      return output;
+    }
+
+    std::string ProjectionAccumulator::ToString() const
+    {
+      std::ostringstream out;
+      out << "itk::simple::ProjectionAccumulator" << std::endl;
+      out << "  Projection: ";
+      switch ( this->m_Projection )
+        {
+        case Maximum:
+          out << "Maximum";
+          break;
+        case Minimum:
+          out << "Minimum";
+          break;
+        case Sum:
+          out << "Sum";
+          break;
+        case Mean:
+          out << "Mean";
+          break;
+        case StandardDeviation:
+          out << "StandardDeviation";
+          break;
+        }
+      out << std::endl;
+      out << "  ProjectionDimension: " << this->m_ProjectionDimension << std::endl;
+      out << "  NumberOfSlices: " << this->m_NumberOfSlices << std::endl;
+      out << ProcessObject::ToString();
+      return out.str();
+    }
+
+  }
+}
@@ -0,0 +1,749 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkRandomAugmentationFilter.h"
+#include "sitkMemberFunctionFactory.h"
+#include "sitkExceptionObject.h"
+
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+#include "itkPhiloxRandomStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <sstream>
+
+namespace itk {
+  namespace simple {
+
+    namespace
+    {
+
+    // The geometry of the input, padded to 3 dimensions
+    struct InputGeometry
+    {
+      const void  *m_Buffer;
+      unsigned int m_Size[3];
+      double       m_Origin[3];
+      double       m_PhysicalToIndex[3][3];
+    };
+
+    // The random transforms of a patch, padded to 3 dimensions
+    struct SampleGeometry
+    {
+      float              *m_Output;
+      uint32_t            m_SampleNumber;
+      // the physical point of the first pixel, and the physical step
+      // along each axis of the patch, m_Step[r][axis]
+      double              m_Origin[3];
+      double              m_Step[3][3];
+      double              m_Center[3];
+      // the rotation and scaling about the centre
+      double              m_Transform[3][3];
+      double              m_IntensityScale;
+      double              m_IntensityShift;
+      // the displacements of the control points, [z][y][x][component]
+      std::vector<double> m_Coefficients;
+    };
+
+    struct AugmentationThreadStruct;
+
+    typedef void (*ExecuteLineFunctionType)( const AugmentationThreadStruct &str,
+                                             const SampleGeometry &sample,
+                                             unsigned int y, unsigned int z,
+                                             const double *displacement );
+
+    struct AugmentationThreadStruct
+    {
+      InputGeometry               m_Input;
+      std::vector<SampleGeometry> m_Samples;
+      unsigned int                m_OutputSize[3];
+      unsigned int                m_NumberOfCoefficients[3];
+      // the pixels of the patch between control points
+      double                      m_KnotSpacing[3];
+      bool                        m_Elastic;
+      double                      m_NoiseStandardDeviation;
+      double                      m_DefaultPixelValue;
+      uint32_t                    m_Seed;
+      ExecuteLineFunctionType     m_ExecuteLine;
+    };
+
+    bool Invert( const double m[3][3], double inverse[3][3] )
+    {
+      const double det =
+        m[0][0] * ( m[1][1] * m[2][2] - m[1][2] * m[2][1] )
+        - m[0][1] * ( m[1][0] * m[2][2] - m[1][2] * m[2][0] )
+        + m[0][2] * ( m[1][0] * m[2][1] - m[1][1] * m[2][0] );
+      if ( det == 0.0 )
+        {
+        return false;
+        }
+      inverse[0][0] = ( m[1][1] * m[2][2] - m[1][2] * m[2][1] ) / det;
+      inverse[0][1] = ( m[0][2] * m[2][1] - m[0][1] * m[2][2] ) / det;
+      inverse[0][2] = ( m[0][1] * m[1][2] - m[0][2] * m[1][1] ) / det;
+      inverse[1][0] = ( m[1][2] * m[2][0] - m[1][0] * m[2][2] ) / det;
+      inverse[1][1] = ( m[0][0] * m[2][2] - m[0][2] * m[2][0] ) / det;
+      inverse[1][2] = ( m[0][2] * m[1][0] - m[0][0] * m[1][2] ) / det;
+      inverse[2][0] = ( m[1][0] * m[2][1] - m[1][1] * m[2][0] ) / det;
+      inverse[2][1] = ( m[0][1] * m[2][0] - m[0][0] * m[2][1] ) / det;
+      inverse[2][2] = ( m[0][0] * m[1][1] - m[0][1] * m[1][0] ) / det;
+      return true;
+    }
+
+    void Multiply( const double a[3][3], const double b[3][3], double product[3][3] )
+    {
+      for ( unsigned int r = 0; r < 3; ++r )
+        {
+        for ( unsigned int c = 0; c < 3; ++c )
+          {
+          product[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c] + a[r][2] * b[2][c];
+          }
+        }
+    }
+
+    void Rotation( unsigned int axis, double angle, double rotation[3][3] )
+    {
+      const unsigned int i = ( axis + 1 ) % 3;
+      const unsigned int j = ( axis + 2 ) % 3;
+      for ( unsigned int r = 0; r < 3; ++r )
+        {
+        for ( unsigned int c = 0; c < 3; ++c )
+          {
+          rotation[r][c] = ( r == c ) ? 1.0 : 0.0;
+          }
+        }
+      rotation[i][i] = std::cos( angle );
+      rotation[i][j] = -std::sin( angle );
+      rotation[j][i] = std::sin( angle );
+      rotation[j][j] = std::cos( angle );
+    }
+
+    // The first control point and the cubic B-spline weights of the
+    // position t, in control point spacings. An axis with a single
+    // control point, along which the patch is not deformed, has one
+    // weight.
+    unsigned int BSplineWeights( double t, unsigned int numberOfCoefficients, unsigned int &first, double w[4] )
+    {
+      if ( numberOfCoefficients == 1 )
+        {
+        first = 0;
+        w[0] = 1.0;
+        return 1;
+        }
+      // the control points are at -1, 0, ..., n - 2, n, stored from 0
+      const unsigned int last = numberOfCoefficients - 4;
+      first = std::min( static_cast<unsigned int>( std::max( std::floor( t ), 0.0 ) ), last );
+      const double f = t - first;
+      const double g = 1.0 - f;
+      w[0] = g * g * g / 6.0;
+      w[1] = ( 3.0 * f * f * f - 6.0 * f * f + 4.0 ) / 6.0;
+      w[2] = ( -3.0 * f * f * f + 3.0 * f * f + 3.0 * f + 1.0 ) / 6.0;
+      w[3] = f * f * f / 6.0;
+      return 4;
+    }
+
+    // Compute the physical displacement of the pixels of a line of
+    // the patch, 3 components per pixel
+    void ComputeLineDisplacement( const AugmentationThreadStruct &str, const SampleGeometry &sample,
+                                  unsigned int y, unsigned int z,
+                                  std::vector<double> &line, double *displacement )
+    {
+      const unsigned int *n = str.m_NumberOfCoefficients;
+
+      unsigned int firstY, firstZ;
+      double wy[4], wz[4];
+      const unsigned int tapsY = BSplineWeights( y / str.m_KnotSpacing[1], n[1], firstY, wy );
+      const unsigned int tapsZ = BSplineWeights( z / str.m_KnotSpacing[2], n[2], firstZ, wz );
+
+      // contract the control points along z and y, leaving those of
+      // the line along x
+      const size_t lineLength = 3 * n[0];
+      line.assign( lineLength, 0.0 );
+      for ( unsigned int tz = 0; tz < tapsZ; ++tz )
+        {
+        for ( unsigned int ty = 0; ty < tapsY; ++ty )
+          {
+          const double w = wz[tz] * wy[ty];
+          const double *c = &sample.m_Coefficients[( ( firstZ + tz ) * n[1] + firstY + ty ) * lineLength];
+          for ( size_t i = 0; i < lineLength; ++i )
+            {
+            line[i] += w * c[i];
+            }
+          }
+        }
+
+      for ( unsigned int x = 0; x < str.m_OutputSize[0]; ++x )
+        {
+        unsigned int firstX;
+        double wx[4];
+        const unsigned int tapsX = BSplineWeights( x / str.m_KnotSpacing[0], n[0], firstX, wx );
+        double *d = displacement + 3 * x;
+        d[0] = d[1] = d[2] = 0.0;
+        for ( unsigned int tx = 0; tx < tapsX; ++tx )
+          {
+          const double *c = &line[3 * ( firstX + tx )];
+          d[0] += wx[tx] * c[0];
+          d[1] += wx[tx] * c[1];
+          d[2] += wx[tx] * c[2];
+          }
+        }
+    }
+
+    template <typename TElement, bool VLinear>
+    void ExecuteLine( const AugmentationThreadStruct &str, const SampleGeometry &sample,
+                      unsigned int y, unsigned int z, const double *displacement )
+    {
+      const InputGeometry &input = str.m_Input;
+      const TElement *buffer = static_cast<const TElement *>( input.m_Buffer );
+      const size_t stride[3] = { 1,
+                                 input.m_Size[0],
+                                 static_cast<size_t>( input.m_Size[0] ) * input.m_Size[1] };
+
+      const unsigned int sizeX = str.m_OutputSize[0];
+      const size_t lineStart = ( static_cast<size_t>( z ) * str.m_OutputSize[1] + y ) * sizeX;
+      float *output = sample.m_Output + lineStart;
+
+      itk::PhiloxRandomStream noise( str.m_Seed, 0 );
+
+      for ( unsigned int x = 0; x < sizeX; ++x )
+        {
+        // the deformed point of the patch, relative to its centre
+        double p[3];
+        for ( unsigned int r = 0; r < 3; ++r )
+          {
+          p[r] = sample.m_Origin[r]
+            + sample.m_Step[r][0] * x + sample.m_Step[r][1] * y + sample.m_Step[r][2] * z
+            + displacement[3 * x + r] - sample.m_Center[r];
+          }
+
+        double q[3];
+        for ( unsigned int r = 0; r < 3; ++r )
+          {
+          q[r] = sample.m_Center[r] - input.m_Origin[r]
+            + sample.m_Transform[r][0] * p[0] + sample.m_Transform[r][1] * p[1] + sample.m_Transform[r][2] * p[2];
+          }
+
+        double index[3];
+        bool inside = true;
+        for ( unsigned int r = 0; r < 3; ++r )
+          {
+          index[r] = input.m_PhysicalToIndex[r][0] * q[0]
+            + input.m_PhysicalToIndex[r][1] * q[1]
+            + input.m_PhysicalToIndex[r][2] * q[2];
+          // also false for NaN
+          inside = inside && index[r] >= -0.5 && index[r] <= input.m_Size[r] - 0.5;
+          }
+        if ( !inside )
+          {
+          output[x] = static_cast<float>( str.m_DefaultPixelValue );
+          continue;
+          }
+
+        double value = 0.0;
+        if ( VLinear )
+          {
+          // the pixels about the point, clamped to the image
+          size_t offset[3][2];
+          double weight[3][2];
+          for ( unsigned int r = 0; r < 3; ++r )
+            {
+            const double lower = std::floor( index[r] );
+            const double f = index[r] - lower;
+            const long i0 = std::max( static_cast<long>( lower ), 0L );
+            const long i1 = std::min( static_cast<long>( lower ) + 1, static_cast<long>( input.m_Size[r] ) - 1 );
+            offset[r][0] = i0 * stride[r];
+            offset[r][1] = i1 * stride[r];
+            weight[r][0] = 1.0 - f;
+            weight[r][1] = f;
+            }
+          for ( unsigned int dz = 0; dz < 2; ++dz )
+            {
+            if ( weight[2][dz] == 0.0 )
+              {
+              continue;
+              }
+            for ( unsigned int dy = 0; dy < 2; ++dy )
+              {
+              const double wzy = weight[2][dz] * weight[1][dy];
+              const TElement *row = buffer + offset[2][dz] + offset[1][dy];
+              value += wzy * ( weight[0][0] * static_cast<double>( row[offset[0][0]] )
+                               + weight[0][1] * static_cast<double>( row[offset[0][1]] ) );
+              }
+            }
+          }
+        else
+          {
+          size_t offset = 0;
+          for ( unsigned int r = 0; r < 3; ++r )
+            {
+            const long i = static_cast<long>( std::floor( index[r] + 0.5 ) );
+            offset += std::min( std::max( i, 0L ), static_cast<long>( input.m_Size[r] ) - 1 ) * stride[r];
+            }
+          value = static_cast<double>( buffer[offset] );
+          }
+
+        value = value * sample.m_IntensityScale + sample.m_IntensityShift;
+
+        if ( str.m_NoiseStandardDeviation > 0.0 )
+          {
+          // the streams of the noise of the patches follow the stream
+          // of the transforms, number 0
+          noise.Reset( str.m_Seed, lineStart + x, sample.m_SampleNumber + 1 );
+          value += str.m_NoiseStandardDeviation * noise.GetNormalVariate();
+          }
+
+        output[x] = static_cast<float>( value );
+        }
+    }
+
+    ITK_THREAD_RETURN_TYPE AugmentationThreaderCallback( void *arg )
+    {
+      typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+      ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+      const AugmentationThreadStruct *str = static_cast<AugmentationThreadStruct *>( info->UserData );
+
+      // the lines of all the patches are divided between the threads
+      const size_t linesPerSample = static_cast<size_t>( str->m_OutputSize[1] ) * str->m_OutputSize[2];
+      const size_t numberOfLines = linesPerSample * str->m_Samples.size();
+      const size_t begin = numberOfLines * info->ThreadID / info->NumberOfThreads;
+      const size_t end = numberOfLines * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+
+      std::vector<double> line;
+      std::vector<double> displacement( 3 * str->m_OutputSize[0], 0.0 );
+
+      for ( size_t l = begin; l < end; ++l )
+        {
+        const SampleGeometry &sample = str->m_Samples[l / linesPerSample];
+        const unsigned int y = static_cast<unsigned int>( ( l % linesPerSample ) % str->m_OutputSize[1] );
+        const unsigned int z = static_cast<unsigned int>( ( l % linesPerSample ) / str->m_OutputSize[1] );
+        if ( str->m_Elastic )
+          {
+          ComputeLineDisplacement( *str, sample, y, z, line, &displacement[0] );
+          }
+        str->m_ExecuteLine( *str, sample, y, z, &displacement[0] );
+        }
+
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+    // Selects the function sampling the lines of a patch for a pixel
+    // type
+    class ExecuteLineSelector
+    {
+    public:
+      typedef ExecuteLineSelector Self;
+      typedef ExecuteLineFunctionType (Self::*MemberFunctionType)( void );
+
+      ExecuteLineSelector( unsigned int dimension, bool linear )
+        : m_Dimension( dimension ),
+          m_Linear( linear ),
+          m_MemberFactory( this )
+        {
+          m_MemberFactory.RegisterMemberFunctions< RandomAugmentationFilter::PixelIDTypeList, 3 > ();
+          m_MemberFactory.RegisterMemberFunctions< RandomAugmentationFilter::PixelIDTypeList, 2 > ();
+        }
+
+      ExecuteLineFunctionType Select( PixelIDValueEnum pixelID )
+        {
+          return m_MemberFactory.GetMemberFunction( pixelID, m_Dimension )();
+        }
+
+      template <class TImageType>
+      ExecuteLineFunctionType ExecuteInternal( void )
+        {
+          typedef typename TImageType::PixelType PixelType;
+          return m_Linear ? &ExecuteLine<PixelType, true> : &ExecuteLine<PixelType, false>;
+        }
+
+    private:
+      unsigned int                                      m_Dimension;
+      bool                                              m_Linear;
+      detail::MemberFunctionFactory<MemberFunctionType> m_MemberFactory;
+    };
+
+    }
+
+
+    RandomAugmentationFilter::RandomAugmentationFilter()
+      : m_RotationRange( 0.0 ),
+        m_ScaleRange( 0.0 ),
+        m_ElasticGridSize( 4 ),
+        m_ElasticStandardDeviation( 0.0 ),
+        m_IntensityScaleRange( 0.0 ),
+        m_IntensityShiftRange( 0.0 ),
+        m_NoiseStandardDeviation( 0.0 ),
+        m_Interpolator( sitkLinear ),
+        m_DefaultPixelValue( 0.0 ),
+        m_Seed( sitkWallClock ),
+        m_SampleNumber( 0 )
+    {
+    }
+
+    RandomAugmentationFilter::~RandomAugmentationFilter()
+    {
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetOutputSize ( const std::vector<unsigned int> &size )
+    {
+      m_OutputSize = size;
+      return *this;
+    }
+
+    const std::vector<unsigned int> &RandomAugmentationFilter::GetOutputSize ( ) const
+    {
+      return m_OutputSize;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetOutputSpacing ( const std::vector<double> &spacing )
+    {
+      m_OutputSpacing = spacing;
+      return *this;
+    }
+
+    const std::vector<double> &RandomAugmentationFilter::GetOutputSpacing ( ) const
+    {
+      return m_OutputSpacing;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetRotationRange ( double range )
+    {
+      m_RotationRange = range;
+      return *this;
+    }
+
+    double RandomAugmentationFilter::GetRotationRange ( ) const
+    {
+      return m_RotationRange;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetScaleRange ( double range )
+    {
+      m_ScaleRange = range;
+      return *this;
+    }
+
+    double RandomAugmentationFilter::GetScaleRange ( ) const
+    {
+      return m_ScaleRange;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetElasticGridSize ( unsigned int size )
+    {
+      if ( size < 2 )
+        {
+        sitkExceptionMacro( "The ElasticGridSize must be at least 2." );
+        }
+      m_ElasticGridSize = size;
+      return *this;
+    }
+
+    unsigned int RandomAugmentationFilter::GetElasticGridSize ( ) const
+    {
+      return m_ElasticGridSize;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetElasticStandardDeviation ( double sigma )
+    {
+      m_ElasticStandardDeviation = sigma;
+      return *this;
+    }
+
+    double RandomAugmentationFilter::GetElasticStandardDeviation ( ) const
+    {
+      return m_ElasticStandardDeviation;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetIntensityScaleRange ( double range )
+    {
+      m_IntensityScaleRange = range;
+      return *this;
+    }
+
+    double RandomAugmentationFilter::GetIntensityScaleRange ( ) const
+    {
+      return m_IntensityScaleRange;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetIntensityShiftRange ( double range )
+    {
+      m_IntensityShiftRange = range;
+      return *this;
+    }
+
+    double RandomAugmentationFilter::GetIntensityShiftRange ( ) const
+    {
+      return m_IntensityShiftRange;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetNoiseStandardDeviation ( double sigma )
+    {
+      m_NoiseStandardDeviation = sigma;
+      return *this;
+    }
+
+    double RandomAugmentationFilter::GetNoiseStandardDeviation ( ) const
+    {
+      return m_NoiseStandardDeviation;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetInterpolator ( InterpolatorEnum interpolator )
+    {
+      if ( interpolator != sitkLinear && interpolator != sitkNearestNeighbor )
+        {
+        sitkExceptionMacro( "Only the sitkLinear and sitkNearestNeighbor interpolators are supported." );
+        }
+      m_Interpolator = interpolator;
+      return *this;
+    }
+
+    InterpolatorEnum RandomAugmentationFilter::GetInterpolator ( ) const
+    {
+      return m_Interpolator;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetDefaultPixelValue ( double value )
+    {
+      m_DefaultPixelValue = value;
+      return *this;
+    }
+
+    double RandomAugmentationFilter::GetDefaultPixelValue ( ) const
+    {
+      return m_DefaultPixelValue;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetSeed ( uint32_t seed )
+    {
+      m_Seed = seed;
+      return *this;
+    }
+
+    uint32_t RandomAugmentationFilter::GetSeed ( ) const
+    {
+      return m_Seed;
+    }
+
+    RandomAugmentationFilter &RandomAugmentationFilter::SetSampleNumber ( uint32_t sampleNumber )
+    {
+      m_SampleNumber = sampleNumber;
+      return *this;
+    }
+
+    uint32_t RandomAugmentationFilter::GetSampleNumber ( ) const
+    {
+      return m_SampleNumber;
+    }
+
+    std::string RandomAugmentationFilter::ToString() const
+    {
+      std::ostringstream out;
+      out << "itk::simple::RandomAugmentationFilter" << std::endl;
+      out << "  OutputSize:";
+      for ( size_t i = 0; i < m_OutputSize.size(); ++i )
+        {
+        out << " " << m_OutputSize[i];
+        }
+      out << std::endl;
+      out << "  OutputSpacing:";
+      for ( size_t i = 0; i < m_OutputSpacing.size(); ++i )
+        {
+        out << " " << m_OutputSpacing[i];
+        }
+      out << std::endl;
+      out << "  RotationRange: " << m_RotationRange << std::endl;
+      out << "  ScaleRange: " << m_ScaleRange << std::endl;
+      out << "  ElasticGridSize: " << m_ElasticGridSize << std::endl;
+      out << "  ElasticStandardDeviation: " << m_ElasticStandardDeviation << std::endl;
+      out << "  IntensityScaleRange: " << m_IntensityScaleRange << std::endl;
+      out << "  IntensityShiftRange: " << m_IntensityShiftRange << std::endl;
+      out << "  NoiseStandardDeviation: " << m_NoiseStandardDeviation << std::endl;
+      out << "  Interpolator: " << m_Interpolator << std::endl;
+      out << "  DefaultPixelValue: " << m_DefaultPixelValue << std::endl;
+      out << "  Seed: " << m_Seed << std::endl;
+      out << "  SampleNumber: " << m_SampleNumber << std::endl;
+      out << ProcessObject::ToString();
+      return out.str();
+    }
+
+    Image RandomAugmentationFilter::Execute ( const Image &image )
+    {
+      return this->Execute( image, 1u )[0];
+    }
+
+    std::vector<Image> RandomAugmentationFilter::Execute ( const Image &image, unsigned int numberOfSamples )
+    {
+      const unsigned int dimension = image.GetDimension();
+
+      if ( m_OutputSize.size() != dimension )
+        {
+        sitkExceptionMacro( "The OutputSize must have an element for each of the "
+                            << dimension << " dimensions of the image." );
+        }
+      if ( std::find( m_OutputSize.begin(), m_OutputSize.end(), 0u ) != m_OutputSize.end() )
+        {
+        sitkExceptionMacro( "The OutputSize must not be zero." );
+        }
+      if ( !m_OutputSpacing.empty() && m_OutputSpacing.size() != dimension )
+        {
+        sitkExceptionMacro( "The OutputSpacing must be empty or have an element for each of the "
+                            << dimension << " dimensions of the image." );
+        }
+
+      ExecuteLineSelector selector( dimension, m_Interpolator == sitkLinear );
+
+      AugmentationThreadStruct str;
+      str.m_ExecuteLine = selector.Select( image.GetPixelID() );
+
+      const std::vector<unsigned int> size = image.GetSize();
+      const std::vector<double> origin = image.GetOrigin();
+      const std::vector<double> spacing = image.GetSpacing();
+      const std::vector<double> direction = image.GetDirection();
+      const std::vector<double> outputSpacing = m_OutputSpacing.empty() ? spacing : m_OutputSpacing;
+
+      double indexToPhysical[3][3];
+      double step[3][3];
+      for ( unsigned int r = 0; r < 3; ++r )
+        {
+        str.m_Input.m_Size[r] = ( r < dimension ) ? size[r] : 1u;
+        str.m_Input.m_Origin[r] = ( r < dimension ) ? origin[r] : 0.0;
+        str.m_OutputSize[r] = ( r < dimension ) ? m_OutputSize[r] : 1u;
+        for ( unsigned int c = 0; c < 3; ++c )
+          {
+          const double d = ( r < dimension && c < dimension ) ? direction[r * dimension + c] : ( r == c ? 1.0 : 0.0 );
+          indexToPhysical[r][c] = d * ( ( c < dimension ) ? spacing[c] : 1.0 );
+          step[r][c] = d * ( ( c < dimension ) ? outputSpacing[c] : 1.0 );
+          }
+        }
+      if ( !Invert( indexToPhysical, str.m_Input.m_PhysicalToIndex ) )
+        {
+        sitkExceptionMacro( "The direction and spacing of the image are not invertible." );
+        }
+      str.m_Input.m_Buffer = image.GetBufferAsVoid();
+
+      str.m_Elastic = m_ElasticStandardDeviation > 0.0;
+      for ( unsigned int a = 0; a < 3; ++a )
+        {
+        str.m_NumberOfCoefficients[a] = ( a < dimension ) ? m_ElasticGridSize + 2 : 1u;
+        str.m_KnotSpacing[a] = ( str.m_OutputSize[a] > 1 )
+          ? ( str.m_OutputSize[a] - 1.0 ) / ( m_ElasticGridSize - 1.0 ) : 1.0;
+        }
+      const size_t numberOfControlPoints = static_cast<size_t>( str.m_NumberOfCoefficients[0] )
+        * str.m_NumberOfCoefficients[1] * str.m_NumberOfCoefficients[2];
+
+      str.m_NoiseStandardDeviation = m_NoiseStandardDeviation;
+      str.m_DefaultPixelValue = m_DefaultPixelValue;
+      str.m_Seed = ( m_Seed == sitkWallClock ) ? static_cast<uint32_t>( std::time( SITK_NULLPTR ) ) : m_Seed;
+
+      std::vector<Image> outputs;
+      outputs.reserve( numberOfSamples );
+      str.m_Samples.resize( numberOfSamples );
+      for ( unsigned int s = 0; s < numberOfSamples; ++s )
+        {
+        SampleGeometry &sample = str.m_Samples[s];
+        sample.m_SampleNumber = m_SampleNumber + s;
+
+        // the numbers drawn depend only on the dimension, so that the
+        // transforms of a sample do not depend on the settings
+        itk::PhiloxRandomStream random( str.m_Seed, sample.m_SampleNumber );
+
+        double centerIndex[3] = { 0.0, 0.0, 0.0 };
+        for ( unsigned int d = 0; d < dimension; ++d )
+          {
+          centerIndex[d] = random.GetVariate() * ( str.m_Input.m_Size[d] - 1.0 );
+          }
+        double angle[3];
+        for ( unsigned int i = 0; i < 3; ++i )
+          {
+          angle[i] = ( 2.0 * random.GetVariate() - 1.0 ) * m_RotationRange;
+          }
+        const double scale = 1.0 + ( 2.0 * random.GetVariate() - 1.0 ) * m_ScaleRange;
+        sample.m_IntensityScale = 1.0 + ( 2.0 * random.GetVariate() - 1.0 ) * m_IntensityScaleRange;
+        sample.m_IntensityShift = ( 2.0 * random.GetVariate() - 1.0 ) * m_IntensityShiftRange;
+
+        double rotation[3][3];
+        if ( dimension == 2 )
+          {
+          Rotation( 2, angle[0], rotation );
+          }
+        else
+          {
+          double rx[3][3], ry[3][3], rz[3][3], ryx[3][3];
+          Rotation( 0, angle[0], rx );
+          Rotation( 1, angle[1], ry );
+          Rotation( 2, angle[2], rz );
+          Multiply( ry, rx, ryx );
+          Multiply( rz, ryx, rotation );
+          }
+
+        for ( unsigned int r = 0; r < 3; ++r )
+          {
+          sample.m_Center[r] = str.m_Input.m_Origin[r];
+          for ( unsigned int c = 0; c < 3; ++c )
+            {
+            sample.m_Center[r] += indexToPhysical[r][c] * centerIndex[c];
+            sample.m_Step[r][c] = step[r][c];
+            sample.m_Transform[r][c] = ( r < dimension && c < dimension ) ? scale * rotation[r][c] : ( r == c ? 1.0 : 0.0 );
+            }
+          }
+        for ( unsigned int r = 0; r < 3; ++r )
+          {
+          sample.m_Origin[r] = sample.m_Center[r];
+          for ( unsigned int a = 0; a < dimension; ++a )
+            {
+            sample.m_Origin[r] -= step[r][a] * 0.5 * ( str.m_OutputSize[a] - 1.0 );
+            }
+          }
+
+        if ( str.m_Elastic )
+          {
+          sample.m_Coefficients.assign( 3 * numberOfControlPoints, 0.0 );
+          for ( size_t i = 0; i < numberOfControlPoints; ++i )
+            {
+            for ( unsigned int d = 0; d < dimension; ++d )
+              {
+              sample.m_Coefficients[3 * i + d] = m_ElasticStandardDeviation * random.GetNormalVariate();
+              }
+            }
+          }
+
+        Image output( m_OutputSize, sitkFloat32, 0u, Image::NoBufferInitialization );
+        output.SetOrigin( std::vector<double>( sample.m_Origin, sample.m_Origin + dimension ) );
+        output.SetSpacing( outputSpacing );
+        output.SetDirection( direction );
+        sample.m_Output = output.GetBufferAsFloat();
+        outputs.push_back( output );
+        }
+
+      const size_t numberOfLines = static_cast<size_t>( str.m_OutputSize[1] ) * str.m_OutputSize[2] * numberOfSamples;
+      if ( numberOfLines > 0 )
+        {
+        const size_t numberOfThreads =
+          std::max<size_t>( 1, std::min<size_t>( this->GetNumberOfThreads(), numberOfLines ) );
+
+        itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+        threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+        threader->SetSingleMethod( AugmentationThreaderCallback, &str );
+        threader->SingleMethodExecute();
+        }
+
+      m_SampleNumber += numberOfSamples;
+      return outputs;
+    }
+
+  }
+}
@@ -0,0 +1,230 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkSeparableKernel_hxx
+#define sitkSeparableKernel_hxx
+
+#include <cmath>
+#include <vector>
+
+#include <itkConvolutionImageFilter.h>
+#include <itkImageBoundaryCondition.h>
+#include <itkNumericTraits.h>
+
+namespace itk {
+namespace simple {
+
+
+/** \brief Decompose a kernel into the 1-D kernels along each axis
+ * whose outer product is the kernel.
+ *
+ * The kernel values along the lines through the largest value are
+ * the 1-D kernels, up to scaling: the first line has the kernel
+ * values and the others are normalized by the largest value. The
+ * buffer is ordered with the first axis varying fastest.
+ *
+ * Returns false when the kernel is not separable.
+ */
+template< typename TPixel >
+bool DecomposeSeparableKernel( const TPixel *buffer,
+                               const std::vector<unsigned int> &size,
+                               std::vector< std::vector<double> > &lines )
+{
+  const unsigned int dimension = size.size();
+  lines.clear();
+
+  std::vector<size_t> stride( dimension, 1 );
+  size_t numberOfPixels = 1;
+  for ( unsigned int d = 0; d < dimension; ++d )
+    {
+    if ( d > 0 )
+      {
+      stride[d] = stride[d-1] * size[d-1];
+      }
+    numberOfPixels *= size[d];
+    }
+
+  size_t peak = 0;
+  for ( size_t i = 1; i < numberOfPixels; ++i )
+    {
+    if ( std::abs( double( buffer[i] ) ) > std::abs( double( buffer[peak] ) ) )
+      {
+      peak = i;
+      }
+    }
+  const double peakValue = buffer[peak];
+  if ( peakValue == 0.0 )
+    {
+    return false;
+    }
+
+  lines.resize( dimension );
+  for ( unsigned int d = 0; d < dimension; ++d )
+    {
+    const size_t peakIndex = ( peak / stride[d] ) % size[d];
+    const size_t lineStart = peak - peakIndex * stride[d];
+    lines[d].resize( size[d] );
+    for ( unsigned int j = 0; j < size[d]; ++j )
+      {
+      lines[d][j] = buffer[lineStart + j * stride[d]];
+      if ( d != 0 )
+        {
+        lines[d][j] /= peakValue;
+        }
+      }
+    }
+
+  const double tolerance = 1e-6 * std::abs( peakValue );
+  for ( size_t i = 0; i < numberOfPixels; ++i )
+    {
+    double value = 1.0;
+    for ( unsigned int d = 0; d < dimension; ++d )
+      {
+      value *= lines[d][( i / stride[d] ) % size[d]];
+      }
+    if ( std::abs( value - double( buffer[i] ) ) > tolerance )
+      {
+      lines.clear();
+      return false;
+      }
+    }
+  return true;
+}
+
+
+/** \brief Compute a convolution with a separable kernel as one pass
+ * per axis.
+ *
+ * The input of filter must be set. When the kernel is separable
+ * along more than one axis and the pixels are real, a 1-D
+ * convolution is computed for each axis but the last, and its output
+ * is connected as the input of the filter. The 1-D kernel of the
+ * last axis is returned, to be set as the kernel of the filter.
+ * Otherwise the input of the filter is unchanged, and the kernel is
+ * returned.
+ *
+ * The boundary conditions extend the image separably along each
+ * axis, and the VALID region shrinks the image along each axis, so
+ * the passes compute the convolution with the kernel. The sum of the
+ * kernel is the product of the sums of the 1-D kernels, so the
+ * normalization is applied to each pass.
+ */
+template< class TFilter >
+typename TFilter::KernelImageType::ConstPointer
+ConnectSeparableKernelPasses( TFilter *filter,
+                              const typename TFilter::KernelImageType *kernel,
+                              bool normalize,
+                              ImageBoundaryCondition< typename TFilter::InputImageType > *boundaryCondition,
+                              int outputRegionMode,
+                              int numberOfThreads )
+{
+  typedef typename TFilter::InputImageType  InputImageType;
+  typedef typename TFilter::KernelImageType KernelImageType;
+  typedef itk::ConvolutionImageFilter< InputImageType, KernelImageType, InputImageType > PassFilterType;
+
+  // integer pixels would be truncated between the passes
+  if ( NumericTraits< typename InputImageType::PixelType >::is_integer )
+    {
+    return kernel;
+    }
+
+  const typename KernelImageType::RegionType region = kernel->GetBufferedRegion();
+  std::vector<unsigned int> size( KernelImageType::ImageDimension );
+  for ( unsigned int d = 0; d < KernelImageType::ImageDimension; ++d )
+    {
+    size[d] = region.GetSize()[d];
+    }
+
+  std::vector< std::vector<double> > lines;
+  if ( !DecomposeSeparableKernel( kernel->GetBufferPointer(), size, lines ) )
+    {
+    return kernel;
+    }
+
+  // the axes with a 1-D kernel of more than one pixel, the single
+  // pixel kernels only scale the convolution
+  std::vector<unsigned int> axes;
+  double scale = 1.0;
+  for ( unsigned int d = 0; d < KernelImageType::ImageDimension; ++d )
+    {
+    if ( size[d] > 1 )
+      {
+      axes.push_back( d );
+      }
+    else
+      {
+      scale *= lines[d][0];
+      }
+    }
+  if ( axes.size() < 2 )
+    {
+    return kernel;
+    }
+  for ( unsigned int j = 0; j < lines[axes[0]].size(); ++j )
+    {
+    lines[axes[0]][j] *= scale;
+    }
+
+  typename KernelImageType::ConstPointer lineKernel;
+  for ( unsigned int i = 0; i < axes.size(); ++i )
+    {
+    const unsigned int d = axes[i];
+
+    typename KernelImageType::SizeType lineSize;
+    lineSize.Fill( 1 );
+    lineSize[d] = size[d];
+
+    typename KernelImageType::Pointer line = KernelImageType::New();
+    line->SetRegions( typename KernelImageType::RegionType( lineSize ) );
+    line->SetSpacing( kernel->GetSpacing() );
+    line->SetDirection( kernel->GetDirection() );
+    line->Allocate();
+    typename KernelImageType::PixelType *lineBuffer = line->GetBufferPointer();
+    for ( unsigned int j = 0; j < size[d]; ++j )
+      {
+      lineBuffer[j] = static_cast< typename KernelImageType::PixelType >( lines[d][j] );
+      }
+    lineKernel = line;
+
+    if ( i + 1 == axes.size() )
+      {
+      break;
+      }
+
+    // The pass is updated here, the output does not keep the pass
+    // filter alive.
+    typename PassFilterType::Pointer pass = PassFilterType::New();
+    pass->SetInput( filter->GetInput() );
+    pass->SetKernelImage( lineKernel );
+    pass->SetNormalize( normalize );
+    pass->SetBoundaryCondition( boundaryCondition );
+    pass->SetOutputRegionMode( typename PassFilterType::OutputRegionModeType( outputRegionMode ) );
+    pass->SetNumberOfThreads( numberOfThreads );
+    pass->Update();
+
+    typename InputImageType::Pointer passOutput = pass->GetOutput();
+    passOutput->DisconnectPipeline();
+    filter->SetInput( passOutput );
+    }
+
+  return lineKernel;
+}
+
+} // end namespace simple
+} // end namespace itk
+
+#endif
@@ -0,0 +1,378 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkStatisticsAccumulator.h"
+#include "sitkMemberFunctionFactory.h"
+#include "sitkExceptionObject.h"
+
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace itk {
+  namespace simple {
+
+    namespace
+    {
+
+    // the number of pixels read and accumulated at once
+    const size_t BlockSize = 1024;
+
+    typedef void (*ReadBlockFunctionType)( const void *buffer, size_t start, size_t n, double *values );
+    typedef void (*ReadMaskFunctionType)( const void *buffer, size_t start, size_t n, unsigned char *mask );
+
+    template <typename TElement>
+    void ReadBlock( const void *buffer, size_t start, size_t n, double *values )
+    {
+      const TElement *in = static_cast<const TElement *>( buffer ) + start;
+      for ( size_t i = 0; i < n; ++i )
+        {
+        values[i] = static_cast<double>( in[i] );
+        }
+    }
+
+    template <typename TElement>
+    void ReadMask( const void *buffer, size_t start, size_t n, unsigned char *mask )
+    {
+      const TElement *in = static_cast<const TElement *>( buffer ) + start;
+      for ( size_t i = 0; i < n; ++i )
+        {
+        mask[i] = ( in[i] != 0 );
+        }
+    }
+
+    struct BlockFunctions
+    {
+      ReadBlockFunctionType m_Read;
+      ReadMaskFunctionType  m_ReadMask;
+    };
+
+    // Selects the functions for a pixel type
+    class BlockFunctionsSelector
+    {
+    public:
+      typedef BlockFunctionsSelector Self;
+      typedef BlockFunctions (Self::*MemberFunctionType)( void );
+
+      BlockFunctionsSelector( unsigned int dimension )
+        : m_Dimension( dimension ),
+          m_MemberFactory( this )
+        {
+          m_MemberFactory.RegisterMemberFunctions< StatisticsAccumulator::PixelIDTypeList, 4 > ();
+          m_MemberFactory.RegisterMemberFunctions< StatisticsAccumulator::PixelIDTypeList, 3 > ();
+          m_MemberFactory.RegisterMemberFunctions< StatisticsAccumulator::PixelIDTypeList, 2 > ();
+        }
+
+      BlockFunctions Select( PixelIDValueEnum pixelID )
+        {
+          return m_MemberFactory.GetMemberFunction( pixelID, m_Dimension )();
+        }
+
+      template <class TImageType>
+      BlockFunctions ExecuteInternal( void )
+        {
+          typedef typename TImageType::PixelType ElementType;
+          BlockFunctions f;
+          f.m_Read = &ReadBlock<ElementType>;
+          // the masks have integer pixels
+          f.m_ReadMask = std::numeric_limits<ElementType>::is_integer ? &ReadMask<ElementType> : SITK_NULLPTR;
+          return f;
+        }
+
+    private:
+      unsigned int                                      m_Dimension;
+      detail::MemberFunctionFactory<MemberFunctionType> m_MemberFactory;
+    };
+
+    // The statistics of a set of pixels, which are merged with the
+    // parallel algorithm of Chan et al.
+    struct Moments
+    {
+      Moments()
+        : m_Count( 0 ),
+          m_NonZeroCount( 0 ),
+          m_Minimum( std::numeric_limits<double>::infinity() ),
+          m_Maximum( -std::numeric_limits<double>::infinity() ),
+          m_Sum( 0.0 ),
+          m_SumCompensation( 0.0 ),
+          m_Mean( 0.0 ),
+          m_SquaredDeviations( 0.0 )
+        {
+        }
+
+      void AddToSum( double x )
+        {
+          // Kahan summation
+          const double y = x - m_SumCompensation;
+          const double t = m_Sum + y;
+          m_SumCompensation = ( t - m_Sum ) - y;
+          m_Sum = t;
+        }
+
+      void Merge( const Moments &other )
+        {
+          if ( other.m_Count == 0 )
+            {
+            return;
+            }
+          const double na = static_cast<double>( m_Count );
+          const double nb = static_cast<double>( other.m_Count );
+          const double n = na + nb;
+          const double delta = other.m_Mean - m_Mean;
+          m_Mean += delta * nb / n;
+          m_SquaredDeviations += other.m_SquaredDeviations + delta * delta * na * nb / n;
+          m_Count += other.m_Count;
+          m_NonZeroCount += other.m_NonZeroCount;
+          m_Minimum = std::min( m_Minimum, other.m_Minimum );
+          m_Maximum = std::max( m_Maximum, other.m_Maximum );
+          this->AddToSum( other.m_Sum );
+          this->AddToSum( -other.m_SumCompensation );
+        }
+
+      // Accumulate the n values of a block where the mask, if any, is
+      // not zero
+      void AddBlock( const double *values, const unsigned char *mask, size_t n )
+        {
+          Moments block;
+          double sum = 0.0;
+          for ( size_t i = 0; i < n; ++i )
+            {
+            if ( mask && !mask[i] )
+              {
+              continue;
+              }
+            const double x = values[i];
+            ++block.m_Count;
+            block.m_NonZeroCount += ( x != 0.0 );
+            block.m_Minimum = std::min( block.m_Minimum, x );
+            block.m_Maximum = std::max( block.m_Maximum, x );
+            sum += x;
+            }
+          if ( block.m_Count == 0 )
+            {
+            return;
+            }
+
+          // the deviations from the mean of the block, which is in
+          // the cache
+          block.m_Sum = sum;
+          block.m_Mean = sum / static_cast<double>( block.m_Count );
+          double squaredDeviations = 0.0;
+          for ( size_t i = 0; i < n; ++i )
+            {
+            if ( mask && !mask[i] )
+              {
+              continue;
+              }
+            const double d = values[i] - block.m_Mean;
+            squaredDeviations += d * d;
+            }
+          block.m_SquaredDeviations = squaredDeviations;
+
+          this->Merge( block );
+        }
+
+      uint64_t m_Count;
+      uint64_t m_NonZeroCount;
+      double   m_Minimum;
+      double   m_Maximum;
+      double   m_Sum;
+      double   m_SumCompensation;
+      double   m_Mean;
+      double   m_SquaredDeviations;
+    };
+
+    struct StatisticsThreadStruct
+    {
+      ReadBlockFunctionType m_Read;
+      const void           *m_Input;
+      ReadMaskFunctionType  m_ReadMask;
+      const void           *m_Mask;
+      size_t                m_NumberOfElements;
+      std::vector<Moments>  m_Moments;
+    };
+
+    ITK_THREAD_RETURN_TYPE StatisticsThreaderCallback( void *arg )
+    {
+      typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+      ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+      StatisticsThreadStruct *str = static_cast<StatisticsThreadStruct *>( info->UserData );
+
+      // whole blocks for each thread, the last one has the remainder
+      const size_t numberOfBlocks = ( str->m_NumberOfElements + BlockSize - 1 ) / BlockSize;
+      const size_t begin = std::min( str->m_NumberOfElements,
+                                     numberOfBlocks * info->ThreadID / info->NumberOfThreads * BlockSize );
+      const size_t end = std::min( str->m_NumberOfElements,
+                                   numberOfBlocks * ( info->ThreadID + 1 ) / info->NumberOfThreads * BlockSize );
+
+      double values[BlockSize];
+      unsigned char mask[BlockSize];
+      Moments &moments = str->m_Moments[info->ThreadID];
+
+      for ( size_t start = begin; start < end; start += BlockSize )
+        {
+        const size_t n = std::min( BlockSize, end - start );
+        str->m_Read( str->m_Input, start, n, values );
+        if ( str->m_Mask )
+          {
+          str->m_ReadMask( str->m_Mask, start, n, mask );
+          }
+        moments.AddBlock( values, str->m_Mask ? mask : SITK_NULLPTR, n );
+        }
+
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+    }
+
+
+    StatisticsAccumulator::StatisticsAccumulator()
+    {
+      this->Reset();
+    }
+
+    StatisticsAccumulator::~StatisticsAccumulator()
+    {
+    }
+
+    StatisticsAccumulator &StatisticsAccumulator::Reset ( )
+    {
+      const Moments empty;
+      this->m_Count = empty.m_Count;
+      this->m_NonZeroCount = empty.m_NonZeroCount;
+      this->m_Minimum = empty.m_Minimum;
+      this->m_Maximum = empty.m_Maximum;
+      this->m_Sum = empty.m_Sum;
+      this->m_SumCompensation = empty.m_SumCompensation;
+      this->m_Mean = empty.m_Mean;
+      this->m_SquaredDeviations = empty.m_SquaredDeviations;
+      return *this;
+    }
+
+    StatisticsAccumulator &StatisticsAccumulator::AddImage ( const Image &image )
+    {
+      return this->AddImage( image, Image() );
+    }
+
+    StatisticsAccumulator &StatisticsAccumulator::AddImage ( const Image &image, const Image &mask )
+    {
+      BlockFunctionsSelector selector( image.GetDimension() );
+
+      StatisticsThreadStruct str;
+      str.m_Read = selector.Select( image.GetPixelID() ).m_Read;
+      str.m_Input = image.GetBufferAsVoid();
+      str.m_ReadMask = SITK_NULLPTR;
+      str.m_Mask = SITK_NULLPTR;
+      str.m_NumberOfElements = static_cast<size_t>( image.GetNumberOfPixels() );
+
+      // the default Image has no pixel, for no mask
+      if ( mask.GetNumberOfPixels() != 0 )
+        {
+        if ( mask.GetSize() != image.GetSize() )
+          {
+          sitkExceptionMacro( "The size of the mask does not match the size of the image!" );
+          }
+        str.m_ReadMask = selector.Select( mask.GetPixelID() ).m_ReadMask;
+        if ( str.m_ReadMask == SITK_NULLPTR )
+          {
+          sitkExceptionMacro( "The mask must have integer pixels, not " << mask.GetPixelIDTypeAsString() << "!" );
+          }
+        str.m_Mask = mask.GetBufferAsVoid();
+        }
+
+      // elements fewer than this are accumulated by the calling thread
+      const size_t minimumElementsPerThread = 16 * BlockSize;
+      const size_t numberOfThreads =
+        std::max<size_t>( 1, std::min<size_t>( this->GetNumberOfThreads(),
+                                               str.m_NumberOfElements / minimumElementsPerThread ) );
+      str.m_Moments.resize( numberOfThreads );
+
+      itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+      threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+      threader->SetSingleMethod( StatisticsThreaderCallback, &str );
+      threader->SingleMethodExecute();
+
+      Moments moments;
+      moments.m_Count = this->m_Count;
+      moments.m_NonZeroCount = this->m_NonZeroCount;
+      moments.m_Minimum = this->m_Minimum;
+      moments.m_Maximum = this->m_Maximum;
+      moments.m_Sum = this->m_Sum;
+      moments.m_SumCompensation = this->m_SumCompensation;
+      moments.m_Mean = this->m_Mean;
+      moments.m_SquaredDeviations = this->m_SquaredDeviations;
+
+      for ( size_t t = 0; t < str.m_Moments.size(); ++t )
+        {
+        moments.Merge( str.m_Moments[t] );
+        }
+
+      this->m_Count = moments.m_Count;
+      this->m_NonZeroCount = moments.m_NonZeroCount;
+      this->m_Minimum = moments.m_Minimum;
+      this->m_Maximum = moments.m_Maximum;
+      this->m_Sum = moments.m_Sum;
+      this->m_SumCompensation = moments.m_SumCompensation;
+      this->m_Mean = moments.m_Mean;
+      this->m_SquaredDeviations = moments.m_SquaredDeviations;
+      return *this;
+    }
+
+    double StatisticsAccumulator::GetMean ( ) const
+    {
+      if ( this->m_Count == 0 )
+        {
+        return std::numeric_limits<double>::quiet_NaN();
+        }
+      return this->m_Mean;
+    }
+
+    double StatisticsAccumulator::GetVariance ( ) const
+    {
+      if ( this->m_Count == 0 )
+        {
+        return std::numeric_limits<double>::quiet_NaN();
+        }
+      return this->m_SquaredDeviations / ( static_cast<double>( this->m_Count ) - 1.0 );
+    }
+
+    double StatisticsAccumulator::GetSigma ( ) const
+    {
+      return std::sqrt( this->GetVariance() );
+    }
+
+    std::string StatisticsAccumulator::ToString() const
+    {
+      std::ostringstream out;
+      out << "itk::simple::StatisticsAccumulator" << std::endl;
+      out << "  Count: " << this->m_Count << std::endl;
+      out << "  NonZeroCount: " << this->m_NonZeroCount << std::endl;
+      out << "  Minimum: " << this->m_Minimum << std::endl;
+      out << "  Maximum: " << this->m_Maximum << std::endl;
+      out << "  Sum: " << this->m_Sum << std::endl;
+      out << "  Mean: " << this->GetMean() << std::endl;
+      out << "  Variance: " << this->GetVariance() << std::endl;
+      out << ProcessObject::ToString();
+      return out.str();
+    }
+
+  }
+}
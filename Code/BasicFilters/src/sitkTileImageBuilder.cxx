@@ -0,0 +1,281 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkTileImageBuilder.h"
+#include "sitkMemberFunctionFactory.h"
+#include "sitkExceptionObject.h"
+
+#include "itkImage.h"
+#include "itkVectorImage.h"
+
+#include <cassert>
+#include <cstring>
+#include <sstream>
+
+namespace itk {
+  namespace simple {
+
+    namespace
+    {
+
+    // Selects the number of bytes of a pixel of an image
+    class PixelSizeSelector
+    {
+    public:
+      typedef PixelSizeSelector Self;
+      typedef size_t (Self::*MemberFunctionType)( const Image & );
+
+      PixelSizeSelector( )
+        : m_MemberFactory( this )
+        {
+          m_MemberFactory.RegisterMemberFunctions< TileImageBuilder::PixelIDTypeList, 4 > ();
+          m_MemberFactory.RegisterMemberFunctions< TileImageBuilder::PixelIDTypeList, 3 > ();
+          m_MemberFactory.RegisterMemberFunctions< TileImageBuilder::PixelIDTypeList, 2 > ();
+        }
+
+      size_t Select( const Image &image )
+        {
+          return m_MemberFactory.GetMemberFunction( image.GetPixelID(), image.GetDimension() )( image );
+        }
+
+      template <class TImageType>
+      size_t ExecuteInternal( const Image &image )
+        {
+          // the vector images have the components of all the pixels
+          // in one container of the component type
+          typedef typename TImageType::PixelContainer::Element ElementType;
+          const TImageType *itkImage = dynamic_cast<const TImageType *>( image.GetITKBase() );
+          assert( itkImage != SITK_NULLPTR );
+          const size_t numberOfPixels = static_cast<size_t>( image.GetNumberOfPixels() );
+          return sizeof( ElementType ) * ( itkImage->GetPixelContainer()->Size() / numberOfPixels );
+        }
+
+    private:
+      detail::MemberFunctionFactory<MemberFunctionType> m_MemberFactory;
+    };
+
+    }
+
+
+    TileImageBuilder::TileImageBuilder()
+      : m_Spacing( 1.0 ),
+        m_Origin( 0.0 ),
+        m_Buffer( SITK_NULLPTR ),
+        m_PixelSize( 0 ),
+        m_TilePixelID( sitkUnknown )
+    {
+    }
+
+    TileImageBuilder::~TileImageBuilder()
+    {
+    }
+
+    TileImageBuilder &TileImageBuilder::Allocate ( const Image &tile, unsigned int numberOfTiles )
+    {
+      if ( numberOfTiles == 0 )
+        {
+        sitkExceptionMacro( "The number of tiles must be positive!" );
+        }
+
+      const unsigned int tileDimension = tile.GetDimension();
+
+      // the layout of the JoinSeriesImageFilter with a new last axis
+      std::vector<unsigned int> layout = this->m_Layout;
+      if ( layout.empty() )
+        {
+        layout.assign( tileDimension, 1u );
+        layout.push_back( numberOfTiles );
+        }
+      const unsigned int dimension = static_cast<unsigned int>( layout.size() );
+      if ( dimension < tileDimension )
+        {
+        sitkExceptionMacro( "The Layout has " << dimension << " elements for tiles of dimension " << tileDimension << "!" );
+        }
+
+      // as the TileImageFilter, a last 0 fits the number of tiles
+      unsigned int gridTiles = 1;
+      for ( unsigned int d = 0; d + 1 < dimension; ++d )
+        {
+        if ( layout[d] == 0 )
+          {
+          sitkExceptionMacro( "Only the last element of the Layout may be 0!" );
+          }
+        gridTiles *= layout[d];
+        }
+      if ( layout.back() == 0 )
+        {
+        layout.back() = ( numberOfTiles + gridTiles - 1 ) / gridTiles;
+        }
+      if ( static_cast<uint64_t>( gridTiles ) * layout.back() < numberOfTiles )
+        {
+        sitkExceptionMacro( "The Layout has room for " << gridTiles * layout.back() << " tiles, not " << numberOfTiles << "!" );
+        }
+
+      std::vector<unsigned int> tileSize = tile.GetSize();
+      tileSize.resize( dimension, 1u );
+      std::vector<unsigned int> size( dimension );
+      for ( unsigned int d = 0; d < dimension; ++d )
+        {
+        size[d] = tileSize[d] * layout[d];
+        }
+
+      // the geometry of the tile, with the new axes after its axes
+      std::vector<double> spacing = tile.GetSpacing();
+      std::vector<double> origin = tile.GetOrigin();
+      spacing.resize( dimension, this->m_Spacing );
+      origin.resize( dimension, this->m_Origin );
+      const std::vector<double> tileDirection = tile.GetDirection();
+      std::vector<double> direction( dimension * dimension, 0.0 );
+      for ( unsigned int r = 0; r < dimension; ++r )
+        {
+        for ( unsigned int c = 0; c < dimension; ++c )
+          {
+          if ( r < tileDimension && c < tileDimension )
+            {
+            direction[r * dimension + c] = tileDirection[r * tileDimension + c];
+            }
+          else if ( r == c )
+            {
+            direction[r * dimension + c] = 1.0;
+            }
+          }
+        }
+
+      PixelSizeSelector selector;
+      const size_t pixelSize = selector.Select( tile );
+
+      Image output( size, tile.GetPixelID(), tile.GetNumberOfComponentsPerPixel() );
+      output.SetSpacing( spacing );
+      output.SetOrigin( origin );
+      output.SetDirection( direction );
+
+      this->m_Output = output;
+      // the buffer is unique to the output until it is released
+      this->m_Buffer = this->m_Output.GetBufferAsVoid();
+      this->m_PixelSize = pixelSize;
+      this->m_TileSize = tileSize;
+      this->m_TilePixelID = tile.GetPixelID();
+      this->m_AllocatedLayout = layout;
+      this->m_TileIsSet.assign( numberOfTiles, 0 );
+      return *this;
+    }
+
+    TileImageBuilder &TileImageBuilder::SetTile ( unsigned int index, const Image &tile )
+    {
+      if ( this->m_Buffer == SITK_NULLPTR )
+        {
+        sitkExceptionMacro( "The output has not been allocated!" );
+        }
+      if ( index >= this->m_TileIsSet.size() )
+        {
+        sitkExceptionMacro( "The tile " << index << " is out of the " << this->m_TileIsSet.size() << " tiles!" );
+        }
+      if ( tile.GetPixelID() != this->m_TilePixelID )
+        {
+        sitkExceptionMacro( "The pixel type of the tile " << index
+                            << " is " << tile.GetPixelIDTypeAsString()
+                            << ", not " << GetPixelIDValueAsString( this->m_TilePixelID ) << " as allocated!" );
+        }
+
+      const unsigned int dimension = static_cast<unsigned int>( this->m_TileSize.size() );
+      std::vector<unsigned int> tileSize = tile.GetSize();
+      tileSize.resize( dimension, 1u );
+      if ( tile.GetDimension() > dimension || tileSize != this->m_TileSize )
+        {
+        sitkExceptionMacro( "The size of the tile " << index << " does not match the allocated tile size!" );
+        }
+
+      // the first pixel of the tile in the output, and the strides of
+      // the output in pixels
+      std::vector<size_t> start( dimension );
+      std::vector<size_t> stride( dimension );
+      size_t gridIndex = index;
+      size_t outputStride = 1;
+      for ( unsigned int d = 0; d < dimension; ++d )
+        {
+        const size_t layout = this->m_AllocatedLayout[d];
+        start[d] = ( gridIndex % layout ) * this->m_TileSize[d];
+        gridIndex /= layout;
+        stride[d] = outputStride;
+        outputStride *= layout * this->m_TileSize[d];
+        }
+
+      // copy the tile one line along the first axis at a time
+      const size_t lineBytes = this->m_TileSize[0] * this->m_PixelSize;
+      const size_t numberOfLines = static_cast<size_t>( tile.GetNumberOfPixels() ) / this->m_TileSize[0];
+      const char *in = static_cast<const char *>( tile.GetBufferAsVoid() );
+      char *out = static_cast<char *>( this->m_Buffer );
+
+      std::vector<size_t> lineIndex( dimension, 0 );
+      for ( size_t l = 0; l < numberOfLines; ++l )
+        {
+        size_t offset = start[0];
+        for ( unsigned int d = 1; d < dimension; ++d )
+          {
+          offset += ( start[d] + lineIndex[d] ) * stride[d];
+          }
+        std::memcpy( out + offset * this->m_PixelSize, in + l * lineBytes, lineBytes );
+
+        for ( unsigned int d = 1; d < dimension; ++d )
+          {
+          if ( ++lineIndex[d] < this->m_TileSize[d] )
+            {
+            break;
+            }
+          lineIndex[d] = 0;
+          }
+        }
+
+      this->m_TileIsSet[index] = 1;
+      return *this;
+    }
+
+    bool TileImageBuilder::IsTileSet ( unsigned int index ) const
+    {
+      return index < this->m_TileIsSet.size() && this->m_TileIsSet[index] != 0;
+    }
+
+    Image TileImageBuilder::GetOutput ( )
+    {
+      if ( this->m_Buffer == SITK_NULLPTR )
+        {
+        sitkExceptionMacro( "The output has not been allocated!" );
+        }
+
+      Image output = this->m_Output;
+      this->m_Output = Image();
+      this->m_Buffer = SITK_NULLPTR;
+      this->m_TileIsSet.clear();
+      return output;
+    }
+
+    std::string TileImageBuilder::ToString() const
+    {
+      std::ostringstream out;
+      out << "itk::simple::TileImageBuilder" << std::endl;
+      out << "  Layout: ";
+      this->ToStringHelper( out, this->m_Layout );
+      out << std::endl;
+      out << "  Spacing: " << this->m_Spacing << std::endl;
+      out << "  Origin: " << this->m_Origin << std::endl;
+      out << "  NumberOfTiles: " << this->m_TileIsSet.size() << std::endl;
+      out << ProcessObject::ToString();
+      return out.str();
+    }
+
+  }
+}
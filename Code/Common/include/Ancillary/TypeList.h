@@ -66,6 +66,255 @@ struct SITK_ABI_HIDDEN TypeList
 struct SITK_ABI_HIDDEN NullType {};
 
 
+#if defined SITK_HAS_CXX11_VARIADIC_TEMPLATES
+
+/** \cond TYPELIST_IMPLEMENTATION
+ *
+ * With variadic templates the typelists are still TypeList and
+ * NullType chains, but each list is converted once to a flat
+ * parameter pack. The algorithms below expand the pack rather than
+ * recursing on the tail, so a query such as IndexOf or TypeAt is a
+ * single instantiation instead of one for each element, and a
+ * DualVisit instantiates one function for each left type instead of
+ * one class for each combination. The interfaces and results are the
+ * same as the recursive implementation.
+ */
+namespace detail
+{
+
+template <typename... TTypes> struct SITK_ABI_HIDDEN TypePack {};
+
+// the types of a typelist as a pack, a NullType is empty and any
+// other type is a pack of one
+template <typename T> struct SITK_ABI_HIDDEN AsPack
+{
+  typedef TypePack<T> Type;
+};
+template <> struct SITK_ABI_HIDDEN AsPack<NullType>
+{
+  typedef TypePack<> Type;
+};
+template <typename THead, typename TTail> struct SITK_ABI_HIDDEN AsPack< TypeList<THead, TTail> >
+{
+private:
+  template <typename TPack> struct Prepend;
+  template <typename... TTypes> struct Prepend< TypePack<TTypes...> >
+  {
+    typedef TypePack<THead, TTypes...> Type;
+  };
+public:
+  typedef typename Prepend<typename AsPack<TTail>::Type>::Type Type;
+};
+
+// the typelist of a pack, without its NullTypes
+template <typename TPack> struct SITK_ABI_HIDDEN FromPack;
+template <> struct SITK_ABI_HIDDEN FromPack< TypePack<> >
+{
+  typedef NullType Type;
+};
+template <typename THead, typename... TTail> struct SITK_ABI_HIDDEN FromPack< TypePack<THead, TTail...> >
+{
+  typedef TypeList<THead, typename FromPack< TypePack<TTail...> >::Type> Type;
+};
+template <typename... TTail> struct SITK_ABI_HIDDEN FromPack< TypePack<NullType, TTail...> >
+{
+  typedef typename FromPack< TypePack<TTail...> >::Type Type;
+};
+
+template <typename TPack1, typename TPack2> struct SITK_ABI_HIDDEN ConcatPack;
+template <typename... TTypes1, typename... TTypes2>
+struct SITK_ABI_HIDDEN ConcatPack< TypePack<TTypes1...>, TypePack<TTypes2...> >
+{
+  typedef TypePack<TTypes1..., TTypes2...> Type;
+};
+
+template <typename T1, typename T2> struct SITK_ABI_HIDDEN IsSame { enum { Result = false }; };
+template <typename T> struct SITK_ABI_HIDDEN IsSame<T, T> { enum { Result = true }; };
+
+// the index of the first true value, or -1, these functions depend
+// only on the number of values and are shared by all lists
+constexpr int FirstTrue( int )
+{
+  return -1;
+}
+template <typename... TBools>
+constexpr int FirstTrue( int index, bool value, TBools... values )
+{
+  return value ? index : FirstTrue( index + 1, values... );
+}
+
+template <typename TPack, typename TType> struct SITK_ABI_HIDDEN IndexOfPack;
+template <typename... TTypes, typename TType> struct SITK_ABI_HIDDEN IndexOfPack< TypePack<TTypes...>, TType >
+{
+  enum { Result = FirstTrue( 0, bool( IsSame<TTypes, TType>::Result )... ) };
+};
+
+// a sequence of indexes, generated with a logarithmic depth
+template <unsigned int... VIndexes> struct SITK_ABI_HIDDEN IndexSequence {};
+
+template <typename TSequence1, typename TSequence2> struct SITK_ABI_HIDDEN ConcatSequence;
+template <unsigned int... VIndexes1, unsigned int... VIndexes2>
+struct SITK_ABI_HIDDEN ConcatSequence< IndexSequence<VIndexes1...>, IndexSequence<VIndexes2...> >
+{
+  typedef IndexSequence<VIndexes1..., ( sizeof...( VIndexes1 ) + VIndexes2 )...> Type;
+};
+
+template <unsigned int VLength> struct SITK_ABI_HIDDEN MakeIndexSequence
+{
+  typedef typename ConcatSequence< typename MakeIndexSequence<VLength / 2>::Type,
+                                   typename MakeIndexSequence<VLength - VLength / 2>::Type >::Type Type;
+};
+template <> struct SITK_ABI_HIDDEN MakeIndexSequence<0> { typedef IndexSequence<> Type; };
+template <> struct SITK_ABI_HIDDEN MakeIndexSequence<1> { typedef IndexSequence<0> Type; };
+
+// each type of a pack is a base class with its index, the type at an
+// index is deduced from the conversion to that base class
+template <unsigned int VIndex, typename TType> struct SITK_ABI_HIDDEN IndexedType
+{
+  typedef TType Type;
+};
+
+template <typename TSequence, typename TPack> struct SITK_ABI_HIDDEN IndexedTypes;
+template <unsigned int... VIndexes, typename... TTypes>
+struct SITK_ABI_HIDDEN IndexedTypes< IndexSequence<VIndexes...>, TypePack<TTypes...> >
+  : IndexedType<VIndexes, TTypes>...
+{
+};
+
+template <unsigned int VIndex, typename TType>
+IndexedType<VIndex, TType> SelectIndexedType( const IndexedType<VIndex, TType> * );
+
+template <typename TPack, unsigned int VIndex, bool VInRange> struct SITK_ABI_HIDDEN TypeAtPack
+{
+  typedef NullType Type;
+};
+template <typename... TTypes, unsigned int VIndex>
+struct SITK_ABI_HIDDEN TypeAtPack< TypePack<TTypes...>, VIndex, true >
+{
+private:
+  typedef IndexedTypes< typename MakeIndexSequence<sizeof...( TTypes )>::Type, TypePack<TTypes...> > IndexedTypesType;
+public:
+  typedef typename decltype( SelectIndexedType<VIndex>( static_cast<const IndexedTypesType *>( 0 ) ) )::Type Type;
+};
+
+template <typename TPack> struct SITK_ABI_HIDDEN VisitPack;
+template <typename... TTypes> struct SITK_ABI_HIDDEN VisitPack< TypePack<TTypes...> >
+{
+  // the predicate type is deduced const for a const predicate
+  template <typename TPredicate>
+  static void Visit( TPredicate &visitor )
+  {
+    const int expand[] = { 0, ( (void)visitor.CLANG_TEMPLATE operator()<TTypes>( ), 0 )... };
+    (void)expand;
+  }
+
+  template <typename TLeftType, typename TPredicate>
+  static void VisitRHS( TPredicate &visitor )
+  {
+    const int expand[] = { 0, ( (void)visitor.CLANG_TEMPLATE operator()<TLeftType, TTypes>( ), 0 )... };
+    (void)expand;
+  }
+};
+
+template <typename TLeftPack, typename TRightPack> struct SITK_ABI_HIDDEN DualVisitPack;
+template <typename... TLeftTypes, typename TRightPack>
+struct SITK_ABI_HIDDEN DualVisitPack< TypePack<TLeftTypes...>, TRightPack >
+{
+  template <typename TPredicate>
+  static void Visit( TPredicate &visitor )
+  {
+    const int expand[] = { 0, ( VisitPack<TRightPack>::template VisitRHS<TLeftTypes>( visitor ), 0 )... };
+    (void)expand;
+  }
+};
+
+}
+/** \endcond */
+
+
+template <typename... TTypes>
+struct SITK_ABI_HIDDEN MakeTypeList
+{
+  typedef typename detail::FromPack< detail::TypePack<TTypes...> >::Type Type;
+};
+
+template <typename TTypeList>
+struct SITK_ABI_HIDDEN Length
+{
+private:
+  template <typename TPack> struct PackLength;
+  template <typename... TTypes> struct PackLength< detail::TypePack<TTypes...> >
+  {
+    enum { Result = sizeof...( TTypes ) };
+  };
+public:
+  enum { Result = PackLength<typename detail::AsPack<TTypeList>::Type>::Result };
+};
+
+template <class TTypeList, unsigned int index>
+struct SITK_ABI_HIDDEN TypeAt
+{
+private:
+  typedef typename detail::AsPack<TTypeList>::Type PackType;
+public:
+  typedef typename detail::TypeAtPack< PackType, index, ( index < Length<TTypeList>::Result ) >::Type Result;
+};
+
+template <class TTypeList1, class TTypeList2>
+struct SITK_ABI_HIDDEN Append
+{
+  typedef typename detail::FromPack< typename detail::ConcatPack< typename detail::AsPack<TTypeList1>::Type,
+                                                                  typename detail::AsPack<TTypeList2>::Type >::Type >::Type Type;
+};
+
+template <class TTypeList, class TType>
+struct SITK_ABI_HIDDEN IndexOf
+{
+  enum { Result = detail::IndexOfPack<typename detail::AsPack<TTypeList>::Type, TType>::Result };
+};
+
+template <class TTypeList, class TType>
+struct SITK_ABI_HIDDEN HasType
+{
+  enum { Result = ( IndexOf<TTypeList, TType>::Result != -1 ) };
+};
+
+template <class TTypeList>
+struct SITK_ABI_HIDDEN Visit
+{
+  template < class Predicate >
+  void operator()( Predicate &visitor ) const
+  {
+    detail::VisitPack<typename detail::AsPack<TTypeList>::Type>::Visit( visitor );
+  }
+  template < class Predicate >
+  void operator()( const Predicate &visitor ) const
+  {
+    detail::VisitPack<typename detail::AsPack<TTypeList>::Type>::Visit( visitor );
+  }
+};
+
+template < typename TLeftTypeList, typename TRightTypeList >
+struct SITK_ABI_HIDDEN DualVisit
+{
+  template <typename Visitor>
+  void operator()( Visitor &visitor ) const
+  {
+    detail::DualVisitPack< typename detail::AsPack<TLeftTypeList>::Type,
+                           typename detail::AsPack<TRightTypeList>::Type >::Visit( visitor );
+  }
+
+  template <typename Visitor>
+  void operator()( const Visitor &visitor ) const
+  {
+    detail::DualVisitPack< typename detail::AsPack<TLeftTypeList>::Type,
+                           typename detail::AsPack<TRightTypeList>::Type >::Visit( visitor );
+  }
+};
+
+#else
+
+
 
 /**\class  MakeTypeList
  * \brief Generates a TypeList from it's template arguments
@@ -474,6 +723,8 @@ struct SITK_ABI_HIDDEN DualVisitImpl< typelist::NullType, typelist::NullType >
 };
 /**\endcond*/
 
+#endif
+
 }
 
 #endif // __TypeList_H__
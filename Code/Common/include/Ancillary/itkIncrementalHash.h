@@ -0,0 +1,275 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkIncrementalHash_h
+#define itkIncrementalHash_h
+
+#include "itkIntTypes.h"
+#include "itkByteSwapper.h"
+#include "itkMultiThreader.h"
+#include "Ancillary/itkXXHash64.h"
+#include "Ancillary/hl_md5.h"
+#include "Ancillary/hl_sha1.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace itk {
+
+/** \class IncrementalHash
+ * \brief Compute the SHA1, MD5 or fast hash of data given in
+ * consecutive pieces.
+ *
+ * The data may be given to Update in any number of pieces, the hash
+ * is the hash of the concatenated pieces. The data is an array of
+ * values of ValueSize bytes which are hashed as little endian, on big
+ * endian systems they are swapped in a copy without modifying the
+ * data.
+ *
+ * The FAST hash is the XXH64 of the little endian XXH64 of each block
+ * of BlockSize bytes of the data, followed by the number of bytes of
+ * the data and by the trailer given to Final. The blocks of a piece
+ * are hashed in parallel, so the pieces should be large. The SHA1 and
+ * MD5 hashes are of the data followed by the trailer.
+ */
+class IncrementalHash
+{
+public:
+  enum HashFunction { SHA1, MD5, FAST };
+
+  /** The number of bytes of the blocks of the FAST hash. */
+  itkStaticConstMacro(BlockSize, SizeValueType, 1u << 20);
+
+  explicit IncrementalHash( HashFunction hashFunction = MD5, unsigned int valueSize = 1 )
+    : m_HashFunction( hashFunction ),
+      m_ValueSize( std::max( valueSize, 1u ) ),
+      m_NumberOfThreads( MultiThreader::GetGlobalDefaultNumberOfThreads() ),
+      m_NumberOfBytes( 0 )
+    {
+      m_MD5.MD5Init( &m_MD5Context );
+      m_SHA1.SHA1Reset( &m_SHA1Context );
+    }
+
+  HashFunction GetHashFunction() const { return m_HashFunction; }
+
+  /** The number of threads hashing the blocks of the FAST hash. */
+  void SetNumberOfThreads( ThreadIdType numberOfThreads ) { m_NumberOfThreads = std::max<ThreadIdType>( numberOfThreads, 1 ); }
+  ThreadIdType GetNumberOfThreads() const { return m_NumberOfThreads; }
+
+  /** The number of bytes given to Update. */
+  uint64_t GetNumberOfBytes() const { return m_NumberOfBytes; }
+
+  /** Hash the next size bytes of the data, size must be a multiple
+   * of the ValueSize. */
+  void Update( const void *data, size_t size )
+    {
+      const unsigned char *p = static_cast< const unsigned char * >( data );
+      m_NumberOfBytes += size;
+
+      if ( m_HashFunction != FAST )
+        {
+        // the hash functions take at most 4GB at once
+        const size_t pieceSize = size_t(1) << 30;
+        while ( size > 0 )
+          {
+          const size_t n = std::min( size, pieceSize );
+          const unsigned char *bytes = this->ToLittleEndian( p, n, m_Swapped );
+          if ( m_HashFunction == SHA1 )
+            {
+            m_SHA1.SHA1Input( &m_SHA1Context, bytes, static_cast< unsigned int >( n ) );
+            }
+          else
+            {
+            m_MD5.MD5Update( &m_MD5Context, const_cast< unsigned char * >( bytes ), static_cast< unsigned int >( n ) );
+            }
+          p += n;
+          size -= n;
+          }
+        return;
+        }
+
+      const size_t blockSize = BlockSize;
+
+      // complete the partial block of the previous pieces
+      if ( !m_Partial.empty() )
+        {
+        const size_t n = std::min( size, blockSize - m_Partial.size() );
+        this->AppendPartial( p, n );
+        p += n;
+        size -= n;
+        if ( m_Partial.size() == blockSize )
+          {
+          m_BlockHashes.push_back( XXHash64::Hash( &m_Partial[0], m_Partial.size() ) );
+          m_Partial.clear();
+          }
+        }
+
+      // hash the complete blocks in parallel
+      const size_t numberOfBlocks = size / blockSize;
+      if ( numberOfBlocks > 0 )
+        {
+        ThreadStruct str;
+        str.m_Self = this;
+        str.m_Buffer = p;
+        str.m_FirstBlock = m_BlockHashes.size();
+        m_BlockHashes.resize( m_BlockHashes.size() + numberOfBlocks );
+
+        MultiThreader::Pointer threader = MultiThreader::New();
+        threader->SetNumberOfThreads( std::min<ThreadIdType>( m_NumberOfThreads, static_cast< ThreadIdType >( numberOfBlocks ) ) );
+        threader->SetSingleMethod( &IncrementalHash::ThreaderCallback, &str );
+        threader->SingleMethodExecute();
+
+        p += numberOfBlocks*blockSize;
+        size -= numberOfBlocks*blockSize;
+        }
+
+      this->AppendPartial( p, size );
+    }
+
+  /** The hash as a string of hexadecimal digits, of the data and of
+   * size bytes of a trailer. */
+  std::string Final( const void *trailer = NULL, size_t size = 0 )
+    {
+      std::vector<unsigned char> digest;
+
+      if ( m_HashFunction == FAST )
+        {
+        std::vector<uint64_t> hashes( m_BlockHashes );
+        if ( !m_Partial.empty() )
+          {
+          hashes.push_back( XXHash64::Hash( &m_Partial[0], m_Partial.size() ) );
+          }
+        hashes.push_back( m_NumberOfBytes );
+        ByteSwapper<uint64_t>::SwapRangeFromSystemToLittleEndian( &hashes[0], hashes.size() );
+
+        std::vector<unsigned char> bytes( hashes.size()*sizeof(uint64_t) );
+        std::memcpy( &bytes[0], &hashes[0], bytes.size() );
+        if ( size > 0 )
+          {
+          const unsigned char *t = static_cast< const unsigned char * >( trailer );
+          bytes.insert( bytes.end(), t, t + size );
+          }
+
+        std::ostringstream os;
+        os.width( 16 );
+        os.fill( '0' );
+        os << std::hex << XXHash64::Hash( &bytes[0], bytes.size() );
+        return os.str();
+        }
+
+      // the trailer is not swapped
+      const unsigned int valueSize = m_ValueSize;
+      m_ValueSize = 1;
+      if ( size > 0 )
+        {
+        this->Update( trailer, size );
+        }
+      m_ValueSize = valueSize;
+
+      if ( m_HashFunction == SHA1 )
+        {
+        digest.resize( SHA1HashSize );
+        m_SHA1.SHA1Result( &m_SHA1Context, &digest[0] );
+        }
+      else
+        {
+        digest.resize( 16 );
+        m_MD5.MD5Final( &digest[0], &m_MD5Context );
+        }
+
+      std::ostringstream os;
+      for ( size_t i = 0; i < digest.size(); ++i )
+        {
+        // set the width to 2, fill with 0, and convert to hex
+        os.width( 2 );
+        os.fill( '0' );
+        os << std::hex << static_cast< unsigned int >( digest[i] );
+        }
+      return os.str();
+    }
+
+private:
+  struct ThreadStruct
+  {
+    IncrementalHash     *m_Self;
+    const unsigned char *m_Buffer;
+    size_t               m_FirstBlock;
+  };
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void *arg )
+    {
+      MultiThreader::ThreadInfoStruct *info = static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+      ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+      IncrementalHash *self = str->m_Self;
+
+      const size_t blockSize = BlockSize;
+      const size_t numberOfBlocks = self->m_BlockHashes.size() - str->m_FirstBlock;
+      std::vector<unsigned char> swapped;
+      for ( size_t block = info->ThreadID; block < numberOfBlocks; block += info->NumberOfThreads )
+        {
+        const unsigned char *bytes = self->ToLittleEndian( str->m_Buffer + block*blockSize, blockSize, swapped );
+        self->m_BlockHashes[str->m_FirstBlock + block] = XXHash64::Hash( bytes, blockSize );
+        }
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+  // The bytes as little endian values, either the bytes or a
+  // swapped copy in buffer.
+  const unsigned char *ToLittleEndian( const unsigned char *bytes, size_t size, std::vector<unsigned char> &buffer ) const
+    {
+      if ( !ByteSwapper<uint16_t>::SystemIsBigEndian() || m_ValueSize == 1 )
+        {
+        return bytes;
+        }
+      buffer.resize( size );
+      for ( size_t i = 0; i + m_ValueSize <= size; i += m_ValueSize )
+        {
+        std::reverse_copy( bytes + i, bytes + i + m_ValueSize, buffer.begin() + i );
+        }
+      return &buffer[0];
+    }
+
+  void AppendPartial( const unsigned char *bytes, size_t size )
+    {
+      if ( size > 0 )
+        {
+        const unsigned char *littleEndian = this->ToLittleEndian( bytes, size, m_Swapped );
+        m_Partial.insert( m_Partial.end(), littleEndian, littleEndian + size );
+        }
+    }
+
+  HashFunction               m_HashFunction;
+  unsigned int               m_ValueSize;
+  ThreadIdType               m_NumberOfThreads;
+  uint64_t                   m_NumberOfBytes;
+
+  ::MD5                      m_MD5;
+  ::HL_MD5_CTX               m_MD5Context;
+  ::SHA1                     m_SHA1;
+  ::HL_SHA1_CTX              m_SHA1Context;
+
+  std::vector<uint64_t>      m_BlockHashes;
+  std::vector<unsigned char> m_Partial;
+  std::vector<unsigned char> m_Swapped;
+};
+
+} // end namespace itk
+
+#endif // itkIncrementalHash_h
@@ -0,0 +1,142 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef itkXXHash64_h
+#define itkXXHash64_h
+
+#include "itkIntTypes.h"
+#include "itkByteSwapper.h"
+
+#include <cstring>
+
+namespace itk {
+
+/** \class XXHash64
+ * \brief The non-cryptographic 64 bits XXH64 hash of Yann Collet.
+ *
+ * The hash of a buffer is the same on all platforms, the buffer is
+ * read as little endian 64 and 32 bits words.
+ */
+class XXHash64
+{
+public:
+  /** Compute the hash of size bytes of a buffer. */
+  static uint64_t Hash( const void *buffer, size_t size, uint64_t seed = 0 )
+    {
+      const unsigned char *p = static_cast< const unsigned char * >( buffer );
+      const unsigned char *end = p + size;
+      uint64_t h;
+
+      if ( size >= 32 )
+        {
+        const unsigned char *limit = end - 32;
+        uint64_t v1 = seed + Prime1() + Prime2();
+        uint64_t v2 = seed + Prime2();
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - Prime1();
+        do
+          {
+          v1 = Round( v1, Read64( p ) );
+          v2 = Round( v2, Read64( p + 8 ) );
+          v3 = Round( v3, Read64( p + 16 ) );
+          v4 = Round( v4, Read64( p + 24 ) );
+          p += 32;
+          }
+        while ( p <= limit );
+
+        h = RotateLeft( v1, 1 ) + RotateLeft( v2, 7 ) + RotateLeft( v3, 12 ) + RotateLeft( v4, 18 );
+        h = MergeRound( h, v1 );
+        h = MergeRound( h, v2 );
+        h = MergeRound( h, v3 );
+        h = MergeRound( h, v4 );
+        }
+      else
+        {
+        h = seed + Prime5();
+        }
+
+      h += static_cast< uint64_t >( size );
+
+      for ( ; p + 8 <= end; p += 8 )
+        {
+        h ^= Round( 0, Read64( p ) );
+        h = RotateLeft( h, 27 ) * Prime1() + Prime4();
+        }
+      if ( p + 4 <= end )
+        {
+        h ^= static_cast< uint64_t >( Read32( p ) ) * Prime1();
+        h = RotateLeft( h, 23 ) * Prime2() + Prime3();
+        p += 4;
+        }
+      for ( ; p < end; ++p )
+        {
+        h ^= static_cast< uint64_t >( *p ) * Prime5();
+        h = RotateLeft( h, 11 ) * Prime1();
+        }
+
+      h ^= h >> 33;
+      h *= Prime2();
+      h ^= h >> 29;
+      h *= Prime3();
+      h ^= h >> 32;
+      return h;
+    }
+
+private:
+  static uint64_t MakeUInt64( uint32_t high, uint32_t low ) { return ( static_cast< uint64_t >( high ) << 32 ) | low; }
+
+  static uint64_t Prime1() { return MakeUInt64( 0x9E3779B1u, 0x85EBCA87u ); }
+  static uint64_t Prime2() { return MakeUInt64( 0xC2B2AE3Du, 0x27D4EB4Fu ); }
+  static uint64_t Prime3() { return MakeUInt64( 0x165667B1u, 0x9E3779F9u ); }
+  static uint64_t Prime4() { return MakeUInt64( 0x85EBCA77u, 0xC2B2AE63u ); }
+  static uint64_t Prime5() { return MakeUInt64( 0x27D4EB2Fu, 0x165667C5u ); }
+
+  static uint64_t RotateLeft( uint64_t x, unsigned int r ) { return ( x << r ) | ( x >> ( 64 - r ) ); }
+
+  static uint64_t Round( uint64_t accumulator, uint64_t input )
+    {
+      accumulator += input * Prime2();
+      accumulator = RotateLeft( accumulator, 31 );
+      return accumulator * Prime1();
+    }
+
+  static uint64_t MergeRound( uint64_t accumulator, uint64_t value )
+    {
+      accumulator ^= Round( 0, value );
+      return accumulator * Prime1() + Prime4();
+    }
+
+  static uint64_t Read64( const unsigned char *p )
+    {
+      uint64_t value;
+      std::memcpy( &value, p, sizeof( value ) );
+      ByteSwapper< uint64_t >::SwapFromSystemToLittleEndian( &value );
+      return value;
+    }
+
+  static uint32_t Read32( const unsigned char *p )
+    {
+      uint32_t value;
+      std::memcpy( &value, p, sizeof( value ) );
+      ByteSwapper< uint32_t >::SwapFromSystemToLittleEndian( &value );
+      return value;
+    }
+};
+
+} // end namespace itk
+
+#endif // itkXXHash64_h
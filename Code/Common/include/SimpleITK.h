@@ -36,6 +36,8 @@
 #include "sitkDetail.h"
 #include "sitkVersion.h"
 #include "sitkImage.h"
+#include "sitkImageView.h"
+#include "sitkFloat16.h"
 #include "sitkTransform.h"
 #include "sitkBSplineTransform.h"
 #include "sitkDisplacementFieldTransform.h"
@@ -56,17 +58,25 @@
 #include "sitkEvent.h"
 #include "sitkRandomSeed.h"
 
+#include "sitkCancellationToken.h"
 #include "sitkProcessObject.h"
+#include "sitkPipeline.h"
+#include "sitkExecutionCache.h"
 #include "sitkImageFilter.h"
 #include "sitkCommand.h"
 #include "sitkFunctionCommand.h"
 
 // IO classes
 #include "sitkImageFileReader.h"
+#include "sitkImageFileReaderQueue.h"
 #include "sitkImageSeriesReader.h"
 #include "sitkImageFileWriter.h"
 #include "sitkImageSeriesWriter.h"
+#include "sitkImageMemoryIO.h"
 #include "sitkImportImageFilter.h"
+#include "sitkSharedMemoryImage.h"
+#include "sitkCompressedImageStore.h"
+#include "sitkDistributedTileExecutor.h"
 
 
 #include "sitkHashImageFilter.h"
@@ -78,7 +88,22 @@
 #include "sitkCenteredTransformInitializerFilter.h"
 #include "sitkCenteredVersorTransformInitializerFilter.h"
 #include "sitkLandmarkBasedTransformInitializerFilter.h"
+#include "sitkFlattenTransformFilter.h"
+#include "sitkMultiResolutionDemonsRegistrationFilter.h"
+#include "sitkFFTConfiguration.h"
+#include "sitkConvolve.h"
+#include "sitkDeconvolutionContext.h"
+#include "sitkNormalizedCorrelationMatcher.h"
+#include "sitkLabelFeaturesImageFilter.h"
+#include "sitkHistogramImageFilter.h"
 #include "sitkCastImageFilter.h"
+#include "sitkImageAccumulator.h"
+#include "sitkTileImageBuilder.h"
+#include "sitkProjectionAccumulator.h"
+#include "sitkStatisticsAccumulator.h"
+#include "sitkPackedBinaryImage.h"
+#include "sitkRandomAugmentationFilter.h"
+#include "sitkGaussianScaleSpaceFilter.h"
 
 #include "sitkAdditionalProcedures.h"
 
@@ -0,0 +1,98 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkCancellationToken_h
+#define sitkCancellationToken_h
+
+#include "sitkCommon.h"
+
+#include <string>
+
+namespace itk
+{
+
+#ifndef SWIG
+class ProcessObject;
+#endif
+
+namespace simple
+{
+
+  /** \class CancellationToken
+   * \brief A request to cancel the executions of the filters sharing
+   * the token.
+   *
+   * A token is set on process objects with
+   * ProcessObject::SetCancellationToken. Copies of a token share the
+   * same state, so one token may be shared by all the filters of a
+   * chain, and cancelled from another thread, such as the thread of
+   * an user interface.
+   *
+   * Cancel aborts the ITK filters currently executing with the token
+   * immediately, as ProcessObject::Abort does, and the filters
+   * executed later with the token abort before doing any work. An
+   * aborted filter throws an exception from Execute, and the buffers
+   * of its outputs are released.
+   *
+   * The filters check the abort request when they report progress, so
+   * the latency of the cancellation depends on the filter.
+   */
+  class SITKCommon_EXPORT CancellationToken
+  {
+  public:
+    typedef CancellationToken Self;
+
+    CancellationToken( void );
+    CancellationToken( const CancellationToken &token );
+    CancellationToken &operator=( const CancellationToken &token );
+    ~CancellationToken( void );
+
+    /** \brief Request the cancellation of the executions. */
+    void Cancel( void );
+
+    /** \brief Returns true if the cancellation has been requested. */
+    bool IsCancelled( void ) const;
+
+    /** \brief Clear the cancellation request, so that the filters
+     * sharing the token may be executed again. */
+    void Reset( void );
+
+    /** Returns true if the tokens share the same state. */
+    bool operator==( const CancellationToken &token ) const { return this->m_Pimple == token.m_Pimple; }
+    bool operator!=( const CancellationToken &token ) const { return this->m_Pimple != token.m_Pimple; }
+
+    std::string ToString( void ) const;
+
+#ifndef SWIG
+    /** Internal methods used by ProcessObject to register the ITK
+     * filters executing with the token, which are aborted by Cancel.
+     * @{
+     */
+    void AddActiveProcess( itk::ProcessObject *p );
+    void RemoveActiveProcess( const itk::ProcessObject *p );
+    /**@}*/
+#endif
+
+  private:
+    class PimpleCancellationToken;
+    PimpleCancellationToken *m_Pimple;
+  };
+
+}
+}
+
+#endif // sitkCancellationToken_h
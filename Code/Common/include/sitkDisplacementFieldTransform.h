@@ -48,8 +48,10 @@ public:
    * constructed transform object. The input image is modified to be a
    * default constructed Image object.
    *
-   * Image must be of sitkVectorFloat64 pixel type with the number of
-   * components equal to the image dimension.
+   * Image must be of sitkVectorFloat64 or sitkVectorFloat32 pixel
+   * type with the number of components equal to the image
+   * dimension. A sitkVectorFloat32 field is converted to the double
+   * precision field of the transform.
    *
    */
   explicit DisplacementFieldTransform( Image &);
@@ -71,8 +73,10 @@ public:
    * transferred to the constructed transform object. The input image
    * is modified to be a default constructed Image object.
    *
-   * Image must be of sitkVectorFloat64 pixel type with the number of
-   * components equal to the image dimension.
+   * Image must be of sitkVectorFloat64 or sitkVectorFloat32 pixel
+   * type with the number of components equal to the image
+   * dimension. A sitkVectorFloat32 field is converted to the double
+   * precision field of the transform.
    *
    */
   SITK_RETURN_SELF_TYPE_HEADER SetDisplacementField(Image &);
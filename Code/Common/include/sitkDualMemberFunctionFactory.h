@@ -170,6 +170,17 @@ protected:
 
   ObjectType *m_ObjectPointer;
 
+  // maps of Keys to pointers to member functions, which are bound to
+  // the object when returned
+#if defined SITK_HAS_UNORDERED_MAP
+  typedef nsstd::unordered_map< typename Superclass::KeyType, MemberFunctionType, hash<typename Superclass::KeyType> > MapType;
+#else
+  typedef std::map<typename Superclass::KeyType, MemberFunctionType> MapType;
+#endif
+
+  MapType m_PFunction3;
+  MapType m_PFunction2;
+
 };
 
 } // end namespace detail
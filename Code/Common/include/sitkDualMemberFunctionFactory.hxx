@@ -114,10 +114,10 @@ DualMemberFunctionFactory< TMemberFunctionPointer >
     switch( int(TImageType1::ImageDimension) )
       {
       case 3:
-        Superclass::m_PFunction3[ key ] = Superclass::BindObject( pfunc, m_ObjectPointer );
+        m_PFunction3[ key ] = pfunc;
         break;
       case 2:
-        Superclass::m_PFunction2[ key ] = Superclass::BindObject( pfunc, m_ObjectPointer );
+        m_PFunction2[ key ] = pfunc;
         break;
       default:
         break;
@@ -152,11 +152,11 @@ DualMemberFunctionFactory< TMemberFunctionPointer >
     switch ( imageDimension )
       {
       case 3:
-        // check if tr1::function has been set in map
-        return Superclass::m_PFunction3.find( key ) != Superclass::m_PFunction3.end();
+        // check if the member function has been set in map
+        return m_PFunction3.find( key ) != m_PFunction3.end();
       case 2:
-        // check if tr1::function has been set in map
-        return Superclass::m_PFunction2.find( key ) != Superclass::m_PFunction2.end();
+        // check if the member function has been set in map
+        return m_PFunction2.find( key ) != m_PFunction2.end();
       default:
         return false;
       }
@@ -188,11 +188,14 @@ DualMemberFunctionFactory< TMemberFunctionPointer >
   switch ( imageDimension )
     {
     case 3:
-      // check if tr1::function has been set
-      if ( Superclass::m_PFunction3.find( key ) != Superclass::m_PFunction3.end() )
+      // check if the member function has been set
+      {
+      typename MapType::const_iterator iter = m_PFunction3.find( key );
+      if ( iter != m_PFunction3.end() )
         {
-        return Superclass::m_PFunction3[ key ];
+        return Superclass::BindObject( iter->second, m_ObjectPointer );
         }
+      }
 
       // todo updated exceptions here
       sitkExceptionMacro ( << "Pixel type: "
@@ -202,11 +205,14 @@ DualMemberFunctionFactory< TMemberFunctionPointer >
 
       break;
     case 2:
-      // check if tr1::function has been set
-      if ( Superclass::m_PFunction2.find( key ) != Superclass::m_PFunction2.end() )
+      // check if the member function has been set
+      {
+      typename MapType::const_iterator iter = m_PFunction2.find( key );
+      if ( iter != m_PFunction2.end() )
         {
-        return Superclass::m_PFunction2[ key ];
+        return Superclass::BindObject( iter->second, m_ObjectPointer );
         }
+      }
 
       sitkExceptionMacro ( << "Pixel type: "
                            << GetPixelIDValueAsString(pixelID1)
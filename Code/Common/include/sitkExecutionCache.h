@@ -0,0 +1,118 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkExecutionCache_h
+#define sitkExecutionCache_h
+
+#include "sitkCommon.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+namespace simple
+{
+
+class Image;
+
+/** \class ExecutionCache
+ * \brief Global cache of the output images of filter executions
+ *
+ * When the cache is enabled, with a memory budget, the filters
+ * generated from the JSON descriptions look up their output before
+ * executing. The key of an output is the name and parameters of the
+ * filter, printed with all their digits, and a hash of the pixels,
+ * pixel type, size, origin, spacing and direction of each input. A repeated execution with the same
+ * parameters on the same images returns the cached image, which
+ * shares its buffer with the cache until it is modified.
+ *
+ * On a cache hit the filter is not executed, so no command is
+ * invoked. The filters with measurements, a random seed, parameters
+ * which are not printed or without an output image are never
+ * cached, nor are the label map images.
+ * The meta-data dictionaries of the images are not cached.
+ *
+ * The least recently used images are evicted when the images in
+ * memory exceed the memory budget. When a spill directory is set,
+ * the evicted images are written to files in it, and read back on
+ * a later hit. The files are removed by Clear.
+ */
+class SITKCommon_EXPORT ExecutionCache
+{
+public:
+
+  /** \brief The budget in bytes of the cached images in memory
+   *
+   * The cache is disabled when the budget is 0, the default.
+   * Reducing the budget evicts the images over it.
+   * @{
+   */
+  static void SetMaximumMemory( uint64_t bytes );
+  static uint64_t GetMaximumMemory();
+  /**@}*/
+
+  /** \brief True when the budget is not 0. */
+  static bool IsEnabled();
+
+  /** \brief The directory where the evicted images are written,
+   * disabled when empty, the default.
+   * @{
+   */
+  static void SetSpillDirectory( const std::string &directory );
+  static std::string GetSpillDirectory();
+  /**@}*/
+
+  /** \brief Remove all the cached images, and their spilled
+   * files. */
+  static void Clear();
+
+  /** \brief The bytes of the cached images in memory. */
+  static uint64_t GetMemoryUsed();
+
+  /** \brief The number of images in memory and spilled to files. */
+  static unsigned int GetNumberOfImages();
+
+  /** \brief The number of lookups which found, and did not find, a
+   * cached image since the last Clear.
+   * @{
+   */
+  static uint64_t GetNumberOfHits();
+  static uint64_t GetNumberOfMisses();
+  /**@}*/
+
+#ifndef SWIG
+  /** \brief The key of the execution of the filter of a name, with
+   * the printed parameters and the input images. */
+  static std::string MakeKey( const std::string &name,
+                              const std::string &parameters,
+                              const std::vector<const Image *> &inputs );
+
+  /** \brief Find the cached image of a key, returns false if there
+   * is none. */
+  static bool Find( const std::string &key, Image &image );
+
+  /** \brief Cache the image of a key. Images without a pixel buffer
+   * are not cached. */
+  static void Insert( const std::string &key, const Image &image );
+#endif
+};
+
+}
+}
+
+#endif
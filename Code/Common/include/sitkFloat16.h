@@ -0,0 +1,77 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkFloat16_h
+#define sitkFloat16_h
+
+#include "sitkCommon.h"
+#include "sitkImage.h"
+
+namespace itk
+{
+namespace simple
+{
+
+/** \brief The 16 bit floating point formats of EncodeFloat16
+ *
+ * sitkFloat16IEEE is the IEEE 754 half precision format, with 5 bits
+ * of exponent and 10 bits of mantissa. sitkBFloat16 is the upper half
+ * of a 32 bit float, with 8 bits of exponent and 7 bits of mantissa.
+ */
+enum Float16FormatEnum {
+  sitkFloat16IEEE = 0,
+  sitkBFloat16 = 1
+};
+
+/** \brief Encode an image of 32 or 64 bit floats into 16 bit floats
+ *
+ * The values are rounded to the nearest 16 bit float, with ties to
+ * even, after the conversion of 64 bit floats to 32 bit floats. The
+ * values too large for the format become infinite. The 16 bit floats
+ * are stored in an image of sitkUInt16, or sitkVectorUInt16 for a
+ * vector image, with the same size and physical meta-data. This
+ * halves the memory of sitkFloat32 images.
+ *
+ * The format is recorded in the "SITK_Float16Format" meta-data
+ * entry, which is kept by the MetaImage and NRRD files, so an encoded
+ * image read from these files may be decoded. The other entries of
+ * the meta-data dictionary are copied.
+ *
+ * The encoded image is not a floating point image for the filters,
+ * it must be decoded before processing.
+ *
+ * \sa DecodeFloat16
+ */
+SITKCommon_EXPORT Image EncodeFloat16( const Image &image, Float16FormatEnum format = sitkFloat16IEEE );
+
+/** \brief Decode an image encoded by EncodeFloat16
+ *
+ * The output pixel type is sitkFloat32 or sitkFloat64, or their
+ * vector types for a vector image. The conversion is exact. An
+ * exception is thrown if the image does not have the
+ * "SITK_Float16Format" meta-data entry of an encoded image.
+ */
+SITKCommon_EXPORT Image DecodeFloat16( const Image &image, PixelIDValueEnum outputPixelType = sitkFloat32 );
+
+/** \brief True if the image has the "SITK_Float16Format" meta-data
+ * entry of an image encoded by EncodeFloat16. */
+SITKCommon_EXPORT bool IsFloat16Encoded( const Image &image );
+
+}
+}
+
+#endif // sitkFloat16_h
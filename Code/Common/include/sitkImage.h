@@ -29,6 +29,7 @@
 
 #include <vector>
 #include <memory>
+#include <algorithm>
 
 namespace itk
 {
@@ -65,6 +66,28 @@ namespace simple
     Image( const Image &img );
     Image& operator=( const Image &img );
 
+#if defined(SITK_HAS_CXX11_RVREF) && !defined(SWIG)
+    /** \brief Move constructor and assignment.
+     *
+     * The internal image is transferred without allocating or
+     * changing the reference count of the ITK image, so that
+     * temporaries such as filter outputs do not later trigger a copy
+     * on write. The moved-from image may only be assigned to or
+     * destroyed.
+     * @{
+     */
+    Image( Image &&img ) SITK_NOEXCEPT;
+    Image& operator=( Image &&img ) SITK_NOEXCEPT;
+    /**@}*/
+#endif
+
+    /** \brief Swap the internal state of this image with another.
+     *
+     * This is a constant time operation which does not allocate or
+     * copy any pixel data.
+     */
+    void Swap( Image &img ) SITK_NOEXCEPT;
+
     /** \brief Constructors for 2D, 3D an optionally 4D images where
      * pixel type and number of components can be specified.
      *
@@ -85,6 +108,31 @@ namespace simple
     Image( const std::vector< unsigned int > &size, PixelIDValueEnum valueEnum, unsigned int numberOfComponents = 0 );
     /**@}*/
 
+    /** \brief How the pixel buffer of a newly constructed image is
+     * initialized.
+     *
+     * ZeroBufferInitialization sets all pixels to zero, large buffers
+     * are filled in parallel by multiple threads. The buffer is split
+     * among the threads as by the filters with the default number of
+     * threads, so on NUMA systems the memory of each piece is on the
+     * node of the thread which will likely process it.
+     *
+     * NoBufferInitialization leaves the pixel values undefined. This
+     * avoids a full pass over the memory when the buffer will be
+     * entirely overwritten, such as when the pixels are immediately
+     * set with SetRegionFrom methods. Label map images are always
+     * empty.
+     */
+    typedef enum { ZeroBufferInitialization, NoBufferInitialization } BufferInitializationType;
+
+    /** \brief Constructor for an image with the specified
+     * initialization of the pixel buffer.
+     *
+     * The parameters are the same as for the above constructor.
+     */
+    Image( const std::vector< unsigned int > &size, PixelIDValueEnum valueEnum, unsigned int numberOfComponents,
+           BufferInitializationType initialization );
+
 
     /** \brief Construct an SimpleITK Image from an pointer to an ITK
      * image
@@ -159,6 +207,35 @@ namespace simple
      */
     uint64_t GetNumberOfPixels( void ) const;
 
+    /** \brief Get the number of bytes used by the image's pixel buffer
+     *
+     * The pixel buffer of an Image is always contiguous, so this is
+     * the number of pixels multiplied by the number of components per
+     * pixel and by the size of a component. Label map images do not
+     * have a pixel buffer and 0 is returned.
+     */
+    uint64_t GetSizeInBytes( void ) const;
+
+    /** \brief Returns true if the pixel buffer is shared with another
+     * object.
+     *
+     * The buffer is shared with copies of this image, or image views,
+     * until the copy on write policy makes the buffer unique. When
+     * shared, a method which modifies the pixels first makes a deep
+     * copy requiring an additional GetSizeInBytes of memory. Setting
+     * the origin, spacing, direction or meta-data dictionary only
+     * copies the meta-data and keeps the buffer shared.
+     */
+    bool IsBufferShared( void ) const;
+
+    /** \brief Get the alignment of the pixel buffer in bytes
+     *
+     * The largest power of two, up to 4096, which divides the
+     * address of the first pixel. Zero is returned if the image has no
+     * pixel buffer.
+     */
+    unsigned int GetBufferAlignment( void ) const;
+
     /** Get/Set the Origin
      * @{
      */
@@ -196,6 +273,22 @@ namespace simple
     /** Transform continuous index to physical point */
     std::vector< double > TransformContinuousIndexToPhysicalPoint( const std::vector< double > &index) const;
 
+    /** \brief Transform many points or indices in one call
+     *
+     * The N points or indices are stored contiguously, with the
+     * GetDimension() coordinates of each point together, and the
+     * results are returned in the same layout. The conversions are
+     * computed by multiple threads, and produce the same results as
+     * the corresponding method for a single point. An exception is
+     * thrown if the length is not a multiple of the dimension.
+     * @{
+     */
+    std::vector< int64_t > TransformPhysicalPointsToIndices( const std::vector< double > &points ) const;
+    std::vector< double > TransformIndicesToPhysicalPoints( const std::vector< int64_t > &indices ) const;
+    std::vector< double > TransformPhysicalPointsToContinuousIndices( const std::vector< double > &points ) const;
+    std::vector< double > TransformContinuousIndicesToPhysicalPoints( const std::vector< double > &indices ) const;
+    /** @} */
+
     std::vector< unsigned int > GetSize( void ) const;
 
     unsigned int GetHeight( void ) const;
@@ -384,15 +477,153 @@ namespace simple
     const double   *GetBufferAsDouble( ) const;
     /** @} */
 
+    /** \brief Get a pointer to the image buffer of any pixel type
+     *
+     * The buffer is GetSizeInBytes() long, and is laid out as the
+     * buffer returned by the GetBufferAs methods for the pixel type of
+     * the image. The non-const method makes the image unique before
+     * returning the pointer. An exception is thrown if the image does
+     * not have a pixel buffer, such as for label maps.
+     *
+     * \sa Image::GetBufferAsInt8
+     * @{
+     */
+    void       *GetBufferAsVoid( );
+    const void *GetBufferAsVoid( ) const;
+    /** @} */
+
+    /** \brief Copy a rectangular region of pixels to or from a buffer.
+     *
+     * The region starting at \p index of \p size is copied between
+     * the image and a contiguous C style buffer, with the first
+     * dimension varying fastest, and the components of vector pixels
+     * interleaved. The buffer must be at least the number of pixels
+     * in the region times the number of components per pixel. These
+     * methods perform a single dispatch on the pixel type and copy the
+     * region by scanlines, which is far more efficient than getting
+     * or setting each pixel individually.
+     *
+     * The index and size must be at least of length GetDimension(),
+     * additional elements are ignored. An exception is thrown if the
+     * region is not inside the image or the method does not match the
+     * component type of the image. Setting a region makes the image
+     * unique before modification.
+     *
+     * \sa Image::GetBufferAsInt8
+     * @{
+     */
+    void GetRegionAsInt8( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, int8_t *buffer ) const;
+    void GetRegionAsUInt8( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, uint8_t *buffer ) const;
+    void GetRegionAsInt16( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, int16_t *buffer ) const;
+    void GetRegionAsUInt16( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, uint16_t *buffer ) const;
+    void GetRegionAsInt32( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, int32_t *buffer ) const;
+    void GetRegionAsUInt32( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, uint32_t *buffer ) const;
+    void GetRegionAsInt64( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, int64_t *buffer ) const;
+    void GetRegionAsUInt64( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, uint64_t *buffer ) const;
+    void GetRegionAsFloat( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, float *buffer ) const;
+    void GetRegionAsDouble( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, double *buffer ) const;
+
+    void SetRegionFromInt8( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const int8_t *buffer );
+    void SetRegionFromUInt8( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const uint8_t *buffer );
+    void SetRegionFromInt16( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const int16_t *buffer );
+    void SetRegionFromUInt16( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const uint16_t *buffer );
+    void SetRegionFromInt32( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const int32_t *buffer );
+    void SetRegionFromUInt32( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const uint32_t *buffer );
+    void SetRegionFromInt64( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const int64_t *buffer );
+    void SetRegionFromUInt64( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const uint64_t *buffer );
+    void SetRegionFromFloat( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const float *buffer );
+    void SetRegionFromDouble( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const double *buffer );
+    /** @} */
+
 
     /** \brief Performs actually coping if needed to make object unique.
      *
      * The Image class by default performs lazy coping and
      * assignment. This method make sure that coping actually happens
-     * to the itk::Image pointed to is only pointed to by this object.
+     * to the itk::Image pointed to is only pointed to by this object,
+     * and that its pixel buffer is not shared with another image.
      */
     void MakeUnique( void );
 
+    /** \brief Statistics of the deep copies performed by MakeUnique.
+     *
+     * When an image's buffer is shared, mutable access such as
+     * SetPixel, GetBuffer or SetOrigin performs a deep copy of the
+     * image. These process wide counters record the number of such
+     * copies and the total number of bytes of pixel buffer copied,
+     * so that unexpected copying can be detected.
+     * @{
+     */
+    static uint64_t GetGlobalNumberOfDeepCopies( void );
+    static uint64_t GetGlobalDeepCopyBytes( void );
+    static void ResetGlobalDeepCopyStatistics( void );
+    /**@}*/
+
+    /** \brief Warn about large copy on write operations.
+     *
+     * When a deep copy made by MakeUnique is at least this number
+     * of bytes a warning is displayed through ITK's output window,
+     * if the global warning display is enabled. The default value of
+     * 0 disables the warning.
+     * @{
+     */
+    static void SetGlobalDeepCopyWarningThreshold( uint64_t bytes );
+    static uint64_t GetGlobalDeepCopyWarningThreshold( void );
+    /**@}*/
+
+#ifndef SWIG
+    /** Function to allocate a pixel buffer of numberOfBytes */
+    typedef void *(*BufferAllocatorFunctionType)( size_t numberOfBytes, void *clientData );
+    /** Function to release a buffer returned by the allocator */
+    typedef void (*BufferDeallocatorFunctionType)( void *buffer, size_t numberOfBytes, void *clientData );
+
+    /** \brief Set the allocator used for the pixel buffer of new images.
+     *
+     * The allocator is used when an Image is constructed with a size
+     * and pixel type. The buffer returned must be suitably aligned
+     * for the pixel type. Each buffer is released with the
+     * deallocator and client data which were set when the buffer was
+     * allocated. Setting both functions to NULL restores the default
+     * allocation.
+     */
+    static void SetGlobalBufferAllocator( BufferAllocatorFunctionType allocator,
+                                          BufferDeallocatorFunctionType deallocator,
+                                          void *clientData = NULL );
+#endif
+
+    /** \brief Enable recycling of the pixel buffers of new images.
+     *
+     * When enabled, the pixel buffer of images constructed with a
+     * size and pixel type are returned to a pool when released, and
+     * are reused by later images with a buffer of the same number of
+     * bytes. This avoids repeatedly allocating and faulting in large
+     * buffers when processing many images of the same geometry. The
+     * pool is not used when a global buffer allocator is set.
+     *
+     * Disabling the pool releases all cached buffers.
+     * @{
+     */
+    static void SetGlobalBufferPool( bool enabled );
+    static bool GetGlobalBufferPool( void );
+    static void GlobalBufferPoolOn( void ) { SetGlobalBufferPool( true ); }
+    static void GlobalBufferPoolOff( void ) { SetGlobalBufferPool( false ); }
+    /**@}*/
+
+    /** \brief The maximum number of bytes cached in the buffer pool.
+     *
+     * The default is 1 GiB.
+     * @{
+     */
+    static void SetGlobalBufferPoolMaximumBytes( uint64_t bytes );
+    static uint64_t GetGlobalBufferPoolMaximumBytes( void );
+    /**@}*/
+
+    /** \brief The number of bytes currently cached in the buffer pool. */
+    static uint64_t GetGlobalBufferPoolBytes( void );
+
+    /** \brief Release all buffers cached in the pool. */
+    static void ReleaseGlobalBufferPool( void );
+
   protected:
 
     /** \brief Methods called by the constructor to allocate and initialize
@@ -401,7 +632,8 @@ namespace simple
      * This method internally utlizes the member function factory to
      * dispatch to methods instantiated on the image of the pixel ID
      */
-    void Allocate ( unsigned int width, unsigned int height, unsigned int depth, unsigned int dim4, PixelIDValueEnum valueEnum, unsigned int numberOfComponents );
+    void Allocate ( unsigned int width, unsigned int height, unsigned int depth, unsigned int dim4, PixelIDValueEnum valueEnum, unsigned int numberOfComponents,
+                    BufferInitializationType initialization = ZeroBufferInitialization );
 
     /** \brief Dispatched methods for allocating images
      *
@@ -412,20 +644,30 @@ namespace simple
      */
     template<class TImageType>
     typename EnableIf<IsBasic<TImageType>::Value>::Type
-    AllocateInternal ( unsigned int width, unsigned int height, unsigned int depth, unsigned int dim4, unsigned int numberOfComponents );
+    AllocateInternal ( unsigned int width, unsigned int height, unsigned int depth, unsigned int dim4, unsigned int numberOfComponents, BufferInitializationType initialization );
 
     template<class TImageType>
     typename EnableIf<IsVector<TImageType>::Value>::Type
-    AllocateInternal ( unsigned int width, unsigned int height, unsigned int depth, unsigned int dim4, unsigned int numberOfComponents );
+    AllocateInternal ( unsigned int width, unsigned int height, unsigned int depth, unsigned int dim4, unsigned int numberOfComponents, BufferInitializationType initialization );
 
     template<class TImageType>
     typename EnableIf<IsLabel<TImageType>::Value>::Type
-    AllocateInternal ( unsigned int width, unsigned int height, unsigned int depth, unsigned int dim4, unsigned int numberOfComponents );
+    AllocateInternal ( unsigned int width, unsigned int height, unsigned int depth, unsigned int dim4, unsigned int numberOfComponents, BufferInitializationType initialization );
     /**@}*/
 
 
   private:
 
+    friend class ImageView;
+
+    /** Construct an image taking ownership of the pimple image. */
+    explicit Image( PimpleImageBase *pimpleImage );
+
+    /** Make the meta-data and the meta-data dictionary of the
+     * itk::Image only referenced by this object, the pixel buffer
+     * stays shared until MakeUnique is called. */
+    void MakeUniqueInformation( void );
+
    /** Method called by certain constructors to convert ITK images
      * into simpleITK ones.
      *
@@ -473,7 +715,27 @@ namespace simple
     PimpleImageBase *m_PimpleImage;
   };
 
+#ifndef SWIG
+  /** \brief Swap two images, found via argument dependent lookup. */
+  inline void swap( Image &lhs, Image &rhs ) SITK_NOEXCEPT
+  {
+    lhs.Swap( rhs );
+  }
+#endif
+
+}
+}
+
+#ifndef SWIG
+namespace std
+{
+/** Specialization so that std::swap does not use the copy constructor. */
+template<>
+inline void swap( itk::simple::Image &lhs, itk::simple::Image &rhs ) SITK_NOEXCEPT
+{
+  lhs.Swap( rhs );
 }
 }
+#endif
 
 #endif
@@ -109,6 +109,79 @@ GetVectorImageFromImage( itk::Image< itk::Vector< TPixelType, NImageDimension >,
   return GetVectorImageFromImage<TPixelType,NImageDimension,NImageDimension>(img, transferOwnership);
 }
 
+
+/** \brief Copy a component of a VectorImage into a new scalar image.
+ *
+ * The component is copied with a strided loop over the buffer of the
+ * VectorImage, without the VariableLengthVector per pixel of the
+ * VectorIndexSelectionCastImageFilter.
+ */
+template< class TComponentImageType, class TVectorImageType >
+SITKCommon_HIDDEN
+typename TComponentImageType::Pointer
+GetComponentImageFromVectorImage( const TVectorImageType *img, unsigned int component )
+{
+  typedef typename TVectorImageType::InternalPixelType InputComponentType;
+  typedef typename TComponentImageType::PixelType      OutputComponentType;
+
+  const unsigned int numberOfComponents = img->GetNumberOfComponentsPerPixel();
+  if ( component >= numberOfComponents )
+    {
+    sitkExceptionMacro("Component " << component << " is out of range of the "
+                       << numberOfComponents << " components of the vector image!");
+    }
+
+  typename TComponentImageType::Pointer out = TComponentImageType::New();
+  out->CopyInformation( img );
+  out->SetRegions( img->GetBufferedRegion() );
+  out->Allocate();
+
+  const size_t numberOfPixels = img->GetBufferedRegion().GetNumberOfPixels();
+  const InputComponentType *in = img->GetBufferPointer() + component;
+  OutputComponentType *outBuffer = out->GetBufferPointer();
+  for ( size_t i = 0; i < numberOfPixels; ++i )
+    {
+    outBuffer[i] = static_cast<OutputComponentType>( in[i * numberOfComponents] );
+    }
+
+  return out;
+}
+
+
+/** \brief Copy a scalar image into a component of a VectorImage with
+ * the same buffered region.
+ *
+ * This composes a VectorImage one component at a time, so each
+ * scalar image may be released after it is copied.
+ */
+template< class TVectorImageType, class TComponentImageType >
+SITKCommon_HIDDEN
+void
+SetComponentImageOfVectorImage( TVectorImageType *img, const TComponentImageType *componentImage, unsigned int component )
+{
+  typedef typename TVectorImageType::InternalPixelType OutputComponentType;
+  typedef typename TComponentImageType::PixelType      InputComponentType;
+
+  const unsigned int numberOfComponents = img->GetNumberOfComponentsPerPixel();
+  if ( component >= numberOfComponents )
+    {
+    sitkExceptionMacro("Component " << component << " is out of range of the "
+                       << numberOfComponents << " components of the vector image!");
+    }
+  if ( img->GetBufferedRegion() != componentImage->GetBufferedRegion() )
+    {
+    sitkExceptionMacro("Expected the component image to have the same buffered region as the vector image!");
+    }
+
+  const size_t numberOfPixels = img->GetBufferedRegion().GetNumberOfPixels();
+  const InputComponentType *in = componentImage->GetBufferPointer();
+  OutputComponentType *outBuffer = img->GetBufferPointer() + component;
+  for ( size_t i = 0; i < numberOfPixels; ++i )
+    {
+    outBuffer[i * numberOfComponents] = static_cast<OutputComponentType>( in[i] );
+    }
+}
+
 }
 }
 
@@ -0,0 +1,145 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkImageView_h
+#define sitkImageView_h
+
+#include "sitkCommon.h"
+#include "sitkImage.h"
+
+#include <vector>
+
+namespace itk
+{
+namespace simple
+{
+
+  /** \class ImageView
+   * \brief A non-owning view of a rectangular sub-region of an Image.
+   *
+   * An ImageView references the pixel buffer of an existing Image
+   * without copying. It describes the sub-region with an index and
+   * size, and provides the physical meta-data of the sub-region: the
+   * origin is that of the first pixel in the region, while the
+   * spacing and direction are those of the viewed image.
+   *
+   * The view holds a shallow copy of the viewed image, so the buffer
+   * remains valid for the lifetime of the view, and SimpleITK's copy
+   * on write policy ensures the viewed pixels are not modified
+   * through other images.
+   *
+   * The pixels may be accessed directly with the buffer of the image
+   * returned by GetImage(), an offset to the first pixel of the view
+   * and the strides of each dimension. When an Image is required,
+   * such as when the view is the input to a filter, ToImage()
+   * converts the view. A view which is contiguous in the buffer, such
+   * as a slice or a slab of slices, shares the buffer of the image
+   * without copying, only a view which is not contiguous is copied
+   * into the contiguous buffer an Image requires.
+   *
+   * \sa Image::GetBufferAsInt8
+   */
+  class SITKCommon_EXPORT ImageView
+  {
+  public:
+    typedef ImageView Self;
+
+    /** \brief Construct a view of the whole image. */
+    explicit ImageView( const Image &image );
+
+    /** \brief Construct a view of a sub-region of an image.
+     *
+     * The index and size must be of the same dimension as the image,
+     * and the region must be inside the image, otherwise an
+     * exception is thrown.
+     */
+    ImageView( const Image &image,
+               const std::vector<unsigned int> &index,
+               const std::vector<unsigned int> &size );
+
+    /** \brief The image the view references. */
+    const Image &GetImage( void ) const;
+
+    /** \brief The region of the image referenced by the view.
+     * @{
+     */
+    std::vector<unsigned int> GetIndex( void ) const;
+    std::vector<unsigned int> GetSize( void ) const;
+    /**@}*/
+
+    unsigned int GetDimension( void ) const;
+    PixelIDValueEnum GetPixelID( void ) const;
+    unsigned int GetNumberOfComponentsPerPixel( void ) const;
+    uint64_t GetNumberOfPixels( void ) const;
+
+    /** \brief Physical meta-data of the view.
+     *
+     * The origin is the physical location of the first pixel of the
+     * view.
+     * @{
+     */
+    std::vector<double> GetOrigin( void ) const;
+    std::vector<double> GetSpacing( void ) const;
+    std::vector<double> GetDirection( void ) const;
+    /**@}*/
+
+    /** \brief Offset, in number of components, from the start of
+     * the image's buffer to the first pixel of the view.
+     */
+    uint64_t GetBufferOffset( void ) const;
+
+    /** \brief The number of components between adjacent pixels in
+     * each dimension of the image's buffer.
+     */
+    std::vector<uint64_t> GetStrides( void ) const;
+
+    /** \brief Returns true if the pixels of the view are contiguous
+     * in the image's buffer.
+     */
+    bool IsContiguous( void ) const;
+
+    /** \brief Create an Image of the sub-region.
+     *
+     * A shallow copy of the image is returned if the view covers the
+     * whole image. If the view is contiguous, the returned image of
+     * the sub-region shares the buffer of the image, and copy on
+     * write copies its pixels before either image is modified, so
+     * filters do not run in place on it. Otherwise the pixels are
+     * copied. The origin of the returned image is the origin of the
+     * view, and the meta-data dictionary is copied.
+     */
+    Image ToImage( void ) const;
+
+#ifndef SWIG
+    /** Implicit conversion, so that a view may be used where an
+     * Image argument is expected. */
+    operator Image( void ) const { return this->ToImage(); }
+#endif
+
+    std::string ToString( void ) const;
+
+  private:
+
+    Image                     m_Image;
+    std::vector<unsigned int> m_Index;
+    std::vector<unsigned int> m_Size;
+  };
+
+}
+}
+
+#endif // sitkImageView_h
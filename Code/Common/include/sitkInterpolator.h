@@ -102,7 +102,19 @@ enum InterpolatorEnum {
    * \sa itk::WindowedSincInterpolateImageFunction
    * \sa itk::Function::BlackmanWindowFunction
    */
-  sitkBlackmanWindowedSinc = 10
+  sitkBlackmanWindowedSinc = 10,
+
+  /** \brief Interpolator for a BSpline coefficient image, of order 3
+   *
+   * The input image is the coefficients computed by the
+   * BSplineDecompositionImageFilter. Resampling the coefficients
+   * gives the same result as resampling the image with sitkBSpline,
+   * without computing the coefficients on each execution.
+   *
+   * \sa itk::BSplineResampleImageFunction
+   * \sa itk::simple::BSplineDecompositionImageFilter
+   */
+  sitkBSplineResampler = 11
 };
 
 #ifndef SWIG
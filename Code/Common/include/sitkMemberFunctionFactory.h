@@ -50,6 +50,13 @@ namespace detail {
  *  An instance of a MemberFunctionFactory is bound to a specific
  *  instance of an object, so that the returned function object does
  *  not need to have the calling object specified.
+ *
+ *  The registered member function pointers are stored in fixed size
+ *  tables indexed by the pixel ID for each dimension, and are only
+ *  bound to the object when returned by GetMemberFunction. So
+ *  constructing a factory and registering the member functions does
+ *  not allocate memory, and the cost of the dispatch does not depend
+ *  on the number of registered member functions.
  */
 template <typename TMemberFunctionPointer>
 class MemberFunctionFactory
@@ -152,8 +159,22 @@ public:
 
 protected:
 
+  // the number of entries of the tables
+  enum { NumberOfPixelIDs = typelist::Length< InstantiatedPixelIDTypeList >::Result };
+
+  // Returns the table of the dimension or a null pointer when the
+  // dimension is not supported.
+  MemberFunctionType *GetMemberFunctionTable( unsigned int imageDimension ) throw();
+  const MemberFunctionType *GetMemberFunctionTable( unsigned int imageDimension ) const throw();
+
   ObjectType *m_ObjectPointer;
 
+  // tables of pointers to the registered member functions indexed by
+  // pixel ID, a null pointer is not registered
+  MemberFunctionType m_PFunction4[NumberOfPixelIDs];
+  MemberFunctionType m_PFunction3[NumberOfPixelIDs];
+  MemberFunctionType m_PFunction2[NumberOfPixelIDs];
+
 };
 
 } // end namespace detail
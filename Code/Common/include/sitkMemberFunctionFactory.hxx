@@ -19,6 +19,7 @@
 #define sitkMemberFunctionFactory_hxx
 
 #include <cassert>
+#include <algorithm>
 
 #include "sitkMemberFunctionFactory.h"
 #include "sitkDetail.h"
@@ -79,6 +80,37 @@ MemberFunctionFactory<TMemberFunctionPointer>
   : m_ObjectPointer( pObject )
 {
   assert( pObject );
+
+  const MemberFunctionType nullMemberFunction = SITK_NULLPTR;
+  std::fill( m_PFunction4, m_PFunction4 + NumberOfPixelIDs, nullMemberFunction );
+  std::fill( m_PFunction3, m_PFunction3 + NumberOfPixelIDs, nullMemberFunction );
+  std::fill( m_PFunction2, m_PFunction2 + NumberOfPixelIDs, nullMemberFunction );
+}
+
+template <typename TMemberFunctionPointer>
+typename MemberFunctionFactory<TMemberFunctionPointer>::MemberFunctionType *
+MemberFunctionFactory<TMemberFunctionPointer>
+::GetMemberFunctionTable( unsigned int imageDimension ) throw()
+{
+  switch ( imageDimension )
+    {
+    case 4:
+      return m_PFunction4;
+    case 3:
+      return m_PFunction3;
+    case 2:
+      return m_PFunction2;
+    default:
+      return SITK_NULLPTR;
+    }
+}
+
+template <typename TMemberFunctionPointer>
+const typename MemberFunctionFactory<TMemberFunctionPointer>::MemberFunctionType *
+MemberFunctionFactory<TMemberFunctionPointer>
+::GetMemberFunctionTable( unsigned int imageDimension ) const throw()
+{
+  return const_cast<Self *>( this )->GetMemberFunctionTable( imageDimension );
 }
 
 template <typename TMemberFunctionPointer>
@@ -89,27 +121,15 @@ void MemberFunctionFactory<TMemberFunctionPointer>
   PixelIDValueType pixelID = ImageTypeToPixelIDValue<TImageType>::Result;
 
   // this shouldn't occur, just may be useful for debugging
-  assert( pixelID >= 0 && pixelID < typelist::Length< InstantiatedPixelIDTypeList >::Result );
+  assert( pixelID >= 0 && pixelID < NumberOfPixelIDs );
 
   sitkStaticAssert( IsInstantiated<TImageType>::Value,
                     "UnInstantiated ImageType or dimension");
 
-  if ( pixelID >= 0 && pixelID < typelist::Length< InstantiatedPixelIDTypeList >::Result )
+  MemberFunctionType *table = this->GetMemberFunctionTable( TImageType::ImageDimension );
+  if ( table && pixelID >= 0 && pixelID < NumberOfPixelIDs )
     {
-    switch( int(TImageType::ImageDimension) )
-      {
-      case 4:
-        Superclass::m_PFunction4[ pixelID ] = Superclass::BindObject( pfunc, m_ObjectPointer );
-        break;
-      case 3:
-        Superclass::m_PFunction3[ pixelID ] = Superclass::BindObject( pfunc, m_ObjectPointer );
-        break;
-      case 2:
-        Superclass::m_PFunction2[ pixelID ] = Superclass::BindObject( pfunc, m_ObjectPointer );
-        break;
-      default:
-        break;
-      }
+    table[ pixelID ] = pfunc;
     }
 }
 
@@ -133,29 +153,12 @@ bool
 MemberFunctionFactory< TMemberFunctionPointer >
 ::HasMemberFunction( PixelIDValueType pixelID, unsigned int imageDimension  ) const throw()
 {
-
-  try
-    {
-    switch ( imageDimension )
-      {
-      case 4:
-        // check if tr1::function has been set in map
-        return Superclass::m_PFunction4.find( pixelID ) != Superclass::m_PFunction4.end();
-      case 3:
-        // check if tr1::function has been set in map
-        return Superclass::m_PFunction3.find( pixelID ) != Superclass::m_PFunction3.end();
-      case 2:
-        // check if tr1::function has been set in map
-        return Superclass::m_PFunction2.find( pixelID ) != Superclass::m_PFunction2.end();
-      default:
-        return false;
-      }
-    }
-  // we do not throw exceptions
-  catch(...)
+  const MemberFunctionType *table = this->GetMemberFunctionTable( imageDimension );
+  if ( !table || pixelID >= NumberOfPixelIDs || pixelID < 0 )
     {
     return false;
     }
+  return table[ pixelID ] != SITK_NULLPTR;
 }
 
 
@@ -164,51 +167,35 @@ typename MemberFunctionFactory<TMemberFunctionPointer>::FunctionObjectType
 MemberFunctionFactory<TMemberFunctionPointer>
 ::GetMemberFunction( PixelIDValueType pixelID, unsigned int imageDimension  )
 {
-  if ( pixelID >= typelist::Length< InstantiatedPixelIDTypeList >::Result || pixelID < 0 )
+  if ( pixelID >= NumberOfPixelIDs || pixelID < 0 )
     {
     sitkExceptionMacro ( << "unexpected error pixelID is out of range " << pixelID << " "  << typeid(ObjectType).name() );
     }
 
+  const MemberFunctionType *table = this->GetMemberFunctionTable( imageDimension );
+  if ( table && table[ pixelID ] )
+    {
+    return Superclass::BindObject( table[ pixelID ], m_ObjectPointer );
+    }
+
   switch ( imageDimension )
     {
     case 4:
-      // check if tr1::function has been set
-      if ( Superclass::m_PFunction4.find( pixelID ) != Superclass::m_PFunction4.end() )
-        {
-        return Superclass::m_PFunction4[ pixelID ];
-        }
-
       sitkExceptionMacro ( << "Pixel type: "
                            << GetPixelIDValueAsString(pixelID)
                            << " is not supported in 4D by "
                            << typeid(ObjectType).name()
                            << " or SimpleITK compiled with SimpleITK_4D_IMAGES set to OFF." );
     case 3:
-      // check if tr1::function has been set
-      if ( Superclass::m_PFunction3.find( pixelID ) != Superclass::m_PFunction3.end() )
-        {
-        return Superclass::m_PFunction3[ pixelID ];
-        }
-
       sitkExceptionMacro ( << "Pixel type: "
                            << GetPixelIDValueAsString(pixelID)
                            << " is not supported in 3D by"
                            << typeid(ObjectType).name() );
-
-      break;
     case 2:
-      // check if tr1::function has been set
-      if (  Superclass::m_PFunction2.find( pixelID ) != Superclass::m_PFunction2.end() )
-        {
-        return Superclass::m_PFunction2[ pixelID ];
-        }
-
-        sitkExceptionMacro ( << "Pixel type: "
-                             << GetPixelIDValueAsString(pixelID)
-                             << " is not supported in 2D by"
-                             << typeid(ObjectType).name() );
-
-      break;
+      sitkExceptionMacro ( << "Pixel type: "
+                           << GetPixelIDValueAsString(pixelID)
+                           << " is not supported in 2D by"
+                           << typeid(ObjectType).name() );
     default:
       sitkExceptionMacro ( << "Image dimension " << imageDimension << " is not supported" );
       throw;
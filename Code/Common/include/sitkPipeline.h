@@ -0,0 +1,162 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkPipeline_h
+#define sitkPipeline_h
+
+#include "sitkCommon.h"
+#include "sitkNonCopyable.h"
+#include "sitkImage.h"
+
+#include <vector>
+
+namespace itk {
+
+#ifndef SWIG
+  class ProcessObject;
+#endif
+
+  namespace simple {
+
+  class ProcessObject;
+
+  /** \class Pipeline
+   * \brief Defer the execution of filters into one connected ITK pipeline
+   *
+   * By default each filter's Execute method runs the ITK filter and
+   * returns a complete image. When a filter has been added to a
+   * Pipeline, Execute only connects the ITK filter to its inputs and
+   * returns a placeholder image describing the output: its size,
+   * spacing, origin, direction and pixel type are valid, but its
+   * pixels have not been computed. Placeholders passed to other
+   * deferred filters connect the ITK filters into a single pipeline.
+   *
+   * Calling Update with a placeholder executes the ITK pipeline
+   * upstream of it. ITK's requested region propagation then computes
+   * only the regions needed for the result, so for example a final
+   * RegionOfInterest only computes the needed region of the filters
+   * before it.
+   *
+   * \code
+   * Pipeline pipeline;
+   * MedianImageFilter median;
+   * RegionOfInterestImageFilter roi;
+   * pipeline.AddFilter( median );
+   * pipeline.AddFilter( roi );
+   * roi.SetSize( size );
+   * Image result = pipeline.Update( roi.Execute( median.Execute( input ) ) );
+   * \endcode
+   *
+   * The pixels of a placeholder must not be accessed, and a
+   * placeholder should only be used as the input of other deferred
+   * filters or of Update. Filters which do not support deferred
+   * execution, such as those with measurements, execute immediately
+   * and request the complete image of their inputs. Commands added
+   * to a filter are not invoked while it is deferred.
+   *
+   * The image sources, such as GaussianImageSource, GridImageSource
+   * and PhysicalPointImageSource, are deferred too, so they compute
+   * the pixels of the regions requested by the filters using them
+   * rather than a complete image. With a NumberOfStreamDivisions
+   * greater than one, Update computes the output one piece at a
+   * time, and the pipeline upstream, sources included, only holds
+   * the pixels of a piece:
+   *
+   * \code
+   * Pipeline pipeline;
+   * pipeline.SetNumberOfStreamDivisions( 16 );
+   * PhysicalPointImageSource points;
+   * VectorIndexSelectionCastImageFilter select;
+   * MultiplyImageFilter multiply;
+   * pipeline.AddFilter( points );
+   * pipeline.AddFilter( select );
+   * pipeline.AddFilter( multiply );
+   * points.SetReferenceImage( volume );
+   * select.SetIndex( 2 );
+   * // weight a sitkFloat32 volume by the z coordinate, without a
+   * // complete image of the coordinates
+   * Image result = pipeline.Update( multiply.Execute( volume, select.Execute( points.Execute() ) ) );
+   * \endcode
+   *
+   * The ITK filters are kept by the Pipeline until it is destroyed
+   * or ReleaseProcesses is called.
+   */
+  class SITKCommon_EXPORT Pipeline
+    : protected NonCopyable
+  {
+  public:
+    typedef Pipeline Self;
+
+    Pipeline();
+    ~Pipeline();
+
+    /** \brief Defer the execution of a filter
+     *
+     * A filter can only be in one Pipeline, it is removed from a
+     * previous one. The filter is removed from the Pipeline when
+     * either is destroyed.
+     */
+    void AddFilter( ProcessObject &filter );
+    void RemoveFilter( ProcessObject &filter );
+    void RemoveAllFilters();
+
+    /** Get the number of filters added */
+    unsigned int GetNumberOfFilters() const;
+
+    /** Get the number of ITK filters kept from deferred executions */
+    unsigned int GetNumberOfProcesses() const;
+
+    /** \brief The number of pieces of the output computed one after
+     * another by Update, by default 1
+     *
+     * The pieces divide the slowest axis of the output that has
+     * enough pixels. Filters which need their complete input, such
+     * as those which do not support streaming, still compute the
+     * whole of it for each piece.
+     */
+    void SetNumberOfStreamDivisions( unsigned int n );
+    unsigned int GetNumberOfStreamDivisions() const;
+
+    /** \brief Compute the pixels of a placeholder image
+     *
+     * The upstream ITK filters are executed, and the returned
+     * image is disconnected from the pipeline. An image which is not
+     * a placeholder is returned unchanged. When streamed, the pieces
+     * are copied into a new image, except for label map images
+     * which are computed at once.
+     */
+    Image Update( const Image &image );
+
+    /** Release the ITK filters of previous executions */
+    void ReleaseProcesses();
+
+    std::string ToString() const;
+
+  private:
+
+    friend class ProcessObject;
+
+    void AddProcess( itk::ProcessObject *p );
+
+    std::vector<ProcessObject *>      m_Filters;
+    std::vector<itk::ProcessObject *> m_Processes;
+    unsigned int                      m_NumberOfStreamDivisions;
+  };
+
+  }
+}
+#endif
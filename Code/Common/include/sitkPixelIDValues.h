@@ -131,6 +131,13 @@ PixelIDValueType SITKCommon_EXPORT GetPixelIDValueFromString(const std::string &
 
 #ifndef SWIG
 SITKCommon_EXPORT std::ostream& operator<<(std::ostream& os, const PixelIDValueEnum id);
+
+/** \brief The bytes of a component of the pixels of the pixel ID
+ *
+ * A complex pixel is one component. The label maps, which have no
+ * pixel buffer, and the unknown pixel ID have a size of 0.
+ */
+unsigned int SITKCommon_EXPORT GetPixelIDValueComponentSize( PixelIDValueType type );
 #endif
 
 
@@ -23,6 +23,7 @@
 #include "sitkTemplateFunctions.h"
 #include "sitkEvent.h"
 #include "sitkImage.h"
+#include "sitkCancellationToken.h"
 
 #include <iostream>
 #include <list>
@@ -41,11 +42,18 @@ namespace itk {
   namespace simple {
 
   class Command;
+  class Pipeline;
 
 
   /** \class ProcessObject
    * \brief Base class for SimpleITK classes based on ProcessObject
    *
+   * Different process objects may be executed concurrently from
+   * different threads, including on the same input images, since the
+   * inputs are not modified. A process object must not be executed,
+   * or modified, concurrently with itself. The global settings, the
+   * static methods, should be set before the concurrent executions,
+   * they apply to the filters executed after they are set.
    */
   class SITKCommon_EXPORT ProcessObject:
       protected NonCopyable
@@ -123,6 +131,47 @@ namespace itk {
       static unsigned int GetGlobalDefaultNumberOfThreads();
       /**@}*/
 
+      /** \brief The number of threads shared by all the filters
+       * executing concurrently in the process
+       *
+       * When the budget is not 0, the threads of each execution are
+       * reserved from the budget for the duration of the update of
+       * its ITK filter. An execution gets at most its number of
+       * threads, its fair share of the budget with the executing
+       * filters, and the threads left, but at least 1 thread. The
+       * shares are computed again at each execution, so concurrent
+       * pipelines converge to a partition of the budget. A filter
+       * alone gets the whole budget.
+       *
+       * The budget is 0, unlimited, by default.
+       * @{
+       */
+      static void SetGlobalThreadBudget(unsigned int n);
+      static unsigned int GetGlobalThreadBudget();
+      /**@}*/
+
+      /** The number of threads of the budget reserved by the filters
+       * currently executing. */
+      static unsigned int GetGlobalNumberOfReservedThreads();
+
+      /** \brief Set the threader used by all new ITK filters
+       *
+       * "PLATFORM" spawns and joins the threads of each filter at
+       * each multi-threaded stage. "POOL" executes the work of all the
+       * filters in a persistent pool of threads, which avoids the
+       * cost of starting the threads of many small filters in
+       * sequence. "TBB" uses the Intel Threading Building Blocks,
+       * when ITK is built with them. The name is not case sensitive.
+       *
+       * Returns false, and keeps the current threader, if the threader
+       * is not available with the ITK used. The pool requires ITK 4.10
+       * or later, and TBB requires ITK 5.
+       * @{
+       */
+      static bool SetGlobalDefaultThreader(const std::string &threader);
+      static std::string GetGlobalDefaultThreader();
+      /**@}*/
+
       /** \brief Access the global tolerance to determine congruent spaces.
        *
        * The default tolerance is governed by the
@@ -142,6 +191,65 @@ namespace itk {
       static void SetGlobalDefaultDirectionTolerance(double);
       /**@}*/
 
+      /** \brief Record the executions of all the filters
+       *
+       * When enabled, every update of the ITK filter of a process
+       * object is recorded in a global log with the name of the
+       * filter, the name of the ITK filter, the pixel type and size
+       * of its output, the number of threads, the wall and CPU times
+       * in seconds, the bytes of the output buffer and the change of
+       * the memory used by the process in bytes. The times start
+       * before the update, so they include the internal filters of
+       * the ITK filter. The CPU time is that of all the threads of
+       * the process. Filters updated by a Pipeline are not recorded.
+       *
+       * The instrumentation is disabled by default.
+       * @{
+       */
+      static void GlobalInstrumentationOn();
+      static void GlobalInstrumentationOff();
+      static void SetGlobalInstrumentation(bool flag);
+      static bool GetGlobalInstrumentation();
+      /**@}*/
+
+      /** \brief The recorded executions as comma separated values
+       *
+       * The first line is the header, followed by one line per
+       * execution in order: Filter, ITKFilter, PixelType, Size,
+       * NumberOfThreads, WallTime, CPUTime, OutputBytes and
+       * MemoryChange. The size is the size of each dimension
+       * separated by "x".
+       */
+      static std::string GetGlobalInstrumentationLog();
+
+      /** \brief The recorded executions aggregated by filter
+       *
+       * Comma separated values with a header line, and one line per
+       * filter name: Filter, Count, WallTime, CPUTime, OutputBytes
+       * and MaximumMemoryChange, with the sums of the times and of
+       * the bytes. The filters are sorted by decreasing wall time.
+       */
+      static std::string GetGlobalInstrumentationSummary();
+
+      /** \brief The recorded executions as a Chrome trace
+       *
+       * The executions are written as complete events of the Chrome
+       * trace event JSON format, which is read by chrome://tracing
+       * and Perfetto, with the start and duration in microseconds of
+       * wall time, the process id and the index of the calling
+       * thread. The events are in the categories "filter", "io" for
+       * the readers and writers, and "level" for each level of a
+       * multi-resolution registration, from its
+       * sitkMultiResolutionIterationEvent to the next. The events of
+       * the same thread nest by time, so the levels are inside their
+       * registration. The other measurements are the arguments of the
+       * events.
+       */
+      static std::string GetGlobalInstrumentationTrace();
+
+      /** Remove the recorded executions. */
+      static void ClearGlobalInstrumentation();
+
       /** The number of threads used when executing a filter if the
        * filter is multi-threaded
        * @{
@@ -150,6 +258,64 @@ namespace itk {
       virtual unsigned int GetNumberOfThreads() const;
       /**@}*/
 
+      /** \brief The number of pieces the output is computed in
+       *
+       * When greater than one, filters which support streaming
+       * execute the ITK pipeline on this many sub-regions of the
+       * output one after another, so that the memory used by the
+       * filter for intermediate data is bounded by the size of a
+       * piece. The output image is still allocated in full. Filters
+       * which do not support streaming ignore this value. The
+       * default is 1, no streaming.
+       * @{
+       */
+      virtual void SetNumberOfStreamDivisions(unsigned int n);
+      virtual unsigned int GetNumberOfStreamDivisions() const;
+      /**@}*/
+
+      /** \brief Throttle the commands of the sitkProgressEvent
+       *
+       * The commands added for the sitkProgressEvent are called only
+       * when the progress increased by at least the minimum delta, and
+       * at least the minimum interval in seconds elapsed, since the
+       * last call. The first and the last progress of an update are
+       * always reported. With an interval of 1/N seconds the commands
+       * are called at most N times per second, which bounds their
+       * overhead, such as acquiring the interpreter lock of a wrapped
+       * language, for fast filters. The other events are not
+       * throttled. The defaults are 0, every progress is reported.
+       * @{
+       */
+      virtual void SetProgressMinimumDelta(float delta);
+      virtual float GetProgressMinimumDelta() const;
+      virtual void SetProgressMinimumInterval(double seconds);
+      virtual double GetProgressMinimumInterval() const;
+      /**@}*/
+
+      /** \brief Keep the ITK filter between executions
+       *
+       * When enabled, filters keep their internal ITK filter after
+       * the execution, and use it again in the next execution with
+       * the same pixel type and dimension. Data computed by the ITK
+       * filter, such as FFT plans or kernels, is then kept, only the
+       * changed parameters are set, and the output buffer is reused
+       * when the size is not changed. The output buffer is only
+       * reused when the image returned by the previous execution
+       * has been deleted, so returned images are never modified.
+       *
+       * The kept ITK filter holds references to its input and output
+       * images until the next execution, or until the persistent ITK
+       * filter is disabled. The ITK filter is not kept when this
+       * object is added to a Pipeline. Filters whose Execute method
+       * is not generated ignore this value. The default is disabled.
+       * @{
+       */
+      virtual void SetPersistentITKFilter(bool persistentITKFilter);
+      virtual bool GetPersistentITKFilter() const;
+      void PersistentITKFilterOn() { this->SetPersistentITKFilter(true); }
+      void PersistentITKFilterOff() { this->SetPersistentITKFilter(false); }
+      /**@}*/
+
       /** \brief Add a Command Object to observer the event.
        *
        * The Command object's Execute method will be invoked when the
@@ -217,6 +383,28 @@ namespace itk {
        */
       virtual void Abort();
 
+      /** \brief Set a token to cancel the executions of this process
+       * object.
+       *
+       * When the token is cancelled, the ITK filter executing with
+       * the token is aborted, and the later executions throw an
+       * exception before doing any work, until the token is reset. The
+       * same token may be set on all the filters of a chain. The
+       * buffers of the outputs of an aborted ITK filter are released
+       * immediately.
+       *
+       * \sa CancellationToken
+       * @{
+       */
+      virtual void SetCancellationToken( const CancellationToken &token );
+      virtual void RemoveCancellationToken();
+      virtual bool HasCancellationToken() const;
+      /**@}*/
+
+      /** \brief The cancellation token, an exception is thrown if there
+       * is none. */
+      virtual CancellationToken GetCancellationToken() const;
+
     protected:
 
       #ifndef SWIG
@@ -263,6 +451,140 @@ namespace itk {
       // method call by command when it's deleted, maintains internal
       // references between command and process objects.
       virtual void onCommandDelete(const itk::simple::Command *cmd) throw();
+
+      // When this object has been added to a Pipeline, prepare the
+      // output of the ITK filter as a placeholder and return true,
+      // the filter is then updated by the Pipeline. Otherwise the
+      // filter must be updated by the caller. The output must have a
+      // zero starting index to be deferred.
+      template< class TFilterType >
+        bool DeferUpdate( TFilterType *filter )
+      {
+        if ( this->m_Pipeline == SITK_NULLPTR )
+          {
+          return false;
+          }
+
+        filter->SetNumberOfThreads(this->GetNumberOfThreads());
+        filter->UpdateOutputInformation();
+
+        typename TFilterType::OutputImageType *output = filter->GetOutput();
+        const typename TFilterType::OutputImageType::RegionType region = output->GetLargestPossibleRegion();
+        for ( unsigned int i = 0; i < TFilterType::OutputImageType::ImageDimension; ++i )
+          {
+          if ( region.GetIndex()[i] != 0 )
+            {
+            return false;
+            }
+          }
+
+        // The buffer is not allocated, the buffered region only
+        // describes the image for the SimpleITK Image.
+        output->SetBufferedRegion( region );
+
+        this->AddDeferredProcess( filter );
+        return true;
+      }
+
+      // Keep the ITK filter alive until the pipeline is updated
+      void AddDeferredProcess( itk::ProcessObject *p );
+
+      // Create the ITK filter for the execution. When the persistent
+      // ITK filter is enabled, the filter of the previous execution
+      // is returned if it has the same type.
+      template< class TFilterType >
+        typename TFilterType::Pointer CreateITKFilter( )
+      {
+        if ( !this->m_PersistentITKFilter || this->m_Pipeline != SITK_NULLPTR )
+          {
+          return TFilterType::New();
+          }
+
+        typename TFilterType::Pointer filter = dynamic_cast<TFilterType *>( this->GetPersistentProcess() );
+        if ( filter.IsNull() )
+          {
+          filter = TFilterType::New();
+          this->SetPersistentProcess( filter.GetPointer() );
+          }
+        return filter;
+      }
+
+      // Before updating a reused ITK filter, replace its output with
+      // a new data object if the output is still referenced by an
+      // Image returned by a previous execution.
+      template< class TFilterType >
+        static void DisconnectReferencedOutput( TFilterType *filter )
+      {
+        typename TFilterType::OutputImageType::Pointer output = filter->GetOutput();
+        if ( IsOutputReferenced( output.GetPointer() ) )
+          {
+          output->DisconnectPipeline();
+          }
+      }
+
+      // The reference held by the smart pointer of the caller is not
+      // counted. The buffer of an image of vectors may be owned by
+      // the VectorImage of a returned Image.
+      template< class TDataObjectType >
+        static bool IsOutputReferenced( const TDataObjectType *output )
+      {
+        return output->GetReferenceCount() > 2;
+      }
+      template< class TPixelType, unsigned int VImageDimension >
+        static bool IsOutputReferenced( const itk::Image<TPixelType, VImageDimension> *output )
+      {
+        return output->GetReferenceCount() > 2 || !output->GetPixelContainer()->GetContainerManageMemory();
+      }
+
+      // When a destination image is set by ExecuteInto, graft its
+      // buffer onto the output of the ITK filter, so that the output
+      // is computed into it. The output must have the pixel type,
+      // dimension, region and physical space of the destination.
+      // Returns true if the output was grafted.
+      template< class TFilterType >
+        bool GraftDestinationImage( TFilterType *filter )
+      {
+        typedef typename TFilterType::OutputImageType OutputImageType;
+
+        if ( this->m_DestinationImage == SITK_NULLPTR || this->GetNumberOfStreamDivisions() > 1 )
+          {
+          return false;
+          }
+
+        OutputImageType *destination = dynamic_cast<OutputImageType *>( this->m_DestinationImage->GetITKBase() );
+        if ( destination == SITK_NULLPTR )
+          {
+          return false;
+          }
+
+        filter->UpdateOutputInformation();
+        const OutputImageType *output = filter->GetOutput();
+        if ( output->GetLargestPossibleRegion() != destination->GetLargestPossibleRegion()
+             || destination->GetBufferedRegion() != destination->GetLargestPossibleRegion()
+             || output->GetOrigin() != destination->GetOrigin()
+             || output->GetSpacing() != destination->GetSpacing()
+             || output->GetDirection() != destination->GetDirection() )
+          {
+          return false;
+          }
+
+        filter->GraftOutput( destination );
+
+        // The buffer must not be released before the update, and the
+        // output is computed even when the ITK filter is up to date.
+        filter->SetReleaseDataBeforeUpdateFlag( false );
+        filter->Modified();
+        return true;
+      }
+
+      // The image ExecuteInto writes the output into, or null
+      void SetDestinationImage( Image *image ) { this->m_DestinationImage = image; }
+
+      // Access the ITK filter kept by the persistent ITK filter mode
+      itk::ProcessObject *GetPersistentProcess( ) const;
+      void SetPersistentProcess( itk::ProcessObject *p );
+
+      friend class itk::simple::Pipeline;
       #endif
 
 
@@ -348,12 +670,42 @@ namespace itk {
 
       unsigned int m_NumberOfThreads;
 
+      unsigned int m_NumberOfStreamDivisions;
+
+      bool m_PersistentITKFilter;
+
+      // the ITK filter kept between executions, with a reference
+      itk::ProcessObject *m_PersistentProcess;
+
+      Image *m_DestinationImage;
+
+      Pipeline *m_Pipeline;
+
+      // the ITK filter with the observer releasing its threads of the
+      // thread budget, and its tag
+      itk::ProcessObject *m_ThreadBudgetProcess;
+      unsigned long       m_ThreadBudgetTag;
+
+      // the ITK filter with the observer of the instrumentation, and
+      // its tag
+      itk::ProcessObject *m_InstrumentedProcess;
+      unsigned long       m_InstrumentationTag;
+
+      // the token, NULL if none, and the ITK filter with the observer
+      // of the token, and its tag
+      CancellationToken  *m_CancellationToken;
+      itk::ProcessObject *m_CancellationProcess;
+      unsigned long       m_CancellationTag;
+
       std::list<EventCommand> m_Commands;
 
       itk::ProcessObject *m_ActiveProcess;
 
       //
       float m_ProgressMeasurement;
+
+      float  m_ProgressMinimumDelta;
+      double m_ProgressMinimumInterval;
     };
 
 
@@ -168,6 +168,25 @@ public:
   std::vector<double> GetParameters( void ) const;
   /**@}*/
 
+  /** \brief Access the parameters without a std::vector copy
+   *
+   * GetParametersAsDouble returns a pointer to the
+   * GetNumberOfParameters parameters of the ITK transform. For the
+   * BSplineTransform and the DisplacementFieldTransform these are
+   * the coefficients and the displacements themselves, so millions
+   * of parameters are not copied. The pointer is valid until this
+   * transform is modified or destroyed.
+   *
+   * The SetParameters overload reads the parameters from a buffer of
+   * numberOfParameters values, an exception is thrown if it is less
+   * than GetNumberOfParameters.
+   * @{
+   */
+  unsigned int GetNumberOfParameters( void ) const;
+  const double *GetParametersAsDouble( void ) const;
+  void SetParameters ( const double *parameters, size_t numberOfParameters );
+  /**@}*/
+
   /** Set/Get Fixed Transform Parameter
    * @{
    */
@@ -180,8 +199,31 @@ public:
 
   std::vector< double > TransformPoint( const std::vector< double > &point ) const;
 
-  // write
-  void WriteTransform( const std::string &filename ) const;
+  /** \brief Transform many points in one call
+   *
+   * The N points are stored contiguously, with the input dimension
+   * coordinates of each point together, and the transformed points
+   * are returned in the same layout. The points are transformed by
+   * multiple threads, and the results are the same as TransformPoint
+   * for each point. This includes composite transforms. An exception
+   * is thrown if the length is not a multiple of the dimension.
+   */
+  std::vector< double > TransformPoints( const std::vector< double > &points ) const;
+
+  /** \brief Write the transform to a file
+   *
+   * The format is selected by the extension of the file name. The
+   * HDF5 format, with the ".h5" or ".hdf5" extension, stores the
+   * parameters in binary, which should be used for the
+   * DisplacementFieldTransform and the BSplineTransform with many
+   * parameters. With useCompression the HDF5 data sets are
+   * compressed, and with useSinglePrecision the parameters are
+   * stored as 32-bit floats, halving the size of the file. The text
+   * formats ignore useCompression.
+   *
+   * \sa itk::simple::WriteTransform
+   */
+  void WriteTransform( const std::string &filename, bool useCompression = false, bool useSinglePrecision = false ) const;
 
   virtual bool IsLinear() const;
 
@@ -288,7 +330,8 @@ private:
 SITKCommon_EXPORT Transform ReadTransform( const std::string &filename );
 
 // write
-SITKCommon_EXPORT void WriteTransform( const Transform &transform, const std::string &filename);
+SITKCommon_EXPORT void WriteTransform( const Transform &transform, const std::string &filename,
+                                       bool useCompression = false, bool useSinglePrecision = false );
 
 }
 }
@@ -0,0 +1,148 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkCancellationToken.h"
+
+#include "itkProcessObject.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkMutexLockHolder.h"
+
+#include <set>
+#include <sstream>
+
+namespace itk
+{
+namespace simple
+{
+
+// The state shared by the copies of a token, reference counted as
+// an itk::LightObject.
+class CancellationToken::PimpleCancellationToken
+  : public itk::LightObject
+{
+public:
+  typedef PimpleCancellationToken Self;
+  typedef itk::SmartPointer<Self> Pointer;
+
+  itkNewMacro(Self);
+
+  typedef itk::MutexLockHolder<itk::SimpleFastMutexLock> MutexHolderType;
+
+  itk::SimpleFastMutexLock               m_Mutex;
+  bool                                   m_Cancelled;
+  std::set<const itk::ProcessObject *>   m_ActiveProcesses;
+
+protected:
+  PimpleCancellationToken( void ) : m_Cancelled( false ) {}
+
+private:
+  PimpleCancellationToken(const Self &); //purposely not implemented
+  void operator=(const Self &);          //purposely not implemented
+};
+
+
+CancellationToken::CancellationToken( void )
+  : m_Pimple( NULL )
+{
+  PimpleCancellationToken::Pointer pimple = PimpleCancellationToken::New();
+  m_Pimple = pimple.GetPointer();
+  m_Pimple->Register();
+}
+
+
+CancellationToken::CancellationToken( const CancellationToken &token )
+  : m_Pimple( token.m_Pimple )
+{
+  m_Pimple->Register();
+}
+
+
+CancellationToken &CancellationToken::operator=( const CancellationToken &token )
+{
+  token.m_Pimple->Register();
+  m_Pimple->UnRegister();
+  m_Pimple = token.m_Pimple;
+  return *this;
+}
+
+
+CancellationToken::~CancellationToken( void )
+{
+  m_Pimple->UnRegister();
+}
+
+
+void CancellationToken::Cancel( void )
+{
+  PimpleCancellationToken::MutexHolderType lock( m_Pimple->m_Mutex );
+  m_Pimple->m_Cancelled = true;
+
+  // The processes remove themselves before they are deleted, while
+  // the lock is held by them.
+  for ( std::set<const itk::ProcessObject *>::const_iterator i = m_Pimple->m_ActiveProcesses.begin();
+        i != m_Pimple->m_ActiveProcesses.end();
+        ++i )
+    {
+    const_cast<itk::ProcessObject *>( *i )->AbortGenerateDataOn();
+    }
+}
+
+
+bool CancellationToken::IsCancelled( void ) const
+{
+  PimpleCancellationToken::MutexHolderType lock( m_Pimple->m_Mutex );
+  return m_Pimple->m_Cancelled;
+}
+
+
+void CancellationToken::Reset( void )
+{
+  PimpleCancellationToken::MutexHolderType lock( m_Pimple->m_Mutex );
+  m_Pimple->m_Cancelled = false;
+}
+
+
+std::string CancellationToken::ToString( void ) const
+{
+  std::ostringstream out;
+  PimpleCancellationToken::MutexHolderType lock( m_Pimple->m_Mutex );
+  out << "itk::simple::CancellationToken" << std::endl;
+  out << "  Cancelled: " << ( m_Pimple->m_Cancelled ? "true" : "false" ) << std::endl;
+  out << "  ActiveProcesses: " << m_Pimple->m_ActiveProcesses.size() << std::endl;
+  return out.str();
+}
+
+
+void CancellationToken::AddActiveProcess( itk::ProcessObject *p )
+{
+  PimpleCancellationToken::MutexHolderType lock( m_Pimple->m_Mutex );
+  m_Pimple->m_ActiveProcesses.insert( p );
+  if ( m_Pimple->m_Cancelled )
+    {
+    p->AbortGenerateDataOn();
+    }
+}
+
+
+void CancellationToken::RemoveActiveProcess( const itk::ProcessObject *p )
+{
+  PimpleCancellationToken::MutexHolderType lock( m_Pimple->m_Mutex );
+  m_Pimple->m_ActiveProcesses.erase( p );
+}
+
+}
+}
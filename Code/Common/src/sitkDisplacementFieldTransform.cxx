@@ -41,6 +41,8 @@
 #include "itkImage.h"
 #include "itkVectorNearestNeighborInterpolateImageFunction.h"
 
+#include <algorithm>
+
 namespace itk
 {
 namespace simple
@@ -49,6 +51,45 @@ namespace simple
 namespace
 {
 
+// A single precision field is converted to the double precision
+// field of the ITK transform, the displacements are interpolated and
+// composed in double precision.
+template<unsigned int NDimension>
+typename itk::Image<itk::Vector<double,NDimension>,NDimension>::Pointer
+ GetITKImageFromSITKFloatVectorImage(Image &inImage)
+{
+  typedef itk::VectorImage<float,NDimension> VectorImageType;
+
+  if ( inImage.GetNumberOfComponentsPerPixel() != NDimension )
+    {
+    sitkExceptionMacro("Expected input displacement field image to have "
+                       << NDimension << " components not " << inImage.GetNumberOfComponentsPerPixel() << "!" );
+    }
+
+  const VectorImageType *image = dynamic_cast < const VectorImageType* > ( inImage.GetITKBase() );
+
+  if ( image == SITK_NULLPTR )
+    {
+    sitkExceptionMacro( "Unexpected casting error!")
+    }
+
+  typedef typename itk::Image<itk::Vector<double,NDimension>,NDimension> ImageVectorType;
+  typename ImageVectorType::Pointer out = ImageVectorType::New();
+  out->CopyInformation( image );
+  out->SetRegions( image->GetBufferedRegion() );
+  out->Allocate();
+
+  const float *inBuffer = image->GetBufferPointer();
+  double *outBuffer = out->GetBufferPointer()->GetDataPointer();
+  const size_t numberOfValues = image->GetBufferedRegion().GetNumberOfPixels() * NDimension;
+  std::copy( inBuffer, inBuffer + numberOfValues, outBuffer );
+
+  // The input image is consumed as with a double precision field.
+  inImage = Image();
+
+  return out;
+}
+
 template<unsigned int NDimension>
 typename itk::Image<itk::Vector<double,NDimension>,NDimension>::Pointer
  GetITKImageFromSITKVectorImage(Image &inImage)
@@ -61,9 +102,14 @@ typename itk::Image<itk::Vector<double,NDimension>,NDimension>::Pointer
                        << NDimension << " not " << inImage.GetDimension() << "!" );
     }
 
+  if (inImage.GetPixelID() == sitkVectorFloat32)
+    {
+    return GetITKImageFromSITKFloatVectorImage<NDimension>(inImage);
+    }
+
   if (inImage.GetPixelID() != sitkVectorFloat64)
     {
-    sitkExceptionMacro("Expected input displacement field image for be of pixel type: " << sitkVectorFloat64);
+    sitkExceptionMacro("Expected input displacement field image for be of pixel type: " << sitkVectorFloat64 << " or " << sitkVectorFloat32);
     }
 
   typename VectorImageType::Pointer image = dynamic_cast < VectorImageType* > ( inImage.GetITKBase() );
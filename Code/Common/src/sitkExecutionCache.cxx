@@ -0,0 +1,414 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkExecutionCache.h"
+#include "sitkImage.h"
+#include "sitkTemplateFunctions.h"
+
+#include "Ancillary/itkIncrementalHash.h"
+
+#include "itkSimpleFastMutexLock.h"
+#include "itkMutexLockHolder.h"
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <fstream>
+#include <list>
+#include <map>
+#include <sstream>
+
+namespace itk
+{
+namespace simple
+{
+
+namespace
+{
+
+typedef itk::MutexLockHolder<itk::SimpleFastMutexLock> MutexHolderType;
+
+// the first bytes of a spilled file
+const char SpillMagic[8] = { 'S', 'I', 'T', 'K', 'C', 'C', '0', '1' };
+
+struct CacheEntry
+{
+  std::string m_Key;
+  Image       m_Image;
+  uint64_t    m_Bytes;
+};
+
+// The cached images in memory, the most recently used first, and the
+// files of the spilled images.
+struct Cache
+{
+  Cache( void )
+    : m_MaximumMemory( 0 ),
+      m_MemoryUsed( 0 ),
+      m_Hits( 0 ),
+      m_Misses( 0 )
+    {}
+
+  typedef std::list<CacheEntry>                          EntryListType;
+  typedef std::map<std::string, EntryListType::iterator> EntryIndexType;
+
+  itk::SimpleFastMutexLock           m_Mutex;
+  uint64_t                           m_MaximumMemory;
+  uint64_t                           m_MemoryUsed;
+  uint64_t                           m_Hits;
+  uint64_t                           m_Misses;
+  std::string                        m_SpillDirectory;
+  EntryListType                      m_Entries;
+  EntryIndexType                     m_Index;
+  std::map<std::string, std::string> m_SpilledFiles;
+
+  // evict the least recently used images until the images in memory
+  // have no more than maximumBytes, the mutex must be held.
+  void Trim( uint64_t maximumBytes );
+
+  // remove an image from memory, the mutex must be held
+  void Remove( EntryListType::iterator entry );
+
+  // add an image in memory as the most recently used, the mutex must
+  // be held
+  void Add( const std::string &key, const Image &image, uint64_t bytes );
+};
+
+// The cache is intentionally never destroyed, so that the cached
+// images are not destroyed during static destruction.
+Cache &GetCache( void )
+{
+  static Cache *cache = new Cache;
+  return *cache;
+}
+
+
+// The bytes of the pixel buffer of an image, 0 for the label maps.
+uint64_t GetBufferSize( const Image &image )
+{
+  return image.GetNumberOfPixels() * image.GetNumberOfComponentsPerPixel() * GetPixelIDValueComponentSize( image.GetPixelID() );
+}
+
+std::string ToHex( uint64_t value )
+{
+  std::ostringstream os;
+  os.width( 16 );
+  os.fill( '0' );
+  os << std::hex << value;
+  return os.str();
+}
+
+template <typename T>
+void WriteValues( std::ostream &os, const std::vector<T> &values )
+{
+  if ( !values.empty() )
+    {
+    os.write( reinterpret_cast<const char *>( &values[0] ), values.size()*sizeof(T) );
+    }
+}
+
+template <typename T>
+bool ReadValues( std::istream &is, std::vector<T> &values )
+{
+  if ( !values.empty() )
+    {
+    is.read( reinterpret_cast<char *>( &values[0] ), values.size()*sizeof(T) );
+    }
+  return bool( is );
+}
+
+// Write an image to a spill file, in the byte order of this
+// system. Returns false if it failed.
+bool WriteSpillFile( const std::string &fileName, const Image &image )
+{
+  std::ofstream os( fileName.c_str(), std::ios::out | std::ios::binary );
+  if ( !os )
+    {
+    return false;
+    }
+
+  std::vector<int32_t> header( 3 );
+  header[0] = image.GetPixelID();
+  header[1] = image.GetDimension();
+  header[2] = image.GetNumberOfComponentsPerPixel();
+
+  os.write( SpillMagic, sizeof(SpillMagic) );
+  WriteValues( os, header );
+  WriteValues( os, image.GetSize() );
+  WriteValues( os, image.GetOrigin() );
+  WriteValues( os, image.GetSpacing() );
+  WriteValues( os, image.GetDirection() );
+  os.write( static_cast<const char *>( image.GetBufferAsVoid() ), GetBufferSize( image ) );
+  return bool( os );
+}
+
+// Read an image of a spill file. Returns false if it failed.
+bool ReadSpillFile( const std::string &fileName, Image &image )
+{
+  std::ifstream is( fileName.c_str(), std::ios::in | std::ios::binary );
+  char magic[sizeof(SpillMagic)];
+  std::vector<int32_t> header( 3 );
+  if ( !is.read( magic, sizeof(magic) ) ||
+       !std::equal( magic, magic + sizeof(magic), SpillMagic ) ||
+       !ReadValues( is, header ) )
+    {
+    return false;
+    }
+
+  const unsigned int dimension = header[1];
+  std::vector<unsigned int> size( dimension );
+  std::vector<double> origin( dimension );
+  std::vector<double> spacing( dimension );
+  std::vector<double> direction( dimension*dimension );
+  if ( !ReadValues( is, size ) || !ReadValues( is, origin ) ||
+       !ReadValues( is, spacing ) || !ReadValues( is, direction ) )
+    {
+    return false;
+    }
+
+  Image result( size, static_cast<PixelIDValueEnum>( header[0] ), header[2], Image::NoBufferInitialization );
+  result.SetOrigin( origin );
+  result.SetSpacing( spacing );
+  result.SetDirection( direction );
+  if ( !is.read( static_cast<char *>( result.GetBufferAsVoid() ), GetBufferSize( result ) ) )
+    {
+    return false;
+    }
+  image = result;
+  return true;
+}
+
+
+void Cache::Trim( uint64_t maximumBytes )
+{
+  while ( m_MemoryUsed > maximumBytes && !m_Entries.empty() )
+    {
+    EntryListType::iterator entry = --m_Entries.end();
+    if ( !m_SpillDirectory.empty() )
+      {
+      const std::string fileName = m_SpillDirectory + "/" + ToHex( XXHash64::Hash( entry->m_Key.data(), entry->m_Key.size() ) ) + ".sitkcache";
+      if ( WriteSpillFile( fileName, entry->m_Image ) )
+        {
+        m_SpilledFiles[entry->m_Key] = fileName;
+        }
+      else
+        {
+        itksys::SystemTools::RemoveFile( fileName.c_str() );
+        }
+      }
+    this->Remove( entry );
+    }
+}
+
+void Cache::Remove( EntryListType::iterator entry )
+{
+  m_MemoryUsed -= entry->m_Bytes;
+  m_Index.erase( entry->m_Key );
+  m_Entries.erase( entry );
+}
+
+void Cache::Add( const std::string &key, const Image &image, uint64_t bytes )
+{
+  CacheEntry newEntry;
+  newEntry.m_Key = key;
+  newEntry.m_Image = image;
+  newEntry.m_Bytes = bytes;
+  m_Entries.push_front( newEntry );
+  m_Index[key] = m_Entries.begin();
+  m_MemoryUsed += bytes;
+}
+
+}
+
+
+void ExecutionCache::SetMaximumMemory( uint64_t bytes )
+{
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+  cache.m_MaximumMemory = bytes;
+  cache.Trim( bytes );
+}
+
+uint64_t ExecutionCache::GetMaximumMemory()
+{
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+  return cache.m_MaximumMemory;
+}
+
+bool ExecutionCache::IsEnabled()
+{
+  return GetMaximumMemory() != 0;
+}
+
+void ExecutionCache::SetSpillDirectory( const std::string &directory )
+{
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+  cache.m_SpillDirectory = directory;
+}
+
+std::string ExecutionCache::GetSpillDirectory()
+{
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+  return cache.m_SpillDirectory;
+}
+
+void ExecutionCache::Clear()
+{
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+  cache.m_Entries.clear();
+  cache.m_Index.clear();
+  cache.m_MemoryUsed = 0;
+  for ( std::map<std::string, std::string>::const_iterator i = cache.m_SpilledFiles.begin();
+        i != cache.m_SpilledFiles.end();
+        ++i )
+    {
+    itksys::SystemTools::RemoveFile( i->second.c_str() );
+    }
+  cache.m_SpilledFiles.clear();
+  cache.m_Hits = 0;
+  cache.m_Misses = 0;
+}
+
+uint64_t ExecutionCache::GetMemoryUsed()
+{
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+  return cache.m_MemoryUsed;
+}
+
+unsigned int ExecutionCache::GetNumberOfImages()
+{
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+  return static_cast<unsigned int>( cache.m_Entries.size() + cache.m_SpilledFiles.size() );
+}
+
+uint64_t ExecutionCache::GetNumberOfHits()
+{
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+  return cache.m_Hits;
+}
+
+uint64_t ExecutionCache::GetNumberOfMisses()
+{
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+  return cache.m_Misses;
+}
+
+std::string ExecutionCache::MakeKey( const std::string &name,
+                                     const std::string &parameters,
+                                     const std::vector<const Image *> &inputs )
+{
+  std::ostringstream key;
+  key.precision( 17 );
+  key << name << '\n' << parameters << '\n' << inputs.size();
+
+  for ( size_t i = 0; i < inputs.size(); ++i )
+    {
+    const Image &image = *inputs[i];
+    key << '\n' << image.GetPixelIDValue()
+        << ' ' << image.GetNumberOfComponentsPerPixel()
+        << ' ' << image.GetSize()
+        << ' ' << image.GetOrigin()
+        << ' ' << image.GetSpacing()
+        << ' ' << image.GetDirection();
+
+    const uint64_t bytes = GetBufferSize( image );
+    if ( bytes != 0 )
+      {
+      // the blocks of the buffer are hashed in parallel
+      itk::IncrementalHash hash( itk::IncrementalHash::FAST );
+      hash.Update( image.GetBufferAsVoid(), bytes );
+      key << ' ' << hash.Final();
+      }
+    else
+      {
+      // label maps are not hashed, so they never match
+      key << " label map " << static_cast<const void *>( &image );
+      }
+    }
+  return key.str();
+}
+
+bool ExecutionCache::Find( const std::string &key, Image &image )
+{
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+
+  Cache::EntryIndexType::iterator i = cache.m_Index.find( key );
+  if ( i != cache.m_Index.end() )
+    {
+    // move the entry to the front as the most recently used
+    cache.m_Entries.splice( cache.m_Entries.begin(), cache.m_Entries, i->second );
+    image = i->second->m_Image;
+    ++cache.m_Hits;
+    return true;
+    }
+
+  std::map<std::string, std::string>::iterator spilled = cache.m_SpilledFiles.find( key );
+  if ( spilled != cache.m_SpilledFiles.end() )
+    {
+    const std::string fileName = spilled->second;
+    cache.m_SpilledFiles.erase( spilled );
+    Image result;
+    const bool read = ReadSpillFile( fileName, result );
+    itksys::SystemTools::RemoveFile( fileName.c_str() );
+    if ( read )
+      {
+      const uint64_t bytes = GetBufferSize( result );
+      cache.Add( key, result, bytes );
+      cache.Trim( std::max( cache.m_MaximumMemory, bytes ) );
+      image = result;
+      ++cache.m_Hits;
+      return true;
+      }
+    }
+
+  ++cache.m_Misses;
+  return false;
+}
+
+void ExecutionCache::Insert( const std::string &key, const Image &image )
+{
+  const uint64_t bytes = GetBufferSize( image );
+
+  Cache &cache = GetCache();
+  MutexHolderType lock( cache.m_Mutex );
+
+  if ( bytes == 0 || bytes > cache.m_MaximumMemory || cache.m_Index.count( key ) )
+    {
+    return;
+    }
+
+  std::map<std::string, std::string>::iterator spilled = cache.m_SpilledFiles.find( key );
+  if ( spilled != cache.m_SpilledFiles.end() )
+    {
+    itksys::SystemTools::RemoveFile( spilled->second.c_str() );
+    cache.m_SpilledFiles.erase( spilled );
+    }
+
+  cache.Add( key, image, bytes );
+  cache.Trim( cache.m_MaximumMemory );
+}
+
+}
+}
@@ -0,0 +1,301 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkFloat16.h"
+#include "sitkExceptionObject.h"
+
+#include <cstring>
+
+namespace itk
+{
+namespace simple
+{
+
+namespace
+{
+
+// the meta-data entry of the format of an encoded image
+const char Float16FormatKey[] = "SITK_Float16Format";
+const char Float16IEEEName[] = "IEEE754Half";
+const char BFloat16Name[] = "BFloat16";
+
+inline uint32_t FloatToBits( float f )
+{
+  uint32_t bits;
+  std::memcpy( &bits, &f, sizeof( bits ) );
+  return bits;
+}
+
+inline float BitsToFloat( uint32_t bits )
+{
+  float f;
+  std::memcpy( &f, &bits, sizeof( f ) );
+  return f;
+}
+
+// Round to the nearest half, ties to even.
+uint16_t FloatToHalf( float f )
+{
+  const uint32_t bits = FloatToBits( f );
+  const uint16_t sign = static_cast<uint16_t>( ( bits >> 16 ) & 0x8000u );
+  const uint32_t magnitude = bits & 0x7fffffffu;
+
+  if ( magnitude >= 0x7f800000u )
+    {
+    // infinity, or a quiet NaN
+    return sign | 0x7c00u | ( magnitude > 0x7f800000u ? 0x0200u : 0u );
+    }
+  if ( magnitude >= 0x477ff000u )
+    {
+    // 65520 and above round to infinity
+    return sign | 0x7c00u;
+    }
+  if ( magnitude >= 0x38800000u )
+    {
+    // normal, rebias the exponent from 127 to 15 and round the 13
+    // dropped bits, a carry into the exponent is correct
+    const uint32_t odd = ( magnitude >> 13 ) & 1u;
+    return sign | static_cast<uint16_t>( ( magnitude - 0x38000000u + 0xfffu + odd ) >> 13 );
+    }
+  if ( magnitude <= 0x33000000u )
+    {
+    // 2^-25 and below round to zero
+    return sign;
+    }
+
+  // subnormal, in units of 2^-24
+  const uint32_t exponent = magnitude >> 23;
+  const uint32_t mantissa = ( magnitude & 0x7fffffu ) | 0x800000u;
+  const unsigned int shift = 126u - exponent;
+  uint32_t half = mantissa >> shift;
+  const uint32_t remainder = mantissa & ( ( 1u << shift ) - 1u );
+  const uint32_t halfway = 1u << ( shift - 1u );
+  if ( remainder > halfway || ( remainder == halfway && ( half & 1u ) ) )
+    {
+    ++half;
+    }
+  return sign | static_cast<uint16_t>( half );
+}
+
+float HalfToFloat( uint16_t half )
+{
+  const uint32_t sign = static_cast<uint32_t>( half & 0x8000u ) << 16;
+  const uint32_t exponent = ( half >> 10 ) & 0x1fu;
+  const uint32_t mantissa = half & 0x3ffu;
+
+  if ( exponent == 0 )
+    {
+    // zero or subnormal, exact in a float
+    const float magnitude = static_cast<float>( mantissa ) * ( 1.0f / 16777216.0f );
+    return sign ? -magnitude : magnitude;
+    }
+  if ( exponent == 0x1fu )
+    {
+    return BitsToFloat( sign | 0x7f800000u | ( mantissa << 13 ) );
+    }
+  return BitsToFloat( sign | ( ( exponent + 112u ) << 23 ) | ( mantissa << 13 ) );
+}
+
+// Round to the nearest bfloat16, ties to even.
+uint16_t FloatToBFloat16( float f )
+{
+  const uint32_t bits = FloatToBits( f );
+  if ( ( bits & 0x7fffffffu ) > 0x7f800000u )
+    {
+    // a quiet NaN
+    return static_cast<uint16_t>( ( bits >> 16 ) | 0x0040u );
+    }
+  // a carry into the exponent is correct, up to infinity
+  return static_cast<uint16_t>( ( bits + 0x7fffu + ( ( bits >> 16 ) & 1u ) ) >> 16 );
+}
+
+float BFloat16ToFloat( uint16_t bfloat )
+{
+  return BitsToFloat( static_cast<uint32_t>( bfloat ) << 16 );
+}
+
+template <typename TFloat>
+void Encode( const TFloat *input, uint16_t *output, uint64_t n, Float16FormatEnum format )
+{
+  if ( format == sitkBFloat16 )
+    {
+    for ( uint64_t i = 0; i < n; ++i )
+      {
+      output[i] = FloatToBFloat16( static_cast<float>( input[i] ) );
+      }
+    }
+  else
+    {
+    for ( uint64_t i = 0; i < n; ++i )
+      {
+      output[i] = FloatToHalf( static_cast<float>( input[i] ) );
+      }
+    }
+}
+
+template <typename TFloat>
+void Decode( const uint16_t *input, TFloat *output, uint64_t n, Float16FormatEnum format )
+{
+  if ( format == sitkBFloat16 )
+    {
+    for ( uint64_t i = 0; i < n; ++i )
+      {
+      output[i] = static_cast<TFloat>( BFloat16ToFloat( input[i] ) );
+      }
+    }
+  else
+    {
+    for ( uint64_t i = 0; i < n; ++i )
+      {
+      output[i] = static_cast<TFloat>( HalfToFloat( input[i] ) );
+      }
+    }
+}
+
+// Copy the meta-data dictionary, except the format entry.
+void CopyMetaData( const Image &input, Image &output )
+{
+  const std::vector<std::string> keys = input.GetMetaDataKeys();
+  for ( size_t i = 0; i < keys.size(); ++i )
+    {
+    if ( keys[i] != Float16FormatKey )
+      {
+      output.SetMetaData( keys[i], input.GetMetaData( keys[i] ) );
+      }
+    }
+}
+
+bool IsVectorPixelID( PixelIDValueEnum id )
+{
+  return id != sitkUnknown
+    && ( id == sitkVectorFloat32 || id == sitkVectorFloat64 || id == sitkVectorUInt16 );
+}
+
+}
+
+Image EncodeFloat16( const Image &image, Float16FormatEnum format )
+{
+  const PixelIDValueEnum inputType = image.GetPixelID();
+  const bool isVector = IsVectorPixelID( inputType );
+  const PixelIDValueEnum outputType = isVector ? sitkVectorUInt16 : sitkUInt16;
+
+  if ( outputType == sitkUnknown )
+    {
+    sitkExceptionMacro( "EncodeFloat16 requires the " << ( isVector ? "sitkVectorUInt16" : "sitkUInt16" )
+                        << " pixel type to be instantiated." );
+    }
+  if ( format != sitkFloat16IEEE && format != sitkBFloat16 )
+    {
+    sitkExceptionMacro( "Unknown 16 bit float format: " << format );
+    }
+
+  Image result( image.GetSize(), outputType, image.GetNumberOfComponentsPerPixel(), Image::NoBufferInitialization );
+  result.CopyInformation( image );
+  CopyMetaData( image, result );
+  result.SetMetaData( Float16FormatKey, format == sitkBFloat16 ? BFloat16Name : Float16IEEEName );
+
+  const uint64_t n = image.GetNumberOfPixels() * image.GetNumberOfComponentsPerPixel();
+  if ( inputType != sitkUnknown && ( inputType == sitkFloat32 || inputType == sitkVectorFloat32 ) )
+    {
+    Encode( image.GetBufferAsFloat(), result.GetBufferAsUInt16(), n, format );
+    }
+  else if ( inputType != sitkUnknown && ( inputType == sitkFloat64 || inputType == sitkVectorFloat64 ) )
+    {
+    Encode( image.GetBufferAsDouble(), result.GetBufferAsUInt16(), n, format );
+    }
+  else
+    {
+    sitkExceptionMacro( "EncodeFloat16 expects an image of 32 or 64 bit floats, not "
+                        << GetPixelIDValueAsString( inputType ) << "." );
+    }
+
+  return result;
+}
+
+Image DecodeFloat16( const Image &image, PixelIDValueEnum outputPixelType )
+{
+  if ( !IsFloat16Encoded( image ) )
+    {
+    sitkExceptionMacro( "The image does not have the " << Float16FormatKey
+                        << " meta-data entry of an image encoded by EncodeFloat16." );
+    }
+  const Float16FormatEnum format =
+    image.GetMetaData( Float16FormatKey ) == BFloat16Name ? sitkBFloat16 : sitkFloat16IEEE;
+
+  const bool isVector = IsVectorPixelID( image.GetPixelID() );
+  bool isDouble = false;
+  if ( outputPixelType != sitkUnknown
+       && ( outputPixelType == sitkFloat64 || outputPixelType == sitkVectorFloat64 ) )
+    {
+    isDouble = true;
+    }
+  else if ( outputPixelType == sitkUnknown
+            || ( outputPixelType != sitkFloat32 && outputPixelType != sitkVectorFloat32 ) )
+    {
+    sitkExceptionMacro( "DecodeFloat16 decodes to 32 or 64 bit floats, not "
+                        << GetPixelIDValueAsString( outputPixelType ) << "." );
+    }
+
+  PixelIDValueEnum outputType;
+  if ( isVector )
+    {
+    outputType = isDouble ? sitkVectorFloat64 : sitkVectorFloat32;
+    }
+  else
+    {
+    outputType = isDouble ? sitkFloat64 : sitkFloat32;
+    }
+  if ( outputType == sitkUnknown )
+    {
+    sitkExceptionMacro( "DecodeFloat16 requires the " << GetPixelIDValueAsString( outputPixelType )
+                        << " pixel type to be instantiated." );
+    }
+
+  Image result( image.GetSize(), outputType, image.GetNumberOfComponentsPerPixel(), Image::NoBufferInitialization );
+  result.CopyInformation( image );
+  CopyMetaData( image, result );
+
+  const uint64_t n = image.GetNumberOfPixels() * image.GetNumberOfComponentsPerPixel();
+  if ( isDouble )
+    {
+    Decode( image.GetBufferAsUInt16(), result.GetBufferAsDouble(), n, format );
+    }
+  else
+    {
+    Decode( image.GetBufferAsUInt16(), result.GetBufferAsFloat(), n, format );
+    }
+
+  return result;
+}
+
+bool IsFloat16Encoded( const Image &image )
+{
+  const PixelIDValueEnum id = image.GetPixelID();
+  if ( id == sitkUnknown || ( id != sitkUInt16 && id != sitkVectorUInt16 ) )
+    {
+    return false;
+    }
+  if ( !image.HasMetaDataKey( Float16FormatKey ) )
+    {
+    return false;
+    }
+  const std::string format = image.GetMetaData( Float16FormatKey );
+  return format == Float16IEEEName || format == BFloat16Name;
+}
+
+}
+}
@@ -19,9 +19,13 @@
 
 #include "itkMetaDataObject.h"
 #include "itkDataObject.h"
+#include "itkAtomicInt.h"
+#include "itkOutputWindow.h"
+#include "itkMultiThreader.h"
 
 #include "sitkExceptionObject.h"
 #include "sitkPimpleImageBase.h"
+#include "sitkImageBufferAllocator.h"
 #include "sitkPixelIDTypeLists.h"
 
 
@@ -30,6 +34,91 @@ namespace itk
   namespace simple
   {
 
+  namespace
+  {
+  // process wide copy-on-write statistics
+  static itk::AtomicInt<uint64_t> GlobalNumberOfDeepCopies( 0 );
+  static itk::AtomicInt<uint64_t> GlobalDeepCopyBytes( 0 );
+  static itk::AtomicInt<uint64_t> GlobalDeepCopyWarningThreshold( 0 );
+
+  // Verify the region described by index and size is inside an image
+  // of imageSize.
+  void CheckRegion( const std::vector<unsigned int> &imageSize,
+                    const std::vector<uint32_t> &index,
+                    const std::vector<uint32_t> &size )
+  {
+    if ( index.size() < imageSize.size() || size.size() < imageSize.size() )
+      {
+      sitkExceptionMacro( "The region index and size must be of length " << imageSize.size() << "!" )
+      }
+
+    for ( unsigned int d = 0; d < imageSize.size(); ++d )
+      {
+      if ( uint64_t(index[d]) + size[d] > imageSize[d] )
+        {
+        sitkExceptionMacro( "The region with index " << index << " and size " << size
+                            << " is not inside the image of size " << imageSize << "!" );
+        }
+      }
+  }
+
+  // Copy a region between an image buffer and a contiguous buffer one
+  // scanline at a time. When toImage is true, the contiguous buffer is
+  // the source, otherwise the image buffer is the source.
+  template <typename T>
+  void CopyRegion( T *imageBuffer,
+                   T *buffer,
+                   const std::vector<unsigned int> &imageSize,
+                   unsigned int numberOfComponents,
+                   const std::vector<uint32_t> &index,
+                   const std::vector<uint32_t> &size,
+                   bool toImage )
+  {
+    const unsigned int dimension = imageSize.size();
+
+    uint64_t numberOfLines = 1;
+    for ( unsigned int d = 1; d < dimension; ++d )
+      {
+      numberOfLines *= size[d];
+      }
+    const size_t lineLength = size_t(size[0]) * numberOfComponents;
+    if ( lineLength == 0 || numberOfLines == 0 )
+      {
+      return;
+      }
+
+    std::vector<uint32_t> lineIndex( index.begin(), index.begin()+dimension );
+    for ( uint64_t l = 0; l < numberOfLines; ++l )
+      {
+      uint64_t offset = 0;
+      for ( unsigned int d = dimension; d > 0; --d )
+        {
+        offset = offset * imageSize[d-1] + lineIndex[d-1];
+        }
+      T *imageLine = imageBuffer + offset * numberOfComponents;
+      if ( toImage )
+        {
+        std::copy( buffer, buffer + lineLength, imageLine );
+        }
+      else
+        {
+        std::copy( imageLine, imageLine + lineLength, buffer );
+        }
+      buffer += lineLength;
+
+      // advance to the next scanline
+      for ( unsigned int d = 1; d < dimension; ++d )
+        {
+        if ( ++lineIndex[d] < index[d] + size[d] )
+          {
+          break;
+          }
+        lineIndex[d] = index[d];
+        }
+      }
+  }
+  }
+
   Image::~Image( )
   {
     delete this->m_PimpleImage;
@@ -42,6 +131,12 @@ namespace itk
     Allocate ( 0, 0, 0, 0, sitkUInt8, 1 );
   }
 
+  Image::Image( PimpleImageBase *pimpleImage )
+    : m_PimpleImage( pimpleImage )
+  {
+    assert( m_PimpleImage );
+  }
+
   Image::Image( const Image &img )
   {
     this->m_PimpleImage = img.m_PimpleImage->ShallowCopy();
@@ -57,6 +152,30 @@ namespace itk
     return *this;
   }
 
+#if defined(SITK_HAS_CXX11_RVREF)
+  Image::Image( Image &&img ) SITK_NOEXCEPT
+    : m_PimpleImage( img.m_PimpleImage )
+  {
+    img.m_PimpleImage = NULL;
+  }
+
+  Image& Image::operator=( Image &&img ) SITK_NOEXCEPT
+  {
+    if ( this != &img )
+      {
+      delete this->m_PimpleImage;
+      this->m_PimpleImage = img.m_PimpleImage;
+      img.m_PimpleImage = NULL;
+      }
+    return *this;
+  }
+#endif
+
+  void Image::Swap( Image &img ) SITK_NOEXCEPT
+  {
+    std::swap( this->m_PimpleImage, img.m_PimpleImage );
+  }
+
     Image::Image( unsigned int Width, unsigned int Height, PixelIDValueEnum ValueEnum )
       : m_PimpleImage( NULL )
     {
@@ -90,6 +209,28 @@ namespace itk
         }
     }
 
+    Image::Image( const std::vector< unsigned int > &size, PixelIDValueEnum ValueEnum, unsigned int numberOfComponents,
+                  BufferInitializationType initialization )
+      : m_PimpleImage( NULL )
+    {
+      if ( size.size() == 2 )
+        {
+        Allocate ( size[0], size[1], 0, 0, ValueEnum, numberOfComponents, initialization );
+        }
+      else if ( size.size() == 3 )
+        {
+        Allocate ( size[0], size[1], size[2], 0, ValueEnum, numberOfComponents, initialization );
+        }
+      else if ( size.size() == 4 )
+        {
+        Allocate ( size[0], size[1], size[2], size[3], ValueEnum, numberOfComponents, initialization );
+        }
+      else
+        {
+        sitkExceptionMacro("Unsupported number of dimesions specified!");
+        }
+    }
+
     itk::DataObject* Image::GetITKBase( void )
     {
       assert( m_PimpleImage );
@@ -132,6 +273,38 @@ namespace itk
       return this->m_PimpleImage->GetNumberOfPixels();
     }
 
+    uint64_t Image::GetSizeInBytes( void ) const
+    {
+      assert( m_PimpleImage );
+      return this->m_PimpleImage->GetSizeOfBuffer();
+    }
+
+    bool Image::IsBufferShared( void ) const
+    {
+      assert( m_PimpleImage );
+      return this->m_PimpleImage->GetReferenceCountOfImage() > 1
+        || this->m_PimpleImage->GetReferenceCountOfBuffer() > 1;
+    }
+
+    unsigned int Image::GetBufferAlignment( void ) const
+    {
+      assert( m_PimpleImage );
+      const void *buffer = this->m_PimpleImage->GetBufferPointer();
+      if ( buffer == SITK_NULLPTR )
+        {
+        return 0;
+        }
+
+      const size_t maximumAlignment = 4096;
+      const size_t address = reinterpret_cast<size_t>( buffer );
+      size_t alignment = 1;
+      while ( alignment < maximumAlignment && ( address & alignment ) == 0 )
+        {
+        alignment <<= 1;
+        }
+      return static_cast<unsigned int>( alignment );
+    }
+
     std::string Image::GetPixelIDTypeAsString( void ) const
     {
       return std::string( GetPixelIDValueAsString( this->GetPixelIDValue() ) );
@@ -178,7 +351,7 @@ namespace itk
     void Image::SetOrigin( const std::vector<double> &orgn )
     {
        assert( m_PimpleImage );
-      this->MakeUnique();
+      this->MakeUniqueInformation();
       this->m_PimpleImage->SetOrigin(orgn);
     }
 
@@ -193,7 +366,7 @@ namespace itk
     void Image::SetSpacing( const std::vector<double> &spc )
     {
       assert( m_PimpleImage );
-      this->MakeUnique();
+      this->MakeUniqueInformation();
       this->m_PimpleImage->SetSpacing(spc);
     }
 
@@ -208,7 +381,7 @@ namespace itk
     void Image::SetDirection( const std::vector< double > &direction )
     {
       assert( m_PimpleImage );
-      this->MakeUnique();
+      this->MakeUniqueInformation();
       this->m_PimpleImage->SetDirection( direction );
     }
 
@@ -265,7 +438,7 @@ namespace itk
     void Image::SetMetaData( const std::string &key, const std::string &value)
     {
       assert( m_PimpleImage );
-      this->MakeUnique();
+      this->MakeUniqueInformation();
       itk::MetaDataDictionary &mdd = this->m_PimpleImage->GetDataBase()->GetMetaDataDictionary();
       itk::EncapsulateMetaData<std::string>(mdd, key, value);
     }
@@ -273,8 +446,12 @@ namespace itk
     bool Image::EraseMetaData( const std::string &key )
     {
       assert( m_PimpleImage );
+      if ( !this->HasMetaDataKey( key ) )
+        {
+        return false;
+        }
+      this->MakeUniqueInformation();
       itk::MetaDataDictionary &mdd = this->m_PimpleImage->GetDataBase()->GetMetaDataDictionary();
-      this->MakeUnique();
       return mdd.Erase(key);
     }
 
@@ -305,6 +482,30 @@ namespace itk
       return this->m_PimpleImage->TransformContinuousIndexToPhysicalPoint( idx );
     }
 
+    std::vector< int64_t > Image::TransformPhysicalPointsToIndices( const std::vector< double > &points ) const
+    {
+      assert( m_PimpleImage );
+      return this->m_PimpleImage->TransformPhysicalPointsToIndices( points, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+    }
+
+    std::vector< double > Image::TransformIndicesToPhysicalPoints( const std::vector< int64_t > &indices ) const
+    {
+      assert( m_PimpleImage );
+      return this->m_PimpleImage->TransformIndicesToPhysicalPoints( indices, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+    }
+
+    std::vector< double > Image::TransformPhysicalPointsToContinuousIndices( const std::vector< double > &points ) const
+    {
+      assert( m_PimpleImage );
+      return this->m_PimpleImage->TransformPhysicalPointsToContinuousIndices( points, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+    }
+
+    std::vector< double > Image::TransformContinuousIndicesToPhysicalPoints( const std::vector< double > &indices ) const
+    {
+      assert( m_PimpleImage );
+      return this->m_PimpleImage->TransformContinuousIndicesToPhysicalPoints( indices, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+    }
+
     int8_t Image::GetPixelAsInt8( const std::vector<uint32_t> &idx) const
     {
       assert( m_PimpleImage );
@@ -567,6 +768,214 @@ namespace itk
       return this->m_PimpleImage->GetBufferAsDouble( );
     }
 
+    void *Image::GetBufferAsVoid( )
+    {
+      assert( m_PimpleImage );
+      this->MakeUnique();
+      return const_cast<void *>( static_cast<const Image *>(this)->GetBufferAsVoid( ) );
+    }
+
+    const void *Image::GetBufferAsVoid( ) const
+    {
+      assert( m_PimpleImage );
+      const void *buffer = this->m_PimpleImage->GetBufferPointer();
+      if ( buffer == SITK_NULLPTR )
+        {
+        sitkExceptionMacro( "The image of pixel type " << this->GetPixelIDTypeAsString() << " does not have a pixel buffer!" );
+        }
+      return buffer;
+    }
+
+    void Image::GetRegionAsInt8( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, int8_t *buffer ) const
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      int8_t *imageBuffer = const_cast<int8_t *>( static_cast<const PimpleImageBase *>(this->m_PimpleImage)->GetBufferAsInt8( ) );
+      CopyRegion( imageBuffer, buffer, imageSize, this->GetNumberOfComponentsPerPixel(), index, size, false );
+    }
+
+    void Image::GetRegionAsUInt8( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, uint8_t *buffer ) const
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      uint8_t *imageBuffer = const_cast<uint8_t *>( static_cast<const PimpleImageBase *>(this->m_PimpleImage)->GetBufferAsUInt8( ) );
+      CopyRegion( imageBuffer, buffer, imageSize, this->GetNumberOfComponentsPerPixel(), index, size, false );
+    }
+
+    void Image::GetRegionAsInt16( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, int16_t *buffer ) const
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      int16_t *imageBuffer = const_cast<int16_t *>( static_cast<const PimpleImageBase *>(this->m_PimpleImage)->GetBufferAsInt16( ) );
+      CopyRegion( imageBuffer, buffer, imageSize, this->GetNumberOfComponentsPerPixel(), index, size, false );
+    }
+
+    void Image::GetRegionAsUInt16( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, uint16_t *buffer ) const
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      uint16_t *imageBuffer = const_cast<uint16_t *>( static_cast<const PimpleImageBase *>(this->m_PimpleImage)->GetBufferAsUInt16( ) );
+      CopyRegion( imageBuffer, buffer, imageSize, this->GetNumberOfComponentsPerPixel(), index, size, false );
+    }
+
+    void Image::GetRegionAsInt32( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, int32_t *buffer ) const
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      int32_t *imageBuffer = const_cast<int32_t *>( static_cast<const PimpleImageBase *>(this->m_PimpleImage)->GetBufferAsInt32( ) );
+      CopyRegion( imageBuffer, buffer, imageSize, this->GetNumberOfComponentsPerPixel(), index, size, false );
+    }
+
+    void Image::GetRegionAsUInt32( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, uint32_t *buffer ) const
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      uint32_t *imageBuffer = const_cast<uint32_t *>( static_cast<const PimpleImageBase *>(this->m_PimpleImage)->GetBufferAsUInt32( ) );
+      CopyRegion( imageBuffer, buffer, imageSize, this->GetNumberOfComponentsPerPixel(), index, size, false );
+    }
+
+    void Image::GetRegionAsInt64( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, int64_t *buffer ) const
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      int64_t *imageBuffer = const_cast<int64_t *>( static_cast<const PimpleImageBase *>(this->m_PimpleImage)->GetBufferAsInt64( ) );
+      CopyRegion( imageBuffer, buffer, imageSize, this->GetNumberOfComponentsPerPixel(), index, size, false );
+    }
+
+    void Image::GetRegionAsUInt64( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, uint64_t *buffer ) const
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      uint64_t *imageBuffer = const_cast<uint64_t *>( static_cast<const PimpleImageBase *>(this->m_PimpleImage)->GetBufferAsUInt64( ) );
+      CopyRegion( imageBuffer, buffer, imageSize, this->GetNumberOfComponentsPerPixel(), index, size, false );
+    }
+
+    void Image::GetRegionAsFloat( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, float *buffer ) const
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      float *imageBuffer = const_cast<float *>( static_cast<const PimpleImageBase *>(this->m_PimpleImage)->GetBufferAsFloat( ) );
+      CopyRegion( imageBuffer, buffer, imageSize, this->GetNumberOfComponentsPerPixel(), index, size, false );
+    }
+
+    void Image::GetRegionAsDouble( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, double *buffer ) const
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      double *imageBuffer = const_cast<double *>( static_cast<const PimpleImageBase *>(this->m_PimpleImage)->GetBufferAsDouble( ) );
+      CopyRegion( imageBuffer, buffer, imageSize, this->GetNumberOfComponentsPerPixel(), index, size, false );
+    }
+
+    void Image::SetRegionFromInt8( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const int8_t *buffer )
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      this->MakeUnique();
+      int8_t *imageBuffer = this->m_PimpleImage->GetBufferAsInt8( );
+      CopyRegion( imageBuffer, const_cast<int8_t *>( buffer ), imageSize, this->GetNumberOfComponentsPerPixel(), index, size, true );
+    }
+
+    void Image::SetRegionFromUInt8( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const uint8_t *buffer )
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      this->MakeUnique();
+      uint8_t *imageBuffer = this->m_PimpleImage->GetBufferAsUInt8( );
+      CopyRegion( imageBuffer, const_cast<uint8_t *>( buffer ), imageSize, this->GetNumberOfComponentsPerPixel(), index, size, true );
+    }
+
+    void Image::SetRegionFromInt16( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const int16_t *buffer )
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      this->MakeUnique();
+      int16_t *imageBuffer = this->m_PimpleImage->GetBufferAsInt16( );
+      CopyRegion( imageBuffer, const_cast<int16_t *>( buffer ), imageSize, this->GetNumberOfComponentsPerPixel(), index, size, true );
+    }
+
+    void Image::SetRegionFromUInt16( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const uint16_t *buffer )
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      this->MakeUnique();
+      uint16_t *imageBuffer = this->m_PimpleImage->GetBufferAsUInt16( );
+      CopyRegion( imageBuffer, const_cast<uint16_t *>( buffer ), imageSize, this->GetNumberOfComponentsPerPixel(), index, size, true );
+    }
+
+    void Image::SetRegionFromInt32( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const int32_t *buffer )
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      this->MakeUnique();
+      int32_t *imageBuffer = this->m_PimpleImage->GetBufferAsInt32( );
+      CopyRegion( imageBuffer, const_cast<int32_t *>( buffer ), imageSize, this->GetNumberOfComponentsPerPixel(), index, size, true );
+    }
+
+    void Image::SetRegionFromUInt32( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const uint32_t *buffer )
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      this->MakeUnique();
+      uint32_t *imageBuffer = this->m_PimpleImage->GetBufferAsUInt32( );
+      CopyRegion( imageBuffer, const_cast<uint32_t *>( buffer ), imageSize, this->GetNumberOfComponentsPerPixel(), index, size, true );
+    }
+
+    void Image::SetRegionFromInt64( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const int64_t *buffer )
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      this->MakeUnique();
+      int64_t *imageBuffer = this->m_PimpleImage->GetBufferAsInt64( );
+      CopyRegion( imageBuffer, const_cast<int64_t *>( buffer ), imageSize, this->GetNumberOfComponentsPerPixel(), index, size, true );
+    }
+
+    void Image::SetRegionFromUInt64( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const uint64_t *buffer )
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      this->MakeUnique();
+      uint64_t *imageBuffer = this->m_PimpleImage->GetBufferAsUInt64( );
+      CopyRegion( imageBuffer, const_cast<uint64_t *>( buffer ), imageSize, this->GetNumberOfComponentsPerPixel(), index, size, true );
+    }
+
+    void Image::SetRegionFromFloat( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const float *buffer )
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      this->MakeUnique();
+      float *imageBuffer = this->m_PimpleImage->GetBufferAsFloat( );
+      CopyRegion( imageBuffer, const_cast<float *>( buffer ), imageSize, this->GetNumberOfComponentsPerPixel(), index, size, true );
+    }
+
+    void Image::SetRegionFromDouble( const std::vector<uint32_t> &index, const std::vector<uint32_t> &size, const double *buffer )
+    {
+      assert( m_PimpleImage );
+      const std::vector<unsigned int> imageSize = this->GetSize();
+      CheckRegion( imageSize, index, size );
+      this->MakeUnique();
+      double *imageBuffer = this->m_PimpleImage->GetBufferAsDouble( );
+      CopyRegion( imageBuffer, const_cast<double *>( buffer ), imageSize, this->GetNumberOfComponentsPerPixel(), index, size, true );
+    }
+
     void Image::SetPixelAsInt8( const std::vector<uint32_t> &idx, int8_t v )
     {
       assert( m_PimpleImage );
@@ -724,14 +1133,106 @@ namespace itk
 
     void Image::MakeUnique( void )
     {
-      if ( this->m_PimpleImage->GetReferenceCountOfImage() > 1 )
+      // the buffer may also be shared with images which only have
+      // their own meta-data, see MakeUniqueInformation
+      if ( this->m_PimpleImage->GetReferenceCountOfImage() > 1
+           || this->m_PimpleImage->GetReferenceCountOfBuffer() > 1 )
         {
         // note: care is take here to be exception safe with memory allocation
         nsstd::auto_ptr<PimpleImageBase> temp( this->m_PimpleImage->DeepCopy() );
         delete this->m_PimpleImage;
         this->m_PimpleImage = temp.release();
+
+        const uint64_t bytes = this->m_PimpleImage->GetSizeOfBuffer();
+        ++GlobalNumberOfDeepCopies;
+        GlobalDeepCopyBytes += bytes;
+
+        const uint64_t threshold = GlobalDeepCopyWarningThreshold;
+        if ( threshold != 0
+             && bytes >= threshold
+             && itk::Object::GetGlobalWarningDisplay() )
+          {
+          std::ostringstream msg;
+          msg << "WARNING: SimpleITK Image copy on write performed a deep copy of "
+              << bytes << " bytes for a " << this->GetPixelIDTypeAsString()
+              << " image of size " << this->GetSize() << ".\n";
+          itk::OutputWindowDisplayWarningText( msg.str().c_str() );
+          }
+        }
+
+    }
+
+    void Image::MakeUniqueInformation( void )
+    {
+      if ( this->m_PimpleImage->GetReferenceCountOfImage() > 1 )
+        {
+        nsstd::auto_ptr<PimpleImageBase> temp( this->m_PimpleImage->ShallowCopyInformation() );
+        delete this->m_PimpleImage;
+        this->m_PimpleImage = temp.release();
         }
+    }
 
+    uint64_t Image::GetGlobalNumberOfDeepCopies( void )
+    {
+      return GlobalNumberOfDeepCopies;
+    }
+
+    uint64_t Image::GetGlobalDeepCopyBytes( void )
+    {
+      return GlobalDeepCopyBytes;
+    }
+
+    void Image::ResetGlobalDeepCopyStatistics( void )
+    {
+      GlobalNumberOfDeepCopies = 0;
+      GlobalDeepCopyBytes = 0;
+    }
+
+    void Image::SetGlobalDeepCopyWarningThreshold( uint64_t bytes )
+    {
+      GlobalDeepCopyWarningThreshold = bytes;
+    }
+
+    uint64_t Image::GetGlobalDeepCopyWarningThreshold( void )
+    {
+      return GlobalDeepCopyWarningThreshold;
+    }
+
+    void Image::SetGlobalBufferAllocator( BufferAllocatorFunctionType allocator,
+                                          BufferDeallocatorFunctionType deallocator,
+                                          void *clientData )
+    {
+      ImageBufferAllocator::SetAllocator( allocator, deallocator, clientData );
+    }
+
+    void Image::SetGlobalBufferPool( bool enabled )
+    {
+      ImageBufferAllocator::SetPoolEnabled( enabled );
+    }
+
+    bool Image::GetGlobalBufferPool( void )
+    {
+      return ImageBufferAllocator::GetPoolEnabled();
+    }
+
+    void Image::SetGlobalBufferPoolMaximumBytes( uint64_t bytes )
+    {
+      ImageBufferAllocator::SetPoolMaximumBytes( bytes );
+    }
+
+    uint64_t Image::GetGlobalBufferPoolMaximumBytes( void )
+    {
+      return ImageBufferAllocator::GetPoolMaximumBytes();
+    }
+
+    uint64_t Image::GetGlobalBufferPoolBytes( void )
+    {
+      return ImageBufferAllocator::GetPoolBytes();
+    }
+
+    void Image::ReleaseGlobalBufferPool( void )
+    {
+      ImageBufferAllocator::ReleasePool();
     }
   } // end namespace simple
 } // end namespace itk
@@ -27,6 +27,7 @@
 
 #include "sitkExceptionObject.h"
 #include "sitkPimpleImageBase.hxx"
+#include "sitkImageBufferAllocator.h"
 #include "sitkPixelIDTypeLists.h"
 
 
@@ -72,7 +73,7 @@ namespace itk
 
   template<class TImageType>
   typename EnableIf<IsBasic<TImageType>::Value>::Type
-  Image::AllocateInternal ( unsigned int Width, unsigned int Height, unsigned int Depth, unsigned int dim4, unsigned int numberOfComponents )
+  Image::AllocateInternal ( unsigned int Width, unsigned int Height, unsigned int Depth, unsigned int dim4, unsigned int numberOfComponents, BufferInitializationType initialization )
   {
     if ( numberOfComponents != 1  && numberOfComponents != 0 )
       {
@@ -106,8 +107,11 @@ namespace itk
 
     typename TImageType::Pointer image = TImageType::New();
     image->SetRegions ( region );
-    image->Allocate();
-    image->FillBuffer ( itk::NumericTraits<typename TImageType::PixelType>::Zero );
+    AllocateImageBuffer( image.GetPointer() );
+    if ( initialization == ZeroBufferInitialization )
+      {
+      ZeroFillImageBuffer( image.GetPointer() );
+      }
 
     delete this->m_PimpleImage;
     this->m_PimpleImage = NULL;
@@ -116,7 +120,7 @@ namespace itk
 
   template<class TImageType>
   typename EnableIf<IsVector<TImageType>::Value>::Type
-  Image::AllocateInternal ( unsigned int Width, unsigned int Height, unsigned int Depth, unsigned int dim4, unsigned int numberOfComponents )
+  Image::AllocateInternal ( unsigned int Width, unsigned int Height, unsigned int Depth, unsigned int dim4, unsigned int numberOfComponents, BufferInitializationType initialization )
   {
     if ( numberOfComponents == 0 )
       {
@@ -126,7 +130,6 @@ namespace itk
     typename TImageType::IndexType  index;
     typename TImageType::SizeType   size;
     typename TImageType::RegionType region;
-    typename TImageType::PixelType  zero;
 
     index.Fill ( 0 );
     size.Fill(1);
@@ -148,14 +151,14 @@ namespace itk
     region.SetSize ( size );
     region.SetIndex ( index );
 
-    zero.SetSize( numberOfComponents );
-    zero.Fill ( itk::NumericTraits<typename TImageType::PixelType::ValueType>::Zero );
-
     typename TImageType::Pointer image = TImageType::New();
     image->SetRegions ( region );
     image->SetVectorLength( numberOfComponents );
-    image->Allocate();
-    image->FillBuffer ( zero );
+    AllocateImageBuffer( image.GetPointer() );
+    if ( initialization == ZeroBufferInitialization )
+      {
+      ZeroFillImageBuffer( image.GetPointer() );
+      }
 
     delete this->m_PimpleImage;
     this->m_PimpleImage = NULL;
@@ -165,7 +168,7 @@ namespace itk
 
   template<class TImageType>
   typename EnableIf<IsLabel<TImageType>::Value>::Type
-  Image::AllocateInternal ( unsigned int Width, unsigned int Height, unsigned int Depth, unsigned int dim4, unsigned int numberOfComponents )
+  Image::AllocateInternal ( unsigned int Width, unsigned int Height, unsigned int Depth, unsigned int dim4, unsigned int numberOfComponents, BufferInitializationType )
   {
     if ( numberOfComponents != 1 && numberOfComponents != 0 )
       {
@@ -0,0 +1,234 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkImageBufferAllocator.h"
+#include "sitkExceptionObject.h"
+
+#include "itkSimpleFastMutexLock.h"
+#include "itkMutexLockHolder.h"
+
+#include <map>
+#include <new>
+#include <cstdlib>
+
+namespace itk
+{
+namespace simple
+{
+
+namespace
+{
+
+typedef itk::MutexLockHolder<itk::SimpleFastMutexLock> MutexHolderType;
+
+// The pool of released buffers, available to be reused for
+// allocations of exactly the same size.
+struct BufferPool
+{
+  BufferPool( void )
+    : m_Enabled( false ),
+      m_MaximumBytes( uint64_t(1) << 30 ),
+      m_Bytes( 0 ),
+      m_Allocator( NULL ),
+      m_Deallocator( NULL ),
+      m_AllocatorClientData( NULL )
+    {}
+
+  itk::SimpleFastMutexLock         m_Mutex;
+  bool                             m_Enabled;
+  uint64_t                         m_MaximumBytes;
+  uint64_t                         m_Bytes;
+  std::multimap<size_t, void *>    m_Buffers;
+
+  ImageBufferAllocator::AllocatorFunctionType   m_Allocator;
+  ImageBufferAllocator::DeallocatorFunctionType m_Deallocator;
+  void                                        * m_AllocatorClientData;
+
+  // release buffers until the pool has no more than maximumBytes,
+  // the mutex must be held.
+  void Trim( uint64_t maximumBytes )
+    {
+      while ( m_Bytes > maximumBytes && !m_Buffers.empty() )
+        {
+        std::multimap<size_t, void *>::iterator i = m_Buffers.begin();
+        std::free( i->second );
+        m_Bytes -= i->first;
+        m_Buffers.erase( i );
+        }
+    }
+};
+
+// The pool is intentionally never destroyed, so that images
+// destroyed during static destruction may still release their
+// buffer.
+BufferPool &GetPool( void )
+{
+  static BufferPool *pool = new BufferPool;
+  return *pool;
+}
+
+void PoolDeallocate( void *buffer, size_t numberOfBytes, void * )
+{
+  BufferPool &pool = GetPool();
+  MutexHolderType lock( pool.m_Mutex );
+
+  if ( pool.m_Enabled && pool.m_Bytes + numberOfBytes <= pool.m_MaximumBytes )
+    {
+    pool.m_Buffers.insert( std::make_pair( numberOfBytes, buffer ) );
+    pool.m_Bytes += numberOfBytes;
+    }
+  else
+    {
+    std::free( buffer );
+    }
+}
+
+}
+
+
+bool ImageBufferAllocator::IsEnabled( void )
+{
+  BufferPool &pool = GetPool();
+  MutexHolderType lock( pool.m_Mutex );
+  return pool.m_Allocator != NULL || pool.m_Enabled;
+}
+
+
+void *ImageBufferAllocator::Allocate( size_t numberOfBytes,
+                                      DeallocatorFunctionType &deallocator,
+                                      void * &clientData )
+{
+  BufferPool &pool = GetPool();
+  AllocatorFunctionType allocator = NULL;
+
+  {
+  MutexHolderType lock( pool.m_Mutex );
+
+  if ( pool.m_Allocator )
+    {
+    allocator = pool.m_Allocator;
+    deallocator = pool.m_Deallocator;
+    clientData = pool.m_AllocatorClientData;
+    }
+  else
+    {
+    deallocator = PoolDeallocate;
+    clientData = NULL;
+
+    std::multimap<size_t, void *>::iterator i = pool.m_Buffers.find( numberOfBytes );
+    if ( i != pool.m_Buffers.end() )
+      {
+      void *buffer = i->second;
+      pool.m_Bytes -= i->first;
+      pool.m_Buffers.erase( i );
+      return buffer;
+      }
+    }
+  }
+
+  // the user allocator is called without holding the lock
+  if ( allocator )
+    {
+    void *buffer = allocator( numberOfBytes, clientData );
+    if ( buffer == NULL && numberOfBytes != 0 )
+      {
+      sitkExceptionMacro( "The image buffer allocator failed to allocate " << numberOfBytes << " bytes!" );
+      }
+    return buffer;
+    }
+
+  // malloc'ed memory is suitably aligned for all pixel types
+  void *buffer = std::malloc( numberOfBytes != 0 ? numberOfBytes : 1 );
+  if ( buffer == NULL )
+    {
+    throw std::bad_alloc();
+    }
+  return buffer;
+}
+
+
+void ImageBufferAllocator::SetAllocator( AllocatorFunctionType allocator,
+                                         DeallocatorFunctionType deallocator,
+                                         void *clientData )
+{
+  if ( ( allocator == NULL ) != ( deallocator == NULL ) )
+    {
+    sitkExceptionMacro( "Both an allocator and deallocator must be provided!" );
+    }
+
+  BufferPool &pool = GetPool();
+  MutexHolderType lock( pool.m_Mutex );
+  pool.m_Allocator = allocator;
+  pool.m_Deallocator = deallocator;
+  pool.m_AllocatorClientData = clientData;
+}
+
+
+void ImageBufferAllocator::SetPoolEnabled( bool enabled )
+{
+  BufferPool &pool = GetPool();
+  MutexHolderType lock( pool.m_Mutex );
+  pool.m_Enabled = enabled;
+  if ( !enabled )
+    {
+    pool.Trim( 0 );
+    }
+}
+
+
+bool ImageBufferAllocator::GetPoolEnabled( void )
+{
+  BufferPool &pool = GetPool();
+  MutexHolderType lock( pool.m_Mutex );
+  return pool.m_Enabled;
+}
+
+
+void ImageBufferAllocator::SetPoolMaximumBytes( uint64_t maximumBytes )
+{
+  BufferPool &pool = GetPool();
+  MutexHolderType lock( pool.m_Mutex );
+  pool.m_MaximumBytes = maximumBytes;
+  pool.Trim( maximumBytes );
+}
+
+
+uint64_t ImageBufferAllocator::GetPoolMaximumBytes( void )
+{
+  BufferPool &pool = GetPool();
+  MutexHolderType lock( pool.m_Mutex );
+  return pool.m_MaximumBytes;
+}
+
+
+uint64_t ImageBufferAllocator::GetPoolBytes( void )
+{
+  BufferPool &pool = GetPool();
+  MutexHolderType lock( pool.m_Mutex );
+  return pool.m_Bytes;
+}
+
+
+void ImageBufferAllocator::ReleasePool( void )
+{
+  BufferPool &pool = GetPool();
+  MutexHolderType lock( pool.m_Mutex );
+  pool.Trim( 0 );
+}
+
+}
+}
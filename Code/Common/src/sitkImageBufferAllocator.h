@@ -0,0 +1,276 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkImageBufferAllocator_h
+#define sitkImageBufferAllocator_h
+
+#include "sitkImage.h"
+
+#include "itkImportImageContainer.h"
+#include "itkMultiThreader.h"
+#include "itkImageRegionSplitterSlowDimension.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+
+namespace itk
+{
+namespace simple
+{
+
+/** \class ImageBufferAllocator
+ * \brief Internal allocator of pixel buffers for images constructed
+ * by SimpleITK.
+ *
+ * Buffers are allocated by the user provided allocator set with
+ * Image::SetGlobalBufferAllocator if any, otherwise from a pool of
+ * recycled buffers when Image::GlobalBufferPoolOn has been called.
+ */
+class SITKCommon_HIDDEN ImageBufferAllocator
+{
+public:
+  typedef Image::BufferAllocatorFunctionType   AllocatorFunctionType;
+  typedef Image::BufferDeallocatorFunctionType DeallocatorFunctionType;
+
+  /** Returns true if either a user allocator or the pool is in use,
+   * otherwise ITK's default allocation should be used. */
+  static bool IsEnabled( void );
+
+  /** Allocate a buffer of numberOfBytes, the deallocator and client
+   * data which must be used to release the buffer are returned. */
+  static void *Allocate( size_t numberOfBytes,
+                         DeallocatorFunctionType &deallocator,
+                         void * &clientData );
+
+  static void SetAllocator( AllocatorFunctionType allocator,
+                            DeallocatorFunctionType deallocator,
+                            void *clientData );
+
+  static void SetPoolEnabled( bool );
+  static bool GetPoolEnabled( void );
+  static void SetPoolMaximumBytes( uint64_t );
+  static uint64_t GetPoolMaximumBytes( void );
+  static uint64_t GetPoolBytes( void );
+  static void ReleasePool( void );
+};
+
+
+/** \class DeallocatorImportImageContainer
+ * \brief A pixel container which releases the imported buffer with a
+ * deallocator function when destroyed.
+ */
+template <typename TElementIdentifier, typename TElement>
+class DeallocatorImportImageContainer
+  : public itk::ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  typedef DeallocatorImportImageContainer                         Self;
+  typedef itk::ImportImageContainer<TElementIdentifier, TElement> Superclass;
+  typedef SmartPointer<Self>                                      Pointer;
+  typedef ImageBufferAllocator::DeallocatorFunctionType           DeallocatorFunctionType;
+
+  itkNewMacro(Self);
+  itkTypeMacro(DeallocatorImportImageContainer, ImportImageContainer);
+
+  void SetDeallocator( DeallocatorFunctionType deallocator,
+                       void *buffer,
+                       size_t numberOfBytes,
+                       void *clientData )
+    {
+      m_Deallocator = deallocator;
+      m_DeallocatorBuffer = buffer;
+      m_DeallocatorNumberOfBytes = numberOfBytes;
+      m_DeallocatorClientData = clientData;
+    }
+
+protected:
+  DeallocatorImportImageContainer()
+    : m_Deallocator(NULL),
+      m_DeallocatorBuffer(NULL),
+      m_DeallocatorNumberOfBytes(0),
+      m_DeallocatorClientData(NULL) {}
+  virtual ~DeallocatorImportImageContainer()
+    {
+      if ( m_Deallocator )
+        {
+        m_Deallocator( m_DeallocatorBuffer, m_DeallocatorNumberOfBytes, m_DeallocatorClientData );
+        }
+    }
+
+private:
+  DeallocatorImportImageContainer(const Self &); //purposely not implemented
+  void operator=(const Self &);                  //purposely not implemented
+
+  DeallocatorFunctionType m_Deallocator;
+  void                   *m_DeallocatorBuffer;
+  size_t                  m_DeallocatorNumberOfBytes;
+  void                   *m_DeallocatorClientData;
+};
+
+
+/** \class RegionImportImageContainer
+ * \brief A pixel container of a contiguous part of the buffer of
+ * another pixel container, which is kept alive.
+ *
+ * The reference count reports the buffer as shared, so that the copy
+ * on write of an Image copies the pixels before they are modified and
+ * filters do not run in place on them.
+ */
+template <typename TElementIdentifier, typename TElement>
+class RegionImportImageContainer
+  : public itk::ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  typedef RegionImportImageContainer                              Self;
+  typedef itk::ImportImageContainer<TElementIdentifier, TElement> Superclass;
+  typedef SmartPointer<Self>                                      Pointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(RegionImportImageContainer, ImportImageContainer);
+
+  void SetRegionOf( Superclass *container, TElementIdentifier offset, TElementIdentifier size )
+    {
+      m_Container = container;
+      this->SetImportPointer( container->GetBufferPointer() + offset, size, false );
+    }
+
+  virtual int GetReferenceCount() const
+    {
+      return Superclass::GetReferenceCount() + 1;
+    }
+
+protected:
+  RegionImportImageContainer() {}
+  virtual ~RegionImportImageContainer() {}
+
+private:
+  RegionImportImageContainer(const Self &); //purposely not implemented
+  void operator=(const Self &);             //purposely not implemented
+
+  typename Superclass::Pointer m_Container;
+};
+
+
+/** Allocate the buffered region of an itk::Image or itk::VectorImage
+ * whose regions and number of components have been set, using the
+ * ImageBufferAllocator when enabled.
+ */
+template <typename TImageType>
+void AllocateImageBuffer( TImageType *image )
+{
+  if ( !ImageBufferAllocator::IsEnabled() )
+    {
+    image->Allocate();
+    return;
+    }
+
+  typedef typename TImageType::PixelContainer PixelContainerType;
+  typedef typename PixelContainerType::Element ElementType;
+  typedef DeallocatorImportImageContainer<typename PixelContainerType::ElementIdentifier, ElementType> ContainerType;
+
+  const size_t numberOfElements = image->GetBufferedRegion().GetNumberOfPixels()
+    * image->GetNumberOfComponentsPerPixel();
+  const size_t numberOfBytes = numberOfElements * sizeof( ElementType );
+
+  typename ContainerType::Pointer container = ContainerType::New();
+
+  ImageBufferAllocator::DeallocatorFunctionType deallocator = NULL;
+  void *clientData = NULL;
+  void *buffer = ImageBufferAllocator::Allocate( numberOfBytes, deallocator, clientData );
+  container->SetDeallocator( deallocator, buffer, numberOfBytes, clientData );
+
+  container->SetImportPointer( static_cast<ElementType*>( buffer ), numberOfElements, false );
+  image->SetPixelContainer( container );
+}
+
+
+
+/** Helper structure for ZeroFillImageBuffer */
+template <typename TImageType>
+struct ZeroFillThreadStruct
+{
+  TImageType                                     *m_Image;
+  const itk::ImageRegionSplitterSlowDimension    *m_Splitter;
+  typename TImageType::RegionType                 m_Region;
+};
+
+template <typename TImageType>
+ITK_THREAD_RETURN_TYPE ZeroFillThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct          ThreadInfoType;
+  typedef typename TImageType::PixelContainer::Element ElementType;
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  const ZeroFillThreadStruct<TImageType> *str = static_cast<ZeroFillThreadStruct<TImageType> *>( info->UserData );
+
+  // the piece along the slowest dimension is contiguous in the buffer
+  typename TImageType::RegionType piece = str->m_Region;
+  str->m_Splitter->GetSplit( info->ThreadID, info->NumberOfThreads, piece );
+
+  const size_t components = str->m_Image->GetNumberOfComponentsPerPixel();
+  ElementType *begin = str->m_Image->GetPixelContainer()->GetBufferPointer()
+    + str->m_Image->ComputeOffset( piece.GetIndex() ) * components;
+  std::fill( begin, begin + piece.GetNumberOfPixels() * components, itk::NumericTraits<ElementType>::ZeroValue() );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/** Set all elements of the pixel buffer of an itk::Image or
+ * itk::VectorImage to zero.
+ *
+ * Large buffers are filled by the default number of threads, split
+ * along the slowest dimension as by the ITK filters, so that the pages
+ * of each piece are first touched by a thread, and allocated on the
+ * memory node, which will likely process the same piece later.
+ */
+template <typename TImageType>
+void ZeroFillImageBuffer( TImageType *image )
+{
+  typedef typename TImageType::PixelContainer::Element ElementType;
+
+  // buffers smaller than this per thread are filled by the calling
+  // thread
+  const size_t minimumBytesPerThread = 1024*1024;
+
+  ElementType *buffer = image->GetPixelContainer()->GetBufferPointer();
+  const size_t numberOfElements = image->GetPixelContainer()->Size();
+  const size_t numberOfBytes = numberOfElements * sizeof( ElementType );
+
+  itk::ImageRegionSplitterSlowDimension::Pointer splitter = itk::ImageRegionSplitterSlowDimension::New();
+  const unsigned int numberOfThreads = splitter->GetNumberOfSplits( image->GetBufferedRegion(),
+                                                                    itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+
+  if ( numberOfThreads <= 1 || numberOfBytes / numberOfThreads < minimumBytesPerThread )
+    {
+    std::fill( buffer, buffer + numberOfElements, itk::NumericTraits<ElementType>::ZeroValue() );
+    return;
+    }
+
+  ZeroFillThreadStruct<TImageType> str;
+  str.m_Image = image;
+  str.m_Splitter = splitter.GetPointer();
+  str.m_Region = image->GetBufferedRegion();
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( ZeroFillThreaderCallback<TImageType>, &str );
+  threader->SingleMethodExecute();
+}
+
+}
+}
+
+#endif // sitkImageBufferAllocator_h
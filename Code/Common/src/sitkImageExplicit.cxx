@@ -37,14 +37,15 @@ namespace itk
 {
   namespace simple
   {
-    void Image::Allocate ( unsigned int Width, unsigned int Height, unsigned int Depth, unsigned int dim4, PixelIDValueEnum ValueEnum, unsigned int numberOfComponents )
+    void Image::Allocate ( unsigned int Width, unsigned int Height, unsigned int Depth, unsigned int dim4, PixelIDValueEnum ValueEnum, unsigned int numberOfComponents,
+                           BufferInitializationType initialization )
     {
       // initialize member function factory for allocating images
 
       // The pixel IDs supported
       typedef AllPixelIDTypeList              PixelIDTypeList;
 
-      typedef void ( Self::*MemberFunctionType )( unsigned int, unsigned int, unsigned int, unsigned int, unsigned int );
+      typedef void ( Self::*MemberFunctionType )( unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, BufferInitializationType );
 
       typedef AllocateMemberFunctionAddressor< MemberFunctionType > AllocateAddressor;
 
@@ -60,15 +61,15 @@ namespace itk
 
       if ( Depth == 0 )
         {
-        allocateMemberFactory.GetMemberFunction( ValueEnum, 2 )( Width, Height, Depth, dim4, numberOfComponents );
+        allocateMemberFactory.GetMemberFunction( ValueEnum, 2 )( Width, Height, Depth, dim4, numberOfComponents, initialization );
         }
       else if ( dim4 == 0 )
         {
-        allocateMemberFactory.GetMemberFunction( ValueEnum, 3 )( Width, Height, Depth, dim4, numberOfComponents );
+        allocateMemberFactory.GetMemberFunction( ValueEnum, 3 )( Width, Height, Depth, dim4, numberOfComponents, initialization );
         }
       else
         {
-        allocateMemberFactory.GetMemberFunction( ValueEnum, 4 )( Width, Height, Depth, dim4, numberOfComponents );
+        allocateMemberFactory.GetMemberFunction( ValueEnum, 4 )( Width, Height, Depth, dim4, numberOfComponents, initialization );
         }
     }
   }
@@ -0,0 +1,209 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkImageView.h"
+#include "sitkExceptionObject.h"
+#include "sitkPimpleImageBase.h"
+
+#include <sstream>
+
+namespace itk
+{
+namespace simple
+{
+
+ImageView::ImageView( const Image &image )
+  : m_Image( image ),
+    m_Index( image.GetDimension(), 0 ),
+    m_Size( image.GetSize() )
+{
+}
+
+
+ImageView::ImageView( const Image &image,
+                      const std::vector<unsigned int> &index,
+                      const std::vector<unsigned int> &size )
+  : m_Image( image ),
+    m_Index( index ),
+    m_Size( size )
+{
+  const std::vector<unsigned int> imageSize = image.GetSize();
+
+  if ( index.size() != imageSize.size() || size.size() != imageSize.size() )
+    {
+    sitkExceptionMacro( "The view index and size must be of the same dimension as the image, "
+                        << imageSize.size() << "!" );
+    }
+
+  for ( unsigned int d = 0; d < imageSize.size(); ++d )
+    {
+    if ( uint64_t(index[d]) + size[d] > imageSize[d] )
+      {
+      sitkExceptionMacro( "The view with index " << index << " and size " << size
+                          << " is not inside the image of size " << imageSize << "!" );
+      }
+    }
+}
+
+
+const Image &ImageView::GetImage( void ) const
+{
+  return this->m_Image;
+}
+
+
+std::vector<unsigned int> ImageView::GetIndex( void ) const
+{
+  return this->m_Index;
+}
+
+
+std::vector<unsigned int> ImageView::GetSize( void ) const
+{
+  return this->m_Size;
+}
+
+
+unsigned int ImageView::GetDimension( void ) const
+{
+  return this->m_Image.GetDimension();
+}
+
+
+PixelIDValueEnum ImageView::GetPixelID( void ) const
+{
+  return this->m_Image.GetPixelID();
+}
+
+
+unsigned int ImageView::GetNumberOfComponentsPerPixel( void ) const
+{
+  return this->m_Image.GetNumberOfComponentsPerPixel();
+}
+
+
+uint64_t ImageView::GetNumberOfPixels( void ) const
+{
+  uint64_t n = 1;
+  for ( unsigned int d = 0; d < this->m_Size.size(); ++d )
+    {
+    n *= this->m_Size[d];
+    }
+  return n;
+}
+
+
+std::vector<double> ImageView::GetOrigin( void ) const
+{
+  return this->m_Image.TransformIndexToPhysicalPoint( std::vector<int64_t>( this->m_Index.begin(), this->m_Index.end() ) );
+}
+
+
+std::vector<double> ImageView::GetSpacing( void ) const
+{
+  return this->m_Image.GetSpacing();
+}
+
+
+std::vector<double> ImageView::GetDirection( void ) const
+{
+  return this->m_Image.GetDirection();
+}
+
+
+uint64_t ImageView::GetBufferOffset( void ) const
+{
+  const std::vector<uint64_t> strides = this->GetStrides();
+
+  uint64_t offset = 0;
+  for ( unsigned int d = 0; d < this->m_Index.size(); ++d )
+    {
+    offset += strides[d] * this->m_Index[d];
+    }
+  return offset;
+}
+
+
+std::vector<uint64_t> ImageView::GetStrides( void ) const
+{
+  const std::vector<unsigned int> imageSize = this->m_Image.GetSize();
+  std::vector<uint64_t> strides( imageSize.size() );
+
+  uint64_t stride = this->m_Image.GetNumberOfComponentsPerPixel();
+  for ( unsigned int d = 0; d < imageSize.size(); ++d )
+    {
+    strides[d] = stride;
+    stride *= imageSize[d];
+    }
+  return strides;
+}
+
+
+bool ImageView::IsContiguous( void ) const
+{
+  const std::vector<unsigned int> imageSize = this->m_Image.GetSize();
+
+  // The region is contiguous if all but the last dimension with a
+  // size greater than one span the whole image.
+  unsigned int d = imageSize.size();
+  while ( d > 0 && this->m_Size[d-1] == 1 )
+    {
+    --d;
+    }
+  for ( unsigned int i = 0; i + 1 < d; ++i )
+    {
+    if ( this->m_Size[i] != imageSize[i] )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+
+Image ImageView::ToImage( void ) const
+{
+  if ( this->m_Size == this->m_Image.GetSize() )
+    {
+    return this->m_Image;
+    }
+
+  // an Image has a contiguous buffer, so only a view which is not
+  // contiguous is copied
+  if ( this->IsContiguous() )
+    {
+    return Image( this->m_Image.m_PimpleImage->ShallowCopyRegion( this->m_Index, this->m_Size ) );
+    }
+  return Image( this->m_Image.m_PimpleImage->DeepCopyRegion( this->m_Index, this->m_Size ) );
+}
+
+
+std::string ImageView::ToString( void ) const
+{
+  std::ostringstream out;
+  out << "ImageView" << std::endl;
+  out << "  Index: " << this->m_Index << std::endl;
+  out << "  Size: " << this->m_Size << std::endl;
+  out << "  Origin: " << this->GetOrigin() << std::endl;
+  out << "  Strides: " << this->GetStrides() << std::endl;
+  out << "  Image: " << this->m_Image.GetPixelIDTypeAsString()
+      << " of size " << this->m_Image.GetSize() << std::endl;
+  return out.str();
+}
+
+}
+}
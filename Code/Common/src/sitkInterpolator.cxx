@@ -39,6 +39,7 @@ std::ostream& operator<<(std::ostream& os, const InterpolatorEnum i)
     sitkInterpolatorToStringCaseMacro(WelchWindowedSinc);
     sitkInterpolatorToStringCaseMacro(LanczosWindowedSinc);
     sitkInterpolatorToStringCaseMacro(BlackmanWindowedSinc);
+    sitkInterpolatorToStringCaseMacro(BSplineResampler);
     }
   return os;
 }
@@ -49,6 +49,21 @@ namespace itk
 
     virtual PimpleImageBase *ShallowCopy(void) const = 0;
     virtual PimpleImageBase *DeepCopy(void) const = 0;
+
+    /** Create a new image with its own meta-data and meta-data
+     * dictionary, sharing the pixel buffer of this image. */
+    virtual PimpleImageBase *ShallowCopyInformation( void ) const = 0;
+
+    /** Create a new image by copying a sub-region, the origin of
+     * the new image is the physical location of index. */
+    virtual PimpleImageBase *DeepCopyRegion( const std::vector<unsigned int> &index,
+                                             const std::vector<unsigned int> &size ) const = 0;
+
+    /** Create a new image of a sub-region which is contiguous in the
+     * buffer, sharing the buffer, the origin of the new image is the
+     * physical location of index. */
+    virtual PimpleImageBase *ShallowCopyRegion( const std::vector<unsigned int> &index,
+                                                const std::vector<unsigned int> &size ) const = 0;
     virtual itk::DataObject* GetDataBase( void ) = 0;
     virtual const itk::DataObject* GetDataBase( void ) const = 0;
 
@@ -73,11 +88,27 @@ namespace itk
     virtual std::vector<double> TransformPhysicalPointToContinuousIndex( const std::vector<double> &pt) const = 0;
     virtual std::vector<double> TransformContinuousIndexToPhysicalPoint( const std::vector<double> &idx) const = 0;
 
+    /** Batched transforms of N points or indices stored contiguously,
+     * with GetDimension() coordinates each */
+    virtual std::vector<int64_t> TransformPhysicalPointsToIndices( const std::vector<double> &pts, unsigned int numberOfThreads ) const = 0;
+    virtual std::vector<double> TransformIndicesToPhysicalPoints( const std::vector<int64_t> &idx, unsigned int numberOfThreads ) const = 0;
+    virtual std::vector<double> TransformPhysicalPointsToContinuousIndices( const std::vector<double> &pts, unsigned int numberOfThreads ) const = 0;
+    virtual std::vector<double> TransformContinuousIndicesToPhysicalPoints( const std::vector<double> &idx, unsigned int numberOfThreads ) const = 0;
+
     virtual std::string ToString() const = 0;
 
 
     virtual int GetReferenceCountOfImage() const = 0;
 
+    /** Number of bytes in the image's pixel buffer, 0 for LabelMaps */
+    virtual uint64_t GetSizeOfBuffer( void ) const = 0;
+
+    /** Reference count of the image's pixel container, 0 for LabelMaps */
+    virtual int GetReferenceCountOfBuffer( void ) const = 0;
+
+    /** Pointer to the image's pixel buffer, NULL for LabelMaps */
+    virtual const void *GetBufferPointer( void ) const = 0;
+
     virtual int8_t   GetPixelAsInt8( const std::vector<uint32_t> &idx) const = 0;
     virtual uint8_t  GetPixelAsUInt8( const std::vector<uint32_t> &idx) const = 0;
     virtual int16_t  GetPixelAsInt16( const std::vector<uint32_t> &idx ) const = 0;
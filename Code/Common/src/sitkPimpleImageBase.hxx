@@ -21,12 +21,17 @@
 #include "sitkPimpleImageBase.h"
 #include "sitkMemberFunctionFactory.h"
 #include "sitkConditional.h"
+#include "sitkImageBufferAllocator.h"
 
 
 #include "itkImage.h"
 #include "itkVectorImage.h"
 #include "itkLabelMap.h"
 #include "itkImageDuplicator.h"
+#include "itkImageAlgorithm.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
 
 namespace itk
 {
@@ -99,6 +104,7 @@ namespace itk
         dup->SetInputImage( this->m_Image );
         dup->Update();
         ImagePointer output = dup->GetOutput();
+        output->SetMetaDataDictionary( this->m_Image->GetMetaDataDictionary() );
 
         return new Self( output.GetPointer() );
       }
@@ -110,6 +116,129 @@ namespace itk
         return new Self( this->m_Image.GetPointer() );
       }
 
+    virtual PimpleImageBase *ShallowCopyInformation( void ) const { return this->ShallowCopyInformation<TImageType>(); }
+
+    template <typename UImageType>
+    typename DisableIf<IsLabel<UImageType>::Value, PimpleImageBase*>::Type
+    ShallowCopyInformation( void ) const
+      {
+        // Graft shares the pixel container and copies the regions,
+        // origin, spacing and direction, the meta-data dictionary is
+        // copied separately.
+        ImagePointer output = ImageType::New();
+        output->Graft( this->m_Image.GetPointer() );
+        output->SetMetaDataDictionary( this->m_Image->GetMetaDataDictionary() );
+
+        return new Self( output.GetPointer() );
+      }
+    template <typename UImageType>
+    typename EnableIf<IsLabel<UImageType>::Value, PimpleImageBase*>::Type
+    ShallowCopyInformation( void ) const
+      {
+        return this->DeepCopy();
+      }
+
+    virtual PimpleImageBase *DeepCopyRegion( const std::vector<unsigned int> &index,
+                                             const std::vector<unsigned int> &size ) const
+      {
+        return this->DeepCopyRegion<TImageType>( index, size );
+      }
+
+    template <typename UImageType>
+    typename DisableIf<IsLabel<UImageType>::Value, PimpleImageBase*>::Type
+    DeepCopyRegion( const std::vector<unsigned int> &index, const std::vector<unsigned int> &size ) const
+      {
+        typename ImageType::RegionType inRegion;
+        inRegion.SetIndex( sitkSTLVectorToITK<IndexType>( index ) );
+        inRegion.SetSize( sitkSTLVectorToITK<typename ImageType::SizeType>( size ) );
+
+        if ( !this->m_Image->GetLargestPossibleRegion().IsInside( inRegion ) )
+          {
+          sitkExceptionMacro( "The requested region " << inRegion
+                              << " is not inside the image's region " << this->m_Image->GetLargestPossibleRegion() );
+          }
+
+        typename ImageType::PointType origin;
+        this->m_Image->TransformIndexToPhysicalPoint( inRegion.GetIndex(), origin );
+
+        typename ImageType::RegionType outRegion;
+        outRegion.SetSize( inRegion.GetSize() );
+
+        ImagePointer output = ImageType::New();
+        output->SetRegions( outRegion );
+        output->SetOrigin( origin );
+        output->SetSpacing( this->m_Image->GetSpacing() );
+        output->SetDirection( this->m_Image->GetDirection() );
+        output->SetNumberOfComponentsPerPixel( this->m_Image->GetNumberOfComponentsPerPixel() );
+        output->SetMetaDataDictionary( this->m_Image->GetMetaDataDictionary() );
+        output->Allocate();
+
+        itk::ImageAlgorithm::Copy( this->m_Image.GetPointer(), output.GetPointer(), inRegion, outRegion );
+
+        return new Self( output.GetPointer() );
+      }
+    template <typename UImageType>
+    typename EnableIf<IsLabel<UImageType>::Value, PimpleImageBase*>::Type
+    DeepCopyRegion( const std::vector<unsigned int> &, const std::vector<unsigned int> & ) const
+      {
+        sitkExceptionMacro( "This method is not implemented yet" );
+        return new Self( this->m_Image.GetPointer() );
+      }
+
+    virtual PimpleImageBase *ShallowCopyRegion( const std::vector<unsigned int> &index,
+                                                const std::vector<unsigned int> &size ) const
+      {
+        return this->ShallowCopyRegion<TImageType>( index, size );
+      }
+
+    template <typename UImageType>
+    typename DisableIf<IsLabel<UImageType>::Value, PimpleImageBase*>::Type
+    ShallowCopyRegion( const std::vector<unsigned int> &index, const std::vector<unsigned int> &size ) const
+      {
+        typedef typename ImageType::PixelContainer                    PixelContainerType;
+        typedef RegionImportImageContainer<typename PixelContainerType::ElementIdentifier,
+                                           typename PixelContainerType::Element> RegionContainerType;
+
+        typename ImageType::RegionType inRegion;
+        inRegion.SetIndex( sitkSTLVectorToITK<IndexType>( index ) );
+        inRegion.SetSize( sitkSTLVectorToITK<typename ImageType::SizeType>( size ) );
+
+        if ( !this->m_Image->GetLargestPossibleRegion().IsInside( inRegion ) )
+          {
+          sitkExceptionMacro( "The requested region " << inRegion
+                              << " is not inside the image's region " << this->m_Image->GetLargestPossibleRegion() );
+          }
+
+        typename ImageType::PointType origin;
+        this->m_Image->TransformIndexToPhysicalPoint( inRegion.GetIndex(), origin );
+
+        typename ImageType::RegionType outRegion;
+        outRegion.SetSize( inRegion.GetSize() );
+
+        const unsigned int numberOfComponents = this->m_Image->GetNumberOfComponentsPerPixel();
+        typename RegionContainerType::Pointer container = RegionContainerType::New();
+        container->SetRegionOf( const_cast<PixelContainerType *>( this->m_Image->GetPixelContainer() ),
+                                this->m_Image->ComputeOffset( inRegion.GetIndex() ) * numberOfComponents,
+                                inRegion.GetNumberOfPixels() * numberOfComponents );
+
+        ImagePointer output = ImageType::New();
+        output->SetRegions( outRegion );
+        output->SetOrigin( origin );
+        output->SetSpacing( this->m_Image->GetSpacing() );
+        output->SetDirection( this->m_Image->GetDirection() );
+        output->SetNumberOfComponentsPerPixel( numberOfComponents );
+        output->SetMetaDataDictionary( this->m_Image->GetMetaDataDictionary() );
+        output->SetPixelContainer( container );
+
+        return new Self( output.GetPointer() );
+      }
+    template <typename UImageType>
+    typename EnableIf<IsLabel<UImageType>::Value, PimpleImageBase*>::Type
+    ShallowCopyRegion( const std::vector<unsigned int> &index, const std::vector<unsigned int> &size ) const
+      {
+        return this->DeepCopyRegion<UImageType>( index, size );
+      }
+
     virtual itk::DataObject* GetDataBase( void ) { return this->m_Image.GetPointer(); }
     virtual const itk::DataObject* GetDataBase( void ) const { return this->m_Image.GetPointer(); }
 
@@ -254,6 +383,145 @@ namespace itk
       return sitkITKVectorToSTL<double>( point );
       }
 
+    // Batched transforms between physical points and indices
+
+    struct PhysicalPointToIndexOperation
+    {
+      typedef double InputType;
+      typedef int64_t OutputType;
+      static void Apply( const ImageType *image, const double *in, int64_t *out )
+        {
+          typename ImageType::PointType point;
+          std::copy( in, in + ImageType::ImageDimension, point.Begin() );
+          typename ImageType::IndexType index;
+          image->TransformPhysicalPointToIndex( point, index );
+          std::copy( index.m_Index, index.m_Index + ImageType::ImageDimension, out );
+        }
+    };
+
+    struct IndexToPhysicalPointOperation
+    {
+      typedef int64_t InputType;
+      typedef double OutputType;
+      static void Apply( const ImageType *image, const int64_t *in, double *out )
+        {
+          typename ImageType::IndexType index;
+          std::copy( in, in + ImageType::ImageDimension, index.m_Index );
+          typename ImageType::PointType point;
+          image->TransformIndexToPhysicalPoint( index, point );
+          std::copy( point.Begin(), point.End(), out );
+        }
+    };
+
+    struct PhysicalPointToContinuousIndexOperation
+    {
+      typedef double InputType;
+      typedef double OutputType;
+      static void Apply( const ImageType *image, const double *in, double *out )
+        {
+          typename ImageType::PointType point;
+          std::copy( in, in + ImageType::ImageDimension, point.Begin() );
+          itk::ContinuousIndex<double, ImageType::ImageDimension> index;
+          image->TransformPhysicalPointToContinuousIndex( point, index );
+          std::copy( index.Begin(), index.End(), out );
+        }
+    };
+
+    struct ContinuousIndexToPhysicalPointOperation
+    {
+      typedef double InputType;
+      typedef double OutputType;
+      static void Apply( const ImageType *image, const double *in, double *out )
+        {
+          itk::ContinuousIndex<double, ImageType::ImageDimension> index;
+          std::copy( in, in + ImageType::ImageDimension, index.Begin() );
+          typename ImageType::PointType point;
+          image->TransformContinuousIndexToPhysicalPoint( index, point );
+          std::copy( point.Begin(), point.End(), out );
+        }
+    };
+
+    template <typename TOperation>
+    struct TransformPointsThreadStruct
+    {
+      const ImageType *m_Image;
+      const typename TOperation::InputType *m_Input;
+      typename TOperation::OutputType *m_Output;
+      size_t m_NumberOfPoints;
+    };
+
+    template <typename TOperation>
+    static ITK_THREAD_RETURN_TYPE TransformPointsThreaderCallback( void *arg )
+      {
+        typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+        ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+        const TransformPointsThreadStruct<TOperation> *str =
+          static_cast<const TransformPointsThreadStruct<TOperation> *>( info->UserData );
+
+        // each thread transforms a contiguous range of points
+        const size_t numberOfThreads = info->NumberOfThreads;
+        const size_t begin = str->m_NumberOfPoints * info->ThreadID / numberOfThreads;
+        const size_t end = str->m_NumberOfPoints * ( info->ThreadID + 1 ) / numberOfThreads;
+        for ( size_t p = begin; p < end; ++p )
+          {
+          TOperation::Apply( str->m_Image,
+                             str->m_Input + p * ImageType::ImageDimension,
+                             str->m_Output + p * ImageType::ImageDimension );
+          }
+        return ITK_THREAD_RETURN_VALUE;
+      }
+
+    template <typename TOperation>
+    std::vector<typename TOperation::OutputType>
+    TransformPoints( const std::vector<typename TOperation::InputType> &input, unsigned int numberOfThreads ) const
+      {
+        if ( input.size() % ImageType::ImageDimension != 0 )
+          {
+          sitkExceptionMacro( "The length of the points " << input.size()
+                              << " is not a multiple of the image dimension " << ImageType::ImageDimension << "!" );
+          }
+
+        std::vector<typename TOperation::OutputType> output( input.size() );
+
+        TransformPointsThreadStruct<TOperation> str;
+        str.m_Image = this->m_Image.GetPointer();
+        str.m_Input = input.empty() ? SITK_NULLPTR : &input[0];
+        str.m_Output = output.empty() ? SITK_NULLPTR : &output[0];
+        str.m_NumberOfPoints = input.size() / ImageType::ImageDimension;
+
+        // points fewer than this are transformed by the calling thread
+        const size_t minimumPointsPerThread = 16384;
+        const size_t threads =
+          std::max<size_t>( 1, std::min<size_t>( numberOfThreads, str.m_NumberOfPoints / minimumPointsPerThread ) );
+
+        itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+        threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( threads ) );
+        threader->SetSingleMethod( TransformPointsThreaderCallback<TOperation>, &str );
+        threader->SingleMethodExecute();
+
+        return output;
+      }
+
+    virtual std::vector<int64_t> TransformPhysicalPointsToIndices( const std::vector<double> &pts, unsigned int numberOfThreads ) const
+      {
+        return this->TransformPoints<PhysicalPointToIndexOperation>( pts, numberOfThreads );
+      }
+
+    virtual std::vector<double> TransformIndicesToPhysicalPoints( const std::vector<int64_t> &idx, unsigned int numberOfThreads ) const
+      {
+        return this->TransformPoints<IndexToPhysicalPointOperation>( idx, numberOfThreads );
+      }
+
+    virtual std::vector<double> TransformPhysicalPointsToContinuousIndices( const std::vector<double> &pts, unsigned int numberOfThreads ) const
+      {
+        return this->TransformPoints<PhysicalPointToContinuousIndexOperation>( pts, numberOfThreads );
+      }
+
+    virtual std::vector<double> TransformContinuousIndicesToPhysicalPoints( const std::vector<double> &idx, unsigned int numberOfThreads ) const
+      {
+        return this->TransformPoints<ContinuousIndexToPhysicalPointOperation>( idx, numberOfThreads );
+      }
+
     virtual unsigned int GetSize( unsigned int dimension ) const
       {
         if ( dimension > ImageType::ImageDimension - 1 )
@@ -290,6 +558,53 @@ namespace itk
         return this->m_Image->GetReferenceCount();
       }
 
+    virtual uint64_t GetSizeOfBuffer( void ) const { return this->GetSizeOfBuffer<TImageType>(); }
+
+    template <typename UImageType>
+    typename DisableIf<IsLabel<UImageType>::Value, uint64_t>::Type
+    GetSizeOfBuffer( void ) const
+      {
+        typedef typename UImageType::PixelContainer PixelContainerType;
+        const PixelContainerType *container = this->m_Image->GetPixelContainer();
+        return static_cast<uint64_t>( container->Size() ) * sizeof( typename PixelContainerType::Element );
+      }
+    template <typename UImageType>
+    typename EnableIf<IsLabel<UImageType>::Value, uint64_t>::Type
+    GetSizeOfBuffer( void ) const
+      {
+        return 0;
+      }
+
+    virtual int GetReferenceCountOfBuffer( void ) const { return this->GetReferenceCountOfBuffer<TImageType>(); }
+
+    template <typename UImageType>
+    typename DisableIf<IsLabel<UImageType>::Value, int>::Type
+    GetReferenceCountOfBuffer( void ) const
+      {
+        return this->m_Image->GetPixelContainer()->GetReferenceCount();
+      }
+    template <typename UImageType>
+    typename EnableIf<IsLabel<UImageType>::Value, int>::Type
+    GetReferenceCountOfBuffer( void ) const
+      {
+        return 0;
+      }
+
+    virtual const void *GetBufferPointer( void ) const { return this->GetBufferPointer<TImageType>(); }
+
+    template <typename UImageType>
+    typename DisableIf<IsLabel<UImageType>::Value, const void *>::Type
+    GetBufferPointer( void ) const
+      {
+        return this->m_Image->GetBufferPointer();
+      }
+    template <typename UImageType>
+    typename EnableIf<IsLabel<UImageType>::Value, const void *>::Type
+    GetBufferPointer( void ) const
+      {
+        return SITK_NULLPTR;
+      }
+
     virtual int8_t  GetPixelAsInt8( const std::vector<uint32_t> &idx) const
       {
         if ( IsLabel<ImageType>::Value )
@@ -645,7 +960,10 @@ namespace itk
           {
           sitkExceptionMacro( "index out of bounds" );
           }
-        return this->m_Image->GetPixel( itkIdx  );
+        // the virtual GetBufferPointer copies the pixels of a GPUImage
+        // back to the host
+        const ImageType *image = this->m_Image.GetPointer();
+        return image->GetBufferPointer()[ image->ComputeOffset( itkIdx ) ];
       }
 
     template < typename TPixelIDType >
@@ -700,7 +1018,7 @@ namespace itk
                       typename ImageType::PixelType *>::Type
     InternalGetBuffer( void )
       {
-        return this->m_Image->GetPixelContainer()->GetBufferPointer();
+        return this->m_Image->GetBufferPointer();
       }
 
     template < typename TPixelIDType >
@@ -746,7 +1064,7 @@ namespace itk
           {
           sitkExceptionMacro( "index out of bounds" );
           }
-        this->m_Image->SetPixel( itkIdx, v );
+        this->m_Image->GetBufferPointer()[ this->m_Image->ComputeOffset( itkIdx ) ] = v;
       }
 
     template < typename TPixelIDType, typename TPixelType >
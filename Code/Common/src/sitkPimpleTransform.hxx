@@ -41,6 +41,9 @@
 #include "itkBSplineSmoothingOnUpdateDisplacementFieldTransform.h"
 #include "itkGaussianSmoothingOnUpdateDisplacementFieldTransform.h"
 #include "itkBSplineTransform.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
 
 namespace itk
 {
@@ -99,6 +102,10 @@ public:
 
 
   void SetParameters( const std::vector< double > &inParams )
+    {
+      this->SetParameters( inParams.empty() ? SITK_NULLPTR : &inParams[0], inParams.size() );
+    }
+  void SetParameters( const double *inParams, size_t numberOfInParams )
     {
       unsigned int numberOfParameters = this->GetTransformBase()->GetNumberOfParameters();
 
@@ -106,14 +113,14 @@ public:
         {
         return;
         }
-      else if ( numberOfParameters > inParams.size())
+      else if ( numberOfParameters > numberOfInParams )
         {
-        sitkExceptionMacro("Transform expected " << numberOfParameters << " parameters but only " << inParams.size() << " are provided!");
+        sitkExceptionMacro("Transform expected " << numberOfParameters << " parameters but only " << numberOfInParams << " are provided!");
         }
 
-      // let the itk::Array class hold a reference to the input vector
+      // let the itk::Array class hold a reference to the input buffer
       itk::TransformBase::ParametersType p;
-      p.SetData( const_cast<double*>(&inParams[0]), numberOfParameters, false );
+      p.SetData( const_cast<double*>(inParams), numberOfParameters, false );
       this->GetTransformBase()->SetParameters( p );
     }
   std::vector< double > GetParameters( void ) const
@@ -121,6 +128,12 @@ public:
       const itk::TransformBase::ParametersType &p = this->GetTransformBase()->GetParameters();
       return std::vector< double >( p.begin(), p.end() );
     }
+  // The parameters of the ITK transform, which are the coefficients
+  // of the transforms with local support.
+  const double *GetParametersPointer( void ) const
+    {
+      return this->GetTransformBase()->GetParameters().data_block();
+    }
 
 
   virtual PimpleTransformBase *ShallowCopy( void ) const = 0;
@@ -157,6 +170,8 @@ public:
 
   virtual std::vector< double > TransformPoint( const std::vector< double > &t ) const = 0;
 
+  virtual std::vector< double > TransformPoints( const std::vector< double > &pts, unsigned int numberOfThreads ) const = 0;
+
 protected:
 
 };
@@ -371,6 +386,65 @@ public:
       return sitkITKVectorToSTL<double>( opt );
     }
 
+  struct TransformPointsThreadStruct
+  {
+    const TransformType *m_Transform;
+    const double *m_Input;
+    double *m_Output;
+    size_t m_NumberOfPoints;
+  };
+
+  static ITK_THREAD_RETURN_TYPE TransformPointsThreaderCallback( void *arg )
+    {
+      typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+      ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+      const TransformPointsThreadStruct *str = static_cast<const TransformPointsThreadStruct *>( info->UserData );
+
+      // each thread transforms a contiguous range of points
+      const size_t numberOfThreads = info->NumberOfThreads;
+      const size_t begin = str->m_NumberOfPoints * info->ThreadID / numberOfThreads;
+      const size_t end = str->m_NumberOfPoints * ( info->ThreadID + 1 ) / numberOfThreads;
+
+      typename TransformType::InputPointType ipt;
+      for ( size_t p = begin; p < end; ++p )
+        {
+        const double *in = str->m_Input + p * InputDimension;
+        std::copy( in, in + InputDimension, ipt.Begin() );
+        const typename TransformType::OutputPointType opt = str->m_Transform->TransformPoint( ipt );
+        std::copy( opt.Begin(), opt.End(), str->m_Output + p * OutputDimension );
+        }
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+  virtual std::vector< double > TransformPoints( const std::vector< double > &pts, unsigned int numberOfThreads ) const
+    {
+      if ( pts.size() % InputDimension != 0 )
+        {
+        sitkExceptionMacro( "The length of the points " << pts.size()
+                            << " is not a multiple of the transform dimension " << InputDimension << "!" );
+        }
+
+      TransformPointsThreadStruct str;
+      str.m_NumberOfPoints = pts.size() / InputDimension;
+
+      std::vector< double > output( str.m_NumberOfPoints * OutputDimension );
+      str.m_Transform = this->m_Transform.GetPointer();
+      str.m_Input = pts.empty() ? SITK_NULLPTR : &pts[0];
+      str.m_Output = output.empty() ? SITK_NULLPTR : &output[0];
+
+      // points fewer than this are transformed by the calling thread
+      const size_t minimumPointsPerThread = 4096;
+      const size_t threads =
+        std::max<size_t>( 1, std::min<size_t>( numberOfThreads, str.m_NumberOfPoints / minimumPointsPerThread ) );
+
+      itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+      threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( threads ) );
+      threader->SetSingleMethod( TransformPointsThreaderCallback, &str );
+      threader->SingleMethodExecute();
+
+      return output;
+    }
+
 private:
 
   TransformPointer m_Transform;
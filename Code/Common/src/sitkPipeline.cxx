@@ -0,0 +1,286 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkPipeline.h"
+#include "sitkProcessObject.h"
+#include "sitkExceptionObject.h"
+
+#include "itkProcessObject.h"
+#include "itkImageBase.h"
+#include "itkImageRegionSplitterSlowDimension.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace itk
+{
+namespace simple
+{
+
+namespace
+{
+
+// Move the origin of an image with a non-zero starting index, so
+// that the index is zero as SimpleITK requires.
+template <unsigned int VImageDimension>
+bool FixNonZeroIndex( itk::DataObject *obj )
+{
+  typedef itk::ImageBase<VImageDimension> ImageBaseType;
+  ImageBaseType *img = dynamic_cast<ImageBaseType *>( obj );
+  if ( img == SITK_NULLPTR )
+    {
+    return false;
+    }
+
+  typename ImageBaseType::RegionType r = img->GetLargestPossibleRegion();
+  typename ImageBaseType::IndexType idx = r.GetIndex();
+
+  for( unsigned int i = 0; i < VImageDimension; ++i )
+    {
+    if ( idx[i] != 0 )
+      {
+      typename ImageBaseType::PointType o;
+      img->TransformIndexToPhysicalPoint( idx, o );
+      img->SetOrigin( o );
+
+      idx.Fill( 0 );
+      r.SetIndex( idx );
+      img->SetRegions( r );
+      break;
+      }
+    }
+  return true;
+}
+
+// Update the placeholder one piece at a time, copying each piece
+// into the result. The placeholder image gives access to the buffer
+// of the output, which holds the buffered region of the last piece.
+template <unsigned int VImageDimension>
+bool StreamedUpdate( itk::DataObject *obj, const Image &placeholder, unsigned int numberOfDivisions, Image &result )
+{
+  typedef itk::ImageBase<VImageDimension> ImageBaseType;
+  typedef typename ImageBaseType::RegionType RegionType;
+  ImageBaseType *img = dynamic_cast<ImageBaseType *>( obj );
+  if ( img == SITK_NULLPTR )
+    {
+    return false;
+    }
+
+  const size_t pixelSize = GetPixelIDValueComponentSize( placeholder.GetPixelID() ) * placeholder.GetNumberOfComponentsPerPixel();
+  if ( pixelSize == 0 )
+    {
+    return false;
+    }
+
+  const RegionType largest = img->GetLargestPossibleRegion();
+
+  result = Image( placeholder.GetSize(), placeholder.GetPixelID(),
+                  placeholder.GetNumberOfComponentsPerPixel(), Image::NoBufferInitialization );
+  result.SetOrigin( placeholder.GetOrigin() );
+  result.SetSpacing( placeholder.GetSpacing() );
+  result.SetDirection( placeholder.GetDirection() );
+  char *destination = static_cast<char *>( result.GetBufferAsVoid() );
+
+  itk::ImageRegionSplitterSlowDimension::Pointer splitter = itk::ImageRegionSplitterSlowDimension::New();
+  const unsigned int numberOfPieces = splitter->GetNumberOfSplits( largest, numberOfDivisions );
+
+  for ( unsigned int piece = 0; piece < numberOfPieces; ++piece )
+    {
+    RegionType region = largest;
+    splitter->GetSplit( piece, numberOfPieces, region );
+
+    img->SetRequestedRegion( region );
+    img->PropagateRequestedRegion();
+    img->UpdateOutputData();
+
+    const RegionType buffered = img->GetBufferedRegion();
+    const char *source = static_cast<const char *>( placeholder.GetBufferAsVoid() );
+
+    // copy the lines along the first axis of the piece
+    const size_t lineBytes = region.GetSize( 0 ) * pixelSize;
+    typename RegionType::IndexType index = region.GetIndex();
+    while ( true )
+      {
+      size_t sourceOffset = 0;
+      size_t destinationOffset = 0;
+      for ( unsigned int d = VImageDimension; d > 0; --d )
+        {
+        sourceOffset = sourceOffset * buffered.GetSize( d - 1 ) + ( index[d-1] - buffered.GetIndex( d - 1 ) );
+        destinationOffset = destinationOffset * largest.GetSize( d - 1 ) + ( index[d-1] - largest.GetIndex( d - 1 ) );
+        }
+      std::memcpy( destination + destinationOffset * pixelSize, source + sourceOffset * pixelSize, lineBytes );
+
+      unsigned int d = 1;
+      for ( ; d < VImageDimension; ++d )
+        {
+        if ( ++index[d] < region.GetIndex( d ) + static_cast<typename RegionType::IndexValueType>( region.GetSize( d ) ) )
+          {
+          break;
+          }
+        index[d] = region.GetIndex( d );
+        }
+      if ( d >= VImageDimension )
+        {
+        break;
+        }
+      }
+    }
+
+  return true;
+}
+
+}
+
+Pipeline::Pipeline()
+  : m_NumberOfStreamDivisions( 1 )
+{
+}
+
+Pipeline::~Pipeline()
+{
+  this->RemoveAllFilters();
+  this->ReleaseProcesses();
+}
+
+void Pipeline::AddFilter( ProcessObject &filter )
+{
+  if ( filter.m_Pipeline == this )
+    {
+    return;
+    }
+  if ( filter.m_Pipeline )
+    {
+    filter.m_Pipeline->RemoveFilter( filter );
+    }
+  filter.m_Pipeline = this;
+  m_Filters.push_back( &filter );
+}
+
+void Pipeline::RemoveFilter( ProcessObject &filter )
+{
+  std::vector<ProcessObject *>::iterator i = std::find( m_Filters.begin(), m_Filters.end(), &filter );
+  if ( i != m_Filters.end() )
+    {
+    filter.m_Pipeline = SITK_NULLPTR;
+    m_Filters.erase( i );
+    }
+}
+
+void Pipeline::RemoveAllFilters()
+{
+  for ( size_t i = 0; i < m_Filters.size(); ++i )
+    {
+    m_Filters[i]->m_Pipeline = SITK_NULLPTR;
+    }
+  m_Filters.clear();
+}
+
+unsigned int Pipeline::GetNumberOfFilters() const
+{
+  return static_cast<unsigned int>( m_Filters.size() );
+}
+
+unsigned int Pipeline::GetNumberOfProcesses() const
+{
+  return static_cast<unsigned int>( m_Processes.size() );
+}
+
+void Pipeline::SetNumberOfStreamDivisions( unsigned int n )
+{
+  m_NumberOfStreamDivisions = std::max( n, 1u );
+}
+
+unsigned int Pipeline::GetNumberOfStreamDivisions() const
+{
+  return m_NumberOfStreamDivisions;
+}
+
+Image Pipeline::Update( const Image &image )
+{
+  // The const method is used to not make a copy of the placeholder.
+  itk::DataObject *output = const_cast<itk::DataObject *>( image.GetITKBase() );
+
+  if ( output->GetSource().IsNull() )
+    {
+    return image;
+    }
+
+  output->UpdateOutputInformation();
+
+  if ( m_NumberOfStreamDivisions > 1 )
+    {
+    Image result;
+    if ( StreamedUpdate<2>( output, image, m_NumberOfStreamDivisions, result )
+         || StreamedUpdate<3>( output, image, m_NumberOfStreamDivisions, result )
+         || StreamedUpdate<4>( output, image, m_NumberOfStreamDivisions, result ) )
+      {
+      return result;
+      }
+    }
+
+  output->SetRequestedRegionToLargestPossibleRegion();
+  output->PropagateRequestedRegion();
+  output->UpdateOutputData();
+
+  // the filter creates a new output, so the pixels are not modified
+  // by later updates of the pipeline
+  output->DisconnectPipeline();
+
+  if ( !FixNonZeroIndex<2>( output ) && !FixNonZeroIndex<3>( output ) )
+    {
+    FixNonZeroIndex<4>( output );
+    }
+
+  return image;
+}
+
+void Pipeline::ReleaseProcesses()
+{
+  for ( size_t i = 0; i < m_Processes.size(); ++i )
+    {
+    m_Processes[i]->UnRegister();
+    }
+  m_Processes.clear();
+}
+
+std::string Pipeline::ToString() const
+{
+  std::ostringstream out;
+  out << "itk::simple::Pipeline" << std::endl;
+  out << "  NumberOfStreamDivisions: " << m_NumberOfStreamDivisions << std::endl;
+  out << "  Filters:" << ( m_Filters.empty() ? " (none)" : "" ) << std::endl;
+  for ( size_t i = 0; i < m_Filters.size(); ++i )
+    {
+    out << "    " << m_Filters[i]->GetName() << std::endl;
+    }
+  out << "  Processes:" << ( m_Processes.empty() ? " (none)" : "" ) << std::endl;
+  for ( size_t i = 0; i < m_Processes.size(); ++i )
+    {
+    out << "    " << m_Processes[i]->GetNameOfClass() << std::endl;
+    }
+  return out.str();
+}
+
+void Pipeline::AddProcess( itk::ProcessObject *p )
+{
+  p->Register();
+  m_Processes.push_back( p );
+}
+
+}
+}
@@ -274,5 +274,57 @@ std::ostream& operator<<(std::ostream& os, const PixelIDValueEnum id)
 }
 
 
+namespace
+{
+
+template <typename TPixelIDType> struct PixelIDComponentSize;
+
+template <typename TPixelType>
+struct PixelIDComponentSize< BasicPixelID<TPixelType> >
+{
+  enum { Result = sizeof(TPixelType) };
+};
+
+template <typename TPixelType>
+struct PixelIDComponentSize< VectorPixelID<TPixelType> >
+{
+  enum { Result = sizeof(TPixelType) };
+};
+
+template <typename TLabelType>
+struct PixelIDComponentSize< LabelPixelID<TLabelType> >
+{
+  enum { Result = 0 };
+};
+
+struct ComponentSizeVisitor
+{
+  PixelIDValueType  m_PixelID;
+  unsigned int     *m_Size;
+
+  template <class TPixelIDType>
+  void operator() ( void ) const
+    {
+      if ( int( PixelIDToPixelIDValue<TPixelIDType>::Result ) == m_PixelID )
+        {
+        *this->m_Size = PixelIDComponentSize<TPixelIDType>::Result;
+        }
+    }
+};
+
+}
+
+unsigned int GetPixelIDValueComponentSize( PixelIDValueType type )
+{
+  unsigned int size = 0;
+  ComponentSizeVisitor visitor;
+  visitor.m_PixelID = type;
+  visitor.m_Size = &size;
+  typelist::Visit<InstantiatedPixelIDTypeList> visitAllPixelTypes;
+  visitAllPixelTypes( visitor );
+  return size;
+}
+
+
 }
 }
@@ -17,13 +17,36 @@
 *=========================================================================*/
 #include "sitkProcessObject.h"
 #include "sitkCommand.h"
+#include "sitkPipeline.h"
+
+#include "sitkPixelIDTypeLists.h"
+#include "sitkPixelIDTypes.h"
+#include "sitkPixelIDValues.h"
 
 #include "itkProcessObject.h"
 #include "itkCommand.h"
 #include "itkImageToImageFilter.h"
+#include "itkVectorImage.h"
+#include "itkLabelMap.h"
+#include "itkLabelObject.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkMutexLockHolder.h"
+#include <itksys/SystemInformation.hxx>
+#include <itksys/SystemTools.hxx>
+
+#if defined(_WIN32)
+#include "itkWindows.h"
+#else
+#include <pthread.h>
+#endif
 
 #include <iostream>
 #include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <map>
+#include <limits>
+#include <sstream>
 
 #include "nsstd/functional.h"
 
@@ -48,6 +71,8 @@ static itk::MultiResolutionIterationEvent eventMultiResolutionIterationEvent;
 // Local class to adapt a sitk::Command to ITK's command.
 // It utilizes a raw pointer, and relies on the sitk
 // ProcessObject<->Command reference to automatically remove it.
+// The progress events are throttled by the settings of the process
+// object, which also removes the command before it is destroyed.
 class SimpleAdaptorCommand
   : public itk::Command
 {
@@ -65,19 +90,21 @@ public:
       m_That=cmd;
     }
 
+  void SetProgressThrottle( const itk::simple::ProcessObject *po )
+    {
+      m_ThrottleProcess=po;
+    }
+
   /**  Invoke the member function. */
-  virtual void Execute(Object *, const EventObject & ) SITK_OVERRIDE
+  virtual void Execute(Object *caller, const EventObject &event ) SITK_OVERRIDE
   {
-    if (m_That)
-      {
-      m_That->Execute();
-      }
+    this->Execute( const_cast<const Object *>( caller ), event );
   }
 
   /**  Invoke the member function with a const object */
-  virtual void Execute(const Object *, const EventObject & ) SITK_OVERRIDE
+  virtual void Execute(const Object *caller, const EventObject & ) SITK_OVERRIDE
   {
-    if ( m_That )
+    if ( m_That && this->IsProgressReported( caller ) )
       {
       m_That->Execute();
       }
@@ -85,14 +112,502 @@ public:
 
 protected:
   itk::simple::Command *                    m_That;
-  SimpleAdaptorCommand():m_That(0) {}
+  const itk::simple::ProcessObject *        m_ThrottleProcess;
+  float                                     m_LastProgress;
+  double                                    m_LastProgressTime;
+  SimpleAdaptorCommand():m_That(0), m_ThrottleProcess(0), m_LastProgress(-1.0f), m_LastProgressTime(0.0) {}
   virtual ~SimpleAdaptorCommand() {}
 
+  // The first and last progress of an update are always reported,
+  // otherwise the progress must have increased by the minimum delta
+  // and the minimum interval must have elapsed since the last one.
+  bool IsProgressReported( const Object *caller )
+    {
+      const itk::ProcessObject *p = dynamic_cast<const itk::ProcessObject *>( caller );
+      if ( !m_ThrottleProcess || !p )
+        {
+        return true;
+        }
+
+      const float  minimumDelta = m_ThrottleProcess->GetProgressMinimumDelta();
+      const double minimumInterval = m_ThrottleProcess->GetProgressMinimumInterval();
+      if ( minimumDelta <= 0.0f && minimumInterval <= 0.0 )
+        {
+        return true;
+        }
+
+      const float  progress = p->GetProgress();
+      const double now = itksys::SystemTools::GetTime();
+      if ( progress < m_LastProgress || progress >= 1.0f ||
+           ( progress - m_LastProgress >= minimumDelta && now - m_LastProgressTime >= minimumInterval ) )
+        {
+        m_LastProgress = progress;
+        m_LastProgressTime = now;
+        return true;
+        }
+      return false;
+    }
+
 private:
   SimpleAdaptorCommand(const Self &); //purposely not implemented
   void operator=(const Self &);        //purposely not implemented
 };
 
+
+typedef itk::MutexLockHolder<itk::SimpleFastMutexLock> MutexHolderType;
+
+// The native identifier of the calling thread
+#if defined(_WIN32)
+typedef DWORD NativeThreadType;
+NativeThreadType GetNativeThread( void ) { return GetCurrentThreadId(); }
+bool IsSameNativeThread( NativeThreadType a, NativeThreadType b ) { return a == b; }
+#else
+typedef pthread_t NativeThreadType;
+NativeThreadType GetNativeThread( void ) { return pthread_self(); }
+bool IsSameNativeThread( NativeThreadType a, NativeThreadType b ) { return pthread_equal( a, b ) != 0; }
+#endif
+
+// An update of an ITK filter, or a level of a multi-resolution
+// registration, recorded by the instrumentation
+struct ExecutionRecord
+{
+  std::string               m_Filter;
+  // the level of a registration, or -1 for the whole update
+  int                       m_Level;
+  // the wall time of the start in seconds, and the index of the
+  // calling thread in the order of the first record
+  double                    m_StartTime;
+  unsigned int              m_Thread;
+  std::string               m_ITKFilter;
+  std::string               m_PixelType;
+  std::vector<unsigned int> m_Size;
+  unsigned int              m_NumberOfThreads;
+  double                    m_WallTime;
+  double                    m_CPUTime;
+  uint64_t                  m_OutputBytes;
+  int64_t                   m_MemoryChange;
+};
+
+// The records of a filter added together
+struct ExecutionSummary
+{
+  ExecutionSummary() : m_Count(0), m_WallTime(0.0), m_CPUTime(0.0), m_OutputBytes(0),
+                       m_MaximumMemoryChange(std::numeric_limits<int64_t>::min()) {}
+  uint64_t m_Count;
+  double   m_WallTime;
+  double   m_CPUTime;
+  uint64_t m_OutputBytes;
+  int64_t  m_MaximumMemoryChange;
+};
+
+struct InstrumentationLog
+{
+  InstrumentationLog( void ) : m_Enabled( false ) {}
+
+  itk::SimpleFastMutexLock      m_Mutex;
+  bool                          m_Enabled;
+  std::vector<ExecutionRecord>  m_Records;
+  std::vector<NativeThreadType> m_Threads;
+
+  // Add a record for the calling thread, the mutex must not be held
+  void Add( ExecutionRecord &record )
+    {
+      const NativeThreadType thread = GetNativeThread();
+      MutexHolderType lock( m_Mutex );
+      record.m_Thread = 0;
+      while ( record.m_Thread < m_Threads.size() && !IsSameNativeThread( m_Threads[record.m_Thread], thread ) )
+        {
+        ++record.m_Thread;
+        }
+      if ( record.m_Thread == m_Threads.size() )
+        {
+        m_Threads.push_back( thread );
+        }
+      m_Records.push_back( record );
+    }
+};
+
+// The log is intentionally never destroyed, so that filters
+// executed during static destruction may still be recorded.
+InstrumentationLog &GetInstrumentationLog( void )
+{
+  static InstrumentationLog *log = new InstrumentationLog;
+  return *log;
+}
+
+// The memory used by the process in bytes, 0 if unknown
+int64_t GetProcessMemoryUsed( void )
+{
+  itksys::SystemInformation systemInformation;
+  const long long used = systemInformation.GetProcMemoryUsed();
+  return used > 0 ? static_cast<int64_t>( used ) * 1024 : 0;
+}
+
+template <class TImageType>
+uint64_t GetBufferBytes( const TImageType *image )
+{
+  typedef typename TImageType::PixelContainer::Element ElementType;
+  return static_cast<uint64_t>( image->GetPixelContainer()->Size() ) * sizeof( ElementType );
+}
+
+template <class TLabelObjectType>
+uint64_t GetBufferBytes( const itk::LabelMap<TLabelObjectType> * )
+{
+  // the runs of a label map are not in one buffer
+  return 0;
+}
+
+// Find the SimpleITK pixel type of an output by trying the image types
+// of all the pixel types.
+struct OutputImageVisitor
+{
+  const itk::DataObject *m_Output;
+  ExecutionRecord       *m_Record;
+
+  template <class TPixelIDType>
+  void operator() ( void ) const
+    {
+      this->VisitDimension< TPixelIDType, 2 >();
+      this->VisitDimension< TPixelIDType, 3 >();
+#ifdef SITK_4D_IMAGES
+      this->VisitDimension< TPixelIDType, 4 >();
+#endif
+    }
+
+  template <class TPixelIDType, unsigned int VImageDimension>
+  void VisitDimension( void ) const
+    {
+      typedef typename PixelIDToImageType<TPixelIDType, VImageDimension>::ImageType ImageType;
+
+      const ImageType *image = dynamic_cast<const ImageType *>( this->m_Output );
+      if ( image == SITK_NULLPTR )
+        {
+        return;
+        }
+      this->m_Record->m_PixelType = GetPixelIDValueAsString( PixelIDToPixelIDValue<TPixelIDType>::Result );
+      const typename ImageType::SizeType size = image->GetLargestPossibleRegion().GetSize();
+      this->m_Record->m_Size.assign( size.m_Size, size.m_Size + VImageDimension );
+      this->m_Record->m_OutputBytes = GetBufferBytes( image );
+    }
+};
+
+
+// Observe the end of the update of an ITK filter, and record the
+// execution since the last start. The levels of a multi-resolution
+// registration are recorded from their iteration events.
+class InstrumentationCommand
+  : public itk::Command
+{
+public:
+
+  typedef InstrumentationCommand Self;
+  typedef SmartPointer< Self >   Pointer;
+
+  itkNewMacro(Self);
+
+  itkTypeMacro(InstrumentationCommand, Command);
+
+  void Start( const std::string &filterName )
+    {
+      m_FilterName = filterName;
+      m_Level = -1;
+      m_WallTime = itksys::SystemTools::GetTime();
+      m_CPUTime = std::clock();
+      m_Memory = GetProcessMemoryUsed();
+      m_Started = true;
+    }
+
+  virtual void Execute(Object *caller, const EventObject &event ) SITK_OVERRIDE
+  {
+    this->Execute( const_cast<const Object *>( caller ), event );
+  }
+
+  virtual void Execute(const Object *caller, const EventObject &event ) SITK_OVERRIDE
+  {
+    if ( !m_Started || !GetInstrumentationLog().m_Enabled )
+      {
+      return;
+      }
+
+    const itk::ProcessObject *p = dynamic_cast<const itk::ProcessObject *>( caller );
+    if ( p )
+      {
+      m_ITKFilter = p->GetNameOfClass();
+      m_NumberOfThreads = p->GetNumberOfThreads();
+      }
+
+    const itk::MultiResolutionIterationEvent levelEvent;
+    if ( levelEvent.CheckEvent( &event ) )
+      {
+      this->EndLevel();
+      m_LevelStartTime = itksys::SystemTools::GetTime();
+      m_LevelCPUTime = std::clock();
+      m_LevelMemory = GetProcessMemoryUsed();
+      ++m_Level;
+      return;
+      }
+    this->EndLevel();
+
+    ExecutionRecord record;
+    record.m_Filter = m_FilterName;
+    record.m_Level = -1;
+    record.m_StartTime = m_WallTime;
+    record.m_WallTime = itksys::SystemTools::GetTime() - m_WallTime;
+    record.m_CPUTime = double( std::clock() - m_CPUTime ) / CLOCKS_PER_SEC;
+    record.m_MemoryChange = GetProcessMemoryUsed() - m_Memory;
+    record.m_ITKFilter = m_ITKFilter;
+    record.m_NumberOfThreads = m_NumberOfThreads;
+    record.m_OutputBytes = 0;
+
+    if ( p )
+      {
+      itk::ProcessObject::DataObjectPointerArray outputs = const_cast<itk::ProcessObject *>( p )->GetOutputs();
+      if ( !outputs.empty() && outputs[0].IsNotNull() )
+        {
+        OutputImageVisitor visitor;
+        visitor.m_Output = outputs[0].GetPointer();
+        visitor.m_Record = &record;
+        typelist::Visit<InstantiatedPixelIDTypeList> visitAllPixelTypes;
+        visitAllPixelTypes( visitor );
+        }
+      }
+
+    GetInstrumentationLog().Add( record );
+
+    // the next piece of a streamed filter is timed from now
+    this->Start( m_FilterName );
+  }
+
+protected:
+  InstrumentationCommand()
+    : m_Level(-1), m_NumberOfThreads(0),
+      m_WallTime(0.0), m_CPUTime(0), m_Memory(0),
+      m_LevelStartTime(0.0), m_LevelCPUTime(0), m_LevelMemory(0),
+      m_Started(false) {}
+  virtual ~InstrumentationCommand() {}
+
+private:
+  InstrumentationCommand(const Self &); //purposely not implemented
+  void operator=(const Self &);          //purposely not implemented
+
+  // Record the current level of a registration, if any
+  void EndLevel( void )
+    {
+      if ( m_Level < 0 )
+        {
+        return;
+        }
+      ExecutionRecord record;
+      record.m_Filter = m_FilterName;
+      record.m_ITKFilter = m_ITKFilter;
+      record.m_Level = m_Level;
+      record.m_NumberOfThreads = m_NumberOfThreads;
+      record.m_StartTime = m_LevelStartTime;
+      record.m_WallTime = itksys::SystemTools::GetTime() - m_LevelStartTime;
+      record.m_CPUTime = double( std::clock() - m_LevelCPUTime ) / CLOCKS_PER_SEC;
+      record.m_MemoryChange = GetProcessMemoryUsed() - m_LevelMemory;
+      record.m_OutputBytes = 0;
+      GetInstrumentationLog().Add( record );
+    }
+
+  std::string  m_FilterName;
+  std::string  m_ITKFilter;
+  int          m_Level;
+  unsigned int m_NumberOfThreads;
+  double       m_WallTime;
+  std::clock_t m_CPUTime;
+  int64_t      m_Memory;
+  double       m_LevelStartTime;
+  std::clock_t m_LevelCPUTime;
+  int64_t      m_LevelMemory;
+  bool         m_Started;
+};
+
+
+// The threads of the process shared by the concurrently executing
+// filters. The threads of a filter are reserved in PreUpdate, and
+// released at the end of its update or at its deletion.
+struct ThreadBudget
+{
+  ThreadBudget( void ) : m_Budget( 0 ), m_InUse( 0 ) {}
+
+  itk::SimpleFastMutexLock                      m_Mutex;
+  unsigned int                                  m_Budget;
+  unsigned int                                  m_InUse;
+  std::map<const itk::Object *, unsigned int>   m_Reservations;
+
+  // Reserve the threads of a filter, returns the number of threads
+  // granted. Without a budget nothing is reserved and the requested
+  // threads are granted.
+  unsigned int Acquire( const itk::Object *p, unsigned int requested, bool &reserved )
+    {
+      MutexHolderType lock( m_Mutex );
+      this->ReleaseLocked( p );
+      reserved = ( m_Budget != 0 );
+      if ( !reserved )
+        {
+        return requested;
+        }
+
+      // a fair share with the executing filters, in the threads left
+      const unsigned int share = ( m_Budget + m_Reservations.size() ) / ( m_Reservations.size() + 1 );
+      const unsigned int left = m_Budget > m_InUse ? m_Budget - m_InUse : 0;
+      const unsigned int granted = std::max( 1u, std::min( requested, std::min( share, left ) ) );
+
+      m_Reservations[p] = granted;
+      m_InUse += granted;
+      return granted;
+    }
+
+  void Release( const itk::Object *p )
+    {
+      MutexHolderType lock( m_Mutex );
+      this->ReleaseLocked( p );
+    }
+
+private:
+  void ReleaseLocked( const itk::Object *p )
+    {
+      std::map<const itk::Object *, unsigned int>::iterator i = m_Reservations.find( p );
+      if ( i != m_Reservations.end() )
+        {
+        m_InUse -= i->second;
+        m_Reservations.erase( i );
+        }
+    }
+};
+
+ThreadBudget &GetThreadBudget( void )
+{
+  static ThreadBudget *budget = new ThreadBudget;
+  return *budget;
+}
+
+// Release the threads of a filter at the end of its update, or at its
+// deletion if the update failed.
+class ThreadBudgetCommand
+  : public itk::Command
+{
+public:
+
+  typedef ThreadBudgetCommand  Self;
+  typedef SmartPointer< Self > Pointer;
+
+  itkNewMacro(Self);
+
+  itkTypeMacro(ThreadBudgetCommand, Command);
+
+  virtual void Execute(Object *caller, const EventObject & ) SITK_OVERRIDE
+  {
+    GetThreadBudget().Release( caller );
+  }
+
+  virtual void Execute(const Object *caller, const EventObject & ) SITK_OVERRIDE
+  {
+    GetThreadBudget().Release( caller );
+  }
+
+protected:
+  ThreadBudgetCommand() {}
+  virtual ~ThreadBudgetCommand() {}
+
+private:
+  ThreadBudgetCommand(const Self &); //purposely not implemented
+  void operator=(const Self &);       //purposely not implemented
+};
+
+
+// Keep the ITK filter executing with a cancellation token registered
+// in the token until the end of its update. The abort request is
+// applied again when the update starts and at each progress, since
+// ITK clears it when starting the update. The outputs are released
+// when the filter is aborted.
+class CancellationCommand
+  : public itk::Command
+{
+public:
+
+  typedef CancellationCommand  Self;
+  typedef SmartPointer< Self > Pointer;
+
+  itkNewMacro(Self);
+
+  itkTypeMacro(CancellationCommand, Command);
+
+  void SetToken( const CancellationToken &token ) { m_Token = token; }
+  const CancellationToken &GetToken( void ) const { return m_Token; }
+
+  virtual void Execute(Object *caller, const EventObject &event ) SITK_OVERRIDE
+  {
+    itk::ProcessObject *p = dynamic_cast<itk::ProcessObject *>( caller );
+    if ( !p )
+      {
+      return;
+      }
+
+    if ( itk::StartEvent().CheckEvent( &event ) || itk::ProgressEvent().CheckEvent( &event ) )
+      {
+      if ( m_Token.IsCancelled() )
+        {
+        p->AbortGenerateDataOn();
+        }
+      return;
+      }
+
+    if ( itk::AbortEvent().CheckEvent( &event ) )
+      {
+      const itk::ProcessObject::DataObjectPointerArray outputs = p->GetOutputs();
+      for ( size_t i = 0; i < outputs.size(); ++i )
+        {
+        if ( outputs[i].IsNotNull() )
+          {
+          outputs[i]->ReleaseData();
+          }
+        }
+      }
+
+    m_Token.RemoveActiveProcess( p );
+  }
+
+  virtual void Execute(const Object *caller, const EventObject & ) SITK_OVERRIDE
+  {
+    const itk::ProcessObject *p = dynamic_cast<const itk::ProcessObject *>( caller );
+    if ( p )
+      {
+      m_Token.RemoveActiveProcess( p );
+      }
+  }
+
+protected:
+  CancellationCommand() {}
+  virtual ~CancellationCommand() {}
+
+private:
+  CancellationCommand(const Self &); //purposely not implemented
+  void operator=(const Self &);       //purposely not implemented
+
+  CancellationToken m_Token;
+};
+
+
+// Escape a string for JSON
+std::string EscapeJSON( const std::string &s )
+{
+  std::string out;
+  for ( std::string::const_iterator i = s.begin(); i != s.end(); ++i )
+    {
+    if ( *i == '"' || *i == '\\' )
+      {
+      out += '\\';
+      }
+    if ( static_cast<unsigned char>( *i ) >= 0x20 )
+      {
+      out += *i;
+      }
+    }
+  return out;
+}
+
 } // end anonymous namespace
 
 //----------------------------------------------------------------------------
@@ -103,8 +618,22 @@ private:
 ProcessObject::ProcessObject ()
   : m_Debug(ProcessObject::GetGlobalDefaultDebug()),
     m_NumberOfThreads(ProcessObject::GetGlobalDefaultNumberOfThreads()),
+    m_NumberOfStreamDivisions(1),
+    m_PersistentITKFilter(false),
+    m_PersistentProcess(NULL),
+    m_DestinationImage(NULL),
+    m_Pipeline(NULL),
+    m_ThreadBudgetProcess(NULL),
+    m_ThreadBudgetTag(0),
+    m_InstrumentedProcess(NULL),
+    m_InstrumentationTag(0),
+    m_CancellationToken(NULL),
+    m_CancellationProcess(NULL),
+    m_CancellationTag(0),
     m_ActiveProcess(NULL),
-    m_ProgressMeasurement(0.0)
+    m_ProgressMeasurement(0.0),
+    m_ProgressMinimumDelta(0.0f),
+    m_ProgressMinimumInterval(0.0)
 {
 }
 
@@ -116,6 +645,15 @@ ProcessObject::~ProcessObject ()
 {
   // ensure to remove reference between sitk commands and process object
   Self::RemoveAllCommands();
+
+  if ( this->m_Pipeline )
+    {
+    this->m_Pipeline->RemoveFilter(*this);
+    }
+
+  this->SetPersistentProcess( NULL );
+
+  delete this->m_CancellationToken;
 }
 
 std::string ProcessObject::ToString() const
@@ -128,6 +666,12 @@ std::string ProcessObject::ToString() const
   out << "  NumberOfThreads: ";
   this->ToStringHelper(out, this->m_NumberOfThreads) << std::endl;
 
+  out << "  NumberOfStreamDivisions: ";
+  this->ToStringHelper(out, this->m_NumberOfStreamDivisions) << std::endl;
+
+  out << "  PersistentITKFilter: ";
+  this->ToStringHelper(out, this->m_PersistentITKFilter) << std::endl;
+
   out << "  Commands:" << (m_Commands.empty()?" (none)":"") << std::endl;
   for( std::list<EventCommand>::const_iterator i = m_Commands.begin();
        i != m_Commands.end();
@@ -140,6 +684,12 @@ std::string ProcessObject::ToString() const
   out << "  ProgressMeasurement: ";
   this->ToStringHelper(out, this->m_ProgressMeasurement) << std::endl;
 
+  out << "  ProgressMinimumDelta: ";
+  this->ToStringHelper(out, this->m_ProgressMinimumDelta) << std::endl;
+
+  out << "  ProgressMinimumInterval: ";
+  this->ToStringHelper(out, this->m_ProgressMinimumInterval) << std::endl;
+
   out << "  ActiveProcess:" << (this->m_ActiveProcess?"":" (none)") <<std::endl;
   if( this->m_ActiveProcess )
     {
@@ -265,6 +815,174 @@ void ProcessObject::SetGlobalDefaultDirectionTolerance(double tolerance)
 }
 
 
+void ProcessObject::GlobalInstrumentationOn()
+{
+  ProcessObject::SetGlobalInstrumentation(true);
+}
+
+
+void ProcessObject::GlobalInstrumentationOff()
+{
+  ProcessObject::SetGlobalInstrumentation(false);
+}
+
+
+void ProcessObject::SetGlobalInstrumentation(bool flag)
+{
+  InstrumentationLog &log = GetInstrumentationLog();
+  MutexHolderType lock( log.m_Mutex );
+  log.m_Enabled = flag;
+}
+
+
+bool ProcessObject::GetGlobalInstrumentation()
+{
+  return GetInstrumentationLog().m_Enabled;
+}
+
+
+std::string ProcessObject::GetGlobalInstrumentationLog()
+{
+  InstrumentationLog &log = GetInstrumentationLog();
+  MutexHolderType lock( log.m_Mutex );
+
+  std::ostringstream out;
+  out << "Filter,ITKFilter,PixelType,Size,NumberOfThreads,WallTime,CPUTime,OutputBytes,MemoryChange" << std::endl;
+  for ( size_t i = 0; i < log.m_Records.size(); ++i )
+    {
+    const ExecutionRecord &record = log.m_Records[i];
+    if ( record.m_Level >= 0 )
+      {
+      continue;
+      }
+    out << record.m_Filter << "," << record.m_ITKFilter << "," << record.m_PixelType << ",";
+    for ( size_t d = 0; d < record.m_Size.size(); ++d )
+      {
+      out << ( d ? "x" : "" ) << record.m_Size[d];
+      }
+    out << "," << record.m_NumberOfThreads
+        << "," << record.m_WallTime
+        << "," << record.m_CPUTime
+        << "," << record.m_OutputBytes
+        << "," << record.m_MemoryChange << std::endl;
+    }
+  return out.str();
+}
+
+
+std::string ProcessObject::GetGlobalInstrumentationSummary()
+{
+  std::map<std::string, ExecutionSummary> summaries;
+  {
+  InstrumentationLog &log = GetInstrumentationLog();
+  MutexHolderType lock( log.m_Mutex );
+  for ( size_t i = 0; i < log.m_Records.size(); ++i )
+    {
+    const ExecutionRecord &record = log.m_Records[i];
+    if ( record.m_Level >= 0 )
+      {
+      continue;
+      }
+    ExecutionSummary &summary = summaries[record.m_Filter];
+    ++summary.m_Count;
+    summary.m_WallTime += record.m_WallTime;
+    summary.m_CPUTime += record.m_CPUTime;
+    summary.m_OutputBytes += record.m_OutputBytes;
+    summary.m_MaximumMemoryChange = std::max( summary.m_MaximumMemoryChange, record.m_MemoryChange );
+    }
+  }
+
+  // by decreasing wall time
+  std::vector< std::pair<double, std::string> > order;
+  for ( std::map<std::string, ExecutionSummary>::const_iterator i = summaries.begin(); i != summaries.end(); ++i )
+    {
+    order.push_back( std::make_pair( -i->second.m_WallTime, i->first ) );
+    }
+  std::sort( order.begin(), order.end() );
+
+  std::ostringstream out;
+  out << "Filter,Count,WallTime,CPUTime,OutputBytes,MaximumMemoryChange" << std::endl;
+  for ( size_t i = 0; i < order.size(); ++i )
+    {
+    const ExecutionSummary &summary = summaries[order[i].second];
+    out << order[i].second
+        << "," << summary.m_Count
+        << "," << summary.m_WallTime
+        << "," << summary.m_CPUTime
+        << "," << summary.m_OutputBytes
+        << "," << summary.m_MaximumMemoryChange << std::endl;
+    }
+  return out.str();
+}
+
+
+std::string ProcessObject::GetGlobalInstrumentationTrace()
+{
+  itksys::SystemInformation systemInformation;
+  const long long processId = systemInformation.GetProcessId();
+
+  InstrumentationLog &log = GetInstrumentationLog();
+  MutexHolderType lock( log.m_Mutex );
+
+  std::ostringstream out;
+  out.precision( 17 );
+  out << "{\"traceEvents\":[";
+  for ( size_t i = 0; i < log.m_Records.size(); ++i )
+    {
+    const ExecutionRecord &record = log.m_Records[i];
+
+    std::string category = "filter";
+    std::string name = record.m_Filter;
+    if ( record.m_Level >= 0 )
+      {
+      category = "level";
+      std::ostringstream level;
+      level << record.m_Filter << " level " << record.m_Level;
+      name = level.str();
+      }
+    else if ( record.m_ITKFilter.find( "Reader" ) != std::string::npos ||
+              record.m_ITKFilter.find( "Writer" ) != std::string::npos )
+      {
+      category = "io";
+      }
+
+    out << ( i ? ",\n" : "\n" )
+        << "{\"name\":\"" << EscapeJSON( name ) << "\""
+        << ",\"cat\":\"" << category << "\""
+        << ",\"ph\":\"X\""
+        << ",\"ts\":" << record.m_StartTime * 1e6
+        << ",\"dur\":" << record.m_WallTime * 1e6
+        << ",\"pid\":" << processId
+        << ",\"tid\":" << record.m_Thread
+        << ",\"args\":{"
+        << "\"ITKFilter\":\"" << EscapeJSON( record.m_ITKFilter ) << "\""
+        << ",\"PixelType\":\"" << EscapeJSON( record.m_PixelType ) << "\""
+        << ",\"Size\":[";
+    for ( size_t d = 0; d < record.m_Size.size(); ++d )
+      {
+      out << ( d ? "," : "" ) << record.m_Size[d];
+      }
+    out << "]"
+        << ",\"NumberOfThreads\":" << record.m_NumberOfThreads
+        << ",\"CPUTime\":" << record.m_CPUTime
+        << ",\"OutputBytes\":" << record.m_OutputBytes
+        << ",\"MemoryChange\":" << record.m_MemoryChange
+        << "}}";
+    }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return out.str();
+}
+
+
+void ProcessObject::ClearGlobalInstrumentation()
+{
+  InstrumentationLog &log = GetInstrumentationLog();
+  MutexHolderType lock( log.m_Mutex );
+  log.m_Records.clear();
+  log.m_Threads.clear();
+}
+
+
 void ProcessObject::SetGlobalDefaultNumberOfThreads(unsigned int n)
 {
   MultiThreader::SetGlobalDefaultNumberOfThreads(n);
@@ -277,6 +995,68 @@ unsigned int ProcessObject::GetGlobalDefaultNumberOfThreads()
 }
 
 
+void ProcessObject::SetGlobalThreadBudget(unsigned int n)
+{
+  ThreadBudget &budget = GetThreadBudget();
+  MutexHolderType lock( budget.m_Mutex );
+  budget.m_Budget = n;
+}
+
+
+unsigned int ProcessObject::GetGlobalThreadBudget()
+{
+  ThreadBudget &budget = GetThreadBudget();
+  MutexHolderType lock( budget.m_Mutex );
+  return budget.m_Budget;
+}
+
+
+unsigned int ProcessObject::GetGlobalNumberOfReservedThreads()
+{
+  ThreadBudget &budget = GetThreadBudget();
+  MutexHolderType lock( budget.m_Mutex );
+  return budget.m_InUse;
+}
+
+
+bool ProcessObject::SetGlobalDefaultThreader(const std::string &threader)
+{
+  std::string name = threader;
+  std::transform( name.begin(), name.end(), name.begin(), ::toupper );
+
+#if ITK_VERSION_MAJOR >= 5
+  const itk::MultiThreaderBase::ThreaderType type = itk::MultiThreaderBase::ThreaderTypeFromString( name );
+  if ( type == itk::MultiThreaderBase::ThreaderType::Unknown )
+    {
+    return false;
+    }
+  itk::MultiThreaderBase::SetGlobalDefaultThreader( type );
+  return true;
+#elif ( ITK_VERSION_MAJOR*100+ITK_VERSION_MINOR ) >= 410
+  if ( name == "PLATFORM" || name == "POOL" )
+    {
+    MultiThreader::SetGlobalDefaultUseThreadPool( name == "POOL" );
+    return true;
+    }
+  return false;
+#else
+  return name == "PLATFORM";
+#endif
+}
+
+
+std::string ProcessObject::GetGlobalDefaultThreader()
+{
+#if ITK_VERSION_MAJOR >= 5
+  return itk::MultiThreaderBase::ThreaderTypeToString( itk::MultiThreaderBase::GetGlobalDefaultThreader() );
+#elif ( ITK_VERSION_MAJOR*100+ITK_VERSION_MINOR ) >= 410
+  return MultiThreader::GetGlobalDefaultUseThreadPool() ? "POOL" : "PLATFORM";
+#else
+  return "PLATFORM";
+#endif
+}
+
+
 void ProcessObject::SetNumberOfThreads(unsigned int n)
 {
   m_NumberOfThreads = n;
@@ -289,6 +1069,58 @@ unsigned int ProcessObject::GetNumberOfThreads() const
 }
 
 
+void ProcessObject::SetNumberOfStreamDivisions(unsigned int n)
+{
+  m_NumberOfStreamDivisions = std::max(n, 1u);
+}
+
+
+unsigned int ProcessObject::GetNumberOfStreamDivisions() const
+{
+  return m_NumberOfStreamDivisions;
+}
+
+
+void ProcessObject::SetProgressMinimumDelta(float delta)
+{
+  m_ProgressMinimumDelta = std::max(delta, 0.0f);
+}
+
+
+float ProcessObject::GetProgressMinimumDelta() const
+{
+  return m_ProgressMinimumDelta;
+}
+
+
+void ProcessObject::SetProgressMinimumInterval(double seconds)
+{
+  m_ProgressMinimumInterval = std::max(seconds, 0.0);
+}
+
+
+double ProcessObject::GetProgressMinimumInterval() const
+{
+  return m_ProgressMinimumInterval;
+}
+
+
+void ProcessObject::SetPersistentITKFilter(bool persistentITKFilter)
+{
+  m_PersistentITKFilter = persistentITKFilter;
+  if ( !persistentITKFilter )
+    {
+    this->SetPersistentProcess( NULL );
+    }
+}
+
+
+bool ProcessObject::GetPersistentITKFilter() const
+{
+  return m_PersistentITKFilter;
+}
+
+
 int ProcessObject::AddCommand(EventEnum event, Command &cmd)
 {
   // add to our list of event, command pairs
@@ -372,12 +1204,135 @@ void ProcessObject::Abort()
 }
 
 
+void ProcessObject::SetCancellationToken( const CancellationToken &token )
+{
+  if ( this->m_CancellationToken )
+    {
+    *this->m_CancellationToken = token;
+    }
+  else
+    {
+    this->m_CancellationToken = new CancellationToken( token );
+    }
+}
+
+
+void ProcessObject::RemoveCancellationToken()
+{
+  delete this->m_CancellationToken;
+  this->m_CancellationToken = NULL;
+}
+
+
+bool ProcessObject::HasCancellationToken() const
+{
+  return this->m_CancellationToken != NULL;
+}
+
+
+CancellationToken ProcessObject::GetCancellationToken() const
+{
+  if ( !this->m_CancellationToken )
+    {
+    sitkExceptionMacro( "No cancellation token is set." );
+    }
+  return *this->m_CancellationToken;
+}
+
+
 void ProcessObject::PreUpdate(itk::ProcessObject *p)
 {
   assert(p);
 
-  // propagate number of threads
-  p->SetNumberOfThreads(this->GetNumberOfThreads());
+  // propagate number of threads, within the thread budget
+  bool reserved = false;
+  p->SetNumberOfThreads( GetThreadBudget().Acquire( p, this->GetNumberOfThreads(), reserved ) );
+  if ( reserved )
+    {
+    // a persistent ITK filter keeps its observer, also when the
+    // budget was set after its first execution
+    ThreadBudgetCommand *release = SITK_NULLPTR;
+    if ( p == this->m_ThreadBudgetProcess )
+      {
+      release = dynamic_cast<ThreadBudgetCommand *>( p->GetCommand( this->m_ThreadBudgetTag ) );
+      }
+    if ( release == SITK_NULLPTR )
+      {
+      ThreadBudgetCommand::Pointer command = ThreadBudgetCommand::New();
+      this->m_ThreadBudgetTag = p->AddObserver( itk::EndEvent(), command );
+      p->AddObserver( itk::DeleteEvent(), command );
+      this->m_ThreadBudgetProcess = p;
+      }
+    }
+
+  if ( GetInstrumentationLog().m_Enabled )
+    {
+    // a persistent ITK filter keeps its observer
+    InstrumentationCommand *instrumentation = SITK_NULLPTR;
+    if ( p == this->m_InstrumentedProcess )
+      {
+      instrumentation = dynamic_cast<InstrumentationCommand *>( p->GetCommand( this->m_InstrumentationTag ) );
+      }
+    if ( instrumentation == SITK_NULLPTR )
+      {
+      InstrumentationCommand::Pointer command = InstrumentationCommand::New();
+      this->m_InstrumentationTag = p->AddObserver( itk::EndEvent(), command );
+      p->AddObserver( itk::MultiResolutionIterationEvent(), command );
+      this->m_InstrumentedProcess = p;
+      instrumentation = command;
+      }
+    instrumentation->Start( this->GetName() );
+    }
+
+  if ( this->m_CancellationToken )
+    {
+    if ( this->m_CancellationToken->IsCancelled() )
+      {
+      itk::ProcessAborted e( __FILE__, __LINE__ );
+      e.SetLocation( ITK_LOCATION );
+      e.SetDescription( "The execution was cancelled." );
+      throw e;
+      }
+
+    // a persistent ITK filter keeps its observer
+    CancellationCommand *cancellation = SITK_NULLPTR;
+    if ( p == this->m_CancellationProcess )
+      {
+      cancellation = dynamic_cast<CancellationCommand *>( p->GetCommand( this->m_CancellationTag ) );
+      }
+    if ( cancellation == SITK_NULLPTR || cancellation->GetToken() != *this->m_CancellationToken )
+      {
+      if ( cancellation != SITK_NULLPTR )
+        {
+        cancellation->GetToken().RemoveActiveProcess( p );
+
+        // the observers of the previous token were added with
+        // consecutive tags
+        itk::Command::Pointer previous = cancellation;
+        for ( unsigned long tag = this->m_CancellationTag; p->GetCommand( tag ) == previous.GetPointer(); ++tag )
+          {
+          p->RemoveObserver( tag );
+          }
+        }
+      CancellationCommand::Pointer command = CancellationCommand::New();
+      command->SetToken( *this->m_CancellationToken );
+      this->m_CancellationTag = p->AddObserver( itk::StartEvent(), command );
+      p->AddObserver( itk::ProgressEvent(), command );
+      p->AddObserver( itk::EndEvent(), command );
+      p->AddObserver( itk::AbortEvent(), command );
+      p->AddObserver( itk::DeleteEvent(), command );
+      this->m_CancellationProcess = p;
+      }
+    this->m_CancellationToken->AddActiveProcess( p );
+    }
+
+  // A persistent ITK filter executed again is still the active
+  // process, with the commands registered.
+  if ( p == this->m_ActiveProcess )
+    {
+    sitkDebugMacro( "Executing ITK filter:\n" << *p );
+    return;
+    }
 
   try
     {
@@ -408,6 +1363,46 @@ void ProcessObject::PreUpdate(itk::ProcessObject *p)
 }
 
 
+void ProcessObject::AddDeferredProcess(itk::ProcessObject *p)
+{
+  assert(p);
+  assert(this->m_Pipeline);
+
+  sitkDebugMacro( "Deferring ITK filter:\n" << *p );
+
+  this->m_Pipeline->AddProcess(p);
+}
+
+
+itk::ProcessObject *ProcessObject::GetPersistentProcess() const
+{
+  return this->m_PersistentProcess;
+}
+
+
+void ProcessObject::SetPersistentProcess(itk::ProcessObject *p)
+{
+  if ( p == this->m_PersistentProcess )
+    {
+    return;
+    }
+
+  if ( p )
+    {
+    p->Register();
+    }
+
+  // releasing the last reference deletes the filter, and invokes
+  // OnActiveProcessDelete when it is the active process
+  itk::ProcessObject *old = this->m_PersistentProcess;
+  this->m_PersistentProcess = p;
+  if ( old )
+    {
+    old->UnRegister();
+    }
+}
+
+
 unsigned long ProcessObject::AddITKObserver( const itk::EventObject &e,
                                              itk::Command *c)
 {
@@ -521,6 +1516,10 @@ unsigned long ProcessObject::AddObserverToActiveProcessObject( EventCommand &eve
   // adapt sitk command to itk command
   SimpleAdaptorCommand::Pointer itkCommand = SimpleAdaptorCommand::New();
   itkCommand->SetSimpleCommand(eventCommand.m_Command);
+  if ( eventCommand.m_Event == sitkProgressEvent )
+    {
+    itkCommand->SetProgressThrottle(this);
+    }
   itkCommand->SetObjectName(eventCommand.m_Command->GetName()+" "+itkEvent.GetEventName());
 
   return eventCommand.m_ITKTag = this->AddITKObserver( itkEvent, itkCommand );
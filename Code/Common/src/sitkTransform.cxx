@@ -529,6 +529,25 @@ void Transform::SetPimpleTransform( PimpleTransformBase *pimpleTransform )
     return this->m_PimpleTransform->GetParameters();
   }
 
+  unsigned int Transform::GetNumberOfParameters( void ) const
+  {
+    assert( m_PimpleTransform );
+    return this->m_PimpleTransform->GetNumberOfParameters();
+  }
+
+  const double *Transform::GetParametersAsDouble( void ) const
+  {
+    assert( m_PimpleTransform );
+    return this->m_PimpleTransform->GetParametersPointer();
+  }
+
+  void Transform::SetParameters ( const double *parameters, size_t numberOfParameters )
+  {
+    assert( m_PimpleTransform );
+    this->MakeUnique();
+    this->m_PimpleTransform->SetParameters( parameters, numberOfParameters );
+  }
+
   void Transform::SetFixedParameters ( const std::vector<double>& parameters )
   {
     assert( m_PimpleTransform );
@@ -561,6 +580,12 @@ void Transform::SetPimpleTransform( PimpleTransformBase *pimpleTransform )
     return this->m_PimpleTransform->TransformPoint( point );
   }
 
+  std::vector< double > Transform::TransformPoints( const std::vector< double > &points ) const
+  {
+    assert( m_PimpleTransform );
+    return this->m_PimpleTransform->TransformPoints( points, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+  }
+
 
   bool Transform::IsLinear() const
   {
@@ -764,19 +789,38 @@ void Transform::InternalInitialization(TransformType *t)
 
   }
 
-  void Transform::WriteTransform( const std::string &filename ) const
+  void Transform::WriteTransform( const std::string &filename, bool useCompression, bool useSinglePrecision ) const
   {
-    itk::simple::WriteTransform( *this, filename );
+    itk::simple::WriteTransform( *this, filename, useCompression, useSinglePrecision );
   }
 
-  // write
-  void WriteTransform( const Transform &transform, const std::string &filename)
+  namespace
   {
-    itk::TransformFileWriter::Pointer writer = itk::TransformFileWriter::New();
+  // The writer converts the double transforms to the precision of
+  // its parameters.
+  template< typename TParametersValueType >
+  void WriteTransformWithPrecision( const itk::TransformBase *transform, const std::string &filename, bool useCompression )
+  {
+    typedef itk::TransformFileWriterTemplate< TParametersValueType > WriterType;
+    typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName(filename.c_str());
-    writer->SetInput( transform.GetITKBase() );
+    writer->SetInput( transform );
+    writer->SetUseCompression( useCompression );
     writer->Update();
+  }
+  }
 
+  // write
+  void WriteTransform( const Transform &transform, const std::string &filename, bool useCompression, bool useSinglePrecision )
+  {
+    if ( useSinglePrecision )
+      {
+      WriteTransformWithPrecision< float >( transform.GetITKBase(), filename, useCompression );
+      }
+    else
+      {
+      WriteTransformWithPrecision< double >( transform.GetITKBase(), filename, useCompression );
+      }
   }
 
 }
@@ -40,6 +40,12 @@
 #include "sitkExplicitITKImageRegionConstIterator.h"
 #include "sitkExplicitITKImageScanlineConstIterator.h"
 #include "sitkExplicitITKImageScanlineIterator.h"
+#include "sitkExplicitITKImageRegionIterator.h"
+#include "sitkExplicitITKConstNeighborhoodIterator.h"
+
+#include "sitkExplicitITKLinearInterpolateImageFunction.h"
+#include "sitkExplicitITKNearestNeighborInterpolateImageFunction.h"
+#include "sitkExplicitITKBSplineInterpolateImageFunction.h"
 
 #include "sitkExplicitITKImageSource.h"
 #include "sitkExplicitITKImageToImageFilter.h"
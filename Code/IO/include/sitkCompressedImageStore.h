@@ -0,0 +1,157 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkCompressedImageStore_h
+#define sitkCompressedImageStore_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkIO.h"
+#include "sitkNonCopyable.h"
+
+#include <string>
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class CompressedImageStore
+     * \brief Keep images in memory by name, compressing the least
+     * recently used ones.
+     *
+     * The images inserted are kept as they are until the memory used
+     * by the store exceeds the MaximumMemory. The least recently
+     * inserted or taken images are then compressed, in chunks of
+     * ChunkSize bytes compressed with zlib by several threads, and the
+     * uncompressed pixels are released. Label maps and masks often
+     * compress twenty times or more.
+     *
+     \code
+     CompressedImageStore store;
+     store.SetMaximumMemory( 2000000000 );
+     store.Insert( "labels", labels );
+     ...
+     Image labels = store.Get( "labels" );
+     \endcode
+     *
+     * Get decompresses a compressed image, by chunks in several
+     * threads, and keeps it uncompressed as the most recently used.
+     * The compressed chunks are kept with it, so compressing it again
+     * only releases the uncompressed pixels. The image returned shares
+     * its buffer with the store: the pixels are only released when
+     * the caller's image is also destroyed, and modifying the image
+     * returned copies its buffer without modifying the store.
+     *
+     * The pixels, pixel type, size, origin, spacing and direction are
+     * kept, but not the meta-data dictionary. Label map pixel types
+     * are not supported. The store is not safe to use from several
+     * threads at once.
+     *
+     * \sa itk::simple::ExecutionCache
+     */
+    class SITKIO_EXPORT CompressedImageStore
+      : protected NonCopyable
+    {
+    public:
+      typedef CompressedImageStore Self;
+
+      CompressedImageStore();
+      ~CompressedImageStore();
+
+      /** Print ourselves to string */
+      std::string ToString() const;
+
+      /** \brief The budget in bytes of the images in the store, both
+       * uncompressed and compressed.
+       *
+       * The images are never compressed when the budget is 0, the
+       * default. Reducing the budget compresses the images over it.
+       */
+      Self &SetMaximumMemory( uint64_t bytes );
+      uint64_t GetMaximumMemory( ) const;
+
+      /** \brief The zlib compression level, from 1 to 9, by default 1,
+       * the fastest. */
+      Self &SetCompressionLevel( int level );
+      int GetCompressionLevel( ) const;
+
+      /** \brief The number of bytes of the pixels compressed together,
+       * by default 1 MiB, for the images compressed after it is set. */
+      Self &SetChunkSize( unsigned int bytes );
+      unsigned int GetChunkSize( ) const;
+
+      /** \brief The number of threads compressing and decompressing
+       * the chunks, by default the global default of ITK. */
+      Self &SetNumberOfThreads( unsigned int n );
+      unsigned int GetNumberOfThreads( ) const;
+
+      /** \brief Insert an image, replacing the image of the key if
+       * any, as the most recently used. */
+      void Insert( const std::string &key, const Image &image );
+
+      /** \brief Get the image of a key, decompressed if needed, which
+       * becomes the most recently used.
+       *
+       * An exception is thrown if there is no image of the key.
+       */
+      Image Get( const std::string &key );
+
+      /** Returns true if the store has an image of the key. */
+      bool Contains( const std::string &key ) const;
+
+      /** Returns true if the image of the key is only kept
+       * compressed. */
+      bool IsCompressed( const std::string &key ) const;
+
+      /** \brief Compress the image of a key and release its
+       * uncompressed pixels. */
+      void Compress( const std::string &key );
+
+      /** Remove the image of a key, if any. */
+      void Remove( const std::string &key );
+
+      /** Remove all the images. */
+      void Clear( );
+
+      /** The keys of the images, from the most recently used. */
+      std::vector<std::string> GetKeys( ) const;
+
+      unsigned int GetNumberOfImages( ) const;
+
+      /** \brief The bytes of the uncompressed and compressed pixels
+       * kept by the store. */
+      uint64_t GetMemoryUsed( ) const;
+
+      /** \brief The bytes of the compressed chunks kept by the
+       * store. */
+      uint64_t GetCompressedMemory( ) const;
+
+    private:
+
+      struct Implementation;
+      Implementation *m_Implementation;
+
+      uint64_t     m_MaximumMemory;
+      int          m_CompressionLevel;
+      unsigned int m_ChunkSize;
+      unsigned int m_NumberOfThreads;
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,178 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkDistributedTileExecutor_h
+#define sitkDistributedTileExecutor_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkIO.h"
+#include "sitkNonCopyable.h"
+
+#include <string>
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class DistributedTileExecutor
+     * \brief Process an image file too large for one computer in
+     * tiles, on the processes of a cluster.
+     *
+     * The image is divided into tiles of TileSize pixels. Each process
+     * of the cluster, a rank of the Transport, reads its tiles from
+     * the input file with a halo of HaloRadius pixels around them,
+     * processes them with a TileFunction, and writes the tiles without
+     * their halo. The output file is then assembled by rank 0 in the
+     * SimpleITK chunked format, ".sitkc", each tile being one chunk.
+     * The compressed chunks are copied without being decoded, so the
+     * output is never held in memory.
+     *
+     \code
+     class Median : public DistributedTileExecutor::TileFunction
+     {
+     public:
+       Image Execute( const Image &tile ) { return m_Filter.Execute( tile ); }
+       MedianImageFilter m_Filter;
+     };
+
+     Median median;
+     median.m_Filter.SetRadius( 2 );
+
+     DistributedTileExecutor executor;
+     executor.SetTransport( &mpiTransport );
+     executor.SetTileSize( std::vector<unsigned int>( 3, 512 ) );
+     executor.SetHaloRadius( median.m_Filter.GetRadius() );
+     executor.Execute( "brain.sitkc", "brain-median.sitkc", median );
+     \endcode
+     *
+     * When the halo is at least the radius of the neighbourhood of a
+     * filter, such as the Radius of the kernel filters, the pixels of
+     * the tiles are those of the filter run on the whole image. The
+     * halo is clipped to the image, so the boundary conditions at the
+     * edges of the image are unchanged. An iterative filter needs the
+     * radius times the number of iterations.
+     *
+     * The processes share the input and output files, through a
+     * shared or parallel file system, and the halos are read from the
+     * input rather than exchanged between the processes. The input is
+     * read with the ExtractIndex and ExtractSize of the
+     * ImageFileReader, which only decodes the chunks of the tile with
+     * an input in the chunked format.
+     *
+     * The tiles of rank r are r, r + n, r + 2n..., for n ranks. Each
+     * is written to a chunked file named after the output file and
+     * its number, which rank 0 removes after the output is assembled.
+     *
+     * \sa itk::simple::ImageFileReader::SetExtractIndex
+     * \sa itk::simple::ImageFileWriter::SetChunkSize
+     */
+    class SITKIO_EXPORT DistributedTileExecutor
+      : protected NonCopyable
+    {
+    public:
+      typedef DistributedTileExecutor Self;
+
+      /** \class TileFunction
+       * \brief The processing of each tile
+       */
+      class SITKIO_EXPORT TileFunction
+      {
+      public:
+        virtual ~TileFunction() {}
+
+        /** Process a tile with its halo. The image returned must have
+         * the size of the tile, and the same pixel type for all the
+         * tiles. */
+        virtual Image Execute( const Image &tile ) = 0;
+      };
+
+      /** \class Transport
+       * \brief The processes taking part in the execution
+       *
+       * An implementation with MPI returns the rank and size of the
+       * communicator, and calls MPI_Barrier. An exception thrown on a
+       * rank does not reach the others, which wait in Barrier, so
+       * the transport should then abort the job.
+       */
+      class SITKIO_EXPORT Transport
+      {
+      public:
+        virtual ~Transport() {}
+
+        virtual unsigned int GetRank( ) const = 0;
+        virtual unsigned int GetNumberOfRanks( ) const = 0;
+
+        /** Return when all the ranks have called Barrier. */
+        virtual void Barrier( ) = 0;
+      };
+
+      DistributedTileExecutor();
+      ~DistributedTileExecutor();
+
+      /** Print ourselves to string */
+      std::string ToString() const;
+
+      /** \brief The size of the tiles, by default 256 pixels along
+       * each axis.
+       *
+       * The size may have fewer elements than the dimension of the
+       * image, the tiles are then 256 pixels along the other axes.
+       */
+      Self &SetTileSize( const std::vector<unsigned int> &tileSize );
+      const std::vector<unsigned int> &GetTileSize( ) const;
+
+      /** \brief The pixels read around each tile along each axis, by
+       * default none.
+       *
+       * The radius may have fewer elements than the dimension of the
+       * image, there is no halo along the other axes.
+       */
+      Self &SetHaloRadius( const std::vector<unsigned int> &radius );
+      const std::vector<unsigned int> &GetHaloRadius( ) const;
+
+      /** \brief The transport between the processes, which is not
+       * owned. By default, or when null, this process is the only
+       * rank. */
+      Self &SetTransport( Transport *transport );
+      Transport *GetTransport( ) const;
+
+      /** \brief Process the tiles of this rank, and assemble the
+       * output on rank 0.
+       *
+       * All the ranks must call Execute with the same arguments. The
+       * output has the origin, spacing and direction of the input.
+       */
+      void Execute( const std::string &inputFileName,
+                    const std::string &outputFileName,
+                    TileFunction &function );
+
+      /** The number of tiles of the last Execute, of all the ranks. */
+      unsigned int GetNumberOfTiles( ) const;
+
+    private:
+
+      std::vector<unsigned int> m_TileSize;
+      std::vector<unsigned int> m_HaloRadius;
+      Transport                *m_Transport;
+      unsigned int              m_NumberOfTiles;
+    };
+
+  }
+}
+
+#endif
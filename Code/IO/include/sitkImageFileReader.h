@@ -30,6 +30,8 @@ namespace itk {
 
   namespace simple {
 
+    class RemoteFile;
+
     /** \class ImageFileReader
      * \brief Read an image file and return a SimpleITK Image.
      *
@@ -42,6 +44,19 @@ namespace itk {
      * the underlying itk::ImageIO. This information can be loaded
      * with the ReadImageInformation method.
      *
+     * When SimpleITK is built with SimpleITK_USE_CURL, the file name
+     * may be an "http://", "https://" or "s3://" URL. Only the bytes
+     * needed are downloaded with HTTP range requests, concurrently
+     * with up to NumberOfThreads connections: the header for
+     * ReadImageInformation, and for uncompressed MetaImage, NRRD and
+     * single file NIfTI images and the SimpleITK chunked format the
+     * bytes of the ExtractIndex and ExtractSize region. Other files
+     * are downloaded whole. The bytes are kept in a temporary local
+     * copy for the duration of the read, and the image is not memory
+     * mapped. The credentials and endpoint of s3:// URLs are the AWS
+     * environment variables: AWS_ACCESS_KEY_ID, AWS_SECRET_ACCESS_KEY,
+     * AWS_SESSION_TOKEN, AWS_REGION and AWS_ENDPOINT_URL.
+     *
      * \sa itk::simple::ReadImage for the procedural interface
      */
     class SITKIO_EXPORT ImageFileReader
@@ -59,8 +74,155 @@ namespace itk {
       SITK_RETURN_SELF_TYPE_HEADER SetFileName ( const std::string &fn );
       std::string GetFileName() const;
 
+      /** \brief Size of the region to read from the file
+       *
+       * When set, only the region defined by the ExtractIndex and
+       * the ExtractSize is read. The size must have the same number
+       * of elements as the dimension of the image in the file. A
+       * size of zero in a dimension collapses that dimension, the
+       * single slice at the ExtractIndex is read and the output
+       * image has fewer dimensions, so that a 2D slice can be read
+       * from a 3D volume. When the ImageIO of the file format
+       * supports streaming, such as uncompressed MetaImage, NRRD
+       * and NIfTI, only the region is read from the disk.
+       *
+       * By default the size is empty, and the whole image is read.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetExtractSize( const std::vector<unsigned int> &size );
+      const std::vector<unsigned int> &GetExtractSize( ) const;
+      /** @} */
+
+      /** \brief Starting index of the region to read from the file
+       *
+       * When the index has fewer elements than the dimension of the
+       * file, the remaining elements are zero.
+       *
+       * \sa SetExtractSize
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetExtractIndex( const std::vector<int> &index );
+      const std::vector<int> &GetExtractIndex( ) const;
+      /** @} */
+
+      /** \brief Memory map the pixel data of the file
+       *
+       * When enabled, the pixel buffer of the image is memory mapped
+       * from the file rather than being read into memory, so that
+       * only the pages accessed are loaded from the disk. The mapping
+       * is private and copy-on-write, modifying the pixels of the
+       * image never changes the file.
+       *
+       * The file must store the pixels uncompressed and in the
+       * native byte order in a MetaImage, NRRD or single file NIfTI
+       * raw layout, the
+       * output pixel type must be the type of the file, and no
+       * extract region may be set. Otherwise the image is read
+       * normally.
+       *
+       * By default memory mapping is disabled.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetUseMemoryMapping( bool useMemoryMapping );
+      bool GetUseMemoryMapping( ) const;
+      SITK_RETURN_SELF_TYPE_HEADER UseMemoryMappingOn( ) { return this->SetUseMemoryMapping(true); }
+      SITK_RETURN_SELF_TYPE_HEADER UseMemoryMappingOff( ) { return this->SetUseMemoryMapping(false); }
+      /** @} */
+
+      /** \brief Read the raw pixel data in blocks of a given size
+       *
+       * When the size is not 0 or SequentialReadAhead is enabled, the
+       * pixels of files which could be memory mapped are read by
+       * SimpleITK rather than by the ImageIO, with reads of
+       * IOBlockSize bytes straight into the image or the buffer
+       * provided to Execute. Large blocks reduce the number of
+       * requests to network storage. A block size of 0 reads blocks
+       * of 1 MiB. Memory mapping is used first when it is enabled.
+       *
+       * By default the size is 0.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetIOBlockSize( uint64_t ioBlockSize );
+      uint64_t GetIOBlockSize( ) const;
+      /** @} */
+
+      /** \brief Advise the system that the file is read sequentially
+       *
+       * When enabled, the raw pixel data is read in blocks as with
+       * the IOBlockSize, and the system is advised with
+       * posix_fadvise that the file is read sequentially, which
+       * enlarges the read ahead of the file on Linux. The advice is
+       * ignored on systems without posix_fadvise.
+       *
+       * By default it is disabled.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetUseSequentialReadAhead( bool useSequentialReadAhead );
+      bool GetUseSequentialReadAhead( ) const;
+      SITK_RETURN_SELF_TYPE_HEADER UseSequentialReadAheadOn( ) { return this->SetUseSequentialReadAhead(true); }
+      SITK_RETURN_SELF_TYPE_HEADER UseSequentialReadAheadOff( ) { return this->SetUseSequentialReadAhead(false); }
+      /** @} */
+
+      /** \brief The level of a multi-resolution pyramid to read
+       *
+       * Files in the SimpleITK chunked format, with the ".sitkc"
+       * extension, may store a multi-resolution pyramid written with
+       * the NumberOfPyramidLevels of the ImageFileWriter. Level 0 is
+       * the full resolution image, and each following level is
+       * shrunk by a factor of 2. The image information, the extract
+       * region and the output image are for the selected level.
+       *
+       * A level which is not in the file is an error. Other file
+       * formats only have level 0. By default level 0 is read.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetPyramidLevel( unsigned int level );
+      unsigned int GetPyramidLevel( ) const;
+      /** @} */
+
+      /** \brief Compute the hash of the read pixels
+       *
+       * When enabled, Execute computes the FAST hash of the pixels of
+       * the output image, which is returned by GetHash. It is the
+       * hash returned by Hash with HashImageFilter::FAST for the
+       * image, and the hash of the ImageFileWriter which wrote the
+       * pixels. The blocks of the buffer are hashed in parallel
+       * right after they are read. With memory mapping, all the
+       * pixels are read from the file to be hashed.
+       *
+       * By default the hash is not computed.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetComputeHash( bool computeHash );
+      bool GetComputeHash( ) const;
+      SITK_RETURN_SELF_TYPE_HEADER ComputeHashOn( ) { return this->SetComputeHash(true); }
+      SITK_RETURN_SELF_TYPE_HEADER ComputeHashOff( ) { return this->SetComputeHash(false); }
+      /** @} */
+
+      /** \brief The hash of the pixels of the last Execute with
+       * ComputeHash, or an empty string. */
+      std::string GetHash( ) const;
+
       Image Execute();
 
+      /** \brief Read the pixels of the file into a buffer provided by the caller
+       *
+       * The pixel data is read from the file directly into \p buffer,
+       * and the returned image refers to the buffer without copying
+       * it. The buffer is not owned by the image, the caller must
+       * keep the buffer valid for the lifetime of the image and any
+       * image sharing its buffer.
+       *
+       * The pixel type of the file, as reported by GetPixelID after
+       * ReadImageInformation, is the pixel type of the image. The
+       * OutputPixelType must be sitkUnknown or that pixel type, no
+       * extract region may be set, \p bufferSize in bytes must be
+       * at least the size of the pixels of the file and \p buffer
+       * must be aligned to the size of a pixel component. Otherwise
+       * an exception is thrown.
+       */
+      Image Execute( void *buffer, uint64_t bufferSize );
+
       ImageFileReader();
       ~ImageFileReader();
 
@@ -100,6 +262,7 @@ namespace itk {
       const std::vector<double> &GetSpacing( void ) const;
       const std::vector<double> &GetDirection() const;
       const std::vector<uint64_t> &GetSize( void ) const;
+      unsigned int GetNumberOfPyramidLevels( void ) const;
       /* @} */
 
       /** \brief Get the meta-data dictionary keys
@@ -127,15 +290,80 @@ namespace itk {
        **/
       std::string GetMetaData( const std::string &key ) const;
 
+      /** \brief Read the values of DICOM tags from many files
+       *
+       * This method is a faster alternative to ReadImageInformation
+       * and GetMetaData for indexing a large number of DICOM files.
+       * Only the requested tags are read with GDCM, the parsing
+       * stops before the pixel data, no ImageIO is created, and the
+       * files are parsed concurrently with the global default number
+       * of threads of ProcessObject.
+       *
+       * The tags are meta-data keys of the form "gggg|eeee", such as
+       * "0020|000e" for the SeriesInstanceUID, invalid keys are an
+       * error. The result has a row for each file with a value for
+       * each tag, the values are converted to strings as the
+       * meta-data of the GDCMImageIO. Tags missing from a file, and
+       * all tags of files which are not DICOM or can not be read,
+       * have empty values.
+       */
+      static std::vector< std::vector<std::string> > ReadDICOMTags( const std::vector<std::string> &fileNames,
+                                                                    const std::vector<std::string> &tags );
+
     protected:
 
       template <class TImageType> Image ExecuteInternal ( itk::ImageIOBase * );
 
+      template <class TImageType, unsigned int VOutputDimension>
+        typename EnableIf<(TImageType::ImageDimension >= VOutputDimension), Image>::Type
+        ExecuteExtract ( itk::ImageIOBase * );
+      template <class TImageType, unsigned int VOutputDimension>
+        typename DisableIf<(TImageType::ImageDimension >= VOutputDimension), Image>::Type
+        ExecuteExtract ( itk::ImageIOBase * );
+
+      /** Find the raw pixel data of the file for the buffer of the
+       * image type, returns false if the pixels are not stored in the
+       * layout of the buffer. */
+      template <class TImageType>
+        bool GetRawPixelData ( const itk::ImageIOBase *, std::string &dataFileName, uint64_t &offset,
+                               uint64_t &numberOfBytes, unsigned int &elementsPerPixel ) const;
+
+      /** Returns false if the file can not be memory mapped. */
+      template <class TImageType> bool ExecuteMemoryMapped ( itk::ImageIOBase *, Image & );
+
+      /** Returns false if the raw pixel data can not be read in blocks. */
+      template <class TImageType> bool ExecuteRawBlocks ( itk::ImageIOBase *, Image & );
+
+      template <class TImageType> Image ExecuteIntoBuffer ( itk::ImageIOBase * );
+
+      /** Create an image without a buffer with the image
+       * information of the file. */
+      template <class TImageType>
+        typename TImageType::Pointer CreateImageFromImageInformation ( unsigned int numberOfComponents ) const;
+
       /** Internal method which update's this classes stored meta-data
        * and image information.
        */
       void UpdateImageInformationFromImageIO( const itk::ImageIOBase* iobase );
 
+      /** Update the image information of the ImageIO for the
+       * PyramidLevel. */
+      void SelectPyramidLevel( itk::ImageIOBase* iobase ) const;
+
+      /** Read a remote file through its local copy. */
+      Image ExecuteRemote ( void );
+      void ReadRemoteImageInformation ( void );
+
+      /** Fetch the header of the remote file and read its image
+       * information, while the file name is the local copy. */
+      itk::SmartPointer<itk::ImageIOBase> FetchRemoteImageInformation( RemoteFile &remote );
+
+      /** Fetch the bytes of the pixels of the extract region, or of
+       * the image, into the local copies. A separate data file is
+       * created as a remote file of the same directory. */
+      void FetchRemotePixelData( RemoteFile &remote, itk::ImageIOBase *imageio,
+                                 nsstd::auto_ptr<RemoteFile> &dataFile );
+
     private:
 
       // function pointer type
@@ -152,6 +380,23 @@ namespace itk {
 
       std::string m_FileName;
 
+      std::vector<unsigned int> m_ExtractSize;
+      std::vector<int>          m_ExtractIndex;
+
+      bool m_UseMemoryMapping;
+
+      uint64_t m_IOBlockSize;
+      bool     m_UseSequentialReadAhead;
+
+      unsigned int m_PyramidLevel;
+
+      bool        m_ComputeHash;
+      std::string m_Hash;
+
+      // the buffer provided to Execute, only set during its execution
+      void     *m_Buffer;
+      uint64_t  m_BufferSize;
+
       nsstd::auto_ptr<MetaDataDictionary> m_MetaDataDictionary;
 
       PixelIDValueEnum     m_PixelType;
@@ -162,6 +407,7 @@ namespace itk {
       std::vector<double>  m_Spacing;
 
       std::vector<uint64_t> m_Size;
+      unsigned int          m_NumberOfPyramidLevels;
     };
 
   /**
@@ -0,0 +1,135 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkImageFileReaderQueue_h
+#define sitkImageFileReaderQueue_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkIO.h"
+#include "sitkNonCopyable.h"
+
+#include <string>
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+    /** \class ImageFileReaderQueue
+     * \brief Read a list of image files ahead in background threads.
+     *
+     * The files are read and decoded concurrently by a fixed number
+     * of worker threads, while the images already read are taken in
+     * order with Next. The number of images read ahead of Next is
+     * bounded, so that the memory used is limited.
+     *
+     \code
+     ImageFileReaderQueue queue;
+     queue.SetFileNames( fileNames );
+     queue.Start();
+     while ( queue.HasNext() )
+       {
+       Image image = queue.Next();
+       ...
+       }
+     \endcode
+     *
+     * Next blocks until the next image is read. When the file can not
+     * be read, Next throws the exception of the reader for that file
+     * and continues with the following files.
+     *
+     * \sa itk::simple::ImageFileReader
+     */
+    class SITKIO_EXPORT ImageFileReaderQueue
+      : protected NonCopyable
+    {
+    public:
+      typedef ImageFileReaderQueue Self;
+
+      ImageFileReaderQueue();
+
+      /** Stops the worker threads. */
+      ~ImageFileReaderQueue();
+
+      /** Print ourselves to string */
+      std::string ToString() const;
+
+      /** The files to read, in the order returned by Next. */
+      Self &SetFileNames( const std::vector<std::string> &fileNames );
+      const std::vector<std::string> &GetFileNames( ) const;
+
+      /** \brief Options for reading each file.
+       *
+       * \sa ImageReaderBase::SetOutputPixelType
+       * \sa ImageReaderBase::SetImageIO
+       * @{
+       */
+      Self &SetOutputPixelType( PixelIDValueEnum pixelID );
+      PixelIDValueEnum GetOutputPixelType( ) const;
+      Self &SetImageIO( const std::string &imageio );
+      std::string GetImageIO( ) const;
+      /** @} */
+
+      /** \brief The number of threads reading files, by default 2. */
+      Self &SetNumberOfWorkers( unsigned int n );
+      unsigned int GetNumberOfWorkers( ) const;
+
+      /** \brief The maximum number of images read ahead or being
+       * read, which have not been taken by Next. By default 4.
+       */
+      Self &SetMaximumNumberOfPendingImages( unsigned int n );
+      unsigned int GetMaximumNumberOfPendingImages( ) const;
+
+      /** \brief Start reading from the first file.
+       *
+       * Images of a previous start which have not been taken are
+       * discarded. Changes to the options take effect on the next
+       * start.
+       */
+      void Start( );
+
+      /** \brief Stop the worker threads and discard the images which
+       * have not been taken. */
+      void Stop( );
+
+      /** Returns true if Next has an image to return since the last
+       * Start. */
+      bool HasNext( ) const;
+
+      /** \brief Wait for and return the next image in the list.
+       *
+       * An exception is thrown if there is no next image, or if the
+       * next file could not be read.
+       */
+      Image Next( );
+
+    private:
+
+      struct Implementation;
+      Implementation *m_Implementation;
+
+      std::vector<std::string> m_FileNames;
+      PixelIDValueEnum         m_OutputPixelType;
+      std::string              m_ImageIO;
+      unsigned int             m_NumberOfWorkers;
+      unsigned int             m_MaximumNumberOfPendingImages;
+    };
+
+  }
+}
+
+#endif
@@ -43,6 +43,17 @@ class SmartPointer;
      * location specified in FileName. If writing fails, an ITK exception is
      * thrown.
      *
+     * The image can be a placeholder returned by a filter in a
+     * Pipeline. With more than one stream division and an ImageIO
+     * which supports streamed writing, the deferred filters are then
+     * executed and written one piece at a time, so the complete image
+     * is never in memory.
+     *
+     * A label map image is painted into a scalar image of its label
+     * type before it is written, so its runs are only expanded
+     * while writing. The file formats have no run-length encoding,
+     * sparse segmentations should be written with UseCompression.
+     *
      * \sa itk::simple::WriteImage for the procedural interface
      */
     class SITKIO_EXPORT ImageFileWriter  :
@@ -75,6 +86,51 @@ class SmartPointer;
       SITK_RETURN_SELF_TYPE_HEADER UseCompressionOff( void ) { return this->SetUseCompression(false); }
       /** @} */
 
+      /** \brief Compress with multiple threads
+       *
+       * When enabled with UseCompression, the data is compressed in
+       * independent blocks concurrently with NumberOfThreads
+       * threads, and written as a single standard deflate
+       * stream. Parallel compression is available for the
+       * MetaImage (.mha), NRRD (.nrrd) and gzip NIfTI (.nii.gz)
+       * formats, other formats are compressed by their ImageIO.
+       *
+       * By default parallel compression is disabled.
+       * @{ */
+      SITK_RETURN_SELF_TYPE_HEADER SetUseParallelCompression( bool UseParallelCompression );
+      bool GetUseParallelCompression( void ) const;
+
+      SITK_RETURN_SELF_TYPE_HEADER UseParallelCompressionOn( void ) { return this->SetUseParallelCompression(true); }
+      SITK_RETURN_SELF_TYPE_HEADER UseParallelCompressionOff( void ) { return this->SetUseParallelCompression(false); }
+      /** @} */
+
+      /** \brief Select the compression algorithm and level
+       *
+       * The compressor is the name of a compression algorithm of
+       * the ImageIO of the file format, which is used when
+       * UseCompression is enabled. The names are case insensitive,
+       * for example "PackBits", "JPEG", "Deflate" or "LZW" for TIFF
+       * files, while the other formats compress with "Deflate". With
+       * ITK 5.1 or later, the compressor is passed to the ImageIO,
+       * where additional compressors may be available. By default
+       * the compressor is empty, and the default of the ImageIO is
+       * used. An exception is thrown when writing with a compressor
+       * not supported by the ImageIO.
+       *
+       * The compression level trades the write speed for the size
+       * of the file, larger levels compress better. It is the zlib
+       * level from 0 to 9 for the Deflate compressor, used for PNG
+       * files and parallel compression, and the quality from 0 to
+       * 100 for JPEG. The default value of -1 is the default level
+       * of the compressor.
+       * @{ */
+      SITK_RETURN_SELF_TYPE_HEADER SetCompressor( const std::string &Compressor );
+      std::string GetCompressor( void ) const;
+
+      SITK_RETURN_SELF_TYPE_HEADER SetCompressionLevel( int CompressionLevel );
+      int GetCompressionLevel( void ) const;
+      /** @} */
+
 
       /** \brief Use the original study/series/frame of reference.
        *
@@ -91,9 +147,148 @@ class SmartPointer;
       SITK_RETURN_SELF_TYPE_HEADER KeepOriginalImageUIDOff( void ) { return this->SetKeepOriginalImageUID(false); }
       /** @} */
 
+      /** \brief The size of the chunks of chunked file formats
+       *
+       * Files with the ".sitkc" extension are written in the
+       * SimpleITK chunked format, where the image is divided into
+       * chunks of this size which are compressed independently.
+       * Reading a region of the file with the ExtractIndex and
+       * ExtractSize of the ImageFileReader only decodes the chunks
+       * which intersect the region, so that regions of interest of
+       * large compressed volumes are read quickly. The chunks are
+       * compressed with the Deflate compressor when UseCompression
+       * is enabled.
+       *
+       * The size may have fewer elements than the dimension of the
+       * image. By default the size is empty, and chunks are 64
+       * pixels in each dimension. The chunk size is ignored for
+       * other file formats.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetChunkSize( const std::vector<unsigned int> &chunkSize );
+      const std::vector<unsigned int> &GetChunkSize( ) const;
+      /** @} */
+
+      /** \brief Number of levels of a multi-resolution pyramid
+       *
+       * Files in the SimpleITK chunked format, with the ".sitkc"
+       * extension, may store a multi-resolution pyramid. Level 0 is
+       * the image, and each following level is computed from the
+       * previous level by shrinking each dimension with more than
+       * one pixel by a factor of 2, averaging the pixels as the
+       * BinShrinkImageFilter. All levels are computed while the
+       * file is written and stored in the one file, a level is read
+       * with the PyramidLevel of the ImageFileReader.
+       *
+       * By default only 1 level is written. The number of levels is
+       * ignored for other file formats.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetNumberOfPyramidLevels( unsigned int levels );
+      unsigned int GetNumberOfPyramidLevels( ) const;
+      /** @} */
+
       SITK_RETURN_SELF_TYPE_HEADER SetFileName ( const std::string &fileName );
       std::string GetFileName() const;
 
+      /** \brief Write the image as a region of an existing file
+       *
+       * When a paste index is set, the file must already exist and
+       * the image is written into the file at this index, replacing
+       * that region of the file. The remaining pixels and the header
+       * of the file are not changed, so a large volume can be
+       * written block by block without holding it in memory. The
+       * pixel type and number of components of the image must match
+       * the file, and the region must be inside of the file. The
+       * ImageIO of the file format must support streamed writing,
+       * such as uncompressed MetaImage or NRRD, and compression is
+       * not used.
+       *
+       * By default the paste index is empty, and the whole file is
+       * written.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetPasteIndex( const std::vector<unsigned int> &index );
+      const std::vector<unsigned int> &GetPasteIndex( ) const;
+      /** @} */
+
+      /** \brief Compute the hash of the written pixels
+       *
+       * When enabled, the FAST hash of the pixels is computed while
+       * they are written, and is returned by GetHash after
+       * Execute. It is the hash returned by Hash with
+       * HashImageFilter::FAST for the written image, so it
+       * identifies the content of the file without reading it
+       * back. When the image is written in streamed pieces, each
+       * piece is hashed as it is written, so no additional pass over
+       * the image is made. With a PasteIndex, it is the hash of the
+       * pasted image.
+       *
+       * By default the hash is not computed.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetComputeHash( bool computeHash );
+      bool GetComputeHash( ) const;
+      SITK_RETURN_SELF_TYPE_HEADER ComputeHashOn( ) { return this->SetComputeHash(true); }
+      SITK_RETURN_SELF_TYPE_HEADER ComputeHashOff( ) { return this->SetComputeHash(false); }
+      /** @} */
+
+      /** \brief The hash of the pixels of the last Execute with
+       * ComputeHash, or an empty string. */
+      std::string GetHash( ) const;
+
+      /** \brief Write the pixels bypassing the page cache
+       *
+       * When enabled, the pixel data of uncompressed MetaImage files
+       * (.mha and .mhd) is written by SimpleITK with direct I/O,
+       * O_DIRECT on Linux and F_NOCACHE on macOS, so writing large
+       * images does not evict the pages of other files from the
+       * page cache. The header and the first pixel are written by
+       * the ImageIO, then the pixels are written in blocks of
+       * IOBlockSize bytes from the buffer of the image. The blocks
+       * of the file which are not aligned to 4096 bytes, and files
+       * on file systems without direct I/O, are written normally.
+       *
+       * Other formats, compressed files, pasted regions and images
+       * of a Pipeline which are not computed are written normally.
+       * By default direct I/O is disabled.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetUseDirectIO( bool useDirectIO );
+      bool GetUseDirectIO( ) const;
+      SITK_RETURN_SELF_TYPE_HEADER UseDirectIOOn( ) { return this->SetUseDirectIO(true); }
+      SITK_RETURN_SELF_TYPE_HEADER UseDirectIOOff( ) { return this->SetUseDirectIO(false); }
+      /** @} */
+
+      /** \brief Drop the written file from the page cache
+       *
+       * When enabled, the file is flushed to the disk after it is
+       * written, and the system is advised with posix_fadvise that
+       * its pages are not needed, so they are dropped from the page
+       * cache. The separate data file of MetaImage and NRRD headers
+       * is dropped as well. It is ignored on systems without
+       * posix_fadvise.
+       *
+       * By default the file is not dropped.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetDropFromPageCache( bool dropFromPageCache );
+      bool GetDropFromPageCache( ) const;
+      SITK_RETURN_SELF_TYPE_HEADER DropFromPageCacheOn( ) { return this->SetDropFromPageCache(true); }
+      SITK_RETURN_SELF_TYPE_HEADER DropFromPageCacheOff( ) { return this->SetDropFromPageCache(false); }
+      /** @} */
+
+      /** \brief The size of the blocks written by SimpleITK
+       *
+       * The size in bytes of the writes of direct I/O, and of the
+       * blocks of the uncompressed file read by parallel
+       * compression. A size of 0 is the default of 1 MiB.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetIOBlockSize( uint64_t ioBlockSize );
+      uint64_t GetIOBlockSize( ) const;
+      /** @} */
+
       SITK_RETURN_SELF_TYPE_HEADER Execute ( const Image& );
       SITK_RETURN_SELF_TYPE_HEADER Execute ( const Image& , const std::string &inFileName, bool useCompression );
 
@@ -102,16 +297,39 @@ class SmartPointer;
       itk::SmartPointer<ImageIOBase> GetImageIOBase(const std::string &fileName);
 
       template <class T> Self& ExecuteInternal ( const Image& );
+      template <class T> Self& ExecuteInternalPaste ( const Image& );
+
+      /** Returns false if the image can not be written with direct
+       * I/O, before the file is written. */
+      template <class T> bool ExecuteInternalDirectIO ( const T *image, ImageIOBase *imageio );
+
+      void DropWrittenFileFromPageCache( const ImageIOBase *imageio ) const;
+      template <class TLabelImageType> Self& ExecuteInternalLabelImage ( const Image& );
 
       bool        m_UseCompression;
+      bool        m_UseParallelCompression;
+      int         m_CompressionLevel;
+      std::string m_Compressor;
       std::string m_FileName;
       bool        m_KeepOriginalImageUID;
 
+      std::vector<unsigned int> m_PasteIndex;
+      std::vector<unsigned int> m_ChunkSize;
+      unsigned int              m_NumberOfPyramidLevels;
+
+      bool        m_ComputeHash;
+      std::string m_Hash;
+
+      bool     m_UseDirectIO;
+      bool     m_DropFromPageCache;
+      uint64_t m_IOBlockSize;
+
       // function pointer type
       typedef Self& (Self::*MemberFunctionType)( const Image& );
 
       // friend to get access to executeInternal member
       friend struct detail::MemberFunctionAddressor<MemberFunctionType>;
+      friend struct detail::ExecuteInternalLabelImageAddressor<MemberFunctionType>;
 
       nsstd::auto_ptr<detail::MemberFunctionFactory<MemberFunctionType> > m_MemberFactory;
 
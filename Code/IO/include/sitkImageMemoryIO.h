@@ -0,0 +1,67 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkImageMemoryIO_h
+#define sitkImageMemoryIO_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkIO.h"
+
+#include <string>
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+  /** \brief Read an image from a file in memory.
+   *
+   * The \p buffer holds the contents of an image file, such as
+   * received over the network, which is decoded without writing it
+   * to the file system.
+   *
+   * Reading from memory is supported for MetaImage files with the
+   * pixels in the same file (".mha"), uncompressed or compressed. The
+   * \p formatHint may be "mha" or "MetaImage", or empty to detect the
+   * format from the header. The ImageIOs of other formats only read
+   * from files by name, and an exception is thrown for them.
+   *
+   * \sa ReadImage
+   * @{
+   */
+  SITKIO_EXPORT Image ReadImageFromMemory( const void *buffer, size_t bufferSize, const std::string &formatHint = "" );
+  SITKIO_EXPORT Image ReadImageFromMemory( const std::vector<uint8_t> &buffer, const std::string &formatHint = "" );
+  /** @} */
+
+  /** \brief Write an image to a file in memory.
+   *
+   * The image is encoded as a MetaImage file with the pixels in the
+   * same file, which can be written to a ".mha" file or read with
+   * ReadImageFromMemory. When \p useCompression is true the pixels
+   * are compressed with zlib. The only supported \p format is "mha",
+   * or "MetaImage".
+   *
+   * Label and complex pixel types are not supported.
+   *
+   * \sa WriteImage
+   */
+  SITKIO_EXPORT std::vector<uint8_t> WriteImageToMemory( const Image &image, const std::string &format = "mha", bool useCompression = false );
+
+  }
+}
+
+#endif
@@ -43,7 +43,7 @@ class SmartPointer;
       typedef ImageReaderBase Self;
 
       ImageReaderBase();
-      // The destructor will be implicitly declared as public.
+      virtual ~ImageReaderBase();
 
       /** \brief Set/Get The output PixelType of the image.
        *
@@ -72,8 +72,37 @@ class SmartPointer;
       virtual void LoadPrivateTagsOff();
       /* @} */
 
+      /** \brief Set/Get the ImageIO used to read the file
+       *
+       * By default the value is an empty string, and each registered
+       * ImageIO is asked if it can read the file. When the name of
+       * an ImageIO class such as "NiftiImageIO" is set, only that
+       * ImageIO is used, which avoids probing the registered
+       * ImageIOs.
+       *
+       * \sa GetRegisteredImageIOs
+       * @{
+       */
+      virtual Self& SetImageIO( const std::string &imageio );
+      virtual std::string GetImageIO( void ) const;
+      /* @} */
+
+      /** \brief Get the names of the registered ImageIO classes. */
+      static std::vector<std::string> GetRegisteredImageIOs( void );
+
     protected:
 
+      /** \brief Get the ImageIO with the information of the file read.
+       *
+       * The ImageIO of the last file is reused while the file has the
+       * same modification time and size, so the ImageIO is usually
+       * not determined and the header not parsed again when the
+       * information of a file is read before the image. The time is
+       * compared in nanoseconds where the file system provides them,
+       * otherwise in seconds, in which case a file rewritten within
+       * the same second with the same size is not detected.
+       */
+
       itk::SmartPointer<ImageIOBase> GetImageIOBase(const std::string &fileName);
 
 
@@ -97,8 +126,18 @@ class SmartPointer;
       PixelIDValueType ExecuteInternalReadComplex( int componentType );
 
 
+      void ReleaseCachedImageIO( void );
+
       PixelIDValueEnum m_OutputPixelType;
       bool             m_LoadPrivateTags;
+      std::string      m_ImageIOName;
+
+      // The ImageIO of the last file and the file's modification
+      // time, in nanoseconds, and size when it was read.
+      ImageIOBase     *m_CachedImageIO;
+      std::string      m_CachedFileName;
+      int64_t          m_CachedModifiedTime;
+      uint64_t         m_CachedFileLength;
 
     };
   }
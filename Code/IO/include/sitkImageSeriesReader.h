@@ -73,6 +73,48 @@ namespace itk {
       SITK_RETURN_SELF_TYPE_HEADER MetaDataDictionaryArrayUpdateOn() { return this->SetMetaDataDictionaryArrayUpdate(true); }
       SITK_RETURN_SELF_TYPE_HEADER MetaDataDictionaryArrayUpdateOff() { return this->SetMetaDataDictionaryArrayUpdate(false); }
 
+      /** \brief Keep only the selected meta-data keys of the slices
+       *
+       * When MetaDataDictionaryArrayUpdate is true and the keys are
+       * not empty, only the values of these keys are kept for each
+       * slice, compactly in one buffer, rather than the complete
+       * meta-data dictionaries of all of the slices. The meta-data
+       * methods of the reader then only report the kept keys.
+       *
+       * For DICOM series the keys are tags of the form "gggg|eeee",
+       * such as "0020|1041" for the SliceLocation, which are read
+       * with the ReadDICOMTags method of the ImageFileReader, and
+       * tags with empty values are not kept. The pixels may then be
+       * read with UseParallelRead.
+       *
+       * By default the keys are empty, and all meta-data is kept.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetMetaDataKeysToKeep( const std::vector<std::string> &keys )
+      { this->m_MetaDataKeysToKeep = keys; return *this; }
+      const std::vector<std::string> &GetMetaDataKeysToKeep() const { return this->m_MetaDataKeysToKeep; }
+      /** @} */
+
+      /** \brief Read the slices of the series in parallel
+       *
+       * When enabled, the slices are read and decoded concurrently,
+       * each directly into the output volume, with up to
+       * NumberOfThreads threads. This is beneficial when decoding is
+       * expensive, such as with compressed DICOM files.
+       *
+       * The meta-data dictionaries of the slices are not read in
+       * parallel, when MetaDataDictionaryArrayUpdate is true and no
+       * MetaDataKeysToKeep are set the slices are read sequentially.
+       * By default parallel reading is disabled.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetUseParallelRead ( bool useParallelRead )
+      { this->m_UseParallelRead = useParallelRead; return *this; }
+      bool GetUseParallelRead() const { return this->m_UseParallelRead; }
+      SITK_RETURN_SELF_TYPE_HEADER UseParallelReadOn() { return this->SetUseParallelRead(true); }
+      SITK_RETURN_SELF_TYPE_HEADER UseParallelReadOff() { return this->SetUseParallelRead(false); }
+      /** @} */
+
 
       /** \brief Generate a sequence of filenames from a directory with a DICOM data set and a series ID.
        *
@@ -110,6 +152,46 @@ namespace itk {
        **/
       static std::vector<std::string> GetGDCMSeriesIDs( const std::string &directory );
 
+      /** \brief Generate a sequence of filenames of a DICOM series with a fast scan of the directory.
+       *
+       * This method is a faster alternative to
+       * GetGDCMSeriesFileNames for large directories. Only the tags
+       * needed to group and order the slices are read from the
+       * files, the parsing stops before the pixel data, and the
+       * files are parsed concurrently with the global default number
+       * of threads of ProcessObject.
+       *
+       * The slices are ordered by their ImagePositionPatient along
+       * the normal of the ImageOrientationPatient, then by the
+       * InstanceNumber, and otherwise by the file name.
+       *
+       * \param directory         The directory that contains the DICOM data set.
+       * \param seriesID          The series to return, the first series when empty.
+       * \param useSeriesDetails  Append the SeriesNumber, SequenceName,
+       * SliceThickness, Rows and Columns to the SeriesInstanceUID
+       * to identify the series.
+       * \param recursive         Recursively scan the directory.
+       * \param cacheFileName     When not empty, the parsed tags are
+       * saved to this index file. Later scans only parse the files
+       * which are new or whose modification time or size changed.
+       *
+       * \sa GetDICOMSeriesIDs
+       **/
+      static std::vector<std::string> GetDICOMSeriesFileNames( const std::string &directory,
+                                                               const std::string &seriesID = "",
+                                                               bool useSeriesDetails = false,
+                                                               bool recursive = false,
+                                                               const std::string &cacheFileName = "" );
+
+      /** \brief Get all the series IDs with a fast scan of a directory
+       *
+       * The parameters are as for GetDICOMSeriesFileNames.
+       **/
+      static std::vector<std::string> GetDICOMSeriesIDs( const std::string &directory,
+                                                         bool useSeriesDetails = false,
+                                                         bool recursive = false,
+                                                         const std::string &cacheFileName = "" );
+
       SITK_RETURN_SELF_TYPE_HEADER SetFileNames ( const std::vector<std::string> &fileNames );
       const std::vector<std::string> &GetFileNames() const;
 
@@ -150,6 +232,15 @@ namespace itk {
 
       template <class TImageType> Image ExecuteInternal ( itk::ImageIOBase * );
 
+      template <class TImageType> Image ExecuteParallelRead ( itk::ImageIOBase * );
+
+      /** Read the values of the MetaDataKeysToKeep of the slices. */
+      void ReadKeptMetaData( itk::ImageIOBase * );
+
+      std::vector<std::string> GetKeptMetaDataKeys( int slice ) const;
+      bool HasKeptMetaDataKey( int slice, const std::string &key ) const;
+      std::string GetKeptMetaData( int slice, const std::string &key ) const;
+
     private:
 
       // function pointer type
@@ -171,6 +262,15 @@ namespace itk {
       std::vector<std::string> m_FileNames;
 
       bool m_MetaDataDictionaryArrayUpdate;
+
+      std::vector<std::string> m_MetaDataKeysToKeep;
+
+      // the values of the kept keys of all slices concatenated, with
+      // the offset of each slice and key, missing keys are empty
+      std::string              m_KeptMetaDataValues;
+      std::vector<uint64_t>    m_KeptMetaDataOffsets;
+
+      bool m_UseParallelRead;
     };
 
   /**
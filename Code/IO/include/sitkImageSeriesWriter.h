@@ -69,6 +69,39 @@ namespace itk {
       SITK_RETURN_SELF_TYPE_HEADER UseCompressionOff( void ) { return this->SetUseCompression(false); }
       /** @} */
 
+      /** \brief Select the compression algorithm and level
+       *
+       * \sa ImageFileWriter::SetCompressor
+       * \sa ImageFileWriter::SetCompressionLevel
+       * @{ */
+      SITK_RETURN_SELF_TYPE_HEADER SetCompressor( const std::string &Compressor );
+      std::string GetCompressor( void ) const;
+
+      SITK_RETURN_SELF_TYPE_HEADER SetCompressionLevel( int CompressionLevel );
+      int GetCompressionLevel( void ) const;
+      /** @} */
+
+      /** \brief Write the slices of the series in parallel
+       *
+       * When enabled, the slices are encoded and written concurrently
+       * with up to NumberOfThreads threads. Each slice is written
+       * directly from the buffer of the input image, so no additional
+       * memory proportional to the volume is allocated. The
+       * ProgressEvent is invoked from the calling thread as each
+       * slice is completed, and aborting the writer stops writing
+       * the remaining slices.
+       *
+       * All the file names must be of the same file format. By
+       * default parallel writing is disabled.
+       * @{
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetUseParallelWrite ( bool useParallelWrite )
+      { this->m_UseParallelWrite = useParallelWrite; return *this; }
+      bool GetUseParallelWrite() const { return this->m_UseParallelWrite; }
+      SITK_RETURN_SELF_TYPE_HEADER UseParallelWriteOn() { return this->SetUseParallelWrite(true); }
+      SITK_RETURN_SELF_TYPE_HEADER UseParallelWriteOff() { return this->SetUseParallelWrite(false); }
+      /** @} */
+
       /** The filenames to where the image slices are written.
         *
         * The number of filenames must match the number of slices in
@@ -86,6 +119,8 @@ namespace itk {
 
       template <class TImageType> Self &ExecuteInternal ( const Image& inImage );
 
+      template <class TImageType> Self &ExecuteParallelWrite ( const TImageType *image );
+
     private:
 
       // function pointer type
@@ -96,7 +131,10 @@ namespace itk {
       nsstd::auto_ptr<detail::MemberFunctionFactory<MemberFunctionType> > m_MemberFactory;
 
       bool                     m_UseCompression;
+      std::string              m_Compressor;
+      int                      m_CompressionLevel;
       std::vector<std::string> m_FileNames;
+      bool                     m_UseParallelWrite;
     };
 
   SITKIO_EXPORT void WriteImage ( const Image & image, const std::vector<std::string> &fileNames, bool useCompression=false );
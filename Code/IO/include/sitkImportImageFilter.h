@@ -37,6 +37,11 @@ namespace itk {
      * delete the buffer afterwards, and it buffer must remain valid
      * while in use.
      *
+     * Alternatively, a deleter function may be provided with
+     * SetBufferDeleter, then ownership of the buffer is transferred
+     * to the imported image, and the deleter is called when the
+     * buffer is no longer referenced by any image.
+     *
      * \sa itk::simple::ImportAsInt8, itk::simple::ImportAsUInt8,
      * itk::simple::ImportAsInt16, itk::simple::ImportAsUInt16,
      * itk::simple::ImportAsInt32, itk::simple::ImportAsUInt32,
@@ -80,6 +85,26 @@ namespace itk {
       SITK_RETURN_SELF_TYPE_HEADER SetBufferAsFloat( float * buffer, unsigned int numberOfComponents = 1 );
       SITK_RETURN_SELF_TYPE_HEADER SetBufferAsDouble( double * buffer, unsigned int numberOfComponents = 1 );
 
+#ifndef SWIG
+      /** Function called to release an imported buffer. */
+      typedef void (*BufferDeleterFunctionType)( void *buffer, void *clientData );
+
+      /** \brief Transfer ownership of the buffer to the imported image.
+       *
+       * The next call to Execute creates an image which owns the
+       * buffer set with one of the SetBufferAs methods. When the last
+       * image referencing the buffer is destroyed, the deleter is
+       * called with the buffer and the clientData. The buffer is
+       * never copied.
+       *
+       * Ownership is transferred only once, after Execute the deleter
+       * is cleared, and setting a new buffer also clears the
+       * deleter. Call with NULL to remove the deleter.
+       */
+      SITK_RETURN_SELF_TYPE_HEADER SetBufferDeleter( BufferDeleterFunctionType deleter, void *clientData = NULL );
+      BufferDeleterFunctionType GetBufferDeleter( ) const;
+#endif
+
       Image Execute();
 
     protected:
@@ -116,6 +141,9 @@ namespace itk {
 
       void        * m_Buffer;
 
+      void       (* m_BufferDeleter)( void *, void * );
+      void        * m_BufferDeleterClientData;
+
     };
 
   Image SITKIO_EXPORT ImportAsInt8(
@@ -0,0 +1,94 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkSharedMemoryImage_h
+#define sitkSharedMemoryImage_h
+
+#include "sitkMacro.h"
+#include "sitkImage.h"
+#include "sitkIO.h"
+
+#include <string>
+#include <vector>
+
+namespace itk {
+  namespace simple {
+
+  /** \brief Create an image in a new shared memory object.
+   *
+   * The pixels of the image are in a POSIX shared memory object, or a
+   * named file mapping on Windows, with the \p name, which may be
+   * attached by other processes on the same computer without copying
+   * with AttachSharedMemoryImage. The name must not be empty or
+   * contain '/' or whitespace, and an exception is thrown if an
+   * object with the name exists.
+   *
+   * The pixels are initialized to zero. Modifying the pixels of the
+   * image, or of an attached image, modifies the pixels in all of
+   * them, unless the image shares its buffer with a copy and the
+   * buffer is made unique. Label and complex pixel types are not
+   * supported.
+   *
+   * The object is mapped until the last image referencing it is
+   * destroyed. It must be removed with UnlinkSharedMemoryImage when it
+   * is no longer needed, after which the mapped images remain valid.
+   *
+   * \sa GetSharedMemoryImageHandle
+   */
+  SITKIO_EXPORT Image CreateSharedMemoryImage( const std::string &name,
+                                               const std::vector<unsigned int> &size,
+                                               PixelIDValueEnum pixelID,
+                                               unsigned int numberOfComponents = 1 );
+
+  /** \brief Copy an image in a new shared memory object.
+   *
+   * The image is created with CreateSharedMemoryImage and the pixels,
+   * geometry and meta-data of \p image are copied.
+   */
+  SITKIO_EXPORT Image CopyImageToSharedMemory( const Image &image, const std::string &name );
+
+  /** \brief Get the handle of an image in shared memory.
+   *
+   * The handle is a string with the name of the shared memory object,
+   * the pixel type, the size and the origin, spacing and direction of
+   * the image, which may be sent to another process to attach the
+   * image. The meta-data is not in the handle.
+   *
+   * An exception is thrown if the buffer of the image is not a
+   * shared memory object created or attached in this process.
+   */
+  SITKIO_EXPORT std::string GetSharedMemoryImageHandle( const Image &image );
+
+  /** \brief Attach an image in shared memory from its handle.
+   *
+   * The shared memory object is mapped and imported without copying,
+   * with the pixel type and geometry of the handle.
+   */
+  SITKIO_EXPORT Image AttachSharedMemoryImage( const std::string &handle );
+
+  /** \brief Remove the name of a shared memory object.
+   *
+   * The object can no longer be attached, and its memory is released
+   * when it is no longer mapped. On Windows the object is released
+   * with its last mapping, and this function does nothing.
+   */
+  SITKIO_EXPORT void UnlinkSharedMemoryImage( const std::string &name );
+
+  }
+}
+
+#endif
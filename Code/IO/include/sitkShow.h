@@ -38,6 +38,13 @@ namespace simple
    *  format can be chosen by setting the SITK_SHOW_EXTENSION environment variable.
    *  For example, set SITK_SHOW_EXTENSION to ".png" to use PNG format.
    *
+   *  The image is written without compression to a temporary file in
+   *  the directory set with the SITK_SHOW_DIRECTORY environment
+   *  variable. Otherwise, on Linux the memory backed /dev/shm is used
+   *  when it is writable, then /tmp. An image shown again with the
+   *  same pixels and geometry is not written again, its file is
+   *  reused as long as it exists.
+   *
    *  The user can specify an application other than ImageJ to view images via
    *  the SITK_SHOW_COMMAND environment variable.
    *
@@ -0,0 +1,1171 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkChunkedImageIO.h"
+
+#include <itkByteSwapper.h>
+#include <itkMath.h>
+#include <itkMultiThreader.h>
+#include <itkSimpleFastMutexLock.h>
+#include <itkVersion.h>
+#include <itksys/SystemTools.hxx>
+#include "itk_zlib.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace itk
+{
+namespace simple
+{
+
+namespace
+{
+
+const char * const ChunkedImageMagic = "SimpleITKChunkedImage";
+
+const unsigned int DefaultChunkSize = 64;
+
+typedef std::map<std::string, std::string> FieldMap;
+
+std::string TrimString( const std::string &s )
+{
+  const std::string whitespace = " \t\r\n";
+  const size_t begin = s.find_first_not_of( whitespace );
+  if ( begin == std::string::npos )
+    {
+    return std::string();
+    }
+  return s.substr( begin, s.find_last_not_of( whitespace ) - begin + 1 );
+}
+
+const std::string &GetField( const FieldMap &fields, const char *key )
+{
+  FieldMap::const_iterator iter = fields.find( key );
+  if ( iter == fields.end() )
+    {
+    sitkExceptionMacro( "The chunked image header has no \"" << key << "\" field." );
+    }
+  return iter->second;
+}
+
+template <typename T>
+std::vector<T> ParseValues( const FieldMap &fields, const char *key, size_t count )
+{
+  const std::string &value = GetField( fields, key );
+  std::istringstream in( value );
+  std::vector<T> result;
+  T v;
+  while ( result.size() < count && in >> v )
+    {
+    result.push_back( v );
+    }
+  if ( result.size() != count )
+    {
+    sitkExceptionMacro( "The chunked image field \"" << key << "\" with value \"" << value
+                        << "\" does not have " << count << " values." );
+    }
+  return result;
+}
+
+void PutUInt64LE( uint8_t *p, uint64_t v )
+{
+  for ( unsigned int i = 0; i < 8; ++i, v >>= 8 )
+    {
+    p[i] = static_cast<uint8_t>( v & 0xff );
+    }
+}
+
+uint64_t GetUInt64LE( const uint8_t *p )
+{
+  uint64_t v = 0;
+  for ( unsigned int i = 8; i > 0; --i )
+    {
+    v = ( v << 8 ) | p[i-1];
+    }
+  return v;
+}
+
+
+/** The division of an image into chunks, the first dimension is
+ * fastest. */
+struct ChunkGrid
+{
+  ChunkGrid( const std::vector<uint64_t> &size, const std::vector<uint64_t> &chunkSize )
+    : m_Size( size ),
+      m_ChunkSize( chunkSize ),
+      m_GridSize( size.size() ),
+      m_NumberOfChunks( 1 )
+    {
+      for ( size_t i = 0; i < size.size(); ++i )
+        {
+        m_GridSize[i] = ( size[i] + chunkSize[i] - 1 ) / chunkSize[i];
+        m_NumberOfChunks *= m_GridSize[i];
+        }
+    }
+
+  /** The start and size of a chunk, clipped to the image. */
+  void GetChunkRegion( uint64_t chunk, std::vector<uint64_t> &start, std::vector<uint64_t> &size ) const
+    {
+      start.resize( m_Size.size() );
+      size.resize( m_Size.size() );
+      for ( size_t i = 0; i < m_Size.size(); ++i )
+        {
+        start[i] = ( chunk % m_GridSize[i] ) * m_ChunkSize[i];
+        size[i] = std::min( m_ChunkSize[i], m_Size[i] - start[i] );
+        chunk /= m_GridSize[i];
+        }
+    }
+
+  std::vector<uint64_t> m_Size;
+  std::vector<uint64_t> m_ChunkSize;
+  std::vector<uint64_t> m_GridSize;
+  uint64_t              m_NumberOfChunks;
+};
+
+
+/** Copy the pixels of the box [start, start+size) from the block at
+ * srcStart with srcSize, to the block at dstStart with dstSize. */
+void CopyBlock( const uint8_t *src, const std::vector<uint64_t> &srcStart, const std::vector<uint64_t> &srcSize,
+                uint8_t *dst, const std::vector<uint64_t> &dstStart, const std::vector<uint64_t> &dstSize,
+                const std::vector<uint64_t> &start, const std::vector<uint64_t> &size,
+                size_t pixelSize )
+{
+  const size_t dimension = start.size();
+  if ( std::find( size.begin(), size.end(), 0u ) != size.end() )
+    {
+    return;
+    }
+
+  const size_t rowLength = static_cast<size_t>( size[0] ) * pixelSize;
+  std::vector<uint64_t> index( start );
+  while ( true )
+    {
+    uint64_t srcOffset = 0;
+    uint64_t dstOffset = 0;
+    uint64_t srcStride = 1;
+    uint64_t dstStride = 1;
+    for ( size_t d = 0; d < dimension; ++d )
+      {
+      srcOffset += ( index[d] - srcStart[d] ) * srcStride;
+      dstOffset += ( index[d] - dstStart[d] ) * dstStride;
+      srcStride *= srcSize[d];
+      dstStride *= dstSize[d];
+      }
+    std::memcpy( dst + dstOffset * pixelSize, src + srcOffset * pixelSize, rowLength );
+
+    // advance to the next row of the box
+    size_t d = 1;
+    while ( d < dimension && ++index[d] == start[d] + size[d] )
+      {
+      index[d] = start[d];
+      ++d;
+      }
+    if ( d >= dimension )
+      {
+      break;
+      }
+    }
+}
+
+
+/** The sizes of the levels of the pyramid, and the shrink factors of
+ * each level from the first level. */
+void ComputePyramidLevels( const std::vector<uint64_t> &size,
+                           unsigned int numberOfLevels,
+                           std::vector< std::vector<uint64_t> > &levelSizes,
+                           std::vector< std::vector<uint64_t> > &levelFactors )
+{
+  levelSizes.assign( 1, size );
+  levelFactors.assign( 1, std::vector<uint64_t>( size.size(), 1 ) );
+  for ( unsigned int level = 1; level < numberOfLevels; ++level )
+    {
+    std::vector<uint64_t> levelSize( levelSizes.back() );
+    std::vector<uint64_t> levelFactor( levelFactors.back() );
+    for ( size_t d = 0; d < size.size(); ++d )
+      {
+      if ( levelSize[d] >= 2 )
+        {
+        levelSize[d] /= 2;
+        levelFactor[d] *= 2;
+        }
+      }
+    levelSizes.push_back( levelSize );
+    levelFactors.push_back( levelFactor );
+    }
+}
+
+template <typename T>
+T ConvertAverage( double value )
+{
+  return std::numeric_limits<T>::is_integer ? static_cast<T>( itk::Math::Round<double>( value ) ) : static_cast<T>( value );
+}
+
+/** Average each bin of factor pixels of the input into a pixel of
+ * the output, the first dimension is fastest. */
+template <typename T>
+void BinShrink( const uint8_t *input, const std::vector<uint64_t> &inputSize,
+                uint8_t *output, const std::vector<uint64_t> &outputSize,
+                const std::vector<uint64_t> &factor, unsigned int numberOfComponents )
+{
+  const T *in = reinterpret_cast<const T *>( input );
+  T *out = reinterpret_cast<T *>( output );
+  const size_t dimension = inputSize.size();
+
+  uint64_t numberOfOutputElements = numberOfComponents;
+  uint64_t numberOfSamples = 1;
+  for ( size_t d = 0; d < dimension; ++d )
+    {
+    numberOfOutputElements *= outputSize[d];
+    numberOfSamples *= factor[d];
+    }
+  std::vector<double> sum( static_cast<size_t>( numberOfOutputElements ), 0.0 );
+
+  // accumulate the rows of the input which are inside of a bin
+  std::vector<uint64_t> index( dimension, 0 );
+  const uint64_t rowLength = outputSize[0] * factor[0];
+  while ( true )
+    {
+    uint64_t inOffset = 0;
+    uint64_t outOffset = 0;
+    uint64_t inStride = 1;
+    uint64_t outStride = 1;
+    for ( size_t d = 1; d < dimension; ++d )
+      {
+      inStride *= inputSize[d-1];
+      outStride *= outputSize[d-1];
+      inOffset += index[d] * inStride;
+      outOffset += ( index[d] / factor[d] ) * outStride;
+      }
+    for ( uint64_t x = 0; x < rowLength; ++x )
+      {
+      const T *pixel = in + ( inOffset + x ) * numberOfComponents;
+      double *bin = &sum[static_cast<size_t>( ( outOffset + x / factor[0] ) * numberOfComponents )];
+      for ( unsigned int c = 0; c < numberOfComponents; ++c )
+        {
+        bin[c] += static_cast<double>( pixel[c] );
+        }
+      }
+
+    size_t d = 1;
+    while ( d < dimension && ++index[d] == outputSize[d] * factor[d] )
+      {
+      index[d] = 0;
+      ++d;
+      }
+    if ( d >= dimension )
+      {
+      break;
+      }
+    }
+
+  for ( size_t i = 0; i < sum.size(); ++i )
+    {
+    out[i] = ConvertAverage<T>( sum[i] / static_cast<double>( numberOfSamples ) );
+    }
+}
+
+void BinShrink( itk::ImageIOBase::IOComponentType componentType,
+                const uint8_t *input, const std::vector<uint64_t> &inputSize,
+                uint8_t *output, const std::vector<uint64_t> &outputSize,
+                const std::vector<uint64_t> &factor, unsigned int numberOfComponents )
+{
+  switch ( componentType )
+    {
+    case itk::ImageIOBase::UCHAR:
+      BinShrink<unsigned char>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::CHAR:
+      BinShrink<char>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::USHORT:
+      BinShrink<unsigned short>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::SHORT:
+      BinShrink<short>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::UINT:
+      BinShrink<unsigned int>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::INT:
+      BinShrink<int>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::ULONG:
+      BinShrink<unsigned long>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::LONG:
+      BinShrink<long>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::ULONGLONG:
+      BinShrink<unsigned long long>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::LONGLONG:
+      BinShrink<long long>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::FLOAT:
+      BinShrink<float>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    case itk::ImageIOBase::DOUBLE:
+      BinShrink<double>( input, inputSize, output, outputSize, factor, numberOfComponents );
+      break;
+    default:
+      sitkExceptionMacro( "Pyramid levels can not be computed for the component type "
+                          << itk::ImageIOBase::GetComponentTypeAsString( componentType ) << "." );
+    }
+}
+
+
+/** The chunks of a batch, which are encoded or decoded in parallel
+ * while the file is read or written sequentially. */
+struct ChunkBatchThreadStruct
+{
+  const ChunkGrid                     *m_Grid;
+  std::vector<uint64_t>                m_Chunks;
+  std::vector< std::vector<uint8_t> >  m_Data;
+  std::vector<std::string>             m_Errors;
+  size_t                               m_PixelSize;
+  bool                                 m_Compressed;
+
+  // encoding from the whole image
+  const uint8_t                       *m_Input;
+  int                                  m_DeflateLevel;
+
+  // decoding into the buffer of a region
+  uint8_t                             *m_Output;
+  std::vector<uint64_t>                m_RegionStart;
+  std::vector<uint64_t>                m_RegionSize;
+  unsigned int                         m_SwapComponentSize;
+};
+
+ITK_THREAD_RETURN_TYPE EncodeChunksThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  ChunkBatchThreadStruct *str = static_cast<ChunkBatchThreadStruct *>( info->UserData );
+
+  const std::vector<uint64_t> origin( str->m_Grid->m_Size.size(), 0 );
+  std::vector<uint64_t> start;
+  std::vector<uint64_t> size;
+  for ( size_t i = info->ThreadID; i < str->m_Chunks.size() && str->m_Errors[info->ThreadID].empty(); i += info->NumberOfThreads )
+    {
+    str->m_Grid->GetChunkRegion( str->m_Chunks[i], start, size );
+    uint64_t numberOfPixels = 1;
+    for ( size_t d = 0; d < size.size(); ++d )
+      {
+      numberOfPixels *= size[d];
+      }
+
+    std::vector<uint8_t> raw( static_cast<size_t>( numberOfPixels ) * str->m_PixelSize );
+    CopyBlock( str->m_Input, origin, str->m_Grid->m_Size, &raw[0], start, size, start, size, str->m_PixelSize );
+
+    if ( !str->m_Compressed )
+      {
+      str->m_Data[i].swap( raw );
+      continue;
+      }
+
+    uLongf length = compressBound( static_cast<uLong>( raw.size() ) );
+    str->m_Data[i].resize( length );
+    const int status = compress2( &str->m_Data[i][0], &length, &raw[0], static_cast<uLong>( raw.size() ),
+                                  ( str->m_DeflateLevel < 0 ) ? Z_DEFAULT_COMPRESSION : str->m_DeflateLevel );
+    if ( status != Z_OK )
+      {
+      std::ostringstream msg;
+      msg << "Compression of a chunk failed with zlib error " << status << ".";
+      str->m_Errors[info->ThreadID] = msg.str();
+      }
+    str->m_Data[i].resize( length );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+ITK_THREAD_RETURN_TYPE DecodeChunksThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  ChunkBatchThreadStruct *str = static_cast<ChunkBatchThreadStruct *>( info->UserData );
+
+  const size_t dimension = str->m_Grid->m_Size.size();
+  std::vector<uint64_t> start;
+  std::vector<uint64_t> size;
+  std::vector<uint64_t> overlapStart( dimension );
+  std::vector<uint64_t> overlapSize( dimension );
+  for ( size_t i = info->ThreadID; i < str->m_Chunks.size() && str->m_Errors[info->ThreadID].empty(); i += info->NumberOfThreads )
+    {
+    str->m_Grid->GetChunkRegion( str->m_Chunks[i], start, size );
+    uint64_t numberOfPixels = 1;
+    for ( size_t d = 0; d < dimension; ++d )
+      {
+      numberOfPixels *= size[d];
+      }
+
+    std::vector<uint8_t> raw;
+    if ( str->m_Compressed )
+      {
+      raw.resize( static_cast<size_t>( numberOfPixels ) * str->m_PixelSize );
+      uLongf length = static_cast<uLongf>( raw.size() );
+      const int status = uncompress( &raw[0], &length,
+                                     str->m_Data[i].empty() ? SITK_NULLPTR : &str->m_Data[i][0],
+                                     static_cast<uLong>( str->m_Data[i].size() ) );
+      if ( status != Z_OK || length != raw.size() )
+        {
+        str->m_Errors[info->ThreadID] = "A compressed chunk of the file is corrupt.";
+        continue;
+        }
+      std::vector<uint8_t>().swap( str->m_Data[i] );
+      }
+    else
+      {
+      raw.swap( str->m_Data[i] );
+      if ( raw.size() != numberOfPixels * str->m_PixelSize )
+        {
+        str->m_Errors[info->ThreadID] = "A chunk of the file does not have the size of its pixels.";
+        continue;
+        }
+      }
+
+    if ( str->m_SwapComponentSize > 1 )
+      {
+      for ( size_t j = 0; j < raw.size(); j += str->m_SwapComponentSize )
+        {
+        std::reverse( raw.begin() + j, raw.begin() + j + str->m_SwapComponentSize );
+        }
+      }
+
+    for ( size_t d = 0; d < dimension; ++d )
+      {
+      overlapStart[d] = std::max( start[d], str->m_RegionStart[d] );
+      const uint64_t end = std::min( start[d] + size[d], str->m_RegionStart[d] + str->m_RegionSize[d] );
+      overlapSize[d] = ( end > overlapStart[d] ) ? end - overlapStart[d] : 0;
+      }
+    CopyBlock( &raw[0], start, size, str->m_Output, str->m_RegionStart, str->m_RegionSize,
+               overlapStart, overlapSize, str->m_PixelSize );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void RunChunkBatch( ChunkBatchThreadStruct &str, ITK_THREAD_RETURN_TYPE (*callback)( void * ), unsigned int maximumNumberOfThreads )
+{
+  const itk::ThreadIdType numberOfThreads =
+    std::max<itk::ThreadIdType>( 1, std::min<size_t>( maximumNumberOfThreads, str.m_Chunks.size() ) );
+  str.m_Errors.assign( numberOfThreads, std::string() );
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( callback, &str );
+  threader->SingleMethodExecute();
+
+  for ( size_t i = 0; i < str.m_Errors.size(); ++i )
+    {
+    if ( !str.m_Errors[i].empty() )
+      {
+      sitkExceptionMacro( str.m_Errors[i] );
+      }
+    }
+}
+
+/** Encode and write the chunks of a level, recording them in the
+ * index at firstChunk. */
+void WriteChunks( std::ofstream &out, ChunkBatchThreadStruct &str, uint64_t firstChunk,
+                  std::vector<uint8_t> &index, unsigned int numberOfThreads )
+{
+  // The chunks are encoded in parallel in batches, which are written
+  // sequentially.
+  const uint64_t numberOfChunks = str.m_Grid->m_NumberOfChunks;
+  const uint64_t batchSize = 4 * static_cast<uint64_t>( numberOfThreads );
+  for ( uint64_t begin = 0; begin < numberOfChunks; begin += batchSize )
+    {
+    const uint64_t end = std::min( numberOfChunks, begin + batchSize );
+    str.m_Chunks.clear();
+    for ( uint64_t chunk = begin; chunk < end; ++chunk )
+      {
+      str.m_Chunks.push_back( chunk );
+      }
+    str.m_Data.assign( str.m_Chunks.size(), std::vector<uint8_t>() );
+
+    RunChunkBatch( str, EncodeChunksThreaderCallback, numberOfThreads );
+
+    for ( size_t i = 0; i < str.m_Chunks.size(); ++i )
+      {
+      const size_t entry = static_cast<size_t>( firstChunk + str.m_Chunks[i] );
+      PutUInt64LE( &index[16 * entry], static_cast<uint64_t>( out.tellp() ) );
+      PutUInt64LE( &index[16 * entry + 8], str.m_Data[i].size() );
+      out.write( reinterpret_cast<const char *>( &str.m_Data[i][0] ), str.m_Data[i].size() );
+      }
+    }
+}
+
+itk::SimpleFastMutexLock RegisterFactoryMutex;
+
+}
+
+
+ChunkedImageIO::ChunkedImageIO()
+  : m_DeflateLevel( -1 ),
+    m_NumberOfPyramidLevels( 1 ),
+    m_PyramidLevel( 0 ),
+    m_NumberOfThreads( itk::MultiThreader::GetGlobalDefaultNumberOfThreads() ),
+    m_LevelFirstChunk( 0 ),
+    m_HeaderLength( 0 ),
+    m_FileCompressed( false ),
+    m_FileBigEndian( false )
+{
+  this->AddSupportedReadExtension( ".sitkc" );
+  this->AddSupportedWriteExtension( ".sitkc" );
+}
+
+
+void ChunkedImageIO::PrintSelf( std::ostream &os, itk::Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "ChunkSize:";
+  for ( size_t i = 0; i < m_ChunkSize.size(); ++i )
+    {
+    os << " " << m_ChunkSize[i];
+    }
+  os << std::endl;
+  os << indent << "DeflateLevel: " << m_DeflateLevel << std::endl;
+  os << indent << "NumberOfPyramidLevels: " << m_NumberOfPyramidLevels << std::endl;
+  os << indent << "PyramidLevel: " << m_PyramidLevel << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+}
+
+
+bool ChunkedImageIO::CanReadFile( const char *fileName )
+{
+  std::ifstream in( fileName, std::ios::in | std::ios::binary );
+  if ( !in )
+    {
+    return false;
+    }
+  const size_t length = std::strlen( ChunkedImageMagic );
+  std::string magic( length, '\0' );
+  in.read( &magic[0], length );
+  return in && magic == ChunkedImageMagic;
+}
+
+
+void ChunkedImageIO::ReadImageInformation( void )
+{
+  std::ifstream in( m_FileName.c_str(), std::ios::in | std::ios::binary );
+  if ( !in )
+    {
+    sitkExceptionMacro( "Unable to open \"" << m_FileName << "\" for reading." );
+    }
+
+  FieldMap fields;
+  bool hasChunkIndex = false;
+  std::string line;
+  while ( !hasChunkIndex && std::getline( in, line ) )
+    {
+    if ( TrimString( line ).empty() )
+      {
+      continue;
+      }
+    const size_t eq = line.find( '=' );
+    if ( eq == std::string::npos || ( fields.empty() && TrimString( line.substr( 0, eq ) ) != ChunkedImageMagic ) )
+      {
+      sitkExceptionMacro( "The file \"" << m_FileName << "\" is not a SimpleITK chunked image." );
+      }
+    const std::string key = TrimString( line.substr( 0, eq ) );
+    fields[key] = TrimString( line.substr( eq + 1 ) );
+    hasChunkIndex = ( key == "ChunkIndex" );
+    }
+  if ( !hasChunkIndex || fields["ChunkIndex"] != "LOCAL" )
+    {
+    sitkExceptionMacro( "The chunked image \"" << m_FileName << "\" has no chunk index." );
+    }
+
+  const unsigned int dimension = ParseValues<unsigned int>( fields, "NDims", 1 )[0];
+  if ( dimension == 0 )
+    {
+    sitkExceptionMacro( "The chunked image \"" << m_FileName << "\" has zero dimensions." );
+    }
+  const std::vector<uint64_t> size = ParseValues<uint64_t>( fields, "DimSize", dimension );
+  m_FileChunkSize = ParseValues<uint64_t>( fields, "ChunkSize", dimension );
+  if ( std::find( m_FileChunkSize.begin(), m_FileChunkSize.end(), 0u ) != m_FileChunkSize.end() )
+    {
+    sitkExceptionMacro( "The chunked image \"" << m_FileName << "\" has a zero ChunkSize." );
+    }
+  const std::vector<double> origin = ParseValues<double>( fields, "Origin", dimension );
+  const std::vector<double> spacing = ParseValues<double>( fields, "Spacing", dimension );
+  const std::vector<double> direction = ParseValues<double>( fields, "Direction", dimension * dimension );
+
+  m_NumberOfPyramidLevels = 1;
+  if ( fields.count( "NumberOfPyramidLevels" ) )
+    {
+    m_NumberOfPyramidLevels = ParseValues<unsigned int>( fields, "NumberOfPyramidLevels", 1 )[0];
+    }
+  if ( m_NumberOfPyramidLevels == 0 || m_PyramidLevel >= m_NumberOfPyramidLevels )
+    {
+    sitkExceptionMacro( "The pyramid level " << m_PyramidLevel << " is not in the "
+                        << m_NumberOfPyramidLevels << " levels of \"" << m_FileName << "\"." );
+    }
+  std::vector< std::vector<uint64_t> > levelSizes;
+  std::vector< std::vector<uint64_t> > levelFactors;
+  ComputePyramidLevels( size, m_NumberOfPyramidLevels, levelSizes, levelFactors );
+
+  uint64_t numberOfChunks = 0;
+  for ( unsigned int level = 0; level < m_NumberOfPyramidLevels; ++level )
+    {
+    if ( level == m_PyramidLevel )
+      {
+      m_LevelFirstChunk = numberOfChunks;
+      }
+    numberOfChunks += ChunkGrid( levelSizes[level], m_FileChunkSize ).m_NumberOfChunks;
+    }
+
+  // the origin of a level is the center of the first bin of pixels
+  const std::vector<uint64_t> &levelSize = levelSizes[m_PyramidLevel];
+  const std::vector<uint64_t> &levelFactor = levelFactors[m_PyramidLevel];
+  this->SetNumberOfDimensions( dimension );
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    double levelOrigin = origin[i];
+    for ( unsigned int j = 0; j < dimension; ++j )
+      {
+      levelOrigin += direction[i * dimension + j] * spacing[j] * 0.5 * ( levelFactor[j] - 1.0 );
+      }
+    this->SetDimensions( i, static_cast<SizeValueType>( levelSize[i] ) );
+    this->SetOrigin( i, levelOrigin );
+    this->SetSpacing( i, spacing[i] * levelFactor[i] );
+    std::vector<double> axis( dimension );
+    for ( unsigned int r = 0; r < dimension; ++r )
+      {
+      axis[r] = direction[r * dimension + i];
+      }
+    this->SetDirection( i, axis );
+    }
+
+  this->SetComponentType( ImageIOBase::GetComponentTypeFromString( GetField( fields, "ComponentType" ) ) );
+  this->SetPixelType( ImageIOBase::GetPixelTypeFromString( GetField( fields, "PixelType" ) ) );
+  this->SetNumberOfComponents( ParseValues<unsigned int>( fields, "NumberOfComponents", 1 )[0] );
+  if ( this->GetComponentType() == UNKNOWNCOMPONENTTYPE || this->GetNumberOfComponents() == 0 )
+    {
+    sitkExceptionMacro( "The chunked image \"" << m_FileName << "\" has an unsupported pixel type." );
+    }
+
+  m_FileBigEndian = ( GetField( fields, "ByteOrderMSB" ) == "True" );
+  this->m_ByteOrder = m_FileBigEndian ? BigEndian : LittleEndian;
+
+  const std::string &compression = GetField( fields, "Compression" );
+  if ( compression != "Deflate" && compression != "None" )
+    {
+    sitkExceptionMacro( "The chunked image \"" << m_FileName << "\" has the unsupported compression \"" << compression << "\"." );
+    }
+  m_FileCompressed = ( compression == "Deflate" );
+
+  if ( ParseValues<uint64_t>( fields, "NumberOfChunks", 1 )[0] != numberOfChunks )
+    {
+    sitkExceptionMacro( "The chunked image \"" << m_FileName << "\" has " << GetField( fields, "NumberOfChunks" )
+                        << " chunks, but " << numberOfChunks << " are expected." );
+    }
+
+  std::vector<uint8_t> index( static_cast<size_t>( numberOfChunks ) * 16 );
+  m_HeaderLength = static_cast<uint64_t>( in.tellg() ) + index.size();
+  if ( !index.empty() )
+    {
+    in.read( reinterpret_cast<char *>( &index[0] ), index.size() );
+    }
+  if ( !in )
+    {
+    sitkExceptionMacro( "Unable to read the chunk index of \"" << m_FileName << "\"." );
+    }
+  m_ChunkOffsets.resize( static_cast<size_t>( numberOfChunks ) );
+  m_ChunkLengths.resize( static_cast<size_t>( numberOfChunks ) );
+  for ( size_t i = 0; i < m_ChunkOffsets.size(); ++i )
+    {
+    m_ChunkOffsets[i] = GetUInt64LE( &index[16 * i] );
+    m_ChunkLengths[i] = GetUInt64LE( &index[16 * i + 8] );
+    }
+}
+
+
+void ChunkedImageIO::Read( void *buffer )
+{
+  const unsigned int dimension = this->GetNumberOfDimensions();
+
+  std::vector<uint64_t> size( dimension );
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    size[i] = this->GetDimensions( i );
+    }
+  const ChunkGrid grid( size, m_FileChunkSize );
+
+  ChunkBatchThreadStruct str;
+  str.m_Grid = &grid;
+  str.m_PixelSize = this->GetComponentSize() * this->GetNumberOfComponents();
+  str.m_Compressed = m_FileCompressed;
+  str.m_Input = SITK_NULLPTR;
+  str.m_DeflateLevel = m_DeflateLevel;
+  str.m_Output = static_cast<uint8_t *>( buffer );
+  str.m_SwapComponentSize = ( m_FileBigEndian != itk::ByteSwapper<uint16_t>::SystemIsBigEndian() )
+    ? static_cast<unsigned int>( this->GetComponentSize() ) : 1u;
+
+  // the region to read, and the chunks which intersect it
+  std::vector<uint64_t> chunks;
+  this->GetChunksOfRegion( m_IORegion, str.m_RegionStart, str.m_RegionSize, chunks );
+  if ( chunks.empty() )
+    {
+    return;
+    }
+
+  std::ifstream in( m_FileName.c_str(), std::ios::in | std::ios::binary );
+  if ( !in )
+    {
+    sitkExceptionMacro( "Unable to open \"" << m_FileName << "\" for reading." );
+    }
+
+  // The chunks are read sequentially in batches, which are decoded in
+  // parallel.
+  const size_t batchSize = 4 * static_cast<size_t>( m_NumberOfThreads );
+  for ( size_t begin = 0; begin < chunks.size(); begin += batchSize )
+    {
+    const size_t end = std::min( chunks.size(), begin + batchSize );
+    str.m_Chunks.assign( chunks.begin() + begin, chunks.begin() + end );
+    str.m_Data.assign( str.m_Chunks.size(), std::vector<uint8_t>() );
+    for ( size_t i = 0; i < str.m_Chunks.size(); ++i )
+      {
+      const size_t chunk = static_cast<size_t>( m_LevelFirstChunk + str.m_Chunks[i] );
+      str.m_Data[i].resize( static_cast<size_t>( m_ChunkLengths[chunk] ) );
+      in.seekg( static_cast<std::streamoff>( m_ChunkOffsets[chunk] ) );
+      if ( !str.m_Data[i].empty() )
+        {
+        in.read( reinterpret_cast<char *>( &str.m_Data[i][0] ), str.m_Data[i].size() );
+        }
+      if ( !in )
+        {
+        sitkExceptionMacro( "Unable to read chunk " << chunk << " of \"" << m_FileName << "\"." );
+        }
+      }
+
+    RunChunkBatch( str, DecodeChunksThreaderCallback, m_NumberOfThreads );
+    }
+}
+
+
+void ChunkedImageIO::GetChunksOfRegion( const ImageIORegion &region,
+                                        std::vector<uint64_t> &regionStart,
+                                        std::vector<uint64_t> &regionSize,
+                                        std::vector<uint64_t> &chunks ) const
+{
+  const unsigned int dimension = this->GetNumberOfDimensions();
+
+  std::vector<uint64_t> size( dimension );
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    size[i] = this->GetDimensions( i );
+    }
+  const ChunkGrid grid( size, m_FileChunkSize );
+
+  chunks.clear();
+  regionStart.resize( dimension );
+  regionSize.resize( dimension );
+  std::vector<uint64_t> firstChunk( dimension );
+  std::vector<uint64_t> lastChunk( dimension );
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    const bool inRegion = ( i < region.GetImageDimension() );
+    regionStart[i] = inRegion ? static_cast<uint64_t>( region.GetIndex( i ) ) : 0;
+    regionSize[i] = inRegion ? static_cast<uint64_t>( region.GetSize( i ) ) : 1;
+    if ( regionSize[i] == 0 )
+      {
+      return;
+      }
+    if ( regionStart[i] + regionSize[i] > size[i] )
+      {
+      sitkExceptionMacro( "The requested region is outside of the chunked image \"" << m_FileName << "\"." );
+      }
+    firstChunk[i] = regionStart[i] / m_FileChunkSize[i];
+    lastChunk[i] = ( regionStart[i] + regionSize[i] - 1 ) / m_FileChunkSize[i];
+    }
+
+  std::vector<uint64_t> chunkIndex( firstChunk );
+  while ( true )
+    {
+    uint64_t chunk = 0;
+    uint64_t stride = 1;
+    for ( unsigned int d = 0; d < dimension; ++d )
+      {
+      chunk += chunkIndex[d] * stride;
+      stride *= grid.m_GridSize[d];
+      }
+    chunks.push_back( chunk );
+
+    unsigned int d = 0;
+    while ( d < dimension && ++chunkIndex[d] > lastChunk[d] )
+      {
+      chunkIndex[d] = firstChunk[d];
+      ++d;
+      }
+    if ( d >= dimension )
+      {
+      break;
+      }
+    }
+}
+
+
+void ChunkedImageIO::GetChunkByteRanges( const ImageIORegion &region,
+                                         std::vector<uint64_t> &offsets,
+                                         std::vector<uint64_t> &lengths ) const
+{
+  std::vector<uint64_t> regionStart;
+  std::vector<uint64_t> regionSize;
+  std::vector<uint64_t> chunks;
+  this->GetChunksOfRegion( region, regionStart, regionSize, chunks );
+
+  offsets.resize( chunks.size() );
+  lengths.resize( chunks.size() );
+  for ( size_t i = 0; i < chunks.size(); ++i )
+    {
+    const size_t chunk = static_cast<size_t>( m_LevelFirstChunk + chunks[i] );
+    offsets[i] = m_ChunkOffsets[chunk];
+    lengths[i] = m_ChunkLengths[chunk];
+    }
+}
+
+
+bool ChunkedImageIO::CanWriteFile( const char *fileName )
+{
+  std::string extension = itksys::SystemTools::GetFilenameLastExtension( fileName );
+  std::transform( extension.begin(), extension.end(), extension.begin(), ::tolower );
+  return extension == ".sitkc";
+}
+
+
+std::string ChunkedImageIO::MakeHeader( const std::vector<uint64_t> &size,
+                                        const std::vector<uint64_t> &chunkSize,
+                                        uint64_t numberOfChunks ) const
+{
+  const unsigned int dimension = static_cast<unsigned int>( size.size() );
+
+  std::ostringstream header;
+  header << std::setprecision( 17 );
+  header << ChunkedImageMagic << " = 1\n";
+  header << "NDims = " << dimension << "\n";
+  header << "DimSize =";
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    header << " " << size[i];
+    }
+  header << "\nChunkSize =";
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    header << " " << chunkSize[i];
+    }
+  header << "\n";
+  header << "ComponentType = " << ImageIOBase::GetComponentTypeAsString( this->GetComponentType() ) << "\n";
+  header << "PixelType = " << ImageIOBase::GetPixelTypeAsString( this->GetPixelType() ) << "\n";
+  header << "NumberOfComponents = " << this->GetNumberOfComponents() << "\n";
+  header << "ByteOrderMSB = " << ( itk::ByteSwapper<uint16_t>::SystemIsBigEndian() ? "True" : "False" ) << "\n";
+  header << "Compression = " << ( this->GetUseCompression() ? "Deflate" : "None" ) << "\n";
+  header << "Origin =";
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    header << " " << this->GetOrigin( i );
+    }
+  header << "\nSpacing =";
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    header << " " << this->GetSpacing( i );
+    }
+  header << "\nDirection =";
+  for ( unsigned int r = 0; r < dimension; ++r )
+    {
+    for ( unsigned int c = 0; c < dimension; ++c )
+      {
+      header << " " << this->GetDirection( c )[r];
+      }
+    }
+  header << "\n";
+  header << "NumberOfPyramidLevels = " << m_NumberOfPyramidLevels << "\n";
+  header << "NumberOfChunks = " << numberOfChunks << "\n";
+  header << "ChunkIndex = LOCAL\n";
+
+  return header.str();
+}
+
+
+void ChunkedImageIO::Write( const void *buffer )
+{
+  const unsigned int dimension = this->GetNumberOfDimensions();
+
+  if ( m_ChunkSize.size() > dimension )
+    {
+    sitkExceptionMacro( "The ChunkSize has " << m_ChunkSize.size() << " elements, but the image has "
+                        << dimension << " dimensions." );
+    }
+
+  std::vector<uint64_t> size( dimension );
+  std::vector<uint64_t> chunkSize( dimension );
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    size[i] = this->GetDimensions( i );
+    if ( i < m_IORegion.GetImageDimension()
+         && ( m_IORegion.GetIndex( i ) != 0 || static_cast<uint64_t>( m_IORegion.GetSize( i ) ) != size[i] ) )
+      {
+      sitkExceptionMacro( "Streamed writing of a chunked image is not supported." );
+      }
+    chunkSize[i] = ( i < m_ChunkSize.size() ) ? m_ChunkSize[i] : DefaultChunkSize;
+    if ( chunkSize[i] == 0 )
+      {
+      sitkExceptionMacro( "The ChunkSize must not be zero." );
+      }
+    chunkSize[i] = std::min( chunkSize[i], std::max<uint64_t>( size[i], 1 ) );
+    }
+
+  std::vector< std::vector<uint64_t> > levelSizes;
+  std::vector< std::vector<uint64_t> > levelFactors;
+  ComputePyramidLevels( size, m_NumberOfPyramidLevels, levelSizes, levelFactors );
+  uint64_t numberOfChunks = 0;
+  for ( unsigned int level = 0; level < m_NumberOfPyramidLevels; ++level )
+    {
+    numberOfChunks += ChunkGrid( levelSizes[level], chunkSize ).m_NumberOfChunks;
+    }
+
+  const std::string headerString = this->MakeHeader( size, chunkSize, numberOfChunks );
+
+  std::ofstream out( m_FileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+  if ( !out )
+    {
+    sitkExceptionMacro( "Unable to open \"" << m_FileName << "\" for writing." );
+    }
+
+  out.write( headerString.c_str(), headerString.size() );
+
+  // the index is written after the chunks, when their offsets are known
+  std::vector<uint8_t> index( static_cast<size_t>( numberOfChunks ) * 16, 0 );
+  const std::streamoff indexPosition = out.tellp();
+  if ( !index.empty() )
+    {
+    out.write( reinterpret_cast<const char *>( &index[0] ), index.size() );
+    }
+
+  ChunkBatchThreadStruct str;
+  str.m_PixelSize = this->GetComponentSize() * this->GetNumberOfComponents();
+  str.m_Compressed = this->GetUseCompression();
+  str.m_Input = static_cast<const uint8_t *>( buffer );
+  str.m_DeflateLevel = m_DeflateLevel;
+  str.m_Output = SITK_NULLPTR;
+  str.m_SwapComponentSize = 1;
+
+  // each level is shrunk from the previous level
+  std::vector<uint8_t> level;
+  std::vector<uint8_t> previousLevel;
+  uint64_t firstChunk = 0;
+  for ( unsigned int l = 0; l < m_NumberOfPyramidLevels; ++l )
+    {
+    if ( l > 0 )
+      {
+      uint64_t numberOfPixels = 1;
+      std::vector<uint64_t> factor( dimension );
+      for ( unsigned int d = 0; d < dimension; ++d )
+        {
+        numberOfPixels *= levelSizes[l][d];
+        factor[d] = levelFactors[l][d] / levelFactors[l-1][d];
+        }
+      level.swap( previousLevel );
+      level.resize( static_cast<size_t>( numberOfPixels ) * str.m_PixelSize );
+      BinShrink( this->GetComponentType(), str.m_Input, levelSizes[l-1], &level[0], levelSizes[l],
+                 factor, this->GetNumberOfComponents() );
+      }
+
+    const ChunkGrid grid( levelSizes[l], chunkSize );
+    str.m_Grid = &grid;
+    if ( l > 0 )
+      {
+      str.m_Input = &level[0];
+      }
+    WriteChunks( out, str, firstChunk, index, m_NumberOfThreads );
+    firstChunk += grid.m_NumberOfChunks;
+    }
+
+  out.seekp( indexPosition );
+  if ( !index.empty() )
+    {
+    out.write( reinterpret_cast<const char *>( &index[0] ), index.size() );
+    }
+  out.close();
+  if ( out.fail() )
+    {
+    sitkExceptionMacro( "Error writing the chunked image \"" << m_FileName << "\"." );
+    }
+}
+
+
+void ChunkedImageIO::WriteFromChunkFiles( const std::vector<std::string> &chunkFileNames )
+{
+  const unsigned int dimension = this->GetNumberOfDimensions();
+
+  if ( m_ChunkSize.size() > dimension )
+    {
+    sitkExceptionMacro( "The ChunkSize has " << m_ChunkSize.size() << " elements, but the image has "
+                        << dimension << " dimensions." );
+    }
+
+  std::vector<uint64_t> size( dimension );
+  std::vector<uint64_t> chunkSize( dimension );
+  for ( unsigned int i = 0; i < dimension; ++i )
+    {
+    size[i] = this->GetDimensions( i );
+    chunkSize[i] = ( i < m_ChunkSize.size() ) ? m_ChunkSize[i] : DefaultChunkSize;
+    if ( chunkSize[i] == 0 )
+      {
+      sitkExceptionMacro( "The ChunkSize must not be zero." );
+      }
+    chunkSize[i] = std::min( chunkSize[i], std::max<uint64_t>( size[i], 1 ) );
+    }
+
+  const ChunkGrid grid( size, chunkSize );
+  if ( chunkFileNames.size() != grid.m_NumberOfChunks )
+    {
+    sitkExceptionMacro( "There are " << chunkFileNames.size() << " chunk files, but the image has "
+                        << grid.m_NumberOfChunks << " chunks." );
+    }
+
+  // The chunks are copied as they are encoded, so all the files must
+  // have the pixel type, byte order and compression of the first.
+  std::vector<ChunkedImageIO::Pointer> chunkIOs( chunkFileNames.size() );
+  std::vector<uint64_t> start;
+  std::vector<uint64_t> regionSize;
+  for ( size_t c = 0; c < chunkFileNames.size(); ++c )
+    {
+    chunkIOs[c] = ChunkedImageIO::New();
+    chunkIOs[c]->SetFileName( chunkFileNames[c] );
+    chunkIOs[c]->ReadImageInformation();
+    const ChunkedImageIO *chunkIO = chunkIOs[c].GetPointer();
+
+    grid.GetChunkRegion( c, start, regionSize );
+    bool sameSize = ( chunkIO->GetNumberOfDimensions() == dimension );
+    for ( unsigned int i = 0; sameSize && i < dimension; ++i )
+      {
+      sameSize = ( chunkIO->GetDimensions( i ) == regionSize[i] );
+      }
+    if ( !sameSize || chunkIO->m_ChunkOffsets.size() != 1 )
+      {
+      sitkExceptionMacro( "The chunk file \"" << chunkFileNames[c] << "\" is not one chunk of the size of chunk "
+                          << c << " of the image." );
+      }
+    if ( chunkIO->GetComponentType() != chunkIOs[0]->GetComponentType()
+         || chunkIO->GetPixelType() != chunkIOs[0]->GetPixelType()
+         || chunkIO->GetNumberOfComponents() != chunkIOs[0]->GetNumberOfComponents()
+         || chunkIO->m_FileCompressed != chunkIOs[0]->m_FileCompressed
+         || chunkIO->m_FileBigEndian != itk::ByteSwapper<uint16_t>::SystemIsBigEndian() )
+      {
+      sitkExceptionMacro( "The chunk file \"" << chunkFileNames[c] << "\" does not have the pixel type, "
+                          << "compression and byte order of the first chunk file and of this system." );
+      }
+    }
+
+  this->SetComponentType( chunkIOs[0]->GetComponentType() );
+  this->SetPixelType( chunkIOs[0]->GetPixelType() );
+  this->SetNumberOfComponents( chunkIOs[0]->GetNumberOfComponents() );
+  this->SetUseCompression( chunkIOs[0]->m_FileCompressed );
+  m_NumberOfPyramidLevels = 1;
+
+  const std::string headerString = this->MakeHeader( size, chunkSize, grid.m_NumberOfChunks );
+
+  std::ofstream out( m_FileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+  if ( !out )
+    {
+    sitkExceptionMacro( "Unable to open \"" << m_FileName << "\" for writing." );
+    }
+
+  out.write( headerString.c_str(), headerString.size() );
+
+  std::vector<uint8_t> index( static_cast<size_t>( grid.m_NumberOfChunks ) * 16, 0 );
+  const std::streamoff indexPosition = out.tellp();
+  out.write( reinterpret_cast<const char *>( &index[0] ), index.size() );
+
+  std::vector<char> data;
+  for ( size_t c = 0; c < chunkIOs.size(); ++c )
+    {
+    std::ifstream in( chunkFileNames[c].c_str(), std::ios::in | std::ios::binary );
+    data.resize( static_cast<size_t>( chunkIOs[c]->m_ChunkLengths[0] ) );
+    in.seekg( static_cast<std::streamoff>( chunkIOs[c]->m_ChunkOffsets[0] ) );
+    if ( !data.empty() )
+      {
+      in.read( &data[0], data.size() );
+      }
+    if ( !in )
+      {
+      sitkExceptionMacro( "Unable to read the chunk of \"" << chunkFileNames[c] << "\"." );
+      }
+
+    PutUInt64LE( &index[16 * c], static_cast<uint64_t>( out.tellp() ) );
+    PutUInt64LE( &index[16 * c + 8], data.size() );
+    if ( !data.empty() )
+      {
+      out.write( &data[0], data.size() );
+      }
+    }
+
+  out.seekp( indexPosition );
+  out.write( reinterpret_cast<const char *>( &index[0] ), index.size() );
+  out.close();
+  if ( out.fail() )
+    {
+    sitkExceptionMacro( "Error writing the chunked image \"" << m_FileName << "\"." );
+    }
+}
+
+ChunkedImageIOFactory::ChunkedImageIOFactory()
+{
+  this->RegisterOverride( "itkImageIOBase",
+                          "ChunkedImageIO",
+                          "SimpleITK Chunked Image IO",
+                          1,
+                          itk::CreateObjectFunction<ChunkedImageIO>::New() );
+}
+
+const char *ChunkedImageIOFactory::GetITKSourceVersion( void ) const
+{
+  return ITK_SOURCE_VERSION;
+}
+
+const char *ChunkedImageIOFactory::GetDescription( void ) const
+{
+  return "SimpleITK chunked image ImageIO Factory, allows the loading of SimpleITK chunked images into insight";
+}
+
+void ChunkedImageIOFactory::RegisterOneFactory( void )
+{
+  RegisterFactoryMutex.Lock();
+  std::list<itk::ObjectFactoryBase *> factories = itk::ObjectFactoryBase::GetRegisteredFactories();
+  bool registered = false;
+  for ( std::list<itk::ObjectFactoryBase *>::iterator i = factories.begin(); i != factories.end(); ++i )
+    {
+    registered = registered || ( dynamic_cast<ChunkedImageIOFactory *>( *i ) != SITK_NULLPTR );
+    }
+  if ( !registered )
+    {
+    itk::ObjectFactoryBase::RegisterFactory( ChunkedImageIOFactory::New() );
+    }
+  RegisterFactoryMutex.Unlock();
+}
+
+}
+}
@@ -0,0 +1,206 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkChunkedImageIO_h
+#define sitkChunkedImageIO_h
+
+#include "sitkMacro.h"
+#include "sitkIO.h"
+
+#include "itkImageIOBase.h"
+#include "itkObjectFactoryBase.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+namespace simple
+{
+
+/** \class ChunkedImageIO
+ * \brief ImageIO for the SimpleITK chunked image format (".sitkc")
+ *
+ * The image is divided into chunks of a fixed size, which are each
+ * compressed independently with zlib. Reading a region decodes only
+ * the chunks which intersect it, so that a region of interest of a
+ * large volume is read without decompressing the whole file.
+ * Chunks are compressed and decompressed with multiple threads.
+ *
+ * The file may store a multi-resolution pyramid. Each level after the
+ * first is bin shrunk by a factor of 2 from the previous level, in
+ * the dimensions with more than one pixel, by averaging the pixels of
+ * each bin as the BinShrinkImageFilter. The PyramidLevel selects the
+ * level described by ReadImageInformation and read.
+ *
+ * The file starts with an ASCII header of "key = value" lines:
+ \verbatim
+ SimpleITKChunkedImage = 1
+ NDims = 3
+ DimSize = 512 512 300
+ ChunkSize = 64 64 64
+ ComponentType = short
+ PixelType = scalar
+ NumberOfComponents = 1
+ ByteOrderMSB = False
+ Compression = Deflate
+ Origin = 0 0 0
+ Spacing = 1 1 1
+ Direction = 1 0 0 0 1 0 0 0 1
+ NumberOfPyramidLevels = 1
+ NumberOfChunks = 600
+ ChunkIndex = LOCAL
+ \endverbatim
+ * The Direction is row-major, the direction of axis j is column
+ * j. The header is followed by the chunk index with a little-endian
+ * 64-bit offset from the start of the file and a length in bytes for
+ * each chunk, then the chunk data. The chunks are ordered by pyramid
+ * level, then with the first dimension fastest. A chunk holds the pixels of its region,
+ * clipped to the image, with the first dimension fastest.
+ */
+class SITKIO_HIDDEN ChunkedImageIO
+  : public itk::ImageIOBase
+{
+public:
+  typedef ChunkedImageIO               Self;
+  typedef itk::ImageIOBase             Superclass;
+  typedef itk::SmartPointer<Self>      Pointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(ChunkedImageIO, ImageIOBase);
+
+  /** The size of the chunks when writing. When empty, or for
+   * dimensions beyond its size, chunks are 64 pixels wide. */
+  void SetChunkSize( const std::vector<unsigned int> &chunkSize ) { m_ChunkSize = chunkSize; }
+  const std::vector<unsigned int> &GetChunkSize( void ) const { return m_ChunkSize; }
+
+  /** The zlib compression level from 0 to 9, or -1 for the default. */
+  itkSetClampMacro( DeflateLevel, int, -1, 9 );
+  itkGetConstMacro( DeflateLevel, int );
+
+  /** The number of pyramid levels to write, and after
+   * ReadImageInformation the number of levels of the file. */
+  itkSetClampMacro( NumberOfPyramidLevels, unsigned int, 1, 32 );
+  itkGetConstMacro( NumberOfPyramidLevels, unsigned int );
+
+  /** The pyramid level to read, 0 is the full resolution. */
+  itkSetMacro( PyramidLevel, unsigned int );
+  itkGetConstMacro( PyramidLevel, unsigned int );
+
+  itkSetClampMacro( NumberOfThreads, unsigned int, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, unsigned int );
+
+  virtual bool SupportsDimension( unsigned long ) { return true; }
+
+  virtual bool CanStreamRead( void ) { return true; }
+
+  virtual bool CanReadFile( const char *fileName );
+  virtual void ReadImageInformation( void );
+  virtual void Read( void *buffer );
+
+  virtual bool CanWriteFile( const char *fileName );
+  virtual void WriteImageInformation( void ) {}
+  virtual void Write( const void *buffer );
+
+  /** Write the file from the chunks of other chunked files, without
+   * decoding them. Each file is one chunk of the image written, in
+   * the order of the chunks, and all have the pixel type and
+   * compression of the first file. The dimensions, origin, spacing,
+   * direction and ChunkSize of this ImageIO describe the image
+   * written, with a single pyramid level. */
+  void WriteFromChunkFiles( const std::vector<std::string> &chunkFileNames );
+
+  /** The number of bytes of the header and the chunk index of the
+   * file read by ReadImageInformation, which are before the chunk
+   * data. */
+  uint64_t GetHeaderLength( void ) const { return m_HeaderLength; }
+
+  /** The offsets and lengths in the file of the chunks of the
+   * pyramid level read which intersect a region, after
+   * ReadImageInformation. These are the bytes read for the region. */
+  void GetChunkByteRanges( const ImageIORegion &region,
+                           std::vector<uint64_t> &offsets,
+                           std::vector<uint64_t> &lengths ) const;
+
+protected:
+  ChunkedImageIO();
+  ~ChunkedImageIO() {}
+
+  virtual void PrintSelf( std::ostream &os, itk::Indent indent ) const;
+
+private:
+  ChunkedImageIO( const Self & ); //purposely not implemented
+  void operator=( const Self & ); //purposely not implemented
+
+  std::string MakeHeader( const std::vector<uint64_t> &size,
+                          const std::vector<uint64_t> &chunkSize,
+                          uint64_t numberOfChunks ) const;
+
+  void GetChunksOfRegion( const ImageIORegion &region,
+                          std::vector<uint64_t> &regionStart,
+                          std::vector<uint64_t> &regionSize,
+                          std::vector<uint64_t> &chunks ) const;
+
+  std::vector<unsigned int> m_ChunkSize;
+  int                       m_DeflateLevel;
+  unsigned int              m_NumberOfPyramidLevels;
+  unsigned int              m_PyramidLevel;
+  unsigned int              m_NumberOfThreads;
+
+  // the chunk layout of the file read by ReadImageInformation
+  std::vector<uint64_t>     m_FileChunkSize;
+  std::vector<uint64_t>     m_ChunkOffsets;
+  std::vector<uint64_t>     m_ChunkLengths;
+  uint64_t                  m_LevelFirstChunk;
+  uint64_t                  m_HeaderLength;
+  bool                      m_FileCompressed;
+  bool                      m_FileBigEndian;
+};
+
+
+/** \class ChunkedImageIOFactory
+ * \brief Creates the ChunkedImageIO with the itk::ImageIOFactory
+ */
+class SITKIO_HIDDEN ChunkedImageIOFactory
+  : public itk::ObjectFactoryBase
+{
+public:
+  typedef ChunkedImageIOFactory        Self;
+  typedef itk::ObjectFactoryBase       Superclass;
+  typedef itk::SmartPointer<Self>      Pointer;
+
+  virtual const char *GetITKSourceVersion( void ) const;
+  virtual const char *GetDescription( void ) const;
+
+  itkFactorylessNewMacro(Self);
+  itkTypeMacro(ChunkedImageIOFactory, ObjectFactoryBase);
+
+  /** Register the factory, once. */
+  static void RegisterOneFactory( void );
+
+protected:
+  ChunkedImageIOFactory();
+
+private:
+  ChunkedImageIOFactory( const Self & ); //purposely not implemented
+  void operator=( const Self & );        //purposely not implemented
+};
+
+}
+}
+
+#endif
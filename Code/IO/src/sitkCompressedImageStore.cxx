@@ -0,0 +1,459 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkCompressedImageStore.h"
+#include "sitkExceptionObject.h"
+
+#include <itkMultiThreader.h>
+#include "itk_zlib.h"
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <map>
+#include <sstream>
+
+namespace itk {
+  namespace simple {
+
+  namespace
+  {
+
+  struct ChunkThreadStruct
+  {
+    char                            *m_Buffer;
+    uint64_t                         m_NumberOfBytes;
+    size_t                           m_ChunkSize;
+    std::vector< std::vector<char> > *m_Chunks;
+    int                              m_CompressionLevel;
+    std::vector<int>                 m_Status;
+  };
+
+  ITK_THREAD_RETURN_TYPE CompressThreaderCallback( void *arg )
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+    ChunkThreadStruct *str = static_cast<ChunkThreadStruct *>( info->UserData );
+
+    for ( size_t i = info->ThreadID; i < str->m_Chunks->size(); i += info->NumberOfThreads )
+      {
+      const uint64_t offset = static_cast<uint64_t>( i ) * str->m_ChunkSize;
+      const uLong inputSize = static_cast<uLong>( std::min<uint64_t>( str->m_ChunkSize, str->m_NumberOfBytes - offset ) );
+      std::vector<char> &chunk = ( *str->m_Chunks )[i];
+      uLongf outputSize = compressBound( inputSize );
+      chunk.resize( outputSize );
+      str->m_Status[i] = compress2( reinterpret_cast<Bytef *>( &chunk[0] ), &outputSize,
+                                    reinterpret_cast<const Bytef *>( str->m_Buffer + offset ), inputSize,
+                                    str->m_CompressionLevel );
+      // shrink the chunk to its compressed size
+      std::vector<char>( chunk.begin(), chunk.begin() + outputSize ).swap( chunk );
+      }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  ITK_THREAD_RETURN_TYPE DecompressThreaderCallback( void *arg )
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+    ChunkThreadStruct *str = static_cast<ChunkThreadStruct *>( info->UserData );
+
+    for ( size_t i = info->ThreadID; i < str->m_Chunks->size(); i += info->NumberOfThreads )
+      {
+      const uint64_t offset = static_cast<uint64_t>( i ) * str->m_ChunkSize;
+      const uLongf expectedSize = static_cast<uLongf>( std::min<uint64_t>( str->m_ChunkSize, str->m_NumberOfBytes - offset ) );
+      const std::vector<char> &chunk = ( *str->m_Chunks )[i];
+      uLongf outputSize = expectedSize;
+      str->m_Status[i] = uncompress( reinterpret_cast<Bytef *>( str->m_Buffer + offset ), &outputSize,
+                                     reinterpret_cast<const Bytef *>( &chunk[0] ), static_cast<uLong>( chunk.size() ) );
+      if ( str->m_Status[i] == Z_OK && outputSize != expectedSize )
+        {
+        str->m_Status[i] = Z_DATA_ERROR;
+        }
+      }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  void RunChunks( ITK_THREAD_RETURN_TYPE (*callback)( void * ), ChunkThreadStruct &str, unsigned int numberOfThreads )
+  {
+    str.m_Status.assign( str.m_Chunks->size(), Z_OK );
+    if ( str.m_Chunks->empty() )
+      {
+      return;
+      }
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>(
+                                    std::max<size_t>( 1, std::min<size_t>( numberOfThreads, str.m_Chunks->size() ) ) ) );
+    threader->SetSingleMethod( callback, &str );
+    threader->SingleMethodExecute();
+
+    for ( size_t i = 0; i < str.m_Status.size(); ++i )
+      {
+      if ( str.m_Status[i] != Z_OK )
+        {
+        sitkExceptionMacro( "Error " << str.m_Status[i] << " in zlib for chunk " << i << "." );
+        }
+      }
+  }
+
+  } // end anonymous namespace
+
+
+  struct CompressedImageStore::Implementation
+  {
+    struct Entry
+    {
+      Entry()
+        : m_HasImage( false ),
+          m_PixelID( sitkUnknown ),
+          m_NumberOfComponents( 0 ),
+          m_NumberOfBytes( 0 ),
+          m_ChunkSize( 0 ),
+          m_CompressedBytes( 0 )
+        {
+        }
+
+      // the uncompressed image, when m_HasImage
+      Image                            m_Image;
+      bool                             m_HasImage;
+
+      PixelIDValueEnum                 m_PixelID;
+      std::vector<unsigned int>        m_Size;
+      unsigned int                     m_NumberOfComponents;
+      std::vector<double>              m_Origin;
+      std::vector<double>              m_Spacing;
+      std::vector<double>              m_Direction;
+      uint64_t                         m_NumberOfBytes;
+
+      // the compressed chunks, empty until compressed
+      size_t                           m_ChunkSize;
+      std::vector< std::vector<char> > m_Chunks;
+      uint64_t                         m_CompressedBytes;
+
+      // the position in the list of the recently used
+      std::list<std::string>::iterator m_Recent;
+    };
+
+    Implementation()
+      : m_MemoryUsed( 0 ),
+        m_CompressedMemory( 0 )
+      {
+      }
+
+    Entry &Find( const std::string &key )
+      {
+        std::map<std::string, Entry>::iterator it = m_Entries.find( key );
+        if ( it == m_Entries.end() )
+          {
+          sitkExceptionMacro( "There is no image \"" << key << "\" in the store." );
+          }
+        return it->second;
+      }
+
+    void Touch( Entry &entry )
+      {
+        m_Recent.splice( m_Recent.begin(), m_Recent, entry.m_Recent );
+      }
+
+    void ReleaseImage( Entry &entry )
+      {
+        if ( entry.m_HasImage )
+          {
+          entry.m_Image = Image();
+          entry.m_HasImage = false;
+          m_MemoryUsed -= entry.m_NumberOfBytes;
+          }
+      }
+
+    // Compress the chunks of the image of an entry, unless they are
+    // already, and release its uncompressed pixels
+    void Compress( Entry &entry, unsigned int chunkSize, int compressionLevel, unsigned int numberOfThreads )
+      {
+        if ( !entry.m_HasImage )
+          {
+          return;
+          }
+
+        // the chunks of an image which was decompressed are still
+        // valid, as the image of the store is never modified
+        if ( entry.m_Chunks.empty() && entry.m_NumberOfBytes != 0 )
+          {
+          entry.m_ChunkSize = chunkSize;
+          entry.m_Chunks.resize( static_cast<size_t>( ( entry.m_NumberOfBytes + chunkSize - 1 ) / chunkSize ) );
+
+          const Image &image = entry.m_Image;
+          ChunkThreadStruct str;
+          str.m_Buffer = const_cast<char *>( static_cast<const char *>( image.GetBufferAsVoid() ) );
+          str.m_NumberOfBytes = entry.m_NumberOfBytes;
+          str.m_ChunkSize = entry.m_ChunkSize;
+          str.m_Chunks = &entry.m_Chunks;
+          str.m_CompressionLevel = compressionLevel;
+          try
+            {
+            RunChunks( CompressThreaderCallback, str, numberOfThreads );
+            }
+          catch ( ... )
+            {
+            entry.m_Chunks.clear();
+            throw;
+            }
+
+          entry.m_CompressedBytes = 0;
+          for ( size_t i = 0; i < entry.m_Chunks.size(); ++i )
+            {
+            entry.m_CompressedBytes += entry.m_Chunks[i].size();
+            }
+          m_MemoryUsed += entry.m_CompressedBytes;
+          m_CompressedMemory += entry.m_CompressedBytes;
+          }
+
+        this->ReleaseImage( entry );
+      }
+
+    // Compress from the least recently used image until the memory
+    // used is within the budget, except the image just inserted or
+    // taken
+    void EnforceMaximumMemory( const CompressedImageStore &store, const Entry *keep )
+      {
+        if ( store.m_MaximumMemory == 0 )
+          {
+          return;
+          }
+
+        std::list<std::string>::reverse_iterator it = m_Recent.rbegin();
+        while ( m_MemoryUsed > store.m_MaximumMemory && it != m_Recent.rend() )
+          {
+          Entry &entry = m_Entries[*it];
+          ++it;
+          if ( &entry != keep )
+            {
+            this->Compress( entry, store.m_ChunkSize, store.m_CompressionLevel, store.m_NumberOfThreads );
+            }
+          }
+      }
+
+    void Erase( std::map<std::string, Entry>::iterator it )
+      {
+        this->ReleaseImage( it->second );
+        m_MemoryUsed -= it->second.m_CompressedBytes;
+        m_CompressedMemory -= it->second.m_CompressedBytes;
+        m_Recent.erase( it->second.m_Recent );
+        m_Entries.erase( it );
+      }
+
+    std::map<std::string, Entry> m_Entries;
+
+    // the keys, from the most recently used
+    std::list<std::string>       m_Recent;
+
+    uint64_t                     m_MemoryUsed;
+    uint64_t                     m_CompressedMemory;
+  };
+
+
+  CompressedImageStore::CompressedImageStore()
+    : m_Implementation( new Implementation ),
+      m_MaximumMemory( 0 ),
+      m_CompressionLevel( 1 ),
+      m_ChunkSize( 1024 * 1024 ),
+      m_NumberOfThreads( itk::MultiThreader::GetGlobalDefaultNumberOfThreads() )
+  {
+  }
+
+  CompressedImageStore::~CompressedImageStore()
+  {
+    delete m_Implementation;
+  }
+
+  std::string CompressedImageStore::ToString() const
+  {
+    std::ostringstream out;
+    out << "itk::simple::CompressedImageStore" << std::endl;
+    out << "  MaximumMemory: " << m_MaximumMemory << std::endl;
+    out << "  CompressionLevel: " << m_CompressionLevel << std::endl;
+    out << "  ChunkSize: " << m_ChunkSize << std::endl;
+    out << "  NumberOfThreads: " << m_NumberOfThreads << std::endl;
+    out << "  NumberOfImages: " << this->GetNumberOfImages() << std::endl;
+    out << "  MemoryUsed: " << this->GetMemoryUsed() << std::endl;
+    out << "  CompressedMemory: " << this->GetCompressedMemory() << std::endl;
+    return out.str();
+  }
+
+  CompressedImageStore &CompressedImageStore::SetMaximumMemory( uint64_t bytes )
+  {
+    this->m_MaximumMemory = bytes;
+    m_Implementation->EnforceMaximumMemory( *this, SITK_NULLPTR );
+    return *this;
+  }
+
+  uint64_t CompressedImageStore::GetMaximumMemory( ) const
+  {
+    return this->m_MaximumMemory;
+  }
+
+  CompressedImageStore &CompressedImageStore::SetCompressionLevel( int level )
+  {
+    if ( level < 1 || level > 9 )
+      {
+      sitkExceptionMacro( "The compression level " << level << " is not from 1 to 9." );
+      }
+    this->m_CompressionLevel = level;
+    return *this;
+  }
+
+  int CompressedImageStore::GetCompressionLevel( ) const
+  {
+    return this->m_CompressionLevel;
+  }
+
+  CompressedImageStore &CompressedImageStore::SetChunkSize( unsigned int bytes )
+  {
+    if ( bytes == 0 )
+      {
+      sitkExceptionMacro( "The chunk size must not be zero." );
+      }
+    this->m_ChunkSize = bytes;
+    return *this;
+  }
+
+  unsigned int CompressedImageStore::GetChunkSize( ) const
+  {
+    return this->m_ChunkSize;
+  }
+
+  CompressedImageStore &CompressedImageStore::SetNumberOfThreads( unsigned int n )
+  {
+    this->m_NumberOfThreads = std::max( 1u, n );
+    return *this;
+  }
+
+  unsigned int CompressedImageStore::GetNumberOfThreads( ) const
+  {
+    return this->m_NumberOfThreads;
+  }
+
+  void CompressedImageStore::Insert( const std::string &key, const Image &image )
+  {
+    const unsigned int componentSize = GetPixelIDValueComponentSize( image.GetPixelID() );
+    if ( componentSize == 0 )
+      {
+      sitkExceptionMacro( "The pixel type " << image.GetPixelIDTypeAsString()
+                          << " is not supported by the CompressedImageStore." );
+      }
+
+    this->Remove( key );
+
+    Implementation::Entry &entry = m_Implementation->m_Entries[key];
+    entry.m_Image = image;
+    entry.m_HasImage = true;
+    entry.m_PixelID = image.GetPixelID();
+    entry.m_Size = image.GetSize();
+    entry.m_NumberOfComponents = image.GetNumberOfComponentsPerPixel();
+    entry.m_Origin = image.GetOrigin();
+    entry.m_Spacing = image.GetSpacing();
+    entry.m_Direction = image.GetDirection();
+    entry.m_NumberOfBytes = image.GetNumberOfPixels() * entry.m_NumberOfComponents * componentSize;
+    entry.m_Recent = m_Implementation->m_Recent.insert( m_Implementation->m_Recent.begin(), key );
+    m_Implementation->m_MemoryUsed += entry.m_NumberOfBytes;
+
+    m_Implementation->EnforceMaximumMemory( *this, &entry );
+  }
+
+  Image CompressedImageStore::Get( const std::string &key )
+  {
+    Implementation::Entry &entry = m_Implementation->Find( key );
+    m_Implementation->Touch( entry );
+
+    if ( !entry.m_HasImage )
+      {
+      Image image( entry.m_Size, entry.m_PixelID, entry.m_NumberOfComponents, Image::NoBufferInitialization );
+      image.SetOrigin( entry.m_Origin );
+      image.SetSpacing( entry.m_Spacing );
+      image.SetDirection( entry.m_Direction );
+
+      ChunkThreadStruct str;
+      str.m_Buffer = static_cast<char *>( image.GetBufferAsVoid() );
+      str.m_NumberOfBytes = entry.m_NumberOfBytes;
+      str.m_ChunkSize = entry.m_ChunkSize;
+      str.m_Chunks = &entry.m_Chunks;
+      str.m_CompressionLevel = m_CompressionLevel;
+      RunChunks( DecompressThreaderCallback, str, m_NumberOfThreads );
+
+      entry.m_Image = image;
+      entry.m_HasImage = true;
+      m_Implementation->m_MemoryUsed += entry.m_NumberOfBytes;
+
+      m_Implementation->EnforceMaximumMemory( *this, &entry );
+      }
+
+    return entry.m_Image;
+  }
+
+  bool CompressedImageStore::Contains( const std::string &key ) const
+  {
+    return m_Implementation->m_Entries.count( key ) != 0;
+  }
+
+  bool CompressedImageStore::IsCompressed( const std::string &key ) const
+  {
+    return !m_Implementation->Find( key ).m_HasImage;
+  }
+
+  void CompressedImageStore::Compress( const std::string &key )
+  {
+    m_Implementation->Compress( m_Implementation->Find( key ), m_ChunkSize, m_CompressionLevel, m_NumberOfThreads );
+  }
+
+  void CompressedImageStore::Remove( const std::string &key )
+  {
+    std::map<std::string, Implementation::Entry>::iterator it = m_Implementation->m_Entries.find( key );
+    if ( it != m_Implementation->m_Entries.end() )
+      {
+      m_Implementation->Erase( it );
+      }
+  }
+
+  void CompressedImageStore::Clear( )
+  {
+    m_Implementation->m_Entries.clear();
+    m_Implementation->m_Recent.clear();
+    m_Implementation->m_MemoryUsed = 0;
+    m_Implementation->m_CompressedMemory = 0;
+  }
+
+  std::vector<std::string> CompressedImageStore::GetKeys( ) const
+  {
+    return std::vector<std::string>( m_Implementation->m_Recent.begin(), m_Implementation->m_Recent.end() );
+  }
+
+  unsigned int CompressedImageStore::GetNumberOfImages( ) const
+  {
+    return static_cast<unsigned int>( m_Implementation->m_Entries.size() );
+  }
+
+  uint64_t CompressedImageStore::GetMemoryUsed( ) const
+  {
+    return m_Implementation->m_MemoryUsed;
+  }
+
+  uint64_t CompressedImageStore::GetCompressedMemory( ) const
+  {
+    return m_Implementation->m_CompressedMemory;
+  }
+
+  }
+}
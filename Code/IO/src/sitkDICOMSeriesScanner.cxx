@@ -0,0 +1,607 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkDICOMSeriesScanner.h"
+
+#include <itkMultiThreader.h>
+#include <itksys/Directory.hxx>
+#include <itksys/SystemTools.hxx>
+
+#include "gdcmReader.h"
+#include "gdcmStringFilter.h"
+#include "gdcmTag.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace itk
+{
+namespace simple
+{
+
+namespace
+{
+
+const char * const CacheHeader = "SimpleITK DICOM series index 1";
+
+const gdcm::Tag SeriesInstanceUIDTag( 0x0020, 0x000e );
+const gdcm::Tag ImagePositionPatientTag( 0x0020, 0x0032 );
+const gdcm::Tag ImageOrientationPatientTag( 0x0020, 0x0037 );
+const gdcm::Tag InstanceNumberTag( 0x0020, 0x0013 );
+
+// series number, sequence name, slice thickness, rows and columns
+// further distinguish the volumes of a series
+const gdcm::Tag SeriesDetailsTags[] = { gdcm::Tag( 0x0020, 0x0011 ),
+                                        gdcm::Tag( 0x0018, 0x0024 ),
+                                        gdcm::Tag( 0x0018, 0x0050 ),
+                                        gdcm::Tag( 0x0028, 0x0010 ),
+                                        gdcm::Tag( 0x0028, 0x0011 ) };
+const unsigned int NumberOfSeriesDetailsTags = sizeof( SeriesDetailsTags ) / sizeof( gdcm::Tag );
+
+
+std::string GetStringValue( const gdcm::DataSet &ds, const gdcm::Tag &tag )
+{
+  if ( !ds.FindDataElement( tag ) )
+    {
+    return std::string();
+    }
+  const gdcm::ByteValue *bv = ds.GetDataElement( tag ).GetByteValue();
+  if ( !bv || bv->GetLength() == 0 )
+    {
+    return std::string();
+    }
+  std::string value( bv->GetPointer(), bv->GetLength() );
+
+  const char *padding = " \t\r\n";
+  value.erase( std::remove( value.begin(), value.end(), '\0' ), value.end() );
+  const std::string::size_type b = value.find_first_not_of( padding );
+  if ( b == std::string::npos )
+    {
+    return std::string();
+    }
+  return value.substr( b, value.find_last_not_of( padding ) - b + 1 );
+}
+
+bool ParseNumbers( const std::string &value, double *numbers, unsigned int n )
+{
+  std::istringstream in( value );
+  std::string token;
+  unsigned int i = 0;
+  while ( i < n && std::getline( in, token, '\\' ) )
+    {
+    char *end = SITK_NULLPTR;
+    numbers[i] = strtod( token.c_str(), &end );
+    if ( end == token.c_str() )
+      {
+      return false;
+      }
+    ++i;
+    }
+  return i == n;
+}
+
+
+void ParseFile( DICOMSeriesScanner::FileInformation &info )
+{
+  info.m_IsDICOM = false;
+
+  std::set<gdcm::Tag> tags;
+  tags.insert( SeriesInstanceUIDTag );
+  tags.insert( ImagePositionPatientTag );
+  tags.insert( ImageOrientationPatientTag );
+  tags.insert( InstanceNumberTag );
+  tags.insert( SeriesDetailsTags, SeriesDetailsTags + NumberOfSeriesDetailsTags );
+
+  // only the selected tags are read, the parser stops before the
+  // pixel data
+  gdcm::Reader reader;
+  reader.SetFileName( info.m_FileName.c_str() );
+  try
+    {
+    if ( !reader.ReadSelectedTags( tags ) )
+      {
+      return;
+      }
+    }
+  catch ( ... )
+    {
+    return;
+    }
+
+  const gdcm::DataSet &ds = reader.GetFile().GetDataSet();
+
+  info.m_SeriesInstanceUID = GetStringValue( ds, SeriesInstanceUIDTag );
+  if ( info.m_SeriesInstanceUID.empty() )
+    {
+    return;
+    }
+  info.m_IsDICOM = true;
+
+  info.m_SeriesDetails.clear();
+  for ( unsigned int i = 0; i < NumberOfSeriesDetailsTags; ++i )
+    {
+    const std::string value = GetStringValue( ds, SeriesDetailsTags[i] );
+    for ( std::string::const_iterator c = value.begin(); c != value.end(); ++c )
+      {
+      if ( isalnum( static_cast<unsigned char>( *c ) ) || *c == '.' )
+        {
+        info.m_SeriesDetails += *c;
+        }
+      }
+    info.m_SeriesDetails += ".";
+    }
+
+  info.m_HasPosition = ParseNumbers( GetStringValue( ds, ImagePositionPatientTag ), info.m_Position, 3 );
+  info.m_HasOrientation = ParseNumbers( GetStringValue( ds, ImageOrientationPatientTag ), info.m_Orientation, 6 );
+
+  const std::string instance = GetStringValue( ds, InstanceNumberTag );
+  char *end = SITK_NULLPTR;
+  info.m_InstanceNumber = strtol( instance.c_str(), &end, 10 );
+  info.m_HasInstanceNumber = ( end != instance.c_str() );
+}
+
+
+struct ScanThreadStruct
+{
+  std::vector<DICOMSeriesScanner::FileInformation *> m_Files;
+};
+
+ITK_THREAD_RETURN_TYPE ScanThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  ScanThreadStruct *str = static_cast<ScanThreadStruct *>( info->UserData );
+
+  for ( size_t i = info->ThreadID; i < str->m_Files.size(); i += info->NumberOfThreads )
+    {
+    ParseFile( *str->m_Files[i] );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+struct ReadTagsThreadStruct
+{
+  const std::vector<std::string>         *m_FileNames;
+  std::set<gdcm::Tag>                     m_TagSet;
+  std::vector<gdcm::Tag>                  m_Tags;
+  std::vector< std::vector<std::string> > m_Values;
+};
+
+void ReadFileTags( const ReadTagsThreadStruct &str, size_t file, std::vector<std::string> &values )
+{
+  values.assign( str.m_Tags.size(), std::string() );
+
+  gdcm::Reader reader;
+  reader.SetFileName( ( *str.m_FileNames )[file].c_str() );
+  try
+    {
+    if ( !reader.ReadSelectedTags( str.m_TagSet ) )
+      {
+      return;
+      }
+
+    const gdcm::DataSet &ds = reader.GetFile().GetDataSet();
+    gdcm::StringFilter filter;
+    filter.SetFile( reader.GetFile() );
+    for ( size_t i = 0; i < str.m_Tags.size(); ++i )
+      {
+      if ( ds.FindDataElement( str.m_Tags[i] ) )
+        {
+        values[i] = filter.ToString( str.m_Tags[i] );
+        }
+      }
+    }
+  catch ( ... )
+    {
+    values.assign( str.m_Tags.size(), std::string() );
+    }
+}
+
+ITK_THREAD_RETURN_TYPE ReadTagsThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  ReadTagsThreadStruct *str = static_cast<ReadTagsThreadStruct *>( info->UserData );
+
+  for ( size_t i = info->ThreadID; i < str->m_FileNames->size(); i += info->NumberOfThreads )
+    {
+    ReadFileTags( *str, i, str->m_Values[i] );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+void ListFiles( const std::string &directory, bool recursive, std::vector<std::string> &fileNames )
+{
+  itksys::Directory dir;
+  if ( !dir.Load( directory.c_str() ) )
+    {
+    return;
+    }
+
+  for ( unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i )
+    {
+    const std::string name = dir.GetFile( i );
+    if ( name == "." || name == ".." )
+      {
+      continue;
+      }
+    const std::string path = directory + "/" + name;
+    if ( itksys::SystemTools::FileIsDirectory( path.c_str() ) )
+      {
+      if ( recursive )
+        {
+        ListFiles( path, recursive, fileNames );
+        }
+      }
+    else
+      {
+      fileNames.push_back( path );
+      }
+    }
+}
+
+
+struct FileNameLess
+{
+  bool operator()( const DICOMSeriesScanner::FileInformation *a, const DICOMSeriesScanner::FileInformation *b ) const
+    {
+      return a->m_FileName < b->m_FileName;
+    }
+};
+
+struct FirstLess
+{
+  template <typename TPair>
+  bool operator()( const TPair &a, const TPair &b ) const
+    {
+      return a.first < b.first;
+    }
+};
+
+struct InstanceNumberLess
+{
+  bool operator()( const DICOMSeriesScanner::FileInformation *a, const DICOMSeriesScanner::FileInformation *b ) const
+    {
+      return a->m_InstanceNumber < b->m_InstanceNumber;
+    }
+};
+
+}
+
+
+DICOMSeriesScanner::FileInformation::FileInformation()
+  : m_ModifiedTime( 0 ),
+    m_FileLength( 0 ),
+    m_IsDICOM( false ),
+    m_HasPosition( false ),
+    m_HasOrientation( false ),
+    m_HasInstanceNumber( false ),
+    m_InstanceNumber( 0 )
+{
+  std::fill( m_Position, m_Position + 3, 0.0 );
+  std::fill( m_Orientation, m_Orientation + 6, 0.0 );
+}
+
+
+DICOMSeriesScanner::DICOMSeriesScanner()
+  : m_UseSeriesDetails( false ),
+    m_Recursive( false ),
+    m_NumberOfThreads( 1 )
+{
+}
+
+
+void DICOMSeriesScanner::Scan( const std::string &directory )
+{
+  m_Series.clear();
+
+  std::vector<std::string> fileNames;
+  ListFiles( directory, m_Recursive, fileNames );
+  std::sort( fileNames.begin(), fileNames.end() );
+
+  std::map<std::string, FileInformation> cache;
+  if ( !m_CacheFileName.empty() )
+    {
+    this->ReadCache( cache );
+    }
+
+  // reuse the parsed tags of the unmodified files
+  std::vector<FileInformation> files( fileNames.size() );
+  ScanThreadStruct str;
+  for ( size_t i = 0; i < fileNames.size(); ++i )
+    {
+    FileInformation &info = files[i];
+    info.m_FileName = fileNames[i];
+    info.m_ModifiedTime = itksys::SystemTools::ModifiedTime( info.m_FileName.c_str() );
+    info.m_FileLength = itksys::SystemTools::FileLength( info.m_FileName.c_str() );
+
+    std::map<std::string, FileInformation>::const_iterator it = cache.find( info.m_FileName );
+    if ( it != cache.end()
+         && it->second.m_ModifiedTime == info.m_ModifiedTime
+         && it->second.m_FileLength == info.m_FileLength )
+      {
+      info = it->second;
+      }
+    else
+      {
+      str.m_Files.push_back( &info );
+      }
+    }
+
+  if ( !str.m_Files.empty() )
+    {
+    const unsigned int numberOfThreads =
+      std::max( 1u, std::min( m_NumberOfThreads, static_cast<unsigned int>( str.m_Files.size() ) ) );
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( numberOfThreads );
+    threader->SetSingleMethod( ScanThreaderCallback, &str );
+    threader->SingleMethodExecute();
+    }
+
+  if ( !m_CacheFileName.empty() && ( !str.m_Files.empty() || cache.size() != files.size() ) )
+    {
+    this->WriteCache( files );
+    }
+
+  std::map<std::string, std::vector<const FileInformation *> > series;
+  for ( size_t i = 0; i < files.size(); ++i )
+    {
+    if ( files[i].m_IsDICOM )
+      {
+      std::string id = files[i].m_SeriesInstanceUID;
+      if ( m_UseSeriesDetails )
+        {
+        id += "." + files[i].m_SeriesDetails;
+        }
+      series[id].push_back( &files[i] );
+      }
+    }
+
+  for ( std::map<std::string, std::vector<const FileInformation *> >::iterator it = series.begin();
+        it != series.end();
+        ++it )
+    {
+    SortSeries( it->second );
+    std::vector<std::string> &names = m_Series[it->first];
+    for ( size_t i = 0; i < it->second.size(); ++i )
+      {
+      names.push_back( it->second[i]->m_FileName );
+      }
+    }
+}
+
+
+std::vector<std::string> DICOMSeriesScanner::GetSeriesIDs( void ) const
+{
+  std::vector<std::string> ids;
+  for ( std::map<std::string, std::vector<std::string> >::const_iterator it = m_Series.begin();
+        it != m_Series.end();
+        ++it )
+    {
+    ids.push_back( it->first );
+    }
+  return ids;
+}
+
+
+std::vector<std::string> DICOMSeriesScanner::GetFileNames( const std::string &seriesID ) const
+{
+  if ( m_Series.empty() )
+    {
+    return std::vector<std::string>();
+    }
+  if ( seriesID.empty() )
+    {
+    return m_Series.begin()->second;
+    }
+  std::map<std::string, std::vector<std::string> >::const_iterator it = m_Series.find( seriesID );
+  if ( it == m_Series.end() )
+    {
+    return std::vector<std::string>();
+    }
+  return it->second;
+}
+
+
+void DICOMSeriesScanner::SortSeries( std::vector<const FileInformation *> &series )
+{
+  std::sort( series.begin(), series.end(), FileNameLess() );
+
+  if ( series.size() < 2 )
+    {
+    return;
+    }
+
+  // position along the normal of the first slice
+  bool usePosition = series[0]->m_HasOrientation;
+  for ( size_t i = 0; usePosition && i < series.size(); ++i )
+    {
+    usePosition = series[i]->m_HasPosition;
+    }
+  if ( usePosition )
+    {
+    const double *o = series[0]->m_Orientation;
+    const double normal[3] = { o[1]*o[5] - o[2]*o[4],
+                               o[2]*o[3] - o[0]*o[5],
+                               o[0]*o[4] - o[1]*o[3] };
+
+    std::vector<std::pair<double, const FileInformation *> > distances;
+    for ( size_t i = 0; i < series.size(); ++i )
+      {
+      const double *p = series[i]->m_Position;
+      distances.push_back( std::make_pair( normal[0]*p[0] + normal[1]*p[1] + normal[2]*p[2], series[i] ) );
+      }
+    std::stable_sort( distances.begin(), distances.end(), FirstLess() );
+
+    bool distinct = true;
+    for ( size_t i = 1; distinct && i < distances.size(); ++i )
+      {
+      distinct = ( distances[i-1].first != distances[i].first );
+      }
+    if ( distinct )
+      {
+      for ( size_t i = 0; i < distances.size(); ++i )
+        {
+        series[i] = distances[i].second;
+        }
+      return;
+      }
+    }
+
+  bool useInstanceNumber = true;
+  for ( size_t i = 0; useInstanceNumber && i < series.size(); ++i )
+    {
+    useInstanceNumber = series[i]->m_HasInstanceNumber;
+    }
+  if ( useInstanceNumber )
+    {
+    std::stable_sort( series.begin(), series.end(), InstanceNumberLess() );
+    }
+}
+
+
+void DICOMSeriesScanner::ReadCache( std::map<std::string, FileInformation> &cache ) const
+{
+  std::ifstream in( m_CacheFileName.c_str() );
+  std::string line;
+  if ( !std::getline( in, line ) || line != CacheHeader )
+    {
+    return;
+    }
+
+  while ( std::getline( in, line ) )
+    {
+    std::vector<std::string> fields;
+    std::istringstream lineStream( line );
+    std::string field;
+    while ( std::getline( lineStream, field, '\t' ) )
+      {
+      fields.push_back( field );
+      }
+    if ( fields.size() != 19 )
+      {
+      continue;
+      }
+
+    FileInformation info;
+    info.m_FileName = fields[0];
+    info.m_ModifiedTime = strtol( fields[1].c_str(), SITK_NULLPTR, 10 );
+    std::istringstream( fields[2] ) >> info.m_FileLength;
+    info.m_IsDICOM = ( fields[3] == "1" );
+    info.m_SeriesInstanceUID = fields[4];
+    info.m_SeriesDetails = fields[5];
+    info.m_HasPosition = ( fields[6] == "1" );
+    for ( unsigned int i = 0; i < 3; ++i )
+      {
+      info.m_Position[i] = strtod( fields[7+i].c_str(), SITK_NULLPTR );
+      }
+    info.m_HasOrientation = ( fields[10] == "1" );
+    for ( unsigned int i = 0; i < 6; ++i )
+      {
+      info.m_Orientation[i] = strtod( fields[11+i].c_str(), SITK_NULLPTR );
+      }
+    info.m_HasInstanceNumber = ( fields[17] == "1" );
+    info.m_InstanceNumber = strtol( fields[18].c_str(), SITK_NULLPTR, 10 );
+
+    cache[info.m_FileName] = info;
+    }
+}
+
+
+void DICOMSeriesScanner::WriteCache( const std::vector<FileInformation> &files ) const
+{
+  std::ofstream out( m_CacheFileName.c_str() );
+  if ( !out )
+    {
+    sitkExceptionMacro( "Unable to write the DICOM index file \"" << m_CacheFileName << "\"." );
+    }
+  out.precision( 17 );
+
+  out << CacheHeader << "\n";
+  for ( size_t i = 0; i < files.size(); ++i )
+    {
+    const FileInformation &info = files[i];
+    if ( info.m_FileName.find_first_of( "\t\n\r" ) != std::string::npos
+         || info.m_SeriesInstanceUID.find_first_of( "\t\n\r" ) != std::string::npos )
+      {
+      continue;
+      }
+    out << info.m_FileName << "\t"
+        << info.m_ModifiedTime << "\t"
+        << info.m_FileLength << "\t"
+        << info.m_IsDICOM << "\t"
+        << info.m_SeriesInstanceUID << "\t"
+        << info.m_SeriesDetails << "\t"
+        << info.m_HasPosition;
+    for ( unsigned int j = 0; j < 3; ++j )
+      {
+      out << "\t" << info.m_Position[j];
+      }
+    out << "\t" << info.m_HasOrientation;
+    for ( unsigned int j = 0; j < 6; ++j )
+      {
+      out << "\t" << info.m_Orientation[j];
+      }
+    out << "\t" << info.m_HasInstanceNumber
+        << "\t" << info.m_InstanceNumber << "\n";
+    }
+}
+
+
+std::vector< std::vector<std::string> >
+ReadDICOMTags( const std::vector<std::string> &fileNames,
+               const std::vector<std::string> &tags,
+               unsigned int numberOfThreads )
+{
+  ReadTagsThreadStruct str;
+  str.m_FileNames = &fileNames;
+  for ( size_t i = 0; i < tags.size(); ++i )
+    {
+    gdcm::Tag tag;
+    if ( !tag.ReadFromPipeSeparatedString( tags[i].c_str() ) )
+      {
+      sitkExceptionMacro( "The DICOM tag \"" << tags[i] << "\" is not of the form \"gggg|eeee\"." );
+      }
+    str.m_Tags.push_back( tag );
+    str.m_TagSet.insert( tag );
+    }
+  str.m_Values.resize( fileNames.size() );
+
+  if ( !fileNames.empty() )
+    {
+    numberOfThreads = std::max( 1u, std::min( numberOfThreads, static_cast<unsigned int>( fileNames.size() ) ) );
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( numberOfThreads );
+    threader->SetSingleMethod( ReadTagsThreaderCallback, &str );
+    threader->SingleMethodExecute();
+    }
+
+  return str.m_Values;
+}
+
+}
+}
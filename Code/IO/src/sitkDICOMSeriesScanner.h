@@ -0,0 +1,116 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkDICOMSeriesScanner_h
+#define sitkDICOMSeriesScanner_h
+
+#include "sitkMacro.h"
+#include "sitkIO.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+namespace simple
+{
+
+/** \class DICOMSeriesScanner
+ * \brief Group the DICOM files of a directory into sorted series.
+ *
+ * Only the tags needed to identify and order the slices are read,
+ * the parsing stops before the pixel data. The files are parsed
+ * concurrently, and the parsed tags can be kept in an index file so
+ * that only new or modified files are parsed by later scans.
+ *
+ * The slices of a series are ordered by their position along the
+ * normal of the image orientation, then by the instance number, and
+ * otherwise by the file name.
+ */
+class SITKIO_HIDDEN DICOMSeriesScanner
+{
+public:
+  DICOMSeriesScanner();
+
+  void SetUseSeriesDetails( bool useSeriesDetails ) { m_UseSeriesDetails = useSeriesDetails; }
+  void SetRecursive( bool recursive ) { m_Recursive = recursive; }
+  void SetNumberOfThreads( unsigned int n ) { m_NumberOfThreads = n; }
+
+  /** The index of parsed files, no index is used when empty. */
+  void SetCacheFileName( const std::string &cacheFileName ) { m_CacheFileName = cacheFileName; }
+
+  void Scan( const std::string &directory );
+
+  /** The sorted identifiers of the series found by Scan. */
+  std::vector<std::string> GetSeriesIDs( void ) const;
+
+  /** The ordered files of a series, the first series when the
+   * seriesID is empty. */
+  std::vector<std::string> GetFileNames( const std::string &seriesID ) const;
+
+  /** The tags parsed from a file. */
+  struct FileInformation
+  {
+    FileInformation();
+
+    std::string m_FileName;
+    long int    m_ModifiedTime;
+    uint64_t    m_FileLength;
+
+    bool        m_IsDICOM;
+    std::string m_SeriesInstanceUID;
+    std::string m_SeriesDetails;
+    bool        m_HasPosition;
+    double      m_Position[3];
+    bool        m_HasOrientation;
+    double      m_Orientation[6];
+    bool        m_HasInstanceNumber;
+    long int    m_InstanceNumber;
+  };
+
+private:
+
+  void ReadCache( std::map<std::string, FileInformation> &cache ) const;
+  void WriteCache( const std::vector<FileInformation> &files ) const;
+
+  static void SortSeries( std::vector<const FileInformation *> &series );
+
+  bool         m_UseSeriesDetails;
+  bool         m_Recursive;
+  unsigned int m_NumberOfThreads;
+  std::string  m_CacheFileName;
+
+  std::map<std::string, std::vector<std::string> > m_Series;
+};
+
+
+/** Read the values of the tags of each of the DICOM files, the
+ * parsing stops before the pixel data and the files are parsed
+ * concurrently. The tags are "gggg|eeee" hexadecimal keys, and the
+ * values are converted to strings as the meta-data of the
+ * GDCMImageIO. Missing tags, and all tags of files which can not be
+ * read, have empty values. */
+SITKIO_HIDDEN std::vector< std::vector<std::string> >
+ReadDICOMTags( const std::vector<std::string> &fileNames,
+               const std::vector<std::string> &tags,
+               unsigned int numberOfThreads );
+
+}
+}
+
+#endif
@@ -0,0 +1,302 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkDistributedTileExecutor.h"
+#include "sitkImageFileReader.h"
+#include "sitkImageFileWriter.h"
+#include "sitkExceptionObject.h"
+#include "sitkChunkedImageIO.h"
+
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace itk {
+  namespace simple {
+
+  namespace
+  {
+
+  const unsigned int DefaultTileSize = 256;
+
+  std::string GetTileFileName( const std::string &outputFileName, unsigned int tile )
+  {
+    std::ostringstream name;
+    name << outputFileName << ".tile" << tile << ".sitkc";
+    return name.str();
+  }
+
+  // Copy the box at offset of size from the source image of
+  // sourceSize into the whole destination, a line along the first
+  // axis at a time.
+  void CopyBox( const char *source, const std::vector<unsigned int> &sourceSize,
+                const std::vector<unsigned int> &offset,
+                char *destination, const std::vector<unsigned int> &size,
+                size_t pixelSize )
+  {
+    const size_t dimension = size.size();
+    const size_t lineBytes = size[0] * pixelSize;
+    std::vector<unsigned int> line( dimension, 0 );
+    while ( true )
+      {
+      size_t sourceOffset = 0;
+      for ( size_t d = dimension; d > 0; --d )
+        {
+        sourceOffset = sourceOffset * sourceSize[d-1] + offset[d-1] + line[d-1];
+        }
+      std::memcpy( destination, source + sourceOffset * pixelSize, lineBytes );
+      destination += lineBytes;
+
+      size_t d = 1;
+      for ( ; d < dimension; ++d )
+        {
+        if ( ++line[d] < size[d] )
+          {
+          break;
+          }
+        line[d] = 0;
+        }
+      if ( d >= dimension )
+        {
+        return;
+        }
+      }
+  }
+
+  }
+
+
+  DistributedTileExecutor::DistributedTileExecutor()
+    : m_Transport( SITK_NULLPTR ),
+      m_NumberOfTiles( 0 )
+  {
+  }
+
+  DistributedTileExecutor::~DistributedTileExecutor()
+  {
+  }
+
+  std::string DistributedTileExecutor::ToString() const
+  {
+    std::ostringstream out;
+    out << "itk::simple::DistributedTileExecutor" << std::endl;
+    out << "  TileSize:";
+    for ( size_t i = 0; i < m_TileSize.size(); ++i )
+      {
+      out << " " << m_TileSize[i];
+      }
+    out << std::endl;
+    out << "  HaloRadius:";
+    for ( size_t i = 0; i < m_HaloRadius.size(); ++i )
+      {
+      out << " " << m_HaloRadius[i];
+      }
+    out << std::endl;
+    out << "  NumberOfRanks: " << ( m_Transport ? m_Transport->GetNumberOfRanks() : 1u ) << std::endl;
+    out << "  NumberOfTiles: " << m_NumberOfTiles << std::endl;
+    return out.str();
+  }
+
+  DistributedTileExecutor &DistributedTileExecutor::SetTileSize( const std::vector<unsigned int> &tileSize )
+  {
+    if ( std::find( tileSize.begin(), tileSize.end(), 0u ) != tileSize.end() )
+      {
+      sitkExceptionMacro( "The TileSize must not be zero." );
+      }
+    m_TileSize = tileSize;
+    return *this;
+  }
+
+  const std::vector<unsigned int> &DistributedTileExecutor::GetTileSize( ) const
+  {
+    return m_TileSize;
+  }
+
+  DistributedTileExecutor &DistributedTileExecutor::SetHaloRadius( const std::vector<unsigned int> &radius )
+  {
+    m_HaloRadius = radius;
+    return *this;
+  }
+
+  const std::vector<unsigned int> &DistributedTileExecutor::GetHaloRadius( ) const
+  {
+    return m_HaloRadius;
+  }
+
+  DistributedTileExecutor &DistributedTileExecutor::SetTransport( Transport *transport )
+  {
+    m_Transport = transport;
+    return *this;
+  }
+
+  DistributedTileExecutor::Transport *DistributedTileExecutor::GetTransport( ) const
+  {
+    return m_Transport;
+  }
+
+  unsigned int DistributedTileExecutor::GetNumberOfTiles( ) const
+  {
+    return m_NumberOfTiles;
+  }
+
+  void DistributedTileExecutor::Execute( const std::string &inputFileName,
+                                         const std::string &outputFileName,
+                                         TileFunction &function )
+  {
+    std::string extension = itksys::SystemTools::GetFilenameLastExtension( outputFileName );
+    std::transform( extension.begin(), extension.end(), extension.begin(), ::tolower );
+    if ( extension != ".sitkc" )
+      {
+      sitkExceptionMacro( "The output \"" << outputFileName << "\" must be in the chunked format, with the \".sitkc\" extension." );
+      }
+
+    const unsigned int rank = m_Transport ? m_Transport->GetRank() : 0u;
+    const unsigned int numberOfRanks = m_Transport ? m_Transport->GetNumberOfRanks() : 1u;
+    if ( rank >= numberOfRanks )
+      {
+      sitkExceptionMacro( "The rank " << rank << " is not less than the number of ranks " << numberOfRanks << "." );
+      }
+
+    ImageFileReader reader;
+    reader.SetFileName( inputFileName );
+    reader.ReadImageInformation();
+
+    const unsigned int dimension = reader.GetDimension();
+    if ( m_TileSize.size() > dimension || m_HaloRadius.size() > dimension )
+      {
+      sitkExceptionMacro( "The TileSize and HaloRadius must not have more elements than the "
+                          << dimension << " dimensions of the image." );
+      }
+
+    // the tiles are the chunks of the output, clipped to the image as
+    // the ChunkedImageIO does
+    std::vector<unsigned int> size( dimension );
+    std::vector<unsigned int> tileSize( dimension );
+    std::vector<unsigned int> radius( dimension, 0 );
+    std::vector<unsigned int> gridSize( dimension );
+    uint64_t numberOfTiles = 1;
+    for ( unsigned int d = 0; d < dimension; ++d )
+      {
+      size[d] = static_cast<unsigned int>( reader.GetSize()[d] );
+      tileSize[d] = ( d < m_TileSize.size() ) ? m_TileSize[d] : DefaultTileSize;
+      tileSize[d] = std::min( tileSize[d], std::max( size[d], 1u ) );
+      if ( d < m_HaloRadius.size() )
+        {
+        radius[d] = m_HaloRadius[d];
+        }
+      gridSize[d] = ( size[d] + tileSize[d] - 1 ) / tileSize[d];
+      numberOfTiles *= gridSize[d];
+      }
+    if ( numberOfTiles > std::numeric_limits<unsigned int>::max() )
+      {
+      sitkExceptionMacro( "The image has too many tiles, " << numberOfTiles << "." );
+      }
+    m_NumberOfTiles = static_cast<unsigned int>( numberOfTiles );
+
+    std::vector<int>          haloIndex( dimension );
+    std::vector<unsigned int> haloSize( dimension );
+    std::vector<unsigned int> offset( dimension );
+    std::vector<unsigned int> coreSize( dimension );
+    for ( unsigned int tile = rank; tile < m_NumberOfTiles; tile += numberOfRanks )
+      {
+      unsigned int t = tile;
+      for ( unsigned int d = 0; d < dimension; ++d )
+        {
+        const unsigned int start = ( t % gridSize[d] ) * tileSize[d];
+        t /= gridSize[d];
+        coreSize[d] = std::min( tileSize[d], size[d] - start );
+        const unsigned int haloStart = ( start > radius[d] ) ? start - radius[d] : 0u;
+        const unsigned int haloEnd = static_cast<unsigned int>(
+          std::min<uint64_t>( size[d], static_cast<uint64_t>( start ) + coreSize[d] + radius[d] ) );
+        haloIndex[d] = static_cast<int>( haloStart );
+        haloSize[d] = haloEnd - haloStart;
+        offset[d] = start - haloStart;
+        }
+
+      reader.SetExtractIndex( haloIndex );
+      reader.SetExtractSize( haloSize );
+      const Image result = function.Execute( reader.Execute() );
+
+      if ( result.GetSize() != haloSize )
+        {
+        sitkExceptionMacro( "The image of tile " << tile << " returned by the TileFunction does not have the size of the tile." );
+        }
+      const size_t pixelSize = GetPixelIDValueComponentSize( result.GetPixelID() ) * result.GetNumberOfComponentsPerPixel();
+      if ( pixelSize == 0 )
+        {
+        sitkExceptionMacro( "The pixel type " << result.GetPixelIDTypeAsString() << " is not supported." );
+        }
+
+      Image core( coreSize, result.GetPixelID(), result.GetNumberOfComponentsPerPixel(), Image::NoBufferInitialization );
+      CopyBox( static_cast<const char *>( result.GetBufferAsVoid() ), haloSize, offset,
+               static_cast<char *>( core.GetBufferAsVoid() ), coreSize, pixelSize );
+
+      ImageFileWriter writer;
+      writer.SetChunkSize( tileSize );
+      writer.Execute( core, GetTileFileName( outputFileName, tile ), true );
+      }
+
+    if ( m_Transport )
+      {
+      m_Transport->Barrier();
+      }
+
+    if ( rank == 0 )
+      {
+      std::vector<std::string> tileFileNames( m_NumberOfTiles );
+      for ( unsigned int tile = 0; tile < m_NumberOfTiles; ++tile )
+        {
+        tileFileNames[tile] = GetTileFileName( outputFileName, tile );
+        }
+
+      ChunkedImageIO::Pointer io = ChunkedImageIO::New();
+      io->SetFileName( outputFileName );
+      io->SetNumberOfDimensions( dimension );
+      for ( unsigned int d = 0; d < dimension; ++d )
+        {
+        io->SetDimensions( d, size[d] );
+        io->SetOrigin( d, reader.GetOrigin()[d] );
+        io->SetSpacing( d, reader.GetSpacing()[d] );
+        std::vector<double> axis( dimension );
+        for ( unsigned int r = 0; r < dimension; ++r )
+          {
+          axis[r] = reader.GetDirection()[r * dimension + d];
+          }
+        io->SetDirection( d, axis );
+        }
+      io->SetChunkSize( tileSize );
+      io->WriteFromChunkFiles( tileFileNames );
+
+      for ( unsigned int tile = 0; tile < m_NumberOfTiles; ++tile )
+        {
+        std::remove( tileFileNames[tile].c_str() );
+        }
+      }
+
+    if ( m_Transport )
+      {
+      m_Transport->Barrier();
+      }
+  }
+
+  }
+}
@@ -20,8 +20,18 @@
 #endif
 
 #include "sitkImageFileReader.h"
+#include "sitkMemoryMappedFile.h"
+#include "sitkRawFileIO.h"
+#include "sitkRemoteFile.h"
+#include "sitkChunkedImageIO.h"
+#include "sitkDICOMSeriesScanner.h"
+#include "sitkStreamingHashImageFilter.h"
 
 #include <itkImageFileReader.h>
+#include <itkExtractImageFilter.h>
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
 
 #include "sitkMetaDataDictionaryCustomCast.hxx"
 
@@ -35,9 +45,17 @@ namespace itk {
     }
 
     ImageFileReader::ImageFileReader() :
+      m_UseMemoryMapping(false),
+      m_IOBlockSize(0),
+      m_UseSequentialReadAhead(false),
+      m_PyramidLevel(0),
+      m_ComputeHash(false),
+      m_Buffer(SITK_NULLPTR),
+      m_BufferSize(0),
       m_PixelType(sitkUnknown),
       m_Dimension(0),
-      m_NumberOfComponents(0)
+      m_NumberOfComponents(0),
+      m_NumberOfPyramidLevels(0)
       {
       // list of pixel types supported
       typedef NonLabelPixelIDTypeList PixelIDTypeList;
@@ -70,6 +88,22 @@ namespace itk {
       out << "    Origin: " << this->m_Origin << std::endl;
       out << "    Spacing: " << this->m_Spacing << std::endl;
       out << "    Size: " << this->m_Size << std::endl;
+      out << "    NumberOfPyramidLevels: " << this->m_NumberOfPyramidLevels << std::endl;
+
+      out << "  ExtractSize: ";
+      this->ToStringHelper(out, this->m_ExtractSize) << std::endl;
+      out << "  ExtractIndex: ";
+      this->ToStringHelper(out, this->m_ExtractIndex) << std::endl;
+      out << "  UseMemoryMapping: ";
+      this->ToStringHelper(out, this->m_UseMemoryMapping) << std::endl;
+      out << "  IOBlockSize: ";
+      this->ToStringHelper(out, this->m_IOBlockSize) << std::endl;
+      out << "  UseSequentialReadAhead: ";
+      this->ToStringHelper(out, this->m_UseSequentialReadAhead) << std::endl;
+      out << "  PyramidLevel: ";
+      this->ToStringHelper(out, this->m_PyramidLevel) << std::endl;
+      out << "  ComputeHash: ";
+      this->ToStringHelper(out, this->m_ComputeHash) << std::endl;
 
       out << ImageReaderBase::ToString();
       return out.str();
@@ -84,6 +118,92 @@ namespace itk {
       return this->m_FileName;
     }
 
+    ImageFileReader& ImageFileReader::SetExtractSize( const std::vector<unsigned int> &size )
+    {
+      this->m_ExtractSize = size;
+      return *this;
+    }
+
+    const std::vector<unsigned int> &ImageFileReader::GetExtractSize( ) const
+    {
+      return this->m_ExtractSize;
+    }
+
+    ImageFileReader& ImageFileReader::SetExtractIndex( const std::vector<int> &index )
+    {
+      this->m_ExtractIndex = index;
+      return *this;
+    }
+
+    const std::vector<int> &ImageFileReader::GetExtractIndex( ) const
+    {
+      return this->m_ExtractIndex;
+    }
+
+    ImageFileReader& ImageFileReader::SetUseMemoryMapping( bool useMemoryMapping )
+    {
+      this->m_UseMemoryMapping = useMemoryMapping;
+      return *this;
+    }
+
+    bool ImageFileReader::GetUseMemoryMapping( ) const
+    {
+      return this->m_UseMemoryMapping;
+    }
+
+    ImageFileReader& ImageFileReader::SetIOBlockSize( uint64_t ioBlockSize )
+    {
+      this->m_IOBlockSize = ioBlockSize;
+      return *this;
+    }
+
+    uint64_t ImageFileReader::GetIOBlockSize( ) const
+    {
+      return this->m_IOBlockSize;
+    }
+
+    ImageFileReader& ImageFileReader::SetUseSequentialReadAhead( bool useSequentialReadAhead )
+    {
+      this->m_UseSequentialReadAhead = useSequentialReadAhead;
+      return *this;
+    }
+
+    bool ImageFileReader::GetUseSequentialReadAhead( ) const
+    {
+      return this->m_UseSequentialReadAhead;
+    }
+
+    ImageFileReader& ImageFileReader::SetPyramidLevel( unsigned int level )
+    {
+      this->m_PyramidLevel = level;
+      return *this;
+    }
+
+    unsigned int ImageFileReader::GetPyramidLevel( ) const
+    {
+      return this->m_PyramidLevel;
+    }
+
+    void
+    ImageFileReader
+    ::SelectPyramidLevel( itk::ImageIOBase* iobase ) const
+    {
+      ChunkedImageIO *ioChunkedImage = dynamic_cast<ChunkedImageIO*>(iobase);
+      if ( ioChunkedImage )
+        {
+        if ( ioChunkedImage->GetPyramidLevel() != this->m_PyramidLevel )
+          {
+          ioChunkedImage->SetPyramidLevel( this->m_PyramidLevel );
+          ioChunkedImage->ReadImageInformation();
+          }
+        }
+      else if ( this->m_PyramidLevel != 0 )
+        {
+        sitkExceptionMacro( "The pyramid level " << this->m_PyramidLevel << " is not in \"" << this->m_FileName
+                            << "\", only the SimpleITK chunked format stores multiple levels." );
+        }
+    }
+
 
     void
     ImageFileReader
@@ -129,6 +249,9 @@ namespace itk {
       swap(spacing, m_Spacing);
       swap(size, m_Size);
 
+      const ChunkedImageIO *ioChunkedImage = dynamic_cast<const ChunkedImageIO*>(iobase);
+      m_NumberOfPyramidLevels = ioChunkedImage ? ioChunkedImage->GetNumberOfPyramidLevels() : 1;
+
       this->m_pfGetMetaDataKeys = nsstd::bind(&MetaDataDictionary::GetKeys, this->m_MetaDataDictionary.get());
       this->m_pfHasMetaDataKey = nsstd::bind(&MetaDataDictionary::HasKey, this->m_MetaDataDictionary.get(), nsstd::placeholders::_1);
       this->m_pfGetMetaData = nsstd::bind(&GetMetaDataDictionaryCustomCast::CustomCast, this->m_MetaDataDictionary.get(), nsstd::placeholders::_1);
@@ -190,11 +313,25 @@ namespace itk {
       return this->m_Size;
     }
 
+    unsigned int
+    ImageFileReader
+    ::GetNumberOfPyramidLevels( void ) const
+    {
+      return this->m_NumberOfPyramidLevels;
+    }
+
     void
     ImageFileReader
     ::ReadImageInformation( void )
     {
+      if ( RemoteFile::IsRemoteFileName( this->m_FileName ) )
+        {
+        this->ReadRemoteImageInformation();
+        return;
+        }
+
       itk::ImageIOBase::Pointer imageio = this->GetImageIOBase( this->m_FileName );
+      this->SelectPyramidLevel(imageio);
       this->UpdateImageInformationFromImageIO(imageio);
     }
 
@@ -220,13 +357,44 @@ namespace itk {
       return this->m_pfGetMetaData(key);
     }
 
+    std::vector< std::vector<std::string> >
+    ImageFileReader
+    ::ReadDICOMTags( const std::vector<std::string> &fileNames,
+                     const std::vector<std::string> &tags )
+    {
+      return itk::simple::ReadDICOMTags( fileNames, tags, ProcessObject::GetGlobalDefaultNumberOfThreads() );
+    }
+
+    ImageFileReader& ImageFileReader::SetComputeHash( bool computeHash )
+    {
+      this->m_ComputeHash = computeHash;
+      return *this;
+    }
+
+    bool ImageFileReader::GetComputeHash( ) const
+    {
+      return this->m_ComputeHash;
+    }
+
+    std::string ImageFileReader::GetHash( ) const
+    {
+      return this->m_Hash;
+    }
+
     Image ImageFileReader::Execute ()
     {
+      if ( RemoteFile::IsRemoteFileName( this->m_FileName ) )
+        {
+        return this->ExecuteRemote();
+        }
+
+      this->m_Hash.clear();
 
       PixelIDValueType type = this->GetOutputPixelType();
 
 
       itk::ImageIOBase::Pointer imageio = this->GetImageIOBase( this->m_FileName );
+      this->SelectPyramidLevel(imageio);
       this->UpdateImageInformationFromImageIO(imageio);
       const unsigned int dimension = this->GetDimension();
       if (type == sitkUnknown)
@@ -243,6 +411,44 @@ namespace itk {
         sitkExceptionMacro( "The file has unsupported " << dimension << " dimensions." );
         }
 
+      if ( !this->m_ExtractSize.empty() )
+        {
+        if ( this->m_ExtractSize.size() != dimension )
+          {
+          sitkExceptionMacro( "The ExtractSize has " << this->m_ExtractSize.size()
+                              << " elements, but the file has " << dimension << " dimensions." );
+          }
+        if ( this->m_ExtractIndex.size() > dimension )
+          {
+          sitkExceptionMacro( "The ExtractIndex has " << this->m_ExtractIndex.size()
+                              << " elements, but the file has " << dimension << " dimensions." );
+          }
+
+        unsigned int outputDimension = 0;
+        for ( unsigned int i = 0; i < dimension; ++i )
+          {
+          const int64_t index = ( i < this->m_ExtractIndex.size() ) ? this->m_ExtractIndex[i] : 0;
+          const int64_t size = std::max( this->m_ExtractSize[i], 1u );
+          if ( index < 0 || index + size > static_cast<int64_t>( this->m_Size[i] ) )
+            {
+            sitkExceptionMacro( "The extraction region with index " << this->m_ExtractIndex
+                                << " and size " << this->m_ExtractSize
+                                << " is outside of the image of size " << this->m_Size << "." );
+            }
+          if ( this->m_ExtractSize[i] != 0 )
+            {
+            ++outputDimension;
+            }
+          }
+
+        if ( outputDimension < 2 )
+          {
+          sitkExceptionMacro( "The ExtractSize " << this->m_ExtractSize
+                              << " collapses the image to " << outputDimension
+                              << " dimensions, at least 2 dimensions are required." );
+          }
+        }
+
       if ( !this->m_MemberFactory->HasMemberFunction( type, dimension ) )
         {
         sitkExceptionMacro( << "PixelType is not supported!" << std::endl
@@ -254,6 +460,245 @@ namespace itk {
       return this->m_MemberFactory->GetMemberFunction( type, dimension )(imageio.GetPointer());
     }
 
+    Image ImageFileReader::Execute ( void *buffer, uint64_t bufferSize )
+    {
+      if ( buffer == SITK_NULLPTR )
+        {
+        sitkExceptionMacro( "The buffer to read into is null." );
+        }
+      if ( !this->m_ExtractSize.empty() )
+        {
+        sitkExceptionMacro( "An extract region can not be read into a buffer." );
+        }
+
+      this->m_Buffer = buffer;
+      this->m_BufferSize = bufferSize;
+      try
+        {
+        Image image = this->Execute();
+        this->m_Buffer = SITK_NULLPTR;
+        this->m_BufferSize = 0;
+        return image;
+        }
+      catch ( ... )
+        {
+        this->m_Buffer = SITK_NULLPTR;
+        this->m_BufferSize = 0;
+        throw;
+        }
+    }
+
+    Image ImageFileReader::ExecuteRemote ( void )
+    {
+      RemoteFile remote( this->m_FileName, this->GetNumberOfThreads() );
+      nsstd::auto_ptr<RemoteFile> dataFile;
+
+      // the file is read from the local copy, which is removed after
+      // the read so it can not be memory mapped
+      const std::string url = this->m_FileName;
+      const bool useMemoryMapping = this->m_UseMemoryMapping;
+      this->m_FileName = remote.GetLocalFileName();
+      this->m_UseMemoryMapping = false;
+      try
+        {
+        itk::ImageIOBase::Pointer imageio = this->FetchRemoteImageInformation( remote );
+        this->FetchRemotePixelData( remote, imageio, dataFile );
+        Image image = this->Execute();
+        this->m_FileName = url;
+        this->m_UseMemoryMapping = useMemoryMapping;
+        return image;
+        }
+      catch ( ... )
+        {
+        this->m_FileName = url;
+        this->m_UseMemoryMapping = useMemoryMapping;
+        throw;
+        }
+    }
+
+    void ImageFileReader::ReadRemoteImageInformation ( void )
+    {
+      RemoteFile remote( this->m_FileName, this->GetNumberOfThreads() );
+
+      const std::string url = this->m_FileName;
+      this->m_FileName = remote.GetLocalFileName();
+      try
+        {
+        itk::ImageIOBase::Pointer imageio = this->FetchRemoteImageInformation( remote );
+        this->UpdateImageInformationFromImageIO( imageio );
+        this->m_FileName = url;
+        }
+      catch ( ... )
+        {
+        this->m_FileName = url;
+        throw;
+        }
+    }
+
+    itk::ImageIOBase::Pointer
+    ImageFileReader::FetchRemoteImageInformation ( RemoteFile &remote )
+    {
+      // the header is expected in the first bytes of the file, the
+      // whole file is fetched when it can not be read from them
+      const uint64_t headerLength = std::min<uint64_t>( remote.GetSize(), 1024*1024 );
+      remote.Fetch( 0, headerLength );
+
+      itk::ImageIOBase::Pointer imageio;
+      try
+        {
+        imageio = this->GetImageIOBase( this->m_FileName );
+        this->SelectPyramidLevel( imageio );
+        }
+      catch ( std::exception & )
+        {
+        if ( headerLength == remote.GetSize() )
+          {
+          throw;
+          }
+        remote.Fetch( 0, remote.GetSize() );
+        imageio = this->GetImageIOBase( this->m_FileName );
+        this->SelectPyramidLevel( imageio );
+        }
+
+      // the chunk index of the chunked format may be larger than the
+      // bytes fetched
+      ChunkedImageIO *ioChunkedImage = dynamic_cast<ChunkedImageIO*>( imageio.GetPointer() );
+      if ( ioChunkedImage && ioChunkedImage->GetHeaderLength() > headerLength )
+        {
+        remote.Fetch( 0, ioChunkedImage->GetHeaderLength() );
+        ioChunkedImage->ReadImageInformation();
+        }
+      return imageio;
+    }
+
+    void
+    ImageFileReader::FetchRemotePixelData ( RemoteFile &remote,
+                                            itk::ImageIOBase *imageio,
+                                            nsstd::auto_ptr<RemoteFile> &dataFile )
+    {
+      this->UpdateImageInformationFromImageIO( imageio );
+      const unsigned int dimension = this->m_Dimension;
+
+      // the region read, an invalid extract region is reported by
+      // Execute
+      std::vector<uint64_t> regionIndex( dimension, 0 );
+      std::vector<uint64_t> regionSize( this->m_Size );
+      if ( !this->m_ExtractSize.empty() && this->m_ExtractSize.size() == dimension )
+        {
+        for ( unsigned int i = 0; i < dimension; ++i )
+          {
+          const int64_t index = ( i < this->m_ExtractIndex.size() ) ? this->m_ExtractIndex[i] : 0;
+          const uint64_t size = std::max( this->m_ExtractSize[i], 1u );
+          if ( index < 0 || index + size > this->m_Size[i] )
+            {
+            return;
+            }
+          regionIndex[i] = static_cast<uint64_t>( index );
+          regionSize[i] = size;
+          }
+        }
+
+      std::vector<uint64_t> offsets;
+      std::vector<uint64_t> lengths;
+
+      ChunkedImageIO *ioChunkedImage = dynamic_cast<ChunkedImageIO*>( imageio );
+      if ( ioChunkedImage )
+        {
+        itk::ImageIORegion region( dimension );
+        for ( unsigned int i = 0; i < dimension; ++i )
+          {
+          region.SetIndex( i, regionIndex[i] );
+          region.SetSize( i, regionSize[i] );
+          }
+        ioChunkedImage->GetChunkByteRanges( region, offsets, lengths );
+        remote.Fetch( offsets, lengths );
+        return;
+        }
+
+      std::string dataFileName;
+      int64_t dataOffset = 0;
+      const uint64_t bytesPerPixel = imageio->GetComponentSize() * imageio->GetNumberOfComponents();
+      if ( !GetRawPixelDataLocation( this->m_FileName, imageio, dataFileName, dataOffset ) || bytesPerPixel == 0 )
+        {
+        remote.Fetch( 0, remote.GetSize() );
+        return;
+        }
+
+      RemoteFile *data = &remote;
+      if ( dataFileName != this->m_FileName )
+        {
+        const std::string directory = remote.GetLocalDirectory() + "/";
+        if ( dataFileName.compare( 0, directory.size(), directory ) != 0 )
+          {
+          sitkExceptionMacro( "The pixel data file \"" << dataFileName << "\" of the remote file \""
+                              << remote.GetURL() << "\" is not in its directory." );
+          }
+        dataFile.reset( new RemoteFile( remote, dataFileName.substr( directory.size() ) ) );
+        data = dataFile.get();
+        }
+
+      uint64_t numberOfBytes = bytesPerPixel;
+      for ( unsigned int i = 0; i < dimension; ++i )
+        {
+        numberOfBytes *= this->m_Size[i];
+        }
+      if ( dataOffset == -1 )
+        {
+        dataOffset = static_cast<int64_t>( data->GetSize() ) - static_cast<int64_t>( numberOfBytes );
+        }
+      if ( dataOffset < 0 )
+        {
+        data->Fetch( 0, data->GetSize() );
+        return;
+        }
+
+      // an ImageIO which can not stream reads the whole image
+      if ( regionSize == this->m_Size || !imageio->CanStreamRead() )
+        {
+        data->Fetch( static_cast<uint64_t>( dataOffset ), numberOfBytes );
+        return;
+        }
+
+      // the lines of the region along the first dimension, with the
+      // small gaps between them fetched rather than split into more
+      // requests
+      const uint64_t maximumGap = 64*1024;
+      const uint64_t lineLength = regionSize[0] * bytesPerPixel;
+      uint64_t numberOfLines = 1;
+      for ( unsigned int i = 1; i < dimension; ++i )
+        {
+        numberOfLines *= regionSize[i];
+        }
+      for ( uint64_t line = 0; line < numberOfLines; ++line )
+        {
+        uint64_t pixel = 0;
+        uint64_t stride = 1;
+        uint64_t remainder = line;
+        for ( unsigned int i = 0; i < dimension; ++i )
+          {
+          uint64_t index = regionIndex[i];
+          if ( i > 0 )
+            {
+            index += remainder % regionSize[i];
+            remainder /= regionSize[i];
+            }
+          pixel += index * stride;
+          stride *= this->m_Size[i];
+          }
+        const uint64_t offset = static_cast<uint64_t>( dataOffset ) + pixel * bytesPerPixel;
+        if ( !offsets.empty() && offset <= offsets.back() + lengths.back() + maximumGap )
+          {
+          lengths.back() = offset + lineLength - offsets.back();
+          }
+        else
+          {
+          offsets.push_back( offset );
+          lengths.push_back( lineLength );
+          }
+        }
+      data->Fetch( offsets, lengths );
+    }
+
   template <class TImageType>
   Image
   ImageFileReader::ExecuteInternal( itk::ImageIOBase *imageio )
@@ -266,6 +711,51 @@ namespace itk {
     // not occur
     assert( ImageTypeToPixelIDValue<ImageType>::Result != (int)sitkUnknown );
     assert( imageio != SITK_NULLPTR );
+
+    if ( !this->m_ExtractSize.empty() )
+      {
+      const unsigned int outputDimension =
+        static_cast<unsigned int>( this->m_ExtractSize.size() - std::count( this->m_ExtractSize.begin(), this->m_ExtractSize.end(), 0u ) );
+      switch ( outputDimension )
+        {
+        case 2:
+          return this->ExecuteExtract<TImageType, 2>( imageio );
+        case 3:
+          return this->ExecuteExtract<TImageType, 3>( imageio );
+#ifdef SITK_4D_IMAGES
+        case 4:
+          return this->ExecuteExtract<TImageType, 4>( imageio );
+#endif
+        default:
+          sitkExceptionMacro( "Unexpected extraction dimension of " << outputDimension << "." );
+        }
+      }
+
+    if ( this->m_Buffer != SITK_NULLPTR )
+      {
+      return this->ExecuteIntoBuffer<TImageType>( imageio );
+      }
+
+    if ( this->m_UseMemoryMapping
+         && ImageTypeToPixelIDValue<ImageType>::Result == static_cast<int>( this->m_PixelType ) )
+      {
+      Image image;
+      if ( this->ExecuteMemoryMapped<TImageType>( imageio, image ) )
+        {
+        return image;
+        }
+      }
+
+    if ( ( this->m_IOBlockSize != 0 || this->m_UseSequentialReadAhead )
+         && ImageTypeToPixelIDValue<ImageType>::Result == static_cast<int>( this->m_PixelType ) )
+      {
+      Image image;
+      if ( this->ExecuteRawBlocks<TImageType>( imageio, image ) )
+        {
+        return image;
+        }
+      }
+
     typename Reader::Pointer reader = Reader::New();
     reader->SetImageIO( imageio );
     reader->SetFileName( this->m_FileName.c_str() );
@@ -274,8 +764,331 @@ namespace itk {
 
     reader->Update();
 
+    if ( this->m_ComputeHash )
+      {
+      this->m_Hash = StreamingHashImageFilter<ImageType>::HashImage( reader->GetOutput(), this->GetNumberOfThreads() );
+      }
+
     return Image( reader->GetOutput() );
   }
 
+  template <class TImageType>
+  bool
+  ImageFileReader::GetRawPixelData( const itk::ImageIOBase *imageio,
+                                    std::string &dataFileName,
+                                    uint64_t &dataOffset,
+                                    uint64_t &numberOfBytes,
+                                    unsigned int &elementsPerPixel ) const
+  {
+    typedef TImageType                                        ImageType;
+    typedef typename ImageType::PixelContainer::Element       ElementType;
+
+    int64_t offset = 0;
+    if ( !GetRawPixelDataLocation( this->m_FileName, imageio, dataFileName, offset ) )
+      {
+      return false;
+      }
+
+    // the pixel layout of the file must be the layout of the image buffer
+    const uint64_t bytesPerPixel = imageio->GetComponentSize() * imageio->GetNumberOfComponents();
+    if ( bytesPerPixel == 0 || bytesPerPixel % sizeof( ElementType ) != 0 )
+      {
+      return false;
+      }
+    elementsPerPixel = static_cast<unsigned int>( bytesPerPixel / sizeof( ElementType ) );
+    if ( elementsPerPixel != 1 && !IsVector<ImageType>::Value )
+      {
+      return false;
+      }
+
+    uint64_t numberOfPixels = 1;
+    for ( unsigned int i = 0; i < ImageType::ImageDimension; ++i )
+      {
+      numberOfPixels *= this->m_Size[i];
+      }
+    numberOfBytes = numberOfPixels * bytesPerPixel;
+
+    const uint64_t fileSize = itksys::SystemTools::FileLength( dataFileName.c_str() );
+    if ( offset == -1 )
+      {
+      if ( fileSize < numberOfBytes )
+        {
+        return false;
+        }
+      offset = static_cast<int64_t>( fileSize - numberOfBytes );
+      }
+    if ( offset < 0
+         || fileSize < static_cast<uint64_t>( offset ) + numberOfBytes
+         || static_cast<uint64_t>( offset ) % imageio->GetComponentSize() != 0 )
+      {
+      return false;
+      }
+    dataOffset = static_cast<uint64_t>( offset );
+    return true;
+  }
+
+  template <class TImageType>
+  bool
+  ImageFileReader::ExecuteMemoryMapped( itk::ImageIOBase *imageio, Image &outImage )
+  {
+    typedef TImageType                                        ImageType;
+    typedef typename ImageType::PixelContainer                PixelContainerType;
+    typedef typename PixelContainerType::ElementIdentifier    ElementIdentifierType;
+    typedef typename PixelContainerType::Element              ElementType;
+    typedef MemoryMappedImportImageContainer<ElementIdentifierType, ElementType> MappedContainerType;
+
+    std::string dataFileName;
+    uint64_t offset = 0;
+    uint64_t numberOfBytes = 0;
+    unsigned int elementsPerPixel = 1;
+    if ( !this->GetRawPixelData<TImageType>( imageio, dataFileName, offset, numberOfBytes, elementsPerPixel ) )
+      {
+      return false;
+      }
+    const uint64_t numberOfElements = numberOfBytes / sizeof( ElementType );
+
+    MemoryMappedFile::Pointer file = MemoryMappedFile::New();
+    if ( !file->Map( dataFileName, offset, numberOfBytes ) )
+      {
+      return false;
+      }
+
+    typename ImageType::Pointer image = this->CreateImageFromImageInformation<ImageType>( elementsPerPixel );
+
+    typename MappedContainerType::Pointer container = MappedContainerType::New();
+    container->SetMemoryMappedFile( file, static_cast<ElementIdentifierType>( numberOfElements ) );
+    image->SetPixelContainer( container );
+
+    image->SetMetaDataDictionary( imageio->GetMetaDataDictionary() );
+
+    if ( this->m_ComputeHash )
+      {
+      this->m_Hash = StreamingHashImageFilter<ImageType>::HashImage( image, this->GetNumberOfThreads() );
+      }
+
+    outImage = Image( image.GetPointer() );
+    return true;
+  }
+
+  template <class TImageType>
+  bool
+  ImageFileReader::ExecuteRawBlocks( itk::ImageIOBase *imageio, Image &outImage )
+  {
+    typedef TImageType ImageType;
+
+    std::string dataFileName;
+    uint64_t offset = 0;
+    uint64_t numberOfBytes = 0;
+    unsigned int elementsPerPixel = 1;
+    if ( !this->GetRawPixelData<TImageType>( imageio, dataFileName, offset, numberOfBytes, elementsPerPixel ) )
+      {
+      return false;
+      }
+
+    typename ImageType::Pointer image = this->CreateImageFromImageInformation<ImageType>( elementsPerPixel );
+    image->Allocate();
+
+    ReadFileBlocks( dataFileName, offset, numberOfBytes, image->GetPixelContainer()->GetBufferPointer(),
+                    this->m_IOBlockSize, this->m_UseSequentialReadAhead );
+
+    image->SetMetaDataDictionary( imageio->GetMetaDataDictionary() );
+
+    if ( this->m_ComputeHash )
+      {
+      this->m_Hash = StreamingHashImageFilter<ImageType>::HashImage( image, this->GetNumberOfThreads() );
+      }
+
+    outImage = Image( image.GetPointer() );
+    return true;
+  }
+
+  template <class TImageType>
+  Image
+  ImageFileReader::ExecuteIntoBuffer( itk::ImageIOBase *imageio )
+  {
+    typedef TImageType                                 ImageType;
+    typedef typename ImageType::PixelContainer         PixelContainerType;
+    typedef typename PixelContainerType::Element       ElementType;
+    typedef itk::ImageFileReader<ImageType>            Reader;
+
+    if ( ImageTypeToPixelIDValue<ImageType>::Result != static_cast<int>( this->m_PixelType ) )
+      {
+      sitkExceptionMacro( "The output pixel type " << GetPixelIDValueAsString( ImageTypeToPixelIDValue<ImageType>::Result )
+                          << " is not the pixel type " << GetPixelIDValueAsString( this->m_PixelType )
+                          << " of the file, which is required to read into a buffer." );
+      }
+
+    const uint64_t bytesPerPixel = imageio->GetComponentSize() * imageio->GetNumberOfComponents();
+    if ( bytesPerPixel == 0 || bytesPerPixel % sizeof( ElementType ) != 0 )
+      {
+      sitkExceptionMacro( "The pixels of the file can not be read into a buffer of "
+                          << GetPixelIDValueAsString( this->m_PixelType ) << "." );
+      }
+    const unsigned int elementsPerPixel = static_cast<unsigned int>( bytesPerPixel / sizeof( ElementType ) );
+
+    uint64_t numberOfPixels = 1;
+    for ( unsigned int i = 0; i < ImageType::ImageDimension; ++i )
+      {
+      numberOfPixels *= this->m_Size[i];
+      }
+    const uint64_t numberOfBytes = numberOfPixels * bytesPerPixel;
+
+    if ( this->m_BufferSize < numberOfBytes )
+      {
+      sitkExceptionMacro( "The buffer of " << this->m_BufferSize << " bytes is smaller than the "
+                          << numberOfBytes << " bytes of the pixels in the file \"" << this->m_FileName << "\"." );
+      }
+    if ( reinterpret_cast<size_t>( this->m_Buffer ) % imageio->GetComponentSize() != 0 )
+      {
+      sitkExceptionMacro( "The buffer is not aligned to the " << imageio->GetComponentSize()
+                          << " bytes of a pixel component." );
+      }
+
+    typename ImageType::Pointer image = this->CreateImageFromImageInformation<ImageType>( elementsPerPixel );
+
+    // The reader is not executed, it only carries the events to the
+    // registered commands.
+    typename Reader::Pointer reader = Reader::New();
+    reader->SetImageIO( imageio );
+    reader->SetFileName( this->m_FileName.c_str() );
+
+    this->PreUpdate( reader.GetPointer() );
+
+    reader->InvokeEvent( itk::StartEvent() );
+
+    itk::ImageIORegion ioRegion( imageio->GetNumberOfDimensions() );
+    for ( unsigned int i = 0; i < imageio->GetNumberOfDimensions(); ++i )
+      {
+      ioRegion.SetIndex( i, 0 );
+      ioRegion.SetSize( i, imageio->GetDimensions( i ) );
+      }
+    imageio->SetIORegion( ioRegion );
+
+    std::string dataFileName;
+    uint64_t offset = 0;
+    uint64_t rawNumberOfBytes = 0;
+    unsigned int rawElementsPerPixel = 1;
+    if ( ( this->m_IOBlockSize != 0 || this->m_UseSequentialReadAhead )
+         && this->GetRawPixelData<TImageType>( imageio, dataFileName, offset, rawNumberOfBytes, rawElementsPerPixel ) )
+      {
+      ReadFileBlocks( dataFileName, offset, rawNumberOfBytes, this->m_Buffer,
+                      this->m_IOBlockSize, this->m_UseSequentialReadAhead );
+      }
+    else
+      {
+      imageio->Read( this->m_Buffer );
+      }
+
+    typename PixelContainerType::Pointer container = PixelContainerType::New();
+    container->SetImportPointer( static_cast<ElementType *>( this->m_Buffer ),
+                                 static_cast<typename PixelContainerType::ElementIdentifier>( numberOfPixels * elementsPerPixel ),
+                                 false );
+    image->SetPixelContainer( container );
+
+    image->SetMetaDataDictionary( imageio->GetMetaDataDictionary() );
+
+    if ( this->m_ComputeHash )
+      {
+      this->m_Hash = StreamingHashImageFilter<ImageType>::HashImage( image, this->GetNumberOfThreads() );
+      }
+
+    reader->UpdateProgress( 1.0f );
+    reader->InvokeEvent( itk::EndEvent() );
+
+    return Image( image.GetPointer() );
+  }
+
+  template <class TImageType>
+  typename TImageType::Pointer
+  ImageFileReader::CreateImageFromImageInformation( unsigned int numberOfComponents ) const
+  {
+    typedef TImageType ImageType;
+
+    typename ImageType::Pointer image = ImageType::New();
+
+    typename ImageType::RegionType region;
+    typename ImageType::PointType origin;
+    typename ImageType::SpacingType spacing;
+    typename ImageType::DirectionType direction;
+    for ( unsigned int i = 0; i < ImageType::ImageDimension; ++i )
+      {
+      region.SetSize( i, this->m_Size[i] );
+      origin[i] = this->m_Origin[i];
+      spacing[i] = this->m_Spacing[i];
+      for ( unsigned int j = 0; j < ImageType::ImageDimension; ++j )
+        {
+        direction[j][i] = this->m_Direction[i*ImageType::ImageDimension+j];
+        }
+      }
+    image->SetRegions( region );
+    image->SetOrigin( origin );
+    image->SetSpacing( spacing );
+    image->SetDirection( direction );
+    image->SetNumberOfComponentsPerPixel( numberOfComponents );
+
+    return image;
+  }
+
+  template <class TImageType, unsigned int VOutputDimension>
+  typename EnableIf<(TImageType::ImageDimension >= VOutputDimension), Image>::Type
+  ImageFileReader::ExecuteExtract( itk::ImageIOBase *imageio )
+  {
+    typedef TImageType                                 InputImageType;
+    typedef typename InputImageType::template Rebind<typename InputImageType::InternalPixelType,
+                                                     VOutputDimension>::Type OutputImageType;
+    typedef itk::ImageFileReader<InputImageType>                        Reader;
+    typedef itk::ExtractImageFilter<InputImageType, OutputImageType>    ExtractorType;
+
+    typename Reader::Pointer reader = Reader::New();
+    reader->SetImageIO( imageio );
+    reader->SetFileName( this->m_FileName.c_str() );
+
+    typename InputImageType::RegionType region;
+    for ( unsigned int i = 0; i < InputImageType::ImageDimension; ++i )
+      {
+      region.SetIndex( i, ( i < this->m_ExtractIndex.size() ) ? this->m_ExtractIndex[i] : 0 );
+      region.SetSize( i, this->m_ExtractSize[i] );
+      }
+
+    // Only the extraction region is requested from the reader, which
+    // is all that is read when the ImageIO supports streaming.
+    typename ExtractorType::Pointer extractor = ExtractorType::New();
+    extractor->SetInput( reader->GetOutput() );
+    extractor->SetExtractionRegion( region );
+    extractor->SetDirectionCollapseToSubmatrix();
+
+    this->PreUpdate( reader.GetPointer() );
+
+    extractor->Update();
+
+    typename OutputImageType::Pointer output = extractor->GetOutput();
+    output->DisconnectPipeline();
+
+    // SimpleITK requires a zero starting index
+    typename OutputImageType::RegionType outputRegion = output->GetLargestPossibleRegion();
+    typename OutputImageType::PointType origin;
+    output->TransformIndexToPhysicalPoint( outputRegion.GetIndex(), origin );
+    output->SetOrigin( origin );
+    typename OutputImageType::IndexType zeroIndex;
+    zeroIndex.Fill( 0 );
+    outputRegion.SetIndex( zeroIndex );
+    output->SetRegions( outputRegion );
+
+    if ( this->m_ComputeHash )
+      {
+      this->m_Hash = StreamingHashImageFilter<OutputImageType>::HashImage( output, this->GetNumberOfThreads() );
+      }
+
+    return Image( output.GetPointer() );
+  }
+
+  template <class TImageType, unsigned int VOutputDimension>
+  typename DisableIf<(TImageType::ImageDimension >= VOutputDimension), Image>::Type
+  ImageFileReader::ExecuteExtract( itk::ImageIOBase * )
+  {
+    sitkExceptionMacro( << "The extraction dimension " << VOutputDimension
+                        << " is greater than the input dimension " << TImageType::ImageDimension << "." );
+  }
+
   }
 }
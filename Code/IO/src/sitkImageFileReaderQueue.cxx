@@ -0,0 +1,306 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkImageFileReaderQueue.h"
+#include "sitkImageFileReader.h"
+
+#include <itkMultiThreader.h>
+#include <itkMutexLock.h>
+#include <itkConditionVariable.h>
+
+#include <algorithm>
+#include <map>
+
+namespace itk {
+  namespace simple {
+
+  struct ImageFileReaderQueue::Implementation
+  {
+    Implementation( const std::vector<std::string> &fileNames,
+                    PixelIDValueEnum outputPixelType,
+                    const std::string &imageio,
+                    unsigned int maximumNumberOfPending )
+      : m_FileNames( fileNames ),
+        m_OutputPixelType( outputPixelType ),
+        m_ImageIO( imageio ),
+        m_MaximumNumberOfPending( maximumNumberOfPending ),
+        m_Condition( itk::ConditionVariable::New() ),
+        m_NextToRead( 0 ),
+        m_NextToTake( 0 ),
+        m_NumberOfPending( 0 ),
+        m_Stop( false ),
+        m_Threader( itk::MultiThreader::New() )
+      {
+      }
+
+    static ITK_THREAD_RETURN_TYPE Worker( void *arg );
+
+    bool IsReady( size_t index ) const
+      {
+        return m_Images.count( index ) || m_Errors.count( index );
+      }
+
+    const std::vector<std::string> m_FileNames;
+    const PixelIDValueEnum         m_OutputPixelType;
+    const std::string              m_ImageIO;
+    const unsigned int             m_MaximumNumberOfPending;
+
+    // the following are guarded by the mutex
+    itk::SimpleMutexLock            m_Mutex;
+    itk::ConditionVariable::Pointer m_Condition;
+    size_t                          m_NextToRead;
+    size_t                          m_NextToTake;
+    unsigned int                    m_NumberOfPending;
+    bool                            m_Stop;
+    std::map<size_t, Image>         m_Images;
+    std::map<size_t, std::string>   m_Errors;
+
+    itk::MultiThreader::Pointer     m_Threader;
+    std::vector<itk::ThreadIdType>  m_Threads;
+  };
+
+
+  ITK_THREAD_RETURN_TYPE ImageFileReaderQueue::Implementation::Worker( void *arg )
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+    Implementation *self = static_cast<Implementation *>( info->UserData );
+
+    ImageFileReader reader;
+    reader.SetOutputPixelType( self->m_OutputPixelType );
+    reader.SetImageIO( self->m_ImageIO );
+
+    while ( true )
+      {
+      self->m_Mutex.Lock();
+      while ( !self->m_Stop
+              && self->m_NextToRead < self->m_FileNames.size()
+              && self->m_NumberOfPending >= self->m_MaximumNumberOfPending )
+        {
+        self->m_Condition->Wait( &self->m_Mutex );
+        }
+      if ( self->m_Stop || self->m_NextToRead >= self->m_FileNames.size() )
+        {
+        self->m_Mutex.Unlock();
+        break;
+        }
+      const size_t index = self->m_NextToRead++;
+      ++self->m_NumberOfPending;
+      self->m_Mutex.Unlock();
+
+      Image image;
+      std::string error;
+      try
+        {
+        image = reader.SetFileName( self->m_FileNames[index] ).Execute();
+        }
+      catch ( std::exception &e )
+        {
+        error = e.what();
+        }
+      catch ( ... )
+        {
+        error = "Unknown exception reading \"" + self->m_FileNames[index] + "\".";
+        }
+
+      self->m_Mutex.Lock();
+      if ( error.empty() )
+        {
+        self->m_Images[index] = image;
+        }
+      else
+        {
+        self->m_Errors[index] = error;
+        }
+      self->m_Condition->Broadcast();
+      self->m_Mutex.Unlock();
+      }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+
+  ImageFileReaderQueue::ImageFileReaderQueue()
+    : m_Implementation( SITK_NULLPTR ),
+      m_OutputPixelType( sitkUnknown ),
+      m_NumberOfWorkers( 2 ),
+      m_MaximumNumberOfPendingImages( 4 )
+  {
+  }
+
+  ImageFileReaderQueue::~ImageFileReaderQueue()
+  {
+    this->Stop();
+  }
+
+  std::string ImageFileReaderQueue::ToString() const
+  {
+    std::ostringstream out;
+    out << "itk::simple::ImageFileReaderQueue" << std::endl;
+    out << "  FileNames:" << std::endl;
+    for ( size_t i = 0; i < m_FileNames.size(); ++i )
+      {
+      out << "    \"" << m_FileNames[i] << "\"" << std::endl;
+      }
+    out << "  OutputPixelType: " << GetPixelIDValueAsString( m_OutputPixelType ) << std::endl;
+    out << "  ImageIO: \"" << m_ImageIO << "\"" << std::endl;
+    out << "  NumberOfWorkers: " << m_NumberOfWorkers << std::endl;
+    out << "  MaximumNumberOfPendingImages: " << m_MaximumNumberOfPendingImages << std::endl;
+    return out.str();
+  }
+
+  ImageFileReaderQueue &ImageFileReaderQueue::SetFileNames( const std::vector<std::string> &fileNames )
+  {
+    this->m_FileNames = fileNames;
+    return *this;
+  }
+
+  const std::vector<std::string> &ImageFileReaderQueue::GetFileNames( ) const
+  {
+    return this->m_FileNames;
+  }
+
+  ImageFileReaderQueue &ImageFileReaderQueue::SetOutputPixelType( PixelIDValueEnum pixelID )
+  {
+    this->m_OutputPixelType = pixelID;
+    return *this;
+  }
+
+  PixelIDValueEnum ImageFileReaderQueue::GetOutputPixelType( ) const
+  {
+    return this->m_OutputPixelType;
+  }
+
+  ImageFileReaderQueue &ImageFileReaderQueue::SetImageIO( const std::string &imageio )
+  {
+    this->m_ImageIO = imageio;
+    return *this;
+  }
+
+  std::string ImageFileReaderQueue::GetImageIO( ) const
+  {
+    return this->m_ImageIO;
+  }
+
+  ImageFileReaderQueue &ImageFileReaderQueue::SetNumberOfWorkers( unsigned int n )
+  {
+    this->m_NumberOfWorkers = std::max( 1u, std::min( n, static_cast<unsigned int>( ITK_MAX_THREADS ) ) );
+    return *this;
+  }
+
+  unsigned int ImageFileReaderQueue::GetNumberOfWorkers( ) const
+  {
+    return this->m_NumberOfWorkers;
+  }
+
+  ImageFileReaderQueue &ImageFileReaderQueue::SetMaximumNumberOfPendingImages( unsigned int n )
+  {
+    this->m_MaximumNumberOfPendingImages = std::max( 1u, n );
+    return *this;
+  }
+
+  unsigned int ImageFileReaderQueue::GetMaximumNumberOfPendingImages( ) const
+  {
+    return this->m_MaximumNumberOfPendingImages;
+  }
+
+  void ImageFileReaderQueue::Start( )
+  {
+    this->Stop();
+
+    m_Implementation = new Implementation( m_FileNames, m_OutputPixelType, m_ImageIO, m_MaximumNumberOfPendingImages );
+
+    const unsigned int numberOfWorkers =
+      std::min( m_NumberOfWorkers, static_cast<unsigned int>( m_FileNames.size() ) );
+    for ( unsigned int i = 0; i < numberOfWorkers; ++i )
+      {
+      m_Implementation->m_Threads.push_back( m_Implementation->m_Threader->SpawnThread( Implementation::Worker, m_Implementation ) );
+      }
+  }
+
+  void ImageFileReaderQueue::Stop( )
+  {
+    if ( m_Implementation == SITK_NULLPTR )
+      {
+      return;
+      }
+
+    m_Implementation->m_Mutex.Lock();
+    m_Implementation->m_Stop = true;
+    m_Implementation->m_Condition->Broadcast();
+    m_Implementation->m_Mutex.Unlock();
+
+    // wait for the files being read
+    for ( size_t i = 0; i < m_Implementation->m_Threads.size(); ++i )
+      {
+      m_Implementation->m_Threader->TerminateThread( m_Implementation->m_Threads[i] );
+      }
+
+    delete m_Implementation;
+    m_Implementation = SITK_NULLPTR;
+  }
+
+  bool ImageFileReaderQueue::HasNext( ) const
+  {
+    // only the caller of Next changes the next index to take
+    return m_Implementation != SITK_NULLPTR
+      && m_Implementation->m_NextToTake < m_Implementation->m_FileNames.size();
+  }
+
+  Image ImageFileReaderQueue::Next( )
+  {
+    if ( !this->HasNext() )
+      {
+      sitkExceptionMacro( "There is no next image, the queue has not been started or all the files have been read." );
+      }
+
+    Implementation *impl = m_Implementation;
+
+    impl->m_Mutex.Lock();
+    const size_t index = impl->m_NextToTake;
+    while ( !impl->IsReady( index ) )
+      {
+      impl->m_Condition->Wait( &impl->m_Mutex );
+      }
+
+    Image image;
+    std::string error;
+    std::map<size_t, Image>::iterator it = impl->m_Images.find( index );
+    if ( it != impl->m_Images.end() )
+      {
+      image = it->second;
+      impl->m_Images.erase( it );
+      }
+    else
+      {
+      error = impl->m_Errors[index];
+      impl->m_Errors.erase( index );
+      }
+    ++impl->m_NextToTake;
+    --impl->m_NumberOfPending;
+    impl->m_Condition->Broadcast();
+    impl->m_Mutex.Unlock();
+
+    if ( !error.empty() )
+      {
+      sitkExceptionMacro( << error );
+      }
+    return image;
+  }
+
+  }
+}
@@ -17,15 +17,185 @@
 *=========================================================================*/
 
 #include "sitkImageFileWriter.h"
+#include "sitkParallelDeflate.h"
+#include "sitkImageIOCompression.h"
+#include "sitkChunkedImageIO.h"
+#include "sitkRawFileIO.h"
+#include "sitkStreamingHashImageFilter.h"
 
 #include <itkImageIOBase.h>
 #include <itkImageFileWriter.h>
 #include <itkImageRegionIterator.h>
+#include <itkLabelMapToLabelImageFilter.h>
 #include <itkGDCMImageIO.h>
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
 
 namespace itk {
 namespace simple {
 
+namespace
+{
+
+enum ParallelCompressionFileType
+{
+  NoParallelCompression,
+  MetaImageParallelCompression,
+  NrrdParallelCompression,
+  NiftiParallelCompression
+};
+
+bool EndsWith( const std::string &s, const std::string &suffix )
+{
+  return s.size() >= suffix.size() && s.compare( s.size() - suffix.size(), suffix.size(), suffix ) == 0;
+}
+
+ParallelCompressionFileType GetParallelCompressionFileType( const itk::ImageIOBase *imageio, const std::string &fileName )
+{
+  const std::string ioName = imageio->GetNameOfClass();
+  const std::string lowerFileName = itksys::SystemTools::LowerCase( fileName );
+
+  if ( ioName == "MetaImageIO" && EndsWith( lowerFileName, ".mha" ) )
+    {
+    return MetaImageParallelCompression;
+    }
+  if ( ioName == "NrrdImageIO" && EndsWith( lowerFileName, ".nrrd" ) )
+    {
+    return NrrdParallelCompression;
+    }
+  if ( ioName == "NiftiImageIO" && EndsWith( lowerFileName, ".nii.gz" ) )
+    {
+    return NiftiParallelCompression;
+    }
+  return NoParallelCompression;
+}
+
+std::string GetHeaderKey( const std::string &line, char separator )
+{
+  const std::string::size_type pos = line.find( separator );
+  if ( pos == std::string::npos )
+    {
+    return std::string();
+    }
+  std::string key = line.substr( 0, pos );
+  key.erase( key.find_last_not_of( " \t" ) + 1 );
+  key.erase( 0, key.find_first_not_of( " \t" ) );
+  return key;
+}
+
+void CompressRemaining( std::istream &in, ParallelDeflate &deflater, uint64_t blockSize )
+{
+  std::vector<char> buffer( blockSize != 0 ? static_cast<size_t>( blockSize ) : 1024*1024 );
+  while ( in )
+    {
+    in.read( &buffer[0], buffer.size() );
+    if ( in.gcount() > 0 )
+      {
+      deflater.Write( &buffer[0], static_cast<size_t>( in.gcount() ) );
+      }
+    }
+}
+
+/** Write the uncompressed file as a compressed file of the same format.
+ *
+ * The header of MetaImage and NRRD files is copied with the
+ * compression fields updated and the pixel data is compressed, while
+ * the complete file is compressed for gzip NIfTI.
+ */
+void CompressFile( ParallelCompressionFileType fileType,
+                   const std::string &uncompressedFileName,
+                   const std::string &fileName,
+                   int compressionLevel,
+                   unsigned int numberOfThreads,
+                   uint64_t blockSize )
+{
+  std::ifstream in( uncompressedFileName.c_str(), std::ios::in | std::ios::binary );
+  std::ofstream out( fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+  if ( !in || !out )
+    {
+    sitkExceptionMacro( "Unable to open \"" << fileName << "\" for writing." );
+    }
+
+  std::string line;
+  if ( fileType == MetaImageParallelCompression )
+    {
+    std::streampos compressedDataSizePosition = -1;
+    while ( std::getline( in, line ) )
+      {
+      const std::string key = GetHeaderKey( line, '=' );
+      if ( key == "CompressedData" || key == "CompressedDataSize" )
+        {
+        continue;
+        }
+      if ( key == "ElementDataFile" )
+        {
+        // the size is filled in when the data is compressed
+        out << "CompressedData = True\n";
+        out << "CompressedDataSize = ";
+        compressedDataSizePosition = out.tellp();
+        out << std::string( 20, ' ' ) << "\n";
+        out << line << "\n";
+        break;
+        }
+      out << line << "\n";
+      }
+    if ( compressedDataSizePosition == std::streampos( -1 ) )
+      {
+      sitkExceptionMacro( "Unexpected MetaImage header written to \"" << uncompressedFileName << "\"." );
+      }
+
+    ParallelDeflate deflater( out, ParallelDeflate::Zlib, compressionLevel, numberOfThreads );
+    CompressRemaining( in, deflater, blockSize );
+    const uint64_t compressedDataSize = deflater.Finish();
+
+    out.seekp( compressedDataSizePosition );
+    out << std::setw( 20 ) << compressedDataSize;
+    }
+  else if ( fileType == NrrdParallelCompression )
+    {
+    bool endOfHeader = false;
+    while ( std::getline( in, line ) )
+      {
+      if ( line.empty() || line == "\r" )
+        {
+        endOfHeader = true;
+        out << "\n";
+        break;
+        }
+      if ( line[0] != '#' && GetHeaderKey( line, ':' ) == "encoding" )
+        {
+        out << "encoding: gzip\n";
+        continue;
+        }
+      out << line << "\n";
+      }
+    if ( !endOfHeader )
+      {
+      sitkExceptionMacro( "Unexpected NRRD header written to \"" << uncompressedFileName << "\"." );
+      }
+
+    ParallelDeflate deflater( out, ParallelDeflate::Gzip, compressionLevel, numberOfThreads );
+    CompressRemaining( in, deflater, blockSize );
+    deflater.Finish();
+    }
+  else
+    {
+    ParallelDeflate deflater( out, ParallelDeflate::Gzip, compressionLevel, numberOfThreads );
+    CompressRemaining( in, deflater, blockSize );
+    deflater.Finish();
+    }
+
+  if ( !out )
+    {
+    sitkExceptionMacro( "Error writing \"" << fileName << "\"." );
+    }
+}
+
+}
+
 void WriteImage ( const Image& image, const std::string &inFileName, bool useCompression )
   {
     ImageFileWriter writer;
@@ -36,7 +206,16 @@ void WriteImage ( const Image& image, const std::string &inFileName, bool useCom
 ImageFileWriter::ImageFileWriter()
   {
   this->m_UseCompression = false;
+  this->m_UseParallelCompression = false;
+  this->m_CompressionLevel = -1;
   this->m_KeepOriginalImageUID = false;
+  this->m_NumberOfPyramidLevels = 1;
+  this->m_ComputeHash = false;
+  this->m_UseDirectIO = false;
+  this->m_DropFromPageCache = false;
+  this->m_IOBlockSize = 0;
+
+  ChunkedImageIOFactory::RegisterOneFactory();
 
   this->m_MemberFactory.reset( new detail::MemberFunctionFactory<MemberFunctionType>( this ) );
 
@@ -44,6 +223,10 @@ ImageFileWriter::ImageFileWriter()
   this->m_MemberFactory->RegisterMemberFunctions< PixelIDTypeList, 3 > ();
   this->m_MemberFactory->RegisterMemberFunctions< PixelIDTypeList, 2 > ();
 
+  this->m_MemberFactory->RegisterMemberFunctions< LabelPixelIDTypeList, 4, detail::ExecuteInternalLabelImageAddressor<MemberFunctionType> > ();
+  this->m_MemberFactory->RegisterMemberFunctions< LabelPixelIDTypeList, 3, detail::ExecuteInternalLabelImageAddressor<MemberFunctionType> > ();
+  this->m_MemberFactory->RegisterMemberFunctions< LabelPixelIDTypeList, 2, detail::ExecuteInternalLabelImageAddressor<MemberFunctionType> > ();
+
   }
 
 
@@ -57,6 +240,18 @@ std::string ImageFileWriter::ToString() const
   this->ToStringHelper(out, this->m_UseCompression);
   out << std::endl;
 
+  out << "  UseParallelCompression: ";
+  this->ToStringHelper(out, this->m_UseParallelCompression);
+  out << std::endl;
+
+  out << "  CompressionLevel: ";
+  this->ToStringHelper(out, this->m_CompressionLevel);
+  out << std::endl;
+
+  out << "  Compressor: \"";
+  this->ToStringHelper(out, this->m_Compressor);
+  out << "\"" << std::endl;
+
   out << "  KeepOriginalImageUID: ";
   this->ToStringHelper(out, this->m_KeepOriginalImageUID);
   out << std::endl;
@@ -65,6 +260,34 @@ std::string ImageFileWriter::ToString() const
   this->ToStringHelper(out, this->m_FileName);
   out << "\"" << std::endl;
 
+  out << "  PasteIndex: ";
+  this->ToStringHelper(out, this->m_PasteIndex);
+  out << std::endl;
+
+  out << "  ChunkSize: ";
+  this->ToStringHelper(out, this->m_ChunkSize);
+  out << std::endl;
+
+  out << "  NumberOfPyramidLevels: ";
+  this->ToStringHelper(out, this->m_NumberOfPyramidLevels);
+  out << std::endl;
+
+  out << "  ComputeHash: ";
+  this->ToStringHelper(out, this->m_ComputeHash);
+  out << std::endl;
+
+  out << "  UseDirectIO: ";
+  this->ToStringHelper(out, this->m_UseDirectIO);
+  out << std::endl;
+
+  out << "  DropFromPageCache: ";
+  this->ToStringHelper(out, this->m_DropFromPageCache);
+  out << std::endl;
+
+  out << "  IOBlockSize: ";
+  this->ToStringHelper(out, this->m_IOBlockSize);
+  out << std::endl;
+
   out << ProcessObject::ToString();
   return out.str();
   }
@@ -81,6 +304,42 @@ std::string ImageFileWriter::ToString() const
     return this->m_UseCompression;
   }
 
+  ImageFileWriter::Self&
+  ImageFileWriter::SetUseParallelCompression( bool UseParallelCompression )
+  {
+    this->m_UseParallelCompression = UseParallelCompression;
+    return *this;
+  }
+
+  bool ImageFileWriter::GetUseParallelCompression( void ) const
+  {
+    return this->m_UseParallelCompression;
+  }
+
+  ImageFileWriter::Self&
+  ImageFileWriter::SetCompressionLevel( int CompressionLevel )
+  {
+    this->m_CompressionLevel = CompressionLevel;
+    return *this;
+  }
+
+  int ImageFileWriter::GetCompressionLevel( void ) const
+  {
+    return this->m_CompressionLevel;
+  }
+
+  ImageFileWriter::Self&
+  ImageFileWriter::SetCompressor( const std::string &Compressor )
+  {
+    this->m_Compressor = Compressor;
+    return *this;
+  }
+
+  std::string ImageFileWriter::GetCompressor( void ) const
+  {
+    return this->m_Compressor;
+  }
+
   ImageFileWriter::Self&
   ImageFileWriter::SetKeepOriginalImageUID( bool KeepOriginalImageUID )
   {
@@ -104,6 +363,88 @@ std::string ImageFileWriter::GetFileName() const
   return this->m_FileName;
   }
 
+ImageFileWriter& ImageFileWriter::SetPasteIndex ( const std::vector<unsigned int> &index )
+  {
+  this->m_PasteIndex = index;
+  return *this;
+  }
+
+const std::vector<unsigned int> &ImageFileWriter::GetPasteIndex() const
+  {
+  return this->m_PasteIndex;
+  }
+
+ImageFileWriter& ImageFileWriter::SetChunkSize ( const std::vector<unsigned int> &chunkSize )
+  {
+  this->m_ChunkSize = chunkSize;
+  return *this;
+  }
+
+const std::vector<unsigned int> &ImageFileWriter::GetChunkSize() const
+  {
+  return this->m_ChunkSize;
+  }
+
+ImageFileWriter& ImageFileWriter::SetNumberOfPyramidLevels ( unsigned int levels )
+  {
+  this->m_NumberOfPyramidLevels = levels;
+  return *this;
+  }
+
+unsigned int ImageFileWriter::GetNumberOfPyramidLevels() const
+  {
+  return this->m_NumberOfPyramidLevels;
+  }
+
+ImageFileWriter& ImageFileWriter::SetComputeHash ( bool computeHash )
+  {
+  this->m_ComputeHash = computeHash;
+  return *this;
+  }
+
+bool ImageFileWriter::GetComputeHash() const
+  {
+  return this->m_ComputeHash;
+  }
+
+std::string ImageFileWriter::GetHash() const
+  {
+  return this->m_Hash;
+  }
+
+ImageFileWriter& ImageFileWriter::SetUseDirectIO ( bool useDirectIO )
+  {
+  this->m_UseDirectIO = useDirectIO;
+  return *this;
+  }
+
+bool ImageFileWriter::GetUseDirectIO() const
+  {
+  return this->m_UseDirectIO;
+  }
+
+ImageFileWriter& ImageFileWriter::SetDropFromPageCache ( bool dropFromPageCache )
+  {
+  this->m_DropFromPageCache = dropFromPageCache;
+  return *this;
+  }
+
+bool ImageFileWriter::GetDropFromPageCache() const
+  {
+  return this->m_DropFromPageCache;
+  }
+
+ImageFileWriter& ImageFileWriter::SetIOBlockSize ( uint64_t ioBlockSize )
+  {
+  this->m_IOBlockSize = ioBlockSize;
+  return *this;
+  }
+
+uint64_t ImageFileWriter::GetIOBlockSize() const
+  {
+  return this->m_IOBlockSize;
+  }
+
   ImageFileWriter& ImageFileWriter::Execute ( const Image& image, const std::string &inFileName, bool useCompression )
   {
     this->SetFileName( inFileName );
@@ -116,6 +457,8 @@ ImageFileWriter& ImageFileWriter::Execute ( const Image& image )
     PixelIDValueType type = image.GetPixelIDValue();
     unsigned int dimension = image.GetDimension();
 
+    this->m_Hash.clear();
+
     return this->m_MemberFactory->GetMemberFunction( type, dimension )( image );
   }
 
@@ -138,27 +481,345 @@ ImageFileWriter
     {
     ioGDCMImage->SetKeepOriginalUID(this->m_KeepOriginalImageUID);
     }
+  ChunkedImageIO *ioChunkedImage = dynamic_cast<ChunkedImageIO*>(iobase.GetPointer());
+  if (ioChunkedImage)
+    {
+    ioChunkedImage->SetChunkSize(this->m_ChunkSize);
+    ioChunkedImage->SetNumberOfPyramidLevels(this->m_NumberOfPyramidLevels);
+    ioChunkedImage->SetNumberOfThreads(this->GetNumberOfThreads());
+    }
   return iobase;
 }
 
+void
+ImageFileWriter
+::DropWrittenFileFromPageCache( const ImageIOBase *imageio ) const
+{
+  DropFileFromPageCache( this->m_FileName );
+
+  std::string dataFileName;
+  int64_t offset = 0;
+  if ( GetRawPixelDataLocation( this->m_FileName, imageio, dataFileName, offset )
+       && dataFileName != this->m_FileName )
+    {
+    DropFileFromPageCache( dataFileName );
+    }
+}
+
 //-----------------------------------------------------------------------------
 template <class InputImageType>
 ImageFileWriter& ImageFileWriter::ExecuteInternal( const Image& inImage )
   {
+    if ( !this->m_PasteIndex.empty() )
+      {
+      return this->ExecuteInternalPaste<InputImageType>( inImage );
+      }
+
+    typename InputImageType::ConstPointer image =
+      dynamic_cast <const InputImageType*> ( inImage.GetITKBase() );
+
+    itk::ImageIOBase::Pointer imageio = GetImageIOBase( this->m_FileName );
+
+    // the compressor is only validated and applied when compressing
+    if ( this->m_UseCompression )
+      {
+      SetImageIOCompression( imageio, this->m_Compressor, this->m_CompressionLevel );
+      }
+
+    const std::string compressor = GetCanonicalCompressorName( this->m_Compressor );
+    ParallelCompressionFileType parallelCompression = NoParallelCompression;
+    if ( this->m_UseCompression && this->m_UseParallelCompression
+         && ( compressor.empty() || compressor == "DEFLATE" ) )
+      {
+      parallelCompression = GetParallelCompressionFileType( imageio, this->m_FileName );
+      }
+
+    // With parallel compression, the file is first written
+    // uncompressed to a temporary file next to the output.
+    std::string fileName = this->m_FileName;
+    switch ( parallelCompression )
+      {
+      case MetaImageParallelCompression:
+        fileName += ".sitk-tmp.mha";
+        break;
+      case NrrdParallelCompression:
+        fileName += ".sitk-tmp.nrrd";
+        break;
+      case NiftiParallelCompression:
+        fileName += ".sitk-tmp.nii";
+        break;
+      case NoParallelCompression:
+        break;
+      }
+
+    typedef itk::ImageFileWriter<InputImageType> Writer;
+    typename Writer::Pointer writer = Writer::New();
+    writer->SetUseCompression( this->m_UseCompression && parallelCompression == NoParallelCompression );
+    writer->SetFileName ( fileName.c_str() );
+
+    // the pieces written are hashed as they pass through the hasher
+    typedef StreamingHashImageFilter<InputImageType> HasherType;
+    typename HasherType::Pointer hasher;
+    if ( this->m_ComputeHash )
+      {
+      hasher = HasherType::New();
+      hasher->SetInput( image );
+      hasher->SetNumberOfThreads( this->GetNumberOfThreads() );
+      writer->SetInput( hasher->GetOutput() );
+      }
+    else
+      {
+      writer->SetInput ( image );
+      }
+    writer->SetImageIO( imageio.GetPointer() );
+    writer->SetNumberOfStreamDivisions( this->GetNumberOfStreamDivisions() );
+
+    if ( this->m_UseDirectIO && !this->m_UseCompression
+         && this->ExecuteInternalDirectIO<InputImageType>( image, imageio ) )
+      {
+      return *this;
+      }
+
+    this->PreUpdate( writer.GetPointer() );
+
+    if ( parallelCompression == NoParallelCompression )
+      {
+      writer->Update();
+      if ( hasher.IsNotNull() )
+        {
+        this->m_Hash = hasher->GetHash();
+        }
+      if ( this->m_DropFromPageCache )
+        {
+        this->DropWrittenFileFromPageCache( imageio );
+        }
+      return *this;
+      }
+
+    try
+      {
+      writer->Update();
+      if ( hasher.IsNotNull() )
+        {
+        this->m_Hash = hasher->GetHash();
+        }
+      CompressFile( parallelCompression, fileName, this->m_FileName,
+                    std::max( -1, std::min( this->m_CompressionLevel, 9 ) ), this->GetNumberOfThreads(),
+                    this->m_IOBlockSize );
+      }
+    catch ( ... )
+      {
+      itksys::SystemTools::RemoveFile( fileName.c_str() );
+      throw;
+      }
+    itksys::SystemTools::RemoveFile( fileName.c_str() );
+
+    if ( this->m_DropFromPageCache )
+      {
+      DropFileFromPageCache( this->m_FileName );
+      }
+
+    return *this;
+  }
+
+//-----------------------------------------------------------------------------
+template <class InputImageType>
+bool ImageFileWriter::ExecuteInternalDirectIO( const InputImageType *image, ImageIOBase *imageio )
+  {
+    const unsigned int Dimension = InputImageType::ImageDimension;
+    typedef typename InputImageType::PixelContainer::Element ElementType;
+
+    const typename InputImageType::RegionType region = image->GetLargestPossibleRegion();
+    const std::string ioName = imageio->GetNameOfClass();
+    if ( ioName != "MetaImageIO"
+         || image->GetBufferedRegion() != region
+         || image->GetPixelContainer() == SITK_NULLPTR
+         || image->GetPixelContainer()->Size() != region.GetNumberOfPixels() * image->GetNumberOfComponentsPerPixel() )
+      {
+      return false;
+      }
+
+    // The ImageIO writes the header and the first pixel of a new
+    // file of the size of the image, the pixels are written after.
+    typename InputImageType::RegionType firstPixelRegion = region;
+    itk::ImageIORegion ioRegion( Dimension );
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      firstPixelRegion.SetSize( i, 1 );
+      ioRegion.SetIndex( i, 0 );
+      ioRegion.SetSize( i, 1 );
+      }
+
+    typename InputImageType::Pointer headerImage = InputImageType::New();
+    headerImage->CopyInformation( image );
+    headerImage->SetLargestPossibleRegion( region );
+    headerImage->SetBufferedRegion( firstPixelRegion );
+    headerImage->SetRequestedRegion( firstPixelRegion );
+    headerImage->SetNumberOfComponentsPerPixel( image->GetNumberOfComponentsPerPixel() );
+    headerImage->SetPixelContainer( const_cast<typename InputImageType::PixelContainer *>( image->GetPixelContainer() ) );
+    headerImage->SetMetaDataDictionary( image->GetMetaDataDictionary() );
+
+    itksys::SystemTools::RemoveFile( this->m_FileName.c_str() );
+
+    typedef itk::ImageFileWriter<InputImageType> Writer;
+    typename Writer::Pointer writer = Writer::New();
+    writer->SetUseCompression( false );
+    writer->SetFileName( this->m_FileName.c_str() );
+    writer->SetInput( headerImage );
+    writer->SetImageIO( imageio );
+    writer->SetIORegion( ioRegion );
+
+    this->PreUpdate( writer.GetPointer() );
+
+    writer->Update();
+
+    const uint64_t numberOfBytes = static_cast<uint64_t>( image->GetPixelContainer()->Size() ) * sizeof( ElementType );
+    std::string dataFileName;
+    int64_t offset = 0;
+    if ( !GetRawPixelDataLocation( this->m_FileName, imageio, dataFileName, offset )
+         || offset < 0
+         || itksys::SystemTools::FileLength( dataFileName.c_str() ) < static_cast<uint64_t>( offset ) + numberOfBytes )
+      {
+      sitkExceptionMacro( "Unable to locate the pixel data of \"" << this->m_FileName << "\" written for direct I/O." );
+      }
+
+    WriteFileBlocks( dataFileName, static_cast<uint64_t>( offset ), image->GetPixelContainer()->GetBufferPointer(),
+                     numberOfBytes, this->m_IOBlockSize, true );
+
+    // the header and the unaligned blocks are written through the
+    // page cache
+    this->DropWrittenFileFromPageCache( imageio );
+
+    if ( this->m_ComputeHash )
+      {
+      this->m_Hash = StreamingHashImageFilter<InputImageType>::HashImage( image, this->GetNumberOfThreads() );
+      }
+
+    return true;
+  }
+
+//-----------------------------------------------------------------------------
+template <class TLabelImageType>
+ImageFileWriter& ImageFileWriter::ExecuteInternalLabelImage( const Image& inImage )
+  {
+    typedef TLabelImageType LabelImageType;
+
+    typedef itk::Image< typename LabelImageType::PixelType, LabelImageType::ImageDimension > ScalarImageType;
+
+    typename LabelImageType::ConstPointer image =
+      dynamic_cast <const LabelImageType*> ( inImage.GetITKBase() );
+
+    // paint the runs of the label map into a scalar image of the
+    // label type, the background of the label map is kept
+    typedef itk::LabelMapToLabelImageFilter<LabelImageType, ScalarImageType> FilterType;
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( image );
+    filter->Update();
+
+    return this->ExecuteInternal<ScalarImageType>( Image( filter->GetOutput() ) );
+  }
+
+template <class InputImageType>
+ImageFileWriter& ImageFileWriter::ExecuteInternalPaste( const Image& inImage )
+  {
+    const unsigned int Dimension = InputImageType::ImageDimension;
+
     typename InputImageType::ConstPointer image =
       dynamic_cast <const InputImageType*> ( inImage.GetITKBase() );
 
+    // The header of the existing file describes the complete image
+    itk::ImageIOBase::Pointer fileIO =
+      itk::ImageIOFactory::CreateImageIO( this->m_FileName.c_str(), itk::ImageIOFactory::ReadMode );
+    if ( fileIO.IsNull() )
+      {
+      sitkExceptionMacro( "Unable to read the existing file \"" << this->m_FileName << "\" to paste into." );
+      }
+    fileIO->SetFileName( this->m_FileName );
+    fileIO->ReadImageInformation();
+
+    itk::ImageIOBase::Pointer imageio = GetImageIOBase( this->m_FileName );
+    if ( !imageio->CanStreamWrite() )
+      {
+      sitkExceptionMacro( "The ImageIO for \"" << this->m_FileName << "\" does not support streamed writing, unable to paste." );
+      }
+
+    imageio->SetPixelTypeInfo( static_cast<const typename InputImageType::InternalPixelType *>( SITK_NULLPTR ) );
+    if ( fileIO->GetNumberOfDimensions() != Dimension
+         || fileIO->GetComponentType() != imageio->GetComponentType()
+         || fileIO->GetNumberOfComponents() != image->GetNumberOfComponentsPerPixel() )
+      {
+      sitkExceptionMacro( "The image with dimension " << Dimension
+                          << ", pixel type " << inImage.GetPixelIDTypeAsString()
+                          << " and " << image->GetNumberOfComponentsPerPixel()
+                          << " components does not match the file \"" << this->m_FileName << "\"." );
+      }
+
+    if ( this->m_PasteIndex.size() != Dimension )
+      {
+      sitkExceptionMacro( "The PasteIndex has " << this->m_PasteIndex.size()
+                          << " elements, but the image has " << Dimension << " dimensions." );
+      }
+
+    typename InputImageType::RegionType fileRegion;
+    typename InputImageType::RegionType pasteRegion;
+    typename InputImageType::PointType origin;
+    typename InputImageType::SpacingType spacing;
+    typename InputImageType::DirectionType direction;
+    itk::ImageIORegion ioRegion( Dimension );
+    for ( unsigned int i = 0; i < Dimension; ++i )
+      {
+      fileRegion.SetIndex( i, 0 );
+      fileRegion.SetSize( i, fileIO->GetDimensions( i ) );
+      pasteRegion.SetIndex( i, this->m_PasteIndex[i] );
+      pasteRegion.SetSize( i, image->GetBufferedRegion().GetSize( i ) );
+      ioRegion.SetIndex( i, this->m_PasteIndex[i] );
+      ioRegion.SetSize( i, image->GetBufferedRegion().GetSize( i ) );
+
+      origin[i] = fileIO->GetOrigin( i );
+      spacing[i] = fileIO->GetSpacing( i );
+      const std::vector<double> axis = fileIO->GetDirection( i );
+      for ( unsigned int j = 0; j < Dimension; ++j )
+        {
+        direction[j][i] = axis[j];
+        }
+      }
+
+    if ( !fileRegion.IsInside( pasteRegion ) )
+      {
+      sitkExceptionMacro( "The image pasted at index " << this->m_PasteIndex
+                          << " with size " << inImage.GetSize()
+                          << " is outside of the file of size " << fileRegion.GetSize() << "." );
+      }
+
+    // An image of the complete file, with only the pasted region
+    // buffered. The buffer of the input is shared, not copied.
+    typename InputImageType::Pointer pasteImage = InputImageType::New();
+    pasteImage->SetLargestPossibleRegion( fileRegion );
+    pasteImage->SetBufferedRegion( pasteRegion );
+    pasteImage->SetRequestedRegion( pasteRegion );
+    pasteImage->SetOrigin( origin );
+    pasteImage->SetSpacing( spacing );
+    pasteImage->SetDirection( direction );
+    pasteImage->SetNumberOfComponentsPerPixel( image->GetNumberOfComponentsPerPixel() );
+    pasteImage->SetPixelContainer( const_cast<typename InputImageType::PixelContainer *>( image->GetPixelContainer() ) );
+
     typedef itk::ImageFileWriter<InputImageType> Writer;
     typename Writer::Pointer writer = Writer::New();
-    writer->SetUseCompression( this->m_UseCompression );
+    writer->SetUseCompression( false );
     writer->SetFileName ( this->m_FileName.c_str() );
-    writer->SetInput ( image );
-    writer->SetImageIO( GetImageIOBase( this->m_FileName ).GetPointer() );
+    writer->SetInput ( pasteImage );
+    writer->SetImageIO( imageio );
+    writer->SetIORegion( ioRegion );
 
     this->PreUpdate( writer.GetPointer() );
 
     writer->Update();
 
+    if ( this->m_ComputeHash )
+      {
+      this->m_Hash = StreamingHashImageFilter<InputImageType>::HashImage( image, this->GetNumberOfThreads() );
+      }
+
     return *this;
   }
 
@@ -0,0 +1,132 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkImageIOCompression.h"
+#include "sitkChunkedImageIO.h"
+
+#include <itkConfigure.h>
+#include <itkImageIOBase.h>
+#include <itkTIFFImageIO.h>
+#include <itkJPEGImageIO.h>
+#include <itkPNGImageIO.h>
+
+#include <algorithm>
+#include <cctype>
+
+namespace itk
+{
+namespace simple
+{
+
+std::string GetCanonicalCompressorName( const std::string &compressor )
+{
+  std::string name = compressor;
+  std::transform( name.begin(), name.end(), name.begin(), ::toupper );
+  return name;
+}
+
+
+void SetImageIOCompression( itk::ImageIOBase *imageio,
+                            const std::string &compressor,
+                            int compressionLevel )
+{
+  const std::string name = GetCanonicalCompressorName( compressor );
+
+  if ( ChunkedImageIO *chunkedIO = dynamic_cast<ChunkedImageIO *>( imageio ) )
+    {
+    if ( !name.empty() && name != "DEFLATE" )
+      {
+      sitkExceptionMacro( "The compressor \"" << compressor << "\" is not supported by " << imageio->GetNameOfClass()
+                          << ", only the Deflate compressor is available." );
+      }
+    chunkedIO->SetDeflateLevel( compressionLevel );
+    return;
+    }
+
+#if ITK_VERSION_MAJOR > 5 || ( ITK_VERSION_MAJOR == 5 && ITK_VERSION_MINOR >= 1 )
+  // the ImageIO chooses among its supported compressors
+  if ( !name.empty() )
+    {
+    imageio->SetCompressor( name );
+    }
+  if ( compressionLevel >= 0 )
+    {
+    imageio->SetCompressionLevel( compressionLevel );
+    }
+#else
+  if ( itk::TIFFImageIO *tiffIO = dynamic_cast<itk::TIFFImageIO *>( imageio ) )
+    {
+    if ( name == "PACKBITS" )
+      {
+      tiffIO->SetCompressionToPackBits();
+      }
+    else if ( name == "JPEG" )
+      {
+      tiffIO->SetCompressionToJPEG();
+      if ( compressionLevel >= 0 )
+        {
+        tiffIO->SetJPEGQuality( compressionLevel );
+        }
+      }
+    else if ( name == "DEFLATE" )
+      {
+      tiffIO->SetCompressionToDeflate();
+      }
+    else if ( name == "LZW" )
+      {
+      tiffIO->SetCompressionToLZW();
+      }
+    else if ( !name.empty() )
+      {
+      sitkExceptionMacro( "The compressor \"" << compressor << "\" is not supported by " << imageio->GetNameOfClass()
+                          << ", the supported compressors are PackBits, JPEG, Deflate and LZW." );
+      }
+    return;
+    }
+
+  if ( itk::JPEGImageIO *jpegIO = dynamic_cast<itk::JPEGImageIO *>( imageio ) )
+    {
+    if ( !name.empty() && name != "JPEG" )
+      {
+      sitkExceptionMacro( "The compressor \"" << compressor << "\" is not supported by " << imageio->GetNameOfClass() << "." );
+      }
+    if ( compressionLevel >= 0 )
+      {
+      jpegIO->SetQuality( compressionLevel );
+      }
+    return;
+    }
+
+  // the remaining ImageIOs compress with zlib
+  if ( !name.empty() && name != "DEFLATE" )
+    {
+    sitkExceptionMacro( "The compressor \"" << compressor << "\" is not supported by " << imageio->GetNameOfClass()
+                        << ", only the Deflate compressor is available with this version of ITK." );
+    }
+
+  if ( itk::PNGImageIO *pngIO = dynamic_cast<itk::PNGImageIO *>( imageio ) )
+    {
+    if ( compressionLevel >= 0 )
+      {
+      pngIO->SetCompressionLevel( compressionLevel );
+      }
+    }
+#endif
+}
+
+}
+}
@@ -0,0 +1,51 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkImageIOCompression_h
+#define sitkImageIOCompression_h
+
+#include "sitkMacro.h"
+#include "sitkIO.h"
+
+#include <string>
+
+namespace itk
+{
+
+class ImageIOBase;
+
+namespace simple
+{
+
+/** Set the compressor and compression level of an ImageIO.
+ *
+ * The compressor name is case insensitive, an empty name is the
+ * default compressor of the ImageIO, and a level less than zero is
+ * the default level of the compressor. An exception is thrown when
+ * the ImageIO does not support the compressor.
+ */
+SITKIO_HIDDEN void SetImageIOCompression( itk::ImageIOBase *imageio,
+                                          const std::string &compressor,
+                                          int compressionLevel );
+
+/** Returns the compressor name in upper case. */
+SITKIO_HIDDEN std::string GetCanonicalCompressorName( const std::string &compressor );
+
+}
+}
+
+#endif
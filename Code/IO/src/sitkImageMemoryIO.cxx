@@ -0,0 +1,553 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkImageMemoryIO.h"
+
+#include <itkByteSwapper.h>
+#include "itk_zlib.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace itk {
+  namespace simple {
+
+  namespace
+  {
+
+  struct MetaElementType
+  {
+    const char       *m_Name;
+    PixelIDValueType  m_ScalarPixelID;
+    PixelIDValueType  m_VectorPixelID;
+    unsigned int      m_Size;
+  };
+
+  // The MetaIO element types, the first match of a pixel type is
+  // used when writing.
+  const MetaElementType MetaElementTypes[] =
+  {
+    { "MET_UCHAR",      sitkUInt8,   sitkVectorUInt8,   1 },
+    { "MET_CHAR",       sitkInt8,    sitkVectorInt8,    1 },
+    { "MET_USHORT",     sitkUInt16,  sitkVectorUInt16,  2 },
+    { "MET_SHORT",      sitkInt16,   sitkVectorInt16,   2 },
+    { "MET_UINT",       sitkUInt32,  sitkVectorUInt32,  4 },
+    { "MET_INT",        sitkInt32,   sitkVectorInt32,   4 },
+    { "MET_ULONG_LONG", sitkUInt64,  sitkVectorUInt64,  8 },
+    { "MET_LONG_LONG",  sitkInt64,   sitkVectorInt64,   8 },
+    { "MET_FLOAT",      sitkFloat32, sitkVectorFloat32, 4 },
+    { "MET_DOUBLE",     sitkFloat64, sitkVectorFloat64, 8 },
+    { "MET_ULONG",      sitkUInt32,  sitkVectorUInt32,  4 },
+    { "MET_LONG",       sitkInt32,   sitkVectorInt32,   4 }
+  };
+
+  const size_t NumberOfMetaElementTypes = sizeof( MetaElementTypes ) / sizeof( MetaElementTypes[0] );
+
+  // The header fields interpreted as the image information, all
+  // others are meta-data.
+  const char * const MetaImageFields[] =
+  {
+    "ObjectType", "NDims", "BinaryData", "BinaryDataByteOrderMSB", "ElementByteOrderMSB",
+    "CompressedData", "CompressedDataSize", "TransformMatrix", "Rotation", "Orientation",
+    "Offset", "Position", "Origin", "CenterOfRotation", "AnatomicalOrientation",
+    "ElementSpacing", "ElementSize", "DimSize", "ElementNumberOfChannels", "ElementType",
+    "ElementDataFile", "HeaderSize"
+  };
+
+  typedef std::map<std::string, std::string> FieldMap;
+
+  std::string TrimString( const std::string &s )
+  {
+    const std::string whitespace = " \t\r\n";
+    const size_t begin = s.find_first_not_of( whitespace );
+    if ( begin == std::string::npos )
+      {
+      return std::string();
+      }
+    return s.substr( begin, s.find_last_not_of( whitespace ) - begin + 1 );
+  }
+
+  std::string ToLower( std::string s )
+  {
+    std::transform( s.begin(), s.end(), s.begin(), ::tolower );
+    return s;
+  }
+
+  bool IsMetaImageFormat( const std::string &format )
+  {
+    std::string f = ToLower( format );
+    if ( !f.empty() && f[0] == '.' )
+      {
+      f.erase( 0, 1 );
+      }
+    return f == "mha" || f == "metaimage";
+  }
+
+  bool IsMetaImageField( const std::string &key )
+  {
+    for ( size_t i = 0; i < sizeof( MetaImageFields ) / sizeof( MetaImageFields[0] ); ++i )
+      {
+      if ( key == MetaImageFields[i] )
+        {
+        return true;
+        }
+      }
+    return false;
+  }
+
+  /** Returns the value of the first of the keys in the header, or an
+   * empty string. */
+  std::string GetField( const FieldMap &fields,
+                        const char *key,
+                        const char *alternative1 = SITK_NULLPTR,
+                        const char *alternative2 = SITK_NULLPTR )
+  {
+    const char * const keys[] = { key, alternative1, alternative2 };
+    for ( unsigned int i = 0; i < 3 && keys[i] != SITK_NULLPTR; ++i )
+      {
+      FieldMap::const_iterator iter = fields.find( keys[i] );
+      if ( iter != fields.end() )
+        {
+        return iter->second;
+        }
+      }
+    return std::string();
+  }
+
+  template <typename T>
+  std::vector<T> ParseValues( const std::string &value, const char *key, size_t count )
+  {
+    std::istringstream in( value );
+    std::vector<T> result;
+    T v;
+    while ( result.size() < count && in >> v )
+      {
+      result.push_back( v );
+      }
+    if ( result.size() != count )
+      {
+      sitkExceptionMacro( "The MetaImage field \"" << key << "\" with value \"" << value
+                          << "\" does not have " << count << " values." );
+      }
+    return result;
+  }
+
+  bool IsTrue( const std::string &value )
+  {
+    const std::string v = ToLower( value );
+    return v == "true" || v == "1";
+  }
+
+  const MetaElementType *FindElementType( const std::string &name )
+  {
+    for ( size_t i = 0; i < NumberOfMetaElementTypes; ++i )
+      {
+      if ( name == MetaElementTypes[i].m_Name )
+        {
+        return &MetaElementTypes[i];
+        }
+      }
+    return SITK_NULLPTR;
+  }
+
+  const MetaElementType *FindElementType( PixelIDValueType pixelID )
+  {
+    for ( size_t i = 0; i < NumberOfMetaElementTypes; ++i )
+      {
+      if ( pixelID == MetaElementTypes[i].m_ScalarPixelID || pixelID == MetaElementTypes[i].m_VectorPixelID )
+        {
+        return &MetaElementTypes[i];
+        }
+      }
+    return SITK_NULLPTR;
+  }
+
+  // The 64-bit pixel types may be sitkUnknown, so they can not be
+  // switch cases.
+  const void *GetImageBuffer( const Image &image, PixelIDValueType scalarPixelID )
+  {
+    if ( scalarPixelID == sitkUInt8 )   { return image.GetBufferAsUInt8(); }
+    if ( scalarPixelID == sitkInt8 )    { return image.GetBufferAsInt8(); }
+    if ( scalarPixelID == sitkUInt16 )  { return image.GetBufferAsUInt16(); }
+    if ( scalarPixelID == sitkInt16 )   { return image.GetBufferAsInt16(); }
+    if ( scalarPixelID == sitkUInt32 )  { return image.GetBufferAsUInt32(); }
+    if ( scalarPixelID == sitkInt32 )   { return image.GetBufferAsInt32(); }
+    if ( scalarPixelID == sitkUInt64 )  { return image.GetBufferAsUInt64(); }
+    if ( scalarPixelID == sitkInt64 )   { return image.GetBufferAsInt64(); }
+    if ( scalarPixelID == sitkFloat32 ) { return image.GetBufferAsFloat(); }
+    if ( scalarPixelID == sitkFloat64 ) { return image.GetBufferAsDouble(); }
+    sitkExceptionMacro( "Unexpected pixel type " << GetPixelIDValueAsString( scalarPixelID ) << "." );
+  }
+
+  void SwapBytes( uint8_t *buffer, size_t numberOfElements, unsigned int elementSize )
+  {
+    for ( size_t i = 0; i < numberOfElements; ++i, buffer += elementSize )
+      {
+      std::reverse( buffer, buffer + elementSize );
+      }
+  }
+
+  /** Decompress zlib or gzip data, which must decompress to exactly
+   * outSize bytes. */
+  void Inflate( const uint8_t *in, size_t inSize, uint8_t *out, size_t outSize )
+  {
+    z_stream strm;
+    std::memset( &strm, 0, sizeof( strm ) );
+
+    // automatic detection of the zlib or gzip header
+    if ( inflateInit2( &strm, 15 + 32 ) != Z_OK )
+      {
+      sitkExceptionMacro( "Unable to initialize zlib decompression." );
+      }
+
+    // zlib counts bytes with 32-bit integers
+    const size_t chunkSize = 1u << 30;
+    int status = Z_OK;
+    while ( status == Z_OK )
+      {
+      if ( strm.avail_in == 0 )
+        {
+        const size_t n = std::min( inSize, chunkSize );
+        strm.next_in = const_cast<Bytef *>( in );
+        strm.avail_in = static_cast<uInt>( n );
+        in += n;
+        inSize -= n;
+        }
+      if ( strm.avail_out == 0 )
+        {
+        const size_t n = std::min( outSize, chunkSize );
+        strm.next_out = out;
+        strm.avail_out = static_cast<uInt>( n );
+        out += n;
+        outSize -= n;
+        }
+      status = inflate( &strm, Z_NO_FLUSH );
+      }
+
+    const bool complete = ( status == Z_STREAM_END && strm.avail_out == 0 && outSize == 0 );
+    inflateEnd( &strm );
+
+    if ( !complete )
+      {
+      sitkExceptionMacro( "The compressed pixel data is corrupt or does not match the size of the image." );
+      }
+  }
+
+  }
+
+
+  Image ReadImageFromMemory( const void *buffer, size_t bufferSize, const std::string &formatHint )
+  {
+    if ( !formatHint.empty() && !IsMetaImageFormat( formatHint ) )
+      {
+      sitkExceptionMacro( "Reading the \"" << formatHint << "\" format from memory is not supported,"
+                          << " only MetaImage files with local pixel data can be read from memory." );
+      }
+    if ( buffer == SITK_NULLPTR && bufferSize != 0 )
+      {
+      sitkExceptionMacro( "The buffer to read from is null." );
+      }
+
+    const uint8_t *data = static_cast<const uint8_t *>( buffer );
+
+    // parse the "key = value" lines of the header up to ElementDataFile
+    FieldMap fields;
+    std::vector<std::string> keys;
+    size_t position = 0;
+    bool hasElementDataFile = false;
+    while ( position < bufferSize && !hasElementDataFile )
+      {
+      const uint8_t *lineEnd = std::find( data + position, data + bufferSize, '\n' );
+      const std::string line( data + position, lineEnd );
+      position = static_cast<size_t>( lineEnd - data ) + ( lineEnd != data + bufferSize ? 1 : 0 );
+
+      if ( TrimString( line ).empty() )
+        {
+        continue;
+        }
+
+      const size_t eq = line.find( '=' );
+      const std::string key = ( eq == std::string::npos ) ? std::string() : TrimString( line.substr( 0, eq ) );
+      if ( keys.empty() && key != "ObjectType" && key != "NDims" )
+        {
+        sitkExceptionMacro( "The buffer is not a MetaImage file." );
+        }
+      if ( key.empty() )
+        {
+        sitkExceptionMacro( "Unexpected line \"" << line << "\" in the MetaImage header." );
+        }
+
+      if ( fields.find( key ) == fields.end() )
+        {
+        keys.push_back( key );
+        }
+      fields[key] = TrimString( line.substr( eq + 1 ) );
+      hasElementDataFile = ( key == "ElementDataFile" );
+      }
+
+    if ( !hasElementDataFile )
+      {
+      sitkExceptionMacro( "The MetaImage header has no ElementDataFile field." );
+      }
+    if ( fields["ElementDataFile"] != "LOCAL" )
+      {
+      sitkExceptionMacro( "The MetaImage refers to the pixel data file \"" << fields["ElementDataFile"]
+                          << "\", only local pixel data can be read from memory." );
+      }
+    if ( fields.count( "BinaryData" ) && !IsTrue( fields["BinaryData"] ) )
+      {
+      sitkExceptionMacro( "ASCII MetaImage pixel data can not be read from memory." );
+      }
+
+    const std::string dimensionValue = GetField( fields, "NDims" );
+    const unsigned int dimension = ParseValues<unsigned int>( dimensionValue, "NDims", 1 )[0];
+    if ( dimension == 0 )
+      {
+      sitkExceptionMacro( "The MetaImage has zero dimensions." );
+      }
+
+    const std::vector<unsigned int> size = ParseValues<unsigned int>( GetField( fields, "DimSize" ), "DimSize", dimension );
+
+    const MetaElementType *elementType = FindElementType( GetField( fields, "ElementType" ) );
+    if ( elementType == SITK_NULLPTR )
+      {
+      sitkExceptionMacro( "The MetaImage ElementType \"" << GetField( fields, "ElementType" ) << "\" is not supported." );
+      }
+
+    unsigned int numberOfComponents = 1;
+    if ( fields.count( "ElementNumberOfChannels" ) )
+      {
+      numberOfComponents = ParseValues<unsigned int>( fields["ElementNumberOfChannels"], "ElementNumberOfChannels", 1 )[0];
+      }
+    if ( numberOfComponents == 0 )
+      {
+      sitkExceptionMacro( "The MetaImage has zero ElementNumberOfChannels." );
+      }
+
+    const PixelIDValueType pixelID = ( numberOfComponents == 1 ) ? elementType->m_ScalarPixelID : elementType->m_VectorPixelID;
+    if ( pixelID == sitkUnknown )
+      {
+      sitkExceptionMacro( "The MetaImage ElementType " << elementType->m_Name << " is not supported by SimpleITK." );
+      }
+
+    Image image( size, static_cast<PixelIDValueEnum>( pixelID ), ( numberOfComponents == 1 ) ? 0 : numberOfComponents );
+
+    // the pixel data
+    uint64_t numberOfElements = numberOfComponents;
+    for ( unsigned int i = 0; i < dimension; ++i )
+      {
+      numberOfElements *= size[i];
+      }
+    const size_t numberOfBytes = static_cast<size_t>( numberOfElements * elementType->m_Size );
+    // the newly constructed image does not share its buffer
+    uint8_t *pixels = static_cast<uint8_t *>( const_cast<void *>( GetImageBuffer( image, elementType->m_ScalarPixelID ) ) );
+
+    size_t dataSize = bufferSize - position;
+    if ( IsTrue( GetField( fields, "CompressedData" ) ) )
+      {
+      if ( fields.count( "CompressedDataSize" ) )
+        {
+        dataSize = std::min( dataSize, ParseValues<size_t>( fields["CompressedDataSize"], "CompressedDataSize", 1 )[0] );
+        }
+      Inflate( data + position, dataSize, pixels, numberOfBytes );
+      }
+    else
+      {
+      if ( dataSize < numberOfBytes )
+        {
+        sitkExceptionMacro( "The buffer has " << dataSize << " bytes of pixel data, but the image requires "
+                            << numberOfBytes << " bytes." );
+        }
+      std::memcpy( pixels, data + position, numberOfBytes );
+      }
+
+    const std::string msb = GetField( fields, "BinaryDataByteOrderMSB", "ElementByteOrderMSB" );
+    if ( elementType->m_Size > 1 && !msb.empty() && IsTrue( msb ) != itk::ByteSwapper<uint16_t>::SystemIsBigEndian() )
+      {
+      SwapBytes( pixels, static_cast<size_t>( numberOfElements ), elementType->m_Size );
+      }
+
+    // the geometry, column i of the direction is row i of the TransformMatrix
+    const std::string spacing = GetField( fields, "ElementSpacing", "ElementSize" );
+    if ( !spacing.empty() )
+      {
+      image.SetSpacing( ParseValues<double>( spacing, "ElementSpacing", dimension ) );
+      }
+    const std::string origin = GetField( fields, "Offset", "Position", "Origin" );
+    if ( !origin.empty() )
+      {
+      image.SetOrigin( ParseValues<double>( origin, "Offset", dimension ) );
+      }
+    const std::string transform = GetField( fields, "TransformMatrix", "Rotation", "Orientation" );
+    if ( !transform.empty() )
+      {
+      const std::vector<double> matrix = ParseValues<double>( transform, "TransformMatrix", dimension * dimension );
+      std::vector<double> direction( dimension * dimension );
+      for ( unsigned int r = 0; r < dimension; ++r )
+        {
+        for ( unsigned int c = 0; c < dimension; ++c )
+          {
+          direction[r * dimension + c] = matrix[c * dimension + r];
+          }
+        }
+      image.SetDirection( direction );
+      }
+
+    for ( size_t i = 0; i < keys.size(); ++i )
+      {
+      if ( !IsMetaImageField( keys[i] ) )
+        {
+        image.SetMetaData( keys[i], fields[keys[i]] );
+        }
+      }
+
+    return image;
+  }
+
+  Image ReadImageFromMemory( const std::vector<uint8_t> &buffer, const std::string &formatHint )
+  {
+    return ReadImageFromMemory( buffer.empty() ? SITK_NULLPTR : &buffer[0], buffer.size(), formatHint );
+  }
+
+
+  std::vector<uint8_t> WriteImageToMemory( const Image &image, const std::string &format, bool useCompression )
+  {
+    if ( !IsMetaImageFormat( format ) )
+      {
+      sitkExceptionMacro( "Writing the \"" << format << "\" format to memory is not supported,"
+                          << " only MetaImage can be written to memory." );
+      }
+
+    const MetaElementType *elementType = FindElementType( image.GetPixelIDValue() );
+    if ( elementType == SITK_NULLPTR )
+      {
+      sitkExceptionMacro( "The pixel type " << image.GetPixelIDTypeAsString() << " can not be written to memory." );
+      }
+
+    const unsigned int dimension = image.GetDimension();
+    const std::vector<unsigned int> size = image.GetSize();
+    const unsigned int numberOfComponents = image.GetNumberOfComponentsPerPixel();
+
+    uint64_t numberOfElements = numberOfComponents;
+    for ( unsigned int i = 0; i < dimension; ++i )
+      {
+      numberOfElements *= size[i];
+      }
+    const size_t numberOfBytes = static_cast<size_t>( numberOfElements * elementType->m_Size );
+    const uint8_t *pixels = static_cast<const uint8_t *>( GetImageBuffer( image, elementType->m_ScalarPixelID ) );
+
+    std::vector<uint8_t> compressed;
+    if ( useCompression )
+      {
+      if ( numberOfBytes > static_cast<size_t>( ULONG_MAX ) / 2 )
+        {
+        sitkExceptionMacro( "The image is too large to be compressed in memory." );
+        }
+      uLongf compressedSize = compressBound( static_cast<uLong>( numberOfBytes ) );
+      compressed.resize( compressedSize );
+      const int status = compress2( &compressed[0], &compressedSize,
+                                    pixels, static_cast<uLong>( numberOfBytes ),
+                                    Z_DEFAULT_COMPRESSION );
+      if ( status != Z_OK )
+        {
+        sitkExceptionMacro( "Compression failed with zlib error " << status << "." );
+        }
+      compressed.resize( compressedSize );
+      }
+
+    const std::vector<double> direction = image.GetDirection();
+
+    std::ostringstream header;
+    header << std::setprecision( 17 );
+    header << "ObjectType = Image\n";
+    header << "NDims = " << dimension << "\n";
+    header << "BinaryData = True\n";
+    header << "BinaryDataByteOrderMSB = " << ( itk::ByteSwapper<uint16_t>::SystemIsBigEndian() ? "True" : "False" ) << "\n";
+    header << "CompressedData = " << ( useCompression ? "True" : "False" ) << "\n";
+    if ( useCompression )
+      {
+      header << "CompressedDataSize = " << compressed.size() << "\n";
+      }
+    header << "TransformMatrix =";
+    for ( unsigned int r = 0; r < dimension; ++r )
+      {
+      for ( unsigned int c = 0; c < dimension; ++c )
+        {
+        header << " " << direction[c * dimension + r];
+        }
+      }
+    header << "\n";
+    header << "Offset =";
+    for ( unsigned int i = 0; i < dimension; ++i )
+      {
+      header << " " << image.GetOrigin()[i];
+      }
+    header << "\n";
+    header << "ElementSpacing =";
+    for ( unsigned int i = 0; i < dimension; ++i )
+      {
+      header << " " << image.GetSpacing()[i];
+      }
+    header << "\n";
+    header << "DimSize =";
+    for ( unsigned int i = 0; i < dimension; ++i )
+      {
+      header << " " << size[i];
+      }
+    header << "\n";
+    if ( numberOfComponents != 1 )
+      {
+      header << "ElementNumberOfChannels = " << numberOfComponents << "\n";
+      }
+    header << "ElementType = " << elementType->m_Name << "\n";
+
+    // meta-data which can be represented as header fields
+    const std::vector<std::string> keys = image.GetMetaDataKeys();
+    for ( size_t i = 0; i < keys.size(); ++i )
+      {
+      const std::string value = image.GetMetaData( keys[i] );
+      if ( !IsMetaImageField( keys[i] )
+           && TrimString( keys[i] ) == keys[i] && !keys[i].empty()
+           && keys[i].find_first_of( "=\n" ) == std::string::npos
+           && value.find( '\n' ) == std::string::npos )
+        {
+        header << keys[i] << " = " << value << "\n";
+        }
+      }
+
+    header << "ElementDataFile = LOCAL\n";
+
+    const std::string headerString = header.str();
+    std::vector<uint8_t> result( headerString.begin(), headerString.end() );
+    if ( useCompression )
+      {
+      result.insert( result.end(), compressed.begin(), compressed.end() );
+      }
+    else
+      {
+      result.insert( result.end(), pixels, pixels + numberOfBytes );
+      }
+    return result;
+  }
+
+  }
+}
@@ -19,6 +19,7 @@
 #include "sitkImageReaderBase.h"
 #include "sitkMacro.h"
 #include "sitkExceptionObject.h"
+#include "sitkChunkedImageIO.h"
 
 #include <itksys/SystemTools.hxx>
 
@@ -28,21 +29,74 @@
 #include <itkTransformFileWriter.h>
 
 #include <string>
+#include <list>
 
 #include <itkImage.h>
 #include <itkImageIOBase.h>
 #include <itkImageIOFactory.h>
 #include <itkGDCMImageIO.h>
 
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
 
 namespace itk {
 namespace simple {
 
+namespace
+{
+
+// The modification time of the file in nanoseconds. The time has the
+// resolution of the file system where stat provides nanoseconds, and
+// of a second otherwise.
+int64_t FileModifiedTime( const std::string &fileName )
+{
+#ifdef _WIN32
+  return static_cast<int64_t>( itksys::SystemTools::ModifiedTime( fileName.c_str() ) ) * 1000000000;
+#else
+  struct stat info;
+  if ( stat( fileName.c_str(), &info ) != 0 )
+    {
+    return 0;
+    }
+#if defined(__APPLE__)
+  return static_cast<int64_t>( info.st_mtimespec.tv_sec ) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+  return static_cast<int64_t>( info.st_mtim.tv_sec ) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+#endif
+}
+
+}
+
 ImageReaderBase
 ::ImageReaderBase()
   : m_OutputPixelType(sitkUnknown),
-    m_LoadPrivateTags(false)
+    m_LoadPrivateTags(false),
+    m_CachedImageIO(SITK_NULLPTR),
+    m_CachedModifiedTime(0),
+    m_CachedFileLength(0)
+{
+  ChunkedImageIOFactory::RegisterOneFactory();
+}
+
+ImageReaderBase
+::~ImageReaderBase()
 {
+  this->ReleaseCachedImageIO();
+}
+
+void
+ImageReaderBase
+::ReleaseCachedImageIO()
+{
+  if ( this->m_CachedImageIO != SITK_NULLPTR )
+    {
+    this->m_CachedImageIO->UnRegister();
+    this->m_CachedImageIO = SITK_NULLPTR;
+    }
+  this->m_CachedFileName.clear();
 }
 
 std::string
@@ -54,6 +108,8 @@ ImageReaderBase
   this->ToStringHelper(out, this->m_OutputPixelType) << std::endl;
   out << "  LoadPrivateTags: ";
   this->ToStringHelper(out, this->m_LoadPrivateTags) << std::endl;
+  out << "  ImageIO: \"";
+  this->ToStringHelper(out, this->m_ImageIOName) << "\"" << std::endl;
   out << ProcessObject::ToString();
   return out.str();
 }
@@ -62,8 +118,59 @@ itk::SmartPointer<ImageIOBase>
 ImageReaderBase
 ::GetImageIOBase(const std::string &fileName)
 {
-  itk::ImageIOBase::Pointer iobase =
-    itk::ImageIOFactory::CreateImageIO( fileName.c_str(), itk::ImageIOFactory::ReadMode);
+  const int64_t modifiedTime = FileModifiedTime( fileName );
+  const uint64_t fileLength = itksys::SystemTools::FileLength( fileName.c_str() );
+
+  if ( this->m_CachedImageIO != SITK_NULLPTR
+       && this->m_CachedFileName == fileName
+       && this->m_CachedModifiedTime == modifiedTime
+       && this->m_CachedFileLength == fileLength )
+    {
+    // The ImageIO may have been used to read other files, such as
+    // the slices of a series.
+    if ( this->m_CachedImageIO->GetFileName() != fileName )
+      {
+      this->m_CachedImageIO->SetFileName( fileName );
+      this->m_CachedImageIO->ReadImageInformation();
+      }
+    return this->m_CachedImageIO;
+    }
+
+  this->ReleaseCachedImageIO();
+
+  itk::ImageIOBase::Pointer iobase;
+
+  if ( !this->m_ImageIOName.empty() )
+    {
+    std::list<itk::LightObject::Pointer> allobjects = itk::ObjectFactoryBase::CreateAllInstance( "itkImageIOBase" );
+    for ( std::list<itk::LightObject::Pointer>::iterator i = allobjects.begin(); i != allobjects.end(); ++i )
+      {
+      itk::ImageIOBase *io = dynamic_cast<itk::ImageIOBase*>( i->GetPointer() );
+      if ( io && this->m_ImageIOName == io->GetNameOfClass() )
+        {
+        iobase = io;
+        break;
+        }
+      }
+
+    if ( iobase.IsNull() )
+      {
+      sitkExceptionMacro( "The ImageIO \"" << this->m_ImageIOName << "\" is not registered." );
+      }
+
+    if ( !iobase->CanReadFile( fileName.c_str() ) )
+      {
+      if ( !itksys::SystemTools::FileExists( fileName.c_str() ) )
+        {
+        sitkExceptionMacro( "The file \"" << fileName << "\" does not exist." );
+        }
+      sitkExceptionMacro( "The ImageIO \"" << this->m_ImageIOName << "\" is unable to read the file \"" << fileName << "\"." );
+      }
+    }
+  else
+    {
+    iobase = itk::ImageIOFactory::CreateImageIO( fileName.c_str(), itk::ImageIOFactory::ReadMode);
+    }
 
 
   if ( iobase.IsNull() )
@@ -87,11 +194,21 @@ ImageReaderBase
     {
     ioGDCMImage->SetLoadPrivateTags(this->m_LoadPrivateTags);
     }
+  ChunkedImageIO *ioChunkedImage = dynamic_cast<ChunkedImageIO*>(iobase.GetPointer());
+  if (ioChunkedImage)
+    {
+    ioChunkedImage->SetNumberOfThreads(this->GetNumberOfThreads());
+    }
 
   // Read the image information
   iobase->SetFileName( fileName );
   iobase->ReadImageInformation();
 
+  this->m_CachedImageIO = iobase;
+  this->m_CachedImageIO->Register();
+  this->m_CachedFileName = fileName;
+  this->m_CachedModifiedTime = modifiedTime;
+  this->m_CachedFileLength = fileLength;
 
   return iobase;
 }
@@ -116,6 +233,10 @@ ImageReaderBase::Self&
 ImageReaderBase
 ::SetLoadPrivateTags(bool loadPrivateTags)
 {
+  if ( this->m_LoadPrivateTags != loadPrivateTags )
+    {
+    this->ReleaseCachedImageIO();
+    }
   this->m_LoadPrivateTags = loadPrivateTags;
   return *this;
 }
@@ -127,6 +248,44 @@ ImageReaderBase
   return this->m_LoadPrivateTags;
 }
 
+ImageReaderBase::Self&
+ImageReaderBase
+::SetImageIO( const std::string &imageio )
+{
+  if ( this->m_ImageIOName != imageio )
+    {
+    this->ReleaseCachedImageIO();
+    }
+  this->m_ImageIOName = imageio;
+  return *this;
+}
+
+std::string
+ImageReaderBase
+::GetImageIO( void ) const
+{
+  return this->m_ImageIOName;
+}
+
+std::vector<std::string>
+ImageReaderBase
+::GetRegisteredImageIOs( void )
+{
+  ChunkedImageIOFactory::RegisterOneFactory();
+
+  std::vector<std::string> names;
+  std::list<itk::LightObject::Pointer> allobjects = itk::ObjectFactoryBase::CreateAllInstance( "itkImageIOBase" );
+  for ( std::list<itk::LightObject::Pointer>::iterator i = allobjects.begin(); i != allobjects.end(); ++i )
+    {
+    itk::ImageIOBase *io = dynamic_cast<itk::ImageIOBase*>( i->GetPointer() );
+    if ( io )
+      {
+      names.push_back( io->GetNameOfClass() );
+      }
+    }
+  return names;
+}
+
 void
 ImageReaderBase
 ::LoadPrivateTagsOn()
@@ -20,16 +20,127 @@
 #endif
 
 #include "sitkImageSeriesReader.h"
+#include "sitkDICOMSeriesScanner.h"
 
 #include <itkImageIOBase.h>
 #include <itkImageSeriesReader.h>
+#include <itkImageFileReader.h>
+#include <itkMultiThreader.h>
 
+#include "itkGDCMImageIO.h"
 #include "itkGDCMSeriesFileNames.h"
 #include "sitkMetaDataDictionaryCustomCast.hxx"
 
+#include <algorithm>
+
 namespace itk {
   namespace simple {
 
+  namespace
+  {
+
+  template <class TImageType>
+  struct ParallelReadThreadStruct
+  {
+    typedef typename TImageType::PixelContainer::Element ElementType;
+
+    const std::vector<std::string>         *m_FileNames;
+    std::vector<itk::ImageIOBase::Pointer>  m_ImageIOs;
+    std::vector<std::string>                m_Errors;
+    TImageType                             *m_Output;
+    size_t                                  m_ElementsPerSlice;
+
+    // the pixel type of the first file, which can be read directly
+    // into the output when it is the type of the output
+    bool                                    m_DirectRead;
+    itk::ImageIOBase::IOComponentType       m_ComponentType;
+    unsigned int                            m_NumberOfComponents;
+  };
+
+  template <class TImageType>
+  void ReadSlice( const ParallelReadThreadStruct<TImageType> &str,
+                  itk::ImageIOBase *imageio,
+                  unsigned int slice )
+  {
+    typedef typename ParallelReadThreadStruct<TImageType>::ElementType ElementType;
+    const unsigned int sliceDimension = TImageType::ImageDimension - 1;
+    const typename TImageType::SizeType &size = str.m_Output->GetLargestPossibleRegion().GetSize();
+    const std::string &fileName = (*str.m_FileNames)[slice];
+
+    ElementType *buffer = str.m_Output->GetPixelContainer()->GetBufferPointer() + slice * str.m_ElementsPerSlice;
+
+    imageio->SetFileName( fileName );
+    imageio->ReadImageInformation();
+
+    for ( unsigned int i = 0; i < std::max( imageio->GetNumberOfDimensions(), sliceDimension ); ++i )
+      {
+      const SizeValueType expected = ( i < sliceDimension ) ? size[i] : 1;
+      const SizeValueType actual = ( i < imageio->GetNumberOfDimensions() ) ? imageio->GetDimensions( i ) : 1;
+      if ( expected != actual )
+        {
+        sitkExceptionMacro( "The size of the file \"" << fileName
+                            << "\" does not match the size of the first file in the series." );
+        }
+      }
+
+    if ( str.m_DirectRead
+         && imageio->GetComponentType() == str.m_ComponentType
+         && imageio->GetNumberOfComponents() == str.m_NumberOfComponents )
+      {
+      itk::ImageIORegion region( imageio->GetNumberOfDimensions() );
+      for ( unsigned int i = 0; i < imageio->GetNumberOfDimensions(); ++i )
+        {
+        region.SetIndex( i, 0 );
+        region.SetSize( i, imageio->GetDimensions( i ) );
+        }
+      imageio->SetIORegion( region );
+      imageio->Read( buffer );
+      }
+    else
+      {
+      // convert the pixels through the reader
+      typedef itk::ImageFileReader<TImageType> ReaderType;
+      typename ReaderType::Pointer reader = ReaderType::New();
+      reader->SetImageIO( imageio );
+      reader->SetFileName( fileName );
+      reader->Update();
+
+      const ElementType *sliceBuffer = reader->GetOutput()->GetPixelContainer()->GetBufferPointer();
+      if ( reader->GetOutput()->GetPixelContainer()->Size() != str.m_ElementsPerSlice )
+        {
+        sitkExceptionMacro( "The number of components of the file \"" << fileName
+                            << "\" does not match the first file in the series." );
+        }
+      std::copy( sliceBuffer, sliceBuffer + str.m_ElementsPerSlice, buffer );
+      }
+  }
+
+  template <class TImageType>
+  ITK_THREAD_RETURN_TYPE ParallelReadThreaderCallback( void *arg )
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+    ParallelReadThreadStruct<TImageType> *str = static_cast<ParallelReadThreadStruct<TImageType> *>( info->UserData );
+
+    // the slices are interleaved between the threads to balance slow
+    // to decode regions of the series
+    try
+      {
+      for ( size_t slice = info->ThreadID; slice < str->m_FileNames->size(); slice += info->NumberOfThreads )
+        {
+        ReadSlice<TImageType>( *str, str->m_ImageIOs[info->ThreadID], static_cast<unsigned int>( slice ) );
+        }
+      }
+    catch ( std::exception &e )
+      {
+      str->m_Errors[info->ThreadID] = e.what();
+      }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  }
+
   Image ReadImage ( const std::vector<std::string> &filenames, PixelIDValueEnum outputPixelType )
     {
     ImageSeriesReader reader;
@@ -65,10 +176,44 @@ namespace itk {
     return gdcmSeries->GetSeriesUIDs();
     }
 
+  std::vector<std::string> ImageSeriesReader::GetDICOMSeriesFileNames( const std::string &directory,
+                                                                       const std::string &seriesID,
+                                                                       bool useSeriesDetails,
+                                                                       bool recursive,
+                                                                       const std::string &cacheFileName )
+    {
+    DICOMSeriesScanner scanner;
+    scanner.SetUseSeriesDetails( useSeriesDetails );
+    scanner.SetRecursive( recursive );
+    scanner.SetCacheFileName( cacheFileName );
+    scanner.SetNumberOfThreads( ProcessObject::GetGlobalDefaultNumberOfThreads() );
+
+    scanner.Scan( directory );
+
+    return scanner.GetFileNames( seriesID );
+    }
+
+  std::vector<std::string> ImageSeriesReader::GetDICOMSeriesIDs( const std::string &directory,
+                                                                 bool useSeriesDetails,
+                                                                 bool recursive,
+                                                                 const std::string &cacheFileName )
+    {
+    DICOMSeriesScanner scanner;
+    scanner.SetUseSeriesDetails( useSeriesDetails );
+    scanner.SetRecursive( recursive );
+    scanner.SetCacheFileName( cacheFileName );
+    scanner.SetNumberOfThreads( ProcessObject::GetGlobalDefaultNumberOfThreads() );
+
+    scanner.Scan( directory );
+
+    return scanner.GetSeriesIDs();
+    }
+
   ImageSeriesReader::ImageSeriesReader()
     :
     m_Filter(SITK_NULLPTR),
-    m_MetaDataDictionaryArrayUpdate(false)
+    m_MetaDataDictionaryArrayUpdate(false),
+    m_UseParallelRead(false)
     {
 
     // list of pixel types supported
@@ -102,6 +247,13 @@ namespace itk {
         ++iter;
         }
 
+      out << "  MetaDataDictionaryArrayUpdate: ";
+      this->ToStringHelper(out, this->m_MetaDataDictionaryArrayUpdate) << std::endl;
+      out << "  MetaDataKeysToKeep: ";
+      this->ToStringHelper(out, this->m_MetaDataKeysToKeep) << std::endl;
+      out << "  UseParallelRead: ";
+      this->ToStringHelper(out, this->m_UseParallelRead) << std::endl;
+
       out << ImageReaderBase::ToString();
       return out.str();
     }
@@ -180,11 +332,6 @@ namespace itk {
     // not occur
     assert( ImageTypeToPixelIDValue<ImageType>::Result != (int)sitkUnknown );
     assert( imageio != SITK_NULLPTR );
-    typename Reader::Pointer reader = Reader::New();
-    reader->SetImageIO( imageio );
-    reader->SetFileNames( this->m_FileNames );
-    // save some computation by not updating this unneeded data-structure
-    reader->SetMetaDataDictionaryArrayUpdate(m_MetaDataDictionaryArrayUpdate);
 
     // release the old filter ( and output data )
     if ( this->m_Filter != SITK_NULLPTR)
@@ -195,11 +342,31 @@ namespace itk {
       this->m_Filter->UnRegister();
       this->m_Filter = SITK_NULLPTR;
       }
+    this->m_KeptMetaDataValues.clear();
+    this->m_KeptMetaDataOffsets.clear();
+
+    // only the selected meta-data, or all of the dictionaries, are kept
+    const bool keepAllMetaData = this->m_MetaDataDictionaryArrayUpdate && this->m_MetaDataKeysToKeep.empty();
+    if ( this->m_MetaDataDictionaryArrayUpdate && !keepAllMetaData )
+      {
+      this->ReadKeptMetaData( imageio );
+      }
+
+    if ( this->m_UseParallelRead && !keepAllMetaData )
+      {
+      return this->ExecuteParallelRead<TImageType>( imageio );
+      }
+
+    typename Reader::Pointer reader = Reader::New();
+    reader->SetImageIO( imageio );
+    reader->SetFileNames( this->m_FileNames );
+    // save some computation by not updating this unneeded data-structure
+    reader->SetMetaDataDictionaryArrayUpdate(keepAllMetaData);
 
 
     this->PreUpdate( reader.GetPointer() );
 
-    if (m_MetaDataDictionaryArrayUpdate)
+    if (keepAllMetaData)
       {
       this->m_Filter = reader;
       this->m_Filter->Register();
@@ -213,5 +380,172 @@ namespace itk {
     return Image( reader->GetOutput() );
     }
 
+  
+  void ImageSeriesReader::ReadKeptMetaData( itk::ImageIOBase* imageio )
+    {
+    std::vector< std::vector<std::string> > values;
+    if ( dynamic_cast<GDCMImageIO*>( imageio ) )
+      {
+      // only the kept tags are parsed from the DICOM files
+      values = ReadDICOMTags( this->m_FileNames, this->m_MetaDataKeysToKeep, this->GetNumberOfThreads() );
+      }
+    else
+      {
+      itk::LightObject::Pointer another = imageio->CreateAnother();
+      itk::ImageIOBase::Pointer sliceIO = dynamic_cast<itk::ImageIOBase*>( another.GetPointer() );
+      if ( sliceIO.IsNull() )
+        {
+        sitkExceptionMacro( "Unable to create an ImageIO of type " << imageio->GetNameOfClass() << "." );
+        }
+      values.resize( this->m_FileNames.size() );
+      for ( size_t slice = 0; slice < this->m_FileNames.size(); ++slice )
+        {
+        sliceIO->SetFileName( this->m_FileNames[slice] );
+        sliceIO->ReadImageInformation();
+        const MetaDataDictionary &dictionary = sliceIO->GetMetaDataDictionary();
+        values[slice].resize( this->m_MetaDataKeysToKeep.size() );
+        for ( size_t k = 0; k < this->m_MetaDataKeysToKeep.size(); ++k )
+          {
+          if ( dictionary.HasKey( this->m_MetaDataKeysToKeep[k] ) )
+            {
+            values[slice][k] = GetMetaDataDictionaryCustomCast::CustomCast( &dictionary, this->m_MetaDataKeysToKeep[k] );
+            }
+          }
+        }
+      }
+
+    this->m_KeptMetaDataOffsets.reserve( this->m_FileNames.size() * this->m_MetaDataKeysToKeep.size() + 1 );
+    this->m_KeptMetaDataOffsets.push_back( 0 );
+    for ( size_t slice = 0; slice < values.size(); ++slice )
+      {
+      for ( size_t k = 0; k < values[slice].size(); ++k )
+        {
+        this->m_KeptMetaDataValues += values[slice][k];
+        this->m_KeptMetaDataOffsets.push_back( this->m_KeptMetaDataValues.size() );
+        }
+      // release the values of the slice as they are copied
+      std::vector<std::string>().swap( values[slice] );
+      }
+
+    this->m_pfGetMetaDataKeys = nsstd::bind(&ImageSeriesReader::GetKeptMetaDataKeys, this, nsstd::placeholders::_1 );
+    this->m_pfHasMetaDataKey = nsstd::bind(&ImageSeriesReader::HasKeptMetaDataKey, this, nsstd::placeholders::_1, nsstd::placeholders::_2 );
+    this->m_pfGetMetaData = nsstd::bind(&ImageSeriesReader::GetKeptMetaData, this, nsstd::placeholders::_1, nsstd::placeholders::_2 );
+    }
+
+  std::vector<std::string> ImageSeriesReader::GetKeptMetaDataKeys( int slice ) const
+    {
+    if ( slice < 0 || static_cast<size_t>( slice ) >= this->m_FileNames.size() )
+      {
+      sitkExceptionMacro( "The slice " << slice << " is not in the series." );
+      }
+    std::vector<std::string> keys;
+    const size_t first = slice * this->m_MetaDataKeysToKeep.size();
+    for ( size_t k = 0; k < this->m_MetaDataKeysToKeep.size(); ++k )
+      {
+      if ( this->m_KeptMetaDataOffsets[first + k + 1] != this->m_KeptMetaDataOffsets[first + k] )
+        {
+        keys.push_back( this->m_MetaDataKeysToKeep[k] );
+        }
+      }
+    return keys;
+    }
+
+  bool ImageSeriesReader::HasKeptMetaDataKey( int slice, const std::string &key ) const
+    {
+    const std::vector<std::string> keys = this->GetKeptMetaDataKeys( slice );
+    return std::find( keys.begin(), keys.end(), key ) != keys.end();
+    }
+
+  std::string ImageSeriesReader::GetKeptMetaData( int slice, const std::string &key ) const
+    {
+    if ( !this->HasKeptMetaDataKey( slice, key ) )
+      {
+      sitkExceptionMacro( "The meta-data key \"" << key << "\" is not kept for the slice " << slice << "." );
+      }
+    const size_t k = std::find( this->m_MetaDataKeysToKeep.begin(), this->m_MetaDataKeysToKeep.end(), key )
+      - this->m_MetaDataKeysToKeep.begin();
+    const size_t entry = slice * this->m_MetaDataKeysToKeep.size() + k;
+    return this->m_KeptMetaDataValues.substr( static_cast<size_t>( this->m_KeptMetaDataOffsets[entry] ),
+                                              static_cast<size_t>( this->m_KeptMetaDataOffsets[entry + 1] - this->m_KeptMetaDataOffsets[entry] ) );
+    }
+
+  template <class TImageType> Image
+  ImageSeriesReader::ExecuteParallelRead( itk::ImageIOBase* imageio )
+    {
+    typedef TImageType                                   ImageType;
+    typedef itk::ImageSeriesReader<ImageType>            Reader;
+    typedef typename ImageType::PixelContainer::Element  ElementType;
+
+    // The series reader computes the geometry of the volume from the
+    // first and last slices.
+    typename Reader::Pointer reader = Reader::New();
+    reader->SetImageIO( imageio );
+    reader->SetFileNames( this->m_FileNames );
+    reader->SetMetaDataDictionaryArrayUpdate( false );
+
+    this->PreUpdate( reader.GetPointer() );
+
+    reader->UpdateOutputInformation();
+
+    const ImageType *info = reader->GetOutput();
+    typename ImageType::Pointer output = ImageType::New();
+    output->CopyInformation( info );
+    output->SetRegions( info->GetLargestPossibleRegion() );
+    output->SetNumberOfComponentsPerPixel( info->GetNumberOfComponentsPerPixel() );
+    output->SetMetaDataDictionary( info->GetMetaDataDictionary() );
+    output->Allocate();
+
+    const unsigned int numberOfSlices = static_cast<unsigned int>( this->m_FileNames.size() );
+    const itk::ThreadIdType numberOfThreads = std::max( 1u, std::min( this->GetNumberOfThreads(), numberOfSlices ) );
+
+    ParallelReadThreadStruct<ImageType> str;
+    str.m_FileNames = &this->m_FileNames;
+    str.m_Output = output;
+    str.m_ElementsPerSlice = output->GetPixelContainer()->Size() / numberOfSlices;
+    str.m_Errors.resize( numberOfThreads );
+
+    // slices with the pixel type of the output are read directly into
+    // the output buffer
+    PixelIDValueType pixelID;
+    unsigned int dimension;
+    this->GetPixelIDFromImageIO( imageio, pixelID, dimension );
+    const size_t pixelsPerSlice = std::max<size_t>( 1, info->GetLargestPossibleRegion().GetNumberOfPixels() / numberOfSlices );
+    const size_t bytesPerPixel = sizeof( ElementType ) * ( str.m_ElementsPerSlice / pixelsPerSlice );
+    str.m_ComponentType = imageio->GetComponentType();
+    str.m_NumberOfComponents = imageio->GetNumberOfComponents();
+    str.m_DirectRead = ( pixelID == static_cast<PixelIDValueType>( ImageTypeToPixelIDValue<ImageType>::Result )
+                         && imageio->GetComponentSize() * imageio->GetNumberOfComponents() == bytesPerPixel );
+
+    for ( itk::ThreadIdType i = 0; i < numberOfThreads; ++i )
+      {
+      itk::LightObject::Pointer another = imageio->CreateAnother();
+      str.m_ImageIOs.push_back( dynamic_cast<itk::ImageIOBase*>( another.GetPointer() ) );
+      if ( str.m_ImageIOs.back().IsNull() )
+        {
+        sitkExceptionMacro( "Unable to create an ImageIO of type " << imageio->GetNameOfClass() << "." );
+        }
+      }
+
+    reader->InvokeEvent( itk::StartEvent() );
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( numberOfThreads );
+    threader->SetSingleMethod( ParallelReadThreaderCallback<ImageType>, &str );
+    threader->SingleMethodExecute();
+
+    for ( itk::ThreadIdType i = 0; i < numberOfThreads; ++i )
+      {
+      if ( !str.m_Errors[i].empty() )
+        {
+        sitkExceptionMacro( "Error reading the series: " << str.m_Errors[i] );
+        }
+      }
+
+    reader->UpdateProgress( 1.0f );
+    reader->InvokeEvent( itk::EndEvent() );
+
+    return Image( output.GetPointer() );
+    }
+
   }
 }
@@ -22,15 +22,170 @@
 #endif
 
 #include "sitkImageSeriesWriter.h"
+#include "sitkImageIOCompression.h"
+#include "sitkChunkedImageIO.h"
 
 #include <itkImageIOBase.h>
+#include <itkImageIOFactory.h>
 #include <itkImageSeriesWriter.h>
+#include <itkImageFileWriter.h>
+#include <itkMultiThreader.h>
+#include <itkMutexLock.h>
+#include <itkConditionVariable.h>
 
+#include <algorithm>
 #include <cctype>
 
 namespace itk {
   namespace simple {
 
+  namespace
+  {
+
+  template <class TImageType>
+  struct ParallelWriteThreadStruct
+  {
+    ParallelWriteThreadStruct()
+      : m_Condition( itk::ConditionVariable::New() ),
+        m_NextSlice( 0 ),
+        m_NumberOfCompletedSlices( 0 ),
+        m_NumberOfRunningThreads( 0 ),
+        m_Stop( false )
+      {}
+
+    const std::vector<std::string>         *m_FileNames;
+    const TImageType                       *m_Input;
+    size_t                                  m_ElementsPerSlice;
+    bool                                    m_UseCompression;
+    std::vector<itk::ImageIOBase::Pointer>  m_ImageIOs;
+
+    // the following are guarded by the mutex
+    itk::SimpleMutexLock                    m_Mutex;
+    itk::ConditionVariable::Pointer         m_Condition;
+    size_t                                  m_NextSlice;
+    size_t                                  m_NumberOfCompletedSlices;
+    unsigned int                            m_NumberOfRunningThreads;
+    bool                                    m_Stop;
+    std::string                             m_Error;
+  };
+
+  template <class TImageType>
+  void WriteSlice( const ParallelWriteThreadStruct<TImageType> &str,
+                   itk::ImageIOBase *imageio,
+                   unsigned int slice )
+  {
+    typedef typename TImageType::template Rebind<typename TImageType::PixelType, TImageType::ImageDimension-1>::Type SliceImageType;
+    typedef typename SliceImageType::PixelContainer PixelContainerType;
+    typedef typename PixelContainerType::Element    ElementType;
+    const unsigned int sliceDimension = SliceImageType::ImageDimension;
+    const TImageType *input = str.m_Input;
+    const std::string &fileName = (*str.m_FileNames)[slice];
+
+    if ( !imageio->CanWriteFile( fileName.c_str() ) )
+      {
+      sitkExceptionMacro( "The file \"" << fileName << "\" can not be written with "
+                          << imageio->GetNameOfClass() << ", the ImageIO of the first file in the series." );
+      }
+
+    // the origin of the slice is the physical location of its first pixel
+    typename TImageType::IndexType index = input->GetLargestPossibleRegion().GetIndex();
+    index[sliceDimension] += slice;
+    typename TImageType::PointType position;
+    input->TransformIndexToPhysicalPoint( index, position );
+
+    typename SliceImageType::RegionType region;
+    typename SliceImageType::SpacingType spacing;
+    typename SliceImageType::PointType origin;
+    typename SliceImageType::DirectionType direction;
+    for ( unsigned int i = 0; i < sliceDimension; ++i )
+      {
+      region.SetIndex( i, 0 );
+      region.SetSize( i, input->GetLargestPossibleRegion().GetSize( i ) );
+      spacing[i] = input->GetSpacing()[i];
+      origin[i] = position[i];
+      for ( unsigned int j = 0; j < sliceDimension; ++j )
+        {
+        direction[i][j] = input->GetDirection()[i][j];
+        }
+      }
+
+    typename SliceImageType::Pointer sliceImage = SliceImageType::New();
+    sliceImage->SetRegions( region );
+    sliceImage->SetSpacing( spacing );
+    sliceImage->SetOrigin( origin );
+    sliceImage->SetDirection( direction );
+    sliceImage->SetNumberOfComponentsPerPixel( input->GetNumberOfComponentsPerPixel() );
+
+    // the slice refers to the buffer of the input without copying
+    typename PixelContainerType::Pointer container = PixelContainerType::New();
+    container->SetImportPointer( const_cast<ElementType *>( input->GetBufferPointer() ) + slice * str.m_ElementsPerSlice,
+                                 str.m_ElementsPerSlice,
+                                 false );
+    sliceImage->SetPixelContainer( container );
+
+    typedef itk::ImageFileWriter<SliceImageType> WriterType;
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetImageIO( imageio );
+    writer->SetUseCompression( str.m_UseCompression );
+    writer->SetFileName( fileName );
+    writer->SetInput( sliceImage );
+    writer->Update();
+  }
+
+  template <class TImageType>
+  ITK_THREAD_RETURN_TYPE ParallelWriteThreaderCallback( void *arg )
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+    ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+    ParallelWriteThreadStruct<TImageType> *str = static_cast<ParallelWriteThreadStruct<TImageType> *>( info->UserData );
+    itk::ImageIOBase *imageio = str->m_ImageIOs[info->ThreadID];
+
+    while ( true )
+      {
+      str->m_Mutex.Lock();
+      if ( str->m_Stop || str->m_NextSlice >= str->m_FileNames->size() )
+        {
+        --str->m_NumberOfRunningThreads;
+        str->m_Condition->Broadcast();
+        str->m_Mutex.Unlock();
+        break;
+        }
+      const size_t slice = str->m_NextSlice++;
+      str->m_Mutex.Unlock();
+
+      std::string error;
+      try
+        {
+        WriteSlice<TImageType>( *str, imageio, static_cast<unsigned int>( slice ) );
+        }
+      catch ( std::exception &e )
+        {
+        error = e.what();
+        }
+      catch ( ... )
+        {
+        error = "Unknown exception writing \"" + (*str->m_FileNames)[slice] + "\".";
+        }
+
+      str->m_Mutex.Lock();
+      ++str->m_NumberOfCompletedSlices;
+      if ( !error.empty() )
+        {
+        if ( str->m_Error.empty() )
+          {
+          str->m_Error = error;
+          }
+        str->m_Stop = true;
+        }
+      str->m_Condition->Broadcast();
+      str->m_Mutex.Unlock();
+      }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  }
+
   void WriteImage ( const Image& inImage, const std::vector<std::string> &filenames, bool useCompression )
   {
     ImageSeriesWriter writer;
@@ -41,6 +196,10 @@ namespace itk {
   {
 
     this->m_UseCompression = false;
+    this->m_CompressionLevel = -1;
+    this->m_UseParallelWrite = false;
+
+    ChunkedImageIOFactory::RegisterOneFactory();
 
     // list of pixel types supported
     typedef NonLabelPixelIDTypeList PixelIDTypeList;
@@ -62,6 +221,18 @@ namespace itk {
     this->ToStringHelper(out, this->m_UseCompression);
     out << std::endl;
 
+    out << "  Compressor: \"";
+    this->ToStringHelper(out, this->m_Compressor);
+    out << "\"" << std::endl;
+
+    out << "  CompressionLevel: ";
+    this->ToStringHelper(out, this->m_CompressionLevel);
+    out << std::endl;
+
+    out << "  UseParallelWrite: ";
+    this->ToStringHelper(out, this->m_UseParallelWrite);
+    out << std::endl;
+
     out << "  FileNames:" << std::endl;
     std::vector<std::string>::const_iterator iter  = m_FileNames.begin();
     while( iter != m_FileNames.end() )
@@ -86,6 +257,30 @@ namespace itk {
     return this->m_UseCompression;
   }
 
+  ImageSeriesWriter::Self&
+  ImageSeriesWriter::SetCompressor( const std::string &Compressor )
+  {
+    this->m_Compressor = Compressor;
+    return *this;
+  }
+
+  std::string ImageSeriesWriter::GetCompressor( void ) const
+  {
+    return this->m_Compressor;
+  }
+
+  ImageSeriesWriter::Self&
+  ImageSeriesWriter::SetCompressionLevel( int CompressionLevel )
+  {
+    this->m_CompressionLevel = CompressionLevel;
+    return *this;
+  }
+
+  int ImageSeriesWriter::GetCompressionLevel( void ) const
+  {
+    return this->m_CompressionLevel;
+  }
+
 
   ImageSeriesWriter& ImageSeriesWriter::SetFileNames ( const std::vector<std::string> &filenames )
   {
@@ -145,6 +340,11 @@ namespace itk {
 
     typename InputImageType::ConstPointer image = this->CastImageToITK<InputImageType>( inImage );
 
+    if ( this->m_UseParallelWrite )
+      {
+      return this->ExecuteParallelWrite<InputImageType>( image.GetPointer() );
+      }
+
     typedef itk::ImageSeriesWriter<InputImageType,
                                    typename InputImageType::template Rebind<typename InputImageType::PixelType, InputImageType::ImageDimension-1>::Type> Writer;
 
@@ -153,6 +353,20 @@ namespace itk {
     writer->SetFileNames( this->m_FileNames );
     writer->SetInput( image );
 
+    // The ImageIO of the first file is used to write each slice, so
+    // that its compression can be configured.
+    if ( this->m_UseCompression && ( !this->m_Compressor.empty() || this->m_CompressionLevel >= 0 ) )
+      {
+      itk::ImageIOBase::Pointer imageio =
+        itk::ImageIOFactory::CreateImageIO( this->m_FileNames[0].c_str(), itk::ImageIOFactory::WriteMode );
+      if ( imageio.IsNull() )
+        {
+        sitkExceptionMacro( "Unable to determine ImageIO writer for \"" << this->m_FileNames[0] << "\"" );
+        }
+      SetImageIOCompression( imageio, this->m_Compressor, this->m_CompressionLevel );
+      writer->SetImageIO( imageio );
+      }
+
     this->PreUpdate( writer.GetPointer() );
 
     writer->Update();
@@ -160,5 +374,121 @@ namespace itk {
     return *this;
   }
 
+
+  template <class TImageType>
+  ImageSeriesWriter &
+  ImageSeriesWriter::ExecuteParallelWrite( const TImageType *image )
+  {
+    typedef TImageType InputImageType;
+    typedef itk::ImageSeriesWriter<InputImageType,
+                                   typename InputImageType::template Rebind<typename InputImageType::PixelType, InputImageType::ImageDimension-1>::Type> Writer;
+
+    const unsigned int numberOfSlices = static_cast<unsigned int>( image->GetLargestPossibleRegion().GetSize( InputImageType::ImageDimension-1 ) );
+    if ( numberOfSlices != this->m_FileNames.size() )
+      {
+      sitkExceptionMacro( "The number of file names (" << this->m_FileNames.size()
+                          << ") does not match the number of slices (" << numberOfSlices << ")." );
+      }
+
+    itk::ImageIOBase::Pointer imageio =
+      itk::ImageIOFactory::CreateImageIO( this->m_FileNames[0].c_str(), itk::ImageIOFactory::WriteMode );
+    if ( imageio.IsNull() )
+      {
+      sitkExceptionMacro( "Unable to determine ImageIO writer for \"" << this->m_FileNames[0] << "\"" );
+      }
+
+    // At most one slice per thread is being encoded at a time.
+    const itk::ThreadIdType numberOfThreads = std::max( 1u, std::min( this->GetNumberOfThreads(), numberOfSlices ) );
+
+    ParallelWriteThreadStruct<InputImageType> str;
+    str.m_FileNames = &this->m_FileNames;
+    str.m_Input = image;
+    str.m_ElementsPerSlice = image->GetPixelContainer()->Size() / numberOfSlices;
+    str.m_UseCompression = this->m_UseCompression;
+
+    for ( itk::ThreadIdType i = 0; i < numberOfThreads; ++i )
+      {
+      itk::LightObject::Pointer another = imageio->CreateAnother();
+      str.m_ImageIOs.push_back( dynamic_cast<itk::ImageIOBase*>( another.GetPointer() ) );
+      if ( str.m_ImageIOs.back().IsNull() )
+        {
+        sitkExceptionMacro( "Unable to create an ImageIO of type " << imageio->GetNameOfClass() << "." );
+        }
+      if ( this->m_UseCompression && ( !this->m_Compressor.empty() || this->m_CompressionLevel >= 0 ) )
+        {
+        SetImageIOCompression( str.m_ImageIOs.back(), this->m_Compressor, this->m_CompressionLevel );
+        }
+      }
+
+    // The ITK series writer is not executed, it only carries the
+    // events of the parallel write to the registered commands. All
+    // events are invoked from this thread.
+    typename Writer::Pointer writer = Writer::New();
+    writer->SetFileNames( this->m_FileNames );
+    writer->SetInput( image );
+
+    this->PreUpdate( writer.GetPointer() );
+
+    writer->InvokeEvent( itk::StartEvent() );
+    writer->UpdateProgress( 0.0f );
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    std::vector<itk::ThreadIdType> threads;
+    str.m_NumberOfRunningThreads = numberOfThreads;
+    for ( itk::ThreadIdType i = 0; i < numberOfThreads; ++i )
+      {
+      threads.push_back( threader->SpawnThread( ParallelWriteThreaderCallback<InputImageType>, &str ) );
+      }
+
+    size_t numberOfReportedSlices = 0;
+    str.m_Mutex.Lock();
+    while ( str.m_NumberOfRunningThreads > 0 )
+      {
+      if ( str.m_NumberOfCompletedSlices == numberOfReportedSlices )
+        {
+        str.m_Condition->Wait( &str.m_Mutex );
+        continue;
+        }
+      numberOfReportedSlices = str.m_NumberOfCompletedSlices;
+      str.m_Mutex.Unlock();
+
+      writer->UpdateProgress( static_cast<float>( numberOfReportedSlices ) / numberOfSlices );
+
+      str.m_Mutex.Lock();
+      if ( writer->GetAbortGenerateData() )
+        {
+        str.m_Stop = true;
+        }
+      }
+    str.m_Mutex.Unlock();
+
+    for ( size_t i = 0; i < threads.size(); ++i )
+      {
+      threader->TerminateThread( threads[i] );
+      }
+
+    if ( !str.m_Error.empty() )
+      {
+      sitkExceptionMacro( "Error writing the series: " << str.m_Error );
+      }
+
+    if ( writer->GetAbortGenerateData() )
+      {
+      writer->InvokeEvent( itk::AbortEvent() );
+      itk::ProcessAborted e( __FILE__, __LINE__ );
+      e.SetLocation( ITK_LOCATION );
+      e.SetDescription( "Process aborted." );
+      throw e;
+      }
+
+    if ( numberOfReportedSlices != numberOfSlices )
+      {
+      writer->UpdateProgress( 1.0f );
+      }
+    writer->InvokeEvent( itk::EndEvent() );
+
+    return *this;
+  }
+
   }
 }
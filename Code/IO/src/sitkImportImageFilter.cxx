@@ -24,6 +24,7 @@
 
 #include <itkImage.h>
 #include <itkVectorImage.h>
+#include <itkImportImageContainer.h>
 
 #include <iterator>
 
@@ -34,6 +35,50 @@ namespace simple {
 namespace
 {
 const unsigned int UnusedDimension = 2;
+
+// An ImportImageContainer which does not manage the imported memory,
+// but calls a user provided deleter on the originally imported
+// buffer when the container is destroyed.
+template <typename TElementIdentifier, typename TElement>
+class ImportImageContainerWithDeleter
+  : public itk::ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  typedef ImportImageContainerWithDeleter                         Self;
+  typedef itk::ImportImageContainer<TElementIdentifier, TElement> Superclass;
+  typedef SmartPointer<Self>                                      Pointer;
+  typedef void (*DeleterFunctionType)( void *, void * );
+
+  itkNewMacro(Self);
+  itkTypeMacro(ImportImageContainerWithDeleter, ImportImageContainer);
+
+  void SetDeleter( DeleterFunctionType deleter, void *buffer, void *clientData )
+    {
+      m_Deleter = deleter;
+      m_DeleterBuffer = buffer;
+      m_DeleterClientData = clientData;
+    }
+
+protected:
+  ImportImageContainerWithDeleter()
+    : m_Deleter(NULL), m_DeleterBuffer(NULL), m_DeleterClientData(NULL) {}
+  virtual ~ImportImageContainerWithDeleter()
+    {
+      if ( m_Deleter )
+        {
+        m_Deleter( m_DeleterBuffer, m_DeleterClientData );
+        }
+    }
+
+private:
+  ImportImageContainerWithDeleter(const Self &); //purposely not implemented
+  void operator=(const Self &);                  //purposely not implemented
+
+  DeleterFunctionType m_Deleter;
+  void               *m_DeleterBuffer;
+  void               *m_DeleterClientData;
+};
+
 }
 
 
@@ -214,6 +259,8 @@ ImportImageFilter::ImportImageFilter()
   m_Origin = std::vector<double>( 3, 0.0 );
   m_Spacing = std::vector<double>( 3, 1.0 );
   this->m_Buffer = NULL;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
 
   // list of pixel types supported
   typedef NonLabelPixelIDTypeList PixelIDTypeList;
@@ -273,6 +320,8 @@ const std::vector< double > &ImportImageFilter::GetDirection( ) const
 ImportImageFilter::Self& ImportImageFilter::SetBufferAsInt8( int8_t * buffer, unsigned int numberOfComponents )
 {
   this->m_Buffer = buffer;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
   this->m_NumberOfComponentsPerPixel = numberOfComponents;
   if ( this->m_NumberOfComponentsPerPixel == 1 )
     {
@@ -287,6 +336,8 @@ ImportImageFilter::Self& ImportImageFilter::SetBufferAsInt8( int8_t * buffer, un
 ImportImageFilter::Self& ImportImageFilter::SetBufferAsUInt8( uint8_t * buffer, unsigned int numberOfComponents )
 {
   this->m_Buffer = buffer;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
   this->m_NumberOfComponentsPerPixel = numberOfComponents;
   if ( this->m_NumberOfComponentsPerPixel == 1 )
     {
@@ -301,6 +352,8 @@ ImportImageFilter::Self& ImportImageFilter::SetBufferAsUInt8( uint8_t * buffer,
 ImportImageFilter::Self& ImportImageFilter::SetBufferAsInt16( int16_t * buffer, unsigned int numberOfComponents )
 {
   this->m_Buffer = buffer;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
   this->m_NumberOfComponentsPerPixel = numberOfComponents;
   if ( this->m_NumberOfComponentsPerPixel == 1 )
     {
@@ -315,6 +368,8 @@ ImportImageFilter::Self& ImportImageFilter::SetBufferAsInt16( int16_t * buffer,
 ImportImageFilter::Self& ImportImageFilter::SetBufferAsUInt16( uint16_t * buffer, unsigned int numberOfComponents )
 {
   this->m_Buffer = buffer;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
   this->m_NumberOfComponentsPerPixel = numberOfComponents;
   if ( this->m_NumberOfComponentsPerPixel == 1 )
     {
@@ -329,6 +384,8 @@ ImportImageFilter::Self& ImportImageFilter::SetBufferAsUInt16( uint16_t * buffer
 ImportImageFilter::Self& ImportImageFilter::SetBufferAsInt32( int32_t * buffer, unsigned int numberOfComponents )
 {
   this->m_Buffer = buffer;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
   this->m_NumberOfComponentsPerPixel = numberOfComponents;
   if ( this->m_NumberOfComponentsPerPixel == 1 )
     {
@@ -343,6 +400,8 @@ ImportImageFilter::Self& ImportImageFilter::SetBufferAsInt32( int32_t * buffer,
 ImportImageFilter::Self& ImportImageFilter::SetBufferAsUInt32( uint32_t * buffer, unsigned int numberOfComponents )
 {
   this->m_Buffer = buffer;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
   this->m_NumberOfComponentsPerPixel = numberOfComponents;
   if ( this->m_NumberOfComponentsPerPixel == 1 )
     {
@@ -357,6 +416,8 @@ ImportImageFilter::Self& ImportImageFilter::SetBufferAsUInt32( uint32_t * buffer
 ImportImageFilter::Self& ImportImageFilter::SetBufferAsInt64( int64_t * buffer, unsigned int numberOfComponents )
 {
   this->m_Buffer = buffer;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
   this->m_NumberOfComponentsPerPixel = numberOfComponents;
   if ( this->m_NumberOfComponentsPerPixel == 1 )
     {
@@ -371,6 +432,8 @@ ImportImageFilter::Self& ImportImageFilter::SetBufferAsInt64( int64_t * buffer,
 ImportImageFilter::Self& ImportImageFilter::SetBufferAsUInt64( uint64_t * buffer, unsigned int numberOfComponents )
 {
   this->m_Buffer = buffer;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
   this->m_NumberOfComponentsPerPixel = numberOfComponents;
   if ( this->m_NumberOfComponentsPerPixel == 1 )
     {
@@ -386,6 +449,8 @@ ImportImageFilter::Self& ImportImageFilter::SetBufferAsUInt64( uint64_t * buffer
 ImportImageFilter::Self& ImportImageFilter::SetBufferAsFloat( float * buffer, unsigned int numberOfComponents )
 {
   this->m_Buffer = buffer;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
   this->m_NumberOfComponentsPerPixel = numberOfComponents;
   if ( this->m_NumberOfComponentsPerPixel == 1 )
     {
@@ -400,6 +465,8 @@ ImportImageFilter::Self& ImportImageFilter::SetBufferAsFloat( float * buffer, un
 ImportImageFilter::Self& ImportImageFilter::SetBufferAsDouble( double * buffer, unsigned int numberOfComponents )
 {
   this->m_Buffer = buffer;
+  this->m_BufferDeleter = NULL;
+  this->m_BufferDeleterClientData = NULL;
   this->m_NumberOfComponentsPerPixel = numberOfComponents;
   if ( this->m_NumberOfComponentsPerPixel == 1 )
     {
@@ -412,6 +479,17 @@ ImportImageFilter::Self& ImportImageFilter::SetBufferAsDouble( double * buffer,
   return *this;
 }
 
+ImportImageFilter::Self& ImportImageFilter::SetBufferDeleter( BufferDeleterFunctionType deleter, void *clientData )
+{
+  this->m_BufferDeleter = deleter;
+  this->m_BufferDeleterClientData = clientData;
+  return *this;
+}
+
+ImportImageFilter::BufferDeleterFunctionType ImportImageFilter::GetBufferDeleter( ) const
+{
+  return this->m_BufferDeleter;
+}
 
 #define PRINT_IVAR_MACRO( VAR ) "\t" << #VAR << ": " << VAR << std::endl
 
@@ -426,7 +504,8 @@ std::string ImportImageFilter::ToString() const
       << PRINT_IVAR_MACRO( m_Spacing )
       << PRINT_IVAR_MACRO( m_Size )
       << PRINT_IVAR_MACRO( m_Direction )
-      << PRINT_IVAR_MACRO( m_Buffer );
+      << PRINT_IVAR_MACRO( m_Buffer )
+      << "\tm_BufferDeleter: " << (this->m_BufferDeleter?"set":"(none)") << std::endl;
   return out.str();
 }
 
@@ -512,6 +591,22 @@ Image ImportImageFilter::ExecuteInternal( )
 
   const bool TheContainerWillTakeCareOfDeletingTheMemoryBuffer = false;
 
+  if ( this->m_BufferDeleter )
+    {
+    // The buffer is released with the user's deleter when the last
+    // reference to the container is removed.
+    typedef typename ImageType::PixelContainer PixelContainerType;
+    typedef ImportImageContainerWithDeleter<typename PixelContainerType::ElementIdentifier,
+                                            typename PixelContainerType::Element> ContainerType;
+    typename ContainerType::Pointer container = ContainerType::New();
+    container->SetDeleter( this->m_BufferDeleter, this->m_Buffer, this->m_BufferDeleterClientData );
+    image->SetPixelContainer( container );
+
+    // ownership has been transferred to the image
+    this->m_BufferDeleter = NULL;
+    this->m_BufferDeleterClientData = NULL;
+    }
+
   // Set the image's pixel container to import the pointer provided.
   image->GetPixelContainer()->SetImportPointer(static_cast<typename ImageType::InternalPixelType*>(m_Buffer), numberOfElements,
                                                TheContainerWillTakeCareOfDeletingTheMemoryBuffer);
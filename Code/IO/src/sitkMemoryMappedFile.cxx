@@ -0,0 +1,163 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkMemoryMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+namespace simple
+{
+
+MemoryMappedFile::MemoryMappedFile()
+  : m_Data( SITK_NULLPTR ),
+    m_MappedAddress( SITK_NULLPTR ),
+    m_MappedLength( 0 )
+#ifdef _WIN32
+  , m_FileHandle( SITK_NULLPTR ),
+    m_MappingHandle( SITK_NULLPTR )
+#endif
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+  this->Unmap();
+}
+
+#ifdef _WIN32
+
+bool MemoryMappedFile::Map( const std::string &fileName, uint64_t offset, uint64_t numberOfBytes )
+{
+  this->Unmap();
+
+  HANDLE file = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+  if ( file == INVALID_HANDLE_VALUE )
+    {
+    return false;
+    }
+  m_FileHandle = file;
+
+  HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+  if ( mapping == NULL )
+    {
+    this->Unmap();
+    return false;
+    }
+  m_MappingHandle = mapping;
+
+  SYSTEM_INFO info;
+  GetSystemInfo( &info );
+  const uint64_t alignedOffset = offset - offset % info.dwAllocationGranularity;
+  const uint64_t length = numberOfBytes + ( offset - alignedOffset );
+
+  void *address = MapViewOfFile( mapping, FILE_MAP_COPY,
+                                 static_cast<DWORD>( alignedOffset >> 32 ),
+                                 static_cast<DWORD>( alignedOffset & 0xFFFFFFFF ),
+                                 static_cast<SIZE_T>( length ) );
+  if ( address == NULL )
+    {
+    this->Unmap();
+    return false;
+    }
+
+  m_MappedAddress = address;
+  m_MappedLength = length;
+  m_Data = static_cast<char *>( address ) + ( offset - alignedOffset );
+  return true;
+}
+
+void MemoryMappedFile::Unmap( void )
+{
+  if ( m_MappedAddress )
+    {
+    UnmapViewOfFile( m_MappedAddress );
+    }
+  if ( m_MappingHandle )
+    {
+    CloseHandle( static_cast<HANDLE>( m_MappingHandle ) );
+    }
+  if ( m_FileHandle )
+    {
+    CloseHandle( static_cast<HANDLE>( m_FileHandle ) );
+    }
+  m_Data = SITK_NULLPTR;
+  m_MappedAddress = SITK_NULLPTR;
+  m_MappedLength = 0;
+  m_MappingHandle = SITK_NULLPTR;
+  m_FileHandle = SITK_NULLPTR;
+}
+
+#else
+
+bool MemoryMappedFile::Map( const std::string &fileName, uint64_t offset, uint64_t numberOfBytes )
+{
+  this->Unmap();
+
+  const int fd = open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    {
+    return false;
+    }
+
+  const uint64_t pageSize = static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) );
+  const uint64_t alignedOffset = offset - offset % pageSize;
+  const uint64_t length = numberOfBytes + ( offset - alignedOffset );
+
+  // A private writable mapping of a read only file, written pages
+  // become copies private to this process.
+  void *address = mmap( SITK_NULLPTR, static_cast<size_t>( length ), PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE, fd, static_cast<off_t>( alignedOffset ) );
+
+  // the mapping remains valid after the file is closed
+  close( fd );
+
+  if ( address == MAP_FAILED )
+    {
+    return false;
+    }
+
+  m_MappedAddress = address;
+  m_MappedLength = length;
+  m_Data = static_cast<char *>( address ) + ( offset - alignedOffset );
+  return true;
+}
+
+void MemoryMappedFile::Unmap( void )
+{
+  if ( m_MappedAddress )
+    {
+    munmap( m_MappedAddress, static_cast<size_t>( m_MappedLength ) );
+    }
+  m_Data = SITK_NULLPTR;
+  m_MappedAddress = SITK_NULLPTR;
+  m_MappedLength = 0;
+}
+
+#endif
+
+}
+}
@@ -0,0 +1,117 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkMemoryMappedFile_h
+#define sitkMemoryMappedFile_h
+
+#include "sitkMacro.h"
+#include "sitkIO.h"
+
+#include "itkLightObject.h"
+#include "itkImportImageContainer.h"
+
+#include <string>
+
+namespace itk
+{
+namespace simple
+{
+
+/** \class MemoryMappedFile
+ * \brief A private copy-on-write memory mapping of a region of a file
+ *
+ * The pages of the file are loaded on demand, and are shared with
+ * other mappings of the file until they are written to. Writes are
+ * never carried to the file.
+ */
+class SITKIO_HIDDEN MemoryMappedFile
+  : public itk::LightObject
+{
+public:
+  typedef MemoryMappedFile          Self;
+  typedef itk::LightObject          Superclass;
+  typedef itk::SmartPointer<Self>   Pointer;
+
+  itkSimpleNewMacro(Self);
+
+  /** Map numberOfBytes of the file starting at offset, returns false
+   * if the file can not be mapped. */
+  bool Map( const std::string &fileName, uint64_t offset, uint64_t numberOfBytes );
+
+  void *GetData( void ) const { return m_Data; }
+
+protected:
+  MemoryMappedFile();
+  ~MemoryMappedFile();
+
+private:
+  MemoryMappedFile( const Self & ); //purposely not implemented
+  void operator=( const Self & );   //purposely not implemented
+
+  void Unmap( void );
+
+  void    *m_Data;
+  void    *m_MappedAddress;
+  uint64_t m_MappedLength;
+#ifdef _WIN32
+  void    *m_FileHandle;
+  void    *m_MappingHandle;
+#endif
+};
+
+
+/** \class MemoryMappedImportImageContainer
+ * \brief A pixel container referencing the data of a MemoryMappedFile,
+ * which is unmapped when the container is destroyed.
+ */
+template <typename TElementIdentifier, typename TElement>
+class MemoryMappedImportImageContainer
+  : public itk::ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  typedef MemoryMappedImportImageContainer                        Self;
+  typedef itk::ImportImageContainer<TElementIdentifier, TElement> Superclass;
+  typedef SmartPointer<Self>                                      Pointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(MemoryMappedImportImageContainer, ImportImageContainer);
+
+  void SetMemoryMappedFile( MemoryMappedFile *file, TElementIdentifier numberOfElements )
+    {
+      m_File = file;
+      this->SetImportPointer( static_cast<TElement *>( file->GetData() ), numberOfElements, false );
+    }
+
+protected:
+  MemoryMappedImportImageContainer() {}
+  virtual ~MemoryMappedImportImageContainer()
+    {
+      // release the pointer before the file is unmapped
+      this->SetImportPointer( SITK_NULLPTR, 0, false );
+    }
+
+private:
+  MemoryMappedImportImageContainer(const Self &); //purposely not implemented
+  void operator=(const Self &);                   //purposely not implemented
+
+  MemoryMappedFile::Pointer m_File;
+};
+
+}
+}
+
+#endif
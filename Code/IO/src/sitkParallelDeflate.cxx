@@ -0,0 +1,272 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkParallelDeflate.h"
+
+#include <itkMultiThreader.h>
+#include "itk_zlib.h"
+
+#include <algorithm>
+
+namespace itk
+{
+namespace simple
+{
+
+namespace
+{
+
+struct CompressThreadStruct
+{
+  std::vector<ParallelDeflate::Block> *m_Blocks;
+  size_t                               m_NumberOfBlocks;
+  int                                  m_CompressionLevel;
+  bool                                 m_Gzip;
+};
+
+void CompressBlock( ParallelDeflate::Block &block, int compressionLevel, bool gzip )
+{
+  block.m_Output.clear();
+
+  Bytef *input = block.m_Input.empty() ? Z_NULL : reinterpret_cast<Bytef *>( &block.m_Input[0] );
+  const uInt inputSize = static_cast<uInt>( block.m_Input.size() );
+
+  block.m_Checksum = gzip ? crc32( 0L, Z_NULL, 0 ) : adler32( 0L, Z_NULL, 0 );
+  block.m_Checksum = gzip ? crc32( block.m_Checksum, input, inputSize ) : adler32( block.m_Checksum, input, inputSize );
+
+  // a raw deflate stream, the header and trailer are written for the
+  // whole stream
+  z_stream strm;
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  block.m_Status = deflateInit2( &strm, compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY );
+  if ( block.m_Status != Z_OK )
+    {
+    return;
+    }
+
+  // The sync flush ends the block on a byte boundary without marking
+  // the end of the stream, so that the next block can be appended.
+  const int flush = block.m_Last ? Z_FINISH : Z_SYNC_FLUSH;
+
+  strm.next_in = input;
+  strm.avail_in = inputSize;
+
+  block.m_Output.resize( deflateBound( &strm, inputSize ) + 64 );
+  size_t produced = 0;
+  while ( true )
+    {
+    strm.next_out = reinterpret_cast<Bytef *>( &block.m_Output[produced] );
+    strm.avail_out = static_cast<uInt>( block.m_Output.size() - produced );
+
+    const int ret = deflate( &strm, flush );
+    produced = block.m_Output.size() - strm.avail_out;
+
+    if ( ret == Z_STREAM_ERROR )
+      {
+      block.m_Status = ret;
+      break;
+      }
+    if ( block.m_Last ? ( ret == Z_STREAM_END ) : ( strm.avail_in == 0 && strm.avail_out != 0 ) )
+      {
+      break;
+      }
+    block.m_Output.resize( 2 * block.m_Output.size() );
+    }
+
+  block.m_Output.resize( produced );
+  deflateEnd( &strm );
+}
+
+ITK_THREAD_RETURN_TYPE CompressThreaderCallback( void *arg )
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+  CompressThreadStruct *str = static_cast<CompressThreadStruct *>( info->UserData );
+
+  for ( size_t i = info->ThreadID; i < str->m_NumberOfBlocks; i += info->NumberOfThreads )
+    {
+    CompressBlock( (*str->m_Blocks)[i], str->m_CompressionLevel, str->m_Gzip );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void WriteUInt32( std::ostream &out, unsigned long value, bool bigEndian )
+{
+  char bytes[4];
+  for ( unsigned int i = 0; i < 4; ++i )
+    {
+    bytes[bigEndian ? 3 - i : i] = static_cast<char>( ( value >> ( 8 * i ) ) & 0xff );
+    }
+  out.write( bytes, 4 );
+}
+
+}
+
+
+ParallelDeflate::ParallelDeflate( std::ostream &out,
+                                  FormatType format,
+                                  int compressionLevel,
+                                  unsigned int numberOfThreads,
+                                  size_t blockSize )
+  : m_Output( out ),
+    m_Format( format ),
+    m_CompressionLevel( compressionLevel ),
+    m_BlockSize( blockSize ),
+    m_Blocks( std::max( 1u, numberOfThreads ) ),
+    m_CurrentBlock( 0 ),
+    m_Checksum( format == Gzip ? crc32( 0L, Z_NULL, 0 ) : adler32( 0L, Z_NULL, 0 ) ),
+    m_UncompressedSize( 0 ),
+    m_CompressedSize( 0 )
+{
+  this->WriteHeader();
+}
+
+
+void ParallelDeflate::WriteHeader( void )
+{
+  if ( m_Format == Gzip )
+    {
+    // no file name and no modification time
+    const char xfl = ( m_CompressionLevel == 9 ) ? 2 : ( ( m_CompressionLevel == 1 ) ? 4 : 0 );
+    const char header[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, xfl, '\xff' };
+    m_Output.write( header, 10 );
+    m_CompressedSize += 10;
+    }
+  else
+    {
+    // 32K window with the compression level hint, and the check bits
+    // of the header
+    char flags = '\x9c';
+    if ( m_CompressionLevel == 0 || m_CompressionLevel == 1 )
+      {
+      flags = '\x01';
+      }
+    else if ( m_CompressionLevel >= 2 && m_CompressionLevel <= 5 )
+      {
+      flags = '\x5e';
+      }
+    else if ( m_CompressionLevel >= 7 )
+      {
+      flags = '\xda';
+      }
+    const char header[2] = { '\x78', flags };
+    m_Output.write( header, 2 );
+    m_CompressedSize += 2;
+    }
+}
+
+
+void ParallelDeflate::Write( const char *data, size_t size )
+{
+  while ( size > 0 )
+    {
+    std::vector<char> &input = m_Blocks[m_CurrentBlock].m_Input;
+    const size_t n = std::min( size, m_BlockSize - input.size() );
+    input.insert( input.end(), data, data + n );
+    data += n;
+    size -= n;
+
+    if ( input.size() == m_BlockSize )
+      {
+      if ( ++m_CurrentBlock == m_Blocks.size() )
+        {
+        this->CompressBlocks( m_Blocks.size(), false );
+        m_CurrentBlock = 0;
+        }
+      }
+    }
+}
+
+
+uint64_t ParallelDeflate::Finish( void )
+{
+  this->CompressBlocks( m_CurrentBlock + 1, true );
+  m_CurrentBlock = 0;
+
+  if ( m_Format == Gzip )
+    {
+    WriteUInt32( m_Output, m_Checksum, false );
+    WriteUInt32( m_Output, static_cast<unsigned long>( m_UncompressedSize & 0xffffffffUL ), false );
+    }
+  else
+    {
+    WriteUInt32( m_Output, m_Checksum, true );
+    }
+  m_CompressedSize += ( m_Format == Gzip ) ? 8 : 4;
+
+  return m_CompressedSize;
+}
+
+
+void ParallelDeflate::CompressBlocks( size_t numberOfBlocks, bool last )
+{
+  for ( size_t i = 0; i < numberOfBlocks; ++i )
+    {
+    m_Blocks[i].m_Last = last && ( i + 1 == numberOfBlocks );
+    }
+
+  CompressThreadStruct str;
+  str.m_Blocks = &m_Blocks;
+  str.m_NumberOfBlocks = numberOfBlocks;
+  str.m_CompressionLevel = m_CompressionLevel;
+  str.m_Gzip = ( m_Format == Gzip );
+
+  if ( numberOfBlocks == 1 )
+    {
+    CompressBlock( m_Blocks[0], m_CompressionLevel, str.m_Gzip );
+    }
+  else
+    {
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfBlocks ) );
+    threader->SetSingleMethod( CompressThreaderCallback, &str );
+    threader->SingleMethodExecute();
+    }
+
+  for ( size_t i = 0; i < numberOfBlocks; ++i )
+    {
+    Block &block = m_Blocks[i];
+    if ( block.m_Status != Z_OK )
+      {
+      sitkExceptionMacro( "Compression failed with zlib error " << block.m_Status << "." );
+      }
+
+    const z_off_t length = static_cast<z_off_t>( block.m_Input.size() );
+    m_Checksum = ( m_Format == Gzip ) ? crc32_combine( m_Checksum, block.m_Checksum, length )
+      : adler32_combine( m_Checksum, block.m_Checksum, length );
+    m_UncompressedSize += block.m_Input.size();
+
+    if ( !block.m_Output.empty() )
+      {
+      m_Output.write( &block.m_Output[0], block.m_Output.size() );
+      m_CompressedSize += block.m_Output.size();
+      }
+    block.m_Input.clear();
+    block.m_Output.clear();
+    }
+
+  if ( !m_Output )
+    {
+    sitkExceptionMacro( "Error writing the compressed data." );
+    }
+}
+
+}
+}
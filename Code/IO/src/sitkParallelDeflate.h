@@ -0,0 +1,94 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkParallelDeflate_h
+#define sitkParallelDeflate_h
+
+#include "sitkMacro.h"
+#include "sitkIO.h"
+
+#include <ostream>
+#include <vector>
+
+namespace itk
+{
+namespace simple
+{
+
+/** \class ParallelDeflate
+ * \brief Compress a stream into a single zlib or gzip stream with
+ * multiple threads.
+ *
+ * The data is split into blocks which are compressed independently
+ * and concurrently. Each block but the last is ended with a sync
+ * flush, so the compressed blocks concatenate into one valid deflate
+ * stream, and the checksums of the blocks are combined. As the
+ * blocks do not share a dictionary, the compression ratio is
+ * slightly less than compressing the data as a whole.
+ */
+class SITKIO_HIDDEN ParallelDeflate
+{
+public:
+  enum FormatType { Zlib, Gzip };
+
+  /** The compression level is from 0 to 9, or -1 for the default. */
+  ParallelDeflate( std::ostream &out,
+                   FormatType format,
+                   int compressionLevel,
+                   unsigned int numberOfThreads,
+                   size_t blockSize = 128*1024 );
+
+  /** Append data to the stream. */
+  void Write( const char *data, size_t size );
+
+  /** Compress the remaining data and write the trailer, returns the
+   * number of bytes written to the output. */
+  uint64_t Finish( void );
+
+  struct Block
+  {
+    std::vector<char> m_Input;
+    std::vector<char> m_Output;
+    unsigned long     m_Checksum;
+    bool              m_Last;
+    int               m_Status;
+  };
+
+private:
+  ParallelDeflate( const ParallelDeflate & ); // purposely not implemented
+  void operator=( const ParallelDeflate & );  // purposely not implemented
+
+  void WriteHeader( void );
+  void CompressBlocks( size_t numberOfBlocks, bool last );
+
+  std::ostream      &m_Output;
+  const FormatType   m_Format;
+  const int          m_CompressionLevel;
+  const size_t       m_BlockSize;
+
+  std::vector<Block> m_Blocks;
+  size_t             m_CurrentBlock;
+
+  unsigned long      m_Checksum;
+  uint64_t           m_UncompressedSize;
+  uint64_t           m_CompressedSize;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,577 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifdef _MFC_VER
+#pragma warning(disable:4996)
+#endif
+
+#include "sitkRawFileIO.h"
+
+#include <itkImageIOBase.h>
+#include <itkByteSwapper.h>
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+namespace simple
+{
+
+namespace
+{
+
+const int32_t NiftiHeaderSize = 348;
+
+// the size of the blocks when none is given
+const uint64_t DefaultBlockSize = 1024*1024;
+
+// the alignment of the offsets, sizes and buffers of direct I/O,
+// the page size of most systems and a multiple of the block size of
+// the devices
+const uint64_t DirectIOAlignment = 4096;
+
+std::string TrimString( const std::string &s )
+{
+  const char *whitespace = " \t\r\n";
+  const std::string::size_type b = s.find_first_not_of( whitespace );
+  if ( b == std::string::npos )
+    {
+    return std::string();
+    }
+  const std::string::size_type e = s.find_last_not_of( whitespace );
+  return s.substr( b, e - b + 1 );
+}
+
+bool IsNativeByteOrderMSB( const std::string &value )
+{
+  const bool msb = ( value == "True" || value == "true" || value == "1" );
+  return msb == itk::ByteSwapper<int>::SystemIsBigEndian();
+}
+
+std::string GetDataFilePath( const std::string &headerFileName, const std::string &dataFileName )
+{
+  if ( itksys::SystemTools::FileIsFullPath( dataFileName.c_str() ) )
+    {
+    return dataFileName;
+    }
+  const std::string path = itksys::SystemTools::GetFilenamePath( headerFileName );
+  return path.empty() ? dataFileName : path + "/" + dataFileName;
+}
+
+}
+
+bool GetRawPixelDataLocation( const std::string &fileName,
+                              const itk::ImageIOBase *imageio,
+                              std::string &dataFileName,
+                              int64_t &offset )
+{
+  std::ifstream header( fileName.c_str(), std::ios::in | std::ios::binary );
+  if ( !header )
+    {
+    return false;
+    }
+
+  const std::string ioName = imageio->GetNameOfClass();
+  std::string line;
+
+  if ( ioName == "MetaImageIO" )
+    {
+    int64_t headerSize = 0;
+    while ( std::getline( header, line ) )
+      {
+      const std::string::size_type eq = line.find( '=' );
+      if ( eq == std::string::npos )
+        {
+        continue;
+        }
+      const std::string key = TrimString( line.substr( 0, eq ) );
+      const std::string value = TrimString( line.substr( eq + 1 ) );
+
+      if ( key == "CompressedData" )
+        {
+        if ( value == "True" || value == "true" )
+          {
+          return false;
+          }
+        }
+      else if ( key == "BinaryDataByteOrderMSB" || key == "ElementByteOrderMSB" )
+        {
+        if ( !IsNativeByteOrderMSB( value ) )
+          {
+          return false;
+          }
+        }
+      else if ( key == "HeaderSize" )
+        {
+        headerSize = atol( value.c_str() );
+        }
+      else if ( key == "ElementDataFile" )
+        {
+        if ( value == "LOCAL" || value == "Local" || value == "local" )
+          {
+          dataFileName = fileName;
+          offset = static_cast<int64_t>( header.tellg() );
+          return offset > 0;
+          }
+        // lists of files and file name patterns are not supported
+        if ( value.empty() || value == "LIST" || value.find( ' ' ) != std::string::npos )
+          {
+          return false;
+          }
+        dataFileName = GetDataFilePath( fileName, value );
+        offset = headerSize;
+        return true;
+        }
+      }
+    return false;
+    }
+  else if ( ioName == "NrrdImageIO" )
+    {
+    if ( !std::getline( header, line ) || line.compare( 0, 4, "NRRD" ) != 0 )
+      {
+      return false;
+      }
+
+    bool raw = false;
+    std::string dataFile;
+    offset = 0;
+    while ( std::getline( header, line ) )
+      {
+      line = TrimString( line );
+      if ( line.empty() )
+        {
+        break;
+        }
+      if ( line[0] == '#' || line.find( ":=" ) != std::string::npos )
+        {
+        continue;
+        }
+      const std::string::size_type colon = line.find( ':' );
+      if ( colon == std::string::npos )
+        {
+        continue;
+        }
+      const std::string key = TrimString( line.substr( 0, colon ) );
+      const std::string value = TrimString( line.substr( colon + 1 ) );
+
+      if ( key == "encoding" )
+        {
+        raw = ( value == "raw" );
+        }
+      else if ( key == "endian" )
+        {
+        if ( ( value == "big" ) != itk::ByteSwapper<int>::SystemIsBigEndian() )
+          {
+          return false;
+          }
+        }
+      else if ( key == "line skip" || key == "lineskip" )
+        {
+        if ( atol( value.c_str() ) != 0 )
+          {
+          return false;
+          }
+        }
+      else if ( key == "byte skip" || key == "byteskip" )
+        {
+        offset = atol( value.c_str() );
+        if ( offset < -1 )
+          {
+          return false;
+          }
+        }
+      else if ( key == "data file" || key == "datafile" )
+        {
+        // lists of files and file name patterns are not supported
+        if ( value.empty() || value.compare( 0, 4, "LIST" ) == 0 || value.find( ' ' ) != std::string::npos )
+          {
+          return false;
+          }
+        dataFile = value;
+        }
+      }
+
+    if ( !raw )
+      {
+      return false;
+      }
+
+    if ( dataFile.empty() )
+      {
+      if ( !header )
+        {
+        return false;
+        }
+      dataFileName = fileName;
+      if ( offset != -1 )
+        {
+        offset += static_cast<int64_t>( header.tellg() );
+        }
+      }
+    else
+      {
+      dataFileName = GetDataFilePath( fileName, dataFile );
+      }
+    return true;
+    }
+  else if ( ioName == "NiftiImageIO" )
+    {
+    // the header of a single file NIfTI-1 image, in the native byte
+    // order when its size is read as 348
+    char nifti[NiftiHeaderSize];
+    if ( !header.read( nifti, NiftiHeaderSize ) )
+      {
+      return false;
+      }
+    int32_t headerSize;
+    float voxelOffset;
+    float slope;
+    float intercept;
+    memcpy( &headerSize, nifti, sizeof( headerSize ) );
+    memcpy( &voxelOffset, nifti + 108, sizeof( voxelOffset ) );
+    memcpy( &slope, nifti + 112, sizeof( slope ) );
+    memcpy( &intercept, nifti + 116, sizeof( intercept ) );
+    if ( headerSize != NiftiHeaderSize || memcmp( nifti + 344, "n+1", 4 ) != 0 )
+      {
+      return false;
+      }
+    // the ImageIO rescales the pixels of a scaled file, and stores
+    // the components of vectors in separate volumes
+    if ( ( slope != 0.0f && slope != 1.0f ) || intercept != 0.0f
+         || imageio->GetNumberOfComponents() != 1
+         || voxelOffset < static_cast<float>( NiftiHeaderSize ) )
+      {
+      return false;
+      }
+    dataFileName = fileName;
+    offset = static_cast<int64_t>( voxelOffset );
+    return true;
+    }
+  return false;
+}
+
+#ifdef _WIN32
+
+void ReadFileBlocks( const std::string &fileName,
+                     uint64_t offset,
+                     uint64_t numberOfBytes,
+                     void *buffer,
+                     uint64_t blockSize,
+                     bool )
+{
+  std::ifstream in( fileName.c_str(), std::ios::in | std::ios::binary );
+  if ( !in || !in.seekg( static_cast<std::streamoff>( offset ) ) )
+    {
+    sitkExceptionMacro( "Unable to open \"" << fileName << "\" for reading." );
+    }
+  if ( blockSize == 0 )
+    {
+    blockSize = DefaultBlockSize;
+    }
+  char *p = static_cast<char *>( buffer );
+  for ( uint64_t done = 0; done < numberOfBytes; )
+    {
+    const uint64_t n = std::min( blockSize, numberOfBytes - done );
+    if ( !in.read( p + done, static_cast<std::streamsize>( n ) ) )
+      {
+      sitkExceptionMacro( "Error reading " << numberOfBytes << " bytes at offset " << offset
+                          << " of \"" << fileName << "\"." );
+      }
+    done += n;
+    }
+}
+
+void WriteFileBlocks( const std::string &fileName,
+                      uint64_t offset,
+                      const void *data,
+                      uint64_t numberOfBytes,
+                      uint64_t blockSize,
+                      bool )
+{
+  std::fstream out( fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary );
+  if ( !out || !out.seekp( static_cast<std::streamoff>( offset ) ) )
+    {
+    sitkExceptionMacro( "Unable to open \"" << fileName << "\" for writing." );
+    }
+  if ( blockSize == 0 )
+    {
+    blockSize = DefaultBlockSize;
+    }
+  const char *p = static_cast<const char *>( data );
+  for ( uint64_t done = 0; done < numberOfBytes; )
+    {
+    const uint64_t n = std::min( blockSize, numberOfBytes - done );
+    if ( !out.write( p + done, static_cast<std::streamsize>( n ) ) )
+      {
+      sitkExceptionMacro( "Error writing \"" << fileName << "\"." );
+      }
+    done += n;
+    }
+}
+
+void DropFileFromPageCache( const std::string & )
+{
+}
+
+#else
+
+namespace
+{
+
+/** Read or write all the bytes with the positioned system calls,
+ * which may transfer fewer bytes than requested. */
+bool ReadAll( int fd, char *p, uint64_t n, uint64_t offset )
+{
+  while ( n > 0 )
+    {
+    const ssize_t r = pread( fd, p, static_cast<size_t>( n ), static_cast<off_t>( offset ) );
+    if ( r < 0 && errno == EINTR )
+      {
+      continue;
+      }
+    if ( r <= 0 )
+      {
+      return false;
+      }
+    p += r;
+    n -= static_cast<uint64_t>( r );
+    offset += static_cast<uint64_t>( r );
+    }
+  return true;
+}
+
+bool WriteAll( int fd, const char *p, uint64_t n, uint64_t offset )
+{
+  while ( n > 0 )
+    {
+    const ssize_t r = pwrite( fd, p, static_cast<size_t>( n ), static_cast<off_t>( offset ) );
+    if ( r < 0 && errno == EINTR )
+      {
+      continue;
+      }
+    if ( r <= 0 )
+      {
+      return false;
+      }
+    p += r;
+    n -= static_cast<uint64_t>( r );
+    offset += static_cast<uint64_t>( r );
+    }
+  return true;
+}
+
+void AdviseFile( int fd, uint64_t offset, uint64_t numberOfBytes, int advice )
+{
+#if defined(POSIX_FADV_NORMAL)
+  posix_fadvise( fd, static_cast<off_t>( offset ), static_cast<off_t>( numberOfBytes ), advice );
+#else
+  (void)fd; (void)offset; (void)numberOfBytes; (void)advice;
+#endif
+}
+
+#if defined(POSIX_FADV_DONTNEED)
+const int AdviceSequential = POSIX_FADV_SEQUENTIAL;
+const int AdviceDontNeed = POSIX_FADV_DONTNEED;
+#else
+const int AdviceSequential = 0;
+const int AdviceDontNeed = 0;
+#endif
+
+/** Write the bytes of the whole aligned blocks with a descriptor
+ * opened for direct I/O, copied to an aligned buffer. Returns false
+ * when the file system does not support direct I/O, before anything
+ * is written. */
+bool WriteDirect( const std::string &fileName,
+                  uint64_t offset,
+                  const char *data,
+                  uint64_t numberOfBytes,
+                  uint64_t blockSize )
+{
+#if defined(O_DIRECT)
+  const int fd = open( fileName.c_str(), O_WRONLY | O_DIRECT );
+#elif defined(F_NOCACHE)
+  const int fd = open( fileName.c_str(), O_WRONLY );
+  if ( fd >= 0 && fcntl( fd, F_NOCACHE, 1 ) != 0 )
+    {
+    close( fd );
+    return false;
+    }
+#else
+  const int fd = -1;
+#endif
+  if ( fd < 0 )
+    {
+    return false;
+    }
+
+  blockSize = std::max( DirectIOAlignment, blockSize - blockSize % DirectIOAlignment );
+  void *block = SITK_NULLPTR;
+  if ( posix_memalign( &block, static_cast<size_t>( DirectIOAlignment ), static_cast<size_t>( blockSize ) ) != 0 )
+    {
+    close( fd );
+    return false;
+    }
+
+  for ( uint64_t done = 0; done < numberOfBytes; )
+    {
+    const uint64_t n = std::min( blockSize, numberOfBytes - done );
+    memcpy( block, data + done, static_cast<size_t>( n ) );
+    if ( !WriteAll( fd, static_cast<const char *>( block ), n, offset + done ) )
+      {
+      const int error = errno;
+      free( block );
+      close( fd );
+      // a file system without direct I/O fails the first write
+      if ( done == 0 && error == EINVAL )
+        {
+        return false;
+        }
+      sitkExceptionMacro( "Error writing \"" << fileName << "\": " << strerror( error ) );
+      }
+    done += n;
+    }
+
+  free( block );
+  close( fd );
+  return true;
+}
+
+}
+
+void ReadFileBlocks( const std::string &fileName,
+                     uint64_t offset,
+                     uint64_t numberOfBytes,
+                     void *buffer,
+                     uint64_t blockSize,
+                     bool sequential )
+{
+  const int fd = open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    {
+    sitkExceptionMacro( "Unable to open \"" << fileName << "\" for reading." );
+    }
+  if ( sequential )
+    {
+    // enlarges the read ahead of the file
+    AdviseFile( fd, offset, numberOfBytes, AdviceSequential );
+    }
+  if ( blockSize == 0 )
+    {
+    blockSize = DefaultBlockSize;
+    }
+
+  char *p = static_cast<char *>( buffer );
+  for ( uint64_t done = 0; done < numberOfBytes; )
+    {
+    const uint64_t n = std::min( blockSize, numberOfBytes - done );
+    if ( !ReadAll( fd, p + done, n, offset + done ) )
+      {
+      close( fd );
+      sitkExceptionMacro( "Error reading " << numberOfBytes << " bytes at offset " << offset
+                          << " of \"" << fileName << "\"." );
+      }
+    done += n;
+    }
+  close( fd );
+}
+
+void WriteFileBlocks( const std::string &fileName,
+                      uint64_t offset,
+                      const void *data,
+                      uint64_t numberOfBytes,
+                      uint64_t blockSize,
+                      bool directIO )
+{
+  if ( blockSize == 0 )
+    {
+    blockSize = DefaultBlockSize;
+    }
+  const char *p = static_cast<const char *>( data );
+
+  // only the whole aligned blocks of the file are written directly,
+  // the bytes before and after them through the page cache
+  uint64_t directBegin = offset;
+  uint64_t directEnd = offset;
+  if ( directIO )
+    {
+    directBegin = std::min( offset + numberOfBytes, ( offset + DirectIOAlignment - 1 ) / DirectIOAlignment * DirectIOAlignment );
+    directEnd = std::max( directBegin, ( offset + numberOfBytes ) / DirectIOAlignment * DirectIOAlignment );
+    if ( directEnd > directBegin
+         && !WriteDirect( fileName, directBegin, p + ( directBegin - offset ), directEnd - directBegin, blockSize ) )
+      {
+      directBegin = directEnd = offset;
+      }
+    }
+
+  const int fd = open( fileName.c_str(), O_WRONLY );
+  if ( fd < 0 )
+    {
+    sitkExceptionMacro( "Unable to open \"" << fileName << "\" for writing." );
+    }
+  for ( uint64_t done = 0; done < numberOfBytes; )
+    {
+    if ( offset + done == directBegin && directEnd > directBegin )
+      {
+      done = directEnd - offset;
+      continue;
+      }
+    uint64_t n = std::min( blockSize, numberOfBytes - done );
+    if ( offset + done < directBegin )
+      {
+      n = std::min( n, directBegin - offset - done );
+      }
+    if ( !WriteAll( fd, p + done, n, offset + done ) )
+      {
+      const int error = errno;
+      close( fd );
+      sitkExceptionMacro( "Error writing \"" << fileName << "\": " << strerror( error ) );
+      }
+    done += n;
+    }
+  close( fd );
+}
+
+void DropFileFromPageCache( const std::string &fileName )
+{
+  const int fd = open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    {
+    return;
+    }
+  // dirty pages are not dropped, they are written first
+  fsync( fd );
+  AdviseFile( fd, 0, 0, AdviceDontNeed );
+  close( fd );
+}
+
+#endif
+
+}
+}
@@ -0,0 +1,80 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkRawFileIO_h
+#define sitkRawFileIO_h
+
+#include "sitkMacro.h"
+#include "sitkIO.h"
+
+#include <string>
+
+namespace itk
+{
+
+class ImageIOBase;
+
+namespace simple
+{
+
+/** Parse the header of a MetaImage, NRRD or single file NIfTI image
+ * to find the file and the offset of the raw pixel data. An offset
+ * of -1 is the data at the end of the file. Returns false when the
+ * pixel data is compressed, split across files, scaled or not in the
+ * native byte order.
+ */
+SITKIO_HIDDEN bool GetRawPixelDataLocation( const std::string &fileName,
+                                            const itk::ImageIOBase *imageio,
+                                            std::string &dataFileName,
+                                            int64_t &offset );
+
+/** Read numberOfBytes of a file at an offset into a buffer, with
+ * reads of blockSize bytes, 1 MiB when 0. When sequential, the system
+ * is advised that the file is read sequentially, which enlarges its
+ * read ahead. An exception is thrown when the bytes can not be read.
+ */
+SITKIO_HIDDEN void ReadFileBlocks( const std::string &fileName,
+                                   uint64_t offset,
+                                   uint64_t numberOfBytes,
+                                   void *buffer,
+                                   uint64_t blockSize,
+                                   bool sequential );
+
+/** Write numberOfBytes at an offset of an existing file, with writes
+ * of blockSize bytes, 1 MiB when 0. With directIO, the blocks
+ * aligned to 4096 bytes in the file are written with O_DIRECT, or
+ * F_NOCACHE on macOS, bypassing the page cache, and the bytes before
+ * and after them are written normally. The file is written normally
+ * when its file system does not support direct I/O.
+ */
+SITKIO_HIDDEN void WriteFileBlocks( const std::string &fileName,
+                                    uint64_t offset,
+                                    const void *data,
+                                    uint64_t numberOfBytes,
+                                    uint64_t blockSize,
+                                    bool directIO );
+
+/** Write the modified pages of a file and advise the system that
+ * they are not needed, so they are dropped from the page cache. Does
+ * nothing when the file can not be opened or without posix_fadvise.
+ */
+SITKIO_HIDDEN void DropFileFromPageCache( const std::string &fileName );
+
+}
+}
+
+#endif
@@ -0,0 +1,536 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkRemoteFile.h"
+#include "sitkRawFileIO.h"
+
+#include "nsstd/auto_ptr.h"
+
+#include <itkSimpleFastMutexLock.h>
+#include <itksys/SystemTools.hxx>
+
+#ifdef SITK_HAS_CURL
+#include <curl/curl.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+namespace simple
+{
+
+namespace
+{
+
+// the largest range of one request
+const uint64_t RemoteRequestSize = 8*1024*1024;
+
+// the number of attempts of a request which fails
+const unsigned int RemoteRequestAttempts = 3;
+
+itk::SimpleFastMutexLock RemoteFileMutex;
+unsigned int             RemoteFileCounter = 0;
+
+bool StartsWith( const std::string &s, const char *prefix )
+{
+  return s.compare( 0, strlen( prefix ), prefix ) == 0;
+}
+
+std::string GetEnvironment( const char *name, const char *defaultValue = "" )
+{
+  const char *value = getenv( name );
+  return ( value != SITK_NULLPTR && *value != '\0' ) ? std::string( value ) : std::string( defaultValue );
+}
+
+/** The URL without its query and fragment. */
+std::string GetURLPath( const std::string &url )
+{
+  return url.substr( 0, url.find_first_of( "?#" ) );
+}
+
+/** The https URL of an s3:// URL, and the region of its signature. */
+std::string GetS3URL( const std::string &url, std::string &region )
+{
+  const std::string path = url.substr( 5 );
+  const std::string::size_type slash = path.find( '/' );
+  if ( slash == std::string::npos || slash == 0 || slash + 1 == path.size() )
+    {
+    sitkExceptionMacro( "The S3 URL \"" << url << "\" is not of the form s3://bucket/key." );
+    }
+  const std::string bucket = path.substr( 0, slash );
+  const std::string key = path.substr( slash + 1 );
+
+  region = GetEnvironment( "AWS_REGION", "us-east-1" );
+  std::string endpoint = GetEnvironment( "AWS_ENDPOINT_URL" );
+  if ( !endpoint.empty() )
+    {
+    // a path style URL for S3 compatible object stores
+    while ( !endpoint.empty() && endpoint[endpoint.size() - 1] == '/' )
+      {
+      endpoint.erase( endpoint.size() - 1 );
+      }
+    return endpoint + "/" + bucket + "/" + key;
+    }
+  return "https://" + bucket + ".s3." + region + ".amazonaws.com/" + key;
+}
+
+std::string CreateTemporaryDirectory( void )
+{
+#ifdef _WIN32
+  std::string base = GetEnvironment( "TEMP", "." );
+  const int pid = _getpid();
+#else
+  std::string base = GetEnvironment( "TMPDIR", "/tmp" );
+  const int pid = static_cast<int>( getpid() );
+#endif
+
+  RemoteFileMutex.Lock();
+  for ( unsigned int attempt = 0; attempt < 100; ++attempt )
+    {
+    std::ostringstream name;
+    name << base << "/sitk-remote-" << pid << "-" << std::time( SITK_NULLPTR ) << "-" << RemoteFileCounter++;
+    const std::string directory = name.str();
+    if ( !itksys::SystemTools::FileExists( directory.c_str() )
+         && itksys::SystemTools::MakeDirectory( directory.c_str() ) )
+      {
+      RemoteFileMutex.Unlock();
+      return directory;
+      }
+    }
+  RemoteFileMutex.Unlock();
+  sitkExceptionMacro( "Unable to create a temporary directory in \"" << base << "\" for a remote file." );
+}
+
+#ifdef SITK_HAS_CURL
+
+void InitializeCurl( void )
+{
+  static bool initialized = false;
+  RemoteFileMutex.Lock();
+  if ( !initialized )
+    {
+    curl_global_init( CURL_GLOBAL_DEFAULT );
+    initialized = true;
+    }
+  RemoteFileMutex.Unlock();
+}
+
+/** An easy handle of a request of a remote file, with its
+ * headers. */
+struct RemoteRequest
+{
+  RemoteRequest( const std::string &url, const std::string &s3Region )
+    : m_Handle( curl_easy_init() ),
+      m_Headers( SITK_NULLPTR ),
+      m_Offset( 0 ),
+      m_Length( 0 ),
+      m_Attempts( 0 )
+    {
+      if ( m_Handle == SITK_NULLPTR )
+        {
+        sitkExceptionMacro( "Unable to create a request for \"" << url << "\"." );
+        }
+      curl_easy_setopt( m_Handle, CURLOPT_URL, url.c_str() );
+      curl_easy_setopt( m_Handle, CURLOPT_FOLLOWLOCATION, 1L );
+      curl_easy_setopt( m_Handle, CURLOPT_NOSIGNAL, 1L );
+      curl_easy_setopt( m_Handle, CURLOPT_USERAGENT, "SimpleITK" );
+      curl_easy_setopt( m_Handle, CURLOPT_PRIVATE, this );
+
+      const std::string accessKey = GetEnvironment( "AWS_ACCESS_KEY_ID" );
+      const std::string secretKey = GetEnvironment( "AWS_SECRET_ACCESS_KEY" );
+      if ( !s3Region.empty() && !accessKey.empty() && !secretKey.empty() )
+        {
+#if LIBCURL_VERSION_NUM >= 0x074B00
+        const std::string userPassword = accessKey + ":" + secretKey;
+        const std::string provider = "aws:amz:" + s3Region + ":s3";
+        curl_easy_setopt( m_Handle, CURLOPT_USERPWD, userPassword.c_str() );
+        curl_easy_setopt( m_Handle, CURLOPT_AWS_SIGV4, provider.c_str() );
+        const std::string sessionToken = GetEnvironment( "AWS_SESSION_TOKEN" );
+        if ( !sessionToken.empty() )
+          {
+          m_Headers = curl_slist_append( m_Headers, ( "x-amz-security-token: " + sessionToken ).c_str() );
+          curl_easy_setopt( m_Handle, CURLOPT_HTTPHEADER, m_Headers );
+          }
+#else
+        curl_easy_cleanup( m_Handle );
+        sitkExceptionMacro( "Signed S3 requests require libcurl 7.75 or later, SimpleITK is built with libcurl "
+                            << LIBCURL_VERSION << "." );
+#endif
+        }
+    }
+
+  ~RemoteRequest()
+    {
+      curl_easy_cleanup( m_Handle );
+      curl_slist_free_all( m_Headers );
+    }
+
+  /** Request a range of the object, received into the data. */
+  void SetRange( uint64_t offset, uint64_t length )
+    {
+      m_Offset = offset;
+      m_Length = length;
+      m_Data.clear();
+      m_Data.reserve( static_cast<size_t>( length ) );
+      std::ostringstream range;
+      range << offset << "-" << offset + length - 1;
+      m_Range = range.str();
+      curl_easy_setopt( m_Handle, CURLOPT_RANGE, m_Range.c_str() );
+      curl_easy_setopt( m_Handle, CURLOPT_WRITEFUNCTION, &RemoteRequest::WriteCallback );
+      curl_easy_setopt( m_Handle, CURLOPT_WRITEDATA, this );
+    }
+
+  static size_t WriteCallback( char *data, size_t size, size_t count, void *userData )
+    {
+      RemoteRequest *request = static_cast<RemoteRequest *>( userData );
+      const size_t n = size * count;
+      // a response larger than the range is not a range response
+      if ( request->m_Data.size() + n > request->m_Length )
+        {
+        return 0;
+        }
+      request->m_Data.insert( request->m_Data.end(), data, data + n );
+      return n;
+    }
+
+  long GetResponseCode( void ) const
+    {
+      long code = 0;
+      curl_easy_getinfo( m_Handle, CURLINFO_RESPONSE_CODE, &code );
+      return code;
+    }
+
+  CURL              *m_Handle;
+  curl_slist        *m_Headers;
+  uint64_t           m_Offset;
+  uint64_t           m_Length;
+  std::string        m_Range;
+  std::vector<char>  m_Data;
+  unsigned int       m_Attempts;
+
+private:
+  RemoteRequest( const RemoteRequest & ); // purposely not implemented
+  void operator=( const RemoteRequest & ); // purposely not implemented
+};
+
+uint64_t GetRemoteSize( const std::string &url, const std::string &s3Region )
+{
+  InitializeCurl();
+
+  RemoteRequest request( url, s3Region );
+  curl_easy_setopt( request.m_Handle, CURLOPT_NOBODY, 1L );
+  const CURLcode result = curl_easy_perform( request.m_Handle );
+  if ( result != CURLE_OK )
+    {
+    sitkExceptionMacro( "Unable to request \"" << url << "\": " << curl_easy_strerror( result ) );
+    }
+  const long code = request.GetResponseCode();
+  if ( code != 200 )
+    {
+    sitkExceptionMacro( "Unable to request \"" << url << "\", the server responded with HTTP status " << code << "." );
+    }
+
+#if LIBCURL_VERSION_NUM >= 0x073700
+  curl_off_t length = -1;
+  curl_easy_getinfo( request.m_Handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length );
+#else
+  double length = -1.0;
+  curl_easy_getinfo( request.m_Handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length );
+#endif
+  if ( length < 0 )
+    {
+    sitkExceptionMacro( "The server did not report the size of \"" << url << "\"." );
+    }
+  return static_cast<uint64_t>( length );
+}
+
+/** Removes the requests from the multi handle and deletes them. */
+struct RemoteRequestSet
+{
+  RemoteRequestSet() : m_Multi( curl_multi_init() ) {}
+  ~RemoteRequestSet()
+    {
+      for ( size_t i = 0; i < m_Requests.size(); ++i )
+        {
+        curl_multi_remove_handle( m_Multi, m_Requests[i]->m_Handle );
+        delete m_Requests[i];
+        }
+      curl_multi_cleanup( m_Multi );
+    }
+
+  CURLM                        *m_Multi;
+  std::vector<RemoteRequest *>  m_Requests;
+};
+
+#else
+
+uint64_t GetRemoteSize( const std::string &url, const std::string & )
+{
+  sitkExceptionMacro( "Unable to read the remote file \"" << url
+                      << "\", SimpleITK is built without remote file support (SimpleITK_USE_CURL)." );
+}
+
+#endif
+
+}
+
+
+bool RemoteFile::IsRemoteFileName( const std::string &fileName )
+{
+  return StartsWith( fileName, "http://" ) || StartsWith( fileName, "https://" ) || StartsWith( fileName, "s3://" );
+}
+
+
+RemoteFile::RemoteFile( const std::string &url, unsigned int numberOfConnections )
+  : m_OwnsLocalDirectory( true ),
+    m_Size( 0 ),
+    m_NumberOfConnections( std::max( 1u, numberOfConnections ) )
+{
+  m_URL = StartsWith( url, "s3://" ) ? GetS3URL( url, m_S3Region ) : url;
+  m_Size = GetRemoteSize( m_URL, m_S3Region );
+
+  std::string name = itksys::SystemTools::GetFilenameName( GetURLPath( m_URL ) );
+  if ( name.empty() )
+    {
+    name = "object";
+    }
+  m_LocalDirectory = CreateTemporaryDirectory();
+  m_LocalFileName = m_LocalDirectory + "/" + name;
+  this->CreateLocalCopy();
+}
+
+
+RemoteFile::RemoteFile( const RemoteFile &parent, const std::string &relativePath )
+  : m_S3Region( parent.m_S3Region ),
+    m_LocalDirectory( parent.m_LocalDirectory ),
+    m_OwnsLocalDirectory( false ),
+    m_Size( 0 ),
+    m_NumberOfConnections( parent.m_NumberOfConnections )
+{
+  if ( relativePath.empty()
+       || itksys::SystemTools::FileIsFullPath( relativePath.c_str() )
+       || relativePath.find( ".." ) != std::string::npos )
+    {
+    sitkExceptionMacro( "The data file \"" << relativePath << "\" of the remote file \"" << parent.m_URL
+                        << "\" is not a relative path in its directory." );
+    }
+
+  const std::string parentPath = GetURLPath( parent.m_URL );
+  m_URL = parentPath.substr( 0, parentPath.rfind( '/' ) + 1 ) + relativePath;
+  m_Size = GetRemoteSize( m_URL, m_S3Region );
+
+  m_LocalFileName = m_LocalDirectory + "/" + relativePath;
+  itksys::SystemTools::MakeDirectory( itksys::SystemTools::GetFilenamePath( m_LocalFileName ).c_str() );
+  this->CreateLocalCopy();
+}
+
+
+RemoteFile::~RemoteFile()
+{
+  if ( m_OwnsLocalDirectory )
+    {
+    itksys::SystemTools::RemoveADirectory( m_LocalDirectory.c_str() );
+    }
+  else
+    {
+    itksys::SystemTools::RemoveFile( m_LocalFileName.c_str() );
+    }
+}
+
+
+void RemoteFile::CreateLocalCopy( void )
+{
+  // an empty file of the size of the object, which is sparse on
+  // most file systems
+  std::ofstream out( m_LocalFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+  if ( m_Size > 0 )
+    {
+    out.seekp( static_cast<std::streamoff>( m_Size - 1 ) );
+    out.put( '\0' );
+    }
+  if ( !out )
+    {
+    sitkExceptionMacro( "Unable to create the local copy \"" << m_LocalFileName << "\" of \"" << m_URL << "\"." );
+    }
+}
+
+
+void RemoteFile::Fetch( uint64_t offset, uint64_t length )
+{
+  this->Fetch( std::vector<uint64_t>( 1, offset ), std::vector<uint64_t>( 1, length ) );
+}
+
+
+void RemoteFile::Fetch( const std::vector<uint64_t> &offsets, const std::vector<uint64_t> &lengths )
+{
+  typedef std::pair<uint64_t, uint64_t> RangeType;
+
+  // the requested ranges, sorted and merged
+  std::vector<RangeType> requested;
+  for ( size_t i = 0; i < offsets.size() && i < lengths.size(); ++i )
+    {
+    const uint64_t begin = std::min( offsets[i], m_Size );
+    const uint64_t end = std::min( offsets[i] + lengths[i], m_Size );
+    if ( end > begin )
+      {
+      requested.push_back( RangeType( begin, end ) );
+      }
+    }
+  std::sort( requested.begin(), requested.end() );
+  std::vector<RangeType> merged;
+  for ( size_t i = 0; i < requested.size(); ++i )
+    {
+    if ( !merged.empty() && requested[i].first <= merged.back().second )
+      {
+      merged.back().second = std::max( merged.back().second, requested[i].second );
+      }
+    else
+      {
+      merged.push_back( requested[i] );
+      }
+    }
+  requested.swap( merged );
+
+  // the parts of the requested ranges which are not fetched, split
+  // into the ranges of the requests
+  std::vector<RangeType> missing;
+  for ( size_t i = 0; i < requested.size(); ++i )
+    {
+    uint64_t begin = requested[i].first;
+    const uint64_t end = requested[i].second;
+    for ( size_t f = 0; f < m_Fetched.size() && begin < end; ++f )
+      {
+      if ( m_Fetched[f].second <= begin || m_Fetched[f].first >= end )
+        {
+        continue;
+        }
+      for ( uint64_t b = begin; b < m_Fetched[f].first; b += RemoteRequestSize )
+        {
+        missing.push_back( RangeType( b, std::min( b + RemoteRequestSize, m_Fetched[f].first ) ) );
+        }
+      begin = std::max( begin, m_Fetched[f].second );
+      }
+    for ( uint64_t b = begin; b < end; b += RemoteRequestSize )
+      {
+      missing.push_back( RangeType( b, std::min( b + RemoteRequestSize, end ) ) );
+      }
+    }
+  if ( missing.empty() )
+    {
+    return;
+    }
+
+#ifdef SITK_HAS_CURL
+  RemoteRequestSet requests;
+  std::deque<RangeType> queue( missing.begin(), missing.end() );
+  std::deque<unsigned int> queueAttempts( missing.size(), 0u );
+  int running = 0;
+  while ( !queue.empty() || running > 0 )
+    {
+    while ( !queue.empty() && requests.m_Requests.size() < m_NumberOfConnections )
+      {
+      RemoteRequest *request = new RemoteRequest( m_URL, m_S3Region );
+      requests.m_Requests.push_back( request );
+      request->SetRange( queue.front().first, queue.front().second - queue.front().first );
+      request->m_Attempts = queueAttempts.front();
+      queue.pop_front();
+      queueAttempts.pop_front();
+      curl_multi_add_handle( requests.m_Multi, request->m_Handle );
+      }
+
+    curl_multi_perform( requests.m_Multi, &running );
+
+    int remaining = 0;
+    while ( CURLMsg *message = curl_multi_info_read( requests.m_Multi, &remaining ) )
+      {
+      if ( message->msg != CURLMSG_DONE )
+        {
+        continue;
+        }
+      RemoteRequest *request = SITK_NULLPTR;
+      curl_easy_getinfo( message->easy_handle, CURLINFO_PRIVATE, &request );
+      const CURLcode result = message->data.result;
+      const long code = request->GetResponseCode();
+      const bool received = ( result == CURLE_OK
+                              && ( code == 206 || ( code == 200 && request->m_Length == m_Size ) )
+                              && request->m_Data.size() == request->m_Length );
+
+      curl_multi_remove_handle( requests.m_Multi, request->m_Handle );
+      requests.m_Requests.erase( std::find( requests.m_Requests.begin(), requests.m_Requests.end(), request ) );
+      nsstd::auto_ptr<RemoteRequest> done( request );
+
+      if ( received )
+        {
+        WriteFileBlocks( m_LocalFileName, request->m_Offset, &request->m_Data[0], request->m_Length, 0, false );
+        m_Fetched.push_back( RangeType( request->m_Offset, request->m_Offset + request->m_Length ) );
+        }
+      else if ( request->m_Attempts + 1 < RemoteRequestAttempts && code != 200 && ( code < 400 || code >= 500 ) )
+        {
+        queue.push_back( RangeType( request->m_Offset, request->m_Offset + request->m_Length ) );
+        queueAttempts.push_back( request->m_Attempts + 1 );
+        }
+      else if ( code == 200 )
+        {
+        sitkExceptionMacro( "The server of \"" << m_URL << "\" does not support range requests." );
+        }
+      else
+        {
+        sitkExceptionMacro( "Unable to read bytes " << request->m_Range << " of \"" << m_URL << "\": "
+                            << ( result != CURLE_OK ? curl_easy_strerror( result ) : "HTTP status" )
+                            << " " << code << "." );
+        }
+      }
+
+    if ( running > 0 )
+      {
+      curl_multi_wait( requests.m_Multi, SITK_NULLPTR, 0, 1000, SITK_NULLPTR );
+      }
+    }
+#endif
+
+  // merge the fetched ranges
+  std::sort( m_Fetched.begin(), m_Fetched.end() );
+  merged.clear();
+  for ( size_t f = 0; f < m_Fetched.size(); ++f )
+    {
+    if ( !merged.empty() && m_Fetched[f].first <= merged.back().second )
+      {
+      merged.back().second = std::max( merged.back().second, m_Fetched[f].second );
+      }
+    else
+      {
+      merged.push_back( m_Fetched[f] );
+      }
+    }
+  m_Fetched.swap( merged );
+}
+
+}
+}
@@ -0,0 +1,106 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkRemoteFile_h
+#define sitkRemoteFile_h
+
+#include "sitkMacro.h"
+#include "sitkIO.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+namespace simple
+{
+
+/** \class RemoteFile
+ * \brief A local sparse copy of a remote object, filled with HTTP
+ * range requests
+ *
+ * The URL is an "http://", "https://" or "s3://" URL. The local copy
+ * has the size of the remote object and the file name of the last
+ * component of its path, in a new temporary directory. Only the byte
+ * ranges fetched are downloaded, with up to NumberOfConnections
+ * concurrent requests of at most 8 MiB, and each byte is fetched at
+ * most once. The local copy and its directory are removed when the
+ * object is destroyed.
+ *
+ * An "s3://bucket/key" URL is requested from the endpoint of the
+ * AWS_ENDPOINT_URL environment variable as "endpoint/bucket/key", or
+ * else from "https://bucket.s3.region.amazonaws.com/key" with the
+ * region of AWS_REGION, "us-east-1" by default. With the
+ * AWS_ACCESS_KEY_ID and AWS_SECRET_ACCESS_KEY environment variables,
+ * and AWS_SESSION_TOKEN for temporary credentials, the requests are
+ * signed with AWS signature version 4, which requires libcurl 7.75.
+ *
+ * Remote files require SimpleITK built with SimpleITK_USE_CURL,
+ * otherwise the constructor throws an exception.
+ */
+class SITKIO_HIDDEN RemoteFile
+{
+public:
+  /** Returns true for the URLs of remote files. */
+  static bool IsRemoteFileName( const std::string &fileName );
+
+  /** Request the size of the remote object and create its empty
+   * local copy. */
+  RemoteFile( const std::string &url, unsigned int numberOfConnections );
+
+  /** A file of the same remote directory as the parent, at a path
+   * relative to it, with its local copy in the local directory of
+   * the parent. */
+  RemoteFile( const RemoteFile &parent, const std::string &relativePath );
+
+  ~RemoteFile();
+
+  const std::string &GetURL( void ) const { return m_URL; }
+  const std::string &GetLocalFileName( void ) const { return m_LocalFileName; }
+  const std::string &GetLocalDirectory( void ) const { return m_LocalDirectory; }
+  uint64_t GetSize( void ) const { return m_Size; }
+
+  /** Download the byte ranges not already fetched into the local
+   * copy. The ranges are clipped to the size of the object. */
+  void Fetch( const std::vector<uint64_t> &offsets, const std::vector<uint64_t> &lengths );
+  void Fetch( uint64_t offset, uint64_t length );
+
+private:
+  RemoteFile( const RemoteFile & ); // purposely not implemented
+  void operator=( const RemoteFile & ); // purposely not implemented
+
+  void CreateLocalCopy( void );
+
+  std::string  m_URL;
+  // the region of the signature of s3:// URLs, empty for other URLs
+  std::string  m_S3Region;
+  std::string  m_LocalDirectory;
+  std::string  m_LocalFileName;
+  bool         m_OwnsLocalDirectory;
+  uint64_t     m_Size;
+  unsigned int m_NumberOfConnections;
+
+  // the sorted and disjoint byte ranges of the local copy which are
+  // fetched, as the begin and end offsets
+  std::vector< std::pair<uint64_t, uint64_t> > m_Fetched;
+};
+
+}
+}
+
+#endif
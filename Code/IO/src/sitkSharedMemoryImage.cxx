@@ -0,0 +1,481 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#include "sitkSharedMemoryImage.h"
+#include "sitkImportImageFilter.h"
+#include "sitkExceptionObject.h"
+
+#include "itkSimpleFastMutexLock.h"
+
+#include <cstring>
+#include <functional>
+#include <locale>
+#include <map>
+#include <numeric>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace itk {
+  namespace simple {
+
+  namespace
+  {
+
+  struct SharedPixelType
+  {
+    const char       *m_Name;
+    PixelIDValueType  m_ScalarPixelID;
+    PixelIDValueType  m_VectorPixelID;
+    unsigned int      m_Size;
+  };
+
+  const SharedPixelType SharedPixelTypes[] =
+  {
+    { "UInt8",   sitkUInt8,   sitkVectorUInt8,   1 },
+    { "Int8",    sitkInt8,    sitkVectorInt8,    1 },
+    { "UInt16",  sitkUInt16,  sitkVectorUInt16,  2 },
+    { "Int16",   sitkInt16,   sitkVectorInt16,   2 },
+    { "UInt32",  sitkUInt32,  sitkVectorUInt32,  4 },
+    { "Int32",   sitkInt32,   sitkVectorInt32,   4 },
+    { "UInt64",  sitkUInt64,  sitkVectorUInt64,  8 },
+    { "Int64",   sitkInt64,   sitkVectorInt64,   8 },
+    { "Float32", sitkFloat32, sitkVectorFloat32, 4 },
+    { "Float64", sitkFloat64, sitkVectorFloat64, 8 }
+  };
+
+  const size_t NumberOfSharedPixelTypes = sizeof( SharedPixelTypes ) / sizeof( SharedPixelTypes[0] );
+
+  const char * const HandlePrefix = "SimpleITKSharedMemoryImage";
+
+  const SharedPixelType *FindPixelType( PixelIDValueType pixelID )
+  {
+    for ( size_t i = 0; pixelID != sitkUnknown && i < NumberOfSharedPixelTypes; ++i )
+      {
+      if ( SharedPixelTypes[i].m_ScalarPixelID == pixelID || SharedPixelTypes[i].m_VectorPixelID == pixelID )
+        {
+        return &SharedPixelTypes[i];
+        }
+      }
+    return SITK_NULLPTR;
+  }
+
+  const SharedPixelType *FindPixelType( const std::string &name )
+  {
+    for ( size_t i = 0; i < NumberOfSharedPixelTypes; ++i )
+      {
+      if ( name == SharedPixelTypes[i].m_Name )
+        {
+        return &SharedPixelTypes[i];
+        }
+      }
+    return SITK_NULLPTR;
+  }
+
+  // A shared memory object mapped in this process, owned by the
+  // buffer of the imported image.
+  struct SharedMemoryMapping
+  {
+    std::string            m_Name;
+    const SharedPixelType *m_PixelType;
+    unsigned int           m_NumberOfComponents;
+    void                  *m_Address;
+    size_t                 m_Length;
+#ifdef _WIN32
+    HANDLE                 m_Handle;
+#endif
+  };
+
+  typedef itk::MutexLockHolder<itk::SimpleFastMutexLock> MutexHolderType;
+
+  // the mappings of this process by address
+  itk::SimpleFastMutexLock                      MappingsMutex;
+  std::map<const void *, SharedMemoryMapping *> Mappings;
+
+  void ReleaseMapping( void *, void *clientData )
+  {
+    SharedMemoryMapping *mapping = static_cast<SharedMemoryMapping *>( clientData );
+    {
+    MutexHolderType holder( MappingsMutex );
+    Mappings.erase( mapping->m_Address );
+    }
+#ifdef _WIN32
+    UnmapViewOfFile( mapping->m_Address );
+    CloseHandle( mapping->m_Handle );
+#else
+    munmap( mapping->m_Address, mapping->m_Length );
+#endif
+    delete mapping;
+  }
+
+  void CheckName( const std::string &name )
+  {
+    if ( name.empty() || name.find_first_of( "/\\ \t\r\n" ) != std::string::npos )
+      {
+      sitkExceptionMacro( "Invalid shared memory name \"" << name << "\"." );
+      }
+  }
+
+#ifndef _WIN32
+  std::string GetPosixName( const std::string &name )
+  {
+    return "/" + name;
+  }
+#endif
+
+  // Map the shared memory object of the mapping, which is created
+  // when create is true.
+  void MapSharedMemory( SharedMemoryMapping *mapping, bool create )
+  {
+    const std::string &name = mapping->m_Name;
+#ifdef _WIN32
+    HANDLE handle = NULL;
+    if ( create )
+      {
+      const uint64_t length = mapping->m_Length;
+      handle = CreateFileMappingA( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                   static_cast<DWORD>( length >> 32 ),
+                                   static_cast<DWORD>( length & 0xFFFFFFFF ),
+                                   name.c_str() );
+      if ( handle != NULL && GetLastError() == ERROR_ALREADY_EXISTS )
+        {
+        CloseHandle( handle );
+        sitkExceptionMacro( "The shared memory object \"" << name << "\" exists." );
+        }
+      }
+    else
+      {
+      handle = OpenFileMappingA( FILE_MAP_ALL_ACCESS, FALSE, name.c_str() );
+      }
+    if ( handle == NULL )
+      {
+      sitkExceptionMacro( "Unable to open the shared memory object \"" << name << "\"." );
+      }
+
+    void *address = MapViewOfFile( handle, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>( mapping->m_Length ) );
+    if ( address == NULL )
+      {
+      CloseHandle( handle );
+      sitkExceptionMacro( "Unable to map the shared memory object \"" << name << "\"." );
+      }
+    mapping->m_Handle = handle;
+#else
+    const std::string posixName = GetPosixName( name );
+    const int fd = create ? shm_open( posixName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600 )
+                          : shm_open( posixName.c_str(), O_RDWR, 0 );
+    if ( fd < 0 )
+      {
+      sitkExceptionMacro( "Unable to open the shared memory object \"" << name << "\": " << std::strerror( errno ) );
+      }
+
+    struct stat info;
+    if ( create )
+      {
+      if ( ftruncate( fd, static_cast<off_t>( mapping->m_Length ) ) != 0 )
+        {
+        const int error = errno;
+        close( fd );
+        shm_unlink( posixName.c_str() );
+        sitkExceptionMacro( "Unable to allocate the shared memory object \"" << name << "\": " << std::strerror( error ) );
+        }
+      }
+    else if ( fstat( fd, &info ) != 0 || static_cast<uint64_t>( info.st_size ) < mapping->m_Length )
+      {
+      close( fd );
+      sitkExceptionMacro( "The shared memory object \"" << name << "\" is smaller than the image." );
+      }
+
+    void *address = mmap( SITK_NULLPTR, mapping->m_Length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    // the mapping remains valid after the descriptor is closed
+    close( fd );
+    if ( address == MAP_FAILED )
+      {
+      if ( create )
+        {
+        shm_unlink( posixName.c_str() );
+        }
+      sitkExceptionMacro( "Unable to map the shared memory object \"" << name << "\"." );
+      }
+#endif
+    mapping->m_Address = address;
+  }
+
+  // Import the mapped object as an image, which owns the mapping.
+  Image ImportMapping( SharedMemoryMapping *mapping, const std::vector<unsigned int> &size )
+  {
+    ImportImageFilter importer;
+    importer.SetSize( size );
+    importer.SetOrigin( std::vector<double>( size.size(), 0.0 ) );
+    importer.SetSpacing( std::vector<double>( size.size(), 1.0 ) );
+    std::vector<double> direction( size.size() * size.size(), 0.0 );
+    for ( size_t i = 0; i < size.size(); ++i )
+      {
+      direction[i * size.size() + i] = 1.0;
+      }
+    importer.SetDirection( direction );
+
+    void *buffer = mapping->m_Address;
+    const unsigned int numberOfComponents = mapping->m_NumberOfComponents;
+    const PixelIDValueType pixelID = mapping->m_PixelType->m_ScalarPixelID;
+    if ( pixelID == sitkUInt8 )        { importer.SetBufferAsUInt8( static_cast<uint8_t *>( buffer ), numberOfComponents ); }
+    else if ( pixelID == sitkInt8 )    { importer.SetBufferAsInt8( static_cast<int8_t *>( buffer ), numberOfComponents ); }
+    else if ( pixelID == sitkUInt16 )  { importer.SetBufferAsUInt16( static_cast<uint16_t *>( buffer ), numberOfComponents ); }
+    else if ( pixelID == sitkInt16 )   { importer.SetBufferAsInt16( static_cast<int16_t *>( buffer ), numberOfComponents ); }
+    else if ( pixelID == sitkUInt32 )  { importer.SetBufferAsUInt32( static_cast<uint32_t *>( buffer ), numberOfComponents ); }
+    else if ( pixelID == sitkInt32 )   { importer.SetBufferAsInt32( static_cast<int32_t *>( buffer ), numberOfComponents ); }
+    else if ( pixelID == sitkUInt64 )  { importer.SetBufferAsUInt64( static_cast<uint64_t *>( buffer ), numberOfComponents ); }
+    else if ( pixelID == sitkInt64 )   { importer.SetBufferAsInt64( static_cast<int64_t *>( buffer ), numberOfComponents ); }
+    else if ( pixelID == sitkFloat32 ) { importer.SetBufferAsFloat( static_cast<float *>( buffer ), numberOfComponents ); }
+    else                               { importer.SetBufferAsDouble( static_cast<double *>( buffer ), numberOfComponents ); }
+
+    {
+    MutexHolderType holder( MappingsMutex );
+    Mappings[mapping->m_Address] = mapping;
+    }
+    importer.SetBufferDeleter( ReleaseMapping, mapping );
+
+    try
+      {
+      return importer.Execute();
+      }
+    catch ( ... )
+      {
+      // the mapping is released by the image once ownership is
+      // transferred
+      if ( importer.GetBufferDeleter() != SITK_NULLPTR )
+        {
+        ReleaseMapping( buffer, mapping );
+        }
+      throw;
+      }
+  }
+
+  SharedMemoryMapping *NewMapping( const std::string &name,
+                                   const SharedPixelType *pixelType,
+                                   unsigned int numberOfComponents,
+                                   const std::vector<unsigned int> &size )
+  {
+    if ( size.size() < 2 || size.size() > 4 )
+      {
+      sitkExceptionMacro( "The dimension of a shared memory image must be 2, 3 or 4." );
+      }
+    const uint64_t numberOfPixels = std::accumulate( size.begin(), size.end(), uint64_t( 1 ), std::multiplies<uint64_t>() );
+    const uint64_t length = numberOfPixels * numberOfComponents * pixelType->m_Size;
+    if ( length == 0 || length != static_cast<size_t>( length ) )
+      {
+      sitkExceptionMacro( "Invalid size of a shared memory image." );
+      }
+
+    SharedMemoryMapping *mapping = new SharedMemoryMapping;
+    mapping->m_Name = name;
+    mapping->m_PixelType = pixelType;
+    mapping->m_NumberOfComponents = numberOfComponents;
+    mapping->m_Address = SITK_NULLPTR;
+    mapping->m_Length = static_cast<size_t>( length );
+    return mapping;
+  }
+
+  } // end anonymous namespace
+
+
+  Image CreateSharedMemoryImage( const std::string &name,
+                                 const std::vector<unsigned int> &size,
+                                 PixelIDValueEnum pixelID,
+                                 unsigned int numberOfComponents )
+  {
+    CheckName( name );
+
+    const SharedPixelType *pixelType = FindPixelType( pixelID );
+    if ( pixelType == SITK_NULLPTR )
+      {
+      sitkExceptionMacro( "The pixel type " << GetPixelIDValueAsString( pixelID )
+                          << " is not supported for shared memory images." );
+      }
+    if ( pixelID == pixelType->m_ScalarPixelID )
+      {
+      numberOfComponents = 1;
+      }
+    else if ( numberOfComponents == 0 )
+      {
+      sitkExceptionMacro( "The number of components of a vector image must not be zero." );
+      }
+
+    SharedMemoryMapping *mapping = NewMapping( name, pixelType, numberOfComponents, size );
+    try
+      {
+      MapSharedMemory( mapping, true );
+      }
+    catch ( ... )
+      {
+      delete mapping;
+      throw;
+      }
+    return ImportMapping( mapping, size );
+  }
+
+
+  Image CopyImageToSharedMemory( const Image &image, const std::string &name )
+  {
+    Image sharedImage = CreateSharedMemoryImage( name, image.GetSize(), image.GetPixelID(),
+                                                 image.GetNumberOfComponentsPerPixel() );
+    const SharedPixelType *pixelType = FindPixelType( image.GetPixelIDValue() );
+    std::memcpy( const_cast<void *>( static_cast<const Image &>( sharedImage ).GetBufferAsVoid() ),
+                 image.GetBufferAsVoid(),
+                 static_cast<size_t>( image.GetNumberOfPixels() ) * image.GetNumberOfComponentsPerPixel() * pixelType->m_Size );
+
+    sharedImage.CopyInformation( image );
+    const std::vector<std::string> keys = image.GetMetaDataKeys();
+    for ( size_t i = 0; i < keys.size(); ++i )
+      {
+      sharedImage.SetMetaData( keys[i], image.GetMetaData( keys[i] ) );
+      }
+    return sharedImage;
+  }
+
+
+  std::string GetSharedMemoryImageHandle( const Image &image )
+  {
+    const SharedMemoryMapping *mapping = SITK_NULLPTR;
+    if ( FindPixelType( image.GetPixelIDValue() ) != SITK_NULLPTR )
+      {
+      MutexHolderType holder( MappingsMutex );
+      std::map<const void *, SharedMemoryMapping *>::const_iterator it = Mappings.find( image.GetBufferAsVoid() );
+      if ( it != Mappings.end() )
+        {
+        mapping = it->second;
+        }
+      }
+    if ( mapping == SITK_NULLPTR )
+      {
+      sitkExceptionMacro( "The buffer of the image is not in shared memory." );
+      }
+
+    std::ostringstream handle;
+    handle.imbue( std::locale::classic() );
+    handle.precision( 17 );
+    handle << HandlePrefix << ' ' << mapping->m_Name << ' ' << mapping->m_PixelType->m_Name
+           << ' ' << image.GetNumberOfComponentsPerPixel() << ' ' << image.GetDimension();
+
+    const std::vector<unsigned int> size = image.GetSize();
+    const std::vector<double> origin = image.GetOrigin();
+    const std::vector<double> spacing = image.GetSpacing();
+    const std::vector<double> direction = image.GetDirection();
+    for ( size_t i = 0; i < size.size(); ++i )
+      {
+      handle << ' ' << size[i];
+      }
+    for ( size_t i = 0; i < origin.size(); ++i )
+      {
+      handle << ' ' << origin[i];
+      }
+    for ( size_t i = 0; i < spacing.size(); ++i )
+      {
+      handle << ' ' << spacing[i];
+      }
+    for ( size_t i = 0; i < direction.size(); ++i )
+      {
+      handle << ' ' << direction[i];
+      }
+    return handle.str();
+  }
+
+
+  Image AttachSharedMemoryImage( const std::string &handle )
+  {
+    std::istringstream in( handle );
+    in.imbue( std::locale::classic() );
+
+    std::string prefix;
+    std::string name;
+    std::string pixelTypeName;
+    unsigned int numberOfComponents = 0;
+    unsigned int dimension = 0;
+    in >> prefix >> name >> pixelTypeName >> numberOfComponents >> dimension;
+
+    const SharedPixelType *pixelType = FindPixelType( pixelTypeName );
+    if ( !in || prefix != HandlePrefix || pixelType == SITK_NULLPTR
+         || numberOfComponents == 0 || dimension < 2 || dimension > 4 )
+      {
+      sitkExceptionMacro( "Invalid shared memory image handle \"" << handle << "\"." );
+      }
+    CheckName( name );
+
+    std::vector<unsigned int> size( dimension );
+    std::vector<double> origin( dimension );
+    std::vector<double> spacing( dimension );
+    std::vector<double> direction( dimension * dimension );
+    for ( size_t i = 0; i < size.size(); ++i )
+      {
+      in >> size[i];
+      }
+    for ( size_t i = 0; i < origin.size(); ++i )
+      {
+      in >> origin[i];
+      }
+    for ( size_t i = 0; i < spacing.size(); ++i )
+      {
+      in >> spacing[i];
+      }
+    for ( size_t i = 0; i < direction.size(); ++i )
+      {
+      in >> direction[i];
+      }
+    if ( !in )
+      {
+      sitkExceptionMacro( "Invalid shared memory image handle \"" << handle << "\"." );
+      }
+
+    SharedMemoryMapping *mapping = NewMapping( name, pixelType, numberOfComponents, size );
+    try
+      {
+      MapSharedMemory( mapping, false );
+      }
+    catch ( ... )
+      {
+      delete mapping;
+      throw;
+      }
+
+    Image image = ImportMapping( mapping, size );
+    image.SetOrigin( origin );
+    image.SetSpacing( spacing );
+    image.SetDirection( direction );
+    return image;
+  }
+
+
+  void UnlinkSharedMemoryImage( const std::string &name )
+  {
+    CheckName( name );
+#ifndef _WIN32
+    if ( shm_unlink( GetPosixName( name ).c_str() ) != 0 )
+      {
+      sitkExceptionMacro( "Unable to remove the shared memory object \"" << name << "\": " << std::strerror( errno ) );
+      }
+#endif
+  }
+
+  }
+}
@@ -18,6 +18,7 @@
 #include "sitkShow.h"
 #include "sitkMacro.h"
 #include "sitkImageFileWriter.h"
+#include "sitkExecutionCache.h"
 #include <itkMacro.h>
 #include <itksys/SystemTools.hxx>
 #include <itksys/Process.h>
@@ -28,6 +29,7 @@
 #include <string>
 #include <algorithm>
 #include <ctype.h>
+#include <map>
 
 #ifdef _WIN32
 #include <process.h>
@@ -53,6 +55,12 @@ namespace itk
 
   static int ShowImageCount = 0;
 
+  // The files written by Show, by the key of the content of their
+  // image and their extension, so an unchanged image is not written
+  // again.
+  typedef std::map<std::string, std::string> ShownFilesType;
+  static ShownFilesType ShownFiles;
+
 #if defined(_WIN32)
   // time to wait in seconds before we check if the process is OK
   const unsigned int ProcessDelay = 1;
@@ -272,9 +280,8 @@ namespace itk
     }
 
   //
-  static std::string FormatFileName ( std::string TempDirectory, std::string name, const bool metaioDefault=false )
+  static std::string GetExtension ( const bool metaioDefault=false )
   {
-  std::string TempFile = TempDirectory;
   std::string Extension;
 
   if (metaioDefault)
@@ -286,8 +293,15 @@ namespace itk
     Extension = ".nii";
     }
 
-
   itksys::SystemTools::GetEnv ( "SITK_SHOW_EXTENSION", Extension );
+  return Extension;
+  }
+
+  //
+  static std::string FormatFileName ( std::string TempDirectory, std::string name, const bool metaioDefault=false )
+  {
+  std::string TempFile = TempDirectory;
+  const std::string Extension = GetExtension( metaioDefault );
 
 #ifdef _WIN32
   int pid = _getpid();
@@ -349,6 +363,16 @@ namespace itk
   {
   std::string TempDirectory;
 
+  if ( itksys::SystemTools::GetEnv ( "SITK_SHOW_DIRECTORY", TempDirectory ) && TempDirectory.length() )
+    {
+#ifdef _WIN32
+    TempDirectory = DoubleBackslashes(TempDirectory + "\\");
+#else
+    TempDirectory = TempDirectory + "/";
+#endif
+    return FormatFileName ( TempDirectory, name, metaioDefault );
+    }
+
 #ifdef _WIN32
   if ( !itksys::SystemTools::GetEnv ( "TMP", TempDirectory )
     && !itksys::SystemTools::GetEnv ( "TEMP", TempDirectory )
@@ -360,7 +384,17 @@ namespace itk
   TempDirectory = TempDirectory + "\\";
   TempDirectory = DoubleBackslashes(TempDirectory);
 #else
-  TempDirectory = "/tmp/";
+  // prefer the memory backed file system, so the images are not
+  // written to disk
+  if ( itksys::SystemTools::FileIsDirectory( "/dev/shm" )
+       && access( "/dev/shm", W_OK ) == 0 )
+    {
+    TempDirectory = "/dev/shm/";
+    }
+  else
+    {
+    TempDirectory = "/tmp/";
+    }
 #endif
   return FormatFileName ( TempDirectory, name, metaioDefault );
   }
@@ -622,10 +656,25 @@ namespace itk
 
   bool fijiFlag = ExecutableName.find( "Fiji.app" ) != std::string::npos;
 
-  TempFile = BuildFullFileName(title, fijiFlag);
+  // An image already shown with the same content, geometry and
+  // extension is not written again, its file is opened again.
+  std::vector<const Image *> inputs( 1, &image );
+  const std::string key = ExecutionCache::MakeKey( "Show", GetExtension( fijiFlag ), inputs );
 
-  // write out the image
-  WriteImage ( image, TempFile );
+  ShownFilesType::iterator shown = ShownFiles.find( key );
+  if ( shown != ShownFiles.end() && itksys::SystemTools::FileExists( shown->second.c_str(), true ) )
+    {
+    TempFile = shown->second;
+    localDebugMacro( << "Show reusing the file of an unchanged image: " << TempFile << std::endl );
+    }
+  else
+    {
+    TempFile = BuildFullFileName(title, fijiFlag);
+
+    // write out the image, without compression
+    WriteImage ( image, TempFile, false );
+    ShownFiles[key] = TempFile;
+    }
 
 
   // check for user-defined environment variables for the command string
@@ -0,0 +1,155 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkStreamingHashImageFilter_h
+#define sitkStreamingHashImageFilter_h
+
+#include "sitkMacro.h"
+
+#include "itkImageToImageFilter.h"
+#include "itkNumericTraits.h"
+#include "Ancillary/itkIncrementalHash.h"
+
+#include <string>
+
+namespace itk
+{
+namespace simple
+{
+
+/** \class StreamingHashImageFilter
+ * \brief Pass the pieces of a streamed image through, and compute
+ * the FAST hash of its pixels as the pieces go by.
+ *
+ * The output shares the buffer of the input. Each time the filter is
+ * executed, the slices along the last dimension of the input buffer
+ * which follow the slices already hashed are added to the hash, so
+ * the pieces of an ImageFileWriter streaming along the slowest
+ * dimension are hashed without another pass over the image. The
+ * hash is the same as the FAST hash of the HashImageFilter of the
+ * whole image, without the geometry.
+ *
+ * The hash is not available when a piece is not a slab of complete
+ * slices, or does not follow the hashed slices.
+ */
+template <class TImageType>
+class StreamingHashImageFilter
+  : public itk::ImageToImageFilter<TImageType, TImageType>
+{
+public:
+  typedef StreamingHashImageFilter                        Self;
+  typedef itk::ImageToImageFilter<TImageType, TImageType> Superclass;
+  typedef itk::SmartPointer<Self>                         Pointer;
+  typedef itk::SmartPointer<const Self>                   ConstPointer;
+
+  typedef TImageType                                      ImageType;
+  typedef typename ImageType::RegionType                  RegionType;
+  typedef typename ImageType::InternalPixelType           InternalPixelType;
+  typedef typename itk::NumericTraits<InternalPixelType>::ValueType ValueType;
+
+  itkNewMacro(Self);
+  itkTypeMacro(StreamingHashImageFilter, ImageToImageFilter);
+
+  /** The hash of the pixels of the image, or an empty string if not
+   * all of them were hashed in order. */
+  std::string GetHash() const
+    {
+      const ImageType *input = this->GetInput();
+      const unsigned int last = ImageType::ImageDimension - 1;
+      if ( !m_Valid || input == SITK_NULLPTR
+           || m_NextSlice != static_cast<IndexValueType>( input->GetLargestPossibleRegion().GetSize( last ) ) )
+        {
+        return std::string();
+        }
+      IncrementalHash hash( m_Hash );
+      return hash.Final();
+    }
+
+  /** The FAST hash of the buffer of an image. */
+  static std::string HashImage( const ImageType *image, ThreadIdType numberOfThreads )
+    {
+      IncrementalHash hash( IncrementalHash::FAST, sizeof(ValueType) );
+      hash.SetNumberOfThreads( numberOfThreads );
+      hash.Update( image->GetBufferPointer(),
+                   image->GetBufferedRegion().GetNumberOfPixels() * GetBytesPerPixel( image ) );
+      return hash.Final();
+    }
+
+protected:
+  StreamingHashImageFilter()
+    : m_Hash( IncrementalHash::FAST, sizeof(ValueType) ),
+      m_NextSlice( 0 ),
+      m_Valid( true )
+    {}
+
+  void GenerateData() ITK_OVERRIDE
+    {
+      ImageType *input = const_cast<ImageType *>( this->GetInput() );
+      this->GraftOutput( input );
+
+      const RegionType largest = input->GetLargestPossibleRegion();
+      const RegionType buffered = input->GetBufferedRegion();
+      const unsigned int last = ImageType::ImageDimension - 1;
+
+      // the buffer must be a slab of complete slices
+      SizeValueType sliceBytes = GetBytesPerPixel( input );
+      for ( unsigned int i = 0; i < last; ++i )
+        {
+        if ( buffered.GetIndex( i ) != largest.GetIndex( i ) || buffered.GetSize( i ) != largest.GetSize( i ) )
+          {
+          m_Valid = false;
+          }
+        sliceBytes *= buffered.GetSize( i );
+        }
+
+      const IndexValueType start = buffered.GetIndex( last ) - largest.GetIndex( last );
+      const IndexValueType end = start + static_cast<IndexValueType>( buffered.GetSize( last ) );
+      if ( !m_Valid || start > m_NextSlice )
+        {
+        m_Valid = false;
+        return;
+        }
+      if ( end <= m_NextSlice )
+        {
+        return;
+        }
+
+      m_Hash.SetNumberOfThreads( this->GetNumberOfThreads() );
+      const unsigned char *buffer = reinterpret_cast<const unsigned char *>( input->GetBufferPointer() );
+      m_Hash.Update( buffer + ( m_NextSlice - start ) * sliceBytes, ( end - m_NextSlice ) * sliceBytes );
+      m_NextSlice = end;
+    }
+
+private:
+  StreamingHashImageFilter( const Self & ); //purposely not implemented
+  void operator=( const Self & );           //purposely not implemented
+
+  static SizeValueType GetBytesPerPixel( const ImageType *image )
+    {
+      return sizeof(InternalPixelType) * ImageType::AccessorFunctorType::GetVectorLength( image );
+    }
+
+  IncrementalHash m_Hash;
+  // the first slice along the last dimension which is not hashed
+  IndexValueType  m_NextSlice;
+  bool            m_Valid;
+};
+
+}
+}
+
+#endif
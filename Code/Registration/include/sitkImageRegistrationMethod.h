@@ -36,6 +36,7 @@ namespace itk
 
 #ifndef SWIG
 template< typename TInternalComputationValueType> class ObjectToObjectOptimizerBaseTemplate;
+template< typename TInternalComputationValueType> class ObjectToObjectMetricBaseTemplate;
 template<typename TFixedImage,
          typename TMovingImage,
          typename TVirtualImage,
@@ -53,6 +54,8 @@ template<typename TMetric> class RegistrationParameterScalesEstimator;
 
 template<unsigned int VDimension> class SpatialObject;
 
+template<typename TParametersValueType> class TransformBaseTemplate;
+
 class Command;
 class EventObject;
 #endif
@@ -230,6 +233,79 @@ namespace simple
      */
     SITK_RETURN_SELF_TYPE_HEADER SetMetricAsMattesMutualInformation( unsigned int numberOfHistogramBins = 50 );
 
+    /** \brief Add the current metric to a weighted composite metric.
+     *
+     * The metric last set with one of the SetMetricAs methods, with
+     * its parameters, is added to the composite metric with the
+     * weight. When the composite metric has components, the
+     * registration and MetricEvaluate use the weighted combination of
+     * them, instead of the current metric. All the components compare
+     * the same fixed and moving images, share the smoothed images of
+     * each level, the masks and the sample points, and are evaluated
+     * together for each iteration of the optimizer.
+     *
+     * \sa itk::ObjectToObjectMultiMetricv4
+     * @{
+     */
+    SITK_RETURN_SELF_TYPE_HEADER AddMetricToComposite( double weight = 1.0 );
+    SITK_RETURN_SELF_TYPE_HEADER ClearCompositeMetric( );
+    unsigned int GetNumberOfCompositeMetricComponents( ) const
+      { return static_cast<unsigned int>( this->m_CompositeMetric.size() ); }
+    /** @} */
+
+    /** \brief Set the weights of the channels of vector images.
+     *
+     * The fixed and moving images may have a vector pixel type with
+     * the same number of components. Each channel is then compared
+     * with the metric, or each component of the composite metric,
+     * and the registration optimizes the weighted combination of them
+     * with the sample points of each level shared by all. The
+     * default, an empty vector, weights each channel by 1.
+     * @{
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetMetricChannelWeights( const std::vector<double> &weights )
+      { this->m_MetricChannelWeights = weights; return *this; }
+    const std::vector<double> &GetMetricChannelWeights( ) const
+      { return this->m_MetricChannelWeights; }
+    /** @} */
+
+    /** \brief Add a landmark term to the image metric.
+     *
+     * The fixed and moving landmarks are flat lists of physical
+     * points, as for the LandmarkBasedTransformInitializerFilter.
+     * The point set metric of the landmarks is combined with the
+     * weight, with the image metric in a multi-metric, so that a few
+     * corresponding landmarks constrain the optimization at a small
+     * cost compared to the image metric, allowing lower sampling
+     * percentages.
+     *
+     * With the Euclidean distance the landmarks correspond by their
+     * order, and the distance between each pair is minimized. With
+     * the expectation based metric the correspondence is not
+     * required, each moving landmark is attracted to the fixed
+     * landmarks within the evaluationKNeighborhood with a Gaussian of
+     * pointSetSigma.
+     *
+     * The moving transform must be invertible, as the moving
+     * landmarks are mapped into the virtual domain. The landmark
+     * term is not included by MetricEvaluate.
+     *
+     * \sa itk::LabeledPointSetToPointSetMetricv4
+     * \sa itk::EuclideanDistancePointSetToPointSetMetricv4
+     * \sa itk::ExpectationBasedPointSetToPointSetMetricv4
+     * @{
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetMetricLandmarksAsEuclideanDistance( const std::vector<double> &fixedLandmarks,
+                                                                         const std::vector<double> &movingLandmarks,
+                                                                         double weight = 1.0 );
+    SITK_RETURN_SELF_TYPE_HEADER SetMetricLandmarksAsExpectation( const std::vector<double> &fixedLandmarks,
+                                                                   const std::vector<double> &movingLandmarks,
+                                                                   double weight = 1.0,
+                                                                   double pointSetSigma = 1.0,
+                                                                   unsigned int evaluationKNeighborhood = 50 );
+    SITK_RETURN_SELF_TYPE_HEADER ClearMetricLandmarks( );
+    /** @} */
+
 
     enum EstimateLearningRateType { Never, ///< Never run estimation, use provided value.
                                     Once,  ///< Estimate learning once each level, ignore provided values.
@@ -274,6 +350,34 @@ namespace simple
                                          EstimateLearningRateType estimateLearningRate = Once,
                                          double maximumStepSizeInPhysicalUnits = 0.0);
 
+    /** \brief Stochastic gradient descent optimizer with the adaptive
+     * moment estimates of Adam.
+     *
+     * Each parameter is moved by the learning rate times the running
+     * mean of its derivative, with decay rate beta1, over the square
+     * root of the running mean of its squared derivative, with decay
+     * rate beta2. The steps are taken in the parameters multiplied by
+     * the square root of their scales, so with the physical shift
+     * scales the learning rate is about the largest shift of a step
+     * in physical units. The learning rate is not estimated.
+     *
+     * When the metric is sampled, the sample points are drawn again
+     * at random in the virtual domain, inside the fixed mask, after
+     * each iteration, seeded by the sampling seed. The metric is then
+     * evaluated on a new small sample at each iteration, so a
+     * sampling percentage of about 1% gives an unbiased
+     * estimate. The first iteration of each level uses the points of
+     * the sampling strategy. The metric value and the convergence
+     * value are those of the current sample.
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetOptimizerAsAdam( double learningRate,
+                                                     unsigned int numberOfIterations,
+                                                     double beta1 = 0.9,
+                                                     double beta2 = 0.999,
+                                                     double epsilon = 1e-8,
+                                                     double convergenceMinimumValue = 1e-6,
+                                                     unsigned int convergenceWindowSize = 10 );
+
     /** \brief Gradient descent optimizer with a golden section line search.
      *
      * \sa itk::GradientDescentLineSearchOptimizerv4Template
@@ -341,10 +445,22 @@ namespace simple
      * \note This optimizer is not suitable for use in conjunction
      * with the  multiple scales.
      *
+     * With numberOfParallelEvaluations greater than 1, the points of
+     * the grid are evaluated concurrently by that many metrics, each
+     * with its share of the threads, as by the MetricEvaluate of
+     * many parameters, instead of one point at a time by a metric
+     * using all the threads. The grid is then evaluated on the full
+     * resolution images, with the manual OptimizerScales, and the
+     * iteration commands are not invoked. With numberOfRefinements
+     * greater than 0, the grid is evaluated again that many times
+     * around the best point, with the step length halved each time.
+     *
      * \sa itk::ExhaustiveOptimizerv4
      */
     SITK_RETURN_SELF_TYPE_HEADER SetOptimizerAsExhaustive( const std::vector<unsigned int> &numberOfSteps,
-                                    double stepLength = 1.0 );
+                                    double stepLength = 1.0,
+                                    unsigned int numberOfParallelEvaluations = 1u,
+                                    unsigned int numberOfRefinements = 0u );
 
     /** \brief Set optimizer to Nelder-Mead downhill simplex algorithm.
      *
@@ -426,6 +542,26 @@ namespace simple
     SITK_RETURN_SELF_TYPE_HEADER SetOptimizerScalesFromPhysicalShift( unsigned int centralRegionRadius = 5,
                                               double smallParameterVariation =  0.01 );
 
+    /** \brief Reuse the estimated scales across the levels.
+     *
+     * By default the optimizer scales are estimated at each level of
+     * the registration. When on, the scales estimated at the first
+     * level are reused by the following levels, unless the transform
+     * parameters adaptor changes the number of parameters, as when
+     * refining the mesh of a BSpline transform. The scales estimated
+     * by an execution are available from GetOptimizerScales, and may
+     * be set with SetOptimizerScales to be reused by later
+     * executions.
+     * @{
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetOptimizerScalesReusedAcrossLevels( bool reuse )
+      { this->m_OptimizerScalesReusedAcrossLevels = reuse; return *this; }
+    bool GetOptimizerScalesReusedAcrossLevels() const
+      { return this->m_OptimizerScalesReusedAcrossLevels; }
+    SITK_RETURN_SELF_TYPE_HEADER OptimizerScalesReusedAcrossLevelsOn() { return this->SetOptimizerScalesReusedAcrossLevels(true); }
+    SITK_RETURN_SELF_TYPE_HEADER OptimizerScalesReusedAcrossLevelsOff() { return this->SetOptimizerScalesReusedAcrossLevels(false); }
+    /** @} */
+
 
     /** \brief Set an image mask in order to restrict the sampled points
      * for the metric.
@@ -466,10 +602,30 @@ namespace simple
     enum MetricSamplingStrategyType {
       NONE,
       REGULAR,
-      RANDOM
+      RANDOM,
+      STRATIFIED,
+      HALTON,
+      GRADIENT_WEIGHTED
     };
 
     /** \brief Set sampling strategy for sample generation.
+     *
+     * In addition to the strategies of ITK, STRATIFIED draws one
+     * random sample from each of equally sized strata of the
+     * voxels, HALTON places the samples on a randomly shifted Halton
+     * low-discrepancy sequence, and GRADIENT_WEIGHTED draws stratified
+     * samples with a density proportional to the gradient magnitude
+     * of the fixed image. These give less noisy metric values than
+     * RANDOM sampling, and do not alias as REGULAR sampling, at low
+     * sampling percentages. The sampling seed is used for the random
+     * components.
+     *
+     * With a fixed mask, REGULAR and RANDOM sample the voxels inside
+     * the mask, found in the bounding box of the mask, instead of
+     * the whole virtual domain with the samples outside of the mask
+     * rejected. The sampling percentage is then of the voxels inside
+     * the mask, which gives the number of samples that the ITK
+     * strategies keep on average.
      *
      * \sa itk::ImageRegistrationMethodv4::SetMetricSamplingStrategy
      */
@@ -530,10 +686,288 @@ namespace simple
     SITK_RETURN_SELF_TYPE_HEADER SmoothingSigmasAreSpecifiedInPhysicalUnitsOff()  { this->SetSmoothingSigmasAreSpecifiedInPhysicalUnits(false); return *this;}
     /** @} */
 
+    /** \brief Set the shrink factors for each level and each
+     * dimension.
+     *
+     * The shrink factors of a level are given for each dimension of
+     * the images, so that the dimensions with a coarse spacing are
+     * shrunk less than the others. SetShrinkFactorsPerLevel replaces
+     * these shrink factors.
+     *
+     * \sa  itk::ImageRegistrationMethodv4::SetShrinkFactorsPerDimension
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetShrinkFactorsPerDimensionPerLevel( const std::vector< std::vector<unsigned int> > &shrinkFactors );
+    const std::vector< std::vector<unsigned int> > &GetShrinkFactorsPerDimensionPerLevel() const
+      { return this->m_ShrinkFactorsPerDimensionPerLevel; }
+
+    /** \brief Set the shrink factors and smoothing sigmas of the
+     * levels from the size and spacing of an image.
+     *
+     * The finest level is the image, and at each coarser level the
+     * spacing of the shrunken image is doubled from the smallest
+     * spacing of the image. Each dimension is shrunk by the factor
+     * closest to the level spacing over its spacing, so a dimension
+     * with a coarse spacing is not shrunk until the level spacing
+     * reaches it, and no dimension is shrunk to less than 4
+     * pixels. Levels are added until the shrunken image has at most
+     * coarsestNumberOfPixels pixels, or maximumNumberOfLevels levels.
+     *
+     * The smoothing sigma of a shrunken level is half of the largest
+     * spacing of its shrunk dimensions, in physical units, and the
+     * finest level is not smoothed. The smoothing sigmas are set as
+     * specified in physical units.
+     *
+     * The fixed image is usually given, and the schedule is set for
+     * the image when called, so the per level parameters may be given
+     * for the resulting number of levels.
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetMultiResolutionScheduleFromImage( const Image &image,
+                                                                      uint64_t coarsestNumberOfPixels = 4096u,
+                                                                      unsigned int maximumNumberOfLevels = 5u );
+
+    /** \brief Set optimizer parameters for each level.
+     *
+     * These override the number of iterations, the learning rate and
+     * the convergence window size given when setting the optimizer,
+     * at each level of the registration, so that the coarse levels
+     * may do most of the optimization and the fine levels only a few
+     * iterations. When not empty, the number of values must match the
+     * number of levels. An empty vector, the default, uses the
+     * optimizer's parameter for all levels.
+     *
+     * The number of iterations is supported by the gradient descent,
+     * Powell and OnePlusOneEvolutionary optimizers, the learning rate
+     * and convergence window size only by the gradient descent
+     * optimizers. When the learning rate is estimated, the estimate
+     * replaces the per level learning rate.
+     * @{
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetOptimizerNumberOfIterationsPerLevel( const std::vector<unsigned int> &numberOfIterations )
+      { this->m_OptimizerNumberOfIterationsPerLevel = numberOfIterations; return *this; }
+    const std::vector<unsigned int> &GetOptimizerNumberOfIterationsPerLevel() const
+      { return this->m_OptimizerNumberOfIterationsPerLevel; }
+    SITK_RETURN_SELF_TYPE_HEADER SetOptimizerLearningRatePerLevel( const std::vector<double> &learningRates )
+      { this->m_OptimizerLearningRatePerLevel = learningRates; return *this; }
+    const std::vector<double> &GetOptimizerLearningRatePerLevel() const
+      { return this->m_OptimizerLearningRatePerLevel; }
+    SITK_RETURN_SELF_TYPE_HEADER SetOptimizerConvergenceWindowSizePerLevel( const std::vector<unsigned int> &windowSizes )
+      { this->m_OptimizerConvergenceWindowSizePerLevel = windowSizes; return *this; }
+    const std::vector<unsigned int> &GetOptimizerConvergenceWindowSizePerLevel() const
+      { return this->m_OptimizerConvergenceWindowSizePerLevel; }
+    /** @} */
+
+    /** \brief Checkpoint the registration after each completed level.
+     *
+     * When the file name is not empty, the transform is written to
+     * the file after each level of the registration completes, with
+     * the number of completed levels written to the file name with
+     * the ".level" suffix. The files are replaced only once
+     * completely written, so an interrupted registration leaves the
+     * last checkpoint intact, from which it may be resumed with
+     * ResumeFromCheckpoint.
+     *
+     * The checkpoint only holds the transform, so the state of the
+     * optimizer, such as an estimated learning rate, is restarted
+     * with the level.
+     * @{
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetCheckpointFileName( const std::string &fileName )
+      { this->m_CheckpointFileName = fileName; return *this; }
+    const std::string &GetCheckpointFileName() const
+      { return this->m_CheckpointFileName; }
+    /** @} */
+
+    /** \brief Set the first level of the registration to execute.
+     *
+     * The levels before the start level are skipped, while the
+     * shrink factors, smoothing sigmas and the per level parameters
+     * are still specified for all the levels. The level reported by
+     * GetCurrentLevel includes the skipped levels. The default is 0.
+     * @{
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetStartLevel( unsigned int level )
+      { this->m_StartLevel = level; return *this; }
+    unsigned int GetStartLevel() const
+      { return this->m_StartLevel; }
+    /** @} */
+
+    /** \brief Resume a registration from a checkpoint.
+     *
+     * The transform of the checkpoint is set as the initial
+     * transform, and the start level is set to the number of levels
+     * completed, so that the next execution continues from the level
+     * where the checkpointed registration was interrupted.
+     *
+     * \sa SetCheckpointFileName, SetInitialTransform, SetStartLevel
+     */
+    SITK_RETURN_SELF_TYPE_HEADER ResumeFromCheckpoint( const std::string &fileName, bool inPlace = true );
+
+    /** \brief Set the number of threads of the parts of the registration.
+     *
+     * By default the metric, the smoothing filters of the pyramid and
+     * the optimizer all use the number of threads of the process
+     * object. These set a separate number of threads for the
+     * evaluation of the metric, the smoothing of the pyramid levels
+     * and the optimizer, so that several registrations may run
+     * concurrently without more threads than processors. A value of
+     * 0, the default, uses the number of threads of the process
+     * object.
+     *
+     * The number of threads of the optimizer is used to scale the
+     * gradient. The optimizer's scales estimator, such as for
+     * SetOptimizerScalesFromPhysicalShift, runs in the calling thread.
+     * @{
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetMetricNumberOfThreads( unsigned int n )
+      { this->m_MetricNumberOfThreads = n; return *this; }
+    unsigned int GetMetricNumberOfThreads() const
+      { return this->m_MetricNumberOfThreads; }
+    SITK_RETURN_SELF_TYPE_HEADER SetSmoothingNumberOfThreads( unsigned int n )
+      { this->m_SmoothingNumberOfThreads = n; return *this; }
+    unsigned int GetSmoothingNumberOfThreads() const
+      { return this->m_SmoothingNumberOfThreads; }
+    SITK_RETURN_SELF_TYPE_HEADER SetOptimizerNumberOfThreads( unsigned int n )
+      { this->m_OptimizerNumberOfThreads = n; return *this; }
+    unsigned int GetOptimizerNumberOfThreads() const
+      { return this->m_OptimizerNumberOfThreads; }
+    /** @} */
+
+    /** \brief Release the cached smoothed images of the pyramid.
+     *
+     * The fixed and moving images smoothed for each level of the
+     * registration are cached, so that subsequent executions with the
+     * same images and smoothing sigmas, such as when trying different
+     * initial transforms, metrics or optimizers, do not repeat the
+     * smoothing. The cache refers to the input images, and only holds
+     * the levels of the images of the last execution.
+     */
+    void ClearCache();
+
+
+    /** \brief Set stopping criteria evaluated at each iteration of
+     * the optimizer, over all the levels of the registration.
+     *
+     * When a criterion is met the optimizer is stopped at its
+     * current position, and the registration completes normally
+     * returning the current transform, rather than throwing as when
+     * the registration is aborted. The optimizer of each remaining
+     * level is stopped after its first iteration. The reason is
+     * appended to the optimizer stop condition description.
+     *
+     * The MaximumElapsedTime is the wall clock budget in seconds
+     * from the start of the execution. The
+     * MaximumTotalNumberOfIterations counts the iterations of all
+     * levels. The metric convergence criterion is met when the metric
+     * values of the last windowSize iterations vary by less than
+     * minimumChange. A value of 0 disables a criterion, which is the
+     * default.
+     *
+     * These criteria, and StopRegistration, are supported by the
+     * gradient descent, Powell and Exhaustive optimizers, and are
+     * ignored by the others.
+     * @{
+     */
+    SITK_RETURN_SELF_TYPE_HEADER SetMaximumElapsedTime( double seconds )
+      { this->m_MaximumElapsedTime = seconds; return *this; }
+    double GetMaximumElapsedTime() const
+      { return this->m_MaximumElapsedTime; }
+    SITK_RETURN_SELF_TYPE_HEADER SetMaximumTotalNumberOfIterations( unsigned int numberOfIterations )
+      { this->m_MaximumTotalNumberOfIterations = numberOfIterations; return *this; }
+    unsigned int GetMaximumTotalNumberOfIterations() const
+      { return this->m_MaximumTotalNumberOfIterations; }
+    SITK_RETURN_SELF_TYPE_HEADER SetMetricConvergenceCriterion( unsigned int windowSize, double minimumChange );
+    /** @} */
+
+    /** \brief Stop the registration at the current transform.
+     *
+     * This method may be called from a command during execution, such
+     * as on the sitkIterationEvent. The optimizer is stopped as when a
+     * stopping criterion is met, and the current transform is
+     * returned by Execute.
+     */
+    void StopRegistration();
+
+
+    /** \brief Measurements of the last execution, to tune the
+     * sampling, the levels and the number of threads.
+     *
+     * For each level, LevelInitializationTimes are the seconds spent
+     * in smoothing and shrinking the images and initializing the
+     * metric, and LevelOptimizationTimes the seconds spent in the
+     * optimizer, which include the time in commands. The
+     * LevelNumberOfIterations are the iterations of the optimizer,
+     * which for the gradient descent optimizers without line search
+     * is the number of metric value and derivative evaluations, and
+     * LevelNumberOfValidPoints the samples used by the last metric
+     * evaluation of the level. NumberOfThreadsUsed is that of the
+     * metric, ObserverTime the seconds spent in the commands of the
+     * iteration event, and TotalTime the seconds of the execution.
+     *
+     * The values are not updated when the execution throws.
+     * @{
+     */
+    const std::vector<double> &GetProfileLevelInitializationTimes() const
+      { return this->m_ProfileLevelInitializationTimes; }
+    const std::vector<double> &GetProfileLevelOptimizationTimes() const
+      { return this->m_ProfileLevelOptimizationTimes; }
+    const std::vector<unsigned int> &GetProfileLevelNumberOfIterations() const
+      { return this->m_ProfileLevelNumberOfIterations; }
+    const std::vector<unsigned int> &GetProfileLevelNumberOfValidPoints() const
+      { return this->m_ProfileLevelNumberOfValidPoints; }
+    unsigned int GetProfileNumberOfThreadsUsed() const
+      { return this->m_ProfileNumberOfThreadsUsed; }
+    double GetProfileObserverTime() const
+      { return this->m_ProfileObserverTime; }
+    double GetProfileTotalTime() const
+      { return this->m_ProfileTotalTime; }
+    /** @} */
 
     /** \brief Optimize the configured registration problem. */
     Transform Execute ( const Image &fixed, const Image & moving );
 
+    /** \brief Register each of many moving images to one fixed image.
+     *
+     * Each moving image is registered independently to the fixed
+     * image with the current configuration, starting from a copy of
+     * the initial transform, which is not modified. The resulting
+     * transforms are returned in the order of the moving images.
+     *
+     * When numberOfParallelRegistrations is greater than one, that
+     * many registrations are run concurrently and the number of
+     * threads of this method is divided between them. The parallel
+     * registrations are performed by copies of this method's
+     * configuration, so the commands added to this method are not
+     * invoked and the measurements are not updated. Otherwise the
+     * registrations are run sequentially by this method.
+     */
+    std::vector<Transform> ExecuteBatch ( const Image &fixed,
+                                          const std::vector<Image> &movingImages,
+                                          unsigned int numberOfParallelRegistrations = 1u );
+
+    /** \brief Register from many initial transforms, continuing the
+     * best.
+     *
+     * A short registration, limited to numberOfStartIterations
+     * iterations of the optimizer, is run from a copy of each of the
+     * initial transforms. The numberOfBest starts with the lowest
+     * metric values are then continued with the full configuration.
+     * The continued transforms are returned ordered by their final
+     * metric value, best first, and the metric value of the best is
+     * available from GetMetricValue. A numberOfStartIterations of 0
+     * uses the configured number of iterations for the starts.
+     *
+     * The registrations of each stage are run concurrently, dividing
+     * the number of threads of this method between them, as with
+     * ExecuteBatch. The transforms are always optimized in place on
+     * copies, so the results have the type of the initial transforms,
+     * and the commands added to this method are not invoked.
+     */
+    std::vector<Transform> ExecuteMultiStart ( const Image &fixed,
+                                               const Image &moving,
+                                               const std::vector<Transform> &initialTransforms,
+                                               unsigned int numberOfStartIterations,
+                                               unsigned int numberOfBest = 1u );
+
 
     /** \brief Get the value of the metric given the state of the method
      *
@@ -546,6 +980,31 @@ namespace simple
      */
     double MetricEvaluate( const Image &fixed, const Image & moving );
 
+    /** \brief Get the values of the metric at many parameters of the
+     * initial transform
+     *
+     * The metric is constructed and configured once, as by
+     * MetricEvaluate, and is evaluated with each parameter vector
+     * set on a copy of the initial transform, such as for the
+     * landscape of the metric or an optimizer of the caller. The
+     * evaluations are distributed between
+     * numberOfParallelEvaluations metrics sharing the threads of this
+     * method. With computeDerivatives, the derivatives of the metric
+     * with respect to the parameters are computed too, and are
+     * returned by GetMetricDerivatives. They have the sign of the
+     * ITKv4 metrics, the direction which decreases the metric, as
+     * followed by the optimizers.
+     */
+    std::vector<double> MetricEvaluate( const Image &fixed,
+                                        const Image &moving,
+                                        const std::vector< std::vector<double> > &parameters,
+                                        unsigned int numberOfParallelEvaluations = 1u,
+                                        bool computeDerivatives = false );
+
+    /** The derivatives of the metric computed by the last MetricEvaluate
+     * of many parameters with computeDerivatives, empty otherwise. */
+    std::vector< std::vector<double> > GetMetricDerivatives() const { return this->m_MetricDerivatives; }
+
 
     /**
       * Active measurements which can be obtained during call backs.
@@ -567,7 +1026,8 @@ namespace simple
       * If the scales are explicitly set then this method returns
       * those values. If an estimator is used then this is an active
       * measurement returning the scales estimated by the estimator
-      * and is only available during execution.
+      * during execution, and the scales last estimated after
+      * execution.
       */
     std::vector<double> GetOptimizerScales() const;
 
@@ -583,19 +1043,40 @@ namespace simple
     template<class TImage>
     double EvaluateInternal ( const Image &fixed, const Image &moving );
 
+    template<class TImage>
+    std::vector<double> BatchEvaluateInternal ( const Image &fixed,
+                                                const Image &moving,
+                                                const std::vector< std::vector<double> > &parameters,
+                                                unsigned int numberOfParallelEvaluations,
+                                                bool computeDerivatives );
+
+    /** Create and initialize the metric of MetricEvaluate, evaluated
+     * with the parameters of transform. A numberOfThreads of 0 uses
+     * the threads of the metric. The returned metric is registered,
+     * the caller has to UnRegister it. */
+    template <class TImageType>
+      itk::ObjectToObjectMetricBaseTemplate<double> *CreateEvaluationMetric( const TImageType *fixed,
+                                                                             const TImageType *moving,
+                                                                             Transform &transform,
+                                                                             unsigned int numberOfThreads );
+
 
     itk::ObjectToObjectOptimizerBaseTemplate<double> *CreateOptimizer( unsigned int numberOfTransformParameters );
 
     template<unsigned int VDimension>
       itk::SpatialObject<VDimension> *CreateSpatialObjectMask(const Image &mask);
 
+    struct MetricComponent;
+
+    MetricComponent GetCurrentMetricComponent( double weight ) const;
+
     template <class TImageType>
       itk::ImageToImageMetricv4<TImageType,
       TImageType,
       TImageType,
       double,
       itk::DefaultImageToImageMetricTraitsv4< TImageType, TImageType, TImageType, double >
-      >* CreateMetric( );
+      >* CreateMetric( const MetricComponent &component );
 
     template <class TImageType>
       void SetupMetric(
@@ -621,6 +1102,40 @@ namespace simple
 
   private:
 
+    template <class TImageType>
+      typename TImageType::ConstPointer GetSmoothedImage( const TImageType *image, double sigma );
+
+    void PrunePyramidCache( const Image &fixed, const Image &moving );
+
+    /** Copy the parameters of the registration from another method,
+     * but not the commands, measurements or active objects. */
+    void CopyConfiguration( const ImageRegistrationMethod &other );
+
+    /** Run each registration job with a private copy of the
+     * configuration, with the given number of jobs concurrently. */
+    void ExecuteParallel( const Image &fixed,
+                          const std::vector<const Image *> &movingImages,
+                          const std::vector<Transform> &initialTransforms,
+                          unsigned int numberOfParallelRegistrations,
+                          unsigned int numberOfIterations,
+                          std::vector<Transform> &transforms,
+                          std::vector<double> &metricValues );
+
+    /** The exhaustive optimizer with the points of its grid
+     * evaluated concurrently, and refined around the best one. */
+    Transform ExecuteExhaustiveParallel( const Image &fixed, const Image &moving );
+
+    /** Evaluated on each iteration of the optimizer. */
+    void CheckStoppingCriteria();
+    void UpdateOptimizerAtLevel( unsigned int level );
+    void WriteCheckpoint( unsigned int completedLevels, itk::TransformBaseTemplate<double> *transform );
+    void ProfileIterationStart();
+    void ProfileIterationEnd();
+    void StopOptimization( const std::string &reason );
+
+    struct BatchRegistrationThreadStruct;
+    friend struct BatchRegistrationThreadStruct;
+
     nsstd::function<unsigned int()> m_pfGetOptimizerIteration;
     nsstd::function<std::vector<double>()> m_pfGetOptimizerPosition;
     nsstd::function<double()> m_pfGetOptimizerLearningRate;
@@ -634,6 +1149,12 @@ namespace simple
 
     nsstd::function<void (itk::TransformBase *outTransform)> m_pfUpdateWithBestValue;
 
+    nsstd::function<void ()> m_pfStopOptimization;
+    nsstd::function<unsigned int ()> m_pfGetMetricNumberOfValidPoints;
+    nsstd::function<void (unsigned int)> m_pfSetOptimizerNumberOfIterations;
+    nsstd::function<void (double)> m_pfSetOptimizerLearningRate;
+    nsstd::function<void (unsigned int)> m_pfSetOptimizerConvergenceWindowSize;
+
     template < class TMemberFunctionPointer >
       struct EvaluateMemberFunctionAddressor
     {
@@ -646,11 +1167,29 @@ namespace simple
         }
     };
 
+    template < class TMemberFunctionPointer >
+      struct BatchEvaluateMemberFunctionAddressor
+    {
+      typedef typename ::detail::FunctionTraits<TMemberFunctionPointer>::ClassType ObjectType;
+
+      template< typename TImageType >
+      TMemberFunctionPointer operator() ( void ) const
+        {
+          return &ObjectType::template BatchEvaluateInternal< TImageType >;
+        }
+    };
+
     typedef Transform (ImageRegistrationMethod::*MemberFunctionType)( const Image &fixed, const Image &moving );
     typedef double (ImageRegistrationMethod::*EvaluateMemberFunctionType)( const Image &fixed, const Image &moving );
+    typedef std::vector<double> (ImageRegistrationMethod::*BatchEvaluateMemberFunctionType)( const Image &fixed,
+                                                                                           const Image &moving,
+                                                                                           const std::vector< std::vector<double> > &parameters,
+                                                                                           unsigned int numberOfParallelEvaluations,
+                                                                                           bool computeDerivatives );
     friend struct detail::MemberFunctionAddressor<MemberFunctionType>;
     nsstd::auto_ptr<detail::MemberFunctionFactory<MemberFunctionType> > m_MemberFactory;
     nsstd::auto_ptr<detail::MemberFunctionFactory<EvaluateMemberFunctionType> > m_EvaluateMemberFactory;
+    nsstd::auto_ptr<detail::MemberFunctionFactory<BatchEvaluateMemberFunctionType> > m_BatchEvaluateMemberFactory;
 
     InterpolatorEnum  m_Interpolator;
     Transform  m_InitialTransform;
@@ -673,7 +1212,8 @@ namespace simple
                          Amoeba,
                          Powell,
                          OnePlusOneEvolutionary,
-                         LBFGS2
+                         LBFGS2,
+                         Adam
     };
     OptimizerType m_OptimizerType;
     double m_OptimizerLearningRate;
@@ -698,6 +1238,8 @@ namespace simple
     bool m_OptimizerTrace;
     std::vector<unsigned int> m_OptimizerNumberOfSteps;
     double m_OptimizerStepLength;
+    unsigned int m_OptimizerNumberOfParallelEvaluations;
+    unsigned int m_OptimizerNumberOfRefinements;
     double m_OptimizerSimplexDelta;
     double m_OptimizerParametersConvergenceTolerance;
     double m_OptimizerFunctionConvergenceTolerance;
@@ -706,6 +1248,8 @@ namespace simple
     double m_OptimizerStepTolerance;
     double m_OptimizerValueTolerance;
     double m_OptimizerEpsilon;
+    double m_OptimizerBeta1;
+    double m_OptimizerBeta2;
     double m_OptimizerInitialRadius;
     double m_OptimizerGrowthFactor;
     double m_OptimizerShrinkFactor;
@@ -733,6 +1277,8 @@ namespace simple
     std::vector<double> m_OptimizerScales;
     unsigned int m_OptimizerScalesCentralRegionRadius;
     double m_OptimizerScalesSmallParameterVariation;
+    bool m_OptimizerScalesReusedAcrossLevels;
+    std::vector<double> m_OptimizerEstimatedScales;
 
     // metric
     enum MetricType { ANTSNeighborhoodCorrelation,
@@ -748,6 +1294,34 @@ namespace simple
     unsigned int m_MetricNumberOfHistogramBins;
     double m_MetricVarianceForJointPDFSmoothing;
 
+    // a metric with its parameters, as a component of the composite metric
+    struct MetricComponent
+    {
+      MetricType m_MetricType;
+      unsigned int m_MetricRadius;
+      double m_MetricIntensityDifferenceThreshold;
+      unsigned int m_MetricNumberOfHistogramBins;
+      double m_MetricVarianceForJointPDFSmoothing;
+      double m_Weight;
+    };
+    std::vector<MetricComponent> m_CompositeMetric;
+    std::vector<double> m_MetricChannelWeights;
+
+    enum LandmarkMetricType { NoLandmarks,
+                              LandmarkEuclideanDistance,
+                              LandmarkExpectation
+    };
+    LandmarkMetricType m_LandmarkMetricType;
+    std::vector<double> m_MetricFixedLandmarks;
+    std::vector<double> m_MetricMovingLandmarks;
+    double m_LandmarkMetricWeight;
+    double m_LandmarkMetricPointSetSigma;
+    unsigned int m_LandmarkMetricEvaluationKNeighborhood;
+
+    // the channels of the vector images during execution
+    std::vector<Image> m_FixedChannels;
+    std::vector<Image> m_MovingChannels;
+
     Image m_MetricFixedMaskImage;
     Image m_MetricMovingMaskImage;
 
@@ -759,11 +1333,56 @@ namespace simple
     bool m_MetricUseMovingImageGradientFilter;
 
     std::vector<unsigned int> m_ShrinkFactorsPerLevel;
+    std::vector< std::vector<unsigned int> > m_ShrinkFactorsPerDimensionPerLevel;
     std::vector<double> m_SmoothingSigmasPerLevel;
     bool m_SmoothingSigmasAreSpecifiedInPhysicalUnits;
 
+    std::vector<unsigned int> m_OptimizerNumberOfIterationsPerLevel;
+    std::vector<double> m_OptimizerLearningRatePerLevel;
+    std::vector<unsigned int> m_OptimizerConvergenceWindowSizePerLevel;
+
+    std::string m_CheckpointFileName;
+    unsigned int m_StartLevel;
+
+    unsigned int m_MetricNumberOfThreads;
+    unsigned int m_SmoothingNumberOfThreads;
+    unsigned int m_OptimizerNumberOfThreads;
+
+    // an image smoothed for a level of the pyramid
+    struct PyramidCacheEntry
+    {
+      Image         m_Image;
+      unsigned long m_ModifiedTime;
+      double        m_Sigma;
+      bool          m_SigmaIsInPhysicalUnits;
+      Image         m_SmoothedImage;
+    };
+    std::vector<PyramidCacheEntry> m_PyramidCache;
+
+    double m_MaximumElapsedTime;
+    unsigned int m_MaximumTotalNumberOfIterations;
+    unsigned int m_MetricConvergenceWindowSize;
+    double m_MetricConvergenceMinimumChange;
+
+    // state of the stopping criteria during execution
+    double m_StartTime;
+    unsigned int m_TotalNumberOfIterations;
+    std::vector<double> m_MetricValueHistory;
+    std::string m_StopReason;
+
+    // measurements of the last execution
+    std::vector<double> m_ProfileLevelInitializationTimes;
+    std::vector<double> m_ProfileLevelOptimizationTimes;
+    std::vector<unsigned int> m_ProfileLevelNumberOfIterations;
+    std::vector<unsigned int> m_ProfileLevelNumberOfValidPoints;
+    unsigned int m_ProfileNumberOfThreadsUsed;
+    double m_ProfileObserverTime;
+    double m_ProfileTotalTime;
+    double m_ProfileIterationStartTime;
+
     std::string m_StopConditionDescription;
     double m_MetricValue;
+    std::vector< std::vector<double> > m_MetricDerivatives;
     unsigned int m_Iteration;
 
     itk::ObjectToObjectOptimizerBaseTemplate<double> *m_ActiveOptimizer;
@@ -0,0 +1,184 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkAdamOptimizerv4_hxx
+#define sitkAdamOptimizerv4_hxx
+
+#include "nsstd/functional.h"
+
+#include <itkGradientDescentOptimizerv4.h>
+
+#include <cmath>
+
+namespace itk {
+namespace simple {
+
+/** \brief A stochastic gradient descent optimizer with the adaptive
+ * moment estimates of Adam.
+ *
+ * Each parameter is moved by the learning rate times the running
+ * mean of its derivative over the square root of the running mean of
+ * its squared derivative, with the bias of the first iterations
+ * corrected. The step of a parameter is bounded by the learning rate
+ * and is robust to the noise of derivatives computed from a few
+ * samples.
+ *
+ * The steps are taken in the parameters multiplied by the square root
+ * of their scales, so that with the scales of the physical shift
+ * estimator the learning rate is a shift in physical units.
+ *
+ * The sample function, when set, is called after each step so that
+ * the metric is evaluated at new sample points at the next
+ * iteration. The learning rate is not estimated.
+ */
+template<typename TInternalComputationValueType>
+class AdamOptimizerv4Template
+  : public GradientDescentOptimizerv4Template<TInternalComputationValueType>
+{
+public:
+  typedef AdamOptimizerv4Template                                            Self;
+  typedef GradientDescentOptimizerv4Template<TInternalComputationValueType> Superclass;
+  typedef SmartPointer< Self >                                               Pointer;
+  typedef SmartPointer< const Self >                                         ConstPointer;
+
+  typedef TInternalComputationValueType        InternalComputationValueType;
+  typedef typename Superclass::DerivativeType  DerivativeType;
+  typedef typename Superclass::ScalesType      ScalesType;
+
+  typedef nsstd::function<void ()> SampleFunctionType;
+
+  itkNewMacro( Self );
+  itkTypeMacro( AdamOptimizerv4Template, GradientDescentOptimizerv4Template );
+
+  itkSetMacro( Beta1, TInternalComputationValueType );
+  itkGetConstMacro( Beta1, TInternalComputationValueType );
+
+  itkSetMacro( Beta2, TInternalComputationValueType );
+  itkGetConstMacro( Beta2, TInternalComputationValueType );
+
+  itkSetMacro( Epsilon, TInternalComputationValueType );
+  itkGetConstMacro( Epsilon, TInternalComputationValueType );
+
+  void SetSampleFunction( const SampleFunctionType &sampleFunction )
+    {
+      m_SampleFunction = sampleFunction;
+    }
+
+  virtual void StartOptimization( bool doOnlyInitialization = false )
+    {
+      // the moments are restarted at each level, where the number of
+      // parameters may change
+      m_FirstMoment.SetSize( 0 );
+      m_SecondMoment.SetSize( 0 );
+      m_NumberOfSteps = 0;
+      Superclass::StartOptimization( doOnlyInitialization );
+    }
+
+protected:
+  AdamOptimizerv4Template()
+    : m_Beta1( 0.9 ),
+      m_Beta2( 0.999 ),
+      m_Epsilon( 1e-8 ),
+      m_NumberOfSteps( 0 )
+    {
+      this->m_DoEstimateLearningRateOnce = false;
+      this->m_DoEstimateLearningRateAtEachIteration = false;
+    }
+
+  virtual void AdvanceOneStep()
+    {
+      itkDebugMacro( "AdvanceOneStep" );
+
+      const SizeValueType numberOfParameters = this->m_Gradient.Size();
+      if ( m_FirstMoment.Size() != numberOfParameters )
+        {
+        m_FirstMoment.SetSize( numberOfParameters );
+        m_FirstMoment.Fill( 0.0 );
+        m_SecondMoment.SetSize( numberOfParameters );
+        m_SecondMoment.Fill( 0.0 );
+        m_NumberOfSteps = 0;
+        }
+      ++m_NumberOfSteps;
+
+      const double firstBiasCorrection = 1.0 - std::pow( double( m_Beta1 ), double( m_NumberOfSteps ) );
+      const double secondBiasCorrection = 1.0 - std::pow( double( m_Beta2 ), double( m_NumberOfSteps ) );
+
+      // the scales and weights are of the local parameters, repeated
+      // for the transforms with local support
+      const ScalesType &scales = this->GetScales();
+      const ScalesType &weights = this->GetWeights();
+      const bool hasScales = !this->GetScalesAreIdentity() && scales.Size() > 0;
+      const bool hasWeights = !this->GetWeightsAreIdentity() && weights.Size() > 0;
+
+      for ( SizeValueType j = 0; j < numberOfParameters; ++j )
+        {
+        const double scale = hasScales ? std::sqrt( double( scales[j % scales.Size()] ) ) : 1.0;
+        double derivative = this->m_Gradient[j] / scale;
+        if ( hasWeights )
+          {
+          derivative *= weights[j % weights.Size()];
+          }
+
+        m_FirstMoment[j] = m_Beta1 * m_FirstMoment[j] + ( 1.0 - m_Beta1 ) * derivative;
+        m_SecondMoment[j] = m_Beta2 * m_SecondMoment[j] + ( 1.0 - m_Beta2 ) * derivative * derivative;
+
+        const double firstMoment = m_FirstMoment[j] / firstBiasCorrection;
+        const double secondMoment = m_SecondMoment[j] / secondBiasCorrection;
+        this->m_Gradient[j] = this->m_LearningRate * firstMoment / ( ( std::sqrt( secondMoment ) + m_Epsilon ) * scale );
+        }
+
+      try
+        {
+        this->m_Metric->UpdateTransformParameters( this->m_Gradient );
+        }
+      catch ( ExceptionObject & err )
+        {
+        this->m_StopCondition = Superclass::UPDATE_PARAMETERS_ERROR;
+        this->m_StopConditionDescription << "UpdateTransformParameters error";
+        this->StopOptimization();
+
+        // Pass exception to caller
+        throw err;
+        }
+
+      if ( m_SampleFunction )
+        {
+        m_SampleFunction();
+        }
+
+      this->InvokeEvent( IterationEvent() );
+    }
+
+private:
+  AdamOptimizerv4Template( const Self & ); //purposely not implemented
+  void operator=( const Self & ); //purposely not implemented
+
+  TInternalComputationValueType m_Beta1;
+  TInternalComputationValueType m_Beta2;
+  TInternalComputationValueType m_Epsilon;
+
+  DerivativeType m_FirstMoment;
+  DerivativeType m_SecondMoment;
+  SizeValueType  m_NumberOfSteps;
+
+  SampleFunctionType m_SampleFunction;
+};
+
+}
+}
+
+#endif
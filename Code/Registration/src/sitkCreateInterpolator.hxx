@@ -23,6 +23,7 @@
 #include <itkNearestNeighborInterpolateImageFunction.h>
 #include <itkLinearInterpolateImageFunction.h>
 #include <itkBSplineInterpolateImageFunction.h>
+#include <itkBSplineResampleImageFunction.h>
 #include <itkGaussianInterpolateImageFunction.h>
 #include <itkLabelImageGaussianInterpolateImageFunction.h>
 #include <itkWindowedSincInterpolateImageFunction.h>
@@ -139,6 +140,11 @@ CreateInterpolator( const TImageType *image, InterpolatorEnum itype )
       typedef itk::WindowedSincInterpolateImageFunction<TImageType, WindowingRadius, WindowFunction, BoundaryCondition> InterpolatorType;
       return RType( ConditionalCreateInterpolator<InterpolatorType>( typename IsBasic<TImageType>::Type() ) );
     }
+    case sitkBSplineResampler:
+    {
+      typedef itk::BSplineResampleImageFunction<TImageType, double> InterpolatorType;
+      return RType( ConditionalCreateInterpolator<InterpolatorType>( typename IsBasic<TImageType>::Type() ) );
+    }
     default:
       return NULL;
     }
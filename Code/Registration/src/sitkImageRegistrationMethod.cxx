@@ -19,16 +19,36 @@
 
 #include "sitkCreateInterpolator.hxx"
 #include "sitkCastImageFilter.h"
+#include "sitkVectorIndexSelectionCastImageFilter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 
 #include "itkImageMaskSpatialObject.h"
 #include "itkImage.h"
 #include "itkImageRegistrationMethodv4.h"
+#include "itkObjectToObjectMultiMetricv4.h"
+#include "itkLabeledPointSetToPointSetMetricv4.h"
+#include "itkEuclideanDistancePointSetToPointSetMetricv4.h"
+#include "itkExpectationBasedPointSetToPointSetMetricv4.h"
+#include "itkDiscreteGaussianImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkRealTimeClock.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkGradientMagnitudeImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithOnlyIndex.h"
+#include "itkCommand.h"
+#include "itkTransformFileWriter.h"
 
 #include "itkRegistrationParameterScalesFromJacobian.h"
 #include "itkRegistrationParameterScalesFromIndexShift.h"
 #include "itkRegistrationParameterScalesFromPhysicalShift.h"
 
 #include "sitkImageRegistrationMethod_CreateParametersAdaptor.hxx"
+#include "sitkAdamOptimizerv4.hxx"
 
 
 template< typename TValue, typename TType>
@@ -59,12 +79,598 @@ struct CurrentLevelCustomCast
       return static_cast<unsigned int>(ret);
     }
 };
+
+
+double GetWallClockTime()
+{
+  itk::RealTimeClock::Pointer clock = itk::RealTimeClock::New();
+  return clock->GetTimeInSeconds();
+}
+
+
+// A number of threads of 0 uses the default number of threads.
+unsigned int NumberOfThreadsOrDefault( unsigned int numberOfThreads, unsigned int defaultNumberOfThreads )
+{
+  return numberOfThreads ? numberOfThreads : defaultNumberOfThreads;
+}
+
+
+// The radical inverse of i in the given base, the coordinate of the
+// Halton sequence.
+double RadicalInverse( itk::SizeValueType i, unsigned int base )
+{
+  double result = 0.0;
+  double f = 1.0 / base;
+  while ( i > 0 )
+    {
+    result += f * ( i % base );
+    i /= base;
+    f /= base;
+    }
+  return result;
+}
+
+
+// A registration method which obtains the smoothed fixed and moving
+// images of each level from a function, so that they may be cached
+// across executions, rather than smoothing them internally.
+template <typename TFixedImage, typename TMovingImage>
+class PyramidCachingRegistrationMethodv4
+  : public itk::ImageRegistrationMethodv4<TFixedImage, TMovingImage>
+{
+public:
+  typedef PyramidCachingRegistrationMethodv4                         Self;
+  typedef itk::ImageRegistrationMethodv4<TFixedImage, TMovingImage> Superclass;
+  typedef itk::SmartPointer<Self>                                    Pointer;
+  typedef itk::SmartPointer<const Self>                              ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(PyramidCachingRegistrationMethodv4, ImageRegistrationMethodv4);
+
+  typedef nsstd::function<typename TFixedImage::ConstPointer (const TFixedImage *, double)>   FixedSmoothingFunctionType;
+  typedef nsstd::function<typename TMovingImage::ConstPointer (const TMovingImage *, double)> MovingSmoothingFunctionType;
+
+  void SetSmoothingFunctions( const FixedSmoothingFunctionType &fixedFunction,
+                              const MovingSmoothingFunctionType &movingFunction )
+    {
+      m_FixedSmoothingFunction = fixedFunction;
+      m_MovingSmoothingFunction = movingFunction;
+    }
+
+  // Sampling strategies in addition to those of the superclass,
+  // which are used with the superclass strategy set to REGULAR.
+  enum CustomSamplingStrategyType {
+    NO_CUSTOM_SAMPLING,
+    STRATIFIED_SAMPLING,
+    HALTON_SAMPLING,
+    GRADIENT_WEIGHTED_SAMPLING,
+    // the REGULAR and RANDOM strategies of the superclass, drawn
+    // from the voxels inside the fixed mask only
+    MASK_REGULAR_SAMPLING,
+    MASK_RANDOM_SAMPLING
+  };
+
+  /** The wall clock times at which the initialization and the
+   * optimization of each level started. */
+  const std::vector<double> &GetLevelStartTimes() const
+    { return m_LevelStartTimes; }
+  const std::vector<double> &GetLevelOptimizationStartTimes() const
+    { return m_LevelOptimizationStartTimes; }
+
+  void SetCustomSamplingStrategy( CustomSamplingStrategyType strategy, unsigned int seed )
+    {
+      m_CustomSamplingStrategy = strategy;
+      m_CustomSamplingSeed = seed;
+    }
+
+  /** The number of fixed and moving image pairs, one for each metric
+   * of a multi-metric. */
+  void SetNumberOfImagePairs( unsigned int n )
+    {
+      m_NumberOfImagePairs = n;
+    }
+
+  typedef nsstd::function<void (unsigned int)> LevelFunctionType;
+  typedef nsstd::function<void (unsigned int, itk::TransformBase *)> LevelCompletedFunctionType;
+
+  /** The function is called with the number of completed levels and
+   * the transform when a level other than the last completes. */
+  void SetLevelCompletedFunction( const LevelCompletedFunctionType &levelCompletedFunction )
+    {
+      m_LevelCompletedFunction = levelCompletedFunction;
+    }
+
+  /** The function is called with the level after it has been
+   * initialized, before its optimization. */
+  void SetLevelFunction( const LevelFunctionType &levelFunction )
+    {
+      m_LevelFunction = levelFunction;
+    }
+
+  /** Initialize the generator of the points drawn by
+   * RedrawMetricSamplePoints. */
+  void SetRedrawSeed( unsigned int seed )
+    {
+      m_RedrawRandomGenerator = itk::Statistics::MersenneTwisterRandomVariateGenerator::New();
+      if ( seed == itk::simple::sitkWallClock )
+        {
+        m_RedrawRandomGenerator->Initialize();
+        }
+      else
+        {
+        m_RedrawRandomGenerator->Initialize( seed );
+        }
+    }
+
+  /** Replace the sample points of the metric by as many points drawn
+   * at random in the virtual domain, for a stochastic optimizer. The
+   * points are replaced in the sampled point set of the metric,
+   * without initializing the metric again. A dense metric is not
+   * changed. */
+  void RedrawMetricSamplePoints()
+    {
+      typedef typename Superclass::ImageMetricType       ImageMetricType;
+      typedef typename ImageMetricType::VirtualImageType VirtualImageType;
+      typedef typename ImageMetricType::VirtualPointSetType VirtualPointSetType;
+      typedef typename VirtualImageType::RegionType      VirtualRegionType;
+      typedef typename VirtualImageType::PointType       VirtualPointType;
+      typedef itk::ContinuousIndex<double, VirtualImageType::ImageDimension> ContinuousIndexType;
+      const unsigned int Dimension = VirtualImageType::ImageDimension;
+
+      std::vector<ImageMetricType *> metrics;
+      typedef typename Superclass::MultiMetricType MultiMetricType;
+      MultiMetricType *multiMetric = dynamic_cast<MultiMetricType *>( this->m_Metric.GetPointer() );
+      if ( multiMetric )
+        {
+        for ( itk::SizeValueType n = 0; n < multiMetric->GetNumberOfMetrics(); ++n )
+          {
+          ImageMetricType *component = dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() );
+          if ( component )
+            {
+            metrics.push_back( component );
+            }
+          }
+        }
+      else if ( ImageMetricType *metric = dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() ) )
+        {
+        metrics.push_back( metric );
+        }
+
+      if ( metrics.empty() || !metrics[0]->GetUseFixedSampledPointSet() || !metrics[0]->GetVirtualSampledPointSet() )
+        {
+        return;
+        }
+      if ( !m_RedrawRandomGenerator )
+        {
+        SetRedrawSeed( itk::simple::sitkWallClock );
+        }
+
+      const VirtualImageType *virtualImage = metrics[0]->GetVirtualImage();
+      const VirtualRegionType virtualRegion = metrics[0]->GetVirtualRegion();
+      const typename ImageMetricType::FixedImageMaskType *fixedMask = metrics[0]->GetFixedImageMask();
+      const itk::SizeValueType numberOfPoints = metrics[0]->GetVirtualSampledPointSet()->GetNumberOfPoints();
+
+      typename VirtualPointSetType::PointsContainer::Pointer points = VirtualPointSetType::PointsContainer::New();
+      points->Reserve( numberOfPoints );
+      for ( itk::SizeValueType i = 0; i < numberOfPoints; ++i )
+        {
+        // the points outside of the mask are drawn again a few times,
+        // so that a small mask does not stall the iteration
+        VirtualPointType point;
+        for ( unsigned int attempt = 0; attempt < 100; ++attempt )
+          {
+          ContinuousIndexType cindex;
+          for ( unsigned int d = 0; d < Dimension; ++d )
+            {
+            cindex[d] = virtualRegion.GetIndex()[d] - 0.5
+              + m_RedrawRandomGenerator->GetVariateWithOpenUpperRange() * virtualRegion.GetSize()[d];
+            }
+          virtualImage->TransformContinuousIndexToPhysicalPoint( cindex, point );
+          if ( !fixedMask || fixedMask->IsInside( point ) )
+            {
+            break;
+            }
+          }
+        points->SetElement( i, point );
+        }
+
+      // the metrics only read the points of their sampled point sets
+      for ( size_t n = 0; n < metrics.size(); ++n )
+        {
+        const_cast<VirtualPointSetType *>( metrics[n]->GetVirtualSampledPointSet() )->SetPoints( points );
+        }
+    }
+
+protected:
+  PyramidCachingRegistrationMethodv4()
+    : m_CustomSamplingStrategy(NO_CUSTOM_SAMPLING),
+      m_CustomSamplingSeed(0),
+      m_NumberOfImagePairs(1)
+    {}
+
+  virtual void SetMetricSamplePoints()
+    {
+      if ( m_CustomSamplingStrategy == NO_CUSTOM_SAMPLING )
+        {
+        Superclass::SetMetricSamplePoints();
+        return;
+        }
+
+      typedef typename Superclass::ImageMetricType    ImageMetricType;
+      typedef typename ImageMetricType::VirtualImageType VirtualImageType;
+      typedef typename VirtualImageType::RegionType   VirtualRegionType;
+      typedef typename Superclass::MetricSamplePointSetType MetricSamplePointSetType;
+      typedef typename MetricSamplePointSetType::PointType  SamplePointType;
+      typedef typename VirtualImageType::PointType    VirtualPointType;
+      typedef itk::ContinuousIndex<double, VirtualImageType::ImageDimension> ContinuousIndexType;
+      const unsigned int Dimension = VirtualImageType::ImageDimension;
+
+      // the components of a multi-metric share the sample points
+      typedef typename Superclass::MultiMetricType MultiMetricType;
+      MultiMetricType *multiMetric = dynamic_cast<MultiMetricType *>( this->m_Metric.GetPointer() );
+      ImageMetricType *metric = SITK_NULLPTR;
+      if ( multiMetric )
+        {
+        metric = dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[0].GetPointer() );
+        }
+      else
+        {
+        metric = dynamic_cast<ImageMetricType *>( this->m_Metric.GetPointer() );
+        }
+      if ( !metric )
+        {
+        itkExceptionMacro( "The sampling strategy requires an image metric." );
+        }
+
+      const VirtualImageType *virtualImage = metric->GetVirtualImage();
+      const VirtualRegionType virtualRegion = metric->GetVirtualRegion();
+      const typename ImageMetricType::FixedImageMaskType *fixedMask = metric->GetFixedImageMask();
+
+      const itk::SizeValueType numberOfVoxels = virtualRegion.GetNumberOfPixels();
+      const itk::SizeValueType sampleCount = std::max<itk::SizeValueType>( 1u,
+        static_cast<itk::SizeValueType>( std::ceil( this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel] * numberOfVoxels ) ) );
+
+      // reproducible for each level with a fixed seed
+      typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+      RandomGeneratorType::Pointer random = RandomGeneratorType::New();
+      if ( m_CustomSamplingSeed == itk::simple::sitkWallClock )
+        {
+        random->Initialize();
+        }
+      else
+        {
+        random->Initialize( m_CustomSamplingSeed + static_cast<unsigned int>( this->m_CurrentLevel ) );
+        }
+
+      std::vector<ContinuousIndexType> sampleIndexes;
+
+      if ( m_CustomSamplingStrategy == MASK_REGULAR_SAMPLING || m_CustomSamplingStrategy == MASK_RANDOM_SAMPLING )
+        {
+        // The voxels inside the mask, searched in the bounding box of
+        // the mask, so the samples are not rejected by the mask.
+        const std::vector<typename VirtualImageType::IndexType> maskIndexes =
+          ComputeMaskIndexes( virtualImage, virtualRegion, fixedMask );
+        const double percentage = this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel];
+
+        if ( m_CustomSamplingStrategy == MASK_REGULAR_SAMPLING )
+          {
+          const size_t stride = std::max<size_t>( 1u, static_cast<size_t>( std::ceil( 1.0 / percentage ) ) );
+          sampleIndexes.reserve( maskIndexes.size() / stride + 1 );
+          for ( size_t i = 0; i < maskIndexes.size(); i += stride )
+            {
+            sampleIndexes.push_back( JitterIndex( maskIndexes[i], random.GetPointer() ) );
+            }
+          }
+        else if ( !maskIndexes.empty() )
+          {
+          const itk::SizeValueType maskSampleCount = std::max<itk::SizeValueType>( 1u,
+            static_cast<itk::SizeValueType>( std::ceil( percentage * maskIndexes.size() ) ) );
+          sampleIndexes.reserve( maskSampleCount );
+          for ( itk::SizeValueType i = 0; i < maskSampleCount; ++i )
+            {
+            const itk::SizeValueType n = random->GetIntegerVariate( static_cast<RandomGeneratorType::IntegerType>( maskIndexes.size() - 1 ) );
+            sampleIndexes.push_back( JitterIndex( maskIndexes[n], random.GetPointer() ) );
+            }
+          }
+        }
+      else if ( m_CustomSamplingStrategy == HALTON_SAMPLING )
+        {
+        // A randomly shifted Halton sequence over the region.
+        static const unsigned int primes[] = {2, 3, 5, 7, 11, 13};
+        sampleIndexes.reserve( sampleCount );
+        double shift[Dimension];
+        for ( unsigned int d = 0; d < Dimension; ++d )
+          {
+          shift[d] = random->GetVariateWithOpenUpperRange();
+          }
+        for ( itk::SizeValueType i = 0; i < sampleCount; ++i )
+          {
+          ContinuousIndexType cindex;
+          for ( unsigned int d = 0; d < Dimension; ++d )
+            {
+            double x = RadicalInverse( i + 1, primes[d] ) + shift[d];
+            x -= std::floor( x );
+            cindex[d] = virtualRegion.GetIndex()[d] - 0.5 + x * virtualRegion.GetSize()[d];
+            }
+          sampleIndexes.push_back( cindex );
+          }
+        }
+      else
+        {
+        // The cumulative weight of the voxels in scan line order; the
+        // weight is uniform for stratified sampling.
+        std::vector<double> cumulativeWeights;
+        if ( m_CustomSamplingStrategy == GRADIENT_WEIGHTED_SAMPLING )
+          {
+          typedef itk::Image<float, Dimension> GradientMagnitudeImageType;
+          typedef itk::GradientMagnitudeImageFilter<TFixedImage, GradientMagnitudeImageType> GradientMagnitudeFilterType;
+          typename GradientMagnitudeFilterType::Pointer gradientMagnitude = GradientMagnitudeFilterType::New();
+          gradientMagnitude->SetInput( this->GetFixedImage() );
+          gradientMagnitude->SetUseImageSpacing( true );
+          gradientMagnitude->Update();
+          const GradientMagnitudeImageType *gradientImage = gradientMagnitude->GetOutput();
+
+          std::vector<double> weights;
+          weights.reserve( numberOfVoxels );
+          double sum = 0.0;
+          itk::ImageRegionConstIteratorWithIndex<VirtualImageType> it( virtualImage, virtualRegion );
+          for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+            {
+            VirtualPointType point;
+            virtualImage->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+            typename GradientMagnitudeImageType::IndexType index;
+            double w = 0.0;
+            if ( gradientImage->TransformPhysicalPointToIndex( point, index ) )
+              {
+              w = gradientImage->GetPixel( index );
+              }
+            weights.push_back( w );
+            sum += w;
+            }
+
+          // a uniform floor, so that flat regions are not excluded
+          const double floor = ( sum > 0.0 ) ? 0.05 * sum / numberOfVoxels : 1.0;
+          cumulativeWeights.resize( numberOfVoxels );
+          double total = 0.0;
+          for ( itk::SizeValueType i = 0; i < numberOfVoxels; ++i )
+            {
+            total += weights[i] + floor;
+            cumulativeWeights[i] = total;
+            }
+          }
+
+        // Systematic sampling of the cumulative weights, with a random
+        // position in each stratum and within the voxel.
+        sampleIndexes.reserve( sampleCount );
+        const double total = cumulativeWeights.empty() ? double( numberOfVoxels ) : cumulativeWeights.back();
+        const double stratumWeight = total / sampleCount;
+        itk::SizeValueType voxel = 0;
+        for ( itk::SizeValueType i = 0; i < sampleCount; ++i )
+          {
+          const double target = ( i + random->GetVariateWithOpenUpperRange() ) * stratumWeight;
+          if ( cumulativeWeights.empty() )
+            {
+            voxel = std::min<itk::SizeValueType>( static_cast<itk::SizeValueType>( target ), numberOfVoxels - 1 );
+            }
+          else
+            {
+            while ( voxel + 1 < numberOfVoxels && cumulativeWeights[voxel] <= target )
+              {
+              ++voxel;
+              }
+            }
+
+          ContinuousIndexType cindex;
+          itk::SizeValueType offset = voxel;
+          for ( unsigned int d = 0; d < Dimension; ++d )
+            {
+            cindex[d] = virtualRegion.GetIndex()[d] + static_cast<double>( offset % virtualRegion.GetSize()[d] )
+              + random->GetVariateWithOpenUpperRange() - 0.5;
+            offset /= virtualRegion.GetSize()[d];
+            }
+          sampleIndexes.push_back( cindex );
+          }
+        }
+
+      typename MetricSamplePointSetType::Pointer samplePointSet = MetricSamplePointSetType::New();
+      samplePointSet->Initialize();
+      itk::SizeValueType index = 0;
+      for ( size_t i = 0; i < sampleIndexes.size(); ++i )
+        {
+        VirtualPointType point;
+        virtualImage->TransformContinuousIndexToPhysicalPoint( sampleIndexes[i], point );
+        if ( !fixedMask || fixedMask->IsInside( point ) )
+          {
+          SamplePointType samplePoint;
+          samplePoint.CastFrom( point );
+          samplePointSet->SetPoint( index++, samplePoint );
+          }
+        }
+
+      if ( multiMetric )
+        {
+        for ( itk::SizeValueType n = 0; n < multiMetric->GetNumberOfMetrics(); ++n )
+          {
+          // point set metrics are not sampled
+          ImageMetricType *component = dynamic_cast<ImageMetricType *>( multiMetric->GetMetricQueue()[n].GetPointer() );
+          if ( component )
+            {
+            component->SetFixedSampledPointSet( samplePointSet );
+            component->SetUseFixedSampledPointSet( true );
+            }
+          }
+        }
+      else
+        {
+        metric->SetFixedSampledPointSet( samplePointSet );
+        metric->SetUseFixedSampledPointSet( true );
+        }
+    }
+
+  virtual void InitializeRegistrationAtEachLevel( const itk::SizeValueType level )
+    {
+      if ( level != 0 && m_LevelCompletedFunction )
+        {
+        m_LevelCompletedFunction( static_cast<unsigned int>( level ), this->GetModifiableTransform() );
+        }
+
+      if ( level == 0 )
+        {
+        m_FixedImages.clear();
+        m_MovingImages.clear();
+        for ( unsigned int n = 0; n < m_NumberOfImagePairs; ++n )
+          {
+          m_FixedImages.push_back( this->GetFixedImage( n ) );
+          m_MovingImages.push_back( this->GetMovingImage( n ) );
+          }
+        m_LevelStartTimes.clear();
+        m_LevelOptimizationStartTimes.clear();
+        }
+      m_LevelStartTimes.push_back( GetWallClockTime() );
+
+      // Pass the smoothed images for this level with a zero sigma, so
+      // the superclass does not smooth them again.
+      const double sigma = this->m_SmoothingSigmasPerLevel[level];
+      for ( unsigned int n = 0; n < m_NumberOfImagePairs; ++n )
+        {
+        this->SetFixedImage( n, m_FixedSmoothingFunction( m_FixedImages[n], sigma ) );
+        this->SetMovingImage( n, m_MovingSmoothingFunction( m_MovingImages[n], sigma ) );
+        }
+      this->m_SmoothingSigmasPerLevel[level] = 0.0;
+      try
+        {
+        Superclass::InitializeRegistrationAtEachLevel( level );
+        }
+      catch ( ... )
+        {
+        this->m_SmoothingSigmasPerLevel[level] = sigma;
+        throw;
+        }
+      this->m_SmoothingSigmasPerLevel[level] = sigma;
+
+      if ( m_LevelFunction )
+        {
+        m_LevelFunction( static_cast<unsigned int>( level ) );
+        }
+      m_LevelOptimizationStartTimes.push_back( GetWallClockTime() );
+    }
+
+private:
+  PyramidCachingRegistrationMethodv4( const Self & ); //purposely not implemented
+
+  template <class TIndex, class TRandomGenerator>
+  static itk::ContinuousIndex<double, TIndex::Dimension> JitterIndex( const TIndex &index, TRandomGenerator *random )
+    {
+      itk::ContinuousIndex<double, TIndex::Dimension> cindex;
+      for ( unsigned int d = 0; d < TIndex::Dimension; ++d )
+        {
+        cindex[d] = index[d] + random->GetVariateWithOpenUpperRange() - 0.5;
+        }
+      return cindex;
+    }
+
+  // The voxels of the virtual region whose centers are inside the
+  // mask, in scan line order. The search is restricted to the
+  // bounding box of the nonzero voxels of an image mask.
+  template <class TVirtualImage, class TMask>
+  static std::vector<typename TVirtualImage::IndexType> ComputeMaskIndexes( const TVirtualImage *virtualImage,
+                                                                            const typename TVirtualImage::RegionType &virtualRegion,
+                                                                            const TMask *mask )
+    {
+      const unsigned int Dimension = TVirtualImage::ImageDimension;
+      typedef typename TVirtualImage::RegionType RegionType;
+      typedef typename TVirtualImage::PointType  PointType;
+
+      RegionType searchRegion = virtualRegion;
+      typedef itk::ImageMaskSpatialObject<Dimension> ImageMaskType;
+      const ImageMaskType *imageMask = dynamic_cast<const ImageMaskType *>( mask );
+      if ( imageMask && imageMask->GetImage() )
+        {
+        const typename ImageMaskType::RegionType maskRegion = imageMask->GetAxisAlignedBoundingBoxRegion();
+        if ( maskRegion.GetNumberOfPixels() == 0 )
+          {
+          return std::vector<typename TVirtualImage::IndexType>();
+          }
+
+        // the virtual voxels covering the corners of the bounding box
+        double lower[Dimension];
+        double upper[Dimension];
+        std::fill( lower, lower + Dimension, itk::NumericTraits<double>::max() );
+        std::fill( upper, upper + Dimension, itk::NumericTraits<double>::NonpositiveMin() );
+        for ( unsigned int corner = 0; corner < ( 1u << Dimension ); ++corner )
+          {
+          itk::ContinuousIndex<double, Dimension> maskIndex;
+          for ( unsigned int d = 0; d < Dimension; ++d )
+            {
+            maskIndex[d] = maskRegion.GetIndex()[d] - 0.5 + ( ( corner >> d ) & 1u ) * maskRegion.GetSize()[d];
+            }
+          PointType point;
+          imageMask->GetImage()->TransformContinuousIndexToPhysicalPoint( maskIndex, point );
+          itk::ContinuousIndex<double, Dimension> virtualIndex;
+          virtualImage->TransformPhysicalPointToContinuousIndex( point, virtualIndex );
+          for ( unsigned int d = 0; d < Dimension; ++d )
+            {
+            lower[d] = std::min( lower[d], virtualIndex[d] );
+            upper[d] = std::max( upper[d], virtualIndex[d] );
+            }
+          }
+        for ( unsigned int d = 0; d < Dimension; ++d )
+          {
+          const itk::IndexValueType first = itk::Math::Floor<itk::IndexValueType>( lower[d] );
+          const itk::IndexValueType last = itk::Math::Ceil<itk::IndexValueType>( upper[d] );
+          searchRegion.SetIndex( d, first );
+          searchRegion.SetSize( d, static_cast<itk::SizeValueType>( std::max<itk::IndexValueType>( 0, last - first + 1 ) ) );
+          }
+        if ( !searchRegion.Crop( virtualRegion ) )
+          {
+          return std::vector<typename TVirtualImage::IndexType>();
+          }
+        }
+
+      std::vector<typename TVirtualImage::IndexType> indexes;
+      // the virtual image is not allocated
+      itk::ImageRegionConstIteratorWithOnlyIndex<TVirtualImage> it( virtualImage, searchRegion );
+      for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+        {
+        PointType point;
+        virtualImage->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+        if ( !mask || mask->IsInside( point ) )
+          {
+          indexes.push_back( it.GetIndex() );
+          }
+        }
+      return indexes;
+    }
+
+  void operator=( const Self & ); //purposely not implemented
+
+  FixedSmoothingFunctionType        m_FixedSmoothingFunction;
+  MovingSmoothingFunctionType       m_MovingSmoothingFunction;
+  LevelFunctionType                 m_LevelFunction;
+  LevelCompletedFunctionType        m_LevelCompletedFunction;
+  CustomSamplingStrategyType        m_CustomSamplingStrategy;
+  unsigned int                      m_CustomSamplingSeed;
+  unsigned int                      m_NumberOfImagePairs;
+  itk::Statistics::MersenneTwisterRandomVariateGenerator::Pointer m_RedrawRandomGenerator;
+  std::vector<double>               m_LevelStartTimes;
+  std::vector<double>               m_LevelOptimizationStartTimes;
+  std::vector<typename TFixedImage::ConstPointer>  m_FixedImages;
+  std::vector<typename TMovingImage::ConstPointer> m_MovingImages;
+};
+
 }
 
 ImageRegistrationMethod::ImageRegistrationMethod()
   : m_Interpolator(sitkLinear),
     m_InitialTransformInPlace(true),
+    m_OptimizerNumberOfParallelEvaluations(1u),
+    m_OptimizerNumberOfRefinements(0u),
     m_OptimizerScalesType(Manual),
+    m_OptimizerScalesReusedAcrossLevels(false),
+    m_LandmarkMetricType(NoLandmarks),
+    m_LandmarkMetricWeight(1.0),
+    m_LandmarkMetricPointSetSigma(1.0),
+    m_LandmarkMetricEvaluationKNeighborhood(50),
     m_MetricSamplingPercentage(1,1.0),
     m_MetricSamplingStrategy(NONE),
     m_MetricSamplingSeed(0u),
@@ -73,6 +679,20 @@ ImageRegistrationMethod::ImageRegistrationMethod()
     m_ShrinkFactorsPerLevel(1, 1),
     m_SmoothingSigmasPerLevel(1,0.0),
     m_SmoothingSigmasAreSpecifiedInPhysicalUnits(true),
+    m_StartLevel(0),
+    m_MetricNumberOfThreads(0),
+    m_SmoothingNumberOfThreads(0),
+    m_OptimizerNumberOfThreads(0),
+    m_MaximumElapsedTime(0.0),
+    m_MaximumTotalNumberOfIterations(0),
+    m_MetricConvergenceWindowSize(0),
+    m_MetricConvergenceMinimumChange(0.0),
+    m_StartTime(0.0),
+    m_TotalNumberOfIterations(0),
+    m_ProfileNumberOfThreadsUsed(0),
+    m_ProfileObserverTime(0.0),
+    m_ProfileTotalTime(0.0),
+    m_ProfileIterationStartTime(0.0),
     m_ActiveOptimizer(NULL)
 {
   m_MemberFactory.reset( new  detail::MemberFunctionFactory<MemberFunctionType>( this ) );
@@ -89,6 +709,12 @@ ImageRegistrationMethod::ImageRegistrationMethod()
   m_EvaluateMemberFactory->RegisterMemberFunctions< RealPixelIDTypeList, 3, EvaluateMemberFunctionAddressorType > ();
   m_EvaluateMemberFactory->RegisterMemberFunctions< RealPixelIDTypeList, 2, EvaluateMemberFunctionAddressorType > ();
 
+  m_BatchEvaluateMemberFactory.reset( new detail::MemberFunctionFactory<BatchEvaluateMemberFunctionType>(this) );
+
+  typedef BatchEvaluateMemberFunctionAddressor<BatchEvaluateMemberFunctionType> BatchEvaluateMemberFunctionAddressorType;
+  m_BatchEvaluateMemberFactory->RegisterMemberFunctions< RealPixelIDTypeList, 3, BatchEvaluateMemberFunctionAddressorType > ();
+  m_BatchEvaluateMemberFactory->RegisterMemberFunctions< RealPixelIDTypeList, 2, BatchEvaluateMemberFunctionAddressorType > ();
+
   this->SetMetricAsMattesMutualInformation();
 
 }
@@ -239,6 +865,70 @@ ImageRegistrationMethod::SetMetricAsMattesMutualInformation( unsigned int number
   return *this;
 }
 
+ImageRegistrationMethod::Self&
+ImageRegistrationMethod::AddMetricToComposite( double weight )
+{
+  m_CompositeMetric.push_back( this->GetCurrentMetricComponent( weight ) );
+  return *this;
+}
+
+ImageRegistrationMethod::Self&
+ImageRegistrationMethod::ClearCompositeMetric( )
+{
+  m_CompositeMetric.clear();
+  return *this;
+}
+
+ImageRegistrationMethod::Self&
+ImageRegistrationMethod::SetMetricLandmarksAsEuclideanDistance( const std::vector<double> &fixedLandmarks,
+                                                                const std::vector<double> &movingLandmarks,
+                                                                double weight )
+{
+  m_LandmarkMetricType = LandmarkEuclideanDistance;
+  m_MetricFixedLandmarks = fixedLandmarks;
+  m_MetricMovingLandmarks = movingLandmarks;
+  m_LandmarkMetricWeight = weight;
+  return *this;
+}
+
+ImageRegistrationMethod::Self&
+ImageRegistrationMethod::SetMetricLandmarksAsExpectation( const std::vector<double> &fixedLandmarks,
+                                                          const std::vector<double> &movingLandmarks,
+                                                          double weight,
+                                                          double pointSetSigma,
+                                                          unsigned int evaluationKNeighborhood )
+{
+  m_LandmarkMetricType = LandmarkExpectation;
+  m_MetricFixedLandmarks = fixedLandmarks;
+  m_MetricMovingLandmarks = movingLandmarks;
+  m_LandmarkMetricWeight = weight;
+  m_LandmarkMetricPointSetSigma = pointSetSigma;
+  m_LandmarkMetricEvaluationKNeighborhood = evaluationKNeighborhood;
+  return *this;
+}
+
+ImageRegistrationMethod::Self&
+ImageRegistrationMethod::ClearMetricLandmarks( )
+{
+  m_LandmarkMetricType = NoLandmarks;
+  m_MetricFixedLandmarks.clear();
+  m_MetricMovingLandmarks.clear();
+  return *this;
+}
+
+ImageRegistrationMethod::MetricComponent
+ImageRegistrationMethod::GetCurrentMetricComponent( double weight ) const
+{
+  MetricComponent component;
+  component.m_MetricType = m_MetricType;
+  component.m_MetricRadius = m_MetricRadius;
+  component.m_MetricIntensityDifferenceThreshold = m_MetricIntensityDifferenceThreshold;
+  component.m_MetricNumberOfHistogramBins = m_MetricNumberOfHistogramBins;
+  component.m_MetricVarianceForJointPDFSmoothing = m_MetricVarianceForJointPDFSmoothing;
+  component.m_Weight = weight;
+  return component;
+}
+
 
 ImageRegistrationMethod::Self&
 ImageRegistrationMethod::SetOptimizerAsConjugateGradientLineSearch( double learningRate,
@@ -304,6 +994,26 @@ ImageRegistrationMethod::SetOptimizerAsGradientDescent( double learningRate,
   return *this;
 }
 
+ImageRegistrationMethod::Self&
+ImageRegistrationMethod::SetOptimizerAsAdam( double learningRate,
+                                             unsigned int numberOfIterations,
+                                             double beta1,
+                                             double beta2,
+                                             double epsilon,
+                                             double convergenceMinimumValue,
+                                             unsigned int convergenceWindowSize )
+{
+  m_OptimizerType = Adam;
+  m_OptimizerLearningRate = learningRate;
+  m_OptimizerNumberOfIterations = numberOfIterations;
+  m_OptimizerBeta1 = beta1;
+  m_OptimizerBeta2 = beta2;
+  m_OptimizerEpsilon = epsilon;
+  m_OptimizerConvergenceMinimumValue = convergenceMinimumValue;
+  m_OptimizerConvergenceWindowSize = convergenceWindowSize;
+  return *this;
+}
+
 ImageRegistrationMethod::Self&
 ImageRegistrationMethod::SetOptimizerAsGradientDescentLineSearch( double learningRate,
                                                                   unsigned int numberOfIterations,
@@ -394,11 +1104,15 @@ ImageRegistrationMethod::GetOptimizerWeights( ) const
 
 ImageRegistrationMethod::Self&
 ImageRegistrationMethod::SetOptimizerAsExhaustive(const std::vector<unsigned int> &numberOfSteps,
-                                                  double stepLength )
+                                                  double stepLength,
+                                                  unsigned int numberOfParallelEvaluations,
+                                                  unsigned int numberOfRefinements )
 {
   m_OptimizerType = Exhaustive;
   m_OptimizerStepLength = stepLength;
   m_OptimizerNumberOfSteps = numberOfSteps;
+  m_OptimizerNumberOfParallelEvaluations = numberOfParallelEvaluations;
+  m_OptimizerNumberOfRefinements = numberOfRefinements;
   return *this;
 }
 
@@ -551,6 +1265,92 @@ ImageRegistrationMethod::Self&
 ImageRegistrationMethod::SetShrinkFactorsPerLevel( const std::vector<unsigned int> &shrinkFactors )
 {
   this->m_ShrinkFactorsPerLevel = shrinkFactors;
+  this->m_ShrinkFactorsPerDimensionPerLevel.clear();
+  return *this;
+}
+
+ImageRegistrationMethod::Self&
+ImageRegistrationMethod::SetShrinkFactorsPerDimensionPerLevel( const std::vector< std::vector<unsigned int> > &shrinkFactors )
+{
+  // the largest factor of each level is the shrink factor of the level
+  this->m_ShrinkFactorsPerLevel.clear();
+  for ( size_t level = 0; level < shrinkFactors.size(); ++level )
+    {
+    if ( shrinkFactors[level].empty() )
+      {
+      sitkExceptionMacro( "The shrink factors of level " << level << " are empty!" );
+      }
+    this->m_ShrinkFactorsPerLevel.push_back( *std::max_element( shrinkFactors[level].begin(), shrinkFactors[level].end() ) );
+    }
+  this->m_ShrinkFactorsPerDimensionPerLevel = shrinkFactors;
+  return *this;
+}
+
+ImageRegistrationMethod::Self&
+ImageRegistrationMethod::SetMultiResolutionScheduleFromImage( const Image &image,
+                                                              uint64_t coarsestNumberOfPixels,
+                                                              unsigned int maximumNumberOfLevels )
+{
+  if ( maximumNumberOfLevels == 0 )
+    {
+    sitkExceptionMacro( "The maximum number of levels is 0!" );
+    }
+
+  const std::vector<unsigned int> size = image.GetSize();
+  const std::vector<double> spacing = image.GetSpacing();
+  const unsigned int dimension = image.GetDimension();
+  const unsigned int minimumShrunkenSize = 4u;
+
+  // the levels from the finest, with the spacing of the level doubled
+  // at each coarser level
+  std::vector< std::vector<unsigned int> > shrinkFactors( 1, std::vector<unsigned int>( dimension, 1u ) );
+  double levelSpacing = *std::min_element( spacing.begin(), spacing.end() );
+  while ( shrinkFactors.size() < maximumNumberOfLevels )
+    {
+    const std::vector<unsigned int> &finerFactors = shrinkFactors.back();
+
+    uint64_t numberOfPixels = 1u;
+    for ( unsigned int d = 0; d < dimension; ++d )
+      {
+      numberOfPixels *= size[d] / finerFactors[d];
+      }
+    if ( numberOfPixels <= coarsestNumberOfPixels )
+      {
+      break;
+      }
+
+    levelSpacing *= 2.0;
+    std::vector<unsigned int> factors( dimension );
+    for ( unsigned int d = 0; d < dimension; ++d )
+      {
+      unsigned int factor = static_cast<unsigned int>( std::floor( levelSpacing / spacing[d] + 0.5 ) );
+      factor = std::min( factor, size[d] / minimumShrunkenSize );
+      factors[d] = std::max( factor, finerFactors[d] );
+      }
+    if ( factors == finerFactors )
+      {
+      // the dimensions may not be shrunk more
+      break;
+      }
+    shrinkFactors.push_back( factors );
+    }
+  std::reverse( shrinkFactors.begin(), shrinkFactors.end() );
+
+  std::vector<double> smoothingSigmas( shrinkFactors.size(), 0.0 );
+  for ( size_t level = 0; level < shrinkFactors.size(); ++level )
+    {
+    for ( unsigned int d = 0; d < dimension; ++d )
+      {
+      if ( shrinkFactors[level][d] > 1u )
+        {
+        smoothingSigmas[level] = std::max( smoothingSigmas[level], 0.5 * spacing[d] * shrinkFactors[level][d] );
+        }
+      }
+    }
+
+  this->SetShrinkFactorsPerDimensionPerLevel( shrinkFactors );
+  this->m_SmoothingSigmasPerLevel = smoothingSigmas;
+  this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits = true;
   return *this;
 }
 
@@ -568,65 +1368,320 @@ ImageRegistrationMethod::SetSmoothingSigmasAreSpecifiedInPhysicalUnits(bool arg)
   return *this;
 }
 
-std::string ImageRegistrationMethod::GetOptimizerStopConditionDescription() const
+ImageRegistrationMethod::Self&
+ImageRegistrationMethod::SetMetricConvergenceCriterion( unsigned int windowSize, double minimumChange )
 {
-  if (bool(this->m_pfGetOptimizerStopConditionDescription))
-    {
-    return this->m_pfGetOptimizerStopConditionDescription();
-    }
-  return this->m_StopConditionDescription;
+  m_MetricConvergenceWindowSize = windowSize;
+  m_MetricConvergenceMinimumChange = minimumChange;
+  return *this;
 }
 
-unsigned int ImageRegistrationMethod::GetOptimizerIteration() const
+void ImageRegistrationMethod::StopRegistration()
 {
-  if (bool(this->m_pfGetOptimizerIteration))
-    {
-    return this->m_pfGetOptimizerIteration();
-    }
-  return this->m_Iteration;
+  this->StopOptimization( "StopRegistration was called." );
 }
 
-
-std::vector<double> ImageRegistrationMethod::GetOptimizerPosition() const
+void ImageRegistrationMethod::StopOptimization( const std::string &reason )
 {
-  if(bool(this->m_pfGetOptimizerPosition))
+  if ( m_StopReason.empty() )
     {
-    return this->m_pfGetOptimizerPosition();
+    m_StopReason = reason;
+    sitkDebugMacro( "Stopping registration: " << reason );
     }
-  return std::vector<double>();
-}
-
-
-double ImageRegistrationMethod::GetOptimizerLearningRate() const
-{
-  if(bool(this->m_pfGetOptimizerLearningRate))
+  if ( m_pfStopOptimization )
     {
-    return this->m_pfGetOptimizerLearningRate();
+    m_pfStopOptimization();
     }
-  return 0.0;
 }
 
-
-double ImageRegistrationMethod::GetOptimizerConvergenceValue() const
+void ImageRegistrationMethod::CheckStoppingCriteria()
 {
-  if(bool(this->m_pfGetOptimizerConvergenceValue))
+  ++m_TotalNumberOfIterations;
+
+  // stop the remaining levels
+  if ( !m_StopReason.empty() )
     {
-    return this->m_pfGetOptimizerConvergenceValue();
+    this->StopOptimization( m_StopReason );
+    return;
     }
-  return 0.0;
-}
-
 
-double ImageRegistrationMethod::GetMetricValue() const
-{
-  if(bool(this->m_pfGetMetricValue))
+  if ( m_MaximumTotalNumberOfIterations != 0 && m_TotalNumberOfIterations >= m_MaximumTotalNumberOfIterations )
     {
-    return this->m_pfGetMetricValue();
+    std::ostringstream msg;
+    msg << "Maximum total number of iterations (" << m_MaximumTotalNumberOfIterations << ") reached.";
+    this->StopOptimization( msg.str() );
+    return;
     }
-  return m_MetricValue;
-}
 
-std::vector<double> ImageRegistrationMethod::GetOptimizerScales() const
+  if ( m_MaximumElapsedTime > 0.0 && GetWallClockTime() - m_StartTime >= m_MaximumElapsedTime )
+    {
+    std::ostringstream msg;
+    msg << "Maximum elapsed time (" << m_MaximumElapsedTime << " s) reached.";
+    this->StopOptimization( msg.str() );
+    return;
+    }
+
+  if ( m_MetricConvergenceWindowSize != 0 )
+    {
+    m_MetricValueHistory.push_back( this->GetMetricValue() );
+    if ( m_MetricValueHistory.size() > m_MetricConvergenceWindowSize )
+      {
+      m_MetricValueHistory.erase( m_MetricValueHistory.begin() );
+      }
+    if ( m_MetricValueHistory.size() == m_MetricConvergenceWindowSize )
+      {
+      const double change = *std::max_element( m_MetricValueHistory.begin(), m_MetricValueHistory.end() )
+        - *std::min_element( m_MetricValueHistory.begin(), m_MetricValueHistory.end() );
+      if ( change < m_MetricConvergenceMinimumChange )
+        {
+        std::ostringstream msg;
+        msg << "Metric changed by " << change << " over the last " << m_MetricConvergenceWindowSize << " iterations.";
+        this->StopOptimization( msg.str() );
+        }
+      }
+    }
+}
+
+ImageRegistrationMethod::Self&
+ImageRegistrationMethod::ResumeFromCheckpoint( const std::string &fileName, bool inPlace )
+{
+  const std::string levelFileName = fileName + ".level";
+  std::ifstream levelFile( levelFileName.c_str() );
+  unsigned int completedLevels = 0;
+  if ( !( levelFile >> completedLevels ) )
+    {
+    sitkExceptionMacro( "Unable to read the completed levels of the checkpoint from \"" << levelFileName << "\"!" );
+    }
+
+  Transform transform = ReadTransform( fileName );
+  this->SetInitialTransform( transform, inPlace );
+  this->SetStartLevel( completedLevels );
+  return *this;
+}
+
+void ImageRegistrationMethod::WriteCheckpoint( unsigned int completedLevels, itk::TransformBaseTemplate<double> *transform )
+{
+  sitkDebugMacro( "Writing checkpoint after " << completedLevels << " levels to \"" << m_CheckpointFileName << "\"" );
+
+  // Each file is written then renamed, so that an interrupted write
+  // does not damage the previous checkpoint. The transform is
+  // renamed first, so the completed levels never exceed those of
+  // the transform.
+  const std::string levelFileName = m_CheckpointFileName + ".level";
+  const std::string temporarySuffix = ".tmp";
+
+  // keep the extension, which selects the transform file format
+  const std::string::size_type dot = m_CheckpointFileName.find_last_of( '.' );
+  const std::string::size_type slash = m_CheckpointFileName.find_last_of( "/\\" );
+  std::string temporaryFileName = m_CheckpointFileName + temporarySuffix;
+  if ( dot != std::string::npos && ( slash == std::string::npos || dot > slash ) )
+    {
+    temporaryFileName = m_CheckpointFileName.substr( 0, dot ) + temporarySuffix + m_CheckpointFileName.substr( dot );
+    }
+
+  typedef itk::TransformFileWriterTemplate<double> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput( transform );
+  writer->SetFileName( temporaryFileName );
+  writer->Update();
+  std::remove( m_CheckpointFileName.c_str() );
+  if ( std::rename( temporaryFileName.c_str(), m_CheckpointFileName.c_str() ) != 0 )
+    {
+    sitkExceptionMacro( "Unable to write the checkpoint transform to \"" << m_CheckpointFileName << "\"!" );
+    }
+
+  const std::string temporaryLevelFileName = levelFileName + temporarySuffix;
+    {
+    std::ofstream levelFile( temporaryLevelFileName.c_str() );
+    levelFile << completedLevels << std::endl;
+    if ( !levelFile )
+      {
+      sitkExceptionMacro( "Unable to write the checkpoint levels to \"" << temporaryLevelFileName << "\"!" );
+      }
+    }
+  std::remove( levelFileName.c_str() );
+  if ( std::rename( temporaryLevelFileName.c_str(), levelFileName.c_str() ) != 0 )
+    {
+    sitkExceptionMacro( "Unable to write the checkpoint levels to \"" << levelFileName << "\"!" );
+    }
+}
+
+void ImageRegistrationMethod::ProfileIterationStart()
+{
+  m_ProfileIterationStartTime = GetWallClockTime();
+
+  // the measurements are of the executed levels
+  const unsigned int level = this->GetCurrentLevel() - m_StartLevel;
+  if ( m_ProfileLevelNumberOfIterations.size() <= level )
+    {
+    m_ProfileLevelNumberOfIterations.resize( level + 1, 0u );
+    m_ProfileLevelNumberOfValidPoints.resize( level + 1, 0u );
+    }
+  ++m_ProfileLevelNumberOfIterations[level];
+  if ( m_pfGetMetricNumberOfValidPoints )
+    {
+    m_ProfileLevelNumberOfValidPoints[level] = m_pfGetMetricNumberOfValidPoints();
+    }
+}
+
+void ImageRegistrationMethod::ProfileIterationEnd()
+{
+  m_ProfileObserverTime += GetWallClockTime() - m_ProfileIterationStartTime;
+}
+
+void ImageRegistrationMethod::UpdateOptimizerAtLevel( unsigned int executedLevel )
+{
+  const unsigned int level = executedLevel + m_StartLevel;
+  if ( !m_OptimizerNumberOfIterationsPerLevel.empty() )
+    {
+    m_pfSetOptimizerNumberOfIterations( m_OptimizerNumberOfIterationsPerLevel[level] );
+    }
+  if ( !m_OptimizerLearningRatePerLevel.empty() )
+    {
+    m_pfSetOptimizerLearningRate( m_OptimizerLearningRatePerLevel[level] );
+    }
+  if ( !m_OptimizerConvergenceWindowSizePerLevel.empty() )
+    {
+    m_pfSetOptimizerConvergenceWindowSize( m_OptimizerConvergenceWindowSizePerLevel[level] );
+    }
+
+  // The scales of the previous level are reused when the transform
+  // adaptor has kept the number of parameters.
+  if ( m_OptimizerScalesReusedAcrossLevels && m_OptimizerScalesType != Manual )
+    {
+    const bool reuseScales = executedLevel != 0
+      && m_ActiveOptimizer->GetScales().Size() == m_ActiveOptimizer->GetMetric()->GetNumberOfParameters();
+    m_ActiveOptimizer->SetDoEstimateScales( !reuseScales );
+    }
+}
+
+void ImageRegistrationMethod::ClearCache()
+{
+  m_PyramidCache.clear();
+}
+
+void ImageRegistrationMethod::PrunePyramidCache( const Image &fixed, const Image &moving )
+{
+  std::vector<PyramidCacheEntry> cache;
+  for ( size_t i = 0; i < m_PyramidCache.size(); ++i )
+    {
+    const itk::DataObject *image = m_PyramidCache[i].m_Image.GetITKBase();
+    if ( image == fixed.GetITKBase() || image == moving.GetITKBase() )
+      {
+      cache.push_back( m_PyramidCache[i] );
+      }
+    }
+  m_PyramidCache.swap( cache );
+}
+
+template <class TImageType>
+typename TImageType::ConstPointer
+ImageRegistrationMethod::GetSmoothedImage( const TImageType *image, double sigma )
+{
+  if ( sigma == 0.0 )
+    {
+    return image;
+    }
+
+  for ( size_t i = 0; i < m_PyramidCache.size(); ++i )
+    {
+    const PyramidCacheEntry &entry = m_PyramidCache[i];
+    if ( entry.m_Image.GetITKBase() == image
+         && entry.m_ModifiedTime == image->GetMTime()
+         && entry.m_Sigma == sigma
+         && entry.m_SigmaIsInPhysicalUnits == m_SmoothingSigmasAreSpecifiedInPhysicalUnits )
+      {
+      sitkDebugMacro( "Using cached smoothed image for sigma " << sigma );
+      return dynamic_cast<const TImageType *>( entry.m_SmoothedImage.GetITKBase() );
+      }
+    }
+
+  // The same smoothing as performed by itk::ImageRegistrationMethodv4
+  typedef itk::DiscreteGaussianImageFilter<TImageType, TImageType> SmoothingFilterType;
+  typename SmoothingFilterType::Pointer smoothingFilter = SmoothingFilterType::New();
+  smoothingFilter->SetUseImageSpacing( m_SmoothingSigmasAreSpecifiedInPhysicalUnits );
+  smoothingFilter->SetVariance( sigma * sigma );
+  smoothingFilter->SetMaximumError( 0.01 );
+  smoothingFilter->SetNumberOfThreads( NumberOfThreadsOrDefault( m_SmoothingNumberOfThreads, this->GetNumberOfThreads() ) );
+  smoothingFilter->SetInput( image );
+  smoothingFilter->Update();
+
+  typename TImageType::Pointer smoothed = smoothingFilter->GetOutput();
+  smoothed->DisconnectPipeline();
+
+  // The entry holds a reference to the input image, so a modification
+  // of the image through SimpleITK makes a new image for which the
+  // entry does not match.
+  PyramidCacheEntry entry;
+  entry.m_Image = Image( const_cast<TImageType *>( image ) );
+  entry.m_ModifiedTime = image->GetMTime();
+  entry.m_Sigma = sigma;
+  entry.m_SigmaIsInPhysicalUnits = m_SmoothingSigmasAreSpecifiedInPhysicalUnits;
+  entry.m_SmoothedImage = Image( smoothed.GetPointer() );
+  m_PyramidCache.push_back( entry );
+
+  return smoothed.GetPointer();
+}
+
+std::string ImageRegistrationMethod::GetOptimizerStopConditionDescription() const
+{
+  if (bool(this->m_pfGetOptimizerStopConditionDescription))
+    {
+    return this->m_pfGetOptimizerStopConditionDescription();
+    }
+  return this->m_StopConditionDescription;
+}
+
+unsigned int ImageRegistrationMethod::GetOptimizerIteration() const
+{
+  if (bool(this->m_pfGetOptimizerIteration))
+    {
+    return this->m_pfGetOptimizerIteration();
+    }
+  return this->m_Iteration;
+}
+
+
+std::vector<double> ImageRegistrationMethod::GetOptimizerPosition() const
+{
+  if(bool(this->m_pfGetOptimizerPosition))
+    {
+    return this->m_pfGetOptimizerPosition();
+    }
+  return std::vector<double>();
+}
+
+
+double ImageRegistrationMethod::GetOptimizerLearningRate() const
+{
+  if(bool(this->m_pfGetOptimizerLearningRate))
+    {
+    return this->m_pfGetOptimizerLearningRate();
+    }
+  return 0.0;
+}
+
+
+double ImageRegistrationMethod::GetOptimizerConvergenceValue() const
+{
+  if(bool(this->m_pfGetOptimizerConvergenceValue))
+    {
+    return this->m_pfGetOptimizerConvergenceValue();
+    }
+  return 0.0;
+}
+
+
+double ImageRegistrationMethod::GetMetricValue() const
+{
+  if(bool(this->m_pfGetMetricValue))
+    {
+    return this->m_pfGetMetricValue();
+    }
+  return m_MetricValue;
+}
+
+std::vector<double> ImageRegistrationMethod::GetOptimizerScales() const
 {
   if(this->m_OptimizerScalesType==Manual)
     {
@@ -636,7 +1691,7 @@ std::vector<double> ImageRegistrationMethod::GetOptimizerScales() const
     {
     return this->m_pfGetOptimizerScales();
     }
-  return std::vector<double>();
+  return m_OptimizerEstimatedScales;
 }
 
 
@@ -737,6 +1792,50 @@ Transform ImageRegistrationMethod::Execute ( const Image &fixed, const Image & m
                          << fixed.GetDimension() << " and " << moving.GetDimension() );
     }
 
+  if ( fixedType == sitkVectorFloat32 || fixedType == sitkVectorFloat64 )
+    {
+    // register the channels together, with the metric for each
+    if ( fixed.GetNumberOfComponentsPerPixel() != moving.GetNumberOfComponentsPerPixel() )
+      {
+      sitkExceptionMacro ( << "Fixed and moving images must have the same number of components! Got "
+                           << fixed.GetNumberOfComponentsPerPixel() << " and " << moving.GetNumberOfComponentsPerPixel() );
+      }
+    const unsigned int numberOfChannels = fixed.GetNumberOfComponentsPerPixel();
+    if ( !m_MetricChannelWeights.empty() && m_MetricChannelWeights.size() != numberOfChannels )
+      {
+      sitkExceptionMacro ( << "Number of metric channel weights and image components don't match!" );
+      }
+
+    m_FixedChannels.clear();
+    m_MovingChannels.clear();
+    for ( unsigned int c = 0; c < numberOfChannels; ++c )
+      {
+      m_FixedChannels.push_back( VectorIndexSelectionCast( fixed, c ) );
+      m_MovingChannels.push_back( VectorIndexSelectionCast( moving, c ) );
+      }
+
+    const PixelIDValueType channelType = m_FixedChannels[0].GetPixelIDValue();
+    try
+      {
+      Transform result = this->m_MemberFactory->GetMemberFunction( channelType, fixedDim )( m_FixedChannels[0], m_MovingChannels[0] );
+      m_FixedChannels.clear();
+      m_MovingChannels.clear();
+      return result;
+      }
+    catch ( ... )
+      {
+      m_FixedChannels.clear();
+      m_MovingChannels.clear();
+      throw;
+      }
+    }
+
+  if ( m_OptimizerType == Exhaustive
+       && ( m_OptimizerNumberOfParallelEvaluations > 1 || m_OptimizerNumberOfRefinements > 0 ) )
+    {
+    return this->ExecuteExhaustiveParallel( fixed, moving );
+    }
+
   if (this->m_MemberFactory->HasMemberFunction( fixedType, fixedDim ) )
     {
     return this->m_MemberFactory->GetMemberFunction( fixedType, fixedDim )( fixed, moving );
@@ -746,6 +1845,445 @@ Transform ImageRegistrationMethod::Execute ( const Image &fixed, const Image & m
 
 }
 
+
+Transform ImageRegistrationMethod::ExecuteExhaustiveParallel ( const Image &fixed, const Image &moving )
+{
+  const unsigned int numberOfParameters = this->m_InitialTransform.GetNumberOfParameters();
+  if ( m_OptimizerNumberOfSteps.size() != numberOfParameters )
+    {
+    sitkExceptionMacro( << "The number of steps of the exhaustive optimizer has " << m_OptimizerNumberOfSteps.size()
+                        << " values, but the initial transform has " << numberOfParameters << " parameters!" );
+    }
+
+  std::vector<double> scales( numberOfParameters, 1.0 );
+  if ( m_OptimizerScalesType == Manual && m_OptimizerScales.size() == numberOfParameters )
+    {
+    scales = m_OptimizerScales;
+    }
+
+  size_t numberOfPoints = 1;
+  for ( unsigned int p = 0; p < numberOfParameters; ++p )
+    {
+    numberOfPoints *= 2 * m_OptimizerNumberOfSteps[p] + 1;
+    }
+
+  m_StartTime = GetWallClockTime();
+
+  std::vector<double> bestPosition = this->m_InitialTransform.GetParameters();
+  double bestValue = std::numeric_limits<double>::max();
+  double stepLength = m_OptimizerStepLength;
+  for ( unsigned int refinement = 0; refinement <= m_OptimizerNumberOfRefinements; ++refinement )
+    {
+    // the points of the grid around the best position, the first
+    // parameter the fastest as by the ExhaustiveOptimizerv4
+    const std::vector<double> center = bestPosition;
+    std::vector< std::vector<double> > grid( numberOfPoints, center );
+    for ( size_t i = 0; i < numberOfPoints; ++i )
+      {
+      size_t remainder = i;
+      for ( unsigned int p = 0; p < numberOfParameters; ++p )
+        {
+        const size_t steps = 2 * m_OptimizerNumberOfSteps[p] + 1;
+        const double step = static_cast<double>( remainder % steps ) - m_OptimizerNumberOfSteps[p];
+        grid[i][p] += step * stepLength * scales[p];
+        remainder /= steps;
+        }
+      }
+
+    const std::vector<double> values = this->MetricEvaluate( fixed, moving, grid, m_OptimizerNumberOfParallelEvaluations );
+    for ( size_t i = 0; i < numberOfPoints; ++i )
+      {
+      if ( values[i] < bestValue )
+        {
+        bestValue = values[i];
+        bestPosition = grid[i];
+        }
+      }
+    stepLength *= 0.5;
+    }
+
+  m_MetricValue = bestValue;
+  m_Iteration = static_cast<unsigned int>( numberOfPoints * ( m_OptimizerNumberOfRefinements + 1 ) );
+  std::ostringstream description;
+  description << "ImageRegistrationMethod: Exhaustive search of " << m_Iteration << " points completed.";
+  m_StopConditionDescription = description.str();
+  m_ProfileTotalTime = GetWallClockTime() - m_StartTime;
+
+  if ( this->m_InitialTransformInPlace )
+    {
+    // the ITK transform is shared with the transform of the caller
+    itk::TransformBase::ParametersType itkParameters( numberOfParameters );
+    std::copy( bestPosition.begin(), bestPosition.end(), itkParameters.begin() );
+    this->m_InitialTransform.GetITKBase()->SetParametersByValue( itkParameters );
+    return this->m_InitialTransform;
+    }
+
+  Transform result = this->m_InitialTransform;
+  result.MakeUnique();
+  result.SetParameters( bestPosition );
+  return result;
+}
+
+
+void ImageRegistrationMethod::CopyConfiguration( const ImageRegistrationMethod &other )
+{
+  this->SetDebug( other.GetDebug() );
+  this->SetNumberOfThreads( other.GetNumberOfThreads() );
+
+  m_Interpolator = other.m_Interpolator;
+  m_InitialTransform = other.m_InitialTransform;
+  m_InitialTransformInPlace = other.m_InitialTransformInPlace;
+  m_MovingInitialTransform = other.m_MovingInitialTransform;
+  m_FixedInitialTransform = other.m_FixedInitialTransform;
+  m_VirtualDomainSize = other.m_VirtualDomainSize;
+  m_VirtualDomainOrigin = other.m_VirtualDomainOrigin;
+  m_VirtualDomainSpacing = other.m_VirtualDomainSpacing;
+  m_VirtualDomainDirection = other.m_VirtualDomainDirection;
+  m_OptimizerType = other.m_OptimizerType;
+  m_OptimizerLearningRate = other.m_OptimizerLearningRate;
+  m_OptimizerMinimumStepLength = other.m_OptimizerMinimumStepLength;
+  m_OptimizerNumberOfIterations = other.m_OptimizerNumberOfIterations;
+  m_OptimizerLineSearchLowerLimit = other.m_OptimizerLineSearchLowerLimit;
+  m_OptimizerLineSearchUpperLimit = other.m_OptimizerLineSearchUpperLimit;
+  m_OptimizerLineSearchEpsilon = other.m_OptimizerLineSearchEpsilon;
+  m_OptimizerLineSearchMaximumIterations = other.m_OptimizerLineSearchMaximumIterations;
+  m_OptimizerEstimateLearningRate = other.m_OptimizerEstimateLearningRate;
+  m_OptimizerMaximumStepSizeInPhysicalUnits = other.m_OptimizerMaximumStepSizeInPhysicalUnits;
+  m_OptimizerRelaxationFactor = other.m_OptimizerRelaxationFactor;
+  m_OptimizerGradientMagnitudeTolerance = other.m_OptimizerGradientMagnitudeTolerance;
+  m_OptimizerConvergenceMinimumValue = other.m_OptimizerConvergenceMinimumValue;
+  m_OptimizerConvergenceWindowSize = other.m_OptimizerConvergenceWindowSize;
+  m_OptimizerGradientConvergenceTolerance = other.m_OptimizerGradientConvergenceTolerance;
+  m_OptimizerMaximumNumberOfCorrections = other.m_OptimizerMaximumNumberOfCorrections;
+  m_OptimizerMaximumNumberOfFunctionEvaluations = other.m_OptimizerMaximumNumberOfFunctionEvaluations;
+  m_OptimizerCostFunctionConvergenceFactor = other.m_OptimizerCostFunctionConvergenceFactor;
+  m_OptimizerLowerBound = other.m_OptimizerLowerBound;
+  m_OptimizerUpperBound = other.m_OptimizerUpperBound;
+  m_OptimizerTrace = other.m_OptimizerTrace;
+  m_OptimizerNumberOfSteps = other.m_OptimizerNumberOfSteps;
+  m_OptimizerStepLength = other.m_OptimizerStepLength;
+  m_OptimizerNumberOfParallelEvaluations = other.m_OptimizerNumberOfParallelEvaluations;
+  m_OptimizerNumberOfRefinements = other.m_OptimizerNumberOfRefinements;
+  m_OptimizerSimplexDelta = other.m_OptimizerSimplexDelta;
+  m_OptimizerParametersConvergenceTolerance = other.m_OptimizerParametersConvergenceTolerance;
+  m_OptimizerFunctionConvergenceTolerance = other.m_OptimizerFunctionConvergenceTolerance;
+  m_OptimizerWithRestarts = other.m_OptimizerWithRestarts;
+  m_OptimizerMaximumLineIterations = other.m_OptimizerMaximumLineIterations;
+  m_OptimizerStepTolerance = other.m_OptimizerStepTolerance;
+  m_OptimizerValueTolerance = other.m_OptimizerValueTolerance;
+  m_OptimizerEpsilon = other.m_OptimizerEpsilon;
+  m_OptimizerBeta1 = other.m_OptimizerBeta1;
+  m_OptimizerBeta2 = other.m_OptimizerBeta2;
+  m_OptimizerInitialRadius = other.m_OptimizerInitialRadius;
+  m_OptimizerGrowthFactor = other.m_OptimizerGrowthFactor;
+  m_OptimizerShrinkFactor = other.m_OptimizerShrinkFactor;
+  m_OptimizerSeed = other.m_OptimizerSeed;
+  m_OptimizerSolutionAccuracy = other.m_OptimizerSolutionAccuracy;
+  m_OptimizerHessianApproximationAccuracy = other.m_OptimizerHessianApproximationAccuracy;
+  m_OptimizerDeltaConvergenceDistance = other.m_OptimizerDeltaConvergenceDistance;
+  m_OptimizerDeltaConvergenceTolerance = other.m_OptimizerDeltaConvergenceTolerance;
+  m_OptimizerLineSearchMaximumEvaluations = other.m_OptimizerLineSearchMaximumEvaluations;
+  m_OptimizerLineSearchMinimumStep = other.m_OptimizerLineSearchMinimumStep;
+  m_OptimizerLineSearchMaximumStep = other.m_OptimizerLineSearchMaximumStep;
+  m_OptimizerLineSearchAccuracy = other.m_OptimizerLineSearchAccuracy;
+  m_OptimizerWeights = other.m_OptimizerWeights;
+  m_OptimizerScalesType = other.m_OptimizerScalesType;
+  m_OptimizerScales = other.m_OptimizerScales;
+  m_OptimizerScalesCentralRegionRadius = other.m_OptimizerScalesCentralRegionRadius;
+  m_OptimizerScalesSmallParameterVariation = other.m_OptimizerScalesSmallParameterVariation;
+  m_OptimizerScalesReusedAcrossLevels = other.m_OptimizerScalesReusedAcrossLevels;
+  m_MetricType = other.m_MetricType;
+  m_MetricRadius = other.m_MetricRadius;
+  m_MetricIntensityDifferenceThreshold = other.m_MetricIntensityDifferenceThreshold;
+  m_MetricNumberOfHistogramBins = other.m_MetricNumberOfHistogramBins;
+  m_MetricVarianceForJointPDFSmoothing = other.m_MetricVarianceForJointPDFSmoothing;
+  m_CompositeMetric = other.m_CompositeMetric;
+  m_StartLevel = other.m_StartLevel;
+  m_MetricNumberOfThreads = other.m_MetricNumberOfThreads;
+  m_SmoothingNumberOfThreads = other.m_SmoothingNumberOfThreads;
+  m_OptimizerNumberOfThreads = other.m_OptimizerNumberOfThreads;
+  m_MetricChannelWeights = other.m_MetricChannelWeights;
+  m_LandmarkMetricType = other.m_LandmarkMetricType;
+  m_MetricFixedLandmarks = other.m_MetricFixedLandmarks;
+  m_MetricMovingLandmarks = other.m_MetricMovingLandmarks;
+  m_LandmarkMetricWeight = other.m_LandmarkMetricWeight;
+  m_LandmarkMetricPointSetSigma = other.m_LandmarkMetricPointSetSigma;
+  m_LandmarkMetricEvaluationKNeighborhood = other.m_LandmarkMetricEvaluationKNeighborhood;
+  m_MetricFixedMaskImage = other.m_MetricFixedMaskImage;
+  m_MetricMovingMaskImage = other.m_MetricMovingMaskImage;
+  m_MetricSamplingPercentage = other.m_MetricSamplingPercentage;
+  m_MetricSamplingStrategy = other.m_MetricSamplingStrategy;
+  m_MetricSamplingSeed = other.m_MetricSamplingSeed;
+  m_MetricUseFixedImageGradientFilter = other.m_MetricUseFixedImageGradientFilter;
+  m_MetricUseMovingImageGradientFilter = other.m_MetricUseMovingImageGradientFilter;
+  m_ShrinkFactorsPerLevel = other.m_ShrinkFactorsPerLevel;
+  m_ShrinkFactorsPerDimensionPerLevel = other.m_ShrinkFactorsPerDimensionPerLevel;
+  m_SmoothingSigmasPerLevel = other.m_SmoothingSigmasPerLevel;
+  m_SmoothingSigmasAreSpecifiedInPhysicalUnits = other.m_SmoothingSigmasAreSpecifiedInPhysicalUnits;
+  m_OptimizerNumberOfIterationsPerLevel = other.m_OptimizerNumberOfIterationsPerLevel;
+  m_OptimizerLearningRatePerLevel = other.m_OptimizerLearningRatePerLevel;
+  m_OptimizerConvergenceWindowSizePerLevel = other.m_OptimizerConvergenceWindowSizePerLevel;
+  m_MaximumElapsedTime = other.m_MaximumElapsedTime;
+  m_MaximumTotalNumberOfIterations = other.m_MaximumTotalNumberOfIterations;
+  m_MetricConvergenceWindowSize = other.m_MetricConvergenceWindowSize;
+  m_MetricConvergenceMinimumChange = other.m_MetricConvergenceMinimumChange;
+}
+
+
+// Each thread runs its own copy of the configured registration
+// method on every NumberOfThreads-th job.
+struct ImageRegistrationMethod::BatchRegistrationThreadStruct
+{
+  std::vector<ImageRegistrationMethod *>  m_Methods;
+  std::vector<Image>                      m_FixedImages;
+  const std::vector<const Image *>       *m_MovingImages;
+  const std::vector<Transform>           *m_InitialTransforms;
+  std::vector<Transform>                 *m_Transforms;
+  std::vector<double>                    *m_MetricValues;
+  std::vector<std::string>                m_Errors;
+
+  ~BatchRegistrationThreadStruct()
+    {
+      for ( size_t i = 0; i < m_Methods.size(); ++i )
+        {
+        delete m_Methods[i];
+        }
+    }
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void *arg )
+    {
+      typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+      ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+      BatchRegistrationThreadStruct *str = static_cast<BatchRegistrationThreadStruct *>( info->UserData );
+
+      const unsigned int threadId = info->ThreadID;
+      ImageRegistrationMethod *method = str->m_Methods[threadId];
+
+      try
+        {
+        for ( size_t i = threadId; i < str->m_MovingImages->size(); i += info->NumberOfThreads )
+          {
+          // the ITK pipeline may not be shared between threads
+          Image moving = *(*str->m_MovingImages)[i];
+          moving.MakeUnique();
+
+          method->m_InitialTransform = (*str->m_InitialTransforms)[i];
+          (*str->m_Transforms)[i] = method->Execute( str->m_FixedImages[threadId], moving );
+          (*str->m_MetricValues)[i] = method->m_MetricValue;
+          }
+        }
+      catch ( std::exception &e )
+        {
+        str->m_Errors[threadId] = e.what();
+        }
+      catch ( ... )
+        {
+        str->m_Errors[threadId] = "Unknown exception.";
+        }
+
+      return ITK_THREAD_RETURN_VALUE;
+    }
+};
+
+
+void ImageRegistrationMethod::ExecuteParallel( const Image &fixed,
+                                               const std::vector<const Image *> &movingImages,
+                                               const std::vector<Transform> &initialTransforms,
+                                               unsigned int numberOfParallelRegistrations,
+                                               unsigned int numberOfIterations,
+                                               std::vector<Transform> &transforms,
+                                               std::vector<double> &metricValues )
+{
+  assert( movingImages.size() == initialTransforms.size() );
+
+  transforms.assign( movingImages.size(), Transform() );
+  metricValues.assign( movingImages.size(), 0.0 );
+
+  const unsigned int numberOfThreads =
+    std::max( 1u, static_cast<unsigned int>( std::min<size_t>( numberOfParallelRegistrations, movingImages.size() ) ) );
+
+  // the fixed side of the configuration is prepared once for all the
+  // registrations
+  Image fixedMask = this->m_MetricFixedMaskImage;
+  if ( fixedMask.GetNumberOfPixels() != 0 && fixedMask.GetPixelID() != sitkUInt8 )
+    {
+    fixedMask = Cast( fixedMask, sitkUInt8 );
+    }
+
+  const unsigned int threadsPerRegistration = std::max( 1u, this->GetNumberOfThreads() / numberOfThreads );
+
+  BatchRegistrationThreadStruct str;
+  str.m_MovingImages = &movingImages;
+  str.m_InitialTransforms = &initialTransforms;
+  str.m_Transforms = &transforms;
+  str.m_MetricValues = &metricValues;
+  str.m_Errors.resize( numberOfThreads );
+  for ( unsigned int t = 0; t < numberOfThreads; ++t )
+    {
+    ImageRegistrationMethod *method = new ImageRegistrationMethod();
+    str.m_Methods.push_back( method );
+    method->CopyConfiguration( *this );
+    method->SetNumberOfThreads( threadsPerRegistration );
+    method->m_MetricFixedMaskImage = fixedMask;
+    method->m_MovingInitialTransform.MakeUnique();
+    method->m_FixedInitialTransform.MakeUnique();
+    if ( numberOfIterations != 0 )
+      {
+      method->m_OptimizerNumberOfIterations = numberOfIterations;
+      }
+
+    str.m_FixedImages.push_back( fixed );
+    str.m_FixedImages.back().MakeUnique();
+    }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfThreads ) );
+  threader->SetSingleMethod( BatchRegistrationThreadStruct::ThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+  for ( unsigned int t = 0; t < numberOfThreads; ++t )
+    {
+    if ( !str.m_Errors[t].empty() )
+      {
+      sitkExceptionMacro( << "Parallel registration failed: " << str.m_Errors[t] );
+      }
+    }
+}
+
+
+std::vector<Transform> ImageRegistrationMethod::ExecuteBatch ( const Image &fixed,
+                                                               const std::vector<Image> &movingImages,
+                                                               unsigned int numberOfParallelRegistrations )
+{
+  const size_t numberOfImages = movingImages.size();
+
+  // every registration starts from its own copy of the initial transform
+  std::vector<Transform> initialTransforms( numberOfImages, this->m_InitialTransform );
+  for ( size_t i = 0; i < numberOfImages; ++i )
+    {
+    initialTransforms[i].MakeUnique();
+    }
+
+  std::vector<Transform> transforms( numberOfImages );
+
+  if ( numberOfParallelRegistrations <= 1 || numberOfImages <= 1 )
+    {
+    const Transform initialTransform = this->m_InitialTransform;
+    try
+      {
+      for ( size_t i = 0; i < numberOfImages; ++i )
+        {
+        this->m_InitialTransform = initialTransforms[i];
+        transforms[i] = this->Execute( fixed, movingImages[i] );
+        }
+      }
+    catch ( ... )
+      {
+      this->m_InitialTransform = initialTransform;
+      throw;
+      }
+    this->m_InitialTransform = initialTransform;
+    return transforms;
+    }
+
+  std::vector<const Image *> movingPointers( numberOfImages );
+  for ( size_t i = 0; i < numberOfImages; ++i )
+    {
+    movingPointers[i] = &movingImages[i];
+    }
+
+  std::vector<double> metricValues;
+  this->ExecuteParallel( fixed, movingPointers, initialTransforms, numberOfParallelRegistrations, 0, transforms, metricValues );
+  return transforms;
+}
+
+
+namespace
+{
+bool MetricValueLess( const std::pair<double, size_t> &a, const std::pair<double, size_t> &b )
+{
+  return a.first < b.first;
+}
+}
+
+std::vector<Transform> ImageRegistrationMethod::ExecuteMultiStart ( const Image &fixed,
+                                                                    const Image &moving,
+                                                                    const std::vector<Transform> &initialTransforms,
+                                                                    unsigned int numberOfStartIterations,
+                                                                    unsigned int numberOfBest )
+{
+  if ( initialTransforms.empty() )
+    {
+    sitkExceptionMacro( "At least one initial transform is required!" );
+    }
+  if ( numberOfBest == 0 )
+    {
+    sitkExceptionMacro( "The number of best starts to continue must be at least 1!" );
+    }
+
+  const size_t numberOfStarts = initialTransforms.size();
+  const unsigned int numberOfThreads = std::max( 1u, this->GetNumberOfThreads() );
+
+  // the starts are optimized in place on copies of the given transforms
+  std::vector<Transform> starts( initialTransforms );
+  for ( size_t i = 0; i < numberOfStarts; ++i )
+    {
+    starts[i].MakeUnique();
+    }
+  std::vector<const Image *> movingPointers( numberOfStarts, &moving );
+
+  const bool inPlace = this->m_InitialTransformInPlace;
+  this->m_InitialTransformInPlace = true;
+  try
+    {
+    std::vector<Transform> transforms;
+    std::vector<double> metricValues;
+    this->ExecuteParallel( fixed, movingPointers, starts, numberOfThreads, numberOfStartIterations, transforms, metricValues );
+
+    // continue the best starts with the full configuration
+    std::vector< std::pair<double, size_t> > ranking( numberOfStarts );
+    for ( size_t i = 0; i < numberOfStarts; ++i )
+      {
+      ranking[i] = std::make_pair( metricValues[i], i );
+      sitkDebugMacro( "Start " << i << " metric value: " << metricValues[i] );
+      }
+    std::stable_sort( ranking.begin(), ranking.end(), MetricValueLess );
+
+    const size_t numberOfContinued = std::min<size_t>( numberOfBest, numberOfStarts );
+    std::vector<Transform> continued( numberOfContinued );
+    movingPointers.resize( numberOfContinued );
+    for ( size_t i = 0; i < numberOfContinued; ++i )
+      {
+      continued[i] = transforms[ranking[i].second];
+      }
+
+    this->ExecuteParallel( fixed, movingPointers, continued, numberOfThreads, 0, transforms, metricValues );
+
+    // return the results ordered by the final metric value
+    ranking.resize( numberOfContinued );
+    for ( size_t i = 0; i < numberOfContinued; ++i )
+      {
+      ranking[i] = std::make_pair( metricValues[i], i );
+      }
+    std::stable_sort( ranking.begin(), ranking.end(), MetricValueLess );
+
+    std::vector<Transform> results( numberOfContinued );
+    for ( size_t i = 0; i < numberOfContinued; ++i )
+      {
+      results[i] = transforms[ranking[i].second];
+      }
+    this->m_MetricValue = ranking[0].first;
+
+    this->m_InitialTransformInPlace = inPlace;
+    return results;
+    }
+  catch ( ... )
+    {
+    this->m_InitialTransformInPlace = inPlace;
+    throw;
+    }
+}
+
 template<class TImageType>
 Transform ImageRegistrationMethod::ExecuteInternal ( const Image &inFixed, const Image &inMoving )
 {
@@ -755,9 +2293,27 @@ Transform ImageRegistrationMethod::ExecuteInternal ( const Image &inFixed, const
   //typedef itk::SpatialObject<ImageDimension> SpatialObjectMaskType;
 
 
-  typedef itk::ImageRegistrationMethodv4<FixedImageType, MovingImageType>  RegistrationType;
+  typedef PyramidCachingRegistrationMethodv4<FixedImageType, MovingImageType>  RegistrationType;
   typename RegistrationType::Pointer   registration  = RegistrationType::New();
 
+  m_StartTime = GetWallClockTime();
+  m_TotalNumberOfIterations = 0;
+  m_ProfileLevelInitializationTimes.clear();
+  m_ProfileLevelOptimizationTimes.clear();
+  m_ProfileLevelNumberOfIterations.clear();
+  m_ProfileLevelNumberOfValidPoints.clear();
+  m_ProfileNumberOfThreadsUsed = 0;
+  m_ProfileObserverTime = 0.0;
+  m_ProfileTotalTime = 0.0;
+  m_OptimizerEstimatedScales.clear();
+  m_MetricValueHistory.clear();
+  m_StopReason.clear();
+
+  this->PrunePyramidCache( inFixed, inMoving );
+  registration->SetSmoothingFunctions(
+    nsstd::bind( &ImageRegistrationMethod::GetSmoothedImage<FixedImageType>, this, nsstd::placeholders::_1, nsstd::placeholders::_2 ),
+    nsstd::bind( &ImageRegistrationMethod::GetSmoothedImage<MovingImageType>, this, nsstd::placeholders::_1, nsstd::placeholders::_2 ) );
+
   // this variable will hold the initial moving then fixed, then the
   // initial to optimize.
   const std::string strIdentityTransform = "IdentityTransform";
@@ -801,6 +2357,14 @@ Transform ImageRegistrationMethod::ExecuteInternal ( const Image &inFixed, const
   // allocate optimizer early, to register the registration process
   // object's onDelete callback
   this->m_ActiveOptimizer = optimizer;
+
+  // the time between these observers, before and after those of the
+  // commands, is the time in the commands of the iteration event
+  typedef itk::SimpleMemberCommand<ImageRegistrationMethod> ProfileCommandType;
+  ProfileCommandType::Pointer profileStartCommand = ProfileCommandType::New();
+  profileStartCommand->SetCallbackFunction( this, &ImageRegistrationMethod::ProfileIterationStart );
+  optimizer->AddObserver( itk::IterationEvent(), profileStartCommand );
+
   const bool stashedDebug = this->GetDebug();
   this->DebugOff();
   this->PreUpdate( registration.GetPointer() );
@@ -808,18 +2372,134 @@ Transform ImageRegistrationMethod::ExecuteInternal ( const Image &inFixed, const
 
 
   // Get the pointer to the ITK image contained in image1
-  typename FixedImageType::ConstPointer fixed = this->CastImageToITK<FixedImageType>( inFixed );
-  typename MovingImageType::ConstPointer moving = this->CastImageToITK<MovingImageType>( inMoving );
+  // the channels of vector images, or the images
+  std::vector<typename FixedImageType::ConstPointer> fixedChannels;
+  std::vector<typename MovingImageType::ConstPointer> movingChannels;
+  if ( m_FixedChannels.empty() )
+    {
+    fixedChannels.push_back( this->CastImageToITK<FixedImageType>( inFixed ) );
+    movingChannels.push_back( this->CastImageToITK<MovingImageType>( inMoving ) );
+    }
+  else
+    {
+    for ( unsigned int c = 0; c < m_FixedChannels.size(); ++c )
+      {
+      fixedChannels.push_back( this->CastImageToITK<FixedImageType>( m_FixedChannels[c] ) );
+      movingChannels.push_back( this->CastImageToITK<MovingImageType>( m_MovingChannels[c] ) );
+      }
+    }
+  typename FixedImageType::ConstPointer fixed = fixedChannels[0];
+  typename MovingImageType::ConstPointer moving = movingChannels[0];
 
   typedef itk::ImageToImageMetricv4<FixedImageType, MovingImageType> _MetricType;
-  typename _MetricType::Pointer metric = this->CreateMetric<FixedImageType>();
-  metric->UnRegister();
-  this->SetupMetric(metric.GetPointer(), fixed.GetPointer(), moving.GetPointer());
+  typedef typename RegistrationType::MultiMetricType _MultiMetricType;
+
+  // A metric for each component of a composite metric and each
+  // channel. The first metric is used for the scales and
+  // measurements.
+  const std::vector<MetricComponent> metricComponents = m_CompositeMetric.empty() ?
+    std::vector<MetricComponent>( 1, this->GetCurrentMetricComponent(1.0) ) : m_CompositeMetric;
+  std::vector<typename _MetricType::Pointer> metrics;
+  std::vector<double> metricWeights;
+  for ( unsigned int c = 0; c < fixedChannels.size(); ++c )
+    {
+    const double channelWeight = m_MetricChannelWeights.empty() ? 1.0 : m_MetricChannelWeights[c];
+    for ( unsigned int i = 0; i < metricComponents.size(); ++i )
+      {
+      metrics.push_back( this->CreateMetric<FixedImageType>( metricComponents[i] ) );
+      metrics.back()->UnRegister();
+      this->SetupMetric(metrics.back().GetPointer(), fixedChannels[c].GetPointer(), movingChannels[c].GetPointer());
+      metricWeights.push_back( channelWeight * metricComponents[i].m_Weight );
+      }
+    }
+  typename _MetricType::Pointer metric = metrics[0];
+
+  // the landmarks follow the images as the last fixed and moving objects
+  typedef typename RegistrationType::PointSetType PointSetType;
+  typedef itk::PointSetToPointSetMetricv4<PointSetType, PointSetType> _PointSetMetricType;
+  typename _PointSetMetricType::Pointer landmarkMetric;
+  typename PointSetType::Pointer fixedLandmarks;
+  typename PointSetType::Pointer movingLandmarks;
+  if ( m_LandmarkMetricType != NoLandmarks )
+    {
+    if ( m_MetricFixedLandmarks.empty()
+         || m_MetricFixedLandmarks.size() % ImageDimension != 0
+         || m_MetricMovingLandmarks.size() % ImageDimension != 0
+         || ( m_LandmarkMetricType == LandmarkEuclideanDistance && m_MetricFixedLandmarks.size() != m_MetricMovingLandmarks.size() ) )
+      {
+      sitkExceptionMacro( "The number of fixed and moving landmark coordinates don't match the image dimension!" );
+      }
 
-  registration->SetMetric( metric );
+    fixedLandmarks = PointSetType::New();
+    movingLandmarks = PointSetType::New();
+    for ( unsigned int i = 0; i * ImageDimension < m_MetricFixedLandmarks.size(); ++i )
+      {
+      typename PointSetType::PointType point;
+      std::copy( m_MetricFixedLandmarks.begin() + i * ImageDimension, m_MetricFixedLandmarks.begin() + ( i + 1 ) * ImageDimension, point.Begin() );
+      fixedLandmarks->SetPoint( i, point );
+      fixedLandmarks->SetPointData( i, i );
+      }
+    for ( unsigned int i = 0; i * ImageDimension < m_MetricMovingLandmarks.size(); ++i )
+      {
+      typename PointSetType::PointType point;
+      std::copy( m_MetricMovingLandmarks.begin() + i * ImageDimension, m_MetricMovingLandmarks.begin() + ( i + 1 ) * ImageDimension, point.Begin() );
+      movingLandmarks->SetPoint( i, point );
+      movingLandmarks->SetPointData( i, i );
+      }
 
-  registration->SetFixedImage( fixed );
-  registration->SetMovingImage( moving );
+    if ( m_LandmarkMetricType == LandmarkEuclideanDistance )
+      {
+      // each landmark has its own label, so that only the
+      // corresponding landmarks are compared
+      typedef itk::LabeledPointSetToPointSetMetricv4<PointSetType, PointSetType> _LabeledMetricType;
+      typedef itk::EuclideanDistancePointSetToPointSetMetricv4<PointSetType, PointSetType> _EuclideanMetricType;
+      typename _LabeledMetricType::Pointer labeledMetric = _LabeledMetricType::New();
+      labeledMetric->SetPointSetMetric( _EuclideanMetricType::New().GetPointer() );
+      landmarkMetric = labeledMetric.GetPointer();
+      }
+    else
+      {
+      typedef itk::ExpectationBasedPointSetToPointSetMetricv4<PointSetType, PointSetType> _ExpectationMetricType;
+      typename _ExpectationMetricType::Pointer expectationMetric = _ExpectationMetricType::New();
+      expectationMetric->SetPointSetSigma( m_LandmarkMetricPointSetSigma );
+      expectationMetric->SetEvaluationKNeighborhood( m_LandmarkMetricEvaluationKNeighborhood );
+      landmarkMetric = expectationMetric.GetPointer();
+      }
+    }
+
+  if ( metrics.size() == 1 && !landmarkMetric )
+    {
+    registration->SetMetric( metric );
+    }
+  else
+    {
+    typename _MultiMetricType::Pointer multiMetric = _MultiMetricType::New();
+    typename _MultiMetricType::WeightsArrayType weights( metrics.size() + ( landmarkMetric ? 1 : 0 ) );
+    for ( unsigned int i = 0; i < metrics.size(); ++i )
+      {
+      multiMetric->AddMetric( metrics[i] );
+      weights[i] = metricWeights[i];
+      }
+    if ( landmarkMetric )
+      {
+      multiMetric->AddMetric( landmarkMetric );
+      weights[metrics.size()] = m_LandmarkMetricWeight;
+      }
+    multiMetric->SetMetricWeights( weights );
+    registration->SetMetric( multiMetric );
+    }
+
+  registration->SetNumberOfImagePairs( static_cast<unsigned int>( metrics.size() ) );
+  for ( unsigned int i = 0; i < metrics.size(); ++i )
+    {
+    registration->SetFixedImage( i, fixedChannels[i/metricComponents.size()] );
+    registration->SetMovingImage( i, movingChannels[i/metricComponents.size()] );
+    }
+  if ( landmarkMetric )
+    {
+    registration->SetFixedPointSet( metrics.size(), fixedLandmarks );
+    registration->SetMovingPointSet( metrics.size(), movingLandmarks );
+    }
 
   // determine number of levels
   const unsigned int numberOfLevels = m_ShrinkFactorsPerLevel.size();
@@ -827,13 +2507,81 @@ Transform ImageRegistrationMethod::ExecuteInternal ( const Image &inFixed, const
     {
     sitkExceptionMacro( "Number of per level parameters for shrink factors and smoothing sigmas don't match!");
     }
-  registration->SetNumberOfLevels(numberOfLevels);
+  if ( m_StartLevel >= numberOfLevels )
+    {
+    sitkExceptionMacro( "The start level " << m_StartLevel << " is not less than the number of levels " << numberOfLevels << "!" );
+    }
+
+  // the levels before the start level are skipped
+  const unsigned int numberOfExecutedLevels = numberOfLevels - m_StartLevel;
+  registration->SetNumberOfLevels(numberOfExecutedLevels);
+
+  if ( !m_CheckpointFileName.empty() )
+    {
+    registration->SetLevelCompletedFunction( nsstd::bind( &ImageRegistrationMethod::WriteCheckpoint, this,
+                                                          nsstd::bind( std::plus<unsigned int>(), nsstd::placeholders::_1, m_StartLevel ),
+                                                          nsstd::placeholders::_2 ) );
+    }
+
+  // per level optimizer parameters
+  if ( !m_OptimizerNumberOfIterationsPerLevel.empty() || !m_OptimizerLearningRatePerLevel.empty() || !m_OptimizerConvergenceWindowSizePerLevel.empty()
+       || m_OptimizerScalesReusedAcrossLevels )
+    {
+    if ( ( !m_OptimizerNumberOfIterationsPerLevel.empty() && m_OptimizerNumberOfIterationsPerLevel.size() != numberOfLevels )
+         || ( !m_OptimizerLearningRatePerLevel.empty() && m_OptimizerLearningRatePerLevel.size() != numberOfLevels )
+         || ( !m_OptimizerConvergenceWindowSizePerLevel.empty() && m_OptimizerConvergenceWindowSizePerLevel.size() != numberOfLevels ) )
+      {
+      sitkExceptionMacro( "Number of per level parameters for the optimizer and the number of levels don't match!" );
+      }
+    if ( ( !m_OptimizerNumberOfIterationsPerLevel.empty() && !m_pfSetOptimizerNumberOfIterations )
+         || ( !m_OptimizerLearningRatePerLevel.empty() && !m_pfSetOptimizerLearningRate )
+         || ( !m_OptimizerConvergenceWindowSizePerLevel.empty() && !m_pfSetOptimizerConvergenceWindowSize ) )
+      {
+      sitkExceptionMacro( "The per level parameters are not supported by the " << optimizer->GetNameOfClass() << " optimizer!" );
+      }
+    registration->SetLevelFunction( nsstd::bind( &ImageRegistrationMethod::UpdateOptimizerAtLevel, this, nsstd::placeholders::_1 ) );
+    }
 
   // set sampling
 
+  const bool hasFixedMask =
+    m_MetricFixedMaskImage.GetSize() != std::vector<unsigned int>(m_MetricFixedMaskImage.GetDimension(), 0u);
+
   // todo test enum match
-  typename RegistrationType::MetricSamplingStrategyType itkSamplingStrategy = static_cast<typename RegistrationType::MetricSamplingStrategyType>(int(m_MetricSamplingStrategy));
-  registration->SetMetricSamplingStrategy(itkSamplingStrategy);
+  if ( hasFixedMask && ( m_MetricSamplingStrategy == REGULAR || m_MetricSamplingStrategy == RANDOM ) )
+    {
+    // the samples are drawn from the voxels inside the mask, instead
+    // of rejected outside of it
+    registration->SetMetricSamplingStrategy(RegistrationType::REGULAR);
+    registration->SetCustomSamplingStrategy( m_MetricSamplingStrategy == REGULAR ?
+                                             RegistrationType::MASK_REGULAR_SAMPLING :
+                                             RegistrationType::MASK_RANDOM_SAMPLING,
+                                             m_MetricSamplingSeed );
+    }
+  else if ( m_MetricSamplingStrategy <= RANDOM )
+    {
+    typename RegistrationType::MetricSamplingStrategyType itkSamplingStrategy = static_cast<typename RegistrationType::MetricSamplingStrategyType>(int(m_MetricSamplingStrategy));
+    registration->SetMetricSamplingStrategy(itkSamplingStrategy);
+    }
+  else
+    {
+    // the custom strategies replace the regular sample points
+    registration->SetMetricSamplingStrategy(RegistrationType::REGULAR);
+    switch ( m_MetricSamplingStrategy )
+      {
+      case STRATIFIED:
+        registration->SetCustomSamplingStrategy( RegistrationType::STRATIFIED_SAMPLING, m_MetricSamplingSeed );
+        break;
+      case HALTON:
+        registration->SetCustomSamplingStrategy( RegistrationType::HALTON_SAMPLING, m_MetricSamplingSeed );
+        break;
+      case GRADIENT_WEIGHTED:
+        registration->SetCustomSamplingStrategy( RegistrationType::GRADIENT_WEIGHTED_SAMPLING, m_MetricSamplingSeed );
+        break;
+      default:
+        sitkExceptionMacro("LogicError: Unexpected case!");
+      }
+    }
 
   if (m_MetricSamplingPercentage.size()==1)
     {
@@ -845,8 +2593,9 @@ Transform ImageRegistrationMethod::ExecuteInternal ( const Image &inFixed, const
       {
 
       }
-    typename RegistrationType::MetricSamplingPercentageArrayType param(m_MetricSamplingPercentage.size());
-    std::copy(m_MetricSamplingPercentage.begin(), m_MetricSamplingPercentage.end(), param.begin());
+    const unsigned int startLevel = ( m_MetricSamplingPercentage.size() == numberOfLevels ) ? m_StartLevel : 0u;
+    typename RegistrationType::MetricSamplingPercentageArrayType param(m_MetricSamplingPercentage.size() - startLevel);
+    std::copy(m_MetricSamplingPercentage.begin() + startLevel, m_MetricSamplingPercentage.end(), param.begin());
     registration->SetMetricSamplingPercentagePerLevel(param);
     }
 
@@ -859,12 +2608,27 @@ Transform ImageRegistrationMethod::ExecuteInternal ( const Image &inFixed, const
     registration->MetricSamplingReinitializeSeed(m_MetricSamplingSeed);
     }
 
-  typename RegistrationType::ShrinkFactorsArrayType shrinkFactorsPerLevel( m_ShrinkFactorsPerLevel.size() );
-  std::copy(m_ShrinkFactorsPerLevel.begin(), m_ShrinkFactorsPerLevel.end(), shrinkFactorsPerLevel.begin());
+  typename RegistrationType::ShrinkFactorsArrayType shrinkFactorsPerLevel( numberOfExecutedLevels );
+  std::copy(m_ShrinkFactorsPerLevel.begin() + m_StartLevel, m_ShrinkFactorsPerLevel.end(), shrinkFactorsPerLevel.begin());
   registration->SetShrinkFactorsPerLevel( shrinkFactorsPerLevel );
+  if ( !m_ShrinkFactorsPerDimensionPerLevel.empty() )
+    {
+    for ( unsigned int level = 0; level < numberOfExecutedLevels; ++level )
+      {
+      const std::vector<unsigned int> &factors = m_ShrinkFactorsPerDimensionPerLevel[level + m_StartLevel];
+      if ( factors.size() != ImageDimension )
+        {
+        sitkExceptionMacro( "The shrink factors of level " << level + m_StartLevel << " have " << factors.size()
+                            << " dimensions instead of " << ImageDimension << "!" );
+        }
+      typename RegistrationType::ShrinkFactorsPerDimensionContainerType shrinkFactorsPerDimension;
+      std::copy( factors.begin(), factors.end(), shrinkFactorsPerDimension.Begin() );
+      registration->SetShrinkFactorsPerDimension( level, shrinkFactorsPerDimension );
+      }
+    }
 
-  typename RegistrationType::SmoothingSigmasArrayType smoothingSigmasPerLevel( m_SmoothingSigmasPerLevel.size() );
-  std::copy(m_SmoothingSigmasPerLevel.begin(), m_SmoothingSigmasPerLevel.end(), smoothingSigmasPerLevel.begin());
+  typename RegistrationType::SmoothingSigmasArrayType smoothingSigmasPerLevel( numberOfExecutedLevels );
+  std::copy(m_SmoothingSigmasPerLevel.begin() + m_StartLevel, m_SmoothingSigmasPerLevel.end(), smoothingSigmasPerLevel.begin());
   registration->SetSmoothingSigmasPerLevel( smoothingSigmasPerLevel );
   registration->SetSmoothingSigmasAreSpecifiedInPhysicalUnits(m_SmoothingSigmasAreSpecifiedInPhysicalUnits);
 
@@ -877,10 +2641,19 @@ Transform ImageRegistrationMethod::ExecuteInternal ( const Image &inFixed, const
   //
   // Configure Optimizer
   //
-  optimizer->SetNumberOfThreads(this->GetNumberOfThreads());
+  optimizer->SetNumberOfThreads( NumberOfThreadsOrDefault( m_OptimizerNumberOfThreads, this->GetNumberOfThreads() ) );
 
   registration->SetOptimizer( optimizer );
 
+  typedef AdamOptimizerv4Template<double> AdamOptimizerType;
+  if ( AdamOptimizerType *adamOptimizer = dynamic_cast<AdamOptimizerType *>( optimizer.GetPointer() ) )
+    {
+    // the stochastic optimizer evaluates the metric at new sample
+    // points at each iteration
+    registration->SetRedrawSeed( m_MetricSamplingSeed );
+    adamOptimizer->SetSampleFunction( nsstd::bind( &RegistrationType::RedrawMetricSamplePoints, registration.GetPointer() ) );
+    }
+
   if ( m_OptimizerWeights.size( ) )
     {
     itk::ObjectToObjectOptimizerBaseTemplate<double>::ScalesType weights(m_OptimizerWeights.size());
@@ -909,7 +2682,20 @@ Transform ImageRegistrationMethod::ExecuteInternal ( const Image &inFixed, const
 
   m_pfGetOptimizerStopConditionDescription =  nsstd::bind(&_OptimizerType::GetStopConditionDescription, optimizer.GetPointer());
 
-  m_pfGetCurrentLevel = nsstd::bind(&CurrentLevelCustomCast::CustomCast<RegistrationType>,registration.GetPointer());
+  m_pfGetCurrentLevel = nsstd::bind(std::plus<unsigned int>(),
+                                     nsstd::bind(&CurrentLevelCustomCast::CustomCast<RegistrationType>,registration.GetPointer()),
+                                     m_StartLevel);
+
+  m_pfGetMetricNumberOfValidPoints = nsstd::bind(&_MetricType::GetNumberOfValidPoints, metric.GetPointer());
+
+  ProfileCommandType::Pointer profileEndCommand = ProfileCommandType::New();
+  profileEndCommand->SetCallbackFunction( this, &ImageRegistrationMethod::ProfileIterationEnd );
+  optimizer->AddObserver( itk::IterationEvent(), profileEndCommand );
+
+  typedef itk::SimpleMemberCommand<ImageRegistrationMethod> StoppingCommandType;
+  StoppingCommandType::Pointer stoppingCommand = StoppingCommandType::New();
+  stoppingCommand->SetCallbackFunction( this, &ImageRegistrationMethod::CheckStoppingCriteria );
+  optimizer->AddObserver( itk::IterationEvent(), stoppingCommand );
 
 
   try
@@ -927,8 +2713,36 @@ Transform ImageRegistrationMethod::ExecuteInternal ( const Image &inFixed, const
     }
 
 
+  if ( !m_CheckpointFileName.empty() )
+    {
+    this->WriteCheckpoint( numberOfLevels, registration->GetModifiableTransform() );
+    }
+
   // update measurements
+  const double endTime = GetWallClockTime();
+  const std::vector<double> &levelStartTimes = registration->GetLevelStartTimes();
+  const std::vector<double> &levelOptimizationStartTimes = registration->GetLevelOptimizationStartTimes();
+  for ( size_t i = 0; i < levelOptimizationStartTimes.size(); ++i )
+    {
+    const double levelEndTime = ( i + 1 < levelStartTimes.size() ) ? levelStartTimes[i+1] : endTime;
+    m_ProfileLevelInitializationTimes.push_back( levelOptimizationStartTimes[i] - levelStartTimes[i] );
+    m_ProfileLevelOptimizationTimes.push_back( levelEndTime - levelOptimizationStartTimes[i] );
+    }
+  m_ProfileLevelNumberOfIterations.resize( levelOptimizationStartTimes.size(), 0u );
+  m_ProfileLevelNumberOfValidPoints.resize( levelOptimizationStartTimes.size(), 0u );
+  m_ProfileNumberOfThreadsUsed = metric->GetNumberOfThreadsUsed();
+  m_ProfileTotalTime = endTime - m_StartTime;
+
+  if ( scalesEstimator && bool(this->m_pfGetOptimizerScales) )
+    {
+    m_OptimizerEstimatedScales = this->m_pfGetOptimizerScales();
+    }
+
   m_StopConditionDescription = registration->GetOptimizer()->GetStopConditionDescription();
+  if ( !m_StopReason.empty() )
+    {
+    m_StopConditionDescription += " " + m_StopReason;
+    }
 
   m_MetricValue = this->GetMetricValue();
   m_Iteration = this->GetOptimizerIteration();
@@ -991,14 +2805,199 @@ double ImageRegistrationMethod::MetricEvaluate ( const Image &fixed, const Image
 }
 
 
+std::vector<double> ImageRegistrationMethod::MetricEvaluate ( const Image &fixed,
+                                                              const Image &moving,
+                                                              const std::vector< std::vector<double> > &parameters,
+                                                              unsigned int numberOfParallelEvaluations,
+                                                              bool computeDerivatives )
+{
+  const PixelIDValueType fixedType = fixed.GetPixelIDValue();
+  const unsigned int fixedDim = fixed.GetDimension();
+  if ( fixed.GetPixelIDValue() != moving.GetPixelIDValue() )
+    {
+    sitkExceptionMacro ( << "Fixed and moving images must be the same datatype! Got "
+                         << fixed.GetPixelIDValue() << " and " << moving.GetPixelIDValue() );
+    }
+
+  if ( fixed.GetDimension() != moving.GetDimension() )
+    {
+    sitkExceptionMacro ( << "Fixed and moving images must be the same dimensionality! Got "
+                         << fixed.GetDimension() << " and " << moving.GetDimension() );
+    }
+
+  this->m_MetricDerivatives.clear();
+
+  if (this->m_BatchEvaluateMemberFactory->HasMemberFunction( fixedType, fixedDim ) )
+    {
+    return this->m_BatchEvaluateMemberFactory->GetMemberFunction( fixedType, fixedDim )( fixed, moving, parameters, numberOfParallelEvaluations, computeDerivatives );
+    }
+
+  sitkExceptionMacro( << "Filter does not support fixed image type: " << itk::simple::GetPixelIDValueAsString (fixedType) );
+
+}
+
+
 
 template<class TImageType>
 double ImageRegistrationMethod::EvaluateInternal ( const Image &inFixed, const Image &inMoving )
+{
+  typedef TImageType     FixedImageType;
+  typedef TImageType     MovingImageType;
+
+  // Get the pointer to the ITK image contained in image1
+  typename FixedImageType::ConstPointer fixed = this->CastImageToITK<FixedImageType>( inFixed );
+  typename MovingImageType::ConstPointer moving = this->CastImageToITK<MovingImageType>( inMoving );
+
+  itk::ObjectToObjectMetricBaseTemplate<double>::Pointer metric =
+    this->CreateEvaluationMetric<FixedImageType>( fixed.GetPointer(), moving.GetPointer(), this->m_InitialTransform, 0u );
+  metric->UnRegister();
+
+  return metric->GetValue();
+}
+
+
+namespace
+{
+
+struct MetricEvaluationThreadStruct
+{
+  typedef itk::ObjectToObjectMetricBaseTemplate<double> MetricType;
+
+  std::vector<MetricType::Pointer>          m_Metrics;
+  std::vector<Transform>                    m_Transforms;
+  const std::vector< std::vector<double> > *m_Parameters;
+  bool                                      m_ComputeDerivatives;
+  std::vector<double>                       m_Values;
+  std::vector< std::vector<double> >        m_Derivatives;
+  std::vector<std::string>                  m_Errors;
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void *arg )
+    {
+      typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+      ThreadInfoType *info = static_cast<ThreadInfoType *>( arg );
+      MetricEvaluationThreadStruct *str = static_cast<MetricEvaluationThreadStruct *>( info->UserData );
+
+      const unsigned int threadId = info->ThreadID;
+      MetricType *metric = str->m_Metrics[threadId];
+      itk::TransformBase *transform = str->m_Transforms[threadId].GetITKBase();
+
+      try
+        {
+        for ( size_t i = threadId; i < str->m_Parameters->size(); i += info->NumberOfThreads )
+          {
+          const std::vector<double> &parameters = (*str->m_Parameters)[i];
+          itk::TransformBase::ParametersType itkParameters( parameters.size() );
+          std::copy( parameters.begin(), parameters.end(), itkParameters.begin() );
+          transform->SetParametersByValue( itkParameters );
+
+          if ( str->m_ComputeDerivatives )
+            {
+            MetricType::MeasureType value;
+            MetricType::DerivativeType derivative;
+            metric->GetValueAndDerivative( value, derivative );
+            str->m_Values[i] = value;
+            str->m_Derivatives[i] = std::vector<double>( derivative.begin(), derivative.end() );
+            }
+          else
+            {
+            str->m_Values[i] = metric->GetValue();
+            }
+          }
+        }
+      catch ( std::exception &e )
+        {
+        str->m_Errors[threadId] = e.what();
+        }
+      catch ( ... )
+        {
+        str->m_Errors[threadId] = "Unknown exception.";
+        }
+
+      return ITK_THREAD_RETURN_VALUE;
+    }
+};
+
+}
+
+
+template<class TImageType>
+std::vector<double> ImageRegistrationMethod::BatchEvaluateInternal ( const Image &inFixed,
+                                                                      const Image &inMoving,
+                                                                      const std::vector< std::vector<double> > &parameters,
+                                                                      unsigned int numberOfParallelEvaluations,
+                                                                      bool computeDerivatives )
+{
+  typedef TImageType     FixedImageType;
+  typedef TImageType     MovingImageType;
+
+  const unsigned int numberOfParameters = this->m_InitialTransform.GetNumberOfParameters();
+  for ( size_t i = 0; i < parameters.size(); ++i )
+    {
+    if ( parameters[i].size() != numberOfParameters )
+      {
+      sitkExceptionMacro( << "Parameters " << i << " have " << parameters[i].size()
+                          << " values, but the initial transform has " << numberOfParameters << " parameters!" );
+      }
+    }
+
+  typename FixedImageType::ConstPointer fixed = this->CastImageToITK<FixedImageType>( inFixed );
+  typename MovingImageType::ConstPointer moving = this->CastImageToITK<MovingImageType>( inMoving );
+
+  // each metric evaluates its share of the parameters with a copy of
+  // the initial transform, and its share of the threads
+  const unsigned int numberOfMetrics =
+    static_cast<unsigned int>( std::max<size_t>( 1u, std::min<size_t>( numberOfParallelEvaluations, parameters.size() ) ) );
+  const unsigned int threadsPerMetric = std::max( 1u, this->GetNumberOfThreads() / numberOfMetrics );
+
+  MetricEvaluationThreadStruct str;
+  str.m_Parameters = &parameters;
+  str.m_ComputeDerivatives = computeDerivatives;
+  str.m_Values.resize( parameters.size(), 0.0 );
+  if ( computeDerivatives )
+    {
+    str.m_Derivatives.resize( parameters.size() );
+    }
+  str.m_Errors.resize( numberOfMetrics );
+  str.m_Transforms.reserve( numberOfMetrics );
+  for ( unsigned int t = 0; t < numberOfMetrics; ++t )
+    {
+    str.m_Transforms.push_back( this->m_InitialTransform );
+    str.m_Transforms.back().MakeUnique();
+    str.m_Metrics.push_back( this->CreateEvaluationMetric<FixedImageType>( fixed.GetPointer(),
+                                                                           moving.GetPointer(),
+                                                                           str.m_Transforms.back(),
+                                                                           numberOfMetrics > 1 ? threadsPerMetric : 0u ) );
+    str.m_Metrics.back()->UnRegister();
+    }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( static_cast<itk::ThreadIdType>( numberOfMetrics ) );
+  threader->SetSingleMethod( MetricEvaluationThreadStruct::ThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+  for ( unsigned int t = 0; t < numberOfMetrics; ++t )
+    {
+    if ( !str.m_Errors[t].empty() )
+      {
+      sitkExceptionMacro( << "Metric evaluation failed: " << str.m_Errors[t] );
+      }
+    }
+
+  this->m_MetricDerivatives.swap( str.m_Derivatives );
+  return str.m_Values;
+}
+
+
+template<class TImageType>
+itk::ObjectToObjectMetricBaseTemplate<double> *
+ImageRegistrationMethod::CreateEvaluationMetric ( const TImageType *fixed,
+                                                  const TImageType *moving,
+                                                  Transform &transform,
+                                                  unsigned int numberOfThreads )
 {
   typedef TImageType     FixedImageType;
   typedef TImageType     MovingImageType;
   const unsigned int ImageDimension = FixedImageType::ImageDimension;
-  //typedef itk::SpatialObject<ImageDimension> SpatialObjectMaskType;
 
  typedef itk::ImageRegistrationMethodv4<FixedImageType, MovingImageType>  RegistrationType;
 
@@ -1006,18 +3005,24 @@ double ImageRegistrationMethod::EvaluateInternal ( const Image &inFixed, const I
   // initial to optimize.
   const std::string strIdentityTransform = "IdentityTransform";
 
-  // Get the pointer to the ITK image contained in image1
-  typename FixedImageType::ConstPointer fixed = this->CastImageToITK<FixedImageType>( inFixed );
-  typename MovingImageType::ConstPointer moving = this->CastImageToITK<MovingImageType>( inMoving );
-
   typedef itk::ImageToImageMetricv4<FixedImageType, MovingImageType> _MetricType;
-  typename _MetricType::Pointer metric = this->CreateMetric<FixedImageType>();
-  metric->UnRegister();
+  typedef typename RegistrationType::MultiMetricType _MultiMetricType;
 
-  this->SetupMetric(metric.GetPointer(), fixed.GetPointer(), moving.GetPointer());
-
-  metric->SetFixedImage(fixed);
-  metric->SetMovingImage(moving);
+  const std::vector<MetricComponent> metricComponents = m_CompositeMetric.empty() ?
+    std::vector<MetricComponent>( 1, this->GetCurrentMetricComponent(1.0) ) : m_CompositeMetric;
+  std::vector<typename _MetricType::Pointer> metrics;
+  for ( unsigned int i = 0; i < metricComponents.size(); ++i )
+    {
+    metrics.push_back( this->CreateMetric<FixedImageType>( metricComponents[i] ) );
+    metrics.back()->UnRegister();
+    this->SetupMetric(metrics.back().GetPointer(), fixed, moving);
+    if ( numberOfThreads != 0 )
+      {
+      metrics.back()->SetMaximumNumberOfThreads( numberOfThreads );
+      }
+    metrics.back()->SetFixedImage(fixed);
+    metrics.back()->SetMovingImage(moving);
+    }
 
   typedef itk::CompositeTransform<double, ImageDimension> CompositeTransformType;
   typename CompositeTransformType::Pointer movingInitialCompositeTransform = CompositeTransformType::New();
@@ -1040,20 +3045,42 @@ double ImageRegistrationMethod::EvaluateInternal ( const Image &inFixed, const I
       {
       sitkExceptionMacro( "Unexpected error converting initial moving transform! Possible miss matching dimensions!" );
       }
-    metric->SetFixedTransform(itkTx);
+    for ( unsigned int i = 0; i < metrics.size(); ++i )
+      {
+      metrics[i]->SetFixedTransform(itkTx);
+      }
     }
 
   typename RegistrationType::InitialTransformType *itkTx;
-  if ( !(itkTx = dynamic_cast<typename RegistrationType::InitialTransformType *>(this->m_InitialTransform.GetITKBase())) )
+  if ( !(itkTx = dynamic_cast<typename RegistrationType::InitialTransformType *>(transform.GetITKBase())) )
     {
     sitkExceptionMacro( "Unexpected error converting initial transform! Possible miss matching dimensions!" );
     }
   movingInitialCompositeTransform->AddTransform(itkTx);
-  metric->SetMovingTransform(movingInitialCompositeTransform);
+  // the derivatives are with respect to the parameters of the transform
+  movingInitialCompositeTransform->SetOnlyMostRecentTransformToOptimizeOn();
+  for ( unsigned int i = 0; i < metrics.size(); ++i )
+    {
+    metrics[i]->SetMovingTransform(movingInitialCompositeTransform);
+    }
 
+  itk::ObjectToObjectMetricBaseTemplate<double> *metric = metrics[0].GetPointer();
+  if ( !m_CompositeMetric.empty() )
+    {
+    typename _MultiMetricType::Pointer multiMetric = _MultiMetricType::New();
+    typename _MultiMetricType::WeightsArrayType weights( metricComponents.size() );
+    for ( unsigned int i = 0; i < metricComponents.size(); ++i )
+      {
+      multiMetric->AddMetric( metrics[i] );
+      weights[i] = metricComponents[i].m_Weight;
+      }
+    multiMetric->SetMetricWeights( weights );
+    metric = multiMetric.GetPointer();
+    }
   metric->Initialize();
 
-  return metric->GetValue();
+  metric->Register();
+  return metric;
 }
 
 
@@ -1073,7 +3100,7 @@ ImageRegistrationMethod::SetupMetric(
   const unsigned int ImageDimension = FixedImageType::ImageDimension;
   typedef itk::SpatialObject<ImageDimension> SpatialObjectMaskType;
 
-  metric->SetMaximumNumberOfThreads(this->GetNumberOfThreads());
+  metric->SetMaximumNumberOfThreads( NumberOfThreadsOrDefault( m_MetricNumberOfThreads, this->GetNumberOfThreads() ) );
 
   metric->SetUseFixedImageGradientFilter( m_MetricUseFixedImageGradientFilter );
   metric->SetUseMovingImageGradientFilter( m_MetricUseMovingImageGradientFilter );
@@ -1167,8 +3194,13 @@ void ImageRegistrationMethod::OnActiveProcessDelete( ) throw()
   this->m_pfGetOptimizerStopConditionDescription = SITK_NULLPTR;
 
   this->m_pfUpdateWithBestValue = SITK_NULLPTR;
+  this->m_pfStopOptimization = SITK_NULLPTR;
+  this->m_pfSetOptimizerNumberOfIterations = SITK_NULLPTR;
+  this->m_pfSetOptimizerLearningRate = SITK_NULLPTR;
+  this->m_pfSetOptimizerConvergenceWindowSize = SITK_NULLPTR;
 
   this->m_pfGetCurrentLevel = SITK_NULLPTR;
+  this->m_pfGetMetricNumberOfValidPoints = SITK_NULLPTR;
 
   this->m_ActiveOptimizer = SITK_NULLPTR;
 }
@@ -28,7 +28,7 @@ itk::ImageToImageMetricv4<itk::Image<float, 2>,
                           itk::Image<float, 2>,
                           double,
                           DefaultImageToImageMetricTraitsv4< itk::Image<float, 2>, itk::Image<float, 2>, itk::Image<float, 2>, double >
-                          >*ImageRegistrationMethod::CreateMetric<itk::Image<float, 2> >( );
+                          >*ImageRegistrationMethod::CreateMetric<itk::Image<float, 2> >( const ImageRegistrationMethod::MetricComponent & );
 
 
 template SITKRegistration_EXPORT
@@ -37,7 +37,7 @@ itk::ImageToImageMetricv4<itk::Image<double, 2>,
                           itk::Image<double, 2>,
                           double,
                           DefaultImageToImageMetricTraitsv4< itk::Image<double, 2>, itk::Image<double, 2>, itk::Image<double, 2>, double >
-                          >*ImageRegistrationMethod::CreateMetric<itk::Image<double, 2> >( );
+                          >*ImageRegistrationMethod::CreateMetric<itk::Image<double, 2> >( const ImageRegistrationMethod::MetricComponent & );
 
 
 template SITKRegistration_EXPORT
@@ -46,7 +46,7 @@ itk::ImageToImageMetricv4<itk::Image<float, 3>,
                           itk::Image<float, 3>,
                           double,
                           DefaultImageToImageMetricTraitsv4< itk::Image<float, 3>, itk::Image<float, 3>, itk::Image<float, 3>, double >
-                          >*ImageRegistrationMethod::CreateMetric<itk::Image<float, 3> >( );
+                          >*ImageRegistrationMethod::CreateMetric<itk::Image<float, 3> >( const ImageRegistrationMethod::MetricComponent & );
 
 
 template SITKRegistration_EXPORT
@@ -55,7 +55,7 @@ itk::ImageToImageMetricv4<itk::Image<double, 3>,
                           itk::Image<double, 3>,
                           double,
                           DefaultImageToImageMetricTraitsv4< itk::Image<double, 3>, itk::Image<double, 3>, itk::Image<double, 3>, double >
-                          >*ImageRegistrationMethod::CreateMetric<itk::Image<double, 3> >( );
+                          >*ImageRegistrationMethod::CreateMetric<itk::Image<double, 3> >( const ImageRegistrationMethod::MetricComponent & );
 
 }
 }
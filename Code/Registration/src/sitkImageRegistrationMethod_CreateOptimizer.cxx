@@ -28,6 +28,8 @@
 #include "itkAmoebaOptimizerv4.h"
 #include "itkPowellOptimizerv4.h"
 
+#include "sitkAdamOptimizerv4.hxx"
+
 #include <time.h>
 
 
@@ -108,6 +110,11 @@ namespace simple
       this->m_pfGetOptimizerConvergenceValue = nsstd::bind(&_OptimizerType::GetConvergenceValue,optimizer.GetPointer());
       this->m_pfGetOptimizerScales = nsstd::bind(&PositionOptimizerCustomCast::Helper<_OptimizerType::ScalesType>, nsstd::bind(&_OptimizerType::GetScales, optimizer.GetPointer()));
 
+      this->m_pfStopOptimization = nsstd::bind(&_OptimizerType::StopOptimization,optimizer.GetPointer());
+      this->m_pfSetOptimizerNumberOfIterations = nsstd::bind(&_OptimizerType::SetNumberOfIterations,optimizer.GetPointer(),nsstd::placeholders::_1);
+      this->m_pfSetOptimizerLearningRate = nsstd::bind(&_OptimizerType::SetLearningRate,optimizer.GetPointer(),nsstd::placeholders::_1);
+      this->m_pfSetOptimizerConvergenceWindowSize = nsstd::bind(&_OptimizerType::SetConvergenceWindowSize,optimizer.GetPointer(),nsstd::placeholders::_1);
+
       optimizer->Register();
       return optimizer.GetPointer();
       }
@@ -130,6 +137,38 @@ namespace simple
       this->m_pfGetOptimizerConvergenceValue = nsstd::bind(&_OptimizerType::GetConvergenceValue,optimizer.GetPointer());
       this->m_pfGetOptimizerScales = nsstd::bind(&PositionOptimizerCustomCast::Helper<_OptimizerType::ScalesType>, nsstd::bind(&_OptimizerType::GetScales, optimizer.GetPointer()));
 
+      this->m_pfStopOptimization = nsstd::bind(&_OptimizerType::StopOptimization,optimizer.GetPointer());
+      this->m_pfSetOptimizerNumberOfIterations = nsstd::bind(&_OptimizerType::SetNumberOfIterations,optimizer.GetPointer(),nsstd::placeholders::_1);
+      this->m_pfSetOptimizerLearningRate = nsstd::bind(&_OptimizerType::SetLearningRate,optimizer.GetPointer(),nsstd::placeholders::_1);
+      this->m_pfSetOptimizerConvergenceWindowSize = nsstd::bind(&_OptimizerType::SetConvergenceWindowSize,optimizer.GetPointer(),nsstd::placeholders::_1);
+
+      optimizer->Register();
+      return optimizer.GetPointer();
+      }
+    else if ( m_OptimizerType == Adam )
+      {
+      typedef AdamOptimizerv4Template<InternalComputationValueType> _OptimizerType;
+      _OptimizerType::Pointer      optimizer     = _OptimizerType::New();
+      optimizer->SetLearningRate( this->m_OptimizerLearningRate );
+      optimizer->SetNumberOfIterations( this->m_OptimizerNumberOfIterations );
+      optimizer->SetBeta1( this->m_OptimizerBeta1 );
+      optimizer->SetBeta2( this->m_OptimizerBeta2 );
+      optimizer->SetEpsilon( this->m_OptimizerEpsilon );
+      optimizer->SetMinimumConvergenceValue( this->m_OptimizerConvergenceMinimumValue );
+      optimizer->SetConvergenceWindowSize( this->m_OptimizerConvergenceWindowSize );
+
+      this->m_pfGetMetricValue = nsstd::bind(&_OptimizerType::GetCurrentMetricValue,optimizer.GetPointer());
+      this->m_pfGetOptimizerIteration = nsstd::bind(&CurrentIterationCustomCast::CustomCast,optimizer.GetPointer());
+      this->m_pfGetOptimizerPosition = nsstd::bind(&PositionOptimizerCustomCast::CustomCast,optimizer.GetPointer());
+      this->m_pfGetOptimizerLearningRate = nsstd::bind(&_OptimizerType::GetLearningRate,optimizer.GetPointer());
+      this->m_pfGetOptimizerConvergenceValue = nsstd::bind(&_OptimizerType::GetConvergenceValue,optimizer.GetPointer());
+      this->m_pfGetOptimizerScales = nsstd::bind(&PositionOptimizerCustomCast::Helper<_OptimizerType::ScalesType>, nsstd::bind(&_OptimizerType::GetScales, optimizer.GetPointer()));
+
+      this->m_pfStopOptimization = nsstd::bind(&_OptimizerType::StopOptimization,optimizer.GetPointer());
+      this->m_pfSetOptimizerNumberOfIterations = nsstd::bind(&_OptimizerType::SetNumberOfIterations,optimizer.GetPointer(),nsstd::placeholders::_1);
+      this->m_pfSetOptimizerLearningRate = nsstd::bind(&_OptimizerType::SetLearningRate,optimizer.GetPointer(),nsstd::placeholders::_1);
+      this->m_pfSetOptimizerConvergenceWindowSize = nsstd::bind(&_OptimizerType::SetConvergenceWindowSize,optimizer.GetPointer(),nsstd::placeholders::_1);
+
       optimizer->Register();
       return optimizer.GetPointer();
       }
@@ -156,6 +195,11 @@ namespace simple
       this->m_pfGetOptimizerConvergenceValue = nsstd::bind(&_OptimizerType::GetConvergenceValue,optimizer.GetPointer());
       this->m_pfGetOptimizerScales = nsstd::bind(&PositionOptimizerCustomCast::Helper<_OptimizerType::ScalesType>, nsstd::bind(&_OptimizerType::GetScales, optimizer.GetPointer()));
 
+      this->m_pfStopOptimization = nsstd::bind(&_OptimizerType::StopOptimization,optimizer.GetPointer());
+      this->m_pfSetOptimizerNumberOfIterations = nsstd::bind(&_OptimizerType::SetNumberOfIterations,optimizer.GetPointer(),nsstd::placeholders::_1);
+      this->m_pfSetOptimizerLearningRate = nsstd::bind(&_OptimizerType::SetLearningRate,optimizer.GetPointer(),nsstd::placeholders::_1);
+      this->m_pfSetOptimizerConvergenceWindowSize = nsstd::bind(&_OptimizerType::SetConvergenceWindowSize,optimizer.GetPointer(),nsstd::placeholders::_1);
+
       optimizer->Register();
       return optimizer.GetPointer();
       }
@@ -181,6 +225,11 @@ namespace simple
       this->m_pfGetOptimizerConvergenceValue = nsstd::bind(&_OptimizerType::GetConvergenceValue,optimizer.GetPointer());
       this->m_pfGetOptimizerScales = nsstd::bind(&PositionOptimizerCustomCast::Helper<_OptimizerType::ScalesType>, nsstd::bind(&_OptimizerType::GetScales, optimizer.GetPointer()));
 
+      this->m_pfStopOptimization = nsstd::bind(&_OptimizerType::StopOptimization,optimizer.GetPointer());
+      this->m_pfSetOptimizerNumberOfIterations = nsstd::bind(&_OptimizerType::SetNumberOfIterations,optimizer.GetPointer(),nsstd::placeholders::_1);
+      this->m_pfSetOptimizerLearningRate = nsstd::bind(&_OptimizerType::SetLearningRate,optimizer.GetPointer(),nsstd::placeholders::_1);
+      this->m_pfSetOptimizerConvergenceWindowSize = nsstd::bind(&_OptimizerType::SetConvergenceWindowSize,optimizer.GetPointer(),nsstd::placeholders::_1);
+
       return optimizer.GetPointer();
       }
     else if ( m_OptimizerType == LBFGSB )
@@ -274,6 +323,8 @@ namespace simple
                                                   nsstd::placeholders::_1);
 
 
+      this->m_pfStopOptimization = nsstd::bind(&_OptimizerType::StopWalking,optimizer.GetPointer());
+
       optimizer->Register();
       return optimizer.GetPointer();
       }
@@ -316,6 +367,9 @@ namespace simple
       this->m_pfGetOptimizerPosition = nsstd::bind(&PositionOptimizerCustomCast::CustomCast,optimizer.GetPointer());
       this->m_pfGetOptimizerScales = nsstd::bind(&PositionOptimizerCustomCast::Helper<_OptimizerType::ScalesType>, nsstd::bind(&_OptimizerType::GetScales, optimizer.GetPointer()));
 
+      this->m_pfStopOptimization = nsstd::bind(&_OptimizerType::StopOptimization,optimizer.GetPointer());
+      this->m_pfSetOptimizerNumberOfIterations = nsstd::bind(&_OptimizerType::SetMaximumIteration,optimizer.GetPointer(),nsstd::placeholders::_1);
+
       optimizer->Register();
       return optimizer.GetPointer();
       }
@@ -351,6 +405,8 @@ namespace simple
       this->m_pfGetOptimizerConvergenceValue = nsstd::bind(&_OptimizerType::GetFrobeniusNorm,optimizer.GetPointer());
       this->m_pfGetOptimizerScales = nsstd::bind(&PositionOptimizerCustomCast::Helper<_OptimizerType::ScalesType>, nsstd::bind(&_OptimizerType::GetScales, optimizer.GetPointer()));
 
+      this->m_pfSetOptimizerNumberOfIterations = nsstd::bind(&_OptimizerType::SetMaximumIteration,optimizer.GetPointer(),nsstd::placeholders::_1);
+
       optimizer->Register();
       return optimizer.GetPointer();
       }
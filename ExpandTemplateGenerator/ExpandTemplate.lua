@@ -188,9 +188,9 @@ function expand(str, ...)
   return estring(str)
 end
 
--- Args should be parameters template output
-if #arg ~= 6 then
-  print ( 'usage: ExpandTemplate.lua test_or_code_flag file_variables template_directory template_component_directory template_extension output ' )
+-- Args should be parameters template output [instantiation]
+if #arg ~= 6 and #arg ~= 7 then
+  print ( 'usage: ExpandTemplate.lua test_or_code_flag file_variables template_directory template_component_directory template_extension output [instantiation_file]' )
   os.exit ( 1 )
 end
 
@@ -200,6 +200,7 @@ templateFileDirectoryAndPrefix = arg[3]
 templateComponentDirectory = arg[4]
 templateFileExtension = arg[5]
 outputFile = arg[6]
+instantiationFile = arg[7]
 
 -- The following output may be useful for debuging perposes
 -- Alternatively a command line option could be added to increase verbosity
@@ -222,6 +223,53 @@ json = fid:read ( "*all" )
 fid:close()
 filterDescription = decode ( json )
 
+-- The dimensions the filter is instantiated for, unless the
+-- configuration has a custom_register.
+if filterDescription.dimensions == nil then
+  filterDescription.dimensions = { 3, 2 }
+end
+
+-- An optional instantiation file restricts the pixel types and
+-- dimensions of the filters. It has top level defaults and
+-- per filter entries:
+--   { "dimensions" : [ 3 ],
+--     "filters" : { "MedianImageFilter" : { "pixel_types" : "RealPixelIDTypeList" } } }
+if instantiationFile ~= nil and instantiationFile ~= "" then
+  fid = io.open ( instantiationFile )
+  if fid == nil then
+    print ( 'Error: failed to open ' .. instantiationFile )
+    os.exit ( 1 )
+  end
+  local instantiation = decode ( fid:read ( "*all" ) )
+  fid:close()
+
+  local instantiationKeys = { dimensions = true,
+                              pixel_types = true,
+                              pixel_types2 = true,
+                              vector_pixel_types_by_component = true,
+                              vector_pixel_types_by_component2 = true }
+
+  local function applyInstantiation ( overrides, where )
+    for key, value in pairs ( overrides ) do
+      if key ~= "filters" then
+        if not instantiationKeys[key] then
+          print ( 'Error: unknown key "' .. key .. '" for ' .. where .. ' in ' .. instantiationFile )
+          os.exit ( 1 )
+        end
+        -- a type list is only replaced where the filter has one
+        if key == "dimensions" or filterDescription[key] ~= nil then
+          filterDescription[key] = value
+        end
+      end
+    end
+  end
+
+  applyInstantiation ( instantiation, "the defaults" )
+  if instantiation.filters ~= nil and instantiation.filters[filterDescription.name] ~= nil then
+    applyInstantiation ( instantiation.filters[filterDescription.name], filterDescription.name )
+  end
+end
+
 templateBaseFilename = templateFileExtension
 
 if testOrCodeFlag == "code" then
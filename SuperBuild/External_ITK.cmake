@@ -81,6 +81,7 @@ ExternalProject_Add(${proj}
   -C "${CMAKE_CURRENT_BINARY_DIR}/${proj}-build/CMakeCacheInit.txt"
   ${ep_itk_args}
   ${ep_common_args}
+  ${ep_optimization_args}
   -DCMAKE_POSITION_INDEPENDENT_CODE:BOOL=ON
   -DCMAKE_VISIBILITY_INLINES_HIDDEN:BOOL=ON
   -DBUILD_EXAMPLES:BOOL=OFF
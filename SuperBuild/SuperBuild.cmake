@@ -264,6 +264,8 @@ if( APPLE )
 endif()
 VariableListToCache( ep_common_list ep_common_cache )
 
+include(sitkBuildOptimization)
+
 #
 # Use CMake file which present options for wrapped languages, and finds languages as needed
 #
@@ -409,6 +411,7 @@ ExternalProject_Add(${proj}
     ${ep_common_args}
     -DBUILD_SHARED_LIBS:BOOL=${BUILD_SHARED_LIBS}
     -DCMAKE_CXX_FLAGS:STRING=${CMAKE_CXX_FLAGS}
+    ${ep_optimization_args}
     -DCMAKE_INSTALL_PREFIX:PATH=<INSTALL_DIR>
     -DCMAKE_LIBRARY_OUTPUT_DIRECTORY:PATH=<BINARY_DIR>/lib
     -DCMAKE_ARCHIVE_OUTPUT_DIRECTORY:PATH=<BINARY_DIR>/lib
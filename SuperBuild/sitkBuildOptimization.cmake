@@ -0,0 +1,109 @@
+#-----------------------------------------------------------------------------
+# Link time and profile guided optimization of ITK and SimpleITK
+#-----------------------------------------------------------------------------
+#
+# SimpleITK_USE_LTO builds ITK and SimpleITK with interprocedural
+# optimization, so the calls between them may be inlined.
+#
+# SimpleITK_PGO selects the stage of the profile guided optimization:
+#
+#   GENERATE  builds instrumented libraries, which write their
+#             profiles to SimpleITK_PGO_PROFILE_DIRECTORY.
+#   USE       builds the libraries optimized with the profiles.
+#
+# The workflow, in the same build directory so the profiles match
+# the object files:
+#
+#   cmake -DSimpleITK_PGO=GENERATE . && cmake --build .
+#   cmake --build SimpleITK-build --target BenchmarkTraining
+#   cmake -DSimpleITK_PGO=USE . && cmake --build .
+#
+# The profiles of the Clang compilers are merged with llvm-profdata
+# when configuring the USE stage. PGO is supported with the GNU and
+# Clang compilers.
+#
+# The flags are only passed to the ITK and SimpleITK projects, as the
+# list of arguments ep_optimization_args.
+
+option( SimpleITK_USE_LTO "Build ITK and SimpleITK with link time optimization. Requires CMake 3.9." OFF )
+mark_as_advanced( SimpleITK_USE_LTO )
+
+set( SimpleITK_PGO "OFF" CACHE STRING "Stage of the profile guided optimization of ITK and SimpleITK: OFF, GENERATE or USE." )
+set_property( CACHE SimpleITK_PGO PROPERTY STRINGS "OFF" "GENERATE" "USE" )
+mark_as_advanced( SimpleITK_PGO )
+
+set( SimpleITK_PGO_PROFILE_DIRECTORY "${CMAKE_CURRENT_BINARY_DIR}/PGOProfiles" CACHE PATH
+  "The directory of the profiles of the profile guided optimization." )
+mark_as_advanced( SimpleITK_PGO_PROFILE_DIRECTORY )
+
+
+function( sitk_build_optimization_args args )
+
+  set( _vars "" )
+
+  if( SimpleITK_USE_LTO )
+    if( CMAKE_VERSION VERSION_LESS 3.9 )
+      message( FATAL_ERROR "SimpleITK_USE_LTO requires CMake 3.9." )
+    endif()
+    include( CheckIPOSupported )
+    check_ipo_supported( RESULT _ipo_supported OUTPUT _ipo_output LANGUAGES C CXX )
+    if( NOT _ipo_supported )
+      message( FATAL_ERROR "SimpleITK_USE_LTO is not supported by the compiler: ${_ipo_output}" )
+    endif()
+    # the NEW policy applies the property whatever the version
+    # required by the projects
+    set( CMAKE_INTERPROCEDURAL_OPTIMIZATION ON )
+    set( CMAKE_POLICY_DEFAULT_CMP0069 NEW )
+    list( APPEND _vars CMAKE_INTERPROCEDURAL_OPTIMIZATION CMAKE_POLICY_DEFAULT_CMP0069 )
+  endif()
+
+  if( NOT SimpleITK_PGO STREQUAL "OFF" )
+    set( _dir "${SimpleITK_PGO_PROFILE_DIRECTORY}" )
+
+    if( NOT CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang" )
+      message( FATAL_ERROR "SimpleITK_PGO is only supported with the GNU and Clang compilers." )
+    endif()
+
+    if( SimpleITK_PGO STREQUAL "GENERATE" )
+      file( MAKE_DIRECTORY "${_dir}" )
+      set( _flags "-fprofile-generate=${_dir}" )
+      if( CMAKE_CXX_COMPILER_ID STREQUAL "GNU" )
+        # the filters run in many threads
+        set( _flags "${_flags} -fprofile-update=atomic" )
+      endif()
+    elseif( SimpleITK_PGO STREQUAL "USE" )
+      if( CMAKE_CXX_COMPILER_ID MATCHES "Clang" )
+        find_program( LLVM_PROFDATA_EXECUTABLE NAMES llvm-profdata )
+        if( NOT LLVM_PROFDATA_EXECUTABLE )
+          message( FATAL_ERROR "llvm-profdata is required to merge the profiles of SimpleITK_PGO." )
+        endif()
+        file( GLOB _raw_profiles "${_dir}/*.profraw" )
+        if( NOT _raw_profiles )
+          message( FATAL_ERROR "No profiles in ${_dir}, run the GENERATE stage first." )
+        endif()
+        execute_process( COMMAND ${LLVM_PROFDATA_EXECUTABLE} merge -output=${_dir}/SimpleITK.profdata ${_raw_profiles}
+          RESULT_VARIABLE _result )
+        if( NOT _result EQUAL 0 )
+          message( FATAL_ERROR "Merging the profiles of SimpleITK_PGO failed." )
+        endif()
+        set( _flags "-fprofile-use=${_dir}/SimpleITK.profdata -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date" )
+      else()
+        set( _flags "-fprofile-use=${_dir} -fprofile-correction -Wno-missing-profile" )
+      endif()
+    else()
+      message( FATAL_ERROR "Unknown SimpleITK_PGO stage \"${SimpleITK_PGO}\", expected OFF, GENERATE or USE." )
+    endif()
+
+    foreach( _var CMAKE_C_FLAGS CMAKE_CXX_FLAGS
+        CMAKE_EXE_LINKER_FLAGS CMAKE_SHARED_LINKER_FLAGS CMAKE_MODULE_LINKER_FLAGS )
+      set( ${_var} "${${_var}} ${_flags}" )
+      list( APPEND _vars ${_var} )
+    endforeach()
+  endif()
+
+  VariableListToArgs( _vars _args )
+  set( ${args} "${_args}" PARENT_SCOPE )
+
+endfunction()
+
+sitk_build_optimization_args( ep_optimization_args )
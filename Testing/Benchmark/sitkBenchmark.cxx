@@ -0,0 +1,780 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+// Performance benchmarks of representative filters, Image copies,
+// image IO and registration, and the scaling benchmarks generated
+// from the JSON descriptions of the filters.
+//
+// Each benchmark is run repeatedly for at least the minimum time, and
+// the results are printed, and optionally written, in the JSON format
+// of Google Benchmark, so they can be tracked over time with the same
+// tools.
+//
+// With --scaling only the scaling benchmarks of the filters are run,
+// on a volume, and --scaling-report writes their speedups and
+// parallel efficiencies as CSV, flagging the filters which are single
+// threaded.
+//
+// Usage: SimpleITKBenchmark [--filter=substring] [--min-time=seconds]
+//                           [--out=file.json] [--temp=directory] [--quick]
+//                           [--scaling] [--scaling-report=file.csv]
+
+#include "sitkBenchmarkHarness.h"
+
+#include <SimpleITK.h>
+
+#include <itksys/SystemTools.hxx>
+#include <itksys/SystemInformation.hxx>
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+sitk::Image MakeImage( const std::vector<unsigned int> &size, sitk::PixelIDValueEnum pixelType )
+{
+  const size_t dimension = size.size();
+
+  std::vector<double> sigma( dimension ), mean( dimension );
+  for ( size_t d = 0; d < dimension; ++d )
+    {
+    sigma[d] = size[d] / 4.0;
+    mean[d] = size[d] / 2.0;
+    }
+
+  sitk::GaussianImageSource source;
+  source.SetOutputPixelType( sitk::sitkFloat32 );
+  source.SetSize( size );
+  source.SetSigma( sigma );
+  source.SetMean( mean );
+  source.SetScale( 200.0 );
+  source.SetOrigin( std::vector<double>( dimension, 0.0 ) );
+  source.SetSpacing( std::vector<double>( dimension, 1.0 ) );
+  std::vector<double> direction( dimension*dimension, 0.0 );
+  for ( size_t d = 0; d < dimension; ++d )
+    {
+    direction[d*dimension+d] = 1.0;
+    }
+  source.SetDirection( direction );
+
+  sitk::AdditiveGaussianNoiseImageFilter noise;
+  noise.SetStandardDeviation( 10.0 );
+  noise.SetMean( 20.0 );
+  noise.SetSeed( 42 );
+
+  sitk::CastImageFilter cast;
+  cast.SetOutputPixelType( pixelType );
+  return cast.Execute( noise.Execute( source.Execute() ) );
+}
+
+
+std::string SizeToString( const std::vector<unsigned int> &size )
+{
+  std::ostringstream out;
+  for ( size_t d = 0; d < size.size(); ++d )
+    {
+    out << ( d ? "x" : "" ) << size[d];
+    }
+  return out.str();
+}
+
+
+std::vector<BenchmarkFactoryFunction> &BenchmarkRegistration::GetFactories()
+{
+  static std::vector<BenchmarkFactoryFunction> factories;
+  return factories;
+}
+
+
+namespace
+{
+
+struct BenchmarkResult
+{
+  std::string  m_Name;
+  uint64_t     m_Iterations;
+  double       m_RealTime;
+  double       m_CPUTime;
+  double       m_MinimumRealTime;
+  uint64_t     m_Bytes;
+  // the number of threads of a scaling benchmark, and its speedup
+  // over the same benchmark with the fewest threads
+  unsigned int m_Threads;
+  double       m_Speedup;
+};
+
+
+// A filter executed on an image of a pixel type and size, the
+// benchmark owns the filter.
+template <class TFilter>
+class FilterBenchmark
+  : public Benchmark
+{
+public:
+  FilterBenchmark( TFilter *filter,
+                   const std::vector<unsigned int> &size,
+                   sitk::PixelIDValueEnum pixelType )
+    : Benchmark( filter->GetName() + "/" + sitk::GetPixelIDValueAsString( pixelType ) + "/" + SizeToString( size ) ),
+      m_Filter( filter ),
+      m_Size( size ),
+      m_PixelType( pixelType )
+    {
+    }
+  virtual ~FilterBenchmark() { delete m_Filter; }
+
+  virtual void SetUp()
+    {
+      m_Input = MakeImage( m_Size, m_PixelType );
+      m_Bytes = m_Input.GetSizeInBytes();
+    }
+  virtual void Run() { m_Filter->Execute( m_Input ); }
+  virtual void TearDown() { m_Input = sitk::Image(); }
+
+private:
+  TFilter               *m_Filter;
+  std::vector<unsigned int> m_Size;
+  sitk::PixelIDValueEnum m_PixelType;
+  sitk::Image            m_Input;
+};
+
+
+// A filter executed on two images.
+template <class TFilter>
+class BinaryFilterBenchmark
+  : public Benchmark
+{
+public:
+  BinaryFilterBenchmark( TFilter *filter,
+                         const std::vector<unsigned int> &size,
+                         sitk::PixelIDValueEnum pixelType )
+    : Benchmark( filter->GetName() + "/" + sitk::GetPixelIDValueAsString( pixelType ) + "/" + SizeToString( size ) ),
+      m_Filter( filter ),
+      m_Size( size ),
+      m_PixelType( pixelType )
+    {
+    }
+  virtual ~BinaryFilterBenchmark() { delete m_Filter; }
+
+  virtual void SetUp()
+    {
+      m_Input = MakeImage( m_Size, m_PixelType );
+      m_Bytes = 2 * m_Input.GetSizeInBytes();
+    }
+  virtual void Run() { m_Filter->Execute( m_Input, m_Input ); }
+  virtual void TearDown() { m_Input = sitk::Image(); }
+
+private:
+  TFilter               *m_Filter;
+  std::vector<unsigned int> m_Size;
+  sitk::PixelIDValueEnum m_PixelType;
+  sitk::Image            m_Input;
+};
+
+
+template <class TFilter>
+Benchmark *NewFilterBenchmark( TFilter *filter,
+                               const std::vector<unsigned int> &size,
+                               sitk::PixelIDValueEnum pixelType )
+{
+  return new FilterBenchmark<TFilter>( filter, size, pixelType );
+}
+
+
+// The deep copy of an image shared by another.
+class MakeUniqueBenchmark
+  : public Benchmark
+{
+public:
+  MakeUniqueBenchmark( const std::vector<unsigned int> &size, sitk::PixelIDValueEnum pixelType )
+    : Benchmark( "Image.MakeUnique/" + sitk::GetPixelIDValueAsString( pixelType ) + "/" + SizeToString( size ) ),
+      m_Size( size ),
+      m_PixelType( pixelType )
+    {
+    }
+
+  virtual void SetUp()
+    {
+      m_Input = MakeImage( m_Size, m_PixelType );
+      m_Bytes = m_Input.GetSizeInBytes();
+    }
+  virtual void Run()
+    {
+      sitk::Image copy = m_Input;
+      copy.MakeUnique();
+    }
+  virtual void TearDown() { m_Input = sitk::Image(); }
+
+private:
+  std::vector<unsigned int> m_Size;
+  sitk::PixelIDValueEnum m_PixelType;
+  sitk::Image            m_Input;
+};
+
+
+// Write an image in a format, or read it back.
+class ImageIOBenchmark
+  : public Benchmark
+{
+public:
+  ImageIOBenchmark( bool write,
+                    const std::string &fileName,
+                    const std::vector<unsigned int> &size,
+                    sitk::PixelIDValueEnum pixelType )
+    : Benchmark( std::string( write ? "WriteImage/" : "ReadImage/" )
+                 + itksys::SystemTools::GetFilenameName( fileName ).substr( std::string( "benchmark" ).size() )
+                 + "/" + sitk::GetPixelIDValueAsString( pixelType ) + "/" + SizeToString( size ) ),
+      m_Write( write ),
+      m_FileName( fileName ),
+      m_Size( size ),
+      m_PixelType( pixelType )
+    {
+    }
+
+  virtual void SetUp()
+    {
+      m_Input = MakeImage( m_Size, m_PixelType );
+      m_Bytes = m_Input.GetSizeInBytes();
+      if ( !m_Write )
+        {
+        sitk::WriteImage( m_Input, m_FileName );
+        }
+    }
+  virtual void Run()
+    {
+      if ( m_Write )
+        {
+        sitk::WriteImage( m_Input, m_FileName );
+        }
+      else
+        {
+        sitk::ReadImage( m_FileName );
+        }
+    }
+  virtual void TearDown()
+    {
+      m_Input = sitk::Image();
+      itksys::SystemTools::RemoveFile( m_FileName );
+    }
+
+private:
+  bool                      m_Write;
+  std::string               m_FileName;
+  std::vector<unsigned int> m_Size;
+  sitk::PixelIDValueEnum    m_PixelType;
+  sitk::Image               m_Input;
+};
+
+
+// A multi-resolution translation registration of a blob with a
+// shifted copy.
+class RegistrationBenchmark
+  : public Benchmark
+{
+public:
+  RegistrationBenchmark( const std::vector<unsigned int> &size )
+    : Benchmark( "ImageRegistrationMethod.Translation/" + SizeToString( size ) ),
+      m_Size( size )
+    {
+    }
+
+  virtual void SetUp()
+    {
+      m_Fixed = MakeImage( m_Size, sitk::sitkFloat32 );
+
+      sitk::TranslationTransform shift( m_Size.size(), std::vector<double>( m_Size.size(), 3.5 ) );
+      sitk::ResampleImageFilter resample;
+      resample.SetReferenceImage( m_Fixed );
+      resample.SetTransform( shift );
+      resample.SetInterpolator( sitk::sitkLinear );
+      m_Moving = resample.Execute( m_Fixed );
+      m_Bytes = m_Fixed.GetSizeInBytes();
+
+      std::vector<unsigned int> shrinkFactors( 2 );
+      shrinkFactors[0] = 2;
+      shrinkFactors[1] = 1;
+      std::vector<double> smoothingSigmas( 2 );
+      smoothingSigmas[0] = 1.0;
+      smoothingSigmas[1] = 0.0;
+
+      m_Registration.SetMetricAsMeanSquares();
+      m_Registration.SetOptimizerAsRegularStepGradientDescent( 1.0, 1e-4, 50 );
+      m_Registration.SetInterpolator( sitk::sitkLinear );
+      m_Registration.SetShrinkFactorsPerLevel( shrinkFactors );
+      m_Registration.SetSmoothingSigmasPerLevel( smoothingSigmas );
+    }
+  virtual void Run()
+    {
+      m_Registration.SetInitialTransform( sitk::TranslationTransform( m_Size.size() ) );
+      m_Registration.Execute( m_Fixed, m_Moving );
+    }
+  virtual void TearDown()
+    {
+      m_Fixed = sitk::Image();
+      m_Moving = sitk::Image();
+    }
+
+private:
+  std::vector<unsigned int>     m_Size;
+  sitk::Image                   m_Fixed;
+  sitk::Image                   m_Moving;
+  sitk::ImageRegistrationMethod m_Registration;
+};
+
+
+// Run a benchmark for at least minimumTime seconds, and at least once.
+BenchmarkResult RunBenchmark( Benchmark &benchmark, double minimumTime )
+{
+  benchmark.SetUp();
+
+  // a first run to warm up the caches and the factories
+  benchmark.Run();
+
+  BenchmarkResult result;
+  result.m_Name = benchmark.GetName();
+  result.m_Iterations = 0;
+  result.m_MinimumRealTime = 0.0;
+  result.m_Bytes = benchmark.GetBytes();
+  result.m_Threads = benchmark.GetThreads();
+  result.m_Speedup = 0.0;
+
+  const double start = itksys::SystemTools::GetTime();
+  const std::clock_t cpuStart = std::clock();
+  double elapsed = 0.0;
+  do
+    {
+    const double runStart = itksys::SystemTools::GetTime();
+    benchmark.Run();
+    const double runTime = itksys::SystemTools::GetTime() - runStart;
+    result.m_MinimumRealTime = result.m_Iterations ? std::min( result.m_MinimumRealTime, runTime ) : runTime;
+    ++result.m_Iterations;
+    elapsed = itksys::SystemTools::GetTime() - start;
+    }
+  while ( elapsed < minimumTime );
+
+  result.m_RealTime = elapsed / result.m_Iterations;
+  result.m_CPUTime = double( std::clock() - cpuStart ) / CLOCKS_PER_SEC / result.m_Iterations;
+
+  benchmark.TearDown();
+  return result;
+}
+
+
+// The name of a scaling benchmark without its number of threads.
+std::string GetScalingName( const std::string &name )
+{
+  return name.substr( 0, name.rfind( "/threads:" ) );
+}
+
+
+// Compute the speedups of the scaling benchmarks over the same
+// benchmark with the fewest threads.
+void ComputeSpeedups( std::vector<BenchmarkResult> &results )
+{
+  for ( size_t i = 0; i < results.size(); ++i )
+    {
+    if ( !results[i].m_Threads )
+      {
+      continue;
+      }
+    const BenchmarkResult *baseline = &results[i];
+    for ( size_t j = 0; j < results.size(); ++j )
+      {
+      if ( results[j].m_Threads
+           && results[j].m_Threads < baseline->m_Threads
+           && GetScalingName( results[j].m_Name ) == GetScalingName( results[i].m_Name ) )
+        {
+        baseline = &results[j];
+        }
+      }
+    if ( results[i].m_RealTime > 0.0 )
+      {
+      results[i].m_Speedup = baseline->m_RealTime / results[i].m_RealTime;
+      }
+    }
+}
+
+
+// The speedup below which a filter with several threads is reported
+// as single threaded.
+const double SingleThreadedSpeedup = 1.2;
+
+
+double GetEfficiency( const BenchmarkResult &result )
+{
+  return result.m_Speedup / result.m_Threads;
+}
+
+
+// Order by increasing parallel efficiency, the filters which do not
+// scale first.
+struct LowerEfficiency
+{
+  bool operator()( const BenchmarkResult *a, const BenchmarkResult *b ) const
+    {
+      return GetEfficiency( *a ) < GetEfficiency( *b );
+    }
+};
+
+
+// The result with the most threads of each scaling benchmark with
+// several threads, by increasing efficiency.
+std::vector<const BenchmarkResult *> GetMostThreads( const std::vector<BenchmarkResult> &results )
+{
+  std::vector<const BenchmarkResult *> most;
+  for ( size_t i = 0; i < results.size(); ++i )
+    {
+    if ( results[i].m_Threads < 2 )
+      {
+      continue;
+      }
+    bool isMost = true;
+    for ( size_t j = 0; j < results.size() && isMost; ++j )
+      {
+      isMost = !( results[j].m_Threads > results[i].m_Threads
+                  && GetScalingName( results[j].m_Name ) == GetScalingName( results[i].m_Name ) );
+      }
+    if ( isMost )
+      {
+      most.push_back( &results[i] );
+      }
+    }
+  std::sort( most.begin(), most.end(), LowerEfficiency() );
+  return most;
+}
+
+
+// Print the speedups with the most threads of each scaling benchmark.
+void WriteScaling( std::ostream &out, const std::vector<BenchmarkResult> &results )
+{
+  const std::vector<const BenchmarkResult *> most = GetMostThreads( results );
+  if ( most.empty() )
+    {
+    return;
+    }
+
+  out << "Scaling, by increasing efficiency:" << std::endl;
+  for ( size_t i = 0; i < most.size(); ++i )
+    {
+    out << "  " << GetScalingName( most[i]->m_Name ) << ": speedup " << most[i]->m_Speedup
+        << " with " << most[i]->m_Threads << " threads";
+    if ( most[i]->m_Speedup < SingleThreadedSpeedup )
+      {
+      out << " (single threaded)";
+      }
+    out << std::endl;
+    }
+}
+
+
+// Write the scaling of each benchmark as CSV, one line per number of
+// threads, with the benchmarks in the order of their efficiency with
+// the most threads.
+void WriteScalingReport( std::ostream &out, const std::vector<BenchmarkResult> &results )
+{
+  out.precision( 6 );
+  out << "Benchmark,Threads,RealTime,Speedup,Efficiency,SingleThreaded" << std::endl;
+
+  const std::vector<const BenchmarkResult *> most = GetMostThreads( results );
+  for ( size_t i = 0; i < most.size(); ++i )
+    {
+    const std::string name = GetScalingName( most[i]->m_Name );
+    const bool singleThreaded = most[i]->m_Speedup < SingleThreadedSpeedup;
+    for ( size_t j = 0; j < results.size(); ++j )
+      {
+      const BenchmarkResult &result = results[j];
+      if ( result.m_Threads && GetScalingName( result.m_Name ) == name )
+        {
+        out << name << "," << result.m_Threads << "," << result.m_RealTime * 1e3 << ","
+            << result.m_Speedup << "," << GetEfficiency( result ) << ","
+            << ( singleThreaded ? "true" : "false" ) << std::endl;
+        }
+      }
+    }
+}
+
+
+void WriteJSON( std::ostream &out, const std::vector<BenchmarkResult> &results )
+{
+  itksys::SystemInformation systemInformation;
+  systemInformation.RunCPUCheck();
+
+  out.precision( 9 );
+  out << "{\n"
+      << "  \"context\": {\n"
+      << "    \"library\": \"SimpleITK\",\n"
+      << "    \"library_version\": \"" << sitk::Version::VersionString() << "\",\n"
+      << "    \"itk_version\": \"" << sitk::Version::ITKVersionString() << "\",\n"
+      << "    \"num_cpus\": " << systemInformation.GetNumberOfLogicalCPU() << ",\n"
+      << "    \"num_threads\": " << sitk::ProcessObject::GetGlobalDefaultNumberOfThreads() << "\n"
+      << "  },\n"
+      << "  \"benchmarks\": [";
+  for ( size_t i = 0; i < results.size(); ++i )
+    {
+    const BenchmarkResult &result = results[i];
+    out << ( i ? "," : "" ) << "\n    {\n"
+        << "      \"name\": \"" << result.m_Name << "\",\n"
+        << "      \"iterations\": " << result.m_Iterations << ",\n"
+        << "      \"real_time\": " << result.m_RealTime * 1e3 << ",\n"
+        << "      \"cpu_time\": " << result.m_CPUTime * 1e3 << ",\n"
+        << "      \"min_real_time\": " << result.m_MinimumRealTime * 1e3 << ",\n"
+        << "      \"time_unit\": \"ms\"";
+    if ( result.m_Threads )
+      {
+      out << ",\n      \"threads\": " << result.m_Threads
+          << ",\n      \"speedup\": " << result.m_Speedup
+          << ",\n      \"efficiency\": " << GetEfficiency( result );
+      }
+    if ( result.m_Bytes && result.m_RealTime > 0.0 )
+      {
+      out << ",\n      \"bytes_per_second\": " << result.m_Bytes / result.m_RealTime;
+      }
+    out << "\n    }";
+    }
+  out << "\n  ]\n}\n";
+}
+
+
+std::string GetArgumentValue( const std::string &argument, const std::string &option )
+{
+  return argument.substr( option.size() );
+}
+
+}
+
+
+int main( int argc, char *argv[] )
+{
+  std::string filter;
+  std::string outputFileName;
+  std::string temporaryDirectory = itksys::SystemTools::GetCurrentWorkingDirectory();
+  std::string scalingReportFileName;
+  double minimumTime = 0.5;
+  bool quick = false;
+  bool scalingOnly = false;
+
+  for ( int i = 1; i < argc; ++i )
+    {
+    const std::string argument = argv[i];
+    if ( argument.find( "--filter=" ) == 0 )
+      {
+      filter = GetArgumentValue( argument, "--filter=" );
+      }
+    else if ( argument.find( "--min-time=" ) == 0 )
+      {
+      minimumTime = atof( GetArgumentValue( argument, "--min-time=" ).c_str() );
+      }
+    else if ( argument.find( "--out=" ) == 0 )
+      {
+      outputFileName = GetArgumentValue( argument, "--out=" );
+      }
+    else if ( argument.find( "--temp=" ) == 0 )
+      {
+      temporaryDirectory = GetArgumentValue( argument, "--temp=" );
+      }
+    else if ( argument == "--quick" )
+      {
+      quick = true;
+      }
+    else if ( argument == "--scaling" )
+      {
+      scalingOnly = true;
+      }
+    else if ( argument.find( "--scaling-report=" ) == 0 )
+      {
+      scalingReportFileName = GetArgumentValue( argument, "--scaling-report=" );
+      }
+    else
+      {
+      std::cerr << "Usage: " << argv[0]
+                << " [--filter=substring] [--min-time=seconds] [--out=file.json] [--temp=directory] [--quick]"
+                << " [--scaling] [--scaling-report=file.csv]"
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the quick mode only checks that the benchmarks run
+  const unsigned int size2D = quick ? 64 : 1024;
+  const unsigned int size3D = quick ? 16 : 128;
+  if ( quick )
+    {
+    minimumTime = 0.0;
+    }
+
+  std::vector< std::vector<unsigned int> > sizes;
+  sizes.push_back( std::vector<unsigned int>( 2, size2D ) );
+  sizes.push_back( std::vector<unsigned int>( 3, size3D ) );
+
+  std::vector<sitk::PixelIDValueEnum> pixelTypes;
+  pixelTypes.push_back( sitk::sitkUInt8 );
+  pixelTypes.push_back( sitk::sitkInt16 );
+  pixelTypes.push_back( sitk::sitkFloat32 );
+
+  std::vector<Benchmark *> benchmarks;
+  for ( size_t s = 0; s < sizes.size(); ++s )
+    {
+    for ( size_t p = 0; p < pixelTypes.size(); ++p )
+      {
+      const std::vector<unsigned int> &size = sizes[s];
+      const sitk::PixelIDValueEnum pixelType = pixelTypes[p];
+
+      sitk::SmoothingRecursiveGaussianImageFilter *smoothing = new sitk::SmoothingRecursiveGaussianImageFilter;
+      smoothing->SetSigma( std::vector<double>( size.size(), 2.0 ) );
+      benchmarks.push_back( NewFilterBenchmark( smoothing, size, pixelType ) );
+
+      sitk::MedianImageFilter *median = new sitk::MedianImageFilter;
+      median->SetRadius( std::vector<unsigned int>( size.size(), 1 ) );
+      benchmarks.push_back( NewFilterBenchmark( median, size, pixelType ) );
+
+      sitk::BinaryThresholdImageFilter *threshold = new sitk::BinaryThresholdImageFilter;
+      threshold->SetLowerThreshold( 100.0 );
+      threshold->SetUpperThreshold( 255.0 );
+      benchmarks.push_back( NewFilterBenchmark( threshold, size, pixelType ) );
+
+      sitk::CastImageFilter *cast = new sitk::CastImageFilter;
+      cast->SetOutputPixelType( sitk::sitkFloat64 );
+      benchmarks.push_back( NewFilterBenchmark( cast, size, pixelType ) );
+
+      benchmarks.push_back( NewFilterBenchmark( new sitk::StatisticsImageFilter, size, pixelType ) );
+
+      sitk::ResampleImageFilter *resample = new sitk::ResampleImageFilter;
+      resample->SetSize( std::vector<uint32_t>( size.begin(), size.end() ) );
+      resample->SetOutputOrigin( std::vector<double>( size.size(), 0.5 ) );
+      resample->SetOutputSpacing( std::vector<double>( size.size(), 1.0 ) );
+      resample->SetInterpolator( sitk::sitkLinear );
+      benchmarks.push_back( NewFilterBenchmark( resample, size, pixelType ) );
+
+      benchmarks.push_back( new BinaryFilterBenchmark<sitk::AddImageFilter>( new sitk::AddImageFilter, size, pixelType ) );
+
+      benchmarks.push_back( new MakeUniqueBenchmark( size, pixelType ) );
+      }
+
+    // integer pixels only
+    benchmarks.push_back( NewFilterBenchmark( new sitk::ConnectedComponentImageFilter, sizes[s], sitk::sitkUInt8 ) );
+
+    const char *extensions[] = { ".nrrd", ".nii", ".nii.gz", ".mha", ".tif" };
+    for ( size_t e = 0; e < sizeof( extensions ) / sizeof( extensions[0] ); ++e )
+      {
+      const std::string fileName = temporaryDirectory + "/benchmark" + extensions[e];
+      benchmarks.push_back( new ImageIOBenchmark( true, fileName, sizes[s], sitk::sitkInt16 ) );
+      benchmarks.push_back( new ImageIOBenchmark( false, fileName, sizes[s], sitk::sitkInt16 ) );
+      }
+
+    benchmarks.push_back( new RegistrationBenchmark( sizes[s] ) );
+    }
+
+  const std::string pngFileName = temporaryDirectory + "/benchmark.png";
+  benchmarks.push_back( new ImageIOBenchmark( true, pngFileName, sizes[0], sitk::sitkUInt8 ) );
+  benchmarks.push_back( new ImageIOBenchmark( false, pngFileName, sizes[0], sitk::sitkUInt8 ) );
+
+  // the benchmarks generated from the JSON descriptions of the
+  // filters, with 1, 2, 4, ... up to all the threads by default
+  BenchmarkSettings settings;
+  settings.m_Quick = quick;
+  settings.m_Sizes = sizes;
+  if ( scalingOnly )
+    {
+    // the filters are only scaled on the synthetic volume
+    settings.m_Sizes.assign( 1, sizes.back() );
+    }
+  const unsigned int maximumThreads = std::max( 1u, sitk::ProcessObject::GetGlobalDefaultNumberOfThreads() );
+  for ( unsigned int threads = 1; threads < maximumThreads; threads *= 2 )
+    {
+    settings.m_Threads.push_back( threads );
+    }
+  settings.m_Threads.push_back( maximumThreads );
+  if ( quick )
+    {
+    settings.m_Threads.resize( std::min<size_t>( settings.m_Threads.size(), 2 ) );
+    }
+  const std::vector<BenchmarkFactoryFunction> &factories = BenchmarkRegistration::GetFactories();
+  for ( size_t i = 0; i < factories.size(); ++i )
+    {
+    factories[i]( settings, benchmarks );
+    }
+
+  std::vector<BenchmarkResult> results;
+  int status = EXIT_SUCCESS;
+  for ( size_t i = 0; i < benchmarks.size(); ++i )
+    {
+    if ( ( !filter.empty() && benchmarks[i]->GetName().find( filter ) == std::string::npos )
+         || ( scalingOnly && !benchmarks[i]->GetThreads() ) )
+      {
+      continue;
+      }
+    try
+      {
+      results.push_back( RunBenchmark( *benchmarks[i], minimumTime ) );
+      const BenchmarkResult &result = results.back();
+      std::cerr << result.m_Name << ": " << result.m_RealTime * 1e3 << " ms ("
+                << result.m_Iterations << " iterations)" << std::endl;
+      }
+    catch ( std::exception &e )
+      {
+      if ( benchmarks[i]->IsOptional() )
+        {
+        std::cerr << benchmarks[i]->GetName() << " skipped: " << e.what() << std::endl;
+        }
+      else
+        {
+        std::cerr << benchmarks[i]->GetName() << " failed: " << e.what() << std::endl;
+        status = EXIT_FAILURE;
+        }
+      }
+    }
+
+  ComputeSpeedups( results );
+  WriteScaling( std::cerr, results );
+
+  for ( size_t i = 0; i < benchmarks.size(); ++i )
+    {
+    delete benchmarks[i];
+    }
+
+  if ( !scalingReportFileName.empty() )
+    {
+    std::ofstream report( scalingReportFileName.c_str() );
+    if ( !report )
+      {
+      std::cerr << "Unable to write \"" << scalingReportFileName << "\"" << std::endl;
+      return EXIT_FAILURE;
+      }
+    WriteScalingReport( report, results );
+    }
+
+  if ( !outputFileName.empty() )
+    {
+    std::ofstream out( outputFileName.c_str() );
+    if ( !out )
+      {
+      std::cerr << "Unable to write \"" << outputFileName << "\"" << std::endl;
+      return EXIT_FAILURE;
+      }
+    WriteJSON( out, results );
+    }
+  else
+    {
+    WriteJSON( std::cout, results );
+    }
+
+  return status;
+}
@@ -0,0 +1,133 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+#ifndef sitkBenchmarkHarness_h
+#define sitkBenchmarkHarness_h
+
+#include <sitkImage.h>
+#include <sitkPixelIDValues.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace sitk = itk::simple;
+
+// A benchmark times Run, the input data are created by SetUp.
+class Benchmark
+{
+public:
+  Benchmark( const std::string &name ) : m_Name( name ), m_Bytes( 0 ), m_Threads( 0 ), m_Optional( false ) {}
+  virtual ~Benchmark() {}
+
+  virtual void SetUp() {}
+  virtual void Run() = 0;
+  virtual void TearDown() {}
+
+  const std::string &GetName() const { return m_Name; }
+
+  // the bytes processed by one run, 0 if not meaningful
+  uint64_t GetBytes() const { return m_Bytes; }
+
+  // the number of threads of a scaling benchmark, 0 otherwise
+  unsigned int GetThreads() const { return m_Threads; }
+
+  // a failure of an optional benchmark only skips it
+  bool IsOptional() const { return m_Optional; }
+
+protected:
+  std::string  m_Name;
+  uint64_t     m_Bytes;
+  unsigned int m_Threads;
+  bool         m_Optional;
+};
+
+
+// A noisy Gaussian blob, with the structures of the images processed
+// by the filters.
+sitk::Image MakeImage( const std::vector<unsigned int> &size, sitk::PixelIDValueEnum pixelType );
+
+std::string SizeToString( const std::vector<unsigned int> &size );
+
+
+// A filter executed with a number of threads on images of a pixel
+// type and size. The benchmarks of the same filter, pixel type and
+// size with different numbers of threads measure its scaling.
+//
+// The derived classes own the filter, set its parameters and execute
+// it on the input in Run.
+class FilterScalingBenchmark
+  : public Benchmark
+{
+public:
+  FilterScalingBenchmark( const std::string &filterName,
+                          unsigned int numberOfInputs,
+                          const std::vector<unsigned int> &size,
+                          sitk::PixelIDValueEnum pixelType,
+                          unsigned int threads,
+                          bool optional )
+    : Benchmark( filterName ),
+      m_NumberOfInputs( numberOfInputs ),
+      m_Size( size ),
+      m_PixelType( pixelType )
+    {
+      std::ostringstream name;
+      name << filterName << "/" << sitk::GetPixelIDValueAsString( pixelType )
+           << "/" << SizeToString( size ) << "/threads:" << threads;
+      m_Name = name.str();
+      m_Threads = threads;
+      m_Optional = optional;
+    }
+
+  virtual void SetUp()
+    {
+      m_Input = MakeImage( m_Size, m_PixelType );
+      m_Bytes = m_NumberOfInputs * m_Input.GetSizeInBytes();
+    }
+  virtual void TearDown() { m_Input = sitk::Image(); }
+
+protected:
+  unsigned int              m_NumberOfInputs;
+  std::vector<unsigned int> m_Size;
+  sitk::PixelIDValueEnum    m_PixelType;
+  // the image used for all the inputs
+  sitk::Image               m_Input;
+};
+
+
+// The default sizes and numbers of threads of the benchmarks
+// generated from the JSON descriptions of the filters.
+struct BenchmarkSettings
+{
+  bool                                     m_Quick;
+  std::vector< std::vector<unsigned int> > m_Sizes;
+  std::vector<unsigned int>                m_Threads;
+};
+
+typedef void (*BenchmarkFactoryFunction)( const BenchmarkSettings &settings, std::vector<Benchmark *> &benchmarks );
+
+// A static BenchmarkRegistration adds the benchmarks of a generated
+// source file to the ones run by main.
+class BenchmarkRegistration
+{
+public:
+  BenchmarkRegistration( BenchmarkFactoryFunction factory ) { GetFactories().push_back( factory ); }
+
+  static std::vector<BenchmarkFactoryFunction> &GetFactories();
+};
+
+#endif // sitkBenchmarkHarness_h
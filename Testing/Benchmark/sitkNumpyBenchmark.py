@@ -0,0 +1,135 @@
+#==========================================================================
+#
+#   Copyright Insight Software Consortium
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#          http://www.apache.org/licenses/LICENSE-2.0.txt
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+#
+#==========================================================================*/
+"""Benchmarks of the conversions between SimpleITK images and numpy
+arrays, written in the JSON format of SimpleITKBenchmark.
+
+Usage: sitkNumpyBenchmark.py [--filter=substring] [--min-time=seconds]
+                             [--out=file.json] [--quick]
+"""
+from __future__ import print_function
+
+import json
+import sys
+import time
+import timeit
+
+import numpy as np
+import SimpleITK as sitk
+
+# the CPU time of the process, time.clock with Python 2
+process_time = getattr(time, 'process_time', None) or time.clock
+
+
+def run_benchmark(name, function, number_of_bytes, minimum_time):
+    # a first run to warm up
+    function()
+
+    iterations = 0
+    minimum_real_time = None
+    start = timeit.default_timer()
+    cpu_start = process_time()
+    elapsed = 0.0
+    while True:
+        run_start = timeit.default_timer()
+        function()
+        run_time = timeit.default_timer() - run_start
+        minimum_real_time = run_time if minimum_real_time is None else min(minimum_real_time, run_time)
+        iterations += 1
+        elapsed = timeit.default_timer() - start
+        if elapsed >= minimum_time:
+            break
+    cpu_time = process_time() - cpu_start
+
+    result = {"name": name,
+              "iterations": iterations,
+              "real_time": 1e3 * elapsed / iterations,
+              "cpu_time": 1e3 * cpu_time / iterations,
+              "min_real_time": 1e3 * minimum_real_time,
+              "time_unit": "ms"}
+    if number_of_bytes and elapsed > 0.0:
+        result["bytes_per_second"] = number_of_bytes * iterations / elapsed
+    return result
+
+
+def main(argv):
+    name_filter = ""
+    minimum_time = 0.5
+    output_file_name = None
+    quick = False
+    for argument in argv[1:]:
+        if argument.startswith("--filter="):
+            name_filter = argument[len("--filter="):]
+        elif argument.startswith("--min-time="):
+            minimum_time = float(argument[len("--min-time="):])
+        elif argument.startswith("--out="):
+            output_file_name = argument[len("--out="):]
+        elif argument == "--quick":
+            quick = True
+        else:
+            print(__doc__, file=sys.stderr)
+            return 1
+
+    if quick:
+        minimum_time = 0.0
+    sizes = [[64] * 2, [16] * 3] if quick else [[1024] * 2, [128] * 3]
+    pixel_types = [sitk.sitkUInt8, sitk.sitkInt16, sitk.sitkFloat32, sitk.sitkVectorFloat32]
+
+    benchmarks = []
+    for size in sizes:
+        for pixel_type in pixel_types:
+            image = sitk.Image(size, pixel_type)
+            array = sitk.GetArrayFromImage(image)
+            suffix = "/{0}/{1}".format(sitk.GetPixelIDValueAsString(pixel_type),
+                                       "x".join(str(s) for s in size))
+            number_of_bytes = array.nbytes
+
+            benchmarks.append(("GetArrayFromImage" + suffix,
+                               lambda image=image: sitk.GetArrayFromImage(image),
+                               number_of_bytes))
+            benchmarks.append(("GetArrayViewFromImage" + suffix,
+                               lambda image=image: sitk.GetArrayViewFromImage(image),
+                               number_of_bytes))
+            is_vector = pixel_type == sitk.sitkVectorFloat32
+            benchmarks.append(("GetImageFromArray" + suffix,
+                               lambda array=array, is_vector=is_vector: sitk.GetImageFromArray(array, isVector=is_vector),
+                               number_of_bytes))
+
+    results = []
+    for name, function, number_of_bytes in benchmarks:
+        if name_filter not in name:
+            continue
+        result = run_benchmark(name, function, number_of_bytes, minimum_time)
+        print("{0}: {1} ms ({2} iterations)".format(name, result["real_time"], result["iterations"]),
+              file=sys.stderr)
+        results.append(result)
+
+    report = {"context": {"library": "SimpleITK",
+                          "library_version": sitk.Version.VersionString(),
+                          "itk_version": sitk.Version.ITKVersionString(),
+                          "numpy_version": np.__version__},
+              "benchmarks": results}
+    if output_file_name:
+        with open(output_file_name, "w") as output:
+            json.dump(report, output, indent=2)
+    else:
+        json.dump(report, sys.stdout, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -68,6 +68,9 @@ sitk_add_r_test( Arithmetic
 sitk_add_r_test( PixelIndexing
   "${SimpleITK_SOURCE_DIR}/Testing/Unit/RPixelAccess.R"
   )
+sitk_add_r_test( ArrayConversion
+  "${SimpleITK_SOURCE_DIR}/Testing/Unit/RArrayConversion.R"
+  )
 sitk_add_r_test( ImageListArguments
   "${SimpleITK_SOURCE_DIR}/Testing/Unit/RImageListArguments.R"
   )
@@ -85,6 +85,30 @@ namespace itk.simple {
                 image /= image;
                 CheckHash(image, "287046eafd10b9984977f6888ea50ea50fe846b5", ref success);  
 
+                // Pixel buffer access
+                Image fimage = new Image(10, 10, PixelId.sitkFloat32);
+                float[] values = new float[100];
+                values[23] = 5.0f;
+                fimage.UseBuffer( delegate(IntPtr buffer, long length) {
+                    if (length != 100*sizeof(float)) {
+                        throw new Exception("Bad buffer length");
+                    }
+                    System.Runtime.InteropServices.Marshal.Copy(values, 0, buffer, 100);
+                });
+                idx[0] = 3;
+                idx[1] = 2;
+                if (fimage.GetPixelAsFloat(idx) != 5.0f) {
+                    success = ExitFailure;
+                    Console.WriteLine("Bad pixel value written to the buffer.");
+                }
+
+                // Deterministic release of the native image
+                using (Image disposed = new Image(1000, 1000, PixelId.sitkFloat64)) {
+                    if (disposed.GetWidth() != 1000) {
+                        success = ExitFailure;
+                        Console.WriteLine("Bad width of a disposed image.");
+                    }
+                }
 
             } catch (Exception ex) {
                 success = ExitFailure;
@@ -177,6 +177,49 @@ TEST(IO,WriteOptions) {
 
 }
 
+TEST(IO,ComputeHash) {
+
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/RA-Float.nrrd" ) );
+  const std::string expected = sitk::Hash( image, sitk::HashImageFilter::FAST );
+
+  sitk::ImageFileWriter writer;
+  EXPECT_FALSE( writer.GetComputeHash() );
+  writer.Execute( image, dataFinder.GetOutputFile( "IO.ComputeHash.mha" ), false );
+  EXPECT_EQ( "", writer.GetHash() );
+
+  writer.ComputeHashOn();
+  EXPECT_TRUE( writer.ToString().find( "ComputeHash: 1" ) != std::string::npos );
+  writer.Execute( image );
+  EXPECT_EQ( expected, writer.GetHash() );
+
+  // the streamed pieces are hashed as they are written
+  writer.SetNumberOfStreamDivisions( 5 );
+  writer.Execute( image );
+  EXPECT_EQ( expected, writer.GetHash() );
+
+  writer.SetNumberOfStreamDivisions( 1 );
+  writer.Execute( image, dataFinder.GetOutputFile( "IO.ComputeHash.nrrd" ), true );
+  EXPECT_EQ( expected, writer.GetHash() );
+
+  sitk::ImageFileReader reader;
+  EXPECT_FALSE( reader.GetComputeHash() );
+  reader.SetFileName( dataFinder.GetOutputFile( "IO.ComputeHash.mha" ) );
+  reader.Execute();
+  EXPECT_EQ( "", reader.GetHash() );
+
+  reader.ComputeHashOn();
+  EXPECT_EQ( expected, sitk::Hash( reader.Execute(), sitk::HashImageFilter::FAST ) );
+  EXPECT_EQ( expected, reader.GetHash() );
+
+  reader.UseMemoryMappingOn();
+  reader.Execute();
+  EXPECT_EQ( expected, reader.GetHash() );
+
+  reader.SetFileName( dataFinder.GetOutputFile( "IO.ComputeHash.nrrd" ) );
+  reader.Execute();
+  EXPECT_EQ( expected, reader.GetHash() );
+}
+
 TEST(IO,Write) {
 
   sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/BlackDots.png" ) );
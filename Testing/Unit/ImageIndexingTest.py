@@ -151,6 +151,42 @@ class TestImageIndexingInterface(unittest.TestCase):
          self.assertImageNDArrayEquals(img[:,::-2,::-1], nda[::-1,::-2,:])
          self.assertImageNDArrayEquals(img[-1:-4:-1,:,:], nda[:,:,-1:-4:-1])
 
+    def test_3d_geometry(self):
+         """testing the geometry of slices copied from the buffer"""
+
+         nda = np.linspace(0, 59, 60 ).reshape(3,4,5)
+
+         img = sitk.GetImageFromArray( nda )
+         img.SetOrigin( [1.0, -2.0, 3.5] )
+         img.SetSpacing( [0.5, 1.5, 2.0] )
+         img.SetDirection( [0,1,0, -1,0,0, 0,0,1] )
+
+         def assertSameImage( a, b ):
+           self.assertEqual( a.GetSize(), b.GetSize() )
+           self.assertEqual( sitk.Hash(a), sitk.Hash(b) )
+           for x, y in zip( a.GetOrigin() + a.GetSpacing() + a.GetDirection(),
+                            b.GetOrigin() + b.GetSpacing() + b.GetDirection() ):
+             self.assertAlmostEqual( x, y )
+
+         assertSameImage( img[1:4,2:,0:2], sitk.Slice( img, [1,2,0], [4,4,2] ) )
+
+         # the singular sub-matrix is replaced with the identity
+         for i in range(3):
+           idx = [slice(None)]*3
+           idx[i] = 1
+           size = list(img.GetSize())
+           size[i] = 0
+           start = [0,0,0]
+           start[i] = 1
+           stop = list(img.GetSize())
+           stop[i] = 2
+           assertSameImage( img[tuple(idx)], sitk.Extract( sitk.Slice( img, start, stop ), size ) )
+
+         vnda = np.linspace(0, 119, 120 ).reshape(3,4,5,2)
+         vimg = sitk.GetImageFromArray( vnda, isVector=True )
+         self.assertEqual( vimg[:,:,1].GetNumberOfComponentsPerPixel(), 2 )
+         self.assertTrue( np.array_equal( sitk.GetArrayFromImage( vimg[1:3,:,1] ), vnda[1,:,1:3] ) )
+
     def test_compare(self):
 
         img = sitk.Image(1,1,sitk.sitkFloat32)
@@ -0,0 +1,180 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <SimpleITKTestHarness.h>
+#include <itkBandedSignedMaurerDistanceMapImageFilter.h>
+
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+#include <cmath>
+
+// This test verifies that the distances of the
+// BandedSignedMaurerDistanceMapImageFilter are the distances of the
+// SignedMaurerDistanceMapImageFilter clamped to the band.
+
+namespace
+{
+
+typedef itk::Image<unsigned char, 3> BinaryImageType;
+typedef itk::Image<float, 3>         FloatImageType;
+
+BinaryImageType::Pointer CreateInput( bool empty )
+{
+  BinaryImageType::Pointer img = BinaryImageType::New();
+
+  BinaryImageType::SizeType size;
+  size[0] = 60;
+  size[1] = 50;
+  size[2] = 40;
+  BinaryImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 0.5;
+  spacing[2] = 2.0;
+
+  img->SetRegions( size );
+  img->SetSpacing( spacing );
+  img->Allocate();
+  img->FillBuffer( 0 );
+
+  if ( empty )
+    {
+    return img;
+    }
+
+  // a box and a ball
+  for ( int z = 10; z < 16; ++z )
+    {
+    for ( int y = 12; y < 30; ++y )
+      {
+      for ( int x = 20; x < 31; ++x )
+        {
+        BinaryImageType::IndexType idx = {{ x, y, z }};
+        img->SetPixel( idx, 1 );
+        }
+      }
+    }
+  for ( int z = 14; z < 26; ++z )
+    {
+    for ( int y = 22; y < 40; ++y )
+      {
+      for ( int x = 26; x < 42; ++x )
+        {
+        const double dx = x - 34;
+        const double dy = y - 31;
+        const double dz = z - 20;
+        if ( dx * dx + dy * dy + dz * dz < 30.0 )
+          {
+          BinaryImageType::IndexType idx = {{ x, y, z }};
+          img->SetPixel( idx, 1 );
+          }
+        }
+      }
+    }
+
+  return img;
+}
+
+FloatImageType::Pointer RunFilter( const BinaryImageType *img,
+                                   double maximumDistance,
+                                   bool squaredDistance,
+                                   bool useImageSpacing,
+                                   bool insideIsPositive )
+{
+  typedef itk::BandedSignedMaurerDistanceMapImageFilter<BinaryImageType, FloatImageType> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+
+  filter->SetInput( img );
+  filter->SetMaximumDistance( maximumDistance );
+  filter->SetSquaredDistance( squaredDistance );
+  filter->SetUseImageSpacing( useImageSpacing );
+  filter->SetInsideIsPositive( insideIsPositive );
+  filter->Update();
+
+  EXPECT_EQ( maximumDistance > 0.0, filter->GetBandUsed() );
+
+  return filter->GetOutput();
+}
+
+void CheckBand( const BinaryImageType *img,
+                double maximumDistance,
+                bool squaredDistance,
+                bool useImageSpacing,
+                bool insideIsPositive )
+{
+  FloatImageType::Pointer expected = RunFilter( img, 0.0, squaredDistance, useImageSpacing, insideIsPositive );
+  FloatImageType::Pointer result = RunFilter( img, maximumDistance, squaredDistance, useImageSpacing, insideIsPositive );
+
+  double limit = maximumDistance;
+  if ( squaredDistance )
+    {
+    limit *= maximumDistance;
+    }
+
+  typedef itk::ImageRegionConstIterator<FloatImageType> IteratorType;
+  IteratorType eIt( expected, expected->GetBufferedRegion() );
+  IteratorType rIt( result, result->GetBufferedRegion() );
+
+  unsigned int numberOfDifferences = 0;
+  while( !eIt.IsAtEnd() )
+    {
+    const double clamped = std::min( std::max( static_cast<double>( eIt.Get() ), -limit ), limit );
+    if ( std::abs( clamped - static_cast<double>( rIt.Get() ) ) > 1e-4 * ( 1.0 + limit ) )
+      {
+      ++numberOfDifferences;
+      }
+    ++eIt;
+    ++rIt;
+    }
+  EXPECT_EQ( 0u, numberOfDifferences );
+}
+
+}
+
+TEST(BandedSignedMaurerDistanceMapImageFilterTest, Band)
+{
+  BinaryImageType::Pointer img = CreateInput( false );
+
+  CheckBand( img, 3.0, false, false, false );
+  CheckBand( img, 3.0, true, false, false );
+  CheckBand( img, 4.5, false, true, false );
+  CheckBand( img, 4.5, true, true, true );
+  // the band covers the whole image
+  CheckBand( img, 200.0, false, true, false );
+}
+
+TEST(BandedSignedMaurerDistanceMapImageFilterTest, Empty)
+{
+  BinaryImageType::Pointer img = CreateInput( true );
+
+  FloatImageType::Pointer result = RunFilter( img, 5.0, false, false, false );
+
+  typedef itk::ImageRegionConstIterator<FloatImageType> IteratorType;
+  IteratorType rIt( result, result->GetBufferedRegion() );
+
+  unsigned int numberOfDifferences = 0;
+  while( !rIt.IsAtEnd() )
+    {
+    if ( rIt.Get() != 5.0f )
+      {
+      ++numberOfDifferences;
+      }
+    ++rIt;
+    }
+  EXPECT_EQ( 0u, numberOfDifferences );
+}
@@ -0,0 +1,127 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <SimpleITKTestHarness.h>
+#include <itkBlockedPermuteAxesImageFilter.h>
+
+#include "itkVectorImage.h"
+
+#include <complex>
+
+// This test verifies that the BlockedPermuteAxesImageFilter produces
+// the same output as the PermuteAxesImageFilter for all the orders,
+// with sizes which are not multiples of the block size.
+
+namespace
+{
+
+template <typename TImageType>
+typename TImageType::Pointer CreateInput( unsigned int numberOfComponents )
+{
+  typename TImageType::Pointer image = TImageType::New();
+
+  typename TImageType::IndexType index;
+  index[0] = 3;
+  index[1] = -2;
+  index[2] = 1;
+  typename TImageType::SizeType size;
+  size[0] = 71;
+  size[1] = 37;
+  size[2] = 5;
+  typename TImageType::RegionType region( index, size );
+  image->SetRegions( region );
+  image->SetNumberOfComponentsPerPixel( numberOfComponents );
+  image->Allocate();
+
+  typedef typename TImageType::InternalPixelType ComponentType;
+  ComponentType *buffer = image->GetBufferPointer();
+  const size_t n = region.GetNumberOfPixels() * numberOfComponents;
+  for ( size_t i = 0; i < n; ++i )
+    {
+    buffer[i] = static_cast<ComponentType>( i % 1009 );
+    }
+  return image;
+}
+
+template <typename TImageType>
+void CheckPermute( unsigned int numberOfComponents )
+{
+  typedef itk::BlockedPermuteAxesImageFilter<TImageType> FilterType;
+  typedef itk::PermuteAxesImageFilter<TImageType>        BaselineType;
+
+  typename TImageType::Pointer input = CreateInput<TImageType>( numberOfComponents );
+
+  unsigned int orders[6][3] = { {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0} };
+  for ( unsigned int o = 0; o < 6; ++o )
+    {
+    typename FilterType::PermuteOrderArrayType order;
+    for ( unsigned int j = 0; j < 3; ++j )
+      {
+      order[j] = orders[o][j];
+      }
+
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( input );
+    filter->SetOrder( order );
+    filter->SetNumberOfThreads( 3 );
+    filter->Update();
+
+    typename BaselineType::Pointer baseline = BaselineType::New();
+    baseline->SetInput( input );
+    baseline->SetOrder( order );
+    baseline->Update();
+
+    const TImageType *result = filter->GetOutput();
+    const TImageType *expected = baseline->GetOutput();
+
+    ASSERT_EQ( expected->GetBufferedRegion(), result->GetBufferedRegion() );
+
+    typedef typename TImageType::InternalPixelType ComponentType;
+    const ComponentType *r = result->GetBufferPointer();
+    const ComponentType *e = expected->GetBufferPointer();
+    const size_t n = result->GetBufferedRegion().GetNumberOfPixels() * numberOfComponents;
+
+    unsigned int numberOfDifferences = 0;
+    for ( size_t i = 0; i < n; ++i )
+      {
+      if ( !( r[i] == e[i] ) )
+        {
+        ++numberOfDifferences;
+        }
+      }
+    EXPECT_EQ( 0u, numberOfDifferences ) << "order " << order;
+    }
+}
+
+}
+
+TEST(BlockedPermuteAxesImageFilterTest, Scalar)
+{
+  CheckPermute< itk::Image<short, 3> >( 1 );
+  CheckPermute< itk::Image<double, 3> >( 1 );
+}
+
+TEST(BlockedPermuteAxesImageFilterTest, Vector)
+{
+  CheckPermute< itk::VectorImage<float, 3> >( 3 );
+}
+
+TEST(BlockedPermuteAxesImageFilterTest, Complex)
+{
+  CheckPermute< itk::Image<std::complex<float>, 3> >( 1 );
+}
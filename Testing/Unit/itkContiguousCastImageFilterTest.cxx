@@ -0,0 +1,122 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <SimpleITKTestHarness.h>
+#include <itkContiguousCastImageFilter.h>
+
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkVectorImage.h"
+
+#include <complex>
+
+// This test verifies that the fast path of the
+// ContiguousCastImageFilter produces the same output as the
+// CastImageFilter, for scalar images and VectorImages.
+
+namespace
+{
+
+template <typename TImageType>
+typename TImageType::Pointer CreateInput( unsigned int numberOfComponents )
+{
+  typename TImageType::Pointer image = TImageType::New();
+
+  typename TImageType::SizeType size;
+  size[0] = 33;
+  size[1] = 7;
+  size[2] = 5;
+  typename TImageType::RegionType region( size );
+  image->SetRegions( region );
+  image->SetNumberOfComponentsPerPixel( numberOfComponents );
+  image->Allocate();
+
+  typedef typename TImageType::InternalPixelType ComponentType;
+  ComponentType *buffer = reinterpret_cast<ComponentType *>( image->GetBufferPointer() );
+  const size_t n = region.GetNumberOfPixels() * numberOfComponents;
+  for ( size_t i = 0; i < n; ++i )
+    {
+    // negative, fractional and large values
+    buffer[i] = static_cast<ComponentType>( ( static_cast<double>( i % 997 ) - 311.0 ) * 1.375 );
+    }
+  return image;
+}
+
+template <typename TInputImageType, typename TOutputImageType>
+void CheckCast( unsigned int numberOfComponents, bool expectSupported )
+{
+  typedef itk::ContiguousCastImageFilter<TInputImageType, TOutputImageType> FilterType;
+  typedef itk::CastImageFilter<TInputImageType, TOutputImageType>           BaselineType;
+
+  EXPECT_EQ( expectSupported, FilterType::IsContiguousCastSupported() );
+
+  typename TInputImageType::Pointer input = CreateInput<TInputImageType>( numberOfComponents );
+
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( input );
+  filter->SetNumberOfThreads( 3 );
+  filter->Update();
+
+  typename BaselineType::Pointer baseline = BaselineType::New();
+  baseline->SetInput( input );
+  baseline->Update();
+
+  const TOutputImageType *result = filter->GetOutput();
+  const TOutputImageType *expected = baseline->GetOutput();
+
+  ASSERT_EQ( expected->GetNumberOfComponentsPerPixel(), result->GetNumberOfComponentsPerPixel() );
+  ASSERT_EQ( expected->GetBufferedRegion(), result->GetBufferedRegion() );
+
+  typedef typename TOutputImageType::InternalPixelType ComponentType;
+  const ComponentType *r = reinterpret_cast<const ComponentType *>( result->GetBufferPointer() );
+  const ComponentType *e = reinterpret_cast<const ComponentType *>( expected->GetBufferPointer() );
+  const size_t n = result->GetBufferedRegion().GetNumberOfPixels() * result->GetNumberOfComponentsPerPixel();
+
+  unsigned int numberOfDifferences = 0;
+  for ( size_t i = 0; i < n; ++i )
+    {
+    if ( !( r[i] == e[i] ) )
+      {
+      ++numberOfDifferences;
+      }
+    }
+  EXPECT_EQ( 0u, numberOfDifferences );
+}
+
+}
+
+TEST(ContiguousCastImageFilterTest, Scalar)
+{
+  CheckCast< itk::Image<short, 3>, itk::Image<float, 3> >( 1, true );
+  CheckCast< itk::Image<unsigned char, 3>, itk::Image<float, 3> >( 1, true );
+  CheckCast< itk::Image<double, 3>, itk::Image<float, 3> >( 1, true );
+  CheckCast< itk::Image<float, 3>, itk::Image<short, 3> >( 1, true );
+  CheckCast< itk::Image<float, 3>, itk::Image<float, 3> >( 1, true );
+}
+
+TEST(ContiguousCastImageFilterTest, Vector)
+{
+  CheckCast< itk::VectorImage<short, 3>, itk::VectorImage<float, 3> >( 3, true );
+  CheckCast< itk::VectorImage<unsigned char, 3>, itk::VectorImage<double, 3> >( 2, true );
+}
+
+TEST(ContiguousCastImageFilterTest, Complex)
+{
+  // complex pixels use the CastImageFilter
+  CheckCast< itk::Image<std::complex<float>, 3>, itk::Image<std::complex<double>, 3> >( 1, false );
+}
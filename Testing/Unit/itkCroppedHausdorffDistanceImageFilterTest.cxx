@@ -0,0 +1,201 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <SimpleITKTestHarness.h>
+#include <itkCroppedHausdorffDistanceImageFilter.h>
+
+#include "itkLabelOverlapMeasuresImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// This test verifies that the CroppedHausdorffDistanceImageFilter
+// computes the distances of the HausdorffDistanceImageFilter, the
+// overlap of the LabelOverlapMeasuresImageFilter, and the average
+// distance between the surfaces.
+
+namespace
+{
+
+typedef itk::Image<unsigned char, 3> BinaryImageType;
+
+BinaryImageType::Pointer CreateBall( double cx, double cy, double cz, double radius )
+{
+  BinaryImageType::Pointer img = BinaryImageType::New();
+
+  BinaryImageType::SizeType size;
+  size[0] = 40;
+  size[1] = 36;
+  size[2] = 30;
+  BinaryImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 0.75;
+  spacing[2] = 1.5;
+
+  img->SetRegions( size );
+  img->SetSpacing( spacing );
+  img->Allocate();
+  img->FillBuffer( 0 );
+
+  typedef itk::ImageRegionIteratorWithIndex<BinaryImageType> IteratorType;
+  IteratorType it( img, img->GetLargestPossibleRegion() );
+  while ( !it.IsAtEnd() )
+    {
+    const BinaryImageType::IndexType idx = it.GetIndex();
+    const double dx = ( idx[0] - cx ) * spacing[0];
+    const double dy = ( idx[1] - cy ) * spacing[1];
+    const double dz = ( idx[2] - cz ) * spacing[2];
+    if ( dx * dx + dy * dy + dz * dz <= radius * radius )
+      {
+      it.Set( 1 );
+      }
+    ++it;
+    }
+  return img;
+}
+
+// The physical positions of the non-zero pixels with a zero face
+// neighbor.
+std::vector<itk::Point<double, 3> > GetSurface( const BinaryImageType *img )
+{
+  std::vector<itk::Point<double, 3> > surface;
+
+  typedef itk::ImageRegionConstIteratorWithIndex<BinaryImageType> IteratorType;
+  IteratorType it( img, img->GetLargestPossibleRegion() );
+  while ( !it.IsAtEnd() )
+    {
+    if ( it.Get() != 0 )
+      {
+      const BinaryImageType::IndexType idx = it.GetIndex();
+      bool onSurface = false;
+      for ( unsigned int d = 0; d < 3; ++d )
+        {
+        for ( int step = -1; step <= 1; step += 2 )
+          {
+          BinaryImageType::IndexType neighbor = idx;
+          neighbor[d] += step;
+          onSurface = onSurface || img->GetPixel( neighbor ) == 0;
+          }
+        }
+      if ( onSurface )
+        {
+        itk::Point<double, 3> point;
+        for ( unsigned int d = 0; d < 3; ++d )
+          {
+          point[d] = idx[d] * img->GetSpacing()[d];
+          }
+        surface.push_back( point );
+        }
+      }
+    ++it;
+    }
+  return surface;
+}
+
+double SumSurfaceDistances( const std::vector<itk::Point<double, 3> > &from,
+                            const std::vector<itk::Point<double, 3> > &to )
+{
+  double sum = 0.0;
+  for ( size_t i = 0; i < from.size(); ++i )
+    {
+    double minimum = itk::NumericTraits<double>::max();
+    for ( size_t j = 0; j < to.size(); ++j )
+      {
+      minimum = std::min( minimum, from[i].EuclideanDistanceTo( to[j] ) );
+      }
+    sum += minimum;
+    }
+  return sum;
+}
+
+}
+
+TEST(CroppedHausdorffDistanceImageFilterTest, Measures)
+{
+  BinaryImageType::Pointer img1 = CreateBall( 14.0, 15.0, 12.0, 7.0 );
+  BinaryImageType::Pointer img2 = CreateBall( 19.0, 17.0, 14.0, 5.5 );
+
+  typedef itk::HausdorffDistanceImageFilter<BinaryImageType, BinaryImageType> HausdorffType;
+  HausdorffType::Pointer hausdorff = HausdorffType::New();
+  hausdorff->SetInput1( img1 );
+  hausdorff->SetInput2( img2 );
+  hausdorff->Update();
+
+  typedef itk::LabelOverlapMeasuresImageFilter<BinaryImageType> OverlapType;
+  OverlapType::Pointer overlap = OverlapType::New();
+  overlap->SetSourceImage( img1 );
+  overlap->SetTargetImage( img2 );
+  overlap->Update();
+
+  typedef itk::CroppedHausdorffDistanceImageFilter<BinaryImageType, BinaryImageType> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput1( img1 );
+  filter->SetInput2( img2 );
+  filter->Update();
+
+  EXPECT_TRUE( filter->GetBoundingBoxUsed() );
+  EXPECT_NEAR( hausdorff->GetHausdorffDistance(), filter->GetHausdorffDistance(), 1e-4 );
+  EXPECT_NEAR( hausdorff->GetAverageHausdorffDistance(), filter->GetAverageHausdorffDistance(), 1e-4 );
+  EXPECT_NEAR( overlap->GetDiceCoefficient( 1 ), filter->GetDiceCoefficient(), 1e-6 );
+  EXPECT_NEAR( overlap->GetJaccardCoefficient( 1 ), filter->GetJaccardCoefficient(), 1e-6 );
+
+  const std::vector<itk::Point<double, 3> > surface1 = GetSurface( img1 );
+  const std::vector<itk::Point<double, 3> > surface2 = GetSurface( img2 );
+  const double averageSurfaceDistance = ( SumSurfaceDistances( surface1, surface2 )
+                                          + SumSurfaceDistances( surface2, surface1 ) )
+    / ( surface1.size() + surface2.size() );
+  EXPECT_NEAR( averageSurfaceDistance, filter->GetAverageSurfaceDistance(), 1e-4 );
+
+  // the band is wider than the distances
+  filter->SetMaximumDistance( 40.0 );
+  filter->Update();
+  EXPECT_NEAR( hausdorff->GetHausdorffDistance(), filter->GetHausdorffDistance(), 1e-4 );
+  EXPECT_NEAR( averageSurfaceDistance, filter->GetAverageSurfaceDistance(), 1e-4 );
+
+  // the distances are clamped to the band
+  filter->SetMaximumDistance( 2.0 );
+  filter->Update();
+  EXPECT_NEAR( 2.0, filter->GetHausdorffDistance(), 1e-4 );
+
+  filter->SetMaximumDistance( 0.0 );
+  filter->UseBoundingBoxOff();
+  filter->Update();
+  EXPECT_FALSE( filter->GetBoundingBoxUsed() );
+  EXPECT_NEAR( hausdorff->GetHausdorffDistance(), filter->GetHausdorffDistance(), 1e-4 );
+  EXPECT_NEAR( overlap->GetDiceCoefficient( 1 ), filter->GetDiceCoefficient(), 1e-6 );
+}
+
+TEST(CroppedHausdorffDistanceImageFilterTest, Identical)
+{
+  BinaryImageType::Pointer img = CreateBall( 20.0, 18.0, 15.0, 6.0 );
+
+  typedef itk::CroppedHausdorffDistanceImageFilter<BinaryImageType, BinaryImageType> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput1( img );
+  filter->SetInput2( img );
+  filter->Update();
+
+  EXPECT_TRUE( filter->GetBoundingBoxUsed() );
+  EXPECT_EQ( 0.0, filter->GetHausdorffDistance() );
+  EXPECT_EQ( 0.0, filter->GetAverageSurfaceDistance() );
+  EXPECT_EQ( 1.0, filter->GetDiceCoefficient() );
+  EXPECT_EQ( 1.0, filter->GetJaccardCoefficient() );
+}
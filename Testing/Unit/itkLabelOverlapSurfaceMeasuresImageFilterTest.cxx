@@ -0,0 +1,180 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <SimpleITKTestHarness.h>
+#include <itkLabelOverlapSurfaceMeasuresImageFilter.h>
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// This test verifies the surface distances of each label of the
+// LabelOverlapSurfaceMeasuresImageFilter against the distances
+// between all the surface pixels.
+
+namespace
+{
+
+typedef itk::Image<unsigned short, 3> LabelImageType;
+typedef itk::Point<double, 3>         PointType;
+
+// Two balls with the labels 3 and 7, touching each other.
+LabelImageType::Pointer CreateLabels( double shift )
+{
+  LabelImageType::Pointer img = LabelImageType::New();
+
+  LabelImageType::SizeType size;
+  size[0] = 36;
+  size[1] = 30;
+  size[2] = 24;
+  LabelImageType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 0.8;
+  spacing[2] = 1.25;
+
+  img->SetRegions( size );
+  img->SetSpacing( spacing );
+  img->Allocate();
+  img->FillBuffer( 0 );
+
+  typedef itk::ImageRegionIteratorWithIndex<LabelImageType> IteratorType;
+  IteratorType it( img, img->GetLargestPossibleRegion() );
+  while ( !it.IsAtEnd() )
+    {
+    const LabelImageType::IndexType idx = it.GetIndex();
+    const double x = idx[0] * spacing[0];
+    const double y = idx[1] * spacing[1];
+    const double z = idx[2] * spacing[2];
+    const double d1 = ( x - 12.0 - shift ) * ( x - 12.0 - shift ) + ( y - 12.0 ) * ( y - 12.0 ) + ( z - 14.0 ) * ( z - 14.0 );
+    const double d2 = ( x - 22.0 ) * ( x - 22.0 ) + ( y - 13.0 - shift ) * ( y - 13.0 - shift ) + ( z - 15.0 ) * ( z - 15.0 );
+    if ( d1 <= 36.0 )
+      {
+      it.Set( 3 );
+      }
+    else if ( d2 <= 25.0 + 4.0 * shift )
+      {
+      it.Set( 7 );
+      }
+    ++it;
+    }
+  return img;
+}
+
+// The physical positions of the pixels of a label with a face
+// neighbor inside of the image with another label.
+std::vector<PointType> GetSurface( const LabelImageType *img, LabelImageType::PixelType label )
+{
+  std::vector<PointType> surface;
+
+  const LabelImageType::RegionType region = img->GetLargestPossibleRegion();
+  typedef itk::ImageRegionConstIteratorWithIndex<LabelImageType> IteratorType;
+  IteratorType it( img, region );
+  while ( !it.IsAtEnd() )
+    {
+    if ( it.Get() == label )
+      {
+      const LabelImageType::IndexType idx = it.GetIndex();
+      bool onSurface = false;
+      for ( unsigned int d = 0; d < 3; ++d )
+        {
+        for ( int step = -1; step <= 1; step += 2 )
+          {
+          LabelImageType::IndexType neighbor = idx;
+          neighbor[d] += step;
+          onSurface = onSurface || ( region.IsInside( neighbor ) && img->GetPixel( neighbor ) != label );
+          }
+        }
+      if ( onSurface )
+        {
+        PointType point;
+        for ( unsigned int d = 0; d < 3; ++d )
+          {
+          point[d] = idx[d] * img->GetSpacing()[d];
+          }
+        surface.push_back( point );
+        }
+      }
+    ++it;
+    }
+  return surface;
+}
+
+void AddSurfaceDistances( const std::vector<PointType> &from,
+                          const std::vector<PointType> &to,
+                          double &maximum,
+                          double &sum )
+{
+  for ( size_t i = 0; i < from.size(); ++i )
+    {
+    double minimum = itk::NumericTraits<double>::max();
+    for ( size_t j = 0; j < to.size(); ++j )
+      {
+      minimum = std::min( minimum, from[i].EuclideanDistanceTo( to[j] ) );
+      }
+    maximum = std::max( maximum, minimum );
+    sum += minimum;
+    }
+}
+
+}
+
+TEST(LabelOverlapSurfaceMeasuresImageFilterTest, SurfaceDistances)
+{
+  LabelImageType::Pointer source = CreateLabels( 0.0 );
+  LabelImageType::Pointer target = CreateLabels( 2.5 );
+
+  typedef itk::LabelOverlapSurfaceMeasuresImageFilter<LabelImageType> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetSourceImage( source );
+  filter->SetTargetImage( target );
+  filter->ComputeSurfaceDistancesOn();
+  filter->Update();
+
+  const std::vector<LabelImageType::PixelType> labels = filter->GetLabels();
+  ASSERT_EQ( 2u, labels.size() );
+  EXPECT_EQ( 3u, labels[0] );
+  EXPECT_EQ( 7u, labels[1] );
+
+  for ( size_t l = 0; l < labels.size(); ++l )
+    {
+    const std::vector<PointType> surface1 = GetSurface( source, labels[l] );
+    const std::vector<PointType> surface2 = GetSurface( target, labels[l] );
+    double maximum = 0.0;
+    double sum = 0.0;
+    AddSurfaceDistances( surface1, surface2, maximum, sum );
+    AddSurfaceDistances( surface2, surface1, maximum, sum );
+
+    EXPECT_NEAR( maximum, filter->GetHausdorffDistance( labels[l] ), 1e-6 );
+    EXPECT_NEAR( sum / ( surface1.size() + surface2.size() ), filter->GetMeanSurfaceDistance( labels[l] ), 1e-6 );
+    }
+
+  // identical images
+  filter->SetTargetImage( source );
+  filter->Update();
+  EXPECT_EQ( 0.0, filter->GetHausdorffDistance( 3 ) );
+  EXPECT_EQ( 0.0, filter->GetMeanSurfaceDistance( 7 ) );
+
+  EXPECT_THROW( filter->GetHausdorffDistance( 5 ), itk::ExceptionObject );
+
+  filter->ComputeSurfaceDistancesOff();
+  filter->Update();
+  EXPECT_THROW( filter->GetHausdorffDistance( 3 ), itk::ExceptionObject );
+}
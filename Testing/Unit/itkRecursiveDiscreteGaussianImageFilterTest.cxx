@@ -0,0 +1,162 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <SimpleITKTestHarness.h>
+#include <itkRecursiveDiscreteGaussianImageFilter.h>
+
+#include "itkGaussianImageSource.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <cmath>
+
+// This test verifies that the recursive path of the
+// RecursiveDiscreteGaussianImageFilter is close to the
+// DiscreteGaussianImageFilter, and that it is only used for large
+// variances.
+
+namespace
+{
+
+typedef itk::Image<float, 3> FloatImageType;
+
+FloatImageType::Pointer CreateInput()
+{
+  typedef itk::GaussianImageSource<FloatImageType> SourceType;
+  SourceType::Pointer source = SourceType::New();
+
+  SourceType::SizeType size;
+  size[0] = 64;
+  size[1] = 48;
+  size[2] = 40;
+  SourceType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 1.5;
+  spacing[2] = 2.0;
+  SourceType::ArrayType sigma;
+  sigma[0] = 6.0;
+  sigma[1] = 9.0;
+  sigma[2] = 8.0;
+  SourceType::ArrayType mean;
+  mean[0] = 30.0;
+  mean[1] = 35.0;
+  mean[2] = 40.0;
+
+  source->SetSize( size );
+  source->SetSpacing( spacing );
+  source->SetSigma( sigma );
+  source->SetMean( mean );
+  source->SetScale( 1000.0 );
+  source->SetNormalized( false );
+  source->Update();
+
+  return source->GetOutput();
+}
+
+FloatImageType::Pointer RunFilter( const FloatImageType *img,
+                                   const FloatImageType::SpacingType &variance,
+                                   bool useImageSpacing,
+                                   bool useRecursiveGaussian,
+                                   bool expectRecursiveGaussianUsed )
+{
+  typedef itk::RecursiveDiscreteGaussianImageFilter<FloatImageType, FloatImageType> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+
+  FilterType::ArrayType filterVariance;
+  for ( unsigned int d = 0; d < 3; ++d )
+    {
+    filterVariance[d] = variance[d];
+    }
+
+  filter->SetInput( img );
+  filter->SetVariance( filterVariance );
+  filter->SetUseImageSpacing( useImageSpacing );
+  // a kernel close to the untruncated discrete Gaussian
+  filter->SetMaximumError( 1e-5 );
+  filter->SetMaximumKernelWidth( 256 );
+  filter->SetUseRecursiveGaussian( useRecursiveGaussian );
+  filter->Update();
+
+  EXPECT_EQ( expectRecursiveGaussianUsed, filter->GetRecursiveGaussianUsed() );
+
+  return filter->GetOutput();
+}
+
+void CheckImagesNear( const FloatImageType *expected, const FloatImageType *result, double tolerance )
+{
+  typedef itk::ImageRegionConstIterator<FloatImageType> IteratorType;
+  IteratorType eIt( expected, expected->GetBufferedRegion() );
+  IteratorType rIt( result, result->GetBufferedRegion() );
+
+  unsigned int numberOfDifferences = 0;
+  while( !eIt.IsAtEnd() )
+    {
+    if ( std::abs( static_cast<double>( eIt.Get() ) - static_cast<double>( rIt.Get() ) ) > tolerance )
+      {
+      ++numberOfDifferences;
+      }
+    ++eIt;
+    ++rIt;
+    }
+  EXPECT_EQ( 0u, numberOfDifferences );
+}
+
+}
+
+TEST(RecursiveDiscreteGaussianImageFilterTest, LargeVariance)
+{
+  FloatImageType::Pointer img = CreateInput();
+
+  // sigma of 5, 6 and 4.5 pixels
+  FloatImageType::SpacingType variance;
+  variance[0] = 25.0;
+  variance[1] = 36.0;
+  variance[2] = 20.25;
+  FloatImageType::Pointer expected = RunFilter( img, variance, false, false, false );
+  FloatImageType::Pointer result = RunFilter( img, variance, false, true, true );
+  CheckImagesNear( expected, result, 2.0 );
+
+  // sigma of 6 pixels along each axis in physical units
+  variance[0] = 36.0;
+  variance[1] = 81.0;
+  variance[2] = 144.0;
+  expected = RunFilter( img, variance, true, false, false );
+  result = RunFilter( img, variance, true, true, true );
+  CheckImagesNear( expected, result, 2.0 );
+
+  // a zero variance does not smooth the axis
+  variance[2] = 0.0;
+  expected = RunFilter( img, variance, true, false, false );
+  result = RunFilter( img, variance, true, true, true );
+  CheckImagesNear( expected, result, 2.0 );
+}
+
+TEST(RecursiveDiscreteGaussianImageFilterTest, SmallVariance)
+{
+  FloatImageType::Pointer img = CreateInput();
+
+  // one axis below the minimum sigma
+  FloatImageType::SpacingType variance;
+  variance[0] = 25.0;
+  variance[1] = 4.0;
+  variance[2] = 25.0;
+  RunFilter( img, variance, false, true, false );
+
+  // no smoothing
+  variance.Fill( 0.0 );
+  RunFilter( img, variance, false, true, false );
+}
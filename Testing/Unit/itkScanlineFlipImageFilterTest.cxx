@@ -0,0 +1,119 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <SimpleITKTestHarness.h>
+#include <itkScanlineFlipImageFilter.h>
+
+#include "itkVectorImage.h"
+
+// This test verifies that the ScanlineFlipImageFilter produces the
+// same output as the FlipImageFilter for all the flipped axes, with
+// an input region which does not start at the zero index.
+
+namespace
+{
+
+template <typename TImageType>
+typename TImageType::Pointer CreateInput( unsigned int numberOfComponents )
+{
+  typename TImageType::Pointer image = TImageType::New();
+
+  typename TImageType::IndexType index;
+  index[0] = 3;
+  index[1] = -2;
+  index[2] = 1;
+  typename TImageType::SizeType size;
+  size[0] = 19;
+  size[1] = 11;
+  size[2] = 6;
+  typename TImageType::RegionType region( index, size );
+  image->SetRegions( region );
+  image->SetNumberOfComponentsPerPixel( numberOfComponents );
+  image->Allocate();
+
+  typedef typename TImageType::InternalPixelType ComponentType;
+  ComponentType *buffer = image->GetBufferPointer();
+  const size_t n = region.GetNumberOfPixels() * numberOfComponents;
+  for ( size_t i = 0; i < n; ++i )
+    {
+    buffer[i] = static_cast<ComponentType>( i % 1009 );
+    }
+  return image;
+}
+
+template <typename TImageType>
+void CheckFlip( unsigned int numberOfComponents )
+{
+  typedef itk::ScanlineFlipImageFilter<TImageType> FilterType;
+  typedef itk::FlipImageFilter<TImageType>         BaselineType;
+
+  typename TImageType::Pointer input = CreateInput<TImageType>( numberOfComponents );
+
+  for ( unsigned int axes = 0; axes < 8; ++axes )
+    {
+    typename FilterType::FlipAxesArrayType flipAxes;
+    for ( unsigned int j = 0; j < 3; ++j )
+      {
+      flipAxes[j] = ( axes >> j ) & 1;
+      }
+
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( input );
+    filter->SetFlipAxes( flipAxes );
+    filter->SetNumberOfThreads( 3 );
+    filter->Update();
+
+    typename BaselineType::Pointer baseline = BaselineType::New();
+    baseline->SetInput( input );
+    baseline->SetFlipAxes( flipAxes );
+    baseline->Update();
+
+    const TImageType *result = filter->GetOutput();
+    const TImageType *expected = baseline->GetOutput();
+
+    ASSERT_EQ( expected->GetBufferedRegion(), result->GetBufferedRegion() );
+
+    typedef typename TImageType::InternalPixelType ComponentType;
+    const ComponentType *r = result->GetBufferPointer();
+    const ComponentType *e = expected->GetBufferPointer();
+    const size_t n = result->GetBufferedRegion().GetNumberOfPixels() * numberOfComponents;
+
+    unsigned int numberOfDifferences = 0;
+    for ( size_t i = 0; i < n; ++i )
+      {
+      if ( !( r[i] == e[i] ) )
+        {
+        ++numberOfDifferences;
+        }
+      }
+    EXPECT_EQ( 0u, numberOfDifferences ) << "flip axes " << flipAxes;
+    }
+}
+
+}
+
+TEST(ScanlineFlipImageFilterTest, Scalar)
+{
+  CheckFlip< itk::Image<short, 3> >( 1 );
+  CheckFlip< itk::Image<float, 3> >( 1 );
+}
+
+TEST(ScanlineFlipImageFilterTest, Vector)
+{
+  CheckFlip< itk::VectorImage<unsigned char, 3> >( 4 );
+}
@@ -0,0 +1,277 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <SimpleITKTestHarness.h>
+#include <itkSeparableResampleImageFilter.h>
+
+#include "itkGaussianImageSource.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkScaleTransform.h"
+#include "itkEuler3DTransform.h"
+#include "itkCompositeTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkBSplineInterpolateImageFunction.h"
+
+#include <cmath>
+
+// This test verifies that the separable fast path of the
+// SeparableResampleImageFilter produces the same output as the
+// ResampleImageFilter, and that it is only used for axis aligned
+// mappings with a supported interpolator. The fast path for the other
+// linear mappings is also verified.
+
+namespace
+{
+
+typedef itk::Image<float, 3>         FloatImageType;
+typedef itk::Image<unsigned char, 3> UCharImageType;
+
+FloatImageType::Pointer CreateInput()
+{
+  typedef itk::GaussianImageSource<FloatImageType> SourceType;
+  SourceType::Pointer source = SourceType::New();
+
+  SourceType::SizeType size;
+  size[0] = 21;
+  size[1] = 17;
+  size[2] = 13;
+  SourceType::SpacingType spacing;
+  spacing[0] = 1.0;
+  spacing[1] = 1.5;
+  spacing[2] = 2.0;
+  SourceType::PointType origin;
+  origin[0] = -3.0;
+  origin[1] = 2.0;
+  origin[2] = 0.5;
+  SourceType::ArrayType sigma;
+  sigma.Fill( 6.0 );
+  SourceType::ArrayType mean;
+  mean[0] = 7.0;
+  mean[1] = 14.0;
+  mean[2] = 13.0;
+
+  source->SetSize( size );
+  source->SetSpacing( spacing );
+  source->SetOrigin( origin );
+  source->SetSigma( sigma );
+  source->SetMean( mean );
+  source->SetScale( 300.0 );
+  source->SetNormalized( false );
+  source->Update();
+
+  return source->GetOutput();
+}
+
+template <typename TOutputImageType>
+typename TOutputImageType::Pointer RunFilter( const FloatImageType *img,
+                                              const itk::Transform<double, 3, 3> *transform,
+                                              itk::InterpolateImageFunction<FloatImageType, double> *interpolator,
+                                              bool useSeparableMapping,
+                                              bool expectSeparableMappingUsed,
+                                              bool expectLinearMappingUsed = false )
+{
+  typedef itk::SeparableResampleImageFilter<FloatImageType, TOutputImageType, double> FilterType;
+  typename FilterType::Pointer filter = FilterType::New();
+
+  typename TOutputImageType::SizeType size;
+  size[0] = 37;
+  size[1] = 11;
+  size[2] = 19;
+  typename TOutputImageType::SpacingType spacing;
+  spacing[0] = 0.7;
+  spacing[1] = 2.5;
+  spacing[2] = 1.6;
+  typename TOutputImageType::PointType origin;
+  origin[0] = -5.0;
+  origin[1] = 1.0;
+  origin[2] = -1.0;
+
+  filter->SetInput( img );
+  filter->SetTransform( transform );
+  filter->SetInterpolator( interpolator );
+  filter->SetSize( size );
+  filter->SetOutputSpacing( spacing );
+  filter->SetOutputOrigin( origin );
+  filter->SetDefaultPixelValue( 7 );
+  filter->SetUseSeparableMapping( useSeparableMapping );
+  filter->Update();
+
+  EXPECT_EQ( expectSeparableMappingUsed, filter->GetSeparableMappingUsed() );
+  EXPECT_EQ( expectLinearMappingUsed, filter->GetLinearMappingUsed() );
+
+  return filter->GetOutput();
+}
+
+template <typename TImageType>
+void CheckImagesNear( const TImageType *expected, const TImageType *result, double tolerance )
+{
+  typedef itk::ImageRegionConstIterator<TImageType> IteratorType;
+  IteratorType eIt( expected, expected->GetBufferedRegion() );
+  IteratorType rIt( result, result->GetBufferedRegion() );
+
+  unsigned int numberOfDifferences = 0;
+  while( !eIt.IsAtEnd() )
+    {
+    if ( std::abs( static_cast<double>( eIt.Get() ) - static_cast<double>( rIt.Get() ) ) > tolerance )
+      {
+      ++numberOfDifferences;
+      }
+    ++eIt;
+    ++rIt;
+    }
+  EXPECT_EQ( 0u, numberOfDifferences );
+}
+
+}
+
+TEST(SeparableResampleImageFilterTest, Linear)
+{
+  FloatImageType::Pointer img = CreateInput();
+
+  typedef itk::ScaleTransform<double, 3> ScaleTransformType;
+  ScaleTransformType::Pointer transform = ScaleTransformType::New();
+  ScaleTransformType::ScaleType scale;
+  scale[0] = 1.3;
+  scale[1] = 0.8;
+  scale[2] = 1.1;
+  transform->SetScale( scale );
+  ScaleTransformType::InputPointType center;
+  center.Fill( 4.0 );
+  transform->SetCenter( center );
+
+  typedef itk::LinearInterpolateImageFunction<FloatImageType, double> InterpolatorType;
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+
+  FloatImageType::Pointer expected = RunFilter<FloatImageType>( img, transform, interpolator, false, false );
+  FloatImageType::Pointer result = RunFilter<FloatImageType>( img, transform, interpolator, true, true );
+  CheckImagesNear<FloatImageType>( expected, result, 1e-3 );
+
+  // the values are clamped and truncated as the ResampleImageFilter
+  UCharImageType::Pointer expectedUChar = RunFilter<UCharImageType>( img, transform, interpolator, false, false );
+  UCharImageType::Pointer resultUChar = RunFilter<UCharImageType>( img, transform, interpolator, true, true );
+  CheckImagesNear<UCharImageType>( expectedUChar, resultUChar, 1.0 );
+}
+
+TEST(SeparableResampleImageFilterTest, NearestNeighbor)
+{
+  FloatImageType::Pointer img = CreateInput();
+
+  typedef itk::ScaleTransform<double, 3> ScaleTransformType;
+  ScaleTransformType::Pointer transform = ScaleTransformType::New();
+  ScaleTransformType::ScaleType scale;
+  scale[0] = 0.9;
+  scale[1] = 1.2;
+  scale[2] = 1.0;
+  transform->SetScale( scale );
+
+  typedef itk::NearestNeighborInterpolateImageFunction<FloatImageType, double> InterpolatorType;
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+
+  FloatImageType::Pointer expected = RunFilter<FloatImageType>( img, transform, interpolator, false, false );
+  FloatImageType::Pointer result = RunFilter<FloatImageType>( img, transform, interpolator, true, true );
+  CheckImagesNear<FloatImageType>( expected, result, 0.0 );
+}
+
+TEST(SeparableResampleImageFilterTest, LinearMappingNearestNeighbor)
+{
+  FloatImageType::Pointer img = CreateInput();
+
+  // a rotation mixes the axes, with some output pixels outside of
+  // the input
+  typedef itk::Euler3DTransform<double> EulerTransformType;
+  EulerTransformType::Pointer transform = EulerTransformType::New();
+  transform->SetRotation( 0.3, -0.2, 0.4 );
+  EulerTransformType::InputPointType center;
+  center[0] = 5.0;
+  center[1] = 12.0;
+  center[2] = 10.0;
+  transform->SetCenter( center );
+
+  typedef itk::NearestNeighborInterpolateImageFunction<FloatImageType, double> InterpolatorType;
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+
+  FloatImageType::Pointer expected = RunFilter<FloatImageType>( img, transform, interpolator, false, false, false );
+  FloatImageType::Pointer result = RunFilter<FloatImageType>( img, transform, interpolator, true, false, true );
+  CheckImagesNear<FloatImageType>( expected, result, 0.0 );
+
+  UCharImageType::Pointer expectedUChar = RunFilter<UCharImageType>( img, transform, interpolator, false, false, false );
+  UCharImageType::Pointer resultUChar = RunFilter<UCharImageType>( img, transform, interpolator, true, false, true );
+  CheckImagesNear<UCharImageType>( expectedUChar, resultUChar, 0.0 );
+}
+
+TEST(SeparableResampleImageFilterTest, LinearMappingLinear)
+{
+  FloatImageType::Pointer img = CreateInput();
+
+  // a composite of linear transforms is linear
+  typedef itk::Euler3DTransform<double> EulerTransformType;
+  EulerTransformType::Pointer euler = EulerTransformType::New();
+  euler->SetRotation( -0.2, 0.1, 0.3 );
+  EulerTransformType::OutputVectorType translation;
+  translation[0] = 1.5;
+  translation[1] = -2.0;
+  translation[2] = 0.7;
+  euler->SetTranslation( translation );
+
+  typedef itk::ScaleTransform<double, 3> ScaleTransformType;
+  ScaleTransformType::Pointer scale = ScaleTransformType::New();
+  ScaleTransformType::ScaleType factors;
+  factors[0] = 1.1;
+  factors[1] = 0.9;
+  factors[2] = 1.2;
+  scale->SetScale( factors );
+
+  typedef itk::CompositeTransform<double, 3> CompositeTransformType;
+  CompositeTransformType::Pointer transform = CompositeTransformType::New();
+  transform->AddTransform( euler );
+  transform->AddTransform( scale );
+
+  typedef itk::LinearInterpolateImageFunction<FloatImageType, double> InterpolatorType;
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+
+  FloatImageType::Pointer expected = RunFilter<FloatImageType>( img, transform, interpolator, false, false, false );
+  FloatImageType::Pointer result = RunFilter<FloatImageType>( img, transform, interpolator, true, false, true );
+  CheckImagesNear<FloatImageType>( expected, result, 1e-3 );
+
+  UCharImageType::Pointer expectedUChar = RunFilter<UCharImageType>( img, transform, interpolator, false, false, false );
+  UCharImageType::Pointer resultUChar = RunFilter<UCharImageType>( img, transform, interpolator, true, false, true );
+  CheckImagesNear<UCharImageType>( expectedUChar, resultUChar, 1.0 );
+}
+
+TEST(SeparableResampleImageFilterTest, NotSeparable)
+{
+  FloatImageType::Pointer img = CreateInput();
+
+  // a rotation mixes the axes, the linear mapping is used
+  typedef itk::Euler3DTransform<double> EulerTransformType;
+  EulerTransformType::Pointer transform = EulerTransformType::New();
+  transform->SetRotation( 0.0, 0.0, 0.1 );
+
+  typedef itk::LinearInterpolateImageFunction<FloatImageType, double> InterpolatorType;
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  RunFilter<FloatImageType>( img, transform, interpolator, true, false, true );
+
+  // an interpolator without a separable implementation
+  typedef itk::ScaleTransform<double, 3> ScaleTransformType;
+  ScaleTransformType::Pointer scaleTransform = ScaleTransformType::New();
+
+  typedef itk::BSplineInterpolateImageFunction<FloatImageType, double> BSplineInterpolatorType;
+  BSplineInterpolatorType::Pointer bsplineInterpolator = BSplineInterpolatorType::New();
+  RunFilter<FloatImageType>( img, scaleTransform, bsplineInterpolator, true, false );
+}
@@ -0,0 +1,204 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <SimpleITKTestHarness.h>
+#include <itkSlidingHistogramRankImageFilter.h>
+#include <itkSlidingHistogramMedianImageFilter.h>
+
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+// This test verifies that the sliding histogram path of the
+// SlidingHistogramRankImageFilter and the
+// SlidingHistogramMedianImageFilter produces the same output as the
+// RankImageFilter and the MedianImageFilter, and that it is only used
+// for small integer pixels.
+
+namespace
+{
+
+template <typename TImageType>
+typename TImageType::Pointer CreateInput( const typename TImageType::SizeType &size, int range, int offset )
+{
+  typename TImageType::Pointer img = TImageType::New();
+  img->SetRegions( typename TImageType::RegionType( size ) );
+  img->Allocate();
+
+  // a deterministic pseudo random image
+  unsigned int state = 12345;
+  itk::ImageRegionIterator<TImageType> it( img, img->GetBufferedRegion() );
+  while( !it.IsAtEnd() )
+    {
+    state = state * 1103515245u + 12345u;
+    it.Set( static_cast<typename TImageType::PixelType>( int( ( state >> 16 ) % range ) + offset ) );
+    ++it;
+    }
+  return img;
+}
+
+template <typename TImageType>
+void CheckImagesEqual( const TImageType *expected, const TImageType *result )
+{
+  typedef itk::ImageRegionConstIterator<TImageType> IteratorType;
+  IteratorType eIt( expected, expected->GetBufferedRegion() );
+  IteratorType rIt( result, result->GetBufferedRegion() );
+
+  unsigned int numberOfDifferences = 0;
+  while( !eIt.IsAtEnd() )
+    {
+    if ( eIt.Get() != rIt.Get() )
+      {
+      ++numberOfDifferences;
+      }
+    ++eIt;
+    ++rIt;
+    }
+  EXPECT_EQ( 0u, numberOfDifferences );
+}
+
+template <typename TImageType>
+typename TImageType::Pointer RunRank( const TImageType *img,
+                                      const typename TImageType::SizeType &radius,
+                                      double rank,
+                                      bool useSlidingHistogram,
+                                      bool expectSlidingHistogramUsed )
+{
+  typedef itk::SlidingHistogramRankImageFilter<TImageType, TImageType> FilterType;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( img );
+  filter->SetRadius( radius );
+  filter->SetRank( rank );
+  filter->SetUseSlidingHistogram( useSlidingHistogram );
+  filter->Update();
+
+  EXPECT_EQ( expectSlidingHistogramUsed, filter->GetSlidingHistogramUsed() );
+
+  return filter->GetOutput();
+}
+
+template <typename TImageType>
+typename TImageType::Pointer RunMedian( const TImageType *img,
+                                        const typename TImageType::SizeType &radius,
+                                        bool useSlidingHistogram,
+                                        bool expectSlidingHistogramUsed )
+{
+  typedef itk::SlidingHistogramMedianImageFilter<TImageType, TImageType> FilterType;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( img );
+  filter->SetRadius( radius );
+  filter->SetUseSlidingHistogram( useSlidingHistogram );
+  filter->Update();
+
+  EXPECT_EQ( expectSlidingHistogramUsed, filter->GetSlidingHistogramUsed() );
+
+  return filter->GetOutput();
+}
+
+template <typename TImageType>
+void CheckRanks( const TImageType *img, const typename TImageType::SizeType &radius )
+{
+  const double ranks[] = { 0.0, 0.3, 0.5, 1.0 };
+  for ( unsigned int i = 0; i < sizeof( ranks ) / sizeof( ranks[0] ); ++i )
+    {
+    typename TImageType::Pointer expected = RunRank<TImageType>( img, radius, ranks[i], false, false );
+    typename TImageType::Pointer result = RunRank<TImageType>( img, radius, ranks[i], true, true );
+    CheckImagesEqual<TImageType>( expected, result );
+    }
+
+  typename TImageType::Pointer expected = RunMedian<TImageType>( img, radius, false, false );
+  typename TImageType::Pointer result = RunMedian<TImageType>( img, radius, true, true );
+  CheckImagesEqual<TImageType>( expected, result );
+}
+
+}
+
+TEST(SlidingHistogramRankImageFilterTest, UChar2D)
+{
+  typedef itk::Image<unsigned char, 2> ImageType;
+
+  ImageType::SizeType size;
+  size[0] = 41;
+  size[1] = 29;
+  ImageType::Pointer img = CreateInput<ImageType>( size, 256, 0 );
+
+  ImageType::SizeType radius;
+  radius[0] = 3;
+  radius[1] = 1;
+  CheckRanks<ImageType>( img, radius );
+
+  // a box larger than the image
+  radius[0] = 25;
+  radius[1] = 40;
+  CheckRanks<ImageType>( img, radius );
+}
+
+TEST(SlidingHistogramRankImageFilterTest, Short3D)
+{
+  typedef itk::Image<short, 3> ImageType;
+
+  ImageType::SizeType size;
+  size[0] = 23;
+  size[1] = 17;
+  size[2] = 11;
+  ImageType::Pointer img = CreateInput<ImageType>( size, 3000, -1000 );
+
+  ImageType::SizeType radius;
+  radius[0] = 2;
+  radius[1] = 4;
+  radius[2] = 1;
+  CheckRanks<ImageType>( img, radius );
+
+  radius[0] = 0;
+  radius[1] = 9;
+  radius[2] = 6;
+  CheckRanks<ImageType>( img, radius );
+}
+
+TEST(SlidingHistogramRankImageFilterTest, UShort3D)
+{
+  typedef itk::Image<unsigned short, 3> ImageType;
+
+  ImageType::SizeType size;
+  size[0] = 19;
+  size[1] = 13;
+  size[2] = 7;
+  // the full range of the pixel type
+  ImageType::Pointer img = CreateInput<ImageType>( size, 65536, 0 );
+
+  ImageType::SizeType radius;
+  radius[0] = 5;
+  radius[1] = 2;
+  radius[2] = 3;
+  CheckRanks<ImageType>( img, radius );
+}
+
+TEST(SlidingHistogramRankImageFilterTest, NotSupported)
+{
+  // the real pixels use the RankImageFilter and the MedianImageFilter
+  typedef itk::Image<float, 2> ImageType;
+
+  ImageType::SizeType size;
+  size[0] = 15;
+  size[1] = 12;
+  ImageType::Pointer img = CreateInput<ImageType>( size, 100, 0 );
+
+  ImageType::SizeType radius;
+  radius.Fill( 2 );
+  RunRank<ImageType>( img, radius, 0.5, true, false );
+  RunMedian<ImageType>( img, radius, true, false );
+}
@@ -0,0 +1,335 @@
+/*=========================================================================
+*
+*  Copyright Insight Software Consortium
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*
+*=========================================================================*/
+
+#include <SimpleITKTestHarness.h>
+#include <itkUnionFindConnectedComponentImageFilter.h>
+#include <itkUnionFindScalarConnectedComponentImageFilter.h>
+#include <itkRelabelComponentImageFilter.h>
+
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <map>
+
+// This test verifies that the union-find path of the
+// UnionFindConnectedComponentImageFilter produces the same labels as
+// the ConnectedComponentImageFilter, and that the union-find path of
+// the UnionFindScalarConnectedComponentImageFilter produces the same
+// components as the ScalarConnectedComponentImageFilter, for any
+// number of threads. The relabeling by size is compared with the
+// RelabelComponentImageFilter.
+
+namespace
+{
+
+template <typename TImageType>
+typename TImageType::Pointer CreateInput( const typename TImageType::SizeType &size, int range, int offset )
+{
+  typename TImageType::Pointer img = TImageType::New();
+  img->SetRegions( typename TImageType::RegionType( size ) );
+  img->Allocate();
+
+  // a deterministic pseudo random image
+  unsigned int state = 12345;
+  itk::ImageRegionIterator<TImageType> it( img, img->GetBufferedRegion() );
+  while( !it.IsAtEnd() )
+    {
+    state = state * 1103515245u + 12345u;
+    it.Set( static_cast<typename TImageType::PixelType>( int( ( state >> 16 ) % range ) + offset ) );
+    ++it;
+    }
+  return img;
+}
+
+template <typename TImageType>
+void CheckImagesEqual( const TImageType *expected, const TImageType *result )
+{
+  typedef itk::ImageRegionConstIterator<TImageType> IteratorType;
+  IteratorType eIt( expected, expected->GetBufferedRegion() );
+  IteratorType rIt( result, result->GetBufferedRegion() );
+
+  unsigned int numberOfDifferences = 0;
+  while( !eIt.IsAtEnd() )
+    {
+    if ( eIt.Get() != rIt.Get() )
+      {
+      ++numberOfDifferences;
+      }
+    ++eIt;
+    ++rIt;
+    }
+  EXPECT_EQ( 0u, numberOfDifferences );
+}
+
+// the two label images have the same components when each label of
+// one matches a single label of the other
+template <typename TImageType>
+void CheckSameComponents( const TImageType *expected, const TImageType *result )
+{
+  typedef typename TImageType::PixelType LabelType;
+  typedef itk::ImageRegionConstIterator<TImageType> IteratorType;
+  IteratorType eIt( expected, expected->GetBufferedRegion() );
+  IteratorType rIt( result, result->GetBufferedRegion() );
+
+  std::map<LabelType, LabelType> expectedToResult;
+  std::map<LabelType, LabelType> resultToExpected;
+  unsigned int numberOfDifferences = 0;
+  while( !eIt.IsAtEnd() )
+    {
+    if ( !expectedToResult.count( eIt.Get() ) && !resultToExpected.count( rIt.Get() ) )
+      {
+      expectedToResult[eIt.Get()] = rIt.Get();
+      resultToExpected[rIt.Get()] = eIt.Get();
+      }
+    if ( !expectedToResult.count( eIt.Get() ) || expectedToResult[eIt.Get()] != rIt.Get() )
+      {
+      ++numberOfDifferences;
+      }
+    ++eIt;
+    ++rIt;
+    }
+  EXPECT_EQ( 0u, numberOfDifferences );
+}
+
+template <typename TImageType, typename TLabelImageType>
+typename TLabelImageType::Pointer RunConnectedComponent( const TImageType *img,
+                                                         bool fullyConnected,
+                                                         bool useUnionFind,
+                                                         unsigned int numberOfThreads,
+                                                         itk::SizeValueType &objectCount )
+{
+  typedef itk::UnionFindConnectedComponentImageFilter<TImageType, TLabelImageType> FilterType;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( img );
+  filter->SetFullyConnected( fullyConnected );
+  filter->SetUseUnionFind( useUnionFind );
+  filter->SetNumberOfThreads( numberOfThreads );
+  filter->Update();
+
+  EXPECT_EQ( useUnionFind, filter->GetUnionFindUsed() );
+  objectCount = filter->GetObjectCount();
+
+  return filter->GetOutput();
+}
+
+template <typename TImageType, typename TLabelImageType>
+void CheckConnectedComponent( const TImageType *img )
+{
+  for ( unsigned int f = 0; f < 2; ++f )
+    {
+    const bool fullyConnected = ( f == 1 );
+    itk::SizeValueType expectedCount = 0;
+    typename TLabelImageType::Pointer expected =
+      RunConnectedComponent<TImageType, TLabelImageType>( img, fullyConnected, false, 1, expectedCount );
+    EXPECT_LT( 1u, expectedCount );
+
+    const unsigned int threads[] = { 1, 3, 8 };
+    for ( unsigned int i = 0; i < sizeof( threads ) / sizeof( threads[0] ); ++i )
+      {
+      itk::SizeValueType count = 0;
+      typename TLabelImageType::Pointer result =
+        RunConnectedComponent<TImageType, TLabelImageType>( img, fullyConnected, true, threads[i], count );
+      EXPECT_EQ( expectedCount, count );
+      CheckImagesEqual<TLabelImageType>( expected, result );
+      }
+    }
+}
+
+template <typename TImageType, typename TLabelImageType>
+typename TLabelImageType::Pointer RunScalarConnectedComponent( const TImageType *img,
+                                                               double distanceThreshold,
+                                                               bool fullyConnected,
+                                                               bool useUnionFind,
+                                                               unsigned int numberOfThreads )
+{
+  typedef itk::UnionFindScalarConnectedComponentImageFilter<TImageType, TLabelImageType> FilterType;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( img );
+  filter->SetDistanceThreshold( distanceThreshold );
+  filter->SetFullyConnected( fullyConnected );
+  filter->SetUseUnionFind( useUnionFind );
+  filter->SetNumberOfThreads( numberOfThreads );
+  filter->Update();
+
+  EXPECT_EQ( useUnionFind, filter->GetUnionFindUsed() );
+
+  return filter->GetOutput();
+}
+
+}
+
+TEST(UnionFindConnectedComponentImageFilterTest, UChar2D)
+{
+  typedef itk::Image<unsigned char, 2> ImageType;
+  typedef itk::Image<unsigned int, 2>  LabelImageType;
+
+  ImageType::SizeType size;
+  size[0] = 97;
+  size[1] = 83;
+  // about half of the pixels are foreground, with values 1 and 2
+  ImageType::Pointer img = CreateInput<ImageType>( size, 5, 0 );
+  itk::ImageRegionIterator<ImageType> it( img, img->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() > 2 )
+      {
+      it.Set( 0 );
+      }
+    }
+
+  CheckConnectedComponent<ImageType, LabelImageType>( img );
+}
+
+TEST(UnionFindConnectedComponentImageFilterTest, Short3D)
+{
+  typedef itk::Image<short, 3>          ImageType;
+  typedef itk::Image<unsigned short, 3> LabelImageType;
+
+  ImageType::SizeType size;
+  size[0] = 31;
+  size[1] = 19;
+  size[2] = 13;
+  ImageType::Pointer img = CreateInput<ImageType>( size, 2, 0 );
+
+  CheckConnectedComponent<ImageType, LabelImageType>( img );
+}
+
+TEST(UnionFindConnectedComponentImageFilterTest, Fallback)
+{
+  // a mask image uses the ConnectedComponentImageFilter
+  typedef itk::Image<unsigned char, 2> ImageType;
+  typedef itk::Image<unsigned int, 2>  LabelImageType;
+
+  ImageType::SizeType size;
+  size[0] = 16;
+  size[1] = 9;
+  ImageType::Pointer img = CreateInput<ImageType>( size, 2, 0 );
+
+  typedef itk::UnionFindConnectedComponentImageFilter<ImageType, LabelImageType> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  EXPECT_TRUE( filter->GetUseUnionFind() );
+  filter->SetInput( img );
+  filter->SetMaskImage( img );
+  filter->Update();
+  EXPECT_FALSE( filter->GetUnionFindUsed() );
+}
+
+TEST(UnionFindConnectedComponentImageFilterTest, Scalar2D)
+{
+  typedef itk::Image<short, 2>        ImageType;
+  typedef itk::Image<unsigned int, 2> LabelImageType;
+
+  ImageType::SizeType size;
+  size[0] = 61;
+  size[1] = 47;
+  ImageType::Pointer img = CreateInput<ImageType>( size, 9, 1 );
+
+  for ( unsigned int f = 0; f < 2; ++f )
+    {
+    const bool fullyConnected = ( f == 1 );
+    LabelImageType::Pointer expected =
+      RunScalarConnectedComponent<ImageType, LabelImageType>( img, 2.0, fullyConnected, false, 1 );
+
+    const unsigned int threads[] = { 1, 4 };
+    for ( unsigned int i = 0; i < sizeof( threads ) / sizeof( threads[0] ); ++i )
+      {
+      LabelImageType::Pointer result =
+        RunScalarConnectedComponent<ImageType, LabelImageType>( img, 2.0, fullyConnected, true, threads[i] );
+      CheckSameComponents<LabelImageType>( expected, result );
+      }
+    }
+}
+
+TEST(UnionFindConnectedComponentImageFilterTest, RelabelBySize)
+{
+  typedef itk::Image<unsigned char, 3> ImageType;
+  typedef itk::Image<unsigned int, 3>  LabelImageType;
+
+  ImageType::SizeType size;
+  size[0] = 37;
+  size[1] = 23;
+  size[2] = 11;
+  ImageType::Pointer img = CreateInput<ImageType>( size, 2, 0 );
+
+  typedef itk::ConnectedComponentImageFilter<ImageType, LabelImageType> ConnectedType;
+  ConnectedType::Pointer connected = ConnectedType::New();
+  connected->SetInput( img );
+
+  const itk::SizeValueType minimumObjectSize = 3;
+  const itk::SizeValueType maximumNumberOfObjects = 5;
+
+  for ( unsigned int s = 0; s < 2; ++s )
+    {
+    const bool sortByObjectSize = ( s == 1 );
+
+    typedef itk::RelabelComponentImageFilter<LabelImageType, LabelImageType> RelabelType;
+    RelabelType::Pointer relabel = RelabelType::New();
+    relabel->SetInput( connected->GetOutput() );
+    relabel->SetMinimumObjectSize( minimumObjectSize );
+    relabel->SetSortByObjectSize( sortByObjectSize );
+    relabel->Update();
+    LabelImageType::Pointer expected = relabel->GetOutput();
+
+    typedef itk::UnionFindConnectedComponentImageFilter<ImageType, LabelImageType> FilterType;
+    for ( unsigned int u = 0; u < 2; ++u )
+      {
+      FilterType::Pointer filter = FilterType::New();
+      filter->SetInput( img );
+      filter->SetUseUnionFind( u == 1 );
+      filter->SetNumberOfThreads( 4 );
+      filter->SetSortByObjectSize( sortByObjectSize );
+      filter->SetMinimumObjectSize( minimumObjectSize );
+      filter->Update();
+
+      EXPECT_EQ( relabel->GetNumberOfObjects(), filter->GetObjectCount() );
+      ASSERT_EQ( relabel->GetSizeOfObjectsInPixels().size(), filter->GetSizeOfObjectsInPixels().size() );
+      for ( unsigned int i = 0; i < filter->GetSizeOfObjectsInPixels().size(); ++i )
+        {
+        EXPECT_EQ( relabel->GetSizeOfObjectsInPixels()[i], filter->GetSizeOfObjectsInPixels()[i] );
+        }
+      CheckImagesEqual<LabelImageType>( expected, filter->GetOutput() );
+      }
+    }
+
+  // only the largest objects are kept, which are the first labels
+  // sorted by size
+  typedef itk::RelabelComponentImageFilter<LabelImageType, LabelImageType> RelabelType;
+  RelabelType::Pointer relabel = RelabelType::New();
+  relabel->SetInput( connected->GetOutput() );
+  relabel->Update();
+  LabelImageType::Pointer expected = relabel->GetOutput();
+  expected->DisconnectPipeline();
+  itk::ImageRegionIterator<LabelImageType> it( expected, expected->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() > maximumNumberOfObjects )
+      {
+      it.Set( 0 );
+      }
+    }
+
+  typedef itk::UnionFindConnectedComponentImageFilter<ImageType, LabelImageType> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( img );
+  filter->SetSortByObjectSize( true );
+  filter->SetMaximumNumberOfObjects( maximumNumberOfObjects );
+  filter->Update();
+  EXPECT_TRUE( filter->GetUnionFindUsed() );
+  EXPECT_EQ( maximumNumberOfObjects, filter->GetObjectCount() );
+  CheckImagesEqual<LabelImageType>( expected, filter->GetOutput() );
+}
@@ -41,6 +41,9 @@
 #include <sitkCurvatureAnisotropicDiffusionImageFilter.h>
 #include <sitkLabelMapContourOverlayImageFilter.h>
 #include <sitkPatchBasedDenoisingImageFilter.h>
+#include <sitkDeconvolutionContext.h>
+#include <sitkNormalizedCorrelationMatcher.h>
+#include <sitkScalarImageKmeansImageFilter.h>
 #include <sitkConnectedThresholdImageFilter.h>
 #include <sitkMergeLabelMapFilter.h>
 #include <sitkDiffeomorphicDemonsRegistrationFilter.h>
@@ -50,8 +53,71 @@
 #include <sitkCenteredTransformInitializerFilter.h>
 #include <sitkCenteredVersorTransformInitializerFilter.h>
 #include <sitkLandmarkBasedTransformInitializerFilter.h>
+#include <sitkFlattenTransformFilter.h>
+#include <sitkMultiResolutionDemonsRegistrationFilter.h>
 #include <sitkAdditionalProcedures.h>
+#include <sitkPixelwisePipeline.h>
+#include <sitkRandomAugmentationFilter.h>
+#include <sitkGaussianScaleSpaceFilter.h>
+#include <sitkThresholdSegmentationLevelSetImageFilter.h>
+#include <sitkFastMarchingImageFilter.h>
+#include <sitkLabelMapToLabelImageFilter.h>
+#include <sitkN4BiasFieldCorrectionImageFilter.h>
+#include <sitkBilateralImageFilter.h>
+#include <sitkSmoothingRecursiveGaussianImageFilter.h>
+#include <sitkShiftScaleImageFilter.h>
+#include <sitkClampImageFilter.h>
+#include <sitkBinaryThresholdImageFilter.h>
+#include <sitkMaskImageFilter.h>
+#include <sitkInvertDisplacementFieldImageFilter.h>
+#include <sitkBSplineDecompositionImageFilter.h>
+#include <sitkResampleImageFilter.h>
+#include <sitkEuler3DTransform.h>
+#include <sitkImageAccumulator.h>
+#include <sitkNaryAddImageFilter.h>
+#include <sitkNaryMaximumImageFilter.h>
+#include <sitkLabelVotingImageFilter.h>
+#include <sitkTileImageBuilder.h>
+#include <sitkTileImageFilter.h>
+#include <sitkAdditiveGaussianNoiseImageFilter.h>
+#include <sitkSaltAndPepperNoiseImageFilter.h>
+#include <sitkShotNoiseImageFilter.h>
+#include <sitkSpeckleNoiseImageFilter.h>
+#include <sitkPasteImageFilter.h>
+#include <sitkProjectionAccumulator.h>
+#include <sitkStatisticsAccumulator.h>
+#include <sitkPackedBinaryImage.h>
+#include <sitkAndImageFilter.h>
+#include <sitkOrImageFilter.h>
+#include <sitkXorImageFilter.h>
+#include <sitkBinaryNotImageFilter.h>
+#include <sitkMaximumProjectionImageFilter.h>
+#include <sitkMinimumProjectionImageFilter.h>
+#include <sitkSumProjectionImageFilter.h>
+#include <sitkMeanProjectionImageFilter.h>
+#include <sitkStandardDeviationProjectionImageFilter.h>
+#include <sitkExecutionCache.h>
+#include <sitkMeanImageFilter.h>
+#include <sitkAddImageFilter.h>
+#include <sitkComposeImageFilter.h>
+#include <sitkRegionOfInterestImageFilter.h>
+#include <sitkPipeline.h>
 #include <sitkCommand.h>
+#include <sitkFFTConfiguration.h>
+#include <sitkConvolve.h>
+#include <sitkBinaryDilateImageFilter.h>
+#include <sitkBinaryErodeImageFilter.h>
+#include <sitkGrayscaleDilateImageFilter.h>
+#include <sitkGrayscaleErodeImageFilter.h>
+#include <sitkGrayscaleMorphologicalOpeningImageFilter.h>
+#include <sitkFFTConvolutionImageFilter.h>
+#include <sitkForwardFFTImageFilter.h>
+#include <sitkInverseFFTImageFilter.h>
+#include <sitkConnectedComponentImageFilter.h>
+#include <sitkScalarConnectedComponentImageFilter.h>
+#include <sitkRelabelComponentImageFilter.h>
+#include <sitkHistogramImageFilter.h>
+#include <sitkLiThresholdImageFilter.h>
 
 #include "itkVectorImage.h"
 #include "itkVector.h"
@@ -77,11 +143,16 @@
 #include "sitkVersorRigid3DTransform.h"
 #include "sitkSimilarity3DTransform.h"
 #include "sitkAffineTransform.h"
+#include "sitkBSplineTransform.h"
+#include "sitkTranslationTransform.h"
 #include "sitkEuler2DTransform.h"
 #include "sitkSimilarity2DTransform.h"
 #include "sitkVersorTransform.h"
 #include "sitkScaleVersor3DTransform.h"
 
+#include <algorithm>
+#include <cmath>
+
 TEST(BasicFilter,FastSymmetricForcesDemonsRegistrationFilter_ENUMCHECK) {
   typedef itk::Image<float,3> ImageType;
   typedef itk::Image<itk::Vector<float,3>,3> DisplacementType;
@@ -359,6 +430,228 @@ TEST(BasicFilters,ProcessObject_NumberOfThreads) {
   EXPECT_EQ(gNum+1, caster2.GetGlobalDefaultNumberOfThreads());
 }
 
+TEST(BasicFilters,ProcessObject_NumberOfStreamDivisions) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::GaussianSource( sitk::sitkFloat32, std::vector<unsigned int>( 3, 32 ) );
+
+  sitk::MeanImageFilter mean;
+  EXPECT_EQ( 1u, mean.GetNumberOfStreamDivisions() );
+  const std::string expected = sitk::Hash( mean.Execute( image ) );
+
+  mean.SetNumberOfStreamDivisions( 5 );
+  EXPECT_EQ( 5u, mean.GetNumberOfStreamDivisions() );
+  EXPECT_TRUE ( mean.ToString().find("NumberOfStreamDivisions: 5") != std::string::npos );
+
+  sitk::Image output = mean.Execute( image );
+  EXPECT_EQ( expected, sitk::Hash( output ) );
+  EXPECT_EQ( image.GetSize(), output.GetSize() );
+
+  // streamed in place execution does not modify the input
+  sitk::AddImageFilter add;
+  add.SetNumberOfStreamDivisions( 3 );
+  sitk::Image copy = image;
+  output = add.Execute( image, 1.0 );
+  EXPECT_EQ( sitk::Hash( copy ), sitk::Hash( image ) );
+  EXPECT_EQ( sitk::Hash( sitk::Add( image, 1.0 ) ), sitk::Hash( output ) );
+
+  mean.SetNumberOfStreamDivisions( 0 );
+  EXPECT_EQ( 1u, mean.GetNumberOfStreamDivisions() );
+}
+
+TEST(BasicFilters,ProcessObject_PersistentITKFilter) {
+  namespace sitk = itk::simple;
+
+  const std::vector<unsigned int> size( 2, 64 );
+  sitk::Image image1 = sitk::GaussianSource( sitk::sitkFloat32, size );
+  sitk::Image image2 = sitk::GaussianSource( sitk::sitkFloat32, size, std::vector<double>( 2, 8.0 ) );
+
+  sitk::DiscreteGaussianImageFilter gaussian;
+  EXPECT_FALSE( gaussian.GetPersistentITKFilter() );
+  const std::string expected1 = sitk::Hash( gaussian.Execute( image1 ) );
+  const std::string expected2 = sitk::Hash( gaussian.Execute( image2 ) );
+
+  gaussian.PersistentITKFilterOn();
+  EXPECT_TRUE( gaussian.GetPersistentITKFilter() );
+  EXPECT_TRUE ( gaussian.ToString().find("PersistentITKFilter: 1") != std::string::npos );
+
+  CountCommand startCmd( gaussian );
+  gaussian.AddCommand( sitk::sitkStartEvent, startCmd );
+
+  sitk::Image output1 = gaussian.Execute( image1 );
+  EXPECT_EQ( expected1, sitk::Hash( output1 ) );
+
+  // the image returned by the previous execution is not modified
+  sitk::Image output2 = gaussian.Execute( image2 );
+  EXPECT_EQ( expected2, sitk::Hash( output2 ) );
+  EXPECT_EQ( expected1, sitk::Hash( output1 ) );
+  EXPECT_EQ( 2, startCmd.m_Count );
+
+  // the output buffer is reused when the returned image is deleted
+  output1 = output2 = sitk::Image();
+  EXPECT_EQ( expected1, sitk::Hash( gaussian.Execute( image1 ) ) );
+  EXPECT_EQ( 3, startCmd.m_Count );
+
+  // changed parameters
+  gaussian.SetVariance( 4.0 );
+  sitk::DiscreteGaussianImageFilter reference;
+  reference.SetVariance( 4.0 );
+  EXPECT_EQ( sitk::Hash( reference.Execute( image2 ) ), sitk::Hash( gaussian.Execute( image2 ) ) );
+
+  // an other pixel type uses a new ITK filter
+  sitk::Image image3 = sitk::Cast( image2, sitk::sitkUInt8 );
+  EXPECT_EQ( sitk::Hash( reference.Execute( image3 ) ), sitk::Hash( gaussian.Execute( image3 ) ) );
+  EXPECT_EQ( 5, startCmd.m_Count );
+
+  // a thread budget set after the first execution is released
+  sitk::Image image4 = sitk::Cast( image1, sitk::sitkUInt8 );
+  sitk::ProcessObject::SetGlobalThreadBudget( 2 );
+  gaussian.Execute( image4 );
+  EXPECT_EQ( 0u, sitk::ProcessObject::GetGlobalNumberOfReservedThreads() );
+  gaussian.Execute( image3 );
+  EXPECT_EQ( 0u, sitk::ProcessObject::GetGlobalNumberOfReservedThreads() );
+  sitk::ProcessObject::SetGlobalThreadBudget( 0 );
+  EXPECT_EQ( 7, startCmd.m_Count );
+
+  // the observer of a replaced cancellation token is removed
+  sitk::CancellationToken token1;
+  sitk::CancellationToken token2;
+  gaussian.SetCancellationToken( token1 );
+  gaussian.Execute( image4 );
+  gaussian.SetCancellationToken( token2 );
+  gaussian.Execute( image3 );
+  token1.Cancel();
+  EXPECT_NO_THROW( gaussian.Execute( image4 ) );
+  gaussian.RemoveCancellationToken();
+  EXPECT_EQ( 10, startCmd.m_Count );
+
+  gaussian.PersistentITKFilterOff();
+  EXPECT_FALSE( gaussian.GetPersistentITKFilter() );
+  EXPECT_EQ( sitk::Hash( reference.Execute( image3 ) ), sitk::Hash( gaussian.Execute( image3 ) ) );
+  EXPECT_EQ( 11, startCmd.m_Count );
+}
+
+TEST(BasicFilters,ExecuteInto) {
+  namespace sitk = itk::simple;
+
+  const std::vector<unsigned int> size( 3, 16 );
+  sitk::Image image1 = sitk::GaussianSource( sitk::sitkFloat32, size );
+  sitk::Image image2 = sitk::GaussianSource( sitk::sitkFloat32, size, std::vector<double>( 3, 4.0 ) );
+
+  sitk::AddImageFilter add;
+  const std::string expected = sitk::Hash( add.Execute( image1, image2 ) );
+
+  // the output is computed into the buffer of the destination
+  sitk::Image output( size, sitk::sitkFloat32 );
+  const void *buffer = output.GetBufferAsVoid();
+  add.ExecuteInto( image1, image2, output );
+  EXPECT_EQ( expected, sitk::Hash( output ) );
+  EXPECT_EQ( buffer, output.GetBufferAsVoid() );
+
+  // a shared destination is not modified
+  sitk::Image copy = output;
+  add.ExecuteInto( image2, image2, output );
+  EXPECT_EQ( expected, sitk::Hash( copy ) );
+  EXPECT_EQ( sitk::Hash( sitk::Add( image2, image2 ) ), sitk::Hash( output ) );
+
+  // an input as destination
+  sitk::Image input = sitk::Image( image1 ) + 0.0f;
+  add.ExecuteInto( input, image2, input );
+  EXPECT_EQ( expected, sitk::Hash( input ) );
+
+  // a destination with another size or pixel type is replaced
+  sitk::Image other( std::vector<unsigned int>( 3, 8 ), sitk::sitkUInt8 );
+  add.ExecuteInto( image1, image2, other );
+  EXPECT_EQ( expected, sitk::Hash( other ) );
+  EXPECT_EQ( image1.GetSize(), other.GetSize() );
+
+  sitk::MeanImageFilter mean;
+  sitk::Image meanOutput( size, sitk::sitkFloat32 );
+  buffer = meanOutput.GetBufferAsVoid();
+  mean.ExecuteInto( image1, meanOutput );
+  EXPECT_EQ( sitk::Hash( mean.Execute( image1 ) ), sitk::Hash( meanOutput ) );
+  EXPECT_EQ( buffer, meanOutput.GetBufferAsVoid() );
+}
+
+TEST(BasicFilters,Pipeline) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::GaussianSource( sitk::sitkFloat32, std::vector<unsigned int>( 3, 32 ) );
+
+  std::vector<unsigned int> size( 3, 8 );
+  std::vector<int> index( 3, 4 );
+
+  sitk::MeanImageFilter mean;
+  sitk::AddImageFilter add;
+  sitk::RegionOfInterestImageFilter roi;
+  roi.SetSize( size );
+  roi.SetIndex( index );
+
+  const std::string expected = sitk::Hash( roi.Execute( add.Execute( mean.Execute( image ), image ) ) );
+
+  sitk::Pipeline pipeline;
+  pipeline.AddFilter( mean );
+  pipeline.AddFilter( add );
+  pipeline.AddFilter( roi );
+  EXPECT_EQ( 3u, pipeline.GetNumberOfFilters() );
+  EXPECT_EQ( 0u, pipeline.GetNumberOfProcesses() );
+
+  sitk::Image placeholder = roi.Execute( add.Execute( mean.Execute( image ), image ) );
+  EXPECT_EQ( 3u, pipeline.GetNumberOfProcesses() );
+  EXPECT_EQ( size, placeholder.GetSize() );
+  EXPECT_EQ( sitk::sitkFloat32, placeholder.GetPixelID() );
+
+  sitk::Image result = pipeline.Update( placeholder );
+  EXPECT_EQ( expected, sitk::Hash( result ) );
+  EXPECT_EQ( size, result.GetSize() );
+
+  // a computed image is returned unchanged
+  EXPECT_EQ( expected, sitk::Hash( pipeline.Update( result ) ) );
+
+  std::string out = pipeline.ToString();
+  EXPECT_TRUE ( out.find("itk::simple::Pipeline") != std::string::npos );
+  EXPECT_TRUE ( out.find("Mean") != std::string::npos );
+
+  pipeline.ReleaseProcesses();
+  EXPECT_EQ( 0u, pipeline.GetNumberOfProcesses() );
+  EXPECT_EQ( expected, sitk::Hash( result ) );
+
+  // filters removed from the pipeline execute immediately
+  pipeline.RemoveFilter( mean );
+  EXPECT_EQ( 2u, pipeline.GetNumberOfFilters() );
+  EXPECT_EQ( sitk::Hash( mean.Execute( image ) ), sitk::Hash( sitk::Mean( image ) ) );
+  EXPECT_EQ( 0u, pipeline.GetNumberOfProcesses() );
+
+  // destroying a filter removes it from the pipeline
+    {
+    sitk::MeanImageFilter mean2;
+    pipeline.AddFilter( mean2 );
+    EXPECT_EQ( 3u, pipeline.GetNumberOfFilters() );
+    placeholder = mean2.Execute( image );
+    }
+  EXPECT_EQ( 2u, pipeline.GetNumberOfFilters() );
+  EXPECT_EQ( sitk::Hash( sitk::Mean( image ) ), sitk::Hash( pipeline.Update( placeholder ) ) );
+
+  // the sources are deferred, and a streamed update computes them
+  // one piece at a time
+  sitk::GaussianImageSource source;
+  source.SetOutputPixelType( sitk::sitkFloat32 );
+  source.SetSize( std::vector<unsigned int>( 3, 32 ) );
+  const std::string sourceExpected = sitk::Hash( mean.Execute( source.Execute() ) );
+  pipeline.AddFilter( source );
+  pipeline.AddFilter( mean );
+  pipeline.SetNumberOfStreamDivisions( 4 );
+  EXPECT_EQ( 4u, pipeline.GetNumberOfStreamDivisions() );
+  placeholder = mean.Execute( source.Execute() );
+  sitk::Image streamed = pipeline.Update( placeholder );
+  EXPECT_EQ( sourceExpected, sitk::Hash( streamed ) );
+  EXPECT_EQ( placeholder.GetSize(), streamed.GetSize() );
+  EXPECT_EQ( placeholder.GetOrigin(), streamed.GetOrigin() );
+
+  pipeline.RemoveAllFilters();
+  EXPECT_EQ( 0u, pipeline.GetNumberOfFilters() );
+}
+
 TEST(BasicFilters,Cast) {
   itk::simple::HashImageFilter hasher;
   itk::simple::ImageFileReader reader;
@@ -463,6 +756,59 @@ TEST(BasicFilters,HashImageFilter) {
 }
 
 
+TEST(BasicFilters,PixelwisePipeline) {
+  namespace sitk = itk::simple;
+
+  sitk::Image input( 100, 100, sitk::sitkInt16 );
+  sitk::Image mask( 100, 100, sitk::sitkUInt8 );
+  int16_t *inputBuffer = input.GetBufferAsInt16();
+  uint8_t *maskBuffer = mask.GetBufferAsUInt8();
+  for ( unsigned int i = 0; i < 100*100; ++i )
+    {
+    inputBuffer[i] = static_cast<int16_t>( i % 1000 ) - 200;
+    maskBuffer[i] = ( i % 7 != 0 );
+    }
+  input.SetOrigin( std::vector<double>( 2, 3.0 ) );
+
+  sitk::PixelwisePipeline pipeline;
+  EXPECT_EQ ( pipeline.GetName(), "PixelwisePipeline" );
+  EXPECT_EQ ( pipeline.GetNumberOfSteps(), 0u );
+
+  // an empty pipeline copies the input
+  sitk::Image output = pipeline.Execute( input );
+  EXPECT_EQ ( sitk::Hash( output ), sitk::Hash( input ) );
+  EXPECT_EQ ( output.GetOrigin(), input.GetOrigin() );
+
+  pipeline.AddCast( sitk::sitkFloat32 ).AddShiftScale( -100.0, 0.5 ).AddClamp( 0.0, 255.0 );
+  output = pipeline.Execute( input );
+  sitk::Image expected = sitk::Clamp( sitk::ShiftScale( sitk::Cast( input, sitk::sitkFloat32 ), -100.0, 0.5 ), sitk::sitkFloat32, 0.0, 255.0 );
+  EXPECT_EQ ( output.GetPixelID(), sitk::sitkFloat32 );
+  EXPECT_EQ ( sitk::Hash( output ), sitk::Hash( expected ) );
+
+  pipeline.AddBinaryThreshold( 10.0, 200.0, 255u, 0u ).AddMask( mask, 7.0 );
+  EXPECT_EQ ( pipeline.GetNumberOfSteps(), 5u );
+  output = pipeline.Execute( input );
+  expected = sitk::Mask( sitk::BinaryThreshold( expected, 10.0, 200.0, 255u, 0u ), mask, 7.0 );
+  EXPECT_EQ ( output.GetPixelID(), sitk::sitkUInt8 );
+  EXPECT_EQ ( sitk::Hash( output ), sitk::Hash( expected ) );
+  EXPECT_EQ ( output.GetOrigin(), input.GetOrigin() );
+
+  // intermediate values are converted to the pixel type of each step
+  pipeline.Clear();
+  output = pipeline.AddShiftScale( 0.0, 0.3 ).AddShiftScale( 0.0, 10.0 ).Execute( input );
+  EXPECT_EQ ( output.GetPixelID(), sitk::sitkInt16 );
+  EXPECT_EQ ( sitk::Hash( output ), sitk::Hash( sitk::ShiftScale( sitk::ShiftScale( input, 0.0, 0.3 ), 0.0, 10.0 ) ) );
+
+  std::string out = pipeline.ToString();
+  EXPECT_TRUE ( out.find("itk::simple::PixelwisePipeline") != std::string::npos );
+  EXPECT_TRUE ( out.find("ShiftScale( 0, 10 )") != std::string::npos );
+  EXPECT_TRUE ( out.find("NumberOfThreads:") != std::string::npos );
+
+  EXPECT_THROW ( pipeline.AddClamp( 1.0, 0.0 ), sitk::GenericException );
+  EXPECT_THROW ( pipeline.AddMask( sitk::Image( 10, 10, sitk::sitkUInt8 ) ).Execute( input ), sitk::GenericException );
+  EXPECT_THROW ( pipeline.Clear().Execute( sitk::Image( 10, 10, sitk::sitkVectorFloat32 ) ), sitk::GenericException );
+}
+
 TEST(BasicFilters,BSplineTransformInitializer) {
   namespace sitk = itk::simple;
 
@@ -574,6 +920,16 @@ TEST(BasicFilters,CenteredTransformInitializer) {
   EXPECT_FLOAT_EQ ( 111.20356, params[0] );
   EXPECT_FLOAT_EQ ( 131.59097, params[1] );
 
+  // the moments of every other pixel
+  EXPECT_EQ ( 1u, filter.GetShrinkFactor() );
+  filter.SetShrinkFactor( 2 );
+  EXPECT_EQ ( 2u, filter.GetShrinkFactor() );
+  outTx = filter.Execute( fixed, moving, tx );
+  params = outTx.GetFixedParameters();
+  ASSERT_EQ( 2u, params.size() );
+  EXPECT_NEAR ( 111.20356, params[0], 1.0 );
+  EXPECT_NEAR ( 131.59097, params[1], 1.0 );
+
 }
 
 
@@ -652,6 +1008,24 @@ TEST(BasicFilters,CenteredVersorTransformInitializer) {
   EXPECT_VECTOR_DOUBLE_NEAR( tx.GetVersor(), v4(-0.5, -0.5,0.5,0.5), 1e-5 );
   }
 
+  {
+  // the moments of every fourth pixel
+  sitk::VersorRigid3DTransform tx;
+  filter.SetShrinkFactor( 4 );
+  EXPECT_EQ ( 4u, filter.GetShrinkFactor() );
+
+  filter.ComputeRotationOff();
+  tx = sitk::VersorRigid3DTransform( filter.Execute(g1, g2, sitk::VersorRigid3DTransform() ) );
+  EXPECT_VECTOR_DOUBLE_NEAR( tx.GetTranslation(), v3(-1.0,-2.0,-3.0), 0.1 );
+  EXPECT_VECTOR_DOUBLE_NEAR( tx.GetCenter(), v3(64.0,64.0,64.0), 2.0 );
+
+  filter.ComputeRotationOn();
+  tx = sitk::VersorRigid3DTransform( filter.Execute(g1, g3, sitk::VersorRigid3DTransform() ) );
+  EXPECT_VECTOR_DOUBLE_NEAR( tx.GetTranslation(), v3(-1.0,-2.0,-3.0), 0.1 );
+  EXPECT_VECTOR_DOUBLE_NEAR( tx.GetVersor(), v4(-0.5, -0.5,0.5,0.5), 1e-2 );
+  filter.SetShrinkFactor( 1 );
+  }
+
   EXPECT_THROW( sitk::CenteredVersorTransformInitializer(g1, g2, sitk::Transform(2,sitk::sitkSimilarity)), sitk::GenericException );
   EXPECT_THROW( sitk::CenteredVersorTransformInitializer(g1, g2, sitk::Transform(3,sitk::sitkVersor)), sitk::GenericException );
   EXPECT_THROW( sitk::CenteredVersorTransformInitializer(g1, g2, sitk::Transform(3,sitk::sitkAffine)), sitk::GenericException );
@@ -777,138 +1151,2315 @@ TEST(BasicFilters,LandmarkBasedTransformInitializer) {
 }
 
 
-TEST(BasicFilters,Cast_Commands) {
-  // test cast filter with a bunch of commands
-
+TEST(BasicFilters,FlattenTransform) {
   namespace sitk = itk::simple;
-  sitk::Image img = sitk::ReadImage( dataFinder.GetFile ( "Input/RA-Short.nrrd" ) );
-  EXPECT_EQ ( "a963bd6a755b853103a2d195e01a50d3", sitk::Hash(img, sitk::HashImageFilter::MD5));
 
-  sitk::CastImageFilter caster;
-  caster.SetOutputPixelType( sitk::sitkInt32 );
+  sitk::FlattenTransformFilter filter;
+
+  EXPECT_EQ ( "FlattenTransformFilter", filter.GetName() );
+  EXPECT_EQ ( std::vector<unsigned int>(3, 64), filter.GetSize() );
+
+  std::vector<double> matrix(4, 0.0);
+  matrix[0] = 1.1;
+  matrix[1] = 0.2;
+  matrix[2] = -0.1;
+  matrix[3] = 0.9;
+  std::vector<double> translation(2, 0.0);
+  translation[0] = 2.0;
+  translation[1] = -3.5;
+  sitk::AffineTransform affine( matrix, translation, std::vector<double>(2, 10.0) );
+
+  std::vector<double> offset(2, 1.5);
+  sitk::TranslationTransform translationTx( 2, offset );
+
+  sitk::Transform composite( affine );
+  composite.AddTransform( translationTx );
+  composite.AddTransform( affine );
+
+  std::vector<double> point(2, 0.0);
+  point[0] = 12.3;
+  point[1] = 45.6;
+
+  // the linear components are composed into one affine transform
+  sitk::Image reference( 32, 32, sitk::sitkFloat32 );
+  filter.SetReferenceImage( reference );
+  EXPECT_EQ ( reference.GetSize(), filter.GetSize() );
+  sitk::Transform flattened = filter.Execute( composite );
+  EXPECT_TRUE ( flattened.IsLinear() );
+  EXPECT_NEAR ( 0.0, filter.GetMaximumError(), 1e-10 );
+  EXPECT_NEAR ( 0.0, filter.GetMeanError(), 1e-10 );
+  EXPECT_VECTOR_DOUBLE_NEAR ( composite.TransformPoint( point ), flattened.TransformPoint( point ), 1e-10 );
+
+  // a BSpline component is sampled into a displacement field
+  sitk::BSplineTransform bspline( 2 );
+  bspline.SetTransformDomainPhysicalDimensions( std::vector<double>(2, 31.0) );
+  bspline.SetTransformDomainMeshSize( std::vector<unsigned int>(2, 2) );
+  std::vector<double> parameters( bspline.GetParameters().size(), 0.0 );
+  for ( unsigned int i = 0; i < parameters.size(); ++i )
+    {
+    parameters[i] = 0.1 * ( i % 5 );
+    }
+  bspline.SetParameters( parameters );
+  composite.AddTransform( bspline );
 
-  ProgressUpdate progressCmd(caster);
-  caster.AddCommand(sitk::sitkProgressEvent, progressCmd);
+  flattened = filter.Execute( composite );
+  EXPECT_FALSE ( flattened.IsLinear() );
+  EXPECT_LE ( filter.GetMeanError(), filter.GetMaximumError() );
+  EXPECT_LT ( filter.GetMaximumError(), 0.1 );
 
-  CountCommand abortCmd(caster);
-  caster.AddCommand(sitk::sitkAbortEvent, abortCmd);
+  // the grid points are exact
+  point[0] = 12.0;
+  point[1] = 20.0;
+  EXPECT_VECTOR_DOUBLE_NEAR ( composite.TransformPoint( point ), flattened.TransformPoint( point ), 1e-8 );
 
-  CountCommand deleteCmd(caster);
-  caster.AddCommand(sitk::sitkDeleteEvent, deleteCmd);
+  flattened = sitk::FlattenTransform( composite, reference );
+  EXPECT_VECTOR_DOUBLE_NEAR ( composite.TransformPoint( point ), flattened.TransformPoint( point ), 1e-8 );
 
-  CountCommand endCmd(caster);
-  caster.AddCommand(sitk::sitkEndEvent, endCmd);
+  // the grid must have the dimension of the transform
+  filter.SetSize( std::vector<unsigned int>(1, 32) );
+  EXPECT_THROW ( filter.Execute( composite ), sitk::GenericException );
+}
 
-  CountCommand iterCmd(caster);
-  caster.AddCommand(sitk::sitkIterationEvent, iterCmd);
+namespace
+{
+// the largest absolute difference between the pixels of two images
+double MaximumAbsoluteDifference( const itk::simple::Image &image1, const itk::simple::Image &image2 )
+{
+  namespace sitk = itk::simple;
+  const sitk::Image float1 = sitk::Cast( image1, sitk::sitkFloat32 );
+  const sitk::Image float2 = sitk::Cast( image2, sitk::sitkFloat32 );
+  const float *buffer1 = float1.GetBufferAsFloat();
+  const float *buffer2 = float2.GetBufferAsFloat();
+  double maximum = 0.0;
+  for ( uint64_t i = 0; i < float1.GetNumberOfPixels(); ++i )
+    {
+    maximum = std::max( maximum, std::abs( double( buffer1[i] ) - double( buffer2[i] ) ) );
+    }
+  return maximum;
+}
+}
 
-  CountCommand startCmd(caster);
-  caster.AddCommand(sitk::sitkStartEvent, startCmd);
+TEST(BasicFilters,ResampleImages) {
+  namespace sitk = itk::simple;
 
-  CountCommand userCmd(caster);
-  caster.AddCommand(sitk::sitkUserEvent, userCmd);
+  std::vector<unsigned int> size( 2, 40 );
+  std::vector<double> sigma( 2, 8.0 );
+  std::vector<double> mean( 2, 18.0 );
+  sitk::Image intensity = sitk::GaussianSource( sitk::sitkFloat32, size, sigma, mean, 100.0 );
+  sitk::Image label = sitk::BinaryThreshold( intensity, 50.0, 200.0, 3, 0 );
+  sitk::Image wide = sitk::Cast( intensity, sitk::sitkInt16 );
+
+  sitk::Image reference( 30, 35, sitk::sitkFloat32 );
+  reference.SetSpacing( std::vector<double>( 2, 1.2 ) );
+
+  sitk::BSplineTransform bspline( 2 );
+  bspline.SetTransformDomainPhysicalDimensions( std::vector<double>( 2, 39.0 ) );
+  bspline.SetTransformDomainMeshSize( std::vector<unsigned int>( 2, 3 ) );
+  std::vector<double> parameters( bspline.GetParameters().size(), 0.0 );
+  for ( unsigned int i = 0; i < parameters.size(); ++i )
+    {
+    parameters[i] = 0.7 * ( i % 3 ) - 0.5;
+    }
+  bspline.SetParameters( parameters );
+
+  std::vector<sitk::Image> images;
+  images.push_back( intensity );
+  images.push_back( label );
+  images.push_back( wide );
+  std::vector<sitk::InterpolatorEnum> interpolators;
+  interpolators.push_back( sitk::sitkLinear );
+  interpolators.push_back( sitk::sitkNearestNeighbor );
+  interpolators.push_back( sitk::sitkBSpline );
+
+  // the same as resampling each image, with a shared mapping for the
+  // first two and direct resampling of the third
+  std::vector<sitk::Image> results = sitk::ResampleImages( images, reference, bspline, interpolators, 5.0 );
+  ASSERT_EQ( 3u, results.size() );
+  for ( unsigned int i = 0; i < images.size(); ++i )
+    {
+    sitk::Image expected = sitk::Resample( images[i], reference, bspline, interpolators[i], 5.0 );
+    EXPECT_EQ( expected.GetPixelID(), results[i].GetPixelID() );
+    EXPECT_EQ( reference.GetSize(), results[i].GetSize() );
+    EXPECT_EQ( reference.GetSpacing(), results[i].GetSpacing() );
+    EXPECT_NEAR( 0.0, MaximumAbsoluteDifference( expected, results[i] ), 1e-4 ) << "image " << i;
+    }
 
+  // one interpolator for all images, and a linear transform
+  sitk::TranslationTransform translation( 2, std::vector<double>( 2, 1.5 ) );
+  results = sitk::ResampleImages( images, reference, translation, sitk::sitkNearestNeighbor );
+  ASSERT_EQ( 3u, results.size() );
+  for ( unsigned int i = 0; i < images.size(); ++i )
+    {
+    sitk::Image expected = sitk::Resample( images[i], reference, translation, sitk::sitkNearestNeighbor );
+    EXPECT_EQ( sitk::Hash( expected ), sitk::Hash( results[i] ) ) << "image " << i;
+    }
 
-  sitk::Image out = caster.Execute(img);
-  EXPECT_EQ ( "6ceea0011178a955b5be2d545d107199", sitk::Hash(out, sitk::HashImageFilter::MD5));
+  interpolators.pop_back();
+  EXPECT_THROW( sitk::ResampleImages( images, reference, bspline, interpolators ), sitk::GenericException );
+}
 
-  EXPECT_EQ ( 1.0f, caster.GetProgress() );
-  EXPECT_EQ ( 1.0f, progressCmd.m_Progress );
-  EXPECT_EQ ( 0, abortCmd.m_Count );
-  EXPECT_EQ ( 1, deleteCmd.m_Count );
-  EXPECT_EQ ( 1, endCmd.m_Count );
-  EXPECT_EQ ( 0, iterCmd.m_Count );
-  EXPECT_EQ ( 1, startCmd.m_Count );
-  EXPECT_EQ ( 0, userCmd.m_Count );
+TEST(BasicFilters,BSplineResampler) {
+  namespace sitk = itk::simple;
+
+  std::vector<unsigned int> size( 2, 40 );
+  std::vector<double> sigma( 2, 6.0 );
+  std::vector<double> mean( 2, 20.0 );
+  sitk::Image image = sitk::GaussianSource( sitk::sitkFloat32, size, sigma, mean, 100.0 );
+  image.SetOrigin( std::vector<double>( 2, -3.0 ) );
 
+  // the coefficients are computed once, and reused for each transform
+  sitk::BSplineDecompositionImageFilter decomposition;
+  EXPECT_EQ( 3u, decomposition.GetSplineOrder() );
+  sitk::Image coefficients = decomposition.Execute( image );
+  EXPECT_EQ( sitk::sitkFloat32, coefficients.GetPixelID() );
+  EXPECT_EQ( image.GetOrigin(), coefficients.GetOrigin() );
+
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    sitk::Euler2DTransform euler( std::vector<double>( 2, 17.0 ), 0.2 * i, std::vector<double>( 2, 0.5 * i ) );
+    sitk::Image expected = sitk::Resample( image, euler, sitk::sitkBSpline, 0.0 );
+    sitk::Image result = sitk::Resample( coefficients, image, euler, sitk::sitkBSplineResampler, 0.0 );
+    EXPECT_NEAR( 0.0, MaximumAbsoluteDifference( expected, result ), 1e-3 ) << "transform " << i;
+    }
+
+  sitk::Image integer = sitk::Cast( image, sitk::sitkInt16 );
+  EXPECT_EQ( sitk::sitkFloat64, decomposition.Execute( integer ).GetPixelID() );
 }
 
-TEST(BasicFilters,Statistics_Abort) {
-  // test Statistics filter with a bunch of commands
+TEST(BasicFilters,ResampleWindowedSincTable) {
+  namespace sitk = itk::simple;
+
+  std::vector<unsigned int> size( 3, 16 );
+  std::vector<double> sigma( 3, 3.0 );
+  std::vector<double> mean( 3, 7.0 );
+  sitk::Image image = sitk::GaussianSource( sitk::sitkFloat32, size, sigma, mean, 100.0 );
+
+  sitk::ResampleImageFilter resampler;
+  EXPECT_EQ( 0u, resampler.GetWindowedSincTableResolution() );
+  resampler.SetReferenceImage( image );
+  resampler.SetDefaultPixelValue( -1.0 );
+
+  // the samples outside of the buffer use the nearest pixels
+  sitk::Euler3DTransform euler( std::vector<double>( 3, 7.5 ), 0.1, 0.2, 0.3, std::vector<double>( 3, 0.4 ) );
+  resampler.SetTransform( euler );
+
+  sitk::InterpolatorEnum interpolators[] = { sitk::sitkHammingWindowedSinc,
+                                             sitk::sitkCosineWindowedSinc,
+                                             sitk::sitkWelchWindowedSinc,
+                                             sitk::sitkLanczosWindowedSinc,
+                                             sitk::sitkBlackmanWindowedSinc };
+  for ( unsigned int i = 0; i < 5; ++i )
+    {
+    resampler.SetInterpolator( interpolators[i] );
+    resampler.SetWindowedSincTableResolution( 0u );
+    sitk::Image expected = resampler.Execute( image );
+    resampler.SetWindowedSincTableResolution( 1000u );
+    sitk::Image result = resampler.Execute( image );
+    EXPECT_NEAR( 0.0, MaximumAbsoluteDifference( expected, result ), 1e-3 ) << "interpolator " << interpolators[i];
+    }
+
+  // the weights are a delta on the pixels
+  resampler.SetTransform( sitk::Transform( 3, sitk::sitkIdentity ) );
+  resampler.SetWindowedSincTableResolution( 10u );
+  EXPECT_EQ( sitk::Hash( image ), sitk::Hash( resampler.Execute( image ) ) );
+}
 
+TEST(BasicFilters,ImageAccumulator) {
   namespace sitk = itk::simple;
-  sitk::Image img = sitk::ReadImage( dataFinder.GetFile ( "Input/RA-Short.nrrd" ) );
-  EXPECT_EQ ( "a963bd6a755b853103a2d195e01a50d3", sitk::Hash(img, sitk::HashImageFilter::MD5));
 
-  sitk::StatisticsImageFilter stats;
-  stats.SetNumberOfThreads(1);
+  std::vector<unsigned int> size( 2, 13 );
+  std::vector<sitk::Image> images;
+  for ( unsigned int i = 0; i < 5; ++i )
+    {
+    sitk::Image image( size, sitk::sitkUInt8 );
+    image.SetSpacing( std::vector<double>( 2, 0.5 ) );
+    for ( unsigned int y = 0; y < size[1]; ++y )
+      {
+      for ( unsigned int x = 0; x < size[0]; ++x )
+        {
+        std::vector<uint32_t> idx( 2 );
+        idx[0] = x;
+        idx[1] = y;
+        image.SetPixelAsUInt8( idx, static_cast<uint8_t>( ( x * ( i + 1 ) + y * 3 + i ) % 4 ) );
+        }
+      }
+    images.push_back( image );
+    }
 
-  AbortAtCommand progressCmd(stats,.05);
-  stats.AddCommand(sitk::sitkProgressEvent, progressCmd);
+  sitk::ImageAccumulator accumulator;
+  EXPECT_EQ( sitk::ImageAccumulator::Sum, accumulator.GetOperation() );
+  EXPECT_THROW( accumulator.GetResult(), sitk::GenericException );
+  for ( unsigned int i = 0; i < images.size(); ++i )
+    {
+    accumulator.AddImage( images[i] );
+    }
+  EXPECT_EQ( 5u, accumulator.GetNumberOfImages() );
+  EXPECT_EQ( sitk::Hash( sitk::NaryAdd( images ) ), sitk::Hash( accumulator.GetResult() ) );
+  EXPECT_EQ( images[0].GetSpacing(), accumulator.GetResult().GetSpacing() );
 
-  CountCommand abortCmd(stats);
-  stats.AddCommand(sitk::sitkAbortEvent, abortCmd);
+  // the first image is not modified
+  EXPECT_EQ( 0u, images[0].GetPixelAsUInt8( std::vector<uint32_t>( 2, 0 ) ) );
 
-  CountCommand deleteCmd(stats);
-  stats.AddCommand(sitk::sitkDeleteEvent, deleteCmd);
+  accumulator.SetOperation( sitk::ImageAccumulator::Maximum );
+  EXPECT_EQ( 0u, accumulator.GetNumberOfImages() );
+  for ( unsigned int i = 0; i < images.size(); ++i )
+    {
+    accumulator.AddImage( images[i] );
+    }
+  EXPECT_EQ( sitk::Hash( sitk::NaryMaximum( images ) ), sitk::Hash( accumulator.GetResult() ) );
 
-  CountCommand endCmd(stats);
-  stats.AddCommand(sitk::sitkEndEvent, endCmd);
+  accumulator.SetOperation( sitk::ImageAccumulator::LabelVoting );
+  for ( unsigned int i = 0; i < images.size(); ++i )
+    {
+    accumulator.AddImage( images[i] );
+    }
+  EXPECT_EQ( sitk::Hash( sitk::LabelVoting( images ) ), sitk::Hash( accumulator.GetResult() ) );
+  EXPECT_EQ( 4u, accumulator.GetLabelForUndecidedPixels() );
 
-  CountCommand iterCmd(stats);
-  stats.AddCommand(sitk::sitkIterationEvent, iterCmd);
+  accumulator.SetLabelForUndecidedPixels( 9u );
+  EXPECT_EQ( sitk::Hash( sitk::LabelVoting( images, 9u ) ), sitk::Hash( accumulator.GetResult() ) );
 
-  CountCommand startCmd(stats);
-  stats.AddCommand(sitk::sitkStartEvent, startCmd);
+  // the images must match the first one
+  EXPECT_THROW( accumulator.AddImage( sitk::Image( 12, 13, sitk::sitkUInt8 ) ), sitk::GenericException );
+  EXPECT_THROW( accumulator.AddImage( sitk::Cast( images[0], sitk::sitkUInt16 ) ), sitk::GenericException );
+  accumulator.Reset();
+  EXPECT_THROW( accumulator.AddImage( sitk::Cast( images[0], sitk::sitkFloat32 ) ), sitk::GenericException );
+}
 
-  CountCommand userCmd(stats);
-  stats.AddCommand(sitk::sitkUserEvent, userCmd);
+TEST(BasicFilters,TileImageBuilder) {
+  namespace sitk = itk::simple;
 
-  EXPECT_ANY_THROW( stats.Execute(img) );
+  std::vector<unsigned int> size( 2 );
+  size[0] = 7;
+  size[1] = 5;
+  std::vector<sitk::Image> images;
+  for ( unsigned int i = 0; i < 5; ++i )
+    {
+    sitk::Image image( size, sitk::sitkVectorFloat32, 2 );
+    image.SetSpacing( std::vector<double>( 2, 0.5 ) );
+    image.SetOrigin( std::vector<double>( 2, -1.0 ) );
+    for ( unsigned int y = 0; y < size[1]; ++y )
+      {
+      for ( unsigned int x = 0; x < size[0]; ++x )
+        {
+        std::vector<uint32_t> idx( 2 );
+        idx[0] = x;
+        idx[1] = y;
+        std::vector<float> v( 2 );
+        v[0] = static_cast<float>( x + 10 * y + 100 * i );
+        v[1] = -v[0];
+        image.SetPixelAsVectorFloat32( idx, v );
+        }
+      }
+    images.push_back( image );
+    }
 
-  EXPECT_EQ ( 1, abortCmd.m_Count );
-  EXPECT_EQ ( 1, deleteCmd.m_Count );
-  EXPECT_EQ ( 0, endCmd.m_Count );
-  EXPECT_EQ ( 0, iterCmd.m_Count );
-  EXPECT_EQ ( 1, startCmd.m_Count );
-  EXPECT_EQ ( 0, userCmd.m_Count );
+  // joined along a new axis
+  sitk::TileImageBuilder builder;
+  builder.SetSpacing( 2.0 );
+  builder.SetOrigin( 3.0 );
+  EXPECT_THROW( builder.SetTile( 0, images[0] ), sitk::GenericException );
+  builder.Allocate( images[0], 5 );
+  EXPECT_EQ( 5u, builder.GetNumberOfTiles() );
+  for ( unsigned int i = static_cast<unsigned int>( images.size() ); i > 0; --i )
+    {
+    builder.SetTile( i - 1, images[i - 1] );
+    }
+  EXPECT_TRUE( builder.IsTileSet( 4 ) );
+  EXPECT_FALSE( builder.IsTileSet( 5 ) );
+
+  sitk::JoinSeriesImageFilter join;
+  join.SetSpacing( 2.0 );
+  join.SetOrigin( 3.0 );
+  sitk::Image expected = join.Execute( images );
+  sitk::Image output = builder.GetOutput();
+  EXPECT_EQ( expected.GetSize(), output.GetSize() );
+  EXPECT_EQ( expected.GetSpacing(), output.GetSpacing() );
+  EXPECT_EQ( expected.GetOrigin(), output.GetOrigin() );
+  EXPECT_EQ( expected.GetDirection(), output.GetDirection() );
+  EXPECT_EQ( sitk::Hash( expected ), sitk::Hash( output ) );
+  EXPECT_EQ( 0u, builder.GetNumberOfTiles() );
+  EXPECT_THROW( builder.GetOutput(), sitk::GenericException );
+
+  // on a grid, with an empty tile
+  std::vector<unsigned int> layout( 2 );
+  layout[0] = 2;
+  layout[1] = 0;
+  builder.SetLayout( layout );
+  builder.Allocate( images[0], 5 );
+  for ( unsigned int i = 0; i < images.size(); ++i )
+    {
+    builder.SetTile( i, images[i] );
+    }
+  EXPECT_FALSE( builder.IsTileSet( 5 ) );
+
+  sitk::TileImageFilter tile;
+  tile.SetLayout( layout );
+  expected = tile.Execute( images );
+  output = builder.GetOutput();
+  EXPECT_EQ( expected.GetSize(), output.GetSize() );
+  EXPECT_EQ( sitk::Hash( expected ), sitk::Hash( output ) );
+
+  // the tiles must match the allocated one
+  builder.Allocate( images[0], 5 );
+  EXPECT_THROW( builder.SetTile( 5, images[0] ), sitk::GenericException );
+  EXPECT_THROW( builder.SetTile( 0, sitk::Image( 7, 6, sitk::sitkVectorFloat32 ) ), sitk::GenericException );
+  EXPECT_THROW( builder.SetTile( 0, sitk::Image( 7, 5, sitk::sitkFloat32 ) ), sitk::GenericException );
+  layout[0] = 0;
+  builder.SetLayout( layout );
+  EXPECT_THROW( builder.Allocate( images[0], 5 ), sitk::GenericException );
+}
+
+TEST(BasicFilters,PasteInPlaceBlend) {
+  namespace sitk = itk::simple;
 
+  sitk::Image destination( 20, 15, sitk::sitkFloat32 );
+  destination += 2.0;
+  sitk::Image patch( 4, 3, sitk::sitkFloat32 );
+  patch += 3.0;
+  std::vector<uint32_t> patchIdx( 2, 1 );
+  patch.SetPixelAsFloat( patchIdx, 1.0 );
+
+  std::vector<unsigned int> sourceSize( 2 );
+  sourceSize[0] = 4;
+  sourceSize[1] = 3;
+  std::vector<int> destinationIndex( 2 );
+  destinationIndex[0] = 5;
+  destinationIndex[1] = 7;
+
+  sitk::PasteImageFilter paste;
+  paste.SetSourceSize( sourceSize );
+  paste.SetDestinationIndex( destinationIndex );
+  EXPECT_EQ( sitk::PasteImageFilter::REPLACE, paste.GetBlendMode() );
+
+  // the buffer of the destination is pasted into
+  const float *buffer = destination.GetBufferAsFloat();
+  paste.ExecuteInPlace( destination, patch );
+  EXPECT_EQ( buffer, destination.GetBufferAsFloat() );
+
+  std::vector<uint32_t> idx( 2 );
+  idx[0] = 6;
+  idx[1] = 8;
+  EXPECT_EQ( 1.0f, destination.GetPixelAsFloat( idx ) );
+  idx[0] = 5;
+  EXPECT_EQ( 3.0f, destination.GetPixelAsFloat( idx ) );
+  idx[0] = 4;
+  EXPECT_EQ( 2.0f, destination.GetPixelAsFloat( idx ) );
+
+  // a shared destination is not modified
+  sitk::Image shared = destination;
+  paste.SetBlendMode( sitk::PasteImageFilter::ADD );
+  paste.SetSourceWeight( 0.5 );
+  paste.ExecuteInPlace( destination, patch );
+  idx[0] = 6;
+  EXPECT_EQ( 1.0f, shared.GetPixelAsFloat( idx ) );
+  EXPECT_EQ( 1.5f, destination.GetPixelAsFloat( idx ) );
+  idx[0] = 5;
+  EXPECT_EQ( 4.5f, destination.GetPixelAsFloat( idx ) );
+  idx[0] = 4;
+  EXPECT_EQ( 2.0f, destination.GetPixelAsFloat( idx ) );
+
+  sitk::Image background( 20, 15, sitk::sitkFloat32 );
+  background += 2.0;
+  paste.SetBlendMode( sitk::PasteImageFilter::MAXIMUM );
+  sitk::Image maximum = paste.Execute( background, patch );
+  idx[0] = 6;
+  EXPECT_EQ( 2.0f, maximum.GetPixelAsFloat( idx ) );
+  idx[0] = 5;
+  EXPECT_EQ( 3.0f, maximum.GetPixelAsFloat( idx ) );
+  EXPECT_EQ( 2.0f, background.GetPixelAsFloat( idx ) );
+
+  // a vector image blends each component
+  sitk::Image vectorDestination = sitk::Compose( background, background );
+  sitk::Image vectorPatch = sitk::Compose( patch, patch );
+  paste.SetBlendMode( sitk::PasteImageFilter::ADD );
+  paste.SetSourceWeight( 2.0 );
+  paste.ExecuteInPlace( vectorDestination, vectorPatch );
+  idx[0] = 5;
+  std::vector<float> v = vectorDestination.GetPixelAsVectorFloat32( idx );
+  ASSERT_EQ( 2u, v.size() );
+  EXPECT_EQ( 8.0f, v[0] );
+  EXPECT_EQ( 8.0f, v[1] );
+
+  paste.SetBlendMode( sitk::PasteImageFilter::MAXIMUM );
+  sitk::Image complexDestination = sitk::Cast( background, sitk::sitkComplexFloat32 );
+  EXPECT_THROW( paste.ExecuteInPlace( complexDestination, sitk::Cast( patch, sitk::sitkComplexFloat32 ) ), sitk::GenericException );
 }
 
-TEST(BasicFilters,ResampleImageFilter_AdditionalProcedures)
-{
+TEST(BasicFilters,ProjectionAccumulator) {
   namespace sitk = itk::simple;
 
-  sitk::Image img;
-  ASSERT_NO_THROW( img = sitk::ReadImage( dataFinder.GetFile ( "Input/RA-Float.nrrd" ) ) ) << "Reading input Image.";
+  std::vector<unsigned int> size( 3 );
+  size[0] = 70;
+  size[1] = 60;
+  size[2] = 9;
+  std::vector<double> sigma( 3, 20.0 );
+  std::vector<double> mean( 3 );
+  mean[0] = 30.0;
+  mean[1] = 20.0;
+  mean[2] = 2.0;
+  sitk::Image image = sitk::GaussianSource( sitk::sitkFloat32, size, sigma, mean, 100.0 );
+  image = sitk::Add( image, sitk::GaussianSource( sitk::sitkFloat32, size, std::vector<double>( 3, 3.0 ), std::vector<double>( 3, 5.0 ), 50.0 ) );
+
+  const sitk::ProjectionAccumulator::ProjectionType projections[] = {
+    sitk::ProjectionAccumulator::Maximum,
+    sitk::ProjectionAccumulator::Minimum,
+    sitk::ProjectionAccumulator::Sum,
+    sitk::ProjectionAccumulator::Mean,
+    sitk::ProjectionAccumulator::StandardDeviation };
+
+  for ( unsigned int p = 0; p < 3; ++p )
+    {
+    const sitk::Image expected[] = {
+      sitk::MaximumProjection( image, p ),
+      sitk::MinimumProjection( image, p ),
+      sitk::SumProjection( image, p ),
+      sitk::MeanProjection( image, p ),
+      sitk::StandardDeviationProjection( image, p ) };
+
+    for ( unsigned int j = 0; j < 5; ++j )
+      {
+      // one thread splits the output pixels along the z projection,
+      // and more threads split the slices
+      for ( unsigned int threads = 1; threads <= 4; threads += 3 )
+        {
+        sitk::ProjectionAccumulator accumulator( projections[j] );
+        accumulator.SetProjectionDimension( p );
+        accumulator.SetNumberOfThreads( threads );
+
+        // slabs of 4 slices and the remainder
+        for ( unsigned int start = 0; start < size[p]; start += 4 )
+          {
+          std::vector<unsigned int> slabSize = size;
+          slabSize[p] = std::min( 4u, size[p] - start );
+          std::vector<int> slabIndex( 3, 0 );
+          slabIndex[p] = start;
+          accumulator.AddSlab( sitk::RegionOfInterest( image, slabSize, slabIndex ) );
+          }
+        EXPECT_EQ( size[p], accumulator.GetNumberOfSlices() );
+
+        sitk::Image result = accumulator.GetResult();
+        EXPECT_EQ( expected[j].GetPixelID(), result.GetPixelID() ) << "projection " << j;
+        EXPECT_EQ( expected[j].GetSize(), result.GetSize() ) << "projection " << j;
+        EXPECT_NEAR( 0.0, MaximumAbsoluteDifference( expected[j], result ), 1e-2 )
+          << "projection " << j << " along " << p << " with " << threads << " threads";
+        }
+      }
+    }
 
-  sitk::Transform xf = sitk::Transform(); // identity transform
+  // integer pixels are kept by the maximum
+  sitk::Image labels = sitk::Cast( image, sitk::sitkUInt8 );
+  sitk::ProjectionAccumulator mip;
+  mip.SetProjectionDimension( 2 );
+  mip.AddSlab( labels );
+  EXPECT_EQ( sitk::Hash( sitk::MaximumProjection( labels, 2 ) ), sitk::Hash( mip.GetResult() ) );
+
+  // the slabs must match the first one
+  EXPECT_THROW( mip.AddSlab( image ), sitk::GenericException );
+  EXPECT_THROW( mip.AddSlab( sitk::Image( 71, 60, 3, sitk::sitkUInt8 ) ), sitk::GenericException );
+  mip.SetProjectionDimension( 3 );
+  EXPECT_THROW( mip.AddSlab( labels ), sitk::GenericException );
+  EXPECT_THROW( mip.GetResult(), sitk::GenericException );
+}
 
-  // self reference image
-   sitk::Image out = sitk::Resample( img,
-                                     xf,
-                                     sitk::sitkNearestNeighbor );
-  EXPECT_EQ( "b187541bdcc89843d0a25a3761f344c358f3518a", sitk::Hash( out )) << " Procedural Interface 1 identity transform.";
+TEST(BasicFilters,StatisticsAccumulator) {
+  namespace sitk = itk::simple;
 
-  // additional parameter reference image
-   out = sitk::Resample( img,
-                         img,
-                         xf,
-                         sitk::sitkNearestNeighbor );
-  EXPECT_EQ( "b187541bdcc89843d0a25a3761f344c358f3518a", sitk::Hash( out )) << " Procedural Interface 2 identity transform.";
+  std::vector<unsigned int> size( 3 );
+  size[0] = 64;
+  size[1] = 50;
+  size[2] = 20;
+  sitk::Image base = sitk::GaussianSource( sitk::sitkFloat64, size, std::vector<double>( 3, 10.0 ),
+                                           std::vector<double>( 3, 20.0 ), 100.0 );
+  sitk::StatisticsImageFilter statistics;
+  statistics.Execute( base );
+
+  // a large offset, which the variance must not lose
+  const double offset = 1e6;
+  sitk::Image image = sitk::Add( base, offset );
+  sitk::Image mask = sitk::BinaryThreshold( base, 10.0, 1000.0, 3, 0 );
+
+  sitk::StatisticsAccumulator accumulator;
+  EXPECT_EQ( 0u, accumulator.GetCount() );
+  EXPECT_TRUE( accumulator.GetMean() != accumulator.GetMean() );
+  accumulator.AddImage( image );
+  EXPECT_EQ( image.GetNumberOfPixels(), accumulator.GetCount() );
+  EXPECT_EQ( image.GetNumberOfPixels(), accumulator.GetNonZeroCount() );
+  EXPECT_NEAR( statistics.GetMinimum() + offset, accumulator.GetMinimum(), 1e-9 * offset );
+  EXPECT_NEAR( statistics.GetMaximum() + offset, accumulator.GetMaximum(), 1e-9 * offset );
+  EXPECT_NEAR( statistics.GetSum() + offset * image.GetNumberOfPixels(), accumulator.GetSum(), 1e-9 * accumulator.GetSum() );
+  EXPECT_NEAR( statistics.GetMean() + offset, accumulator.GetMean(), 1e-9 * offset );
+  EXPECT_NEAR( statistics.GetVariance(), accumulator.GetVariance(), 1e-6 * statistics.GetVariance() );
+  EXPECT_NEAR( statistics.GetSigma(), accumulator.GetSigma(), 1e-6 * statistics.GetSigma() );
+
+  // the masked statistics
+  sitk::LabelStatisticsImageFilter labelStatistics;
+  labelStatistics.Execute( base, mask );
+  accumulator.Reset();
+  accumulator.AddImage( base, mask );
+  EXPECT_EQ( labelStatistics.GetCount( 3 ), accumulator.GetCount() );
+  EXPECT_EQ( labelStatistics.GetMinimum( 3 ), accumulator.GetMinimum() );
+  EXPECT_EQ( labelStatistics.GetMaximum( 3 ), accumulator.GetMaximum() );
+  EXPECT_NEAR( labelStatistics.GetMean( 3 ), accumulator.GetMean(), 1e-6 );
+  EXPECT_NEAR( labelStatistics.GetSigma( 3 ), accumulator.GetSigma(), 1e-6 * labelStatistics.GetSigma( 3 ) );
+
+  // accumulated over chunks, with one thread and several
+  for ( unsigned int threads = 1; threads <= 4; threads += 3 )
+    {
+    accumulator.Reset();
+    accumulator.SetNumberOfThreads( threads );
+    std::vector<unsigned int> chunkSize = size;
+    chunkSize[2] = 5;
+    for ( int z = 0; z < 20; z += 5 )
+      {
+      std::vector<int> chunkIndex( 3, 0 );
+      chunkIndex[2] = z;
+      accumulator.AddImage( sitk::RegionOfInterest( base, chunkSize, chunkIndex ),
+                            sitk::RegionOfInterest( mask, chunkSize, chunkIndex ) );
+      }
+    EXPECT_EQ( labelStatistics.GetCount( 3 ), accumulator.GetCount() );
+    EXPECT_NEAR( labelStatistics.GetMean( 3 ), accumulator.GetMean(), 1e-6 );
+    EXPECT_NEAR( labelStatistics.GetSigma( 3 ), accumulator.GetSigma(), 1e-6 * labelStatistics.GetSigma( 3 ) );
+    }
 
-  // manual specification of output domain
- out = sitk::Resample( img,
-                       img.GetSize(),
-                       xf,
-                       sitk::sitkNearestNeighbor,
-                       img.GetOrigin(),
-                       img.GetSpacing(),
-                       img.GetDirection() );
-  EXPECT_EQ( "b187541bdcc89843d0a25a3761f344c358f3518a", sitk::Hash( out )) << " Procedural Interface 3 identity transform.";
+  // the zero pixels are counted
+  sitk::Image zeros( 10, 10, sitk::sitkInt16 );
+  zeros.SetPixelAsInt16( std::vector<uint32_t>( 2, 3 ), -4 );
+  accumulator.Reset();
+  accumulator.AddImage( zeros );
+  EXPECT_EQ( 100u, accumulator.GetCount() );
+  EXPECT_EQ( 1u, accumulator.GetNonZeroCount() );
+  EXPECT_EQ( -4.0, accumulator.GetMinimum() );
+  EXPECT_EQ( -4.0, accumulator.GetSum() );
+
+  // the mask must match the image and have integer pixels
+  EXPECT_THROW( accumulator.AddImage( image, zeros ), sitk::GenericException );
+  EXPECT_THROW( accumulator.AddImage( image, image ), sitk::GenericException );
 }
 
+TEST(BasicFilters,PackedBinaryImage) {
+  namespace sitk = itk::simple;
 
-TEST(BasicFilters,OtsuThreshold_CheckNamesInputCompatibility)
-{
+  // lines which do not fill their last word
+  sitk::Image image( 131, 37, 5, sitk::sitkUInt8 );
+  sitk::Image other( 131, 37, 5, sitk::sitkUInt8 );
+  std::vector<uint32_t> index( 3 );
+  for ( index[2] = 0; index[2] < 5; ++index[2] )
+    {
+    for ( index[1] = 0; index[1] < 37; ++index[1] )
+      {
+      for ( index[0] = 0; index[0] < 131; ++index[0] )
+        {
+        image.SetPixelAsUInt8( index, ( 7 * index[0] + 13 * index[1] + 5 * index[2] ) % 29 == 0 );
+        other.SetPixelAsUInt8( index, index[0] % 3 == 0 );
+        }
+      }
+    }
+  image.SetOrigin( std::vector<double>( 3, 2.0 ) );
+  image.SetSpacing( std::vector<double>( 3, 0.5 ) );
+  other.CopyInformation( image );
+
+  sitk::PackedBinaryImage packed( image );
+  EXPECT_EQ( image.GetSize(), packed.GetSize() );
+  EXPECT_EQ( image.GetOrigin(), packed.GetOrigin() );
+  EXPECT_EQ( 3u * 8u * 37u * 5u, packed.GetSizeInBytes() );
+  EXPECT_EQ( static_cast<uint64_t>( std::count( image.GetBufferAsUInt8(), image.GetBufferAsUInt8() + image.GetNumberOfPixels(), 1 ) ),
+             packed.GetNumberOfForegroundPixels() );
+  EXPECT_EQ( sitk::Hash( image ), sitk::Hash( packed.ToImage() ) );
+  index[0] = 130;
+  index[1] = 0;
+  index[2] = 2;
+  EXPECT_EQ( image.GetPixelAsUInt8( index ) != 0, packed.GetPixel( index ) );
+
+  // the morphology is that of the box kernel, across words
+  std::vector<unsigned int> radius( 3, 1 );
+  radius[0] = 70;
+  radius[1] = 2;
+  sitk::PackedBinaryImage dilated = packed;
+  dilated.Dilate( radius );
+  std::vector<uint32_t> kernelRadius( radius.begin(), radius.end() );
+  EXPECT_EQ( sitk::Hash( sitk::BinaryDilate( image, kernelRadius, sitk::sitkBox, 0.0, 1.0 ) ),
+             sitk::Hash( dilated.ToImage() ) );
+
+  radius[0] = 3;
+  kernelRadius[0] = 3;
+  sitk::PackedBinaryImage eroded( other );
+  eroded.Erode( radius );
+  EXPECT_EQ( sitk::Hash( sitk::BinaryErode( other, kernelRadius, sitk::sitkBox, 0.0, 1.0 ) ),
+             sitk::Hash( eroded.ToImage() ) );
+  EXPECT_ANY_THROW( eroded.Erode( std::vector<unsigned int>( 2, 1 ) ) );
+
+  // the logical operations
+  const sitk::PackedBinaryImage packedOther( other );
+  EXPECT_EQ( sitk::Hash( sitk::And( image, other ) ), sitk::Hash( sitk::PackedBinaryImage( packed ).And( packedOther ).ToImage() ) );
+  EXPECT_EQ( sitk::Hash( sitk::Or( image, other ) ), sitk::Hash( sitk::PackedBinaryImage( packed ).Or( packedOther ).ToImage() ) );
+  EXPECT_EQ( sitk::Hash( sitk::Xor( image, other ) ), sitk::Hash( sitk::PackedBinaryImage( packed ).Xor( packedOther ).ToImage() ) );
+  EXPECT_EQ( sitk::Hash( sitk::BinaryNot( image ) ), sitk::Hash( sitk::PackedBinaryImage( packed ).Not().ToImage() ) );
+  EXPECT_ANY_THROW( sitk::PackedBinaryImage( packed ).And( sitk::PackedBinaryImage( std::vector<unsigned int>( 3, 4 ) ) ) );
+
+  // the masking of an image of another pixel type
+  sitk::Image values = sitk::ShiftScale( sitk::Cast( other, sitk::sitkFloat32 ), 0.5, 2.0 );
+  EXPECT_EQ( sitk::Hash( sitk::Mask( values, image, -1.0 ) ), sitk::Hash( packed.Mask( values, -1.0 ) ) );
+  EXPECT_EQ( 1.0f, values.GetPixelAsFloat( std::vector<uint32_t>( 3, 1 ) ) );
+
+  // a slab converted into the middle and back
+  std::vector<unsigned int> slabIndex( 3, 0 );
+  slabIndex[0] = 5;
+  slabIndex[2] = 2;
+  std::vector<unsigned int> slabSize( 3, 1 );
+  slabSize[0] = 100;
+  slabSize[1] = 37;
+  sitk::PackedBinaryImage assembled( image.GetSize() );
+  assembled.SetRegion( sitk::Extract( image, slabSize, std::vector<int>( slabIndex.begin(), slabIndex.end() ) ), slabIndex );
+  sitk::Image slab = assembled.GetRegion( slabIndex, slabSize );
+  EXPECT_EQ( sitk::Hash( sitk::Extract( image, slabSize, std::vector<int>( slabIndex.begin(), slabIndex.end() ) ) ),
+             sitk::Hash( slab ) );
+  EXPECT_EQ( 3.0, slab.GetOrigin()[2] );
+  EXPECT_EQ( 0u, assembled.GetRegion( std::vector<unsigned int>( 3, 0 ), slabSize ).GetPixelAsUInt8( std::vector<uint32_t>( 3, 0 ) ) );
+  index[0] = 0;
+  index[1] = 0;
+  index[2] = 0;
+  EXPECT_EQ( 255u, packed.ToImage( 255 ).GetPixelAsUInt8( index ) );
+  EXPECT_ANY_THROW( assembled.SetRegion( image, slabIndex ) );
+}
+
+
+TEST(BasicFilters,NoiseImageFilters_Reproducible) {
   namespace sitk = itk::simple;
 
-  sitk::Image input(10,10,sitk::sitkFloat32);
-  sitk::Image mask1(10,10,10,sitk::sitkUInt8);
-  sitk::Image mask2(11,10,sitk::sitkUInt8);
+  // the noise of each pixel is drawn from its own stream, so the
+  // output does not depend on the number of threads
+  sitk::Image image = sitk::ReadImage ( dataFinder.GetFile ( "Input/RA-Float.nrrd" ) );
+
+  sitk::AdditiveGaussianNoiseImageFilter gaussian;
+  gaussian.SetSeed( 123u );
+  gaussian.SetNumberOfThreads( 1 );
+  const std::string gaussianHash = sitk::Hash( gaussian.Execute( image ) );
+  gaussian.SetNumberOfThreads( 7 );
+  EXPECT_EQ( gaussianHash, sitk::Hash( gaussian.Execute( image ) ) );
+  gaussian.SetSeed( 124u );
+  EXPECT_NE( gaussianHash, sitk::Hash( gaussian.Execute( image ) ) );
+
+  sitk::SaltAndPepperNoiseImageFilter saltAndPepper;
+  saltAndPepper.SetSeed( 123u );
+  saltAndPepper.SetNumberOfThreads( 1 );
+  const std::string saltAndPepperHash = sitk::Hash( saltAndPepper.Execute( image ) );
+  saltAndPepper.SetNumberOfThreads( 7 );
+  EXPECT_EQ( saltAndPepperHash, sitk::Hash( saltAndPepper.Execute( image ) ) );
+
+  sitk::ShotNoiseImageFilter shot;
+  shot.SetSeed( 123u );
+  shot.SetNumberOfThreads( 1 );
+  const std::string shotHash = sitk::Hash( shot.Execute( image ) );
+  shot.SetNumberOfThreads( 7 );
+  EXPECT_EQ( shotHash, sitk::Hash( shot.Execute( image ) ) );
+
+  sitk::SpeckleNoiseImageFilter speckle;
+  speckle.SetSeed( 123u );
+  speckle.SetNumberOfThreads( 1 );
+  const std::string speckleHash = sitk::Hash( speckle.Execute( image ) );
+  speckle.SetNumberOfThreads( 7 );
+  EXPECT_EQ( speckleHash, sitk::Hash( speckle.Execute( image ) ) );
+
+  // the noise has the mean and standard deviation set
+  sitk::Image constant( 200, 200, sitk::sitkFloat64 );
+  gaussian.SetMean( 2.0 );
+  gaussian.SetStandardDeviation( 3.0 );
+  sitk::Image noise = gaussian.Execute( constant );
+  double sum = 0.0;
+  double sumOfSquares = 0.0;
+  const double *buffer = noise.GetBufferAsDouble();
+  for ( unsigned int i = 0; i < 200u * 200u; ++i )
+    {
+    sum += buffer[i];
+    sumOfSquares += buffer[i] * buffer[i];
+    }
+  const double mean = sum / ( 200.0 * 200.0 );
+  EXPECT_NEAR( 2.0, mean, 0.05 );
+  EXPECT_NEAR( 3.0, std::sqrt( sumOfSquares / ( 200.0 * 200.0 ) - mean * mean ), 0.05 );
+}
 
-  // check that if the dimension or size does not match an exception
-  // is thrown.
-  EXPECT_THROW( sitk::OtsuThreshold(input, mask1), sitk::GenericException );
-  EXPECT_THROW( sitk::OtsuThreshold(input, mask2), sitk::GenericException );
+TEST(BasicFilters,RandomAugmentationFilter) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage ( dataFinder.GetFile ( "Input/RA-Float.nrrd" ) );
+
+  sitk::RandomAugmentationFilter augment;
+  EXPECT_EQ ( augment.GetName(), "RandomAugmentationFilter" );
+  EXPECT_THROW ( augment.Execute( image ), sitk::GenericException );
+  EXPECT_THROW ( augment.SetInterpolator( sitk::sitkBSpline ), sitk::GenericException );
+  EXPECT_THROW ( augment.SetElasticGridSize( 1 ), sitk::GenericException );
+
+  augment.SetOutputSize( std::vector<unsigned int>( 3, 24 ) );
+  augment.SetRotationRange( 0.3 ).SetScaleRange( 0.1 );
+  augment.SetElasticStandardDeviation( 2.0 ).SetElasticGridSize( 3 );
+  augment.SetIntensityScaleRange( 0.1 ).SetIntensityShiftRange( 5.0 ).SetNoiseStandardDeviation( 2.0 );
+  augment.SetSeed( 123u );
+
+  augment.SetNumberOfThreads( 1 );
+  std::vector<sitk::Image> batch = augment.Execute( image, 4 );
+  ASSERT_EQ ( 4u, batch.size() );
+  EXPECT_EQ ( 4u, augment.GetSampleNumber() );
+  for ( unsigned int i = 0; i < batch.size(); ++i )
+    {
+    EXPECT_EQ ( std::vector<unsigned int>( 3, 24 ), batch[i].GetSize() );
+    EXPECT_EQ ( sitk::sitkFloat32, batch[i].GetPixelID() );
+    EXPECT_EQ ( image.GetSpacing(), batch[i].GetSpacing() );
+    }
+  EXPECT_NE ( sitk::Hash( batch[0] ), sitk::Hash( batch[1] ) );
+
+  // the patches do not depend on the number of threads, and a sample
+  // number is drawn again
+  augment.SetNumberOfThreads( 7 );
+  augment.SetSampleNumber( 0 );
+  std::vector<sitk::Image> again = augment.Execute( image, 4 );
+  for ( unsigned int i = 0; i < batch.size(); ++i )
+    {
+    EXPECT_EQ ( sitk::Hash( batch[i] ), sitk::Hash( again[i] ) );
+    }
+  augment.SetSampleNumber( 2 );
+  EXPECT_EQ ( sitk::Hash( batch[2] ), sitk::Hash( augment.Execute( image ) ) );
+
+  // without transforms, a patch is the linear interpolation of the
+  // image about a random centre
+  sitk::Image ramp( 32, 24, sitk::sitkFloat32 );
+  for ( unsigned int y = 0; y < 24; ++y )
+    {
+    for ( unsigned int x = 0; x < 32; ++x )
+      {
+      std::vector<unsigned int> idx( 2 );
+      idx[0] = x; idx[1] = y;
+      ramp.SetPixelAsFloat( idx, static_cast<float>( x + 2 * y ) );
+      }
+    }
+  ramp.SetSpacing( std::vector<double>( 2, 0.5 ) );
+  sitk::RandomAugmentationFilter identity;
+  identity.SetOutputSize( std::vector<unsigned int>( 2, 20 ) );
+  identity.SetDefaultPixelValue( -1.0 );
+  identity.SetSeed( 1u );
+  sitk::Image patch = identity.Execute( ramp );
+  unsigned int inside = 0;
+  for ( unsigned int y = 0; y < 20; ++y )
+    {
+    for ( unsigned int x = 0; x < 20; ++x )
+      {
+      std::vector<int64_t> idx( 2 );
+      idx[0] = x; idx[1] = y;
+      const std::vector<double> index =
+        ramp.TransformPhysicalPointToContinuousIndex( patch.TransformIndexToPhysicalPoint( idx ) );
+      const float value = patch.GetPixelAsFloat( std::vector<unsigned int>( idx.begin(), idx.end() ) );
+      if ( index[0] >= 0.0 && index[0] <= 31.0 && index[1] >= 0.0 && index[1] <= 23.0 )
+        {
+        EXPECT_NEAR ( index[0] + 2.0 * index[1], value, 1e-4 );
+        ++inside;
+        }
+      else if ( index[0] < -0.5 || index[0] > 31.5 || index[1] < -0.5 || index[1] > 23.5 )
+        {
+        EXPECT_EQ ( -1.0f, value );
+        }
+      }
+    }
+  EXPECT_GT ( inside, 0u );
+
+  // a 2D label image sampled with the nearest neighbour keeps its
+  // labels
+  sitk::Image labels( 32, 32, sitk::sitkUInt8 );
+  for ( unsigned int y = 0; y < 32; ++y )
+    {
+    for ( unsigned int x = 0; x < 32; ++x )
+      {
+      std::vector<unsigned int> idx( 2 );
+      idx[0] = x; idx[1] = y;
+      labels.SetPixelAsUInt8( idx, static_cast<uint8_t>( ( x / 8 + y / 8 ) % 3 + 1 ) );
+      }
+    }
+  sitk::RandomAugmentationFilter labelAugment;
+  labelAugment.SetOutputSize( std::vector<unsigned int>( 2, 16 ) );
+  labelAugment.SetRotationRange( 0.5 ).SetElasticStandardDeviation( 1.0 );
+  labelAugment.SetInterpolator( sitk::sitkNearestNeighbor ).SetSeed( 7u );
+  sitk::Image labelPatch = labelAugment.Execute( labels );
+  const float *buffer = labelPatch.GetBufferAsFloat();
+  for ( unsigned int i = 0; i < 16u * 16u; ++i )
+    {
+    EXPECT_TRUE ( buffer[i] == 0.0f || buffer[i] == 1.0f || buffer[i] == 2.0f || buffer[i] == 3.0f );
+    }
+}
+
+TEST(BasicFilters,GaussianScaleSpaceFilter) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile( "Input/BrainProtonDensitySliceBorder20.png" ) );
+
+  sitk::GaussianScaleSpaceFilter filter;
+  EXPECT_EQ ( "GaussianScaleSpaceFilter", filter.GetName() );
+
+  std::vector<double> sigmas;
+  sigmas.push_back( 0.5 );
+  sigmas.push_back( 1.0 );
+  sigmas.push_back( 2.0 );
+  sigmas.push_back( 4.0 );
+  filter.SetSigmas( sigmas );
+
+  std::vector<sitk::Image> levels = filter.Execute( image );
+  ASSERT_EQ ( 4u, levels.size() );
+  EXPECT_EQ ( std::vector<unsigned int>( 4, 1u ), filter.GetShrinkFactors() );
+
+  // each level is the image smoothed at its sigma
+  sitk::SmoothingRecursiveGaussianImageFilter smoothing;
+  for ( unsigned int i = 2; i < levels.size(); ++i )
+    {
+    EXPECT_EQ ( sitk::sitkFloat32, levels[i].GetPixelID() );
+    EXPECT_EQ ( image.GetSize(), levels[i].GetSize() );
+
+    smoothing.SetSigma( sigmas[i] );
+    sitk::Image expected = sitk::Cast( smoothing.Execute( image ), sitk::sitkFloat32 );
+    const float *a = expected.GetBufferAsFloat();
+    const float *b = levels[i].GetBufferAsFloat();
+    const size_t n = expected.GetNumberOfPixels();
+    double difference = 0.0;
+    for ( size_t j = 0; j < n; ++j )
+      {
+      difference += std::abs( a[j] - b[j] );
+      }
+    EXPECT_LT ( difference / n, 1.0 ) << " level " << i;
+    }
+
+  // the octaves are shrunk when sigma doubles
+  filter.ShrinkPerOctaveOn();
+  levels = filter.Execute( image );
+  ASSERT_EQ ( 4u, levels.size() );
+  std::vector<unsigned int> factors = filter.GetShrinkFactors();
+  EXPECT_EQ ( 1u, factors[0] );
+  EXPECT_EQ ( 1u, factors[1] );
+  EXPECT_EQ ( 2u, factors[2] );
+  EXPECT_EQ ( 4u, factors[3] );
+  EXPECT_EQ ( image.GetSize()[0] / 2, levels[2].GetSize()[0] );
+  EXPECT_EQ ( image.GetSize()[1] / 4, levels[3].GetSize()[1] );
+  EXPECT_EQ ( 4.0 * image.GetSpacing()[0], levels[3].GetSpacing()[0] );
+
+  std::reverse( sigmas.begin(), sigmas.end() );
+  filter.SetSigmas( sigmas );
+  EXPECT_THROW ( filter.Execute( image ), sitk::GenericException );
+}
+
+TEST(BasicFilters,KernelCache) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/cthead1.png" ) );
+
+  std::vector<uint32_t> radius2( 2, 2 );
+  std::vector<uint32_t> radius3( 2, 3 );
+  const std::string expected2 = sitk::Hash( sitk::GrayscaleDilate( image, radius2, sitk::sitkBall ) );
+  const std::string expected3 = sitk::Hash( sitk::GrayscaleDilate( image, radius3, sitk::sitkBall ) );
+
+  // the cached kernel gives the same output again
+  EXPECT_EQ( expected2, sitk::Hash( sitk::GrayscaleDilate( image, radius2, sitk::sitkBall ) ) );
+
+  // a persistent filter keeps its kernel while the radius is the same
+  sitk::GrayscaleDilateImageFilter dilate;
+  dilate.PersistentITKFilterOn();
+  dilate.SetKernelType( sitk::sitkBall );
+  dilate.SetKernelRadius( radius2 );
+  EXPECT_EQ( expected2, sitk::Hash( dilate.Execute( image ) ) );
+  EXPECT_EQ( expected2, sitk::Hash( dilate.Execute( image ) ) );
+  dilate.SetKernelRadius( radius3 );
+  EXPECT_EQ( expected3, sitk::Hash( dilate.Execute( image ) ) );
+  dilate.SetKernelType( sitk::sitkBox );
+  EXPECT_EQ( sitk::Hash( sitk::GrayscaleDilate( image, radius3, sitk::sitkBox ) ), sitk::Hash( dilate.Execute( image ) ) );
+  dilate.SetKernelType( sitk::sitkBall );
+  dilate.SetKernelRadius( radius2 );
+  EXPECT_EQ( expected2, sitk::Hash( dilate.Execute( image ) ) );
+}
+
+TEST(BasicFilters,ConvolutionPadInput) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/cthead1-Float.mha" ) );
+  image = sitk::RegionOfInterest( image, std::vector<unsigned int>( 2, 24 ), std::vector<int>( 2, 100 ) );
+
+  // a separable kernel, and a non separable kernel of an even size
+  sitk::Image box( 9, 7, sitk::sitkFloat32 );
+  std::fill( box.GetBufferAsFloat(), box.GetBufferAsFloat() + box.GetNumberOfPixels(), 1.0f );
+  sitk::Image ramp( 8, 6, sitk::sitkFloat32 );
+  for ( unsigned int i = 0; i < ramp.GetNumberOfPixels(); ++i )
+    {
+    ramp.GetBufferAsFloat()[i] = float( i % 5 );
+    }
+  const sitk::Image kernels[] = { box, ramp };
+
+  for ( unsigned int k = 0; k < 2; ++k )
+    {
+    for ( unsigned int bc = 0; bc < 3; ++bc )
+      {
+      sitk::ConvolutionImageFilter convolution;
+      convolution.SetBoundaryCondition( sitk::ConvolutionImageFilter::BoundaryConditionType( bc ) );
+      convolution.NormalizeOn();
+      sitk::Image expected = convolution.Execute( image, kernels[k] );
+
+      convolution.PadInputOn();
+      sitk::Image padded = convolution.Execute( image, kernels[k] );
+      EXPECT_EQ( expected.GetSize(), padded.GetSize() );
+      EXPECT_EQ( expected.GetOrigin(), padded.GetOrigin() );
+      EXPECT_EQ( sitk::Hash( expected ), sitk::Hash( padded ) ) << "kernel: " << k << " boundary condition: " << bc;
+
+      // the VALID region is not padded
+      convolution.SetOutputRegionMode( sitk::ConvolutionImageFilter::VALID );
+      EXPECT_EQ( expected.GetSize()[0] - 2 * ( kernels[k].GetSize()[0] / 2 ) + 1 - kernels[k].GetSize()[0] % 2,
+                 convolution.Execute( image, kernels[k] ).GetSize()[0] );
+      }
+    }
+}
+
+TEST(BasicFilters,LevelSetCropToInitialLevelSet) {
+  namespace sitk = itk::simple;
+
+  // a bright square in a large image, and an initial level set of a
+  // small disk at its centre, negative inside
+  const unsigned int size = 160;
+  sitk::Image feature( size, size, sitk::sitkFloat32 );
+  sitk::Image initial( size, size, sitk::sitkFloat32 );
+  for ( unsigned int j = 0; j < size; ++j )
+    {
+    for ( unsigned int i = 0; i < size; ++i )
+      {
+      const bool inside = i >= 40 && i < 60 && j >= 45 && j < 70;
+      feature.GetBufferAsFloat()[i + size * j] = inside ? 100.0f : 0.0f;
+      const double dx = double( i ) - 50.0;
+      const double dy = double( j ) - 57.0;
+      initial.GetBufferAsFloat()[i + size * j] = float( std::sqrt( dx * dx + dy * dy ) - 3.0 );
+      }
+    }
+
+  sitk::ThresholdSegmentationLevelSetImageFilter segmentation;
+  segmentation.SetLowerThreshold( 50.0 );
+  segmentation.SetUpperThreshold( 150.0 );
+  segmentation.SetNumberOfIterations( 200 );
+  sitk::Image expected = segmentation.Execute( initial, feature );
+  const uint32_t expectedIterations = segmentation.GetElapsedIterations();
+
+  segmentation.CropToInitialLevelSetOn();
+  segmentation.SetCropMargin( 16 );
+  sitk::Image cropped = segmentation.Execute( initial, feature );
+  EXPECT_EQ( expected.GetSize(), cropped.GetSize() );
+  EXPECT_EQ( expected.GetOrigin(), cropped.GetOrigin() );
+  EXPECT_EQ( expectedIterations, segmentation.GetElapsedIterations() );
+
+  // the same object, the background of the cropped output is outside
+  sitk::Image expectedObject = sitk::BinaryThreshold( expected, -1e6, 0.0 );
+  sitk::Image croppedObject = sitk::BinaryThreshold( cropped, -1e6, 0.0 );
+  EXPECT_EQ( sitk::Hash( expectedObject ), sitk::Hash( croppedObject ) );
+  EXPECT_LT( 0.0f, cropped.GetBufferAsFloat()[0] );
+}
+
+TEST(BasicFilters,FastMarchingStoppingValueRegion) {
+  namespace sitk = itk::simple;
+
+  sitk::Image speed( 200, 150, sitk::sitkFloat32 );
+  std::fill( speed.GetBufferAsFloat(), speed.GetBufferAsFloat() + speed.GetNumberOfPixels(), 1.0f );
+  speed.SetSpacing( std::vector<double>( 2, 0.5 ) );
+
+  std::vector< std::vector<unsigned int> > trialPoints;
+  std::vector<unsigned int> point( 2, 60 );
+  point[0] = 50;
+  trialPoints.push_back( point );
+
+  sitk::FastMarchingImageFilter fastMarching;
+  fastMarching.SetTrialPoints( trialPoints );
+  sitk::Image expected = fastMarching.Execute( speed );
+
+  // the front of the stopping value is bounded to a region of 2 * 20 / 0.5 pixels
+  fastMarching.SetStoppingValue( 20.0 );
+  sitk::Image bounded = fastMarching.Execute( speed );
+  ASSERT_EQ( sitk::sitkFloat64, bounded.GetPixelID() );
+  EXPECT_EQ( expected.GetSize(), bounded.GetSize() );
+  EXPECT_EQ( expected.GetOrigin(), bounded.GetOrigin() );
+  EXPECT_EQ( expected.GetSpacing(), bounded.GetSpacing() );
+
+  unsigned int numberOfReached = 0;
+  for ( unsigned int i = 0; i < expected.GetNumberOfPixels(); ++i )
+    {
+    if ( expected.GetBufferAsDouble()[i] <= 20.0 )
+      {
+      ++numberOfReached;
+      EXPECT_EQ( expected.GetBufferAsDouble()[i], bounded.GetBufferAsDouble()[i] ) << "pixel: " << i;
+      }
+    else
+      {
+      EXPECT_LT( 20.0, bounded.GetBufferAsDouble()[i] ) << "pixel: " << i;
+      }
+    }
+  EXPECT_LT( 0u, numberOfReached );
+  EXPECT_GT( expected.GetNumberOfPixels(), numberOfReached );
+}
+
+TEST(BasicFilters,ConnectedThresholdBoundedGrowth) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/cthead1.png" ) );
+
+  std::vector< std::vector<unsigned int> > seeds;
+  seeds.push_back( std::vector<unsigned int>( 2, 128 ) );
+
+  sitk::ConnectedThresholdImageFilter connected;
+  connected.SetSeedList( seeds );
+  connected.SetLower( 80 );
+  connected.SetUpper( 255 );
+  connected.SetReplaceValue( 3 );
+
+  for ( unsigned int c = 0; c < 2; ++c )
+    {
+    connected.SetConnectivity( sitk::ConnectedThresholdImageFilter::ConnectivityType( c ) );
+    connected.SetMaximumNumberOfPixels( 0 );
+    connected.SetOutputMode( sitk::ConnectedThresholdImageFilter::FullImage );
+    sitk::Image expected = connected.Execute( image );
+
+    // the region grown by runs, in the bounding box of the region
+    connected.SetOutputMode( sitk::ConnectedThresholdImageFilter::CroppedImage );
+    sitk::Image cropped = connected.Execute( image );
+    const std::vector<int64_t> start = expected.TransformPhysicalPointToIndex( cropped.GetOrigin() );
+    std::vector<int> index( start.begin(), start.end() );
+    EXPECT_LT( cropped.GetNumberOfPixels(), expected.GetNumberOfPixels() );
+    EXPECT_EQ( sitk::Hash( sitk::RegionOfInterest( expected, cropped.GetSize(), index ) ), sitk::Hash( cropped ) ) << "connectivity: " << c;
+
+    // the region as runs of a label map
+    connected.SetOutputMode( sitk::ConnectedThresholdImageFilter::RunLengthLabelMap );
+    sitk::Image labelMap = connected.Execute( image );
+    EXPECT_EQ( sitk::sitkLabelUInt8, labelMap.GetPixelID() );
+    EXPECT_EQ( sitk::Hash( expected ), sitk::Hash( sitk::LabelMapToLabel( labelMap ) ) ) << "connectivity: " << c;
+
+    // a bounded region is a part of the region
+    connected.SetOutputMode( sitk::ConnectedThresholdImageFilter::FullImage );
+    connected.SetMaximumNumberOfPixels( 500 );
+    sitk::Image bounded = connected.Execute( image );
+    EXPECT_EQ( expected.GetSize(), bounded.GetSize() );
+    unsigned int numberOfPixels = 0;
+    for ( unsigned int i = 0; i < bounded.GetNumberOfPixels(); ++i )
+      {
+      if ( bounded.GetBufferAsUInt8()[i] != 0 )
+        {
+        ++numberOfPixels;
+        EXPECT_EQ( 3u, expected.GetBufferAsUInt8()[i] );
+        }
+      }
+    EXPECT_EQ( 500u, numberOfPixels );
+    }
+}
+
+TEST(BasicFilters,N4BiasFieldShrinkFactor) {
+  namespace sitk = itk::simple;
+
+  // two tissues with a smooth multiplicative bias
+  sitk::Image image( 64, 48, sitk::sitkFloat32 );
+  image.SetSpacing( std::vector<double>( 2, 0.5 ) );
+  float *buffer = image.GetBufferAsFloat();
+  for ( unsigned int y = 0; y < 48; ++y )
+    {
+    for ( unsigned int x = 0; x < 64; ++x )
+      {
+      const float tissue = ( x / 8 + y / 8 ) % 2 ? 200.0f : 100.0f;
+      buffer[x + 64 * y] = tissue * std::exp( 0.005f * x + 0.002f * y );
+      }
+    }
+
+  sitk::N4BiasFieldCorrectionImageFilter n4;
+  EXPECT_ANY_THROW( n4.GetLogBiasFieldAsImage( image ) );
+  n4.SetMaximumNumberOfIterations( std::vector<uint32_t>( 2, 10 ) );
+  n4.SetShrinkFactor( 4 );
+  EXPECT_EQ( 4u, n4.GetShrinkFactor() );
+
+  sitk::Image corrected = n4.Execute( image );
+  ASSERT_EQ( image.GetSize(), corrected.GetSize() );
+  EXPECT_EQ( image.GetOrigin(), corrected.GetOrigin() );
+  EXPECT_EQ( image.GetSpacing(), corrected.GetSpacing() );
+
+  EXPECT_LT( 1u, n4.GetLogBiasFieldControlPointLattice().GetNumberOfPixels() );
+  sitk::Image logBiasField = n4.GetLogBiasFieldAsImage( image );
+  ASSERT_EQ( sitk::sitkFloat32, logBiasField.GetPixelID() );
+  ASSERT_EQ( image.GetSize(), logBiasField.GetSize() );
+  EXPECT_EQ( image.GetSpacing(), logBiasField.GetSpacing() );
+
+  // the output is the full resolution input corrected by the field
+  for ( unsigned int i = 0; i < image.GetNumberOfPixels(); ++i )
+    {
+    EXPECT_NEAR( buffer[i] / std::exp( logBiasField.GetBufferAsFloat()[i] ),
+                 corrected.GetBufferAsFloat()[i],
+                 1e-3 * buffer[i] ) << "pixel: " << i;
+    }
+}
+
+TEST(BasicFilters,BilateralGrid) {
+  namespace sitk = itk::simple;
+
+  // a step edge with a checkerboard noise of 10
+  sitk::Image image( 64, 40, sitk::sitkFloat32 );
+  float *buffer = image.GetBufferAsFloat();
+  for ( unsigned int y = 0; y < 40; ++y )
+    {
+    for ( unsigned int x = 0; x < 64; ++x )
+      {
+      buffer[x + 64 * y] = ( x < 32 ? 100.0f : 1000.0f ) + ( ( x + y ) % 2 ? 10.0f : -10.0f );
+      }
+    }
+
+  sitk::BilateralImageFilter bilateral;
+  EXPECT_EQ( sitk::BilateralImageFilter::Exact, bilateral.GetAlgorithm() );
+  bilateral.SetDomainSigma( 4.0 );
+  bilateral.SetRangeSigma( 50.0 );
+  bilateral.SetAlgorithm( sitk::BilateralImageFilter::BilateralGrid );
+  EXPECT_EQ( 1.0, bilateral.GetGridSamplingRate() );
+
+  sitk::Image output = bilateral.Execute( image );
+  ASSERT_EQ( image.GetSize(), output.GetSize() );
+  ASSERT_EQ( sitk::sitkFloat32, output.GetPixelID() );
+
+  // the noise is smoothed and the edge is preserved
+  for ( unsigned int y = 0; y < 40; ++y )
+    {
+    for ( unsigned int x = 0; x < 64; ++x )
+      {
+      const float expected = x < 32 ? 100.0f : 1000.0f;
+      EXPECT_NEAR( expected, output.GetBufferAsFloat()[x + 64 * y], 8.0 ) << "x: " << x << " y: " << y;
+      }
+    }
+
+  bilateral.SetGridSamplingRate( 2.0 );
+  sitk::Image finer = bilateral.Execute( image );
+  EXPECT_NEAR( 100.0, finer.GetBufferAsFloat()[10 + 64 * 20], 8.0 );
+  EXPECT_NEAR( 1000.0, finer.GetBufferAsFloat()[50 + 64 * 20], 8.0 );
+
+  // the output does not depend on the number of threads
+  bilateral.SetNumberOfThreads( 1 );
+  sitk::Image serial = bilateral.Execute( image );
+  bilateral.SetNumberOfThreads( 4 );
+  EXPECT_EQ( sitk::Hash( serial ), sitk::Hash( bilateral.Execute( image ) ) );
+
+  bilateral.SetGridSamplingRate( 0.0 );
+  EXPECT_ANY_THROW( bilateral.Execute( image ) );
+
+  // a grid of a cell per intensity unit over a range of 1e9
+  bilateral.SetGridSamplingRate( 1.0 );
+  bilateral.SetRangeSigma( 1.0 );
+  buffer[0] = 1e9f;
+  EXPECT_ANY_THROW( bilateral.Execute( image ) );
+}
+
+TEST(BasicFilters,PatchBasedDenoisingSampler) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image( 32, 32, sitk::sitkFloat32 );
+  float *buffer = image.GetBufferAsFloat();
+  for ( unsigned int i = 0; i < image.GetNumberOfPixels(); ++i )
+    {
+    buffer[i] = 100.0f + ( i % 7 ) * 5.0f;
+    }
+
+  sitk::PatchBasedDenoisingImageFilter denoising;
+  EXPECT_EQ( 0u, denoising.GetSampleRadius() );
+  EXPECT_EQ( sitk::PatchBasedDenoisingImageFilter::GaussianSampler, denoising.GetSampler() );
+  denoising.SetPatchRadius( 1 );
+  denoising.SetNumberOfSamplePatches( 20 );
+  denoising.SetSampleRadius( 4 );
+
+  sitk::Image gaussian = denoising.Execute( image );
+  EXPECT_EQ( image.GetSize(), gaussian.GetSize() );
+
+  denoising.SetSampler( sitk::PatchBasedDenoisingImageFilter::UniformSampler );
+  EXPECT_EQ( sitk::PatchBasedDenoisingImageFilter::UniformSampler, denoising.GetSampler() );
+  sitk::Image uniform = denoising.Execute( image );
+  ASSERT_EQ( image.GetSize(), uniform.GetSize() );
+  for ( unsigned int i = 0; i < uniform.GetNumberOfPixels(); ++i )
+    {
+    EXPECT_LE( 100.0f, uniform.GetBufferAsFloat()[i] );
+    EXPECT_GE( 130.0f, uniform.GetBufferAsFloat()[i] );
+    }
+}
+
+TEST(BasicFilters,AnisotropicDiffusionConvergenceTolerance) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image( 32, 32, sitk::sitkFloat32 );
+  float *buffer = image.GetBufferAsFloat();
+  for ( unsigned int i = 0; i < image.GetNumberOfPixels(); ++i )
+    {
+    buffer[i] = ( i % 32 < 16 ? 10.0f : 20.0f ) + ( i % 3 );
+    }
+
+  sitk::GradientAnisotropicDiffusionImageFilter diffusion;
+  EXPECT_EQ( 0.0, diffusion.GetConvergenceTolerance() );
+  diffusion.SetNumberOfIterations( 1 );
+  sitk::Image once = diffusion.Execute( image );
+
+  // the first update is smaller than the tolerance, so only one
+  // iteration is run
+  diffusion.SetNumberOfIterations( 50 );
+  diffusion.SetConvergenceTolerance( 1e6 );
+  sitk::Image converged = diffusion.Execute( image );
+  EXPECT_EQ( sitk::Hash( once ), sitk::Hash( converged ) );
+
+  diffusion.SetConvergenceTolerance( 0.0 );
+  sitk::Image all = diffusion.Execute( image );
+  EXPECT_NE( sitk::Hash( once ), sitk::Hash( all ) );
+
+  // in place the output takes the buffer of the input
+  sitk::Image inPlace = sitk::Image( image );
+  inPlace.MakeUnique();
+  diffusion.ExecuteInPlace( inPlace );
+  EXPECT_EQ( sitk::Hash( all ), sitk::Hash( inPlace ) );
+}
+
+TEST(BasicFilters,DeconvolutionContext) {
+  namespace sitk = itk::simple;
+
+  std::vector<sitk::Image> tiles;
+  for ( unsigned int t = 0; t < 3; ++t )
+    {
+    sitk::Image tile( 30, 20, sitk::sitkFloat32 );
+    for ( unsigned int i = 0; i < tile.GetNumberOfPixels(); ++i )
+      {
+      tile.GetBufferAsFloat()[i] = 10.0f + ( ( i + t ) % 5 );
+      }
+    tiles.push_back( tile );
+    }
+
+  sitk::DeconvolutionContext deconvolution;
+  EXPECT_EQ( sitk::DeconvolutionContext::Wiener, deconvolution.GetAlgorithm() );
+  EXPECT_ANY_THROW( deconvolution.Execute( tiles[0] ) );
+
+  // the deconvolution with an impulse is the identity
+  sitk::Image impulse( 1, 1, sitk::sitkFloat32 );
+  impulse.GetBufferAsFloat()[0] = 1.0f;
+  deconvolution.SetAlgorithm( sitk::DeconvolutionContext::Tikhonov );
+  deconvolution.SetKernelImage( impulse );
+  sitk::Image identity = deconvolution.Execute( tiles[0] );
+  ASSERT_EQ( tiles[0].GetSize(), identity.GetSize() );
+  for ( unsigned int i = 0; i < identity.GetNumberOfPixels(); ++i )
+    {
+    EXPECT_NEAR( tiles[0].GetBufferAsFloat()[i], identity.GetBufferAsFloat()[i], 1e-3 ) << "pixel: " << i;
+    }
+
+  // a batch uses the kernel transform of the tile size
+  sitk::Image kernel( 5, 3, sitk::sitkFloat32 );
+  std::fill( kernel.GetBufferAsFloat(), kernel.GetBufferAsFloat() + kernel.GetNumberOfPixels(), 1.0f );
+  kernel.GetBufferAsFloat()[7] = 4.0f;
+  deconvolution.SetKernelImage( kernel );
+  deconvolution.SetNormalize( true );
+  deconvolution.SetAlgorithm( sitk::DeconvolutionContext::RichardsonLucy );
+  deconvolution.SetNumberOfIterations( 3 );
+  EXPECT_TRUE( deconvolution.GetPaddedSize().empty() );
+
+  std::vector<sitk::Image> batch = deconvolution.Execute( tiles );
+  ASSERT_EQ( tiles.size(), batch.size() );
+  ASSERT_EQ( 2u, deconvolution.GetPaddedSize().size() );
+  EXPECT_LE( 34u, deconvolution.GetPaddedSize()[0] );
+  EXPECT_LE( 22u, deconvolution.GetPaddedSize()[1] );
+  for ( unsigned int t = 0; t < tiles.size(); ++t )
+    {
+    EXPECT_EQ( sitk::Hash( deconvolution.Execute( tiles[t] ) ), sitk::Hash( batch[t] ) );
+    }
+
+  // the output has the pixel type of the input
+  sitk::Image integerTile = sitk::Cast( tiles[1], sitk::sitkUInt16 );
+  EXPECT_EQ( sitk::sitkUInt16, deconvolution.Execute( integerTile ).GetPixelID() );
+
+  tiles.push_back( sitk::Image( 10, 10, sitk::sitkFloat32 ) );
+  EXPECT_ANY_THROW( deconvolution.Execute( tiles ) );
+}
+
+TEST(BasicFilters,NormalizedCorrelationMatcher) {
+  namespace sitk = itk::simple;
+
+  sitk::Image fixed( 32, 24, sitk::sitkFloat32 );
+  for ( unsigned int i = 0; i < fixed.GetNumberOfPixels(); ++i )
+    {
+    fixed.GetBufferAsFloat()[i] = static_cast<float>( ( i * 7919u ) % 101u );
+    }
+
+  // templates cut from the fixed image
+  const unsigned int offsets[3][2] = { { 5, 4 }, { 20, 11 }, { 9, 15 } };
+  const unsigned int sizes[3][2] = { { 6, 5 }, { 8, 7 }, { 4, 4 } };
+  std::vector<sitk::Image> templates;
+  for ( unsigned int t = 0; t < 3; ++t )
+    {
+    sitk::Image movingImage( sizes[t][0], sizes[t][1], sitk::sitkFloat32 );
+    for ( unsigned int y = 0; y < sizes[t][1]; ++y )
+      {
+      for ( unsigned int x = 0; x < sizes[t][0]; ++x )
+        {
+        movingImage.GetBufferAsFloat()[y * sizes[t][0] + x] =
+          fixed.GetBufferAsFloat()[( y + offsets[t][1] ) * 32 + x + offsets[t][0]];
+        }
+      }
+    templates.push_back( movingImage );
+    }
+
+  sitk::NormalizedCorrelationMatcher matcher;
+  EXPECT_ANY_THROW( matcher.Execute( templates[0] ) );
+  matcher.SetFixedImage( fixed );
+  EXPECT_TRUE( matcher.GetPaddedSize().empty() );
+
+  // the peak places the first pixel of the template at its offset
+  for ( unsigned int t = 0; t < 3; ++t )
+    {
+    std::vector< std::vector<unsigned int> > peaks = matcher.FindPeaks( templates[t], 2 );
+    ASSERT_EQ( 2u, peaks.size() );
+    ASSERT_EQ( 2u, matcher.GetPeakValues().size() );
+    EXPECT_EQ( offsets[t][0] + sizes[t][0] - 1, peaks[0][0] );
+    EXPECT_EQ( offsets[t][1] + sizes[t][1] - 1, peaks[0][1] );
+    EXPECT_NEAR( 1.0, matcher.GetPeakValues()[0], 1e-6 );
+    EXPECT_LT( matcher.GetPeakValues()[1], matcher.GetPeakValues()[0] );
+    }
+
+  // the batch caches the fixed transforms for the largest template
+  matcher.SetFixedImage( fixed );
+  std::vector<sitk::Image> batch = matcher.Execute( templates );
+  ASSERT_EQ( templates.size(), batch.size() );
+  const std::vector<unsigned int> paddedSize = matcher.GetPaddedSize();
+  ASSERT_EQ( 2u, paddedSize.size() );
+  EXPECT_LE( 39u, paddedSize[0] );
+  EXPECT_LE( 30u, paddedSize[1] );
+  for ( unsigned int t = 0; t < templates.size(); ++t )
+    {
+    EXPECT_EQ( sitk::sitkFloat64, batch[t].GetPixelID() );
+    EXPECT_EQ( 32u + sizes[t][0] - 1, batch[t].GetSize()[0] );
+    EXPECT_EQ( 24u + sizes[t][1] - 1, batch[t].GetSize()[1] );
+    sitk::Image correlation = matcher.Execute( templates[t] );
+    EXPECT_EQ( paddedSize, matcher.GetPaddedSize() );
+    for ( unsigned int i = 0; i < correlation.GetNumberOfPixels(); ++i )
+      {
+      EXPECT_NEAR( batch[t].GetBufferAsDouble()[i], correlation.GetBufferAsDouble()[i], 1e-9 ) << "pixel: " << i;
+      }
+    }
+
+  // the origin is the point of the first pixel of the template
+  EXPECT_EQ( -5.0, batch[0].GetOrigin()[0] );
+  EXPECT_EQ( -4.0, batch[0].GetOrigin()[1] );
+
+  EXPECT_ANY_THROW( matcher.Execute( sitk::Image( 4, 4, 4, sitk::sitkFloat32 ) ) );
+  EXPECT_ANY_THROW( matcher.Execute( templates[0], sitk::Image( 2, 2, sitk::sitkUInt8 ) ) );
+}
+
+TEST(BasicFilters,ScalarImageKmeansLloyd) {
+  namespace sitk = itk::simple;
+
+  // three intensity modes
+  sitk::Image image( 64, 48, sitk::sitkUInt8 );
+  for ( unsigned int i = 0; i < image.GetNumberOfPixels(); ++i )
+    {
+    image.GetBufferAsUInt8()[i] = static_cast<uint8_t>( 40 * ( i % 3 ) + 20 + ( i * 7 ) % 9 );
+    }
+
+  std::vector<double> initialMeans;
+  initialMeans.push_back( 10.0 );
+  initialMeans.push_back( 50.0 );
+  initialMeans.push_back( 120.0 );
+
+  sitk::ScalarImageKmeansImageFilter filter;
+  EXPECT_EQ( sitk::ScalarImageKmeansImageFilter::KdTree, filter.GetAlgorithm() );
+  filter.SetClassWithInitialMean( initialMeans );
+  sitk::Image kdTree = filter.Execute( image );
+  const std::vector<double> kdTreeMeans = filter.GetFinalMeans();
+
+  // the histogram of the integer pixels gives the same means
+  filter.SetAlgorithm( sitk::ScalarImageKmeansImageFilter::Lloyd );
+  sitk::Image lloyd = filter.Execute( image );
+  ASSERT_EQ( 3u, filter.GetFinalMeans().size() );
+  for ( unsigned int k = 0; k < 3; ++k )
+    {
+    EXPECT_NEAR( kdTreeMeans[k], filter.GetFinalMeans()[k], 1e-6 );
+    }
+  EXPECT_EQ( sitk::Hash( kdTree ), sitk::Hash( lloyd ) );
+
+  // all the pixels and a sample of them of a float image
+  sitk::Image floatImage = sitk::Cast( image, sitk::sitkFloat32 );
+  EXPECT_EQ( sitk::Hash( kdTree ), sitk::Hash( filter.Execute( floatImage ) ) );
+  for ( unsigned int k = 0; k < 3; ++k )
+    {
+    EXPECT_NEAR( kdTreeMeans[k], filter.GetFinalMeans()[k], 1e-6 );
+    }
+  filter.SetNumberOfSamples( 500u );
+  EXPECT_EQ( sitk::Hash( kdTree ), sitk::Hash( filter.Execute( floatImage ) ) );
+  for ( unsigned int k = 0; k < 3; ++k )
+    {
+    EXPECT_NEAR( kdTreeMeans[k], filter.GetFinalMeans()[k], 1.0 );
+    }
+}
+
+TEST(BasicFilters,ScalarToRGBColormapLookupTable) {
+  namespace sitk = itk::simple;
+
+  // a ramp of the 8 bit values
+  sitk::Image image( 64, 64, sitk::sitkUInt8 );
+  for ( unsigned int i = 0; i < 64u*64u; ++i )
+    {
+    image.GetBufferAsUInt8()[i] = static_cast<uint8_t>( i % 256 );
+    }
+
+  sitk::ScalarToRGBColormapImageFilter filter;
+  filter.SetColormap( sitk::ScalarToRGBColormapImageFilter::Hot );
+
+  // the table of the integer types gives the colors of the functor
+  const std::string expected = sitk::Hash( filter.Execute( sitk::Cast( image, sitk::sitkFloat32 ) ) );
+  EXPECT_EQ( expected, sitk::Hash( filter.Execute( image ) ) );
+  EXPECT_EQ( expected, sitk::Hash( filter.Execute( sitk::Cast( image, sitk::sitkUInt16 ) ) ) );
+
+  // the window is applied with the colormap
+  sitk::ClampImageFilter clamp;
+  clamp.SetLowerBound( 50.0 );
+  clamp.SetUpperBound( 100.0 );
+  const std::string expectedWindow = sitk::Hash( filter.Execute( clamp.Execute( image ) ) );
+
+  EXPECT_EQ( 0.0, filter.GetWindowMinimum() );
+  EXPECT_EQ( 255.0, filter.GetWindowMaximum() );
+  filter.UseInputImageExtremaForScalingOff();
+  filter.SetWindowMinimum( 50.0 );
+  filter.SetWindowMaximum( 100.0 );
+  EXPECT_EQ( expectedWindow, sitk::Hash( filter.Execute( image ) ) );
+  EXPECT_EQ( expectedWindow, sitk::Hash( filter.Execute( sitk::Cast( image, sitk::sitkFloat32 ) ) ) );
+
+  // the fractional bounds are rounded for the integer types
+  filter.SetWindowMinimum( 49.6 );
+  filter.SetWindowMaximum( 100.4 );
+  EXPECT_EQ( expectedWindow, sitk::Hash( filter.Execute( image ) ) );
+
+  // the bounds beyond the pixel type are clamped to its range
+  filter.SetWindowMinimum( 0.0 );
+  filter.SetWindowMaximum( 255.0 );
+  const std::string expectedRange = sitk::Hash( filter.Execute( image ) );
+  filter.SetWindowMinimum( -10.0 );
+  filter.SetWindowMaximum( 300.0 );
+  EXPECT_EQ( expectedRange, sitk::Hash( filter.Execute( image ) ) );
+  filter.SetWindowMinimum( -1e20 );
+  filter.SetWindowMaximum( 1e20 );
+  EXPECT_EQ( expectedRange, sitk::Hash( filter.Execute( image ) ) );
+}
+
+TEST(BasicFilters,MultiResolutionDemonsRegistration) {
+  namespace sitk = itk::simple;
+
+  sitk::Image fixed = sitk::ReadImage( dataFinder.GetFile( "Input/BrainProtonDensitySliceBorder20.png" ) );
+  sitk::Image moving = sitk::ReadImage( dataFinder.GetFile( "Input/BrainProtonDensitySliceBSplined10.png" ) );
+
+  sitk::MultiResolutionDemonsRegistrationFilter filter;
+
+  EXPECT_EQ ( "MultiResolutionDemonsRegistrationFilter", filter.GetName() );
+  EXPECT_EQ ( sitk::MultiResolutionDemonsRegistrationFilter::Demons, filter.GetDemonsType() );
+  EXPECT_EQ ( 3u, filter.GetNumberOfLevels() );
+
+  filter.SetDemonsType( sitk::MultiResolutionDemonsRegistrationFilter::FastSymmetricForces );
+  filter.SetNumberOfLevels( 2 );
+  std::vector<uint32_t> numberOfIterations;
+  numberOfIterations.push_back( 20 );
+  numberOfIterations.push_back( 10 );
+  filter.SetNumberOfIterations( numberOfIterations );
+  filter.SetStandardDeviations( 1.5 );
+
+  sitk::Image field = filter.Execute( fixed, moving );
+  EXPECT_EQ ( sitk::sitkVectorFloat64, field.GetPixelID() );
+  EXPECT_EQ ( fixed.GetSize(), field.GetSize() );
+  EXPECT_EQ ( fixed.GetSpacing(), field.GetSpacing() );
+  EXPECT_EQ ( 1u, filter.GetCurrentLevel() );
+  EXPECT_LE ( filter.GetElapsedIterations(), 10u );
+  EXPECT_LT ( 0.0, filter.GetMetric() );
+  EXPECT_NO_THROW ( filter.ToString() );
+
+  // continue from the computed field
+  filter.SetNumberOfIterations( 10u );
+  sitk::Image refinedField = filter.Execute( fixed, moving, field );
+  EXPECT_EQ ( fixed.GetSize(), refinedField.GetSize() );
+  EXPECT_LT ( 0.0, filter.GetMetric() );
+
+  // the iterations are per level
+  filter.SetNumberOfLevels( 3 );
+  filter.SetNumberOfIterations( numberOfIterations );
+  EXPECT_THROW ( filter.Execute( fixed, moving ), sitk::GenericException );
+}
+
+TEST(BasicFilters,Cast_Commands) {
+  // test cast filter with a bunch of commands
+
+  namespace sitk = itk::simple;
+  sitk::Image img = sitk::ReadImage( dataFinder.GetFile ( "Input/RA-Short.nrrd" ) );
+  EXPECT_EQ ( "a963bd6a755b853103a2d195e01a50d3", sitk::Hash(img, sitk::HashImageFilter::MD5));
+
+  sitk::CastImageFilter caster;
+  caster.SetOutputPixelType( sitk::sitkInt32 );
+
+  ProgressUpdate progressCmd(caster);
+  caster.AddCommand(sitk::sitkProgressEvent, progressCmd);
+
+  CountCommand abortCmd(caster);
+  caster.AddCommand(sitk::sitkAbortEvent, abortCmd);
+
+  CountCommand deleteCmd(caster);
+  caster.AddCommand(sitk::sitkDeleteEvent, deleteCmd);
+
+  CountCommand endCmd(caster);
+  caster.AddCommand(sitk::sitkEndEvent, endCmd);
+
+  CountCommand iterCmd(caster);
+  caster.AddCommand(sitk::sitkIterationEvent, iterCmd);
+
+  CountCommand startCmd(caster);
+  caster.AddCommand(sitk::sitkStartEvent, startCmd);
+
+  CountCommand userCmd(caster);
+  caster.AddCommand(sitk::sitkUserEvent, userCmd);
+
+
+  sitk::Image out = caster.Execute(img);
+  EXPECT_EQ ( "6ceea0011178a955b5be2d545d107199", sitk::Hash(out, sitk::HashImageFilter::MD5));
+
+  EXPECT_EQ ( 1.0f, caster.GetProgress() );
+  EXPECT_EQ ( 1.0f, progressCmd.m_Progress );
+  EXPECT_EQ ( 0, abortCmd.m_Count );
+  EXPECT_EQ ( 1, deleteCmd.m_Count );
+  EXPECT_EQ ( 1, endCmd.m_Count );
+  EXPECT_EQ ( 0, iterCmd.m_Count );
+  EXPECT_EQ ( 1, startCmd.m_Count );
+  EXPECT_EQ ( 0, userCmd.m_Count );
+
+}
+
+TEST(BasicFilters,Statistics_Abort) {
+  // test Statistics filter with a bunch of commands
+
+  namespace sitk = itk::simple;
+  sitk::Image img = sitk::ReadImage( dataFinder.GetFile ( "Input/RA-Short.nrrd" ) );
+  EXPECT_EQ ( "a963bd6a755b853103a2d195e01a50d3", sitk::Hash(img, sitk::HashImageFilter::MD5));
+
+  sitk::StatisticsImageFilter stats;
+  stats.SetNumberOfThreads(1);
+
+  AbortAtCommand progressCmd(stats,.05);
+  stats.AddCommand(sitk::sitkProgressEvent, progressCmd);
+
+  CountCommand abortCmd(stats);
+  stats.AddCommand(sitk::sitkAbortEvent, abortCmd);
+
+  CountCommand deleteCmd(stats);
+  stats.AddCommand(sitk::sitkDeleteEvent, deleteCmd);
+
+  CountCommand endCmd(stats);
+  stats.AddCommand(sitk::sitkEndEvent, endCmd);
+
+  CountCommand iterCmd(stats);
+  stats.AddCommand(sitk::sitkIterationEvent, iterCmd);
+
+  CountCommand startCmd(stats);
+  stats.AddCommand(sitk::sitkStartEvent, startCmd);
+
+  CountCommand userCmd(stats);
+  stats.AddCommand(sitk::sitkUserEvent, userCmd);
+
+  EXPECT_ANY_THROW( stats.Execute(img) );
+
+  EXPECT_EQ ( 1, abortCmd.m_Count );
+  EXPECT_EQ ( 1, deleteCmd.m_Count );
+  EXPECT_EQ ( 0, endCmd.m_Count );
+  EXPECT_EQ ( 0, iterCmd.m_Count );
+  EXPECT_EQ ( 1, startCmd.m_Count );
+  EXPECT_EQ ( 0, userCmd.m_Count );
+
+}
+
+TEST(BasicFilters,ResampleImageFilter_AdditionalProcedures)
+{
+  namespace sitk = itk::simple;
+
+  sitk::Image img;
+  ASSERT_NO_THROW( img = sitk::ReadImage( dataFinder.GetFile ( "Input/RA-Float.nrrd" ) ) ) << "Reading input Image.";
+
+  sitk::Transform xf = sitk::Transform(); // identity transform
+
+  // self reference image
+   sitk::Image out = sitk::Resample( img,
+                                     xf,
+                                     sitk::sitkNearestNeighbor );
+  EXPECT_EQ( "b187541bdcc89843d0a25a3761f344c358f3518a", sitk::Hash( out )) << " Procedural Interface 1 identity transform.";
+
+  // additional parameter reference image
+   out = sitk::Resample( img,
+                         img,
+                         xf,
+                         sitk::sitkNearestNeighbor );
+  EXPECT_EQ( "b187541bdcc89843d0a25a3761f344c358f3518a", sitk::Hash( out )) << " Procedural Interface 2 identity transform.";
+
+  // manual specification of output domain
+ out = sitk::Resample( img,
+                       img.GetSize(),
+                       xf,
+                       sitk::sitkNearestNeighbor,
+                       img.GetOrigin(),
+                       img.GetSpacing(),
+                       img.GetDirection() );
+  EXPECT_EQ( "b187541bdcc89843d0a25a3761f344c358f3518a", sitk::Hash( out )) << " Procedural Interface 3 identity transform.";
+}
+
+
+TEST(BasicFilters,EvaluateAtPhysicalPoints)
+{
+  namespace sitk = itk::simple;
+
+  sitk::Image img( 20, 10, sitk::sitkFloat32 );
+  img.SetSpacing( v2( 0.5, 2.0 ) );
+  img.SetOrigin( v2( -1.0, 3.0 ) );
+  for ( unsigned int j = 0; j < 10u; ++j )
+    {
+    for ( unsigned int i = 0; i < 20u; ++i )
+      {
+      std::vector<uint32_t> idx(2);
+      idx[0] = i;
+      idx[1] = j;
+      img.SetPixelAsFloat( idx, static_cast<float>( 2*i + 3*j ) );
+      }
+    }
+
+  // enough points to be split across threads
+  std::vector<double> points;
+  for ( unsigned int k = 0; k < 5000u; ++k )
+    {
+    const std::vector<double> pt = img.TransformContinuousIndexToPhysicalPoint( v2( 0.001*(k%19000), 0.25*(k%36) ) );
+    points.insert( points.end(), pt.begin(), pt.end() );
+    }
+  points.push_back( -100.0 );
+  points.push_back( 0.0 );
+
+  std::vector<double> values;
+  ASSERT_NO_THROW( values = sitk::EvaluateAtPhysicalPoints( img, points, sitk::sitkLinear, -1.0 ) );
+  ASSERT_EQ( 5001u, values.size() );
+  for ( unsigned int k = 0; k < 5000u; ++k )
+    {
+    EXPECT_NEAR( 2.0*0.001*(k%19000) + 3.0*0.25*(k%36), values[k], 1e-4 ) << " point " << k;
+    }
+  EXPECT_EQ( -1.0, values[5000] );
+
+  // the BSpline reproduces the linear ramp away from the boundary
+  ASSERT_NO_THROW( values = sitk::EvaluateAtPhysicalPoints( img, points, sitk::sitkBSpline ) );
+  ASSERT_EQ( 5001u, values.size() );
+  for ( unsigned int k = 0; k < 5000u; ++k )
+    {
+    const double x = 0.001*(k%19000);
+    const double y = 0.25*(k%36);
+    if ( x > 4.0 && x < 15.0 && y > 4.0 && y < 5.0 )
+      {
+      EXPECT_NEAR( 2.0*x + 3.0*y, values[k], 1e-3 ) << " point " << k;
+      }
+    }
+  EXPECT_EQ( 0.0, values[5000] );
+
+  ASSERT_NO_THROW( values = sitk::EvaluateAtPhysicalPoints( img, img.TransformContinuousIndexToPhysicalPoint( v2( 3.0, 4.0 ) ), sitk::sitkNearestNeighbor ) );
+  ASSERT_EQ( 1u, values.size() );
+  EXPECT_EQ( 18.0, values[0] );
+
+  // vector images return the components of each point contiguously
+  sitk::Image constant = sitk::Add( sitk::Image( img.GetSize(), sitk::sitkFloat32 ), 7.0 );
+  constant.CopyInformation( img );
+  sitk::Image vimg = sitk::Compose( img, constant );
+  ASSERT_NO_THROW( values = sitk::EvaluateAtPhysicalPoints( vimg, img.TransformContinuousIndexToPhysicalPoint( v2( 1.5, 2.0 ) ) ) );
+  ASSERT_EQ( 2u, values.size() );
+  EXPECT_NEAR( 9.0, values[0], 1e-6 );
+  EXPECT_NEAR( 7.0, values[1], 1e-6 );
+
+  EXPECT_THROW( sitk::EvaluateAtPhysicalPoints( img, std::vector<double>( 3, 0.0 ) ), sitk::GenericException );
+  EXPECT_TRUE( sitk::EvaluateAtPhysicalPoints( img, std::vector<double>() ).empty() );
+}
+
+
+TEST(BasicFilters,OtsuThreshold_CheckNamesInputCompatibility)
+{
+  namespace sitk = itk::simple;
+
+  sitk::Image input(10,10,sitk::sitkFloat32);
+  sitk::Image mask1(10,10,10,sitk::sitkUInt8);
+  sitk::Image mask2(11,10,sitk::sitkUInt8);
+
+  // check that if the dimension or size does not match an exception
+  // is thrown.
+  EXPECT_THROW( sitk::OtsuThreshold(input, mask1), sitk::GenericException );
+  EXPECT_THROW( sitk::OtsuThreshold(input, mask2), sitk::GenericException );
+}
+
+
+TEST(BasicFilters,FFTConfiguration)
+{
+  namespace sitk = itk::simple;
+
+  sitk::Image image( 32, 16, sitk::sitkFloat32 );
+  image.SetPixelAsFloat( std::vector<uint32_t>( 2, 5u ), 1.0f );
+
+  const sitk::FFTConfiguration::FFTBackendType backend = sitk::FFTConfiguration::GetBackend();
+  if ( sitk::FFTConfiguration::HasFFTW() )
+    {
+    EXPECT_EQ( sitk::FFTConfiguration::FFTW, backend );
+    }
+  else
+    {
+    EXPECT_EQ( sitk::FFTConfiguration::VNL, backend );
+    EXPECT_THROW( sitk::FFTConfiguration::SetBackend( sitk::FFTConfiguration::FFTW ), sitk::GenericException );
+    EXPECT_THROW( sitk::FFTConfiguration::SetPlanRigor( "FFTW_MEASURE" ), sitk::GenericException );
+    }
+
+  sitk::Image fftw = sitk::InverseFFT( sitk::ForwardFFT( image ) );
+
+  sitk::FFTConfiguration::SetBackend( sitk::FFTConfiguration::VNL );
+  EXPECT_EQ( sitk::FFTConfiguration::VNL, sitk::FFTConfiguration::GetBackend() );
+  sitk::Image vnl = sitk::InverseFFT( sitk::ForwardFFT( image ) );
+  EXPECT_NEAR( 1.0, vnl.GetPixelAsFloat( std::vector<uint32_t>( 2, 5u ) ), 1e-5 );
+  EXPECT_NEAR( fftw.GetPixelAsFloat( std::vector<uint32_t>( 2, 5u ) ),
+               vnl.GetPixelAsFloat( std::vector<uint32_t>( 2, 5u ) ), 1e-5 );
+
+  if ( sitk::FFTConfiguration::HasFFTW() )
+    {
+    sitk::FFTConfiguration::SetBackend( sitk::FFTConfiguration::FFTW );
+    EXPECT_EQ( sitk::FFTConfiguration::FFTW, sitk::FFTConfiguration::GetBackend() );
+
+    const std::string planRigor = sitk::FFTConfiguration::GetPlanRigor();
+    sitk::FFTConfiguration::SetPlanRigor( "FFTW_ESTIMATE" );
+    EXPECT_EQ( "FFTW_ESTIMATE", sitk::FFTConfiguration::GetPlanRigor() );
+    EXPECT_THROW( sitk::FFTConfiguration::SetPlanRigor( "FFTW_FAST" ), sitk::GenericException );
+    sitk::FFTConfiguration::SetPlanRigor( planRigor );
+    }
+}
+
+
+TEST(BasicFilters,Convolve)
+{
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/cthead1-Float.mha" ) );
+
+  // a separable box kernel and a non separable kernel
+  sitk::Image box( 5, 3, sitk::sitkFloat32 );
+  std::fill( box.GetBufferAsFloat(), box.GetBufferAsFloat() + box.GetNumberOfPixels(), 2.0f );
+  sitk::Image cross( 3, 3, sitk::sitkFloat32 );
+  cross.GetBufferAsFloat()[1] = cross.GetBufferAsFloat()[3] = cross.GetBufferAsFloat()[4] = 1.0f;
+  cross.GetBufferAsFloat()[5] = cross.GetBufferAsFloat()[7] = 1.0f;
+
+  EXPECT_EQ( sitk::sitkConvolutionSpatial, sitk::SelectConvolutionMode( image, cross ) );
+  EXPECT_THROW( sitk::Convolve( image, cross, false,
+                                sitk::ConvolutionImageFilter::ZERO_PAD,
+                                sitk::ConvolutionImageFilter::SAME,
+                                sitk::sitkConvolutionSeparable ), sitk::GenericException );
+  EXPECT_THROW( sitk::Convolve( image, sitk::Cast( box, sitk::sitkFloat64 ) ), sitk::GenericException );
+
+  const sitk::ConvolutionModeEnum modes[] = { sitk::sitkConvolutionAuto,
+                                              sitk::sitkConvolutionSeparable,
+                                              sitk::sitkConvolutionFFT };
+  for ( unsigned int bc = 0; bc < 3; ++bc )
+    {
+    for ( unsigned int orm = 0; orm < 2; ++orm )
+      {
+      sitk::ConvolutionImageFilter::BoundaryConditionType boundaryCondition = sitk::ConvolutionImageFilter::BoundaryConditionType( bc );
+      sitk::ConvolutionImageFilter::OutputRegionModeType outputRegionMode = sitk::ConvolutionImageFilter::OutputRegionModeType( orm );
+      sitk::Image expected = sitk::Convolve( image, box, true, boundaryCondition, outputRegionMode, sitk::sitkConvolutionSpatial );
+
+      for ( unsigned int m = 0; m < sizeof(modes)/sizeof(modes[0]); ++m )
+        {
+        sitk::Image result = sitk::Convolve( image, box, true, boundaryCondition, outputRegionMode, modes[m] );
+        EXPECT_EQ( expected.GetSize(), result.GetSize() ) << "mode: " << modes[m];
+        EXPECT_VECTOR_DOUBLE_NEAR( expected.GetOrigin(), result.GetOrigin(), 1e-8 );
+        double maximumDifference = 0.0;
+        for ( uint64_t i = 0; i < expected.GetNumberOfPixels() && i < result.GetNumberOfPixels(); ++i )
+          {
+          maximumDifference = std::max( maximumDifference,
+                                        double( std::abs( expected.GetBufferAsFloat()[i] - result.GetBufferAsFloat()[i] ) ) );
+          }
+        EXPECT_NEAR( 0.0, maximumDifference, 1e-2 ) << "mode: " << modes[m];
+        }
+      }
+    }
+}
+
+
+TEST(BasicFilters,KernelLineDecomposition)
+{
+  namespace sitk = itk::simple;
+
+  std::vector<uint32_t> radius( 2, 1 );
+  radius[0] = 2;
+
+  // the box and the cross of a single pixel
+  sitk::Image point( 11, 11, sitk::sitkUInt8 );
+  point.SetPixelAsUInt8( std::vector<uint32_t>( 2, 5 ), 1 );
+
+  sitk::Image box = sitk::BinaryDilate( point, radius, sitk::sitkBox, 0.0, 1.0 );
+  std::vector<uint32_t> corner( 2, 6 );
+  corner[0] = 7;
+  EXPECT_EQ( 15, std::count( box.GetBufferAsUInt8(), box.GetBufferAsUInt8() + box.GetNumberOfPixels(), 1 ) );
+  EXPECT_EQ( 1u, box.GetPixelAsUInt8( corner ) );
+  sitk::Image eroded = sitk::BinaryErode( box, radius, sitk::sitkBox, 0.0, 1.0 );
+  EXPECT_EQ( sitk::Hash( point ), sitk::Hash( eroded ) );
+
+  sitk::Image cross = sitk::GrayscaleDilate( point, radius, sitk::sitkCross );
+  EXPECT_EQ( 7, std::count( cross.GetBufferAsUInt8(), cross.GetBufferAsUInt8() + cross.GetNumberOfPixels(), 1 ) );
+  sitk::Image background = sitk::GrayscaleErode( sitk::BinaryThreshold( point, 0, 0, 1, 0 ), radius, sitk::sitkCross );
+  EXPECT_EQ( sitk::Hash( cross ), sitk::Hash( sitk::BinaryThreshold( background, 0, 0, 1, 0 ) ) );
+
+  // a separable kernel with the spatial and FFT convolutions
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/cthead1-Float.mha" ) );
+  sitk::Image kernel( 5, 3, sitk::sitkFloat32 );
+  for ( unsigned int j = 0; j < 3; ++j )
+    {
+    for ( unsigned int i = 0; i < 5; ++i )
+      {
+      kernel.GetBufferAsFloat()[i + 5 * j] = float( ( i + 1 ) * ( j + 2 ) );
+      }
+    }
+
+  for ( unsigned int orm = 0; orm < 2; ++orm )
+    {
+    sitk::ConvolutionImageFilter convolution;
+    convolution.SetOutputRegionMode( sitk::ConvolutionImageFilter::OutputRegionModeType( orm ) );
+    convolution.NormalizeOn();
+    sitk::FFTConvolutionImageFilter fftConvolution;
+    fftConvolution.SetOutputRegionMode( sitk::FFTConvolutionImageFilter::OutputRegionModeType( orm ) );
+    fftConvolution.NormalizeOn();
+
+    sitk::Image result = convolution.Execute( image, kernel );
+    sitk::Image expected = fftConvolution.Execute( image, kernel );
+    ASSERT_EQ( expected.GetSize(), result.GetSize() );
+    EXPECT_VECTOR_DOUBLE_NEAR( expected.GetOrigin(), result.GetOrigin(), 1e-8 );
+    double maximumDifference = 0.0;
+    for ( uint64_t i = 0; i < expected.GetNumberOfPixels(); ++i )
+      {
+      maximumDifference = std::max( maximumDifference,
+                                    double( std::abs( expected.GetBufferAsFloat()[i] - result.GetBufferAsFloat()[i] ) ) );
+      }
+    EXPECT_NEAR( 0.0, maximumDifference, 1e-2 ) << "output region mode: " << orm;
+    }
+}
+
+
+TEST(BasicFilters,GrayscaleMorphologyAlgorithm)
+{
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/STAPLE1.png" ) );
+
+  sitk::GrayscaleDilateImageFilter dilate;
+  EXPECT_EQ( sitk::GrayscaleDilateImageFilter::AUTO, dilate.GetAlgorithm() );
+  dilate.SetKernelType( sitk::sitkBox );
+  dilate.SetKernelRadius( 7 );
+  const std::string expected = sitk::Hash( dilate.Execute( image ) );
+
+  // the algorithms compute the same dilation with a decomposable kernel
+  const sitk::GrayscaleDilateImageFilter::AlgorithmType algorithms[] = { sitk::GrayscaleDilateImageFilter::BASIC,
+                                                                         sitk::GrayscaleDilateImageFilter::HISTO,
+                                                                         sitk::GrayscaleDilateImageFilter::ANCHOR,
+                                                                         sitk::GrayscaleDilateImageFilter::VHGW };
+  for ( unsigned int i = 0; i < sizeof(algorithms)/sizeof(algorithms[0]); ++i )
+    {
+    dilate.SetAlgorithm( algorithms[i] );
+    EXPECT_EQ( expected, sitk::Hash( dilate.Execute( image ) ) ) << "algorithm: " << algorithms[i];
+    }
+  EXPECT_EQ( expected, sitk::Hash( sitk::GrayscaleDilate( image, 7, sitk::sitkBox, sitk::GrayscaleDilateImageFilter::VHGW ) ) );
+
+  // the ball is not decomposable
+  dilate.SetKernelType( sitk::sitkBall );
+  dilate.SetAlgorithm( sitk::GrayscaleDilateImageFilter::VHGW );
+  EXPECT_ANY_THROW( dilate.Execute( image ) );
+
+  sitk::GrayscaleMorphologicalOpeningImageFilter opening;
+  opening.SetKernelType( sitk::sitkBox );
+  opening.SetKernelRadius( 5 );
+  const std::string expectedOpening = sitk::Hash( opening.Execute( image ) );
+  opening.SetAlgorithm( sitk::GrayscaleMorphologicalOpeningImageFilter::VHGW );
+  EXPECT_EQ( expectedOpening, sitk::Hash( opening.Execute( image ) ) );
+  opening.SetAlgorithm( sitk::GrayscaleMorphologicalOpeningImageFilter::HISTO );
+  EXPECT_EQ( expectedOpening, sitk::Hash( opening.Execute( image ) ) );
+}
+
+
+TEST(BasicFilters,ConnectedComponent_CompactOutput)
+{
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/WhiteDots.png" ) );
+
+  sitk::ConnectedComponentImageFilter connected;
+  EXPECT_TRUE( connected.GetUseUnionFind() );
+  EXPECT_FALSE( connected.GetCompactOutput() );
+  sitk::Image labels = connected.Execute( image );
+  EXPECT_EQ( sitk::sitkUInt32, labels.GetPixelID() );
+  EXPECT_EQ( 23u, connected.GetObjectCount() );
+
+  // the union-find labels are those of the ConnectedComponentImageFilter
+  connected.UseUnionFindOff();
+  EXPECT_EQ( sitk::Hash( labels ), sitk::Hash( connected.Execute( image ) ) );
+
+  // the few labels fit in 8 bits
+  connected.UseUnionFindOn();
+  connected.CompactOutputOn();
+  sitk::Image compactLabels = connected.Execute( image );
+  EXPECT_EQ( sitk::sitkUInt8, compactLabels.GetPixelID() );
+  EXPECT_EQ( sitk::Hash( sitk::Cast( labels, sitk::sitkUInt8 ) ), sitk::Hash( compactLabels ) );
+
+  // the largest objects only, sorted by size
+  connected.CompactOutputOff();
+  connected.SortByObjectSizeOn();
+  connected.SetMaximumNumberOfObjects( 3 );
+  sitk::Image largestLabels = connected.Execute( image );
+  EXPECT_EQ( 3u, connected.GetObjectCount() );
+  ASSERT_EQ( 3u, connected.GetSizeOfObjectsInPixels().size() );
+  EXPECT_GE( connected.GetSizeOfObjectsInPixels()[0], connected.GetSizeOfObjectsInPixels()[1] );
+  EXPECT_GE( connected.GetSizeOfObjectsInPixels()[1], connected.GetSizeOfObjectsInPixels()[2] );
+
+  sitk::RelabelComponentImageFilter relabel;
+  sitk::Image expectedLabels = relabel.Execute( labels );
+  expectedLabels = sitk::Mask( expectedLabels, sitk::BinaryThreshold( expectedLabels, 0, 3, 1, 0 ) );
+  EXPECT_EQ( sitk::Hash( expectedLabels ), sitk::Hash( largestLabels ) );
+
+  sitk::ScalarConnectedComponentImageFilter scalarConnected;
+  EXPECT_FALSE( scalarConnected.GetUseUnionFind() );
+  scalarConnected.UseUnionFindOn();
+  scalarConnected.CompactOutputOn();
+  sitk::Image scalarLabels = scalarConnected.Execute( image );
+  EXPECT_EQ( sitk::sitkUInt8, scalarLabels.GetPixelID() );
+}
+
+
+TEST(BasicFilters,HistogramImageFilter)
+{
+  namespace sitk = itk::simple;
+
+  // the pixels of a 10x10 image are 0 to 99
+  sitk::Image image( 10, 10, sitk::sitkFloat32 );
+  sitk::Image image2( 10, 10, sitk::sitkUInt8 );
+  sitk::Image mask( 10, 10, sitk::sitkUInt8 );
+  for ( unsigned int y = 0; y < 10; ++y )
+    {
+    for ( unsigned int x = 0; x < 10; ++x )
+      {
+      std::vector<uint32_t> index( 2 );
+      index[0] = x;
+      index[1] = y;
+      image.SetPixelAsFloat( index, 10.0f * y + x );
+      image2.SetPixelAsUInt8( index, x % 2 );
+      mask.SetPixelAsUInt8( index, y < 5 );
+      }
+    }
+
+  sitk::HistogramImageFilter histogram;
+  EXPECT_EQ( "HistogramImageFilter", histogram.GetName() );
+  EXPECT_EQ( 256u, histogram.GetNumberOfBins() );
+  EXPECT_TRUE( histogram.GetAutoMinimumMaximum() );
+
+  // the range is that of the pixels, the maximum is in the last bin
+  histogram.SetNumberOfBins( 10 );
+  histogram.Execute( image );
+  EXPECT_EQ( 1u, histogram.GetNumberOfHistogramDimensions() );
+  EXPECT_EQ( 100u, histogram.GetNumberOfPixels() );
+  EXPECT_EQ( std::vector<uint64_t>( 10, 10 ), histogram.GetCounts() );
+  std::vector<double> edges = histogram.GetBinEdges();
+  ASSERT_EQ( 11u, edges.size() );
+  EXPECT_EQ( 0.0, edges[0] );
+  EXPECT_NEAR( 9.9, edges[1], 1e-10 );
+  EXPECT_EQ( 99.0, edges[10] );
+  EXPECT_ANY_THROW( histogram.GetBinEdges( 1 ) );
+
+  // the pixels inside of the mask
+  histogram.Execute( image, mask );
+  EXPECT_EQ( 50u, histogram.GetNumberOfPixels() );
+  EXPECT_EQ( 49.0, histogram.GetBinEdges()[10] );
+
+  // fixed edges, the pixels outside are not counted
+  histogram.AutoMinimumMaximumOff();
+  EXPECT_ANY_THROW( histogram.Execute( image ) );
+  histogram.SetHistogramMinimum( std::vector<double>( 1, 0.0 ) );
+  histogram.SetHistogramMaximum( std::vector<double>( 1, 49.5 ) );
+  histogram.Execute( image );
+  EXPECT_EQ( 50u, histogram.GetNumberOfPixels() );
+  EXPECT_EQ( std::vector<uint64_t>( 10, 5 ), histogram.GetCounts() );
+
+  // the joint histogram, the second image is 0 or 1
+  histogram.AutoMinimumMaximumOn();
+  histogram.SetNumberOfBins( 2 );
+  histogram.ExecuteJoint( image2, image );
+  EXPECT_EQ( 2u, histogram.GetNumberOfHistogramDimensions() );
+  ASSERT_EQ( 4u, histogram.GetCounts().size() );
+  EXPECT_EQ( 100u, histogram.GetNumberOfPixels() );
+  EXPECT_EQ( 25u, histogram.GetCounts()[0] );
+  EXPECT_EQ( 25u, histogram.GetCounts()[3] );
+  EXPECT_EQ( 1.0, histogram.GetBinEdges( 0 )[2] );
+  EXPECT_EQ( 99.0, histogram.GetBinEdges( 1 )[2] );
+  EXPECT_ANY_THROW( histogram.ComputeThreshold( sitk::HistogramImageFilter::OTSU ) );
+
+  // the results do not depend on the number of threads
+  const std::vector<uint64_t> counts = histogram.GetCounts();
+  histogram.SetNumberOfThreads( 1 );
+  histogram.ExecuteJoint( image2, image, mask );
+  EXPECT_EQ( 50u, histogram.GetNumberOfPixels() );
+  histogram.ExecuteJoint( image2, image );
+  EXPECT_EQ( counts, histogram.GetCounts() );
+
+  // the mask must be of the sitkUInt8 pixel type
+  EXPECT_ANY_THROW( histogram.Execute( image, image ) );
+  EXPECT_ANY_THROW( histogram.ExecuteJoint( image, sitk::Image( 5, 5, sitk::sitkUInt8 ) ) );
+}
+
+
+TEST(BasicFilters,HistogramImageFilter_Threshold)
+{
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile( "Input/cthead1.png" ) );
+
+  sitk::HistogramImageFilter histogram;
+  histogram.Execute( image );
+  const std::vector<double> edges = histogram.GetBinEdges();
+  const double binWidth = edges[1] - edges[0];
+
+  // the thresholds of one histogram are those of the filters, up to
+  // the bins of their own histograms
+  sitk::OtsuThresholdImageFilter otsu;
+  otsu.Execute( image );
+  EXPECT_NEAR( otsu.GetThreshold(), histogram.ComputeThreshold( sitk::HistogramImageFilter::OTSU ), 2.0 * binWidth );
+
+  sitk::LiThresholdImageFilter li;
+  li.Execute( image );
+  EXPECT_NEAR( li.GetThreshold(), histogram.ComputeThreshold( sitk::HistogramImageFilter::LI ), 2.0 * binWidth );
+
+  // a histogram of the caller
+  const double threshold = sitk::HistogramImageFilter::ComputeThreshold( histogram.GetCounts(), edges, sitk::HistogramImageFilter::OTSU );
+  EXPECT_EQ( histogram.ComputeThreshold( sitk::HistogramImageFilter::OTSU ), threshold );
+  EXPECT_ANY_THROW( sitk::HistogramImageFilter::ComputeThreshold( histogram.GetCounts(), std::vector<double>( 2, 0.0 ), sitk::HistogramImageFilter::OTSU ) );
+  EXPECT_ANY_THROW( sitk::HistogramImageFilter::ComputeThreshold( std::vector<uint64_t>( 2, 0 ), std::vector<double>( 3, 0.0 ), sitk::HistogramImageFilter::OTSU ) );
+}
+
+
+TEST(BasicFilters,HistogramImageFilter_Percentile)
+{
+  namespace sitk = itk::simple;
+
+  // the pixels of a 10x10 image are 0 to 99
+  sitk::Image image( 10, 10, sitk::sitkFloat32 );
+  sitk::Image mask( 10, 10, sitk::sitkUInt8 );
+  for ( unsigned int y = 0; y < 10; ++y )
+    {
+    for ( unsigned int x = 0; x < 10; ++x )
+      {
+      std::vector<uint32_t> index( 2 );
+      index[0] = x;
+      index[1] = y;
+      image.SetPixelAsFloat( index, 10.0f * y + x );
+      mask.SetPixelAsUInt8( index, y < 5 );
+      }
+    }
+
+  // the percentiles are interpolated inside of the bins
+  sitk::HistogramImageFilter histogram;
+  histogram.SetNumberOfBins( 10 );
+  histogram.Execute( image );
+  EXPECT_EQ( 0.0, histogram.ComputePercentile( 0.0 ) );
+  EXPECT_NEAR( 49.5, histogram.ComputePercentile( 50.0 ), 1e-10 );
+  EXPECT_NEAR( 24.75, histogram.ComputePercentile( 25.0 ), 1e-10 );
+  EXPECT_EQ( 99.0, histogram.ComputePercentile( 100.0 ) );
+  EXPECT_ANY_THROW( histogram.ComputePercentile( -1.0 ) );
+  EXPECT_ANY_THROW( histogram.ComputePercentile( 101.0 ) );
+
+  // the empty bins are skipped
+  std::vector<uint64_t> counts( 4, 0 );
+  counts[1] = 2;
+  std::vector<double> edges( 5 );
+  for ( unsigned int i = 0; i < edges.size(); ++i )
+    {
+    edges[i] = i;
+    }
+  EXPECT_EQ( 1.0, sitk::HistogramImageFilter::ComputePercentile( counts, edges, 0.0 ) );
+  EXPECT_EQ( 1.5, sitk::HistogramImageFilter::ComputePercentile( counts, edges, 50.0 ) );
+  EXPECT_EQ( 2.0, sitk::HistogramImageFilter::ComputePercentile( counts, edges, 100.0 ) );
+  EXPECT_ANY_THROW( sitk::HistogramImageFilter::ComputePercentile( std::vector<uint64_t>( 4, 0 ), edges, 50.0 ) );
+
+  // the error of a percentile is less than the width of a bin
+  sitk::Image cthead = sitk::ReadImage( dataFinder.GetFile( "Input/cthead1.png" ) );
+  std::vector<double> values( cthead.GetNumberOfPixels() );
+  const uint8_t *buffer = cthead.GetBufferAsUInt8();
+  std::copy( buffer, buffer + values.size(), values.begin() );
+  std::sort( values.begin(), values.end() );
+  histogram.SetNumberOfBins( 64 );
+  histogram.Execute( cthead );
+  const double binWidth = histogram.GetBinEdges()[1] - histogram.GetBinEdges()[0];
+  const double percentiles[] = { 1.0, 5.0, 50.0, 95.0, 99.0 };
+  for ( unsigned int i = 0; i < 5; ++i )
+    {
+    // the pixel of the rank of the percentile
+    const double expected = values[static_cast<size_t>( std::ceil( percentiles[i] / 100.0 * values.size() ) ) - 1];
+    EXPECT_NEAR( expected, histogram.ComputePercentile( percentiles[i] ), binWidth ) << "percentile " << percentiles[i];
+    }
+
+  // clip between the 10th and 90th percentiles and rescale to [0,1]
+  sitk::Image windowed = sitk::PercentileWindowing( image, 10.0, 90.0, 0.0, 1.0, 10 );
+  EXPECT_EQ( sitk::sitkFloat32, windowed.GetPixelID() );
+  std::vector<uint32_t> index( 2, 0 );
+  EXPECT_EQ( 0.0f, windowed.GetPixelAsFloat( index ) );
+  index[0] = 5;
+  index[1] = 4;
+  EXPECT_NEAR( ( 45.0 - 9.9 ) / ( 89.1 - 9.9 ), windowed.GetPixelAsFloat( index ), 1e-6 );
+  index[0] = 9;
+  index[1] = 9;
+  EXPECT_EQ( 1.0f, windowed.GetPixelAsFloat( index ) );
+
+  // the percentiles of the pixels inside of the mask, all the pixels
+  // are rescaled
+  windowed = sitk::PercentileWindowing( image, mask, 0.0, 100.0, 0.0, 49.0, 10 );
+  EXPECT_EQ( 49.0f, windowed.GetPixelAsFloat( index ) );
+  index[0] = 5;
+  index[1] = 4;
+  EXPECT_NEAR( 45.0, windowed.GetPixelAsFloat( index ), 1e-5 );
+  EXPECT_ANY_THROW( sitk::PercentileWindowing( image, 90.0, 10.0 ) );
+}
+
+
+TEST(BasicFilters,HashImageFilter_Fast)
+{
+  namespace sitk = itk::simple;
+
+  sitk::HashImageFilter hasher;
+  hasher.SetHashFunction( sitk::HashImageFilter::FAST );
+  EXPECT_EQ( sitk::HashImageFilter::FAST, hasher.GetHashFunction() );
+  EXPECT_FALSE( hasher.GetIncludeGeometry() );
+
+  // the XXH64 of the XXH64 of one block of 200 zeros and of its size
+  sitk::Image zeros( 10, 20, sitk::sitkUInt8 );
+  EXPECT_EQ( "4da50f6b9cc53706", hasher.Execute( zeros ) );
+
+  // several blocks, hashed by any number of threads
+  sitk::Image image = sitk::GaussianSource( sitk::sitkFloat32, std::vector<unsigned int>( 3, 128 ) );
+  hasher.SetNumberOfThreads( 1 );
+  const std::string expected = hasher.Execute( image );
+  hasher.SetNumberOfThreads( 5 );
+  EXPECT_EQ( expected, hasher.Execute( image ) );
+  EXPECT_NE( expected, hasher.Execute( sitk::Add( image, 1.0 ) ) );
+
+  // the other hashes are not changed
+  EXPECT_EQ( sitk::Hash( image ), sitk::Hash( image, sitk::HashImageFilter::SHA1 ) );
+  EXPECT_NE( expected, sitk::Hash( image ) );
+
+  // the geometry is only hashed when requested
+  sitk::Image moved = image;
+  moved.SetOrigin( std::vector<double>( 3, 1.0 ) );
+  EXPECT_EQ( expected, hasher.Execute( moved ) );
+  EXPECT_EQ( sitk::Hash( image ), sitk::Hash( moved ) );
+
+  hasher.IncludeGeometryOn();
+  EXPECT_TRUE( hasher.ToString().find( "IncludeGeometry: 1" ) != std::string::npos );
+  EXPECT_NE( expected, hasher.Execute( image ) );
+  EXPECT_NE( hasher.Execute( image ), hasher.Execute( moved ) );
+
+  hasher.SetHashFunction( sitk::HashImageFilter::SHA1 );
+  EXPECT_NE( sitk::Hash( image ), hasher.Execute( image ) );
+  EXPECT_NE( hasher.Execute( image ), hasher.Execute( moved ) );
+
+  // the hash does not modify the input
+  const std::string sha1 = sitk::Hash( image );
+  hasher.SetHashFunction( sitk::HashImageFilter::FAST );
+  hasher.Execute( image );
+  EXPECT_EQ( sha1, sitk::Hash( image ) );
+}
+
+
+TEST(BasicFilters,ExecutionCache)
+{
+  namespace sitk = itk::simple;
+
+  sitk::ExecutionCache::Clear();
+  EXPECT_FALSE( sitk::ExecutionCache::IsEnabled() );
+
+  // room for two 64x64 float images
+  sitk::ExecutionCache::SetMaximumMemory( 40000 );
+  EXPECT_TRUE( sitk::ExecutionCache::IsEnabled() );
+
+  sitk::Image image = sitk::GaussianSource( sitk::sitkFloat32, std::vector<unsigned int>( 2, 64 ) );
+
+  sitk::ShiftScaleImageFilter filter;
+  filter.SetShift( 1.0 );
+  const sitk::Image first = filter.Execute( image );
+  EXPECT_EQ( 0u, sitk::ExecutionCache::GetNumberOfHits() );
+  EXPECT_EQ( 1u, sitk::ExecutionCache::GetNumberOfMisses() );
+  EXPECT_EQ( 64u*64u*4u, sitk::ExecutionCache::GetMemoryUsed() );
+
+  // the cached image shares the buffer of the first output
+  sitk::Image second = filter.Execute( image );
+  EXPECT_EQ( 1u, sitk::ExecutionCache::GetNumberOfHits() );
+  EXPECT_EQ( sitk::Hash( first ), sitk::Hash( second ) );
+  EXPECT_TRUE( second.IsBufferShared() );
+
+  // modifying an output does not modify the cached image
+  second.SetPixelAsFloat( std::vector<unsigned int>( 2, 0 ), 100.0f );
+  EXPECT_EQ( sitk::Hash( first ), sitk::Hash( filter.Execute( image ) ) );
+  EXPECT_EQ( 2u, sitk::ExecutionCache::GetNumberOfHits() );
+
+  // a parameter differing in the last digits, or another input, is
+  // executed
+  filter.SetShift( 1.0 + 1e-12 );
+  filter.Execute( image );
+  EXPECT_EQ( 2u, sitk::ExecutionCache::GetNumberOfMisses() );
+
+  filter.SetShift( 1.0 );
+  sitk::Image moved = image;
+  moved.SetOrigin( std::vector<double>( 2, 1.0 ) );
+  filter.Execute( moved );
+  EXPECT_EQ( 3u, sitk::ExecutionCache::GetNumberOfMisses() );
+
+  // the least recently used images are evicted
+  EXPECT_EQ( 2u, sitk::ExecutionCache::GetNumberOfImages() );
+  EXPECT_LE( sitk::ExecutionCache::GetMemoryUsed(), 40000u );
+  filter.Execute( image );
+  EXPECT_EQ( 4u, sitk::ExecutionCache::GetNumberOfMisses() );
+
+  // the evicted images are read back from the spill directory
+  sitk::ExecutionCache::Clear();
+  EXPECT_EQ( 0u, sitk::ExecutionCache::GetNumberOfImages() );
+  sitk::ExecutionCache::SetSpillDirectory( dataFinder.GetOutputDirectory() );
+  EXPECT_EQ( dataFinder.GetOutputDirectory(), sitk::ExecutionCache::GetSpillDirectory() );
+
+  const std::string expected = sitk::Hash( filter.Execute( moved ) );
+  filter.Execute( image );
+  filter.SetShift( 2.0 );
+  filter.Execute( image );
+  EXPECT_EQ( 3u, sitk::ExecutionCache::GetNumberOfImages() );
+
+  filter.SetShift( 1.0 );
+  sitk::Image spilled = filter.Execute( moved );
+  EXPECT_EQ( 1u, sitk::ExecutionCache::GetNumberOfHits() );
+  EXPECT_EQ( expected, sitk::Hash( spilled ) );
+  EXPECT_EQ( moved.GetOrigin(), spilled.GetOrigin() );
+
+  // the cache is disabled again
+  sitk::ExecutionCache::Clear();
+  sitk::ExecutionCache::SetSpillDirectory( "" );
+  sitk::ExecutionCache::SetMaximumMemory( 0 );
+  filter.Execute( image );
+  EXPECT_EQ( 0u, sitk::ExecutionCache::GetNumberOfMisses() );
+  EXPECT_EQ( 0u, sitk::ExecutionCache::GetNumberOfImages() );
+}
+
+TEST(BasicFilters,InvertDisplacementField_InitialEstimate)
+{
+  sitk::Image field = sitk::Cast( sitk::ReadImage( dataFinder.GetFile( "Input/displacement.mha" ) ), sitk::sitkVectorFloat64 );
+
+  sitk::InvertDisplacementFieldImageFilter filter;
+  filter.SetMeanErrorToleranceThreshold( 0.0 );
+  filter.SetMaxErrorToleranceThreshold( 0.0 );
+
+  filter.SetMaximumNumberOfIterations( 20u );
+  sitk::Image inverse = filter.Execute( field );
+
+  filter.SetMaximumNumberOfIterations( 1u );
+  filter.Execute( field );
+  const double coldError = filter.GetMeanErrorNorm();
+
+  // starting from the previous inverse needs fewer iterations
+  sitk::Image warmInverse = filter.Execute( field, inverse );
+  EXPECT_LT( filter.GetMeanErrorNorm(), coldError );
+  EXPECT_EQ( field.GetSize(), warmInverse.GetSize() );
+
+  // the fields may have float components
+  sitk::Image field32 = sitk::Cast( field, sitk::sitkVectorFloat32 );
+  sitk::Image inverse32 = sitk::Cast( inverse, sitk::sitkVectorFloat32 );
+  sitk::Image warmInverse32 = filter.Execute( field32, inverse32 );
+  EXPECT_EQ( sitk::sitkVectorFloat32, warmInverse32.GetPixelID() );
+  EXPECT_LT( filter.GetMeanErrorNorm(), coldError );
+
+  EXPECT_THROW( filter.Execute( field, inverse32 ), sitk::GenericException );
 }
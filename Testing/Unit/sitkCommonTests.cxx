@@ -24,6 +24,8 @@
 
 #include <sitkKernel.h>
 
+#include <sstream>
+
 namespace nsstd = itk::simple::nsstd;
 
 TEST( ConditionalTest, ConditionalTest1 ) {
@@ -59,6 +61,80 @@ TEST( ProcessObject, GlobalTolerance ) {
 
 }
 
+TEST( ProcessObject, GlobalDefaultThreader ) {
+
+  namespace sitk = itk::simple;
+
+  const std::string defaultThreader = sitk::ProcessObject::GetGlobalDefaultThreader();
+
+  sitk::Image img( 100, 100, sitk::sitkUInt16 );
+  std::vector<uint32_t> idx( 2 );
+  idx[0] = 10;
+  idx[1] = 20;
+  img.SetPixelAsUInt16( idx, 17 );
+
+  sitk::CastImageFilter po;
+  po.SetOutputPixelType( sitk::sitkFloat32 );
+
+  EXPECT_TRUE( sitk::ProcessObject::SetGlobalDefaultThreader( "platform" ) );
+  EXPECT_EQ( sitk::ProcessObject::GetGlobalDefaultThreader(), "PLATFORM" );
+  const sitk::Image expected = po.Execute( img );
+
+  if ( sitk::ProcessObject::SetGlobalDefaultThreader( "POOL" ) )
+    {
+    EXPECT_EQ( sitk::ProcessObject::GetGlobalDefaultThreader(), "POOL" );
+    for ( unsigned int i = 0; i < 10; ++i )
+      {
+      EXPECT_EQ( po.Execute( img ).GetPixelAsFloat( idx ), expected.GetPixelAsFloat( idx ) );
+      }
+    }
+
+  const std::string threader = sitk::ProcessObject::GetGlobalDefaultThreader();
+  EXPECT_FALSE( sitk::ProcessObject::SetGlobalDefaultThreader( "NotAThreader" ) );
+  EXPECT_EQ( sitk::ProcessObject::GetGlobalDefaultThreader(), threader );
+
+  sitk::ProcessObject::SetGlobalDefaultThreader( defaultThreader );
+}
+
+TEST( ProcessObject, GlobalThreadBudget ) {
+
+  namespace sitk = itk::simple;
+
+  EXPECT_EQ( sitk::ProcessObject::GetGlobalThreadBudget(), 0u );
+
+  sitk::Image img( 100, 100, sitk::sitkUInt16 );
+
+  sitk::CastImageFilter po;
+  po.SetOutputPixelType( sitk::sitkFloat32 );
+  po.SetNumberOfThreads( 8 );
+
+  sitk::ProcessObject::SetGlobalThreadBudget( 3 );
+  EXPECT_EQ( sitk::ProcessObject::GetGlobalThreadBudget(), 3u );
+
+  // the number of threads of the ITK filter is recorded
+  sitk::ProcessObject::ClearGlobalInstrumentation();
+  sitk::ProcessObject::GlobalInstrumentationOn();
+  po.Execute( img );
+  po.SetNumberOfThreads( 2 );
+  po.Execute( img );
+  sitk::ProcessObject::GlobalInstrumentationOff();
+
+  EXPECT_EQ( sitk::ProcessObject::GetGlobalNumberOfReservedThreads(), 0u );
+
+  std::istringstream log( sitk::ProcessObject::GetGlobalInstrumentationLog() );
+  std::string line;
+  std::getline( log, line );
+  ASSERT_TRUE( std::getline( log, line ) );
+  EXPECT_NE( line.find( ",100x100,3," ), std::string::npos ) << line;
+  ASSERT_TRUE( std::getline( log, line ) );
+  EXPECT_NE( line.find( ",100x100,2," ), std::string::npos ) << line;
+  sitk::ProcessObject::ClearGlobalInstrumentation();
+
+  sitk::ProcessObject::SetGlobalThreadBudget( 0 );
+  EXPECT_EQ( po.Execute( img ).GetSize()[0], 100u );
+  EXPECT_EQ( sitk::ProcessObject::GetGlobalNumberOfReservedThreads(), 0u );
+}
+
 TEST( ProcessObject, GlobalWarning ) {
   // Basic coverage test of setting and getting. Need separate
   // specific check for propagation of warning to ITK.
@@ -347,6 +423,196 @@ TEST( ProcessObject, RemoveAllCommandsActiveProcess )
   EXPECT_FALSE(po.HasCommand(sitk::sitkProgressEvent));
 }
 
+TEST( ProcessObject, GlobalInstrumentation )
+{
+  namespace sitk = itk::simple;
+
+  EXPECT_FALSE( sitk::ProcessObject::GetGlobalInstrumentation() );
+
+  sitk::CastImageFilter po;
+  po.SetOutputPixelType( sitk::sitkFloat32 );
+  sitk::Image img( 10, 20, sitk::sitkUInt16 );
+
+  // nothing is recorded while disabled
+  sitk::ProcessObject::ClearGlobalInstrumentation();
+  po.Execute( img );
+  const std::string header = "Filter,ITKFilter,PixelType,Size,NumberOfThreads,WallTime,CPUTime,OutputBytes,MemoryChange\n";
+  EXPECT_EQ( sitk::ProcessObject::GetGlobalInstrumentationLog(), header );
+
+  sitk::ProcessObject::GlobalInstrumentationOn();
+  EXPECT_TRUE( sitk::ProcessObject::GetGlobalInstrumentation() );
+  po.SetNumberOfThreads( 2 );
+  po.Execute( img );
+  po.Execute( img );
+  sitk::ProcessObject::GlobalInstrumentationOff();
+  po.Execute( img );
+
+  std::istringstream log( sitk::ProcessObject::GetGlobalInstrumentationLog() );
+  std::string line;
+  std::getline( log, line );
+  EXPECT_EQ( line + "\n", header );
+  for ( unsigned int i = 0; i < 2; ++i )
+    {
+    ASSERT_TRUE( std::getline( log, line ) );
+    EXPECT_EQ( line.find( "CastImageFilter,CastImageFilter,32-bit float,10x20,2," ), 0u ) << line;
+    EXPECT_NE( line.find( ",800," ), std::string::npos ) << line;
+    }
+  EXPECT_FALSE( std::getline( log, line ) );
+
+  std::istringstream summary( sitk::ProcessObject::GetGlobalInstrumentationSummary() );
+  std::getline( summary, line );
+  EXPECT_EQ( line, "Filter,Count,WallTime,CPUTime,OutputBytes,MaximumMemoryChange" );
+  ASSERT_TRUE( std::getline( summary, line ) );
+  EXPECT_EQ( line.find( "CastImageFilter,2," ), 0u ) << line;
+  EXPECT_NE( line.find( ",1600," ), std::string::npos ) << line;
+  EXPECT_FALSE( std::getline( summary, line ) );
+
+  const std::string trace = sitk::ProcessObject::GetGlobalInstrumentationTrace();
+  EXPECT_EQ( trace.find( "{\"traceEvents\":[" ), 0u );
+  size_t events = 0;
+  for ( size_t pos = trace.find( "\"ph\":\"X\"" ); pos != std::string::npos; pos = trace.find( "\"ph\":\"X\"", pos + 1 ) )
+    {
+    ++events;
+    }
+  EXPECT_EQ( events, 2u );
+  EXPECT_NE( trace.find( "{\"name\":\"CastImageFilter\",\"cat\":\"filter\"" ), std::string::npos ) << trace;
+  EXPECT_NE( trace.find( "\"tid\":0," ), std::string::npos ) << trace;
+  EXPECT_NE( trace.find( "\"Size\":[10,20]" ), std::string::npos ) << trace;
+
+  sitk::ProcessObject::ClearGlobalInstrumentation();
+  EXPECT_EQ( sitk::ProcessObject::GetGlobalInstrumentationLog(), header );
+  EXPECT_EQ( sitk::ProcessObject::GetGlobalInstrumentationTrace().find( "\"ph\"" ), std::string::npos );
+}
+
+
+TEST( ProcessObject, CancellationToken )
+{
+  namespace sitk = itk::simple;
+
+  // cancel the token when the progress of the process reaches a value
+  class CancelAtCommand
+  : public ProcessObjectCommand
+  {
+  public:
+    CancelAtCommand(itk::simple::ProcessObject &po, sitk::CancellationToken &token, float cancelAt )
+      : ProcessObjectCommand(po),
+        m_Token(token),
+        m_CancelAt(cancelAt)
+      {
+      }
+
+    virtual void Execute( )
+      {
+        if ( m_Process.GetProgress() >= m_CancelAt )
+          {
+          m_Token.Cancel();
+          }
+      }
+
+    sitk::CancellationToken m_Token;
+    float                   m_CancelAt;
+  };
+
+  sitk::Image img( 100, 100, 100, sitk::sitkUInt16 );
+
+  sitk::CancellationToken token;
+  EXPECT_FALSE( token.IsCancelled() );
+  sitk::CancellationToken copy = token;
+  EXPECT_TRUE( copy == token );
+  EXPECT_TRUE( sitk::CancellationToken() != token );
+
+  sitk::CastImageFilter po1;
+  po1.SetOutputPixelType( sitk::sitkFloat32 );
+  po1.SetNumberOfThreads( 1 );
+  EXPECT_FALSE( po1.HasCancellationToken() );
+  EXPECT_THROW( po1.GetCancellationToken(), sitk::GenericException );
+  po1.SetCancellationToken( token );
+  EXPECT_TRUE( po1.HasCancellationToken() );
+  EXPECT_TRUE( po1.GetCancellationToken() == token );
+
+  sitk::CastImageFilter po2;
+  po2.SetOutputPixelType( sitk::sitkInt32 );
+  po2.SetCancellationToken( copy );
+
+  // cancelled during the execution
+  CancelAtCommand cancelCmd( po1, token, .1f );
+  po1.AddCommand( sitk::sitkProgressEvent, cancelCmd );
+  CountCommand abortCmd( po1 );
+  po1.AddCommand( sitk::sitkAbortEvent, abortCmd );
+
+  EXPECT_ANY_THROW( po1.Execute( img ) );
+  EXPECT_TRUE( token.IsCancelled() );
+  EXPECT_TRUE( copy.IsCancelled() );
+  EXPECT_EQ( 1, abortCmd.m_Count );
+
+  // the other filters of the chain are cancelled before executing
+  CountCommand startCmd( po2 );
+  po2.AddCommand( sitk::sitkStartEvent, startCmd );
+  EXPECT_ANY_THROW( po2.Execute( img ) );
+  EXPECT_EQ( 0, startCmd.m_Count );
+
+  // the token may be reused after it is reset
+  token.Reset();
+  EXPECT_FALSE( copy.IsCancelled() );
+  po1.RemoveAllCommands();
+  EXPECT_NO_THROW( po1.Execute( img ) );
+  EXPECT_NO_THROW( po2.Execute( img ) );
+  EXPECT_EQ( 1, startCmd.m_Count );
+
+  po2.RemoveCancellationToken();
+  EXPECT_FALSE( po2.HasCancellationToken() );
+  copy.Cancel();
+  EXPECT_NO_THROW( po2.Execute( img ) );
+}
+
+TEST( ProcessObject, ProgressThrottle )
+{
+  namespace sitk = itk::simple;
+
+  sitk::Image img( 100, 100, 100, sitk::sitkUInt16 );
+
+  sitk::CastImageFilter po;
+  po.SetOutputPixelType( sitk::sitkFloat32 );
+  po.SetNumberOfThreads( 1 );
+
+  EXPECT_EQ( po.GetProgressMinimumDelta(), 0.0f );
+  EXPECT_EQ( po.GetProgressMinimumInterval(), 0.0 );
+
+  CountCommand progressCount( po );
+  po.AddCommand( sitk::sitkProgressEvent, progressCount );
+  ProgressUpdate progressCmd( po );
+  po.AddCommand( sitk::sitkProgressEvent, progressCmd );
+
+  po.Execute( img );
+  const int numberOfProgress = progressCount.m_Count;
+  EXPECT_GT( numberOfProgress, 10 );
+  EXPECT_EQ( 1.0f, progressCmd.m_Progress );
+
+  // at most one call per quarter, and the last progress
+  progressCount.m_Count = 0;
+  progressCmd.m_Progress = 0.0f;
+  po.SetProgressMinimumDelta( .25f );
+  po.Execute( img );
+  EXPECT_LE( progressCount.m_Count, 6 );
+  EXPECT_GE( progressCount.m_Count, 2 );
+  EXPECT_EQ( 1.0f, progressCmd.m_Progress );
+
+  // only the first and the last progress
+  progressCount.m_Count = 0;
+  progressCmd.m_Progress = 0.0f;
+  po.SetProgressMinimumDelta( 0.0f );
+  po.SetProgressMinimumInterval( 1000.0 );
+  EXPECT_EQ( po.GetProgressMinimumInterval(), 1000.0 );
+  po.Execute( img );
+  EXPECT_LE( progressCount.m_Count, 2 );
+  EXPECT_EQ( 1.0f, progressCmd.m_Progress );
+
+  po.SetProgressMinimumInterval( -1.0 );
+  EXPECT_EQ( po.GetProgressMinimumInterval(), 0.0 );
+  progressCount.m_Count = 0;
+  po.Execute( img );
+  EXPECT_EQ( progressCount.m_Count, numberOfProgress );
+}
 
 TEST( Event, Test1 )
 {
@@ -619,6 +885,9 @@ TEST( Interpolator, Test1 )
   ss.str("");
   ss << sitk::sitkBlackmanWindowedSinc;
   EXPECT_EQ("BlackmanWindowedSinc", ss.str());
+  ss.str("");
+  ss << sitk::sitkBSplineResampler;
+  EXPECT_EQ("BSplineResampler", ss.str());
 
 }
 
@@ -666,3 +935,18 @@ TEST( Kernel, Test1 )
   EXPECT_EQ("Polygon9", ss.str());
 
 }
+
+TEST( PixelIDValues, ComponentSize )
+{
+  namespace sitk = itk::simple;
+
+  EXPECT_EQ( 1u, sitk::GetPixelIDValueComponentSize( sitk::sitkUInt8 ) );
+  EXPECT_EQ( 1u, sitk::GetPixelIDValueComponentSize( sitk::sitkVectorInt8 ) );
+  EXPECT_EQ( 2u, sitk::GetPixelIDValueComponentSize( sitk::sitkInt16 ) );
+  EXPECT_EQ( 4u, sitk::GetPixelIDValueComponentSize( sitk::sitkFloat32 ) );
+  EXPECT_EQ( 8u, sitk::GetPixelIDValueComponentSize( sitk::sitkVectorUInt64 ) );
+  EXPECT_EQ( 8u, sitk::GetPixelIDValueComponentSize( sitk::sitkComplexFloat32 ) );
+  EXPECT_EQ( 16u, sitk::GetPixelIDValueComponentSize( sitk::sitkComplexFloat64 ) );
+  EXPECT_EQ( 0u, sitk::GetPixelIDValueComponentSize( sitk::sitkLabelUInt8 ) );
+  EXPECT_EQ( 0u, sitk::GetPixelIDValueComponentSize( sitk::sitkUnknown ) );
+}
@@ -129,6 +129,110 @@ class TestNumpySimpleITKMemoryviewInterface(unittest.TestCase):
         with self.assertRaises(ValueError):
             a.fill(0)
 
+        # a writable view modifies the image
+        a = sitk.GetArrayViewFromImage(img, writable=True)
+        a[2,3] = 5.0
+        self.assertEqual(img.GetPixel(3,2), 5.0)
+
+        # the view keeps the image alive
+        a = sitk.GetArrayViewFromImage(sitk.Image((9, 10), sitk.sitkInt32, 1) + 7, writable=True)
+        self.assertEqual(a.sum(), 9*10*7)
+        a.fill(1)
+        self.assertEqual(a.sum(), 9*10)
+
+    def test_image_from_array_without_copy(self):
+        """Test importing a NumPy array into an image without a copy."""
+
+        nda = np.arange(4*5*6, dtype=np.int16).reshape(4,5,6)
+        img = sitk.GetImageFromArray(nda, copy=False)
+        self.assertEqual(img.GetSize(), (6,5,4))
+        self.assertEqual(img.GetPixelID(), sitk.sitkInt16)
+        self.assertEqual(sitk.Hash(img), sitk.Hash(sitk.GetImageFromArray(nda)))
+
+        # the image and the array share the buffer
+        nda[1,2,3] = -1
+        self.assertEqual(img.GetPixel(3,2,1), -1)
+        img.SetPixel(0,0,0, 42)
+        self.assertEqual(nda[0,0,0], 42)
+
+        # the image holds the buffer of the array
+        del nda
+        self.assertEqual(img.GetPixel(3,2,1), -1)
+
+        nda = np.ones((4,3,2), dtype=np.float32)
+        img = sitk.GetImageFromArray(nda, isVector=True, copy=False)
+        self.assertEqual(img.GetNumberOfComponentsPerPixel(), 2)
+        nda[0,0,1] = 3.0
+        self.assertEqual(img.GetPixel(0,0), (1.0, 3.0))
+
+        # arrays which are not contiguous are copied
+        nda = np.zeros((6,8), dtype=np.float64)[::2,::2]
+        img = sitk.GetImageFromArray(nda, copy=False)
+        self.assertEqual(img.GetSize(), (4,3))
+        nda[0,0] = 1.0
+        self.assertEqual(img.GetPixel(0,0), 0.0)
+
+    def test_array_interface(self):
+        """Test the array interface of an image."""
+
+        img = sitk.Image((6, 5, 4), sitk.sitkUInt16, 1)
+        nda = np.asarray(img)
+        self.assertEqual(nda.shape, (4,5,6))
+        self.assertEqual(nda.dtype, np.uint16)
+
+        # the array shares the buffer of the image
+        nda[1,2,3] = 7
+        self.assertEqual(img.GetPixel(3,2,1), 7)
+
+        img = sitk.Image((3, 2), sitk.sitkVectorFloat64, 5)
+        self.assertEqual(np.asarray(img).shape, (2,3,5))
+
+        with self.assertRaises(TypeError):
+            np.asarray(sitk.Image((3, 2), sitk.sitkComplexFloat32)).sum()
+
+    def test_dlpack(self):
+        """Test the exchange of images with DLPack."""
+
+        img = sitk.Image((6, 5, 4), sitk.sitkFloat32, 1) + 2.0
+        self.assertEqual(img.__dlpack_device__(), (1, 0))
+
+        # a capsule which is not consumed is released
+        capsule = img.__dlpack__()
+        del capsule
+
+        img2 = sitk.GetImageFromDLPack(img)
+        self.assertEqual(img2.GetSize(), (6,5,4))
+        self.assertEqual(img2.GetPixelID(), sitk.sitkFloat32)
+        img2.SetPixel(1,2,3, 5.0)
+        self.assertEqual(img.GetPixel(1,2,3), 5.0)
+
+        # the new image references the exported image
+        del img
+        self.assertEqual(img2.GetPixel(1,2,3), 5.0)
+
+        img = sitk.Image((3,2), sitk.sitkVectorInt16, 4)
+        img2 = sitk.GetImageFromDLPack(img.__dlpack__(), isVector=True)
+        self.assertEqual(img2.GetNumberOfComponentsPerPixel(), 4)
+        self.assertEqual(img2.GetPixelID(), sitk.sitkVectorInt16)
+
+        # a consumed capsule can not be imported again
+        capsule = img.__dlpack__()
+        sitk.GetImageFromDLPack(capsule)
+        with self.assertRaises(TypeError):
+            sitk.GetImageFromDLPack(capsule)
+
+        if hasattr(np, 'from_dlpack'):
+            img = sitk.Image((6, 5), sitk.sitkInt32, 1)
+            nda = np.from_dlpack(img)
+            self.assertEqual(nda.shape, (5,6))
+            nda[2,3] = -2
+            self.assertEqual(img.GetPixel(3,2), -2)
+
+            nda = np.arange(12, dtype=np.uint8).reshape(3,4)
+            img = sitk.GetImageFromDLPack(nda)
+            self.assertEqual(img.GetSize(), (4,3))
+            self.assertEqual(img.GetPixel(3,2), 11)
+
 
     def test_processing_time(self):
       """Check the processing time the conversions from SimpleITK Image
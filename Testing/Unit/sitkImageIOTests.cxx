@@ -17,12 +17,22 @@
 *=========================================================================*/
 #include <SimpleITKTestHarness.h>
 #include <sitkImageFileReader.h>
+#include <sitkImageFileReaderQueue.h>
 #include <sitkImageSeriesReader.h>
 #include <sitkImageFileWriter.h>
 #include <sitkImageSeriesWriter.h>
+#include <sitkImageMemoryIO.h>
+#include <sitkSharedMemoryImage.h>
+#include <sitkCompressedImageStore.h>
+#include <sitkDistributedTileExecutor.h>
 #include <sitkHashImageFilter.h>
 #include <sitkPhysicalPointImageSource.h>
 
+#include <itksys/SystemTools.hxx>
+
+#include <fstream>
+#include <iterator>
+
 TEST(IO,ImageFileReader) {
 
   namespace sitk = itk::simple;
@@ -316,6 +326,62 @@ TEST(IO, SeriesReader) {
 }
 
 
+TEST(IO, ImageSeriesReader_ParallelRead )
+{
+  std::vector< std::string > fileNames;
+  fileNames.push_back( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/WhiteDots.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+
+  sitk::ImageSeriesReader reader;
+  EXPECT_FALSE( reader.GetUseParallelRead() );
+  reader.UseParallelReadOn();
+  EXPECT_TRUE( reader.GetUseParallelRead() );
+  reader.SetNumberOfThreads( 3 );
+
+  ProgressUpdate progressCmd(reader);
+  reader.AddCommand(sitk::sitkProgressEvent, progressCmd);
+
+  CountCommand endCmd(reader);
+  reader.AddCommand(sitk::sitkEndEvent, endCmd);
+
+  sitk::Image image = reader.SetFileNames( fileNames ).Execute();
+  EXPECT_EQ ( "62fff5903956f108fbafd506e31c1e733e527820", sitk::Hash( image ) );
+  EXPECT_EQ ( 4u, image.GetDepth() );
+  EXPECT_EQ ( 1.0, progressCmd.m_Progress );
+  EXPECT_EQ ( 1, endCmd.m_Count );
+
+  // converted pixel type
+  fileNames.resize(0);
+  fileNames.push_back( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+  reader.SetFileNames( fileNames );
+  EXPECT_EQ ( "bb42b8d3991132b4860adbc4b3f6c38313f52b4c", sitk::Hash( reader.Execute() ) );
+  reader.SetOutputPixelType( sitk::sitkUInt8 );
+  EXPECT_EQ ( "a51361940fdf6c33cf700e1002e5f5ca5b88cc42", sitk::Hash( reader.Execute() ) );
+  reader.SetOutputPixelType( sitk::sitkUnknown );
+
+  // the geometry matches the sequential reader
+  fileNames = sitk::ImageSeriesReader::GetGDCMSeriesFileNames( dataFinder.GetDirectory( ) + "/Input/DicomSeries" );
+  reader.SetFileNames( fileNames );
+  image = reader.Execute();
+  sitk::Image expected = sitk::ReadImage( fileNames );
+  EXPECT_EQ( sitk::Hash( expected ), sitk::Hash( image ) );
+  EXPECT_VECTOR_DOUBLE_NEAR( expected.GetSpacing(), image.GetSpacing(), 1e-8 );
+  EXPECT_VECTOR_DOUBLE_NEAR( expected.GetOrigin(), image.GetOrigin(), 1e-8 );
+  EXPECT_VECTOR_DOUBLE_NEAR( expected.GetDirection(), image.GetDirection(), 1e-8 );
+
+  // slices of different sizes
+  fileNames.resize(0);
+  fileNames.push_back( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  reader.SetFileNames( fileNames );
+  EXPECT_ANY_THROW( reader.Execute() );
+}
+
 TEST(IO,Write_BadName) {
 
   sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/BlackDots.png" ) );
@@ -377,6 +443,126 @@ TEST(IO, DicomSeriesReader) {
   EXPECT_ANY_THROW( reader.GetMetaDataKeys(99) );
   EXPECT_ANY_THROW( reader.HasMetaDataKey(99, "nothing") );
   EXPECT_ANY_THROW( reader.GetMetaData(99, "nothing") );
+
+  // only the selected keys are kept for each slice
+  std::vector< std::string > allValues;
+  std::vector< std::string > keysToKeep;
+  keysToKeep.push_back( "0020|0013" );
+  keysToKeep.push_back( "0020|1041" );
+  keysToKeep.push_back( "0008|0032" );
+  keysToKeep.push_back( "0009|1234" );
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    for (unsigned int j = 0; j < 3; ++j )
+      {
+      allValues.push_back( reader.HasMetaDataKey(i, keysToKeep[j]) ? reader.GetMetaData(i, keysToKeep[j]) : "" );
+      }
+    }
+  EXPECT_TRUE( reader.GetMetaDataKeysToKeep().empty() );
+  reader.SetMetaDataKeysToKeep( keysToKeep );
+  EXPECT_EQ( keysToKeep, reader.GetMetaDataKeysToKeep() );
+  for ( unsigned int parallel = 0; parallel < 2; ++parallel )
+    {
+    reader.SetUseParallelRead( parallel == 1 );
+    EXPECT_EQ( "f5ad2854d68fc87a141e112e529d47424b58acfb", sitk::Hash( reader.Execute() ) );
+    for (unsigned int i = 0; i < 3; ++i)
+      {
+      EXPECT_LE( reader.GetMetaDataKeys(i).size(), 3u );
+      EXPECT_FALSE( reader.HasMetaDataKey(i, "0009|1234") );
+      EXPECT_FALSE( reader.HasMetaDataKey(i, "0008|0031") );
+      EXPECT_ANY_THROW( reader.GetMetaData(i, "0008|0031") );
+      for (unsigned int j = 0; j < 3; ++j )
+        {
+        EXPECT_EQ( allValues[3*i+j], reader.HasMetaDataKey(i, keysToKeep[j]) ? reader.GetMetaData(i, keysToKeep[j]) : "" );
+        }
+      }
+    EXPECT_ANY_THROW( reader.GetMetaDataKeys(99) );
+    }
+  reader.SetUseParallelRead( false );
+  reader.SetMetaDataKeysToKeep( std::vector< std::string >() );
+}
+
+
+TEST(IO, DicomSeriesScan) {
+
+  const std::string dicomDir = dataFinder.GetDirectory( ) + "/Input/DicomSeries";
+
+  std::vector< std::string > seriesIDs = sitk::ImageSeriesReader::GetDICOMSeriesIDs( dicomDir );
+  EXPECT_EQ( sitk::ImageSeriesReader::GetGDCMSeriesIDs( dicomDir ), seriesIDs );
+
+  std::vector< std::string > fileNames = sitk::ImageSeriesReader::GetDICOMSeriesFileNames( dicomDir );
+  EXPECT_EQ( sitk::ImageSeriesReader::GetGDCMSeriesFileNames( dicomDir ), fileNames );
+  EXPECT_EQ( 3u, fileNames.size() );
+  EXPECT_EQ( fileNames, sitk::ImageSeriesReader::GetDICOMSeriesFileNames( dicomDir, "1.2.840.113619.2.133.1762890640.1886.1055165015.999" ) );
+  EXPECT_TRUE( sitk::ImageSeriesReader::GetDICOMSeriesFileNames( dicomDir, "1.2.3" ).empty() );
+  EXPECT_EQ( "f5ad2854d68fc87a141e112e529d47424b58acfb", sitk::Hash( sitk::ReadImage( fileNames ) ) );
+
+  // the series details extend the series ID
+  std::vector< std::string > detailedIDs = sitk::ImageSeriesReader::GetDICOMSeriesIDs( dicomDir, true );
+  ASSERT_EQ( 1u, detailedIDs.size() );
+  EXPECT_EQ( 0u, detailedIDs[0].find( seriesIDs[0] ) );
+  EXPECT_EQ( fileNames, sitk::ImageSeriesReader::GetDICOMSeriesFileNames( dicomDir, detailedIDs[0], true ) );
+
+  // the index file gives the same results
+  const std::string cacheFileName = dataFinder.GetOutputFile( "IO.DicomSeriesScan.index" );
+  itksys::SystemTools::RemoveFile( cacheFileName.c_str() );
+  EXPECT_EQ( fileNames, sitk::ImageSeriesReader::GetDICOMSeriesFileNames( dicomDir, "", false, false, cacheFileName ) );
+  EXPECT_TRUE( itksys::SystemTools::FileExists( cacheFileName.c_str() ) );
+  EXPECT_EQ( fileNames, sitk::ImageSeriesReader::GetDICOMSeriesFileNames( dicomDir, "", false, false, cacheFileName ) );
+  EXPECT_EQ( detailedIDs, sitk::ImageSeriesReader::GetDICOMSeriesIDs( dicomDir, true, false, cacheFileName ) );
+
+  EXPECT_TRUE( sitk::ImageSeriesReader::GetDICOMSeriesIDs( dataFinder.GetDirectory( ) + "/Input/DoesNotExist" ).empty() );
+}
+
+
+TEST(IO, ReadDICOMTags) {
+
+  const std::string dicomDir = dataFinder.GetDirectory( ) + "/Input/DicomSeries";
+  std::vector< std::string > fileNames = sitk::ImageSeriesReader::GetDICOMSeriesFileNames( dicomDir );
+  ASSERT_EQ( 3u, fileNames.size() );
+  fileNames.push_back( dataFinder.GetFile( "Input/BlackDots.png" ) );
+  fileNames.push_back( dicomDir + "/DoesNotExist.dcm" );
+
+  std::vector< std::string > tags;
+  tags.push_back( "0020|000e" );
+  tags.push_back( "0020|0013" );
+  tags.push_back( "0028|0010" );
+  tags.push_back( "0008|0031" );
+  tags.push_back( "0009|1234" );
+
+  const std::vector< std::vector< std::string > > values = sitk::ImageFileReader::ReadDICOMTags( fileNames, tags );
+  ASSERT_EQ( fileNames.size(), values.size() );
+
+  // the values are those of the meta-data of the ImageFileReader
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    ASSERT_EQ( tags.size(), values[i].size() );
+    sitk::ImageFileReader reader;
+    reader.SetFileName( fileNames[i] );
+    reader.ReadImageInformation();
+    for ( unsigned int j = 0; j < tags.size(); ++j )
+      {
+      if ( reader.HasMetaDataKey( tags[j] ) )
+        {
+        EXPECT_EQ( reader.GetMetaData( tags[j] ), values[i][j] ) << fileNames[i] << " " << tags[j];
+        }
+      else
+        {
+        EXPECT_TRUE( values[i][j].empty() ) << fileNames[i] << " " << tags[j];
+        }
+      }
+    EXPECT_EQ( "153128", values[i][3] );
+    }
+
+  // files which are not DICOM have empty values
+  for ( unsigned int i = 3; i < fileNames.size(); ++i )
+    {
+    EXPECT_EQ( std::vector< std::string >( tags.size() ), values[i] );
+    }
+
+  EXPECT_TRUE( sitk::ImageFileReader::ReadDICOMTags( std::vector< std::string >(), tags ).empty() );
+  tags.push_back( "0020-000e" );
+  EXPECT_ANY_THROW( sitk::ImageFileReader::ReadDICOMTags( fileNames, tags ) );
 }
 
 
@@ -447,6 +633,72 @@ TEST(IO, ImageSeriesWriter )
 }
 
 
+TEST(IO, ImageSeriesWriter_ParallelWrite )
+{
+  sitk::ImageSeriesWriter writer;
+  EXPECT_FALSE( writer.GetUseParallelWrite() );
+  writer.UseParallelWriteOn();
+  EXPECT_TRUE( writer.GetUseParallelWrite() );
+  writer.SetNumberOfThreads( 3 );
+
+  std::vector< std::string > fileNames;
+  fileNames.push_back( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/WhiteDots.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  sitk::Image image = sitk::ReadImage( fileNames );
+  EXPECT_EQ ( "62fff5903956f108fbafd506e31c1e733e527820", sitk::Hash( image ) );
+
+  std::vector< std::string > outputFileNames;
+  for ( unsigned int i = 0; i < fileNames.size(); ++i )
+    {
+    std::ostringstream fn;
+    fn << dataFinder.GetOutputDirectory() << "/ImageSeriesWriter_ParallelWrite_" << i << ".png";
+    outputFileNames.push_back( fn.str() );
+    }
+
+  ProgressUpdate progressCmd(writer);
+  writer.AddCommand(sitk::sitkProgressEvent, progressCmd);
+
+  CountCommand progressCount(writer);
+  writer.AddCommand(sitk::sitkProgressEvent, progressCount);
+
+  CountCommand endCmd(writer);
+  writer.AddCommand(sitk::sitkEndEvent, endCmd);
+
+  writer.SetFileNames( outputFileNames );
+  EXPECT_NO_THROW( writer.Execute( image ) );
+  EXPECT_EQ ( 1.0, progressCmd.m_Progress );
+  EXPECT_GE ( progressCount.m_Count, 2 );
+  EXPECT_EQ ( 1, endCmd.m_Count );
+
+  EXPECT_EQ ( "62fff5903956f108fbafd506e31c1e733e527820", sitk::Hash( sitk::ReadImage( outputFileNames ) ) );
+  EXPECT_EQ ( "0188164c9932359b3f33f176d0d73661c4dc04a8", sitk::Hash( sitk::ReadImage( outputFileNames[3] ) ) );
+
+  // the number of file names must match the number of slices
+  outputFileNames.pop_back();
+  writer.SetFileNames( outputFileNames );
+  EXPECT_ANY_THROW( writer.Execute( image ) );
+
+  // vector pixels
+  fileNames.resize(0);
+  fileNames.push_back( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+  image = sitk::ReadImage( fileNames );
+  EXPECT_EQ ( "bb42b8d3991132b4860adbc4b3f6c38313f52b4c", sitk::Hash( image ) );
+
+  writer.SetFileNames( outputFileNames );
+  EXPECT_NO_THROW( writer.Execute( image ) );
+  EXPECT_EQ ( "bb42b8d3991132b4860adbc4b3f6c38313f52b4c", sitk::Hash( sitk::ReadImage( outputFileNames ) ) );
+
+  // the files must all be of the format of the first file
+  outputFileNames[1] = dataFinder.GetOutputDirectory() + "/ImageSeriesWriter_ParallelWrite_1.mha";
+  writer.SetFileNames( outputFileNames );
+  EXPECT_ANY_THROW( writer.Execute( image ) );
+}
+
+
 TEST(IO, VectorImageSeriesWriter )
 {
 
@@ -529,3 +781,1086 @@ TEST(IO, ImageFileReader_ImageInformation )
   EXPECT_VECTOR_NEAR(reader.GetSize(), v2( 179.0, 240.0), 1e-10);
   EXPECT_EQ( reader.GetMetaDataKeys().size(), 0u);
 }
+
+TEST(IO, ImageFileReader_ImageIO )
+{
+  const std::vector<std::string> ios = sitk::ImageFileReader::GetRegisteredImageIOs();
+  EXPECT_TRUE( std::find( ios.begin(), ios.end(), "PNGImageIO" ) != ios.end() );
+  EXPECT_TRUE( std::find( ios.begin(), ios.end(), "MetaImageIO" ) != ios.end() );
+
+  sitk::ImageFileReader reader;
+  EXPECT_EQ( "", reader.GetImageIO() );
+  reader.SetFileName( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  reader.SetImageIO( "PNGImageIO" );
+  EXPECT_EQ( "PNGImageIO", reader.GetImageIO() );
+  EXPECT_EQ ( "0188164c9932359b3f33f176d0d73661c4dc04a8", sitk::Hash( reader.Execute() ) );
+
+  reader.SetImageIO( "MetaImageIO" );
+  EXPECT_THROW( reader.Execute(), sitk::GenericException );
+  reader.SetImageIO( "NotAnImageIO" );
+  EXPECT_THROW( reader.ReadImageInformation(), sitk::GenericException );
+  reader.SetImageIO( "" );
+  EXPECT_NO_THROW( reader.ReadImageInformation() );
+
+  // the information of a modified file is read again
+  const std::string filename = dataFinder.GetOutputFile ( "IO.ImageFileReader_ImageIO.mha" );
+  sitk::WriteImage( sitk::Image( 10, 10, sitk::sitkUInt8 ), filename );
+  reader.SetFileName( filename );
+  reader.ReadImageInformation();
+  EXPECT_EQ( 10u, reader.GetSize()[0] );
+  sitk::WriteImage( sitk::Image( 12, 11, sitk::sitkUInt8 ), filename );
+  reader.ReadImageInformation();
+  EXPECT_EQ( 12u, reader.GetSize()[0] );
+  EXPECT_EQ( 11u, reader.Execute().GetHeight() );
+}
+
+TEST(IO, ImageFileReader_Extract )
+{
+  std::vector<unsigned int> size( 3 );
+  size[0] = 10;
+  size[1] = 12;
+  size[2] = 8;
+  sitk::Image image( size, sitk::sitkFloat32 );
+  image.SetOrigin( v3( 1.0, 2.0, 3.0 ) );
+  image.SetSpacing( v3( 0.5, 0.5, 2.0 ) );
+  float *buffer = image.GetBufferAsFloat();
+  for ( unsigned int i = 0; i < 10*12*8; ++i )
+    {
+    buffer[i] = static_cast<float>( i );
+    }
+
+  const std::string filename = dataFinder.GetOutputFile ( "IO.ImageFileReader_Extract.mha" );
+  sitk::WriteImage( image, filename );
+
+  std::vector<int> index( 3 );
+  index[0] = 2;
+  index[1] = 3;
+  index[2] = 4;
+  std::vector<unsigned int> extractSize( 3 );
+  extractSize[0] = 4;
+  extractSize[1] = 5;
+  extractSize[2] = 2;
+
+  sitk::ImageFileReader reader;
+  reader.SetFileName( filename );
+  EXPECT_TRUE( reader.GetExtractSize().empty() );
+  EXPECT_TRUE( reader.GetExtractIndex().empty() );
+  reader.SetExtractIndex( index );
+  reader.SetExtractSize( extractSize );
+  EXPECT_EQ( reader.GetExtractSize(), extractSize );
+  EXPECT_EQ( reader.GetExtractIndex(), index );
+
+  std::vector<uint32_t> idx( 3, 0 );
+  sitk::Image region = reader.Execute();
+  EXPECT_EQ( region.GetSize(), extractSize );
+  EXPECT_EQ( region.GetPixelAsFloat( idx ), 2.0f + 3.0f*10 + 4.0f*10*12 );
+  EXPECT_VECTOR_DOUBLE_NEAR( region.GetOrigin(), v3( 2.0, 3.5, 11.0 ), 1e-8 );
+  EXPECT_VECTOR_DOUBLE_NEAR( region.GetSpacing(), image.GetSpacing(), 1e-8 );
+  EXPECT_VECTOR_NEAR( reader.GetSize(), v3( 10.0, 12.0, 8.0 ), 1e-10 );
+
+  // collapse the last dimension, for a 2D slice
+  extractSize[2] = 0;
+  idx.resize( 2 );
+  idx[0] = 1;
+  idx[1] = 2;
+  sitk::Image slice = reader.SetExtractSize( extractSize ).Execute();
+  EXPECT_EQ( slice.GetDimension(), 2u );
+  EXPECT_EQ( slice.GetWidth(), 4u );
+  EXPECT_EQ( slice.GetHeight(), 5u );
+  EXPECT_EQ( slice.GetPixelAsFloat( idx ), 3.0f + 5.0f*10 + 4.0f*10*12 );
+  EXPECT_VECTOR_DOUBLE_NEAR( slice.GetOrigin(), v2( 2.0, 3.5 ), 1e-8 );
+
+  // a shorter index is padded with zeros
+  index.resize( 2 );
+  slice = reader.SetExtractIndex( index ).Execute();
+  EXPECT_EQ( slice.GetPixelAsFloat( idx ), 3.0f + 5.0f*10 );
+
+  extractSize[1] = 0;
+  EXPECT_THROW( reader.SetExtractSize( extractSize ).Execute(), sitk::GenericException );
+  extractSize.resize( 2 );
+  EXPECT_THROW( reader.SetExtractSize( extractSize ).Execute(), sitk::GenericException );
+  extractSize = std::vector<unsigned int>( 3, 9 );
+  EXPECT_THROW( reader.SetExtractSize( extractSize ).Execute(), sitk::GenericException );
+
+  sitk::Image whole = reader.SetExtractSize( std::vector<unsigned int>() ).Execute();
+  EXPECT_EQ( sitk::Hash( whole ), sitk::Hash( image ) );
+}
+
+TEST(IO, ImageFileWriter_Paste )
+{
+  std::vector<unsigned int> size( 3 );
+  size[0] = 20;
+  size[1] = 20;
+  size[2] = 5;
+  sitk::Image image( size, sitk::sitkUInt16 );
+  image.SetOrigin( v3( 1.0, 2.0, 3.0 ) );
+
+  const std::string filename = dataFinder.GetOutputFile ( "IO.ImageFileWriter_Paste.mha" );
+  sitk::WriteImage( image, filename );
+
+  std::vector<unsigned int> blockSize( 3 );
+  blockSize[0] = 5;
+  blockSize[1] = 4;
+  blockSize[2] = 2;
+  sitk::Image block( blockSize, sitk::sitkUInt16 );
+  uint16_t *buffer = block.GetBufferAsUInt16();
+  for ( unsigned int i = 0; i < 5*4*2; ++i )
+    {
+    buffer[i] = static_cast<uint16_t>( i + 1 );
+    }
+
+  std::vector<unsigned int> pasteIndex( 3 );
+  pasteIndex[0] = 3;
+  pasteIndex[1] = 6;
+  pasteIndex[2] = 1;
+
+  sitk::ImageFileWriter writer;
+  EXPECT_TRUE( writer.GetPasteIndex().empty() );
+  writer.SetFileName( filename );
+  writer.SetPasteIndex( pasteIndex );
+  EXPECT_EQ( writer.GetPasteIndex(), pasteIndex );
+  EXPECT_NO_THROW( writer.Execute( block ) );
+
+  sitk::Image result = sitk::ReadImage( filename );
+  EXPECT_EQ( result.GetSize(), size );
+  EXPECT_VECTOR_DOUBLE_NEAR( result.GetOrigin(), v3( 1.0, 2.0, 3.0 ), 1e-8 );
+
+  std::vector<uint32_t> idx( 3 );
+  idx[0] = 3;
+  idx[1] = 6;
+  idx[2] = 1;
+  EXPECT_EQ( result.GetPixelAsUInt16( idx ), 1u );
+  idx[0] = 7;
+  idx[1] = 9;
+  idx[2] = 2;
+  EXPECT_EQ( result.GetPixelAsUInt16( idx ), 40u );
+  idx[0] = 8;
+  EXPECT_EQ( result.GetPixelAsUInt16( idx ), 0u );
+  idx[0] = 2;
+  idx[2] = 1;
+  EXPECT_EQ( result.GetPixelAsUInt16( idx ), 0u );
+
+  // the region must be inside the file
+  pasteIndex[0] = 16;
+  EXPECT_THROW( writer.SetPasteIndex( pasteIndex ).Execute( block ), sitk::GenericException );
+  pasteIndex.resize( 2 );
+  EXPECT_THROW( writer.SetPasteIndex( pasteIndex ).Execute( block ), sitk::GenericException );
+
+  // the pixel type must match
+  pasteIndex = std::vector<unsigned int>( 3, 0 );
+  EXPECT_THROW( writer.SetPasteIndex( pasteIndex ).Execute( sitk::Image( blockSize, sitk::sitkFloat32 ) ), sitk::GenericException );
+
+  // the file must exist
+  writer.SetFileName( dataFinder.GetOutputFile ( "IO.ImageFileWriter_Paste_missing.mha" ) );
+  EXPECT_ANY_THROW( writer.Execute( block ) );
+}
+
+TEST(IO, ImageFileReader_MemoryMapping )
+{
+  std::vector<unsigned int> size( 3 );
+  size[0] = 17;
+  size[1] = 9;
+  size[2] = 4;
+  sitk::Image image( size, sitk::sitkFloat32 );
+  image.SetOrigin( v3( 1.0, 2.0, 3.0 ) );
+  image.SetSpacing( v3( 0.5, 1.5, 2.0 ) );
+  float *buffer = image.GetBufferAsFloat();
+  for ( unsigned int i = 0; i < 17*9*4; ++i )
+    {
+    buffer[i] = 0.25f * i;
+    }
+
+  const char *extensions[] = { ".mha", ".nrrd" };
+  for ( unsigned int e = 0; e < 2; ++e )
+    {
+    const std::string filename = dataFinder.GetOutputFile ( std::string( "IO.ImageFileReader_MemoryMapping" ) + extensions[e] );
+    sitk::ImageFileWriter writer;
+    writer.SetFileName( filename );
+    writer.UseCompressionOff();
+    writer.Execute( image );
+
+    sitk::ImageFileReader reader;
+    EXPECT_FALSE( reader.GetUseMemoryMapping() );
+    reader.SetFileName( filename );
+    reader.UseMemoryMappingOn();
+    EXPECT_TRUE( reader.GetUseMemoryMapping() );
+
+    sitk::Image mapped = reader.Execute();
+    EXPECT_EQ( sitk::Hash( mapped ), sitk::Hash( image ) ) << extensions[e];
+    EXPECT_EQ( mapped.GetSize(), size );
+    EXPECT_VECTOR_DOUBLE_NEAR( mapped.GetOrigin(), v3( 1.0, 2.0, 3.0 ), 1e-8 );
+    EXPECT_VECTOR_DOUBLE_NEAR( mapped.GetSpacing(), v3( 0.5, 1.5, 2.0 ), 1e-8 );
+
+    // writes to the mapped image do not change the file
+    mapped.GetBufferAsFloat()[0] = -1.0f;
+    EXPECT_FLOAT_EQ( mapped.GetBufferAsFloat()[0], -1.0f );
+    EXPECT_EQ( sitk::Hash( sitk::ReadImage( filename ) ), sitk::Hash( image ) ) << extensions[e];
+
+    // files which can not be mapped are read normally
+    reader.SetOutputPixelType( sitk::sitkFloat64 );
+    EXPECT_EQ( reader.Execute().GetPixelID(), sitk::sitkFloat64 );
+    }
+
+  sitk::ImageFileWriter writer;
+  const std::string filename = dataFinder.GetOutputFile ( "IO.ImageFileReader_MemoryMapping_compressed.mha" );
+  writer.SetFileName( filename );
+  writer.UseCompressionOn();
+  writer.Execute( image );
+
+  sitk::ImageFileReader reader;
+  reader.SetFileName( filename );
+  reader.UseMemoryMappingOn();
+  EXPECT_EQ( sitk::Hash( reader.Execute() ), sitk::Hash( image ) );
+}
+
+TEST(IO, ImageFileWriter_DirectIO )
+{
+  std::vector<unsigned int> size( 3 );
+  size[0] = 64;
+  size[1] = 33;
+  size[2] = 5;
+  sitk::Image image( size, sitk::sitkFloat32 );
+  image.SetOrigin( v3( 1.0, 2.0, 3.0 ) );
+  image.SetSpacing( v3( 0.5, 1.5, 2.0 ) );
+  float *buffer = image.GetBufferAsFloat();
+  for ( unsigned int i = 0; i < 64*33*5; ++i )
+    {
+    buffer[i] = 0.25f * i;
+    }
+  const std::string hash = sitk::Hash( image );
+
+  sitk::ImageFileWriter writer;
+  EXPECT_FALSE( writer.GetUseDirectIO() );
+  EXPECT_FALSE( writer.GetDropFromPageCache() );
+  EXPECT_EQ( 0u, writer.GetIOBlockSize() );
+  writer.UseDirectIOOn();
+  writer.DropFromPageCacheOn();
+  writer.SetIOBlockSize( 5000 );
+  EXPECT_TRUE( writer.GetUseDirectIO() );
+  EXPECT_TRUE( writer.GetDropFromPageCache() );
+  EXPECT_EQ( 5000u, writer.GetIOBlockSize() );
+  writer.ComputeHashOn();
+
+  sitk::ImageFileReader reader;
+  EXPECT_EQ( 0u, reader.GetIOBlockSize() );
+  EXPECT_FALSE( reader.GetUseSequentialReadAhead() );
+  reader.SetIOBlockSize( 3000 );
+  reader.UseSequentialReadAheadOn();
+  EXPECT_EQ( 3000u, reader.GetIOBlockSize() );
+  EXPECT_TRUE( reader.GetUseSequentialReadAhead() );
+
+  // the formats written normally are dropped from the page cache
+  const char *extensions[] = { ".mha", ".mhd", ".nrrd", ".nii" };
+  for ( unsigned int e = 0; e < 4; ++e )
+    {
+    const std::string filename = dataFinder.GetOutputFile ( std::string( "IO.ImageFileWriter_DirectIO" ) + extensions[e] );
+    writer.SetFileName( filename );
+    writer.Execute( image );
+    EXPECT_EQ( hash, writer.GetHash() ) << extensions[e];
+
+    EXPECT_EQ( hash, sitk::Hash( sitk::ReadImage( filename ) ) ) << extensions[e];
+
+    reader.SetFileName( filename );
+    sitk::Image read = reader.Execute();
+    EXPECT_EQ( hash, sitk::Hash( read ) ) << extensions[e];
+    EXPECT_VECTOR_DOUBLE_NEAR( read.GetOrigin(), image.GetOrigin(), 1e-8 );
+    EXPECT_VECTOR_DOUBLE_NEAR( read.GetSpacing(), image.GetSpacing(), 1e-8 );
+
+    std::vector<float> readBuffer( 64*33*5 );
+    read = reader.Execute( &readBuffer[0], readBuffer.size() * sizeof( float ) );
+    EXPECT_EQ( hash, sitk::Hash( read ) ) << extensions[e];
+    }
+
+  // writing over a larger file
+  std::vector<unsigned int> smallSize( 3, 4 );
+  sitk::Image small( smallSize, sitk::sitkInt16 );
+  std::vector<uint32_t> index( 3, 1 );
+  index[2] = 3;
+  small.SetPixelAsInt16( index, 7 );
+  writer.SetFileName( dataFinder.GetOutputFile ( "IO.ImageFileWriter_DirectIO.mha" ) );
+  writer.Execute( small );
+  EXPECT_EQ( sitk::Hash( small ), sitk::Hash( sitk::ReadImage( writer.GetFileName() ) ) );
+
+  // compressed files are written normally
+  writer.UseCompressionOn();
+  writer.Execute( image );
+  reader.SetFileName( writer.GetFileName() );
+  EXPECT_EQ( hash, sitk::Hash( reader.Execute() ) );
+}
+
+TEST(IO, ImageFileReader_RemoteFile )
+{
+  // a URL which can not be reached, an exception is thrown with or
+  // without remote file support
+  sitk::ImageFileReader reader;
+  reader.SetFileName( "http://127.0.0.1:1/image.mha" );
+  EXPECT_THROW( reader.ReadImageInformation(), sitk::GenericException );
+  EXPECT_THROW( reader.Execute(), sitk::GenericException );
+  EXPECT_EQ( "http://127.0.0.1:1/image.mha", reader.GetFileName() );
+
+  reader.SetFileName( "s3://bucket" );
+  EXPECT_THROW( reader.Execute(), sitk::GenericException );
+}
+
+TEST(IO, ImageFileReader_Buffer )
+{
+  sitk::ImageFileReader reader;
+  reader.SetFileName( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  reader.ReadImageInformation();
+  ASSERT_EQ( sitk::sitkUInt8, reader.GetPixelID() );
+
+  const size_t numberOfPixels = reader.GetSize()[0] * reader.GetSize()[1];
+  std::vector<uint8_t> buffer( numberOfPixels );
+
+  CountCommand endCmd(reader);
+  reader.AddCommand(sitk::sitkEndEvent, endCmd);
+
+  sitk::Image image = reader.Execute( &buffer[0], buffer.size() );
+  EXPECT_EQ ( "0188164c9932359b3f33f176d0d73661c4dc04a8", sitk::Hash( image ) );
+  EXPECT_EQ ( &buffer[0], image.GetBufferAsUInt8() );
+  EXPECT_EQ ( 1, endCmd.m_Count );
+
+  // the image refers to the buffer
+  buffer[0] = 42;
+  EXPECT_EQ ( 42u, image.GetPixelAsUInt8( std::vector<uint32_t>( 2, 0 ) ) );
+
+  EXPECT_ANY_THROW( reader.Execute( &buffer[0], buffer.size() - 1 ) );
+  EXPECT_ANY_THROW( reader.Execute( SITK_NULLPTR, buffer.size() ) );
+
+  reader.SetOutputPixelType( sitk::sitkFloat32 );
+  EXPECT_ANY_THROW( reader.Execute( &buffer[0], buffer.size() ) );
+  reader.SetOutputPixelType( sitk::sitkUnknown );
+
+  std::vector<unsigned int> extractSize( 2, 5 );
+  reader.SetExtractSize( extractSize );
+  EXPECT_ANY_THROW( reader.Execute( &buffer[0], buffer.size() ) );
+  reader.SetExtractSize( std::vector<unsigned int>() );
+
+  // vector pixels
+  reader.SetFileName( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+  reader.ReadImageInformation();
+  std::vector<uint8_t> rgbBuffer( reader.GetSize()[0] * reader.GetSize()[1] * reader.GetNumberOfComponents() );
+  image = reader.Execute( &rgbBuffer[0], rgbBuffer.size() );
+  EXPECT_EQ ( sitk::Hash( sitk::ReadImage( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) ) ), sitk::Hash( image ) );
+  EXPECT_EQ ( &rgbBuffer[0], image.GetBufferAsUInt8() );
+
+  // the reader is usable after reading into a buffer
+  reader.SetFileName( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  EXPECT_EQ ( "0188164c9932359b3f33f176d0d73661c4dc04a8", sitk::Hash( reader.Execute() ) );
+}
+
+namespace
+{
+std::vector<uint8_t> ReadFileBytes( const std::string &fileName )
+{
+  std::ifstream in( fileName.c_str(), std::ios::binary );
+  return std::vector<uint8_t>( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+}
+}
+
+TEST(IO, ImageMemoryIO )
+{
+  std::vector<unsigned int> size( 3 );
+  size[0] = 7;
+  size[1] = 5;
+  size[2] = 3;
+  sitk::Image image( size, sitk::sitkInt16 );
+  int16_t *buffer = image.GetBufferAsInt16();
+  for ( unsigned int i = 0; i < 7*5*3; ++i )
+    {
+    buffer[i] = static_cast<int16_t>( 3 * i - 50 );
+    }
+  image.SetOrigin( v3( 1.0, -2.0, 3.5 ) );
+  image.SetSpacing( v3( 0.5, 1.5, 2.0 ) );
+  std::vector<double> direction( 9, 0.0 );
+  direction[1] = 1.0;
+  direction[3] = -1.0;
+  direction[8] = 1.0;
+  image.SetDirection( direction );
+  image.SetMetaData( "Comment", "in memory" );
+
+  const std::string fileName = dataFinder.GetOutputFile ( "IO.ImageMemoryIO.mha" );
+  for ( int compress = 0; compress < 2; ++compress )
+    {
+    std::vector<uint8_t> bytes = sitk::WriteImageToMemory( image, "mha", compress != 0 );
+    sitk::Image result = sitk::ReadImageFromMemory( bytes );
+    EXPECT_EQ( sitk::Hash( image ), sitk::Hash( result ) ) << compress;
+    EXPECT_EQ( size, result.GetSize() );
+    EXPECT_VECTOR_DOUBLE_NEAR( image.GetOrigin(), result.GetOrigin(), 1e-8 );
+    EXPECT_VECTOR_DOUBLE_NEAR( image.GetSpacing(), result.GetSpacing(), 1e-8 );
+    EXPECT_VECTOR_DOUBLE_NEAR( direction, result.GetDirection(), 1e-8 );
+    ASSERT_TRUE( result.HasMetaDataKey( "Comment" ) );
+    EXPECT_EQ( "in memory", result.GetMetaData( "Comment" ) );
+
+    // the bytes are a MetaImage file
+    std::ofstream out( fileName.c_str(), std::ios::binary );
+    out.write( reinterpret_cast<const char *>( &bytes[0] ), bytes.size() );
+    out.close();
+    sitk::Image fromFile = sitk::ReadImage( fileName );
+    EXPECT_EQ( sitk::Hash( image ), sitk::Hash( fromFile ) ) << compress;
+    EXPECT_VECTOR_DOUBLE_NEAR( direction, fromFile.GetDirection(), 1e-8 );
+
+    if ( compress == 0 )
+      {
+      bytes.pop_back();
+      EXPECT_ANY_THROW( sitk::ReadImageFromMemory( bytes ) );
+      }
+    }
+
+  // a file written by the MetaImageIO
+  for ( int compress = 0; compress < 2; ++compress )
+    {
+    sitk::WriteImage( image, fileName, compress != 0 );
+    sitk::Image result = sitk::ReadImageFromMemory( ReadFileBytes( fileName ), ".mha" );
+    EXPECT_EQ( sitk::Hash( image ), sitk::Hash( result ) ) << compress;
+    EXPECT_VECTOR_DOUBLE_NEAR( image.GetOrigin(), result.GetOrigin(), 1e-8 );
+    EXPECT_VECTOR_DOUBLE_NEAR( direction, result.GetDirection(), 1e-8 );
+    }
+
+  // vector pixels
+  sitk::Image rgb = sitk::ReadImage( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+  sitk::Image rgbResult = sitk::ReadImageFromMemory( sitk::WriteImageToMemory( rgb, "MetaImage", true ), "MetaImage" );
+  EXPECT_EQ( sitk::Hash( rgb ), sitk::Hash( rgbResult ) );
+  EXPECT_EQ( 3u, rgbResult.GetNumberOfComponentsPerPixel() );
+
+  // other formats are not supported in memory
+  const std::vector<uint8_t> png = ReadFileBytes( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  EXPECT_ANY_THROW( sitk::ReadImageFromMemory( png ) );
+  EXPECT_ANY_THROW( sitk::ReadImageFromMemory( png, "png" ) );
+  EXPECT_ANY_THROW( sitk::WriteImageToMemory( image, "png" ) );
+  EXPECT_ANY_THROW( sitk::ReadImageFromMemory( std::vector<uint8_t>() ) );
+}
+
+TEST(IO, ChunkedImageIO )
+{
+  std::vector<unsigned int> size( 3 );
+  size[0] = 70;
+  size[1] = 50;
+  size[2] = 33;
+  sitk::Image image( size, sitk::sitkInt16 );
+  int16_t *buffer = image.GetBufferAsInt16();
+  for ( unsigned int i = 0; i < 70*50*33; ++i )
+    {
+    buffer[i] = static_cast<int16_t>( ( i % 70 ) + 100 * ( ( i / 70 ) % 50 ) - i / 3500 );
+    }
+  image.SetOrigin( v3( 1.0, -2.0, 3.5 ) );
+  image.SetSpacing( v3( 0.5, 1.5, 2.0 ) );
+  std::vector<double> direction( 9, 0.0 );
+  direction[1] = 1.0;
+  direction[3] = -1.0;
+  direction[8] = 1.0;
+  image.SetDirection( direction );
+
+  const std::string fileName = dataFinder.GetOutputFile ( "IO.ChunkedImageIO.sitkc" );
+  const std::string rawFileName = dataFinder.GetOutputFile ( "IO.ChunkedImageIO_raw.sitkc" );
+
+  sitk::ImageFileWriter writer;
+  EXPECT_TRUE( writer.GetChunkSize().empty() );
+  std::vector<unsigned int> chunkSize( 3 );
+  chunkSize[0] = 16;
+  chunkSize[1] = 16;
+  chunkSize[2] = 8;
+  writer.SetChunkSize( chunkSize );
+  EXPECT_EQ( chunkSize, writer.GetChunkSize() );
+  writer.SetNumberOfThreads( 3 );
+  writer.SetFileName( rawFileName );
+  writer.Execute( image );
+  writer.SetFileName( fileName );
+  writer.UseCompressionOn();
+  writer.Execute( image );
+  EXPECT_LT( itksys::SystemTools::FileLength( fileName.c_str() ), itksys::SystemTools::FileLength( rawFileName.c_str() ) );
+
+  const std::vector<std::string> imageIOs = sitk::ImageFileReader::GetRegisteredImageIOs();
+  EXPECT_TRUE( std::find( imageIOs.begin(), imageIOs.end(), "ChunkedImageIO" ) != imageIOs.end() );
+
+  const std::string files[] = { fileName, rawFileName };
+  for ( unsigned int f = 0; f < 2; ++f )
+    {
+    sitk::ImageFileReader reader;
+    reader.SetFileName( files[f] );
+    if ( f == 1 )
+      {
+      reader.SetImageIO( "ChunkedImageIO" );
+      }
+    sitk::Image result = reader.Execute();
+    EXPECT_EQ( sitk::Hash( image ), sitk::Hash( result ) ) << files[f];
+    EXPECT_VECTOR_DOUBLE_NEAR( image.GetOrigin(), result.GetOrigin(), 1e-8 );
+    EXPECT_VECTOR_DOUBLE_NEAR( image.GetSpacing(), result.GetSpacing(), 1e-8 );
+    EXPECT_VECTOR_DOUBLE_NEAR( direction, result.GetDirection(), 1e-8 );
+
+    // a region spanning several chunks
+    std::vector<int> extractIndex( 3 );
+    extractIndex[0] = 10;
+    extractIndex[1] = 30;
+    extractIndex[2] = 7;
+    std::vector<unsigned int> extractSize( 3 );
+    extractSize[0] = 25;
+    extractSize[1] = 20;
+    extractSize[2] = 10;
+    reader.SetExtractIndex( extractIndex );
+    reader.SetExtractSize( extractSize );
+    sitk::Image region = reader.Execute();
+    EXPECT_EQ( extractSize, region.GetSize() );
+    EXPECT_VECTOR_DOUBLE_NEAR( image.TransformIndexToPhysicalPoint( std::vector<int64_t>( extractIndex.begin(), extractIndex.end() ) ),
+                               region.GetOrigin(), 1e-8 );
+    bool same = true;
+    std::vector<uint32_t> idx( 3 );
+    std::vector<uint32_t> imageIdx( 3 );
+    for ( idx[2] = 0; idx[2] < extractSize[2]; ++idx[2] )
+      for ( idx[1] = 0; idx[1] < extractSize[1]; ++idx[1] )
+        for ( idx[0] = 0; idx[0] < extractSize[0]; ++idx[0] )
+          {
+          for ( unsigned int d = 0; d < 3; ++d )
+            {
+            imageIdx[d] = idx[d] + extractIndex[d];
+            }
+          same = same && region.GetPixelAsInt16( idx ) == image.GetPixelAsInt16( imageIdx );
+          }
+    EXPECT_TRUE( same ) << files[f];
+
+    // a slice of the volume
+    extractSize[2] = 0;
+    reader.SetExtractSize( extractSize );
+    EXPECT_EQ( 2u, reader.Execute().GetDimension() );
+    }
+
+  // vector pixels with the default chunk size
+  sitk::Image rgb = sitk::ReadImage( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+  writer.SetChunkSize( std::vector<unsigned int>() );
+  writer.SetFileName( fileName );
+  writer.Execute( rgb );
+  EXPECT_EQ( sitk::Hash( rgb ), sitk::Hash( sitk::ReadImage( fileName ) ) );
+
+  // the chunk size has more elements than the image dimension
+  chunkSize.push_back( 4 );
+  writer.SetChunkSize( chunkSize );
+  EXPECT_ANY_THROW( writer.Execute( image ) );
+  chunkSize.resize( 2 );
+  chunkSize[1] = 0;
+  writer.SetChunkSize( chunkSize );
+  EXPECT_ANY_THROW( writer.Execute( image ) );
+  writer.SetChunkSize( std::vector<unsigned int>() );
+  writer.SetCompressor( "LZW" );
+  EXPECT_ANY_THROW( writer.Execute( image ) );
+}
+
+TEST(IO, ChunkedImageIO_Pyramid )
+{
+  std::vector<unsigned int> size( 3 );
+  size[0] = 40;
+  size[1] = 31;
+  size[2] = 3;
+  sitk::Image image( size, sitk::sitkFloat32 );
+  float *buffer = image.GetBufferAsFloat();
+  for ( unsigned int i = 0; i < 40*31*3; ++i )
+    {
+    buffer[i] = static_cast<float>( i % 40 ) + 0.5f * ( ( i / 40 ) % 31 ) + 10.0f * ( i / 1240 );
+    }
+  image.SetOrigin( v3( 1.0, -2.0, 3.5 ) );
+  image.SetSpacing( v3( 0.5, 1.5, 2.0 ) );
+
+  const std::string fileName = dataFinder.GetOutputFile ( "IO.ChunkedImageIO_Pyramid.sitkc" );
+
+  sitk::ImageFileWriter writer;
+  EXPECT_EQ( 1u, writer.GetNumberOfPyramidLevels() );
+  writer.SetNumberOfPyramidLevels( 3 );
+  EXPECT_EQ( 3u, writer.GetNumberOfPyramidLevels() );
+  std::vector<unsigned int> chunkSize( 3, 8 );
+  writer.SetChunkSize( chunkSize );
+  writer.SetFileName( fileName );
+  writer.UseCompressionOn();
+  writer.Execute( image );
+
+  sitk::ImageFileReader reader;
+  EXPECT_EQ( 0u, reader.GetPyramidLevel() );
+  reader.SetFileName( fileName );
+  reader.ReadImageInformation();
+  EXPECT_EQ( 3u, reader.GetNumberOfPyramidLevels() );
+  EXPECT_EQ( sitk::Hash( image ), sitk::Hash( reader.Execute() ) );
+
+  // the size 3 dimension is shrunk to 1 pixel and then not shrunk
+  const unsigned int expectedSizes[3][3] = { { 40, 31, 3 }, { 20, 15, 1 }, { 10, 7, 1 } };
+  const double expectedFactors[3][3] = { { 1, 1, 1 }, { 2, 2, 2 }, { 4, 4, 2 } };
+  for ( unsigned int level = 0; level < 3; ++level )
+    {
+    reader.SetPyramidLevel( level );
+    EXPECT_EQ( level, reader.GetPyramidLevel() );
+    sitk::Image result = reader.Execute();
+    std::vector<double> expectedOrigin( 3 );
+    std::vector<double> expectedSpacing( 3 );
+    for ( unsigned int d = 0; d < 3; ++d )
+      {
+      EXPECT_EQ( expectedSizes[level][d], result.GetSize()[d] ) << "level " << level;
+      expectedSpacing[d] = image.GetSpacing()[d] * expectedFactors[level][d];
+      expectedOrigin[d] = image.GetOrigin()[d] + 0.5 * ( expectedFactors[level][d] - 1.0 ) * image.GetSpacing()[d];
+      }
+    EXPECT_VECTOR_DOUBLE_NEAR( expectedSpacing, result.GetSpacing(), 1e-8 );
+    EXPECT_VECTOR_DOUBLE_NEAR( expectedOrigin, result.GetOrigin(), 1e-8 );
+    EXPECT_EQ( reader.GetSize(), std::vector<uint64_t>( result.GetSize().begin(), result.GetSize().end() ) );
+    }
+
+  // a pixel of level 1 is the average of a 2x2x2 bin of the image
+  reader.SetPyramidLevel( 1 );
+  sitk::Image level1 = reader.Execute();
+  std::vector<uint32_t> idx( 3, 0 );
+  idx[0] = 3;
+  idx[1] = 5;
+  double sum = 0.0;
+  std::vector<uint32_t> imageIdx( 3 );
+  for ( imageIdx[2] = 0; imageIdx[2] < 2; ++imageIdx[2] )
+    for ( imageIdx[1] = 10; imageIdx[1] < 12; ++imageIdx[1] )
+      for ( imageIdx[0] = 6; imageIdx[0] < 8; ++imageIdx[0] )
+        {
+        sum += image.GetPixelAsFloat( imageIdx );
+        }
+  EXPECT_NEAR( sum / 8.0, level1.GetPixelAsFloat( idx ), 1e-5 );
+
+  // the levels are also read by region
+  std::vector<unsigned int> extractSize( 3, 1 );
+  extractSize[0] = 5;
+  extractSize[1] = 4;
+  reader.SetExtractSize( extractSize );
+  EXPECT_EQ( extractSize, reader.Execute().GetSize() );
+  reader.SetExtractSize( std::vector<unsigned int>() );
+
+  reader.SetPyramidLevel( 3 );
+  EXPECT_ANY_THROW( reader.Execute() );
+
+  // other file formats only have one level
+  sitk::ImageFileReader pngReader;
+  pngReader.SetFileName( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  pngReader.ReadImageInformation();
+  EXPECT_EQ( 1u, pngReader.GetNumberOfPyramidLevels() );
+  pngReader.SetPyramidLevel( 1 );
+  EXPECT_ANY_THROW( pngReader.Execute() );
+}
+
+TEST(IO, ImageFileReaderQueue )
+{
+  std::vector< std::string > fileNames;
+  fileNames.push_back( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/WhiteDots.png" ) );
+  fileNames.push_back( dataFinder.GetOutputFile ( "IO.ImageFileReaderQueue_missing.png" ) );
+  fileNames.push_back( dataFinder.GetFile ( "Input/VM1111Shrink-RGB.png" ) );
+
+  std::vector< std::string > expected;
+  for ( unsigned int i = 0; i < fileNames.size(); ++i )
+    {
+    expected.push_back( ( i == 2 ) ? std::string() : sitk::Hash( sitk::ReadImage( fileNames[i], sitk::sitkFloat32 ) ) );
+    }
+
+  sitk::ImageFileReaderQueue queue;
+  EXPECT_FALSE( queue.HasNext() );
+  EXPECT_THROW( queue.Next(), sitk::GenericException );
+
+  EXPECT_EQ( 2u, queue.GetNumberOfWorkers() );
+  EXPECT_EQ( 4u, queue.GetMaximumNumberOfPendingImages() );
+  queue.SetFileNames( fileNames );
+  queue.SetOutputPixelType( sitk::sitkFloat32 );
+  EXPECT_EQ( sitk::sitkFloat32, queue.GetOutputPixelType() );
+  EXPECT_NO_THROW( queue.ToString() );
+
+  for ( unsigned int workers = 1; workers <= 3; ++workers )
+    {
+    queue.SetNumberOfWorkers( workers );
+    queue.SetMaximumNumberOfPendingImages( workers );
+    queue.Start();
+    for ( unsigned int i = 0; i < fileNames.size(); ++i )
+      {
+      ASSERT_TRUE( queue.HasNext() );
+      if ( i == 2 )
+        {
+        EXPECT_THROW( queue.Next(), sitk::GenericException );
+        }
+      else
+        {
+        EXPECT_EQ( expected[i], sitk::Hash( queue.Next() ) ) << "file " << i << " with " << workers << " workers";
+        }
+      }
+    EXPECT_FALSE( queue.HasNext() );
+    EXPECT_THROW( queue.Next(), sitk::GenericException );
+    }
+
+  // restarting discards the pending images
+  queue.Start();
+  EXPECT_EQ( expected[0], sitk::Hash( queue.Next() ) );
+  queue.Start();
+  EXPECT_EQ( expected[0], sitk::Hash( queue.Next() ) );
+  queue.Stop();
+  EXPECT_FALSE( queue.HasNext() );
+}
+
+TEST(IO, ImageFileWriter_ParallelCompression )
+{
+  std::vector<unsigned int> size( 3, 64 );
+  sitk::Image image( size, sitk::sitkFloat32 );
+  image.SetSpacing( v3( 0.5, 0.75, 2.0 ) );
+  float *buffer = image.GetBufferAsFloat();
+  for ( unsigned int i = 0; i < 64*64*64; ++i )
+    {
+    buffer[i] = static_cast<float>( ( i * 7919u ) % 1000u ) * 0.5f;
+    }
+
+  sitk::ImageFileWriter writer;
+  EXPECT_FALSE( writer.GetUseParallelCompression() );
+  EXPECT_EQ( -1, writer.GetCompressionLevel() );
+  writer.UseCompressionOn();
+  writer.UseParallelCompressionOn();
+  EXPECT_TRUE( writer.GetUseParallelCompression() );
+  writer.SetNumberOfThreads( 4 );
+
+  const char *extensions[] = { ".mha", ".nrrd", ".nii.gz" };
+  for ( unsigned int e = 0; e < 3; ++e )
+    {
+    const std::string filename = dataFinder.GetOutputFile ( std::string( "IO.ImageFileWriter_ParallelCompression" ) + extensions[e] );
+    for ( int level = -1; level <= 9; level += 5 )
+      {
+      writer.SetCompressionLevel( level );
+      EXPECT_EQ( level, writer.GetCompressionLevel() );
+      writer.SetFileName( filename ).Execute( image );
+
+      sitk::Image result = sitk::ReadImage( filename );
+      EXPECT_EQ( sitk::Hash( image ), sitk::Hash( result ) ) << extensions[e] << " level " << level;
+      EXPECT_VECTOR_DOUBLE_NEAR( image.GetSpacing(), result.GetSpacing(), 1e-6 );
+      EXPECT_FALSE( itksys::SystemTools::FileExists( ( filename + ".sitk-tmp" + extensions[e] ).c_str() ) );
+      }
+
+    // the file is compressed
+    EXPECT_LT( itksys::SystemTools::FileLength( filename.c_str() ), 64u*64u*64u*sizeof(float) );
+    }
+
+  // levels above the zlib range are the best compression
+  writer.SetCompressionLevel( 12 );
+  EXPECT_EQ( 12, writer.GetCompressionLevel() );
+  const std::string filename = dataFinder.GetOutputFile ( "IO.ImageFileWriter_ParallelCompression_level.mha" );
+  writer.SetFileName( filename ).Execute( image );
+  EXPECT_EQ( sitk::Hash( image ), sitk::Hash( sitk::ReadImage( filename ) ) );
+}
+
+TEST(IO, ImageFileWriter_Compressor )
+{
+  sitk::Image image = sitk::ReadImage( dataFinder.GetFile ( "Input/BlackDots.png" ) );
+  const std::string hash = sitk::Hash( image );
+
+  sitk::ImageFileWriter writer;
+  EXPECT_EQ( "", writer.GetCompressor() );
+  writer.UseCompressionOn();
+
+  const char *compressors[] = { "PackBits", "Deflate", "lzw" };
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    const std::string filename = dataFinder.GetOutputFile ( std::string( "IO.ImageFileWriter_Compressor_" ) + compressors[i] + ".tif" );
+    writer.SetCompressor( compressors[i] );
+    EXPECT_EQ( compressors[i], writer.GetCompressor() );
+    writer.SetFileName( filename ).Execute( image );
+    EXPECT_EQ( hash, sitk::Hash( sitk::ReadImage( filename ) ) ) << compressors[i];
+    }
+
+  // the PNG compression level
+  writer.SetCompressor( "" );
+  const std::string pngFileName = dataFinder.GetOutputFile ( "IO.ImageFileWriter_Compressor.png" );
+  writer.SetCompressionLevel( 9 );
+  writer.SetFileName( pngFileName ).Execute( image );
+  EXPECT_EQ( hash, sitk::Hash( sitk::ReadImage( pngFileName ) ) );
+
+  // lossy JPEG quality
+  const std::string jpegFileName = dataFinder.GetOutputFile ( "IO.ImageFileWriter_Compressor.jpg" );
+  writer.SetCompressionLevel( 100 );
+  writer.SetFileName( jpegFileName ).Execute( image );
+  EXPECT_EQ( image.GetSize(), sitk::ReadImage( jpegFileName ).GetSize() );
+
+  // the compressor is not checked without compression
+  writer.SetCompressor( "LZW" );
+  writer.UseCompressionOff();
+  writer.SetFileName( pngFileName ).Execute( image );
+  EXPECT_EQ( hash, sitk::Hash( sitk::ReadImage( pngFileName ) ) );
+
+  sitk::ImageSeriesWriter seriesWriter;
+  EXPECT_EQ( "", seriesWriter.GetCompressor() );
+  EXPECT_EQ( -1, seriesWriter.GetCompressionLevel() );
+  std::vector<std::string> fileNames;
+  fileNames.push_back( dataFinder.GetOutputFile ( "IO.ImageSeriesWriter_Compressor_0.tif" ) );
+  fileNames.push_back( dataFinder.GetOutputFile ( "IO.ImageSeriesWriter_Compressor_1.tif" ) );
+  std::vector<unsigned int> size( 3, 8 );
+  size[2] = 2;
+  sitk::Image volume( size, sitk::sitkUInt8 );
+  volume.SetPixelAsUInt8( std::vector<uint32_t>( 3, 1 ), 42 );
+  seriesWriter.SetFileNames( fileNames );
+  seriesWriter.SetCompressor( "LZW" );
+  seriesWriter.SetCompressionLevel( 5 );
+  EXPECT_EQ( "LZW", seriesWriter.GetCompressor() );
+  EXPECT_EQ( 5, seriesWriter.GetCompressionLevel() );
+  seriesWriter.UseCompressionOn().Execute( volume );
+  EXPECT_EQ( sitk::Hash( volume ), sitk::Hash( sitk::ReadImage( fileNames ) ) );
+}
+
+
+TEST(IO, SharedMemoryImage)
+{
+  const std::string name = "sitkIOSharedMemoryImageTest";
+  try
+    {
+    sitk::UnlinkSharedMemoryImage( name );
+    }
+  catch ( sitk::GenericException & )
+    {
+    // not left by a previous run
+    }
+
+  std::vector<unsigned int> size( 3 );
+  size[0] = 7;
+  size[1] = 5;
+  size[2] = 3;
+  sitk::Image image = sitk::CreateSharedMemoryImage( name, size, sitk::sitkVectorFloat32, 2 );
+  EXPECT_EQ( sitk::sitkVectorFloat32, image.GetPixelID() );
+  EXPECT_EQ( 2u, image.GetNumberOfComponentsPerPixel() );
+  EXPECT_EQ( size, image.GetSize() );
+  EXPECT_EQ( 0.0f, image.GetPixelAsVectorFloat32( std::vector<uint32_t>( 3, 1 ) )[1] );
+  EXPECT_ANY_THROW( sitk::CreateSharedMemoryImage( name, size, sitk::sitkUInt8 ) ) << "the name exists";
+
+  std::vector<float> value( 2, 3.5f );
+  image.SetPixelAsVectorFloat32( std::vector<uint32_t>( 3, 1 ), value );
+  image.SetOrigin( v3( 1.0, -2.0, 3.5 ) );
+  image.SetSpacing( v3( 0.5, 1.5, 2.0 ) );
+
+  const std::string handle = sitk::GetSharedMemoryImageHandle( image );
+  {
+  sitk::Image attached = sitk::AttachSharedMemoryImage( handle );
+  EXPECT_EQ( sitk::Hash( image ), sitk::Hash( attached ) );
+  EXPECT_EQ( image.GetPixelID(), attached.GetPixelID() );
+  EXPECT_VECTOR_DOUBLE_NEAR( image.GetOrigin(), attached.GetOrigin(), 1e-8 );
+  EXPECT_VECTOR_DOUBLE_NEAR( image.GetSpacing(), attached.GetSpacing(), 1e-8 );
+  EXPECT_NE( static_cast<const sitk::Image &>( image ).GetBufferAsVoid(),
+             static_cast<const sitk::Image &>( attached ).GetBufferAsVoid() ) << " mapped twice";
+
+  // the pixels are shared
+  value[0] = -1.0f;
+  attached.SetPixelAsVectorFloat32( std::vector<uint32_t>( 3, 2 ), value );
+  EXPECT_EQ( -1.0f, image.GetPixelAsVectorFloat32( std::vector<uint32_t>( 3, 2 ) )[0] );
+  EXPECT_EQ( handle, sitk::GetSharedMemoryImageHandle( attached ) );
+  }
+
+  sitk::Image copy = sitk::CopyImageToSharedMemory( image, name + "Copy" );
+  EXPECT_EQ( sitk::Hash( image ), sitk::Hash( copy ) );
+  EXPECT_VECTOR_DOUBLE_NEAR( image.GetOrigin(), copy.GetOrigin(), 1e-8 );
+  sitk::UnlinkSharedMemoryImage( name + "Copy" );
+
+  // the mapped images remain valid after the name is removed
+  sitk::UnlinkSharedMemoryImage( name );
+  EXPECT_EQ( 3.5f, image.GetPixelAsVectorFloat32( std::vector<uint32_t>( 3, 1 ) )[1] );
+
+  EXPECT_ANY_THROW( sitk::GetSharedMemoryImageHandle( sitk::Image( size, sitk::sitkUInt8 ) ) );
+  EXPECT_ANY_THROW( sitk::AttachSharedMemoryImage( "not a handle" ) );
+  EXPECT_ANY_THROW( sitk::CreateSharedMemoryImage( "a/b", size, sitk::sitkUInt8 ) );
+  EXPECT_ANY_THROW( sitk::CreateSharedMemoryImage( name, size, sitk::sitkComplexFloat32 ) );
+}
+
+
+TEST(IO, CompressedImageStore)
+{
+  // a label image which compresses well
+  std::vector<unsigned int> size( 3 );
+  size[0] = 200;
+  size[1] = 100;
+  size[2] = 20;
+  sitk::Image labels( size, sitk::sitkUInt8 );
+  std::vector<uint32_t> index( 3 );
+  for ( index[2] = 5; index[2] < 15; ++index[2] )
+    {
+    for ( index[1] = 20; index[1] < 60; ++index[1] )
+      {
+      for ( index[0] = 50; index[0] < 150; ++index[0] )
+        {
+        labels.SetPixelAsUInt8( index, 1 + index[0] / 50 );
+        }
+      }
+    }
+  labels.SetOrigin( v3( 1.0, -2.0, 3.5 ) );
+  labels.SetSpacing( v3( 0.5, 1.5, 2.0 ) );
+  const uint64_t labelBytes = 200 * 100 * 20;
+
+  sitk::Image vectors( 30, 20, sitk::sitkVectorFloat32 );
+  std::vector<float> value( 2, 3.5f );
+  vectors.SetPixelAsVectorFloat32( std::vector<uint32_t>( 2, 1 ), value );
+  const uint64_t vectorBytes = 30 * 20 * 2 * 4;
+
+  sitk::CompressedImageStore store;
+  EXPECT_EQ( 0u, store.GetMaximumMemory() );
+  EXPECT_EQ( 1, store.GetCompressionLevel() );
+  store.SetChunkSize( 64 * 1024 );
+  EXPECT_ANY_THROW( store.SetCompressionLevel( 0 ) );
+  EXPECT_ANY_THROW( store.SetChunkSize( 0 ) );
+
+  // without a budget the images stay uncompressed
+  store.Insert( "labels", labels );
+  EXPECT_TRUE( store.Contains( "labels" ) );
+  EXPECT_FALSE( store.IsCompressed( "labels" ) );
+  EXPECT_EQ( labelBytes, store.GetMemoryUsed() );
+  EXPECT_EQ( sitk::Hash( labels ), sitk::Hash( store.Get( "labels" ) ) );
+
+  // a budget below the images compresses the least recently used
+  store.Insert( "vectors", vectors );
+  store.SetMaximumMemory( labelBytes / 2 );
+  EXPECT_TRUE( store.IsCompressed( "labels" ) );
+  EXPECT_FALSE( store.IsCompressed( "vectors" ) );
+  EXPECT_LT( store.GetCompressedMemory(), labelBytes / 20 );
+  EXPECT_EQ( vectorBytes + store.GetCompressedMemory(), store.GetMemoryUsed() );
+
+  // the image is decompressed on access, and the chunks are kept
+  const uint64_t compressedMemory = store.GetCompressedMemory();
+  sitk::Image restored = store.Get( "labels" );
+  EXPECT_EQ( sitk::Hash( labels ), sitk::Hash( restored ) );
+  EXPECT_EQ( labels.GetPixelID(), restored.GetPixelID() );
+  EXPECT_EQ( labels.GetSize(), restored.GetSize() );
+  EXPECT_VECTOR_DOUBLE_NEAR( labels.GetOrigin(), restored.GetOrigin(), 1e-8 );
+  EXPECT_VECTOR_DOUBLE_NEAR( labels.GetSpacing(), restored.GetSpacing(), 1e-8 );
+  EXPECT_FALSE( store.IsCompressed( "labels" ) );
+  EXPECT_TRUE( store.IsCompressed( "vectors" ) );
+  EXPECT_EQ( "labels", store.GetKeys()[0] );
+
+  // modifying the image returned does not modify the store
+  restored.SetPixelAsUInt8( std::vector<uint32_t>( 3, 0 ), 9 );
+  store.Compress( "labels" );
+  EXPECT_GE( store.GetCompressedMemory(), compressedMemory );
+  EXPECT_EQ( sitk::Hash( labels ), sitk::Hash( store.Get( "labels" ) ) );
+
+  sitk::Image restoredVectors = store.Get( "vectors" );
+  EXPECT_EQ( sitk::Hash( vectors ), sitk::Hash( restoredVectors ) );
+  EXPECT_EQ( 2u, restoredVectors.GetNumberOfComponentsPerPixel() );
+  EXPECT_EQ( 3.5f, restoredVectors.GetPixelAsVectorFloat32( std::vector<uint32_t>( 2, 1 ) )[1] );
+
+  store.Remove( "vectors" );
+  EXPECT_FALSE( store.Contains( "vectors" ) );
+  EXPECT_EQ( 1u, store.GetNumberOfImages() );
+  EXPECT_ANY_THROW( store.Get( "vectors" ) );
+
+  store.Clear();
+  EXPECT_EQ( 0u, store.GetNumberOfImages() );
+  EXPECT_EQ( 0u, store.GetMemoryUsed() );
+}
+
+
+namespace
+{
+
+// The sum of the 4-connected neighbours of each pixel, inside of the
+// image
+class NeighbourSum
+  : public sitk::DistributedTileExecutor::TileFunction
+{
+public:
+  sitk::Image Execute( const sitk::Image &tile )
+    {
+      const std::vector<unsigned int> size = tile.GetSize();
+      sitk::Image result( size, sitk::sitkFloat32 );
+      std::vector<uint32_t> idx( 2 );
+      for ( idx[1] = 0; idx[1] < size[1]; ++idx[1] )
+        {
+        for ( idx[0] = 0; idx[0] < size[0]; ++idx[0] )
+          {
+          float sum = 0.0f;
+          for ( unsigned int d = 0; d < 2; ++d )
+            {
+            std::vector<uint32_t> n = idx;
+            if ( idx[d] > 0 )
+              {
+              n[d] = idx[d] - 1;
+              sum += tile.GetPixelAsFloat( n );
+              }
+            if ( idx[d] + 1 < size[d] )
+              {
+              n[d] = idx[d] + 1;
+              sum += tile.GetPixelAsFloat( n );
+              }
+            }
+          result.SetPixelAsFloat( idx, sum );
+          }
+        }
+      return result;
+    }
+};
+
+// The ranks of one job run one after the other in this process, so
+// that rank 0, which assembles the output, runs last.
+class SequentialTransport
+  : public sitk::DistributedTileExecutor::Transport
+{
+public:
+  SequentialTransport( unsigned int rank, unsigned int numberOfRanks )
+    : m_Rank( rank ), m_NumberOfRanks( numberOfRanks ) {}
+  unsigned int GetRank( ) const { return m_Rank; }
+  unsigned int GetNumberOfRanks( ) const { return m_NumberOfRanks; }
+  void Barrier( ) {}
+private:
+  unsigned int m_Rank;
+  unsigned int m_NumberOfRanks;
+};
+
+}
+
+TEST(IO, DistributedTileExecutor)
+{
+  namespace sitk = itk::simple;
+
+  const std::string inputFileName = dataFinder.GetOutputFile ( "IO.DistributedTileExecutor_input.sitkc" );
+  const std::string outputFileName = dataFinder.GetOutputFile ( "IO.DistributedTileExecutor.sitkc" );
+
+  sitk::Image input( 37, 29, sitk::sitkFloat32 );
+  std::vector<uint32_t> idx( 2 );
+  for ( idx[1] = 0; idx[1] < 29; ++idx[1] )
+    {
+    for ( idx[0] = 0; idx[0] < 37; ++idx[0] )
+      {
+      input.SetPixelAsFloat( idx, static_cast<float>( ( idx[0] * 7 + idx[1] * 13 ) % 17 ) );
+      }
+    }
+  input.SetOrigin( v2( 1.5, -2.0 ) );
+  input.SetSpacing( v2( 0.5, 2.0 ) );
+
+  sitk::ImageFileWriter writer;
+  writer.SetChunkSize( std::vector<unsigned int>( 2, 8 ) );
+  writer.Execute( input, inputFileName, true );
+
+  NeighbourSum function;
+  const sitk::Image expected = function.Execute( input );
+
+  sitk::DistributedTileExecutor executor;
+  EXPECT_ANY_THROW( executor.SetTileSize( std::vector<unsigned int>( 2, 0 ) ) );
+  executor.SetTileSize( std::vector<unsigned int>( 2, 10 ) );
+  executor.SetHaloRadius( std::vector<unsigned int>( 2, 1 ) );
+  EXPECT_ANY_THROW( executor.Execute( inputFileName, dataFinder.GetOutputFile ( "IO.DistributedTileExecutor.nrrd" ), function ) );
+
+  // a single process
+  executor.Execute( inputFileName, outputFileName, function );
+  EXPECT_EQ( 12u, executor.GetNumberOfTiles() );
+  sitk::Image output = sitk::ReadImage( outputFileName );
+  EXPECT_EQ( sitk::Hash( expected ), sitk::Hash( output ) );
+  EXPECT_VECTOR_DOUBLE_NEAR( input.GetOrigin(), output.GetOrigin(), 1e-8 );
+  EXPECT_VECTOR_DOUBLE_NEAR( input.GetSpacing(), output.GetSpacing(), 1e-8 );
+  EXPECT_FALSE( itksys::SystemTools::FileExists( outputFileName + ".tile0.sitkc" ) );
+
+  // three ranks, each processing a third of the tiles
+  itksys::SystemTools::RemoveFile( outputFileName );
+  for ( unsigned int rank = 3; rank > 0; --rank )
+    {
+    SequentialTransport transport( rank - 1, 3 );
+    executor.SetTransport( &transport );
+    executor.Execute( inputFileName, outputFileName, function );
+    EXPECT_EQ( rank == 1, itksys::SystemTools::FileExists( outputFileName ) );
+    }
+  executor.SetTransport( SITK_NULLPTR );
+  EXPECT_EQ( sitk::Hash( expected ), sitk::Hash( sitk::ReadImage( outputFileName ) ) );
+
+  // a region of the output only decodes its tiles
+  sitk::ImageFileReader reader;
+  reader.SetFileName( outputFileName );
+  reader.SetExtractIndex( std::vector<int>( 2, 9 ) );
+  reader.SetExtractSize( std::vector<unsigned int>( 2, 3 ) );
+  sitk::Image region = reader.Execute();
+  idx[0] = 10;
+  idx[1] = 11;
+  std::vector<uint32_t> regionIdx( 2 );
+  regionIdx[0] = 1;
+  regionIdx[1] = 2;
+  EXPECT_EQ( expected.GetPixelAsFloat( idx ), region.GetPixelAsFloat( regionIdx ) );
+}
@@ -210,6 +210,48 @@ TEST_F(sitkRegistrationMethodTest, Metric_Evaluate)
   EXPECT_NEAR(3.34e-09 ,R3.MetricEvaluate(fixedBlobs,movingBlobs), 1e-10);
 }
 
+TEST_F(sitkRegistrationMethodTest, Metric_EvaluateBatch)
+{
+  sitk::Image fixed = fixedBlobs;
+  sitk::Image moving = fixedBlobs;
+
+  sitk::ImageRegistrationMethod R;
+  R.SetMetricAsMeanSquares();
+  R.SetInitialTransform(sitk::TranslationTransform(fixed.GetDimension()));
+
+  std::vector< std::vector<double> > parameters;
+  parameters.push_back(v2(0,0));
+  parameters.push_back(v2(5,-7));
+  parameters.push_back(v2(-2,1));
+  parameters.push_back(v2(3,3));
+  parameters.push_back(v2(1.5,-0.5));
+
+  std::vector<double> values = R.MetricEvaluate(fixed, moving, parameters);
+  ASSERT_EQ(parameters.size(), values.size());
+  EXPECT_NEAR(0.0, values[0], 1e-10);
+  EXPECT_NEAR(0.0036468516797954148, values[1], 1e-10);
+  EXPECT_TRUE(R.GetMetricDerivatives().empty());
+
+  // the initial transform is not changed
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0,0), R.GetInitialTransform().GetParameters(), 1e-10);
+
+  // the same values with the evaluations spread between metrics
+  std::vector<double> parallelValues = R.MetricEvaluate(fixed, moving, parameters, 3u, true);
+  ASSERT_EQ(parameters.size(), parallelValues.size());
+  ASSERT_EQ(parameters.size(), R.GetMetricDerivatives().size());
+  for ( unsigned int i = 0; i < parameters.size(); ++i )
+    {
+    R.SetInitialTransform(sitk::TranslationTransform(fixed.GetDimension(),parameters[i]));
+    EXPECT_NEAR(R.MetricEvaluate(fixed, moving), values[i], 1e-10) << "parameters: " << i;
+    EXPECT_NEAR(values[i], parallelValues[i], 1e-10) << "parameters: " << i;
+    EXPECT_EQ(2u, R.GetMetricDerivatives()[i].size());
+    }
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0,0), R.GetMetricDerivatives()[0], 1e-10);
+
+  parameters.push_back(std::vector<double>(3, 0.0));
+  EXPECT_THROW(R.MetricEvaluate(fixed, moving, parameters), sitk::GenericException);
+}
+
 TEST_F(sitkRegistrationMethodTest, Transform_InPlaceOn)
 {
   // This test is to check the inplace operation of the initial
@@ -270,6 +312,534 @@ TEST_F(sitkRegistrationMethodTest, Transform_InPlaceOn)
 
 }
 
+TEST_F(sitkRegistrationMethodTest, ExecuteBatch)
+{
+  // This test is to check the registration of many moving images to
+  // one fixed image, sequentially and in parallel
+  sitk::ImageRegistrationMethod R;
+
+  R.SetOptimizerAsRegularStepGradientDescent(1.0, 1e-4, 100, 0.5, 1e-10);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+
+  sitk::TranslationTransform tx(fixedBlobs.GetDimension());
+  tx.SetOffset(v2(0.5,-0.5));
+  R.SetInitialTransform(tx,true);
+
+  const double offsets[] = { -4.0, 0.0, 5.0 };
+  std::vector<sitk::Image> movingImages;
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    movingImages.push_back( MakeDualGaussianBlobs(v2(64+offsets[i],64), v2(192+offsets[i],192), std::vector<unsigned int>(2,256)) );
+    }
+
+  IterationUpdate cmd(R);
+  R.AddCommand(sitk::sitkIterationEvent, cmd);
+
+  std::vector<sitk::Transform> sequential = R.ExecuteBatch(fixedBlobs, movingImages);
+  ASSERT_EQ(3u, sequential.size());
+
+  std::vector<sitk::Transform> parallel = R.ExecuteBatch(fixedBlobs, movingImages, 2);
+  ASSERT_EQ(3u, parallel.size());
+
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    EXPECT_VECTOR_DOUBLE_NEAR(v2(offsets[i],0.0), sequential[i].GetParameters(), 1e-2) << " moving image " << i;
+    EXPECT_VECTOR_DOUBLE_NEAR(sequential[i].GetParameters(), parallel[i].GetParameters(), 1e-4) << " moving image " << i;
+    }
+
+  // expect the initial transform not to be modified
+  EXPECT_EQ(v2(0.5,-0.5), tx.GetParameters());
+
+  EXPECT_TRUE(R.ExecuteBatch(fixedBlobs, std::vector<sitk::Image>(), 4).empty());
+
+  // errors in the parallel registrations are reported
+  movingImages.push_back( sitk::Image(10,10,10,sitk::sitkFloat32) );
+  EXPECT_THROW(R.ExecuteBatch(fixedBlobs, movingImages, 2), sitk::GenericException);
+}
+
+TEST_F(sitkRegistrationMethodTest, ExecuteMultiStart)
+{
+  // This test is to check the continuation of the best of several
+  // initial transforms
+  sitk::ImageRegistrationMethod R;
+
+  sitk::Image fixed = fixedBlobs;
+  sitk::Image moving = fixedBlobs;
+
+  R.SetOptimizerAsRegularStepGradientDescent(1.0, 1e-4, 100, 0.5, 1e-10);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+
+  std::vector<sitk::Transform> starts;
+  starts.push_back(sitk::TranslationTransform(fixed.GetDimension(), v2(60.0,-70.0)));
+  starts.push_back(sitk::TranslationTransform(fixed.GetDimension(), v2(1.5,-2.0)));
+  starts.push_back(sitk::TranslationTransform(fixed.GetDimension(), v2(-3.0,3.0)));
+
+  std::vector<sitk::Transform> results = R.ExecuteMultiStart(fixed, moving, starts, 5, 2);
+  ASSERT_EQ(2u, results.size());
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), results[0].GetParameters(), 1e-3);
+  EXPECT_EQ("TranslationTransform", results[0].GetName());
+  EXPECT_NEAR(0.0, R.GetMetricValue(), 1e-6);
+
+  // expect the initial transforms not to be modified
+  EXPECT_EQ(v2(60.0,-70.0), starts[0].GetParameters());
+  EXPECT_EQ(v2(1.5,-2.0), starts[1].GetParameters());
+
+  results = R.ExecuteMultiStart(fixed, moving, starts, 0);
+  ASSERT_EQ(1u, results.size());
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), results[0].GetParameters(), 1e-3);
+
+  EXPECT_THROW(R.ExecuteMultiStart(fixed, moving, std::vector<sitk::Transform>(), 5), sitk::GenericException);
+  EXPECT_THROW(R.ExecuteMultiStart(fixed, moving, starts, 5, 0), sitk::GenericException);
+}
+
+TEST_F(sitkRegistrationMethodTest, PyramidCache)
+{
+  // This test is to check that repeated multi-resolution executions
+  // with cached smoothed images give the same results
+  sitk::ImageRegistrationMethod R;
+
+  sitk::Image fixed = fixedBlobs;
+  sitk::Image moving = fixedBlobs;
+
+  R.SetOptimizerAsRegularStepGradientDescent(1.0, 1e-4, 100, 0.5, 1e-10);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+  R.SetShrinkFactorsPerLevel(std::vector<unsigned int>(2,1));
+  R.SetSmoothingSigmasPerLevel(v2(4.0,1.0));
+
+  sitk::TranslationTransform tx(fixed.GetDimension(), v2(1.1,-2.2));
+
+  R.SetInitialTransform(tx,false);
+  const sitk::Transform outTx1 = R.Execute(fixed,moving);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), outTx1.GetParameters(), 1e-3);
+
+  R.SetInitialTransform(tx,false);
+  const sitk::Transform outTx2 = R.Execute(fixed,moving);
+  EXPECT_VECTOR_DOUBLE_NEAR(outTx1.GetParameters(), outTx2.GetParameters(), 1e-10);
+
+  R.ClearCache();
+  R.SetInitialTransform(tx,false);
+  const sitk::Transform outTx3 = R.Execute(fixed,moving);
+  EXPECT_VECTOR_DOUBLE_NEAR(outTx1.GetParameters(), outTx3.GetParameters(), 1e-10);
+
+  // changing the smoothing of the levels is not served from the cache
+  R.SetSmoothingSigmasPerLevel(v2(0.0,0.0));
+  R.SetInitialTransform(tx,false);
+  const sitk::Transform outTx4 = R.Execute(fixed,moving);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), outTx4.GetParameters(), 1e-3);
+}
+
+TEST_F(sitkRegistrationMethodTest, MultiResolutionScheduleFromImage)
+{
+  sitk::ImageRegistrationMethod R;
+
+  // isotropic, shrunk until 64x64 pixels
+  R.SetMultiResolutionScheduleFromImage(fixedBlobs);
+  ASSERT_EQ(3u, R.GetShrinkFactorsPerDimensionPerLevel().size());
+  EXPECT_EQ(std::vector<unsigned int>(2,4), R.GetShrinkFactorsPerDimensionPerLevel()[0]);
+  EXPECT_EQ(std::vector<unsigned int>(2,2), R.GetShrinkFactorsPerDimensionPerLevel()[1]);
+  EXPECT_EQ(std::vector<unsigned int>(2,1), R.GetShrinkFactorsPerDimensionPerLevel()[2]);
+
+  // the coarse dimension is not shrunk
+  sitk::Image anisotropic(256, 64, sitk::sitkFloat32);
+  anisotropic.SetSpacing(v2(1.0,4.0));
+  R.SetMultiResolutionScheduleFromImage(anisotropic, 4096u, 2u);
+  ASSERT_EQ(2u, R.GetShrinkFactorsPerDimensionPerLevel().size());
+  EXPECT_EQ(2u, R.GetShrinkFactorsPerDimensionPerLevel()[0][0]);
+  EXPECT_EQ(1u, R.GetShrinkFactorsPerDimensionPerLevel()[0][1]);
+
+  R.SetMultiResolutionScheduleFromImage(fixedBlobs);
+  R.SetOptimizerAsRegularStepGradientDescent(2.0, 1e-4, 100, 0.5, 1e-10);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsCorrelation();
+
+  sitk::TranslationTransform tx(fixedBlobs.GetDimension());
+  R.SetInitialTransform(tx);
+  sitk::Transform outTx = R.Execute(fixedBlobs, movingBlobs);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(-10,10), outTx.GetParameters(), 1e-2);
+  EXPECT_EQ(3u, R.GetProfileLevelNumberOfValidPoints().size());
+}
+
+namespace
+{
+class StopRegistrationCommand
+  : public itk::simple::Command
+{
+public:
+  StopRegistrationCommand(sitk::ImageRegistrationMethod &r, unsigned int iteration)
+    : m_Method(r), m_Iteration(iteration)
+    {}
+
+  virtual void Execute( )
+    {
+      if ( m_Method.GetOptimizerIteration() >= m_Iteration )
+        {
+        m_Method.StopRegistration();
+        }
+    }
+private:
+  sitk::ImageRegistrationMethod &m_Method;
+  unsigned int m_Iteration;
+};
+}
+
+TEST_F(sitkRegistrationMethodTest, StoppingCriteria)
+{
+  // This test is to check the stopping criteria applied across all
+  // the levels of the registration
+  sitk::ImageRegistrationMethod R;
+
+  sitk::Image fixed = fixedBlobs;
+  sitk::Image moving = fixedBlobs;
+
+  R.SetOptimizerAsGradientDescent(1e-6, 100, 1e-20, 100);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+  R.SetShrinkFactorsPerLevel(std::vector<unsigned int>(2,1));
+  R.SetSmoothingSigmasPerLevel(v2(1.0,0.0));
+
+  EXPECT_EQ(0u, R.GetMaximumTotalNumberOfIterations());
+  EXPECT_EQ(0.0, R.GetMaximumElapsedTime());
+
+  sitk::TranslationTransform tx(fixed.GetDimension(), v2(1.1,-2.2));
+
+  R.SetMaximumTotalNumberOfIterations(5);
+  R.SetInitialTransform(tx,false);
+  R.Execute(fixed,moving);
+  EXPECT_GE(1u, R.GetOptimizerIteration());
+  EXPECT_TRUE(R.GetOptimizerStopConditionDescription().find("Maximum total number of iterations") != std::string::npos)
+    << R.GetOptimizerStopConditionDescription();
+  R.SetMaximumTotalNumberOfIterations(0);
+
+  // the learning rate is so small the metric does not change
+  R.SetMetricConvergenceCriterion(10, 1e-3);
+  R.SetInitialTransform(tx,false);
+  R.Execute(fixed,moving);
+  EXPECT_GE(10u, R.GetOptimizerIteration());
+  EXPECT_TRUE(R.GetOptimizerStopConditionDescription().find("Metric changed by") != std::string::npos)
+    << R.GetOptimizerStopConditionDescription();
+  R.SetMetricConvergenceCriterion(0, 0.0);
+
+  // a graceful stop returns the current transform
+  StopRegistrationCommand cmd(R, 3);
+  R.AddCommand(sitk::sitkIterationEvent, cmd);
+  R.SetInitialTransform(tx,false);
+  sitk::Transform outTx;
+  EXPECT_NO_THROW(outTx = R.Execute(fixed,moving));
+  EXPECT_EQ(2u, outTx.GetParameters().size());
+  EXPECT_TRUE(R.GetOptimizerStopConditionDescription().find("StopRegistration was called") != std::string::npos)
+    << R.GetOptimizerStopConditionDescription();
+}
+
+TEST_F(sitkRegistrationMethodTest, OptimizerParametersPerLevel)
+{
+  // This test is to check the optimizer parameters are set for each
+  // level of the registration
+  sitk::ImageRegistrationMethod R;
+
+  sitk::Image fixed = fixedBlobs;
+  sitk::Image moving = fixedBlobs;
+
+  R.SetOptimizerAsGradientDescent(1.0, 100, 1e-20, 100);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+  R.SetShrinkFactorsPerLevel(std::vector<unsigned int>(2,1));
+  R.SetSmoothingSigmasPerLevel(v2(1.0,0.0));
+
+  EXPECT_TRUE(R.GetOptimizerNumberOfIterationsPerLevel().empty());
+
+  R.SetOptimizerNumberOfIterationsPerLevel(std::vector<unsigned int>(3,5));
+  EXPECT_EQ(3u, R.GetOptimizerNumberOfIterationsPerLevel().size());
+
+  sitk::TranslationTransform tx(fixed.GetDimension(), v2(1.1,-2.2));
+  R.SetInitialTransform(tx,false);
+  EXPECT_THROW(R.Execute(fixed,moving), sitk::GenericException);
+
+  std::vector<unsigned int> numberOfIterations;
+  numberOfIterations.push_back(5);
+  numberOfIterations.push_back(2);
+  R.SetOptimizerNumberOfIterationsPerLevel(numberOfIterations);
+  R.SetOptimizerLearningRatePerLevel(v2(0.1,0.01));
+  R.SetOptimizerConvergenceWindowSizePerLevel(std::vector<unsigned int>(2,10));
+  R.SetInitialTransform(tx,false);
+  R.Execute(fixed,moving);
+  EXPECT_EQ(2u, R.GetOptimizerIteration());
+
+  R.SetOptimizerAsLBFGSB();
+  R.SetInitialTransform(tx,false);
+  EXPECT_THROW(R.Execute(fixed,moving), sitk::GenericException);
+}
+
+TEST_F(sitkRegistrationMethodTest, Profile)
+{
+  // This test is to check the measurements of the execution
+  sitk::ImageRegistrationMethod R;
+
+  sitk::Image fixed = fixedBlobs;
+  sitk::Image moving = fixedBlobs;
+
+  R.SetOptimizerAsGradientDescent(1.0, 10, 1e-20, 100);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+  std::vector<unsigned int> shrinkFactors;
+  shrinkFactors.push_back(2);
+  shrinkFactors.push_back(1);
+  R.SetShrinkFactorsPerLevel(shrinkFactors);
+  R.SetSmoothingSigmasPerLevel(v2(1.0,0.0));
+
+  EXPECT_TRUE(R.GetProfileLevelOptimizationTimes().empty());
+  EXPECT_EQ(0.0, R.GetProfileTotalTime());
+
+  IterationUpdate cmd(R);
+  R.AddCommand(sitk::sitkIterationEvent, cmd);
+
+  sitk::TranslationTransform tx(fixed.GetDimension(), v2(1.1,-2.2));
+  R.SetInitialTransform(tx,false);
+  R.Execute(fixed,moving);
+
+  ASSERT_EQ(2u, R.GetProfileLevelInitializationTimes().size());
+  ASSERT_EQ(2u, R.GetProfileLevelOptimizationTimes().size());
+  ASSERT_EQ(2u, R.GetProfileLevelNumberOfIterations().size());
+  ASSERT_EQ(2u, R.GetProfileLevelNumberOfValidPoints().size());
+  EXPECT_EQ(10u, R.GetProfileLevelNumberOfIterations()[0]);
+  EXPECT_EQ(10u, R.GetProfileLevelNumberOfIterations()[1]);
+  EXPECT_LT(R.GetProfileLevelNumberOfValidPoints()[0], R.GetProfileLevelNumberOfValidPoints()[1]);
+  EXPECT_LE(R.GetProfileLevelNumberOfValidPoints()[1], fixed.GetNumberOfPixels());
+  EXPECT_LE(1u, R.GetProfileNumberOfThreadsUsed());
+
+  double levelTime = 0.0;
+  for ( unsigned int i = 0; i < 2; ++i )
+    {
+    EXPECT_LE(0.0, R.GetProfileLevelInitializationTimes()[i]);
+    EXPECT_LE(0.0, R.GetProfileLevelOptimizationTimes()[i]);
+    levelTime += R.GetProfileLevelInitializationTimes()[i] + R.GetProfileLevelOptimizationTimes()[i];
+    }
+  EXPECT_LE(0.0, R.GetProfileObserverTime());
+  EXPECT_LE(R.GetProfileObserverTime(), levelTime);
+  EXPECT_LE(levelTime, R.GetProfileTotalTime());
+}
+
+TEST_F(sitkRegistrationMethodTest, CompositeMetric)
+{
+  // This test is to check the weighted combination of metrics
+  sitk::ImageRegistrationMethod R;
+
+  sitk::Image fixed = fixedBlobs;
+  sitk::Image moving = fixedBlobs;
+
+  R.SetInitialTransform(sitk::Transform(fixed.GetDimension(),sitk::sitkIdentity));
+
+  EXPECT_EQ(0u, R.GetNumberOfCompositeMetricComponents());
+  R.SetMetricAsMattesMutualInformation();
+  R.AddMetricToComposite(1.0);
+  R.SetMetricAsCorrelation();
+  R.AddMetricToComposite(0.5);
+  EXPECT_EQ(2u, R.GetNumberOfCompositeMetricComponents());
+
+  // the current metric is not used with a composite metric
+  R.SetMetricAsMeanSquares();
+  EXPECT_NEAR(-1.5299437083119216-0.5, R.MetricEvaluate(fixed,moving), 1e-8 );
+
+  R.SetOptimizerAsRegularStepGradientDescent(1.0, 1e-4, 100, 0.5, 1e-10);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricSamplingStrategy(R.REGULAR);
+  R.SetMetricSamplingPercentage(0.2,1u);
+
+  sitk::TranslationTransform tx(fixed.GetDimension(), v2(1.1,-2.2));
+  R.SetInitialTransform(tx,false);
+  const sitk::Transform outTx = R.Execute(fixed,moving);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), outTx.GetParameters(), 1e-2);
+
+  R.ClearCompositeMetric();
+  EXPECT_EQ(0u, R.GetNumberOfCompositeMetricComponents());
+  R.SetInitialTransform(sitk::Transform(fixed.GetDimension(),sitk::sitkIdentity));
+  EXPECT_NEAR(0.0, R.MetricEvaluate(fixed,moving), 1e-10 );
+}
+
+TEST_F(sitkRegistrationMethodTest, VectorImages)
+{
+  // This test is to check the registration of the channels of vector
+  // images together
+  sitk::ImageRegistrationMethod R;
+
+  sitk::Image inverted = sitk::InvertIntensity(fixedBlobs, 1.0);
+  sitk::Image fixed = sitk::Compose(fixedBlobs, inverted);
+  sitk::Image moving = sitk::Compose(fixedBlobs, inverted);
+  ASSERT_EQ(sitk::sitkVectorFloat32, fixed.GetPixelID());
+
+  R.SetOptimizerAsRegularStepGradientDescent(1.0, 1e-4, 100, 0.5, 1e-10);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+
+  sitk::TranslationTransform tx(fixed.GetDimension(), v2(1.1,-2.2));
+  R.SetInitialTransform(tx,false);
+  sitk::Transform outTx = R.Execute(fixed,moving);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), outTx.GetParameters(), 1e-3);
+
+  R.SetMetricChannelWeights(v2(1.0,0.0));
+  R.SetInitialTransform(tx,false);
+  outTx = R.Execute(fixed,moving);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), outTx.GetParameters(), 1e-3);
+
+  R.SetMetricChannelWeights(std::vector<double>(3,1.0));
+  R.SetInitialTransform(tx,false);
+  EXPECT_THROW(R.Execute(fixed,moving), sitk::GenericException);
+  R.SetMetricChannelWeights(std::vector<double>());
+
+  sitk::Image scalar = fixedBlobs;
+  EXPECT_THROW(R.Execute(fixed,sitk::Compose(scalar,scalar,scalar)), sitk::GenericException);
+}
+
+TEST_F(sitkRegistrationMethodTest, Landmarks)
+{
+  // This test is to check the landmark terms of the metric
+  sitk::ImageRegistrationMethod R;
+
+  sitk::Image fixed = fixedBlobs;
+  sitk::Image moving = fixedBlobs;
+
+  R.SetOptimizerAsRegularStepGradientDescent(1.0, 1e-4, 100, 0.5, 1e-10);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+  R.SetMetricSamplingStrategy(R.RANDOM);
+  R.SetMetricSamplingPercentage(0.05,1u);
+
+  std::vector<double> landmarks;
+  landmarks.push_back(64.0);
+  landmarks.push_back(64.0);
+  landmarks.push_back(192.0);
+  landmarks.push_back(192.0);
+
+  sitk::TranslationTransform tx(fixed.GetDimension(), v2(1.1,-2.2));
+
+  R.SetMetricLandmarksAsEuclideanDistance(landmarks, landmarks, 0.5);
+  R.SetInitialTransform(tx,false);
+  sitk::Transform outTx = R.Execute(fixed,moving);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), outTx.GetParameters(), 1e-2);
+
+  R.SetMetricLandmarksAsExpectation(landmarks, landmarks, 0.5, 2.0, 2);
+  R.SetInitialTransform(tx,false);
+  outTx = R.Execute(fixed,moving);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), outTx.GetParameters(), 1e-2);
+
+  // the landmarks must correspond
+  R.SetMetricLandmarksAsEuclideanDistance(landmarks, v2(64.0,64.0));
+  R.SetInitialTransform(tx,false);
+  EXPECT_THROW(R.Execute(fixed,moving), sitk::GenericException);
+
+  landmarks.pop_back();
+  R.SetMetricLandmarksAsExpectation(landmarks, landmarks);
+  R.SetInitialTransform(tx,false);
+  EXPECT_THROW(R.Execute(fixed,moving), sitk::GenericException);
+
+  R.ClearMetricLandmarks();
+  R.SetInitialTransform(tx,false);
+  EXPECT_NO_THROW(R.Execute(fixed,moving));
+}
+
+TEST_F(sitkRegistrationMethodTest, Checkpoint)
+{
+  // This test is to check resuming a registration from a checkpoint
+  sitk::ImageRegistrationMethod R;
+
+  sitk::Image fixed = fixedBlobs;
+  sitk::Image moving = fixedBlobs;
+
+  const std::string checkpointFileName = dataFinder.GetOutputDirectory()+"/RegistrationCheckpoint.txt";
+
+  R.SetOptimizerAsGradientDescent(1.0, 100, 1e-20, 100);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+  std::vector<unsigned int> shrinkFactors;
+  shrinkFactors.push_back(4);
+  shrinkFactors.push_back(2);
+  shrinkFactors.push_back(1);
+  R.SetShrinkFactorsPerLevel(shrinkFactors);
+  std::vector<double> smoothingSigmas;
+  smoothingSigmas.push_back(2.0);
+  smoothingSigmas.push_back(1.0);
+  smoothingSigmas.push_back(0.0);
+  R.SetSmoothingSigmasPerLevel(smoothingSigmas);
+
+  EXPECT_EQ(0u, R.GetStartLevel());
+  EXPECT_TRUE(R.GetCheckpointFileName().empty());
+
+  R.SetCheckpointFileName(checkpointFileName);
+  EXPECT_EQ(checkpointFileName, R.GetCheckpointFileName());
+
+  sitk::TranslationTransform tx(fixed.GetDimension(), v2(1.1,-2.2));
+  R.SetInitialTransform(tx,false);
+  sitk::Transform outTx = R.Execute(fixed,moving);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), outTx.GetParameters(), 1e-3);
+
+  // the checkpoint of the completed registration resumes after the last level
+  R.SetCheckpointFileName("");
+  R.ResumeFromCheckpoint(checkpointFileName);
+  EXPECT_EQ(3u, R.GetStartLevel());
+  EXPECT_THROW(R.Execute(fixed,moving), sitk::GenericException);
+
+  // resume the last level
+  R.SetStartLevel(2);
+  std::vector<unsigned int> numberOfIterations;
+  numberOfIterations.push_back(0);
+  numberOfIterations.push_back(0);
+  numberOfIterations.push_back(100);
+  R.SetOptimizerNumberOfIterationsPerLevel(numberOfIterations);
+  IterationUpdate cmd(R);
+  R.AddCommand(sitk::sitkIterationEvent, cmd);
+  outTx = R.Execute(fixed,moving);
+  ASSERT_EQ(1u, R.GetProfileLevelNumberOfIterations().size());
+  EXPECT_EQ(100u, R.GetProfileLevelNumberOfIterations()[0]);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), outTx.GetParameters(), 1e-3);
+
+  EXPECT_THROW(R.ResumeFromCheckpoint(checkpointFileName+".missing"), sitk::GenericException);
+}
+
+TEST_F(sitkRegistrationMethodTest, NumberOfThreads)
+{
+  // This test is to check the number of threads of the metric
+  sitk::ImageRegistrationMethod R;
+
+  sitk::Image fixed = fixedBlobs;
+  sitk::Image moving = fixedBlobs;
+
+  EXPECT_EQ(0u, R.GetMetricNumberOfThreads());
+  EXPECT_EQ(0u, R.GetSmoothingNumberOfThreads());
+  EXPECT_EQ(0u, R.GetOptimizerNumberOfThreads());
+
+  R.SetOptimizerAsGradientDescent(1.0, 10, 1e-20, 100);
+  R.SetOptimizerScalesFromPhysicalShift();
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+  std::vector<unsigned int> shrinkFactors;
+  shrinkFactors.push_back(2);
+  shrinkFactors.push_back(1);
+  R.SetShrinkFactorsPerLevel(shrinkFactors);
+  R.SetSmoothingSigmasPerLevel(v2(1.0,0.0));
+
+  R.SetMetricNumberOfThreads(1);
+  R.SetSmoothingNumberOfThreads(2);
+  R.SetOptimizerNumberOfThreads(1);
+  EXPECT_EQ(1u, R.GetMetricNumberOfThreads());
+  EXPECT_EQ(2u, R.GetSmoothingNumberOfThreads());
+  EXPECT_EQ(1u, R.GetOptimizerNumberOfThreads());
+
+  sitk::TranslationTransform tx(fixed.GetDimension(), v2(1.1,-2.2));
+  R.SetInitialTransform(tx,false);
+  sitk::Transform outTx = R.Execute(fixed,moving);
+  EXPECT_EQ(1u, R.GetProfileNumberOfThreadsUsed());
+
+  const sitk::Transform singleThreadedTx = outTx;
+
+  R.SetMetricNumberOfThreads(0);
+  R.SetInitialTransform(tx,false);
+  outTx = R.Execute(fixed,moving);
+  EXPECT_LE(1u, R.GetProfileNumberOfThreadsUsed());
+  EXPECT_VECTOR_DOUBLE_NEAR(singleThreadedTx.GetParameters(), outTx.GetParameters(), 1e-6);
+}
+
 TEST_F(sitkRegistrationMethodTest, Transform_Initial)
 {
   // This test is to check the initial transforms
@@ -407,6 +977,44 @@ TEST_F(sitkRegistrationMethodTest, Mask_Test1)
 }
 
 
+TEST_F(sitkRegistrationMethodTest, Mask_Sampling)
+{
+  // The samples are drawn from the 40x40 voxels of the mask around
+  // the first blob, not rejected from the whole image.
+  sitk::Image mask(256, 256, sitk::sitkUInt8);
+  for ( unsigned int y = 44; y < 84; ++y )
+    {
+    for ( unsigned int x = 44; x < 84; ++x )
+      {
+      mask.GetBufferAsUInt8()[y * 256 + x] = 1;
+      }
+    }
+
+  sitk::ImageRegistrationMethod R;
+  R.SetOptimizerAsRegularStepGradientDescent(2.0, 1e-7, 100, 0.5, 1e-8);
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsCorrelation();
+  R.SetMetricFixedMask(mask);
+  R.SetMetricSamplingStrategy(sitk::ImageRegistrationMethod::RANDOM);
+  R.SetMetricSamplingPercentage(0.25, 1u);
+
+  sitk::TranslationTransform tx(fixedBlobs.GetDimension());
+  R.SetInitialTransform(tx);
+  sitk::Transform outTx = R.Execute(fixedBlobs, movingBlobs);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(-10,10), outTx.GetParameters(), 1e-2);
+  ASSERT_EQ(1u, R.GetProfileLevelNumberOfValidPoints().size());
+  EXPECT_LE(380u, R.GetProfileLevelNumberOfValidPoints()[0]);
+  EXPECT_LE(R.GetProfileLevelNumberOfValidPoints()[0], 400u);
+
+  // every fourth voxel of the mask
+  R.SetMetricSamplingStrategy(sitk::ImageRegistrationMethod::REGULAR);
+  R.SetInitialTransform(sitk::TranslationTransform(fixedBlobs.GetDimension()));
+  outTx = R.Execute(fixedBlobs, movingBlobs);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(-10,10), outTx.GetParameters(), 1e-2);
+  EXPECT_LE(380u, R.GetProfileLevelNumberOfValidPoints()[0]);
+  EXPECT_LE(R.GetProfileLevelNumberOfValidPoints()[0], 400u);
+}
+
 TEST_F(sitkRegistrationMethodTest, Mask_Test2)
 {
   // This test is to check that the metric masks have the correct
@@ -836,6 +1444,42 @@ TEST_F(sitkRegistrationMethodTest, Optimizer_Exhaustive)
 }
 
 
+TEST_F(sitkRegistrationMethodTest, Optimizer_ExhaustiveParallel)
+{
+  sitk::Image image = MakeGaussianBlob( v2(64, 64), std::vector<unsigned int>(2,256) );
+
+  sitk::ImageRegistrationMethod R;
+  R.SetInterpolator(sitk::sitkLinear);
+  R.SetMetricAsMeanSquares();
+
+  // the same best point as the serial grid
+  sitk::TranslationTransform tx(image.GetDimension());
+  tx.SetOffset(v2(-1,-2));
+  R.SetInitialTransform(tx, false);
+  R.SetOptimizerAsExhaustive(std::vector<unsigned int>(2,5), 0.5);
+  sitk::Transform serialTx = R.Execute(image, image);
+  const double serialValue = R.GetMetricValue();
+
+  R.SetOptimizerAsExhaustive(std::vector<unsigned int>(2,5), 0.5, 4u);
+  sitk::Transform parallelTx = R.Execute(image, image);
+  EXPECT_VECTOR_DOUBLE_NEAR(serialTx.GetParameters(), parallelTx.GetParameters(), 1e-10);
+  EXPECT_NEAR(serialValue, R.GetMetricValue(), 1e-10);
+  EXPECT_EQ(121u, R.GetOptimizerIteration());
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(-1,-2), tx.GetParameters(), 1e-10);
+
+  // the refinement reaches a point between the points of the grid
+  tx.SetOffset(v2(-1.3,-2.6));
+  R.SetInitialTransform(tx, true);
+  R.SetOptimizerAsExhaustive(std::vector<unsigned int>(2,2), 1.0, 2u, 3u);
+  sitk::Transform refinedTx = R.Execute(image, image);
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), refinedTx.GetParameters(), 0.15);
+  EXPECT_VECTOR_DOUBLE_NEAR(refinedTx.GetParameters(), tx.GetParameters(), 1e-10);
+  EXPECT_EQ(100u, R.GetOptimizerIteration());
+
+  R.SetOptimizerAsExhaustive(std::vector<unsigned int>(3,2), 1.0, 2u);
+  EXPECT_THROW(R.Execute(image, image), sitk::GenericException);
+}
+
 TEST_F(sitkRegistrationMethodTest, Optimizer_Amoeba)
 {
   sitk::Image image = MakeGaussianBlob( v2(64, 64), std::vector<unsigned int>(2,256) );
@@ -992,6 +1636,43 @@ TEST_F(sitkRegistrationMethodTest, Optimizer_LBFGS2)
 
 
 
+TEST_F(sitkRegistrationMethodTest, Optimizer_Adam)
+{
+  sitk::Image image = MakeGaussianBlob( v2(64, 64), std::vector<unsigned int>(2,256) );
+
+  sitk::ImageRegistrationMethod R;
+  R.SetInterpolator(sitk::sitkLinear);
+
+  sitk::TranslationTransform tx(image.GetDimension());
+  tx.SetOffset(v2(-1,-2));
+  R.SetInitialTransform(tx, false);
+
+  // a new 1% sample at each iteration
+  R.SetMetricAsMeanSquares();
+  R.SetMetricSamplingStrategy(sitk::ImageRegistrationMethod::RANDOM);
+  R.SetMetricSamplingPercentage(0.01, 1u);
+  R.SetOptimizerAsAdam(0.1, 300);
+
+  IterationUpdate cmd(R);
+  R.AddCommand(sitk::sitkIterationEvent, cmd);
+
+  sitk::Transform outTx = R.Execute(image, image);
+
+  std::cout << "-------" << std::endl;
+  std::cout << outTx.ToString() << std::endl;
+  std::cout << "Optimizer stop condition: " << R.GetOptimizerStopConditionDescription() << std::endl;
+  std::cout << " Iteration: " << R.GetOptimizerIteration() << std::endl;
+  std::cout << " Metric value: " << R.GetMetricValue() << std::endl;
+
+  EXPECT_VECTOR_DOUBLE_NEAR(v2(0.0,0.0), outTx.GetParameters(), 0.1);
+
+  tx.SetOffset(v2(-1,-2));
+  R.SetOptimizerAsAdam(0.1, 2);
+  outTx = R.Execute(image, image);
+  EXPECT_EQ(2u, R.GetOptimizerIteration()) << "Checking iteration.";
+}
+
+
 TEST_F(sitkRegistrationMethodTest, Optimizer_ScalesEstimator)
 {
   sitk::Image fixedImage = MakeDualGaussianBlobs( v2(64, 64), v2(54, 74), std::vector<unsigned int>(2,256) );
@@ -1040,6 +1721,23 @@ TEST_F(sitkRegistrationMethodTest, Optimizer_ScalesEstimator)
   EXPECT_VECTOR_DOUBLE_NEAR(v3(0.0,-2.8,9.5), outTx.GetParameters(), 0.6);
   EXPECT_VECTOR_DOUBLE_NEAR(v3(130049,1.0,1.0), cmd.scales, 1.0);
   EXPECT_TRUE( cmd.toString.find("ScalesFromPhysicalShift") != std::string::npos );
+  EXPECT_VECTOR_DOUBLE_NEAR(v3(130049,1.0,1.0), R.GetOptimizerScales(), 1.0);
+
+  EXPECT_FALSE(R.GetOptimizerScalesReusedAcrossLevels());
+  R.OptimizerScalesReusedAcrossLevelsOn();
+  EXPECT_TRUE(R.GetOptimizerScalesReusedAcrossLevels());
+  std::vector<unsigned int> shrinkFactors;
+  shrinkFactors.push_back(1);
+  shrinkFactors.push_back(1);
+  R.SetShrinkFactorsPerLevel(shrinkFactors);
+  R.SetSmoothingSigmasPerLevel(v2(1.0,0.0));
+  outTx = R.Execute(fixedImage, movingImage);
+
+  EXPECT_VECTOR_DOUBLE_NEAR(v3(0.0,-2.8,9.5), outTx.GetParameters(), 0.6);
+  EXPECT_VECTOR_DOUBLE_NEAR(v3(130049,1.0,1.0), R.GetOptimizerScales(), 1.0);
+  R.OptimizerScalesReusedAcrossLevelsOff();
+  R.SetShrinkFactorsPerLevel(std::vector<unsigned int>(1,1));
+  R.SetSmoothingSigmasPerLevel(std::vector<double>(1,0.0));
 
   R.SetOptimizerScales(v3(200000,1.0,1.0));
   outTx = R.Execute(fixedImage, movingImage);
@@ -1100,6 +1798,20 @@ TEST_F(sitkRegistrationMethodTest, Optimizer_Sampling)
 
   EXPECT_VECTOR_DOUBLE_NEAR(outTx1.GetParameters(), outTx1.GetParameters(), 1e-10)  << "Same registration with fixed seed and regular sampling";
 
+  const sitk::ImageRegistrationMethod::MetricSamplingStrategyType strategies[] = { R.STRATIFIED, R.HALTON, R.GRADIENT_WEIGHTED };
+  for ( unsigned int i = 0; i < 3; ++i )
+    {
+    R.SetMetricSamplingStrategy(strategies[i]);
+    R.SetMetricSamplingPercentage(.02,1u);
+
+    outTx1 = R.Execute(fixedImage, movingImage);
+    const double value1 = R.GetMetricValue();
+    outTx2 = R.Execute(fixedImage, movingImage);
+
+    EXPECT_VECTOR_DOUBLE_NEAR(outTx1.GetParameters(), outTx2.GetParameters(), 1e-10)  << "Same registration with fixed seed and sampling strategy " << strategies[i];
+    EXPECT_DOUBLE_EQ(value1, R.GetMetricValue());
+    }
+
   // set wall clock seed and expect the same results with full sampling
   R.SetMetricSamplingStrategy(R.NONE);
   R.SetMetricSamplingPercentage(.02,sitk::sitkWallClock);
@@ -26,14 +26,20 @@
 #include "sitkMultiplyImageFilter.h"
 
 #include "sitkImageOperators.h"
+#include "sitkImageExpression.h"
 
 #include "sitkComplexToRealImageFilter.h"
 #include "sitkComplexToImaginaryImageFilter.h"
 #include "sitkRealAndImaginaryToComplexImageFilter.h"
 #include "sitkImportImageFilter.h"
+#include "sitkImageView.h"
+#include "sitkFloat16.h"
 
 #include <itkIntTypes.h>
 
+#include <cstdlib>
+#include <algorithm>
+
 #include "itkImage.h"
 #include "itkVectorImage.h"
 #include "itkMetaDataObject.h"
@@ -367,6 +373,51 @@ TEST_F(Image,Transforms) {
   }
 }
 
+TEST_F(Image,BatchedTransforms) {
+
+  sitk::Image image( 10, 20, 30, sitk::sitkUInt8 );
+  image.SetOrigin( v3( 1.1, 2.2, 3.3 ) );
+  image.SetSpacing( v3( 0.5, 0.75, 1.5 ) );
+  std::vector<double> direction( 9, 0.0 );
+  direction[1] = 1.0;
+  direction[3] = -1.0;
+  direction[8] = 1.0;
+  image.SetDirection( direction );
+
+  // enough points to be transformed by multiple threads
+  const size_t numberOfPoints = 100000;
+  std::vector<double> points( 3 * numberOfPoints );
+  for ( size_t i = 0; i < points.size(); ++i )
+    {
+    points[i] = 0.37 * static_cast<double>( i % 97 ) - 5.0;
+    }
+
+  const std::vector<int64_t> indices = image.TransformPhysicalPointsToIndices( points );
+  const std::vector<double> cindices = image.TransformPhysicalPointsToContinuousIndices( points );
+  const std::vector<double> ipoints = image.TransformIndicesToPhysicalPoints( indices );
+  const std::vector<double> cpoints = image.TransformContinuousIndicesToPhysicalPoints( cindices );
+  ASSERT_EQ( indices.size(), points.size() );
+  ASSERT_EQ( cindices.size(), points.size() );
+  ASSERT_EQ( ipoints.size(), points.size() );
+  ASSERT_EQ( cpoints.size(), points.size() );
+
+  for ( size_t p = 0; p < numberOfPoints; p += 997 )
+    {
+    const std::vector<double> pt( points.begin() + 3*p, points.begin() + 3*p + 3 );
+    const std::vector<int64_t> idx( indices.begin() + 3*p, indices.begin() + 3*p + 3 );
+    const std::vector<double> cidx( cindices.begin() + 3*p, cindices.begin() + 3*p + 3 );
+    EXPECT_EQ( image.TransformPhysicalPointToIndex( pt ), idx ) << " point " << p;
+    EXPECT_EQ( image.TransformPhysicalPointToContinuousIndex( pt ), cidx ) << " point " << p;
+    EXPECT_EQ( image.TransformIndexToPhysicalPoint( idx ),
+               std::vector<double>( ipoints.begin() + 3*p, ipoints.begin() + 3*p + 3 ) ) << " point " << p;
+    EXPECT_EQ( image.TransformContinuousIndexToPhysicalPoint( cidx ),
+               std::vector<double>( cpoints.begin() + 3*p, cpoints.begin() + 3*p + 3 ) ) << " point " << p;
+    }
+
+  EXPECT_TRUE( image.TransformPhysicalPointsToIndices( std::vector<double>() ).empty() );
+  EXPECT_THROW( image.TransformPhysicalPointsToIndices( std::vector<double>( 4, 0.0 ) ), sitk::GenericException );
+}
+
 TEST_F(Image,Properties) {
 
   // GetOrigin
@@ -501,6 +552,405 @@ TEST_F(Image, CopyOnWrite)
   EXPECT_EQ( sitk::Hash( imgCopy ), sitk::Hash( img0 ) ) << "Hash for shared and copy after set spacing";
 }
 
+TEST_F(Image, Region)
+{
+  sitk::Image img( 5, 4, 3, sitk::sitkUInt16 );
+  uint16_t *imgBuffer = img.GetBufferAsUInt16();
+  for ( unsigned int i = 0; i < img.GetNumberOfPixels(); ++i )
+    {
+    imgBuffer[i] = i;
+    }
+
+  std::vector<uint32_t> index( 3 );
+  index[0] = 1; index[1] = 2; index[2] = 1;
+  std::vector<uint32_t> size( 3 );
+  size[0] = 3; size[1] = 2; size[2] = 2;
+
+  std::vector<uint16_t> buffer( 12 );
+  img.GetRegionAsUInt16( index, size, &buffer[0] );
+
+  std::vector<uint32_t> idx( 3 );
+  unsigned int i = 0;
+  for ( idx[2] = 1; idx[2] < 3; ++idx[2] )
+    for ( idx[1] = 2; idx[1] < 4; ++idx[1] )
+      for ( idx[0] = 1; idx[0] < 4; ++idx[0] )
+        {
+        EXPECT_EQ( img.GetPixelAsUInt16( idx ), buffer[i++] ) << " at index " << idx;
+        }
+
+  // check copy on write when setting a region
+  sitk::Image imgCopy = img;
+  std::fill( buffer.begin(), buffer.end(), 99 );
+  imgCopy.SetRegionFromUInt16( index, size, &buffer[0] );
+  EXPECT_EQ( img.GetPixelAsUInt16( index ), 5u*4u+2u*5u+1u );
+  EXPECT_EQ( imgCopy.GetPixelAsUInt16( index ), 99u );
+  idx[0] = 0; idx[1] = 0; idx[2] = 0;
+  EXPECT_EQ( imgCopy.GetPixelAsUInt16( idx ), 0u );
+
+  // wrong component type
+  EXPECT_ANY_THROW( img.GetRegionAsInt16( index, size, reinterpret_cast<int16_t*>( &buffer[0] ) ) );
+
+  // region outside of the image
+  size[0] = 5;
+  EXPECT_ANY_THROW( img.GetRegionAsUInt16( index, size, &buffer[0] ) );
+  EXPECT_ANY_THROW( img.GetRegionAsUInt16( std::vector<uint32_t>( 2, 0 ), size, &buffer[0] ) );
+
+  // vector image components are interleaved
+  sitk::Image vimg( std::vector<unsigned int>( 2, 4 ), sitk::sitkVectorFloat32, 2 );
+  std::vector<float> v( 2 );
+  v[0] = 1.0f; v[1] = 2.0f;
+  vimg.SetPixelAsVectorFloat32( std::vector<uint32_t>( 2, 1 ), v );
+  std::vector<float> vbuffer( 2*2*2 );
+  vimg.GetRegionAsFloat( std::vector<uint32_t>( 2, 1 ), std::vector<uint32_t>( 2, 2 ), &vbuffer[0] );
+  EXPECT_EQ( vbuffer[0], 1.0f );
+  EXPECT_EQ( vbuffer[1], 2.0f );
+  EXPECT_EQ( vbuffer[2], 0.0f );
+}
+
+TEST_F(Image, View)
+{
+  sitk::Image img( 5, 4, 3, sitk::sitkFloat32 );
+  img.SetOrigin( std::vector<double>( 3, 1.0 ) );
+  img.SetSpacing( std::vector<double>( 3, 0.5 ) );
+  img.SetMetaData( "key", "value" );
+  float *imgBuffer = img.GetBufferAsFloat();
+  for ( unsigned int i = 0; i < img.GetNumberOfPixels(); ++i )
+    {
+    imgBuffer[i] = i;
+    }
+
+  std::vector<unsigned int> index( 3, 1 );
+  std::vector<unsigned int> size( 3, 2 );
+  sitk::ImageView view( img, index, size );
+
+  EXPECT_EQ( view.GetSize(), size );
+  EXPECT_EQ( view.GetIndex(), index );
+  EXPECT_EQ( view.GetNumberOfPixels(), 8u );
+  EXPECT_EQ( view.GetOrigin(), std::vector<double>( 3, 1.5 ) );
+  EXPECT_EQ( view.GetSpacing(), img.GetSpacing() );
+  EXPECT_EQ( view.GetStrides()[2], 20u );
+  EXPECT_EQ( view.GetBufferOffset(), 1u + 5u + 20u );
+  EXPECT_FALSE( view.IsContiguous() );
+
+  // the view shares the buffer with the image
+  EXPECT_EQ( static_cast<const sitk::Image &>( view.GetImage() ).GetBufferAsFloat(),
+             static_cast<const sitk::Image &>( img ).GetBufferAsFloat() );
+
+  sitk::Image sub = view.ToImage();
+  EXPECT_EQ( sub.GetSize(), size );
+  EXPECT_EQ( sub.GetOrigin(), view.GetOrigin() );
+  EXPECT_EQ( sub.GetMetaData( "key" ), "value" );
+  EXPECT_EQ( sub.GetPixelAsFloat( std::vector<uint32_t>( 3, 0 ) ), 26.0f );
+  EXPECT_EQ( sub.GetPixelAsFloat( std::vector<uint32_t>( 3, 1 ) ), 26.0f + 1.0f + 5.0f + 20.0f );
+
+  // a view of the entire image does not copy
+  sitk::ImageView whole( img );
+  EXPECT_TRUE( whole.IsContiguous() );
+  EXPECT_EQ( static_cast<const sitk::Image &>( whole.ToImage() ).GetITKBase(),
+             static_cast<const sitk::Image &>( img ).GetITKBase() );
+
+  // implicit conversion where an image is expected
+  sitk::Image sum = sitk::Add( view, view );
+  EXPECT_EQ( sum.GetPixelAsFloat( std::vector<uint32_t>( 3, 0 ) ), 52.0f );
+
+  // a contiguous view of the last two slices shares the buffer
+  std::vector<unsigned int> slabIndex( 3, 0 );
+  slabIndex[2] = 1;
+  std::vector<unsigned int> slabSize = img.GetSize();
+  slabSize[2] = 2;
+  sitk::ImageView slabView( img, slabIndex, slabSize );
+  EXPECT_TRUE( slabView.IsContiguous() );
+  sitk::Image slab = slabView;
+  EXPECT_EQ( slab.GetSize(), slabSize );
+  EXPECT_EQ( slab.GetOrigin(), slabView.GetOrigin() );
+  EXPECT_EQ( static_cast<const sitk::Image &>( slab ).GetBufferAsFloat(),
+             static_cast<const sitk::Image &>( img ).GetBufferAsFloat() + 20 );
+  EXPECT_TRUE( slab.IsBufferShared() );
+  EXPECT_EQ( sitk::Add( slab, slab ).GetPixelAsFloat( std::vector<uint32_t>( 3, 0 ) ), 40.0f );
+
+  // modifying the slab copies it, the image is not modified
+  slab.SetPixelAsFloat( std::vector<uint32_t>( 3, 0 ), -1.0f );
+  EXPECT_EQ( slab.GetPixelAsFloat( std::vector<uint32_t>( 3, 0 ) ), -1.0f );
+  EXPECT_EQ( img.GetPixelAsFloat( slabIndex ), 20.0f );
+  EXPECT_NE( static_cast<const sitk::Image &>( slab ).GetBufferAsFloat(),
+             static_cast<const sitk::Image &>( img ).GetBufferAsFloat() + 20 );
+
+  size[0] = 5;
+  EXPECT_ANY_THROW( sitk::ImageView( img, index, size ) );
+  EXPECT_ANY_THROW( sitk::ImageView( img, std::vector<unsigned int>( 2, 0 ), std::vector<unsigned int>( 2, 1 ) ) );
+}
+
+TEST_F(Image, Float16)
+{
+  sitk::Image img( 4, 3, 2, sitk::sitkFloat32 );
+  img.SetSpacing( std::vector<double>( 3, 0.25 ) );
+  img.SetMetaData( "key", "value" );
+  float *buffer = img.GetBufferAsFloat();
+  buffer[0] = 1.0f;
+  buffer[1] = -0.333333f;
+  buffer[2] = 65504.0f;
+  buffer[3] = 70000.0f;
+  buffer[4] = 1e-7f;
+  buffer[5] = 1.0009765625f;
+
+  sitk::Image encoded = sitk::EncodeFloat16( img );
+  EXPECT_EQ( encoded.GetPixelID(), sitk::sitkUInt16 );
+  EXPECT_EQ( encoded.GetSpacing(), img.GetSpacing() );
+  EXPECT_EQ( encoded.GetMetaData( "key" ), "value" );
+  EXPECT_TRUE( sitk::IsFloat16Encoded( encoded ) );
+  EXPECT_FALSE( sitk::IsFloat16Encoded( img ) );
+
+  const uint16_t *bits = static_cast<const sitk::Image &>( encoded ).GetBufferAsUInt16();
+  EXPECT_EQ( bits[0], 0x3c00u );
+  EXPECT_EQ( bits[2], 0x7bffu );
+  EXPECT_EQ( bits[3], 0x7c00u ) << "Too large values are infinite";
+
+  sitk::Image decoded = sitk::DecodeFloat16( encoded );
+  EXPECT_EQ( decoded.GetPixelID(), sitk::sitkFloat32 );
+  EXPECT_FALSE( decoded.HasMetaDataKey( "SITK_Float16Format" ) );
+  EXPECT_EQ( decoded.GetMetaData( "key" ), "value" );
+  const float *values = static_cast<const sitk::Image &>( decoded ).GetBufferAsFloat();
+  EXPECT_EQ( values[0], 1.0f );
+  EXPECT_NEAR( values[1], -0.333333f, 2e-4 );
+  EXPECT_EQ( values[2], 65504.0f );
+  EXPECT_EQ( values[4], 1.0f / 16777216.0f * 2.0f );
+  EXPECT_EQ( values[5], 1.0009765625f );
+
+  // bfloat16 keeps the range of the floats
+  sitk::Image bfloat = sitk::EncodeFloat16( img, sitk::sitkBFloat16 );
+  EXPECT_EQ( static_cast<const sitk::Image &>( bfloat ).GetBufferAsUInt16()[0], 0x3f80u );
+  sitk::Image bdecoded = sitk::DecodeFloat16( bfloat, sitk::sitkFloat64 );
+  EXPECT_EQ( bdecoded.GetPixelID(), sitk::sitkFloat64 );
+  EXPECT_EQ( static_cast<const sitk::Image &>( bdecoded ).GetBufferAsDouble()[3], 70144.0 );
+
+  // vector images and a round trip through a file
+  sitk::Image vimg( std::vector<unsigned int>( 2, 5 ), sitk::sitkVectorFloat64, 3 );
+  vimg.GetBufferAsDouble()[7] = 0.5;
+  sitk::Image vencoded = sitk::EncodeFloat16( vimg );
+  EXPECT_EQ( vencoded.GetPixelID(), sitk::sitkVectorUInt16 );
+  EXPECT_EQ( vencoded.GetNumberOfComponentsPerPixel(), 3u );
+  sitk::WriteImage( vencoded, "float16.mha" );
+  sitk::Image vread = sitk::ReadImage( "float16.mha" );
+  ASSERT_TRUE( sitk::IsFloat16Encoded( vread ) );
+  sitk::Image vdecoded = sitk::DecodeFloat16( vread );
+  EXPECT_EQ( vdecoded.GetPixelID(), sitk::sitkVectorFloat32 );
+  EXPECT_EQ( static_cast<const sitk::Image &>( vdecoded ).GetBufferAsFloat()[7], 0.5f );
+
+  EXPECT_ANY_THROW( sitk::EncodeFloat16( sitk::Image( 2, 2, sitk::sitkInt16 ) ) );
+  EXPECT_ANY_THROW( sitk::DecodeFloat16( img ) );
+  EXPECT_ANY_THROW( sitk::DecodeFloat16( encoded, sitk::sitkInt32 ) );
+}
+
+TEST_F(Image, DeepCopyStatistics)
+{
+  sitk::Image::ResetGlobalDeepCopyStatistics();
+  EXPECT_EQ( sitk::Image::GetGlobalNumberOfDeepCopies(), 0u );
+  EXPECT_EQ( sitk::Image::GetGlobalDeepCopyBytes(), 0u );
+
+  sitk::Image img( 10, 20, sitk::sitkInt16 );
+  img.SetPixelAsInt16( std::vector<uint32_t>( 2, 0 ), 1 );
+  EXPECT_EQ( sitk::Image::GetGlobalNumberOfDeepCopies(), 0u ) << "Unique image should not be copied";
+
+  sitk::Image imgCopy = img;
+  imgCopy.SetPixelAsInt16( std::vector<uint32_t>( 2, 0 ), 2 );
+  EXPECT_EQ( sitk::Image::GetGlobalNumberOfDeepCopies(), 1u );
+  EXPECT_EQ( sitk::Image::GetGlobalDeepCopyBytes(), 10u*20u*sizeof(int16_t) );
+
+  sitk::Image vimg( std::vector<unsigned int>( 2, 8 ), sitk::sitkVectorFloat32, 3 );
+  sitk::Image vimgCopy = vimg;
+  vimgCopy.GetBufferAsFloat();
+  EXPECT_EQ( sitk::Image::GetGlobalNumberOfDeepCopies(), 2u );
+  EXPECT_EQ( sitk::Image::GetGlobalDeepCopyBytes(), 10u*20u*sizeof(int16_t) + 8u*8u*3u*sizeof(float) );
+
+  const uint64_t oldThreshold = sitk::Image::GetGlobalDeepCopyWarningThreshold();
+  sitk::Image::SetGlobalDeepCopyWarningThreshold( 1 );
+  EXPECT_EQ( sitk::Image::GetGlobalDeepCopyWarningThreshold(), 1u );
+  sitk::Image::SetGlobalDeepCopyWarningThreshold( oldThreshold );
+
+  sitk::Image::ResetGlobalDeepCopyStatistics();
+  EXPECT_EQ( sitk::Image::GetGlobalNumberOfDeepCopies(), 0u );
+  EXPECT_EQ( sitk::Image::GetGlobalDeepCopyBytes(), 0u );
+}
+
+namespace
+{
+unsigned int testAllocations = 0;
+
+void *TestAllocator( size_t bytes, void *clientData )
+{
+  ++testAllocations;
+  EXPECT_EQ( clientData, &testAllocations );
+  return std::malloc( bytes );
+}
+
+void TestDeallocator( void *buffer, size_t, void *clientData )
+{
+  --testAllocations;
+  EXPECT_EQ( clientData, &testAllocations );
+  std::free( buffer );
+}
+}
+
+TEST_F(Image, BufferAllocator)
+{
+  EXPECT_FALSE( sitk::Image::GetGlobalBufferPool() );
+
+  sitk::Image::GlobalBufferPoolOn();
+  EXPECT_TRUE( sitk::Image::GetGlobalBufferPool() );
+  EXPECT_EQ( sitk::Image::GetGlobalBufferPoolBytes(), 0u );
+
+  {
+  sitk::Image img( 10, 20, sitk::sitkFloat32 );
+  img.SetPixelAsFloat( std::vector<uint32_t>( 2, 1 ), 3.0f );
+  }
+  EXPECT_EQ( sitk::Image::GetGlobalBufferPoolBytes(), 10u*20u*sizeof(float) );
+
+  {
+  // the recycled buffer must still be zero initialized
+  sitk::Image img( 20, 10, sitk::sitkFloat32 );
+  EXPECT_EQ( sitk::Image::GetGlobalBufferPoolBytes(), 0u );
+  EXPECT_EQ( img.GetPixelAsFloat( std::vector<uint32_t>( 2, 1 ) ), 0.0f );
+
+  sitk::Image vimg( std::vector<unsigned int>( 2, 8 ), sitk::sitkVectorUInt8, 3 );
+  }
+  EXPECT_EQ( sitk::Image::GetGlobalBufferPoolBytes(), 10u*20u*sizeof(float) + 8u*8u*3u );
+
+  sitk::Image::SetGlobalBufferPoolMaximumBytes( 100 );
+  EXPECT_EQ( sitk::Image::GetGlobalBufferPoolMaximumBytes(), 100u );
+  EXPECT_LE( sitk::Image::GetGlobalBufferPoolBytes(), 100u );
+  sitk::Image::SetGlobalBufferPoolMaximumBytes( uint64_t(1) << 30 );
+
+  sitk::Image::ReleaseGlobalBufferPool();
+  EXPECT_EQ( sitk::Image::GetGlobalBufferPoolBytes(), 0u );
+  sitk::Image::GlobalBufferPoolOff();
+  EXPECT_FALSE( sitk::Image::GetGlobalBufferPool() );
+
+  EXPECT_THROW( sitk::Image::SetGlobalBufferAllocator( TestAllocator, NULL ), sitk::GenericException );
+
+  sitk::Image::SetGlobalBufferAllocator( TestAllocator, TestDeallocator, &testAllocations );
+  {
+  sitk::Image img( 5, 5, 5, sitk::sitkInt32 );
+  EXPECT_EQ( testAllocations, 1u );
+  sitk::Image copy = img;
+  copy.SetPixelAsInt32( std::vector<uint32_t>( 3, 0 ), 1 );
+  EXPECT_EQ( testAllocations, 1u ) << "Deep copies use the ITK allocator";
+  }
+  EXPECT_EQ( testAllocations, 0u );
+  sitk::Image::SetGlobalBufferAllocator( NULL, NULL );
+}
+
+TEST_F(Image, BufferInitialization)
+{
+  std::vector<unsigned int> size( 3 );
+  size[0] = 10;
+  size[1] = 20;
+  size[2] = 30;
+
+  sitk::Image img( size, sitk::sitkUInt16, 0, sitk::Image::NoBufferInitialization );
+  EXPECT_EQ( img.GetSize(), size );
+  EXPECT_EQ( img.GetPixelID(), sitk::sitkUInt16 );
+  EXPECT_EQ( img.GetNumberOfComponentsPerPixel(), 1u );
+
+  sitk::Image vimg( size, sitk::sitkVectorFloat32, 2, sitk::Image::NoBufferInitialization );
+  EXPECT_EQ( vimg.GetNumberOfComponentsPerPixel(), 2u );
+
+  EXPECT_THROW( sitk::Image( size, sitk::sitkFloat32, 2, sitk::Image::NoBufferInitialization ), sitk::GenericException );
+
+  // large enough to be zero filled by multiple threads
+  size[0] = 256;
+  size[1] = 256;
+  size[2] = 64;
+  sitk::Image zimg( size, sitk::sitkFloat32, 0, sitk::Image::ZeroBufferInitialization );
+  const float *buffer = zimg.GetBufferAsFloat();
+  const size_t numberOfPixels = size[0]*size[1]*size[2];
+  EXPECT_EQ( std::count( buffer, buffer + numberOfPixels, 0.0f ), static_cast<std::ptrdiff_t>( numberOfPixels ) );
+
+  sitk::Image zvimg( size, sitk::sitkVectorUInt8, 3 );
+  const uint8_t *vbuffer = zvimg.GetBufferAsUInt8();
+  EXPECT_EQ( std::count( vbuffer, vbuffer + 3*numberOfPixels, 0 ), static_cast<std::ptrdiff_t>( 3*numberOfPixels ) );
+}
+
+TEST_F(Image, BufferIntrospection)
+{
+  sitk::Image img( 10, 20, sitk::sitkInt16 );
+  EXPECT_EQ( img.GetSizeInBytes(), 10u*20u*sizeof(int16_t) );
+  EXPECT_FALSE( img.IsBufferShared() );
+  EXPECT_GE( img.GetBufferAlignment(), sizeof(int16_t) );
+  EXPECT_EQ( reinterpret_cast<size_t>( img.GetBufferAsInt16() ) % img.GetBufferAlignment(), 0u );
+
+  sitk::Image copy = img;
+  EXPECT_TRUE( img.IsBufferShared() );
+  EXPECT_TRUE( copy.IsBufferShared() );
+  copy.MakeUnique();
+  EXPECT_FALSE( img.IsBufferShared() );
+  EXPECT_FALSE( copy.IsBufferShared() );
+
+  sitk::Image vimg( std::vector<unsigned int>( 3, 4 ), sitk::sitkVectorFloat64, 2 );
+  EXPECT_EQ( vimg.GetSizeInBytes(), 4u*4u*4u*2u*sizeof(double) );
+
+  EXPECT_EQ( static_cast<const sitk::Image &>( vimg ).GetBufferAsVoid(),
+             static_cast<const void *>( static_cast<const sitk::Image &>( vimg ).GetBufferAsDouble() ) );
+
+  // the buffer of any pixel type is made unique
+  sitk::Image cimg( 4, 5, sitk::sitkComplexFloat32 );
+  sitk::Image ccopy = cimg;
+  void *cbuffer = cimg.GetBufferAsVoid();
+  EXPECT_FALSE( cimg.IsBufferShared() );
+  EXPECT_NE( cbuffer, static_cast<const sitk::Image &>( ccopy ).GetBufferAsVoid() );
+
+  sitk::Image limg( 10, 10, sitk::sitkLabelUInt8 );
+  EXPECT_EQ( limg.GetSizeInBytes(), 0u );
+  EXPECT_EQ( limg.GetBufferAlignment(), 0u );
+  EXPECT_THROW( limg.GetBufferAsVoid(), sitk::GenericException );
+}
+
+TEST_F(Image, Swap)
+{
+  sitk::Image img1( 10, 10, sitk::sitkInt16 );
+  sitk::Image img2( 5, 6, 7, sitk::sitkFloat32 );
+  const itk::DataObject *base1 = static_cast<const sitk::Image *>(&img1)->GetITKBase();
+  const itk::DataObject *base2 = static_cast<const sitk::Image *>(&img2)->GetITKBase();
+
+  img1.Swap( img2 );
+  EXPECT_EQ( static_cast<const sitk::Image *>(&img1)->GetITKBase(), base2 );
+  EXPECT_EQ( static_cast<const sitk::Image *>(&img2)->GetITKBase(), base1 );
+  EXPECT_EQ( img1.GetDimension(), 3u );
+  EXPECT_EQ( img2.GetPixelID(), sitk::sitkInt16 );
+  EXPECT_EQ( base2->GetReferenceCount(), 1 );
+
+  std::swap( img1, img2 );
+  EXPECT_EQ( static_cast<const sitk::Image *>(&img1)->GetITKBase(), base1 );
+  EXPECT_EQ( static_cast<const sitk::Image *>(&img2)->GetITKBase(), base2 );
+  EXPECT_EQ( base1->GetReferenceCount(), 1 );
+}
+
+#if defined(SITK_HAS_CXX11_RVREF)
+TEST_F(Image, Move)
+{
+  sitk::Image img( 10, 10, sitk::sitkInt16 );
+  const itk::DataObject *base = static_cast<const sitk::Image *>(&img)->GetITKBase();
+
+  // the move constructor transfers the ITK image without a new reference
+  sitk::Image img1( std::move( img ) );
+  EXPECT_EQ( static_cast<const sitk::Image *>(&img1)->GetITKBase(), base );
+  EXPECT_EQ( base->GetReferenceCount(), 1 ) << " Reference Count after move construction";
+
+  // a moved-from image may be assigned to
+  img = sitk::Image( 5, 5, sitk::sitkUInt8 );
+  EXPECT_EQ( img.GetPixelID(), sitk::sitkUInt8 );
+
+  sitk::Image img2( 3, 3, sitk::sitkFloat32 );
+  img2 = std::move( img1 );
+  EXPECT_EQ( static_cast<const sitk::Image *>(&img2)->GetITKBase(), base );
+  EXPECT_EQ( base->GetReferenceCount(), 1 ) << " Reference Count after move assignment";
+  EXPECT_EQ( img2.GetPixelID(), sitk::sitkInt16 );
+
+  // a result returned by value does not need to be made unique
+  img2.SetPixelAsInt16( std::vector<uint32_t>( 2, 0 ), 1 );
+  EXPECT_EQ( static_cast<const sitk::Image *>(&img2)->GetITKBase(), base );
+}
+#endif
+
 TEST_F(Image,Operators)
 {
 
@@ -635,6 +1085,108 @@ TEST_F(Image,Operators)
   EXPECT_EQ( 0, v ) << "value check 8";
 }
 
+TEST_F(Image,InPlaceOperators)
+{
+  const std::vector<uint32_t> idx( 2, 0 );
+
+  sitk::Image img( 10, 10, sitk::sitkFloat32 );
+  const float *buffer = static_cast<const sitk::Image &>( img ).GetBufferAsFloat();
+
+  sitk::Image frame( 10, 10, sitk::sitkFloat32 );
+  frame += 2.0;
+
+  for ( unsigned int i = 0; i < 5; ++i )
+    {
+    img += frame;
+    }
+  EXPECT_EQ( img.GetPixelAsFloat( idx ), 10.0f );
+  EXPECT_EQ( static_cast<const sitk::Image &>( img ).GetBufferAsFloat(), buffer ) << "Unique buffer should be reused";
+
+  img *= 0.5;
+  img -= frame;
+  img /= frame;
+  EXPECT_EQ( img.GetPixelAsFloat( idx ), 1.5f );
+  EXPECT_EQ( static_cast<const sitk::Image &>( img ).GetBufferAsFloat(), buffer ) << "Unique buffer should be reused";
+
+  // a shared buffer must not be modified
+  sitk::Image copy = img;
+  img += 1.0;
+  EXPECT_EQ( img.GetPixelAsFloat( idx ), 2.5f );
+  EXPECT_EQ( copy.GetPixelAsFloat( idx ), 1.5f );
+  EXPECT_EQ( static_cast<const sitk::Image &>( copy ).GetBufferAsFloat(), buffer );
+  EXPECT_NE( static_cast<const sitk::Image &>( img ).GetBufferAsFloat(), buffer );
+
+  sitk::Image chain = copy + frame + frame + 1.0;
+  EXPECT_EQ( chain.GetPixelAsFloat( idx ), 6.5f );
+  EXPECT_EQ( copy.GetPixelAsFloat( idx ), 1.5f );
+
+  sitk::Image limg( 10, 10, sitk::sitkUInt8 );
+  const uint8_t *lbuffer = static_cast<const sitk::Image &>( limg ).GetBufferAsUInt8();
+  limg |= 12;
+  limg &= 6;
+  limg ^= 1;
+  EXPECT_EQ( limg.GetPixelAsUInt8( idx ), 5u );
+  EXPECT_EQ( static_cast<const sitk::Image &>( limg ).GetBufferAsUInt8(), lbuffer );
+}
+
+TEST_F(Image,Expression)
+{
+  const std::vector<uint32_t> idx( 2, 3 );
+
+  sitk::Image a( 64, 64, sitk::sitkFloat32 );
+  sitk::Image b( 64, 64, sitk::sitkFloat32 );
+  sitk::Image c( 64, 64, sitk::sitkFloat32 );
+  sitk::Image d( 64, 64, sitk::sitkFloat32 );
+  a += 7.0;
+  b += 2.0;
+  c += 3.0;
+  d += 5.0;
+  a.SetSpacing( std::vector<double>( 2, 0.5 ) );
+
+  sitk::ImageExpression expression = ( sitk::ImageExpression( a ) - b ) * c + sitk::ImageExpression( d ) / 2.0;
+  EXPECT_EQ( expression.GetNumberOfImages(), 4u );
+  EXPECT_EQ( expression.ToString(), "(((image0 - image1) * image2) + (image3 / 2))" );
+
+  sitk::Image result = expression;
+  EXPECT_EQ( result.GetPixelAsFloat( idx ), 17.5f );
+  EXPECT_EQ( sitk::Hash( result ), sitk::Hash( ( a - b ) * c + d / 2.0 ) );
+  EXPECT_EQ( result.GetSpacing(), a.GetSpacing() );
+
+  // the expression holds its own reference to the images
+  a += 1.0;
+  EXPECT_EQ( expression.Evaluate().GetPixelAsFloat( idx ), 17.5f );
+  EXPECT_EQ( sitk::Image( -sitk::ImageExpression( a ) + 1.0 ).GetPixelAsFloat( idx ), -7.0f );
+
+  // integer results are clamped, division by zero is the maximum
+  sitk::Image u( 10, 10, sitk::sitkUInt8 );
+  u += 200;
+  EXPECT_EQ( sitk::Image( sitk::ImageExpression( u ) * 2.0 ).GetPixelAsUInt8( idx ), 255u );
+  EXPECT_EQ( sitk::Image( 100.0 - sitk::ImageExpression( u ) ).GetPixelAsUInt8( idx ), 0u );
+  EXPECT_EQ( sitk::Image( sitk::ImageExpression( 1.0 ) / ( sitk::ImageExpression( u ) - u ) ).GetPixelAsUInt8( idx ), 255u );
+
+  // vector images are computed component-wise
+  std::vector<unsigned int> size( 2, 10 );
+  sitk::Image v1( size, sitk::sitkVectorFloat32, 3 );
+  sitk::Image v2( size, sitk::sitkVectorFloat32, 3 );
+  float *buffer1 = v1.GetBufferAsFloat();
+  float *buffer2 = v2.GetBufferAsFloat();
+  for ( unsigned int i = 0; i < 10*10*3; ++i )
+    {
+    buffer1[i] = static_cast<float>( i % 3 );
+    buffer2[i] = 2.0f;
+    }
+  std::vector<float> pixel = sitk::Image( sitk::ImageExpression( v1 ) * v2 + 1.0 ).GetPixelAsVectorFloat32( idx );
+  ASSERT_EQ( pixel.size(), 3u );
+  EXPECT_EQ( pixel[0], 1.0f );
+  EXPECT_EQ( pixel[1], 3.0f );
+  EXPECT_EQ( pixel[2], 5.0f );
+
+  // mismatched images and constant only expressions
+  EXPECT_THROW( ( sitk::ImageExpression( a ) + u ).Evaluate(), sitk::GenericException );
+  EXPECT_THROW( ( sitk::ImageExpression( a ) + sitk::Image( 32, 32, sitk::sitkFloat32 ) ).Evaluate(), sitk::GenericException );
+  EXPECT_THROW( ( sitk::ImageExpression( 1.0 ) + 2.0 ).Evaluate(), sitk::GenericException );
+}
+
 TEST_F(Image,SetPixel)
 {
 
@@ -1628,6 +2180,49 @@ TEST_F(Image,MetaDataDictionary)
 }
 
 
+TEST_F(Image,SharedMetaDataDictionary)
+{
+  sitk::Image img( 10, 10, sitk::sitkFloat32 );
+  img.SetMetaData( "k1", "v1" );
+  img.SetPixelAsFloat( std::vector<uint32_t>( 2, 0 ), 1.0f );
+
+  sitk::Image::ResetGlobalDeepCopyStatistics();
+
+  // modifying the meta-data of a copy does not copy the pixels
+  sitk::Image copy = img;
+  copy.SetMetaData( "k2", "v2" );
+  EXPECT_TRUE( copy.EraseMetaData( "k1" ) );
+  copy.SetOrigin( std::vector<double>( 2, 5.0 ) );
+  EXPECT_EQ( sitk::Image::GetGlobalNumberOfDeepCopies(), 0u );
+  EXPECT_TRUE( img.IsBufferShared() );
+  EXPECT_TRUE( copy.IsBufferShared() );
+  EXPECT_EQ( static_cast<const sitk::Image &>( img ).GetBufferAsVoid(),
+             static_cast<const sitk::Image &>( copy ).GetBufferAsVoid() );
+
+  EXPECT_EQ( 1u, img.GetMetaDataKeys().size() );
+  EXPECT_EQ( "v1", img.GetMetaData( "k1" ) );
+  EXPECT_FALSE( img.HasMetaDataKey( "k2" ) );
+  EXPECT_EQ( std::vector<double>( 2, 0.0 ), img.GetOrigin() );
+  EXPECT_EQ( 1u, copy.GetMetaDataKeys().size() );
+  EXPECT_EQ( "v2", copy.GetMetaData( "k2" ) );
+
+  // erasing a missing key does not modify the image
+  sitk::Image other = img;
+  EXPECT_FALSE( other.EraseMetaData( "k2" ) );
+  EXPECT_EQ( sitk::Image::GetGlobalNumberOfDeepCopies(), 0u );
+
+  // modifying the pixels still copies the shared buffer
+  copy.SetPixelAsFloat( std::vector<uint32_t>( 2, 0 ), 2.0f );
+  EXPECT_EQ( sitk::Image::GetGlobalNumberOfDeepCopies(), 1u );
+  EXPECT_FALSE( copy.IsBufferShared() );
+  EXPECT_EQ( 1.0f, img.GetPixelAsFloat( std::vector<uint32_t>( 2, 0 ) ) );
+  EXPECT_EQ( 2.0f, copy.GetPixelAsFloat( std::vector<uint32_t>( 2, 0 ) ) );
+  EXPECT_EQ( "v2", copy.GetMetaData( "k2" ) );
+  EXPECT_EQ( std::vector<double>( 2, 5.0 ), copy.GetOrigin() );
+
+  sitk::Image::ResetGlobalDeepCopyStatistics();
+}
+
 TEST_F(Image,Mandelbrot)
 {
   unsigned int xs = 35*100;
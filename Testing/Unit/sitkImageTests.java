@@ -39,7 +39,7 @@ class sitkImageTests
 
   public static void main(String argv[])
     {
-    int ntests = 2;
+    int ntests = 4;
     int npass = 0;
     int nfail = 0;
 
@@ -73,6 +73,32 @@ class sitkImageTests
       nfail++;
       }
     System.out.println("[----------]");
+    System.out.println("[----------]");
+    System.out.println("[ RUN      ] Java.ByteBufferTest");
+    if (ByteBufferTest())
+      {
+      System.out.println("[       OK ] Java.ByteBufferTest");
+      npass++;
+      }
+    else
+      {
+      System.out.println("[     FAIL ] Java.ByteBufferTest");
+      nfail++;
+      }
+    System.out.println("[----------]");
+    System.out.println("[----------]");
+    System.out.println("[ RUN      ] Java.CloseTest");
+    if (CloseTest())
+      {
+      System.out.println("[       OK ] Java.CloseTest");
+      npass++;
+      }
+    else
+      {
+      System.out.println("[     FAIL ] Java.CloseTest");
+      nfail++;
+      }
+    System.out.println("[----------]");
     System.out.println("[==========]");
     if (npass == ntests)
       {
@@ -195,4 +221,76 @@ class sitkImageTests
     return true;
   }
 
+  public static boolean ByteBufferTest()
+    {
+    int size = 10;
+    Image image = new Image(size, size, PixelIDValueEnum.sitkFloat32);
+    VectorUInt32 idx = new VectorUInt32( 2 );
+    idx.set(0, 3);
+    idx.set(1, 2);
+
+    try
+      {
+      java.nio.FloatBuffer buffer = image.getBufferAsByteBuffer().asFloatBuffer();
+      if (buffer.capacity() != size*size)
+        {
+        throw new Exception("Bad buffer capacity");
+        }
+
+      /* the buffer refers to the pixels of the image */
+      buffer.put(3+size*2, 5.0f);
+      if (image.getPixelAsFloat(idx) != 5.0f)
+        {
+        throw new Exception("Bad pixel value written through the buffer");
+        }
+      image.setPixelAsFloat(idx, 7.0f);
+      if (buffer.get(3+size*2) != 7.0f)
+        {
+        throw new Exception("Bad pixel value read through the buffer");
+        }
+
+      /* the buffer keeps the image alive */
+      buffer = new Image(size, size, PixelIDValueEnum.sitkFloat32).getBufferAsByteBuffer().asFloatBuffer();
+      System.gc();
+      buffer.put(0, 1.0f);
+      if (buffer.get(0) != 1.0f)
+        {
+        throw new Exception("Bad pixel value of a pinned image");
+        }
+      }
+    catch (Exception e)
+      {
+      System.out.println(e);
+      return false;
+      }
+
+    return true;
+    }
+
+  public static boolean CloseTest()
+    {
+    int size = 10;
+
+    /* the native objects are released at the end of the block */
+    try (Image image = new Image(size, size, PixelIDValueEnum.sitkUInt8);
+         AddImageFilter filter = new AddImageFilter())
+      {
+      Image sum = filter.execute(image, image);
+      if (sum.getWidth() != size)
+        {
+        throw new Exception("Bad width");
+        }
+      sum.close();
+      /* closing again does nothing */
+      sum.close();
+      }
+    catch (Exception e)
+      {
+      System.out.println(e);
+      return false;
+      }
+
+    return true;
+    }
+
 }
@@ -78,6 +78,45 @@ class ImageTests(unittest.TestCase):
 
         self.assertEqual(len( image ), 100)
 
+    def test_pickle(self):
+        """Test pickling of images, with out-of-band buffers"""
+
+        import pickle
+
+        image = sitk.Image( 10, 9, 8, sitk.sitkVectorFloat32, 2 )
+        image.SetOrigin( [1.0, 2.0, 3.0] )
+        image.SetSpacing( [0.5, 1.5, 2.5] )
+        image.SetMetaData( "key", "value" )
+        image[1,2,3] = [4.0, 5.0]
+
+        for protocol in range( 0, pickle.HIGHEST_PROTOCOL+1 ):
+          img = pickle.loads( pickle.dumps( image, protocol ) )
+          self.assertEqual( img.GetPixelID(), image.GetPixelID() )
+          self.assertEqual( img.GetSize(), image.GetSize() )
+          self.assertEqual( img.GetOrigin(), image.GetOrigin() )
+          self.assertEqual( img.GetSpacing(), image.GetSpacing() )
+          self.assertEqual( img.GetMetaData( "key" ), "value" )
+          self.assertEqual( sitk.Hash( img ), sitk.Hash( image ) )
+
+        for pixelID in [ sitk.sitkComplexFloat32, sitk.sitkLabelUInt8 ]:
+          image = sitk.Image( 5, 6, pixelID )
+          img = pickle.loads( pickle.dumps( image ) )
+          self.assertEqual( img.GetPixelID(), pixelID )
+          self.assertEqual( img.GetSize(), image.GetSize() )
+
+        if pickle.HIGHEST_PROTOCOL >= 5:
+          image = sitk.Image( 10, 10, sitk.sitkUInt16 )
+          buffers = []
+          data = pickle.dumps( image, 5, buffer_callback=buffers.append )
+          self.assertEqual( len( buffers ), 1 )
+
+          # the unpickled image shares the writable out-of-band buffer
+          img = pickle.loads( data, buffers=[ bytearray( buffers[0] ) ] )
+          self.assertEqual( sitk.Hash( img ), sitk.Hash( image ) )
+          img = pickle.loads( data, buffers=buffers )
+          img[1,1] = 7
+          self.assertEqual( image[1,1], 7 )
+
 
 if __name__ == '__main__':
     unittest.main()
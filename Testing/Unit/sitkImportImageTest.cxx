@@ -228,6 +228,53 @@ TEST_F(Import,Shallow) {
 
 }
 
+namespace
+{
+void CountingFloatDeleter( void *buffer, void *clientData )
+{
+  ++(*static_cast<int*>( clientData ));
+  delete [] static_cast<float*>( buffer );
+}
+}
+
+TEST_F(Import,Deleter) {
+
+  // This test is designed to verify ownership of the buffer is
+  // transferred and released with the deleter
+
+  int deleteCount = 0;
+  float *buffer = new float[16*16*2];
+  std::fill( buffer, buffer + 16*16*2, 1.5f );
+
+  sitk::ImportImageFilter importer;
+  importer.SetSize( std::vector< unsigned int >( 2, 16u ) );
+  importer.SetBufferAsFloat( buffer, 2 );
+  EXPECT_TRUE( importer.GetBufferDeleter() == NULL );
+  importer.SetBufferDeleter( CountingFloatDeleter, &deleteCount );
+  EXPECT_TRUE( importer.GetBufferDeleter() == CountingFloatDeleter );
+
+  {
+  sitk::Image image = importer.Execute();
+  EXPECT_TRUE( importer.GetBufferDeleter() == NULL ) << " deleter is cleared after Execute";
+  EXPECT_EQ( image.GetPixelID(), sitk::sitkVectorFloat32 );
+  EXPECT_EQ( static_cast<const sitk::Image &>( image ).GetBufferAsFloat(), buffer ) << " buffer is not copied";
+
+  sitk::Image copy = image;
+  image = sitk::Image();
+  EXPECT_EQ( deleteCount, 0 ) << " buffer still referenced by copy";
+  EXPECT_EQ( copy.GetPixelAsVectorFloat32( std::vector<uint32_t>( 2, 3 ) )[1], 1.5f );
+  }
+  EXPECT_EQ( deleteCount, 1 ) << " buffer deleted with the last image";
+
+  // setting a new buffer clears the deleter
+  std::vector<float> other( 16*16, 0.0f );
+  importer.SetBufferDeleter( CountingFloatDeleter, &deleteCount );
+  importer.SetBufferAsFloat( &other[0] );
+  EXPECT_TRUE( importer.GetBufferDeleter() == NULL );
+  importer.Execute();
+  EXPECT_EQ( deleteCount, 1 );
+}
+
 TEST_F(Import,ExhaustiveTypes) {
 
   sitk::ImportImageFilter importer;
@@ -200,3 +200,208 @@ TEST(LabelStatistics,Shape_OBB) {
   EXPECT_VECTOR_DOUBLE_NEAR( verticesExpected, lssFilter.GetOrientedBoundingBoxVertices(100), 1e-4);
 
 }
+
+
+TEST(LabelStatistics,LabelFeatures) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage ( dataFinder.GetFile ( "Input/cthead1.png" ) );
+  sitk::Image labelImage = sitk::ReadImage ( dataFinder.GetFile ( "Input/2th_cthead1.png" ) );
+  labelImage.SetSpacing( v2( 0.5, 1.5 ) );
+  labelImage.SetOrigin( v2( -3.0, 2.0 ) );
+  image.CopyInformation( labelImage );
+
+  sitk::LabelFeaturesImageFilter featuresFilter;
+  EXPECT_EQ( "LabelFeaturesImageFilter", featuresFilter.GetName() );
+  EXPECT_EQ( unsigned( sitk::LabelFeaturesImageFilter::ALL_FEATURES ), featuresFilter.GetFeatures() );
+  EXPECT_EQ( 0, featuresFilter.GetBackgroundValue() );
+
+  featuresFilter.Execute( labelImage, image );
+  EXPECT_EQ( unsigned( sitk::LabelFeaturesImageFilter::ALL_FEATURES ), featuresFilter.GetComputedFeatures() );
+
+  sitk::LabelShapeStatisticsImageFilter shapeFilter;
+  shapeFilter.Execute( labelImage );
+
+  sitk::LabelStatisticsImageFilter statisticsFilter;
+  statisticsFilter.Execute( image, labelImage );
+
+  ASSERT_EQ( shapeFilter.GetLabels(), featuresFilter.GetLabels() );
+  EXPECT_FALSE( featuresFilter.HasLabel( 0 ) );
+  EXPECT_TRUE( featuresFilter.HasLabel( 100 ) );
+
+  const std::vector<int64_t> labels = featuresFilter.GetLabels();
+  for ( size_t i = 0; i < labels.size(); ++i )
+    {
+    const int64_t label = labels[i];
+    EXPECT_EQ( shapeFilter.GetNumberOfPixels( label ), featuresFilter.GetNumberOfPixels( label ) );
+    EXPECT_EQ( shapeFilter.GetBoundingBox( label ), featuresFilter.GetBoundingBox( label ) );
+    EXPECT_VECTOR_DOUBLE_NEAR( shapeFilter.GetCentroid( label ), featuresFilter.GetCentroid( label ), 1e-6 );
+    EXPECT_VECTOR_DOUBLE_NEAR( shapeFilter.GetPrincipalMoments( label ), featuresFilter.GetPrincipalMoments( label ), 1e-3 );
+
+    EXPECT_NEAR( statisticsFilter.GetSum( label ), featuresFilter.GetSum( label ), 1e-6 );
+    EXPECT_NEAR( statisticsFilter.GetMean( label ), featuresFilter.GetMean( label ), 1e-6 );
+    EXPECT_EQ( statisticsFilter.GetMinimum( label ), featuresFilter.GetMinimum( label ) );
+    EXPECT_EQ( statisticsFilter.GetMaximum( label ), featuresFilter.GetMaximum( label ) );
+    EXPECT_NEAR( statisticsFilter.GetVariance( label ), featuresFilter.GetVariance( label ), 1e-4 );
+    EXPECT_NEAR( statisticsFilter.GetSigma( label ), featuresFilter.GetStandardDeviation( label ), 1e-6 );
+    }
+  EXPECT_ANY_THROW( featuresFilter.GetNumberOfPixels( 1 ) );
+
+  // the results do not depend on the number of threads
+  const std::vector<double> centerOfGravity = featuresFilter.GetCenterOfGravity( 100 );
+  featuresFilter.SetNumberOfThreads( 1 );
+  featuresFilter.Execute( labelImage, image );
+  EXPECT_VECTOR_DOUBLE_NEAR( centerOfGravity, featuresFilter.GetCenterOfGravity( 100 ), 1e-6 );
+
+  // only the selected features are computed, and no intensity
+  // features without an intensity image
+  featuresFilter.SetFeatures( sitk::LabelFeaturesImageFilter::NUMBER_OF_PIXELS | sitk::LabelFeaturesImageFilter::MEAN );
+  featuresFilter.Execute( labelImage );
+  EXPECT_EQ( unsigned( sitk::LabelFeaturesImageFilter::NUMBER_OF_PIXELS ), featuresFilter.GetComputedFeatures() );
+  EXPECT_EQ( shapeFilter.GetNumberOfPixels( 100 ), featuresFilter.GetNumberOfPixels( 100 ) );
+  EXPECT_ANY_THROW( featuresFilter.GetCentroid( 100 ) );
+  EXPECT_ANY_THROW( featuresFilter.GetMean( 100 ) );
+
+  // the background label is skipped
+  featuresFilter.SetBackgroundValue( 100 );
+  featuresFilter.Execute( labelImage );
+  EXPECT_FALSE( featuresFilter.HasLabel( 100 ) );
+  EXPECT_TRUE( featuresFilter.HasLabel( 0 ) );
+}
+
+
+TEST(LabelStatistics,MeasurementArrays) {
+  namespace sitk = itk::simple;
+
+  sitk::Image labelImage = sitk::ReadImage ( dataFinder.GetFile ( "Input/2th_cthead1.png" ) );
+
+  sitk::LabelShapeStatisticsImageFilter shapeFilter;
+  shapeFilter.Execute( labelImage );
+
+  sitk::LabelFeaturesImageFilter featuresFilter;
+  featuresFilter.Execute( labelImage );
+
+  const std::vector<int64_t> labels = shapeFilter.GetLabels();
+  const std::vector<double> centroids = shapeFilter.GetCentroidArray();
+  const std::vector<unsigned int> boundingBoxes = shapeFilter.GetBoundingBoxArray();
+  const std::vector<uint64_t> numberOfPixels = shapeFilter.GetNumberOfPixelsArray();
+  ASSERT_EQ( 2u * labels.size(), centroids.size() );
+  ASSERT_EQ( 4u * labels.size(), boundingBoxes.size() );
+  ASSERT_EQ( labels.size(), numberOfPixels.size() );
+
+  EXPECT_EQ( numberOfPixels, featuresFilter.GetNumberOfPixelsArray() );
+  EXPECT_EQ( boundingBoxes, featuresFilter.GetBoundingBoxArray() );
+  EXPECT_VECTOR_DOUBLE_NEAR( centroids, featuresFilter.GetCentroidArray(), 1e-6 );
+
+  for ( size_t i = 0; i < labels.size(); ++i )
+    {
+    const std::vector<double> centroid( centroids.begin() + 2*i, centroids.begin() + 2*i + 2 );
+    EXPECT_EQ( shapeFilter.GetCentroid( labels[i] ), centroid );
+    EXPECT_EQ( shapeFilter.GetNumberOfPixels( labels[i] ), numberOfPixels[i] );
+    }
+
+  // the intensity features were not computed
+  EXPECT_TRUE( featuresFilter.GetMeanArray().empty() );
+}
+
+
+TEST(LabelStatistics,LabelMapFeatures) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage ( dataFinder.GetFile ( "Input/cthead1.png" ) );
+  sitk::Image labelImage = sitk::ReadImage ( dataFinder.GetFile ( "Input/2th_cthead1.png" ) );
+  labelImage.SetSpacing( v2( 0.5, 1.5 ) );
+  labelImage.SetOrigin( v2( -3.0, 2.0 ) );
+  image.CopyInformation( labelImage );
+
+  sitk::Image labelMap = sitk::Cast( labelImage, sitk::sitkLabelUInt16 );
+
+  sitk::LabelFeaturesImageFilter featuresFilter;
+  featuresFilter.Execute( labelImage, image );
+
+  // the runs of the label map give the features of the dense image
+  sitk::LabelFeaturesImageFilter mapFilter;
+  mapFilter.Execute( labelMap, image );
+
+  EXPECT_EQ( featuresFilter.GetComputedFeatures(), mapFilter.GetComputedFeatures() );
+  ASSERT_EQ( featuresFilter.GetLabels(), mapFilter.GetLabels() );
+  EXPECT_EQ( featuresFilter.GetNumberOfPixelsArray(), mapFilter.GetNumberOfPixelsArray() );
+  EXPECT_EQ( featuresFilter.GetBoundingBoxArray(), mapFilter.GetBoundingBoxArray() );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetCentroidArray(), mapFilter.GetCentroidArray(), 1e-6 );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetSecondOrderMomentsArray(), mapFilter.GetSecondOrderMomentsArray(), 1e-4 );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetSumArray(), mapFilter.GetSumArray(), 1e-6 );
+  EXPECT_EQ( featuresFilter.GetMinimumArray(), mapFilter.GetMinimumArray() );
+  EXPECT_EQ( featuresFilter.GetMaximumArray(), mapFilter.GetMaximumArray() );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetVarianceArray(), mapFilter.GetVarianceArray(), 1e-4 );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetCenterOfGravityArray(), mapFilter.GetCenterOfGravityArray(), 1e-6 );
+
+  // the shape features only, with one thread
+  featuresFilter.Execute( labelImage );
+  mapFilter.SetNumberOfThreads( 1 );
+  mapFilter.Execute( labelMap );
+  EXPECT_EQ( featuresFilter.GetComputedFeatures(), mapFilter.GetComputedFeatures() );
+  EXPECT_EQ( featuresFilter.GetNumberOfPixelsArray(), mapFilter.GetNumberOfPixelsArray() );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetPrincipalMoments( 100 ), mapFilter.GetPrincipalMoments( 100 ), 1e-4 );
+
+  // a label map is written as the dense label image
+  const std::string fileName = dataFinder.GetOutputFile ( "LabelMapFeatures.nrrd" );
+  sitk::WriteImage( labelMap, fileName, true );
+  sitk::Image written = sitk::ReadImage( fileName );
+  EXPECT_EQ( sitk::sitkUInt16, written.GetPixelID() );
+  EXPECT_EQ( sitk::Hash( sitk::Cast( labelImage, sitk::sitkUInt16 ) ), sitk::Hash( written ) );
+}
+
+
+TEST(LabelStatistics,LabelFeatureChunks) {
+  namespace sitk = itk::simple;
+
+  sitk::Image image = sitk::ReadImage ( dataFinder.GetFile ( "Input/cthead1.png" ) );
+  sitk::Image labelImage = sitk::ReadImage ( dataFinder.GetFile ( "Input/2th_cthead1.png" ) );
+  labelImage.SetSpacing( v2( 0.5, 1.5 ) );
+  labelImage.SetOrigin( v2( -3.0, 2.0 ) );
+  image.CopyInformation( labelImage );
+
+  sitk::LabelFeaturesImageFilter featuresFilter;
+  featuresFilter.Execute( labelImage, image );
+
+  // the chunks are bands of rows of different heights, so the labels
+  // span several chunks
+  sitk::LabelFeaturesImageFilter chunksFilter;
+  EXPECT_EQ( 0u, chunksFilter.GetNumberOfChunks() );
+  const unsigned int width = labelImage.GetWidth();
+  const unsigned int height = labelImage.GetHeight();
+  const unsigned int rows[] = { 0, 50, 51, 130, height };
+  for ( unsigned int i = 0; i + 1 < sizeof( rows ) / sizeof( rows[0] ); ++i )
+    {
+    std::vector<unsigned int> size( 2, width );
+    size[1] = rows[i+1] - rows[i];
+    std::vector<int> index( 2, 0 );
+    index[1] = rows[i];
+    chunksFilter.AddChunk( sitk::RegionOfInterest( labelImage, size, index ),
+                           sitk::RegionOfInterest( image, size, index ),
+                           index );
+    }
+  EXPECT_EQ( 4u, chunksFilter.GetNumberOfChunks() );
+  chunksFilter.ExecuteChunks();
+
+  EXPECT_EQ( featuresFilter.GetComputedFeatures(), chunksFilter.GetComputedFeatures() );
+  ASSERT_EQ( featuresFilter.GetLabels(), chunksFilter.GetLabels() );
+  EXPECT_EQ( featuresFilter.GetNumberOfPixelsArray(), chunksFilter.GetNumberOfPixelsArray() );
+  EXPECT_EQ( featuresFilter.GetBoundingBoxArray(), chunksFilter.GetBoundingBoxArray() );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetCentroidArray(), chunksFilter.GetCentroidArray(), 1e-6 );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetSecondOrderMomentsArray(), chunksFilter.GetSecondOrderMomentsArray(), 1e-4 );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetSumArray(), chunksFilter.GetSumArray(), 1e-6 );
+  EXPECT_EQ( featuresFilter.GetMinimumArray(), chunksFilter.GetMinimumArray() );
+  EXPECT_EQ( featuresFilter.GetMaximumArray(), chunksFilter.GetMaximumArray() );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetVarianceArray(), chunksFilter.GetVarianceArray(), 1e-4 );
+  EXPECT_VECTOR_DOUBLE_NEAR( featuresFilter.GetCenterOfGravityArray(), chunksFilter.GetCenterOfGravityArray(), 1e-6 );
+
+  // the chunks must be consistent
+  std::vector<int> index( 2, 0 );
+  EXPECT_ANY_THROW( chunksFilter.AddChunk( labelImage, index ) );
+  EXPECT_ANY_THROW( chunksFilter.AddChunk( labelImage, std::vector<int>( 1, 0 ) ) );
+
+  chunksFilter.ClearChunks();
+  EXPECT_EQ( 0u, chunksFilter.GetNumberOfChunks() );
+  EXPECT_ANY_THROW( chunksFilter.ExecuteChunks() );
+}
@@ -174,5 +174,161 @@ class TestNumpySimpleITKInterface(unittest.TestCase):
       self.assertEqual(image[1,1,1], 25)
       self.assertEqual(image[2,2,2], 50)
 
+    def test_transform_points_array(self):
+      """Test the batched transforms of arrays of points."""
+
+      image = sitk.Image((10, 20, 30), sitk.sitkUInt8)
+      image.SetOrigin((1.1, 2.2, 3.3))
+      image.SetSpacing((0.5, 0.75, 1.5))
+      image.SetDirection((0, 1, 0, -1, 0, 0, 0, 0, 1))
+
+      points = np.random.uniform(-10, 10, size=(1000, 3))
+
+      indices = image.TransformPhysicalPointsToIndicesArray(points)
+      self.assertEqual(indices.shape, (1000, 3))
+      self.assertEqual(indices.dtype, np.int64)
+      cindices = image.TransformPhysicalPointsToContinuousIndicesArray(points)
+      self.assertEqual(cindices.dtype, np.float64)
+
+      for p in range(0, 1000, 97):
+        pt = tuple(points[p])
+        self.assertEqual(tuple(indices[p]), image.TransformPhysicalPointToIndex(pt))
+        self.assertEqual(tuple(cindices[p]), image.TransformPhysicalPointToContinuousIndex(pt))
+
+      np.testing.assert_allclose(image.TransformContinuousIndicesToPhysicalPointsArray(cindices), points)
+      ipoints = image.TransformIndicesToPhysicalPointsArray(indices)
+      self.assertEqual(tuple(ipoints[3]), image.TransformIndexToPhysicalPoint(tuple(int(i) for i in indices[3])))
+
+      # the array must have the dimension of the image
+      with self.assertRaises(ValueError):
+        image.TransformPhysicalPointsToIndicesArray(np.zeros((5, 2)))
+
+    def test_transform_points_with_transform(self):
+      """Test the batched transform of an array of points."""
+
+      tx = sitk.Transform(sitk.AffineTransform(3).SetTranslation((1.0, 2.0, 3.0)))
+      tx.AddTransform(sitk.Euler3DTransform((0, 0, 0), 0.1, 0.2, 0.3))
+
+      points = np.random.uniform(-10, 10, size=(500, 3))
+      tpoints = tx.TransformPointsArray(points)
+      self.assertEqual(tpoints.shape, (500, 3))
+      for p in range(0, 500, 37):
+        self.assertEqual(tuple(tpoints[p]), tx.TransformPoint(tuple(points[p])))
+
+    def test_transform_parameters_array(self):
+      """Test the NumPy views of the parameters of a transform."""
+
+      tx = sitk.BSplineTransform(2)
+      tx.SetTransformDomainMeshSize((4, 5))
+      n = tx.GetNumberOfParameters()
+
+      parameters = np.arange(n, dtype=np.float64)
+      tx.SetParametersFromArray(parameters)
+      self.assertEqual(tx.GetParameters(), tuple(parameters))
+
+      view = tx.GetParametersArrayView()
+      self.assertEqual(view.shape, (n,))
+      self.assertFalse(view.flags.writeable)
+      self.assertTrue(np.array_equal(view, parameters))
+
+      coefficients = tx.GetCoefficientArrayViews()
+      self.assertEqual(len(coefficients), 2)
+      self.assertEqual(coefficients[0].shape, (8, 7))
+      self.assertTrue(np.array_equal(coefficients[1], sitk.GetArrayFromImage(tx.GetCoefficientImages()[1])))
+
+      # the view does not change when the transform is modified
+      tx.SetParametersFromArray(np.zeros(n))
+      self.assertTrue(np.array_equal(view, parameters))
+      del tx
+      self.assertTrue(np.array_equal(view, parameters))
+
+      out = np.empty(6)
+      affine = sitk.AffineTransform(2)
+      self.assertIs(affine.GetParametersArray(out), out)
+      self.assertEqual(tuple(out), affine.GetParameters())
+      self.assertEqual(sitk.Transform().GetParametersArrayView().shape, (0,))
+
+    def test_label_feature_arrays(self):
+      """Test the arrays of the features of all the labels."""
+
+      labels = np.zeros((20, 30), dtype=np.uint8)
+      labels[2:5, 3:9] = 1
+      labels[10:18, 1:4] = 7
+      labels[12, 20] = 3
+      labelImage = sitk.GetImageFromArray(labels)
+      labelImage.SetSpacing((0.5, 2.0))
+      intensityImage = sitk.GetImageFromArray(np.arange(600, dtype=np.float32).reshape(20, 30))
+      intensityImage.CopyInformation(labelImage)
+
+      features = sitk.LabelFeaturesImageFilter()
+      features.Execute(labelImage, intensityImage)
+      arrays = features.GetFeatureArrays()
+
+      self.assertEqual(tuple(arrays["Labels"]), (1, 3, 7))
+      self.assertEqual(arrays["Centroid"].shape, (3, 2))
+      self.assertEqual(arrays["BoundingBox"].shape, (3, 4))
+      self.assertEqual(arrays["SecondOrderMoments"].shape, (3, 2, 2))
+      for i, label in enumerate(features.GetLabels()):
+        self.assertEqual(arrays["NumberOfPixels"][i], features.GetNumberOfPixels(label))
+        self.assertEqual(tuple(arrays["BoundingBox"][i]), features.GetBoundingBox(label))
+        self.assertEqual(tuple(arrays["Centroid"][i]), features.GetCentroid(label))
+        self.assertEqual(arrays["Mean"][i], features.GetMean(label))
+
+      # only the computed features
+      features.SetFeatures(sitk.LabelFeaturesImageFilter.CENTROID)
+      features.Execute(labelImage)
+      self.assertEqual(set(features.GetFeatureArrays().keys()), set(["Labels", "NumberOfPixels", "Centroid"]))
+
+    def test_histogram_counts_array(self):
+      """Test the counts of a histogram as an array"""
+
+      image = sitk.GetImageFromArray(np.arange(600, dtype=np.float32).reshape(20, 30))
+      image2 = sitk.GetImageFromArray((np.arange(600, dtype=np.int16) % 7).reshape(20, 30))
+
+      histogram = sitk.HistogramImageFilter()
+      histogram.SetNumberOfBins(10)
+      histogram.Execute(image)
+      counts = histogram.GetCountsArray()
+      self.assertEqual(counts.shape, (10,))
+      self.assertEqual(counts.dtype, np.uint64)
+      self.assertEqual(tuple(counts), histogram.GetCounts())
+      self.assertEqual(counts.sum(), 600)
+
+      histogram.ExecuteJoint(image, image2)
+      counts = histogram.GetCountsArray()
+      self.assertEqual(counts.shape, (10, 10))
+      self.assertEqual(counts.sum(), 600)
+
+      # the marginal of the first image is its histogram
+      histogram.Execute(image)
+      self.assertTrue(np.array_equal(counts.sum(axis=1), histogram.GetCountsArray()))
+
+    def test_slice_by_slice(self):
+      """Test applying a filter to each slice of an image"""
+
+      image = sitk.GetImageFromArray(np.random.rand(5, 12, 10).astype(np.float32))
+      image.SetSpacing([0.5, 0.7, 3.0])
+      image.SetOrigin([1.0, 2.0, 3.0])
+
+      expected = sitk.JoinSeries([sitk.Median(image[:,:,z], [1, 1]) for z in range(5)])
+
+      for numberOfThreads in [1, 3]:
+        result = sitk.SliceBySlice(image, lambda s: sitk.Median(s, [1, 1]), numberOfThreads)
+        self.assertEqual(result.GetSize(), image.GetSize())
+        self.assertEqual(result.GetSpacing(), image.GetSpacing())
+        self.assertEqual(result.GetOrigin(), image.GetOrigin())
+        self.assertTrue(np.array_equal(sitk.GetArrayViewFromImage(result), sitk.GetArrayViewFromImage(expected)))
+
+      # a filter object, with a change of the pixel type
+      threshold = sitk.BinaryThresholdImageFilter()
+      threshold.SetLowerThreshold(0.5)
+      threshold.SetUpperThreshold(1.0)
+      result = sitk.SliceBySlice(image, threshold)
+      self.assertEqual(result.GetPixelID(), sitk.sitkUInt8)
+      self.assertTrue(np.array_equal(sitk.GetArrayViewFromImage(result), sitk.GetArrayViewFromImage(image) >= 0.5))
+
+      # the result must have the size of the slice
+      self.assertRaises(ValueError, sitk.SliceBySlice, image, lambda s: sitk.Shrink(s, [2, 2]))
+
 if __name__ == '__main__':
     unittest.main()
@@ -21,6 +21,7 @@ import unittest
 
 
 import SimpleITK as sitk
+from multiprocessing.pool import ThreadPool
 
 
 class ProcessObjectTest(unittest.TestCase):
@@ -94,5 +95,32 @@ class ProcessObjectTest(unittest.TestCase):
         self.assertEqual(p,[0.0])
 
 
+    def test_ProcessObject_threaded_Command(self):
+        """Check that commands are called while filters execute in Python threads"""
+
+        def smooth(i):
+            f = sitk.DiscreteGaussianImageFilter()
+            f.SetVariance(2.0)
+            f.SetNumberOfThreads(1)
+            p = [0.0]
+            events = [0]
+            def prog():
+                events[0] += 1
+                p[0] = f.GetProgress()
+            f.AddCommand(sitk.sitkProgressEvent, prog)
+            img = f.Execute(sitk.Image(64,64,32,sitk.sitkFloat32)+i)
+            return (p[0], events[0], img.GetPixel(10,10,10))
+
+        pool = ThreadPool(4)
+        results = pool.map(smooth, range(8))
+        pool.close()
+        pool.join()
+
+        for i, (p, events, value) in enumerate(results):
+            self.assertEqual(p, 1.0)
+            self.assertGreater(events, 0)
+            self.assertAlmostEqual(value, i, places=4)
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -489,6 +489,47 @@ TEST(TransformTest, TransformPoint) {
 
 }
 
+TEST(TransformTest, TransformPoints) {
+
+  // a composite of an affine and a bspline transform
+  sitk::AffineTransform affine( 2 );
+  affine.SetMatrix( v4( 1.1, 0.2, -0.3, 0.9 ) );
+  affine.SetTranslation( v2( 1.5, -2.5 ) );
+
+  sitk::BSplineTransform bspline( 2 );
+  bspline.SetTransformDomainMeshSize( std::vector<unsigned int>( 2, 4u ) );
+  bspline.SetTransformDomainPhysicalDimensions( v2( 20.0, 20.0 ) );
+  bspline.SetTransformDomainOrigin( v2( -10.0, -10.0 ) );
+  std::vector<double> params = bspline.GetParameters();
+  for ( size_t i = 0; i < params.size(); ++i )
+    {
+    params[i] = 0.01 * static_cast<double>( i % 7 );
+    }
+  bspline.SetParameters( params );
+
+  sitk::Transform tx( affine );
+  tx.AddTransform( bspline );
+
+  // enough points to be transformed by multiple threads
+  const size_t numberOfPoints = 50000;
+  std::vector<double> ipts( 2 * numberOfPoints );
+  for ( size_t i = 0; i < ipts.size(); ++i )
+    {
+    ipts[i] = 0.013 * static_cast<double>( i % 1499 ) - 9.0;
+    }
+
+  const std::vector<double> opts = tx.TransformPoints( ipts );
+  ASSERT_EQ( opts.size(), ipts.size() );
+  for ( size_t p = 0; p < numberOfPoints; p += 499 )
+    {
+    EXPECT_EQ( tx.TransformPoint( std::vector<double>( ipts.begin() + 2*p, ipts.begin() + 2*p + 2 ) ),
+               std::vector<double>( opts.begin() + 2*p, opts.begin() + 2*p + 2 ) ) << " point " << p;
+    }
+
+  EXPECT_TRUE( tx.TransformPoints( std::vector<double>() ).empty() );
+  EXPECT_ANY_THROW( tx.TransformPoints( std::vector<double>( 3, 0.0 ) ) );
+}
+
 
 TEST(TransformTest,AffineTransform)
 {
@@ -715,6 +756,43 @@ TEST(TransformTest,BSplineTransform)
   EXPECT_THROW(tx->GetInverse(),sitk::GenericException);
 }
 
+TEST(TransformTest,BSplineTransform_ParametersBuffer)
+{
+  sitk::BSplineTransform tx(2);
+  tx.SetTransformDomainMeshSize( std::vector<unsigned int>(2,4u) );
+  ASSERT_EQ( tx.GetNumberOfParameters(), 98u );
+
+  std::vector<double> parameters( tx.GetNumberOfParameters() );
+  for ( size_t i = 0; i < parameters.size(); ++i )
+    {
+    parameters[i] = 0.5 * i;
+    }
+  tx.SetParameters( &parameters[0], parameters.size() );
+  EXPECT_EQ( tx.GetParameters(), parameters );
+
+  // the parameters are the coefficients of the transform
+  const double *p = tx.GetParametersAsDouble();
+  ASSERT_TRUE( p != SITK_NULLPTR );
+  EXPECT_EQ( std::vector<double>( p, p + tx.GetNumberOfParameters() ), parameters );
+  std::vector<sitk::Image> coefficientImages = tx.GetCoefficientImages();
+  EXPECT_EQ( static_cast<const sitk::Image &>( coefficientImages[0] ).GetBufferAsDouble(), p );
+  EXPECT_EQ( static_cast<const sitk::Image &>( coefficientImages[1] ).GetBufferAsDouble(), p + 49 );
+
+  // copy on write
+  sitk::Transform copy( tx );
+  std::vector<double> zeros( parameters.size(), 0.0 );
+  copy.SetParameters( &zeros[0], zeros.size() );
+  EXPECT_EQ( copy.GetParameters(), zeros );
+  EXPECT_EQ( tx.GetParameters(), parameters );
+
+  EXPECT_THROW( tx.SetParameters( &zeros[0], 10u ), sitk::GenericException );
+
+  sitk::AffineTransform affine(2);
+  ASSERT_EQ( affine.GetNumberOfParameters(), 6u );
+  std::vector<double> affineParameters = affine.GetParameters();
+  EXPECT_EQ( std::vector<double>( affine.GetParametersAsDouble(), affine.GetParametersAsDouble() + 6 ), affineParameters );
+}
+
 TEST(TransformTest,BSplineTransform_order)
 {
   // test features with bspline order
@@ -858,6 +936,34 @@ TEST(TransformTest,DisplacementFieldTransform_CopyOnWrite)
 
 }
 
+TEST(TransformTest,DisplacementFieldTransform_HDF5)
+{
+  std::vector<unsigned int> size(2,20u);
+  sitk::Image disImage( size, sitk::sitkVectorFloat64 );
+  disImage.SetOrigin( v2(1.0,2.0) );
+  double *buffer = disImage.GetBufferAsDouble();
+  for ( unsigned int i = 0; i < 2u*20u*20u; ++i )
+    {
+    buffer[i] = 0.25 * ( i % 17 );
+    }
+
+  const sitk::DisplacementFieldTransform tx( disImage );
+  const std::vector<double> parameters = tx.GetParameters();
+
+  const std::string filename = dataFinder.GetOutputFile ( "TransformTest.DisplacementFieldTransform_HDF5.h5" );
+  sitk::WriteTransform( tx, filename, true );
+  sitk::DisplacementFieldTransform readTx( sitk::ReadTransform( filename ) );
+  EXPECT_EQ( readTx.GetFixedParameters(), tx.GetFixedParameters() );
+  EXPECT_EQ( readTx.GetParameters(), parameters );
+
+  // the parameters are exactly representable as floats
+  tx.WriteTransform( filename, true, true );
+  readTx = sitk::DisplacementFieldTransform( sitk::ReadTransform( filename ) );
+  EXPECT_EQ( readTx.GetFixedParameters(), tx.GetFixedParameters() );
+  EXPECT_EQ( readTx.GetParameters(), parameters );
+  EXPECT_EQ( readTx.TransformPoint( v2(5.5,7.5) ), tx.TransformPoint( v2(5.5,7.5) ) );
+}
+
 TEST(TransformTest,DisplacementFieldTransform_Points)
 {
   const std::vector<unsigned int> size(3,5u);
@@ -890,6 +996,34 @@ TEST(TransformTest,DisplacementFieldTransform_Points)
 
 }
 
+TEST(TransformTest,DisplacementFieldTransform_Float32)
+{
+  const std::vector<unsigned int> idx(2,0u);
+  std::vector<float> displacement(2, 0.5f);
+
+  sitk::Image disImage( std::vector<unsigned int>(2,5u), sitk::sitkVectorFloat32 );
+  disImage.SetPixelAsVectorFloat32( idx, displacement );
+  disImage.SetSpacing( v2(2.0,2.0) );
+
+  // a single precision field is converted and consumed
+  sitk::DisplacementFieldTransform tx(disImage);
+  EXPECT_EQ( disImage.GetSize()[0], 0u );
+
+  EXPECT_VECTOR_DOUBLE_NEAR( tx.TransformPoint( v2(0.0,0.0) ), v2(0.5,0.5), 1e-15 );
+  EXPECT_VECTOR_DOUBLE_NEAR( tx.TransformPoint( v2(1.0, 0.0) ), v2(1.25,0.25), 1e-15 );
+
+  sitk::Image field = tx.GetDisplacementField();
+  EXPECT_EQ( field.GetPixelID(), sitk::sitkVectorFloat64 );
+  EXPECT_VECTOR_DOUBLE_NEAR( field.GetSpacing(), v2(2.0,2.0), 1e-15 );
+
+  disImage = sitk::Image( std::vector<unsigned int>(2,5u), sitk::sitkVectorFloat32 );
+  tx.SetInverseDisplacementField( disImage );
+  EXPECT_EQ( tx.GetInverseDisplacementField().GetPixelID(), sitk::sitkVectorFloat64 );
+
+  disImage = sitk::Image( std::vector<unsigned int>(2,5u), sitk::sitkVectorFloat32, 3 );
+  EXPECT_THROW( tx.SetDisplacementField( disImage ), sitk::GenericException );
+}
+
 TEST(TransformTest,Euler2DTransform)
 {
   // test Euler2DTransform
@@ -24,6 +24,7 @@
 #include <sitkImageFileWriter.h>
 #include <sitkHashImageFilter.h>
 #include <sitkCastImageFilter.h>
+#include <sitkPipeline.h>
 #include <sitkVersion.h>
 
 
@@ -129,3 +130,36 @@ TEST(BasicFilters,TransformToDisplacementFieldFilter_32)
 
    IMAGECOMPAREWITHTOLERANCE ( output, "", 5e-4 );
 }
+
+TEST(BasicFilters,TransformToDisplacementFieldFilter_Streaming)
+  {
+  namespace sitk = itk::simple;
+
+  sitk::Transform input = sitk::ReadTransform( dataFinder.GetFile( "Input/xforms/affine_i_3.txt" ) );
+
+  sitk::TransformToDisplacementFieldFilter filter;
+  filter.SetOutputPixelType( sitk::sitkVectorFloat32 );
+  filter.SetSize( std::vector<unsigned int>( 3, 32 ) );
+
+  const std::string expected = sitk::Hash( filter.Execute( input ) );
+
+  // the field is computed one piece at a time
+  filter.SetNumberOfStreamDivisions( 4 );
+  EXPECT_EQ( expected, sitk::Hash( filter.Execute( input ) ) );
+
+  // the deferred field is computed while it is written
+  sitk::Pipeline pipeline;
+  pipeline.AddFilter( filter );
+  sitk::Image placeholder = filter.Execute( input );
+  EXPECT_EQ( 1u, pipeline.GetNumberOfProcesses() );
+  EXPECT_EQ( filter.GetSize(), placeholder.GetSize() );
+  EXPECT_EQ( sitk::sitkVectorFloat32, placeholder.GetPixelID() );
+
+  const std::string fileName = dataFinder.GetOutputFile( "TransformToDisplacementFieldFilter_Streaming.mha" );
+  sitk::ImageFileWriter writer;
+  writer.SetFileName( fileName );
+  writer.SetNumberOfStreamDivisions( 4 );
+  writer.Execute( placeholder );
+
+  EXPECT_EQ( expected, sitk::Hash( sitk::ReadImage( fileName ) ) );
+}
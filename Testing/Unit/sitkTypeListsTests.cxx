@@ -17,6 +17,7 @@
 *=========================================================================*/
 #include "SimpleITKTestHarness.h"
 #include <sitkPixelIDTypeLists.h>
+#include "nsstd/type_traits.h"
 
 class TypeListTest
   : public ::testing::Test
@@ -85,3 +86,26 @@ TEST_F(TypeListTest, DualVisit) {
   EXPECT_EQ( constPred.count, 9 );
 
 }
+
+TEST_F(TypeListTest, Queries) {
+
+  typedef typelist::MakeTypeList<int, char, short>::Type MyTypeList;
+  typedef typelist::Append<MyTypeList, MyTypeList>::Type MyDoubleTypeList;
+
+  EXPECT_EQ( 3, int( typelist::Length<MyTypeList>::Result ) );
+  EXPECT_EQ( 6, int( typelist::Length<MyDoubleTypeList>::Result ) );
+  EXPECT_EQ( 0, int( typelist::Length<typelist::NullType>::Result ) );
+
+  // the index of the first of repeated types
+  EXPECT_EQ( 1, int( typelist::IndexOf<MyDoubleTypeList, char>::Result ) );
+  EXPECT_EQ( -1, int( typelist::IndexOf<MyDoubleTypeList, long>::Result ) );
+  EXPECT_TRUE( bool( typelist::HasType<MyTypeList, short>::Result ) );
+  EXPECT_FALSE( bool( typelist::HasType<MyTypeList, long>::Result ) );
+
+  EXPECT_TRUE( ( itk::simple::nsstd::is_same< typelist::TypeAt<MyDoubleTypeList, 4>::Result, char >::value ) );
+  EXPECT_TRUE( ( itk::simple::nsstd::is_same< typelist::TypeAt<MyTypeList, 3>::Result, typelist::NullType >::value ) );
+  EXPECT_TRUE( ( itk::simple::nsstd::is_same< typelist::Append<MyTypeList, long>::Type,
+                                               typelist::MakeTypeList<int, char, short, long>::Type >::value ) );
+  EXPECT_TRUE( ( itk::simple::nsstd::is_same< typelist::Append<typelist::NullType, typelist::NullType>::Type,
+                                               typelist::NullType >::value ) );
+}
@@ -42,6 +42,7 @@
 %CSharpTypemapHelper( uint32_t*, System.IntPtr )
 %CSharpTypemapHelper( float*, System.IntPtr )
 %CSharpTypemapHelper( double*, System.IntPtr )
+%CSharpTypemapHelper( void*, System.IntPtr )
 
 // Add override to ToString method
 %csmethodmodifiers ToString "public override";
@@ -50,6 +51,48 @@
 // TODO:
 //%apply unsigned int INOUT[] {unsigned int DefaultOrder[3]}
 
+// The size of the pixels of an image is added to the memory pressure
+// of the garbage collector while the image owns the native object, so
+// that collections account for the native memory. The pixels of
+// copies sharing a buffer are counted by each copy.
+%typemap(csbody) itk::simple::Image %{
+  private global::System.Runtime.InteropServices.HandleRef swigCPtr;
+  protected bool swigCMemOwn;
+  private long swigMemoryPressure;
+
+  internal $csclassname(global::System.IntPtr cPtr, bool cMemoryOwn) {
+    swigCMemOwn = cMemoryOwn;
+    swigCPtr = new global::System.Runtime.InteropServices.HandleRef(this, cPtr);
+    if (cMemoryOwn && cPtr != global::System.IntPtr.Zero) {
+      swigMemoryPressure = (long)GetSizeInBytes();
+      if (swigMemoryPressure > 0) {
+        global::System.GC.AddMemoryPressure(swigMemoryPressure);
+      }
+    }
+  }
+
+  internal static global::System.Runtime.InteropServices.HandleRef getCPtr($csclassname obj) {
+    return (obj == null) ? new global::System.Runtime.InteropServices.HandleRef(null, global::System.IntPtr.Zero) : obj.swigCPtr;
+  }
+%}
+
+%typemap(csdestruct, methodname="Dispose", methodmodifiers="public") itk::simple::Image {
+    lock(this) {
+      if (swigCPtr.Handle != global::System.IntPtr.Zero) {
+        if (swigCMemOwn) {
+          swigCMemOwn = false;
+          $imcall;
+        }
+        swigCPtr = new global::System.Runtime.InteropServices.HandleRef(null, global::System.IntPtr.Zero);
+      }
+      if (swigMemoryPressure > 0) {
+        global::System.GC.RemoveMemoryPressure(swigMemoryPressure);
+        swigMemoryPressure = 0;
+      }
+      global::System.GC.SuppressFinalize(this);
+    }
+  }
+
 // Extend Image class
 %typemap(cscode) itk::simple::Image %{
 
@@ -263,6 +306,25 @@
   }
 
   #endregion
+
+  #region Pixel buffer access
+
+  ///<summary>Call an action with a pointer to the unique pixel buffer
+  ///of the image and its size in bytes, keeping the image alive until
+  ///the action returns.</summary>
+  ///<remarks>The buffer is laid out as described for GetBufferAsVoid.
+  ///The pointer is only valid while the action runs, it may be used
+  ///with System.Runtime.InteropServices.Marshal.Copy for bulk copies,
+  ///or wrapped in a view such as a Span.</remarks>
+  public void UseBuffer(System.Action<System.IntPtr, long> action) {
+    try {
+      action(GetBufferAsVoid(), (long) GetSizeInBytes());
+    } finally {
+      System.GC.KeepAlive(this);
+    }
+  }
+
+  #endregion
 %}
 
 #endif // End of C# specific sections
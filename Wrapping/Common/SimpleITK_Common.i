@@ -69,8 +69,17 @@
 %ignore itk::simple::Image::GetBufferAsUInt64;
 %ignore itk::simple::Image::GetBufferAsFloat;
 %ignore itk::simple::Image::GetBufferAsDouble;
+%ignore itk::simple::Image::GetBufferAsVoid;
 #endif
 
+// The raw parameter interface, Python has NumPy views of the parameters
+%ignore itk::simple::Transform::GetParametersAsDouble;
+%ignore itk::simple::Transform::SetParameters( const double *, size_t );
+
+// The raw pointer interface, the wrapped languages use the vector of bytes
+%ignore itk::simple::ReadImageFromMemory( const void *, size_t, const std::string & );
+%ignore itk::simple::ReadImageFromMemory( const void *, size_t );
+
 
 // This section is copied verbatim into the generated source code.
 // Any include files, definitions, etc. need to go here.
@@ -95,8 +104,11 @@ namespace std
   %template(VectorFloat) vector<float>;
   %template(VectorDouble) vector<double>;
   %template(VectorOfImage) vector< itk::simple::Image >;
+  %template(VectorOfTransform) vector< itk::simple::Transform >;
   %template(VectorUIntList) vector< vector<unsigned int> >;
+  %template(VectorOfVectorDouble) vector< vector<double> >;
   %template(VectorString) vector< std::string >;
+  %template(VectorOfVectorString) vector< vector< std::string > >;
 
   %template(DoubleDoubleMap) map<double, double>;
 }
@@ -132,6 +144,7 @@ namespace std
 
 
 // define these preprocessor directives to nothing for the swig interface
+#define SITK_NOEXCEPT
 #define SITKCommon_EXPORT
 #define SITKCommon_HIDDEN
 #define SITKBasicFilters0_EXPORT
@@ -151,6 +164,8 @@ namespace std
 %include "sitkVersion.h"
 %include "sitkPixelIDValues.h"
 %include "sitkImage.h"
+%include "sitkImageView.h"
+%include "sitkFloat16.h"
 %include "sitkCommand.h"
 %include "sitkInterpolator.h"
 %include "sitkKernel.h"
@@ -175,7 +190,10 @@ namespace std
 
 
 // Basic Filter Base
+%include "sitkCancellationToken.h"
 %include "sitkProcessObject.h"
+%include "sitkPipeline.h"
+%include "sitkExecutionCache.h"
 %include "sitkImageFilter.h"
 
 %template(ImageFilter_0) itk::simple::ImageFilter<0>;
@@ -192,6 +210,11 @@ namespace std
 %include "sitkImageReaderBase.h"
 %include "sitkImageSeriesReader.h"
 %include "sitkImageFileReader.h"
+%include "sitkImageFileReaderQueue.h"
+%include "sitkImageMemoryIO.h"
+%include "sitkSharedMemoryImage.h"
+%include "sitkCompressedImageStore.h"
+%include "sitkDistributedTileExecutor.h"
 
  // Basic Filters
 %include "sitkHashImageFilter.h"
@@ -199,7 +222,22 @@ namespace std
 %include "sitkCenteredTransformInitializerFilter.h"
 %include "sitkCenteredVersorTransformInitializerFilter.h"
 %include "sitkLandmarkBasedTransformInitializerFilter.h"
+%include "sitkFlattenTransformFilter.h"
+%include "sitkMultiResolutionDemonsRegistrationFilter.h"
+%include "sitkFFTConfiguration.h"
+%include "sitkConvolve.h"
+%include "sitkDeconvolutionContext.h"
+%include "sitkNormalizedCorrelationMatcher.h"
+%include "sitkLabelFeaturesImageFilter.h"
+%include "sitkHistogramImageFilter.h"
 %include "sitkCastImageFilter.h"
+%include "sitkImageAccumulator.h"
+%include "sitkTileImageBuilder.h"
+%include "sitkProjectionAccumulator.h"
+%include "sitkStatisticsAccumulator.h"
+%include "sitkPackedBinaryImage.h"
+%include "sitkRandomAugmentationFilter.h"
+%include "sitkGaussianScaleSpaceFilter.h"
 %include "sitkAdditionalProcedures.h"
 
 // Registration
@@ -43,5 +43,99 @@
 // called from C++
 %feature("director") itk::simple::Command;
 
+// Direct access to the pixel buffer of an image with a
+// java.nio.ByteBuffer, which refers to the unique buffer of the image.
+%{
+struct sitkJavaDirectBuffer
+{
+  void *m_Data;
+  jlong m_Length;
+};
+%}
+%typemap(jni) sitkJavaDirectBuffer "jobject"
+%typemap(jtype) sitkJavaDirectBuffer "java.nio.ByteBuffer"
+%typemap(jstype) sitkJavaDirectBuffer "java.nio.ByteBuffer"
+%typemap(javaout) sitkJavaDirectBuffer { return $jnicall; }
+%typemap(out) sitkJavaDirectBuffer
+{
+  const sitkJavaDirectBuffer &buffer = $1;
+  $result = jenv->NewDirectByteBuffer( buffer.m_Data, buffer.m_Length );
+}
+
+%javamethodmodifiers itk::simple::Image::GetDirectByteBuffer "private";
+%extend itk::simple::Image {
+  sitkJavaDirectBuffer GetDirectByteBuffer( void )
+  {
+    // a java.nio.Buffer is indexed by int
+    if ( self->GetSizeInBytes() > static_cast<uint64_t>( std::numeric_limits<int32_t>::max() ) )
+      {
+      sitkExceptionMacro( "The pixel buffer of " << self->GetSizeInBytes()
+                          << " bytes is too large for a java.nio.ByteBuffer." );
+      }
+    sitkJavaDirectBuffer buffer;
+    buffer.m_Data = self->GetBufferAsVoid();
+    buffer.m_Length = static_cast<jlong>( self->GetSizeInBytes() );
+    return buffer;
+  }
+}
+
+// The native objects may be released deterministically with
+// try-with-resources, instead of when the garbage collector finalizes
+// them, which does not account for their native memory.
+%typemap(javainterfaces) SWIGTYPE "AutoCloseable";
+%typemap(javacode) SWIGTYPE %{
+  /** Release the native object, as delete(). */
+  public void close() {
+    delete();
+  }
+%}
+
+%typemap(javacode) itk::simple::Image %{
+  /** Release the native image, and its pixels if they are not shared
+   * with another image, as delete(). The image must not be closed
+   * while a buffer from getBufferAsByteBuffer is used. */
+  public void close() {
+    delete();
+  }
+
+  /** A phantom reference to a buffer, which holds the image until
+   * the buffer and all views derived from it are unreachable. */
+  private static final class BufferPin extends java.lang.ref.PhantomReference<java.nio.ByteBuffer> {
+    private final Image image;
+
+    BufferPin(java.nio.ByteBuffer buffer, Image image, java.lang.ref.ReferenceQueue<java.nio.ByteBuffer> queue) {
+      super(buffer, queue);
+      this.image = image;
+    }
+  }
+
+  private static final java.lang.ref.ReferenceQueue<java.nio.ByteBuffer> bufferPinQueue =
+    new java.lang.ref.ReferenceQueue<java.nio.ByteBuffer>();
+  private static final java.util.Set<BufferPin> bufferPins =
+    java.util.Collections.synchronizedSet(new java.util.HashSet<BufferPin>());
+
+  /** Get a direct buffer of the pixels of the image, in native byte order.
+   *
+   * The image is made unique, and the buffer refers to its pixels
+   * without copying, laid out as for the GetBufferAs methods of the
+   * C++ Image. Typed views of the buffer may be obtained, such as
+   * with asFloatBuffer(). The image is kept alive while the buffer is
+   * reachable, but the image must not be explicitly deleted, and the
+   * buffer no longer refers to the image's pixels if they are
+   * replaced, such as when a copy of the image sharing its pixels is
+   * modified.
+   */
+  public java.nio.ByteBuffer getBufferAsByteBuffer() {
+    java.lang.ref.Reference<? extends java.nio.ByteBuffer> released;
+    while ((released = bufferPinQueue.poll()) != null) {
+      bufferPins.remove(released);
+    }
+
+    java.nio.ByteBuffer buffer = getDirectByteBuffer().order(java.nio.ByteOrder.nativeOrder());
+    bufferPins.add(new BufferPin(buffer, this, bufferPinQueue));
+    return buffer;
+  }
+%}
+
 
 #endif // End of Java specific sections
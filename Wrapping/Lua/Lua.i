@@ -23,4 +23,71 @@
 %ignore itk::simple::CastImageFilter::SetOutputPixelType( PixelIDValueType pixelID );
 %ignore itk::simple::GetPixelIDValueAsString( PixelIDValueType type );
 
+
+// Bulk access to the pixel buffer of an image as a Lua string of
+// bytes, laid out as the GetBufferAs methods of the C++ Image.
+%{
+struct sitkLuaByteString
+{
+  const char *m_Data;
+  size_t      m_Length;
+};
+
+struct sitkLuaLightUserData
+{
+  void *m_Data;
+};
+%}
+%typemap(out) sitkLuaByteString
+{
+  lua_pushlstring( L, $1.m_Data, $1.m_Length );
+  SWIG_arg++;
+}
+%typemap(in,checkfn="lua_isstring") sitkLuaByteString
+{
+  size_t length = 0;
+  $1.m_Data = lua_tolstring( L, $input, &length );
+  $1.m_Length = length;
+}
+%typemap(out) sitkLuaLightUserData
+{
+  lua_pushlightuserdata( L, $1.m_Data );
+  SWIG_arg++;
+}
+
+%extend itk::simple::Image {
+  // Copies the pixels into an immutable Lua string. The image is
+  // not made unique.
+  sitkLuaByteString GetBufferAsString( void ) const
+  {
+    sitkLuaByteString buffer;
+    buffer.m_Data = static_cast<const char *>( self->GetBufferAsVoid() );
+    buffer.m_Length = static_cast<size_t>( self->GetSizeInBytes() );
+    return buffer;
+  }
+
+  // Copies a string of bytes, such as returned by GetBufferAsString,
+  // into the pixels of the image.
+  void SetBufferFromString( sitkLuaByteString buffer )
+  {
+    if ( static_cast<uint64_t>( buffer.m_Length ) != self->GetSizeInBytes() )
+      {
+      sitkExceptionMacro( "The string of " << buffer.m_Length << " bytes does not match the "
+                          << self->GetSizeInBytes() << " bytes of the image buffer." );
+      }
+    memcpy( self->GetBufferAsVoid(), buffer.m_Data, buffer.m_Length );
+  }
+
+  // The address of the pixels as light userdata, without copying,
+  // for use with the LuaJIT FFI or torch storages. The image is made
+  // unique, and the address is only valid while the image is
+  // referenced and its buffer is not reallocated.
+  sitkLuaLightUserData GetBufferPointer( void )
+  {
+    sitkLuaLightUserData pointer;
+    pointer.m_Data = self->GetBufferAsVoid();
+    return pointer;
+  }
+}
+
 #endif
@@ -330,7 +330,9 @@
             index.
 
             Multi-dimension extended slice based indexing is also
-            implemented. The return is a copy of a new image. The
+            implemented. The return is a copy of a new image, the
+            pixels of slices with unit steps are copied directly from
+            the buffer. The
             standard sliced based indices are supported including
             negative indices, to indicate location relative to the
             end, along with negative step sized to indicate reversing
@@ -410,6 +412,13 @@
               # extract each element of the indices rages together
               (start, stop, step) = zip(*sidx)
 
+              # a region with unit steps is copied line by line from
+              # the buffer, without running the filters
+              if all( s[2] == 1 and s[1] > s[0] for s in sidx ):
+                img = _SimpleITK._GetRegionOfImage( self, start, [ s[1]-s[0] for s in sidx ], slice_dim )
+                if img is not None:
+                  return img
+
               # run the slice filter
               img = Slice(self, start=start, stop=stop, step=step)
 
@@ -595,12 +604,285 @@
           raise Exception("unknown pixel type")
 
 
+        # batched transforms of NumPy arrays of points
+
+        def __TransformPointsArray__(self, points, dtype, transform):
+          if not HAVE_NUMPY:
+            raise ImportError('NumPy not available.')
+          dim = self.GetDimension()
+          points = numpy.ascontiguousarray( points, dtype=dtype )
+          if points.ndim != 2 or points.shape[1] != dim:
+            raise ValueError("The points must be an N x {0} array.".format(dim))
+          outType = numpy.int64 if transform == 0 else numpy.float64
+          result = _SimpleITK._TransformPointsFromBuffer( self, points, transform )
+          return numpy.frombuffer( result, dtype=outType ).reshape( -1, dim )
+
+        def TransformPhysicalPointsToIndicesArray(self, points):
+          """Transform an N x D NumPy array of physical points to an array of indices with one multi-threaded call."""
+          return self.__TransformPointsArray__( points, "float64", 0 )
+
+        def TransformIndicesToPhysicalPointsArray(self, indices):
+          """Transform an N x D NumPy array of indices to an array of physical points with one multi-threaded call."""
+          return self.__TransformPointsArray__( indices, "int64", 1 )
+
+        def TransformPhysicalPointsToContinuousIndicesArray(self, points):
+          """Transform an N x D NumPy array of physical points to an array of continuous indices with one multi-threaded call."""
+          return self.__TransformPointsArray__( points, "float64", 2 )
+
+        def TransformContinuousIndicesToPhysicalPointsArray(self, indices):
+          """Transform an N x D NumPy array of continuous indices to an array of physical points with one multi-threaded call."""
+          return self.__TransformPointsArray__( indices, "float64", 3 )
+
+        # array interchange protocols, sharing the image's buffer
+
+        @property
+        def __array_interface__(self):
+          """The NumPy array interface of the image's buffer, which is
+          made unique. The shape is in C order, with the components of
+          a vector image as the last dimension."""
+
+          _typestr = { sitkUInt8:'u1', sitkInt8:'i1', sitkUInt16:'u2', sitkInt16:'i2',
+                       sitkUInt32:'u4', sitkInt32:'i4', sitkUInt64:'u8', sitkInt64:'i8',
+                       sitkFloat32:'f4', sitkFloat64:'f8',
+                       sitkVectorUInt8:'u1', sitkVectorInt8:'i1', sitkVectorUInt16:'u2', sitkVectorInt16:'i2',
+                       sitkVectorUInt32:'u4', sitkVectorInt32:'i4', sitkVectorUInt64:'u8', sitkVectorInt64:'i8',
+                       sitkVectorFloat32:'f4', sitkVectorFloat64:'f8' }
+
+          pixelID = self.GetPixelIDValue()
+          if pixelID not in _typestr:
+            raise TypeError("The pixel type of the image is not supported.")
+
+          shape = self.GetSize()[::-1]
+          if self.GetNumberOfComponentsPerPixel() > 1:
+            shape = shape + ( self.GetNumberOfComponentsPerPixel(), )
+
+          address = _SimpleITK._GetBufferAddressFromImage(self)
+          typestr = ( '<' if sys.byteorder == 'little' else '>' ) + _typestr[pixelID]
+
+          return { 'shape': shape,
+                   'typestr': typestr,
+                   'data': ( address, False ),
+                   'version': 3 }
+
+        def __dlpack__(self, stream=None):
+          """Export the image's buffer, which is made unique, as a
+          DLPack capsule. The tensor has the shape of the array
+          interface, and references the image until it is released by
+          the consumer."""
+
+          if stream is not None:
+            raise BufferError("The image is in CPU memory, a stream is not supported.")
+          return _SimpleITK._GetDLPackFromImage(self)
+
+        def __dlpack_device__(self):
+          """The DLPack device of the image's buffer, which is always the CPU."""
+          return ( 1, 0 )
+
+        # pickling
+
+        def __reduce_ex__(self, protocol):
+          """Pickle the image with its pixels, geometry and meta-data.
+
+          With protocol 5 and NumPy, the pixels are a PickleBuffer
+          over the image's buffer, which is made unique, so they may
+          be transferred out-of-band without a copy. An image
+          unpickled from a writable buffer imports it without copying,
+          and shares the memory with the buffer."""
+
+          pixelID = self.GetPixelIDValue()
+          state = ( self.GetOrigin(), self.GetSpacing(), self.GetDirection(),
+                    dict( ( k, self.GetMetaData(k) ) for k in self.GetMetaDataKeys() ) )
+
+          if pixelID in ( sitkComplexFloat32, sitkComplexFloat64 ):
+            return ( _image_from_complex_pickle, ( ComplexToReal( self ), ComplexToImaginary( self ) ) + state )
+
+          _labelToScalar = { sitkLabelUInt8:sitkUInt8, sitkLabelUInt16:sitkUInt16,
+                             sitkLabelUInt32:sitkUInt32, sitkLabelUInt64:sitkUInt64 }
+          if pixelID in _labelToScalar and pixelID != sitkUnknown:
+            return ( _image_from_label_pickle, ( Cast( self, _labelToScalar[pixelID] ), pixelID ) + state )
+
+          if protocol >= 5 and HAVE_NUMPY:
+            import pickle
+            pixels = pickle.PickleBuffer( numpy.asarray( self ) )
+          else:
+            pixels = _SimpleITK._GetMemoryViewFromImage( self ).tobytes()
+
+          return ( _image_from_pickle, ( pixels, self.GetSize(), pixelID,
+                                         self.GetNumberOfComponentsPerPixel() ) + state )
+
          %}
 
 
 
 }
 
+%extend itk::simple::Transform {
+        %pythoncode %{
+
+        def TransformPointsArray(self, points):
+          """Transform an N x D NumPy array of points to an array of transformed points with one multi-threaded call."""
+          if not HAVE_NUMPY:
+            raise ImportError('NumPy not available.')
+          dim = self.GetDimension()
+          points = numpy.ascontiguousarray( points, dtype="float64" )
+          if points.ndim != 2 or points.shape[1] != dim:
+            raise ValueError("The points must be an N x {0} array.".format(dim))
+          result = _SimpleITK._TransformPointsFromBuffer( self, points, 4 )
+          return numpy.frombuffer( result, dtype=numpy.float64 ).reshape( -1, dim )
+
+        def GetParametersArrayView(self):
+          """Get a read-only NumPy view of the parameters of the transform.
+
+          The parameters are not copied. For the BSplineTransform and the
+          DisplacementFieldTransform these are the coefficients and the
+          displacements. The array references a shallow copy of the
+          transform, so the values do not change when this transform is
+          later modified.
+          """
+          if not HAVE_NUMPY:
+            raise ImportError('NumPy not available.')
+          if self.GetNumberOfParameters() == 0:
+            return numpy.zeros( 0, dtype=numpy.float64 )
+          transform = Transform( self )
+          view = numpy.frombuffer( _SimpleITK._GetMemoryViewFromTransformParameters( transform ), dtype=numpy.float64 )
+          return numpy.asarray( _TransformArrayInterface( transform, view.__array_interface__ ) )
+
+        def GetParametersArray(self, out=None):
+          """Get the parameters of the transform as a NumPy array.
+
+          If out is provided the parameters are written into it, which
+          avoids allocating an array on each call.
+          """
+          view = self.GetParametersArrayView()
+          if out is None:
+            return numpy.array( view, copy=True )
+          numpy.copyto( out, view.reshape( numpy.shape( out ) ) )
+          return out
+
+        def SetParametersFromArray(self, parameters):
+          """Set the parameters of the transform from a NumPy array, without an intermediate list."""
+          if not HAVE_NUMPY:
+            raise ImportError('NumPy not available.')
+          parameters = numpy.ascontiguousarray( parameters, dtype=numpy.float64 )
+          _SimpleITK._SetTransformParametersFromBuffer( self, parameters )
+
+         %}
+};
+
+%extend itk::simple::BSplineTransform {
+        %pythoncode %{
+
+        def GetCoefficientArrayViews(self):
+          """Get read-only NumPy views of the coefficient images, one for
+          each dimension, without copying the coefficients."""
+          shape = self.GetCoefficientImages()[0].GetSize()[::-1]
+          parameters = self.GetParametersArrayView()
+          return tuple( parameters.reshape( ( -1, ) + shape ) )
+
+         %}
+};
+
+%extend itk::simple::LabelFeaturesImageFilter {
+        %pythoncode %{
+
+        def GetFeatureArrays(self):
+          """Return the computed features of all the labels as a
+          dictionary of NumPy arrays, with one row per label in the
+          order of GetLabels. The positions are N x D arrays, the
+          bounding boxes N x 2D arrays of the index followed by the
+          size, and the second order moments N x D x D arrays. The
+          dictionary has the features computed in the last execution."""
+          if not HAVE_NUMPY:
+            raise ImportError('NumPy not available.')
+
+          dim = self.GetDimension()
+          features = [ ( "Labels", numpy.int64, () ),
+                       ( "NumberOfPixels", numpy.uint64, () ),
+                       ( "BoundingBox", numpy.uint32, ( 2 * dim, ) ),
+                       ( "Centroid", numpy.float64, ( dim, ) ),
+                       ( "SecondOrderMoments", numpy.float64, ( dim, dim ) ),
+                       ( "Sum", numpy.float64, () ),
+                       ( "Mean", numpy.float64, () ),
+                       ( "Minimum", numpy.float64, () ),
+                       ( "Maximum", numpy.float64, () ),
+                       ( "Variance", numpy.float64, () ),
+                       ( "CenterOfGravity", numpy.float64, ( dim, ) ) ]
+
+          numberOfLabels = self.GetNumberOfLabels()
+          arrays = {}
+          for name, dtype, shape in features:
+            result = _SimpleITK._GetLabelFeaturesArray( self, name )
+            if len( result ) == 0 and numberOfLabels > 0:
+              continue
+            arrays[name] = numpy.frombuffer( result, dtype=dtype ).reshape( ( numberOfLabels, ) + shape )
+          return arrays
+
+         %}
+};
+
+%extend itk::simple::HistogramImageFilter {
+        %pythoncode %{
+
+        def GetCountsArray(self):
+          """Return the counts of the histogram of the last execution
+          as a NumPy array of uint64, with one axis per image. The
+          count of the bin i of the first image and the bin j of the
+          second image of a joint histogram is at [i, j]."""
+          if not HAVE_NUMPY:
+            raise ImportError('NumPy not available.')
+
+          shape = ( self.GetNumberOfBins(), ) * self.GetNumberOfHistogramDimensions()
+          result = _SimpleITK._GetHistogramCountsArray( self )
+          return numpy.frombuffer( result, dtype=numpy.uint64 ).reshape( shape )
+
+         %}
+};
+
+%extend itk::simple::ImageAccumulator {
+        %pythoncode %{
+
+        def AddImages(self, images):
+          """Fold each image of an iterable, such as a generator, into
+          the accumulated state. The strings are file names, which are
+          read one at a time so only one image is loaded at once."""
+          for image in images:
+            if isinstance( image, str ):
+              image = ReadImage( image )
+            self.AddImage( image )
+          return self
+
+         %}
+};
+
+%extend itk::simple::ProjectionAccumulator {
+        %pythoncode %{
+
+        def AddFile(self, fileName, numberOfSlicesPerSlab=16):
+          """Read a file in slabs of numberOfSlicesPerSlab slices along
+          the ProjectionDimension and fold each into the running
+          projection, so only one slab is loaded at once. Formats
+          which support streaming, such as uncompressed MetaImage,
+          NRRD and NIfTI, read only the slab from the disk."""
+          reader = ImageFileReader()
+          reader.SetFileName( fileName )
+          reader.ReadImageInformation()
+          size = list( reader.GetSize() )
+          p = self.GetProjectionDimension()
+          if p >= len( size ):
+            raise ValueError( "The ProjectionDimension is not an axis of the image in the file." )
+          index = [0] * len( size )
+          for start in range( 0, size[p], numberOfSlicesPerSlab ):
+            slabSize = list( size )
+            slabSize[p] = min( numberOfSlicesPerSlab, size[p] - start )
+            index[p] = start
+            reader.SetExtractIndex( index )
+            reader.SetExtractSize( slabSize )
+            self.AddSlab( reader.Execute() )
+          return self
+
+         %}
+};
+
 // This is included inline because SwigMethods (SimpleITKPYTHON_wrap.cxx)
 // is declared static.
 %{
@@ -609,6 +891,16 @@
 // Numpy array conversion support
 %native(_GetMemoryViewFromImage) PyObject *sitk_GetMemoryViewFromImage( PyObject *self, PyObject *args );
 %native(_SetImageFromArray) PyObject *sitk_SetImageFromArray( PyObject *self, PyObject *args );
+%native(_GetImageViewFromArray) PyObject *sitk_GetImageViewFromArray( PyObject *self, PyObject *args );
+%native(_GetRegionOfImage) PyObject *sitk_GetRegionOfImage( PyObject *self, PyObject *args );
+%native(_GetBufferAddressFromImage) PyObject *sitk_GetBufferAddressFromImage( PyObject *self, PyObject *args );
+%native(_GetDLPackFromImage) PyObject *sitk_GetDLPackFromImage( PyObject *self, PyObject *args );
+%native(_GetImageFromDLPack) PyObject *sitk_GetImageFromDLPack( PyObject *self, PyObject *args );
+%native(_TransformPointsFromBuffer) PyObject *sitk_TransformPointsFromBuffer( PyObject *self, PyObject *args );
+%native(_GetMemoryViewFromTransformParameters) PyObject *sitk_GetMemoryViewFromTransformParameters( PyObject *self, PyObject *args );
+%native(_SetTransformParametersFromBuffer) PyObject *sitk_SetTransformParametersFromBuffer( PyObject *self, PyObject *args );
+%native(_GetLabelFeaturesArray) PyObject *sitk_GetLabelFeaturesArray( PyObject *self, PyObject *args );
+%native(_GetHistogramCountsArray) PyObject *sitk_GetHistogramCountsArray( PyObject *self, PyObject *args );
 
 %pythoncode %{
 
@@ -719,12 +1011,61 @@ def _get_sitk_vector_pixelid(numpy_array_type):
 
 # SimplyITK <-> Numpy Array conversion support.
 
-def GetArrayViewFromImage(image):
-    """Get a NumPy ndarray view of a SimpleITK Image.
+class _ImageArrayInterface(object):
+    """Exposes the buffer of an image to NumPy, and is the base object
+    of the array which keeps the image alive."""
+
+    def __init__(self, image, arrayInterface):
+        self.image = image
+        self.__array_interface__ = arrayInterface
+
+
+class _TransformArrayInterface(object):
+    """Exposes the parameters of a transform to NumPy, and is the base
+    object of the array which keeps the transform alive."""
+
+    def __init__(self, transform, arrayInterface):
+        self.transform = transform
+        self.__array_interface__ = arrayInterface
 
-    Returns a Numpy ndarray object as a "view" of the SimpleITK's Image buffer. This reduces pixel buffer copies, but requires that the SimpleITK image object is kept around while the buffer is being used.
 
+def _set_image_pickle_state( image, origin, spacing, direction, metadata ):
+    image.SetOrigin( origin )
+    image.SetSpacing( spacing )
+    image.SetDirection( direction )
+    for key, value in metadata.items():
+      image.SetMetaData( key, value )
+    return image
 
+def _image_from_pickle( pixels, size, pixelID, numberOfComponents, *state ):
+    """Reconstruct a pickled Image. A writable buffer of pixels, such
+    as an out-of-band buffer of protocol 5, is imported without
+    copying, otherwise the pixels are copied."""
+
+    image = None
+    if not memoryview( pixels ).readonly:
+      image = _SimpleITK._GetImageViewFromArray( pixels, size, pixelID, numberOfComponents )
+      # a vector image with one component is imported as a scalar image
+      if image.GetPixelIDValue() != pixelID:
+        image = None
+    if image is None:
+      image = Image( size, pixelID, numberOfComponents )
+      _SimpleITK._SetImageFromArray( pixels, image )
+    return _set_image_pickle_state( image, *state )
+
+def _image_from_complex_pickle( real, imaginary, *state ):
+    return _set_image_pickle_state( RealAndImaginaryToComplex( real, imaginary ), *state )
+
+def _image_from_label_pickle( image, pixelID, *state ):
+    return _set_image_pickle_state( Cast( image, pixelID ), *state )
+
+
+def GetArrayViewFromImage(image, writable=False):
+    """Get a NumPy ndarray view of a SimpleITK Image.
+
+    Returns a Numpy ndarray object as a "view" of the SimpleITK's Image buffer. This reduces pixel buffer copies. The array holds a reference to the image, so the buffer remains valid while the array is being used.
+
+    By default the view is read-only. If writable is True, the image buffer is made unique once, when the view is created, and modifying the array modifies the pixels of the image. The view no longer refers to the image's buffer if the buffer is later replaced, such as by modifying a copy of the image which shares its buffer.
     """
 
     if not HAVE_NUMPY:
@@ -742,11 +1083,12 @@ def GetArrayViewFromImage(image):
 
     image.MakeUnique()
 
-    imageMemoryView =  _SimpleITK._GetMemoryViewFromImage(image)
+    imageMemoryView =  _SimpleITK._GetMemoryViewFromImage(image, writable)
     arrayView = numpy.asarray(imageMemoryView).view(dtype = dtype)
     arrayView.shape = shape[::-1]
 
-    return arrayView
+    # the array is based on an object which references the image
+    return numpy.asarray(_ImageArrayInterface(image, arrayView.__array_interface__))
 
 def GetArrayFromImage(image):
     """Get a NumPy ndarray from a SimpleITK Image.
@@ -761,8 +1103,10 @@ def GetArrayFromImage(image):
     return numpy.array(arrayView, copy=True)
 
 
-def GetImageFromArray( arr, isVector=False):
-    """Get a SimpleITK Image from a numpy array. If isVector is True, then a 3D array will be treated as a 2D vector image, otherwise it will be treated as a 3D image"""
+def GetImageFromArray( arr, isVector=False, copy=True):
+    """Get a SimpleITK Image from a numpy array. If isVector is True, then a 3D array will be treated as a 2D vector image, otherwise it will be treated as a 3D image
+
+    If copy is False, the image imports the buffer of the array without copying it when the array is writable, C contiguous and aligned, otherwise the pixels are copied. The image then holds the array's buffer until the image and all images sharing its buffer are destroyed, and modifying the pixels of either modifies both."""
 
     if not HAVE_NUMPY:
         raise ImportError('Numpy not available.')
@@ -774,14 +1118,99 @@ def GetImageFromArray( arr, isVector=False):
 
     if ( z.ndim == 3 and isVector ) or (z.ndim == 4):
       id = _get_sitk_vector_pixelid( z )
+      if not copy and z.shape[-1] > 1 and z.flags.c_contiguous and z.flags.writeable and z.flags.aligned:
+        return _SimpleITK._GetImageViewFromArray( z, z.shape[-2::-1], id, z.shape[-1] )
       img = Image( z.shape[-2::-1] , id, z.shape[-1] )
     elif z.ndim in ( 2, 3 ):
       id = _get_sitk_pixelid( z )
+      if not copy and id not in ( sitkComplexFloat32, sitkComplexFloat64 ) and z.flags.c_contiguous and z.flags.writeable and z.flags.aligned:
+        return _SimpleITK._GetImageViewFromArray( z, z.shape[::-1], id, 1 )
       img = Image( z.shape[::-1], id )
 
     _SimpleITK._SetImageFromArray( z.tostring(), img )
 
     return img
+
+
+def GetImageFromDLPack( obj, isVector=False ):
+    """Get a SimpleITK Image from an object supporting the DLPack protocol, or a DLPack capsule.
+
+    The image imports the tensor without copying, and shares the memory with the producer. Only C contiguous tensors in CPU memory are supported. If isVector is True, then a 3D tensor will be treated as a 2D vector image, otherwise it will be treated as a 3D image."""
+
+    if hasattr( obj, '__dlpack__' ):
+      obj = obj.__dlpack__()
+    return _SimpleITK._GetImageFromDLPack( obj, isVector )
+
+from_dlpack = GetImageFromDLPack
+
+
+def SliceBySlice( image, function, numberOfThreads=None ):
+    """Apply a function to each slice of an image along its last axis, such as a 2D filter to each slice of a 3D image or a 3D filter to each frame of a 4D image.
+
+    The function is called with each slice as an Image of one less dimension, and must return an Image of the same size. Each slice is copied once from the buffer of the image, and the results are written directly into one preallocated output with the meta-data of the input, without extracting and joining images.
+
+    The slices are processed by numberOfThreads concurrent threads, by default the global default number of threads. A filter object, such as MedianImageFilter(), keeps the state of its execution so its Execute method is called for one slice at a time. Callables creating their own filter, such as procedural functions, are called concurrently, which is only parallel when the Python wrapping releases the GIL during the execution."""
+
+    if not HAVE_NUMPY:
+        raise ImportError('NumPy not available.')
+
+    if image.GetDimension() < 3:
+        raise ValueError( "The image must have at least 3 dimensions." )
+
+    if hasattr( function, 'Execute' ):
+        function = function.Execute
+        numberOfThreads = 1
+    elif numberOfThreads is None:
+        numberOfThreads = ProcessObject.GetGlobalDefaultNumberOfThreads()
+
+    dimension = image.GetDimension()
+    isVector = image.GetNumberOfComponentsPerPixel() > 1
+    numberOfSlices = image.GetSize()[-1]
+
+    # the direction of the slices is the sub-matrix of the first axes,
+    # or the identity when it is singular
+    direction = numpy.array( image.GetDirection() ).reshape( dimension, dimension )[:-1, :-1]
+    if abs( numpy.linalg.det( direction ) ) < 1e-6:
+        direction = numpy.identity( dimension - 1 )
+    direction = tuple( direction.flatten() )
+
+    inputArray = GetArrayViewFromImage( image )
+
+    def _slice( index ):
+        sliceImage = GetImageFromArray( inputArray[index], isVector=isVector )
+        sliceImage.SetSpacing( image.GetSpacing()[:-1] )
+        sliceImage.SetOrigin( image.TransformIndexToPhysicalPoint( ( 0, ) * ( dimension - 1 ) + ( index, ) )[:-1] )
+        sliceImage.SetDirection( direction )
+        return sliceImage
+
+    def _apply( index ):
+        result = function( _slice( index ) )
+        if result.GetSize() != image.GetSize()[:-1]:
+            raise ValueError( "The function must return an image of the size of the slice." )
+        outputArray[index] = GetArrayViewFromImage( result )
+
+    # the first slice sets the pixel type of the output
+    first = function( _slice( 0 ) )
+    if first.GetSize() != image.GetSize()[:-1]:
+        raise ValueError( "The function must return an image of the size of the slice." )
+    output = Image( image.GetSize(), first.GetPixelID(), first.GetNumberOfComponentsPerPixel() )
+    output.CopyInformation( image )
+    outputArray = GetArrayViewFromImage( output, writable=True )
+    outputArray[0] = GetArrayViewFromImage( first )
+
+    if numberOfThreads > 1 and numberOfSlices > 2:
+        from multiprocessing.pool import ThreadPool
+        pool = ThreadPool( min( numberOfThreads, numberOfSlices - 1 ) )
+        try:
+            pool.map( _apply, range( 1, numberOfSlices ) )
+        finally:
+            pool.close()
+            pool.join()
+    else:
+        for index in range( 1, numberOfSlices ):
+            _apply( index )
+
+    return output
 %}
 
 
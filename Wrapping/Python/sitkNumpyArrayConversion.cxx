@@ -21,11 +21,21 @@
 #include <functional>
 
 #include "sitkImage.h"
+#include "sitkImportImageFilter.h"
 #include "sitkConditional.h"
 #include "sitkExceptionObject.h"
+#include "sitkLabelFeaturesImageFilter.h"
 
 namespace sitk = itk::simple;
 
+template< typename T >
+static PyObject *
+VectorToPyByteArray( const std::vector< T > &values )
+{
+  return PyByteArray_FromStringAndSize( values.empty() ? NULL : reinterpret_cast< const char * >( &values[0] ),
+                                        static_cast< Py_ssize_t >( values.size() * sizeof( T ) ) );
+}
+
 // Python is written in C
 #ifdef __cplusplus
 extern "C"
@@ -34,7 +44,8 @@ extern "C"
 
 /** An internal function that returns a memoryview object to the
  * SimpleITK Image's buffer (shallow). The correct copy and writing
- * policies need to be done by the end-user method.
+ * policies need to be done by the end-user method. When the optional
+ * second argument is true the memoryview is writable.
  */
 static PyObject *
 sitk_GetMemoryViewFromImage( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
@@ -56,8 +67,10 @@ sitk_GetMemoryViewFromImage( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
   Py_buffer                   pyBuffer;
   memset(&pyBuffer, 0, sizeof(Py_buffer));
 
+  int                         writable      = 0;
 
-  if( !PyArg_ParseTuple( args, "O", &pyImage ) )
+
+  if( !PyArg_ParseTuple( args, "O|i", &pyImage, &writable ) )
     {
     SWIG_fail; // SWIG_fail is a macro that says goto: fail (return NULL)
     }
@@ -146,7 +159,7 @@ sitk_GetMemoryViewFromImage( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
   len = std::accumulate( size.begin(), size.end(), size_t(1), std::multiplies<size_t>() );
   len *= pixelSize;
 
-  if (PyBuffer_FillInfo(&pyBuffer, NULL, (void*)sitkBufferPtr, len, true, PyBUF_CONTIG_RO)!=0)
+  if (PyBuffer_FillInfo(&pyBuffer, NULL, (void*)sitkBufferPtr, len, !writable, writable ? PyBUF_CONTIG : PyBUF_CONTIG_RO)!=0)
     {
     SWIG_fail;
     }
@@ -323,7 +336,10 @@ sitk_SetImageFromArray( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
     goto fail;
     }
 
+  // the GIL is not needed while copying the pixels
+  SWIG_PYTHON_THREAD_BEGIN_ALLOW;
   memcpy( (void *)sitkBufferPtr, buffer, len );
+  SWIG_PYTHON_THREAD_END_ALLOW;
 
 
   PyBuffer_Release( &pyBuffer );
@@ -334,6 +350,1063 @@ fail:
   return NULL;
 }
 
+/** Release the buffer of a NumPy array when the last image
+ * importing it is destroyed.
+ */
+static void
+sitk_ReleaseArrayBuffer( void *SWIGUNUSEDPARM(buffer), void *clientData )
+{
+  PyGILState_STATE gstate = PyGILState_Ensure();
+  Py_buffer *pyBuffer = reinterpret_cast< Py_buffer * >( clientData );
+  PyBuffer_Release( pyBuffer );
+  delete pyBuffer;
+  PyGILState_Release( gstate );
+}
+
+/** Create a SimpleITK Image which imports a buffer (shallow), with
+ * the pixel ID and number of components per pixel. The buffer length
+ * in bytes must match the size of the image. The deleter is called
+ * with the clientData when the last image referring to the buffer is
+ * destroyed, or on failure when NULL is returned with a Python error
+ * set.
+ */
+static PyObject *
+sitk_ImportBufferAsImage( void *buffer, size_t bufferLength,
+                          const std::vector< unsigned int > &size,
+                          int pixelID, unsigned int numberOfComponents,
+                          sitk::ImportImageFilter::BufferDeleterFunctionType deleter,
+                          void *clientData )
+{
+  sitk::ImportImageFilter importer;
+  size_t pixelSize = 1;
+  size_t len = 1;
+
+  switch( pixelID )
+    {
+    case sitk::ConditionalValue< sitk::sitkVectorUInt8 != sitk::sitkUnknown, sitk::sitkVectorUInt8, -14 >::Value:
+    case sitk::ConditionalValue< sitk::sitkUInt8 != sitk::sitkUnknown, sitk::sitkUInt8, -2 >::Value:
+      importer.SetBufferAsUInt8( reinterpret_cast< uint8_t * >( buffer ), numberOfComponents );
+      pixelSize  = sizeof( uint8_t );
+      break;
+    case sitk::ConditionalValue< sitk::sitkVectorInt8 != sitk::sitkUnknown, sitk::sitkVectorInt8, -15 >::Value:
+    case sitk::ConditionalValue< sitk::sitkInt8 != sitk::sitkUnknown, sitk::sitkInt8, -3 >::Value:
+      importer.SetBufferAsInt8( reinterpret_cast< int8_t * >( buffer ), numberOfComponents );
+      pixelSize  = sizeof( int8_t );
+      break;
+    case sitk::ConditionalValue< sitk::sitkVectorUInt16 != sitk::sitkUnknown, sitk::sitkVectorUInt16, -16 >::Value:
+    case sitk::ConditionalValue< sitk::sitkUInt16 != sitk::sitkUnknown, sitk::sitkUInt16, -4 >::Value:
+      importer.SetBufferAsUInt16( reinterpret_cast< uint16_t * >( buffer ), numberOfComponents );
+      pixelSize  = sizeof( uint16_t );
+      break;
+    case sitk::ConditionalValue< sitk::sitkVectorInt16 != sitk::sitkUnknown, sitk::sitkVectorInt16, -17 >::Value:
+    case sitk::ConditionalValue< sitk::sitkInt16 != sitk::sitkUnknown, sitk::sitkInt16, -5 >::Value:
+      importer.SetBufferAsInt16( reinterpret_cast< int16_t * >( buffer ), numberOfComponents );
+      pixelSize  = sizeof( int16_t );
+      break;
+    case sitk::ConditionalValue< sitk::sitkVectorUInt32 != sitk::sitkUnknown, sitk::sitkVectorUInt32, -18 >::Value:
+    case sitk::ConditionalValue< sitk::sitkUInt32 != sitk::sitkUnknown, sitk::sitkUInt32, -6 >::Value:
+      importer.SetBufferAsUInt32( reinterpret_cast< uint32_t * >( buffer ), numberOfComponents );
+      pixelSize  = sizeof( uint32_t );
+      break;
+    case sitk::ConditionalValue< sitk::sitkVectorInt32 != sitk::sitkUnknown, sitk::sitkVectorInt32, -19 >::Value:
+    case sitk::ConditionalValue< sitk::sitkInt32 != sitk::sitkUnknown, sitk::sitkInt32, -7 >::Value:
+      importer.SetBufferAsInt32( reinterpret_cast< int32_t * >( buffer ), numberOfComponents );
+      pixelSize  = sizeof( int32_t );
+      break;
+    case sitk::ConditionalValue< sitk::sitkVectorUInt64 != sitk::sitkUnknown, sitk::sitkVectorUInt64, -20 >::Value:
+    case sitk::ConditionalValue< sitk::sitkUInt64 != sitk::sitkUnknown, sitk::sitkUInt64, -8 >::Value:
+      importer.SetBufferAsUInt64( reinterpret_cast< uint64_t * >( buffer ), numberOfComponents );
+      pixelSize  = sizeof( uint64_t );
+      break;
+    case sitk::ConditionalValue< sitk::sitkVectorInt64 != sitk::sitkUnknown, sitk::sitkVectorInt64, -21 >::Value:
+    case sitk::ConditionalValue< sitk::sitkInt64 != sitk::sitkUnknown, sitk::sitkInt64, -9 >::Value:
+      importer.SetBufferAsInt64( reinterpret_cast< int64_t * >( buffer ), numberOfComponents );
+      pixelSize  = sizeof( int64_t );
+      break;
+    case sitk::ConditionalValue< sitk::sitkVectorFloat32 != sitk::sitkUnknown, sitk::sitkVectorFloat32, -22 >::Value:
+    case sitk::ConditionalValue< sitk::sitkFloat32 != sitk::sitkUnknown, sitk::sitkFloat32, -10 >::Value:
+      importer.SetBufferAsFloat( reinterpret_cast< float * >( buffer ), numberOfComponents );
+      pixelSize  = sizeof( float );
+      break;
+    case sitk::ConditionalValue< sitk::sitkVectorFloat64 != sitk::sitkUnknown, sitk::sitkVectorFloat64, -23 >::Value:
+    case sitk::ConditionalValue< sitk::sitkFloat64 != sitk::sitkUnknown, sitk::sitkFloat64, -11 >::Value:
+      importer.SetBufferAsDouble( reinterpret_cast< double * >( buffer ), numberOfComponents );
+      pixelSize  = sizeof( double );
+      break;
+    default:
+      PyErr_SetString( PyExc_RuntimeError, "The pixel type can not be imported without copying." );
+      goto fail;
+    }
+
+  len = std::accumulate( size.begin(), size.end(), size_t(1), std::multiplies<size_t>() );
+  len *= pixelSize * numberOfComponents;
+
+  if ( bufferLength != len )
+    {
+    PyErr_SetString( PyExc_RuntimeError, "Size mismatch of image and Buffer." );
+    goto fail;
+    }
+  if ( reinterpret_cast< size_t >( buffer ) % pixelSize != 0 )
+    {
+    PyErr_SetString( PyExc_RuntimeError, "The buffer is not aligned to the pixel type." );
+    goto fail;
+    }
+
+  try
+    {
+    std::vector< double > direction( size.size() * size.size(), 0.0 );
+    for ( size_t i = 0; i < size.size(); ++i )
+      {
+      direction[i * size.size() + i] = 1.0;
+      }
+    importer.SetSize( size );
+    importer.SetOrigin( std::vector< double >( size.size(), 0.0 ) );
+    importer.SetSpacing( std::vector< double >( size.size(), 1.0 ) );
+    importer.SetDirection( direction );
+    importer.SetBufferDeleter( deleter, clientData );
+
+    sitk::Image image = importer.Execute();
+    return SWIG_NewPointerObj( new sitk::Image( image ), SWIGTYPE_p_itk__simple__Image, SWIG_POINTER_OWN );
+    }
+  catch( const std::exception &e )
+    {
+    std::string msg = "Exception thrown in SimpleITK new Image: ";
+    msg += e.what();
+    PyErr_SetString( PyExc_RuntimeError, msg.c_str() );
+    }
+
+  // the buffer is released by the image once ownership is transferred
+  if ( importer.GetBufferDeleter() == NULL )
+    {
+    return NULL;
+    }
+
+fail:
+  deleter( buffer, clientData );
+  return NULL;
+}
+
+/** An internal function that creates a SimpleITK Image which imports
+ * the buffer of a writable C contiguous array (shallow). The array's
+ * buffer is held until the last image referring to it is destroyed.
+ *
+ * The arguments are the array, the size of the image, the pixel ID
+ * and the number of components per pixel.
+ */
+static PyObject *
+sitk_GetImageViewFromArray( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
+{
+  PyObject *                  pyArray       = NULL;
+  PyObject *                  pySize        = NULL;
+  int                         pixelID       = sitk::sitkUnknown;
+  unsigned int                numberOfComponents = 1;
+
+  Py_buffer *                 pyBuffer      = NULL;
+  std::vector< unsigned int > size;
+  PyObject *                  pyImage       = NULL;
+
+  if( !PyArg_ParseTuple( args, "OOiI", &pyArray, &pySize, &pixelID, &numberOfComponents ) )
+    {
+    return NULL;
+    }
+
+  if ( !PySequence_Check( pySize ) )
+    {
+    PyErr_SetString( PyExc_TypeError, "The size must be a sequence." );
+    return NULL;
+    }
+  for ( Py_ssize_t i = 0; i < PySequence_Size( pySize ); ++i )
+    {
+    PyObject *item = PySequence_GetItem( pySize, i );
+    Py_ssize_t value = ( item != NULL ) ? PyNumber_AsSsize_t( item, NULL ) : -1;
+    Py_XDECREF( item );
+    if ( value < 0 )
+      {
+      if ( !PyErr_Occurred() )
+        {
+        PyErr_SetString( PyExc_ValueError, "The size must not be negative." );
+        }
+      return NULL;
+      }
+    size.push_back( static_cast< unsigned int >( value ) );
+    }
+
+  pyBuffer = new Py_buffer;
+  memset(pyBuffer, 0, sizeof(Py_buffer));
+  if ( PyObject_GetBuffer( pyArray, pyBuffer, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE ) != 0 )
+    {
+    delete pyBuffer;
+    return NULL;
+    }
+
+  // a failed import releases the buffer
+  pyImage = sitk_ImportBufferAsImage( pyBuffer->buf, static_cast< size_t >( pyBuffer->len ), size,
+                                      pixelID, numberOfComponents, sitk_ReleaseArrayBuffer, pyBuffer );
+  return pyImage;
+}
+
+
+/** Convert a Python sequence of non-negative integers, returns false
+ * with a Python error set on failure. */
+static bool
+sitk_SequenceToUInt32Vector( PyObject *pySequence, std::vector< uint32_t > &values )
+{
+  if ( !PySequence_Check( pySequence ) )
+    {
+    PyErr_SetString( PyExc_TypeError, "Expected a sequence of integers." );
+    return false;
+    }
+  values.clear();
+  for ( Py_ssize_t i = 0; i < PySequence_Size( pySequence ); ++i )
+    {
+    PyObject *item = PySequence_GetItem( pySequence, i );
+    Py_ssize_t value = ( item != NULL ) ? PyNumber_AsSsize_t( item, NULL ) : -1;
+    Py_XDECREF( item );
+    if ( value < 0 )
+      {
+      if ( !PyErr_Occurred() )
+        {
+        PyErr_SetString( PyExc_ValueError, "Expected non-negative integers." );
+        }
+      return false;
+      }
+    values.push_back( static_cast< uint32_t >( value ) );
+    }
+  return true;
+}
+
+/** An internal function that copies a region of an image to a new
+ * image, by copying the lines of the region from the buffer, with the
+ * geometry of the SliceImageFilter with unit steps.
+ *
+ * The arguments are the image, the index and the size of the
+ * region, and a dimension to collapse, or -1. The collapsed
+ * dimension must have a size of 1, it is removed as by the
+ * ExtractImageFilter with the DIRECTIONCOLLAPSETOGUESS strategy.
+ * None is returned for the pixel types without a buffer of scalar
+ * components, which are copied by the filters.
+ */
+static PyObject *
+sitk_GetRegionOfImage( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
+{
+  PyObject *                  pyImage       = NULL;
+  PyObject *                  pyIndex       = NULL;
+  PyObject *                  pySize        = NULL;
+  int                         collapse      = -1;
+  void *                      voidImage     = NULL;
+  std::vector< uint32_t >     index;
+  std::vector< uint32_t >     size;
+
+  if( !PyArg_ParseTuple( args, "OOO|i", &pyImage, &pyIndex, &pySize, &collapse ) )
+    {
+    return NULL;
+    }
+  int res = SWIG_ConvertPtr( pyImage, &voidImage, SWIGTYPE_p_itk__simple__Image, 0 );
+  if( !SWIG_IsOK( res ) )
+    {
+    PyErr_SetString( PyExc_TypeError, "The argument needs to be of type 'sitk::Image *'" );
+    return NULL;
+    }
+  const sitk::Image &image = *reinterpret_cast< sitk::Image * >( voidImage );
+
+  if ( !sitk_SequenceToUInt32Vector( pyIndex, index ) || !sitk_SequenceToUInt32Vector( pySize, size ) )
+    {
+    return NULL;
+    }
+  const unsigned int dimension = image.GetDimension();
+  if ( index.size() != dimension || size.size() != dimension
+       || collapse >= static_cast< int >( dimension ) || ( collapse >= 0 && size[collapse] != 1 ) )
+    {
+    PyErr_SetString( PyExc_ValueError, "Invalid region of the image." );
+    return NULL;
+    }
+
+  const int pixelID = image.GetPixelIDValue();
+  const unsigned int numberOfComponents = image.GetNumberOfComponentsPerPixel();
+
+  // the dimensions of the output, without the collapsed dimension
+  std::vector< unsigned int > outputSize;
+  for ( unsigned int d = 0; d < dimension; ++d )
+    {
+    if ( static_cast< int >( d ) != collapse )
+      {
+      outputSize.push_back( size[d] );
+      }
+    }
+
+  if ( pixelID == sitk::sitkUnknown
+       || pixelID == sitk::sitkComplexFloat32 || pixelID == sitk::sitkComplexFloat64
+       || pixelID == sitk::sitkLabelUInt8 || pixelID == sitk::sitkLabelUInt16
+       || pixelID == sitk::sitkLabelUInt32 || pixelID == sitk::sitkLabelUInt64 )
+    {
+    Py_RETURN_NONE;
+    }
+
+  try
+    {
+    sitk::Image output( outputSize, static_cast< sitk::PixelIDValueEnum >( pixelID ), numberOfComponents,
+                        sitk::Image::NoBufferInitialization );
+
+    if ( pixelID == sitk::sitkUInt8 || pixelID == sitk::sitkVectorUInt8 )
+      {
+      image.GetRegionAsUInt8( index, size, output.GetBufferAsUInt8() );
+      }
+    else if ( pixelID == sitk::sitkInt8 || pixelID == sitk::sitkVectorInt8 )
+      {
+      image.GetRegionAsInt8( index, size, output.GetBufferAsInt8() );
+      }
+    else if ( pixelID == sitk::sitkUInt16 || pixelID == sitk::sitkVectorUInt16 )
+      {
+      image.GetRegionAsUInt16( index, size, output.GetBufferAsUInt16() );
+      }
+    else if ( pixelID == sitk::sitkInt16 || pixelID == sitk::sitkVectorInt16 )
+      {
+      image.GetRegionAsInt16( index, size, output.GetBufferAsInt16() );
+      }
+    else if ( pixelID == sitk::sitkUInt32 || pixelID == sitk::sitkVectorUInt32 )
+      {
+      image.GetRegionAsUInt32( index, size, output.GetBufferAsUInt32() );
+      }
+    else if ( pixelID == sitk::sitkInt32 || pixelID == sitk::sitkVectorInt32 )
+      {
+      image.GetRegionAsInt32( index, size, output.GetBufferAsInt32() );
+      }
+    else if ( pixelID == sitk::sitkUInt64 || pixelID == sitk::sitkVectorUInt64 )
+      {
+      image.GetRegionAsUInt64( index, size, output.GetBufferAsUInt64() );
+      }
+    else if ( pixelID == sitk::sitkInt64 || pixelID == sitk::sitkVectorInt64 )
+      {
+      image.GetRegionAsInt64( index, size, output.GetBufferAsInt64() );
+      }
+    else if ( pixelID == sitk::sitkFloat32 || pixelID == sitk::sitkVectorFloat32 )
+      {
+      image.GetRegionAsFloat( index, size, output.GetBufferAsFloat() );
+      }
+    else if ( pixelID == sitk::sitkFloat64 || pixelID == sitk::sitkVectorFloat64 )
+      {
+      image.GetRegionAsDouble( index, size, output.GetBufferAsDouble() );
+      }
+    else
+      {
+      PyErr_SetString( PyExc_RuntimeError, "Unknown pixel type." );
+      return NULL;
+      }
+
+    // the origin is the physical point of the index of the region
+    const std::vector< double > origin =
+      image.TransformIndexToPhysicalPoint( std::vector< int64_t >( index.begin(), index.end() ) );
+    const std::vector< double > spacing = image.GetSpacing();
+    const std::vector< double > direction = image.GetDirection();
+    std::vector< double > outputOrigin;
+    std::vector< double > outputSpacing;
+    std::vector< double > outputDirection;
+    for ( unsigned int i = 0; i < dimension; ++i )
+      {
+      if ( static_cast< int >( i ) == collapse )
+        {
+        continue;
+        }
+      outputOrigin.push_back( origin[i] );
+      outputSpacing.push_back( spacing[i] );
+      for ( unsigned int j = 0; j < dimension; ++j )
+        {
+        if ( static_cast< int >( j ) != collapse )
+          {
+          outputDirection.push_back( direction[i * dimension + j] );
+          }
+        }
+      }
+
+    // a singular sub-matrix of a 3D direction is replaced with the
+    // identity, as by the DIRECTIONCOLLAPSETOGUESS strategy
+    if ( collapse >= 0 && outputSize.size() == 2
+         && outputDirection[0] * outputDirection[3] - outputDirection[1] * outputDirection[2] == 0.0 )
+      {
+      outputDirection[0] = outputDirection[3] = 1.0;
+      outputDirection[1] = outputDirection[2] = 0.0;
+      }
+
+    output.SetOrigin( outputOrigin );
+    output.SetSpacing( outputSpacing );
+    output.SetDirection( outputDirection );
+    return SWIG_NewPointerObj( new sitk::Image( output ), SWIGTYPE_p_itk__simple__Image, SWIG_POINTER_OWN );
+    }
+  catch( const std::exception &e )
+    {
+    std::string msg = "Exception thrown in SimpleITK region of Image: ";
+    msg += e.what();
+    PyErr_SetString( PyExc_RuntimeError, msg.c_str() );
+    }
+  return NULL;
+}
+
+
+// The DLPack data structures, as defined by the stable ABI of
+// dlpack.h, for the exchange of tensors with other libraries.
+typedef struct
+{
+  int32_t device_type;
+  int32_t device_id;
+} sitk_DLDevice;
+
+typedef struct
+{
+  uint8_t  code;
+  uint8_t  bits;
+  uint16_t lanes;
+} sitk_DLDataType;
+
+typedef struct
+{
+  void *          data;
+  sitk_DLDevice   device;
+  int32_t         ndim;
+  sitk_DLDataType dtype;
+  int64_t *       shape;
+  int64_t *       strides;
+  uint64_t        byte_offset;
+} sitk_DLTensor;
+
+typedef struct sitk_DLManagedTensor
+{
+  sitk_DLTensor dl_tensor;
+  void *        manager_ctx;
+  void (*deleter)( struct sitk_DLManagedTensor *self );
+} sitk_DLManagedTensor;
+
+enum { sitk_kDLCPU = 1 };
+enum { sitk_kDLInt = 0, sitk_kDLUInt = 1, sitk_kDLFloat = 2 };
+
+
+/** Get the buffer of an image, made unique so that it can be
+ * written, and the size of a pixel component. NULL is returned with
+ * a Python error set if the pixel type is not supported.
+ */
+static void *
+sitk_GetUniqueBufferFromImage( sitk::Image *sitkImage, size_t &pixelSize, sitk_DLDataType &dtype )
+{
+  dtype.lanes = 1;
+  switch( sitkImage->GetPixelIDValue() )
+    {
+    case sitk::ConditionalValue< sitk::sitkVectorUInt8 != sitk::sitkUnknown, sitk::sitkVectorUInt8, -14 >::Value:
+    case sitk::ConditionalValue< sitk::sitkUInt8 != sitk::sitkUnknown, sitk::sitkUInt8, -2 >::Value:
+      pixelSize = sizeof( uint8_t );
+      dtype.code = sitk_kDLUInt;
+      dtype.bits = 8;
+      return sitkImage->GetBufferAsUInt8();
+    case sitk::ConditionalValue< sitk::sitkVectorInt8 != sitk::sitkUnknown, sitk::sitkVectorInt8, -15 >::Value:
+    case sitk::ConditionalValue< sitk::sitkInt8 != sitk::sitkUnknown, sitk::sitkInt8, -3 >::Value:
+      pixelSize = sizeof( int8_t );
+      dtype.code = sitk_kDLInt;
+      dtype.bits = 8;
+      return sitkImage->GetBufferAsInt8();
+    case sitk::ConditionalValue< sitk::sitkVectorUInt16 != sitk::sitkUnknown, sitk::sitkVectorUInt16, -16 >::Value:
+    case sitk::ConditionalValue< sitk::sitkUInt16 != sitk::sitkUnknown, sitk::sitkUInt16, -4 >::Value:
+      pixelSize = sizeof( uint16_t );
+      dtype.code = sitk_kDLUInt;
+      dtype.bits = 16;
+      return sitkImage->GetBufferAsUInt16();
+    case sitk::ConditionalValue< sitk::sitkVectorInt16 != sitk::sitkUnknown, sitk::sitkVectorInt16, -17 >::Value:
+    case sitk::ConditionalValue< sitk::sitkInt16 != sitk::sitkUnknown, sitk::sitkInt16, -5 >::Value:
+      pixelSize = sizeof( int16_t );
+      dtype.code = sitk_kDLInt;
+      dtype.bits = 16;
+      return sitkImage->GetBufferAsInt16();
+    case sitk::ConditionalValue< sitk::sitkVectorUInt32 != sitk::sitkUnknown, sitk::sitkVectorUInt32, -18 >::Value:
+    case sitk::ConditionalValue< sitk::sitkUInt32 != sitk::sitkUnknown, sitk::sitkUInt32, -6 >::Value:
+      pixelSize = sizeof( uint32_t );
+      dtype.code = sitk_kDLUInt;
+      dtype.bits = 32;
+      return sitkImage->GetBufferAsUInt32();
+    case sitk::ConditionalValue< sitk::sitkVectorInt32 != sitk::sitkUnknown, sitk::sitkVectorInt32, -19 >::Value:
+    case sitk::ConditionalValue< sitk::sitkInt32 != sitk::sitkUnknown, sitk::sitkInt32, -7 >::Value:
+      pixelSize = sizeof( int32_t );
+      dtype.code = sitk_kDLInt;
+      dtype.bits = 32;
+      return sitkImage->GetBufferAsInt32();
+    case sitk::ConditionalValue< sitk::sitkVectorUInt64 != sitk::sitkUnknown, sitk::sitkVectorUInt64, -20 >::Value:
+    case sitk::ConditionalValue< sitk::sitkUInt64 != sitk::sitkUnknown, sitk::sitkUInt64, -8 >::Value:
+      pixelSize = sizeof( uint64_t );
+      dtype.code = sitk_kDLUInt;
+      dtype.bits = 64;
+      return sitkImage->GetBufferAsUInt64();
+    case sitk::ConditionalValue< sitk::sitkVectorInt64 != sitk::sitkUnknown, sitk::sitkVectorInt64, -21 >::Value:
+    case sitk::ConditionalValue< sitk::sitkInt64 != sitk::sitkUnknown, sitk::sitkInt64, -9 >::Value:
+      pixelSize = sizeof( int64_t );
+      dtype.code = sitk_kDLInt;
+      dtype.bits = 64;
+      return sitkImage->GetBufferAsInt64();
+    case sitk::ConditionalValue< sitk::sitkVectorFloat32 != sitk::sitkUnknown, sitk::sitkVectorFloat32, -22 >::Value:
+    case sitk::ConditionalValue< sitk::sitkFloat32 != sitk::sitkUnknown, sitk::sitkFloat32, -10 >::Value:
+      pixelSize = sizeof( float );
+      dtype.code = sitk_kDLFloat;
+      dtype.bits = 32;
+      return sitkImage->GetBufferAsFloat();
+    case sitk::ConditionalValue< sitk::sitkVectorFloat64 != sitk::sitkUnknown, sitk::sitkVectorFloat64, -23 >::Value:
+    case sitk::ConditionalValue< sitk::sitkFloat64 != sitk::sitkUnknown, sitk::sitkFloat64, -11 >::Value:
+      pixelSize = sizeof( double );
+      dtype.code = sitk_kDLFloat;
+      dtype.bits = 64;
+      return sitkImage->GetBufferAsDouble();
+    case sitk::ConditionalValue< sitk::sitkComplexFloat32 != sitk::sitkUnknown, sitk::sitkComplexFloat32, -12 >::Value:
+    case sitk::ConditionalValue< sitk::sitkComplexFloat64 != sitk::sitkUnknown, sitk::sitkComplexFloat64, -13 >::Value:
+      PyErr_SetString( PyExc_RuntimeError, "Images of Complex Pixel types currently are not supported." );
+      return NULL;
+    default:
+      PyErr_SetString( PyExc_RuntimeError, "Unknown pixel type." );
+      return NULL;
+    }
+}
+
+/** An internal function that returns the address of the image's
+ * buffer as an integer, after making the buffer unique.
+ */
+static PyObject *
+sitk_GetBufferAddressFromImage( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
+{
+  PyObject *pyImage = NULL;
+  void *voidImage = NULL;
+  size_t pixelSize = 1;
+  sitk_DLDataType dtype;
+
+  if( !PyArg_ParseTuple( args, "O", &pyImage ) )
+    {
+    return NULL;
+    }
+  int res = SWIG_ConvertPtr( pyImage, &voidImage, SWIGTYPE_p_itk__simple__Image, 0 );
+  if( !SWIG_IsOK( res ) )
+    {
+    PyErr_SetString( PyExc_TypeError, "The argument needs to be of type 'sitk::Image *'" );
+    return NULL;
+    }
+
+  void *buffer = sitk_GetUniqueBufferFromImage( reinterpret_cast< sitk::Image * >( voidImage ), pixelSize, dtype );
+  if ( buffer == NULL )
+    {
+    return NULL;
+    }
+  return PyLong_FromVoidPtr( buffer );
+}
+
+
+/** The context of an exported DLPack tensor, which holds a reference
+ * to the Python image. */
+struct sitk_DLPackExportContext
+{
+  PyObject *m_Image;
+  int64_t   m_Shape[5];
+};
+
+static void
+sitk_DLPackExportDeleter( sitk_DLManagedTensor *self )
+{
+  PyGILState_STATE gstate = PyGILState_Ensure();
+  sitk_DLPackExportContext *ctx = reinterpret_cast< sitk_DLPackExportContext * >( self->manager_ctx );
+  Py_XDECREF( ctx->m_Image );
+  delete ctx;
+  delete self;
+  PyGILState_Release( gstate );
+}
+
+/** Release a DLPack capsule which has not been consumed. */
+static void
+sitk_DLPackCapsuleDestructor( PyObject *capsule )
+{
+  if ( PyCapsule_IsValid( capsule, "dltensor" ) )
+    {
+    sitk_DLManagedTensor *managed =
+      reinterpret_cast< sitk_DLManagedTensor * >( PyCapsule_GetPointer( capsule, "dltensor" ) );
+    if ( managed && managed->deleter )
+      {
+      managed->deleter( managed );
+      }
+    }
+}
+
+/** An internal function that exports the buffer of an image as a
+ * DLPack capsule (shallow). The buffer is made unique, and the tensor
+ * holds a reference to the image until it is deleted by the consumer.
+ * The shape is in C order, with the components of a vector image as
+ * the last dimension.
+ */
+static PyObject *
+sitk_GetDLPackFromImage( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
+{
+  PyObject *pyImage = NULL;
+  void *voidImage = NULL;
+  size_t pixelSize = 1;
+  sitk_DLDataType dtype;
+
+  if( !PyArg_ParseTuple( args, "O", &pyImage ) )
+    {
+    return NULL;
+    }
+  int res = SWIG_ConvertPtr( pyImage, &voidImage, SWIGTYPE_p_itk__simple__Image, 0 );
+  if( !SWIG_IsOK( res ) )
+    {
+    PyErr_SetString( PyExc_TypeError, "The argument needs to be of type 'sitk::Image *'" );
+    return NULL;
+    }
+  sitk::Image *sitkImage = reinterpret_cast< sitk::Image * >( voidImage );
+
+  void *buffer = sitk_GetUniqueBufferFromImage( sitkImage, pixelSize, dtype );
+  if ( buffer == NULL )
+    {
+    return NULL;
+    }
+
+  sitk_DLPackExportContext *ctx = new sitk_DLPackExportContext;
+  const std::vector< unsigned int > size = sitkImage->GetSize();
+  int32_t ndim = 0;
+  for ( size_t i = size.size(); i > 0; --i )
+    {
+    ctx->m_Shape[ndim++] = size[i-1];
+    }
+  if ( sitkImage->GetNumberOfComponentsPerPixel() > 1 )
+    {
+    ctx->m_Shape[ndim++] = sitkImage->GetNumberOfComponentsPerPixel();
+    }
+  Py_INCREF( pyImage );
+  ctx->m_Image = pyImage;
+
+  sitk_DLManagedTensor *managed = new sitk_DLManagedTensor;
+  memset( managed, 0, sizeof( sitk_DLManagedTensor ) );
+  managed->dl_tensor.data = buffer;
+  managed->dl_tensor.device.device_type = sitk_kDLCPU;
+  managed->dl_tensor.device.device_id = 0;
+  managed->dl_tensor.ndim = ndim;
+  managed->dl_tensor.dtype = dtype;
+  managed->dl_tensor.shape = ctx->m_Shape;
+  managed->dl_tensor.strides = NULL;
+  managed->dl_tensor.byte_offset = 0;
+  managed->manager_ctx = ctx;
+  managed->deleter = sitk_DLPackExportDeleter;
+
+  PyObject *capsule = PyCapsule_New( managed, "dltensor", sitk_DLPackCapsuleDestructor );
+  if ( capsule == NULL )
+    {
+    sitk_DLPackExportDeleter( managed );
+    }
+  return capsule;
+}
+
+static void
+sitk_ReleaseDLPackTensor( void *SWIGUNUSEDPARM(buffer), void *clientData )
+{
+  sitk_DLManagedTensor *managed = reinterpret_cast< sitk_DLManagedTensor * >( clientData );
+  if ( managed->deleter )
+    {
+    managed->deleter( managed );
+    }
+}
+
+/** An internal function that creates a SimpleITK Image which imports
+ * the tensor of a DLPack capsule (shallow). The capsule is consumed,
+ * and the tensor is deleted when the last image referring to the
+ * buffer is destroyed. Only compact C ordered tensors in CPU memory
+ * are supported. When the second argument is true the last dimension
+ * is the components of a vector image.
+ */
+static PyObject *
+sitk_GetImageFromDLPack( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
+{
+  PyObject *capsule = NULL;
+  int isVector = 0;
+
+  if( !PyArg_ParseTuple( args, "O|i", &capsule, &isVector ) )
+    {
+    return NULL;
+    }
+  if ( !PyCapsule_IsValid( capsule, "dltensor" ) )
+    {
+    PyErr_SetString( PyExc_TypeError, "A DLPack capsule which has not been consumed is required." );
+    return NULL;
+    }
+  sitk_DLManagedTensor *managed =
+    reinterpret_cast< sitk_DLManagedTensor * >( PyCapsule_GetPointer( capsule, "dltensor" ) );
+  const sitk_DLTensor &tensor = managed->dl_tensor;
+
+  if ( tensor.device.device_type != sitk_kDLCPU )
+    {
+    PyErr_SetString( PyExc_RuntimeError, "Only DLPack tensors in CPU memory can be imported." );
+    return NULL;
+    }
+  if ( tensor.ndim < 2 || tensor.ndim > 4 || tensor.dtype.lanes != 1 )
+    {
+    PyErr_SetString( PyExc_RuntimeError, "Only DLPack tensors of 2, 3 or 4 dimensions are supported." );
+    return NULL;
+    }
+
+  const bool vector = ( tensor.ndim == 4 ) || ( isVector && tensor.ndim == 3 );
+  unsigned int numberOfComponents = 1;
+  std::vector< unsigned int > size;
+  int64_t stride = 1;
+  bool compact = true;
+  for ( int32_t d = tensor.ndim; d > 0; --d )
+    {
+    if ( tensor.strides != NULL && tensor.shape[d-1] > 1 && tensor.strides[d-1] != stride )
+      {
+      compact = false;
+      }
+    stride *= tensor.shape[d-1];
+    if ( vector && d == tensor.ndim )
+      {
+      numberOfComponents = static_cast< unsigned int >( tensor.shape[d-1] );
+      }
+    else
+      {
+      size.push_back( static_cast< unsigned int >( tensor.shape[d-1] ) );
+      }
+    }
+  if ( !compact )
+    {
+    PyErr_SetString( PyExc_RuntimeError, "Only C contiguous DLPack tensors can be imported." );
+    return NULL;
+    }
+
+  int pixelID = sitk::sitkUnknown;
+  const unsigned int bits = tensor.dtype.bits;
+  if ( tensor.dtype.code == sitk_kDLUInt )
+    {
+    pixelID = ( bits == 8 ) ? sitk::sitkVectorUInt8 : ( bits == 16 ) ? sitk::sitkVectorUInt16 :
+      ( bits == 32 ) ? sitk::sitkVectorUInt32 : ( bits == 64 ) ? sitk::sitkVectorUInt64 : sitk::sitkUnknown;
+    }
+  else if ( tensor.dtype.code == sitk_kDLInt )
+    {
+    pixelID = ( bits == 8 ) ? sitk::sitkVectorInt8 : ( bits == 16 ) ? sitk::sitkVectorInt16 :
+      ( bits == 32 ) ? sitk::sitkVectorInt32 : ( bits == 64 ) ? sitk::sitkVectorInt64 : sitk::sitkUnknown;
+    }
+  else if ( tensor.dtype.code == sitk_kDLFloat )
+    {
+    pixelID = ( bits == 32 ) ? sitk::sitkVectorFloat32 : ( bits == 64 ) ? sitk::sitkVectorFloat64 : sitk::sitkUnknown;
+    }
+  if ( pixelID == sitk::sitkUnknown || ( vector && numberOfComponents < 2 ) )
+    {
+    PyErr_SetString( PyExc_RuntimeError, "The data type of the DLPack tensor is not supported." );
+    return NULL;
+    }
+
+  // the tensor is owned by the image once the capsule is consumed
+  if ( PyCapsule_SetName( capsule, "used_dltensor" ) != 0 )
+    {
+    return NULL;
+    }
+  const size_t length = static_cast< size_t >( stride ) * ( bits / 8 );
+  return sitk_ImportBufferAsImage( static_cast< char * >( tensor.data ) + tensor.byte_offset, length, size,
+                                   pixelID, numberOfComponents, sitk_ReleaseDLPackTensor, managed );
+}
+
+/** An internal function that transforms many points or indices of
+ * an image, or points with a transform, in one call. The arguments
+ * are the image or transform, a C contiguous buffer of float64
+ * points, or int64 indices, and the transform: 0 physical points to
+ * indices, 1 indices to physical points, 2 physical points to
+ * continuous indices and 3 continuous indices to physical points of
+ * an image, and 4 points with a sitk::Transform. A bytearray of the
+ * transformed coordinates is returned, int64 for indices and float64
+ * otherwise.
+ */
+static PyObject *
+sitk_TransformPointsFromBuffer( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
+{
+  PyObject *pyObject = NULL;
+  PyObject *pyPoints = NULL;
+  int transform = 0;
+  void *voidObject = NULL;
+  Py_buffer pyBuffer;
+
+  if( !PyArg_ParseTuple( args, "OOi", &pyObject, &pyPoints, &transform ) )
+    {
+    return NULL;
+    }
+  if ( transform < 0 || transform > 4 )
+    {
+    PyErr_SetString( PyExc_ValueError, "Unknown transform." );
+    return NULL;
+    }
+  if ( transform == 4 )
+    {
+    int res = SWIG_ConvertPtr( pyObject, &voidObject, SWIGTYPE_p_itk__simple__Transform, 0 );
+    if( !SWIG_IsOK( res ) )
+      {
+      PyErr_SetString( PyExc_TypeError, "The first argument needs to be of type 'sitk::Transform *'" );
+      return NULL;
+      }
+    }
+  else
+    {
+    int res = SWIG_ConvertPtr( pyObject, &voidObject, SWIGTYPE_p_itk__simple__Image, 0 );
+    if( !SWIG_IsOK( res ) )
+      {
+      PyErr_SetString( PyExc_TypeError, "The first argument needs to be of type 'sitk::Image *'" );
+      return NULL;
+      }
+    }
+  const sitk::Image *sitkImage = reinterpret_cast< const sitk::Image * >( voidObject );
+  const sitk::Transform *sitkTransform = reinterpret_cast< const sitk::Transform * >( voidObject );
+
+  memset( &pyBuffer, 0, sizeof(Py_buffer) );
+  if ( PyObject_GetBuffer( pyPoints, &pyBuffer, PyBUF_C_CONTIGUOUS ) != 0 )
+    {
+    return NULL;
+    }
+
+  // both the inputs and the outputs have 8 byte coordinates
+  const size_t length = static_cast< size_t >( pyBuffer.len ) / 8;
+  std::vector< double > points;
+  std::vector< int64_t > indices;
+  if ( transform == 1 )
+    {
+    indices.resize( length );
+    memcpy( indices.empty() ? NULL : &indices[0], pyBuffer.buf, length * 8 );
+    }
+  else
+    {
+    points.resize( length );
+    memcpy( points.empty() ? NULL : &points[0], pyBuffer.buf, length * 8 );
+    }
+  PyBuffer_Release( &pyBuffer );
+
+  std::string msg;
+  SWIG_PYTHON_THREAD_BEGIN_ALLOW;
+  try
+    {
+    switch ( transform )
+      {
+      case 0:
+        indices = sitkImage->TransformPhysicalPointsToIndices( points );
+        break;
+      case 1:
+        points = sitkImage->TransformIndicesToPhysicalPoints( indices );
+        break;
+      case 2:
+        points = sitkImage->TransformPhysicalPointsToContinuousIndices( points );
+        break;
+      case 3:
+        points = sitkImage->TransformContinuousIndicesToPhysicalPoints( points );
+        break;
+      case 4:
+        points = sitkTransform->TransformPoints( points );
+        break;
+      }
+    }
+  catch( const std::exception &e )
+    {
+    msg = "Exception thrown in SimpleITK TransformPoints: ";
+    msg += e.what();
+    }
+  SWIG_PYTHON_THREAD_END_ALLOW;
+
+  if ( !msg.empty() )
+    {
+    PyErr_SetString( PyExc_RuntimeError, msg.c_str() );
+    return NULL;
+    }
+
+  if ( transform == 0 )
+    {
+    return PyByteArray_FromStringAndSize( indices.empty() ? NULL : reinterpret_cast< const char * >( &indices[0] ),
+                                          static_cast< Py_ssize_t >( indices.size() * sizeof( int64_t ) ) );
+    }
+  return PyByteArray_FromStringAndSize( points.empty() ? NULL : reinterpret_cast< const char * >( &points[0] ),
+                                        static_cast< Py_ssize_t >( points.size() * sizeof( double ) ) );
+}
+
+/** Return a read-only memoryview of the parameters of a transform,
+ * without copying them. The memoryview does not reference the
+ * transform, the caller must keep the ITK transform alive.
+ */
+static PyObject *
+sitk_GetMemoryViewFromTransformParameters( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
+{
+  PyObject *pyTransform = NULL;
+  void *voidTransform = NULL;
+  Py_buffer pyBuffer;
+  memset( &pyBuffer, 0, sizeof(Py_buffer) );
+
+  if( !PyArg_ParseTuple( args, "O", &pyTransform ) )
+    {
+    return NULL;
+    }
+  int res = SWIG_ConvertPtr( pyTransform, &voidTransform, SWIGTYPE_p_itk__simple__Transform, 0 );
+  if( !SWIG_IsOK( res ) )
+    {
+    PyErr_SetString( PyExc_TypeError, "The first argument needs to be of type 'sitk::Transform *'" );
+    return NULL;
+    }
+  const sitk::Transform *sitkTransform = reinterpret_cast< const sitk::Transform * >( voidTransform );
+
+  const double *parameters = SITK_NULLPTR;
+  Py_ssize_t len = 0;
+  try
+    {
+    len = static_cast< Py_ssize_t >( sitkTransform->GetNumberOfParameters() * sizeof( double ) );
+    parameters = sitkTransform->GetParametersAsDouble();
+    }
+  catch( const std::exception &e )
+    {
+    std::string msg = "Exception thrown in SimpleITK GetParameters: ";
+    msg += e.what();
+    PyErr_SetString( PyExc_RuntimeError, msg.c_str() );
+    return NULL;
+    }
+
+  if ( PyBuffer_FillInfo( &pyBuffer, NULL, const_cast< double * >( parameters ), len, 1, PyBUF_CONTIG_RO ) != 0 )
+    {
+    return NULL;
+    }
+  PyObject *memoryView = PyMemoryView_FromBuffer( &pyBuffer );
+  PyBuffer_Release( &pyBuffer );
+  return memoryView;
+}
+
+/** Set the parameters of a transform from a C contiguous buffer of
+ * doubles, without an intermediate std::vector.
+ */
+static PyObject *
+sitk_SetTransformParametersFromBuffer( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
+{
+  PyObject *pyTransform = NULL;
+  PyObject *pyParameters = NULL;
+  void *voidTransform = NULL;
+  Py_buffer pyBuffer;
+
+  if( !PyArg_ParseTuple( args, "OO", &pyTransform, &pyParameters ) )
+    {
+    return NULL;
+    }
+  int res = SWIG_ConvertPtr( pyTransform, &voidTransform, SWIGTYPE_p_itk__simple__Transform, 0 );
+  if( !SWIG_IsOK( res ) )
+    {
+    PyErr_SetString( PyExc_TypeError, "The first argument needs to be of type 'sitk::Transform *'" );
+    return NULL;
+    }
+  sitk::Transform *sitkTransform = reinterpret_cast< sitk::Transform * >( voidTransform );
+
+  memset( &pyBuffer, 0, sizeof(Py_buffer) );
+  if ( PyObject_GetBuffer( pyParameters, &pyBuffer, PyBUF_C_CONTIGUOUS ) != 0 )
+    {
+    return NULL;
+    }
+
+  std::string msg;
+  try
+    {
+    sitkTransform->SetParameters( static_cast< const double * >( pyBuffer.buf ),
+                                  static_cast< size_t >( pyBuffer.len ) / sizeof( double ) );
+    }
+  catch( const std::exception &e )
+    {
+    msg = "Exception thrown in SimpleITK SetParameters: ";
+    msg += e.what();
+    }
+  PyBuffer_Release( &pyBuffer );
+
+  if ( !msg.empty() )
+    {
+    PyErr_SetString( PyExc_RuntimeError, msg.c_str() );
+    return NULL;
+    }
+  Py_RETURN_NONE;
+}
+
+/** Return a feature of all the labels of a LabelFeaturesImageFilter
+ * as a bytearray, with one copy of the contiguous measurements.
+ */
+static PyObject *
+sitk_GetLabelFeaturesArray( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
+{
+  PyObject *pyFilter = NULL;
+  const char *name = NULL;
+  void *voidFilter = NULL;
+
+  if( !PyArg_ParseTuple( args, "Os", &pyFilter, &name ) )
+    {
+    return NULL;
+    }
+  int res = SWIG_ConvertPtr( pyFilter, &voidFilter, SWIGTYPE_p_itk__simple__LabelFeaturesImageFilter, 0 );
+  if( !SWIG_IsOK( res ) )
+    {
+    PyErr_SetString( PyExc_TypeError, "The first argument needs to be of type 'sitk::LabelFeaturesImageFilter *'" );
+    return NULL;
+    }
+  const sitk::LabelFeaturesImageFilter *filter = reinterpret_cast< const sitk::LabelFeaturesImageFilter * >( voidFilter );
+
+  const std::string feature( name );
+  if ( feature == "Labels" )
+    {
+    return VectorToPyByteArray( filter->GetLabels() );
+    }
+  if ( feature == "NumberOfPixels" )
+    {
+    return VectorToPyByteArray( filter->GetNumberOfPixelsArray() );
+    }
+  if ( feature == "BoundingBox" )
+    {
+    return VectorToPyByteArray( filter->GetBoundingBoxArray() );
+    }
+  if ( feature == "Centroid" )
+    {
+    return VectorToPyByteArray( filter->GetCentroidArray() );
+    }
+  if ( feature == "SecondOrderMoments" )
+    {
+    return VectorToPyByteArray( filter->GetSecondOrderMomentsArray() );
+    }
+  if ( feature == "Sum" )
+    {
+    return VectorToPyByteArray( filter->GetSumArray() );
+    }
+  if ( feature == "Mean" )
+    {
+    return VectorToPyByteArray( filter->GetMeanArray() );
+    }
+  if ( feature == "Minimum" )
+    {
+    return VectorToPyByteArray( filter->GetMinimumArray() );
+    }
+  if ( feature == "Maximum" )
+    {
+    return VectorToPyByteArray( filter->GetMaximumArray() );
+    }
+  if ( feature == "Variance" )
+    {
+    return VectorToPyByteArray( filter->GetVarianceArray() );
+    }
+  if ( feature == "CenterOfGravity" )
+    {
+    return VectorToPyByteArray( filter->GetCenterOfGravityArray() );
+    }
+
+  PyErr_SetString( PyExc_ValueError, "Unknown label feature." );
+  return NULL;
+}
+
+/** Return the counts of the histogram of a HistogramImageFilter as a
+ * bytearray, with one copy of the contiguous counts.
+ */
+static PyObject *
+sitk_GetHistogramCountsArray( PyObject *SWIGUNUSEDPARM(self), PyObject *args )
+{
+  PyObject *pyFilter = NULL;
+  void *voidFilter = NULL;
+
+  if( !PyArg_ParseTuple( args, "O", &pyFilter ) )
+    {
+    return NULL;
+    }
+  int res = SWIG_ConvertPtr( pyFilter, &voidFilter, SWIGTYPE_p_itk__simple__HistogramImageFilter, 0 );
+  if( !SWIG_IsOK( res ) )
+    {
+    PyErr_SetString( PyExc_TypeError, "The first argument needs to be of type 'sitk::HistogramImageFilter *'" );
+    return NULL;
+    }
+  const sitk::HistogramImageFilter *filter = reinterpret_cast< const sitk::HistogramImageFilter * >( voidFilter );
+
+  return VectorToPyByteArray( filter->GetCounts() );
+}
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -104,6 +104,11 @@ void PyCommand::Execute()
     return;
     }
 
+  // The wrapped methods release the GIL while executing, so it is
+  // acquired before any use of the Python API. The command may be
+  // invoked from any thread which is executing a filter.
+  PyGILStateEnsure gil;
+
   // make sure that the CommandCallable is in fact callable
   if (!PyCallable_Check(this->m_Object))
     {
@@ -115,8 +120,6 @@ void PyCommand::Execute()
     }
   else
     {
-    PyGILStateEnsure gil;
-
     PyObject *result;
 
     result = PyObject_CallObject(this->m_Object, (PyObject *)NULL);
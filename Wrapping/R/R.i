@@ -159,11 +159,12 @@ void delete_Transform_void(SEXP p)
 }
 #endif
 
-SEXP ImAsArray(itk::simple::Image src);
+SEXP ImAsArray(const itk::simple::Image &src);
 itk::simple::Image ArrayAsIm(SEXP arr,
                              std::vector<unsigned int> size,
                              std::vector<double> spacing,
-                             std::vector<double> origin);
+                             std::vector<double> origin,
+                             unsigned int numberOfComponents);
 %}
 
 
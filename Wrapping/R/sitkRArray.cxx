@@ -18,15 +18,17 @@
 
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 
 #include <Rdefines.h>
 #include <Rversion.h>
 
 #include "sitkImage.h"
 #include "sitkConditional.h"
-#include "sitkImportImageFilter.h"
+#include "sitkMacro.h"
 
-SEXP ImAsArray(itk::simple::Image src)
+SEXP ImAsArray(const itk::simple::Image &src)
 {
   // tricky to make this efficient with memory and fast.
   // Ideally we want multithreaded casting directly to the
@@ -34,13 +36,19 @@ SEXP ImAsArray(itk::simple::Image src)
   // obviously producing a redundant copy. If we do a direct cast,
   // then we're probably not multi-threaded.
   // Lets be slow but memory efficient.
+  //
+  // The buffer is accessed through the const image, so a buffer
+  // shared with other images is not copied before the conversion.
+  // The first index of ITK varies fastest, which is R's column-major
+  // order, so the buffer is copied without reordering. Buffers of the
+  // R storage type are copied with a single memcpy.
 
   std::vector<unsigned int> sz = src.GetSize();
   itk::simple::PixelIDValueType  PID=src.GetPixelIDValue();
   SEXP res = 0;
   double *dans=0;
   int *ians=0;
-  unsigned pixcount=src.GetNumberOfComponentsPerPixel();
+  R_xlen_t pixcount=src.GetNumberOfComponentsPerPixel();
   for (unsigned k = 0; k < sz.size();k++)
     {
     pixcount *= sz[k];
@@ -90,72 +98,72 @@ SEXP ImAsArray(itk::simple::Image src)
     case itk::simple::ConditionalValue< itk::simple::sitkUInt8 != itk::simple::sitkUnknown, itk::simple::sitkUInt8, -2 >::Value:
     case itk::simple::ConditionalValue< itk::simple::sitkVectorUInt8 != itk::simple::sitkUnknown, itk::simple::sitkVectorUInt8, -14 >::Value:
     {
-    uint8_t * buff = src.GetBufferAsUInt8();
+    const uint8_t * buff = src.GetBufferAsUInt8();
     std::copy(buff,buff + pixcount,ians);
     }
     break;
     case itk::simple::ConditionalValue< itk::simple::sitkInt8 != itk::simple::sitkUnknown, itk::simple::sitkInt8, -3 >::Value:
     case itk::simple::ConditionalValue< itk::simple::sitkVectorInt8 != itk::simple::sitkUnknown, itk::simple::sitkVectorInt8, -15 >::Value:
     {
-    int8_t * buff = src.GetBufferAsInt8();
+    const int8_t * buff = src.GetBufferAsInt8();
     std::copy(buff,buff + pixcount,ians);
     }
     break;
     case itk::simple::ConditionalValue< itk::simple::sitkUInt16 != itk::simple::sitkUnknown, itk::simple::sitkUInt16, -4 >::Value:
     case itk::simple::ConditionalValue< itk::simple::sitkVectorUInt16 != itk::simple::sitkUnknown, itk::simple::sitkVectorUInt16, -16 >::Value:
     {
-    uint16_t * buff = src.GetBufferAsUInt16();
+    const uint16_t * buff = src.GetBufferAsUInt16();
     std::copy(buff,buff + pixcount,ians);
     }
     break;
     case itk::simple::ConditionalValue< itk::simple::sitkInt16 != itk::simple::sitkUnknown, itk::simple::sitkInt16, -5 >::Value:
     case itk::simple::ConditionalValue< itk::simple::sitkVectorInt16 != itk::simple::sitkUnknown, itk::simple::sitkVectorInt16, -17 >::Value:
     {
-    int16_t * buff = src.GetBufferAsInt16();
+    const int16_t * buff = src.GetBufferAsInt16();
     std::copy(buff,buff + pixcount,ians);
     }
     break;
     case itk::simple::ConditionalValue< itk::simple::sitkUInt32 != itk::simple::sitkUnknown, itk::simple::sitkUInt32, -6 >::Value:
     case itk::simple::ConditionalValue< itk::simple::sitkVectorUInt32 != itk::simple::sitkUnknown, itk::simple::sitkVectorUInt32, -18 >::Value:
     {
-    uint32_t * buff = src.GetBufferAsUInt32();
+    const uint32_t * buff = src.GetBufferAsUInt32();
     std::copy(buff,buff + pixcount,ians);
     }
     break;
     case itk::simple::ConditionalValue< itk::simple::sitkInt32 != itk::simple::sitkUnknown, itk::simple::sitkInt32, -7 >::Value:
     case itk::simple::ConditionalValue< itk::simple::sitkVectorInt32 != itk::simple::sitkUnknown, itk::simple::sitkVectorInt32, -19 >::Value:
     {
-    int32_t * buff = src.GetBufferAsInt32();
-    std::copy(buff,buff + pixcount,ians);
+    const int32_t * buff = src.GetBufferAsInt32();
+    memcpy(ians, buff, pixcount * sizeof(int32_t));
     }
     break;
     case itk::simple::ConditionalValue< itk::simple::sitkUInt64 != itk::simple::sitkUnknown, itk::simple::sitkUInt64, -8 >::Value:
     case itk::simple::ConditionalValue< itk::simple::sitkVectorUInt64 != itk::simple::sitkUnknown, itk::simple::sitkVectorUInt64, -20 >::Value:
 
     {
-    uint64_t * buff = src.GetBufferAsUInt64();
+    const uint64_t * buff = src.GetBufferAsUInt64();
     std::copy(buff,buff + pixcount,ians);
     }
     break;
     case itk::simple::ConditionalValue< itk::simple::sitkInt64 != itk::simple::sitkUnknown, itk::simple::sitkInt64, -9 >::Value:
     case itk::simple::ConditionalValue< itk::simple::sitkVectorInt64 != itk::simple::sitkUnknown, itk::simple::sitkVectorInt64, -21 >::Value:
     {
-    int64_t * buff = src.GetBufferAsInt64();
+    const int64_t * buff = src.GetBufferAsInt64();
     std::copy(buff,buff + pixcount,ians);
     }
     break;
     case itk::simple::ConditionalValue< itk::simple::sitkFloat32 != itk::simple::sitkUnknown, itk::simple::sitkFloat32, -10 >::Value:
     case itk::simple::ConditionalValue< itk::simple::sitkVectorFloat32 != itk::simple::sitkUnknown, itk::simple::sitkVectorFloat32, -22 >::Value:
     {
-    float * buff = src.GetBufferAsFloat();
+    const float * buff = src.GetBufferAsFloat();
     std::copy(buff,buff + pixcount,dans);
     }
     break;
     case itk::simple::ConditionalValue< itk::simple::sitkFloat64 != itk::simple::sitkUnknown, itk::simple::sitkFloat64, -11 >::Value:
     case itk::simple::ConditionalValue< itk::simple::sitkVectorFloat64 != itk::simple::sitkUnknown, itk::simple::sitkVectorFloat64, -23 >::Value:
     {
-    double * buff = src.GetBufferAsDouble();
-    std::copy(buff,buff + pixcount,dans);
+    const double * buff = src.GetBufferAsDouble();
+    memcpy(dans, buff, pixcount * sizeof(double));
     }
     break;
     default:
@@ -170,27 +178,43 @@ SEXP ImAsArray(itk::simple::Image src)
 itk::simple::Image ArrayAsIm(SEXP arr,
                              std::vector<unsigned int> size,
                              std::vector<double> spacing,
-                             std::vector<double> origin)
+                             std::vector<double> origin,
+                             unsigned int numberOfComponents)
 {
-  // can't work out how to get the array size in C
-  itk::simple::ImportImageFilter importer;
-  importer.SetSpacing( spacing );
-  importer.SetOrigin( origin );
-  importer.SetSize( size );
+  // The pixels are copied with a single memcpy, in the order of the R
+  // array with the components interleaved, so the image does not
+  // refer to the memory of the R array after it is collected.
+  R_xlen_t len = std::max(numberOfComponents, 1u);
+  for (unsigned k = 0; k < size.size(); k++)
+    {
+    len *= size[k];
+    }
+  if (Rf_xlength(arr) != len)
+    {
+    sitkExceptionMacro( << "Exception thrown ArrayAsIm : the length of the array "
+                        << Rf_xlength(arr) << " does not match the size of the image" );
+    }
+
+  itk::simple::Image res;
   if (Rf_isReal(arr))
     {
-    importer.SetBufferAsDouble(NUMERIC_POINTER(arr));
+    res = ( numberOfComponents > 1 ) ?
+      itk::simple::Image( size, itk::simple::sitkVectorFloat64, numberOfComponents ) :
+      itk::simple::Image( size, itk::simple::sitkFloat64 );
+    memcpy(res.GetBufferAsDouble(), NUMERIC_POINTER(arr), len * sizeof(double));
     }
   else if (Rf_isInteger(arr) || Rf_isLogical(arr))
     {
-    importer.SetBufferAsInt32(INTEGER_POINTER(arr));
+    res = ( numberOfComponents > 1 ) ?
+      itk::simple::Image( size, itk::simple::sitkVectorInt32, numberOfComponents ) :
+      itk::simple::Image( size, itk::simple::sitkInt32 );
+    memcpy(res.GetBufferAsInt32(), INTEGER_POINTER(arr), len * sizeof(int32_t));
     }
   else
     {
-    char error_msg[1024];
-    snprintf( error_msg, 1024, "Exception thrown ArrayAsIm : unsupported array type");
-    Rprintf(error_msg);
+    sitkExceptionMacro( << "Exception thrown ArrayAsIm : unsupported array type" );
     }
-  itk::simple::Image res = importer.Execute();
+  res.SetSpacing( spacing );
+  res.SetOrigin( origin );
   return(res);
 }
@@ -24,4 +24,53 @@
 // ignore overload methods of int type when there is an enum
 %ignore itk::simple::CastImageFilter::SetOutputPixelType( PixelIDValueType pixelID );
 %ignore itk::simple::GetPixelIDValueAsString( PixelIDValueType type );
+
+
+// Bulk access to the pixel buffer of an image as a Tcl byte array,
+// laid out as the GetBufferAs methods of the C++ Image.
+%{
+struct sitkTclByteArray
+{
+  const unsigned char *m_Data;
+  size_t               m_Length;
+};
+%}
+%typemap(out) sitkTclByteArray
+{
+  if ( $1.m_Length > static_cast<size_t>( std::numeric_limits<int>::max() ) )
+    {
+    SWIG_exception( SWIG_ValueError, "The image buffer is too large for a Tcl byte array." );
+    }
+  Tcl_SetObjResult( interp, Tcl_NewByteArrayObj( $1.m_Data, static_cast<int>( $1.m_Length ) ) );
+}
+%typemap(in) sitkTclByteArray
+{
+  int length = 0;
+  $1.m_Data = Tcl_GetByteArrayFromObj( $input, &length );
+  $1.m_Length = static_cast<size_t>( length );
+}
+
+%extend itk::simple::Image {
+  // Copies the pixels into a byte array, for use with binary scan or
+  // a channel in binary mode. The image is not made unique.
+  sitkTclByteArray GetBufferAsByteArray( void ) const
+  {
+    sitkTclByteArray buffer;
+    buffer.m_Data = static_cast<const unsigned char *>( self->GetBufferAsVoid() );
+    buffer.m_Length = static_cast<size_t>( self->GetSizeInBytes() );
+    return buffer;
+  }
+
+  // Copies a byte array, such as returned by GetBufferAsByteArray,
+  // into the pixels of the image.
+  void SetBufferFromByteArray( sitkTclByteArray buffer )
+  {
+    if ( static_cast<uint64_t>( buffer.m_Length ) != self->GetSizeInBytes() )
+      {
+      sitkExceptionMacro( "The byte array of " << buffer.m_Length << " bytes does not match the "
+                          << self->GetSizeInBytes() << " bytes of the image buffer." );
+      }
+    memcpy( self->GetBufferAsVoid(), buffer.m_Data, buffer.m_Length );
+  }
+}
 #endif